@@ -26,6 +26,7 @@
 
 #include "autotype/AutoTypePlatformPlugin.h"
 #include "autotype/AutoTypeSelectDialog.h"
+#include "autotype/AutoTypeWindowMatcher.h"
 #include "autotype/WildcardMatcher.h"
 #include "core/AutoTypeMatch.h"
 #include "core/Config.h"
@@ -42,6 +43,11 @@
 #include "gui/osutils/macutils/MacUtils.h"
 #endif
 
+namespace
+{
+    constexpr int MaxCachedSequences = 100;
+} // namespace
+
 AutoType* AutoType::m_instance = nullptr;
 
 AutoType::AutoType(QObject* parent, bool test)
@@ -246,9 +252,11 @@ void AutoType::executeAutoTypeActions(const Entry* entry, QWidget* hideWindow, c
 
     QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
 
+    m_executor->execBegin(actions, config()->get(Config::AutoTypeBurstMode).toBool());
     for (AutoTypeAction* action : asConst(actions)) {
         if (m_plugin->activeWindow() != window) {
             qWarning("Active window changed, interrupting auto-type.");
+            m_executor->execEnd();
             emit autotypeRejected();
             m_inAutoType.unlock();
             return;
@@ -257,6 +265,7 @@ void AutoType::executeAutoTypeActions(const Entry* entry, QWidget* hideWindow, c
         action->accept(m_executor);
         QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
     }
+    m_executor->execEnd();
 
     m_windowForGlobal = 0;
     m_windowTitleForGlobal.clear();
@@ -338,20 +347,12 @@ void AutoType::performGlobalAutoType(const QList<QSharedPointer<Database>>& dbLi
 
     QList<AutoTypeMatch> matchList;
     bool hideExpired = config()->get(Config::AutoTypeHideExpiredEntry).toBool();
+    bool matchTitle = config()->get(Config::AutoTypeEntryTitleMatch).toBool();
+    bool matchUrl = config()->get(Config::AutoTypeEntryURLMatch).toBool();
 
     for (const auto& db : dbList) {
-        const QList<Entry*> dbEntries = db->rootGroup()->entriesRecursive();
-        for (Entry* entry : dbEntries) {
-            if (hideExpired && entry->isExpired()) {
-                continue;
-            }
-            const QSet<QString> sequences = autoTypeSequences(entry, m_windowTitleForGlobal).toSet();
-            for (const QString& sequence : sequences) {
-                if (!sequence.isEmpty()) {
-                    matchList << AutoTypeMatch(entry, sequence);
-                }
-            }
-        }
+        matchList << AutoTypeWindowMatcher::forDatabase(db.data())
+                         ->match(m_windowTitleForGlobal, matchTitle, matchUrl, hideExpired);
     }
 
     if (matchList.isEmpty()) {
@@ -436,12 +437,99 @@ void AutoType::autoTypeRejectedFromGlobal()
 
 /**
  * Parse an autotype sequence and resolve its Template/command inside as AutoTypeActions
+ *
+ * The structure of a sequence is compiled once and cached, only the entry
+ * fields and placeholders are resolved every time.
  */
 bool AutoType::parseActions(const QString& actionSequence, const Entry* entry, QList<AutoTypeAction*>& actions)
+{
+    QVector<SequenceToken> tokens = m_sequenceCache.value(actionSequence);
+    if (tokens.isEmpty()) {
+        if (!compileSequence(actionSequence, tokens)) {
+            return false;
+        }
+        if (m_sequenceCache.size() >= MaxCachedSequences) {
+            m_sequenceCache.clear();
+        }
+        m_sequenceCache.insert(actionSequence, tokens);
+    }
+
+    // Burst mode drops the default per-key delay, an explicit {DELAY=X} still applies
+    if (config()->get(Config::AutoTypeBurstMode).toBool()) {
+        m_autoTypeDelay = 0;
+    } else {
+        m_autoTypeDelay = qMax(config()->get(Config::AutoTypeDelay).toInt(), 0);
+    }
+
+    for (const SequenceToken& token : asConst(tokens)) {
+        switch (token.type) {
+        case SequenceToken::Characters:
+            for (int i = 0; i < token.count; i++) {
+                for (const QChar& ch : token.text) {
+                    actions.append(new AutoTypeChar(ch));
+                }
+            }
+            break;
+        case SequenceToken::Key:
+            for (int i = 0; i < token.count; i++) {
+                actions.append(new AutoTypeKey(static_cast<Qt::Key>(token.value)));
+            }
+            break;
+        case SequenceToken::Delay:
+            actions.append(new AutoTypeDelay(token.value));
+            break;
+        case SequenceToken::SetDelay:
+            m_autoTypeDelay = token.value;
+            break;
+        case SequenceToken::ClearField:
+            actions.append(new AutoTypeClearField());
+            break;
+        case SequenceToken::Totp:
+            for (const QChar& ch : entry->totp()) {
+                actions.append(new AutoTypeChar(ch));
+            }
+            break;
+        case SequenceToken::Placeholder: {
+            const QString placeholder = QString("{%1}").arg(token.text);
+            const QString resolved = entry->resolvePlaceholder(placeholder);
+            if (placeholder != resolved) {
+                for (const QChar& ch : resolved) {
+                    if (ch == '\n') {
+                        actions.append(new AutoTypeKey(Qt::Key_Enter));
+                    } else if (ch == '\t') {
+                        actions.append(new AutoTypeKey(Qt::Key_Tab));
+                    } else {
+                        actions.append(new AutoTypeChar(ch));
+                    }
+                }
+            }
+            break;
+        }
+        }
+    }
+
+    if (m_autoTypeDelay > 0) {
+        QList<AutoTypeAction*>::iterator i;
+        i = actions.begin();
+        while (i != actions.end()) {
+            ++i;
+            if (i != actions.end()) {
+                i = actions.insert(i, new AutoTypeDelay(m_autoTypeDelay));
+                ++i;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Split an autotype sequence into literal characters and compiled templates
+ */
+bool AutoType::compileSequence(const QString& actionSequence, QVector<SequenceToken>& tokens)
 {
     QString tmpl;
+    QString characters;
     bool inTmpl = false;
-    m_autoTypeDelay = qMax(config()->get(Config::AutoTypeDelay).toInt(), 0);
 
     QString sequence = actionSequence;
     sequence.replace("{{}", "{LEFTBRACE}");
@@ -453,183 +541,114 @@ bool AutoType::parseActions(const QString& actionSequence, const Entry* entry, Q
                 qWarning("Syntax error in Auto-Type sequence.");
                 return false;
             } else if (ch == '}') {
-                QList<AutoTypeAction*> autoType = createActionFromTemplate(tmpl, entry);
-                if (!autoType.isEmpty()) {
-                    actions.append(autoType);
-                }
+                compileTemplate(tmpl, tokens);
                 inTmpl = false;
                 tmpl.clear();
             } else {
                 tmpl += ch;
             }
         } else if (ch == '{') {
+            if (!characters.isEmpty()) {
+                tokens.append({SequenceToken::Characters, characters, 0, 1});
+                characters.clear();
+            }
             inTmpl = true;
         } else if (ch == '}') {
             qWarning("Syntax error in Auto-Type sequence.");
             return false;
         } else {
-            actions.append(new AutoTypeChar(ch));
+            characters += ch;
         }
     }
-    if (m_autoTypeDelay > 0) {
-        QList<AutoTypeAction*>::iterator i;
-        i = actions.begin();
-        while (i != actions.end()) {
-            ++i;
-            if (i != actions.end()) {
-                i = actions.insert(i, new AutoTypeDelay(m_autoTypeDelay));
-                ++i;
-            }
-        }
+
+    if (!characters.isEmpty()) {
+        tokens.append({SequenceToken::Characters, characters, 0, 1});
+    }
+    // Remember that an empty sequence was compiled
+    if (tokens.isEmpty()) {
+        tokens.append({SequenceToken::Characters, QString(), 0, 0});
     }
     return true;
 }
 
 /**
- * Convert an autotype Template/command to its AutoTypeAction that will be executed by the plugin executor
+ * Convert an autotype Template/command to the token that will be turned into AutoTypeActions
  */
-QList<AutoTypeAction*> AutoType::createActionFromTemplate(const QString& tmpl, const Entry* entry)
+void AutoType::compileTemplate(const QString& tmpl, QVector<SequenceToken>& tokens)
 {
+    static const QRegularExpression delayRegEx("^delay=(\\d+)$", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression repeatRegEx("^(.+) (\\d+)$", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression fnRegEx("^f(\\d+)$", QRegularExpression::CaseInsensitiveOption);
+
+    // clang-format off
+    static const QHash<QString, Qt::Key> keys = {
+        {"tab", Qt::Key_Tab}, {"enter", Qt::Key_Enter}, {"space", Qt::Key_Space},
+        {"up", Qt::Key_Up}, {"down", Qt::Key_Down}, {"left", Qt::Key_Left}, {"right", Qt::Key_Right},
+        {"insert", Qt::Key_Insert}, {"ins", Qt::Key_Insert},
+        {"delete", Qt::Key_Delete}, {"del", Qt::Key_Delete},
+        {"home", Qt::Key_Home}, {"end", Qt::Key_End},
+        {"pgup", Qt::Key_PageUp}, {"pgdown", Qt::Key_PageDown},
+        {"backspace", Qt::Key_Backspace}, {"bs", Qt::Key_Backspace}, {"bksp", Qt::Key_Backspace},
+        {"break", Qt::Key_Pause}, {"capslock", Qt::Key_CapsLock}, {"esc", Qt::Key_Escape},
+        {"help", Qt::Key_Help}, {"numlock", Qt::Key_NumLock}, {"ptrsc", Qt::Key_Print},
+        {"scrolllock", Qt::Key_ScrollLock}
+    };
+    // Qt doesn't know about keypad keys so use the normal ones instead
+    static const QHash<QString, QChar> chars = {
+        {"add", '+'}, {"+", '+'}, {"subtract", '-'}, {"multiply", '*'}, {"divide", '/'},
+        {"^", '^'}, {"%", '%'}, {"~", '~'}, {"(", '('}, {")", ')'},
+        {"leftbrace", '{'}, {"rightbrace", '}'}
+    };
+    // clang-format on
+
     QString tmplName = tmpl;
     int num = -1;
-    QList<AutoTypeAction*> list;
 
-    QRegExp delayRegEx("delay=(\\d+)", Qt::CaseInsensitive, QRegExp::RegExp2);
-    if (delayRegEx.exactMatch(tmplName)) {
-        num = delayRegEx.cap(1).toInt();
-        m_autoTypeDelay = std::max(0, std::min(num, 10000));
-        return list;
+    QRegularExpressionMatch match = delayRegEx.match(tmplName);
+    if (match.hasMatch()) {
+        num = match.captured(1).toInt();
+        tokens.append({SequenceToken::SetDelay, QString(), std::max(0, std::min(num, 10000)), 1});
+        return;
     }
 
-    QRegExp repeatRegEx("(.+) (\\d+)", Qt::CaseInsensitive, QRegExp::RegExp2);
-    if (repeatRegEx.exactMatch(tmplName)) {
-        tmplName = repeatRegEx.cap(1);
-        num = repeatRegEx.cap(2).toInt();
+    match = repeatRegEx.match(tmplName);
+    if (match.hasMatch()) {
+        tmplName = match.captured(1);
+        num = match.captured(2).toInt();
 
         if (num == 0) {
-            return list;
+            return;
         }
     }
 
-    if (tmplName.compare("tab", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Tab));
-    } else if (tmplName.compare("enter", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Enter));
-    } else if (tmplName.compare("space", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Space));
-    } else if (tmplName.compare("up", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Up));
-    } else if (tmplName.compare("down", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Down));
-    } else if (tmplName.compare("left", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Left));
-    } else if (tmplName.compare("right", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Right));
-    } else if (tmplName.compare("insert", Qt::CaseInsensitive) == 0
-               || tmplName.compare("ins", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Insert));
-    } else if (tmplName.compare("delete", Qt::CaseInsensitive) == 0
-               || tmplName.compare("del", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Delete));
-    } else if (tmplName.compare("home", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Home));
-    } else if (tmplName.compare("end", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_End));
-    } else if (tmplName.compare("pgup", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_PageUp));
-    } else if (tmplName.compare("pgdown", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_PageDown));
-    } else if (tmplName.compare("backspace", Qt::CaseInsensitive) == 0
-               || tmplName.compare("bs", Qt::CaseInsensitive) == 0
-               || tmplName.compare("bksp", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Backspace));
-    } else if (tmplName.compare("break", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Pause));
-    } else if (tmplName.compare("capslock", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_CapsLock));
-    } else if (tmplName.compare("esc", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Escape));
-    } else if (tmplName.compare("help", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Help));
-    } else if (tmplName.compare("numlock", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_NumLock));
-    } else if (tmplName.compare("ptrsc", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_Print));
-    } else if (tmplName.compare("scrolllock", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeKey(Qt::Key_ScrollLock));
-    }
-    // Qt doesn't know about keypad keys so use the normal ones instead
-    else if (tmplName.compare("add", Qt::CaseInsensitive) == 0 || tmplName.compare("+", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeChar('+'));
-    } else if (tmplName.compare("subtract", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeChar('-'));
-    } else if (tmplName.compare("multiply", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeChar('*'));
-    } else if (tmplName.compare("divide", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeChar('/'));
-    } else if (tmplName.compare("^", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeChar('^'));
-    } else if (tmplName.compare("%", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeChar('%'));
-    } else if (tmplName.compare("~", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeChar('~'));
-    } else if (tmplName.compare("(", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeChar('('));
-    } else if (tmplName.compare(")", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeChar(')'));
-    } else if (tmplName.compare("leftbrace", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeChar('{'));
-    } else if (tmplName.compare("rightbrace", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeChar('}'));
-    } else {
-        QRegExp fnRegexp("f(\\d+)", Qt::CaseInsensitive, QRegExp::RegExp2);
-        if (fnRegexp.exactMatch(tmplName)) {
-            int fnNo = fnRegexp.cap(1).toInt();
-            if (fnNo >= 1 && fnNo <= 16) {
-                list.append(new AutoTypeKey(static_cast<Qt::Key>(Qt::Key_F1 - 1 + fnNo)));
-            }
-        }
+    const QString name = tmplName.toLower();
+    const int count = std::max(1, num);
+    if (keys.contains(name)) {
+        tokens.append({SequenceToken::Key, QString(), keys.value(name), count});
+        return;
+    } else if (chars.contains(name)) {
+        tokens.append({SequenceToken::Characters, QString(chars.value(name)), 0, count});
+        return;
     }
 
-    if (!list.isEmpty()) {
-        for (int i = 1; i < num; i++) {
-            list.append(list.at(0)->clone());
-        }
-        return list;
-    }
-
-    if (tmplName.compare("delay", Qt::CaseInsensitive) == 0 && num > 0) {
-        list.append(new AutoTypeDelay(num));
-    } else if (tmplName.compare("clearfield", Qt::CaseInsensitive) == 0) {
-        list.append(new AutoTypeClearField());
-    } else if (tmplName.compare("totp", Qt::CaseInsensitive) == 0) {
-        QString totp = entry->totp();
-        if (!totp.isEmpty()) {
-            for (const QChar& ch : totp) {
-                list.append(new AutoTypeChar(ch));
-            }
+    match = fnRegEx.match(tmplName);
+    if (match.hasMatch()) {
+        int fnNo = match.captured(1).toInt();
+        if (fnNo >= 1 && fnNo <= 16) {
+            tokens.append({SequenceToken::Key, QString(), Qt::Key_F1 - 1 + fnNo, count});
+            return;
         }
     }
 
-    if (!list.isEmpty()) {
-        return list;
-    }
-
-    const QString placeholder = QString("{%1}").arg(tmplName);
-    const QString resolved = entry->resolvePlaceholder(placeholder);
-    if (placeholder != resolved) {
-        for (const QChar& ch : resolved) {
-            if (ch == '\n') {
-                list.append(new AutoTypeKey(Qt::Key_Enter));
-            } else if (ch == '\t') {
-                list.append(new AutoTypeKey(Qt::Key_Tab));
-            } else {
-                list.append(new AutoTypeChar(ch));
-            }
-        }
+    if (name == "delay" && num > 0) {
+        tokens.append({SequenceToken::Delay, QString(), num, 1});
+    } else if (name == "clearfield") {
+        tokens.append({SequenceToken::ClearField, QString(), 0, 1});
+    } else if (name == "totp") {
+        tokens.append({SequenceToken::Totp, QString(), 0, 1});
+    } else {
+        tokens.append({SequenceToken::Placeholder, tmplName, 0, 1});
     }
-
-    return list;
 }
 
 /**
@@ -697,7 +716,7 @@ bool AutoType::windowMatches(const QString& windowTitle, const QString& windowPa
         QRegExp regExp(windowPattern.mid(2, windowPattern.size() - 4), Qt::CaseInsensitive, QRegExp::RegExp2);
         return (regExp.indexIn(windowTitle) != -1);
     }
-    return WildcardMatcher(windowTitle).match(windowPattern);
+    return WildcardMatcher(windowPattern).match(windowTitle);
 }
 
 /**
@@ -727,46 +746,53 @@ bool AutoType::windowMatchesUrl(const QString& windowTitle, const QString& resol
     return false;
 }
 
+namespace
+{
+    QRegularExpression autoTypeSyntaxRegEx()
+    {
+        QString allowRepetition = "(?:\\s\\d+)?";
+        // the ":" allows custom commands with syntax S:Field
+        // exclude BEEP otherwise will be checked as valid
+        QString normalCommands = "(?!BEEP\\s)[A-Z:_]*" + allowRepetition;
+        QString specialLiterals = "[\\^\\%\\(\\)~\\{\\}\\[\\]\\+]" + allowRepetition;
+        QString functionKeys = "(?:F[1-9]" + allowRepetition + "|F1[0-2])" + allowRepetition;
+        QString numpad = "NUMPAD\\d" + allowRepetition;
+        QString delay = "DELAY=\\d+";
+        QString beep = "BEEP\\s\\d+\\s\\d+";
+        QString vkey = "VKEY(?:-[EN]X)?\\s\\w+";
+        QString customAttributes = "S:(?:[^\\{\\}])+";
+
+        // these chars aren't in parentheses
+        QString shortcutKeys = "[\\^\\%~\\+@]";
+        // a normal string not in parentheses
+        QString fixedStrings = "[^\\^\\%~\\+@\\{\\}]*";
+        // clang-format off
+        return QRegularExpression(
+            "^(?:" + shortcutKeys + "|" + fixedStrings + "|\\{(?:" + normalCommands + "|" + specialLiterals + "|"
+                + functionKeys
+                + "|"
+                + numpad
+                + "|"
+                + delay
+                + "|"
+                + beep
+                + "|"
+                + vkey
+                + ")\\}|\\{"
+                + customAttributes
+                + "\\})*$",
+            QRegularExpression::CaseInsensitiveOption);
+        // clang-format on
+    }
+} // namespace
+
 /**
  * Checks if the overall syntax of an autotype sequence is fine
  */
 bool AutoType::checkSyntax(const QString& string)
 {
-    QString allowRepetition = "(?:\\s\\d+)?";
-    // the ":" allows custom commands with syntax S:Field
-    // exclude BEEP otherwise will be checked as valid
-    QString normalCommands = "(?!BEEP\\s)[A-Z:_]*" + allowRepetition;
-    QString specialLiterals = "[\\^\\%\\(\\)~\\{\\}\\[\\]\\+]" + allowRepetition;
-    QString functionKeys = "(?:F[1-9]" + allowRepetition + "|F1[0-2])" + allowRepetition;
-    QString numpad = "NUMPAD\\d" + allowRepetition;
-    QString delay = "DELAY=\\d+";
-    QString beep = "BEEP\\s\\d+\\s\\d+";
-    QString vkey = "VKEY(?:-[EN]X)?\\s\\w+";
-    QString customAttributes = "S:(?:[^\\{\\}])+";
-
-    // these chars aren't in parentheses
-    QString shortcutKeys = "[\\^\\%~\\+@]";
-    // a normal string not in parentheses
-    QString fixedStrings = "[^\\^\\%~\\+@\\{\\}]*";
-    // clang-format off
-    QRegularExpression autoTypeSyntax(
-        "^(?:" + shortcutKeys + "|" + fixedStrings + "|\\{(?:" + normalCommands + "|" + specialLiterals + "|"
-            + functionKeys
-            + "|"
-            + numpad
-            + "|"
-            + delay
-            + "|"
-            + beep
-            + "|"
-            + vkey
-            + ")\\}|\\{"
-            + customAttributes
-            + "\\})*$",
-        QRegularExpression::CaseInsensitiveOption);
-    // clang-format on
-    QRegularExpressionMatch match = autoTypeSyntax.match(string);
-    return match.hasMatch();
+    static const QRegularExpression autoTypeSyntax = autoTypeSyntaxRegEx();
+    return autoTypeSyntax.match(string).hasMatch();
 }
 
 /**
@@ -775,9 +801,8 @@ bool AutoType::checkSyntax(const QString& string)
 bool AutoType::checkHighDelay(const QString& string)
 {
     // 5 digit numbers(10 seconds) are too much
-    QRegularExpression highDelay("\\{DELAY\\s\\d{5,}\\}", QRegularExpression::CaseInsensitiveOption);
-    QRegularExpressionMatch match = highDelay.match(string);
-    return match.hasMatch();
+    static const QRegularExpression highDelay("\\{DELAY\\s\\d{5,}\\}", QRegularExpression::CaseInsensitiveOption);
+    return highDelay.match(string).hasMatch();
 }
 
 /**
@@ -786,9 +811,8 @@ bool AutoType::checkHighDelay(const QString& string)
 bool AutoType::checkSlowKeypress(const QString& string)
 {
     // 3 digit numbers(100 milliseconds) are too much
-    QRegularExpression slowKeypress("\\{DELAY=\\d{3,}\\}", QRegularExpression::CaseInsensitiveOption);
-    QRegularExpressionMatch match = slowKeypress.match(string);
-    return match.hasMatch();
+    static const QRegularExpression slowKeypress("\\{DELAY=\\d{3,}\\}", QRegularExpression::CaseInsensitiveOption);
+    return slowKeypress.match(string).hasMatch();
 }
 
 /**
@@ -797,9 +821,9 @@ bool AutoType::checkSlowKeypress(const QString& string)
 bool AutoType::checkHighRepetition(const QString& string)
 {
     // 3 digit numbers are too much
-    QRegularExpression highRepetition("\\{(?!DELAY\\s)\\w+\\s\\d{3,}\\}", QRegularExpression::CaseInsensitiveOption);
-    QRegularExpressionMatch match = highRepetition.match(string);
-    return match.hasMatch();
+    static const QRegularExpression highRepetition("\\{(?!DELAY\\s)\\w+\\s\\d{3,}\\}",
+                                                   QRegularExpression::CaseInsensitiveOption);
+    return highRepetition.match(string).hasMatch();
 }
 
 /**
@@ -19,9 +19,11 @@
 #ifndef KEEPASSX_AUTOTYPE_H
 #define KEEPASSX_AUTOTYPE_H
 
+#include <QHash>
 #include <QMutex>
 #include <QObject>
 #include <QStringList>
+#include <QVector>
 #include <QWidget>
 
 #include "core/AutoTypeMatch.h"
@@ -88,8 +90,31 @@ private:
                                 QWidget* hideWindow = nullptr,
                                 const QString& customSequence = QString(),
                                 WId window = 0);
+    struct SequenceToken
+    {
+        enum Type
+        {
+            Characters,
+            Key,
+            Delay,
+            SetDelay,
+            ClearField,
+            Totp,
+            Placeholder
+        };
+
+        Type type;
+        // characters to type or the placeholder name
+        QString text;
+        // key, delay in milliseconds
+        int value;
+        // repetitions of a key or characters
+        int count;
+    };
+
     bool parseActions(const QString& sequence, const Entry* entry, QList<AutoTypeAction*>& actions);
-    QList<AutoTypeAction*> createActionFromTemplate(const QString& tmpl, const Entry* entry);
+    bool compileSequence(const QString& sequence, QVector<SequenceToken>& tokens);
+    void compileTemplate(const QString& tmpl, QVector<SequenceToken>& tokens);
     QList<QString> autoTypeSequences(const Entry* entry, const QString& windowTitle = QString());
     bool windowMatchesTitle(const QString& windowTitle, const QString& resolvedTitle);
     bool windowMatchesUrl(const QString& windowTitle, const QString& resolvedUrl);
@@ -104,6 +129,7 @@ private:
     QPluginLoader* m_pluginLoader;
     AutoTypePlatformInterface* m_plugin;
     AutoTypeExecutor* m_executor;
+    QHash<QString, QVector<SequenceToken>> m_sequenceCache;
     static AutoType* m_instance;
 
     QString m_windowTitleForGlobal;
@@ -78,6 +78,23 @@ void AutoTypeClearField::accept(AutoTypeExecutor* executor)
     executor->execClearField(this);
 }
 
+/**
+ * Called before the actions of a sequence are executed. In burst mode the
+ * executor may prepare the whole sequence up front and batch its events.
+ */
+void AutoTypeExecutor::execBegin(const QList<AutoTypeAction*>& actions, bool burst)
+{
+    Q_UNUSED(actions);
+    Q_UNUSED(burst);
+}
+
+/**
+ * Called after the last action was executed or auto-type was interrupted.
+ */
+void AutoTypeExecutor::execEnd()
+{
+}
+
 void AutoTypeExecutor::execDelay(AutoTypeDelay* action)
 {
     Tools::wait(action->delayMs);
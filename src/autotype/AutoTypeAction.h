@@ -19,6 +19,7 @@
 #define KEEPASSX_AUTOTYPEACTION_H
 
 #include <QChar>
+#include <QList>
 #include <QObject>
 #include <Qt>
 
@@ -78,6 +79,8 @@ public:
     virtual ~AutoTypeExecutor()
     {
     }
+    virtual void execBegin(const QList<AutoTypeAction*>& actions, bool burst);
+    virtual void execEnd();
     virtual void execChar(AutoTypeChar* action) = 0;
     virtual void execKey(AutoTypeKey* action) = 0;
     virtual void execDelay(AutoTypeDelay* action);
@@ -28,7 +28,6 @@
 #include <QHeaderView>
 #include <QLabel>
 #include <QLineEdit>
-#include <QSortFilterProxyModel>
 #include <QVBoxLayout>
 
 #include "autotype/AutoTypeSelectView.h"
@@ -78,12 +77,6 @@ AutoTypeSelectDialog::AutoTypeSelectDialog(QWidget* parent)
     connect(m_view, SIGNAL(matchTextCopied()), SLOT(reject()));
     // clang-format on
 
-    QSortFilterProxyModel* proxy = qobject_cast<QSortFilterProxyModel*>(m_view->model());
-    if (proxy) {
-        proxy->setFilterKeyColumn(-1);
-        proxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    }
-
     layout->addWidget(m_view);
 
     connect(m_filterLineEdit, SIGNAL(textChanged(QString)), SLOT(filterList(QString)));
@@ -144,17 +137,16 @@ void AutoTypeSelectDialog::matchRemoved()
 
     if (m_view->model()->rowCount() == 0 && m_filterLineEdit->text().isEmpty()) {
         reject();
+    } else if (!m_view->currentIndex().isValid()) {
+        m_view->setCurrentIndex(m_view->model()->index(0, 0));
     }
 }
 
 void AutoTypeSelectDialog::filterList(QString filterString)
 {
-    QSortFilterProxyModel* proxy = qobject_cast<QSortFilterProxyModel*>(m_view->model());
-    if (proxy) {
-        proxy->setFilterWildcard(filterString);
-        if (!m_view->currentIndex().isValid()) {
-            m_view->setCurrentIndex(m_view->model()->index(0, 0));
-        }
+    m_view->filterMatches(filterString);
+    if (!m_view->currentIndex().isValid()) {
+        m_view->setCurrentIndex(m_view->model()->index(0, 0));
     }
 }
 
@@ -0,0 +1,220 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AutoTypeWindowMatcher.h"
+
+#include <QUrl>
+
+#include "autotype/WildcardMatcher.h"
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Global.h"
+#include "core/Group.h"
+
+namespace
+{
+    bool isAutoTypeEnabled(const Entry* entry)
+    {
+        const Group* group = entry->group();
+        if (!group || !entry->autoTypeEnabled()) {
+            return false;
+        }
+
+        do {
+            if (group->autoTypeEnabled() == Group::Disable) {
+                return false;
+            } else if (group->autoTypeEnabled() == Group::Enable) {
+                break;
+            }
+            group = group->parentGroup();
+        } while (group);
+
+        return true;
+    }
+} // namespace
+
+AutoTypeWindowMatcher::AutoTypeWindowMatcher(Database* db)
+    : QObject(db)
+    , m_db(db)
+{
+}
+
+/**
+ * @param db database to match the entries of
+ * @return the matcher of the database, created on first use
+ */
+AutoTypeWindowMatcher* AutoTypeWindowMatcher::forDatabase(Database* db)
+{
+    auto* matcher = db->findChild<AutoTypeWindowMatcher*>(QString(), Qt::FindDirectChildrenOnly);
+    if (!matcher) {
+        matcher = new AutoTypeWindowMatcher(db);
+    }
+    return matcher;
+}
+
+/**
+ * Auto-Type sequences of the entries that match a window title, in the
+ * order of the group tree and of the associations of each entry.
+ *
+ * @param windowTitle title of the target window
+ * @param matchTitle match the entry title against the window title
+ * @param matchUrl match the entry URL against the window title
+ * @param hideExpired skip expired entries
+ * @return one match per entry and distinct sequence
+ */
+QList<AutoTypeMatch>
+AutoTypeWindowMatcher::match(const QString& windowTitle, bool matchTitle, bool matchUrl, bool hideExpired)
+{
+    update();
+
+    QList<AutoTypeMatch> result;
+    for (Entry* entry : asConst(m_order)) {
+        CompiledEntry& compiled = m_entries[entry];
+        if (!compiled.enabled || (hideExpired && entry->isExpired())) {
+            continue;
+        }
+
+        QStringList sequences;
+        for (WindowMatcher& matcher : compiled.matchers) {
+            if ((matcher.type == WindowMatcher::Title && !matchTitle)
+                || (matcher.type == WindowMatcher::Url && !matchUrl) || !matches(matcher, windowTitle)) {
+                continue;
+            }
+            const QString& sequence = matcher.sequence.isEmpty() ? compiled.sequence : matcher.sequence;
+            if (!sequence.isEmpty() && !sequences.contains(sequence)) {
+                sequences.append(sequence);
+            }
+        }
+
+        for (const QString& sequence : asConst(sequences)) {
+            result.append(AutoTypeMatch(entry, sequence));
+        }
+    }
+    return result;
+}
+
+/**
+ * Compile the entries that changed since the last update, if the
+ * database was modified.
+ */
+void AutoTypeWindowMatcher::update()
+{
+    if (m_valid && m_modificationCount == m_db->modificationCount()) {
+        return;
+    }
+
+    ++m_generation;
+    m_order.clear();
+    if (m_db->rootGroup()) {
+        m_db->rootGroup()->forEachEntryRecursive([this](Entry* entry) -> bool {
+            auto it = m_entries.find(entry);
+            if (it == m_entries.end()) {
+                it = m_entries.insert(entry, CompiledEntry());
+                compile(entry, it.value());
+            } else if (it->revision != entry->revision() || it->hasReferences) {
+                // Placeholders referring to other entries are resolved again
+                compile(entry, it.value());
+            }
+
+            // Inherited from the groups, which don't change the entry revision
+            it->generation = m_generation;
+            it->enabled = isAutoTypeEnabled(entry);
+            it->sequence = it->enabled ? entry->effectiveAutoTypeSequence() : QString();
+            m_order.append(entry);
+            return true;
+        });
+    }
+
+    // Drop the entries that were not visited: removed or deleted
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->generation != m_generation) {
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    m_modificationCount = m_db->modificationCount();
+    m_valid = true;
+}
+
+void AutoTypeWindowMatcher::compile(Entry* entry, CompiledEntry& compiled) const
+{
+    compiled.revision = entry->revision();
+    compiled.hasReferences = entry->hasReferences();
+    compiled.matchers.clear();
+
+    const QList<AutoTypeAssociations::Association> assocList = entry->autoTypeAssociations()->getAll();
+    for (const AutoTypeAssociations::Association& assoc : assocList) {
+        const QString window = entry->resolveMultiplePlaceholders(assoc.window);
+        WindowMatcher matcher;
+        matcher.sequence = assoc.sequence;
+        if (window.startsWith("//") && window.endsWith("//") && window.size() >= 4) {
+            matcher.type = WindowMatcher::Regex;
+            matcher.regex = QRegExp(window.mid(2, window.size() - 4), Qt::CaseInsensitive, QRegExp::RegExp2);
+        } else {
+            matcher.type = WindowMatcher::Wildcard;
+            matcher.wildcard = WildcardMatcher(window);
+            matcher.literal = matcher.wildcard.longestPart();
+        }
+        compiled.matchers.append(matcher);
+    }
+
+    const QString title = entry->resolvePlaceholder(entry->title());
+    if (!title.isEmpty()) {
+        WindowMatcher matcher;
+        matcher.type = WindowMatcher::Title;
+        matcher.literal = title;
+        compiled.matchers.append(matcher);
+    }
+
+    const QString url = entry->resolvePlaceholder(entry->url());
+    if (!url.isEmpty()) {
+        const QUrl parsedUrl(url);
+        const QString host = parsedUrl.isValid() ? parsedUrl.host() : QString();
+        WindowMatcher matcher;
+        matcher.type = WindowMatcher::Url;
+        matcher.parts = QStringList({url, host});
+        // A title containing the URL also contains its host
+        if (host.isEmpty()) {
+            matcher.literal = url;
+        } else if (url.contains(host, Qt::CaseInsensitive)) {
+            matcher.literal = host;
+        }
+        compiled.matchers.append(matcher);
+    }
+}
+
+bool AutoTypeWindowMatcher::matches(WindowMatcher& matcher, const QString& windowTitle)
+{
+    if (!matcher.literal.isEmpty() && !windowTitle.contains(matcher.literal, Qt::CaseInsensitive)) {
+        return false;
+    }
+
+    switch (matcher.type) {
+    case WindowMatcher::Regex:
+        return matcher.regex.indexIn(windowTitle) != -1;
+    case WindowMatcher::Wildcard:
+        return matcher.wildcard.match(windowTitle);
+    case WindowMatcher::Title:
+        return true;
+    case WindowMatcher::Url:
+        return windowTitle.contains(matcher.parts.at(0), Qt::CaseInsensitive)
+               || (!matcher.parts.at(1).isEmpty() && windowTitle.contains(matcher.parts.at(1), Qt::CaseInsensitive));
+    }
+    return false;
+}
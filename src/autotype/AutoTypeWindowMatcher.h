@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_AUTOTYPEWINDOWMATCHER_H
+#define KEEPASSXC_AUTOTYPEWINDOWMATCHER_H
+
+#include <QHash>
+#include <QObject>
+#include <QRegExp>
+#include <QStringList>
+#include <QVector>
+
+#include "autotype/WildcardMatcher.h"
+#include "core/AutoTypeMatch.h"
+
+class Database;
+class Entry;
+
+/**
+ * Window associations, titles and URLs of the entries of a database,
+ * compiled into matchers for global Auto-Type.
+ *
+ * The matcher is owned by its database. It is brought up to date before
+ * matching whenever the database was modified: entries whose revision
+ * changed or that have references are compiled again, the others only
+ * refresh their group dependent state. Each matcher has the literal text
+ * a matching window title must contain, checked before the full match.
+ */
+class AutoTypeWindowMatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    static AutoTypeWindowMatcher* forDatabase(Database* db);
+
+    QList<AutoTypeMatch>
+    match(const QString& windowTitle, bool matchTitle, bool matchUrl, bool hideExpired = false);
+    void update();
+
+private:
+    explicit AutoTypeWindowMatcher(Database* db);
+
+    struct WindowMatcher
+    {
+        enum Type
+        {
+            Regex,
+            Wildcard,
+            Title,
+            Url
+        };
+
+        Type type;
+        QString literal;
+        // resolved URL and host of an URL matcher
+        QStringList parts;
+        QRegExp regex;
+        WildcardMatcher wildcard;
+        // empty for the effective sequence of the entry
+        QString sequence;
+    };
+
+    struct CompiledEntry
+    {
+        quint64 revision;
+        quint64 generation;
+        bool hasReferences;
+        bool enabled;
+        QString sequence;
+        QVector<WindowMatcher> matchers;
+    };
+
+    void compile(Entry* entry, CompiledEntry& compiled) const;
+    static bool matches(WindowMatcher& matcher, const QString& windowTitle);
+
+    Database* const m_db;
+    quint64 m_modificationCount = 0;
+    quint64 m_generation = 0;
+    bool m_valid = false;
+    QHash<Entry*, CompiledEntry> m_entries;
+    // entries in the order of the group tree
+    QList<Entry*> m_order;
+};
+
+#endif // KEEPASSXC_AUTOTYPEWINDOWMATCHER_H
@@ -17,80 +17,60 @@
 
 #include "WildcardMatcher.h"
 
-#include <QStringList>
-#include <utility>
+#include "core/Global.h"
 
 const QChar WildcardMatcher::Wildcard = '*';
 const Qt::CaseSensitivity WildcardMatcher::Sensitivity = Qt::CaseInsensitive;
 
-WildcardMatcher::WildcardMatcher(QString text)
-    : m_text(std::move(text))
+WildcardMatcher::WildcardMatcher(const QString& pattern)
+    : m_pattern(pattern)
 {
-}
-
-bool WildcardMatcher::match(const QString& pattern)
-{
-    m_pattern = pattern;
-
-    if (patternContainsWildcard()) {
-        return matchWithWildcards();
-    } else {
-        return patternEqualsText();
+    if (!m_pattern.contains(Wildcard)) {
+        m_longestPart = m_pattern;
+        return;
     }
-}
 
-bool WildcardMatcher::patternContainsWildcard()
-{
-    return m_pattern.contains(Wildcard);
-}
-
-bool WildcardMatcher::patternEqualsText()
-{
-    return m_text.compare(m_pattern, Sensitivity) == 0;
+    m_parts = m_pattern.split(Wildcard, QString::KeepEmptyParts);
+    Q_ASSERT(m_parts.size() >= 2);
+    for (const QString& part : asConst(m_parts)) {
+        if (part.size() > m_longestPart.size()) {
+            m_longestPart = part;
+        }
+    }
 }
 
-bool WildcardMatcher::matchWithWildcards()
+bool WildcardMatcher::match(const QString& text) const
 {
-    QStringList parts = m_pattern.split(Wildcard, QString::KeepEmptyParts);
-    Q_ASSERT(parts.size() >= 2);
+    if (m_parts.isEmpty()) {
+        return text.compare(m_pattern, Sensitivity) == 0;
+    }
 
-    if (startOrEndDoesNotMatch(parts)) {
+    if (!text.startsWith(m_parts.first(), Sensitivity) || !text.endsWith(m_parts.last(), Sensitivity)) {
         return false;
     }
 
-    return partsMatch(parts);
+    return partsMatch(text);
 }
 
-bool WildcardMatcher::startOrEndDoesNotMatch(const QStringList& parts)
+/**
+ * The longest literal part of the pattern, every matching text contains it.
+ * Callers can use it as a cheap pre-filter before calling match().
+ */
+const QString& WildcardMatcher::longestPart() const
 {
-    return !m_text.startsWith(parts.first(), Sensitivity) || !m_text.endsWith(parts.last(), Sensitivity);
+    return m_longestPart;
 }
 
-bool WildcardMatcher::partsMatch(const QStringList& parts)
+bool WildcardMatcher::partsMatch(const QString& text) const
 {
     int index = 0;
-    for (const QString& part : parts) {
-        int matchIndex = getMatchIndex(part, index);
-        if (noMatchFound(matchIndex)) {
+    for (const QString& part : m_parts) {
+        int matchIndex = text.indexOf(part, index, Sensitivity);
+        if (matchIndex == -1) {
             return false;
         }
-        index = calculateNewIndex(matchIndex, part.length());
+        index = matchIndex + part.length();
     }
 
     return true;
 }
-
-int WildcardMatcher::getMatchIndex(const QString& part, int startIndex)
-{
-    return m_text.indexOf(part, startIndex, Sensitivity);
-}
-
-bool WildcardMatcher::noMatchFound(int index)
-{
-    return index == -1;
-}
-
-int WildcardMatcher::calculateNewIndex(int matchIndex, int partLength)
-{
-    return matchIndex + partLength;
-}
@@ -20,27 +20,28 @@
 
 #include <QStringList>
 
+/**
+ * Case insensitive matcher for window patterns where '*' matches any
+ * sequence of characters. The pattern is split once on construction so
+ * the same matcher can be applied to any number of texts.
+ */
 class WildcardMatcher
 {
 public:
-    explicit WildcardMatcher(QString text);
-    bool match(const QString& pattern);
+    explicit WildcardMatcher(const QString& pattern = QString());
+    bool match(const QString& text) const;
+    const QString& longestPart() const;
 
     static const QChar Wildcard;
 
 private:
-    bool patternEqualsText();
-    bool patternContainsWildcard();
-    bool matchWithWildcards();
-    bool startOrEndDoesNotMatch(const QStringList& parts);
-    bool partsMatch(const QStringList& parts);
-    int getMatchIndex(const QString& part, int startIndex);
-    bool noMatchFound(int index);
-    int calculateNewIndex(int matchIndex, int partLength);
+    bool partsMatch(const QString& text) const;
 
     static const Qt::CaseSensitivity Sensitivity;
-    const QString m_text;
     QString m_pattern;
+    // empty if the pattern does not contain a wildcard
+    QStringList m_parts;
+    QString m_longestPart;
 };
 
 #endif // KEEPASSX_WILDCARDMATCHER_H
@@ -56,6 +56,7 @@ AutoTypePlatformX11::AutoTypePlatformX11()
     m_xkb = nullptr;
     m_remapKeycode = 0;
     m_currentRemapKeysym = NoSymbol;
+    m_burstMode = false;
     m_modifierMask = ControlMask | ShiftMask | Mod1Mask | Mod4Mask;
 
     m_loaded = true;
@@ -91,6 +92,9 @@ bool AutoTypePlatformX11::isAvailable()
 void AutoTypePlatformX11::unload()
 {
     // Restore the KeyboardMapping to its original state.
+    for (KeySym keysym : m_burstKeycodes.keys()) {
+        releaseBurstKeycode(keysym);
+    }
     if (m_currentRemapKeysym != NoSymbol) {
         AddKeysym(NoSymbol);
     }
@@ -618,6 +622,80 @@ int AutoTypePlatformX11::AddKeysym(KeySym keysym)
     return m_remapKeycode;
 }
 
+void AutoTypePlatformX11::releaseBurstKeycode(KeySym keysym)
+{
+    int keycode = m_burstKeycodes.take(keysym);
+    int inx = (keycode - m_minKeycode) * m_keysymPerKeycode;
+    m_keysymTable[inx] = NoSymbol;
+
+    XChangeKeyboardMapping(m_dpy, keycode, m_keysymPerKeycode, &m_keysymTable[inx], 1);
+    XFlush(m_dpy);
+}
+
+/*
+ * Remap all keysyms of a sequence which are not on the keyboard at once,
+ * each to its own free keycode. Typing them later needs no further remapping
+ * and only one keymap update has to be waited for. Keysyms which don't fit
+ * into the free keycodes are remapped one at a time as before.
+ */
+void AutoTypePlatformX11::prepareKeysyms(const QList<KeySym>& keysyms)
+{
+    QList<KeySym> missing;
+    QSet<KeySym> kept;
+    for (KeySym keysym : keysyms) {
+        if (keysym == NoSymbol || kept.contains(keysym) || missing.contains(keysym)) {
+            continue;
+        }
+        if (m_burstKeycodes.contains(keysym)) {
+            kept.insert(keysym);
+            continue;
+        }
+
+        unsigned int mask;
+        int keycode = XKeysymToKeycode(m_dpy, keysym);
+        if (!keycode || !keysymModifiers(keysym, keycode, &mask)) {
+            missing.append(keysym);
+        }
+    }
+
+    bool changed = false;
+    for (KeySym keysym : m_burstKeycodes.keys()) {
+        if (!kept.contains(keysym)) {
+            releaseBurstKeycode(keysym);
+            changed = true;
+        }
+    }
+
+    // the dedicated remap keycode stays free for the keysyms which don't fit
+    for (int keycode = m_minKeycode; keycode <= m_maxKeycode && !missing.isEmpty(); keycode++) {
+        int inx = (keycode - m_minKeycode) * m_keysymPerKeycode;
+        if (keycode == static_cast<int>(m_remapKeycode) || m_keysymTable[inx] != NoSymbol) {
+            continue;
+        }
+
+        KeySym keysym = missing.takeFirst();
+        m_keysymTable[inx] = keysym;
+        m_burstKeycodes.insert(keysym, keycode);
+        XChangeKeyboardMapping(m_dpy, keycode, m_keysymPerKeycode, &m_keysymTable[inx], 1);
+        changed = true;
+    }
+
+    if (changed) {
+        XFlush(m_dpy);
+        updateKeymap();
+    }
+}
+
+/*
+ * In burst mode key events are not synchronized one by one, the events
+ * of a key and its modifiers are flushed together.
+ */
+void AutoTypePlatformX11::setBurstMode(bool burst)
+{
+    m_burstMode = burst;
+    XFlush(m_dpy);
+}
+
 /*
  * Send event to the focused window.
  * If input focus is specified explicitly, select the window
@@ -625,11 +703,15 @@ int AutoTypePlatformX11::AddKeysym(KeySym keysym)
  */
 void AutoTypePlatformX11::SendKeyEvent(unsigned keycode, bool press)
 {
-    XSync(m_dpy, False);
+    if (!m_burstMode) {
+        XSync(m_dpy, False);
+    }
     int (*oldHandler)(Display*, XErrorEvent*) = XSetErrorHandler(MyErrorHandler);
 
     XTestFakeKeyEvent(m_dpy, keycode, press, 0);
-    XFlush(m_dpy);
+    if (!m_burstMode) {
+        XFlush(m_dpy);
+    }
 
     XSetErrorHandler(oldHandler);
 }
@@ -654,6 +736,11 @@ void AutoTypePlatformX11::SendModifiers(unsigned int mask, bool press)
  */
 int AutoTypePlatformX11::GetKeycode(KeySym keysym, unsigned int* mask)
 {
+    auto burstKeycode = m_burstKeycodes.constFind(keysym);
+    if (burstKeycode != m_burstKeycodes.constEnd() && keysymModifiers(keysym, burstKeycode.value(), mask)) {
+        return burstKeycode.value();
+    }
+
     int keycode = XKeysymToKeycode(m_dpy, keysym);
 
     if (keycode && keysymModifiers(keysym, keycode, mask)) {
@@ -718,7 +805,9 @@ void AutoTypePlatformX11::SendKey(KeySym keysym, unsigned int modifiers)
     int root_x, root_y, x, y;
     unsigned int original_mask;
 
-    XSync(m_dpy, False);
+    if (!m_burstMode) {
+        XSync(m_dpy, False);
+    }
     XQueryPointer(m_dpy, m_rootWindow, &root, &child, &root_x, &root_y, &x, &y, &original_mask);
 
     // modifiers that need to be pressed but aren't
@@ -777,6 +866,10 @@ void AutoTypePlatformX11::SendKey(KeySym keysym, unsigned int modifiers)
         SendModifiers(LockMask, true);
         SendModifiers(LockMask, false);
     }
+
+    if (m_burstMode) {
+        XFlush(m_dpy);
+    }
 }
 
 int AutoTypePlatformX11::MyErrorHandler(Display* my_dpy, XErrorEvent* event)
@@ -791,11 +884,78 @@ int AutoTypePlatformX11::MyErrorHandler(Display* my_dpy, XErrorEvent* event)
     return 0;
 }
 
+namespace
+{
+    /**
+     * Collects the keysyms a sequence is going to type
+     */
+    class KeySymCollector : public AutoTypeExecutor
+    {
+    public:
+        explicit KeySymCollector(AutoTypePlatformX11* platform)
+            : m_platform(platform)
+        {
+        }
+
+        void execChar(AutoTypeChar* action) override
+        {
+            keysyms.append(m_platform->charToKeySym(action->character));
+        }
+
+        void execKey(AutoTypeKey* action) override
+        {
+            keysyms.append(m_platform->keyToKeySym(action->key));
+        }
+
+        void execDelay(AutoTypeDelay* action) override
+        {
+            Q_UNUSED(action);
+        }
+
+        void execClearField(AutoTypeClearField* action) override
+        {
+            Q_UNUSED(action);
+            keysyms.append(m_platform->keyToKeySym(Qt::Key_Home));
+            keysyms.append(m_platform->keyToKeySym(Qt::Key_End));
+            keysyms.append(m_platform->keyToKeySym(Qt::Key_Backspace));
+        }
+
+        QList<KeySym> keysyms;
+
+    private:
+        AutoTypePlatformX11* const m_platform;
+    };
+} // namespace
+
 AutoTypeExecutorX11::AutoTypeExecutorX11(AutoTypePlatformX11* platform)
     : m_platform(platform)
+    , m_burst(false)
 {
 }
 
+void AutoTypeExecutorX11::execBegin(const QList<AutoTypeAction*>& actions, bool burst)
+{
+    m_burst = burst;
+    if (!m_burst) {
+        return;
+    }
+
+    KeySymCollector collector(m_platform);
+    for (AutoTypeAction* action : actions) {
+        action->accept(&collector);
+    }
+    m_platform->prepareKeysyms(collector.keysyms);
+    m_platform->setBurstMode(true);
+}
+
+void AutoTypeExecutorX11::execEnd()
+{
+    if (m_burst) {
+        m_platform->setBurstMode(false);
+        m_burst = false;
+    }
+}
+
 void AutoTypeExecutorX11::execChar(AutoTypeChar* action)
 {
     m_platform->SendKey(m_platform->charToKeySym(action->character));
@@ -810,6 +970,13 @@ void AutoTypeExecutorX11::execClearField(AutoTypeClearField* action = nullptr)
 {
     Q_UNUSED(action);
 
+    if (m_burst) {
+        m_platform->SendKey(m_platform->keyToKeySym(Qt::Key_Home), static_cast<unsigned int>(ControlMask));
+        m_platform->SendKey(m_platform->keyToKeySym(Qt::Key_End), static_cast<unsigned int>(ControlMask | ShiftMask));
+        m_platform->SendKey(m_platform->keyToKeySym(Qt::Key_Backspace));
+        return;
+    }
+
     timespec ts;
     ts.tv_sec = 0;
     ts.tv_nsec = 25 * 1000 * 1000;
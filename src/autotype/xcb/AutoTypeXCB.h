@@ -21,6 +21,7 @@
 #define KEEPASSX_AUTOTYPEXCB_H
 
 #include <QApplication>
+#include <QHash>
 #include <QSet>
 #include <QWidget>
 #include <QX11Info>
@@ -58,6 +59,8 @@ public:
     KeySym keyToKeySym(Qt::Key key);
 
     void SendKey(KeySym keysym, unsigned int modifiers = 0);
+    void prepareKeysyms(const QList<KeySym>& keysyms);
+    void setBurstMode(bool burst);
 
 signals:
     void globalShortcutTriggered();
@@ -76,6 +79,7 @@ private:
     XkbDescPtr getKeyboard();
     void updateKeymap();
     bool isRemapKeycodeValid();
+    void releaseBurstKeycode(KeySym keysym);
     int AddKeysym(KeySym keysym);
     void AddModifier(KeySym keysym);
     void SendKeyEvent(unsigned keycode, bool press);
@@ -115,6 +119,9 @@ private:
     /* dedicated keycode for remapped keys */
     unsigned int m_remapKeycode;
     KeySym m_currentRemapKeysym;
+    /* keycodes remapped up front for a whole sequence in burst mode */
+    QHash<KeySym, int> m_burstKeycodes;
+    bool m_burstMode;
     KeyCode m_modifier_keycode[N_MOD_INDICES];
     bool m_loaded;
 };
@@ -124,12 +131,15 @@ class AutoTypeExecutorX11 : public AutoTypeExecutor
 public:
     explicit AutoTypeExecutorX11(AutoTypePlatformX11* platform);
 
+    void execBegin(const QList<AutoTypeAction*>& actions, bool burst) override;
+    void execEnd() override;
     void execChar(AutoTypeChar* action) override;
     void execKey(AutoTypeKey* action) override;
     void execClearField(AutoTypeClearField* action) override;
 
 private:
     AutoTypePlatformX11* const m_platform;
+    bool m_burst;
 };
 
 #endif // KEEPASSX_AUTOTYPEXCB_H
@@ -39,9 +39,24 @@ BrowserAccessControlDialog::~BrowserAccessControlDialog()
 
 void BrowserAccessControlDialog::setItems(const QList<Entry*>& items, const QString& urlString, bool httpAuth)
 {
-    QUrl url(urlString);
-    m_ui->siteLabel->setText(m_ui->siteLabel->text().arg(
-        url.toDisplayString(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment)));
+    setItems(items, QStringList(urlString), httpAuth);
+}
+
+/**
+ * Ask for access to the items on behalf of several sites at once, e.g. the
+ * frames of a single page.
+ */
+void BrowserAccessControlDialog::setItems(const QList<Entry*>& items, const QStringList& urlStrings, bool httpAuth)
+{
+    QStringList sites;
+    for (const auto& urlString : urlStrings) {
+        const auto site = QUrl(urlString).toDisplayString(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery
+                                                          | QUrl::RemoveFragment);
+        if (!sites.contains(site)) {
+            sites.append(site);
+        }
+    }
+    m_ui->siteLabel->setText(m_ui->siteLabel->text().arg(sites.join(", ")));
 
     m_ui->rememberDecisionCheckBox->setVisible(!httpAuth);
     m_ui->rememberDecisionCheckBox->setChecked(false);
@@ -39,6 +39,7 @@ public:
     ~BrowserAccessControlDialog() override;
 
     void setItems(const QList<Entry*>& items, const QString& urlString, bool httpAuth);
+    void setItems(const QList<Entry*>& items, const QStringList& urlStrings, bool httpAuth);
     bool remember() const;
 
     QList<QTableWidgetItem*> getSelectedEntries() const;
@@ -21,6 +21,7 @@
 #include "BrowserShared.h"
 #include "config-keepassx.h"
 #include "core/Global.h"
+#include "core/Trace.h"
 
 #include <QJsonDocument>
 #include <QJsonParseError>
@@ -52,8 +53,14 @@ namespace
     };
 }
 
+BrowserAction::~BrowserAction()
+{
+    clearSharedKey();
+}
+
 QJsonObject BrowserAction::processClientMessage(const QJsonObject& json)
 {
+    TRACE_SCOPE("BrowserAction::processClientMessage");
     if (json.isEmpty()) {
         return getErrorReply("", ERROR_KEEPASS_EMPTY_MESSAGE_RECEIVED);
     }
@@ -97,6 +104,10 @@ QJsonObject BrowserAction::handleAction(const QJsonObject& json)
         return handleTestAssociate(json, action);
     } else if (action.compare("get-logins", Qt::CaseSensitive) == 0) {
         return handleGetLogins(json, action);
+    } else if (action.compare("get-logins-batch", Qt::CaseSensitive) == 0) {
+        return handleGetLoginsBatch(json, action);
+    } else if (action.compare("anticipate", Qt::CaseSensitive) == 0) {
+        return handleAnticipate(json, action);
     } else if (action.compare("generate-password", Qt::CaseSensitive) == 0) {
         return handleGeneratePassword(json, action);
     } else if (action.compare("set-login", Qt::CaseSensitive) == 0) {
@@ -135,6 +146,7 @@ QJsonObject BrowserAction::handleChangePublicKeys(const QJsonObject& json, const
         return getErrorReply(action, ERROR_KEEPASS_ENCRYPTION_KEY_UNRECOGNIZED);
     }
 
+    clearSharedKey();
     m_clientPublicKey = clientPublicKey;
     m_publicKey = publicKey;
     m_secretKey = secretKey;
@@ -284,7 +296,10 @@ QJsonObject BrowserAction::handleGetLogins(const QJsonObject& json, const QStrin
     const QString formUrl = decrypted.value("submitUrl").toString();
     const QString auth = decrypted.value("httpAuth").toString();
     const bool httpAuth = auth.compare(TRUE_STR, Qt::CaseSensitive) == 0 ? true : false;
-    const QJsonArray users = browserService()->findMatchingEntries(id, siteUrl, formUrl, "", keyList, httpAuth);
+    const QStringList fields = getRequestedFields(decrypted);
+    const QString uuid = decrypted.value("uuid").toString();
+    const QJsonArray users =
+        browserService()->findMatchingEntries(id, siteUrl, formUrl, "", keyList, httpAuth, fields, uuid);
 
     if (users.isEmpty()) {
         return getErrorReply(action, ERROR_KEEPASS_NO_LOGINS_FOUND);
@@ -301,6 +316,116 @@ QJsonObject BrowserAction::handleGetLogins(const QJsonObject& json, const QStrin
     return buildResponse(action, message, newNonce);
 }
 
+QJsonObject BrowserAction::handleGetLoginsBatch(const QJsonObject& json, const QString& action)
+{
+    const QString hash = browserService()->getDatabaseHash();
+    const QString nonce = json.value("nonce").toString();
+    const QString encrypted = json.value("message").toString();
+
+    if (!m_associated) {
+        return getErrorReply(action, ERROR_KEEPASS_ASSOCIATION_FAILED);
+    }
+
+    const QJsonObject decrypted = decryptMessage(encrypted, nonce);
+    if (decrypted.isEmpty()) {
+        return getErrorReply(action, ERROR_KEEPASS_CANNOT_DECRYPT_MESSAGE);
+    }
+
+    StringPairList urlList;
+    for (const QJsonValue val : decrypted.value("urls").toArray()) {
+        const QJsonObject urlObject = val.toObject();
+        const QString siteUrl = urlObject.value("url").toString();
+        if (siteUrl.isEmpty()) {
+            return getErrorReply(action, ERROR_KEEPASS_NO_URL_PROVIDED);
+        }
+        urlList.push_back(qMakePair(siteUrl, urlObject.value("submitUrl").toString()));
+    }
+
+    if (urlList.isEmpty()) {
+        return getErrorReply(action, ERROR_KEEPASS_NO_URL_PROVIDED);
+    }
+
+    const QJsonArray keys = decrypted.value("keys").toArray();
+
+    StringPairList keyList;
+    for (const QJsonValue val : keys) {
+        const QJsonObject keyObject = val.toObject();
+        keyList.push_back(qMakePair(keyObject.value("id").toString(), keyObject.value("key").toString()));
+    }
+
+    const QString id = decrypted.value("id").toString();
+    const QString auth = decrypted.value("httpAuth").toString();
+    const bool httpAuth = auth.compare(TRUE_STR, Qt::CaseSensitive) == 0 ? true : false;
+    const QStringList fields = getRequestedFields(decrypted);
+    const QList<QJsonArray> users =
+        browserService()->findMatchingEntries(id, urlList, "", keyList, httpAuth, fields);
+
+    int count = 0;
+    QJsonArray results;
+    for (int i = 0; i < urlList.size(); ++i) {
+        QJsonObject result;
+        result["url"] = urlList[i].first;
+        result["submitUrl"] = urlList[i].second;
+        result["count"] = users[i].count();
+        result["entries"] = users[i];
+        results.append(result);
+        count += users[i].count();
+    }
+
+    if (count == 0) {
+        return getErrorReply(action, ERROR_KEEPASS_NO_LOGINS_FOUND);
+    }
+
+    const QString newNonce = incrementNonce(nonce);
+
+    QJsonObject message = buildMessage(newNonce);
+    message["count"] = count;
+    message["results"] = results;
+    message["hash"] = hash;
+    message["id"] = id;
+
+    return buildResponse(action, message, newNonce);
+}
+
+QJsonObject BrowserAction::handleAnticipate(const QJsonObject& json, const QString& action)
+{
+    const QString hash = browserService()->getDatabaseHash();
+    const QString nonce = json.value("nonce").toString();
+    const QString encrypted = json.value("message").toString();
+
+    if (!m_associated) {
+        return getErrorReply(action, ERROR_KEEPASS_ASSOCIATION_FAILED);
+    }
+
+    const QJsonObject decrypted = decryptMessage(encrypted, nonce);
+    if (decrypted.isEmpty()) {
+        return getErrorReply(action, ERROR_KEEPASS_CANNOT_DECRYPT_MESSAGE);
+    }
+
+    const QString siteUrl = decrypted.value("url").toString();
+    if (siteUrl.isEmpty()) {
+        return getErrorReply(action, ERROR_KEEPASS_NO_URL_PROVIDED);
+    }
+
+    StringPairList keyList;
+    for (const QJsonValue val : decrypted.value("keys").toArray()) {
+        const QJsonObject keyObject = val.toObject();
+        keyList.push_back(qMakePair(keyObject.value("id").toString(), keyObject.value("key").toString()));
+    }
+
+    const QString id = decrypted.value("id").toString();
+    const QString formUrl = decrypted.value("submitUrl").toString();
+    browserService()->anticipateEntries(siteUrl, formUrl, keyList);
+
+    const QString newNonce = incrementNonce(nonce);
+
+    QJsonObject message = buildMessage(newNonce);
+    message["hash"] = hash;
+    message["id"] = id;
+
+    return buildResponse(action, message, newNonce);
+}
+
 QJsonObject BrowserAction::handleGeneratePassword(const QJsonObject& json, const QString& action)
 {
     auto nonce = json.value("nonce").toString();
@@ -598,22 +723,20 @@ QString BrowserAction::encrypt(const QString& plaintext, const QString& nonce)
 {
     const QByteArray ma = plaintext.toUtf8();
     const QByteArray na = base64Decode(nonce);
-    const QByteArray ca = base64Decode(m_clientPublicKey);
-    const QByteArray sa = base64Decode(m_secretKey);
+    const QByteArray& key = sharedKey();
 
     std::vector<unsigned char> m(ma.cbegin(), ma.cend());
     std::vector<unsigned char> n(na.cbegin(), na.cend());
-    std::vector<unsigned char> ck(ca.cbegin(), ca.cend());
-    std::vector<unsigned char> sk(sa.cbegin(), sa.cend());
 
     std::vector<unsigned char> e;
     e.resize(BrowserShared::NATIVEMSG_MAX_LENGTH);
 
-    if (m.empty() || n.empty() || ck.empty() || sk.empty()) {
+    if (m.empty() || n.size() != crypto_box_NONCEBYTES || key.isEmpty()) {
         return QString();
     }
 
-    if (crypto_box_easy(e.data(), m.data(), m.size(), n.data(), ck.data(), sk.data()) == 0) {
+    auto k = reinterpret_cast<const unsigned char*>(key.constData());
+    if (crypto_box_easy_afternm(e.data(), m.data(), m.size(), n.data(), k) == 0) {
         QByteArray res = getQByteArray(e.data(), (crypto_box_MACBYTES + ma.length()));
         return res.toBase64();
     }
@@ -625,28 +748,70 @@ QByteArray BrowserAction::decrypt(const QString& encrypted, const QString& nonce
 {
     const QByteArray ma = base64Decode(encrypted);
     const QByteArray na = base64Decode(nonce);
-    const QByteArray ca = base64Decode(m_clientPublicKey);
-    const QByteArray sa = base64Decode(m_secretKey);
+    const QByteArray& key = sharedKey();
 
     std::vector<unsigned char> m(ma.cbegin(), ma.cend());
     std::vector<unsigned char> n(na.cbegin(), na.cend());
-    std::vector<unsigned char> ck(ca.cbegin(), ca.cend());
-    std::vector<unsigned char> sk(sa.cbegin(), sa.cend());
 
     std::vector<unsigned char> d;
     d.resize(BrowserShared::NATIVEMSG_MAX_LENGTH);
 
-    if (m.empty() || n.empty() || ck.empty() || sk.empty()) {
+    if (m.empty() || n.size() != crypto_box_NONCEBYTES || key.isEmpty()) {
         return QByteArray();
     }
 
-    if (crypto_box_open_easy(d.data(), m.data(), ma.length(), n.data(), ck.data(), sk.data()) == 0) {
+    auto k = reinterpret_cast<const unsigned char*>(key.constData());
+    if (crypto_box_open_easy_afternm(d.data(), m.data(), ma.length(), n.data(), k) == 0) {
         return getQByteArray(d.data(), std::char_traits<char>::length(reinterpret_cast<const char*>(d.data())));
     }
 
     return QByteArray();
 }
 
+/**
+ * Get the precomputed shared key for the current key pair. The Curve25519
+ * scalar multiplication is only done again after the keys have changed.
+ *
+ * @return shared key or an empty array if the keys are invalid
+ */
+const QByteArray& BrowserAction::sharedKey()
+{
+    if (!m_sharedKey.isEmpty() && m_sharedKeyClientPublicKey == m_clientPublicKey
+        && m_sharedKeySecretKey == m_secretKey) {
+        return m_sharedKey;
+    }
+
+    clearSharedKey();
+
+    const QByteArray ca = base64Decode(m_clientPublicKey);
+    QByteArray sa = base64Decode(m_secretKey);
+    if (ca.size() == crypto_box_PUBLICKEYBYTES && sa.size() == crypto_box_SECRETKEYBYTES) {
+        m_sharedKey.resize(crypto_box_BEFORENMBYTES);
+        if (crypto_box_beforenm(reinterpret_cast<unsigned char*>(m_sharedKey.data()),
+                                reinterpret_cast<const unsigned char*>(ca.constData()),
+                                reinterpret_cast<const unsigned char*>(sa.constData()))
+            == 0) {
+            m_sharedKeyClientPublicKey = m_clientPublicKey;
+            m_sharedKeySecretKey = m_secretKey;
+        } else {
+            clearSharedKey();
+        }
+    }
+    sodium_memzero(sa.data(), static_cast<size_t>(sa.size()));
+
+    return m_sharedKey;
+}
+
+void BrowserAction::clearSharedKey()
+{
+    if (!m_sharedKey.isEmpty()) {
+        sodium_memzero(m_sharedKey.data(), static_cast<size_t>(m_sharedKey.size()));
+    }
+    m_sharedKey.clear();
+    m_sharedKeyClientPublicKey.clear();
+    m_sharedKeySecretKey.clear();
+}
+
 QString BrowserAction::getBase64FromKey(const uchar* array, const uint len)
 {
     return getQByteArray(array, len).toBase64();
@@ -690,3 +855,19 @@ QString BrowserAction::incrementNonce(const QString& nonce)
     sodium_increment(n.data(), n.size());
     return getQByteArray(n.data(), n.size()).toBase64();
 }
+
+/**
+ * Fields of the entries a get-logins request asks for, e.g. only "name"
+ * and "login" for a picker. The secrets of the picked entry can then be
+ * requested with its "uuid".
+ *
+ * @return requested fields, empty for all fields
+ */
+QStringList BrowserAction::getRequestedFields(const QJsonObject& message) const
+{
+    QStringList fields;
+    for (const QJsonValue val : message.value("fields").toArray()) {
+        fields.append(val.toString());
+    }
+    return fields;
+}
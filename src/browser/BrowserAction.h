@@ -25,7 +25,7 @@ class BrowserAction
 {
 public:
     explicit BrowserAction() = default;
-    ~BrowserAction() = default;
+    ~BrowserAction();
 
     QJsonObject processClientMessage(const QJsonObject& json);
 
@@ -36,6 +36,8 @@ private:
     QJsonObject handleAssociate(const QJsonObject& json, const QString& action);
     QJsonObject handleTestAssociate(const QJsonObject& json, const QString& action);
     QJsonObject handleGetLogins(const QJsonObject& json, const QString& action);
+    QJsonObject handleGetLoginsBatch(const QJsonObject& json, const QString& action);
+    QJsonObject handleAnticipate(const QJsonObject& json, const QString& action);
     QJsonObject handleGeneratePassword(const QJsonObject& json, const QString& action);
     QJsonObject handleSetLogin(const QJsonObject& json, const QString& action);
     QJsonObject handleLockDatabase(const QJsonObject& json, const QString& action);
@@ -52,6 +54,8 @@ private:
     QJsonObject decryptMessage(const QString& message, const QString& nonce);
     QString encrypt(const QString& plaintext, const QString& nonce);
     QByteArray decrypt(const QString& encrypted, const QString& nonce);
+    const QByteArray& sharedKey();
+    void clearSharedKey();
 
     QString getBase64FromKey(const uchar* array, const uint len);
     QByteArray getQByteArray(const uchar* array, const uint len) const;
@@ -59,6 +63,7 @@ private:
     QJsonObject getJsonObject(const QByteArray& ba) const;
     QByteArray base64Decode(const QString& str);
     QString incrementNonce(const QString& nonce);
+    QStringList getRequestedFields(const QJsonObject& message) const;
 
 private:
     QString m_clientPublicKey;
@@ -66,6 +71,11 @@ private:
     QString m_secretKey;
     bool m_associated = false;
 
+    // crypto_box_beforenm() result for the key pair it was computed from
+    QByteArray m_sharedKey;
+    QString m_sharedKeyClientPublicKey;
+    QString m_sharedKeySecretKey;
+
     friend class TestBrowser;
 };
 
@@ -19,10 +19,34 @@
 #include "BrowserEntryConfig.h"
 #include "core/Entry.h"
 #include "core/EntryAttributes.h"
+#include "core/MemoryUsage.h"
 #include <QtCore>
 
 static const char KEEPASSXCBROWSER_NAME[] = "KeePassXC-Browser Settings";
 
+namespace
+{
+    struct ParsedConfig
+    {
+        QSet<QString> allowedHosts;
+        QSet<QString> deniedHosts;
+        QString realm;
+    };
+
+    /**
+     * Configs parsed before, by their JSON. Entries usually keep their
+     * config for a long time and many share the same one, and a changed
+     * config is simply a new key.
+     */
+    QCache<QString, ParsedConfig>& parsedConfigs()
+    {
+        static QCache<QString, ParsedConfig> cache(1024);
+        static const bool registered = MemoryUsage::registerCache([] { cache.clear(); });
+        Q_UNUSED(registered);
+        return cache;
+    }
+} // namespace
+
 BrowserEntryConfig::BrowserEntryConfig(QObject* parent)
     : QObject(parent)
 {
@@ -80,6 +104,11 @@ void BrowserEntryConfig::setRealm(const QString& realm)
     m_realm = realm;
 }
 
+/**
+ * Replace the config with the one stored in the entry.
+ *
+ * @return false if the entry has no valid config
+ */
 bool BrowserEntryConfig::load(const Entry* entry)
 {
     QString s = entry->customData()->value(KEEPASSXCBROWSER_NAME);
@@ -87,15 +116,28 @@ bool BrowserEntryConfig::load(const Entry* entry)
         return false;
     }
 
+    const auto* parsed = parsedConfigs().object(s);
+    if (parsed) {
+        m_allowedHosts = parsed->allowedHosts;
+        m_deniedHosts = parsed->deniedHosts;
+        m_realm = parsed->realm;
+        return true;
+    }
+
     QJsonDocument doc = QJsonDocument::fromJson(s.toUtf8());
     if (doc.isNull()) {
         return false;
     }
 
+    m_allowedHosts.clear();
+    m_deniedHosts.clear();
+    m_realm.clear();
     QVariantMap map = doc.object().toVariantMap();
     for (QVariantMap::const_iterator iter = map.cbegin(); iter != map.cend(); ++iter) {
         setProperty(iter.key().toLatin1(), iter.value());
     }
+
+    parsedConfigs().insert(s, new ParsedConfig{m_allowedHosts, m_deniedHosts, m_realm});
     return true;
 }
 
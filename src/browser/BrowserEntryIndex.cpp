@@ -0,0 +1,168 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrowserEntryIndex.h"
+
+#include "BrowserService.h"
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+
+#include <algorithm>
+
+BrowserEntryIndex::BrowserEntryIndex(Database* db, const KeyFunction& urlKey)
+    : QObject(db)
+    , m_db(db)
+    , m_urlKey(urlKey)
+{
+}
+
+/**
+ * @param db database to index
+ * @param urlKey base domain of an entry URL, empty if it can't match any site
+ * @return the index of the database, created on first use
+ */
+BrowserEntryIndex* BrowserEntryIndex::forDatabase(Database* db, const KeyFunction& urlKey)
+{
+    auto* index = db->findChild<BrowserEntryIndex*>(QString(), Qt::FindDirectChildrenOnly);
+    if (!index) {
+        index = new BrowserEntryIndex(db, urlKey);
+    }
+    return index;
+}
+
+/**
+ * Entries outside of the recycle bin that have a URL with the given base
+ * domain, in the order of the group tree.
+ *
+ * @param key base domain
+ * @return candidate entries, still to be matched against the full URL
+ */
+QList<Entry*> BrowserEntryIndex::candidates(const QString& key)
+{
+    update();
+
+    QList<Entry*> result;
+    const auto entries = m_entriesByKey.constFind(key);
+    if (entries == m_entriesByKey.constEnd()) {
+        return result;
+    }
+
+    result.reserve(entries->size());
+    for (Entry* entry : *entries) {
+        result.append(entry);
+    }
+    std::sort(result.begin(), result.end(), [this](Entry* lhs, Entry* rhs) {
+        return m_entries.constFind(lhs)->order < m_entries.constFind(rhs)->order;
+    });
+    return result;
+}
+
+/**
+ * @return number of indexed entries
+ */
+int BrowserEntryIndex::size() const
+{
+    return m_entries.size();
+}
+
+/**
+ * Re-index the entries that changed since the last update, if the
+ * database was modified.
+ */
+void BrowserEntryIndex::update()
+{
+    if (m_valid && m_modificationCount == m_db->modificationCount()) {
+        return;
+    }
+
+    ++m_generation;
+    int order = 0;
+    if (m_db->rootGroup()) {
+        m_db->rootGroup()->forEachEntryRecursive(
+            [this, &order](Entry* entry) -> bool {
+                updateEntry(entry, order++);
+                return true;
+            },
+            true);
+    }
+
+    // Drop the entries that were not visited: removed, recycled or deleted
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->generation != m_generation) {
+            remove(it.key(), it.value());
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    m_modificationCount = m_db->modificationCount();
+    m_valid = true;
+}
+
+void BrowserEntryIndex::updateEntry(Entry* entry, int order)
+{
+    auto it = m_entries.find(entry);
+    if (it != m_entries.end()) {
+        it->generation = m_generation;
+        it->order = order;
+        if (it->revision == entry->revision()) {
+            return;
+        }
+        remove(entry, it.value());
+        m_entries.erase(it);
+    }
+
+    IndexedEntry indexed;
+    indexed.revision = entry->revision();
+    indexed.generation = m_generation;
+    indexed.order = order;
+
+    QStringList urls(entry->url());
+    const EntryAttributes* attributes = entry->attributes();
+    for (const auto& key : attributes->keys()) {
+        if (key.startsWith(BrowserService::ADDITIONAL_URL)) {
+            urls.append(attributes->value(key));
+        }
+    }
+    for (const auto& url : asConst(urls)) {
+        if (url.isEmpty()) {
+            continue;
+        }
+        const auto key = m_urlKey(url);
+        if (!key.isEmpty() && !indexed.keys.contains(key)) {
+            indexed.keys.append(key);
+            m_entriesByKey[key].insert(entry);
+        }
+    }
+
+    m_entries.insert(entry, indexed);
+}
+
+void BrowserEntryIndex::remove(Entry* entry, const IndexedEntry& indexed)
+{
+    for (const auto& key : indexed.keys) {
+        auto entries = m_entriesByKey.find(key);
+        if (entries != m_entriesByKey.end()) {
+            entries->remove(entry);
+            if (entries->isEmpty()) {
+                m_entriesByKey.erase(entries);
+            }
+        }
+    }
+}
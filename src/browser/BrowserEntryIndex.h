@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_BROWSERENTRYINDEX_H
+#define KEEPASSXC_BROWSERENTRYINDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+#include <functional>
+
+class Database;
+class Entry;
+
+/**
+ * Entries of a database by the base domains of their URL and additional
+ * URLs, so that looking up the logins of a site only has to match the
+ * entries of the same base domain.
+ *
+ * The index is owned by its database. It is brought up to date before a
+ * lookup whenever the database was modified: entries whose revision
+ * changed are re-indexed and entries that are gone are dropped. Once it is
+ * up to date, lookups only read the index and may run on any thread.
+ */
+class BrowserEntryIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<QString(const QString& url)> KeyFunction;
+
+    static BrowserEntryIndex* forDatabase(Database* db, const KeyFunction& urlKey);
+
+    QList<Entry*> candidates(const QString& key);
+    void update();
+    int size() const;
+
+private:
+    BrowserEntryIndex(Database* db, const KeyFunction& urlKey);
+
+    struct IndexedEntry
+    {
+        quint64 revision;
+        quint64 generation;
+        int order;
+        QStringList keys;
+    };
+
+    void updateEntry(Entry* entry, int order);
+    void remove(Entry* entry, const IndexedEntry& indexed);
+
+    Database* const m_db;
+    const KeyFunction m_urlKey;
+    quint64 m_modificationCount = 0;
+    quint64 m_generation = 0;
+    bool m_valid = false;
+    QHash<Entry*, IndexedEntry> m_entries;
+    QHash<QString, QSet<Entry*>> m_entriesByKey;
+};
+
+#endif // KEEPASSXC_BROWSERENTRYINDEX_H
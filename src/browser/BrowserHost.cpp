@@ -66,6 +66,7 @@ void BrowserHost::start()
 void BrowserHost::stop()
 {
     m_socketList.clear();
+    m_socketBuffers.clear();
     m_localServer->close();
 }
 
@@ -93,14 +94,19 @@ void BrowserHost::readProxyMessage()
         setsockopt(socketDesc, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<char*>(&max), sizeof(max));
     }
 
-    QJsonParseError error;
-    auto json = QJsonDocument::fromJson(socket->readAll(), &error);
-    if (json.isNull()) {
-        qWarning() << "Failed to read proxy message: " << error.errorString();
-        return;
-    }
+    // A read may hold a partial message or several pipelined ones
+    auto& buffer = m_socketBuffers[socket];
+    buffer.append(socket->readAll());
+    for (const auto& message : buffer.takeMessages()) {
+        QJsonParseError error;
+        auto json = QJsonDocument::fromJson(message, &error);
+        if (json.isNull()) {
+            qWarning() << "Failed to read proxy message: " << error.errorString();
+            continue;
+        }
 
-    emit clientMessageReceived(json.object());
+        emit clientMessageReceived(json.object());
+    }
 }
 
 void BrowserHost::sendClientMessage(const QJsonObject& json)
@@ -119,4 +125,5 @@ void BrowserHost::proxyDisconnected()
 {
     auto socket = qobject_cast<QLocalSocket*>(QObject::sender());
     m_socketList.removeOne(socket);
+    m_socketBuffers.remove(socket);
 }
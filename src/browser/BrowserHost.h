@@ -18,6 +18,9 @@
 #ifndef NATIVEMESSAGINGHOST_H
 #define NATIVEMESSAGINGHOST_H
 
+#include "BrowserShared.h"
+
+#include <QHash>
 #include <QJsonObject>
 #include <QObject>
 #include <QPointer>
@@ -49,6 +52,7 @@ private slots:
 private:
     QPointer<QLocalServer> m_localServer;
     QList<QLocalSocket*> m_socketList;
+    QHash<QLocalSocket*, BrowserShared::MessageBuffer> m_socketBuffers;
 };
 
 #endif // NATIVEMESSAGINGHOST_H
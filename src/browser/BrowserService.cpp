@@ -24,10 +24,12 @@
 #include <QMessageBox>
 #include <QProgressDialog>
 #include <QUuid>
+#include <QtConcurrent>
 
 #include "BrowserAccessControlDialog.h"
 #include "BrowserAction.h"
 #include "BrowserEntryConfig.h"
+#include "BrowserEntryIndex.h"
 #include "BrowserEntrySaveDialog.h"
 #include "BrowserHost.h"
 #include "BrowserService.h"
@@ -40,6 +42,7 @@
 #include "core/Tools.h"
 #include "gui/MainWindow.h"
 #include "gui/MessageBox.h"
+#include "totp/totp.h"
 #ifdef Q_OS_MACOS
 #include "gui/osutils/macutils/MacUtils.h"
 #endif
@@ -58,6 +61,8 @@ const QString BrowserService::OPTION_ONLY_HTTP_AUTH = QStringLiteral("BrowserOnl
 const QString BrowserService::OPTION_NOT_HTTP_AUTH = QStringLiteral("BrowserNotHttpAuth");
 // Multiple URL's
 const QString BrowserService::ADDITIONAL_URL = QStringLiteral("KP2A_URL");
+// Milliseconds a search prepared for an activated tab is used
+static const qint64 ANTICIPATED_SEARCH_TTL = 30000;
 
 Q_GLOBAL_STATIC(BrowserService, s_browserService);
 
@@ -68,6 +73,7 @@ BrowserService::BrowserService()
     , m_bringToFrontRequested(false)
     , m_prevWindowState(WindowState::Normal)
     , m_keepassBrowserUUID(Tools::hexToUuid("de887cc3036343b8974b5911b8816224"))
+    , m_parsedUrls(4096)
 {
     connect(m_browserHost, &BrowserHost::clientMessageReceived, this, &BrowserService::processClientMessage);
     setEnabled(browserSettings()->isEnabled());
@@ -200,6 +206,24 @@ QJsonObject BrowserService::getDatabaseGroups()
         return {};
     }
 
+    // The tree is cached until a group of the database changes
+    const Database* database = db.data();
+    if (!m_databaseGroups.contains(database)) {
+        auto invalidate = [this, database] { m_databaseGroups[database].rootGroup.clear(); };
+        connect(database, &Database::groupAdded, this, invalidate);
+        connect(database, &Database::groupRemoved, this, invalidate);
+        connect(database, &Database::groupMoved, this, invalidate);
+        connect(database, &Database::groupDataChanged, this, invalidate);
+        connect(database, &Database::groupModified, this, invalidate);
+        connect(database->metadata(), &Metadata::metadataModified, this, invalidate);
+        connect(database, &QObject::destroyed, this, [this, database] { m_databaseGroups.remove(database); });
+    }
+
+    auto& cached = m_databaseGroups[database];
+    if (cached.rootGroup == rootGroup) {
+        return cached.groups;
+    }
+
     QJsonObject root;
     root["name"] = rootGroup->name();
     root["uuid"] = Tools::uuidToHex(rootGroup->uuid());
@@ -211,6 +235,8 @@ QJsonObject BrowserService::getDatabaseGroups()
     QJsonObject result;
     result["groups"] = groups;
 
+    cached.rootGroup = rootGroup;
+    cached.groups = result;
     return result;
 }
 
@@ -376,18 +402,136 @@ QJsonArray BrowserService::findMatchingEntries(const QString& dbid,
                                                const QString& formUrlStr,
                                                const QString& realm,
                                                const StringPairList& keyList,
-                                               const bool httpAuth)
+                                               const bool httpAuth,
+                                               const QStringList& fields,
+                                               const QString& uuid)
+{
+    return findMatchingEntries(dbid, {qMakePair(siteUrlStr, formUrlStr)}, realm, keyList, httpAuth, fields, uuid)
+        .first();
+}
+
+/**
+ * Find the entries for several sites at once, e.g. the frames of a page.
+ * Entries that need a confirmation are confirmed in a single dialog.
+ *
+ * @param urls site and form URL of every site
+ * @param fields fields to return for every entry, all if empty
+ * @param uuid only return the entry with this UUID, e.g. to fetch the
+ *        secrets of the entry picked from a list of names
+ * @return the entries of every site, in the same order as the sites
+ */
+QList<QJsonArray> BrowserService::findMatchingEntries(const QString& dbid,
+                                                      const StringPairList& urls,
+                                                      const QString& realm,
+                                                      const StringPairList& keyList,
+                                                      const bool httpAuth,
+                                                      const QStringList& fields,
+                                                      const QString& uuid)
 {
     Q_UNUSED(dbid);
+
+    // Check entries for authorization
+    QVector<QList<Entry*>> pwEntries(urls.size());
+    QVector<QList<Entry*>> pwEntriesToConfirm(urls.size());
+    QList<Entry*> allEntriesToConfirm;
+    QHash<Entry*, StringPairList> entryHosts;
+    QStringList siteUrls;
+    for (int i = 0; i < urls.size(); ++i) {
+        const QString& siteUrlStr = urls[i].first;
+        const QString& formUrlStr = urls[i].second;
+        const QString siteHost = QUrl(siteUrlStr).host();
+        const QString formHost = QUrl(formUrlStr).host();
+        QList<Entry*> entries = searchEntries(siteUrlStr, formUrlStr, keyList);
+        if (!uuid.isEmpty()) {
+            QMutableListIterator<Entry*> it(entries);
+            while (it.hasNext()) {
+                if (it.next()->uuidToHex() != uuid) {
+                    it.remove();
+                }
+            }
+        }
+        checkEntries(entries,
+                     siteHost,
+                     formHost,
+                     realm,
+                     httpAuth,
+                     pwEntries[i],
+                     pwEntriesToConfirm[i]);
+
+        for (auto* entry : asConst(pwEntriesToConfirm[i])) {
+            if (!entryHosts.contains(entry)) {
+                allEntriesToConfirm.append(entry);
+            }
+            entryHosts[entry].append(qMakePair(siteHost, formHost));
+        }
+        if (!pwEntriesToConfirm[i].isEmpty()) {
+            siteUrls.append(siteUrlStr);
+        }
+    }
+
+    // Confirm entries
+    const QList<Entry*> selectedEntriesToConfirm =
+        confirmEntries(allEntriesToConfirm, siteUrls, entryHosts, realm, httpAuth);
+
+    QList<QJsonArray> results;
+    for (int i = 0; i < urls.size(); ++i) {
+        for (auto* entry : asConst(pwEntriesToConfirm[i])) {
+            if (selectedEntriesToConfirm.contains(entry)) {
+                pwEntries[i].append(entry);
+            }
+        }
+
+        // Ensure that database is not locked when the popup was visible
+        if (pwEntries[i].isEmpty() || !isDatabaseOpened()) {
+            results.append(QJsonArray());
+            continue;
+        }
+
+        // Sort results
+        const auto sortedEntries = sortEntries(pwEntries[i], urls[i].first, urls[i].second);
+
+        // Generate the TOTPs of all entries in one pass
+        const bool withTotp = fields.isEmpty() || fields.contains("totp");
+        QList<QSharedPointer<Totp::Settings>> totpSettings;
+        for (auto* entry : sortedEntries) {
+            if (withTotp && entry->hasTotp()) {
+                totpSettings.append(entry->totpSettings());
+            }
+        }
+        const auto totps = Totp::generateTotps(totpSettings);
+
+        // Fill the list
+        QJsonArray result;
+        int totpIndex = 0;
+        for (auto* entry : sortedEntries) {
+            QJsonObject res = prepareEntry(entry, fields);
+            if (withTotp && entry->hasTotp()) {
+                res["totp"] = totps[totpIndex++].first;
+            }
+            result.append(res);
+        }
+        results.append(result);
+    }
+
+    return results;
+}
+
+/**
+ * Split the entries found for a site into the ones that may be handed out
+ * and the ones that need a confirmation, dropping the denied ones.
+ */
+void BrowserService::checkEntries(const QList<Entry*>& entries,
+                                  const QString& siteHost,
+                                  const QString& formHost,
+                                  const QString& realm,
+                                  const bool httpAuth,
+                                  QList<Entry*>& pwEntries,
+                                  QList<Entry*>& pwEntriesToConfirm)
+{
     const bool alwaysAllowAccess = browserSettings()->alwaysAllowAccess();
     const bool ignoreHttpAuth = browserSettings()->httpAuthPermission();
-    const QString siteHost = QUrl(siteUrlStr).host();
-    const QString formHost = QUrl(formUrlStr).host();
 
-    // Check entries for authorization
-    QList<Entry*> pwEntriesToConfirm;
-    QList<Entry*> pwEntries;
-    for (auto* entry : searchEntries(siteUrlStr, formUrlStr, keyList)) {
+    for (auto* entry : entries) {
         if (entry->customData()->contains(BrowserService::OPTION_HIDE_ENTRY)
             && entry->customData()->value(BrowserService::OPTION_HIDE_ENTRY) == TRUE_STR) {
             continue;
@@ -426,33 +570,6 @@ QJsonArray BrowserService::findMatchingEntries(const QString& dbid,
             break;
         }
     }
-
-    // Confirm entries
-    QList<Entry*> selectedEntriesToConfirm =
-        confirmEntries(pwEntriesToConfirm, siteUrlStr, siteHost, formHost, realm, httpAuth);
-    if (!selectedEntriesToConfirm.isEmpty()) {
-        pwEntries.append(selectedEntriesToConfirm);
-    }
-
-    if (pwEntries.isEmpty()) {
-        return {};
-    }
-
-    // Ensure that database is not locked when the popup was visible
-    if (!isDatabaseOpened()) {
-        return {};
-    }
-
-    // Sort results
-    pwEntries = sortEntries(pwEntries, siteUrlStr, formUrlStr);
-
-    // Fill the list
-    QJsonArray result;
-    for (auto* entry : pwEntries) {
-        result.append(prepareEntry(entry));
-    }
-
-    return result;
 }
 
 void BrowserService::addEntry(const QString& dbid,
@@ -585,46 +702,67 @@ BrowserService::searchEntries(const QSharedPointer<Database>& db, const QString&
         return entries;
     }
 
-    for (const auto& group : rootGroup->groupsRecursive(true)) {
-        if (group->isRecycled() || !group->resolveSearchingEnabled()) {
-            continue;
-        }
-
-        for (auto* entry : group->entries()) {
-            if (entry->isRecycled()) {
+    auto addIfMatching = [&](Entry* entry) {
+        // Search for additional URL's starting with KP2A_URL
+        for (const auto& key : entry->attributes()->keys()) {
+            if (key.startsWith(ADDITIONAL_URL) && handleURL(entry->attributes()->value(key), siteUrlStr, formUrlStr)
+                && !entries.contains(entry)) {
+                entries.append(entry);
                 continue;
             }
+        }
 
-            // Search for additional URL's starting with KP2A_URL
-            for (const auto& key : entry->attributes()->keys()) {
-                if (key.startsWith(ADDITIONAL_URL) && handleURL(entry->attributes()->value(key), siteUrlStr, formUrlStr)
-                    && !entries.contains(entry)) {
-                    entries.append(entry);
-                    continue;
-                }
-            }
+        if (!handleEntry(entry, siteUrlStr, formUrlStr)) {
+            return;
+        }
 
-            if (!handleEntry(entry, siteUrlStr, formUrlStr)) {
-                continue;
-            }
+        // Additional URL check may have already inserted the entry to the list
+        if (!entries.contains(entry)) {
+            entries.append(entry);
+        }
+    };
 
-            // Additional URL check may have already inserted the entry to the list
-            if (!entries.contains(entry)) {
-                entries.append(entry);
+    // Only entries with the same base domain as the site can match its URL,
+    // unless the URL is local or selects an entry directly
+    const QString siteDomain = baseDomain(QUrl(siteUrlStr).host());
+    if (!siteDomain.isEmpty() && !siteUrlStr.startsWith("file://") && !siteUrlStr.startsWith("keepassxc://")) {
+        for (auto* entry : entryIndex(db.data())->candidates(siteDomain)) {
+            if (entry->group()->resolveSearchingEnabled()) {
+                addIfMatching(entry);
             }
         }
+        return entries;
     }
 
+    rootGroup->forEachGroupRecursive(
+        [&](Group* group) -> bool {
+            if (!group->resolveSearchingEnabled()) {
+                return true;
+            }
+
+            for (auto* entry : group->entries()) {
+                if (!entry->isRecycled()) {
+                    addIfMatching(entry);
+                }
+            }
+            return true;
+        },
+        true,
+        true);
+
     return entries;
 }
 
-QList<Entry*>
-BrowserService::searchEntries(const QString& siteUrlStr, const QString& formUrlStr, const StringPairList& keyList)
+/**
+ * @return the databases connected with the client that a search covers
+ */
+QList<QSharedPointer<Database>> BrowserService::searchedDatabases(const StringPairList& keyList)
 {
     // Check if database is connected with KeePassXC-Browser
     auto databaseConnected = [&](const QSharedPointer<Database>& db) {
+        const QHash<QString, QString> browserKeys = db->metadata()->customData()->browserKeys();
         for (const StringPair& keyPair : keyList) {
-            QString key = db->metadata()->customData()->value(CustomData::BrowserKeyPrefix + keyPair.first);
+            QString key = browserKeys.value(keyPair.first);
             if (!key.isEmpty() && keyPair.second == key) {
                 return true;
             }
@@ -647,15 +785,79 @@ BrowserService::searchEntries(const QString& siteUrlStr, const QString& formUrlS
             databases << db;
         }
     }
+    return databases;
+}
 
-    // Search entries matching the hostname
-    QString hostname = QUrl(siteUrlStr).host();
+QList<Entry*>
+BrowserService::searchEntries(const QString& siteUrlStr, const QString& formUrlStr, const StringPairList& keyList)
+{
+    const auto databases = searchedDatabases(keyList);
+
+    // Answer from the search prepared when the tab was activated, as long
+    // as it covered the same, unmodified databases
+    auto& anticipated = m_anticipatedSearch;
+    if (anticipated.age.isValid() && !anticipated.age.hasExpired(ANTICIPATED_SEARCH_TTL)
+        && anticipated.siteUrl == siteUrlStr && anticipated.formUrl == formUrlStr
+        && anticipated.databases.size() == databases.size()) {
+        bool valid = true;
+        for (int i = 0; i < databases.size() && valid; ++i) {
+            valid = anticipated.databases[i].first.toStrongRef() == databases[i]
+                    && anticipated.databases[i].second == databases[i]->modificationCount();
+        }
+        if (valid) {
+            return anticipated.entries;
+        }
+    }
+
+    return searchEntries(databases, siteUrlStr, formUrlStr);
+}
+
+/**
+ * Search the entries of a site before it asks for them, e.g. when its tab
+ * is activated, so that the following get-logins doesn't have to search.
+ */
+void BrowserService::anticipateEntries(const QString& siteUrlStr,
+                                       const QString& formUrlStr,
+                                       const StringPairList& keyList)
+{
+    const auto databases = searchedDatabases(keyList);
+
+    auto& anticipated = m_anticipatedSearch;
+    anticipated.siteUrl = siteUrlStr;
+    anticipated.formUrl = formUrlStr;
+    anticipated.databases.clear();
+    for (const auto& db : databases) {
+        anticipated.databases.append(qMakePair(db.toWeakRef(), db->modificationCount()));
+    }
+    anticipated.entries = searchEntries(databases, siteUrlStr, formUrlStr);
+    anticipated.age.start();
+}
+
+QList<Entry*> BrowserService::searchEntries(const QList<QSharedPointer<Database>>& databases,
+                                            const QString& siteUrlStr,
+                                            const QString& formUrlStr)
+{
+    // Search entries matching the hostname. Subdomains are already matched
+    // by handleURL(), so a single search per database is enough.
     QList<Entry*> entries;
-    do {
+    if (databases.size() < 2) {
         for (const auto& db : databases) {
             entries << searchEntries(db, siteUrlStr, formUrlStr);
         }
-    } while (entries.isEmpty() && removeFirstDomain(hostname));
+        return entries;
+    }
+
+    // Search the databases in parallel. The indexes are brought up to date
+    // here, so the searches only read them, and nothing can modify the
+    // databases while this thread waits for the results.
+    for (const auto& db : databases) {
+        entryIndex(db.data())->update();
+    }
+    std::function<QList<Entry*>(const QSharedPointer<Database>&)> search =
+        [&](const QSharedPointer<Database>& db) { return searchEntries(db, siteUrlStr, formUrlStr); };
+    for (const auto& dbEntries : QtConcurrent::blockingMapped<QList<QList<Entry*>>>(databases, search)) {
+        entries << dbEntries;
+    }
 
     return entries;
 }
@@ -737,9 +939,12 @@ QList<Entry*>
 BrowserService::sortEntries(QList<Entry*>& pwEntries, const QString& siteUrlStr, const QString& formUrlStr)
 {
     // Build map of prioritized entries
+    const auto stdOpts = QUrl::RemoveFragment | QUrl::RemoveUserInfo;
+    const auto siteUrl = QUrl(siteUrlStr).adjusted(stdOpts);
+    const auto formUrl = QUrl(formUrlStr).adjusted(stdOpts);
     QMultiMap<int, Entry*> priorities;
     for (auto* entry : pwEntries) {
-        priorities.insert(sortPriority(getEntryURLs(entry), siteUrlStr, formUrlStr), entry);
+        priorities.insert(sortPriority(getEntryURLs(entry), siteUrl, formUrl), entry);
     }
 
     auto keys = priorities.uniqueKeys();
@@ -764,9 +969,8 @@ BrowserService::sortEntries(QList<Entry*>& pwEntries, const QString& siteUrlStr,
 }
 
 QList<Entry*> BrowserService::confirmEntries(QList<Entry*>& pwEntriesToConfirm,
-                                             const QString& siteUrlStr,
-                                             const QString& siteHost,
-                                             const QString& formUrlStr,
+                                             const QStringList& siteUrls,
+                                             const QHash<Entry*, StringPairList>& entryHosts,
                                              const QString& realm,
                                              const bool httpAuth)
 {
@@ -780,21 +984,29 @@ QList<Entry*> BrowserService::confirmEntries(QList<Entry*>& pwEntriesToConfirm,
 
     connect(m_currentDatabaseWidget, SIGNAL(databaseLocked()), &accessControlDialog, SLOT(reject()));
 
-    connect(&accessControlDialog, &BrowserAccessControlDialog::disableAccess, [&](QTableWidgetItem* item) {
-        auto entry = pwEntriesToConfirm[item->row()];
+    // Remember the decision for the sites the entry was requested for
+    auto saveDecision = [&](Entry* entry, bool allow) {
         BrowserEntryConfig config;
         config.load(entry);
-        config.deny(siteHost);
-        if (!formUrlStr.isEmpty() && siteHost != formUrlStr) {
-            config.deny(formUrlStr);
+        for (const auto& hosts : entryHosts.value(entry)) {
+            const QString& siteHost = hosts.first;
+            const QString& formHost = hosts.second;
+            allow ? config.allow(siteHost) : config.deny(siteHost);
+            if (!formHost.isEmpty() && siteHost != formHost) {
+                allow ? config.allow(formHost) : config.deny(formHost);
+            }
         }
         if (!realm.isEmpty()) {
             config.setRealm(realm);
         }
         config.save(entry);
+    };
+
+    connect(&accessControlDialog, &BrowserAccessControlDialog::disableAccess, [&](QTableWidgetItem* item) {
+        saveDecision(pwEntriesToConfirm[item->row()], false);
     });
 
-    accessControlDialog.setItems(pwEntriesToConfirm, siteUrlStr, httpAuth);
+    accessControlDialog.setItems(pwEntriesToConfirm, siteUrls, httpAuth);
 
     QList<Entry*> allowedEntries;
     if (accessControlDialog.exec() == QDialog::Accepted) {
@@ -802,16 +1014,7 @@ QList<Entry*> BrowserService::confirmEntries(QList<Entry*>& pwEntriesToConfirm,
         for (auto item : accessControlDialog.getSelectedEntries()) {
             auto entry = pwEntriesToConfirm[item->row()];
             if (accessControlDialog.remember()) {
-                BrowserEntryConfig config;
-                config.load(entry);
-                config.allow(siteHost);
-                if (!formUrlStr.isEmpty() && siteHost != formUrlStr) {
-                    config.allow(formUrlStr);
-                }
-                if (!realm.isEmpty()) {
-                    config.setRealm(realm);
-                }
-                config.save(entry);
+                saveDecision(entry, true);
             }
             allowedEntries.append(entry);
         }
@@ -828,28 +1031,38 @@ QList<Entry*> BrowserService::confirmEntries(QList<Entry*>& pwEntriesToConfirm,
     return allowedEntries;
 }
 
-QJsonObject BrowserService::prepareEntry(const Entry* entry)
+/**
+ * @param fields fields to serialize, all if empty. The UUID is always
+ *        included, so that the client can fetch the other fields later.
+ */
+QJsonObject BrowserService::prepareEntry(const Entry* entry, const QStringList& fields)
 {
+    auto wanted = [&fields](const QString& field) { return fields.isEmpty() || fields.contains(field); };
+
     QJsonObject res;
-    res["login"] = entry->resolveMultiplePlaceholders(entry->username());
-    res["password"] = entry->resolveMultiplePlaceholders(entry->password());
-    res["name"] = entry->resolveMultiplePlaceholders(entry->title());
+    if (wanted("login")) {
+        res["login"] = entry->resolveMultiplePlaceholders(entry->username());
+    }
+    if (wanted("password")) {
+        res["password"] = entry->resolveMultiplePlaceholders(entry->password());
+    }
+    if (wanted("name")) {
+        res["name"] = entry->resolveMultiplePlaceholders(entry->title());
+    }
     res["uuid"] = entry->resolveMultiplePlaceholders(entry->uuidToHex());
-    res["group"] = entry->resolveMultiplePlaceholders(entry->group()->name());
-
-    if (entry->hasTotp()) {
-        res["totp"] = entry->totp();
+    if (wanted("group")) {
+        res["group"] = entry->resolveMultiplePlaceholders(entry->group()->name());
     }
 
-    if (entry->isExpired()) {
+    if (wanted("expired") && entry->isExpired()) {
         res["expired"] = TRUE_STR;
     }
 
-    if (entry->customData()->contains(BrowserService::OPTION_SKIP_AUTO_SUBMIT)) {
+    if (wanted("skipAutoSubmit") && entry->customData()->contains(BrowserService::OPTION_SKIP_AUTO_SUBMIT)) {
         res["skipAutoSubmit"] = entry->customData()->value(BrowserService::OPTION_SKIP_AUTO_SUBMIT);
     }
 
-    if (browserSettings()->supportKphFields()) {
+    if (wanted("stringFields") && browserSettings()->supportKphFields()) {
         const EntryAttributes* attr = entry->attributes();
         QJsonArray stringFields;
         for (const auto& key : attr->keys()) {
@@ -917,30 +1130,20 @@ Group* BrowserService::getDefaultEntryGroup(const QSharedPointer<Database>& sele
 // extension provided site and form url.
 int BrowserService::sortPriority(const QStringList& urls, const QString& siteUrlStr, const QString& formUrlStr)
 {
-    QList<int> priorityList;
     // NOTE: QUrl::matches is utterly broken in Qt < 5.11, so we work around that
     // by removing parts of the url that we don't match and direct matching others
     const auto stdOpts = QUrl::RemoveFragment | QUrl::RemoveUserInfo;
-    const auto siteUrl = QUrl(siteUrlStr).adjusted(stdOpts);
-    const auto formUrl = QUrl(formUrlStr).adjusted(stdOpts);
+    return sortPriority(urls, QUrl(siteUrlStr).adjusted(stdOpts), QUrl(formUrlStr).adjusted(stdOpts));
+}
 
+int BrowserService::sortPriority(const QStringList& urls, const QUrl& siteUrl, const QUrl& formUrl)
+{
     auto getPriority = [&](const QString& givenUrl) {
-        auto url = QUrl::fromUserInput(givenUrl).adjusted(stdOpts);
-
-        // Default to https scheme if undefined
-        if (url.scheme().isEmpty() || !givenUrl.contains("://")) {
-            url.setScheme("https");
-        }
-
-        // Add the empty path to the URL if it's missing.
-        // URL's from the extension always have a path set, entry URL's can be without.
-        if (url.path().isEmpty() && !url.hasFragment() && !url.hasQuery()) {
-            url.setPath("/");
-        }
+        const auto parsed = parsedUrl(givenUrl);
+        const auto& url = parsed.priorityUrl;
 
         // Reject invalid urls and hosts, except 'localhost', and scheme mismatch
-        if (!url.isValid() || (!url.host().contains(".") && url.host() != "localhost")
-            || url.scheme() != siteUrl.scheme()) {
+        if (!parsed.priorityValid || url.scheme() != siteUrl.scheme()) {
             return 0;
         }
 
@@ -955,18 +1158,19 @@ int BrowserService::sortPriority(const QStringList& urls, const QString& siteUrl
         }
 
         // Match without path (ie, FQDN match), form url prioritizes lower than site url
-        if (url.host() == siteUrl.host()) {
+        const auto host = url.host();
+        if (host == siteUrl.host()) {
             return 80;
         }
-        if (url.host() == formUrl.host()) {
+        if (host == formUrl.host()) {
             return 70;
         }
 
         // Site/form url ends with given url (subdomain mismatch)
-        if (siteUrl.host().endsWith(url.host())) {
+        if (siteUrl.host().endsWith(host)) {
             return 60;
         }
-        if (formUrl.host().endsWith(url.host())) {
+        if (formUrl.host().endsWith(host)) {
             return 50;
         }
 
@@ -974,11 +1178,11 @@ int BrowserService::sortPriority(const QStringList& urls, const QString& siteUrl
         return 0;
     };
 
+    int priority = 0;
     for (const auto& entryUrl : urls) {
-        priorityList << getPriority(entryUrl);
+        priority = std::max(priority, getPriority(entryUrl));
     }
-
-    return *std::max_element(priorityList.begin(), priorityList.end());
+    return priority;
 }
 
 bool BrowserService::schemeFound(const QString& url)
@@ -987,23 +1191,6 @@ bool BrowserService::schemeFound(const QString& url)
     return !address.scheme().isEmpty();
 }
 
-bool BrowserService::removeFirstDomain(QString& hostname)
-{
-    int pos = hostname.indexOf(".");
-    if (pos < 0) {
-        return false;
-    }
-
-    // Don't remove the second-level domain if it's the only one
-    if (hostname.count(".") > 1) {
-        hostname = hostname.mid(pos + 1);
-        return !hostname.isEmpty();
-    }
-
-    // Nothing removed
-    return false;
-}
-
 /* Test if a search URL matches a custom entry. If the URL has the schema "keepassxc", some special checks will be made.
  * Otherwise, this simply delegates to handleURL(). */
 bool BrowserService::handleEntry(Entry* entry, const QString& url, const QString& submitUrl)
@@ -1023,52 +1210,43 @@ bool BrowserService::handleURL(const QString& entryUrl, const QString& siteUrlSt
         return false;
     }
 
-    QUrl entryQUrl;
-    if (entryUrl.contains("://")) {
-        entryQUrl = entryUrl;
-    } else {
-        entryQUrl = QUrl::fromUserInput(entryUrl);
-
-        if (browserSettings()->matchUrlScheme()) {
-            entryQUrl.setScheme("https");
-        }
-    }
-
     // Make a direct compare if a local file is used
     if (siteUrlStr.startsWith("file://")) {
         return entryUrl == formUrlStr;
     }
 
     // URL host validation fails
-    if (entryQUrl.host().isEmpty()) {
+    const auto entry = parsedUrl(entryUrl);
+    if (entry.host.isEmpty()) {
         return false;
     }
 
     // Match port, if used
-    QUrl siteQUrl(siteUrlStr);
-    if (entryQUrl.port() > 0 && entryQUrl.port() != siteQUrl.port()) {
+    const auto site = parsedSiteUrl(siteUrlStr);
+    if (entry.port > 0 && entry.port != site.port) {
         return false;
     }
 
-    // Match scheme
-    if (browserSettings()->matchUrlScheme() && !entryQUrl.scheme().isEmpty()
-        && entryQUrl.scheme().compare(siteQUrl.scheme()) != 0) {
-        return false;
+    // Match scheme, URLs without one are assumed to be https
+    if (browserSettings()->matchUrlScheme()) {
+        const QString scheme = entry.hasScheme ? entry.scheme : QStringLiteral("https");
+        if (!scheme.isEmpty() && scheme.compare(site.scheme) != 0) {
+            return false;
+        }
     }
 
     // Check for illegal characters
-    QRegularExpression re("[<>\\^`{|}]");
-    if (re.match(entryUrl).hasMatch()) {
+    if (entry.hasIllegalChars) {
         return false;
     }
 
     // Match the base domain
-    if (baseDomain(siteQUrl.host()) != baseDomain(entryQUrl.host())) {
+    if (site.baseDomain != entry.baseDomain) {
         return false;
     }
 
     // Match the subdomains with the limited wildcard
-    if (siteQUrl.host().endsWith(entryQUrl.host())) {
+    if (site.host.endsWith(entry.host)) {
         return true;
     }
 
@@ -1104,6 +1282,73 @@ QString BrowserService::baseDomain(const QString& hostname) const
     return baseDomain;
 }
 
+/**
+ * Parse an entry URL once for all requests.
+ */
+BrowserService::ParsedUrl BrowserService::parsedUrl(const QString& url)
+{
+    QMutexLocker locker(&m_parsedUrlsMutex);
+    auto* parsed = m_parsedUrls.object(url);
+    if (parsed) {
+        return *parsed;
+    }
+
+    parsed = new ParsedUrl();
+    parsed->hasScheme = url.contains("://");
+    const QUrl qurl = parsed->hasScheme ? QUrl(url) : QUrl::fromUserInput(url);
+    parsed->scheme = qurl.scheme();
+    parsed->host = qurl.host();
+    parsed->baseDomain = parsed->host.isEmpty() ? QString() : baseDomain(parsed->host);
+    parsed->port = qurl.port();
+
+    static const QRegularExpression illegalChars("[<>\\^`{|}]");
+    parsed->hasIllegalChars = illegalChars.match(url).hasMatch();
+
+    auto priorityUrl = QUrl::fromUserInput(url).adjusted(QUrl::RemoveFragment | QUrl::RemoveUserInfo);
+    // Default to https scheme if undefined
+    if (priorityUrl.scheme().isEmpty() || !parsed->hasScheme) {
+        priorityUrl.setScheme("https");
+    }
+    // Add the empty path to the URL if it's missing.
+    // URL's from the extension always have a path set, entry URL's can be without.
+    if (priorityUrl.path().isEmpty() && !priorityUrl.hasFragment() && !priorityUrl.hasQuery()) {
+        priorityUrl.setPath("/");
+    }
+    parsed->priorityValid =
+        priorityUrl.isValid() && (priorityUrl.host().contains(".") || priorityUrl.host() == "localhost");
+    parsed->priorityUrl = priorityUrl;
+
+    const ParsedUrl result = *parsed;
+    m_parsedUrls.insert(url, parsed);
+    return result;
+}
+
+/**
+ * Parse the site URL of a request, which is the same for all entries
+ * matched by the request.
+ */
+BrowserService::ParsedSiteUrl BrowserService::parsedSiteUrl(const QString& siteUrlStr)
+{
+    QMutexLocker locker(&m_parsedUrlsMutex);
+    if (m_parsedSiteUrl.url != siteUrlStr || m_parsedSiteUrl.url.isNull()) {
+        const QUrl siteQUrl(siteUrlStr);
+        m_parsedSiteUrl.url = siteUrlStr;
+        m_parsedSiteUrl.scheme = siteQUrl.scheme();
+        m_parsedSiteUrl.host = siteQUrl.host();
+        m_parsedSiteUrl.baseDomain = baseDomain(siteQUrl.host());
+        m_parsedSiteUrl.port = siteQUrl.port();
+    }
+    return m_parsedSiteUrl;
+}
+
+/**
+ * @return the index of the database's entries by base domain
+ */
+BrowserEntryIndex* BrowserService::entryIndex(Database* db)
+{
+    return BrowserEntryIndex::forDatabase(db, [this](const QString& url) { return parsedUrl(url).baseDomain; });
+}
+
 QSharedPointer<Database> BrowserService::getDatabase()
 {
     if (m_currentDatabaseWidget) {
@@ -37,6 +37,7 @@ enum
 class DatabaseWidget;
 class BrowserHost;
 class BrowserAction;
+class BrowserEntryIndex;
 
 class BrowserService : public QObject
 {
@@ -81,7 +82,17 @@ public:
                                    const QString& formUrlStr,
                                    const QString& realm,
                                    const StringPairList& keyList,
-                                   const bool httpAuth = false);
+                                   const bool httpAuth = false,
+                                   const QStringList& fields = {},
+                                   const QString& uuid = {});
+    void anticipateEntries(const QString& siteUrlStr, const QString& formUrlStr, const StringPairList& keyList);
+    QList<QJsonArray> findMatchingEntries(const QString& dbid,
+                                          const StringPairList& urls,
+                                          const QString& realm,
+                                          const StringPairList& keyList,
+                                          const bool httpAuth = false,
+                                          const QStringList& fields = {},
+                                          const QString& uuid = {});
 
     static void convertAttributesToCustomData(QSharedPointer<Database> db);
 
@@ -119,26 +130,82 @@ private:
         Hidden
     };
 
+    // Parts of an entry URL that matching and sorting compare
+    struct ParsedUrl
+    {
+        bool hasScheme;
+        bool hasIllegalChars;
+        QString scheme;
+        QString host;
+        QString baseDomain;
+        int port;
+        // normalized as sortPriority() compares it
+        QUrl priorityUrl;
+        bool priorityValid;
+    };
+
+    // Parts of the site URL of a request that matching compares
+    struct ParsedSiteUrl
+    {
+        QString url;
+        QString scheme;
+        QString host;
+        QString baseDomain;
+        int port = -1;
+    };
+
+    // Search result prepared before the site asked for its logins, valid
+    // while none of the searched databases was modified
+    struct AnticipatedSearch
+    {
+        QString siteUrl;
+        QString formUrl;
+        QList<QPair<QWeakPointer<Database>, quint64>> databases;
+        QList<Entry*> entries;
+        QElapsedTimer age;
+    };
+
+    // Serialized group tree of a database, built for the root group it
+    // belongs to and dropped whenever a group changes
+    struct DatabaseGroups
+    {
+        QPointer<Group> rootGroup;
+        QJsonObject groups;
+    };
+
     QList<Entry*>
     searchEntries(const QSharedPointer<Database>& db, const QString& siteUrlStr, const QString& formUrlStr);
     QList<Entry*> searchEntries(const QString& siteUrlStr, const QString& formUrlStr, const StringPairList& keyList);
+    QList<Entry*> searchEntries(const QList<QSharedPointer<Database>>& databases,
+                                const QString& siteUrlStr,
+                                const QString& formUrlStr);
+    QList<QSharedPointer<Database>> searchedDatabases(const StringPairList& keyList);
     QList<Entry*> sortEntries(QList<Entry*>& pwEntries, const QString& siteUrlStr, const QString& formUrlStr);
+    void checkEntries(const QList<Entry*>& entries,
+                      const QString& siteHost,
+                      const QString& formHost,
+                      const QString& realm,
+                      const bool httpAuth,
+                      QList<Entry*>& pwEntries,
+                      QList<Entry*>& pwEntriesToConfirm);
     QList<Entry*> confirmEntries(QList<Entry*>& pwEntriesToConfirm,
-                                 const QString& siteUrlStr,
-                                 const QString& siteHost,
-                                 const QString& formUrlStr,
+                                 const QStringList& siteUrls,
+                                 const QHash<Entry*, StringPairList>& entryHosts,
                                  const QString& realm,
                                  const bool httpAuth);
-    QJsonObject prepareEntry(const Entry* entry);
+    QJsonObject prepareEntry(const Entry* entry, const QStringList& fields);
     QJsonArray getChildrenFromGroup(Group* group);
     Access checkAccess(const Entry* entry, const QString& siteHost, const QString& formHost, const QString& realm);
     Group* getDefaultEntryGroup(const QSharedPointer<Database>& selectedDb = {});
     int sortPriority(const QStringList& urls, const QString& siteUrlStr, const QString& formUrlStr);
+    int sortPriority(const QStringList& urls, const QUrl& siteUrl, const QUrl& formUrl);
     bool schemeFound(const QString& url);
-    bool removeFirstDomain(QString& hostname);
     bool handleEntry(Entry* entry, const QString& url, const QString& submitUrl);
     bool handleURL(const QString& entryUrl, const QString& siteUrlStr, const QString& formUrlStr);
     QString baseDomain(const QString& hostname) const;
+    ParsedUrl parsedUrl(const QString& url);
+    ParsedSiteUrl parsedSiteUrl(const QString& siteUrlStr);
+    BrowserEntryIndex* entryIndex(Database* db);
     QSharedPointer<Database> getDatabase();
     QSharedPointer<Database> selectedDatabase();
     QString getDatabaseRootUuid();
@@ -163,9 +230,19 @@ private:
 
     QPointer<DatabaseWidget> m_currentDatabaseWidget;
 
+    // entry URLs are parsed once, a changed URL is simply another key
+    QCache<QString, ParsedUrl> m_parsedUrls;
+    ParsedSiteUrl m_parsedSiteUrl;
+    // databases are searched in parallel
+    QMutex m_parsedUrlsMutex;
+    QHash<const Database*, DatabaseGroups> m_databaseGroups;
+    AnticipatedSearch m_anticipatedSearch;
+
     Q_DISABLE_COPY(BrowserService);
 
     friend class TestBrowser;
+    friend class BenchmarkBrowser;
+    friend class TestScaling;
 };
 
 static inline BrowserService* browserService()
@@ -19,6 +19,7 @@
 #include "config-keepassx.h"
 
 #include <QCoreApplication>
+#include <QDebug>
 #include <QProcessEnvironment>
 #include <QStandardPaths>
 #include <QVariant>
@@ -42,4 +43,60 @@ namespace BrowserShared
         return QStandardPaths::writableLocation(QStandardPaths::TempLocation) + serverName;
 #endif
     }
+
+    void MessageBuffer::append(const QByteArray& data)
+    {
+        m_buffer.append(data);
+    }
+
+    /**
+     * @return the messages completed by the data appended so far, the rest
+     *         of the data is kept for the next call
+     */
+    QList<QByteArray> MessageBuffer::takeMessages()
+    {
+        QList<QByteArray> messages;
+        int start = 0;
+        for (; m_scanned < m_buffer.size(); ++m_scanned) {
+            const char c = m_buffer.at(m_scanned);
+            if (m_inString) {
+                if (m_escaped) {
+                    m_escaped = false;
+                } else if (c == '\\') {
+                    m_escaped = true;
+                } else if (c == '"') {
+                    m_inString = false;
+                }
+            } else if (c == '"') {
+                m_inString = m_depth > 0;
+            } else if (c == '{' || c == '[') {
+                if (m_depth == 0) {
+                    // Skip separators and garbage between messages
+                    start = m_scanned;
+                }
+                ++m_depth;
+            } else if ((c == '}' || c == ']') && m_depth > 0 && --m_depth == 0) {
+                messages.append(m_buffer.mid(start, m_scanned + 1 - start));
+                start = m_scanned + 1;
+            }
+        }
+
+        if (m_depth == 0) {
+            // Nothing of the remaining data belongs to a message
+            start = m_buffer.size();
+        }
+        m_buffer.remove(0, start);
+        m_scanned -= start;
+
+        // Drop a message that exceeds the limit instead of buffering forever
+        if (m_buffer.size() > NATIVEMSG_MAX_LENGTH) {
+            m_buffer.clear();
+            m_scanned = 0;
+            m_depth = 0;
+            m_inString = false;
+            m_escaped = false;
+            qWarning() << "Dropped a browser message exceeding the maximum length";
+        }
+        return messages;
+    }
 } // namespace BrowserShared
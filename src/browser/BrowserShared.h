@@ -18,6 +18,8 @@
 #ifndef KEEPASSXC_BROWSERSHARED_H
 #define KEEPASSXC_BROWSERSHARED_H
 
+#include <QByteArray>
+#include <QList>
 #include <QString>
 
 namespace BrowserShared
@@ -38,6 +40,26 @@ namespace BrowserShared
     };
 
     QString localServerPath();
+
+    /**
+     * Splits the stream of a local socket into its messages. Messages are
+     * JSON objects sent back to back, so a read can end in the middle of a
+     * message or contain several of them. The stream is scanned once as it
+     * arrives, tracking the nesting of the objects and their strings.
+     */
+    class MessageBuffer
+    {
+    public:
+        void append(const QByteArray& data);
+        QList<QByteArray> takeMessages();
+
+    private:
+        QByteArray m_buffer;
+        int m_scanned = 0;
+        int m_depth = 0;
+        bool m_inString = false;
+        bool m_escaped = false;
+    };
 } // namespace BrowserShared
 
 #endif // KEEPASSXC_BROWSERSHARED_H
@@ -73,6 +73,12 @@ Add::Add()
     options.append(Generate::IncludeEveryGroupOption);
 }
 
+bool Add::isServable(const QSharedPointer<QCommandLineParser>& parser) const
+{
+    // A server has no input to read the password from
+    return !parser->isSet(Add::PasswordPromptOption);
+}
+
 int Add::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
 {
     auto& out = Utils::STDOUT;
@@ -127,7 +133,7 @@ int Add::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<Q
     }
 
     QString errorMessage;
-    if (!database->save(&errorMessage, true, false)) {
+    if (!saveDatabase(database, &errorMessage)) {
         err << QObject::tr("Writing the database failed %1.").arg(errorMessage) << endl;
         return EXIT_FAILURE;
     }
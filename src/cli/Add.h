@@ -25,6 +25,7 @@ class Add : public DatabaseCommand
 public:
     Add();
 
+    bool isServable(const QSharedPointer<QCommandLineParser>& parser) const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
 
     static const QCommandLineOption UsernameOption;
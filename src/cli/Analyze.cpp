@@ -20,18 +20,25 @@
 #include "core/HibpOffline.h"
 
 #include <QCommandLineParser>
+#include <QCryptographicHash>
 #include <QFile>
 #include <QString>
+#include <QtConcurrent>
+
+#include <functional>
 
 #include "cli/TextStream.h"
+#include "core/DuplicateDetector.h"
+#include "core/Global.h"
 #include "core/Group.h"
+#include "core/PasswordHealth.h"
 #include "core/Tools.h"
 
 const QCommandLineOption Analyze::HIBPDatabaseOption = QCommandLineOption(
     {"H", "hibp"},
     QObject::tr("Check if any passwords have been publicly leaked. FILENAME must be the path of a file listing "
                 "SHA-1 hashes of leaked passwords in HIBP format, as available from "
-                "https://haveibeenpwned.com/Passwords."),
+                "https://haveibeenpwned.com/Passwords, or an index of such a file written by hibp-index."),
     QObject::tr("FILENAME"));
 
 const QCommandLineOption Analyze::OkonOption =
@@ -39,12 +46,61 @@ const QCommandLineOption Analyze::OkonOption =
                        QObject::tr("Path to okon-cli to search a formatted HIBP file"),
                        QObject::tr("okon-cli"));
 
+const QCommandLineOption Analyze::HealthOption =
+    QCommandLineOption("health",
+                       QObject::tr("Also report passwords whose quality is less than good, like the health check "
+                                   "of the database reports."));
+
+const QCommandLineOption Analyze::DuplicatesOption =
+    QCommandLineOption("duplicates",
+                       QObject::tr("Also report groups of duplicate entries, which have the same title, username, "
+                                   "URL host and password."));
+
+namespace
+{
+    QString qualityName(PasswordHealth::Quality quality)
+    {
+        switch (quality) {
+        case PasswordHealth::Quality::Bad:
+            return QStringLiteral("bad");
+        case PasswordHealth::Quality::Poor:
+            return QStringLiteral("poor");
+        case PasswordHealth::Quality::Weak:
+            return QStringLiteral("weak");
+        case PasswordHealth::Quality::Good:
+            return QStringLiteral("good");
+        case PasswordHealth::Quality::Excellent:
+            return QStringLiteral("excellent");
+        }
+        return {};
+    }
+
+    bool isKnownBad(const Entry* entry)
+    {
+        return entry->customData()->contains(PasswordHealth::OPTION_KNOWN_BAD)
+               && entry->customData()->value(PasswordHealth::OPTION_KNOWN_BAD) == TRUE_STR;
+    }
+} // namespace
+
 Analyze::Analyze()
 {
     name = QString("analyze");
     description = QObject::tr("Analyze passwords for weaknesses and problems.");
     options.append(Analyze::HIBPDatabaseOption);
     options.append(Analyze::OkonOption);
+    options.append(Analyze::HealthOption);
+    options.append(Analyze::DuplicatesOption);
+    options.append(Command::FormatOption);
+}
+
+bool Analyze::isServable(const QSharedPointer<QCommandLineParser>&) const
+{
+    return true;
+}
+
+bool Analyze::isMetadataOnly(const QSharedPointer<QCommandLineParser>&) const
+{
+    return true;
 }
 
 int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
@@ -52,55 +108,229 @@ int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPoint
     auto& out = Utils::STDOUT;
     auto& err = Utils::STDERR;
 
-    QList<QPair<const Entry*, int>> findings;
     QString error;
 
+    Utils::OutputFormat format;
+    if (!Utils::parseOutputFormat(parser->value(Command::FormatOption), format)) {
+        err << QObject::tr("Unsupported format %1.").arg(parser->value(Command::FormatOption)) << endl;
+        return EXIT_FAILURE;
+    }
+    // Progress messages would get in the way of machine-readable records
+    const bool verbose = format == Utils::OutputFormat::Text;
+
+    const bool checkHealth = parser->isSet(Analyze::HealthOption);
+    const bool checkDuplicates = parser->isSet(Analyze::DuplicatesOption);
     auto hibpDatabase = parser->value(Analyze::HIBPDatabaseOption);
-    if (!QFile::exists(hibpDatabase) || hibpDatabase.isEmpty()) {
+    if ((!(checkHealth || checkDuplicates) || !hibpDatabase.isEmpty())
+        && (!QFile::exists(hibpDatabase) || hibpDatabase.isEmpty())) {
         err << QObject::tr("Cannot find HIBP file: %1").arg(hibpDatabase);
         return EXIT_FAILURE;
     }
 
     auto okon = parser->value(Analyze::OkonOption);
-    if (!okon.isEmpty()) {
-        out << QObject::tr("Evaluating database entries using okon...") << endl;
-
-        if (!HibpOffline::okonReport(database, okon, hibpDatabase, findings, &error)) {
+    QFile hibpFile;
+    HibpOffline::Index hibpIndex;
+    bool useIndex = false;
+    if (hibpDatabase.isEmpty()) {
+        if (verbose) {
+            out << QObject::tr("Evaluating database entries...") << endl;
+        }
+    } else if (!okon.isEmpty()) {
+        if (verbose) {
+            out << QObject::tr("Evaluating database entries using okon...") << endl;
+        }
+    } else if (HibpOffline::isIndex(hibpDatabase)) {
+        if (!hibpIndex.open(hibpDatabase, &error)) {
             err << error << endl;
             return EXIT_FAILURE;
         }
+        useIndex = true;
+
+        if (verbose) {
+            out << QObject::tr("Evaluating database entries against HIBP index...") << endl;
+        }
     } else {
-        QFile hibpFile(hibpDatabase);
+        hibpFile.setFileName(hibpDatabase);
         if (!hibpFile.open(QFile::ReadOnly)) {
             err << QObject::tr("Failed to open HIBP file %1: %2").arg(hibpDatabase).arg(hibpFile.errorString()) << endl;
             return EXIT_FAILURE;
         }
 
-        out << QObject::tr("Evaluating database entries against HIBP file, this will take a while...") << endl;
+        if (verbose) {
+            out << QObject::tr("Evaluating database entries against HIBP file, this will take a while...") << endl;
+        }
+    }
+
+    QList<const Entry*> entries;
+    database->rootGroup()->forEachEntryRecursive(
+        [&entries](const Entry* entry) -> bool {
+            entries.append(entry);
+            return true;
+        },
+        true);
 
-        if (!HibpOffline::report(database, hibpFile, findings, &error)) {
+    // Hashing, health evaluation and index lookups are independent for each
+    // entry and run on the thread pool. With an index the results are written
+    // as soon as they arrive, in the order of the entries.
+    QSharedPointer<HealthChecker> checker;
+    if (checkHealth) {
+        checker.reset(new HealthChecker(database));
+    }
+    std::function<Finding(const Entry*)> evaluate = [&](const Entry* entry) -> Finding {
+        Finding finding;
+        finding.entry = entry;
+        if (!hibpDatabase.isEmpty()) {
+            finding.sha1 = QCryptographicHash::hash(entry->password().toUtf8(), QCryptographicHash::Sha1);
+            if (useIndex) {
+                finding.leaked = hibpIndex.lookup(finding.sha1, &finding.count);
+            }
+        }
+        if (checker && !isKnownBad(entry)) {
+            finding.health = checker->evaluate(entry);
+        }
+        return finding;
+    };
+    QFuture<Finding> future = QtConcurrent::mapped(entries, evaluate);
+
+    if (useIndex || hibpDatabase.isEmpty()) {
+        for (int i = 0; i < entries.size(); ++i) {
+            printFinding(future.resultAt(i), format, out);
+        }
+        if (checkDuplicates) {
+            printDuplicates(DuplicateDetector::findDuplicates(database->rootGroup()), format, out);
+        }
+        out << flush;
+        return EXIT_SUCCESS;
+    }
+
+    QList<Finding> findings = future.results();
+    QList<QPair<const Entry*, int>> leaks;
+    if (!okon.isEmpty()) {
+        if (!HibpOffline::okonReport(database, okon, hibpDatabase, leaks, &error)) {
+            err << error << endl;
+            return EXIT_FAILURE;
+        }
+    } else {
+        QVector<QPair<QByteArray, const Entry*>> hashes;
+        hashes.reserve(findings.size());
+        for (const auto& finding : asConst(findings)) {
+            hashes.append({finding.sha1, finding.entry});
+        }
+        if (!HibpOffline::report(hashes, hibpFile, leaks, &error)) {
             err << error << endl;
             return EXIT_FAILURE;
         }
     }
 
+    QHash<const Entry*, int> leakCounts;
+    for (const auto& leak : asConst(leaks)) {
+        leakCounts.insert(leak.first, leak.second);
+    }
     for (auto& finding : findings) {
-        printHibpFinding(finding.first, finding.second, out);
+        if (leakCounts.contains(finding.entry)) {
+            finding.leaked = true;
+            finding.count = leakCounts.value(finding.entry);
+        }
+        printFinding(finding, format, out);
+    }
+    if (checkDuplicates) {
+        printDuplicates(DuplicateDetector::findDuplicates(database->rootGroup()), format, out);
     }
+    out << flush;
 
     return EXIT_SUCCESS;
 }
 
-void Analyze::printHibpFinding(const Entry* entry, int count, QTextStream& out)
+/**
+ * Write the problems found for an entry, if there are any. Leaked passwords
+ * print as they used to, the other formats have one record per entry.
+ */
+void Analyze::printFinding(const Finding& finding, Utils::OutputFormat format, QTextStream& out)
 {
-    QString path = entry->title();
-    for (auto g = entry->group(); g && g != g->database()->rootGroup(); g = g->parentGroup()) {
-        path.prepend("/").prepend(g->name());
+    const bool weak = finding.health && finding.health->quality() < PasswordHealth::Quality::Good;
+    if (!finding.leaked && !weak) {
+        return;
+    }
+
+    const Entry* entry = finding.entry;
+    if (format == Utils::OutputFormat::Text) {
+        if (finding.leaked) {
+            printHibpFinding(entry, finding.count, out);
+        }
+        if (weak) {
+            printHealthFinding(entry, *finding.health, out);
+        }
+        return;
+    }
+
+    QList<QPair<QString, QString>> fields;
+    fields.append({"path", Utils::groupPath(entry->group()) + entry->title()});
+    fields.append({"uuid", entry->uuidToHex()});
+    fields.append({"leaked", finding.leaked ? TRUE_STR : FALSE_STR});
+    fields.append({"leakCount", finding.leaked && finding.count > 0 ? QString::number(finding.count) : QString()});
+    fields.append({"quality", finding.health ? qualityName(finding.health->quality()) : QString()});
+    fields.append({"score", finding.health ? QString::number(finding.health->score()) : QString()});
+    fields.append({"reason", finding.health ? finding.health->scoreReason() : QString()});
+    Utils::writeRecord(out, format, fields);
+}
+
+/**
+ * Write every group of duplicates on a line of its own, or one record per
+ * duplicate entry that refers to the entry kept by the GUI.
+ */
+void Analyze::printDuplicates(const QList<QList<Entry*>>& duplicates, Utils::OutputFormat format, QTextStream& out)
+{
+    for (const auto& group : duplicates) {
+        if (format == Utils::OutputFormat::Text) {
+            QStringList paths;
+            for (const Entry* entry : group) {
+                paths.append(entryPath(entry));
+            }
+            out << QObject::tr("Entries '%1' are duplicates").arg(paths.join("', '")) << endl;
+            continue;
+        }
+
+        const Entry* kept = DuplicateDetector::keptEntry(group);
+        for (const Entry* entry : group) {
+            QList<QPair<QString, QString>> fields;
+            fields.append({"path", Utils::groupPath(entry->group()) + entry->title()});
+            fields.append({"uuid", entry->uuidToHex()});
+            fields.append({"duplicateOf", entry == kept ? QString() : kept->uuidToHex()});
+            Utils::writeRecord(out, format, fields);
+        }
     }
+}
 
+void Analyze::printHibpFinding(const Entry* entry, int count, QTextStream& out)
+{
+    const QString path = entryPath(entry);
     if (count > 0) {
         out << QObject::tr("Password for '%1' has been leaked %2 time(s)!", "", count).arg(path).arg(count) << endl;
     } else {
         out << QObject::tr("Password for '%1' has been leaked!", "", count).arg(path) << endl;
     }
 }
+
+void Analyze::printHealthFinding(const Entry* entry, const PasswordHealth& health, QTextStream& out)
+{
+    const QString path = entryPath(entry);
+    const QString reason = health.scoreReason();
+    if (reason.isEmpty()) {
+        out << QObject::tr("Password for '%1' is %2 (score %3)")
+                   .arg(path, qualityName(health.quality()), QString::number(health.score()))
+            << endl;
+    } else {
+        out << QObject::tr("Password for '%1' is %2 (score %3): %4")
+                   .arg(path, qualityName(health.quality()), QString::number(health.score()), reason)
+            << endl;
+    }
+}
+
+QString Analyze::entryPath(const Entry* entry)
+{
+    QString path = entry->title();
+    for (auto g = entry->group(); g && g != g->database()->rootGroup(); g = g->parentGroup()) {
+        path.prepend("/").prepend(g->name());
+    }
+    return path;
+}
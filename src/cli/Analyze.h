@@ -20,17 +20,39 @@
 
 #include "DatabaseCommand.h"
 
+#include "cli/Utils.h"
+
+class PasswordHealth;
+
 class Analyze : public DatabaseCommand
 {
 public:
     Analyze();
+    bool isServable(const QSharedPointer<QCommandLineParser>& parser) const override;
+    bool isMetadataOnly(const QSharedPointer<QCommandLineParser>& parser) const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
 
     static const QCommandLineOption HIBPDatabaseOption;
     static const QCommandLineOption OkonOption;
+    static const QCommandLineOption HealthOption;
+    static const QCommandLineOption DuplicatesOption;
 
 private:
+    // Problems found with the password of an entry
+    struct Finding
+    {
+        const Entry* entry = nullptr;
+        QByteArray sha1;
+        bool leaked = false;
+        int count = -1;
+        QSharedPointer<PasswordHealth> health;
+    };
+
+    void printFinding(const Finding& finding, Utils::OutputFormat format, QTextStream& out);
+    void printDuplicates(const QList<QList<Entry*>>& duplicates, Utils::OutputFormat format, QTextStream& out);
     void printHibpFinding(const Entry* entry, int count, QTextStream& out);
+    void printHealthFinding(const Entry* entry, const PasswordHealth& health, QTextStream& out);
+    static QString entryPath(const Entry* entry);
 };
 
 #endif // KEEPASSXC_HIBP_H
@@ -0,0 +1,155 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Batch.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "TextStream.h"
+#include "Utils.h"
+
+const QCommandLineOption Batch::ScriptOption =
+    QCommandLineOption(QStringList() << "s"
+                                     << "script",
+                       QObject::tr("Read the commands from the given file instead of the standard input."),
+                       QObject::tr("path"));
+
+const QCommandLineOption Batch::FormatOption =
+    QCommandLineOption(QStringList() << "f"
+                                     << "format",
+                       QObject::tr("Format of the command results. Available choices are text and json."),
+                       QObject::tr("format"),
+                       "text");
+
+namespace
+{
+    int runCommand(QSharedPointer<Database> database, const QStringList& arguments)
+    {
+        auto command = Commands::getCommand(arguments.first());
+        if (!command) {
+            Utils::STDERR << QObject::tr("Unknown command %1").arg(arguments.first()) << endl;
+            return EXIT_FAILURE;
+        }
+
+        auto databaseCommand = command.dynamicCast<DatabaseCommand>();
+        if (!databaseCommand) {
+            return command->execute(arguments);
+        }
+        if (!databaseCommand->isBatchable()) {
+            Utils::STDERR << QObject::tr("Command %1 cannot be run in a batch.").arg(arguments.first()) << endl;
+            return EXIT_FAILURE;
+        }
+
+        databaseCommand->currentDatabase = database;
+        int exitCode = databaseCommand->execute(arguments);
+        databaseCommand->currentDatabase.reset();
+        return exitCode;
+    }
+} // namespace
+
+Batch::Batch()
+{
+    name = QString("batch");
+    description = QObject::tr("Run several commands against a database unlocked once.");
+    options.append(Batch::ScriptOption);
+    options.append(Batch::FormatOption);
+}
+
+bool Batch::isBatchable() const
+{
+    return false;
+}
+
+/**
+ * Run one command per line of the script, as they would be run in interactive mode.
+ * Empty lines and lines starting with # are skipped. Changes are saved once after
+ * all commands ran instead of after each command.
+ */
+int Batch::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
+{
+    auto& out = Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    const QString format = parser->value(Batch::FormatOption);
+    if (format != "text" && format != "json") {
+        err << QObject::tr("Unsupported format %1.").arg(format) << endl;
+        return EXIT_FAILURE;
+    }
+
+    QFile scriptFile;
+    QTextStream scriptStream;
+    QTextStream* input = &Utils::STDIN;
+    if (parser->isSet(Batch::ScriptOption)) {
+        scriptFile.setFileName(parser->value(Batch::ScriptOption));
+        if (!scriptFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            err << QObject::tr("Could not open script %1: %2").arg(scriptFile.fileName(), scriptFile.errorString())
+                << endl;
+            return EXIT_FAILURE;
+        }
+        scriptStream.setDevice(&scriptFile);
+        input = &scriptStream;
+    }
+
+    int exitCode = EXIT_SUCCESS;
+    int lineNumber = 0;
+    DatabaseCommand::setSavesDeferred(true);
+    while (!input->atEnd()) {
+        const QString line = input->readLine();
+        ++lineNumber;
+
+        const QStringList arguments = Utils::splitCommandString(line);
+        if (arguments.isEmpty() || arguments.first().startsWith('#')) {
+            continue;
+        }
+
+        QByteArray commandOut;
+        QByteArray commandErr;
+        int commandExitCode =
+            Utils::captureOutput([&] { return runCommand(database, arguments); }, commandOut, commandErr);
+        if (commandExitCode != EXIT_SUCCESS) {
+            exitCode = EXIT_FAILURE;
+        }
+
+        if (format == "json") {
+            QJsonObject record;
+            record["line"] = lineNumber;
+            record["command"] = arguments.first();
+            record["exitCode"] = commandExitCode;
+            record["output"] = QString::fromLocal8Bit(commandOut);
+            record["error"] = QString::fromLocal8Bit(commandErr);
+            out << QJsonDocument(record).toJson(QJsonDocument::Compact) << endl;
+        } else {
+            out << QString::fromLocal8Bit(commandOut);
+            err << QString::fromLocal8Bit(commandErr);
+            out << QStringLiteral("-- %1 %2").arg(lineNumber).arg(commandExitCode) << endl;
+        }
+    }
+    const bool modified = DatabaseCommand::hasDeferredSave();
+    DatabaseCommand::setSavesDeferred(false);
+
+    if (modified) {
+        QString errorMessage;
+        if (!database->save(&errorMessage, true, false)) {
+            err << QObject::tr("Writing the database failed %1.").arg(errorMessage) << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return exitCode;
+}
@@ -58,6 +58,11 @@ Clip::Clip()
         {QString("timeout"), QObject::tr("Timeout in seconds before clearing the clipboard."), QString("[timeout]")});
 }
 
+bool Clip::isMetadataOnly(const QSharedPointer<QCommandLineParser>&) const
+{
+    return true;
+}
+
 int Clip::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
 {
     auto& out = parser->isSet(Command::QuietOption) ? Utils::DEVNULL : Utils::STDOUT;
@@ -25,6 +25,7 @@ class Clip : public DatabaseCommand
 public:
     Clip();
 
+    bool isMetadataOnly(const QSharedPointer<QCommandLineParser>& parser) const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
 
     static const QCommandLineOption AttributeOption;
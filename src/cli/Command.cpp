@@ -27,6 +27,7 @@
 #include "Add.h"
 #include "AddGroup.h"
 #include "Analyze.h"
+#include "Batch.h"
 #include "Clip.h"
 #include "Close.h"
 #include "Create.h"
@@ -36,7 +37,9 @@
 #include "Exit.h"
 #include "Export.h"
 #include "Generate.h"
+#include "GenerateDatabase.h"
 #include "Help.h"
+#include "HibpIndex.h"
 #include "Import.h"
 #include "Info.h"
 #include "List.h"
@@ -44,8 +47,10 @@
 #include "Merge.h"
 #include "Move.h"
 #include "Open.h"
+#include "Probe.h"
 #include "Remove.h"
 #include "RemoveGroup.h"
+#include "Serve.h"
 #include "Show.h"
 #include "TextStream.h"
 #include "Utils.h"
@@ -76,6 +81,12 @@ const QCommandLineOption Command::YubiKeyOption =
                        QObject::tr("Yubikey slot and optional serial used to access the database (e.g., 1:7370001)."),
                        QObject::tr("slot[:serial]"));
 
+const QCommandLineOption Command::FormatOption =
+    QCommandLineOption(QStringList() << "format",
+                       QObject::tr("Output format. Available choices are text, json and tsv."),
+                       QObject::tr("format"),
+                       "text");
+
 namespace
 {
 
@@ -147,7 +158,8 @@ QSharedPointer<QCommandLineParser> Command::getCommandLineParser(const QStringLi
         err << getHelpText();
         return {};
     }
-    if (parser->positionalArguments().size() > (positionalArguments.size() + optionalArguments.size())) {
+    if (!repeatableLastArgument
+        && parser->positionalArguments().size() > (positionalArguments.size() + optionalArguments.size())) {
         err << getHelpText();
         return {};
     }
@@ -171,12 +183,15 @@ namespace Commands
         s_commands.insert(QStringLiteral("clip"), QSharedPointer<Command>(new Clip()));
         s_commands.insert(QStringLiteral("close"), QSharedPointer<Command>(new Close()));
         s_commands.insert(QStringLiteral("db-create"), QSharedPointer<Command>(new Create()));
+        s_commands.insert(QStringLiteral("db-generate"), QSharedPointer<Command>(new GenerateDatabase()));
         s_commands.insert(QStringLiteral("db-info"), QSharedPointer<Command>(new Info()));
+        s_commands.insert(QStringLiteral("db-probe"), QSharedPointer<Command>(new Probe()));
         s_commands.insert(QStringLiteral("diceware"), QSharedPointer<Command>(new Diceware()));
         s_commands.insert(QStringLiteral("edit"), QSharedPointer<Command>(new Edit()));
         s_commands.insert(QStringLiteral("estimate"), QSharedPointer<Command>(new Estimate()));
         s_commands.insert(QStringLiteral("generate"), QSharedPointer<Command>(new Generate()));
         s_commands.insert(QStringLiteral("help"), QSharedPointer<Command>(new Help()));
+        s_commands.insert(QStringLiteral("hibp-index"), QSharedPointer<Command>(new HibpIndex()));
         s_commands.insert(QStringLiteral("locate"), QSharedPointer<Command>(new Locate()));
         s_commands.insert(QStringLiteral("ls"), QSharedPointer<Command>(new List()));
         s_commands.insert(QStringLiteral("merge"), QSharedPointer<Command>(new Merge()));
@@ -191,8 +206,10 @@ namespace Commands
             s_commands.insert(QStringLiteral("exit"), QSharedPointer<Command>(new Exit("exit")));
             s_commands.insert(QStringLiteral("quit"), QSharedPointer<Command>(new Exit("quit")));
         } else {
+            s_commands.insert(QStringLiteral("batch"), QSharedPointer<Command>(new Batch()));
             s_commands.insert(QStringLiteral("export"), QSharedPointer<Command>(new Export()));
             s_commands.insert(QStringLiteral("import"), QSharedPointer<Command>(new Import()));
+            s_commands.insert(QStringLiteral("serve"), QSharedPointer<Command>(new Serve()));
         }
     }
 
@@ -48,6 +48,8 @@ public:
     QList<CommandLineArgument> positionalArguments;
     QList<CommandLineArgument> optionalArguments;
     QList<QCommandLineOption> options;
+    // the last positional argument may be given any number of times
+    bool repeatableLastArgument = false;
 
     QString getDescriptionLine();
     QSharedPointer<QCommandLineParser> getCommandLineParser(const QStringList& arguments);
@@ -58,6 +60,7 @@ public:
     static const QCommandLineOption KeyFileOption;
     static const QCommandLineOption NoPasswordOption;
     static const QCommandLineOption YubiKeyOption;
+    static const QCommandLineOption FormatOption;
 };
 
 namespace Commands
@@ -0,0 +1,436 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CommandServer.h"
+
+#include "Command.h"
+#include "DatabaseCommand.h"
+#include "Utils.h"
+
+#include "core/Database.h"
+#include "core/MemoryUsage.h"
+#include "crypto/CryptoHash.h"
+#include "keys/CompositeKey.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QLocalSocket>
+#include <QtEndian>
+
+namespace
+{
+    const int ConnectTimeoutMs = 500;
+    // Clients have to send their request within this time, or they are dropped
+    const int RequestTimeoutMs = 10 * 1000;
+    // Time to wait for the result of a command, the server runs one at a time
+    const int ResponseTimeoutMs = 60 * 1000;
+    // Upper bound of a single request, larger requests drop the connection
+    const quint32 MaxRequestSize = 1024 * 1024;
+
+    const QString ExecuteRequest = QStringLiteral("exec");
+    const QString StopRequest = QStringLiteral("stop");
+
+    QByteArray frame(const QByteArray& payload)
+    {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream << payload;
+        return data;
+    }
+
+    /**
+     * Take the next complete frame from the buffer.
+     *
+     * @return true if a frame was complete
+     */
+    bool takeFrame(QByteArray& buffer, QByteArray& payload)
+    {
+        if (buffer.size() < 4) {
+            return false;
+        }
+        auto size = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(buffer.constData()));
+        if (static_cast<quint32>(buffer.size() - 4) < size) {
+            return false;
+        }
+        payload = buffer.mid(4, static_cast<int>(size));
+        buffer.remove(0, static_cast<int>(size) + 4);
+        return true;
+    }
+
+    bool readFrame(QLocalSocket& socket, QByteArray& payload, int timeoutMs)
+    {
+        QByteArray buffer = socket.readAll();
+        while (!takeFrame(buffer, payload)) {
+            if (!socket.waitForReadyRead(timeoutMs)) {
+                return false;
+            }
+            buffer.append(socket.readAll());
+        }
+        return true;
+    }
+
+    bool connectToServer(QLocalSocket& socket, const QString& databasePath)
+    {
+        if (!QFileInfo(databasePath).exists()) {
+            return false;
+        }
+        socket.connectToServer(CommandServer::serverName(databasePath));
+        return socket.waitForConnected(ConnectTimeoutMs);
+    }
+
+    /**
+     * Digest by which clients show that they have the key of the served
+     * database, without handing out the key itself. Challenge-response
+     * components are not covered.
+     */
+    QByteArray keyDigest(const CompositeKey& key)
+    {
+        CryptoHash hash(CryptoHash::Sha256);
+        hash.addData(QByteArrayLiteral("keepassxc-cli serve"));
+        hash.addData(key.rawKey());
+        return hash.result();
+    }
+
+    bool sendRequest(QLocalSocket& socket, const QString& type, const QByteArray& key, const QStringList& arguments)
+    {
+        QByteArray request;
+        QDataStream stream(&request, QIODevice::WriteOnly);
+        stream << type << key << arguments;
+        socket.write(frame(request));
+        return socket.waitForBytesWritten(RequestTimeoutMs);
+    }
+
+    /**
+     * The server runs commands as in interactive mode, which don't take the database path.
+     */
+    QStringList withoutDatabasePath(const QStringList& arguments, const QString& databasePath)
+    {
+        static const QStringList ValueOptions = {"-k", "--key-file", "-y", "--yubikey"};
+        QStringList result(arguments);
+        for (int i = 1; i < result.size(); ++i) {
+            if (result.at(i) == databasePath && !ValueOptions.contains(result.at(i - 1))) {
+                result.removeAt(i);
+                break;
+            }
+        }
+        return result;
+    }
+} // namespace
+
+CommandServer::CommandServer(QSharedPointer<Database> db, int idleTimeoutSeconds, QObject* parent)
+    : QObject(parent)
+    , m_db(std::move(db))
+{
+    m_server.setSocketOptions(QLocalServer::UserAccessOption);
+    connect(&m_server, SIGNAL(newConnection()), SLOT(handleConnection()));
+
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(idleTimeoutSeconds * 1000);
+    connect(&m_idleTimer, SIGNAL(timeout()), SLOT(close()));
+
+    if (m_db && m_db->key()) {
+        m_keyDigest = keyDigest(*m_db->key());
+    }
+    rememberFileState();
+}
+
+CommandServer::~CommandServer()
+{
+    close();
+}
+
+/**
+ * Server name for a database, unique per user and canonical database path.
+ */
+QString CommandServer::serverName(const QString& databasePath)
+{
+    QString userName = qgetenv("USER");
+    if (userName.isEmpty()) {
+        userName = qgetenv("USERNAME");
+    }
+    const QString canonicalPath = QFileInfo(databasePath).canonicalFilePath();
+    const QByteArray pathHash = QCryptographicHash::hash(canonicalPath.toUtf8(), QCryptographicHash::Sha256);
+    QString name = "keepassxc-cli";
+    if (!userName.isEmpty()) {
+        name += "-" + userName;
+    }
+    return name + "-" + QString::fromLatin1(pathHash.toHex().left(16));
+}
+
+/**
+ * Start listening for invocations, refusing to replace a server which is still running.
+ *
+ * @param error error message in case of failure
+ * @return true if the server is listening
+ */
+bool CommandServer::listen(QString* error)
+{
+    const QString name = serverName(m_db->filePath());
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    if (socket.waitForConnected(ConnectTimeoutMs)) {
+        if (error) {
+            *error = tr("A server for this database is already running.");
+        }
+        return false;
+    }
+    // Remove the socket left behind by a server that did not shut down
+    QLocalServer::removeServer(name);
+    if (!m_server.listen(name)) {
+        if (error) {
+            *error = m_server.errorString();
+        }
+        return false;
+    }
+    m_idleTimer.start();
+    return true;
+}
+
+/**
+ * Lock the database and stop serving.
+ */
+void CommandServer::close()
+{
+    if (!m_server.isListening() && !m_db) {
+        return;
+    }
+    m_idleTimer.stop();
+    m_server.close();
+    for (auto* socket : m_buffers.keys()) {
+        socket->abort();
+        socket->deleteLater();
+    }
+    m_buffers.clear();
+    if (m_db) {
+        m_db->releaseData();
+        m_db.reset();
+    }
+    emit finished();
+}
+
+/**
+ * Run a command against the served database and capture its output.
+ *
+ * Only commands which opt in through DatabaseCommand::isServable() are
+ * run, the others are refused since they would prompt for input or keep
+ * the server from serving anyone else.
+ *
+ * @param arguments command name and arguments without the database path
+ * @param out standard output of the command
+ * @param err error output of the command
+ * @return exit code of the command
+ */
+int CommandServer::execute(const QStringList& arguments, QByteArray& out, QByteArray& err)
+{
+    m_idleTimer.start();
+
+    return Utils::captureOutput(
+        [&]() -> int {
+            auto command = arguments.isEmpty() ? QSharedPointer<Command>() : Commands::getCommand(arguments.first());
+            auto databaseCommand = command.dynamicCast<DatabaseCommand>();
+            if (!m_db) {
+                Utils::STDERR << tr("The database is locked.") << endl;
+                return EXIT_FAILURE;
+            }
+            if (!databaseCommand) {
+                Utils::STDERR << tr("Command %1 cannot be served.").arg(arguments.value(0)) << endl;
+                return EXIT_FAILURE;
+            }
+            QStringList amendedArgs(arguments);
+            amendedArgs.insert(1, m_db->filePath());
+            auto parser = databaseCommand->getCommandLineParser(amendedArgs);
+            if (!parser) {
+                return EXIT_FAILURE;
+            }
+            if (!databaseCommand->isServable(parser)) {
+                Utils::STDERR << tr("Command %1 cannot be served.").arg(arguments.value(0)) << endl;
+                return EXIT_FAILURE;
+            }
+
+            reloadIfModified();
+            databaseCommand->currentDatabase = m_db;
+            int exitCode = databaseCommand->execute(arguments);
+            databaseCommand->currentDatabase.reset();
+            rememberFileState();
+            return exitCode;
+        },
+        out,
+        err);
+}
+
+/**
+ * Run a command invocation on the server for its database, if one is running.
+ *
+ * @param databasePath path of the database as given on the command line
+ * @param arguments command name and arguments including the database path
+ * @param key key of the database given by the invocation
+ * @param exitCode exit code of the command if it was served
+ * @return true if the invocation was handed to the server
+ */
+bool CommandServer::forward(const QString& databasePath,
+                            const QStringList& arguments,
+                            QSharedPointer<const CompositeKey> key,
+                            int& exitCode)
+{
+    QLocalSocket socket;
+    if (!key || !connectToServer(socket, databasePath)
+        || !sendRequest(socket, ExecuteRequest, keyDigest(*key), withoutDatabasePath(arguments, databasePath))) {
+        return false;
+    }
+
+    // The server may have run the command already, so it is not run again here
+    QByteArray response;
+    if (!readFrame(socket, response, ResponseTimeoutMs)) {
+        Utils::STDERR << tr("The server for the database did not respond.") << endl;
+        exitCode = EXIT_FAILURE;
+        return true;
+    }
+
+    qint32 code = EXIT_FAILURE;
+    QByteArray out;
+    QByteArray err;
+    QDataStream stream(response);
+    stream >> code >> out >> err;
+
+    Utils::STDOUT.flush();
+    Utils::STDERR.flush();
+    Utils::STDOUT.device()->write(out);
+    Utils::STDERR.device()->write(err);
+    exitCode = code;
+    return true;
+}
+
+/**
+ * Ask the server for the database to lock it and stop.
+ *
+ * @return true if a server was running
+ */
+bool CommandServer::stop(const QString& databasePath)
+{
+    QLocalSocket socket;
+    if (!connectToServer(socket, databasePath) || !sendRequest(socket, StopRequest, {}, {})) {
+        return false;
+    }
+    QByteArray response;
+    readFrame(socket, response, RequestTimeoutMs);
+    return true;
+}
+
+void CommandServer::handleConnection()
+{
+    while (m_server.hasPendingConnections()) {
+        auto* socket = m_server.nextPendingConnection();
+        m_buffers.insert(socket, {});
+        connect(socket, SIGNAL(readyRead()), SLOT(handleRequest()));
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket] {
+            m_buffers.remove(socket);
+            socket->deleteLater();
+        });
+        // A client which does not send its request in time must not hold on to the server
+        QTimer::singleShot(RequestTimeoutMs, socket, [this, socket] {
+            if (m_buffers.remove(socket) > 0) {
+                socket->abort();
+            }
+        });
+    }
+}
+
+void CommandServer::handleRequest()
+{
+    auto* socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket || !m_buffers.contains(socket)) {
+        return;
+    }
+
+    QByteArray& buffer = m_buffers[socket];
+    buffer.append(socket->readAll());
+    if (buffer.size() >= 4
+        && qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(buffer.constData())) > MaxRequestSize) {
+        m_buffers.remove(socket);
+        socket->abort();
+        socket->deleteLater();
+        return;
+    }
+
+    QByteArray request;
+    if (!takeFrame(buffer, request)) {
+        return;
+    }
+    // One request per connection
+    m_buffers.remove(socket);
+
+    QString type;
+    QByteArray key;
+    QStringList arguments;
+    QDataStream stream(request);
+    stream >> type >> key >> arguments;
+
+    QByteArray response;
+    QDataStream responseStream(&response, QIODevice::WriteOnly);
+    if (type == ExecuteRequest && (m_keyDigest.isEmpty() || key != m_keyDigest)) {
+        const QByteArray error = tr("The key does not match the served database.").toUtf8() + '\n';
+        responseStream << qint32(EXIT_FAILURE) << QByteArray() << error;
+    } else if (type == ExecuteRequest) {
+        QByteArray out;
+        QByteArray err;
+        qint32 exitCode = execute(arguments, out, err);
+        responseStream << exitCode << out << err;
+    } else {
+        responseStream << qint32(EXIT_SUCCESS) << QByteArray() << QByteArray();
+    }
+    socket->write(frame(response));
+    socket->flush();
+
+    if (type == StopRequest) {
+        socket->waitForBytesWritten(ConnectTimeoutMs);
+        close();
+    }
+}
+
+/**
+ * Read the database again if another program changed its file since the last command.
+ * The database keeps its current state if the file cannot be read.
+ */
+void CommandServer::reloadIfModified()
+{
+    QFileInfo fileInfo(m_db->filePath());
+    if (fileInfo.lastModified() == m_fileModified && fileInfo.size() == m_fileSize) {
+        return;
+    }
+
+    auto db = QSharedPointer<Database>::create();
+    QString error;
+    if (!db->open(m_db->filePath(), m_db->key(), &error)) {
+        Utils::STDERR << tr("Reloading the database failed: %1").arg(error) << endl;
+        return;
+    }
+    m_db->releaseData();
+    m_db = db;
+    MemoryUsage::releaseFreeMemory();
+    rememberFileState();
+}
+
+void CommandServer::rememberFileState()
+{
+    if (!m_db) {
+        return;
+    }
+    QFileInfo fileInfo(m_db->filePath());
+    m_fileModified = fileInfo.lastModified();
+    m_fileSize = fileInfo.size();
+}
@@ -0,0 +1,84 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_COMMANDSERVER_H
+#define KEEPASSXC_COMMANDSERVER_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QLocalServer>
+#include <QSharedPointer>
+#include <QTimer>
+
+class CompositeKey;
+class Database;
+class QLocalSocket;
+
+/**
+ * Serve command invocations against an unlocked database over a local socket.
+ *
+ * The socket is only accessible by the current user and named after the
+ * canonical path of the database, so that invocations of the command line
+ * interface for that database are forwarded to the server instead of
+ * reading the file and transforming the key again. Invocations still have
+ * to present the key of the database, which the server compares by digest.
+ * Only commands which opt in through DatabaseCommand::isServable() are
+ * served. The server locks the database and stops once it has been idle
+ * for the given time.
+ */
+class CommandServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CommandServer(QSharedPointer<Database> db, int idleTimeoutSeconds, QObject* parent = nullptr);
+    ~CommandServer() override;
+
+    bool listen(QString* error = nullptr);
+    int execute(const QStringList& arguments, QByteArray& out, QByteArray& err);
+
+    static QString serverName(const QString& databasePath);
+    static bool forward(const QString& databasePath,
+                        const QStringList& arguments,
+                        QSharedPointer<const CompositeKey> key,
+                        int& exitCode);
+    static bool stop(const QString& databasePath);
+
+public slots:
+    void close();
+
+signals:
+    void finished();
+
+private slots:
+    void handleConnection();
+    void handleRequest();
+
+private:
+    void reloadIfModified();
+    void rememberFileState();
+
+    QSharedPointer<Database> m_db;
+    QByteArray m_keyDigest;
+    QLocalServer m_server;
+    QHash<QLocalSocket*, QByteArray> m_buffers;
+    QTimer m_idleTimer;
+    QDateTime m_fileModified;
+    qint64 m_fileSize = -1;
+};
+
+#endif // KEEPASSXC_COMMANDSERVER_H
@@ -17,8 +17,15 @@
 
 #include "DatabaseCommand.h"
 
+#include "CommandServer.h"
 #include "Utils.h"
 
+namespace
+{
+    bool s_savesDeferred = false;
+    bool s_deferredSave = false;
+} // namespace
+
 DatabaseCommand::DatabaseCommand()
 {
     positionalArguments.append({QString("database"), QObject::tr("Path of the database."), QString("")});
@@ -44,20 +51,31 @@ int DatabaseCommand::execute(const QStringList& arguments)
     QStringList args = parser->positionalArguments();
     auto db = currentDatabase;
     if (!db) {
+        auto key = Utils::getDatabaseKey(args.at(0),
+                                         !parser->isSet(Command::NoPasswordOption),
+                                         parser->value(Command::KeyFileOption),
+#ifdef WITH_XC_YUBIKEY
+                                         parser->value(Command::YubiKeyOption),
+#else
+                                         "",
+#endif
+                                         parser->isSet(Command::QuietOption));
+        if (!key) {
+            return EXIT_FAILURE;
+        }
+
+        // Let a server which already unlocked the database with the same key run the command
+        int exitCode = EXIT_FAILURE;
+        if (isServable(parser) && CommandServer::forward(args.at(0), arguments, key, exitCode)) {
+            return exitCode;
+        }
+
         // It would be nice to update currentDatabase here, but the CLI tests frequently
         // re-use Command objects to exercise non-interactive behavior. Updating the current
         // database confuses these tests. Because of this, we leave it up to the interactive
         // mode implementation in the main command loop to update currentDatabase
         // (see keepassxc-cli.cpp).
-        db = Utils::unlockDatabase(args.at(0),
-                                   !parser->isSet(Command::NoPasswordOption),
-                                   parser->value(Command::KeyFileOption),
-#ifdef WITH_XC_YUBIKEY
-                                   parser->value(Command::YubiKeyOption),
-#else
-                                   "",
-#endif
-                                   parser->isSet(Command::QuietOption));
+        db = Utils::unlockDatabase(args.at(0), key, parser->isSet(Command::QuietOption), isMetadataOnly(parser));
         if (!db) {
             return EXIT_FAILURE;
         }
@@ -65,3 +83,61 @@ int DatabaseCommand::execute(const QStringList& arguments)
 
     return executeWithDatabase(db, parser);
 }
+
+/**
+ * Whether a server (see CommandServer) may run the command for another
+ * invocation. The server has no input and serves one command at a time,
+ * so only commands which neither prompt nor wait opt in.
+ */
+bool DatabaseCommand::isServable(const QSharedPointer<QCommandLineParser>&) const
+{
+    return false;
+}
+
+/**
+ * Whether the command can run in a batch against the database unlocked
+ * by the batch.
+ */
+bool DatabaseCommand::isBatchable() const
+{
+    return true;
+}
+
+/**
+ * Whether the command only looks at the current state of the entries. The
+ * database is then opened read-only, without entry history, custom icons
+ * and attachments, which makes unlocking large databases faster.
+ */
+bool DatabaseCommand::isMetadataOnly(const QSharedPointer<QCommandLineParser>&) const
+{
+    return false;
+}
+
+/**
+ * Defer saving the database after changes until the caller saves it once,
+ * used to run several commands against the same database.
+ *
+ * @param deferred whether commands should leave saving to the caller
+ */
+void DatabaseCommand::setSavesDeferred(bool deferred)
+{
+    s_savesDeferred = deferred;
+    s_deferredSave = false;
+}
+
+/**
+ * @return true if a command changed the database while saves were deferred
+ */
+bool DatabaseCommand::hasDeferredSave()
+{
+    return s_deferredSave;
+}
+
+bool DatabaseCommand::saveDatabase(QSharedPointer<Database> database, QString* error)
+{
+    if (s_savesDeferred) {
+        s_deferredSave = true;
+        return true;
+    }
+    return database->save(error, true, false);
+}
@@ -29,7 +29,16 @@ class DatabaseCommand : public Command
 public:
     DatabaseCommand();
     int execute(const QStringList& arguments) override;
+    virtual bool isServable(const QSharedPointer<QCommandLineParser>& parser) const;
+    virtual bool isBatchable() const;
+    virtual bool isMetadataOnly(const QSharedPointer<QCommandLineParser>& parser) const;
     virtual int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) = 0;
+
+    static void setSavesDeferred(bool deferred);
+    static bool hasDeferredSave();
+
+protected:
+    static bool saveDatabase(QSharedPointer<Database> database, QString* error);
 };
 
 #endif // KEEPASSXC_DATABASECOMMAND_H
@@ -36,12 +36,19 @@ const QCommandLineOption Diceware::WordListOption =
                        QObject::tr("Wordlist for the diceware generator.\n[Default: EFF English]"),
                        QObject::tr("path"));
 
+const QCommandLineOption Diceware::CountOption =
+    QCommandLineOption(QStringList() << "c"
+                                     << "count",
+                       QObject::tr("Number of passphrases to generate"),
+                       QObject::tr("count", "CLI parameter"));
+
 Diceware::Diceware()
 {
     name = QString("diceware");
     description = QObject::tr("Generate a new random diceware passphrase.");
     options.append(Diceware::WordCountOption);
     options.append(Diceware::WordListOption);
+    options.append(Diceware::CountOption);
 }
 
 int Diceware::execute(const QStringList& arguments)
@@ -66,6 +73,16 @@ int Diceware::execute(const QStringList& arguments)
         dicewareGenerator.setWordCount(wordCount.toInt());
     }
 
+    int count = 1;
+    QString countValue = parser->value(Diceware::CountOption);
+    if (!countValue.isEmpty()) {
+        count = countValue.toInt();
+        if (count <= 0) {
+            err << QObject::tr("Invalid count %1").arg(countValue) << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     QString wordListFile = parser->value(Diceware::WordListOption);
     if (!wordListFile.isEmpty()) {
         dicewareGenerator.setWordList(wordListFile);
@@ -78,8 +95,15 @@ int Diceware::execute(const QStringList& arguments)
         return EXIT_FAILURE;
     }
 
-    QString password = dicewareGenerator.generatePassphrase();
-    out << password << endl;
+    // Generate in batches so large counts are streamed instead of being held in memory
+    const int batchSize = 4096;
+    for (int remaining = count; remaining > 0; remaining -= batchSize) {
+        const QStringList passphrases = dicewareGenerator.generatePassphrases(qMin(remaining, batchSize));
+        for (const QString& passphrase : passphrases) {
+            out << passphrase << "\n";
+        }
+        out.flush();
+    }
 
     return EXIT_SUCCESS;
 }
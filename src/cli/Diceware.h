@@ -29,6 +29,7 @@ public:
 
     static const QCommandLineOption WordCountOption;
     static const QCommandLineOption WordListOption;
+    static const QCommandLineOption CountOption;
 };
 
 #endif // KEEPASSXC_DICEWARE_H
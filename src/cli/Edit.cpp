@@ -59,6 +59,12 @@ Edit::Edit()
     options.append(Generate::IncludeEveryGroupOption);
 }
 
+bool Edit::isServable(const QSharedPointer<QCommandLineParser>& parser) const
+{
+    // A server has no input to read the password from
+    return !parser->isSet(Add::PasswordPromptOption);
+}
+
 int Edit::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
 {
     auto& out = parser->isSet(Command::QuietOption) ? Utils::DEVNULL : Utils::STDOUT;
@@ -130,7 +136,7 @@ int Edit::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<
     entry->endUpdate();
 
     QString errorMessage;
-    if (!database->save(&errorMessage, true, false)) {
+    if (!saveDatabase(database, &errorMessage)) {
         err << QObject::tr("Writing the database failed: %1").arg(errorMessage) << endl;
         return EXIT_FAILURE;
     }
@@ -24,6 +24,7 @@ class Edit : public DatabaseCommand
 {
 public:
     Edit();
+    bool isServable(const QSharedPointer<QCommandLineParser>& parser) const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
 
     static const QCommandLineOption TitleOption;
@@ -20,7 +20,6 @@
 
 #include "Export.h"
 
-#include "cli/TextStream.h"
 #include "cli/Utils.h"
 #include "core/Database.h"
 #include "format/CsvExporter.h"
@@ -38,23 +37,28 @@ Export::Export()
     description = QObject::tr("Exports the content of a database to standard output in the specified format.");
 }
 
+bool Export::isServable(const QSharedPointer<QCommandLineParser>&) const
+{
+    return true;
+}
+
 int Export::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
 {
-    TextStream out(Utils::STDOUT.device());
     auto& err = Utils::STDERR;
 
     QString format = parser->value(Export::FormatOption);
     if (format.isEmpty() || format.startsWith(QStringLiteral("xml"), Qt::CaseInsensitive)) {
-        QByteArray xmlData;
         QString errorMessage;
-        if (!database->extract(xmlData, &errorMessage)) {
+        if (!database->extract(Utils::STDOUT.device(), &errorMessage)) {
             err << QObject::tr("Unable to export database to XML: %1").arg(errorMessage) << endl;
             return EXIT_FAILURE;
         }
-        out.write(xmlData.constData());
     } else if (format.startsWith(QStringLiteral("csv"), Qt::CaseInsensitive)) {
         CsvExporter csvExporter;
-        out << csvExporter.exportDatabase(database);
+        if (!csvExporter.exportDatabase(Utils::STDOUT.device(), database)) {
+            err << QObject::tr("Unable to export database to CSV: %1").arg(csvExporter.errorString()) << endl;
+            return EXIT_FAILURE;
+        }
     } else {
         err << QObject::tr("Unsupported format %1").arg(format) << endl;
         return EXIT_FAILURE;
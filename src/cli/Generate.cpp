@@ -59,6 +59,13 @@ const QCommandLineOption Generate::ExcludeSimilarCharsOption =
 
 const QCommandLineOption Generate::IncludeEveryGroupOption =
     QCommandLineOption(QStringList() << "every-group", QObject::tr("Include characters from every selected group"));
+
+const QCommandLineOption Generate::CountOption =
+    QCommandLineOption(QStringList() << "c"
+                                     << "count",
+                       QObject::tr("Number of passwords to generate"),
+                       QObject::tr("count", "CLI parameter"));
+
 Generate::Generate()
 {
     name = QString("generate");
@@ -72,6 +79,7 @@ Generate::Generate()
     options.append(Generate::ExcludeCharsOption);
     options.append(Generate::ExcludeSimilarCharsOption);
     options.append(Generate::IncludeEveryGroupOption);
+    options.append(Generate::CountOption);
 }
 
 /**
@@ -146,8 +154,27 @@ int Generate::execute(const QStringList& arguments)
     }
 
     auto& out = Utils::STDOUT;
-    QString password = passwordGenerator->generatePassword();
-    out << password << endl;
+    auto& err = Utils::STDERR;
+
+    int count = 1;
+    QString countValue = parser->value(Generate::CountOption);
+    if (!countValue.isEmpty()) {
+        count = countValue.toInt();
+        if (count <= 0) {
+            err << QObject::tr("Invalid count %1").arg(countValue) << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Generate in batches so large counts are streamed instead of being held in memory
+    const int batchSize = 4096;
+    for (int remaining = count; remaining > 0; remaining -= batchSize) {
+        const QStringList passwords = passwordGenerator->generatePasswords(qMin(remaining, batchSize));
+        for (const QString& password : passwords) {
+            out << password << "\n";
+        }
+        out.flush();
+    }
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,180 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <limits>
+#include <stdio.h>
+
+#include <QFileInfo>
+
+#include "Create.h"
+#include "GenerateDatabase.h"
+#include "Utils.h"
+
+#include "core/Database.h"
+#include "core/DatabaseGenerator.h"
+
+namespace
+{
+    /**
+     * Read a non-negative integer option into value, leaving value untouched
+     * when the option is not set.
+     *
+     * @return false if the option value is not a number in [0, max]
+     */
+    bool readOption(const QSharedPointer<QCommandLineParser>& parser,
+                    const QCommandLineOption& option,
+                    int& value,
+                    int max = std::numeric_limits<int>::max())
+    {
+        if (!parser->isSet(option)) {
+            return true;
+        }
+
+        bool ok = false;
+        const QString text = parser->value(option);
+        const int number = text.toInt(&ok);
+        if (!ok || number < 0 || number > max) {
+            Utils::STDERR << QObject::tr("Invalid value %1 for option --%2.").arg(text, option.names().last())
+                          << endl;
+            return false;
+        }
+        value = number;
+        return true;
+    }
+} // namespace
+
+const QCommandLineOption GenerateDatabase::SeedOption =
+    QCommandLineOption(QStringList() << "seed", QObject::tr("Seed of the generated content."), QObject::tr("seed"));
+
+const QCommandLineOption GenerateDatabase::GroupsOption =
+    QCommandLineOption(QStringList() << "groups", QObject::tr("Number of groups."), QObject::tr("count"));
+
+const QCommandLineOption GenerateDatabase::EntriesOption =
+    QCommandLineOption(QStringList() << "entries", QObject::tr("Number of entries."), QObject::tr("count"));
+
+const QCommandLineOption GenerateDatabase::HistoryOption =
+    QCommandLineOption(QStringList() << "history",
+                       QObject::tr("Number of history items per entry."),
+                       QObject::tr("count"));
+
+const QCommandLineOption GenerateDatabase::AttachmentsOption =
+    QCommandLineOption(QStringList() << "attachments", QObject::tr("Number of attachments."), QObject::tr("count"));
+
+const QCommandLineOption GenerateDatabase::AttachmentSizeOption =
+    QCommandLineOption(QStringList() << "attachment-size",
+                       QObject::tr("Size of each attachment in bytes."),
+                       QObject::tr("bytes"));
+
+const QCommandLineOption GenerateDatabase::AttachmentDuplicationOption =
+    QCommandLineOption(QStringList() << "attachment-duplication",
+                       QObject::tr("Percentage of attachments that repeat an earlier one."),
+                       QObject::tr("percent"));
+
+const QCommandLineOption GenerateDatabase::IconsOption =
+    QCommandLineOption(QStringList() << "icons", QObject::tr("Number of custom icons."), QObject::tr("count"));
+
+const QCommandLineOption GenerateDatabase::ReferencesOption =
+    QCommandLineOption(QStringList() << "references",
+                       QObject::tr("Number of entries referencing another entry."),
+                       QObject::tr("count"));
+
+const QCommandLineOption GenerateDatabase::AttributesOption =
+    QCommandLineOption(QStringList() << "attributes",
+                       QObject::tr("Number of custom attributes per entry."),
+                       QObject::tr("count"));
+
+const QCommandLineOption GenerateDatabase::PasswordReuseOption =
+    QCommandLineOption(QStringList() << "password-reuse",
+                       QObject::tr("Percentage of entries sharing one password."),
+                       QObject::tr("percent"));
+
+GenerateDatabase::GenerateDatabase()
+{
+    name = QString("db-generate");
+    description = QObject::tr("Create a new database filled with generated content.");
+    positionalArguments.append({QString("database"), QObject::tr("Path of the database."), QString("")});
+    options.append(Create::SetKeyFileOption);
+    options.append(Create::SetPasswordOption);
+    options.append(Create::DecryptionTimeOption);
+    options.append(GenerateDatabase::SeedOption);
+    options.append(GenerateDatabase::GroupsOption);
+    options.append(GenerateDatabase::EntriesOption);
+    options.append(GenerateDatabase::HistoryOption);
+    options.append(GenerateDatabase::AttachmentsOption);
+    options.append(GenerateDatabase::AttachmentSizeOption);
+    options.append(GenerateDatabase::AttachmentDuplicationOption);
+    options.append(GenerateDatabase::IconsOption);
+    options.append(GenerateDatabase::ReferencesOption);
+    options.append(GenerateDatabase::AttributesOption);
+    options.append(GenerateDatabase::PasswordReuseOption);
+}
+
+/**
+ * Create a database file filled with synthetic content for scale testing.
+ * The same options and seed always generate the same content.
+ *
+ * @return EXIT_SUCCESS on success, or EXIT_FAILURE on failure
+ */
+int GenerateDatabase::execute(const QStringList& arguments)
+{
+    QSharedPointer<QCommandLineParser> parser = getCommandLineParser(arguments);
+    if (parser.isNull()) {
+        return EXIT_FAILURE;
+    }
+
+    auto& out = parser->isSet(Command::QuietOption) ? Utils::DEVNULL : Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    const QString& databaseFilename = parser->positionalArguments().at(0);
+    if (QFileInfo::exists(databaseFilename)) {
+        err << QObject::tr("File %1 already exists.").arg(databaseFilename) << endl;
+        return EXIT_FAILURE;
+    }
+
+    DatabaseGenerator::Settings settings;
+    int seed = static_cast<int>(settings.seed);
+    if (!readOption(parser, SeedOption, seed) || !readOption(parser, GroupsOption, settings.groups)
+        || !readOption(parser, EntriesOption, settings.entries)
+        || !readOption(parser, HistoryOption, settings.historyDepth)
+        || !readOption(parser, AttachmentsOption, settings.attachments)
+        || !readOption(parser, AttachmentSizeOption, settings.attachmentSize)
+        || !readOption(parser, AttachmentDuplicationOption, settings.attachmentDuplication, 100)
+        || !readOption(parser, IconsOption, settings.customIcons)
+        || !readOption(parser, ReferencesOption, settings.references)
+        || !readOption(parser, AttributesOption, settings.customAttributes)
+        || !readOption(parser, PasswordReuseOption, settings.passwordReuse, 100)) {
+        return EXIT_FAILURE;
+    }
+    settings.seed = static_cast<quint32>(seed);
+
+    QSharedPointer<Database> db = Create::initializeDatabaseFromOptions(parser);
+    if (!db) {
+        return EXIT_FAILURE;
+    }
+
+    DatabaseGenerator(settings).populate(db.data());
+
+    QString errorMessage;
+    if (!db->saveAs(databaseFilename, &errorMessage, true, false)) {
+        err << QObject::tr("Failed to save the database: %1.").arg(errorMessage) << endl;
+        return EXIT_FAILURE;
+    }
+
+    out << QObject::tr("Successfully generated new database with %n entries.", "", settings.entries) << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,42 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_GENERATEDATABASE_H
+#define KEEPASSXC_GENERATEDATABASE_H
+
+#include "Command.h"
+
+class GenerateDatabase : public Command
+{
+public:
+    GenerateDatabase();
+    int execute(const QStringList& arguments) override;
+
+    static const QCommandLineOption SeedOption;
+    static const QCommandLineOption GroupsOption;
+    static const QCommandLineOption EntriesOption;
+    static const QCommandLineOption HistoryOption;
+    static const QCommandLineOption AttachmentsOption;
+    static const QCommandLineOption AttachmentSizeOption;
+    static const QCommandLineOption AttachmentDuplicationOption;
+    static const QCommandLineOption IconsOption;
+    static const QCommandLineOption ReferencesOption;
+    static const QCommandLineOption AttributesOption;
+    static const QCommandLineOption PasswordReuseOption;
+};
+
+#endif // KEEPASSXC_GENERATEDATABASE_H
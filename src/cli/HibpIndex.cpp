@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "HibpIndex.h"
+
+#include "cli/TextStream.h"
+#include "cli/Utils.h"
+#include "core/HibpOffline.h"
+
+#include <QFile>
+
+const QCommandLineOption HibpIndex::HashBytesOption =
+    QCommandLineOption(QStringList() << "b"
+                                     << "hash-bytes",
+                       QObject::tr("Number of leading SHA-1 bytes kept per hash, smaller indexes at the cost of "
+                                   "false positives (default: 20)."),
+                       QObject::tr("bytes"));
+
+HibpIndex::HibpIndex()
+{
+    name = QString("hibp-index");
+    description = QObject::tr("Convert a HIBP file into a binary index for fast offline lookups.");
+    options.append(HibpIndex::HashBytesOption);
+    positionalArguments.append({QString("hibp"), QObject::tr("Path of the HIBP file to convert."), QString("")});
+    positionalArguments.append({QString("index"), QObject::tr("Path of the index file to write."), QString("")});
+}
+
+int HibpIndex::execute(const QStringList& arguments)
+{
+    QSharedPointer<QCommandLineParser> parser = getCommandLineParser(arguments);
+    if (parser.isNull()) {
+        return EXIT_FAILURE;
+    }
+
+    auto& out = Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    int hashBytes = 20;
+    const QString hashBytesValue = parser->value(HibpIndex::HashBytesOption);
+    if (!hashBytesValue.isEmpty()) {
+        bool ok = false;
+        hashBytes = hashBytesValue.toInt(&ok);
+        if (!ok) {
+            err << QObject::tr("Invalid hash length %1").arg(hashBytesValue) << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const QStringList args = parser->positionalArguments();
+    QFile hibpFile(args.at(0));
+    if (!hibpFile.open(QFile::ReadOnly)) {
+        err << QObject::tr("Failed to open HIBP file %1: %2").arg(args.at(0), hibpFile.errorString()) << endl;
+        return EXIT_FAILURE;
+    }
+
+    // The index is read back when the input has to be sorted
+    QFile indexFile(args.at(1));
+    if (!indexFile.open(QFile::ReadWrite | QFile::Truncate)) {
+        err << QObject::tr("Failed to open index file %1: %2").arg(args.at(1), indexFile.errorString()) << endl;
+        return EXIT_FAILURE;
+    }
+
+    out << QObject::tr("Converting HIBP file, this will take a while...") << endl;
+
+    QString error;
+    if (!HibpOffline::convert(hibpFile, indexFile, hashBytes, &error)) {
+        indexFile.remove();
+        err << error << endl;
+        return EXIT_FAILURE;
+    }
+
+    out << QObject::tr("Successfully wrote HIBP index %1.").arg(args.at(1)) << endl;
+    return EXIT_SUCCESS;
+}
@@ -28,12 +28,23 @@
 #include "cli/TextStream.h"
 #include "cli/Utils.h"
 #include "core/Database.h"
+#include "format/KeePass1Importer.h"
 #include "keys/CompositeKey.h"
 #include "keys/FileKey.h"
 #include "keys/Key.h"
 
+const QCommandLineOption Import::KdbOption =
+    QCommandLineOption(QStringList() << "kdb",
+                       QObject::tr("Import one or more KeePass1 databases instead of an XML export."));
+
+const QCommandLineOption Import::KdbKeyFileOption =
+    QCommandLineOption(QStringList() << "kdb-key-file",
+                       QObject::tr("Key file of the KeePass1 databases."),
+                       QObject::tr("path"));
+
 /**
- * Create a database file from an XML export of another database.
+ * Create a database file from an XML export of another database,
+ * or from a batch of KeePass1 databases with --kdb.
  * A password can be specified to encrypt the database.
  * If none is specified the function will fail.
  *
@@ -47,11 +58,16 @@ Import::Import()
 {
     name = QString("import");
     description = QObject::tr("Import the contents of an XML database.");
-    positionalArguments.append({QString("xml"), QObject::tr("Path of the XML database export."), QString("")});
+    positionalArguments.append(
+        {QString("xml"), QObject::tr("Path of the XML database export, or of the KeePass1 databases."), QString("")});
     positionalArguments.append({QString("database"), QObject::tr("Path of the new database."), QString("")});
     options.append(Create::SetKeyFileOption);
     options.append(Create::SetPasswordOption);
     options.append(Create::DecryptionTimeOption);
+    options.append(Import::KdbOption);
+    options.append(Import::KdbKeyFileOption);
+    // several KeePass1 databases can be given before the new database
+    repeatableLastArgument = true;
 }
 
 int Import::execute(const QStringList& arguments)
@@ -65,8 +81,14 @@ int Import::execute(const QStringList& arguments)
     auto& err = Utils::STDERR;
 
     const QStringList args = parser->positionalArguments();
-    const QString& xmlExportPath = args.at(0);
-    const QString& dbPath = args.at(1);
+    const bool kdb = parser->isSet(Import::KdbOption);
+    if (!kdb && args.size() > 2) {
+        err << getHelpText();
+        return EXIT_FAILURE;
+    }
+
+    const QString& xmlExportPath = args.first();
+    const QString& dbPath = args.last();
 
     if (QFileInfo::exists(dbPath)) {
         err << QObject::tr("File %1 already exists.").arg(dbPath) << endl;
@@ -78,6 +100,10 @@ int Import::execute(const QStringList& arguments)
         return EXIT_FAILURE;
     }
 
+    if (kdb) {
+        return importKeePass1(parser, args.mid(0, args.size() - 1), dbPath, db);
+    }
+
     QString errorMessage;
     if (!db->import(xmlExportPath, &errorMessage)) {
         err << QObject::tr("Unable to import XML database: %1").arg(errorMessage) << endl;
@@ -92,3 +118,62 @@ int Import::execute(const QStringList& arguments)
     out << QObject::tr("Successfully imported database.") << endl;
     return EXIT_SUCCESS;
 }
+
+/**
+ * Import a batch of KeePass1 databases sharing the same credentials into the new
+ * database, one group per file. The files are read concurrently, progress is
+ * reported per file and the new database is only saved if every file was imported.
+ *
+ * @return EXIT_SUCCESS on success, or EXIT_FAILURE on failure
+ */
+int Import::importKeePass1(const QSharedPointer<QCommandLineParser>& parser,
+                           const QStringList& kdbPaths,
+                           const QString& dbPath,
+                           QSharedPointer<Database> db)
+{
+    auto& out = parser->isSet(Command::QuietOption) ? Utils::DEVNULL : Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    if (!parser->isSet(Command::QuietOption)) {
+        err << QObject::tr("Enter password of the KeePass1 databases: ") << flush;
+    }
+    const QString password = Utils::getPassword(parser->isSet(Command::QuietOption));
+
+    KeePass1Importer importer;
+    importer.setPassword(password);
+    importer.setKeyFile(parser->value(Import::KdbKeyFileOption));
+    QObject::connect(&importer,
+                     &KeePass1Importer::fileImported,
+                     [&](int done, int total, const QString& path, const QString& error) {
+                         if (error.isEmpty()) {
+                             out << QObject::tr("[%1/%2] Imported %3.").arg(done).arg(total).arg(path) << endl;
+                         } else {
+                             err << QObject::tr("[%1/%2] Unable to import %3: %4")
+                                        .arg(done)
+                                        .arg(total)
+                                        .arg(path, error)
+                                 << endl;
+                         }
+                     });
+
+    int failed = 0;
+    for (const auto& result : importer.import(kdbPaths, db.data())) {
+        if (!result.error.isEmpty()) {
+            ++failed;
+        }
+    }
+    if (failed > 0) {
+        err << QObject::tr("%n database(s) could not be imported, the new database was not saved.", "", failed)
+            << endl;
+        return EXIT_FAILURE;
+    }
+
+    QString errorMessage;
+    if (!db->saveAs(dbPath, &errorMessage, true, false)) {
+        err << QObject::tr("Failed to save the database: %1.").arg(errorMessage) << endl;
+        return EXIT_FAILURE;
+    }
+
+    out << QObject::tr("Successfully imported database.") << endl;
+    return EXIT_SUCCESS;
+}
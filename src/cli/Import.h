@@ -25,6 +25,15 @@ class Import : public Command
 public:
     Import();
     int execute(const QStringList& arguments) override;
+
+    static const QCommandLineOption KdbOption;
+    static const QCommandLineOption KdbKeyFileOption;
+
+private:
+    int importKeePass1(const QSharedPointer<QCommandLineParser>& parser,
+                       const QStringList& kdbPaths,
+                       const QString& dbPath,
+                       QSharedPointer<Database> db);
 };
 
 #endif // KEEPASSXC_IMPORT_H
@@ -23,15 +23,31 @@
 #include "core/Database.h"
 #include "core/Global.h"
 #include "core/Metadata.h"
+#include "core/Tools.h"
 #include "format/KeePass2.h"
 
+const QCommandLineOption Info::MemoryOption =
+    QCommandLineOption(QStringList() << "memory", QObject::tr("Show the estimated memory used by the database."));
+
 Info::Info()
 {
     name = QString("db-info");
     description = QObject::tr("Show a database's information.");
+    options.append(Info::MemoryOption);
 }
 
-int Info::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser>)
+bool Info::isServable(const QSharedPointer<QCommandLineParser>&) const
+{
+    return true;
+}
+
+bool Info::isMetadataOnly(const QSharedPointer<QCommandLineParser>& parser) const
+{
+    // The memory report needs the history, icons and attachments
+    return !parser->isSet(Info::MemoryOption);
+}
+
+int Info::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
 {
     auto& out = Utils::STDOUT;
 
@@ -49,5 +65,22 @@ int Info::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<
     } else {
         out << QObject::tr("Recycle bin is not enabled.") << endl;
     }
+
+    if (parser->isSet(Info::MemoryOption)) {
+        const MemoryUsage usage = database->memoryUsage();
+        out << QObject::tr("Estimated memory usage: ") << Tools::humanReadableFileSize(usage.total()) << endl;
+        out << QObject::tr("  Entries: ") << Tools::humanReadableFileSize(usage.entries) << endl;
+        out << QObject::tr("  History items: ") << Tools::humanReadableFileSize(usage.historyItems) << endl;
+        out << QObject::tr("  Attachments: %1 (%2 before deduplication)")
+                   .arg(Tools::humanReadableFileSize(usage.attachmentsDeduplicated),
+                        Tools::humanReadableFileSize(usage.attachmentsTotal))
+            << endl;
+        out << QObject::tr("  Custom icons: %1 (%2 decoded)")
+                   .arg(Tools::humanReadableFileSize(usage.customIconsRaw),
+                        Tools::humanReadableFileSize(usage.customIconsDecoded))
+            << endl;
+        out << QObject::tr("  Custom data: ") << Tools::humanReadableFileSize(usage.customData) << endl;
+        out << QObject::tr("  Deleted objects: ") << Tools::humanReadableFileSize(usage.deletedObjects) << endl;
+    }
     return EXIT_SUCCESS;
 }
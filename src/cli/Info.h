@@ -25,7 +25,11 @@ class Info : public DatabaseCommand
 public:
     Info();
 
+    bool isServable(const QSharedPointer<QCommandLineParser>& parser) const override;
+    bool isMetadataOnly(const QSharedPointer<QCommandLineParser>& parser) const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser);
+
+    static const QCommandLineOption MemoryOption;
 };
 
 #endif // KEEPASSXC_INFO_H
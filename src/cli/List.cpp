@@ -35,16 +35,54 @@ const QCommandLineOption List::FlattenOption = QCommandLineOption(QStringList()
                                                                                 << "flatten",
                                                                   QObject::tr("Flattens the output to single lines."));
 
+namespace
+{
+    void writeGroupRecords(QTextStream& out, Utils::OutputFormat format, const Group* group, bool recursive)
+    {
+        const QString path = Utils::groupPath(group);
+        for (const Entry* entry : group->entries()) {
+            Utils::writeRecord(out,
+                               format,
+                               {{"type", "entry"},
+                                {"path", path + entry->title()},
+                                {"title", entry->title()},
+                                {"uuid", entry->uuidToHex()}});
+        }
+        for (const Group* child : group->children()) {
+            Utils::writeRecord(out,
+                               format,
+                               {{"type", "group"},
+                                {"path", path + child->name() + "/"},
+                                {"title", child->name()},
+                                {"uuid", child->uuidToHex()}});
+            if (recursive) {
+                writeGroupRecords(out, format, child, recursive);
+            }
+        }
+    }
+} // namespace
+
 List::List()
 {
     name = QString("ls");
     description = QObject::tr("List database entries.");
     options.append(List::RecursiveOption);
     options.append(List::FlattenOption);
+    options.append(Command::FormatOption);
     optionalArguments.append(
         {QString("group"), QObject::tr("Path of the group to list. Default is /"), QString("[group]")});
 }
 
+bool List::isServable(const QSharedPointer<QCommandLineParser>&) const
+{
+    return true;
+}
+
+bool List::isMetadataOnly(const QSharedPointer<QCommandLineParser>&) const
+{
+    return true;
+}
+
 int List::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
 {
     auto& out = Utils::STDOUT;
@@ -54,19 +92,28 @@ int List::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<
     bool recursive = parser->isSet(List::RecursiveOption);
     bool flatten = parser->isSet(List::FlattenOption);
 
-    // No group provided, defaulting to root group.
-    if (args.size() == 1) {
-        out << database->rootGroup()->print(recursive, flatten) << flush;
-        return EXIT_SUCCESS;
+    Utils::OutputFormat format;
+    if (!Utils::parseOutputFormat(parser->value(Command::FormatOption), format)) {
+        err << QObject::tr("Unsupported format %1.").arg(parser->value(Command::FormatOption)) << endl;
+        return EXIT_FAILURE;
     }
 
-    const QString& groupPath = args.at(1);
-    Group* group = database->rootGroup()->findGroupByPath(groupPath);
-    if (!group) {
-        err << QObject::tr("Cannot find group %1.").arg(groupPath) << endl;
-        return EXIT_FAILURE;
+    // No group provided, defaulting to root group.
+    Group* group = database->rootGroup();
+    if (args.size() > 1) {
+        const QString& groupPath = args.at(1);
+        group = database->rootGroup()->findGroupByPath(groupPath);
+        if (!group) {
+            err << QObject::tr("Cannot find group %1.").arg(groupPath) << endl;
+            return EXIT_FAILURE;
+        }
     }
 
-    out << group->print(recursive, flatten) << flush;
+    if (format == Utils::OutputFormat::Text) {
+        group->print(out, recursive, flatten);
+    } else {
+        writeGroupRecords(out, format, group, recursive);
+    }
+    out << flush;
     return EXIT_SUCCESS;
 }
@@ -25,6 +25,8 @@ class List : public DatabaseCommand
 public:
     List();
 
+    bool isServable(const QSharedPointer<QCommandLineParser>& parser) const override;
+    bool isMetadataOnly(const QSharedPointer<QCommandLineParser>& parser) const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
 
     static const QCommandLineOption RecursiveOption;
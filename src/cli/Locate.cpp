@@ -34,6 +34,17 @@ Locate::Locate()
     name = QString("locate");
     description = QObject::tr("Find entries quickly.");
     positionalArguments.append({QString("term"), QObject::tr("Search term."), QString("")});
+    options.append(Command::FormatOption);
+}
+
+bool Locate::isServable(const QSharedPointer<QCommandLineParser>&) const
+{
+    return true;
+}
+
+bool Locate::isMetadataOnly(const QSharedPointer<QCommandLineParser>&) const
+{
+    return true;
 }
 
 int Locate::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
@@ -44,14 +55,39 @@ int Locate::executeWithDatabase(QSharedPointer<Database> database, QSharedPointe
     const QStringList args = parser->positionalArguments();
     const QString& searchTerm = args.at(1);
 
-    QStringList results = database->rootGroup()->locate(searchTerm);
-    if (results.isEmpty()) {
-        err << "No results for that search term." << endl;
+    Utils::OutputFormat format;
+    if (!Utils::parseOutputFormat(parser->value(Command::FormatOption), format)) {
+        err << QObject::tr("Unsupported format %1.").arg(parser->value(Command::FormatOption)) << endl;
         return EXIT_FAILURE;
     }
 
-    for (const QString& result : asConst(results)) {
-        out << result << endl;
+    // Write the matches while visiting the groups in the order of Group::locate()
+    int results = 0;
+    if (!searchTerm.isEmpty()) {
+        const Group* root = database->rootGroup();
+        root->forEachGroupRecursive([&](const Group* group) -> bool {
+            const QString groupPath = Utils::groupPath(group);
+            for (const Entry* entry : group->entries()) {
+                const QString entryPath = groupPath + entry->title();
+                if (!entryPath.contains(searchTerm, Qt::CaseInsensitive)) {
+                    continue;
+                }
+                ++results;
+                if (format == Utils::OutputFormat::Text) {
+                    out << entryPath << endl;
+                } else {
+                    Utils::writeRecord(
+                        out, format, {{"path", entryPath}, {"title", entry->title()}, {"uuid", entry->uuidToHex()}});
+                }
+            }
+            return true;
+        });
+    }
+    out << flush;
+
+    if (results == 0) {
+        err << "No results for that search term." << endl;
+        return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
 }
@@ -25,6 +25,8 @@ class Locate : public DatabaseCommand
 public:
     Locate();
 
+    bool isServable(const QSharedPointer<QCommandLineParser>& parser) const override;
+    bool isMetadataOnly(const QSharedPointer<QCommandLineParser>& parser) const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
 };
 
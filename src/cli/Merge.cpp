@@ -23,11 +23,16 @@
 #include "cli/Utils.h"
 #include "core/Database.h"
 #include "core/Merger.h"
+#include "format/KeePass2Reader.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QtConcurrent>
 
 const QCommandLineOption Merge::SameCredentialsOption =
     QCommandLineOption(QStringList() << "s"
                                      << "same-credentials",
-                       QObject::tr("Use the same credentials for both database files."));
+                       QObject::tr("Use the same credentials for all database files."));
 
 const QCommandLineOption Merge::KeyFileFromOption =
     QCommandLineOption(QStringList() << "key-file-from",
@@ -43,12 +48,44 @@ const QCommandLineOption Merge::DryRunOption =
                        QObject::tr("Only print the changes detected by the merge operation."));
 
 const QCommandLineOption Merge::YubiKeyFromOption(QStringList() << "yubikey-from",
-                                                  QObject::tr("Yubikey slot for the second database."),
+                                                  QObject::tr("Yubikey slot for the databases to merge from."),
                                                   QObject::tr("slot"));
+
+namespace
+{
+    struct SourceDatabase
+    {
+        QSharedPointer<Database> database;
+        QString error;
+    };
+
+    /**
+     * Read a database to merge from. The databases are read and their keys
+     * derived on worker threads, the merge happens on the main thread.
+     */
+    SourceDatabase readSourceDatabase(const QString& path, QSharedPointer<const CompositeKey> key)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return {{}, QObject::tr("Unable to open file %1.").arg(path)};
+        }
+
+        auto db = QSharedPointer<Database>::create();
+        db->setEmitModified(false);
+        KeePass2Reader reader;
+        if (!reader.readDatabase(&file, std::move(key), db.data())) {
+            return {{}, reader.errorString()};
+        }
+
+        db->moveToThread(QCoreApplication::instance()->thread());
+        return {db, {}};
+    }
+} // namespace
+
 Merge::Merge()
 {
     name = QString("merge");
-    description = QObject::tr("Merge two databases.");
+    description = QObject::tr("Merge databases.");
     options.append(Merge::SameCredentialsOption);
     options.append(Merge::KeyFileFromOption);
     options.append(Merge::NoPasswordFromOption);
@@ -56,7 +93,9 @@ Merge::Merge()
 #ifdef WITH_XC_YUBIKEY
     options.append(Merge::YubiKeyFromOption);
 #endif
-    positionalArguments.append({QString("database2"), QObject::tr("Path of the database to merge from."), QString("")});
+    positionalArguments.append(
+        {QString("database2"), QObject::tr("Paths of the databases to merge from."), QString("database2...")});
+    repeatableLastArgument = true;
 }
 
 int Merge::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
@@ -67,29 +106,52 @@ int Merge::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer
     const QStringList args = parser->positionalArguments();
 
     auto& toDatabasePath = args.at(0);
-    auto& fromDatabasePath = args.at(1);
-
-    QSharedPointer<Database> db2;
-    if (!parser->isSet(Merge::SameCredentialsOption)) {
-        db2 = Utils::unlockDatabase(fromDatabasePath,
-                                    !parser->isSet(Merge::NoPasswordFromOption),
-                                    parser->value(Merge::KeyFileFromOption),
-                                    parser->value(Merge::YubiKeyFromOption),
-                                    parser->isSet(Command::QuietOption));
-        if (!db2) {
-            return EXIT_FAILURE;
+    const QStringList fromDatabasePaths = args.mid(1);
+
+    // Ask for all credentials first, the passwords are read one after another
+    QList<QSharedPointer<const CompositeKey>> keys;
+    for (const QString& fromDatabasePath : fromDatabasePaths) {
+        if (parser->isSet(Merge::SameCredentialsOption)) {
+            keys.append(database->key());
+            continue;
         }
-    } else {
-        db2 = QSharedPointer<Database>::create();
-        QString errorMessage;
-        if (!db2->open(fromDatabasePath, database->key(), &errorMessage, false)) {
-            err << QObject::tr("Error reading merge file:\n%1").arg(errorMessage);
+
+        auto key = Utils::getDatabaseKey(fromDatabasePath,
+                                         !parser->isSet(Merge::NoPasswordFromOption),
+                                         parser->value(Merge::KeyFileFromOption),
+                                         parser->value(Merge::YubiKeyFromOption),
+                                         parser->isSet(Command::QuietOption));
+        if (!key) {
             return EXIT_FAILURE;
         }
+        keys.append(key);
+    }
+
+    // Derive the keys of all sources concurrently, except for a YubiKey, which can only answer one at a time
+    const bool sequential = !parser->value(Merge::YubiKeyFromOption).isEmpty();
+    QList<QFuture<SourceDatabase>> sources;
+    for (int i = 0; i < fromDatabasePaths.size(); ++i) {
+        sources.append(QtConcurrent::run(readSourceDatabase, fromDatabasePaths.at(i), keys.at(i)));
+        if (sequential) {
+            sources.last().waitForFinished();
+        }
     }
 
-    Merger merger(db2.data(), database.data());
-    QStringList changeList = merger.merge();
+    // Merge the sources in order as they become available, the target is saved once
+    QStringList changeList;
+    for (int i = 0; i < sources.size(); ++i) {
+        const SourceDatabase source = sources[i].result();
+        if (!source.database) {
+            err << QObject::tr("Error reading merge file:\n%1").arg(source.error) << endl;
+            for (auto& pending : sources) {
+                pending.waitForFinished();
+            }
+            return EXIT_FAILURE;
+        }
+
+        Merger merger(source.database.data(), database.data());
+        changeList << merger.merge();
+    }
 
     for (auto& mergeChange : changeList) {
         out << "\t" << mergeChange << endl;
@@ -97,11 +159,13 @@ int Merge::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer
 
     if (!changeList.isEmpty() && !parser->isSet(Merge::DryRunOption)) {
         QString errorMessage;
-        if (!database->save(&errorMessage, true, false)) {
+        if (!saveDatabase(database, &errorMessage)) {
             err << QObject::tr("Unable to save database to file : %1").arg(errorMessage) << endl;
             return EXIT_FAILURE;
         }
-        out << QObject::tr("Successfully merged %1 into %2.").arg(fromDatabasePath, toDatabasePath) << endl;
+        out << QObject::tr("Successfully merged %1 into %2.")
+                   .arg(fromDatabasePaths.join(QStringLiteral(", ")), toDatabasePath)
+            << endl;
     } else {
         out << QObject::tr("Database was not modified by merge operation.") << endl;
     }
@@ -26,6 +26,7 @@ public:
     Move();
     ~Move();
 
+    bool isServable(const QSharedPointer<QCommandLineParser>& parser) const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser);
 };
 
@@ -35,6 +35,11 @@ int Open::execute(const QStringList& arguments)
     return this->DatabaseCommand::execute(arguments);
 }
 
+bool Open::isBatchable() const
+{
+    return false;
+}
+
 int Open::executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser)
 {
     Q_UNUSED(parser)
@@ -25,6 +25,7 @@ class Open : public DatabaseCommand
 public:
     Open();
     int execute(const QStringList& arguments) override;
+    bool isBatchable() const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
 };
 
@@ -0,0 +1,95 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Probe.h"
+
+#include "cli/TextStream.h"
+#include "cli/Utils.h"
+#include "core/Database.h"
+#include "core/Global.h"
+#include "format/KeePass2.h"
+#include "format/KeePass2Reader.h"
+
+#include <QDirIterator>
+#include <QFileInfo>
+
+namespace
+{
+    QString cipherName(const QUuid& uuid)
+    {
+        for (auto& cipher : asConst(KeePass2::CIPHERS)) {
+            if (cipher.first == uuid) {
+                return cipher.second;
+            }
+        }
+        return uuid.toString();
+    }
+
+    QString compressionName(quint32 algorithm)
+    {
+        return algorithm == Database::CompressionGZip ? QStringLiteral("GZip") : QObject::tr("None");
+    }
+} // namespace
+
+Probe::Probe()
+{
+    name = QString("db-probe");
+    description = QObject::tr("Show the unencrypted header of databases without opening them.");
+    positionalArguments.append(
+        {QString("path"), QObject::tr("Database file or directory to scan for .kdbx files."), QString("")});
+}
+
+int Probe::execute(const QStringList& arguments)
+{
+    QSharedPointer<QCommandLineParser> parser = getCommandLineParser(arguments);
+    if (parser.isNull()) {
+        return EXIT_FAILURE;
+    }
+
+    auto& out = Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    const QString path = parser->positionalArguments().at(0);
+    QStringList files;
+    if (QFileInfo(path).isDir()) {
+        QDirIterator it(path, {"*.kdbx"}, QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            files.append(it.next());
+        }
+        files.sort();
+    } else {
+        files.append(path);
+    }
+
+    int result = EXIT_SUCCESS;
+    for (const QString& file : asConst(files)) {
+        KeePass2Reader reader;
+        KdbxHeaderInfo header;
+        if (!reader.readHeader(file, header)) {
+            err << QObject::tr("Failed to read header of %1: %2").arg(file, reader.errorString()) << endl;
+            result = EXIT_FAILURE;
+            continue;
+        }
+
+        // one tab-separated line per database to keep the output easy to parse
+        out << file << '\t' << QString("KDBX %1.%2").arg(header.version >> 16).arg(header.version & 0xFFFF) << '\t'
+            << cipherName(header.cipher) << '\t' << (header.kdf ? header.kdf->toString() : QString()) << '\t'
+            << compressionName(header.compressionAlgorithm) << endl;
+    }
+
+    return result;
+}
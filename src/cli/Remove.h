@@ -25,6 +25,7 @@ class Remove : public DatabaseCommand
 public:
     Remove();
 
+    bool isServable(const QSharedPointer<QCommandLineParser>& parser) const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser);
 };
 
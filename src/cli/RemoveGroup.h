@@ -26,6 +26,7 @@ public:
     RemoveGroup();
     ~RemoveGroup();
 
+    bool isServable(const QSharedPointer<QCommandLineParser>& parser) const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser);
 };
 
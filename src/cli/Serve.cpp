@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Serve.h"
+
+#include <QEventLoop>
+
+#include "CommandServer.h"
+#include "TextStream.h"
+#include "Utils.h"
+
+const QCommandLineOption Serve::IdleTimeoutOption =
+    QCommandLineOption(QStringList() << "idle-timeout",
+                       QObject::tr("Lock the database and stop after being idle for the given time in seconds."),
+                       QObject::tr("seconds"),
+                       "600");
+
+const QCommandLineOption Serve::StopOption =
+    QCommandLineOption(QStringList() << "stop", QObject::tr("Stop the server running for the database."));
+
+Serve::Serve()
+{
+    name = QString("serve");
+    description = QObject::tr("Keep a database unlocked for other invocations of this program.");
+    options.append(Serve::IdleTimeoutOption);
+    options.append(Serve::StopOption);
+}
+
+int Serve::execute(const QStringList& arguments)
+{
+    auto parser = getCommandLineParser(arguments);
+    if (parser.isNull()) {
+        return EXIT_FAILURE;
+    }
+
+    if (parser->isSet(Serve::StopOption)) {
+        const QString databasePath = parser->positionalArguments().at(0);
+        if (!CommandServer::stop(databasePath)) {
+            Utils::STDERR << QObject::tr("No server is running for database %1.").arg(databasePath) << endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    return DatabaseCommand::execute(arguments);
+}
+
+bool Serve::isBatchable() const
+{
+    return false;
+}
+
+int Serve::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
+{
+    auto& out = parser->isSet(Command::QuietOption) ? Utils::DEVNULL : Utils::STDERR;
+    auto& err = Utils::STDERR;
+
+    const QString idleTimeout = parser->value(Serve::IdleTimeoutOption);
+    if (idleTimeout.toInt() <= 0) {
+        err << QObject::tr("Invalid idle timeout value %1.").arg(idleTimeout) << endl;
+        return EXIT_FAILURE;
+    }
+
+    CommandServer server(database, idleTimeout.toInt());
+    database.reset();
+    QString error;
+    if (!server.listen(&error)) {
+        err << error << endl;
+        return EXIT_FAILURE;
+    }
+
+    out << QObject::tr("Serving the database until it is idle for %n second(s).", "", idleTimeout.toInt()) << endl;
+
+    QEventLoop loop;
+    QObject::connect(&server, &CommandServer::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    return EXIT_SUCCESS;
+}
@@ -54,9 +54,20 @@ Show::Show()
     options.append(Show::TotpOption);
     options.append(Show::AttributesOption);
     options.append(Show::ProtectedAttributesOption);
+    options.append(Command::FormatOption);
     positionalArguments.append({QString("entry"), QObject::tr("Name of the entry to show."), QString("")});
 }
 
+bool Show::isServable(const QSharedPointer<QCommandLineParser>&) const
+{
+    return true;
+}
+
+bool Show::isMetadataOnly(const QSharedPointer<QCommandLineParser>&) const
+{
+    return true;
+}
+
 int Show::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
 {
     auto& out = Utils::STDOUT;
@@ -68,6 +79,12 @@ int Show::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<
     bool showProtectedAttributes = parser->isSet(Show::ProtectedAttributesOption);
     QStringList attributes = parser->values(Show::AttributesOption);
 
+    Utils::OutputFormat format;
+    if (!Utils::parseOutputFormat(parser->value(Command::FormatOption), format)) {
+        err << QObject::tr("Unsupported format %1.").arg(parser->value(Command::FormatOption)) << endl;
+        return EXIT_FAILURE;
+    }
+
     Entry* entry = database->rootGroup()->findEntryByPath(entryPath);
     if (!entry) {
         err << QObject::tr("Could not find entry with path %1.").arg(entryPath) << endl;
@@ -86,6 +103,8 @@ int Show::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<
     }
 
     // Iterate over the attributes and output them line-by-line.
+    // Other formats name every value, as for the default attributes.
+    QList<QPair<QString, QString>> fields;
     bool encounteredError = false;
     for (const QString& attributeName : asConst(attributes)) {
         QStringList attrs = Utils::findAttributes(*entry->attributes(), attributeName);
@@ -101,19 +120,38 @@ int Show::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<
             continue;
         }
         QString canonicalName = attrs[0];
+        QString value;
+        if (entry->attributes()->isProtected(canonicalName) && showDefaultAttributes && !showProtectedAttributes) {
+            value = "PROTECTED";
+        } else {
+            value = entry->resolveMultiplePlaceholders(entry->attributes()->value(canonicalName));
+        }
+        if (format != Utils::OutputFormat::Text) {
+            fields.append({canonicalName, value});
+            continue;
+        }
         if (showDefaultAttributes) {
             out << canonicalName << ": ";
         }
-        if (entry->attributes()->isProtected(canonicalName) && showDefaultAttributes && !showProtectedAttributes) {
-            out << "PROTECTED" << endl;
+        out << value << endl;
+    }
+
+    if (showTotp) {
+        if (format != Utils::OutputFormat::Text) {
+            fields.append({QStringLiteral("TOTP"), entry->totp()});
         } else {
-            out << entry->resolveMultiplePlaceholders(entry->attributes()->value(canonicalName)) << endl;
+            out << entry->totp() << endl;
         }
     }
 
-    if (showTotp) {
-        out << entry->totp() << endl;
+    if (format == Utils::OutputFormat::Json) {
+        Utils::writeRecord(out, format, fields);
+    } else if (format == Utils::OutputFormat::Tsv) {
+        for (const auto& field : asConst(fields)) {
+            Utils::writeRecord(out, format, {{"name", field.first}, {"value", field.second}});
+        }
     }
+    out << flush;
 
     return encounteredError ? EXIT_FAILURE : EXIT_SUCCESS;
 }
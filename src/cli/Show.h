@@ -25,6 +25,8 @@ class Show : public DatabaseCommand
 public:
     Show();
 
+    bool isServable(const QSharedPointer<QCommandLineParser>& parser) const override;
+    bool isMetadataOnly(const QSharedPointer<QCommandLineParser>& parser) const override;
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser);
 
     static const QCommandLineOption TotpOption;
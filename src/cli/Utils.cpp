@@ -28,7 +28,12 @@
 #include <unistd.h>
 #endif
 
+#include "core/Group.h"
+
+#include <QBuffer>
 #include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QProcess>
 #include <QScopedPointer>
 
@@ -90,11 +95,17 @@ namespace Utils
 #endif
     }
 
-    QSharedPointer<Database> unlockDatabase(const QString& databaseFilename,
-                                            const bool isPasswordProtected,
-                                            const QString& keyFilename,
-                                            const QString& yubiKeySlot,
-                                            bool quiet)
+    /**
+     * Check that the database file can be read and build its key, asking
+     * for the password if the database is password protected.
+     *
+     * @return the key or null on error
+     */
+    QSharedPointer<CompositeKey> getDatabaseKey(const QString& databaseFilename,
+                                                const bool isPasswordProtected,
+                                                const QString& keyFilename,
+                                                const QString& yubiKeySlot,
+                                                bool quiet)
     {
         auto& err = quiet ? DEVNULL : STDERR;
         auto compositeKey = QSharedPointer<CompositeKey>::create();
@@ -173,9 +184,32 @@ namespace Utils
         Q_UNUSED(yubiKeySlot);
 #endif // WITH_XC_YUBIKEY
 
+        return compositeKey;
+    }
+
+    QSharedPointer<Database> unlockDatabase(const QString& databaseFilename,
+                                            const bool isPasswordProtected,
+                                            const QString& keyFilename,
+                                            const QString& yubiKeySlot,
+                                            bool quiet,
+                                            bool metadataOnly)
+    {
+        auto compositeKey = getDatabaseKey(databaseFilename, isPasswordProtected, keyFilename, yubiKeySlot, quiet);
+        if (!compositeKey) {
+            return {};
+        }
+        return unlockDatabase(databaseFilename, compositeKey, quiet, metadataOnly);
+    }
+
+    QSharedPointer<Database> unlockDatabase(const QString& databaseFilename,
+                                            QSharedPointer<CompositeKey> compositeKey,
+                                            bool quiet,
+                                            bool metadataOnly)
+    {
+        auto& err = quiet ? DEVNULL : STDERR;
         auto db = QSharedPointer<Database>::create();
         QString error;
-        if (db->open(databaseFilename, compositeKey, &error, false)) {
+        if (db->open(databaseFilename, compositeKey, &error, false, metadataOnly)) {
             return db;
         } else {
             err << error << endl;
@@ -354,6 +388,101 @@ namespace Utils
         return result;
     }
 
+    /**
+     * Run a function with the standard streams redirected to buffers.
+     * The function reads an empty input, so prompts behave as if the input was empty.
+     *
+     * @param run function to run, usually executing a command
+     * @param out standard output written by the function
+     * @param err error output written by the function
+     * @return result of the function
+     */
+    int captureOutput(const std::function<int()>& run, QByteArray& out, QByteArray& err)
+    {
+        QBuffer outBuffer(&out);
+        QBuffer errBuffer(&err);
+        QBuffer inBuffer;
+        outBuffer.open(QIODevice::WriteOnly);
+        errBuffer.open(QIODevice::WriteOnly);
+        inBuffer.open(QIODevice::ReadOnly);
+
+        auto* stdoutDevice = STDOUT.device();
+        auto* stderrDevice = STDERR.device();
+        auto* stdinDevice = STDIN.device();
+        STDOUT.setDevice(&outBuffer);
+        STDERR.setDevice(&errBuffer);
+        STDIN.setDevice(&inBuffer);
+
+        int result = run();
+
+        STDOUT.flush();
+        STDERR.flush();
+        STDOUT.setDevice(stdoutDevice);
+        STDERR.setDevice(stderrDevice);
+        STDIN.setDevice(stdinDevice);
+
+        return result;
+    }
+
+    /**
+     * Parse the value of the format option, see Command::FormatOption.
+     *
+     * @return false if the value is not a known format
+     */
+    bool parseOutputFormat(const QString& value, OutputFormat& format)
+    {
+        if (value == "text") {
+            format = OutputFormat::Text;
+        } else if (value == "json") {
+            format = OutputFormat::Json;
+        } else if (value == "tsv") {
+            format = OutputFormat::Tsv;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Write one record as a line, either a JSON object or tab separated values
+     * in the order of the fields. Tabs, line breaks and backslashes in TSV values
+     * are escaped with backslashes. Nothing is written for the text format.
+     */
+    void writeRecord(QTextStream& out, OutputFormat format, const QList<QPair<QString, QString>>& fields)
+    {
+        if (format == OutputFormat::Json) {
+            QJsonObject record;
+            for (const auto& field : fields) {
+                record[field.first] = field.second;
+            }
+            out << QJsonDocument(record).toJson(QJsonDocument::Compact) << "\n";
+        } else if (format == OutputFormat::Tsv) {
+            bool first = true;
+            for (const auto& field : fields) {
+                QString value(field.second);
+                value.replace("\\", "\\\\").replace("\t", "\\t").replace("\n", "\\n").replace("\r", "\\r");
+                if (!first) {
+                    out << "\t";
+                }
+                out << value;
+                first = false;
+            }
+            out << "\n";
+        }
+    }
+
+    /**
+     * Path of a group as used by the commands, starting and ending with a slash.
+     */
+    QString groupPath(const Group* group)
+    {
+        const QStringList names = group->hierarchy().mid(1);
+        if (names.isEmpty()) {
+            return QStringLiteral("/");
+        }
+        return "/" + names.join("/") + "/";
+    }
+
     QStringList findAttributes(const EntryAttributes& attributes, const QString& name)
     {
         QStringList result;
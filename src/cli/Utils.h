@@ -26,8 +26,18 @@
 #include "keys/PasswordKey.h"
 #include <QtCore/qglobal.h>
 
+#include <functional>
+
+class Group;
+
 namespace Utils
 {
+    enum class OutputFormat
+    {
+        Text,
+        Json,
+        Tsv
+    };
     extern QTextStream STDOUT;
     extern QTextStream STDERR;
     extern QTextStream STDIN;
@@ -40,13 +50,28 @@ namespace Utils
     QString getPassword(bool quiet = false);
     QSharedPointer<PasswordKey> getConfirmedPassword();
     int clipText(const QString& text);
+    QSharedPointer<CompositeKey> getDatabaseKey(const QString& databaseFilename,
+                                                const bool isPasswordProtected = true,
+                                                const QString& keyFilename = {},
+                                                const QString& yubiKeySlot = {},
+                                                bool quiet = false);
     QSharedPointer<Database> unlockDatabase(const QString& databaseFilename,
                                             const bool isPasswordProtected = true,
                                             const QString& keyFilename = {},
                                             const QString& yubiKeySlot = {},
-                                            bool quiet = false);
+                                            bool quiet = false,
+                                            bool metadataOnly = false);
+    QSharedPointer<Database> unlockDatabase(const QString& databaseFilename,
+                                            QSharedPointer<CompositeKey> compositeKey,
+                                            bool quiet = false,
+                                            bool metadataOnly = false);
 
     QStringList splitCommandString(const QString& command);
+    int captureOutput(const std::function<int()>& run, QByteArray& out, QByteArray& err);
+
+    bool parseOutputFormat(const QString& value, OutputFormat& format);
+    void writeRecord(QTextStream& out, OutputFormat format, const QList<QPair<QString, QString>>& fields);
+    QString groupPath(const Group* group);
 
     /**
      * If `attributes` contains an attribute named `name` (case-sensitive),
@@ -32,6 +32,7 @@
 #include "Utils.h"
 #include "config-keepassx.h"
 #include "core/Bootstrap.h"
+#include "core/MemoryUsage.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
 #include "crypto/Crypto.h"
@@ -165,10 +166,15 @@ void enterInteractiveMode(const QStringList& arguments)
             break;
         }
 
+        const Database* previousDatabase = currentDatabase.data();
         cmd->currentDatabase = currentDatabase;
         cmd->execute(args);
         currentDatabase = cmd->currentDatabase;
         cmd->currentDatabase.reset();
+        if (previousDatabase && currentDatabase.data() != previousDatabase) {
+            // the database was closed or replaced by another one
+            MemoryUsage::releaseFreeMemory();
+        }
     }
 
     if (currentDatabase) {
@@ -23,6 +23,9 @@
 #cmakedefine WITH_XC_UPDATECHECK
 #cmakedefine WITH_XC_TOUCHID
 #cmakedefine WITH_XC_FDOSECRETS
+#cmakedefine WITH_XC_TRACING
+#cmakedefine WITH_XC_ALLOC_STATS
+#cmakedefine WITH_XC_LIBDEFLATE
 
 #cmakedefine KEEPASSXC_BUILD_TYPE "@KEEPASSXC_BUILD_TYPE@"
 #cmakedefine KEEPASSXC_BUILD_TYPE_RELEASE
@@ -37,5 +40,6 @@
 #cmakedefine HAVE_PR_SET_DUMPABLE 1
 #cmakedefine HAVE_RLIMIT_CORE 1
 #cmakedefine HAVE_PT_DENY_ATTACH 1
+#cmakedefine HAVE_MALLOC_TRIM 1
 
 #endif // KEEPASSX_CONFIG_KEEPASSX_H
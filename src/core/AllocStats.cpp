@@ -0,0 +1,116 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AllocStats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    // Zero-initialized and trivially constructed, so recording never allocates itself
+    thread_local AllocStats::Counters counters;
+    std::atomic<quint64> totalAllocations(0);
+    std::atomic<quint64> totalBytes(0);
+
+    void* allocate(std::size_t size)
+    {
+        AllocStats::record(size);
+        void* ptr = std::malloc(size ? size : 1);
+        if (!ptr) {
+            // Built without exceptions, so std::bad_alloc can't be thrown
+            std::abort();
+        }
+        return ptr;
+    }
+
+    void* allocate(std::size_t size, const std::nothrow_t&) noexcept
+    {
+        AllocStats::record(size);
+        return std::malloc(size ? size : 1);
+    }
+} // namespace
+
+namespace AllocStats
+{
+    const Counters& thread()
+    {
+        return counters;
+    }
+
+    quint64 processAllocations()
+    {
+        return totalAllocations.load(std::memory_order_relaxed);
+    }
+
+    quint64 processBytes()
+    {
+        return totalBytes.load(std::memory_order_relaxed);
+    }
+
+    void record(std::size_t size)
+    {
+        ++counters.allocations;
+        counters.bytes += size;
+        ++counters.histogram[bucket(size)];
+        totalAllocations.fetch_add(1, std::memory_order_relaxed);
+        totalBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    int bucket(std::size_t size)
+    {
+        int bucket = 0;
+        while (bucket < Buckets - 1 && size > bucketLimit(bucket)) {
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    /**
+     * Largest allocation counted in the size class, open ended for the last one.
+     */
+    quint64 bucketLimit(int bucket)
+    {
+        return Q_UINT64_C(8) << bucket;
+    }
+} // namespace AllocStats
+
+/**
+ * Replacements of the allocating operators that count every allocation.
+ * The memory comes from malloc, which the default and the secure delete
+ * operators both release with free.
+ */
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return allocate(size, tag);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return allocate(size, tag);
+}
@@ -0,0 +1,51 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ALLOCSTATS_H
+#define KEEPASSXC_ALLOCSTATS_H
+
+#include <QtGlobal>
+
+#include <cstddef>
+
+/**
+ * Allocation counters maintained by the operator new replacements of builds
+ * with WITH_XC_ALLOC_STATS. Tracing scopes record the difference of the
+ * counters of their thread between their start and end, benchmarks use the
+ * totals of the process to include the work of thread pools.
+ */
+namespace AllocStats
+{
+    // Power of two size classes from 8 bytes up, the last one collects all larger allocations
+    constexpr int Buckets = 16;
+
+    struct Counters
+    {
+        quint64 allocations;
+        quint64 bytes;
+        quint64 histogram[Buckets];
+    };
+
+    const Counters& thread();
+    quint64 processAllocations();
+    quint64 processBytes();
+    void record(std::size_t size);
+    int bucket(std::size_t size);
+    quint64 bucketLimit(int bucket);
+} // namespace AllocStats
+
+#endif // KEEPASSXC_ALLOCSTATS_H
@@ -0,0 +1,84 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AsyncTask.h"
+
+namespace
+{
+    struct ExecutorPool
+    {
+        ExecutorPool(int maxThreads, QThread::Priority priority)
+            : priority(priority)
+        {
+            pool.setMaxThreadCount(qMax(1, maxThreads));
+        }
+
+        QThreadPool pool;
+        QThread::Priority priority;
+    };
+
+    int idealThreads()
+    {
+        return qMax(1, QThread::idealThreadCount());
+    }
+
+    ExecutorPool* executorPool(AsyncTask::Executor executor)
+    {
+        // Argon2 runs its lanes on threads of its own, two derivations at a
+        // time are enough for unlocking one database while preparing another
+        static ExecutorPool kdfPool(2, QThread::NormalPriority);
+        static ExecutorPool ioPool(2, QThread::NormalPriority);
+        static ExecutorPool interactivePool(idealThreads(), QThread::HighPriority);
+        static ExecutorPool backgroundPool(1, QThread::LowestPriority);
+
+        switch (executor) {
+        case AsyncTask::Executor::Kdf:
+            return &kdfPool;
+        case AsyncTask::Executor::Io:
+            return &ioPool;
+        case AsyncTask::Executor::Interactive:
+            return &interactivePool;
+        case AsyncTask::Executor::Background:
+            return &backgroundPool;
+        case AsyncTask::Executor::Global:
+            break;
+        }
+        return nullptr;
+    }
+} // namespace
+
+namespace AsyncTask
+{
+    /**
+     * @return thread pool that runs the tasks of the executor
+     */
+    QThreadPool* threadPool(Executor executor)
+    {
+        auto* pool = executorPool(executor);
+        return pool ? &pool->pool : QThreadPool::globalInstance();
+    }
+
+    /**
+     * @return priority of the threads running tasks of the executor,
+     *         QThread::InheritPriority if it is left alone
+     */
+    QThread::Priority threadPriority(Executor executor)
+    {
+        auto* pool = executorPool(executor);
+        return pool ? pool->priority : QThread::InheritPriority;
+    }
+} // namespace AsyncTask
@@ -27,6 +27,46 @@
  */
 namespace AsyncTask
 {
+    /**
+     * Thread pools for the different kinds of work, so a long running
+     * task of one kind cannot starve the others.
+     */
+    enum class Executor
+    {
+        // Qt's global thread pool
+        Global,
+        // key derivations, which run their own threads for parallel lanes
+        Kdf,
+        // reading and writing files
+        Io,
+        // work the user is waiting for, e.g. searching
+        Interactive,
+        // work nobody waits for, running at the lowest priority
+        Background
+    };
+
+    QThreadPool* threadPool(Executor executor);
+    QThread::Priority threadPriority(Executor executor);
+
+    /**
+     * Run a given task on the thread pool of the executor.
+     *
+     * @param executor executor to run the task on
+     * @param task std::function object to run
+     * @return future of the task result
+     */
+    template <typename FunctionObject>
+    QFuture<typename std::result_of<FunctionObject()>::type> run(Executor executor, FunctionObject task)
+    {
+        const auto priority = threadPriority(executor);
+        return QtConcurrent::run(threadPool(executor), [task, priority]() mutable {
+            // pool threads may have run tasks at another priority before
+            if (priority != QThread::InheritPriority && QThread::currentThread()->priority() != priority) {
+                QThread::currentThread()->setPriority(priority);
+            }
+            return task();
+        });
+    }
 
     /**
      * Wait for the given future without blocking the event loop.
@@ -58,6 +98,41 @@ namespace AsyncTask
         return waitForFuture<FunctionObject>(QtConcurrent::run(task));
     }
 
+    /**
+     * Run a given task on the given executor and wait for it to finish
+     * without blocking the event loop.
+     *
+     * @param executor executor to run the task on
+     * @param task std::function object to run
+     * @return async task result
+     */
+    template <typename FunctionObject>
+    typename std::result_of<FunctionObject()>::type runAndWaitForFuture(Executor executor, FunctionObject task)
+    {
+        return waitForFuture<FunctionObject>(run(executor, task));
+    }
+
+    /**
+     * Run a given task on the given thread pool then call the defined callback.
+     *
+     * @param pool thread pool to run the task on
+     * @param task std::function object to run
+     * @param context QObject responsible for calling this function
+     * @param callback std::function object to run after the task completes
+     */
+    template <typename FunctionObject, typename FunctionObject2>
+    void runThenCallback(QThreadPool* pool, FunctionObject task, QObject* context, FunctionObject2 callback)
+    {
+        typedef QFutureWatcher<typename std::result_of<FunctionObject()>::type> FutureWatcher;
+        auto future = QtConcurrent::run(pool, task);
+        auto watcher = new FutureWatcher(context);
+        QObject::connect(watcher, &QFutureWatcherBase::finished, context, [=]() {
+            watcher->deleteLater();
+            callback(future.result());
+        });
+        watcher->setFuture(future);
+    }
+
     /**
      * Run a given task then call the defined callback. Prevents event loop blocking and
      * ensures the validity of the follow-on task through the context. If the context is
@@ -69,9 +144,23 @@ namespace AsyncTask
      */
     template <typename FunctionObject, typename FunctionObject2>
     void runThenCallback(FunctionObject task, QObject* context, FunctionObject2 callback)
+    {
+        runThenCallback(QThreadPool::globalInstance(), task, context, callback);
+    }
+
+    /**
+     * Run a given task on the given executor then call the defined callback.
+     *
+     * @param executor executor to run the task on
+     * @param task std::function object to run
+     * @param context QObject responsible for calling this function
+     * @param callback std::function object to run after the task completes
+     */
+    template <typename FunctionObject, typename FunctionObject2>
+    void runThenCallback(Executor executor, FunctionObject task, QObject* context, FunctionObject2 callback)
     {
         typedef QFutureWatcher<typename std::result_of<FunctionObject()>::type> FutureWatcher;
-        auto future = QtConcurrent::run(task);
+        auto future = run(executor, task);
         auto watcher = new FutureWatcher(context);
         QObject::connect(watcher, &QFutureWatcherBase::finished, context, [=]() {
             watcher->deleteLater();
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ATTACHMENTSOURCE_H
+#define KEEPASSXC_ATTACHMENTSOURCE_H
+
+#include <QByteArray>
+#include <QSharedPointer>
+
+/**
+ * Storage for attachment data that is not kept in memory.
+ *
+ * Database readers hand out a source when attachments are loaded on
+ * demand. Each attachment is addressed by its index in the source.
+ * Implementations must be safe to call from multiple threads.
+ */
+class AttachmentSource
+{
+public:
+    virtual ~AttachmentSource() = default;
+
+    virtual int count() const = 0;
+    virtual int size(int index) const = 0;
+    virtual QByteArray read(int index) const = 0;
+};
+
+/**
+ * Attachment contents held in memory, or a reference to an attachment
+ * of a source that is only read when the contents are needed.
+ */
+struct AttachmentValue
+{
+    QByteArray data;
+    QSharedPointer<const AttachmentSource> source;
+    int index;
+
+    bool isDeferred() const
+    {
+        return !source.isNull();
+    }
+
+    int size() const
+    {
+        return source ? source->size(index) : data.size();
+    }
+
+    QByteArray read() const
+    {
+        return source ? source->read(index) : data;
+    }
+};
+
+#endif // KEEPASSXC_ATTACHMENTSOURCE_H
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AttachmentStore.h"
+
+#include "crypto/CryptoHash.h"
+
+#include <QMutexLocker>
+
+/**
+ * Add a blob to the store.
+ *
+ * @param data attachment contents
+ * @return the stored blob with the same contents, which may be another
+ *         instance than data; use it to share the contents
+ */
+QByteArray AttachmentStore::insert(const QByteArray& data)
+{
+    QMutexLocker locker(&m_mutex);
+    const Blob& stored = blob(data);
+    return m_blobs.value(m_canonical.value(stored.digest)).data;
+}
+
+/**
+ * SHA-256 digest of a blob. The blob is added to the store, so it is
+ * only hashed again once it was pruned.
+ *
+ * @param data attachment contents
+ * @return digest of the contents
+ */
+QByteArray AttachmentStore::digest(const QByteArray& data)
+{
+    QMutexLocker locker(&m_mutex);
+    return blob(data).digest;
+}
+
+/**
+ * Drop all blobs that are no longer referenced outside of the store.
+ */
+void AttachmentStore::prune()
+{
+    QMutexLocker locker(&m_mutex);
+    pruneLocked();
+}
+
+int AttachmentStore::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_blobs.size();
+}
+
+void AttachmentStore::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_blobs.clear();
+    m_canonical.clear();
+    m_pruneThreshold = 64;
+}
+
+const AttachmentStore::Blob& AttachmentStore::blob(const QByteArray& data)
+{
+    // the store keeps a reference, so the address can't be reused for
+    // other contents as long as the blob is stored
+    auto it = m_blobs.constFind(data.constData());
+    if (it != m_blobs.constEnd()) {
+        return it.value();
+    }
+
+    if (m_blobs.size() >= m_pruneThreshold) {
+        pruneLocked();
+        m_pruneThreshold = qMax(64, m_blobs.size() * 2);
+    }
+
+    Blob stored{data, CryptoHash::hash(data, CryptoHash::Sha256)};
+    if (!m_canonical.contains(stored.digest)) {
+        m_canonical.insert(stored.digest, data.constData());
+    }
+    return m_blobs.insert(data.constData(), stored).value();
+}
+
+void AttachmentStore::pruneLocked()
+{
+    bool removed = false;
+    for (auto it = m_blobs.begin(); it != m_blobs.end();) {
+        if (it->data.isDetached()) {
+            it = m_blobs.erase(it);
+            removed = true;
+        } else {
+            ++it;
+        }
+    }
+
+    if (removed) {
+        m_canonical.clear();
+        for (auto it = m_blobs.constBegin(); it != m_blobs.constEnd(); ++it) {
+            if (!m_canonical.contains(it->digest)) {
+                m_canonical.insert(it->digest, it.key());
+            }
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ATTACHMENTSTORE_H
+#define KEEPASSXC_ATTACHMENTSTORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+
+/**
+ * Content-addressed store for the attachment data of a database.
+ *
+ * Every blob the store has seen is kept with its SHA-256 digest, keyed by
+ * the address of its data. Attachments share their data implicitly, so a
+ * blob only has to be hashed once no matter how many entries and history
+ * items refer to it or how often the database is saved. The references
+ * held by entries act as the reference count of a blob: blobs that are
+ * only referenced by the store are dropped by prune().
+ *
+ * The store is shared with the snapshots used for background saving and
+ * is safe to use from multiple threads.
+ */
+class AttachmentStore
+{
+public:
+    AttachmentStore() = default;
+
+    QByteArray insert(const QByteArray& data);
+    QByteArray digest(const QByteArray& data);
+    void prune();
+    int count() const;
+    void clear();
+
+private:
+    struct Blob
+    {
+        QByteArray data;
+        QByteArray digest;
+    };
+
+    const Blob& blob(const QByteArray& data);
+    void pruneLocked();
+
+    mutable QMutex m_mutex;
+    QHash<const char*, Blob> m_blobs;
+    // address of the first blob with the digest, shared by insert()
+    QHash<QByteArray, const char*> m_canonical;
+    int m_pruneThreshold = 64;
+
+    Q_DISABLE_COPY(AttachmentStore)
+};
+
+#endif // KEEPASSXC_ATTACHMENTSTORE_H
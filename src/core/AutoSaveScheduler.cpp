@@ -0,0 +1,104 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AutoSaveScheduler.h"
+
+#include "core/Database.h"
+
+AutoSaveScheduler::AutoSaveScheduler(QObject* parent)
+    : QObject(parent)
+    , m_queued(false)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, SIGNAL(timeout()), SLOT(quietPeriodElapsed()));
+}
+
+/**
+ * Set the database whose saves are tracked.
+ *
+ * Any pending save of the previous database is dropped.
+ */
+void AutoSaveScheduler::setDatabase(Database* db)
+{
+    if (m_db == db) {
+        return;
+    }
+
+    cancel();
+    if (m_db) {
+        m_db->disconnect(this);
+    }
+
+    m_db = db;
+    if (m_db) {
+        connect(m_db, SIGNAL(databaseSaved()), SLOT(saveFinished()));
+        connect(m_db, SIGNAL(databaseSaveFailed(QString)), SLOT(saveFinished()));
+    }
+}
+
+/**
+ * Set the quiet period in milliseconds that has to pass without
+ * modifications before a save is requested.
+ */
+void AutoSaveScheduler::setDelay(int msec)
+{
+    m_timer.setInterval(qMax(0, msec));
+}
+
+int AutoSaveScheduler::delay() const
+{
+    return m_timer.interval();
+}
+
+/**
+ * @return true if a save will be requested later on
+ */
+bool AutoSaveScheduler::isPending() const
+{
+    return m_timer.isActive() || m_queued;
+}
+
+void AutoSaveScheduler::schedule()
+{
+    m_timer.start();
+}
+
+void AutoSaveScheduler::cancel()
+{
+    m_timer.stop();
+    m_queued = false;
+}
+
+void AutoSaveScheduler::quietPeriodElapsed()
+{
+    // Never overlap saves, the running one requests the queued save when done
+    if (m_db && m_db->isSaving()) {
+        m_queued = true;
+        return;
+    }
+
+    m_queued = false;
+    emit saveRequested();
+}
+
+void AutoSaveScheduler::saveFinished()
+{
+    if (m_queued) {
+        m_queued = false;
+        m_timer.start();
+    }
+}
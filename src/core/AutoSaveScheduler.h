@@ -0,0 +1,64 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_AUTOSAVESCHEDULER_H
+#define KEEPASSXC_AUTOSAVESCHEDULER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+class Database;
+
+/**
+ * Coalesces database modifications into as few saves as possible.
+ *
+ * Every call to schedule() restarts the quiet period; saveRequested() is
+ * emitted once it elapses without further changes. While the database is
+ * being saved, at most one more save is queued and requested after the
+ * running save has finished.
+ */
+class AutoSaveScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AutoSaveScheduler(QObject* parent = nullptr);
+
+    void setDatabase(Database* db);
+    void setDelay(int msec);
+    int delay() const;
+    bool isPending() const;
+
+signals:
+    void saveRequested();
+
+public slots:
+    void schedule();
+    void cancel();
+
+private slots:
+    void quietPeriodElapsed();
+    void saveFinished();
+
+private:
+    QPointer<Database> m_db;
+    QTimer m_timer;
+    bool m_queued;
+};
+
+#endif // KEEPASSXC_AUTOSAVESCHEDULER_H
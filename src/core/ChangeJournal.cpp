@@ -0,0 +1,101 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ChangeJournal.h"
+
+#include <algorithm>
+
+ChangeJournal::ChangeJournal(int capacity)
+    : m_capacity(qMax(capacity, 2))
+    , m_sequence(0)
+    , m_truncatedSequence(0)
+{
+}
+
+/**
+ * @return sequence number of the latest change, 0 if nothing changed yet
+ */
+quint64 ChangeJournal::sequence() const
+{
+    return m_sequence;
+}
+
+/**
+ * Get the changes recorded after the given sequence number, oldest first.
+ *
+ * @param sequence value of sequence() the consumer has seen last
+ * @param changes receives the changes
+ * @return false if some changes are no longer available and the consumer
+ *         has to rebuild its state from the database
+ */
+bool ChangeJournal::changesSince(quint64 sequence, QVector<Change>* changes) const
+{
+    Q_ASSERT(changes);
+    changes->clear();
+    if (sequence < m_truncatedSequence || sequence > m_sequence) {
+        return false;
+    }
+
+    auto first = std::upper_bound(
+        m_changes.constBegin(), m_changes.constEnd(), sequence, [](quint64 seq, const Change& change) {
+            return seq < change.sequence;
+        });
+    changes->reserve(static_cast<int>(m_changes.constEnd() - first));
+    std::copy(first, m_changes.constEnd(), std::back_inserter(*changes));
+    return true;
+}
+
+/**
+ * @return number of changes kept
+ */
+int ChangeJournal::size() const
+{
+    return m_changes.size();
+}
+
+void ChangeJournal::record(Kind kind, const QUuid& uuid, Fields fields)
+{
+    ++m_sequence;
+
+    if (!m_changes.isEmpty() && (kind == Kind::EntryModified || kind == Kind::GroupModified)) {
+        Change& last = m_changes.last();
+        if (last.kind == kind && last.uuid == uuid) {
+            // consumers that have seen the change already get it again
+            last.sequence = m_sequence;
+            last.fields |= fields;
+            return;
+        }
+    }
+
+    if (m_changes.size() >= m_capacity) {
+        // drop the older half at once instead of moving all changes every time
+        const int dropped = m_capacity / 2;
+        m_truncatedSequence = m_changes.at(dropped - 1).sequence;
+        m_changes.remove(0, dropped);
+    }
+    m_changes.append({m_sequence, uuid, kind, fields});
+}
+
+/**
+ * Forget all changes, e.g. after the whole tree was replaced. Every
+ * consumer has to rebuild its state.
+ */
+void ChangeJournal::reset()
+{
+    m_changes.clear();
+    m_truncatedSequence = ++m_sequence;
+}
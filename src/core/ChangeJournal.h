@@ -0,0 +1,97 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_CHANGEJOURNAL_H
+#define KEEPASSXC_CHANGEJOURNAL_H
+
+#include <QUuid>
+#include <QVector>
+
+/**
+ * Append-only list of the changes of a database, so that consumers can
+ * update their state from the changes since the last time they looked
+ * instead of rescanning the whole tree.
+ *
+ * Every change gets the next sequence number. A consumer remembers
+ * sequence() after building its state and later asks changesSince() for
+ * everything after it. Only the most recent changes are kept; if a
+ * consumer fell too far behind or the database was reloaded, it has to
+ * rebuild its state from the tree.
+ *
+ * Consecutive modifications of the same item are combined into one
+ * change. Removing a group removes its whole subtree, and entries moved
+ * to another group are recorded as removed and added again.
+ *
+ * The journal belongs to the thread of its database.
+ */
+class ChangeJournal
+{
+public:
+    enum class Kind
+    {
+        EntryAdded,
+        EntryModified,
+        EntryRemoved,
+        GroupAdded,
+        GroupModified,
+        GroupMoved,
+        GroupRemoved,
+        MetadataModified
+    };
+
+    enum Field
+    {
+        NoFields = 0,
+        Properties = 1, // icon, colors, expiry, auto-type settings and other plain properties
+        Attributes = 2, // title, username, password, URL, notes and custom attributes
+        Attachments = 4,
+        AutoTypeAssociations = 8,
+        CustomData = 16,
+        AllFields = Properties | Attributes | Attachments | AutoTypeAssociations | CustomData
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+
+    struct Change
+    {
+        quint64 sequence;
+        QUuid uuid;
+        Kind kind;
+        Fields fields;
+    };
+
+    static const int DefaultCapacity = 10000;
+
+    explicit ChangeJournal(int capacity = DefaultCapacity);
+
+    quint64 sequence() const;
+    bool changesSince(quint64 sequence, QVector<Change>* changes) const;
+    int size() const;
+
+    void record(Kind kind, const QUuid& uuid, Fields fields = NoFields);
+    void reset();
+
+private:
+    QVector<Change> m_changes;
+    int m_capacity;
+    quint64 m_sequence;
+    // changes up to this sequence are no longer available
+    quint64 m_truncatedSequence;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(ChangeJournal::Fields)
+
+#endif // KEEPASSXC_CHANGEJOURNAL_H
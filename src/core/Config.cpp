@@ -22,6 +22,7 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QHash>
+#include <QMutexLocker>
 #include <QProcessEnvironment>
 #include <QSettings>
 #include <QSize>
@@ -29,6 +30,8 @@
 #include <QTemporaryFile>
 
 #define CONFIG_VERSION 1
+// Time without further changes before they are written to the config files
+#define CONFIG_SAVE_DELAY_MS 1000
 #define QS QStringLiteral
 
 enum ConfigType
@@ -60,6 +63,7 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
     {Config::AutoReloadOnChange,{QS("AutoReloadOnChange"), Roaming, true}},
     {Config::AutoSaveOnExit,{QS("AutoSaveOnExit"), Roaming, true}},
     {Config::AutoSaveNonDataChanges,{QS("AutoSaveNonDataChanges"), Roaming, true}},
+    {Config::AutoSaveDelay,{QS("AutoSaveDelay"), Roaming, 500}},
     {Config::BackupBeforeSave,{QS("BackupBeforeSave"), Roaming, false}},
     {Config::UseAtomicSaves,{QS("UseAtomicSaves"), Roaming, true}},
     {Config::SearchLimitGroup,{QS("SearchLimitGroup"), Roaming, false}},
@@ -74,11 +78,22 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
     {Config::AutoTypeDelay,{QS("AutoTypeDelay"), Roaming, 25}},
     {Config::AutoTypeStartDelay,{QS("AutoTypeStartDelay"), Roaming, 500}},
     {Config::AutoTypeHideExpiredEntry,{QS("AutoTypeHideExpiredEntry"), Roaming, false}},
+    {Config::AutoTypeBurstMode,{QS("AutoTypeBurstMode"), Roaming, false}},
     {Config::GlobalAutoTypeKey,{QS("GlobalAutoTypeKey"), Roaming, 0}},
     {Config::GlobalAutoTypeModifiers,{QS("GlobalAutoTypeModifiers"), Roaming, 0}},
     {Config::FaviconDownloadTimeout,{QS("FaviconDownloadTimeout"), Roaming, 10}},
     {Config::UpdateCheckMessageShown,{QS("UpdateCheckMessageShown"), Roaming, false}},
     {Config::UseTouchID,{QS("UseTouchID"), Roaming, false}},
+    {Config::PipelinedDatabaseRead,{QS("PipelinedDatabaseRead"), Local, false}},
+    {Config::DeferredAttachmentLoading,{QS("DeferredAttachmentLoading"), Local, false}},
+    {Config::ProgressiveDatabaseOpen,{QS("ProgressiveDatabaseOpen"), Local, false}},
+    {Config::IncrementalSave,{QS("IncrementalSave"), Local, false}},
+    {Config::BackgroundSave,{QS("BackgroundSave"), Local, false}},
+    {Config::CompressionLevel,{QS("CompressionLevel"), Local, 6}},
+    {Config::ParallelCompression,{QS("ParallelCompression"), Local, false}},
+    {Config::DeferredProtectedValues,{QS("DeferredProtectedValues"), Local, false}},
+    {Config::PrepareSaveKey,{QS("PrepareSaveKey"), Local, false}},
+    {Config::ReuseKdfMemory,{QS("ReuseKdfMemory"), Local, false}},
 
     {Config::LastDatabases, {QS("LastDatabases"), Local, {}}},
     {Config::LastKeyFiles, {QS("LastKeyFiles"), Local, {}}},
@@ -138,6 +153,8 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
     {Config::Security_ResetTouchId, {QS("Security/ResetTouchId"), Roaming, false}},
     {Config::Security_ResetTouchIdTimeout, {QS("Security/ResetTouchIdTimeout"), Roaming, 30}},
     {Config::Security_ResetTouchIdScreenlock,{QS("Security/ResetTouchIdScreenlock"), Roaming, true}},
+    {Config::Security_QuickUnlock, {QS("Security/QuickUnlock"), Roaming, false}},
+    {Config::Security_QuickUnlockTimeout, {QS("Security/QuickUnlockTimeout"), Roaming, 30}},
 
     // Browser
     {Config::Browser_Enabled, {QS("Browser/Enabled"), Roaming, false}},
@@ -216,14 +233,24 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
 
 QPointer<Config> Config::m_instance(nullptr);
 
+/**
+ * Get the value of a setting.
+ *
+ * Values are only read from QSettings the first time they are requested,
+ * after that they are served from memory.
+ */
 QVariant Config::get(ConfigKey key)
 {
-    auto cfg = configStrings[key];
-    auto defaultValue = configStrings[key].defaultValue;
-    if (m_localSettings && cfg.type == Local) {
-        return m_localSettings->value(cfg.name, defaultValue);
+    QMutexLocker locker(&m_cacheMutex);
+    auto cached = m_cache.constFind(key);
+    if (cached != m_cache.constEnd()) {
+        return cached.value();
     }
-    return m_settings->value(cfg.name, defaultValue);
+
+    const auto& cfg = configStrings[key];
+    auto value = settingsFor(key)->value(cfg.name, cfg.defaultValue);
+    m_cache.insert(key, value);
+    return value;
 }
 
 bool Config::hasAccessError()
@@ -236,34 +263,62 @@ QString Config::getFileName()
     return m_settings->fileName();
 }
 
+/**
+ * Set the value of a setting.
+ *
+ * The new value is visible to get() right away, but only written to the config
+ * files once no other setting changed for CONFIG_SAVE_DELAY_MS, on sync() or
+ * on quit. This keeps bursts of changes, like column widths while resizing,
+ * from rewriting the files over and over.
+ */
 void Config::set(ConfigKey key, const QVariant& value)
 {
     if (get(key) == value) {
         return;
     }
 
-    auto cfg = configStrings[key];
-    if (cfg.type == Local && m_localSettings) {
-        m_localSettings->setValue(cfg.name, value);
-    } else {
-        m_settings->setValue(cfg.name, value);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        m_cache.insert(key, value);
+        m_pending.insert(key, value);
     }
 
+    // The timer lives in the thread of the config object
+    QMetaObject::invokeMethod(&m_saveTimer, "start");
     emit changed(key);
 }
 
 void Config::remove(ConfigKey key)
 {
-    auto cfg = configStrings[key];
-    if (cfg.type == Local && m_localSettings) {
-        m_localSettings->remove(cfg.name);
-    } else {
-        m_settings->remove(cfg.name);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        m_cache.remove(key);
+        m_pending.remove(key);
+        settingsFor(key)->remove(configStrings[key].name);
     }
 
     emit changed(key);
 }
 
+QSettings* Config::settingsFor(ConfigKey key) const
+{
+    if (configStrings[key].type == Local && m_localSettings) {
+        return m_localSettings.data();
+    }
+    return m_settings.data();
+}
+
+/**
+ * Hand pending values over to QSettings. The cache mutex must be held.
+ */
+void Config::writePending()
+{
+    for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+        settingsFor(it.key())->setValue(configStrings[it.key()].name, it.value());
+    }
+    m_pending.clear();
+}
+
 /**
  * Sync configuration with persistent storage.
  *
@@ -273,6 +328,10 @@ void Config::remove(ConfigKey key)
  */
 void Config::sync()
 {
+    m_saveTimer.stop();
+
+    QMutexLocker locker(&m_cacheMutex);
+    writePending();
     m_settings->sync();
     if (m_localSettings) {
         m_localSettings->sync();
@@ -281,6 +340,9 @@ void Config::sync()
 
 void Config::resetToDefaults()
 {
+    QMutexLocker locker(&m_cacheMutex);
+    m_cache.clear();
+    m_pending.clear();
     m_settings->clear();
     if (m_localSettings) {
         m_localSettings->clear();
@@ -437,6 +499,7 @@ Config::Config(QObject* parent)
 
 Config::~Config()
 {
+    sync();
 }
 
 void Config::init(const QString& configFileName, const QString& localConfigFileName)
@@ -456,6 +519,10 @@ void Config::init(const QString& configFileName, const QString& localConfigFileN
         m_localSettings.reset(new QSettings(localConfigFileName, QSettings::IniFormat));
     }
 
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(CONFIG_SAVE_DELAY_MS);
+    connect(&m_saveTimer, &QTimer::timeout, this, &Config::sync);
+
     migrate();
     connect(qApp, &QCoreApplication::aboutToQuit, this, &Config::sync);
 }
@@ -19,8 +19,11 @@
 #ifndef KEEPASSX_CONFIG_H
 #define KEEPASSX_CONFIG_H
 
+#include <QHash>
+#include <QMutex>
 #include <QPointer>
 #include <QScopedPointer>
+#include <QTimer>
 #include <QVariant>
 
 class QSettings;
@@ -43,6 +46,7 @@ public:
         AutoReloadOnChange,
         AutoSaveOnExit,
         AutoSaveNonDataChanges,
+        AutoSaveDelay,
         BackupBeforeSave,
         UseAtomicSaves,
         SearchLimitGroup,
@@ -57,11 +61,22 @@ public:
         AutoTypeDelay,
         AutoTypeStartDelay,
         AutoTypeHideExpiredEntry,
+        AutoTypeBurstMode,
         GlobalAutoTypeKey,
         GlobalAutoTypeModifiers,
         FaviconDownloadTimeout,
         UpdateCheckMessageShown,
         UseTouchID,
+        PipelinedDatabaseRead,
+        DeferredAttachmentLoading,
+        ProgressiveDatabaseOpen,
+        IncrementalSave,
+        BackgroundSave,
+        CompressionLevel,
+        ParallelCompression,
+        DeferredProtectedValues,
+        PrepareSaveKey,
+        ReuseKdfMemory,
 
         LastDatabases,
         LastKeyFiles,
@@ -119,6 +134,8 @@ public:
         Security_ResetTouchId,
         Security_ResetTouchIdTimeout,
         Security_ResetTouchIdScreenlock,
+        Security_QuickUnlock,
+        Security_QuickUnlockTimeout,
 
         Browser_Enabled,
         Browser_ShowNotification,
@@ -212,6 +229,8 @@ private:
     explicit Config(QObject* parent);
     void init(const QString& configFileName, const QString& localConfigFileName);
     void migrate();
+    QSettings* settingsFor(ConfigKey key) const;
+    void writePending();
     static QPair<QString, QString> defaultConfigFiles();
 
     static QPointer<Config> m_instance;
@@ -219,6 +238,12 @@ private:
     QScopedPointer<QSettings> m_settings;
     QScopedPointer<QSettings> m_localSettings;
     QHash<QString, QVariant> m_defaults;
+
+    // Values read or written so far, and the ones not yet handed to QSettings
+    QHash<ConfigKey, QVariant> m_cache;
+    QHash<ConfigKey, QVariant> m_pending;
+    QMutex m_cacheMutex;
+    QTimer m_saveTimer;
 };
 
 inline Config* config()
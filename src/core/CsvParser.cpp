@@ -21,10 +21,24 @@
 #include <QObject>
 #include <QTextCodec>
 
-#include "core/Tools.h"
+#include "streams/MappedFileDevice.h"
+
+namespace
+{
+    // number of bytes decoded at once
+    const int ChunkSize = 64 * 1024;
+    // consumed characters are dropped from the buffer once there are this many
+    const int CompactThreshold = 64 * 1024;
+} // namespace
 
 CsvParser::CsvParser()
-    : m_ch(0)
+    : m_codec(QTextCodec::codecForName("UTF-8"))
+    , m_pos(0)
+    , m_lastPos(-1)
+    , m_hasPendingCR(false)
+    , m_isSourceEnd(true)
+    , m_isStarted(false)
+    , m_ch(0)
     , m_comment('#')
     , m_currCol(1)
     , m_currRow(1)
@@ -32,21 +46,18 @@ CsvParser::CsvParser()
     , m_isEof(false)
     , m_isFileLoaded(false)
     , m_isGood(true)
-    , m_lastPos(-1)
+    , m_isTruncated(false)
+    , m_fileSize(0)
     , m_maxCols(0)
+    , m_rowLimit(0)
     , m_qualifier('"')
     , m_separator(',')
     , m_statusMsg("")
 {
-    m_csv.setBuffer(&m_array);
-    m_ts.setDevice(&m_csv);
-    m_csv.open(QIODevice::ReadOnly);
-    m_ts.setCodec("UTF-8");
 }
 
 CsvParser::~CsvParser()
 {
-    m_csv.close();
 }
 
 bool CsvParser::isFileLoaded()
@@ -75,24 +86,35 @@ bool CsvParser::parse(QFile* device)
 
 bool CsvParser::readFile(QFile* device)
 {
+    // closing the device flushes pending writes of streams attached to it
     if (device->isOpen()) {
         device->close();
     }
 
-    device->open(QIODevice::ReadOnly);
-    if (!Tools::readAllFromDevice(device, m_array)) {
-        appendStatusMsg(QObject::tr("error reading from device"), true);
-        m_isFileLoaded = false;
-    } else {
-        device->close();
-
-        m_array.replace("\r\n", "\n");
-        m_array.replace("\r", "\n");
-        if (0 == m_array.size()) {
-            appendStatusMsg(QObject::tr("file empty").append("\n"));
+    const QString fileName = device->fileName();
+    if (MappedFileDevice::isMappingSafe(fileName)) {
+        m_device.reset(new MappedFileDevice(fileName));
+        if (!m_device->open(QIODevice::ReadOnly)) {
+            // empty files can't be mapped
+            m_device.reset();
         }
-        m_isFileLoaded = true;
     }
+    if (!m_device) {
+        m_device.reset(new QFile(fileName));
+        if (!m_device->open(QIODevice::ReadOnly)) {
+            m_device.reset();
+            appendStatusMsg(QObject::tr("error reading from device"), true);
+            m_isFileLoaded = false;
+            return false;
+        }
+    }
+
+    m_fileSize = m_device->size();
+    restartInput();
+    if (0 == m_fileSize) {
+        appendStatusMsg(QObject::tr("file empty").append("\n"));
+    }
+    m_isFileLoaded = true;
     return m_isFileLoaded;
 }
 
@@ -103,11 +125,11 @@ void CsvParser::reset()
     m_currRow = 1;
     m_isEof = false;
     m_isGood = true;
-    m_lastPos = -1;
+    m_isTruncated = false;
     m_maxCols = 0;
     m_statusMsg = "";
-    m_ts.seek(0);
     m_table.clear();
+    restartInput();
     // the following are users' concern :)
     // m_comment = '#';
     // m_backslashSyntax = false;
@@ -119,49 +141,235 @@ void CsvParser::reset()
 void CsvParser::clear()
 {
     reset();
+    m_device.reset();
+    m_fileSize = 0;
     m_isFileLoaded = false;
-    m_array.clear();
+    m_isSourceEnd = true;
+}
+
+/**
+ * Start reading the records of the file over from the beginning. Unlike
+ * reparse(), the table and the status messages are left untouched, so it
+ * can be used to stream the whole file with readRows() after a preview.
+ */
+void CsvParser::rewind()
+{
+    m_ch = 0;
+    m_currCol = 1;
+    m_currRow = 1;
+    restartInput();
+}
+
+/**
+ * Read the next batch of records from the file.
+ *
+ * @param rows receives the records, previous content is removed
+ * @param maxRows maximum number of records to read
+ * @return number of records read, 0 at the end of the file
+ */
+int CsvParser::readRows(CsvTable& rows, int maxRows)
+{
+    rows.clear();
+    CsvRow row;
+    while (rows.size() < maxRows && readRecord(row)) {
+        rows.append(row);
+    }
+    return rows.size();
+}
+
+void CsvParser::restartInput()
+{
+    if (m_device) {
+        m_device->seek(0);
+    }
+    m_decoder.reset(m_codec->makeDecoder());
+    m_text.clear();
+    m_pos = 0;
+    m_lastPos = -1;
+    m_hasPendingCR = false;
+    m_isSourceEnd = !m_device;
+    m_isStarted = false;
+    m_isEof = false;
+}
+
+/**
+ * Decode the next chunk of the file into the buffer. Line endings are
+ * normalized to LF, including CR LF pairs split across two chunks.
+ *
+ * @return false if the end of the file has already been reached
+ */
+bool CsvParser::fillBuffer()
+{
+    if (m_isSourceEnd) {
+        return false;
+    }
+
+    QByteArray chunk;
+    auto* mappedDevice = qobject_cast<MappedFileDevice*>(m_device.data());
+    if (mappedDevice) {
+        chunk = mappedDevice->readSlice(ChunkSize);
+    } else {
+        chunk = m_device->read(ChunkSize);
+    }
+
+    QString text;
+    if (chunk.isEmpty()) {
+        m_isSourceEnd = true;
+        auto* file = qobject_cast<QFile*>(m_device.data());
+        if (file && file->error() != QFileDevice::NoError) {
+            appendStatusMsg(QObject::tr("error reading from device"), true);
+        }
+        if (m_hasPendingCR) {
+            text = "\n";
+            m_hasPendingCR = false;
+        }
+    } else {
+        text = m_decoder->toUnicode(chunk);
+        if (m_hasPendingCR) {
+            text.prepend('\r');
+            m_hasPendingCR = false;
+        }
+        if (text.endsWith('\r')) {
+            text.chop(1);
+            m_hasPendingCR = true;
+        }
+        text.replace("\r\n", "\n");
+        text.replace('\r', '\n');
+    }
+
+    m_text.append(text);
+    return true;
+}
+
+/**
+ * @return true if there is at least one character left to read
+ */
+bool CsvParser::ensureAvailable()
+{
+    while (m_pos >= m_text.size()) {
+        if (!fillBuffer()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CsvParser::compactBuffer()
+{
+    if (m_pos >= CompactThreshold) {
+        m_text.remove(0, m_pos);
+        m_pos = 0;
+        m_lastPos = -1;
+    }
 }
 
 bool CsvParser::parseFile()
 {
-    parseRecord();
-    while (!m_isEof) {
-        if (!skipEndline()) {
-            appendStatusMsg(QObject::tr("malformed string"), true);
+    CsvRow row;
+    while (readRecord(row)) {
+        if (m_rowLimit > 0 && m_table.size() >= m_rowLimit) {
+            m_isTruncated = true;
+            break;
+        }
+        m_table.push_back(row);
+        if (m_maxCols < row.size()) {
+            m_maxCols = row.size();
         }
-        m_currRow++;
-        m_currCol = 1;
-        parseRecord();
     }
     fillColumns();
     return m_isGood;
 }
 
-void CsvParser::parseRecord()
+/**
+ * Read the next non-empty record.
+ *
+ * @return false at the end of the file
+ */
+bool CsvParser::readRecord(CsvRow& row)
+{
+    while (true) {
+        if (m_isStarted) {
+            if (m_isEof) {
+                return false;
+            }
+            if (!skipEndline()) {
+                appendStatusMsg(QObject::tr("malformed string"), true);
+            }
+            m_currRow++;
+            m_currCol = 1;
+        }
+        m_isStarted = true;
+
+        compactBuffer();
+        row.clear();
+        if (parseRecord(row)) {
+            return true;
+        }
+    }
+}
+
+bool CsvParser::parseRecord(CsvRow& row)
 {
-    CsvRow row;
     if (isComment()) {
         skipLine();
-        return;
+        return false;
     }
-    do {
-        parseField(row);
-        getChar(m_ch);
-    } while (isSeparator(m_ch) && !m_isEof);
-
-    if (!m_isEof) {
-        ungetChar();
+    if (!parseSimpleRecord(row)) {
+        do {
+            parseField(row);
+            getChar(m_ch);
+        } while (isSeparator(m_ch) && !m_isEof);
+
+        if (!m_isEof) {
+            ungetChar();
+        }
     }
     if (isEmptyRow(row)) {
         row.clear();
-        return;
-    }
-    m_table.push_back(row);
-    if (m_maxCols < row.size()) {
-        m_maxCols = row.size();
+        return false;
     }
     m_currCol++;
+    return true;
+}
+
+/**
+ * Fast path for the common case of a record without any text qualifiers:
+ * the line is split at the separators in one go instead of character by
+ * character.
+ *
+ * @return false if the record has to be parsed by the regular parser
+ */
+bool CsvParser::parseSimpleRecord(CsvRow& row)
+{
+    int lineEnd = m_text.indexOf('\n', m_pos);
+    int searchPos = m_text.size();
+    while (lineEnd < 0 && fillBuffer()) {
+        lineEnd = m_text.indexOf('\n', searchPos);
+        searchPos = m_text.size();
+    }
+
+    const bool isLastLine = lineEnd < 0;
+    if (isLastLine) {
+        lineEnd = m_text.size();
+    }
+
+    const QStringRef line = m_text.midRef(m_pos, lineEnd - m_pos);
+    if (line.contains(m_qualifier) || (m_isBackslashSyntax && line.contains('\\'))) {
+        return false;
+    }
+
+    const auto fields = line.split(m_separator);
+    for (const auto& field : fields) {
+        row.push_back(field.toString());
+    }
+
+    m_pos = lineEnd;
+    m_lastPos = -1;
+    m_isEof = isLastLine;
+    if (!isLastLine) {
+        m_ch = '\n';
+    }
+    return true;
 }
 
 void CsvParser::parseField(CsvRow& row)
@@ -276,8 +484,17 @@ void CsvParser::fillColumns()
 
 void CsvParser::skipLine()
 {
-    m_ts.readLine();
-    m_ts.seek(m_ts.pos() - 1);
+    // stop at the line break, it is consumed by skipEndline()
+    while (ensureAvailable()) {
+        if (m_text.at(m_pos) == '\n') {
+            return;
+        }
+        ++m_pos;
+    }
+    // last line without a line break: step back onto its last character
+    if (m_pos > 0) {
+        --m_pos;
+    }
 }
 
 bool CsvParser::skipEndline()
@@ -288,18 +505,20 @@ bool CsvParser::skipEndline()
 
 void CsvParser::getChar(QChar& c)
 {
-    m_isEof = m_ts.atEnd();
+    m_isEof = !ensureAvailable();
     if (!m_isEof) {
-        m_lastPos = m_ts.pos();
-        m_ts >> c;
+        m_lastPos = m_pos;
+        c = m_text.at(m_pos++);
     }
 }
 
 void CsvParser::ungetChar()
 {
-    if (!m_ts.seek(m_lastPos)) {
+    if (m_lastPos < 0) {
         qWarning("CSV Parser: unget lower bound exceeded");
         m_isGood = false;
+    } else {
+        m_pos = m_lastPos;
     }
 }
 
@@ -324,7 +543,7 @@ bool CsvParser::isComment()
 {
     bool result = false;
     QChar c2;
-    qint64 pos = m_ts.pos();
+    int pos = m_pos;
 
     do {
         getChar(c2);
@@ -333,7 +552,7 @@ bool CsvParser::isComment()
     if (c2 == m_comment) {
         result = true;
     }
-    m_ts.seek(pos);
+    m_pos = pos;
     return result;
 }
 
@@ -390,7 +609,10 @@ void CsvParser::setComment(const QChar& c)
 
 void CsvParser::setCodec(const QString& s)
 {
-    m_ts.setCodec(QTextCodec::codecForName(s.toLocal8Bit()));
+    auto* codec = QTextCodec::codecForName(s.toLocal8Bit());
+    if (codec) {
+        m_codec = codec;
+    }
 }
 
 void CsvParser::setFieldSeparator(const QChar& c)
@@ -403,9 +625,19 @@ void CsvParser::setTextQualifier(const QChar& c)
     m_qualifier = c.unicode();
 }
 
-int CsvParser::getFileSize() const
+void CsvParser::setRowLimit(int rows)
+{
+    m_rowLimit = qMax(0, rows);
+}
+
+bool CsvParser::isTruncated() const
+{
+    return m_isTruncated;
+}
+
+qint64 CsvParser::getFileSize() const
 {
-    return m_csv.size();
+    return m_fileSize;
 }
 
 const CsvTable CsvParser::getCsvTable() const
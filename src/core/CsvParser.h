@@ -19,14 +19,23 @@
 #ifndef KEEPASSX_CSVPARSER_H
 #define KEEPASSX_CSVPARSER_H
 
-#include <QBuffer>
 #include <QFile>
-#include <QQueue>
-#include <QTextStream>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QTextCodec>
 
 typedef QStringList CsvRow;
 typedef QList<CsvRow> CsvTable;
 
+/**
+ * Tokenizer for CSV files.
+ *
+ * The file is read in chunks (memory-mapped when the file system allows
+ * it) and decoded on the fly, so only the current record is held in memory.
+ * parse() and reparse() collect the records into a table, optionally limited
+ * to the first rows for a preview. readRows() streams the records of the
+ * whole file in batches instead.
+ */
 class CsvParser
 {
 
@@ -36,25 +45,39 @@ public:
     // read data from device and parse it
     bool parse(QFile* device);
     bool isFileLoaded();
-    // reparse the same buffer (device is not opened again)
+    // reparse the same file (device is not opened again)
     bool reparse();
     void setCodec(const QString& s);
     void setComment(const QChar& c);
     void setFieldSeparator(const QChar& c);
     void setTextQualifier(const QChar& c);
     void setBackslashSyntax(bool set);
-    int getFileSize() const;
+    // limit the table built by parse() and reparse() to the first rows, 0 = no limit
+    void setRowLimit(int rows);
+    bool isTruncated() const;
+    qint64 getFileSize() const;
     int getCsvRows() const;
     int getCsvCols() const;
     QString getStatus() const;
     const CsvTable getCsvTable() const;
 
+    // stream all records of the file, starting over at the first one
+    void rewind();
+    int readRows(CsvTable& rows, int maxRows);
+
 protected:
     CsvTable m_table;
 
 private:
-    QByteArray m_array;
-    QBuffer m_csv;
+    QScopedPointer<QIODevice> m_device;
+    QTextCodec* m_codec;
+    QScopedPointer<QTextDecoder> m_decoder;
+    QString m_text;
+    int m_pos;
+    int m_lastPos;
+    bool m_hasPendingCR;
+    bool m_isSourceEnd;
+    bool m_isStarted;
     QChar m_ch;
     QChar m_comment;
     unsigned int m_currCol;
@@ -63,13 +86,18 @@ private:
     bool m_isEof;
     bool m_isFileLoaded;
     bool m_isGood;
-    qint64 m_lastPos;
+    bool m_isTruncated;
+    qint64 m_fileSize;
     int m_maxCols;
+    int m_rowLimit;
     QChar m_qualifier;
     QChar m_separator;
     QString m_statusMsg;
-    QTextStream m_ts;
 
+    void restartInput();
+    bool fillBuffer();
+    bool ensureAvailable();
+    void compactBuffer();
     void getChar(QChar& c);
     void ungetChar();
     void peek(QChar& c);
@@ -85,7 +113,9 @@ private:
     bool isTab(const QChar& c) const;
     bool isEmptyRow(const CsvRow& row) const;
     bool parseFile();
-    void parseRecord();
+    bool readRecord(CsvRow& row);
+    bool parseRecord(CsvRow& row);
+    bool parseSimpleRecord(CsvRow& row);
     void parseField(CsvRow& row);
     void parseSimple(QString& s);
     void parseQuoted(QString& s);
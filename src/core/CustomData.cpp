@@ -20,10 +20,13 @@
 
 #include "core/Global.h"
 
+#include <algorithm>
+
 const QString CustomData::LastModified = QStringLiteral("_LAST_MODIFIED");
 const QString CustomData::Created = QStringLiteral("_CREATED");
 const QString CustomData::BrowserKeyPrefix = QStringLiteral("KPXC_BROWSER_");
 const QString CustomData::BrowserLegacyKeyPrefix = QStringLiteral("Public Key: ");
+const QString CustomData::MergeBaseKeyPrefix = QStringLiteral("KPXC_MERGE_BASE_");
 
 CustomData::CustomData(QObject* parent)
     : QObject(parent)
@@ -66,6 +69,7 @@ void CustomData::set(const QString& key, const QString& value)
 
     if (addAttribute || changeValue) {
         m_data.insert(key, value);
+        invalidateCaches(addAttribute ? QString() : key);
         updateLastModified();
         emit customDataModified();
     }
@@ -80,6 +84,7 @@ void CustomData::remove(const QString& key)
     emit aboutToBeRemoved(key);
 
     m_data.remove(key);
+    invalidateCaches();
 
     updateLastModified();
     emit removed(key);
@@ -101,6 +106,7 @@ void CustomData::rename(const QString& oldKey, const QString& newKey)
 
     m_data.remove(oldKey);
     m_data.insert(newKey, data);
+    invalidateCaches();
 
     updateLastModified();
     emit customDataModified();
@@ -116,6 +122,7 @@ void CustomData::copyDataFrom(const CustomData* other)
     emit aboutToBeReset();
 
     m_data = other->m_data;
+    invalidateCaches();
 
     updateLastModified();
     emit reset();
@@ -132,7 +139,72 @@ QDateTime CustomData::getLastModified() const
 
 bool CustomData::isProtectedCustomData(const QString& key) const
 {
-    return key.startsWith(CustomData::BrowserKeyPrefix) || key.startsWith(CustomData::Created);
+    return key.startsWith(CustomData::BrowserKeyPrefix) || key.startsWith(CustomData::Created)
+           || key.startsWith(CustomData::MergeBaseKeyPrefix);
+}
+
+/**
+ * Get all keys starting with the given prefix without looking at the
+ * other keys, using an index of the keys in sorted order.
+ *
+ * @param prefix start of the keys
+ * @return keys in sorted order
+ */
+QList<QString> CustomData::keysWithPrefix(const QString& prefix) const
+{
+    QMutexLocker locker(&m_cacheMutex);
+    if (!m_sortedKeysValid) {
+        m_sortedKeys = m_data.keys();
+        std::sort(m_sortedKeys.begin(), m_sortedKeys.end());
+        m_sortedKeysValid = true;
+    }
+
+    QList<QString> keys;
+    for (auto it = std::lower_bound(m_sortedKeys.constBegin(), m_sortedKeys.constEnd(), prefix);
+         it != m_sortedKeys.constEnd() && it->startsWith(prefix);
+         ++it) {
+        keys.append(*it);
+    }
+    return keys;
+}
+
+/**
+ * @return public keys of the connected browsers by their client id,
+ *         i.e. the keys starting with BrowserKeyPrefix without the prefix
+ */
+QHash<QString, QString> CustomData::browserKeys() const
+{
+    const QList<QString> keys = keysWithPrefix(BrowserKeyPrefix);
+
+    QMutexLocker locker(&m_cacheMutex);
+    if (!m_browserKeysValid) {
+        m_browserKeys.clear();
+        for (const QString& key : keys) {
+            m_browserKeys.insert(key.mid(BrowserKeyPrefix.size()), m_data.value(key));
+        }
+        m_browserKeysValid = true;
+    }
+    return m_browserKeys;
+}
+
+/**
+ * Drop the cached data derived from the values.
+ *
+ * @param key key whose value changed, all caches are dropped for a null key
+ */
+void CustomData::invalidateCaches(const QString& key)
+{
+    QMutexLocker locker(&m_cacheMutex);
+    if (key.isNull()) {
+        m_sortedKeysValid = false;
+        m_sortedKeys.clear();
+        m_parsedValues.clear();
+    } else {
+        m_parsedValues.remove(key);
+    }
+    if (key.isNull() || key.startsWith(BrowserKeyPrefix)) {
+        m_browserKeysValid = false;
+    }
 }
 
 bool CustomData::operator==(const CustomData& other) const
@@ -150,6 +222,7 @@ void CustomData::clear()
     emit aboutToBeReset();
 
     m_data.clear();
+    invalidateCaches();
 
     emit reset();
     emit customDataModified();
@@ -181,8 +254,11 @@ void CustomData::updateLastModified()
 {
     if (m_data.size() == 1 && m_data.contains(LastModified)) {
         m_data.remove(LastModified);
+        invalidateCaches();
         return;
     }
 
+    const bool added = !m_data.contains(LastModified);
     m_data.insert(LastModified, Clock::currentDateTimeUtc().toString());
+    invalidateCaches(added ? QString() : LastModified);
 }
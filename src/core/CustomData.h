@@ -19,9 +19,11 @@
 #define KEEPASSXC_CUSTOMDATA_H
 
 #include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QSet>
 #include <QStringList>
+#include <QVariant>
 
 class CustomData : public QObject
 {
@@ -44,6 +46,9 @@ public:
     void copyDataFrom(const CustomData* other);
     QDateTime getLastModified() const;
     bool isProtectedCustomData(const QString& key) const;
+    QList<QString> keysWithPrefix(const QString& prefix) const;
+    QHash<QString, QString> browserKeys() const;
+    template <typename T, typename Parser> T parsedValue(const QString& key, Parser parse) const;
     bool operator==(const CustomData& other) const;
     bool operator!=(const CustomData& other) const;
 
@@ -51,6 +56,7 @@ public:
     static const QString Created;
     static const QString BrowserKeyPrefix;
     static const QString BrowserLegacyKeyPrefix;
+    static const QString MergeBaseKeyPrefix;
 
 signals:
     void customDataModified();
@@ -68,7 +74,40 @@ private slots:
     void updateLastModified();
 
 private:
+    friend class HistoryItem;
+
+    void invalidateCaches(const QString& key = {});
+
     QHash<QString, QString> m_data;
+
+    // Caches derived from m_data, built on first use
+    mutable QStringList m_sortedKeys;
+    mutable bool m_sortedKeysValid = false;
+    mutable QHash<QString, QString> m_browserKeys;
+    mutable bool m_browserKeysValid = false;
+    mutable QHash<QString, QVariant> m_parsedValues;
+    mutable QMutex m_cacheMutex;
 };
 
+/**
+ * Get the value of a key in parsed form. The parsed value is cached until
+ * the value of the key changes, so every key must always be parsed into
+ * the same type.
+ *
+ * @param key key of the value
+ * @param parse callable turning the value, empty if the key is missing, into T
+ * @return parsed value
+ */
+template <typename T, typename Parser> T CustomData::parsedValue(const QString& key, Parser parse) const
+{
+    QMutexLocker locker(&m_cacheMutex);
+    auto it = m_parsedValues.constFind(key);
+    if (it != m_parsedValues.constEnd()) {
+        return it->template value<T>();
+    }
+    const T parsed = parse(m_data.value(key));
+    m_parsedValues.insert(key, QVariant::fromValue(parsed));
+    return parsed;
+}
+
 #endif // KEEPASSXC_CUSTOMDATA_H
@@ -19,31 +19,227 @@
 #include "Database.h"
 
 #include "core/AsyncTask.h"
+#include "core/AttachmentStore.h"
 #include "core/Clock.h"
+#include "core/Config.h"
+#include "core/EntrySearchIndex.h"
 #include "core/FileWatcher.h"
 #include "core/Group.h"
 #include "core/Merger.h"
 #include "core/Metadata.h"
+#include "core/PasswordHealthCache.h"
+#include "core/Trace.h"
+#include "format/KdbxXmlFragmentCache.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
+#include "streams/MappedFileDevice.h"
+#include "streams/RecordingStream.h"
 
+#include <QCoreApplication>
+#include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QSaveFile>
+#include <QScopedPointer>
 #include <QTemporaryFile>
+#include <QThread>
 #include <QTimer>
 #include <QXmlStreamReader>
 
+#if defined(Q_OS_WIN)
+#include <io.h>
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(Q_OS_MACOS)
+#include <sys/clonefile.h>
+#elif defined(Q_OS_LINUX)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
 QHash<QUuid, QPointer<Database>> Database::s_uuidMap;
 
+namespace
+{
+    const int UuidHexLength = 32;
+    const int FileWatchIntervalSeconds = 30;
+    const int FileChecksumSizeKiB = 1;
+
+    /**
+     * Collect every hex UUID a reference value could match, which are all
+     * 32 character windows of its hexadecimal runs, see
+     * Entry::isAttributeReferenceOf().
+     */
+    void addReferencedUuids(const QString& value, QStringList& uuids)
+    {
+        const QString lower = value.toLower();
+        int runStart = 0;
+        for (int i = 0; i <= lower.size(); ++i) {
+            const QChar c = i < lower.size() ? lower.at(i) : QChar();
+            if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')) {
+                continue;
+            }
+            for (int start = runStart; start + UuidHexLength <= i; ++start) {
+                const QString uuid = lower.mid(start, UuidHexLength);
+                if (!uuids.contains(uuid)) {
+                    uuids.append(uuid);
+                }
+            }
+            runStart = i + 1;
+        }
+    }
+
+    /**
+     * Create target as a reflink clone of source, which shares the data
+     * blocks of source until either file is written to. Only copy-on-write
+     * file systems support this.
+     */
+    bool reflinkFile(const QString& source, const QString& target)
+    {
+#if defined(Q_OS_MACOS)
+        return ::clonefile(QFile::encodeName(source).constData(), QFile::encodeName(target).constData(), 0) == 0;
+#elif defined(Q_OS_LINUX) && defined(FICLONE)
+        int sourceFd = ::open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC);
+        if (sourceFd < 0) {
+            return false;
+        }
+        bool cloned = false;
+        int targetFd = ::open(QFile::encodeName(target).constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (targetFd >= 0) {
+            cloned = ::ioctl(targetFd, FICLONE, sourceFd) == 0;
+            ::close(targetFd);
+            if (!cloned) {
+                ::unlink(QFile::encodeName(target).constData());
+            }
+        }
+        ::close(sourceFd);
+        return cloned;
+#else
+        Q_UNUSED(source);
+        Q_UNUSED(target);
+        return false;
+#endif
+    }
+
+    /**
+     * Give the file at source the additional name target. As long as the
+     * database file is replaced by a new one, the link keeps the previous
+     * generation without copying it. Writing into the file changes both.
+     */
+    bool hardlinkFile(const QString& source, const QString& target)
+    {
+#if defined(Q_OS_WIN)
+        return CreateHardLinkW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(target).utf16()),
+                               reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(source).utf16()),
+                               nullptr);
+#elif defined(Q_OS_UNIX)
+        return ::link(QFile::encodeName(source).constData(), QFile::encodeName(target).constData()) == 0;
+#else
+        Q_UNUSED(source);
+        Q_UNUSED(target);
+        return false;
+#endif
+    }
+
+    /**
+     * Copy source to target, preferring a reflink clone over a full copy.
+     * On Windows, QFile::copy() uses the system copy which clones blocks
+     * on ReFS by itself.
+     */
+    bool cloneFile(const QString& source, const QString& target)
+    {
+        if (reflinkFile(source, target)) {
+            return true;
+        }
+        if (!QFile::copy(source, target)) {
+            return false;
+        }
+        QFile::setPermissions(target, QFile::permissions(source));
+        return true;
+    }
+
+    /**
+     * Flush the file and wait until the system has written it to the disk.
+     */
+    bool syncFile(QFileDevice* file)
+    {
+        if (!file->flush()) {
+            return false;
+        }
+#if defined(Q_OS_WIN)
+        return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file->handle())));
+#elif defined(Q_OS_UNIX)
+        return ::fsync(file->handle()) == 0;
+#else
+        return true;
+#endif
+    }
+
+    /**
+     * Atomically replace target by source, both must be on the same file system.
+     */
+    bool replaceFile(const QString& source, const QString& target)
+    {
+#if defined(Q_OS_WIN)
+        return MoveFileExW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(source).utf16()),
+                           reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(target).utf16()),
+                           MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+        return ::rename(QFile::encodeName(source).constData(), QFile::encodeName(target).constData()) == 0;
+#endif
+    }
+
+    /**
+     * Stream the contents of source into target, keeping the target file
+     * itself. This works where replacing files does not, but a crash while
+     * writing leaves a partially written target behind.
+     */
+    bool writeFileInPlace(const QString& source, const QString& target, QString* error)
+    {
+        QFile sourceFile(source);
+        if (!sourceFile.open(QIODevice::ReadOnly)) {
+            *error = sourceFile.errorString();
+            return false;
+        }
+
+        // Overwrite instead of truncating first, the target is never empty
+        QFile targetFile(target);
+        if (!targetFile.open(QIODevice::ReadWrite)) {
+            *error = targetFile.errorString();
+            return false;
+        }
+
+        QByteArray buffer;
+        while (!sourceFile.atEnd()) {
+            buffer = sourceFile.read(64 * 1024);
+            if (buffer.isEmpty() || targetFile.write(buffer) != buffer.size()) {
+                *error = buffer.isEmpty() ? sourceFile.errorString() : targetFile.errorString();
+                return false;
+            }
+        }
+
+        if (!targetFile.resize(sourceFile.size()) || !syncFile(&targetFile)) {
+            *error = targetFile.errorString();
+            return false;
+        }
+        return true;
+    }
+} // namespace
+
+const QString Database::DeletedObjectsMaxAgeKey = QStringLiteral("KPXC_DELETED_OBJECTS_MAX_AGE");
+
 Database::Database()
     : m_metadata(new Metadata(this))
     , m_data()
     , m_rootGroup(nullptr)
     , m_fileWatcher(new FileWatcher(this))
+    , m_attachmentStore(new AttachmentStore())
     , m_emitModified(false)
     , m_uuid(QUuid::createUuid())
 {
@@ -60,6 +256,29 @@ Database::Database()
     connect(this, SIGNAL(databaseSaved()), SLOT(updateCommonUsernames()));
     connect(m_fileWatcher, &FileWatcher::fileChanged, this, &Database::databaseFileChanged);
 
+    // the journal is fed from the signals the tree already emits, entries record their modifications directly
+    connect(this, &Database::entryAdded, this, [this](Entry* entry) {
+        m_changeJournal.record(ChangeJournal::Kind::EntryAdded, entry->uuid());
+    });
+    connect(this, &Database::entryAboutToRemove, this, [this](Entry* entry) {
+        m_changeJournal.record(ChangeJournal::Kind::EntryRemoved, entry->uuid());
+    });
+    connect(this, &Database::groupAboutToAdd, this, [this](Group* group) {
+        m_changeJournal.record(ChangeJournal::Kind::GroupAdded, group->uuid());
+    });
+    connect(this, &Database::groupAboutToMove, this, [this](Group* group) {
+        m_changeJournal.record(ChangeJournal::Kind::GroupMoved, group->uuid());
+    });
+    connect(this, &Database::groupAboutToRemove, this, [this](Group* group) {
+        m_changeJournal.record(ChangeJournal::Kind::GroupRemoved, group->uuid());
+    });
+    connect(this, &Database::groupModified, this, [this](Group* group) {
+        m_changeJournal.record(ChangeJournal::Kind::GroupModified, group->uuid(), ChangeJournal::Properties);
+    });
+    connect(m_metadata, &Metadata::metadataModified, this, [this] {
+        m_changeJournal.record(ChangeJournal::Kind::MetadataModified, QUuid());
+    });
+
     m_modified = false;
     m_emitModified = true;
 }
@@ -73,6 +292,12 @@ Database::Database(const QString& filePath)
 Database::~Database()
 {
     releaseData();
+
+    // Groups and entries notify their database directly, so they have to be
+    // destroyed while the members are still alive. Listeners are not notified
+    // anymore, just like during the destruction of the children by QObject.
+    blockSignals(true);
+    qDeleteAll(findChildren<Group*>(QString(), Qt::FindDirectChildrenOnly));
 }
 
 QUuid Database::uuid() const
@@ -108,10 +333,17 @@ bool Database::open(QSharedPointer<const CompositeKey> key, QString* error, bool
  * @param key composite key for unlocking the database
  * @param readOnly open in read-only mode
  * @param error error message in case of failure
+ * @param metadataOnly skip entry history, custom icons and attachments, the
+ *                     database can't be saved then (see isMetadataOnly())
  * @return true on success
  */
-bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey> key, QString* error, bool readOnly)
+bool Database::open(const QString& filePath,
+                    QSharedPointer<const CompositeKey> key,
+                    QString* error,
+                    bool readOnly,
+                    bool metadataOnly)
 {
+    TRACE_SCOPE("Database::open");
     QFile dbFile(filePath);
     if (!dbFile.exists()) {
         if (error) {
@@ -127,7 +359,12 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
     // }
     //
     // if (!dbFile.isOpen() && !dbFile.open(QIODevice::ReadOnly)) {
-    if (!dbFile.open(QIODevice::ReadOnly)) {
+    // Read through a memory mapping unless the file lives on a network share
+    MappedFileDevice mappedFile(filePath);
+    QIODevice* device = &dbFile;
+    if (MappedFileDevice::isMappingSafe(filePath) && mappedFile.open(QIODevice::ReadOnly)) {
+        device = &mappedFile;
+    } else if (!dbFile.open(QIODevice::ReadOnly)) {
         if (error) {
             *error = tr("Unable to open file %1.").arg(filePath);
         }
@@ -135,30 +372,197 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
     }
 
     setEmitModified(false);
+    // the data a running loadSkippedData() would fill in is about to be replaced
+    m_skippedDataLoad = 0;
+
+    // The reader starts with the same bytes, peeking them fills the buffer it reads from
+    // and gives the file watcher its checksum without reading the file a second time
+    QByteArray fileChecksum = FileWatcher::checksumOf(device->peek(FileChecksumSizeKiB * 1024), FileChecksumSizeKiB);
 
     KeePass2Reader reader;
-    if (!reader.readDatabase(&dbFile, std::move(key), this)) {
+    reader.setPipelinedRead(config()->get(Config::PipelinedDatabaseRead).toBool());
+    reader.setDeferredAttachments(config()->get(Config::DeferredAttachmentLoading).toBool());
+    reader.setDeferredProtectedValues(config()->get(Config::DeferredProtectedValues).toBool());
+    reader.setMetadataOnly(metadataOnly);
+    if (!reader.readDatabase(device, std::move(key), this)) {
         if (error) {
             *error = tr("Error while reading the database: %1").arg(reader.errorString());
         }
         return false;
     }
 
-    setReadOnly(readOnly);
+    setReadOnly(readOnly || metadataOnly);
+    m_data.isMetadataOnly = metadataOnly;
     setFilePath(filePath);
-    dbFile.close();
+    device->close();
 
     markAsClean();
+    prepareSaveKey();
 
     emit databaseOpened();
-    m_fileWatcher->start(canonicalFilePath(), 30, 1);
+    m_fileWatcher->start(canonicalFilePath(), FileWatchIntervalSeconds, FileChecksumSizeKiB, fileChecksum);
     setEmitModified(true);
 
     return true;
 }
 
+/**
+ * Open the database from a file in two passes to show it sooner.
+ *
+ * The first pass reads the groups and entries without entry history,
+ * custom icons and attachments, like a metadata-only open(). Unlike
+ * the latter, the database can be edited right away. The file is then
+ * read again on a worker thread, reusing the transformed key, and the
+ * skipped data is filled in once it is read, see skippedDataLoaded().
+ * The database can't be saved until then.
+ *
+ * Keys with challenge-response components are opened in one pass, as
+ * the second read would have to ask the hardware key again.
+ *
+ * @param filePath path to the file
+ * @param key composite key for unlocking the database
+ * @param error error message in case of failure
+ * @param readOnly open in read-only mode
+ * @return true on success
+ */
+bool Database::openProgressively(const QString& filePath,
+                                 QSharedPointer<const CompositeKey> key,
+                                 QString* error,
+                                 bool readOnly)
+{
+    if (!key || !key->challengeResponseKeys().isEmpty()) {
+        return open(filePath, std::move(key), error, readOnly);
+    }
+
+    if (!open(filePath, std::move(key), error, readOnly, true)) {
+        return false;
+    }
+
+    setReadOnly(readOnly);
+    loadSkippedData();
+    return true;
+}
+
+/**
+ * Read the whole file on a worker thread and fill in the data that was
+ * skipped by the first pass of openProgressively().
+ */
+void Database::loadSkippedData()
+{
+    TRACE_SCOPE("Database::loadSkippedData");
+    quint64 load = ++m_skippedDataLoads;
+    m_skippedDataLoad = load;
+
+    QString filePath = m_data.filePath;
+    QSharedPointer<const CompositeKey> key = m_data.key;
+    QByteArray transformSeed = m_data.kdf->seed();
+    QByteArray transformedKey = transformedDatabaseKey();
+    bool pipelined = config()->get(Config::PipelinedDatabaseRead).toBool();
+    bool deferredAttachments = config()->get(Config::DeferredAttachmentLoading).toBool();
+    bool deferredProtectedValues = config()->get(Config::DeferredProtectedValues).toBool();
+
+    AsyncTask::runThenCallback(
+        AsyncTask::Executor::Io,
+        [=] {
+            QSharedPointer<Database> fullDatabase(new Database(), &QObject::deleteLater);
+            fullDatabase->setEmitModified(false);
+
+            KeePass2Reader reader;
+            reader.setPipelinedRead(pipelined);
+            reader.setDeferredAttachments(deferredAttachments);
+            reader.setDeferredProtectedValues(deferredProtectedValues);
+            reader.setTransformedKey(transformSeed, transformedKey);
+            bool ok = reader.readDatabase(filePath, key, fullDatabase.data());
+
+            // read on a worker thread, but filled in and deleted on the GUI thread,
+            // history items have no parent and have to be moved on their own
+            QThread* guiThread = QCoreApplication::instance()->thread();
+            for (Entry* entry : fullDatabase->rootGroup()->entriesRecursive(false)) {
+                for (Entry* historyItem : entry->historyItems()) {
+                    historyItem->moveToThread(guiThread);
+                }
+            }
+            fullDatabase->moveToThread(guiThread);
+            if (!ok) {
+                qWarning("Unable to load the skipped data of %s: %s",
+                         qPrintable(filePath),
+                         qPrintable(reader.errorString()));
+                return QSharedPointer<Database>();
+            }
+            return fullDatabase;
+        },
+        this,
+        [=](const QSharedPointer<Database>& fullDatabase) {
+            if (m_skippedDataLoad != load) {
+                // the database was closed or opened again in the meantime
+                return;
+            }
+            m_skippedDataLoad = 0;
+
+            // A new seed means the file was saved by someone else, its reload takes care of it
+            if (!fullDatabase || fullDatabase->kdf()->seed() != m_data.kdf->seed()) {
+                return;
+            }
+            fillInSkippedData(fullDatabase.data());
+            emit skippedDataLoaded();
+        });
+}
+
+/**
+ * Take the entry history, custom icons and attachments from a full
+ * read of the file. Entries changed in the meantime keep their changes,
+ * history items they got in the meantime follow the read ones.
+ *
+ * @param fullDatabase full read of the file this database was read from
+ */
+void Database::fillInSkippedData(Database* fullDatabase)
+{
+    TRACE_SCOPE("Database::fillInSkippedData");
+    bool modified = m_modified;
+    bool hasNonDataChange = m_hasNonDataChange;
+    beginBulkUpdate();
+
+    // only the icons that were not added in the meantime are missing
+    QSet<QUuid> customIcons;
+    for (const QUuid& uuid : fullDatabase->metadata()->customIconsOrder()) {
+        customIcons.insert(uuid);
+    }
+    m_metadata->copyCustomIcons(customIcons, fullDatabase->metadata());
+
+    for (Entry* entry : m_rootGroup->entriesRecursive(false)) {
+        Entry* fullEntry = fullDatabase->m_entriesByUuid.value(entry->uuid());
+        if (!fullEntry) {
+            continue;
+        }
+
+        entry->takeHistoryFrom(fullEntry);
+
+        // attachments were only skipped where they could not be deferred
+        const EntryAttachments* fullAttachments = fullEntry->attachments();
+        for (const QString& name : fullAttachments->keys()) {
+            if (!entry->attachments()->hasKey(name)) {
+                entry->attachments()->set(name, fullAttachments->value(name));
+            }
+        }
+    }
+
+    m_data.isMetadataOnly = false;
+    endBulkUpdate();
+
+    // filling in what was read is not a modification
+    if (!modified) {
+        m_modified = false;
+        m_modifiedTimer.stop();
+        m_hasNonDataChange = hasNonDataChange;
+    }
+}
+
 bool Database::isSaving()
 {
+    if (m_backgroundSaveRunning) {
+        return true;
+    }
+
     bool locked = m_saveMutex.tryLock();
     if (locked) {
         m_saveMutex.unlock();
@@ -196,9 +600,10 @@ bool Database::save(QString* error, bool atomic, bool backup)
  * prevent the QSaveFile from renaming itself when using Dropbox, Google Drive,
  * or OneDrive.
  *
- * The risk in using QTemporaryFile is that the rename function is not atomic
- * and may result in loss of data if there is a crash or power loss at the
- * wrong moment.
+ * The temporary file is written next to the database and renamed over it.
+ * Where the file cannot be replaced, its new contents are written into the
+ * existing file instead, which may result in loss of data if there is a
+ * crash or power loss at the wrong moment.
  *
  * @param filePath Absolute path of the file to save
  * @param error error message in case of failure
@@ -207,6 +612,161 @@ bool Database::save(QString* error, bool atomic, bool backup)
  * @return true on success
  */
 bool Database::saveAs(const QString& filePath, QString* error, bool atomic, bool backup)
+{
+    if (!canSaveTo(filePath, error)) {
+        return false;
+    }
+
+    // Prevent destructive operations while saving
+    QMutexLocker locker(&m_saveMutex);
+
+    pruneExpiredDeletedObjects();
+
+    // Deferred attachments are read from the original file. It is about to
+    // be replaced, which Windows doesn't allow while it is open, and a
+    // non-atomic save may write into it.
+#ifdef Q_OS_WIN
+    loadDeferredAttachments();
+#else
+    if (!atomic) {
+        loadDeferredAttachments();
+    }
+#endif
+
+    // Clear read-only flag
+    setReadOnly(false);
+    m_fileWatcher->stop();
+
+    QFileInfo fileInfo(filePath);
+    auto realFilePath = fileInfo.exists() ? fileInfo.canonicalFilePath() : fileInfo.absoluteFilePath();
+    bool isNewFile = !QFile::exists(realFilePath);
+    QByteArray fileChecksum;
+    bool ok = AsyncTask::runAndWaitForFuture(
+        AsyncTask::Executor::Io, [&] { return performSave(realFilePath, error, atomic, backup, &fileChecksum); });
+    if (ok) {
+        markAsClean();
+        prepareSaveKey();
+        setFilePath(filePath);
+        if (isNewFile) {
+            QFile::setPermissions(realFilePath, QFile::ReadUser | QFile::WriteUser);
+        }
+        m_fileWatcher->start(realFilePath, FileWatchIntervalSeconds, FileChecksumSizeKiB, fileChecksum);
+    } else {
+        // Saving failed, don't rewatch file since it does not represent our database
+        markAsModified();
+    }
+
+    return ok;
+}
+
+/**
+ * Save the database to the current file path on a worker thread.
+ *
+ * A snapshot of the database is taken first, which is serialized and
+ * written while this database can still be edited. Once the file has
+ * been written, databaseSaved() is emitted. If the database was modified
+ * in the meantime, it stays modified and databaseModified() is emitted
+ * again so the new changes can be saved. If saving fails,
+ * databaseSaveFailed() is emitted.
+ *
+ * @param error error message in case the save could not be started
+ * @param atomic Use atomic file transactions
+ * @param backup Backup the existing database file, if exists
+ * @return true if the save was started
+ */
+bool Database::saveInBackground(QString* error, bool atomic, bool backup)
+{
+    Q_ASSERT(!m_data.filePath.isEmpty());
+    if (m_data.filePath.isEmpty()) {
+        if (error) {
+            *error = tr("Could not save, database does not point to a valid file.");
+        }
+        return false;
+    }
+
+    if (!canSaveTo(m_data.filePath, error)) {
+        return false;
+    }
+
+    // See saveAs() for the deferred attachments
+#ifdef Q_OS_WIN
+    loadDeferredAttachments();
+#else
+    if (!atomic) {
+        loadDeferredAttachments();
+    }
+#endif
+
+    m_fileWatcher->stop();
+
+    QFileInfo fileInfo(m_data.filePath);
+    auto realFilePath = fileInfo.exists() ? fileInfo.canonicalFilePath() : fileInfo.absoluteFilePath();
+    bool isNewFile = !QFile::exists(realFilePath);
+
+    pruneExpiredDeletedObjects();
+    QSharedPointer<Database> snapshot = createSnapshot();
+    {
+        // the snapshot is the one to save next, a seed must never be used twice
+        QMutexLocker locker(&m_preparedSaveKeyMutex);
+        snapshot->m_preparedSaveKey = m_preparedSaveKey;
+        m_preparedSaveKey = {};
+    }
+    m_backgroundSaveRunning = true;
+    m_modifiedDuringSave = false;
+    quint64 generation = m_dataGeneration;
+
+    struct SaveResult
+    {
+        bool ok = false;
+        QString error;
+        QByteArray fileChecksum;
+    };
+
+    AsyncTask::runThenCallback(
+        AsyncTask::Executor::Io,
+        [=] {
+            SaveResult result;
+            result.ok = snapshot->performSave(realFilePath, &result.error, atomic, backup, &result.fileChecksum);
+            return result;
+        },
+        this,
+        [=](const SaveResult& result) {
+            m_backgroundSaveRunning = false;
+            if (generation != m_dataGeneration) {
+                // the database was closed while saving
+                return;
+            }
+
+            if (result.ok) {
+                prepareSaveKey();
+                if (isNewFile) {
+                    QFile::setPermissions(realFilePath, QFile::ReadUser | QFile::WriteUser);
+                }
+                m_fileWatcher->start(realFilePath, FileWatchIntervalSeconds, FileChecksumSizeKiB, result.fileChecksum);
+
+                if (m_modifiedDuringSave) {
+                    emit databaseSaved();
+                    emit databaseModified();
+                } else {
+                    markAsClean();
+                }
+            } else {
+                markAsModified();
+                emit databaseSaveFailed(result.error);
+            }
+        });
+
+    return true;
+}
+
+/**
+ * Check if the database may be saved to the given file.
+ *
+ * @param filePath target file path
+ * @param error error message in case saving is not possible
+ * @return true if the database may be saved
+ */
+bool Database::canSaveTo(const QString& filePath, QString* error)
 {
     // Disallow overlapping save operations
     if (isSaving()) {
@@ -224,8 +784,18 @@ bool Database::saveAs(const QString& filePath, QString* error, bool atomic, bool
         return false;
     }
 
-    // Prevent destructive operations while saving
-    QMutexLocker locker(&m_saveMutex);
+    // Saving would drop the content that was skipped while reading
+    if (m_data.isMetadataOnly && isLoadingSkippedData()) {
+        if (error) {
+            *error = tr("Could not save, the database is still being loaded.");
+        }
+        return false;
+    } else if (m_data.isMetadataOnly) {
+        if (error) {
+            *error = tr("Could not save, the history and attachments of the database were not loaded.");
+        }
+        return false;
+    }
 
     if (filePath == m_data.filePath) {
         // Disallow saving to the same file if read-only
@@ -247,41 +817,142 @@ bool Database::saveAs(const QString& filePath, QString* error, bool atomic, bool
         }
     }
 
-    // Clear read-only flag
-    setReadOnly(false);
-    m_fileWatcher->stop();
+    return true;
+}
 
-    QFileInfo fileInfo(filePath);
-    auto realFilePath = fileInfo.exists() ? fileInfo.canonicalFilePath() : fileInfo.absoluteFilePath();
-    bool isNewFile = !QFile::exists(realFilePath);
-    bool ok = AsyncTask::runAndWaitForFuture([&] { return performSave(realFilePath, error, atomic, backup); });
-    if (ok) {
-        markAsClean();
-        setFilePath(filePath);
-        if (isNewFile) {
-            QFile::setPermissions(realFilePath, QFile::ReadUser | QFile::WriteUser);
+namespace
+{
+    Group* cloneGroupForSnapshot(const Group* group)
+    {
+        Group* clonedGroup = group->clone(Entry::CloneNoFlags, Group::CloneNoFlags);
+        clonedGroup->setUpdateTimeinfo(false);
+
+        for (const Entry* entry : group->entries()) {
+            Entry* clonedEntry = entry->clone(Entry::CloneIncludeHistory | Entry::CloneCompactHistory);
+            clonedEntry->setUpdateTimeinfo(false);
+            clonedEntry->setGroup(clonedGroup);
         }
-        m_fileWatcher->start(realFilePath, 30, 1);
-    } else {
-        // Saving failed, don't rewatch file since it does not represent our database
-        markAsModified();
+
+        for (const Group* child : group->children()) {
+            cloneGroupForSnapshot(child)->setParent(clonedGroup);
+        }
+
+        if (group->lastTopVisibleEntry()) {
+            clonedGroup->setLastTopVisibleEntry(
+                clonedGroup->findEntryByUuid(group->lastTopVisibleEntry()->uuid(), false));
+        }
+
+        return clonedGroup;
     }
+} // namespace
 
-    return ok;
+/**
+ * Create a detached copy of the database for saving it on another thread.
+ * Strings and binary data are implicitly shared with this database, so
+ * the copy mostly consists of the group and entry objects themselves.
+ * Timestamps of the copied items are never updated.
+ *
+ * The snapshot is deleted on the thread it was created on.
+ *
+ * @return database snapshot
+ */
+QSharedPointer<Database> Database::createSnapshot() const
+{
+    return cloneForSnapshot();
+}
+
+/**
+ * Get an immutable copy of the database for reading it on other threads,
+ * see the threading notes of this class. The copy is shared by all callers
+ * until the database is modified. Its modificationCount() is the one of
+ * the database at the time of the copy, and its entries and groups have
+ * the UUIDs of the originals.
+ *
+ * Protected values that have not been decrypted yet stay encrypted in the
+ * copy, decrypting them on first access is thread-safe.
+ *
+ * Must be called on the thread of the database.
+ *
+ * @return read-only database snapshot
+ */
+QSharedPointer<const Database> Database::readSnapshot()
+{
+    Q_ASSERT(thread() == QThread::currentThread());
+
+    if (!m_readSnapshot || m_readSnapshot->m_modificationCount != m_modificationCount) {
+        auto snapshot = cloneForSnapshot();
+        snapshot->m_modificationCount = m_modificationCount;
+        m_readSnapshot = snapshot;
+    }
+    return m_readSnapshot;
 }
 
-bool Database::performSave(const QString& filePath, QString* error, bool atomic, bool backup)
+QSharedPointer<Database> Database::cloneForSnapshot() const
 {
+    QSharedPointer<Database> snapshot(new Database(), &QObject::deleteLater);
+    snapshot->setEmitModified(false);
+
+    Group* oldRoot = snapshot->rootGroup();
+    snapshot->setRootGroup(cloneGroupForSnapshot(m_rootGroup));
+    delete oldRoot;
+
+    snapshot->m_metadata->copyAllFrom(m_metadata, snapshot->m_rootGroup);
+    snapshot->setDeletedObjects(m_deletedObjects);
+
+    snapshot->m_data.filePath = m_data.filePath;
+    snapshot->m_data.cipher = m_data.cipher;
+    snapshot->m_data.compressionAlgorithm = m_data.compressionAlgorithm;
+    snapshot->m_data.masterSeed->setHash(m_data.masterSeed->rawKey());
+    snapshot->m_data.transformedDatabaseKey->setHash(m_data.transformedDatabaseKey->rawKey());
+    snapshot->m_data.challengeResponseKey->setHash(m_data.challengeResponseKey->rawKey());
+    snapshot->m_data.key = m_data.key;
+    snapshot->m_data.kdf = m_data.kdf->clone();
+    snapshot->m_data.publicCustomData = m_data.publicCustomData;
+    snapshot->m_attachmentStore = m_attachmentStore;
+
+    return snapshot;
+}
+
+/**
+ * Write the database to a file and move it into place.
+ *
+ * @param filePath Absolute path of the file to save
+ * @param error error message in case of failure
+ * @param atomic Use atomic file transactions
+ * @param backup Backup the existing database file, if exists
+ * @param fileChecksum receives the file watcher checksum of the written file
+ * @return true on success
+ */
+bool Database::performSave(const QString& filePath, QString* error, bool atomic, bool backup, QByteArray* fileChecksum)
+{
+    TRACE_SCOPE("Database::performSave");
+
+    // Keep the head of the file as it is written, so the file watcher
+    // does not need to read it back to compute its checksum
+    auto writeFile = [&](QIODevice* file) {
+        QByteArray fileHead;
+        RecordingStream recorder(file);
+        recorder.setRecordBuffer(&fileHead);
+        recorder.setRecordLimit(FileChecksumSizeKiB * 1024);
+        if (!recorder.open(QIODevice::WriteOnly) || !writeDatabase(&recorder, error)) {
+            return false;
+        }
+        if (fileChecksum) {
+            *fileChecksum = FileWatcher::checksumOf(fileHead, FileChecksumSizeKiB);
+        }
+        return true;
+    };
+
     if (atomic) {
         QSaveFile saveFile(filePath);
         if (saveFile.open(QIODevice::WriteOnly)) {
             // write the database to the file
-            if (!writeDatabase(&saveFile, error)) {
+            if (!writeFile(&saveFile)) {
                 return false;
             }
 
             if (backup) {
-                backupDatabase(filePath);
+                backupDatabase(filePath, true);
             }
 
             if (saveFile.commit()) {
@@ -294,44 +965,75 @@ bool Database::performSave(const QString& filePath, QString* error, bool atomic,
             *error = saveFile.errorString();
         }
     } else {
-        QTemporaryFile tempFile;
-        if (tempFile.open()) {
+        // Write next to the database, so the file can be renamed into place
+        // instead of being copied across file systems
+        QFileInfo fileInfo(filePath);
+        QScopedPointer<QTemporaryFile> tempFile(
+            new QTemporaryFile(fileInfo.absoluteDir().filePath(QString(".%1.XXXXXX").arg(fileInfo.fileName()))));
+        bool sameDirectory = tempFile->open();
+        if (!sameDirectory) {
+            // The directory does not allow new files, the database can only be written in place
+            tempFile.reset(new QTemporaryFile());
+            tempFile->open();
+        }
+
+        if (tempFile->isOpen()) {
             // write the database to the file
-            if (!writeDatabase(&tempFile, error)) {
+            if (!writeFile(tempFile.data())) {
                 return false;
             }
 
-            tempFile.close(); // flush to disk
+            bool synced = syncFile(tempFile.data());
+            tempFile->close();
+            if (!synced) {
+                if (error) {
+                    *error = tempFile->errorString();
+                }
+                return false;
+            }
 
             if (backup) {
-                backupDatabase(filePath);
+                backupDatabase(filePath, sameDirectory);
             }
 
-            // Delete the original db and move the temp file in place
             auto perms = QFile::permissions(filePath);
-            QFile::remove(filePath);
+            if (perms) {
+                QFile::setPermissions(tempFile->fileName(), perms);
+            }
 
-            // Note: call into the QFile rename instead of QTemporaryFile
-            // due to an undocumented difference in how the function handles
-            // errors. This prevents errors when saving across file systems.
-            if (tempFile.QFile::rename(filePath)) {
+            if (sameDirectory && replaceFile(tempFile->fileName(), filePath)) {
                 // successfully saved the database
-                tempFile.setAutoRemove(false);
-                QFile::setPermissions(filePath, perms);
+                tempFile->setAutoRemove(false);
+                return true;
+            }
+
+            // Some cloud sync folders and network shares refuse to replace
+            // the file, write the new contents through to the existing one.
+            // A hard linked backup would be overwritten along with it.
+            if (backup && sameDirectory) {
+                backupDatabase(filePath, false);
+            }
+            QString writeError;
+            if (writeFileInPlace(tempFile->fileName(), filePath, &writeError)) {
                 return true;
             } else if (!backup || !restoreDatabase(filePath)) {
-                // Failed to copy new database in place, and
+                // Failed to write the new database in place, and
                 // failed to restore from backup or backups disabled
-                tempFile.setAutoRemove(false);
+                tempFile->setAutoRemove(false);
                 if (error) {
-                    *error = tr("%1\nBackup database located at %2").arg(tempFile.errorString(), tempFile.fileName());
+                    *error = tr("%1\nBackup database located at %2").arg(writeError, tempFile->fileName());
                 }
                 return false;
             }
+
+            if (error) {
+                *error = writeError;
+            }
+            return false;
         }
 
         if (error) {
-            *error = tempFile.errorString();
+            *error = tempFile->errorString();
         }
     }
 
@@ -355,6 +1057,16 @@ bool Database::writeDatabase(QIODevice* device, QString* error)
     }
 
     KeePass2Writer writer;
+    if (config()->get(Config::IncrementalSave).toBool()) {
+        if (!m_xmlFragmentCache) {
+            m_xmlFragmentCache.reset(new KdbxXmlFragmentCache());
+        }
+        writer.setFragmentCache(m_xmlFragmentCache.data());
+    } else {
+        m_xmlFragmentCache.reset();
+    }
+    writer.setCompression(config()->get(Config::CompressionLevel).toInt(),
+                          config()->get(Config::ParallelCompression).toBool());
     setEmitModified(false);
     writer.writeDatabase(device, this);
     setEmitModified(true);
@@ -390,127 +1102,515 @@ bool Database::extract(QByteArray& xmlOutput, QString* error)
         return false;
     }
 
-    return true;
+    return true;
+}
+
+/**
+ * Stream the decrypted database as XML to a device without
+ * building the whole document in memory first.
+ *
+ * @param device output device
+ * @param error error message in case of failure
+ * @return true on success
+ */
+bool Database::extract(QIODevice* device, QString* error)
+{
+    KeePass2Writer writer;
+    writer.extractDatabase(this, device);
+    if (writer.hasError()) {
+        if (error) {
+            *error = writer.errorString();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool Database::import(const QString& xmlExportPath, QString* error)
+{
+    KdbxXmlReader reader(KeePass2::FILE_VERSION_4);
+    QFile file(xmlExportPath);
+    file.open(QIODevice::ReadOnly);
+
+    reader.readDatabase(&file, this);
+
+    if (reader.hasError()) {
+        if (error) {
+            *error = reader.errorString();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Release all stored group, entry, and meta data of this database.
+ *
+ * Call this method to ensure all data is cleared even if valid
+ * pointers to this Database object are still being held.
+ *
+ * The groups and entries are deleted without notifying anybody, models
+ * showing them have to let go of them on dataAboutToBeReleased().
+ * A previously reparented root group will not be freed.
+ */
+
+void Database::releaseData()
+{
+    // Prevent data release while saving
+    QMutexLocker locker(&m_saveMutex);
+
+    if (m_modified) {
+        emit databaseDiscarded();
+    }
+
+    setEmitModified(false);
+    m_modified = false;
+    m_modifiedTimer.stop();
+    // discard the result of a running background save
+    ++m_dataGeneration;
+    m_skippedDataLoad = 0;
+
+    s_uuidMap.remove(m_uuid);
+    m_uuid = QUuid();
+
+    emit dataAboutToBeReleased();
+
+    m_data.clear();
+    m_metadata->clear();
+    {
+        QMutexLocker preparedKeyLocker(&m_preparedSaveKeyMutex);
+        m_preparedSaveKey = {};
+    }
+    m_readSnapshot.reset();
+
+    // the old tree is destroyed at once instead of object by object
+    Group* oldRoot = m_rootGroup;
+    m_entriesByUuid.clear();
+    m_groupsByUuid.clear();
+    m_referencingEntries.clear();
+    m_referencedUuids.clear();
+    m_usernameCounts.clear();
+    m_countedUsernames.clear();
+    setRootGroup(new Group());
+    if (oldRoot && oldRoot->QObject::parent() == this && !oldRoot->parentGroup()) {
+        Group::destroyTree(oldRoot);
+    }
+
+    emit dataReleased();
+
+    m_fileWatcher->stop();
+
+    m_deletedObjects.clear();
+    m_deletedObjectUuids.clear();
+    m_deletedObjectUuidsValid = false;
+    m_commonUsernames.clear();
+    m_commonUsernamesValid = true;
+    m_attachmentStore->clear();
+}
+
+/**
+ * Remove the old backup and replace it with a new one
+ * backups are named <filename>.old.<extension>
+ *
+ * The backup is a reflink clone where the file system supports it.
+ * Otherwise it is a hard link to the current file if the save replaces
+ * the file rather than writing into it, or a full copy.
+ *
+ * @param filePath Path to the file to backup
+ * @param replacedByRename the new database is renamed over the file
+ * @return true on success
+ */
+bool Database::backupDatabase(const QString& filePath, bool replacedByRename)
+{
+    static auto re = QRegularExpression("(\\.[^.]+)$");
+
+    auto match = re.match(filePath);
+    auto backupFilePath = filePath;
+    backupFilePath = backupFilePath.replace(re, "") + ".old" + match.captured(1);
+    QFile::remove(backupFilePath);
+    if (reflinkFile(filePath, backupFilePath)) {
+        QFile::setPermissions(backupFilePath, QFile::permissions(filePath));
+        return true;
+    }
+    return (replacedByRename && hardlinkFile(filePath, backupFilePath)) || cloneFile(filePath, backupFilePath);
+}
+
+/**
+ * Restores the database file from the backup file with
+ * name <filename>.old.<extension> to filePath. This will
+ * overwrite the existing file!
+ *
+ * @param filePath Path to the file to restore
+ * @return true on success
+ */
+bool Database::restoreDatabase(const QString& filePath)
+{
+    static auto re = QRegularExpression("^(.*?)(\\.[^.]+)?$");
+
+    auto match = re.match(filePath);
+    auto backupFilePath = match.captured(1) + ".old" + match.captured(2);
+    // Only try to restore if the backup file actually exists
+    if (QFile::exists(backupFilePath)) {
+        // The backup may share its inode with older files, never link it back
+        QFile::remove(filePath);
+        return cloneFile(backupFilePath, filePath);
+    }
+    return false;
+}
+
+bool Database::isReadOnly() const
+{
+    return m_data.isReadOnly;
+}
+
+void Database::setReadOnly(bool readOnly)
+{
+    m_data.isReadOnly = readOnly;
+}
+
+/**
+ * @return true if the database was opened without entry history, custom
+ *         icons and attachments, it can't be saved then
+ */
+bool Database::isMetadataOnly() const
+{
+    return m_data.isMetadataOnly;
+}
+
+/**
+ * @return true if the data skipped by openProgressively() is still being read
+ */
+bool Database::isLoadingSkippedData() const
+{
+    return m_skippedDataLoad != 0;
+}
+
+/**
+ * Returns true if the database key exists, has subkeys, and the
+ * root group exists
+ *
+ * @return true if database has been fully initialized
+ */
+bool Database::isInitialized() const
+{
+    return m_data.key && !m_data.key->isEmpty() && m_rootGroup;
+}
+
+void Database::addToUuidIndex(Entry* entry)
+{
+    m_entriesByUuid.insert(entry->uuid(), entry);
+    invalidatePathIndex();
+}
+
+void Database::removeFromUuidIndex(Entry* entry, const QUuid& uuid)
+{
+    m_entriesByUuid.remove(uuid, entry);
+    invalidatePathIndex();
+}
+
+void Database::addToUuidIndex(Group* group)
+{
+    m_groupsByUuid.insert(group->uuid(), group);
+}
+
+void Database::removeFromUuidIndex(Group* group, const QUuid& uuid)
+{
+    m_groupsByUuid.remove(uuid, group);
+}
+
+/**
+ * Index the UUIDs referenced by the entry, called whenever an entry of
+ * this database is added or modified.
+ */
+void Database::updateReferenceIndex(Entry* entry)
+{
+    // the title may have changed
+    invalidatePathIndex();
+    removeFromReferenceIndex(entry);
+
+    QStringList uuids;
+    const EntryAttributes* attributes = entry->attributes();
+    for (const QString& key : EntryAttributes::DefaultAttributes) {
+        if (attributes->contains(key) && attributes->value(key).contains(QLatin1String("{REF:"), Qt::CaseInsensitive)
+            && attributes->isReference(key)) {
+            addReferencedUuids(attributes->value(key), uuids);
+        }
+    }
+
+    if (!uuids.isEmpty()) {
+        for (const QString& uuid : asConst(uuids)) {
+            m_referencingEntries.insert(uuid, entry);
+        }
+        m_referencedUuids.insert(entry, uuids);
+    }
+}
+
+void Database::removeFromReferenceIndex(const Entry* entry)
+{
+    const QStringList uuids = m_referencedUuids.take(entry);
+    for (const QString& uuid : uuids) {
+        m_referencingEntries.remove(uuid, const_cast<Entry*>(entry));
+    }
+}
+
+/**
+ * Look up an entry by its path from the root group, or by its title if the
+ * path does not start with a slash. Matches Group::findEntryByPath() on the
+ * root group: with duplicate paths or titles the first entry in tree order wins.
+ *
+ * @param path normalized entry path
+ * @return entry or nullptr if no entry has this path
+ */
+Entry* Database::entryByPath(const QString& path) const
+{
+    QMutexLocker locker(&m_pathIndexMutex);
+    updatePathIndex();
+    if (path.startsWith('/')) {
+        return m_entriesByPath.value(path);
+    }
+    return m_entriesByTitle.value(path);
+}
+
+/**
+ * Look up a group by its path from the root group, see Group::findGroupByPath().
+ *
+ * @param path normalized group path starting and ending with a slash
+ * @return group or nullptr if no group has this path
+ */
+Group* Database::groupByPath(const QString& path) const
+{
+    QMutexLocker locker(&m_pathIndexMutex);
+    updatePathIndex();
+    return m_groupsByPath.value(path);
+}
+
+/**
+ * Called whenever an entry is added, removed or modified, changes of groups
+ * and the tree structure are tracked by Group::treeGeneration().
+ */
+void Database::invalidatePathIndex()
+{
+    QMutexLocker locker(&m_pathIndexMutex);
+    m_pathIndexValid = false;
+}
+
+void Database::updatePathIndex() const
+{
+    const quint64 generation = Group::treeGeneration();
+    if (m_pathIndexValid && m_pathIndexGeneration == generation) {
+        return;
+    }
+
+    m_entriesByPath.clear();
+    m_entriesByTitle.clear();
+    m_groupsByPath.clear();
+    if (m_rootGroup) {
+        indexPaths(m_rootGroup, QStringLiteral("/"));
+    }
+    m_pathIndexValid = true;
+    m_pathIndexGeneration = generation;
+}
+
+void Database::indexPaths(Group* group, const QString& basePath) const
+{
+    if (!m_groupsByPath.contains(basePath)) {
+        m_groupsByPath.insert(basePath, group);
+    }
+    for (Entry* entry : group->entries()) {
+        const QString path = basePath + entry->title();
+        if (!m_entriesByPath.contains(path)) {
+            m_entriesByPath.insert(path, entry);
+        }
+        if (!m_entriesByTitle.contains(entry->title())) {
+            m_entriesByTitle.insert(entry->title(), entry);
+        }
+    }
+    for (Group* child : group->children()) {
+        indexPaths(child, basePath + child->name() + "/");
+    }
+}
+
+/**
+ * Count the username of the entry towards the common usernames, called
+ * whenever an entry of this database is added or modified.
+ */
+void Database::updateUsernameIndex(const Entry* entry)
+{
+    QString username = entry->username();
+    if (username.contains(QLatin1String("{REF:"), Qt::CaseInsensitive)
+        && entry->isAttributeReference(EntryAttributes::UserNameKey)) {
+        username.clear();
+    }
+
+    auto counted = m_countedUsernames.find(entry);
+    if (counted != m_countedUsernames.end() && counted.value() == username) {
+        return;
+    }
+    if (counted == m_countedUsernames.end() && username.isEmpty()) {
+        return;
+    }
+
+    removeFromUsernameIndex(entry);
+    if (!username.isEmpty()) {
+        ++m_usernameCounts[username];
+        m_countedUsernames.insert(entry, username);
+    }
+    m_commonUsernamesValid = false;
 }
 
-bool Database::import(const QString& xmlExportPath, QString* error)
+void Database::removeFromUsernameIndex(const Entry* entry)
 {
-    KdbxXmlReader reader(KeePass2::FILE_VERSION_4);
-    QFile file(xmlExportPath);
-    file.open(QIODevice::ReadOnly);
-
-    reader.readDatabase(&file, this);
+    auto counted = m_countedUsernames.find(entry);
+    if (counted == m_countedUsernames.end()) {
+        return;
+    }
 
-    if (reader.hasError()) {
-        if (error) {
-            *error = reader.errorString();
-        }
-        return false;
+    auto count = m_usernameCounts.find(counted.value());
+    if (count != m_usernameCounts.end() && --count.value() <= 0) {
+        m_usernameCounts.erase(count);
     }
+    m_countedUsernames.erase(counted);
+    m_commonUsernamesValid = false;
+}
 
-    return true;
+/**
+ * @return content-addressed store of the attachment data of this database
+ */
+AttachmentStore* Database::attachmentStore() const
+{
+    return m_attachmentStore.data();
 }
 
 /**
- * Release all stored group, entry, and meta data of this database.
+ * Distinct attachments of all entries and history items. The position
+ * of an attachment in the list is its binary id in the database file,
+ * the order only depends on the entries, so both the inner header and
+ * the XML of a KDBX file can be written from it independently.
  *
- * Call this method to ensure all data is cleared even if valid
- * pointers to this Database object are still being held.
+ * Deferred attachments are not read, they are told apart by their
+ * position in their source. A source holds every binary of its file
+ * once, so only the attachments held in memory have to be hashed.
  *
- * A previously reparented root group will not be freed.
+ * @return list of unique attachments
  */
-
-void Database::releaseData()
+QList<AttachmentValue> Database::attachmentPool() const
 {
-    // Prevent data release while saving
-    QMutexLocker locker(&m_saveMutex);
-
-    if (m_modified) {
-        emit databaseDiscarded();
+    QList<AttachmentValue> pool;
+    if (!m_rootGroup) {
+        return pool;
     }
 
-    setEmitModified(false);
-    m_modified = false;
-    m_modifiedTimer.stop();
-
-    s_uuidMap.remove(m_uuid);
-    m_uuid = QUuid();
-
-    m_data.clear();
-    m_metadata->clear();
+    m_attachmentStore->prune();
 
-    setRootGroup(new Group());
+    QSet<QByteArray> digests;
+    QSet<QPair<const AttachmentSource*, int>> deferred;
+    auto addValue = [this, &pool, &digests, &deferred](const AttachmentValue& value) {
+        if (value.isDeferred()) {
+            const auto id = qMakePair(value.source.data(), value.index);
+            if (!deferred.contains(id)) {
+                deferred.insert(id);
+                pool.append(value);
+            }
+            return;
+        }
 
-    m_fileWatcher->stop();
+        const QByteArray digest = m_attachmentStore->digest(value.data);
+        if (!digests.contains(digest)) {
+            digests.insert(digest);
+            pool.append(value);
+        }
+    };
+
+    // same order as entriesRecursive(true), without expanding the history
+    m_rootGroup->forEachGroupRecursive([&addValue](const Group* group) -> bool {
+        const QList<Entry*> entries = group->entries();
+        for (const Entry* entry : entries) {
+            const EntryAttachments* attachments = entry->attachments();
+            const QList<QString> keys = attachments->keys();
+            for (const QString& key : keys) {
+                addValue(attachments->valueRef(key));
+            }
+        }
+        for (const Entry* entry : entries) {
+            const QList<AttachmentValue> values = entry->historyAttachmentValues();
+            for (const AttachmentValue& value : values) {
+                addValue(value);
+            }
+        }
+        return true;
+    });
 
-    m_deletedObjects.clear();
-    m_commonUsernames.clear();
+    return pool;
 }
 
 /**
- * Remove the old backup and replace it with a new one
- * backups are named <filename>.old.<extension>
+ * Search index of the entries in this database. The index is created on
+ * first use and only covers entries that have been searched since.
  *
- * @param filePath Path to the file to backup
- * @return true on success
+ * @return search index owned by the database
  */
-bool Database::backupDatabase(const QString& filePath)
+EntrySearchIndex* Database::searchIndex() const
 {
-    static auto re = QRegularExpression("(\\.[^.]+)$");
-
-    auto match = re.match(filePath);
-    auto backupFilePath = filePath;
-    auto perms = QFile::permissions(filePath);
-    backupFilePath = backupFilePath.replace(re, "") + ".old" + match.captured(1);
-    QFile::remove(backupFilePath);
-    bool res = QFile::copy(filePath, backupFilePath);
-    QFile::setPermissions(backupFilePath, perms);
-    return res;
+    if (!m_searchIndex) {
+        m_searchIndex.reset(new EntrySearchIndex());
+    }
+    return m_searchIndex.data();
 }
 
 /**
- * Restores the database file from the backup file with
- * name <filename>.old.<extension> to filePath. This will
- * overwrite the existing file!
+ * Password reuse and entropy cache of the health reports, created on
+ * first use and brought up to date by the reports themselves.
  *
- * @param filePath Path to the file to restore
- * @return true on success
+ * @return health cache owned by the database
  */
-bool Database::restoreDatabase(const QString& filePath)
+PasswordHealthCache* Database::healthCache() const
 {
-    static auto re = QRegularExpression("^(.*?)(\\.[^.]+)?$");
-
-    auto match = re.match(filePath);
-    auto perms = QFile::permissions(filePath);
-    auto backupFilePath = match.captured(1) + ".old" + match.captured(2);
-    // Only try to restore if the backup file actually exists
-    if (QFile::exists(backupFilePath)) {
-        QFile::remove(filePath);
-        return QFile::copy(backupFilePath, filePath);
-        QFile::setPermissions(filePath, perms);
+    if (!m_healthCache) {
+        m_healthCache.reset(new PasswordHealthCache());
     }
-    return false;
+    return m_healthCache.data();
 }
 
-bool Database::isReadOnly() const
+/**
+ * Estimate the memory held by the database contents, to tell whether it goes
+ * to entries, their history, attachments, icons or custom data.
+ */
+MemoryUsage Database::memoryUsage() const
 {
-    return m_data.isReadOnly;
+    MemoryUsage usage;
+    if (!m_rootGroup) {
+        return usage;
+    }
+
+    m_metadata->addMemoryUsage(usage);
+    for (const Group* group : m_rootGroup->groupsRecursive(true)) {
+        usage.customData += MemoryUsage::textSize(group->customData()->dataSize());
+        for (const Entry* entry : group->entries()) {
+            entry->addMemoryUsage(usage);
+        }
+    }
+    usage.deletedObjects = static_cast<qint64>(m_deletedObjects.size()) * sizeof(DeletedObject);
+    return usage;
 }
 
-void Database::setReadOnly(bool readOnly)
+/**
+ * @return number of modifications of the database data, which changes
+ *         whenever an entry or group is modified, added or removed
+ */
+quint64 Database::modificationCount() const
 {
-    m_data.isReadOnly = readOnly;
+    return m_modificationCount;
 }
 
 /**
- * Returns true if the database key exists, has subkeys, and the
- * root group exists
- *
- * @return true if database has been fully initialized
+ * @return changes to the groups, entries and metadata of the database,
+ *         for consumers that update their state incrementally
  */
-bool Database::isInitialized() const
+const ChangeJournal* Database::changeJournal() const
 {
-    return m_data.key && !m_data.key->isEmpty() && m_rootGroup;
+    return &m_changeJournal;
 }
 
 Group* Database::rootGroup()
@@ -538,6 +1638,28 @@ void Database::setRootGroup(Group* group)
         emit databaseDiscarded();
     }
 
+    if (m_xmlFragmentCache) {
+        m_xmlFragmentCache->clear();
+    }
+
+    if (m_searchIndex) {
+        m_searchIndex->clear();
+    }
+
+    {
+        QMutexLocker locker(&m_pathIndexMutex);
+        m_entriesByPath.clear();
+        m_entriesByTitle.clear();
+        m_groupsByPath.clear();
+        m_pathIndexValid = false;
+    }
+
+    if (m_healthCache) {
+        m_healthCache->clear();
+    }
+
+    ++m_modificationCount;
+    m_changeJournal.reset();
     m_rootGroup = group;
     m_rootGroup->setParent(this);
 }
@@ -600,22 +1722,20 @@ const QList<DeletedObject>& Database::deletedObjects() const
 
 bool Database::containsDeletedObject(const QUuid& uuid) const
 {
-    for (const DeletedObject& currentObject : m_deletedObjects) {
-        if (currentObject.uuid == uuid) {
-            return true;
+    if (!m_deletedObjectUuidsValid) {
+        m_deletedObjectUuids.clear();
+        m_deletedObjectUuids.reserve(m_deletedObjects.size());
+        for (const DeletedObject& currentObject : m_deletedObjects) {
+            ++m_deletedObjectUuids[currentObject.uuid];
         }
+        m_deletedObjectUuidsValid = true;
     }
-    return false;
+    return m_deletedObjectUuids.contains(uuid);
 }
 
 bool Database::containsDeletedObject(const DeletedObject& object) const
 {
-    for (const DeletedObject& currentObject : m_deletedObjects) {
-        if (currentObject.uuid == object.uuid) {
-            return true;
-        }
-    }
-    return false;
+    return containsDeletedObject(object.uuid);
 }
 
 void Database::setDeletedObjects(const QList<DeletedObject>& delObjs)
@@ -624,12 +1744,93 @@ void Database::setDeletedObjects(const QList<DeletedObject>& delObjs)
         return;
     }
     m_deletedObjects = delObjs;
+    // Merger replaces the list after every erased item, so rebuild lazily
+    m_deletedObjectUuidsValid = false;
 }
 
 void Database::addDeletedObject(const DeletedObject& delObj)
 {
     Q_ASSERT(delObj.deletionTime.timeSpec() == Qt::UTC);
     m_deletedObjects.append(delObj);
+    if (m_deletedObjectUuidsValid) {
+        ++m_deletedObjectUuids[delObj.uuid];
+    }
+}
+
+/**
+ * Drop the deleted objects that were recorded after the list had the given size.
+ *
+ * @param count number of deleted objects to keep
+ */
+void Database::truncateDeletedObjects(int count)
+{
+    while (m_deletedObjects.size() > qMax(count, 0)) {
+        const QUuid uuid = m_deletedObjects.takeLast().uuid;
+        if (m_deletedObjectUuidsValid) {
+            auto it = m_deletedObjectUuids.find(uuid);
+            if (it != m_deletedObjectUuids.end() && --it.value() <= 0) {
+                m_deletedObjectUuids.erase(it);
+            }
+        }
+    }
+}
+
+/**
+ * Remove the deleted objects that were deleted before the given time.
+ *
+ * Once a deleted object is removed, a copy of the database that still contains
+ * the object will bring it back on the next merge, so only objects older than
+ * any copy that is still synchronized should be pruned.
+ *
+ * @param olderThan cutoff time in UTC
+ * @return number of removed deleted objects
+ */
+int Database::pruneDeletedObjects(const QDateTime& olderThan)
+{
+    const int count = m_deletedObjects.size();
+    m_deletedObjects.erase(std::remove_if(m_deletedObjects.begin(),
+                                          m_deletedObjects.end(),
+                                          [&olderThan](const DeletedObject& object) {
+                                              return object.deletionTime < olderThan;
+                                          }),
+                           m_deletedObjects.end());
+
+    const int removed = count - m_deletedObjects.size();
+    if (removed > 0) {
+        m_deletedObjectUuidsValid = false;
+    }
+    return removed;
+}
+
+/**
+ * @return maximum age of deleted objects in days, 0 if they are kept forever
+ */
+int Database::deletedObjectsMaxAge() const
+{
+    return qMax(m_metadata->customData()->value(DeletedObjectsMaxAgeKey).toInt(), 0);
+}
+
+/**
+ * Set the maximum age of deleted objects. Older deleted objects are pruned
+ * whenever the database is saved.
+ *
+ * @param days maximum age in days, 0 to keep deleted objects forever
+ */
+void Database::setDeletedObjectsMaxAge(int days)
+{
+    if (days > 0) {
+        m_metadata->customData()->set(DeletedObjectsMaxAgeKey, QString::number(days));
+    } else {
+        m_metadata->customData()->remove(DeletedObjectsMaxAgeKey);
+    }
+}
+
+void Database::pruneExpiredDeletedObjects()
+{
+    const int maxAge = deletedObjectsMaxAge();
+    if (maxAge > 0) {
+        pruneDeletedObjects(Clock::currentDateTimeUtc().addDays(-maxAge));
+    }
 }
 
 void Database::addDeletedObject(const QUuid& uuid)
@@ -641,15 +1842,67 @@ void Database::addDeletedObject(const QUuid& uuid)
     addDeletedObject(delObj);
 }
 
+/**
+ * Read all attachments that are still loaded on demand into memory,
+ * so they no longer depend on the database file. Every binary of the
+ * file is read once and shared by all entries and history items that
+ * refer to it.
+ */
+void Database::loadDeferredAttachments()
+{
+    if (!m_rootGroup) {
+        return;
+    }
+
+    EntryAttachments::LoadedValues loaded;
+    m_rootGroup->forEachEntryRecursive([&loaded](Entry* entry) -> bool {
+        entry->loadDeferredAttachments(&loaded);
+        return true;
+    });
+}
+
+/**
+ * @return most used usernames of this database, ordered by frequency and name
+ */
 QList<QString> Database::commonUsernames()
 {
+    if (!m_commonUsernamesValid) {
+        updateCommonUsernames(m_commonUsernamesTopN);
+    }
     return m_commonUsernames;
 }
 
+/**
+ * Rebuild the list of common usernames from the username counts, which
+ * are maintained as entries are added, modified and removed.
+ *
+ * @param topN number of usernames to keep, all of them if negative
+ */
 void Database::updateCommonUsernames(int topN)
 {
+    QList<QPair<QString, int>> sortedUsernames;
+    sortedUsernames.reserve(m_usernameCounts.size());
+    for (auto it = m_usernameCounts.constBegin(); it != m_usernameCounts.constEnd(); ++it) {
+        sortedUsernames.append({it.key(), it.value()});
+    }
+
+    auto comparator = [](const QPair<QString, int>& arg1, const QPair<QString, int>& arg2) {
+        if (arg1.second == arg2.second) {
+            return arg1.first < arg2.first;
+        }
+        return arg1.second > arg2.second;
+    };
+
+    int actualUsernames = topN < 0 ? sortedUsernames.size() : qMin(topN, sortedUsernames.size());
+    std::partial_sort(
+        sortedUsernames.begin(), sortedUsernames.begin() + actualUsernames, sortedUsernames.end(), comparator);
+
     m_commonUsernames.clear();
-    m_commonUsernames.append(rootGroup()->usernamesRecursive(topN));
+    for (int i = 0; i < actualUsernames; ++i) {
+        m_commonUsernames.append(sortedUsernames[i].first);
+    }
+    m_commonUsernamesTopN = topN;
+    m_commonUsernamesValid = true;
 }
 
 const QUuid& Database::cipher() const
@@ -679,17 +1932,32 @@ bool Database::challengeMasterSeed(const QByteArray& masterSeed)
         m_data.masterSeed->setHash(masterSeed);
         QByteArray response;
         bool ok = m_data.key->challenge(masterSeed, response, &m_keyError);
-        if (ok && !response.isEmpty()) {
-            m_data.challengeResponseKey->setHash(response);
-        } else if (ok && response.isEmpty()) {
-            // no CR key present, make sure buffer is empty
-            m_data.challengeResponseKey.reset(new PasswordKey);
+        if (ok) {
+            setChallengeResponse(masterSeed, response);
         }
         return ok;
     }
     return false;
 }
 
+/**
+ * Store the response to a master seed challenge that was issued
+ * by the caller, e.g. concurrently to the key transformation.
+ *
+ * @param masterSeed challenged master seed
+ * @param response challenge response, empty if the key has no challenge-response component
+ */
+void Database::setChallengeResponse(const QByteArray& masterSeed, const QByteArray& response)
+{
+    m_data.masterSeed->setHash(masterSeed);
+    if (!response.isEmpty()) {
+        m_data.challengeResponseKey->setHash(response);
+    } else {
+        // no CR key present, make sure buffer is empty
+        m_data.challengeResponseKey.reset(new PasswordKey);
+    }
+}
+
 void Database::setCipher(const QUuid& cipher)
 {
     Q_ASSERT(!cipher.isNull());
@@ -727,7 +1995,10 @@ bool Database::setKey(const QSharedPointer<const CompositeKey>& key,
         return true;
     }
 
-    if (updateTransformSalt) {
+    QByteArray transformedDatabaseKey;
+    const bool prepared = updateTransformSalt && transformKey && takePreparedSaveKey(key, transformedDatabaseKey);
+
+    if (updateTransformSalt && !prepared) {
         m_data.kdf->randomizeSeed();
         Q_ASSERT(!m_data.kdf->seed().isEmpty());
     }
@@ -737,11 +2008,9 @@ bool Database::setKey(const QSharedPointer<const CompositeKey>& key,
         oldTransformedDatabaseKey.setHash(m_data.transformedDatabaseKey->rawKey());
     }
 
-    QByteArray transformedDatabaseKey;
-
     if (!transformKey) {
         transformedDatabaseKey = QByteArray(oldTransformedDatabaseKey.rawKey());
-    } else if (!key->transform(*m_data.kdf, transformedDatabaseKey, &m_keyError)) {
+    } else if (!prepared && !key->transform(*m_data.kdf, transformedDatabaseKey, &m_keyError)) {
         return false;
     }
 
@@ -760,6 +2029,84 @@ bool Database::setKey(const QSharedPointer<const CompositeKey>& key,
     return true;
 }
 
+/**
+ * Set the key without running the KDF, the transformed key must belong
+ * to the current KDF settings, e.g. when reading a file a second time.
+ *
+ * @param key composite key
+ * @param transformedKey the key transformed with kdf()
+ */
+void Database::setTransformedKey(const QSharedPointer<const CompositeKey>& key, const QByteArray& transformedKey)
+{
+    m_keyError.clear();
+    m_data.key = key;
+    m_data.transformedDatabaseKey->setHash(transformedKey);
+}
+
+/**
+ * Start deriving the key for the next save in the background. Every save
+ * uses a fresh KDF seed and has to run the KDF for it, which takes a second
+ * or more with the default settings. Doing that ahead of time lets the next
+ * save start writing right away, see takePreparedSaveKey().
+ *
+ * Keys with challenge-response components are never prepared, as they could
+ * ask for a hardware key at any time.
+ */
+void Database::prepareSaveKey()
+{
+    QMutexLocker locker(&m_preparedSaveKeyMutex);
+    m_preparedSaveKey = {};
+
+    const auto key = m_data.key;
+    if (!config()->get(Config::PrepareSaveKey).toBool() || m_data.isReadOnly || !m_data.kdf || !key
+        || key->isEmpty() || !key->challengeResponseKeys().isEmpty()) {
+        return;
+    }
+
+    auto kdf = m_data.kdf->clone();
+    kdf->randomizeSeed();
+    // nobody waits for the prepared key, it must not slow down anything else
+    m_preparedSaveKey = AsyncTask::run(AsyncTask::Executor::Background, [key, kdf] {
+        PreparedKey prepared;
+        prepared.key = key;
+        prepared.kdf = kdf;
+        if (!key->transform(*kdf, prepared.transformedKey)) {
+            prepared.transformedKey.clear();
+        }
+        return prepared;
+    });
+}
+
+/**
+ * Take the key prepared by prepareSaveKey() and switch the KDF to its seed.
+ * Fails while the key is still being derived, or if the composite key or the
+ * KDF settings changed since, in which case the caller derives the key itself.
+ */
+bool Database::takePreparedSaveKey(const QSharedPointer<const CompositeKey>& key, QByteArray& transformedKey)
+{
+    QMutexLocker locker(&m_preparedSaveKeyMutex);
+    if (m_preparedSaveKey.resultCount() == 0 || !m_preparedSaveKey.isFinished()) {
+        return false;
+    }
+
+    const PreparedKey prepared = m_preparedSaveKey.result();
+    m_preparedSaveKey = {};
+    if (prepared.key != key || prepared.transformedKey.isEmpty()) {
+        return false;
+    }
+
+    // the KDF must only differ in its seed
+    auto kdf = m_data.kdf->clone();
+    kdf->setSeed(prepared.kdf->seed());
+    if (kdf->uuid() != prepared.kdf->uuid() || kdf->writeParameters() != prepared.kdf->writeParameters()) {
+        return false;
+    }
+
+    m_data.kdf->setSeed(prepared.kdf->seed());
+    transformedKey = prepared.transformedKey;
+    return true;
+}
+
 QString Database::keyError()
 {
     return m_keyError;
@@ -809,6 +2156,48 @@ void Database::recycleEntry(Entry* entry)
     }
 }
 
+/**
+ * Move entries to the recycle bin, or delete them if the recycle bin is
+ * disabled. Works in one bulk update, with a single compaction of the
+ * entries of every affected group.
+ */
+void Database::recycleEntries(const QList<Entry*>& entries)
+{
+    Q_ASSERT(!m_data.isReadOnly);
+    if (!m_metadata->recycleBinEnabled()) {
+        deleteEntries(entries);
+        return;
+    }
+
+    beginBulkUpdate();
+    if (!m_metadata->recycleBin()) {
+        createRecycleBin();
+    }
+    metadata()->recycleBin()->moveEntriesHere(entries);
+    endBulkUpdate();
+}
+
+/**
+ * Delete entries for good. Works in one bulk update, with a single
+ * compaction of the entries of every affected group.
+ */
+void Database::deleteEntries(const QList<Entry*>& entries)
+{
+    Q_ASSERT(!m_data.isReadOnly);
+
+    QHash<Group*, QList<Entry*>> entriesByGroup;
+    for (Entry* entry : entries) {
+        Q_ASSERT(entry->group() && entry->group()->database() == this);
+        entriesByGroup[entry->group()].append(entry);
+    }
+
+    beginBulkUpdate();
+    for (auto it = entriesByGroup.begin(); it != entriesByGroup.end(); ++it) {
+        it.key()->deleteEntries(it.value());
+    }
+    endBulkUpdate();
+}
+
 void Database::recycleGroup(Group* group)
 {
     Q_ASSERT(!m_data.isReadOnly);
@@ -826,16 +2215,15 @@ void Database::emptyRecycleBin()
 {
     Q_ASSERT(!m_data.isReadOnly);
     if (m_metadata->recycleBinEnabled() && m_metadata->recycleBin()) {
+        beginBulkUpdate();
         // destroying direct entries of the recycle bin
-        QList<Entry*> subEntries = m_metadata->recycleBin()->entries();
-        for (Entry* entry : subEntries) {
-            delete entry;
-        }
+        m_metadata->recycleBin()->deleteEntries(m_metadata->recycleBin()->entries());
         // destroying direct subgroups of the recycle bin
         QList<Group*> subGroups = m_metadata->recycleBin()->children();
         for (Group* group : subGroups) {
             delete group;
         }
+        endBulkUpdate();
     }
 }
 
@@ -848,6 +2236,44 @@ void Database::setEmitModified(bool value)
     m_emitModified = value;
 }
 
+/**
+ * Start a bulk update, e.g. an import or a merge. Until the matching
+ * endBulkUpdate() models coalesce the changes of the single entries and
+ * groups and databaseModified() is not emitted. Bulk updates may be nested.
+ */
+void Database::beginBulkUpdate()
+{
+    if (m_bulkUpdateDepth++ == 0) {
+        m_modifiedDuringBulkUpdate = false;
+        emit bulkUpdateStarted();
+    }
+}
+
+/**
+ * Finish a bulk update started by beginBulkUpdate(). The outermost call
+ * emits bulkUpdateFinished() and a single databaseModified() for all
+ * modifications of the bulk update.
+ */
+void Database::endBulkUpdate()
+{
+    Q_ASSERT(m_bulkUpdateDepth > 0);
+    if (m_bulkUpdateDepth == 0 || --m_bulkUpdateDepth > 0) {
+        return;
+    }
+
+    emit bulkUpdateFinished();
+
+    if (m_modifiedDuringBulkUpdate && m_emitModified && !m_modifiedTimer.isActive()) {
+        m_modifiedTimer.start(150);
+    }
+    m_modifiedDuringBulkUpdate = false;
+}
+
+bool Database::isBulkUpdating() const
+{
+    return m_bulkUpdateDepth > 0;
+}
+
 bool Database::isModified() const
 {
     return m_modified;
@@ -860,8 +2286,15 @@ bool Database::hasNonDataChanges() const
 
 void Database::markAsModified()
 {
+    ++m_modificationCount;
+    m_readSnapshot.reset();
     m_modified = true;
-    if (m_emitModified && !m_modifiedTimer.isActive()) {
+    if (m_backgroundSaveRunning) {
+        m_modifiedDuringSave = true;
+    }
+    if (m_bulkUpdateDepth > 0) {
+        m_modifiedDuringBulkUpdate = true;
+    } else if (m_emitModified && !m_modifiedTimer.isActive()) {
         // Small time delay prevents numerous consecutive saves due to repeated signals
         m_modifiedTimer.start(150);
     }
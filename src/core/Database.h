@@ -20,24 +20,35 @@
 #define KEEPASSX_DATABASE_H
 
 #include <QDateTime>
+#include <QFuture>
 #include <QHash>
+#include <QMultiHash>
 #include <QMutex>
 #include <QPointer>
 #include <QScopedPointer>
+#include <QSharedPointer>
+#include <QSet>
 #include <QTimer>
 
 #include "config-keepassx.h"
+#include "core/ChangeJournal.h"
+#include "core/MemoryUsage.h"
 #include "crypto/kdf/AesKdf.h"
 #include "crypto/kdf/Kdf.h"
 #include "format/KeePass2.h"
 #include "keys/CompositeKey.h"
 #include "keys/PasswordKey.h"
 
+class AttachmentStore;
+struct AttachmentValue;
 class Entry;
 enum class EntryReferenceType;
+class EntrySearchIndex;
 class FileWatcher;
 class Group;
+class KdbxXmlFragmentCache;
 class Metadata;
+class PasswordHealthCache;
 class QIODevice;
 
 struct DeletedObject
@@ -52,6 +63,26 @@ struct DeletedObject
 
 Q_DECLARE_TYPEINFO(DeletedObject, Q_MOVABLE_TYPE);
 
+/**
+ * A password database and its tree of groups and entries.
+ *
+ * Threading: the tree belongs to the thread of the database, usually the
+ * GUI thread, and only that thread may modify it. Other threads read the
+ * database in one of two ways:
+ *
+ *  - Through an immutable copy from readSnapshot(). The copy reflects the
+ *    database at one modification count and stays valid for as long as
+ *    the thread holds on to it, no matter how the database changes in the
+ *    meantime. Several threads may use the same copy through its const
+ *    API; caches filled on first access are guarded by their own mutexes,
+ *    except for the search index, which one thread at a time may use.
+ *  - Through the live tree, while the thread of the database blocks until
+ *    the work is done. Any modification, including edits of entry data,
+ *    would race with the reading threads.
+ *
+ * Saving in the background writes a snapshot from createSnapshot(), which
+ * follows the same rules.
+ */
 class Database : public QObject
 {
     Q_OBJECT
@@ -63,6 +94,8 @@ public:
         CompressionGZip = 1
     };
     static const quint32 CompressionAlgorithmMax = CompressionGZip;
+    // custom data key of the maximum age of deleted objects in days
+    static const QString DeletedObjectsMaxAgeKey;
 
     Database();
     explicit Database(const QString& filePath);
@@ -72,10 +105,17 @@ public:
     bool open(const QString& filePath,
               QSharedPointer<const CompositeKey> key,
               QString* error = nullptr,
-              bool readOnly = false);
+              bool readOnly = false,
+              bool metadataOnly = false);
+    bool openProgressively(const QString& filePath,
+                           QSharedPointer<const CompositeKey> key,
+                           QString* error = nullptr,
+                           bool readOnly = false);
     bool save(QString* error = nullptr, bool atomic = true, bool backup = false);
     bool saveAs(const QString& filePath, QString* error = nullptr, bool atomic = true, bool backup = false);
+    bool saveInBackground(QString* error = nullptr, bool atomic = true, bool backup = false);
     bool extract(QByteArray&, QString* error = nullptr);
+    bool extract(QIODevice* device, QString* error = nullptr);
     bool import(const QString& xmlExportPath, QString* error = nullptr);
 
     void releaseData();
@@ -84,8 +124,13 @@ public:
     bool isModified() const;
     bool hasNonDataChanges() const;
     void setEmitModified(bool value);
+    void beginBulkUpdate();
+    void endBulkUpdate();
+    bool isBulkUpdating() const;
     bool isReadOnly() const;
     void setReadOnly(bool readOnly);
+    bool isMetadataOnly() const;
+    bool isLoadingSkippedData() const;
     bool isSaving();
 
     QUuid uuid() const;
@@ -104,6 +149,8 @@ public:
 
     void recycleGroup(Group* group);
     void recycleEntry(Entry* entry);
+    void recycleEntries(const QList<Entry*>& entries);
+    void deleteEntries(const QList<Entry*>& entries);
     void emptyRecycleBin();
     QList<DeletedObject> deletedObjects();
     const QList<DeletedObject>& deletedObjects() const;
@@ -112,17 +159,32 @@ public:
     bool containsDeletedObject(const QUuid& uuid) const;
     bool containsDeletedObject(const DeletedObject& uuid) const;
     void setDeletedObjects(const QList<DeletedObject>& delObjs);
+    void truncateDeletedObjects(int count);
+    int pruneDeletedObjects(const QDateTime& olderThan);
+    int deletedObjectsMaxAge() const;
+    void setDeletedObjectsMaxAge(int days);
 
     QList<QString> commonUsernames();
+    void loadDeferredAttachments();
+    AttachmentStore* attachmentStore() const;
+    QList<AttachmentValue> attachmentPool() const;
+    EntrySearchIndex* searchIndex() const;
+    PasswordHealthCache* healthCache() const;
+    MemoryUsage memoryUsage() const;
+    quint64 modificationCount() const;
+    QSharedPointer<const Database> readSnapshot();
+    const ChangeJournal* changeJournal() const;
 
     QSharedPointer<const CompositeKey> key() const;
     bool setKey(const QSharedPointer<const CompositeKey>& key,
                 bool updateChangedTime = true,
                 bool updateTransformSalt = false,
                 bool transformKey = true);
+    void setTransformedKey(const QSharedPointer<const CompositeKey>& key, const QByteArray& transformedKey);
     QString keyError();
     QByteArray challengeResponseKey() const;
     bool challengeMasterSeed(const QByteArray& masterSeed);
+    void setChallengeResponse(const QByteArray& masterSeed, const QByteArray& response);
     const QUuid& cipher() const;
     void setCipher(const QUuid& cipher);
     Database::CompressionAlgorithm compressionAlgorithm() const;
@@ -150,17 +212,31 @@ signals:
     void groupRemoved();
     void groupAboutToMove(Group* group, Group* toGroup, int index);
     void groupMoved();
+    void groupModified(Group* group);
+    void entryAdded(Entry* entry);
+    void entryAboutToRemove(Entry* entry);
+    void entryDataChanged(Entry* entry);
     void databaseOpened();
     void databaseModified();
     void databaseSaved();
+    void databaseSaveFailed(const QString& error);
     void databaseDiscarded();
     void databaseFileChanged();
+    void bulkUpdateStarted();
+    void bulkUpdateFinished();
+    void dataAboutToBeReleased();
+    void dataReleased();
+    void skippedDataLoaded();
 
 private:
+    friend class Entry;
+    friend class Group;
+
     struct DatabaseData
     {
         QString filePath;
         bool isReadOnly = false;
+        bool isMetadataOnly = false;
         QUuid cipher = KeePass2::CIPHER_AES256;
         CompressionAlgorithm compressionAlgorithm = CompressionGZip;
 
@@ -184,6 +260,7 @@ private:
         void clear()
         {
             filePath.clear();
+            isMetadataOnly = false;
 
             masterSeed.reset();
             transformedDatabaseKey.reset();
@@ -198,24 +275,101 @@ private:
 
     void createRecycleBin();
 
+    void addToUuidIndex(Entry* entry);
+    void removeFromUuidIndex(Entry* entry, const QUuid& uuid);
+    void addToUuidIndex(Group* group);
+    void removeFromUuidIndex(Group* group, const QUuid& uuid);
+    void updateReferenceIndex(Entry* entry);
+    void removeFromReferenceIndex(const Entry* entry);
+    void updateUsernameIndex(const Entry* entry);
+    void removeFromUsernameIndex(const Entry* entry);
+    Entry* entryByPath(const QString& path) const;
+    Group* groupByPath(const QString& path) const;
+    void invalidatePathIndex();
+    void updatePathIndex() const;
+    void indexPaths(Group* group, const QString& basePath) const;
+
+    // Transformed key for a fresh KDF seed, derived ahead of the next save
+    struct PreparedKey
+    {
+        QSharedPointer<const CompositeKey> key;
+        QSharedPointer<Kdf> kdf;
+        QByteArray transformedKey;
+    };
+
+    void prepareSaveKey();
+    bool takePreparedSaveKey(const QSharedPointer<const CompositeKey>& key, QByteArray& transformedKey);
+
+    bool canSaveTo(const QString& filePath, QString* error);
+    QSharedPointer<Database> createSnapshot() const;
+    QSharedPointer<Database> cloneForSnapshot() const;
     bool writeDatabase(QIODevice* device, QString* error = nullptr);
-    bool backupDatabase(const QString& filePath);
+    bool backupDatabase(const QString& filePath, bool replacedByRename);
     bool restoreDatabase(const QString& filePath);
-    bool performSave(const QString& filePath, QString* error, bool atomic, bool backup);
+    void loadSkippedData();
+    void fillInSkippedData(Database* fullDatabase);
+    bool performSave(const QString& filePath,
+                     QString* error,
+                     bool atomic,
+                     bool backup,
+                     QByteArray* fileChecksum = nullptr);
+    void pruneExpiredDeletedObjects();
 
     QPointer<Metadata> const m_metadata;
     DatabaseData m_data;
     QPointer<Group> m_rootGroup;
     QList<DeletedObject> m_deletedObjects;
+    // number of m_deletedObjects per uuid, rebuilt on demand after the list was replaced
+    mutable QHash<QUuid, int> m_deletedObjectUuids;
+    mutable bool m_deletedObjectUuidsValid = false;
     QTimer m_modifiedTimer;
     QMutex m_saveMutex;
+    QFuture<PreparedKey> m_preparedSaveKey;
+    QMutex m_preparedSaveKeyMutex;
+    // handed out by readSnapshot() until the database is modified
+    QSharedPointer<const Database> m_readSnapshot;
+    ChangeJournal m_changeJournal;
     QPointer<FileWatcher> m_fileWatcher;
+    QScopedPointer<KdbxXmlFragmentCache> m_xmlFragmentCache;
+    mutable QScopedPointer<EntrySearchIndex> m_searchIndex;
+    mutable QScopedPointer<PasswordHealthCache> m_healthCache;
+    // shared with the snapshots of background saves
+    QSharedPointer<AttachmentStore> m_attachmentStore;
+    // all entries and groups whose group belongs to this database,
+    // maintained by Group and Entry
+    QMultiHash<QUuid, Entry*> m_entriesByUuid;
+    QMultiHash<QUuid, Group*> m_groupsByUuid;
+    // entries with references by the hex UUIDs their references contain
+    QMultiHash<QString, Entry*> m_referencingEntries;
+    QHash<const Entry*, QStringList> m_referencedUuids;
+    // usage count of every username and the username counted for each entry
+    QHash<QString, int> m_usernameCounts;
+    QHash<const Entry*, QString> m_countedUsernames;
+    // first entry and group in tree order for every path from the root group
+    // and first entry for every title, rebuilt on the next lookup after a change
+    mutable QHash<QString, Entry*> m_entriesByPath;
+    mutable QHash<QString, Entry*> m_entriesByTitle;
+    mutable QHash<QString, Group*> m_groupsByPath;
+    mutable bool m_pathIndexValid = false;
+    mutable quint64 m_pathIndexGeneration = 0;
+    mutable QMutex m_pathIndexMutex;
     bool m_modified = false;
     bool m_emitModified;
+    int m_bulkUpdateDepth = 0;
+    bool m_modifiedDuringBulkUpdate = false;
     bool m_hasNonDataChange = false;
+    bool m_backgroundSaveRunning = false;
+    bool m_modifiedDuringSave = false;
+    quint64 m_dataGeneration = 0;
+    // id of the running loadSkippedData(), 0 if none is running
+    quint64 m_skippedDataLoad = 0;
+    quint64 m_skippedDataLoads = 0;
+    quint64 m_modificationCount = 0;
     QString m_keyError;
 
     QList<QString> m_commonUsernames;
+    int m_commonUsernamesTopN = 10;
+    bool m_commonUsernamesValid = true;
 
     QUuid m_uuid;
     static QHash<QUuid, QPointer<Database>> s_uuidMap;
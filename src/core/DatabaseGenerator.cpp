@@ -0,0 +1,196 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseGenerator.h"
+
+#include "core/Database.h"
+#include "core/Global.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+
+#include <QImage>
+
+#include <random>
+
+namespace
+{
+    constexpr int SiteCount = 1000;
+    constexpr int CustomIconSize = 16;
+
+    QByteArray randomBytes(std::mt19937& rng, int size)
+    {
+        QByteArray bytes(size, Qt::Uninitialized);
+        for (int i = 0; i < size; ++i) {
+            bytes[i] = static_cast<char>(rng() & 0xFF);
+        }
+        return bytes;
+    }
+
+    QUuid randomUuid(std::mt19937& rng)
+    {
+        QByteArray bytes = randomBytes(rng, 16);
+        // Mark the bytes as a version 4 (random) RFC 4122 UUID
+        bytes[6] = static_cast<char>((bytes[6] & 0x0F) | 0x40);
+        bytes[8] = static_cast<char>((bytes[8] & 0x3F) | 0x80);
+        return QUuid::fromRfc4122(bytes);
+    }
+
+    QString randomPassword(std::mt19937& rng)
+    {
+        static const QString chars("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789!#$%&*+-=?@_");
+        QString password;
+        for (int i = 0; i < 20; ++i) {
+            password.append(chars.at(static_cast<int>(rng() % chars.size())));
+        }
+        return password;
+    }
+
+    int randomIndex(std::mt19937& rng, int count)
+    {
+        return static_cast<int>(rng() % static_cast<quint32>(count));
+    }
+
+    // Fixed timestamps keep the generated files identical between runs
+    TimeInfo timeInfoAt(const QDateTime& dateTime)
+    {
+        TimeInfo timeInfo;
+        timeInfo.setCreationTime(dateTime);
+        timeInfo.setLastModificationTime(dateTime);
+        timeInfo.setLastAccessTime(dateTime);
+        timeInfo.setLocationChanged(dateTime);
+        timeInfo.setExpiryTime(dateTime);
+        return timeInfo;
+    }
+} // namespace
+
+DatabaseGenerator::DatabaseGenerator(const Settings& settings)
+    : m_settings(settings)
+{
+}
+
+/**
+ * Add the generated groups and entries to the root group of the database.
+ *
+ * Entries are spread over the groups, which nest below randomly chosen
+ * earlier groups. Attachments, custom icons and references are distributed
+ * over the entries after they have been created, and the history items are
+ * added last so they carry the complete entry data.
+ */
+void DatabaseGenerator::populate(Database* db) const
+{
+    std::mt19937 rng(m_settings.seed);
+    const QDateTime baseTime(QDate(2020, 1, 1), QTime(0, 0), Qt::UTC);
+
+    Metadata* metadata = db->metadata();
+    if (m_settings.historyDepth > metadata->historyMaxItems()) {
+        metadata->setHistoryMaxItems(m_settings.historyDepth);
+        metadata->setHistoryMaxSize(-1);
+    }
+
+    QList<QUuid> icons;
+    for (int i = 0; i < m_settings.customIcons; ++i) {
+        QImage image(CustomIconSize, CustomIconSize, QImage::Format_ARGB32);
+        image.fill(QColor::fromRgb(rng() | 0xFF000000));
+        for (int p = 0; p < CustomIconSize; ++p) {
+            const int x = randomIndex(rng, CustomIconSize);
+            const int y = randomIndex(rng, CustomIconSize);
+            image.setPixel(x, y, rng() | 0xFF000000);
+        }
+        const QUuid uuid = randomUuid(rng);
+        metadata->addCustomIcon(uuid, image);
+        icons.append(uuid);
+    }
+
+    Group* root = db->rootGroup();
+    root->setUuid(randomUuid(rng));
+    root->setTimeInfo(timeInfoAt(baseTime));
+
+    QList<Group*> groups;
+    for (int i = 0; i < m_settings.groups; ++i) {
+        auto group = new Group();
+        group->setUpdateTimeinfo(false);
+        group->setUuid(randomUuid(rng));
+        group->setName(QString("Group %1").arg(i));
+        group->setTimeInfo(timeInfoAt(baseTime));
+        const bool topLevel = groups.isEmpty() || randomIndex(rng, 4) == 0;
+        group->setParent(topLevel ? root : groups.at(randomIndex(rng, groups.size())));
+        groups.append(group);
+    }
+
+    QList<Entry*> entries;
+    entries.reserve(m_settings.entries);
+    for (int i = 0; i < m_settings.entries; ++i) {
+        const int site = i % SiteCount;
+        auto entry = new Entry();
+        entry->setUpdateTimeinfo(false);
+        entry->setUuid(randomUuid(rng));
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setUsername(QString("user%1@example%2.com").arg(i).arg(site));
+        if (randomIndex(rng, 100) < m_settings.passwordReuse) {
+            entry->setPassword(QStringLiteral("reused-password"));
+        } else {
+            entry->setPassword(randomPassword(rng));
+        }
+        entry->setUrl(QString("https://site%1.example.com/login").arg(site));
+        entry->setNotes(QString("Notes of entry %1\nsecond line with more text").arg(i));
+        for (int a = 0; a < m_settings.customAttributes; ++a) {
+            // Every third attribute is protected, like stored secrets next to plain fields
+            entry->attributes()->set(QString("Attribute %1").arg(a), QString("value %1-%2").arg(i).arg(a), a % 3 == 2);
+        }
+        if (!icons.isEmpty()) {
+            entry->setIcon(icons.at(i % icons.size()));
+        }
+        entry->setTimeInfo(timeInfoAt(baseTime.addSecs(i)));
+        entry->setGroup(groups.isEmpty() ? root : groups.at(randomIndex(rng, groups.size())));
+        entries.append(entry);
+    }
+
+    if (entries.isEmpty()) {
+        return;
+    }
+
+    QList<QByteArray> attachmentPool;
+    for (int i = 0; i < m_settings.attachments; ++i) {
+        QByteArray content;
+        if (!attachmentPool.isEmpty() && randomIndex(rng, 100) < m_settings.attachmentDuplication) {
+            content = attachmentPool.at(randomIndex(rng, attachmentPool.size()));
+        } else {
+            content = randomBytes(rng, m_settings.attachmentSize);
+            attachmentPool.append(content);
+        }
+        entries.at(randomIndex(rng, entries.size()))->attachments()->set(QString("attachment-%1.bin").arg(i), content);
+    }
+
+    // Each reference points at an entry that is not itself a reference
+    const int references = qMin(m_settings.references, entries.size() / 2);
+    for (int i = 0; i < references; ++i) {
+        Entry* entry = entries.at(entries.size() - 1 - i);
+        const QUuid target = entries.at(randomIndex(rng, entries.size() - references))->uuid();
+        entry->setUsername(Entry::buildReference(target, EntryAttributes::UserNameKey));
+        entry->setPassword(Entry::buildReference(target, EntryAttributes::PasswordKey));
+    }
+
+    for (int i = 0; i < m_settings.historyDepth; ++i) {
+        for (Entry* entry : asConst(entries)) {
+            Entry* historyItem = entry->clone(Entry::CloneNoFlags);
+            historyItem->setPassword(randomPassword(rng));
+            historyItem->setTimeInfo(timeInfoAt(baseTime.addDays(i - m_settings.historyDepth)));
+            entry->addHistoryItem(historyItem);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DATABASEGENERATOR_H
+#define KEEPASSXC_DATABASEGENERATOR_H
+
+#include <QtGlobal>
+
+class Database;
+
+/**
+ * Fills a database with synthetic content for scale testing and benchmarks.
+ *
+ * The content only depends on the settings, including the seed, so the same
+ * settings always produce the same groups, entries, UUIDs and timestamps.
+ */
+class DatabaseGenerator
+{
+public:
+    struct Settings
+    {
+        quint32 seed = 1;
+        int groups = 10;
+        int entries = 1000;
+        // Number of history items of every entry
+        int historyDepth = 0;
+        // Number of attachments over all entries, and the size of each one in bytes
+        int attachments = 0;
+        int attachmentSize = 4096;
+        // Percentage of attachments that repeat the content of an earlier one
+        int attachmentDuplication = 0;
+        int customIcons = 0;
+        // Number of entries whose username and password reference another entry
+        int references = 0;
+        // Number of custom attributes of every entry
+        int customAttributes = 0;
+        // Percentage of entries that share one password
+        int passwordReuse = 0;
+    };
+
+    explicit DatabaseGenerator(const Settings& settings);
+
+    void populate(Database* db) const;
+
+private:
+    Settings m_settings;
+};
+
+#endif // KEEPASSXC_DATABASEGENERATOR_H
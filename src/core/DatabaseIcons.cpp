@@ -19,9 +19,11 @@
 
 #include "core/Config.h"
 #include "core/Global.h"
+#include "core/MemoryUsage.h"
 #include "core/Resources.h"
 #include "gui/MainWindow.h"
 
+#include <QApplication>
 #include <QDir>
 #include <QImageReader>
 #include <QPainter>
@@ -45,6 +47,12 @@ DatabaseIcons::DatabaseIcons()
 
     // Set this early and once to ensure consistent icon size until app restart
     m_compactMode = config()->get(Config::GUI_CompactMode).toBool();
+
+    // The icons are rendered again on demand, so drop them with the other caches
+    MemoryUsage::registerCache([this] {
+        m_iconCache.clear();
+        QPixmapCache::clear();
+    });
 }
 
 DatabaseIcons* DatabaseIcons::instance()
@@ -63,6 +71,15 @@ QPixmap DatabaseIcons::icon(int index, IconSize size)
         return {};
     }
 
+    // Hand out the same rasterized pixmap for every view, this also lets applyBadge() find its cached result
+    const int pixelSize = iconSize(size);
+    const qreal pixelRatio = qApp->devicePixelRatio();
+    const auto pixmapKey = QStringLiteral("databaseicon-%1-%2-%3").arg(index).arg(pixelSize).arg(pixelRatio);
+    QPixmap pixmap;
+    if (QPixmapCache::find(pixmapKey, &pixmap)) {
+        return pixmap;
+    }
+
     auto cacheKey = QString::number(index);
     auto icon = m_iconCache.value(cacheKey);
     if (icon.isNull()) {
@@ -71,7 +88,9 @@ QPixmap DatabaseIcons::icon(int index, IconSize size)
         m_iconCache.insert(cacheKey, icon);
     }
 
-    return icon.pixmap(iconSize(size));
+    pixmap = icon.pixmap(pixelSize);
+    QPixmapCache::insert(pixmapKey, pixmap);
+    return pixmap;
 }
 
 QPixmap DatabaseIcons::applyBadge(const QPixmap& basePixmap, Badges badgeIndex)
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DuplicateDetector.h"
+
+#include "core/Database.h"
+#include "core/Group.h"
+
+#include <QCryptographicHash>
+#include <QHash>
+#include <QUrl>
+
+#include <algorithm>
+
+namespace
+{
+    QString normalized(const QString& value)
+    {
+        return value.simplified().toCaseFolded();
+    }
+
+    // Host of the URL, so that e.g. different login pages of a site are equal
+    QString urlHost(const Entry* entry)
+    {
+        QString host = QUrl(entry->webUrl()).host().toCaseFolded();
+        if (host.isEmpty()) {
+            // not a web URL, compare all of it
+            return normalized(entry->url());
+        }
+        if (host.startsWith("www.")) {
+            host.remove(0, 4);
+        }
+        return host;
+    }
+
+    QList<Entry*> removedEntries(const QList<QList<Entry*>>& duplicates)
+    {
+        QList<Entry*> removed;
+        for (const auto& group : duplicates) {
+            const Entry* kept = DuplicateDetector::keptEntry(group);
+            for (Entry* entry : group) {
+                if (entry != kept) {
+                    removed.append(entry);
+                }
+            }
+        }
+        return removed;
+    }
+
+    void mergeInto(Entry* kept, const QList<Entry*>& duplicates)
+    {
+        kept->beginUpdate();
+        QStringList tags = kept->tagList();
+        QString notes = kept->notes();
+        for (const Entry* entry : duplicates) {
+            if (entry == kept) {
+                continue;
+            }
+
+            const EntryAttributes* attributes = entry->attributes();
+            for (const QString& key : attributes->customKeys()) {
+                if (!kept->attributes()->hasKey(key)) {
+                    kept->attributes()->set(key, attributes->value(key), attributes->isProtected(key));
+                }
+            }
+            const EntryAttachments* attachments = entry->attachments();
+            for (const QString& name : attachments->keys()) {
+                if (!kept->attachments()->hasKey(name)) {
+                    kept->attachments()->set(name, attachments->value(name));
+                }
+            }
+            for (const QString& tag : entry->tagList()) {
+                if (!tags.contains(tag)) {
+                    tags.append(tag);
+                }
+            }
+            if (!entry->notes().isEmpty() && !notes.contains(entry->notes())) {
+                notes = notes.isEmpty() ? entry->notes() : notes + "\n\n" + entry->notes();
+            }
+        }
+        kept->setTags(tags.join(";"));
+        kept->setNotes(notes);
+        kept->endUpdate();
+    }
+} // namespace
+
+namespace DuplicateDetector
+{
+    /**
+     * @return hash of the normalized fields that are equal for duplicates
+     */
+    QByteArray fingerprint(const Entry* entry)
+    {
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        for (const QString& field : {normalized(entry->title()), normalized(entry->username()), urlHost(entry)}) {
+            hash.addData(field.toUtf8());
+            hash.addData("\0", 1);
+        }
+        // passwords are compared as they are
+        hash.addData(entry->password().toUtf8());
+        return hash.result();
+    }
+
+    QList<QList<Entry*>> findDuplicates(const Group* root)
+    {
+        QHash<QByteArray, int> buckets;
+        QList<QList<Entry*>> groups;
+        for (Entry* entry : root->entriesRecursive()) {
+            if (entry->isRecycled()) {
+                continue;
+            }
+
+            const QByteArray key = fingerprint(entry);
+            const auto bucket = buckets.constFind(key);
+            if (bucket == buckets.constEnd()) {
+                buckets.insert(key, groups.size());
+                groups.append({entry});
+            } else {
+                groups[bucket.value()].append(entry);
+            }
+        }
+
+        groups.erase(std::remove_if(groups.begin(),
+                                    groups.end(),
+                                    [](const QList<Entry*>& group) { return group.size() < 2; }),
+                     groups.end());
+        return groups;
+    }
+
+    Entry* keptEntry(const QList<Entry*>& duplicates)
+    {
+        Q_ASSERT(!duplicates.isEmpty());
+        return *std::max_element(duplicates.begin(), duplicates.end(), [](const Entry* lhs, const Entry* rhs) {
+            return lhs->timeInfo().lastModificationTime() < rhs->timeInfo().lastModificationTime();
+        });
+    }
+
+    int mergeDuplicates(Database* db, const QList<QList<Entry*>>& duplicates)
+    {
+        db->beginBulkUpdate();
+        for (const auto& group : duplicates) {
+            mergeInto(keptEntry(group), group);
+        }
+        const int removed = removeDuplicates(db, duplicates);
+        db->endBulkUpdate();
+        return removed;
+    }
+
+    int removeDuplicates(Database* db, const QList<QList<Entry*>>& duplicates)
+    {
+        const QList<Entry*> removed = removedEntries(duplicates);
+        if (!removed.isEmpty()) {
+            db->recycleEntries(removed);
+        }
+        return removed.size();
+    }
+} // namespace DuplicateDetector
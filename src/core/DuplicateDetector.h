@@ -0,0 +1,70 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DUPLICATEDETECTOR_H
+#define KEEPASSXC_DUPLICATEDETECTOR_H
+
+#include <QByteArray>
+#include <QList>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Find entries that are copies of each other, e.g. after importing the same
+ * data twice. Entries are duplicates when their title, username, URL host
+ * and password are equal, ignoring case and surrounding whitespace. Every
+ * entry is fingerprinted once and grouped in a hash table, so this takes
+ * linear time instead of comparing all pairs of entries.
+ */
+namespace DuplicateDetector
+{
+    QByteArray fingerprint(const Entry* entry);
+
+    /**
+     * @param root group to search, recursively
+     * @return groups of duplicate entries in tree order, entries in the recycle bin are skipped
+     */
+    QList<QList<Entry*>> findDuplicates(const Group* root);
+
+    /**
+     * @return entry of the duplicates that is kept by mergeDuplicates() and
+     *         removeDuplicates(), the most recently modified one
+     */
+    Entry* keptEntry(const QList<Entry*>& duplicates);
+
+    /**
+     * Merge every group of duplicates into its kept entry, which takes the
+     * missing custom attributes, attachments, tags and notes of the others,
+     * and move the others to the recycle bin. All groups are merged in one
+     * bulk update of the database.
+     *
+     * @return number of entries that were removed
+     */
+    int mergeDuplicates(Database* db, const QList<QList<Entry*>>& duplicates);
+
+    /**
+     * Move all entries except the kept one of every group of duplicates to
+     * the recycle bin in one bulk update of the database.
+     *
+     * @return number of entries that were removed
+     */
+    int removeDuplicates(Database* db, const QList<QList<Entry*>>& duplicates);
+} // namespace DuplicateDetector
+
+#endif // KEEPASSXC_DUPLICATEDETECTOR_H
@@ -19,18 +19,83 @@
 
 #include "config-keepassx.h"
 
+#include "core/AttachmentStore.h"
 #include "core/Clock.h"
 #include "core/Database.h"
 #include "core/DatabaseIcons.h"
 #include "core/Group.h"
+#include "core/MemoryUsage.h"
 #include "core/Metadata.h"
+#include "core/ProtectedValueSource.h"
+#include "core/SecureArena.h"
 #include "core/Tools.h"
 #include "totp/totp.h"
 
 #include <QDir>
 #include <QRegularExpression>
+#include <algorithm>
+#include <atomic>
 #include <utility>
 
+namespace
+{
+    // Shared by all entries so a revision is never reused, not even by an
+    // entry that is allocated at the address of a deleted one
+    std::atomic<quint64> nextRevision(1);
+
+    struct ResolveContext
+    {
+        bool cacheable = true;
+        bool usesReferences = false;
+    };
+
+    // Collects what the placeholder resolution of the current thread depends on
+    thread_local ResolveContext* resolveContext = nullptr;
+
+    // Bounds the cache of entries that resolve many distinct strings, e.g. Auto-Type sequences
+    const int MaxResolvedCacheSize = 16;
+
+    /**
+     * Split a tags string into its tags. Every tag is interned in a pool
+     * shared by all entries, so a tag used by many entries is stored once.
+     */
+    QStringList splitTags(const QString& tags)
+    {
+        static const QRegularExpression delimiter(",|:|;");
+        static QMutex poolMutex;
+        static QSet<QString> pool;
+
+        QStringList tagList;
+        QMutexLocker locker(&poolMutex);
+        for (const QString& tag : tags.split(delimiter, QString::SkipEmptyParts)) {
+            const QString trimmed = tag.trimmed();
+            if (trimmed.isEmpty()) {
+                continue;
+            }
+            auto it = pool.constFind(trimmed);
+            if (it == pool.constEnd()) {
+                it = pool.insert(trimmed);
+            }
+            tagList.append(*it);
+        }
+        return tagList;
+    }
+
+    void markResolvedVolatile()
+    {
+        if (resolveContext) {
+            resolveContext->cacheable = false;
+        }
+    }
+
+    void markResolvedReference()
+    {
+        if (resolveContext) {
+            resolveContext->usesReferences = true;
+        }
+    }
+} // namespace
+
 const int Entry::DefaultIconNumber = 0;
 const int Entry::ResolveMaximumDepth = 10;
 const QString Entry::AutoTypeSequenceUsername = "{USERNAME}{ENTER}";
@@ -45,11 +110,27 @@ Entry::Entry()
     , m_customData(new CustomData(this))
     , m_modifiedSinceBegin(false)
     , m_updateTimeinfo(true)
+    , m_revision(nextRevision++)
+    , m_size(0)
+    , m_sizeRevision(0)
 {
     m_data.iconNumber = DefaultIconNumber;
     m_data.autoTypeEnabled = true;
     m_data.autoTypeObfuscation = 0;
 
+    // connected first, so the fields are known when handleModified() runs
+    connect(m_attributes, &EntryAttributes::entryAttributesModified, this, [this] {
+        m_changedFields |= ChangeJournal::Attributes;
+    });
+    connect(m_attachments, &EntryAttachments::entryAttachmentsModified, this, [this] {
+        m_changedFields |= ChangeJournal::Attachments;
+    });
+    connect(m_autoTypeAssociations, &AutoTypeAssociations::modified, this, [this] {
+        m_changedFields |= ChangeJournal::AutoTypeAssociations;
+    });
+    connect(m_customData, &CustomData::customDataModified, this, [this] {
+        m_changedFields |= ChangeJournal::CustomData;
+    });
     connect(m_attributes, SIGNAL(entryAttributesModified()), SLOT(updateTotp()));
     connect(m_attributes, SIGNAL(entryAttributesModified()), this, SIGNAL(entryModified()));
     connect(m_attributes, SIGNAL(defaultKeyModified()), SLOT(emitDataChanged()));
@@ -57,8 +138,7 @@ Entry::Entry()
     connect(m_autoTypeAssociations, SIGNAL(modified()), SIGNAL(entryModified()));
     connect(m_customData, SIGNAL(customDataModified()), this, SIGNAL(entryModified()));
 
-    connect(this, SIGNAL(entryModified()), SLOT(updateTimeinfo()));
-    connect(this, SIGNAL(entryModified()), SLOT(updateModifiedSinceBegin()));
+    connect(this, SIGNAL(entryModified()), SLOT(handleModified()));
 }
 
 Entry::~Entry()
@@ -226,6 +306,14 @@ QString Entry::tags() const
     return m_data.tags;
 }
 
+/**
+ * @return tags of the entry without surrounding whitespace
+ */
+const QStringList& Entry::tagList() const
+{
+    return m_data.tagList;
+}
+
 const TimeInfo& Entry::timeInfo() const
 {
     return m_data.timeInfo;
@@ -336,24 +424,55 @@ QString Entry::attribute(const QString& key) const
 
 int Entry::size() const
 {
+    // every modification changes the revision, history items never change
+    if (m_sizeRevision == m_revision) {
+        return m_size;
+    }
+
     int size = 0;
-    const QRegularExpression delimiter(",|:|;");
 
     size += this->attributes()->attributesSize();
     size += this->autoTypeAssociations()->associationsSize();
     size += this->attachments()->attachmentsSize();
     size += this->customData()->dataSize();
-    const QStringList tags = this->tags().split(delimiter, QString::SkipEmptyParts);
-    for (const QString& tag : tags) {
+    for (const QString& tag : m_data.tagList) {
         size += tag.toUtf8().size();
     }
 
+    m_size = size;
+    m_sizeRevision = m_revision;
     return size;
 }
 
+/**
+ * Add the estimated memory of the entry and its history items to the usage.
+ */
+void Entry::addMemoryUsage(MemoryUsage& usage) const
+{
+    auto textSize = [](const Entry* entry) {
+        return MemoryUsage::textSize(entry->attributes()->attributesSize()
+                                     + entry->autoTypeAssociations()->associationsSize()
+                                     + entry->tags().toUtf8().size());
+    };
+
+    usage.entries += sizeof(Entry) + textSize(this);
+    usage.customData += MemoryUsage::textSize(m_customData->dataSize());
+    m_attachments->addMemoryUsage(usage);
+
+    for (const Entry* historyItem : m_history) {
+        usage.historyItems += sizeof(Entry) + textSize(historyItem);
+        usage.customData += MemoryUsage::textSize(historyItem->customData()->dataSize());
+        historyItem->attachments()->addMemoryUsage(usage);
+    }
+    for (const HistoryItem& historyItem : m_compactHistory) {
+        historyItem.addMemoryUsage(usage);
+    }
+}
+
 bool Entry::isExpired() const
 {
-    return m_data.timeInfo.expires() && m_data.timeInfo.expiryTime() < Clock::currentDateTimeUtc();
+    return m_data.timeInfo.expires()
+           && m_data.timeInfo.expiryMSecs() < Clock::currentDateTimeUtc().toMSecsSinceEpoch();
 }
 
 bool Entry::isRecycled() const
@@ -513,7 +632,11 @@ QString Entry::path() const
 void Entry::setUuid(const QUuid& uuid)
 {
     Q_ASSERT(!uuid.isNull());
-    set(m_uuid, uuid);
+    const QUuid oldUuid = m_uuid;
+    if (set(m_uuid, uuid) && m_group && m_group->database()) {
+        m_group->database()->removeFromUuidIndex(this, oldUuid);
+        m_group->database()->addToUuidIndex(this);
+    }
 }
 
 void Entry::setIcon(int iconNumber)
@@ -559,6 +682,10 @@ void Entry::setOverrideUrl(const QString& url)
 
 void Entry::setTags(const QString& tags)
 {
+    if (m_data.tags == tags) {
+        return;
+    }
+    m_data.tagList = splitTags(tags);
     set(m_data.tags, tags);
 }
 
@@ -642,22 +769,182 @@ void Entry::setExpiryTime(const QDateTime& dateTime)
 
 QList<Entry*> Entry::historyItems()
 {
+    expandHistory();
     return m_history;
 }
 
 const QList<Entry*>& Entry::historyItems() const
 {
+    expandHistory();
     return m_history;
 }
 
+int Entry::historyItemCount() const
+{
+    return m_history.size() + m_compactHistory.size();
+}
+
+QList<TimeInfo> Entry::historyTimeInfos() const
+{
+    QList<TimeInfo> timeInfos;
+    timeInfos.reserve(historyItemCount());
+    for (const Entry* historyItem : asConst(m_history)) {
+        timeInfos.append(historyItem->timeInfo());
+    }
+    for (const HistoryItem& historyItem : asConst(m_compactHistory)) {
+        timeInfos.append(historyItem.timeInfo());
+    }
+    return timeInfos;
+}
+
+/**
+ * @return snapshots of the history items from oldest to newest. They share
+ *         the data of the items, compact history items are not expanded.
+ */
+QList<HistoryItem> Entry::historySnapshots() const
+{
+    if (m_history.isEmpty()) {
+        return m_compactHistory;
+    }
+
+    QList<HistoryItem> snapshots;
+    snapshots.reserve(m_history.size());
+    for (const Entry* historyItem : asConst(m_history)) {
+        snapshots.append(HistoryItem(historyItem));
+    }
+    return snapshots;
+}
+
+bool Entry::hasHistoryCustomData() const
+{
+    for (const Entry* historyItem : asConst(m_history)) {
+        if (!historyItem->customData()->isEmpty()) {
+            return true;
+        }
+    }
+    for (const HistoryItem& historyItem : asConst(m_compactHistory)) {
+        if (historyItem.hasCustomData()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Attachments of all history items, oldest item first. Compact items are
+ * not expanded and deferred attachments are not read for this.
+ */
+QList<AttachmentValue> Entry::historyAttachmentValues() const
+{
+    QList<AttachmentValue> values;
+    for (const Entry* historyItem : asConst(m_history)) {
+        const EntryAttachments* attachments = historyItem->attachments();
+        const QList<QString> keys = attachments->keys();
+        for (const QString& key : keys) {
+            values.append(attachments->valueRef(key));
+        }
+    }
+    for (const HistoryItem& historyItem : asConst(m_compactHistory)) {
+        values.append(historyItem.attachmentValues());
+    }
+    return values;
+}
+
+/**
+ * Whether the history is kept as HistoryItem snapshots instead of entries.
+ */
+bool Entry::hasCompactHistory() const
+{
+    return !m_compactHistory.isEmpty();
+}
+
+/**
+ * Replace the history entries by compact snapshots. Pointers previously
+ * returned by historyItems() become invalid.
+ */
+void Entry::compactHistory()
+{
+    for (Entry* historyItem : asConst(m_history)) {
+        m_compactHistory.append(HistoryItem(historyItem));
+    }
+    qDeleteAll(m_history);
+    m_history.clear();
+}
+
+/**
+ * Create the entries of a compact history, they are kept from then on.
+ */
+void Entry::expandHistory() const
+{
+    if (m_compactHistory.isEmpty()) {
+        return;
+    }
+
+    Q_ASSERT(m_history.isEmpty());
+    m_history.reserve(m_compactHistory.size());
+    for (const HistoryItem& historyItem : asConst(m_compactHistory)) {
+        m_history.append(historyItem.createEntry());
+    }
+    m_compactHistory.clear();
+}
+
+void Entry::loadDeferredAttachments(EntryAttachments::LoadedValues* loaded)
+{
+    // history items mostly refer to the same binaries as the entry
+    EntryAttachments::LoadedValues entryLoaded;
+    if (!loaded) {
+        loaded = &entryLoaded;
+    }
+
+    m_attachments->loadDeferred(loaded);
+    for (Entry* historyItem : asConst(m_history)) {
+        historyItem->attachments()->loadDeferred(loaded);
+    }
+    for (HistoryItem& historyItem : m_compactHistory) {
+        historyItem.loadDeferredAttachments(loaded);
+    }
+}
+
 void Entry::addHistoryItem(Entry* entry)
 {
     Q_ASSERT(!entry->parent());
 
+    expandHistory();
+
+    // Consecutive versions mostly differ in a single field, keep one copy of the rest
+    const Entry* previous = m_history.isEmpty() ? this : m_history.last();
+    entry->m_attributes->shareValuesWith(previous->m_attributes);
+    entry->m_attachments->shareValuesWith(previous->m_attachments);
+    if (previous != this) {
+        entry->m_attributes->shareValuesWith(m_attributes);
+        entry->m_attachments->shareValuesWith(m_attachments);
+    }
+
     m_history.append(entry);
     emit entryModified();
 }
 
+/**
+ * Move the history of another entry in front of the own history items,
+ * e.g. to fill in history that was skipped while reading the entry.
+ *
+ * @param other entry whose history is taken
+ */
+void Entry::takeHistoryFrom(Entry* other)
+{
+    if (!other->hasCompactHistory() && other->m_history.isEmpty()) {
+        return;
+    }
+
+    expandHistory();
+    other->expandHistory();
+    QList<Entry*> history = other->m_history;
+    other->m_history.clear();
+    history.append(m_history);
+    m_history = history;
+    emit entryModified();
+}
+
 void Entry::removeHistoryItems(const QList<Entry*>& historyEntries)
 {
     if (historyEntries.isEmpty()) {
@@ -676,6 +963,33 @@ void Entry::removeHistoryItems(const QList<Entry*>& historyEntries)
     emit entryModified();
 }
 
+/**
+ * Remove history items by their position in historySnapshots(), without
+ * creating entries for compact history items.
+ */
+void Entry::removeHistoryItemsAt(const QList<int>& indexes)
+{
+    if (indexes.isEmpty()) {
+        return;
+    }
+
+    QList<int> sorted = indexes;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    for (int i = sorted.size() - 1; i >= 0; --i) {
+        const int index = sorted.at(i);
+        if (hasCompactHistory()) {
+            if (index >= 0 && index < m_compactHistory.size()) {
+                m_compactHistory.removeAt(index);
+            }
+        } else if (index >= 0 && index < m_history.size()) {
+            delete m_history.takeAt(index);
+        }
+    }
+
+    emit entryModified();
+}
+
 void Entry::truncateHistory()
 {
     const Database* db = database();
@@ -686,6 +1000,33 @@ void Entry::truncateHistory()
 
     bool changed = false;
     int histMaxItems = db->metadata()->historyMaxItems();
+    if (hasCompactHistory()) {
+        // Snapshots know their size, there is no need to create the entries
+        if (histMaxItems > -1 && m_compactHistory.size() > histMaxItems) {
+            m_compactHistory.erase(m_compactHistory.begin(), m_compactHistory.end() - histMaxItems);
+            changed = true;
+        }
+
+        int histMaxSize = db->metadata()->historyMaxSize();
+        if (histMaxSize > -1) {
+            int size = 0;
+            int keep = m_compactHistory.size();
+            while (keep > 0 && size + m_compactHistory.at(keep - 1).size() <= histMaxSize) {
+                size += m_compactHistory.at(keep - 1).size();
+                --keep;
+            }
+            if (keep > 0) {
+                m_compactHistory.erase(m_compactHistory.begin(), m_compactHistory.begin() + keep);
+                changed = true;
+            }
+        }
+
+        if (changed) {
+            emit entryModified();
+        }
+        return;
+    }
+
     if (histMaxItems > -1) {
         int historyCount = 0;
         QMutableListIterator<Entry*> i(m_history);
@@ -704,7 +1045,6 @@ void Entry::truncateHistory()
     int histMaxSize = db->metadata()->historyMaxSize();
     if (histMaxSize > -1) {
         int size = 0;
-        QSet<QByteArray> foundAttachments = attachments()->values();
 
         QMutableListIterator<Entry*> i(m_history);
         i.toBack();
@@ -714,7 +1054,6 @@ void Entry::truncateHistory()
             // don't calculate size if it's already above the maximum
             if (size <= histMaxSize) {
                 size += historyItem->size();
-                foundAttachments += historyItem->attachments()->values();
             }
 
             if (size > histMaxSize) {
@@ -754,9 +1093,11 @@ bool Entry::equals(const Entry* other, CompareItemOptions options) const
         return false;
     }
     if (!options.testFlag(CompareItemIgnoreHistory)) {
-        if (m_history.count() != other->m_history.count()) {
+        if (historyItemCount() != other->historyItemCount()) {
             return false;
         }
+        expandHistory();
+        other->expandHistory();
         for (int i = 0; i < m_history.count(); ++i) {
             if (!m_history[i]->equals(other->m_history[i], options)) {
                 return false;
@@ -793,8 +1134,20 @@ Entry* Entry::clone(CloneFlags flags) const
     }
 
     entry->m_autoTypeAssociations->copyDataFrom(m_autoTypeAssociations);
-    if (flags & CloneIncludeHistory) {
-        for (Entry* historyItem : m_history) {
+    const bool shareHistory = hasCompactHistory() || (flags & CloneCompactHistory);
+    if ((flags & CloneIncludeHistory) && shareHistory && !(flags & (CloneUserAsRef | ClonePassAsRef))) {
+        // The snapshots share their data, copying them is cheap
+        for (const Entry* historyEntry : asConst(m_history)) {
+            HistoryItem historyItem(historyEntry);
+            historyItem.setUuid(entry->uuid());
+            entry->m_compactHistory.append(historyItem);
+        }
+        for (HistoryItem historyItem : asConst(m_compactHistory)) {
+            historyItem.setUuid(entry->uuid());
+            entry->m_compactHistory.append(historyItem);
+        }
+    } else if (flags & CloneIncludeHistory) {
+        for (Entry* historyItem : historyItems()) {
             Entry* historyItemClone =
                 historyItem->clone(flags & ~CloneIncludeHistory & ~CloneNewUuid & ~CloneResetTimeInfo);
             historyItemClone->setUpdateTimeinfo(false);
@@ -830,6 +1183,9 @@ void Entry::copyDataFrom(const Entry* other)
     m_attachments->copyDataFrom(other->m_attachments);
     m_autoTypeAssociations->copyDataFrom(other->m_autoTypeAssociations);
     setUpdateTimeinfo(true);
+    // m_data is assigned directly without emitting entryModified()
+    m_changedFields = ChangeJournal::AllFields;
+    updateRevision();
 }
 
 void Entry::beginUpdate()
@@ -851,8 +1207,14 @@ bool Entry::endUpdate()
 {
     Q_ASSERT(!m_tmpHistoryItem.isNull());
     if (m_modifiedSinceBegin) {
-        m_tmpHistoryItem->setUpdateTimeinfo(true);
-        addHistoryItem(m_tmpHistoryItem.take());
+        if (m_history.isEmpty()) {
+            // Nobody holds pointers to history entries, keep the snapshot compact
+            m_compactHistory.append(HistoryItem(m_tmpHistoryItem.data()));
+            emit entryModified();
+        } else {
+            m_tmpHistoryItem->setUpdateTimeinfo(true);
+            addHistoryItem(m_tmpHistoryItem.take());
+        }
         truncateHistory();
     }
 
@@ -861,9 +1223,18 @@ bool Entry::endUpdate()
     return m_modifiedSinceBegin;
 }
 
-void Entry::updateModifiedSinceBegin()
+/**
+ * Bookkeeping for every modification. The database is notified directly,
+ * so entries don't need a connection to the database they belong to.
+ */
+void Entry::handleModified()
 {
+    updateTimeinfo();
     m_modifiedSinceBegin = true;
+    updateRevision();
+    if (m_group && m_group->database()) {
+        m_group->database()->markAsModified();
+    }
 }
 
 QString Entry::resolveMultiplePlaceholdersRecursive(const QString& str, int maxDepth) const
@@ -928,6 +1299,7 @@ QString Entry::resolvePlaceholderRecursive(const QString& placeholder, int maxDe
         }
         return resolveMultiplePlaceholdersRecursive(url(), maxDepth - 1);
     case PlaceholderType::DbDir: {
+        markResolvedVolatile();
         QFileInfo fileInfo(database()->filePath());
         return fileInfo.absoluteDir().absolutePath();
     }
@@ -945,6 +1317,7 @@ QString Entry::resolvePlaceholderRecursive(const QString& placeholder, int maxDe
         return resolveUrlPlaceholder(strUrl, typeOfPlaceholder);
     }
     case PlaceholderType::Totp:
+        markResolvedVolatile();
         // totp can't have placeholder inside
         return totp();
     case PlaceholderType::CustomAttribute: {
@@ -952,6 +1325,7 @@ QString Entry::resolvePlaceholderRecursive(const QString& placeholder, int maxDe
         return attributes()->hasKey(key) ? attributes()->value(key) : QString();
     }
     case PlaceholderType::Reference:
+        markResolvedReference();
         return resolveReferencePlaceholderRecursive(placeholder, maxDepth);
     case PlaceholderType::DateTimeSimple:
     case PlaceholderType::DateTimeYear:
@@ -967,6 +1341,7 @@ QString Entry::resolvePlaceholderRecursive(const QString& placeholder, int maxDe
     case PlaceholderType::DateTimeUtcHour:
     case PlaceholderType::DateTimeUtcMinute:
     case PlaceholderType::DateTimeUtcSecond:
+        markResolvedVolatile();
         return resolveMultiplePlaceholdersRecursive(resolveDateTimePlaceholder(typeOfPlaceholder), maxDepth - 1);
     }
 
@@ -1130,16 +1505,29 @@ void Entry::setGroup(Group* group)
             // copy custom icon to the new database
             if (!iconUuid().isNull() && group->database() && m_group->database()->metadata()->hasCustomIcon(iconUuid())
                 && !group->database()->metadata()->hasCustomIcon(iconUuid())) {
-                group->database()->metadata()->addCustomIcon(iconUuid(), icon());
+                group->database()->metadata()->addCustomIcon(iconUuid(),
+                                                             m_group->database()->metadata()->customIconData(iconUuid()));
             }
         }
     }
 
+    Database* previousDatabase = m_group ? m_group->database() : nullptr;
     m_group = group;
     group->addEntry(this);
 
     QObject::setParent(group);
 
+    // attachments equal to ones already in the database share their data
+    Database* db = group->database();
+    if (db && db != previousDatabase && !m_attachments->isEmpty()) {
+        const QList<QString> keys = m_attachments->keys();
+        for (const QString& key : keys) {
+            if (!m_attachments->isDeferred(key)) {
+                m_attachments->shareValue(key, db->attachmentStore()->insert(m_attachments->value(key)));
+            }
+        }
+    }
+
     if (m_updateTimeinfo) {
         m_data.timeInfo.setLocationChanged(Clock::currentDateTimeUtc());
     }
@@ -1148,6 +1536,31 @@ void Entry::setGroup(Group* group)
 void Entry::emitDataChanged()
 {
     emit entryDataChanged(this);
+    if (m_group && m_group->database()) {
+        emit m_group->database()->entryDataChanged(this);
+    }
+}
+
+void Entry::updateRevision()
+{
+    m_revision = nextRevision++;
+    if (m_group && m_group->database()) {
+        m_group->database()->updateReferenceIndex(this);
+        m_group->database()->updateUsernameIndex(this);
+        // plain properties are set without telling which one changed
+        const ChangeJournal::Fields fields = m_changedFields ? m_changedFields : ChangeJournal::Properties;
+        m_group->database()->m_changeJournal.record(ChangeJournal::Kind::EntryModified, m_uuid, fields);
+    }
+    m_changedFields = ChangeJournal::NoFields;
+}
+
+/**
+ * @return revision that changes whenever the entry is modified and
+ *         is unique across all entries, e.g. to invalidate caches
+ */
+quint64 Entry::revision() const
+{
+    return m_revision;
 }
 
 const Database* Entry::database() const
@@ -1189,12 +1602,68 @@ Entry* Entry::resolveReference(const QString& str) const
 
 QString Entry::resolveMultiplePlaceholders(const QString& str) const
 {
-    return resolveMultiplePlaceholdersRecursive(str, ResolveMaximumDepth);
+    return resolveCached(str, true);
 }
 
 QString Entry::resolvePlaceholder(const QString& placeholder) const
 {
-    return resolvePlaceholderRecursive(placeholder, ResolveMaximumDepth);
+    return resolveCached(placeholder, false);
+}
+
+/**
+ * Resolve the placeholders of the string, reusing the previous result
+ * while it is still valid. Results depend on the entry revision, and if
+ * they contain references, on the modifications of the database since
+ * any entry may be referenced. Time dependent results are not cached.
+ */
+QString Entry::resolveCached(const QString& str, bool multiple) const
+{
+    // Nothing to resolve, which is the case for most fields
+    if (!str.contains(QLatin1Char('{'))) {
+        return str;
+    }
+
+    const quint64 revision = m_revision;
+    const Database* db = database();
+    const quint64 databaseModifications = db ? db->modificationCount() : 0;
+
+    {
+        QMutexLocker locker(&m_resolvedCacheMutex);
+        auto it = m_resolvedCache.constFind(str);
+        if (it != m_resolvedCache.constEnd() && it->multiple == multiple && it->revision == revision
+            && (!it->database || (it->database == db && it->databaseModifications == databaseModifications))) {
+            return it->value;
+        }
+    }
+
+    ResolveContext context;
+    ResolveContext* outerContext = resolveContext;
+    resolveContext = &context;
+    const QString result = multiple ? resolveMultiplePlaceholdersRecursive(str, ResolveMaximumDepth)
+                                    : resolvePlaceholderRecursive(str, ResolveMaximumDepth);
+    resolveContext = outerContext;
+
+    if (outerContext) {
+        outerContext->cacheable = outerContext->cacheable && context.cacheable;
+        outerContext->usesReferences = outerContext->usesReferences || context.usesReferences;
+    }
+
+    if (context.cacheable) {
+        ResolvedValue resolved;
+        resolved.value = result;
+        resolved.multiple = multiple;
+        resolved.revision = revision;
+        resolved.database = context.usesReferences ? db : nullptr;
+        resolved.databaseModifications = databaseModifications;
+
+        QMutexLocker locker(&m_resolvedCacheMutex);
+        if (m_resolvedCache.size() >= MaxResolvedCacheSize) {
+            m_resolvedCache.clear();
+        }
+        m_resolvedCache.insert(str, resolved);
+    }
+
+    return result;
 }
 
 QString Entry::resolveUrlPlaceholder(const QString& str, Entry::PlaceholderType placeholderType) const
@@ -1382,3 +1851,249 @@ bool EntryData::equals(const EntryData& other, CompareItemOptions options) const
 
     return true;
 }
+
+HistoryItem::HistoryItem(const Entry* entry)
+    : m_uuid(entry->m_uuid)
+    , m_data(entry->m_data)
+    , m_attributes(entry->m_attributes->m_attributes)
+    , m_deferredAttributes(entry->m_attributes->m_deferred)
+    , m_compressedAttributes(entry->m_attributes->m_compressed)
+    , m_protectedAttributes(entry->m_attributes->m_protectedAttributes)
+    , m_attachments(entry->m_attachments->m_attachments)
+    , m_deferredAttachments(entry->m_attachments->m_deferred)
+    , m_autoTypeAssociations(entry->m_autoTypeAssociations->m_associations)
+    , m_customData(entry->m_customData->m_data)
+    , m_size(entry->size())
+{
+}
+
+const QUuid& HistoryItem::uuid() const
+{
+    return m_uuid;
+}
+
+void HistoryItem::setUuid(const QUuid& uuid)
+{
+    m_uuid = uuid;
+}
+
+const TimeInfo& HistoryItem::timeInfo() const
+{
+    return m_data.timeInfo;
+}
+
+const EntryData& HistoryItem::data() const
+{
+    return m_data;
+}
+
+/**
+ * @return value of the attribute, a protected value that is still encrypted
+ *         is decrypted without keeping the plain text in the snapshot
+ */
+QString HistoryItem::attributeValue(const QString& key) const
+{
+    auto compressed = m_compressedAttributes.constFind(key);
+    if (compressed != m_compressedAttributes.constEnd()) {
+        return EntryAttributes::decompressValue(*compressed);
+    }
+
+    auto deferred = m_deferredAttributes.constFind(key);
+    if (deferred == m_deferredAttributes.constEnd()) {
+        return m_attributes.value(key);
+    }
+
+    QByteArray plaintext = deferred->source->decrypt(deferred->ciphertext, deferred->offset);
+    const QString value = QString::fromUtf8(plaintext);
+    SecureArena::wipe(plaintext);
+    return value;
+}
+
+/**
+ * @return keys of the attributes that differ from the other snapshot or
+ *         only exist in one of them, in the order of their keys
+ */
+QStringList HistoryItem::changedAttributes(const HistoryItem& other) const
+{
+    if (m_attributes.isSharedWith(other.m_attributes) && m_deferredAttributes.isEmpty()
+        && other.m_deferredAttributes.isEmpty() && m_compressedAttributes == other.m_compressedAttributes) {
+        return {};
+    }
+
+    QStringList keys = m_attributes.keys();
+    for (const QString& key : other.m_attributes.keys()) {
+        if (!m_attributes.contains(key)) {
+            keys.append(key);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+
+    QStringList changed;
+    for (const QString& key : asConst(keys)) {
+        if (!m_attributes.contains(key) || !other.m_attributes.contains(key)) {
+            changed.append(key);
+            continue;
+        }
+
+        auto deferred = m_deferredAttributes.constFind(key);
+        auto otherDeferred = other.m_deferredAttributes.constFind(key);
+        if (deferred != m_deferredAttributes.constEnd() && otherDeferred != other.m_deferredAttributes.constEnd()
+            && deferred->source == otherDeferred->source && deferred->offset == otherDeferred->offset) {
+            // the same encrypted value of the file
+            continue;
+        }
+        auto compressed = m_compressedAttributes.constFind(key);
+        auto otherCompressed = other.m_compressedAttributes.constFind(key);
+        if (compressed != m_compressedAttributes.constEnd()
+            && otherCompressed != other.m_compressedAttributes.constEnd() && *compressed == *otherCompressed) {
+            continue;
+        }
+        if (attributeValue(key) != other.attributeValue(key)) {
+            changed.append(key);
+        }
+    }
+    return changed;
+}
+
+/**
+ * @return true if both snapshots have attachments with the same names and contents,
+ *         deferred attachments are only read when their sizes are equal
+ */
+bool HistoryItem::hasSameAttachments(const HistoryItem& other) const
+{
+    if (m_attachments.keys() != other.m_attachments.keys()) {
+        return false;
+    }
+
+    for (auto it = m_attachments.constBegin(); it != m_attachments.constEnd(); ++it) {
+        auto deferred = m_deferredAttachments.constFind(it.key());
+        auto otherDeferred = other.m_deferredAttachments.constFind(it.key());
+        const bool isDeferred = deferred != m_deferredAttachments.constEnd();
+        const bool otherIsDeferred = otherDeferred != other.m_deferredAttachments.constEnd();
+        if (!isDeferred && !otherIsDeferred) {
+            if (it.value() != other.m_attachments.value(it.key())) {
+                return false;
+            }
+            continue;
+        }
+        if (isDeferred && otherIsDeferred && deferred->source == otherDeferred->source
+            && deferred->index == otherDeferred->index) {
+            continue;
+        }
+
+        const int size = isDeferred ? deferred->source->size(deferred->index) : it.value().size();
+        const int otherSize = otherIsDeferred ? otherDeferred->source->size(otherDeferred->index)
+                                              : other.m_attachments.value(it.key()).size();
+        if (size != otherSize) {
+            return false;
+        }
+        const QByteArray value = isDeferred ? deferred->source->read(deferred->index) : it.value();
+        const QByteArray otherValue = otherIsDeferred ? otherDeferred->source->read(otherDeferred->index)
+                                                      : other.m_attachments.value(it.key());
+        if (value != otherValue) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int HistoryItem::size() const
+{
+    return m_size;
+}
+
+void HistoryItem::addMemoryUsage(MemoryUsage& usage) const
+{
+    // m_size also covers the attachments and custom data, which are counted in their own categories
+    int otherSize = 0;
+    for (auto it = m_attachments.constBegin(); it != m_attachments.constEnd(); ++it) {
+        auto deferred = m_deferredAttachments.constFind(it.key());
+        if (deferred != m_deferredAttachments.constEnd()) {
+            const int size = deferred->source->size(deferred->index);
+            usage.addDeferredAttachment(size);
+            otherSize += size;
+        } else {
+            usage.addAttachment(it.value());
+            otherSize += it.value().size();
+        }
+        otherSize += it.key().toUtf8().size();
+    }
+
+    int customDataSize = 0;
+    for (auto it = m_customData.constBegin(); it != m_customData.constEnd(); ++it) {
+        customDataSize += it.key().toUtf8().size() + it.value().toUtf8().size();
+    }
+    otherSize += customDataSize;
+
+    usage.historyItems += sizeof(HistoryItem) + MemoryUsage::textSize(qMax(0, m_size - otherSize));
+    usage.customData += MemoryUsage::textSize(customDataSize);
+}
+
+bool HistoryItem::hasCustomData() const
+{
+    return !m_customData.isEmpty();
+}
+
+/**
+ * @return attachments in the order of their names, deferred ones unread
+ */
+QList<AttachmentValue> HistoryItem::attachmentValues() const
+{
+    QList<AttachmentValue> values;
+    for (auto it = m_attachments.constBegin(); it != m_attachments.constEnd(); ++it) {
+        auto deferred = m_deferredAttachments.constFind(it.key());
+        if (deferred != m_deferredAttachments.constEnd()) {
+            values.append({{}, deferred->source, deferred->index});
+        } else {
+            values.append({it.value(), {}, -1});
+        }
+    }
+    return values;
+}
+
+/**
+ * @param key attachment name
+ * @return attachment, unread if it is deferred
+ */
+AttachmentValue HistoryItem::attachmentValue(const QString& key) const
+{
+    auto deferred = m_deferredAttachments.constFind(key);
+    if (deferred != m_deferredAttachments.constEnd()) {
+        return {{}, deferred->source, deferred->index};
+    }
+    return {m_attachments.value(key), {}, -1};
+}
+
+void HistoryItem::loadDeferredAttachments(EntryAttachments::LoadedValues* loaded)
+{
+    if (m_deferredAttachments.isEmpty()) {
+        return;
+    }
+
+    EntryAttachments attachments;
+    attachments.m_attachments = m_attachments;
+    attachments.m_deferred = m_deferredAttachments;
+    attachments.loadDeferred(loaded);
+    m_attachments = attachments.m_attachments;
+    m_deferredAttachments = attachments.m_deferred;
+}
+
+/**
+ * Create a full entry from the snapshot, the caller takes ownership.
+ * The data is assigned directly, so no modification signals are involved.
+ */
+Entry* HistoryItem::createEntry() const
+{
+    auto* entry = new Entry();
+    entry->m_uuid = m_uuid;
+    entry->m_data = m_data;
+    entry->m_attributes->m_attributes = m_attributes;
+    entry->m_attributes->m_deferred = m_deferredAttributes;
+    entry->m_attributes->m_compressed = m_compressedAttributes;
+    entry->m_attributes->m_protectedAttributes = m_protectedAttributes;
+    entry->m_attachments->m_attachments = m_attachments;
+    entry->m_attachments->m_deferred = m_deferredAttachments;
+    entry->m_autoTypeAssociations->m_associations = m_autoTypeAssociations;
+    entry->m_customData->m_data = m_customData;
+    return entry;
+}
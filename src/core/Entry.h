@@ -19,15 +19,20 @@
 #ifndef KEEPASSX_ENTRY_H
 #define KEEPASSX_ENTRY_H
 
+#include <QHash>
 #include <QImage>
 #include <QMap>
+#include <QMutex>
 #include <QPixmap>
 #include <QPointer>
+#include <QScopedPointer>
 #include <QSet>
 #include <QUrl>
 #include <QUuid>
 
+#include "core/AttachmentSource.h"
 #include "core/AutoTypeAssociations.h"
+#include "core/ChangeJournal.h"
 #include "core/CustomData.h"
 #include "core/EntryAttachments.h"
 #include "core/EntryAttributes.h"
@@ -35,7 +40,9 @@
 #include "core/TimeInfo.h"
 
 class Database;
+class Entry;
 class Group;
+class MemoryUsage;
 namespace Totp
 {
     struct Settings;
@@ -61,6 +68,8 @@ struct EntryData
     QString backgroundColor;
     QString overrideUrl;
     QString tags;
+    // tags split at their delimiters, kept in sync with tags
+    QStringList tagList;
     bool autoTypeEnabled;
     int autoTypeObfuscation;
     QString defaultAutoTypeSequence;
@@ -72,6 +81,45 @@ struct EntryData
     bool equals(const EntryData& other, CompareItemOptions options) const;
 };
 
+/**
+ * Read-only snapshot of an entry in the history of another one. It keeps the
+ * same implicitly shared data as an Entry without any of its QObjects, a full
+ * Entry is only created once the history is actually inspected.
+ */
+class HistoryItem
+{
+public:
+    explicit HistoryItem(const Entry* entry);
+
+    const QUuid& uuid() const;
+    void setUuid(const QUuid& uuid);
+    const TimeInfo& timeInfo() const;
+    const EntryData& data() const;
+    QString attributeValue(const QString& key) const;
+    QStringList changedAttributes(const HistoryItem& other) const;
+    bool hasSameAttachments(const HistoryItem& other) const;
+    int size() const;
+    void addMemoryUsage(MemoryUsage& usage) const;
+    bool hasCustomData() const;
+    QList<AttachmentValue> attachmentValues() const;
+    AttachmentValue attachmentValue(const QString& key) const;
+    void loadDeferredAttachments(EntryAttachments::LoadedValues* loaded = nullptr);
+    Entry* createEntry() const;
+
+private:
+    QUuid m_uuid;
+    EntryData m_data;
+    EntryAttributes::Values m_attributes;
+    QMap<QString, EntryAttributes::DeferredValue> m_deferredAttributes;
+    QMap<QString, EntryAttributes::CompressedValue> m_compressedAttributes;
+    QSet<QString> m_protectedAttributes;
+    QMap<QString, QByteArray> m_attachments;
+    QMap<QString, EntryAttachments::DeferredValue> m_deferredAttachments;
+    QList<AutoTypeAssociations::Association> m_autoTypeAssociations;
+    QHash<QString, QString> m_customData;
+    int m_size;
+};
+
 class Entry : public QObject
 {
     Q_OBJECT
@@ -89,6 +137,7 @@ public:
     QString backgroundColor() const;
     QString overrideUrl() const;
     QString tags() const;
+    const QStringList& tagList() const;
     const TimeInfo& timeInfo() const;
     bool autoTypeEnabled() const;
     int autoTypeObfuscation() const;
@@ -109,6 +158,7 @@ public:
     QString totpSettingsString() const;
     QSharedPointer<Totp::Settings> totpSettings() const;
     int size() const;
+    void addMemoryUsage(MemoryUsage& usage) const;
     QString path() const;
 
     bool hasTotp() const;
@@ -149,9 +199,20 @@ public:
 
     QList<Entry*> historyItems();
     const QList<Entry*>& historyItems() const;
+    int historyItemCount() const;
+    QList<TimeInfo> historyTimeInfos() const;
+    QList<HistoryItem> historySnapshots() const;
+    bool hasHistoryCustomData() const;
+    QList<AttachmentValue> historyAttachmentValues() const;
+    template <typename Visitor> bool forEachHistoryItem(Visitor visitor) const;
     void addHistoryItem(Entry* entry);
+    void takeHistoryFrom(Entry* other);
     void removeHistoryItems(const QList<Entry*>& historyEntries);
+    void removeHistoryItemsAt(const QList<int>& indexes);
     void truncateHistory();
+    bool hasCompactHistory() const;
+    void compactHistory();
+    void loadDeferredAttachments(EntryAttachments::LoadedValues* loaded = nullptr);
 
     bool equals(const Entry* other, CompareItemOptions options = CompareItemDefault) const;
 
@@ -164,6 +225,7 @@ public:
         CloneRenameTitle = 8, // add "-Clone" after the original title
         CloneUserAsRef = 16, // Add the user as a reference to the original entry
         ClonePassAsRef = 32, // Add the password as a reference to the original entry
+        CloneCompactHistory = 64, // keep the cloned history as shared snapshots instead of entries
     };
     Q_DECLARE_FLAGS(CloneFlags, CloneFlag)
 
@@ -244,6 +306,7 @@ public:
     void setGroup(Group* group);
     const Database* database() const;
     Database* database();
+    quint64 revision() const;
 
     bool canUpdateTimeinfo() const;
     void setUpdateTimeinfo(bool value);
@@ -258,10 +321,22 @@ signals:
 private slots:
     void emitDataChanged();
     void updateTimeinfo();
-    void updateModifiedSinceBegin();
     void updateTotp();
+    void updateRevision();
+    void handleModified();
 
 private:
+    struct ResolvedValue
+    {
+        QString value;
+        bool multiple;
+        quint64 revision;
+        // only set if the value depends on references to other entries
+        const Database* database;
+        quint64 databaseModifications;
+    };
+
+    QString resolveCached(const QString& str, bool multiple) const;
     QString resolveMultiplePlaceholdersRecursive(const QString& str, int maxDepth) const;
     QString resolvePlaceholderRecursive(const QString& placeholder, int maxDepth) const;
     QString resolveReferencePlaceholderRecursive(const QString& placeholder, int maxDepth) const;
@@ -271,6 +346,10 @@ private:
     static EntryReferenceType referenceType(const QString& referenceStr);
 
     template <class T> bool set(T& property, const T& value);
+    void expandHistory() const;
+
+    friend class Group;
+    friend class HistoryItem;
 
     QUuid m_uuid;
     EntryData m_data;
@@ -278,14 +357,47 @@ private:
     QPointer<EntryAttachments> m_attachments;
     QPointer<AutoTypeAssociations> m_autoTypeAssociations;
     QPointer<CustomData> m_customData;
-    QList<Entry*> m_history; // Items sorted from oldest to newest
+    // Items sorted from oldest to newest, at most one of the lists is filled
+    mutable QList<Entry*> m_history;
+    mutable QList<HistoryItem> m_compactHistory;
 
     QScopedPointer<Entry> m_tmpHistoryItem;
     bool m_modifiedSinceBegin;
     QPointer<Group> m_group;
     bool m_updateTimeinfo;
+    quint64 m_revision;
+    // fields modified since the last revision, for the change journal of the database
+    ChangeJournal::Fields m_changedFields;
+    // size() of the revision m_sizeRevision, revisions start at 1
+    mutable int m_size;
+    mutable quint64 m_sizeRevision;
+    mutable QHash<QString, ResolvedValue> m_resolvedCache;
+    mutable QMutex m_resolvedCacheMutex;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Entry::CloneFlags)
 
+/**
+ * Visit the history items without keeping an Entry for compact items
+ * around; those are only valid during the call of the visitor.
+ *
+ * @param visitor callable taking const Entry*, returning false to stop
+ * @return false if the visitor stopped the iteration
+ */
+template <typename Visitor> bool Entry::forEachHistoryItem(Visitor visitor) const
+{
+    for (const Entry* historyItem : m_history) {
+        if (!visitor(historyItem)) {
+            return false;
+        }
+    }
+    for (const HistoryItem& historyItem : m_compactHistory) {
+        QScopedPointer<Entry> entry(historyItem.createEntry());
+        if (!visitor(entry.data())) {
+            return false;
+        }
+    }
+    return true;
+}
+
 #endif // KEEPASSX_ENTRY_H
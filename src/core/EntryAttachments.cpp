@@ -17,7 +17,9 @@
 
 #include "EntryAttachments.h"
 
+#include "core/AttachmentSource.h"
 #include "core/Global.h"
+#include "core/MemoryUsage.h"
 
 #include <QSet>
 #include <QStringList>
@@ -39,14 +41,56 @@ bool EntryAttachments::hasKey(const QString& key) const
 
 QSet<QByteArray> EntryAttachments::values() const
 {
-    return asConst(m_attachments).values().toSet();
+    if (m_deferred.isEmpty()) {
+        return asConst(m_attachments).values().toSet();
+    }
+
+    QSet<QByteArray> values;
+    for (auto it = m_attachments.constBegin(); it != m_attachments.constEnd(); ++it) {
+        values.insert(value(it.key()));
+    }
+    return values;
 }
 
 QByteArray EntryAttachments::value(const QString& key) const
 {
+    auto deferred = m_deferred.constFind(key);
+    if (deferred != m_deferred.constEnd()) {
+        return deferred->source->read(deferred->index);
+    }
     return m_attachments.value(key);
 }
 
+/**
+ * Size of an attachment in bytes. Deferred attachments are not read.
+ *
+ * @param key attachment name
+ * @return attachment size
+ */
+int EntryAttachments::valueSize(const QString& key) const
+{
+    auto deferred = m_deferred.constFind(key);
+    if (deferred != m_deferred.constEnd()) {
+        return deferred->source->size(deferred->index);
+    }
+    return m_attachments.value(key).size();
+}
+
+/**
+ * Attachment without reading it if it is deferred.
+ *
+ * @param key attachment name
+ * @return data or the position of the attachment in its source
+ */
+AttachmentValue EntryAttachments::valueRef(const QString& key) const
+{
+    auto deferred = m_deferred.constFind(key);
+    if (deferred != m_deferred.constEnd()) {
+        return {{}, deferred->source, deferred->index};
+    }
+    return {m_attachments.value(key), {}, -1};
+}
+
 void EntryAttachments::set(const QString& key, const QByteArray& value)
 {
     bool emitModified = false;
@@ -56,8 +100,9 @@ void EntryAttachments::set(const QString& key, const QByteArray& value)
         emit aboutToBeAdded(key);
     }
 
-    if (addAttachment || m_attachments.value(key) != value) {
+    if (addAttachment || this->value(key) != value) {
         m_attachments.insert(key, value);
+        m_deferred.remove(key);
         emitModified = true;
     }
 
@@ -72,6 +117,71 @@ void EntryAttachments::set(const QString& key, const QByteArray& value)
     }
 }
 
+/**
+ * Add or replace an attachment whose data is read from the source
+ * every time it is accessed instead of being kept in memory.
+ *
+ * @param key attachment name
+ * @param source attachment storage
+ * @param index index of the attachment in the source
+ */
+void EntryAttachments::setDeferred(const QString& key, QSharedPointer<const AttachmentSource> source, int index)
+{
+    Q_ASSERT(source && index >= 0 && index < source->count());
+
+    bool addAttachment = !m_attachments.contains(key);
+
+    if (addAttachment) {
+        emit aboutToBeAdded(key);
+    }
+
+    m_attachments.insert(key, QByteArray());
+    m_deferred.insert(key, {std::move(source), index});
+
+    if (addAttachment) {
+        emit added(key);
+    } else {
+        emit keyModified(key);
+    }
+
+    emit entryAttachmentsModified();
+}
+
+bool EntryAttachments::isDeferred(const QString& key) const
+{
+    return m_deferred.contains(key);
+}
+
+bool EntryAttachments::hasDeferred() const
+{
+    return !m_deferred.isEmpty();
+}
+
+/**
+ * Read all deferred attachments into memory. The attachment
+ * contents don't change, so no signals are emitted.
+ *
+ * @param loaded attachments read before, e.g. for other history items;
+ *               they are shared instead of being read again
+ */
+void EntryAttachments::loadDeferred(LoadedValues* loaded)
+{
+    for (auto it = m_deferred.constBegin(); it != m_deferred.constEnd(); ++it) {
+        if (!loaded) {
+            m_attachments.insert(it.key(), it->source->read(it->index));
+            continue;
+        }
+
+        const auto id = qMakePair(it->source.data(), it->index);
+        auto value = loaded->constFind(id);
+        if (value == loaded->constEnd()) {
+            value = loaded->insert(id, it->source->read(it->index));
+        }
+        m_attachments.insert(it.key(), value.value());
+    }
+    m_deferred.clear();
+}
+
 void EntryAttachments::remove(const QString& key)
 {
     if (!m_attachments.contains(key)) {
@@ -82,6 +192,7 @@ void EntryAttachments::remove(const QString& key)
     emit aboutToBeRemoved(key);
 
     m_attachments.remove(key);
+    m_deferred.remove(key);
 
     emit removed(key);
     emit entryAttachmentsModified();
@@ -104,6 +215,7 @@ void EntryAttachments::remove(const QStringList& keys)
         isModified = true;
         emit aboutToBeRemoved(key);
         m_attachments.remove(key);
+        m_deferred.remove(key);
         emit removed(key);
     }
 
@@ -114,6 +226,13 @@ void EntryAttachments::remove(const QStringList& keys)
 
 void EntryAttachments::rename(const QString& key, const QString& newKey)
 {
+    if (isDeferred(key)) {
+        const DeferredValue deferred = m_deferred.value(key);
+        remove(key);
+        setDeferred(newKey, deferred.source, deferred.index);
+        return;
+    }
+
     const QByteArray val = value(key);
     remove(key);
     set(newKey, val);
@@ -133,6 +252,7 @@ void EntryAttachments::clear()
     emit aboutToBeReset();
 
     m_attachments.clear();
+    m_deferred.clear();
 
     emit reset();
     emit entryAttachmentsModified();
@@ -144,27 +264,98 @@ void EntryAttachments::copyDataFrom(const EntryAttachments* other)
         emit aboutToBeReset();
 
         m_attachments = other->m_attachments;
+        m_deferred = other->m_deferred;
 
         emit reset();
         emit entryAttachmentsModified();
     }
 }
 
+/**
+ * Let attachments equal to those of another instance share their data.
+ * The contents stay the same, hence no signals.
+ *
+ * @param other attachments to share the data with
+ */
+void EntryAttachments::shareValuesWith(const EntryAttachments* other)
+{
+    if (m_attachments.isSharedWith(other->m_attachments)) {
+        return;
+    }
+
+    for (auto it = m_attachments.begin(); it != m_attachments.end(); ++it) {
+        if (m_deferred.contains(it.key()) || other->m_deferred.contains(it.key())) {
+            continue;
+        }
+        auto otherIt = other->m_attachments.constFind(it.key());
+        if (otherIt != other->m_attachments.constEnd() && otherIt.value() == it.value()) {
+            it.value() = otherIt.value();
+        }
+    }
+}
+
+/**
+ * Let an attachment share the data of an equal value, e.g. the copy
+ * kept by the attachment store of the database. No signals are emitted.
+ *
+ * @param key attachment name
+ * @param value value with the same contents as the attachment
+ */
+void EntryAttachments::shareValue(const QString& key, const QByteArray& value)
+{
+    auto it = m_attachments.constFind(key);
+    if (it == m_attachments.constEnd() || m_deferred.contains(key) || it.value().constData() == value.constData()
+        || it.value() != value) {
+        return;
+    }
+    m_attachments.insert(key, value);
+}
+
 bool EntryAttachments::operator==(const EntryAttachments& other) const
 {
-    return m_attachments == other.m_attachments;
+    if (m_deferred.isEmpty() && other.m_deferred.isEmpty()) {
+        return m_attachments == other.m_attachments;
+    }
+
+    if (m_attachments.keys() != other.m_attachments.keys()) {
+        return false;
+    }
+    for (auto it = m_attachments.constBegin(); it != m_attachments.constEnd(); ++it) {
+        auto deferred = m_deferred.constFind(it.key());
+        auto otherDeferred = other.m_deferred.constFind(it.key());
+        if (deferred != m_deferred.constEnd() && otherDeferred != other.m_deferred.constEnd()
+            && deferred->source == otherDeferred->source && deferred->index == otherDeferred->index) {
+            continue;
+        }
+        if (value(it.key()) != other.value(it.key())) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool EntryAttachments::operator!=(const EntryAttachments& other) const
 {
-    return m_attachments != other.m_attachments;
+    return !(*this == other);
 }
 
 int EntryAttachments::attachmentsSize() const
 {
     int size = 0;
     for (auto it = m_attachments.constBegin(); it != m_attachments.constEnd(); ++it) {
-        size += it.key().toUtf8().size() + it.value().size();
+        size += it.key().toUtf8().size() + valueSize(it.key());
     }
     return size;
 }
+
+void EntryAttachments::addMemoryUsage(MemoryUsage& usage) const
+{
+    for (auto it = m_attachments.constBegin(); it != m_attachments.constEnd(); ++it) {
+        auto deferred = m_deferred.constFind(it.key());
+        if (deferred != m_deferred.constEnd()) {
+            usage.addDeferredAttachment(deferred->source->size(deferred->index));
+        } else {
+            usage.addAttachment(it.value());
+        }
+    }
+}
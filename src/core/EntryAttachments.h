@@ -18,9 +18,16 @@
 #ifndef KEEPASSX_ENTRYATTACHMENTS_H
 #define KEEPASSX_ENTRYATTACHMENTS_H
 
+#include <QHash>
 #include <QMap>
 #include <QObject>
+#include <QPair>
+#include <QSharedPointer>
 
+class MemoryUsage;
+
+class AttachmentSource;
+struct AttachmentValue;
 class QStringList;
 
 class EntryAttachments : public QObject
@@ -28,21 +35,33 @@ class EntryAttachments : public QObject
     Q_OBJECT
 
 public:
+    // attachments read by loadDeferred(), by source and index
+    using LoadedValues = QHash<QPair<const AttachmentSource*, int>, QByteArray>;
+
     explicit EntryAttachments(QObject* parent = nullptr);
     QList<QString> keys() const;
     bool hasKey(const QString& key) const;
     QSet<QByteArray> values() const;
     QByteArray value(const QString& key) const;
+    int valueSize(const QString& key) const;
+    AttachmentValue valueRef(const QString& key) const;
     void set(const QString& key, const QByteArray& value);
+    void setDeferred(const QString& key, QSharedPointer<const AttachmentSource> source, int index);
+    bool isDeferred(const QString& key) const;
+    bool hasDeferred() const;
+    void loadDeferred(LoadedValues* loaded = nullptr);
     void remove(const QString& key);
     void remove(const QStringList& keys);
     void rename(const QString& key, const QString& newKey);
     bool isEmpty() const;
     void clear();
     void copyDataFrom(const EntryAttachments* other);
+    void shareValuesWith(const EntryAttachments* other);
+    void shareValue(const QString& key, const QByteArray& value);
     bool operator==(const EntryAttachments& other) const;
     bool operator!=(const EntryAttachments& other) const;
     int attachmentsSize() const;
+    void addMemoryUsage(MemoryUsage& usage) const;
 
 signals:
     void entryAttachmentsModified();
@@ -55,7 +74,17 @@ signals:
     void reset();
 
 private:
+    friend class HistoryItem;
+
+    struct DeferredValue
+    {
+        QSharedPointer<const AttachmentSource> source;
+        int index;
+    };
+
+    // deferred attachments keep an empty placeholder in m_attachments
     QMap<QString, QByteArray> m_attachments;
+    QMap<QString, DeferredValue> m_deferred;
 };
 
 #endif // KEEPASSX_ENTRYATTACHMENTS_H
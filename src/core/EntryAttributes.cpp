@@ -19,6 +19,17 @@
 #include "EntryAttributes.h"
 
 #include "core/Global.h"
+#include "core/MemoryUsage.h"
+#include "core/ProtectedValueSource.h"
+#include "core/SecureArena.h"
+#include "streams/GzipCodec.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <utility>
 
 const QString EntryAttributes::TitleKey = "Title";
 const QString EntryAttributes::UserNameKey = "UserName";
@@ -34,12 +45,97 @@ const QString EntryAttributes::SearchTextGroupName = "SearchText";
 
 const QString EntryAttributes::RememberCmdExecAttr = "_EXEC_CMD";
 
+const int EntryAttributes::CompressionThreshold = 16 * 1024;
+
+namespace
+{
+    /**
+     * Custom keys repeat across all entries of a database, keep a single
+     * copy of every key for the whole process.
+     */
+    QString internKey(const QString& key)
+    {
+        static QMutex mutex;
+        static QSet<QString> keys;
+
+        QMutexLocker locker(&mutex);
+        auto it = keys.constFind(key);
+        if (it == keys.constEnd()) {
+            it = keys.insert(key);
+        }
+        return *it;
+    }
+
+    bool lessKey(const QPair<QString, QString>& value, const QString& key)
+    {
+        return value.first < key;
+    }
+
+    // the values are mostly text that compresses well even at the fastest level
+    const int CompressionLevel = 1;
+    // total number of characters kept in the cache of decompressed values
+    const int DecompressedCacheSize = 4 * 1024 * 1024;
+
+    struct DecompressedValue
+    {
+        // keeps the compressed data alive, so its address identifies the value
+        QByteArray compressed;
+        QString value;
+    };
+
+    /**
+     * Recently decompressed values of the whole process. History items share the
+     * compressed data of their entry, so they share its cached value as well.
+     */
+    struct DecompressedCache
+    {
+        QMutex mutex;
+        QCache<const char*, DecompressedValue> values{DecompressedCacheSize};
+
+        DecompressedCache()
+        {
+            MemoryUsage::registerCache([this] {
+                QMutexLocker locker(&mutex);
+                values.clear();
+            });
+        }
+
+        static DecompressedCache& instance()
+        {
+            static DecompressedCache cache;
+            return cache;
+        }
+
+        bool find(const QByteArray& compressed, QString& value)
+        {
+            QMutexLocker locker(&mutex);
+            const DecompressedValue* cached = values.object(compressed.constData());
+            if (!cached) {
+                return false;
+            }
+            value = cached->value;
+            return true;
+        }
+
+        void insert(const QByteArray& compressed, const QString& value)
+        {
+            QMutexLocker locker(&mutex);
+            values.insert(compressed.constData(), new DecompressedValue{compressed, value}, value.size());
+        }
+    };
+} // namespace
+
 EntryAttributes::EntryAttributes(QObject* parent)
     : QObject(parent)
 {
     clear();
 }
 
+EntryAttributes::~EntryAttributes()
+{
+    wipeSensitiveValues();
+}
+
 QList<QString> EntryAttributes::keys() const
 {
     return m_attributes.keys();
@@ -64,6 +160,18 @@ QList<QString> EntryAttributes::customKeys() const
 
 QString EntryAttributes::value(const QString& key) const
 {
+    if (!m_deferred.isEmpty()) {
+        auto deferred = m_deferred.constFind(key);
+        if (deferred != m_deferred.constEnd()) {
+            return deferredValue(key, *deferred);
+        }
+    }
+    if (!m_compressed.isEmpty()) {
+        auto compressed = m_compressed.constFind(key);
+        if (compressed != m_compressed.constEnd()) {
+            return decompressValue(*compressed);
+        }
+    }
     return m_attributes.value(key);
 }
 
@@ -71,7 +179,7 @@ QList<QString> EntryAttributes::values(const QList<QString>& keys) const
 {
     QList<QString> values;
     for (const QString& key : keys) {
-        values.append(m_attributes.value(key));
+        values.append(value(key));
     }
     return values;
 }
@@ -83,7 +191,28 @@ bool EntryAttributes::contains(const QString& key) const
 
 bool EntryAttributes::containsValue(const QString& value) const
 {
-    return asConst(m_attributes).values().contains(value);
+    if (m_compressed.isEmpty() && m_deferred.isEmpty()) {
+        return m_attributes.containsValue(value);
+    }
+
+    // skip the placeholders of compressed values, which only shorter values could match
+    const QList<QString> keyList = m_attributes.keys();
+    for (const QString& key : keyList) {
+        auto compressed = m_compressed.constFind(key);
+        auto deferred = m_deferred.constFind(key);
+        if (deferred != m_deferred.constEnd()) {
+            if (deferredValue(key, *deferred) == value) {
+                return true;
+            }
+        } else if (compressed == m_compressed.constEnd()) {
+            if (m_attributes.value(key) == value) {
+                return true;
+            }
+        } else if (value.size() >= CompressionThreshold && decompressValue(*compressed) == value) {
+            return true;
+        }
+    }
+    return false;
 }
 
 bool EntryAttributes::isProtected(const QString& key) const
@@ -107,7 +236,7 @@ void EntryAttributes::set(const QString& key, const QString& value, bool protect
     bool emitModified = false;
 
     bool addAttribute = !m_attributes.contains(key);
-    bool changeValue = !addAttribute && (m_attributes.value(key) != value);
+    bool changeValue = !addAttribute && (this->value(key) != value);
     bool defaultAttribute = isDefaultAttribute(key);
 
     if (addAttribute && !defaultAttribute) {
@@ -115,7 +244,11 @@ void EntryAttributes::set(const QString& key, const QString& value, bool protect
     }
 
     if (addAttribute || changeValue) {
-        m_attributes.insert(key, value);
+        m_deferred.remove(key);
+        dropDecrypted(key);
+        m_compressed.remove(key);
+        wipeValue(key);
+        insertValue(key, value, protect);
         emitModified = true;
     }
 
@@ -123,6 +256,12 @@ void EntryAttributes::set(const QString& key, const QString& value, bool protect
         if (!m_protectedAttributes.contains(key)) {
             emitModified = true;
         }
+        // protected values are wiped when they are replaced, so they are never compressed
+        auto compressed = m_compressed.find(key);
+        if (compressed != m_compressed.end()) {
+            m_attributes.insert(key, decompressValue(*compressed));
+            m_compressed.erase(compressed);
+        }
         m_protectedAttributes.insert(key);
     } else if (m_protectedAttributes.remove(key)) {
         emitModified = true;
@@ -141,6 +280,83 @@ void EntryAttributes::set(const QString& key, const QString& value, bool protect
     }
 }
 
+/**
+ * Set a protected value that is only decrypted when it is accessed.
+ * Setting or removing the value discards the ciphertext.
+ *
+ * @param key attribute key
+ * @param source source to decrypt the value with
+ * @param ciphertext encrypted value
+ * @param offset position of the value in the source's stream
+ */
+void EntryAttributes::setDeferred(const QString& key,
+                                  QSharedPointer<const ProtectedValueSource> source,
+                                  const QByteArray& ciphertext,
+                                  quint64 offset)
+{
+    set(key, QString(), true);
+    m_deferred.insert(key, {std::move(source), ciphertext, offset});
+}
+
+/**
+ * @return true if the value of the key has not been decrypted yet
+ */
+bool EntryAttributes::isDeferred(const QString& key) const
+{
+    if (!m_deferred.contains(key)) {
+        return false;
+    }
+    QMutexLocker locker(&m_decryptedMutex);
+    return !m_decrypted.contains(key);
+}
+
+/**
+ * @return true if the value of the key is kept compressed in memory
+ */
+bool EntryAttributes::isCompressed(const QString& key) const
+{
+    return m_compressed.contains(key);
+}
+
+/**
+ * Decrypt a deferred value on first access. Only the decrypted values are
+ * written, under their mutex, so concurrent readers of the attributes are
+ * safe as long as the attributes themselves are not modified.
+ */
+QString EntryAttributes::deferredValue(const QString& key, const DeferredValue& deferred) const
+{
+    QMutexLocker locker(&m_decryptedMutex);
+    auto decrypted = m_decrypted.constFind(key);
+    if (decrypted != m_decrypted.constEnd()) {
+        return *decrypted;
+    }
+
+    QByteArray plaintext = deferred.source->decrypt(deferred.ciphertext, deferred.offset);
+    const QString value = QString::fromUtf8(plaintext);
+    SecureArena::wipe(plaintext);
+    m_decrypted.insert(key, value);
+    return value;
+}
+
+void EntryAttributes::dropDecrypted(const QString& key)
+{
+    QMutexLocker locker(&m_decryptedMutex);
+    auto decrypted = m_decrypted.find(key);
+    if (decrypted != m_decrypted.end()) {
+        SecureArena::wipe(*decrypted);
+        m_decrypted.erase(decrypted);
+    }
+}
+
+void EntryAttributes::wipeDecrypted()
+{
+    QMutexLocker locker(&m_decryptedMutex);
+    for (auto it = m_decrypted.begin(); it != m_decrypted.end(); ++it) {
+        SecureArena::wipe(*it);
+    }
+    m_decrypted.clear();
+}
+
 void EntryAttributes::remove(const QString& key)
 {
     Q_ASSERT(!isDefaultAttribute(key));
@@ -151,6 +367,10 @@ void EntryAttributes::remove(const QString& key)
 
     emit aboutToBeRemoved(key);
 
+    m_deferred.remove(key);
+    dropDecrypted(key);
+    m_compressed.remove(key);
+    wipeValue(key);
     m_attributes.remove(key);
     m_protectedAttributes.remove(key);
 
@@ -173,13 +393,19 @@ void EntryAttributes::rename(const QString& oldKey, const QString& newKey)
         return;
     }
 
-    QString data = value(oldKey);
+    QString data = m_compressed.contains(oldKey) ? QString() : value(oldKey);
     bool protect = isProtected(oldKey);
 
     emit aboutToRename(oldKey, newKey);
 
+    // a deferred value moves to the new key decrypted
+    m_deferred.remove(oldKey);
+    dropDecrypted(oldKey);
     m_attributes.remove(oldKey);
     m_attributes.insert(newKey, data);
+    if (m_compressed.contains(oldKey)) {
+        m_compressed.insert(newKey, m_compressed.take(oldKey));
+    }
     if (protect) {
         m_protectedAttributes.remove(oldKey);
         m_protectedAttributes.insert(newKey);
@@ -201,6 +427,9 @@ void EntryAttributes::copyCustomKeysFrom(const EntryAttributes* other)
     const QList<QString> keyList = keys();
     for (const QString& key : keyList) {
         if (!isDefaultAttribute(key)) {
+            m_deferred.remove(key);
+            dropDecrypted(key);
+            m_compressed.remove(key);
             m_attributes.remove(key);
             m_protectedAttributes.remove(key);
         }
@@ -209,7 +438,13 @@ void EntryAttributes::copyCustomKeysFrom(const EntryAttributes* other)
     const QList<QString> otherKeyList = other->keys();
     for (const QString& key : otherKeyList) {
         if (!isDefaultAttribute(key)) {
-            m_attributes.insert(key, other->value(key));
+            auto compressed = other->m_compressed.constFind(key);
+            if (compressed != other->m_compressed.constEnd()) {
+                m_attributes.insert(key, QString());
+                m_compressed.insert(key, *compressed);
+            } else {
+                m_attributes.insert(key, other->value(key));
+            }
             if (other->isProtected(key)) {
                 m_protectedAttributes.insert(key);
             }
@@ -247,6 +482,13 @@ void EntryAttributes::copyDataFrom(const EntryAttributes* other)
         emit aboutToBeReset();
 
         m_attributes = other->m_attributes;
+        m_deferred = other->m_deferred;
+        wipeDecrypted();
+        {
+            QMutexLocker locker(&other->m_decryptedMutex);
+            m_decrypted = other->m_decrypted;
+        }
+        m_compressed = other->m_compressed;
         m_protectedAttributes = other->m_protectedAttributes;
 
         emit reset();
@@ -254,6 +496,47 @@ void EntryAttributes::copyDataFrom(const EntryAttributes* other)
     }
 }
 
+/**
+ * Let values equal to those of another instance share their storage,
+ * so history items read from a file cost no more than those recorded
+ * by edits. The values themselves stay the same, hence no signals.
+ *
+ * @param other attributes to share the values with
+ */
+void EntryAttributes::shareValuesWith(const EntryAttributes* other)
+{
+    if (m_attributes.isSharedWith(other->m_attributes)) {
+        return;
+    }
+
+    if (m_deferred.isEmpty() && other->m_deferred.isEmpty() && m_attributes == other->m_attributes
+        && m_compressed == other->m_compressed) {
+        m_attributes = other->m_attributes;
+        m_compressed = other->m_compressed;
+        return;
+    }
+
+    const QList<QString> keyList = m_attributes.keys();
+    for (const QString& key : keyList) {
+        if (m_deferred.contains(key) || other->m_deferred.contains(key)) {
+            continue;
+        }
+        if (m_compressed.contains(key) || other->m_compressed.contains(key)) {
+            auto compressed = m_compressed.find(key);
+            auto otherCompressed = other->m_compressed.constFind(key);
+            if (compressed != m_compressed.end() && otherCompressed != other->m_compressed.constEnd()
+                && *compressed == *otherCompressed) {
+                *compressed = *otherCompressed;
+            }
+            continue;
+        }
+        const QString* otherValue = asConst(other->m_attributes).find(key);
+        if (otherValue && *otherValue == *asConst(m_attributes).find(key)) {
+            *m_attributes.find(key) = *otherValue;
+        }
+    }
+}
+
 QUuid EntryAttributes::referenceUuid(const QString& key) const
 {
     if (!m_attributes.contains(key)) {
@@ -274,12 +557,41 @@ QUuid EntryAttributes::referenceUuid(const QString& key) const
 
 bool EntryAttributes::operator==(const EntryAttributes& other) const
 {
-    return (m_attributes == other.m_attributes && m_protectedAttributes == other.m_protectedAttributes);
+    // with the same compressed values, the placeholders are in the same places
+    if (m_deferred.isEmpty() && other.m_deferred.isEmpty() && m_compressed == other.m_compressed) {
+        return (m_attributes == other.m_attributes && m_protectedAttributes == other.m_protectedAttributes);
+    }
+
+    if (m_protectedAttributes != other.m_protectedAttributes || m_attributes.keys() != other.m_attributes.keys()) {
+        return false;
+    }
+
+    const QList<QString> keyList = m_attributes.keys();
+    for (const QString& key : keyList) {
+        // values still encrypted at the same stream position are identical
+        auto deferred = m_deferred.constFind(key);
+        auto otherDeferred = other.m_deferred.constFind(key);
+        if (deferred != m_deferred.constEnd() && otherDeferred != other.m_deferred.constEnd()
+            && deferred->source == otherDeferred->source && deferred->offset == otherDeferred->offset) {
+            continue;
+        }
+        auto compressed = m_compressed.constFind(key);
+        auto otherCompressed = other.m_compressed.constFind(key);
+        if (compressed != m_compressed.constEnd() && otherCompressed != other.m_compressed.constEnd()
+            && *compressed == *otherCompressed) {
+            continue;
+        }
+        if (value(key) != other.value(key)) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 bool EntryAttributes::operator!=(const EntryAttributes& other) const
 {
-    return (m_attributes != other.m_attributes || m_protectedAttributes != other.m_protectedAttributes);
+    return !(*this == other);
 }
 
 QRegularExpressionMatch EntryAttributes::matchReference(const QString& text)
@@ -295,7 +607,10 @@ void EntryAttributes::clear()
 {
     emit aboutToBeReset();
 
+    wipeSensitiveValues();
     m_attributes.clear();
+    m_deferred.clear();
+    m_compressed.clear();
     m_protectedAttributes.clear();
 
     for (const QString& key : DefaultAttributes) {
@@ -306,16 +621,317 @@ void EntryAttributes::clear()
     emit entryAttributesModified();
 }
 
+/**
+ * Store a new value, compressed if it is large and neither protected nor the password.
+ * Values that do not get smaller are kept as they are.
+ */
+void EntryAttributes::insertValue(const QString& key, const QString& value, bool protect)
+{
+    if (!protect && value.size() >= CompressionThreshold && key != PasswordKey) {
+        const CompressedValue compressed = compressValue(value);
+        if (!compressed.data.isEmpty() && compressed.data.size() < compressed.size) {
+            m_attributes.insert(key, QString());
+            m_compressed.insert(key, compressed);
+            return;
+        }
+    }
+    m_attributes.insert(key, value);
+}
+
+/**
+ * Compress a value. The value was just set, so it is cached right away.
+ */
+EntryAttributes::CompressedValue EntryAttributes::compressValue(const QString& value)
+{
+    const QByteArray utf8 = value.toUtf8();
+    CompressedValue compressed{GzipCodec::compress(utf8, CompressionLevel), utf8.size()};
+    if (!compressed.data.isEmpty() && compressed.data.size() < compressed.size) {
+        DecompressedCache::instance().insert(compressed.data, value);
+    }
+    return compressed;
+}
+
+QString EntryAttributes::decompressValue(const CompressedValue& compressed)
+{
+    QString value;
+    DecompressedCache& cache = DecompressedCache::instance();
+    if (cache.find(compressed.data, value)) {
+        return value;
+    }
+
+    QByteArray utf8;
+    if (!GzipCodec::decompress(compressed.data, utf8)) {
+        Q_ASSERT(false);
+        return {};
+    }
+    value = QString::fromUtf8(utf8);
+    cache.insert(compressed.data, value);
+    return value;
+}
+
+bool EntryAttributes::CompressedValue::operator==(const CompressedValue& other) const
+{
+    // the same compressed value, or the same text compressed twice
+    return data.constData() == other.data.constData() || data == other.data;
+}
+
+/**
+ * Zero the value of a protected attribute or the password before it is
+ * replaced or removed. Values still shared with other copies are not touched.
+ */
+void EntryAttributes::wipeValue(const QString& key)
+{
+    if (key != PasswordKey && !m_protectedAttributes.contains(key)) {
+        return;
+    }
+
+    // shared values are not wiped anyway, so do not copy them just to clear them
+    if (m_attributes.isShared()) {
+        return;
+    }
+
+    QString* value = m_attributes.find(key);
+    if (value) {
+        SecureArena::wipe(*value);
+    }
+}
+
+void EntryAttributes::wipeSensitiveValues()
+{
+    wipeDecrypted();
+    wipeValue(PasswordKey);
+    for (const QString& key : asConst(m_protectedAttributes)) {
+        wipeValue(key);
+    }
+}
+
 int EntryAttributes::attributesSize() const
 {
     int size = 0;
-    for (auto it = m_attributes.constBegin(); it != m_attributes.constEnd(); ++it) {
-        size += it.key().toUtf8().size() + it.value().toUtf8().size();
+    const QList<QString> keyList = m_attributes.keys();
+    for (const QString& key : keyList) {
+        // the ciphertext has the same length as the UTF-8 encoded value
+        auto deferred = m_deferred.constFind(key);
+        auto compressed = m_compressed.constFind(key);
+        int valueSize;
+        if (deferred != m_deferred.constEnd()) {
+            valueSize = deferred->ciphertext.size();
+        } else if (compressed != m_compressed.constEnd()) {
+            valueSize = compressed->size;
+        } else {
+            valueSize = m_attributes.value(key).toUtf8().size();
+        }
+        size += key.toUtf8().size() + valueSize;
     }
     return size;
 }
 
 bool EntryAttributes::isDefaultAttribute(const QString& key)
 {
-    return DefaultAttributes.contains(key);
+    return Values::defaultSlot(key) >= 0;
+}
+
+EntryAttributes::Values::Values()
+    : d(new Data())
+{
+}
+
+/**
+ * @return slot of a default attribute key, -1 for custom keys
+ */
+int EntryAttributes::Values::defaultSlot(const QString& key)
+{
+    // callers mostly pass the key constants themselves
+    for (int slot = 0; slot < DefaultSlotCount; ++slot) {
+        if (key.constData() == defaultKey(slot).constData()) {
+            return slot;
+        }
+    }
+    for (int slot = 0; slot < DefaultSlotCount; ++slot) {
+        if (key == defaultKey(slot)) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+/**
+ * The slots are sorted by key, so keys() can merge them with the custom keys.
+ */
+const QString& EntryAttributes::Values::defaultKey(int slot)
+{
+    switch (slot) {
+    case 0:
+        return NotesKey;
+    case 1:
+        return PasswordKey;
+    case 2:
+        return TitleKey;
+    case 3:
+        return URLKey;
+    default:
+        return UserNameKey;
+    }
+}
+
+QVector<EntryAttributes::Values::CustomValue>::const_iterator
+EntryAttributes::Values::findCustom(const QString& key) const
+{
+    const QVector<CustomValue>& custom = d->custom;
+    auto it = std::lower_bound(custom.constBegin(), custom.constEnd(), key, lessKey);
+    return it != custom.constEnd() && it->first == key ? it : custom.constEnd();
+}
+
+bool EntryAttributes::Values::contains(const QString& key) const
+{
+    return find(key) != nullptr;
+}
+
+QString EntryAttributes::Values::value(const QString& key) const
+{
+    const QString* value = find(key);
+    return value ? *value : QString();
+}
+
+const QString* EntryAttributes::Values::find(const QString& key) const
+{
+    const int slot = defaultSlot(key);
+    if (slot >= 0) {
+        return d->present & (1 << slot) ? &d->defaults[slot] : nullptr;
+    }
+
+    auto it = findCustom(key);
+    return it != d->custom.constEnd() ? &it->second : nullptr;
+}
+
+QString* EntryAttributes::Values::find(const QString& key)
+{
+    if (!asConst(*this).find(key)) {
+        return nullptr;
+    }
+
+    // detach before handing out a modifiable value
+    const int slot = defaultSlot(key);
+    if (slot >= 0) {
+        return &d->defaults[slot];
+    }
+    auto it = std::lower_bound(d->custom.begin(), d->custom.end(), key, lessKey);
+    return &it->second;
+}
+
+QList<QString> EntryAttributes::Values::keys() const
+{
+    QList<QString> keys;
+    keys.reserve(size());
+
+    int slot = 0;
+    for (const CustomValue& value : d->custom) {
+        for (; slot < DefaultSlotCount && defaultKey(slot) < value.first; ++slot) {
+            if (d->present & (1 << slot)) {
+                keys.append(defaultKey(slot));
+            }
+        }
+        keys.append(value.first);
+    }
+    for (; slot < DefaultSlotCount; ++slot) {
+        if (d->present & (1 << slot)) {
+            keys.append(defaultKey(slot));
+        }
+    }
+    return keys;
+}
+
+bool EntryAttributes::Values::containsValue(const QString& value) const
+{
+    for (int slot = 0; slot < DefaultSlotCount; ++slot) {
+        if ((d->present & (1 << slot)) && d->defaults[slot] == value) {
+            return true;
+        }
+    }
+    for (const CustomValue& customValue : d->custom) {
+        if (customValue.second == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int EntryAttributes::Values::size() const
+{
+    int size = d->custom.size();
+    for (int slot = 0; slot < DefaultSlotCount; ++slot) {
+        if (d->present & (1 << slot)) {
+            ++size;
+        }
+    }
+    return size;
+}
+
+void EntryAttributes::Values::insert(const QString& key, const QString& value)
+{
+    const int slot = defaultSlot(key);
+    if (slot >= 0) {
+        d->defaults[slot] = value;
+        d->present |= 1 << slot;
+        return;
+    }
+
+    auto it = std::lower_bound(d->custom.begin(), d->custom.end(), key, lessKey);
+    if (it != d->custom.end() && it->first == key) {
+        it->second = value;
+    } else {
+        d->custom.insert(it, qMakePair(internKey(key), value));
+    }
+}
+
+void EntryAttributes::Values::remove(const QString& key)
+{
+    if (!asConst(*this).find(key)) {
+        return;
+    }
+
+    const int slot = defaultSlot(key);
+    if (slot >= 0) {
+        d->defaults[slot].clear();
+        d->present &= ~(1 << slot);
+        return;
+    }
+    auto it = std::lower_bound(d->custom.begin(), d->custom.end(), key, lessKey);
+    d->custom.erase(it);
+}
+
+void EntryAttributes::Values::clear()
+{
+    d = new Data();
+}
+
+bool EntryAttributes::Values::isShared() const
+{
+    return d->ref.load() > 1;
+}
+
+bool EntryAttributes::Values::isSharedWith(const Values& other) const
+{
+    return d.constData() == other.d.constData();
+}
+
+bool EntryAttributes::Values::operator==(const Values& other) const
+{
+    if (isSharedWith(other)) {
+        return true;
+    }
+    if (d->present != other.d->present || d->custom != other.d->custom) {
+        return false;
+    }
+    for (int slot = 0; slot < DefaultSlotCount; ++slot) {
+        if (d->defaults[slot] != other.d->defaults[slot]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EntryAttributes::Values::operator!=(const Values& other) const
+{
+    return !(*this == other);
 }
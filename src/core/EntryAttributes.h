@@ -19,12 +19,20 @@
 #ifndef KEEPASSX_ENTRYATTRIBUTES_H
 #define KEEPASSX_ENTRYATTRIBUTES_H
 
+#include <QHash>
 #include <QMap>
+#include <QMutex>
 #include <QObject>
 #include <QRegularExpression>
+#include <QPair>
 #include <QSet>
+#include <QSharedData>
+#include <QSharedPointer>
 #include <QStringList>
 #include <QUuid>
+#include <QVector>
+
+class ProtectedValueSource;
 
 class EntryAttributes : public QObject
 {
@@ -32,6 +40,7 @@ class EntryAttributes : public QObject
 
 public:
     explicit EntryAttributes(QObject* parent = nullptr);
+    ~EntryAttributes() override;
     QList<QString> keys() const;
     bool hasKey(const QString& key) const;
     QList<QString> customKeys() const;
@@ -42,6 +51,12 @@ public:
     bool isProtected(const QString& key) const;
     bool isReference(const QString& key) const;
     void set(const QString& key, const QString& value, bool protect = false);
+    void setDeferred(const QString& key,
+                     QSharedPointer<const ProtectedValueSource> source,
+                     const QByteArray& ciphertext,
+                     quint64 offset);
+    bool isDeferred(const QString& key) const;
+    bool isCompressed(const QString& key) const;
     void remove(const QString& key);
     void rename(const QString& oldKey, const QString& newKey);
     void copyCustomKeysFrom(const EntryAttributes* other);
@@ -49,6 +64,7 @@ public:
     void clear();
     int attributesSize() const;
     void copyDataFrom(const EntryAttributes* other);
+    void shareValuesWith(const EntryAttributes* other);
     QUuid referenceUuid(const QString& key) const;
     bool operator==(const EntryAttributes& other) const;
     bool operator!=(const EntryAttributes& other) const;
@@ -64,6 +80,9 @@ public:
     static const QString RememberCmdExecAttr;
     static bool isDefaultAttribute(const QString& key);
 
+    // values of at least this many characters are kept compressed in memory
+    static const int CompressionThreshold;
+
     static const QString WantedFieldGroupName;
     static const QString SearchInGroupName;
     static const QString SearchTextGroupName;
@@ -82,7 +101,87 @@ signals:
     void reset();
 
 private:
-    QMap<QString, QString> m_attributes;
+    friend class HistoryItem;
+
+    struct DeferredValue
+    {
+        QSharedPointer<const ProtectedValueSource> source;
+        QByteArray ciphertext;
+        quint64 offset;
+    };
+
+    struct CompressedValue
+    {
+        QByteArray data;
+        // size of the UTF-8 encoded value
+        int size;
+
+        bool operator==(const CompressedValue& other) const;
+    };
+
+    /**
+     * Implicitly shared attribute values. The default attributes have fixed
+     * slots, custom ones are kept in a vector sorted by their interned keys.
+     * keys() returns the same order a QMap would.
+     */
+    class Values
+    {
+    public:
+        Values();
+        bool contains(const QString& key) const;
+        QString value(const QString& key) const;
+        const QString* find(const QString& key) const;
+        QString* find(const QString& key);
+        QList<QString> keys() const;
+        bool containsValue(const QString& value) const;
+        int size() const;
+        void insert(const QString& key, const QString& value);
+        void remove(const QString& key);
+        void clear();
+        bool isShared() const;
+        bool isSharedWith(const Values& other) const;
+        bool operator==(const Values& other) const;
+        bool operator!=(const Values& other) const;
+
+        static int defaultSlot(const QString& key);
+
+    private:
+        static const int DefaultSlotCount = 5;
+        typedef QPair<QString, QString> CustomValue;
+
+        struct Data : public QSharedData
+        {
+            QString defaults[DefaultSlotCount];
+            quint8 present = 0;
+            QVector<CustomValue> custom;
+        };
+
+        static const QString& defaultKey(int slot);
+        QVector<CustomValue>::const_iterator findCustom(const QString& key) const;
+
+        QSharedDataPointer<Data> d;
+    };
+
+    QString deferredValue(const QString& key, const DeferredValue& deferred) const;
+    void dropDecrypted(const QString& key);
+    void wipeDecrypted();
+    void insertValue(const QString& key, const QString& value, bool protect);
+    void wipeValue(const QString& key);
+    void wipeSensitiveValues();
+
+    static CompressedValue compressValue(const QString& value);
+    static QString decompressValue(const CompressedValue& compressed);
+
+    // deferred values keep an empty placeholder in m_attributes. They are
+    // decrypted into m_decrypted on first access, which is guarded by the
+    // mutex, so values can be read from several threads at once
+    Values m_attributes;
+    QMap<QString, DeferredValue> m_deferred;
+    mutable QMutex m_decryptedMutex;
+    mutable QHash<QString, QString> m_decrypted;
+    // large unprotected values also keep an empty placeholder, but stay compressed
+    // and are decompressed into a shared cache of recently used values on access
+    QMap<QString, CompressedValue> m_compressed;
     QSet<QString> m_protectedAttributes;
 };
 
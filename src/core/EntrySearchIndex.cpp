@@ -0,0 +1,320 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntrySearchIndex.h"
+
+#include "core/Entry.h"
+
+#include <algorithm>
+
+namespace
+{
+    quint64 trigramKey(const QChar* chars)
+    {
+        return (static_cast<quint64>(chars[0].unicode()) << 32) | (static_cast<quint64>(chars[1].unicode()) << 16)
+               | static_cast<quint64>(chars[2].unicode());
+    }
+
+    void addTrigrams(const QString& text, QSet<quint64>& trigrams)
+    {
+        const QString folded = text.toCaseFolded();
+        for (int i = 0; i + 3 <= folded.size(); ++i) {
+            trigrams.insert(trigramKey(folded.constData() + i));
+        }
+    }
+
+    /**
+     * Extract the literal strings every match of the pattern has to contain.
+     * Patterns with alternations, groups or escapes that are not plain
+     * characters are not analyzed since their literals may be optional.
+     *
+     * @param pattern regular expression pattern
+     * @param literals required literal strings
+     * @return false if the pattern cannot be analyzed
+     */
+    bool requiredLiterals(const QString& pattern, QStringList& literals)
+    {
+        QString current;
+        auto flush = [&] {
+            if (!current.isEmpty()) {
+                literals.append(current);
+                current.clear();
+            }
+        };
+
+        for (int i = 0; i < pattern.size(); ++i) {
+            const QChar c = pattern.at(i);
+            if (c == '\\') {
+                if (i + 1 >= pattern.size()
+                    || (pattern.at(i + 1).unicode() < 0x80 && pattern.at(i + 1).isLetterOrNumber())) {
+                    // character classes, back references or encoded characters
+                    return false;
+                }
+                current.append(pattern.at(++i));
+            } else if (c == '|' || c == '(' || c == ')') {
+                return false;
+            } else if (c == '*' || c == '?' || c == '{') {
+                // the preceding character is optional
+                current.chop(1);
+                flush();
+                if (c == '{') {
+                    i = pattern.indexOf('}', i);
+                    if (i < 0) {
+                        return false;
+                    }
+                }
+            } else if (c == '[') {
+                flush();
+                // skip the character class, a leading ']' is part of the class
+                int end = i + 1;
+                if (end < pattern.size() && pattern.at(end) == '^') {
+                    ++end;
+                }
+                if (end < pattern.size() && pattern.at(end) == ']') {
+                    ++end;
+                }
+                while (end < pattern.size() && pattern.at(end) != ']') {
+                    end += pattern.at(end) == '\\' ? 2 : 1;
+                }
+                if (end >= pattern.size()) {
+                    return false;
+                }
+                i = end;
+            } else if (c == '+' || c == '.' || c == '^' || c == '$') {
+                flush();
+            } else {
+                current.append(c);
+            }
+        }
+        flush();
+
+        return true;
+    }
+} // namespace
+
+EntrySearchIndex::EntrySearchIndex(QObject* parent)
+    : QObject(parent)
+{
+}
+
+/**
+ * Index the entry unless it is already indexed at its current revision.
+ *
+ * @param entry entry to index
+ */
+void EntrySearchIndex::update(const Entry* entry)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.constFind(entry);
+    if (it != m_entries.constEnd()) {
+        if (it->revision == entry->revision()) {
+            return;
+        }
+        remove(entry);
+    } else {
+        connect(entry, &QObject::destroyed, this, [this, entry] {
+            QMutexLocker locker(&m_mutex);
+            remove(entry);
+        });
+    }
+
+    QSet<quint64> trigrams;
+    for (const QString& value : {entry->title(), entry->username(), entry->url()}) {
+        // the searcher matches resolved placeholders, which may contain anything
+        if (value.contains('{')) {
+            m_unindexable.insert(entry);
+        }
+        addTrigrams(value, trigrams);
+    }
+    addTrigrams(entry->notes(), trigrams);
+
+    const EntryAttributes* attributes = entry->attributes();
+    for (const QString& key : attributes->customKeys()) {
+        if (attributes->isProtected(key)) {
+            m_protectedAttributes.insert(entry);
+        } else {
+            addTrigrams(attributes->value(key), trigrams);
+        }
+    }
+
+    IndexedEntry indexed;
+    indexed.revision = entry->revision();
+    indexed.trigrams.reserve(trigrams.size());
+    for (quint64 trigram : asConst(trigrams)) {
+        indexed.trigrams.append(trigram);
+        m_postings[trigram].insert(entry);
+    }
+    indexed.tags = entry->tagList();
+    for (const QString& tag : asConst(indexed.tags)) {
+        m_tags[tag].insert(entry);
+    }
+    m_entries.insert(entry, indexed);
+}
+
+/**
+ * Find the entries that may match all of the given search terms.
+ * Only entries that have been passed to update() are considered.
+ *
+ * @param terms search terms
+ * @param result candidate entries
+ * @return false if the terms cannot be used to narrow down the entries
+ */
+bool EntrySearchIndex::candidates(const QList<EntrySearcher::SearchTerm>& terms, QSet<const Entry*>& result) const
+{
+    QMutexLocker locker(&m_mutex);
+    bool filtered = false;
+    for (const auto& term : terms) {
+        QSet<const Entry*> termResult;
+        if (!termCandidates(term, termResult)) {
+            continue;
+        }
+
+        if (filtered) {
+            result.intersect(termResult);
+        } else {
+            result = termResult;
+            filtered = true;
+        }
+    }
+    return filtered;
+}
+
+/**
+ * @return number of indexed entries
+ */
+int EntrySearchIndex::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.size();
+}
+
+void EntrySearchIndex::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
+    m_entries.clear();
+    m_postings.clear();
+    m_tags.clear();
+    m_unindexable.clear();
+    m_protectedAttributes.clear();
+}
+
+void EntrySearchIndex::remove(const Entry* entry)
+{
+    auto it = m_entries.find(entry);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    for (quint64 trigram : asConst(it->trigrams)) {
+        auto posting = m_postings.find(trigram);
+        if (posting != m_postings.end()) {
+            posting->remove(entry);
+            if (posting->isEmpty()) {
+                m_postings.erase(posting);
+            }
+        }
+    }
+    for (const QString& tag : asConst(it->tags)) {
+        auto posting = m_tags.find(tag);
+        if (posting != m_tags.end()) {
+            posting->remove(entry);
+            if (posting->isEmpty()) {
+                m_tags.erase(posting);
+            }
+        }
+    }
+    m_entries.erase(it);
+    m_unindexable.remove(entry);
+    m_protectedAttributes.remove(entry);
+}
+
+bool EntrySearchIndex::termCandidates(const EntrySearcher::SearchTerm& term, QSet<const Entry*>& result) const
+{
+    if (term.exclude) {
+        return false;
+    }
+
+    if (term.field == EntrySearcher::Field::Tag) {
+        for (auto it = m_tags.constBegin(); it != m_tags.constEnd(); ++it) {
+            if (term.regex.match(it.key()).hasMatch()) {
+                result.unite(it.value());
+            }
+        }
+        return true;
+    }
+
+    bool customAttribute = false;
+    switch (term.field) {
+    case EntrySearcher::Field::Undefined:
+    case EntrySearcher::Field::Title:
+    case EntrySearcher::Field::Username:
+    case EntrySearcher::Field::Url:
+    case EntrySearcher::Field::Notes:
+        break;
+    case EntrySearcher::Field::AttributeValue:
+        if (term.word == EntryAttributes::PasswordKey) {
+            return false;
+        }
+        customAttribute = !EntryAttributes::isDefaultAttribute(term.word);
+        break;
+    default:
+        return false;
+    }
+
+    QStringList literals;
+    if (!requiredLiterals(term.regex.pattern(), literals)) {
+        return false;
+    }
+
+    QSet<quint64> trigrams;
+    for (const QString& literal : asConst(literals)) {
+        addTrigrams(literal, trigrams);
+    }
+    if (trigrams.isEmpty()) {
+        return false;
+    }
+
+    // Intersect the posting lists starting with the shortest one
+    QVector<const QSet<const Entry*>*> postings;
+    for (quint64 trigram : asConst(trigrams)) {
+        auto posting = m_postings.constFind(trigram);
+        if (posting == m_postings.constEnd()) {
+            postings.clear();
+            break;
+        }
+        postings.append(&posting.value());
+    }
+
+    if (!postings.isEmpty()) {
+        std::sort(postings.begin(), postings.end(), [](const QSet<const Entry*>* lhs, const QSet<const Entry*>* rhs) {
+            return lhs->size() < rhs->size();
+        });
+        result = *postings.first();
+        for (int i = 1; i < postings.size() && !result.isEmpty(); ++i) {
+            result.intersect(*postings.at(i));
+        }
+    }
+
+    result.unite(m_unindexable);
+    if (customAttribute) {
+        result.unite(m_protectedAttributes);
+    }
+    return true;
+}
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ENTRYSEARCHINDEX_H
+#define KEEPASSXC_ENTRYSEARCHINDEX_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QVector>
+
+#include "core/EntrySearcher.h"
+
+class Entry;
+
+/**
+ * Trigram index over the searchable, non-protected fields of entries:
+ * title, username, URL, notes and unprotected custom attribute values.
+ * Tags are indexed as a whole, a tag term only has to be matched against
+ * the distinct tags of the database.
+ *
+ * The index is only used to narrow down the entries a search has to look
+ * at, every candidate is still matched against the full search terms.
+ * Entries are (re-)indexed on demand whenever their revision changes, so
+ * the index stays valid no matter how entries are added, moved or edited.
+ * Searches of several views may use the index from different threads, all
+ * public functions are serialized.
+ */
+class EntrySearchIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EntrySearchIndex(QObject* parent = nullptr);
+
+    void update(const Entry* entry);
+    bool candidates(const QList<EntrySearcher::SearchTerm>& terms, QSet<const Entry*>& result) const;
+    int size() const;
+    void clear();
+
+private:
+    struct IndexedEntry
+    {
+        quint64 revision;
+        QVector<quint64> trigrams;
+        QStringList tags;
+    };
+
+    void remove(const Entry* entry);
+    bool termCandidates(const EntrySearcher::SearchTerm& term, QSet<const Entry*>& result) const;
+
+    mutable QMutex m_mutex;
+    QHash<const Entry*, IndexedEntry> m_entries;
+    QHash<quint64, QSet<const Entry*>> m_postings;
+    QHash<QString, QSet<const Entry*>> m_tags;
+    // entries with placeholders in resolved fields always have to be matched
+    QSet<const Entry*> m_unindexable;
+    QSet<const Entry*> m_protectedAttributes;
+};
+
+#endif // KEEPASSXC_ENTRYSEARCHINDEX_H
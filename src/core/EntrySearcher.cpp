@@ -18,14 +18,58 @@
 
 #include "EntrySearcher.h"
 
+#include "core/AsyncTask.h"
+#include "core/Clock.h"
+#include "core/Database.h"
+#include "core/EntrySearchIndex.h"
 #include "core/Group.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Smaller searches are not worth the thread pool overhead
+    const int ParallelSearchThreshold = 512;
+    const int MinChunkSize = 128;
+
+    // How well the title matches a search word, better matches are larger
+    enum TitleMatch
+    {
+        NoTitleMatch,
+        TitleSubstring,
+        TitleWordStart,
+        TitlePrefix,
+        TitleExact
+    };
+
+    // The title match decides the ranking, usage and recency only order equal title matches
+    const int TitleMatchWeight = 1000;
+    const int UsageBonusPerDoubling = 60;
+    const int MaxUsageBonus = 600;
+    const int MaxRecencyBonus = 365;
+    static_assert(MaxUsageBonus + MaxRecencyBonus < TitleMatchWeight, "bonuses must not outweigh the title match");
+
+    bool isTitleTerm(const EntrySearcher::SearchTerm& term)
+    {
+        return !term.exclude
+               && (term.field == EntrySearcher::Field::Undefined || term.field == EntrySearcher::Field::Title);
+    }
+
+    // Group 1 = modifiers, Group 2 = field, Group 3 = quoted string, Group 4 = unquoted string
+    const QRegularExpression& termParser()
+    {
+        static const QRegularExpression parser(R"re(([-!*+]+)?(?:(\w*):)?(?:(?=")"((?:[^"\\]|\\.)*)"|([^ ]*))( |$))re");
+        return parser;
+    }
+} // namespace
 
 EntrySearcher::EntrySearcher(bool caseSensitive, bool skipProtected)
     : m_caseSensitive(caseSensitive)
     , m_skipProtected(skipProtected)
-    , m_termParser(R"re(([-!*+]+)?(?:(\w*):)?(?:(?=")"((?:[^"\\]|\\.)*)"|([^ ]*))( |$))re")
-// Group 1 = modifiers, Group 2 = field, Group 3 = quoted string, Group 4 = unquoted string
+    , m_useIndex(false)
 {
 }
 
@@ -68,19 +112,160 @@ QList<Entry*> EntrySearcher::search(const QString& searchString, const Group* ba
  */
 QList<Entry*> EntrySearcher::repeat(const Group* baseGroup, bool forceSearch)
 {
+    TRACE_SCOPE("EntrySearcher::repeat");
+    Q_ASSERT(baseGroup);
+
+    return repeatEntries(searchedEntries(baseGroup, forceSearch), baseGroup->database());
+}
+
+/**
+ * Search group, and its children, by parsing the provided search string and
+ * return the best matches only. Matches are ranked by how well their title
+ * matches a search word (whole title, title prefix, start of a word in the
+ * title, anywhere in the title), then by how often and how recently they were
+ * used. Equally ranked matches keep their tree order.
+ *
+ * @param searchString search terms
+ * @param baseGroup group to start search from, cannot be null
+ * @param limit maximum number of entries to return, all matches if not positive
+ * @param forceSearch ignore group search settings
+ * @return best matching entries, best match first
+ */
+QList<Entry*>
+EntrySearcher::searchRanked(const QString& searchString, const Group* baseGroup, int limit, bool forceSearch)
+{
+    Q_ASSERT(baseGroup);
+    parseSearchTerms(searchString);
+    return repeatRanked(baseGroup, limit, forceSearch);
+}
+
+/**
+ * Repeat the last search starting from the given group and return the best
+ * matches only, see searchRanked().
+ *
+ * Only the best matches found so far are kept, an entry is scored before it
+ * is matched and skipped without matching it if it cannot replace one of them.
+ * The search ends early once none of the remaining entries could.
+ */
+QList<Entry*> EntrySearcher::repeatRanked(const Group* baseGroup, int limit, bool forceSearch)
+{
+    TRACE_SCOPE("EntrySearcher::repeatRanked");
     Q_ASSERT(baseGroup);
 
+    buildSearchPlan();
+    const QList<Entry*> entries = indexCandidates(searchedEntries(baseGroup, forceSearch), baseGroup->database());
+    if (entries.isEmpty()) {
+        return {};
+    }
+    if (limit <= 0) {
+        limit = entries.size();
+    }
+
+    const bool rankTitle = std::any_of(m_searchTerms.begin(), m_searchTerms.end(), isTitleTerm);
+    const int maxScore = (rankTitle ? TitleExact : NoTitleMatch) * TitleMatchWeight + MaxUsageBonus + MaxRecencyBonus;
+    const QDateTime now = Clock::currentDateTimeUtc();
+
+    // Score and position of the best matches, kept as a heap with the worst of them on top
+    using RankedEntry = QPair<int, int>;
+    auto better = [](const RankedEntry& lhs, const RankedEntry& rhs) {
+        return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+    };
+    QVector<RankedEntry> best;
+    best.reserve(qMin(limit, entries.size()));
+
+    for (int i = 0; i < entries.size(); ++i) {
+        if (m_cancelToken.isCancelled()) {
+            return {};
+        }
+
+        const bool full = best.size() >= limit;
+        if (full && best.first().first >= maxScore) {
+            break;
+        }
+
+        // Ties keep the tree order, so a later entry has to score higher to get in
+        const int entryScore = score(entries.at(i), now);
+        if ((full && entryScore <= best.first().first) || !searchEntryImpl(entries.at(i))) {
+            continue;
+        }
+
+        if (full) {
+            std::pop_heap(best.begin(), best.end(), better);
+            best.last() = qMakePair(entryScore, i);
+        } else {
+            best.append(qMakePair(entryScore, i));
+        }
+        std::push_heap(best.begin(), best.end(), better);
+    }
+    TRACE_COUNTER("EntrySearcher::rankedEntries", best.size());
+
+    std::sort_heap(best.begin(), best.end(), better);
     QList<Entry*> results;
+    results.reserve(best.size());
+    for (const RankedEntry& ranked : asConst(best)) {
+        results.append(entries.at(ranked.second));
+    }
+    return results;
+}
+
+/**
+ * Rank an entry against the terms of the last search, see searchRanked().
+ * The scores of different searches are not comparable.
+ *
+ * @return score of the entry, higher is better
+ */
+int EntrySearcher::score(const Entry* entry) const
+{
+    return score(entry, Clock::currentDateTimeUtc());
+}
+
+int EntrySearcher::score(const Entry* entry, const QDateTime& now) const
+{
+    const TimeInfo& timeInfo = entry->timeInfo();
+    const int usage = qMax(0, timeInfo.usageCount());
+    const int usageBonus = qMin(MaxUsageBonus, qRound(UsageBonusPerDoubling * std::log2(1.0 + usage)));
+    const qint64 days = timeInfo.lastAccessTime().daysTo(now);
+    const int recencyBonus = static_cast<int>(qBound<qint64>(0, MaxRecencyBonus - days, MaxRecencyBonus));
+    return titleScore(entry) * TitleMatchWeight + usageBonus + recencyBonus;
+}
+
+/**
+ * @return best TitleMatch of the title terms of the last search
+ */
+int EntrySearcher::titleScore(const Entry* entry) const
+{
+    const QString title = entry->resolvePlaceholder(entry->title());
+    int best = NoTitleMatch;
+    for (const SearchTerm& term : m_searchTerms) {
+        if (!isTitleTerm(term)) {
+            continue;
+        }
+
+        auto matches = term.regex.globalMatch(title);
+        while (matches.hasNext()) {
+            const auto match = matches.next();
+            const int start = match.capturedStart();
+            if (start == 0) {
+                best = qMax(best, match.capturedLength() == title.size() ? TitleExact : TitlePrefix);
+                // later matches can only start inside the title
+                break;
+            }
+            best = qMax(best, title.at(start - 1).isLetterOrNumber() ? TitleSubstring : TitleWordStart);
+        }
+    }
+    return best;
+}
+
+QList<Entry*> EntrySearcher::searchedEntries(const Group* baseGroup, bool forceSearch) const
+{
+    QList<Entry*> entries;
     for (const auto group : baseGroup->groupsRecursive(true)) {
         if (forceSearch || group->resolveSearchingEnabled()) {
-            for (const auto entry : group->entries()) {
-                if (searchEntryImpl(entry)) {
-                    results.append(entry);
-                }
-            }
+            entries.append(group->entries());
         }
     }
-    return results;
+    TRACE_COUNTER("EntrySearcher::searchedEntries", entries.size());
+    return entries;
 }
 
 /**
@@ -118,10 +303,84 @@ QList<Entry*> EntrySearcher::searchEntries(const QString& searchString, const QL
  */
 QList<Entry*> EntrySearcher::repeatEntries(const QList<Entry*>& entries)
 {
+    return repeatEntries(entries, entries.isEmpty() ? nullptr : entries.first()->database());
+}
+
+QList<Entry*> EntrySearcher::repeatEntries(const QList<Entry*>& entries, const Database* db)
+{
+    buildSearchPlan();
+    const QList<Entry*> searched = indexCandidates(entries, db);
+
+    const int threads = AsyncTask::threadPool(AsyncTask::Executor::Interactive)->maxThreadCount();
+    if (searched.size() < ParallelSearchThreshold || threads < 2) {
+        return searchRange(searched, 0, searched.size());
+    }
+
+    // Evaluate the entries in chunks on the interactive thread pool and merge
+    // the chunk results in their original order
+    const int chunkSize = qMax(MinChunkSize, searched.size() / (threads * 4));
+    QList<QFuture<QList<Entry*>>> chunks;
+    for (int begin = 0; begin < searched.size(); begin += chunkSize) {
+        const int end = qMin(begin + chunkSize, searched.size());
+        chunks.append(AsyncTask::run(AsyncTask::Executor::Interactive,
+                                     [this, &searched, begin, end] { return searchRange(searched, begin, end); }));
+    }
+
     QList<Entry*> results;
+    for (auto& chunk : chunks) {
+        results.append(chunk.result());
+    }
+    if (m_cancelToken.isCancelled()) {
+        return {};
+    }
+    return results;
+}
+
+/**
+ * Drop the entries that the search index of the database rules out for the
+ * last search, keeping the order of the others.
+ */
+QList<Entry*> EntrySearcher::indexCandidates(const QList<Entry*>& entries, const Database* db)
+{
+    if (!m_useIndex || !db) {
+        return entries;
+    }
+
+    EntrySearchIndex* index = db->searchIndex();
+    for (const auto* entry : entries) {
+        index->update(entry);
+    }
+    QSet<const Entry*> candidates;
+    if (!index->candidates(m_searchTerms, candidates)) {
+        return entries;
+    }
+
+    QList<Entry*> searched;
+    searched.reserve(candidates.size());
     for (auto* entry : entries) {
-        if (searchEntryImpl(entry)) {
-            results.append(entry);
+        if (candidates.contains(entry)) {
+            searched.append(entry);
+        }
+    }
+    return searched;
+}
+
+/**
+ * Match the entries in [begin, end) against the search terms. This only
+ * reads the entries and the searcher, so ranges can be searched in
+ * parallel as long as the database is not modified meanwhile.
+ */
+QList<Entry*> EntrySearcher::searchRange(const QList<Entry*>& entries, int begin, int end) const
+{
+    // Traced per range rather than per entry in searchEntryImpl to keep the number of events down
+    TRACE_SCOPE("EntrySearcher::searchRange");
+    QList<Entry*> results;
+    for (int i = begin; i < end; ++i) {
+        if (m_cancelToken.isCancelled()) {
+            return {};
+        }
+        if (searchEntryImpl(entries.at(i))) {
+            results.append(entries.at(i));
         }
     }
     return results;
@@ -142,19 +401,64 @@ bool EntrySearcher::isCaseSensitive() const
     return m_caseSensitive;
 }
 
-bool EntrySearcher::searchEntryImpl(const Entry* entry)
+/**
+ * Use the search index of the searched database to skip entries that
+ * cannot match. The index is updated with the searched entries first.
+ *
+ * @param state
+ */
+void EntrySearcher::setUseIndex(bool state)
+{
+    m_useIndex = state;
+}
+
+bool EntrySearcher::isUsingIndex() const
+{
+    return m_useIndex;
+}
+
+/**
+ * Set the token that aborts the following searches once it is cancelled,
+ * a cancelled search returns no entries.
+ *
+ * @param token cancellation token shared with the cancelling thread
+ */
+void EntrySearcher::setCancelToken(const CancelToken& token)
+{
+    m_cancelToken = token;
+}
+
+/**
+ * @return search terms of the last search
+ */
+const QList<EntrySearcher::SearchTerm>& EntrySearcher::searchTerms() const
+{
+    return m_searchTerms;
+}
+
+void EntrySearcher::CancelToken::cancel()
+{
+    m_cancelled->storeRelease(1);
+}
+
+bool EntrySearcher::CancelToken::isCancelled() const
 {
-    // Pre-load in case they are needed
-    auto attributes_keys = entry->attributes()->customKeys();
-    auto attributes = QStringList(attributes_keys + entry->attributes()->values(attributes_keys));
-    auto attachments = QStringList(entry->attachments()->keys());
-    // Build a group hierarchy to allow searching for e.g. /group1/subgroup*
-    auto hierarchy = entry->group()->hierarchy().join('/').prepend("/");
+    return m_cancelled->loadAcquire() != 0;
+}
+
+bool EntrySearcher::searchEntryImpl(const Entry* entry) const
+{
+    // Fields that are expensive to build are only loaded when a term needs them
+    QStringList attributes;
+    bool attributesLoaded = false;
+    QStringList attachments;
+    bool attachmentsLoaded = false;
 
     // By default, empty term matches every entry.
     // However when skipping protected fields, we will recject everything instead
     bool found = !m_skipProtected;
-    for (const auto& term : m_searchTerms) {
+    for (int index : asConst(m_searchPlan)) {
+        const SearchTerm& term = m_searchTerms.at(index);
         switch (term.field) {
         case Field::Title:
             found = term.regex.match(entry->resolvePlaceholder(entry->title())).hasMatch();
@@ -175,9 +479,18 @@ bool EntrySearcher::searchEntryImpl(const Entry* entry)
             found = term.regex.match(entry->notes()).hasMatch();
             break;
         case Field::AttributeKV:
+            if (!attributesLoaded) {
+                const auto keys = entry->attributes()->customKeys();
+                attributes = QStringList(keys + entry->attributes()->values(keys));
+                attributesLoaded = true;
+            }
             found = !attributes.filter(term.regex).empty();
             break;
         case Field::Attachment:
+            if (!attachmentsLoaded) {
+                attachments = entry->attachments()->keys();
+                attachmentsLoaded = true;
+            }
             found = !attachments.filter(term.regex).empty();
             break;
         case Field::AttributeValue:
@@ -190,11 +503,19 @@ bool EntrySearcher::searchEntryImpl(const Entry* entry)
         case Field::Group:
             // Match against the full hierarchy if the word contains a '/' otherwise just the group name
             if (term.word.contains('/')) {
-                found = term.regex.match(hierarchy).hasMatch();
+                // Build a group hierarchy to allow searching for e.g. /group1/subgroup*
+                found = term.regex.match(entry->group()->hierarchy().join('/').prepend("/")).hasMatch();
             } else {
                 found = term.regex.match(entry->group()->name()).hasMatch();
             }
             break;
+        case Field::Tag: {
+            const QStringList& tags = entry->tagList();
+            found = std::any_of(tags.begin(), tags.end(), [&term](const QString& tag) {
+                return term.regex.match(tag).hasMatch();
+            });
+            break;
+        }
         default:
             // Terms without a specific field try to match title, username, url, and notes
             found = term.regex.match(entry->resolvePlaceholder(entry->title())).hasMatch()
@@ -217,6 +538,95 @@ bool EntrySearcher::searchEntryImpl(const Entry* entry)
     return found;
 }
 
+/**
+ * Order the search terms so that the terms on cheap fields are evaluated
+ * first. Since all terms have to match, the order does not change the
+ * result, but entries are rejected before building expensive fields.
+ */
+void EntrySearcher::buildSearchPlan()
+{
+    auto cost = [](const SearchTerm& term) -> int {
+        switch (term.field) {
+        case Field::Notes:
+        case Field::AttributeValue:
+            return 0;
+        case Field::Title:
+        case Field::Username:
+        case Field::Password:
+        case Field::Url:
+        case Field::Tag:
+            return 1;
+        case Field::Group:
+            return term.word.contains('/') ? 3 : 1;
+        case Field::Attachment:
+            return 3;
+        case Field::AttributeKV:
+            return 4;
+        default:
+            // resolves title, username and url
+            return 2;
+        }
+    };
+
+    m_searchPlan.clear();
+    m_searchPlan.reserve(m_searchTerms.size());
+    for (int i = 0; i < m_searchTerms.size(); ++i) {
+        m_searchPlan.append(i);
+    }
+    std::stable_sort(m_searchPlan.begin(), m_searchPlan.end(), [&](int lhs, int rhs) {
+        return cost(m_searchTerms.at(lhs)) < cost(m_searchTerms.at(rhs));
+    });
+}
+
+/**
+ * Check whether every entry matching searchString also matches previousSearchString,
+ * so the new search only has to look at the previous results. This holds when terms
+ * are appended or a plain term is extended while typing, anything else counts as a
+ * different search.
+ */
+bool EntrySearcher::narrows(const QString& searchString, const QString& previousSearchString) const
+{
+    // modifiers, field and word of each term
+    auto splitTerms = [](const QString& string) -> QList<QStringList> {
+        QList<QStringList> terms;
+        auto results = termParser().globalMatch(string);
+        while (results.hasNext()) {
+            auto result = results.next();
+            auto word = result.captured(3);
+            if (word.isEmpty()) {
+                word = result.captured(4);
+            }
+            if (!word.isEmpty()) {
+                terms.append({result.captured(1), result.captured(2), word});
+            }
+        }
+        return terms;
+    };
+
+    const auto terms = splitTerms(searchString);
+    const auto previousTerms = splitTerms(previousSearchString);
+    if (previousTerms.isEmpty() || terms.size() < previousTerms.size()) {
+        return false;
+    }
+
+    static const QRegularExpression wildcards(R"([*?|])");
+    const auto cs = m_caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    for (int i = 0; i < previousTerms.size(); ++i) {
+        const auto& term = terms.at(i);
+        const auto& previous = previousTerms.at(i);
+        if (term == previous) {
+            continue;
+        }
+        // Only a plain substring term gets narrower when its word grows
+        if (!term.at(0).isEmpty() || !previous.at(0).isEmpty() || term.at(1) != previous.at(1)
+            || term.at(1).startsWith("_") || term.at(2).contains(wildcards) || previous.at(2).contains(wildcards)
+            || !term.at(2).contains(previous.at(2), cs)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void EntrySearcher::parseSearchTerms(const QString& searchString)
 {
     static const QList<QPair<QString, Field>> fieldnames{
@@ -226,13 +636,14 @@ void EntrySearcher::parseSearchTerms(const QString& searchString)
         {QStringLiteral("pw"), Field::Password},
         {QStringLiteral("password"), Field::Password},
         {QStringLiteral("title"), Field::Title},
+        {QStringLiteral("tag"), Field::Tag},
         {QStringLiteral("u"), Field::Username}, // u: stands for username rather than url
         {QStringLiteral("url"), Field::Url},
         {QStringLiteral("username"), Field::Username},
         {QStringLiteral("group"), Field::Group}};
 
     m_searchTerms.clear();
-    auto results = m_termParser.globalMatch(searchString);
+    auto results = termParser().globalMatch(searchString);
     while (results.hasNext()) {
         auto result = results.next();
         SearchTerm term{};
@@ -19,9 +19,14 @@
 #ifndef KEEPASSX_ENTRYSEARCHER_H
 #define KEEPASSX_ENTRYSEARCHER_H
 
+#include <QAtomicInt>
+#include <QDateTime>
 #include <QRegularExpression>
+#include <QSharedPointer>
 #include <QString>
+#include <QVector>
 
+class Database;
 class Group;
 class Entry;
 
@@ -39,7 +44,8 @@ public:
         AttributeKV,
         Attachment,
         AttributeValue,
-        Group
+        Group,
+        Tag
     };
 
     struct SearchTerm
@@ -51,6 +57,20 @@ public:
         bool exclude;
     };
 
+    /**
+     * Shared flag to abort a running search, e.g. when the search
+     * string changed. Copies of a token refer to the same flag.
+     */
+    class CancelToken
+    {
+    public:
+        void cancel();
+        bool isCancelled() const;
+
+    private:
+        QSharedPointer<QAtomicInt> m_cancelled = QSharedPointer<QAtomicInt>::create(0);
+    };
+
     explicit EntrySearcher(bool caseSensitive = false, bool skipProtected = false);
 
     QList<Entry*> search(const QList<SearchTerm>& searchTerms, const Group* baseGroup, bool forceSearch = false);
@@ -61,17 +81,38 @@ public:
     QList<Entry*> searchEntries(const QString& searchString, const QList<Entry*>& entries);
     QList<Entry*> repeatEntries(const QList<Entry*>& entries);
 
+    QList<Entry*>
+    searchRanked(const QString& searchString, const Group* baseGroup, int limit, bool forceSearch = false);
+    QList<Entry*> repeatRanked(const Group* baseGroup, int limit, bool forceSearch = false);
+    int score(const Entry* entry) const;
+
     void setCaseSensitive(bool state);
     bool isCaseSensitive() const;
+    void setUseIndex(bool state);
+    bool isUsingIndex() const;
+    void setCancelToken(const CancelToken& token);
+    const QList<SearchTerm>& searchTerms() const;
+
+    bool narrows(const QString& searchString, const QString& previousSearchString) const;
 
 private:
-    bool searchEntryImpl(const Entry* entry);
+    QList<Entry*> repeatEntries(const QList<Entry*>& entries, const Database* db);
+    QList<Entry*> searchedEntries(const Group* baseGroup, bool forceSearch) const;
+    QList<Entry*> indexCandidates(const QList<Entry*>& entries, const Database* db);
+    int titleScore(const Entry* entry) const;
+    int score(const Entry* entry, const QDateTime& now) const;
+    QList<Entry*> searchRange(const QList<Entry*>& entries, int begin, int end) const;
+    bool searchEntryImpl(const Entry* entry) const;
+    void buildSearchPlan();
     void parseSearchTerms(const QString& searchString);
 
     bool m_caseSensitive;
     bool m_skipProtected;
-    QRegularExpression m_termParser;
+    bool m_useIndex;
     QList<SearchTerm> m_searchTerms;
+    // indexes into m_searchTerms in evaluation order
+    QVector<int> m_searchPlan;
+    CancelToken m_cancelToken;
 
     friend class TestEntrySearcher;
 };
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Exporter.h"
+
+#include <QFile>
+
+#include "core/Database.h"
+#include "core/Group.h"
+
+bool Exporter::exportDatabase(const QString& filename, const QSharedPointer<const Database>& db)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_error = file.errorString();
+        return false;
+    }
+    return exportDatabase(&file, db);
+}
+
+bool Exporter::exportDatabase(QIODevice* device, const QSharedPointer<const Database>& db)
+{
+    m_error.clear();
+
+    if (!writeHeader(device, *db)) {
+        return false;
+    }
+
+    if (db->rootGroup() && !exportGroup(device, *db->rootGroup(), {})) {
+        return false;
+    }
+
+    return writeFooter(device, *db);
+}
+
+QString Exporter::errorString() const
+{
+    return m_error;
+}
+
+bool Exporter::writeFooter(QIODevice* device, const Database& db)
+{
+    Q_UNUSED(device);
+    Q_UNUSED(db);
+    return true;
+}
+
+/**
+ * @return false if the group and all of its children should be left out
+ */
+bool Exporter::includeGroup(const Group& group) const
+{
+    Q_UNUSED(group);
+    return true;
+}
+
+/**
+ * Write UTF-8 encoded data to the device.
+ *
+ * @return false and set the error string if writing failed
+ */
+bool Exporter::write(QIODevice* device, const QString& data)
+{
+    if (data.isEmpty()) {
+        return true;
+    }
+
+    if (device->write(data.toUtf8()) == -1) {
+        m_error = device->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool Exporter::exportGroup(QIODevice* device, const Group& group, QStringList path)
+{
+    if (!includeGroup(group)) {
+        return true;
+    }
+
+    path.append(group.name());
+    if (!writeGroup(device, group, path)) {
+        return false;
+    }
+
+    const auto& children = group.children();
+    for (const auto* child : children) {
+        if (child && !exportGroup(device, *child, path)) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -1,16 +1,60 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
 #ifndef KEEPASSX_EXPORTER_H
 #define KEEPASSX_EXPORTER_H
 
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
 class Database;
 class Group;
+class QIODevice;
 
+/**
+ * Base class for exporters that write a database in a plain text format.
+ *
+ * The export is streamed to the output device group by group, so only the
+ * output of a single group is held in memory at any time. Subclasses write
+ * the document header and footer and the entries of a single group; the
+ * traversal of the group tree is done here.
+ */
 class Exporter
 {
 public:
-    virtual Database* exportGroup(Group* group) = 0;
-    virtual ~Exporter()
-    {
-    }
+    virtual ~Exporter() = default;
+
+    bool exportDatabase(const QString& filename, const QSharedPointer<const Database>& db);
+    bool exportDatabase(QIODevice* device, const QSharedPointer<const Database>& db);
+    QString errorString() const;
+
+protected:
+    virtual bool writeHeader(QIODevice* device, const Database& db) = 0;
+    virtual bool writeGroup(QIODevice* device, const Group& group, const QStringList& path) = 0;
+    virtual bool writeFooter(QIODevice* device, const Database& db);
+    virtual bool includeGroup(const Group& group) const;
+
+    bool write(QIODevice* device, const QString& data);
+
+    QString m_error;
+
+private:
+    bool exportGroup(QIODevice* device, const Group& group, QStringList path);
 };
 
 #endif // KEEPASSX_EXPORTER_H
@@ -19,17 +19,225 @@
 
 #include "core/AsyncTask.h"
 
+#include <QCoreApplication>
 #include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QPointer>
+#include <QSet>
+
+#include <algorithm>
 
 #ifdef Q_OS_LINUX
 #include <sys/vfs.h>
 #endif
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    // Upper bound of the polling interval relative to the requested one
+    const int MaxPollBackOffFactor = 8;
+    // Resolution of the shared polling timer
+    const int PollTickMs = 1000;
+    // Polls started per tick, further due files wait for the next tick
+    const int MaxPollsPerTick = 4;
+
+    /**
+     * Network file systems don't deliver inotify events for remote changes,
+     * so files on them are watched by polling.
+     */
+    bool requiresPolling(const QString& directory)
+    {
+#if defined(Q_OS_LINUX)
+        struct statfs statfsBuf;
+        const unsigned long NFS_SUPER_MAGIC = 0x6969;
+
+        const unsigned long SMB_SUPER_MAGIC = 0x517B;
+        const unsigned long CIFS_MAGIC_NUMBER = 0xFF534D42;
+        const unsigned long SMB2_MAGIC_NUMBER = 0xFE534D42;
+
+        if (!statfs(directory.toLocal8Bit().constData(), &statfsBuf)) {
+            auto type = static_cast<unsigned long>(statfsBuf.f_type);
+            return type == NFS_SUPER_MAGIC || type == SMB_SUPER_MAGIC || type == CIFS_MAGIC_NUMBER
+                   || type == SMB2_MAGIC_NUMBER;
+        }
+        // if we can't get the fs type let's fall back to polling
+        return true;
+#else
+        Q_UNUSED(directory);
+        return false;
+#endif
+    }
+} // namespace
+
+/**
+ * Shared state of all file watchers.
+ *
+ * Native watches are reference counted per path, the file system type is
+ * looked up once per directory and a single timer polls all watched files.
+ * Each tick starts the checks of a few due files, at most one per directory,
+ * so files on the same share are not hashed at the same time.
+ */
+class FileWatchScheduler : public QObject
+{
+public:
+    static FileWatchScheduler* instance(bool create = true);
+
+    bool isPollingDirectory(const QString& directory);
+    void watch(FileWatcher* watcher, const QString& path);
+    void unwatch(FileWatcher* watcher, const QString& path);
+    void schedulePoll(FileWatcher* watcher, const QString& path, int intervalMs, int delayMs);
+    void unschedulePoll(FileWatcher* watcher);
+
+private:
+    struct Poll
+    {
+        QString directory;
+        int intervalMs;
+        qint64 due;
+    };
+
+    explicit FileWatchScheduler(QObject* parent);
+    void handleFileChanged(const QString& path);
+    void pollDue();
+
+    QFileSystemWatcher m_nativeWatcher;
+    QFileSystemWatcher m_pollingWatcher;
+    QMultiHash<QString, FileWatcher*> m_watchers;
+    QHash<QString, bool> m_pollingDirectories;
+    QHash<FileWatcher*, Poll> m_polls;
+    QTimer m_pollTimer;
+};
+
+FileWatchScheduler::FileWatchScheduler(QObject* parent)
+    : QObject(parent)
+{
+#if defined(Q_OS_LINUX)
+    m_pollingWatcher.setObjectName(QLatin1String("_qt_autotest_force_engine_poller"));
+#endif
+    connect(&m_nativeWatcher, &QFileSystemWatcher::fileChanged, this, &FileWatchScheduler::handleFileChanged);
+    connect(&m_pollingWatcher, &QFileSystemWatcher::fileChanged, this, &FileWatchScheduler::handleFileChanged);
+    connect(&m_pollTimer, &QTimer::timeout, this, &FileWatchScheduler::pollDue);
+    m_pollTimer.setInterval(PollTickMs);
+}
+
+/**
+ * The scheduler lives as long as the application.
+ *
+ * @param create create the scheduler if it does not exist yet
+ * @return scheduler, nullptr if it was not created or is already destroyed
+ */
+FileWatchScheduler* FileWatchScheduler::instance(bool create)
+{
+    static QPointer<FileWatchScheduler> scheduler;
+    static bool created = false;
+    if (!created && create) {
+        created = true;
+        scheduler = new FileWatchScheduler(QCoreApplication::instance());
+    }
+    return scheduler;
+}
+
+bool FileWatchScheduler::isPollingDirectory(const QString& directory)
+{
+    auto it = m_pollingDirectories.constFind(directory);
+    if (it == m_pollingDirectories.constEnd()) {
+        it = m_pollingDirectories.insert(directory, requiresPolling(directory));
+    }
+    return it.value();
+}
+
+void FileWatchScheduler::watch(FileWatcher* watcher, const QString& path)
+{
+    if (!m_watchers.contains(path)) {
+        if (isPollingDirectory(QFileInfo(path).absolutePath())) {
+            m_pollingWatcher.addPath(path);
+        } else {
+            m_nativeWatcher.addPath(path);
+        }
+    }
+    m_watchers.insert(path, watcher);
+}
+
+void FileWatchScheduler::unwatch(FileWatcher* watcher, const QString& path)
+{
+    m_watchers.remove(path, watcher);
+    if (!m_watchers.contains(path)) {
+        if (m_pollingWatcher.files().contains(path)) {
+            m_pollingWatcher.removePath(path);
+        } else if (m_nativeWatcher.files().contains(path)) {
+            m_nativeWatcher.removePath(path);
+        }
+    }
+    unschedulePoll(watcher);
+}
+
+/**
+ * Poll the file of the watcher after the given delay and then in the given interval.
+ * Scheduling an already scheduled watcher replaces its previous schedule.
+ */
+void FileWatchScheduler::schedulePoll(FileWatcher* watcher, const QString& path, int intervalMs, int delayMs)
+{
+    m_polls.insert(watcher,
+                   {QFileInfo(path).absolutePath(), intervalMs, QDateTime::currentMSecsSinceEpoch() + delayMs});
+    if (!m_pollTimer.isActive()) {
+        m_pollTimer.start();
+    }
+}
+
+void FileWatchScheduler::unschedulePoll(FileWatcher* watcher)
+{
+    m_polls.remove(watcher);
+    if (m_polls.isEmpty()) {
+        m_pollTimer.stop();
+    }
+}
+
+void FileWatchScheduler::handleFileChanged(const QString& path)
+{
+    // Watchers may stop watching while handling the change
+    const auto watchers = m_watchers.values(path);
+    for (auto* watcher : watchers) {
+        if (m_watchers.contains(path, watcher)) {
+            watcher->handleFileSystemChange();
+        }
+    }
+}
+
+void FileWatchScheduler::pollDue()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<QPair<qint64, FileWatcher*>> due;
+    for (auto it = m_polls.constBegin(); it != m_polls.constEnd(); ++it) {
+        if (it.value().due <= now) {
+            due.append(qMakePair(it.value().due, it.key()));
+        }
+    }
+    std::sort(due.begin(), due.end());
+
+    QSet<QString> directories;
+    int started = 0;
+    for (const auto& item : due) {
+        if (started >= MaxPollsPerTick) {
+            break;
+        }
+        auto it = m_polls.find(item.second);
+        if (it == m_polls.end() || directories.contains(it.value().directory)) {
+            continue;
+        }
+        directories.insert(it.value().directory);
+        it.value().due = now + it.value().intervalMs;
+        ++started;
+        item.second->checkFileChanged();
+    }
+}
 
 FileWatcher::FileWatcher(QObject* parent)
     : QObject(parent)
 {
-    connect(&m_fileWatcher, SIGNAL(fileChanged(QString)), SLOT(checkFileChanged()));
-    connect(&m_fileChecksumTimer, SIGNAL(timeout()), SLOT(checkFileChanged()));
     connect(&m_fileChangeDelayTimer, &QTimer::timeout, this, [this] { emit fileChanged(m_filePath); });
     m_fileChangeDelayTimer.setSingleShot(true);
     m_fileIgnoreDelayTimer.setSingleShot(true);
@@ -40,33 +248,40 @@ FileWatcher::~FileWatcher()
     stop();
 }
 
-void FileWatcher::start(const QString& filePath, int checksumIntervalSeconds, int checksumSizeKibibytes)
+/**
+ * Start watching a file.
+ *
+ * The baseline checksum is read from the file unless the caller already
+ * knows it, e.g. from the bytes it just read or wrote, see checksumOf().
+ *
+ * @param filePath file to watch
+ * @param checksumIntervalSeconds polling interval, 0 to rely on notifications only
+ * @param checksumSizeKibibytes number of leading KiB to hash, -1 for the whole file
+ * @param checksum current checksum of the file or empty to read it
+ */
+void FileWatcher::start(const QString& filePath,
+                        int checksumIntervalSeconds,
+                        int checksumSizeKibibytes,
+                        const QByteArray& checksum)
 {
     stop();
 
-#if defined(Q_OS_LINUX)
-    struct statfs statfsBuf;
-    bool forcePolling = false;
-    const auto NFS_SUPER_MAGIC = 0x6969;
-
-    if (!statfs(filePath.toLocal8Bit().constData(), &statfsBuf)) {
-        forcePolling = (statfsBuf.f_type == NFS_SUPER_MAGIC);
-    } else {
-        // if we can't get the fs type let's fall back to polling
-        forcePolling = true;
-    }
-    auto objectName = forcePolling ? QLatin1String("_qt_autotest_force_engine_poller") : QLatin1String("");
-    m_fileWatcher.setObjectName(objectName);
-#endif
-
-    m_fileWatcher.addPath(filePath);
+    auto scheduler = FileWatchScheduler::instance();
+    scheduler->watch(this, filePath);
     m_filePath = filePath;
+    m_forcePolling = scheduler->isPollingDirectory(QFileInfo(filePath).absolutePath());
 
     // Handle file checksum
     m_fileChecksumSizeBytes = checksumSizeKibibytes * 1024;
-    m_fileChecksum = calculateChecksum();
-    if (checksumIntervalSeconds > 0) {
-        m_fileChecksumTimer.start(checksumIntervalSeconds * 1000);
+    m_fileSignature = readSignature();
+    m_fileChecksum = checksum.isEmpty() ? calculateChecksum() : checksum;
+    m_pollIntervalMs = checksumIntervalSeconds * 1000;
+    m_currentPollIntervalMs = m_pollIntervalMs;
+    if (m_pollIntervalMs > 0) {
+        // Spread the first polls of files watched at the same time over the interval
+        auto spread = static_cast<uint>(m_pollIntervalMs / 2 + 1);
+        int delay = m_pollIntervalMs / 2 + static_cast<int>(qHash(filePath) % spread);
+        scheduler->schedulePoll(this, m_filePath, m_pollIntervalMs, delay);
     }
 
     m_ignoreFileChange = false;
@@ -74,12 +289,15 @@ void FileWatcher::start(const QString& filePath, int checksumIntervalSeconds, in
 
 void FileWatcher::stop()
 {
-    if (!m_filePath.isEmpty()) {
-        m_fileWatcher.removePath(m_filePath);
+    auto scheduler = FileWatchScheduler::instance(false);
+    if (!m_filePath.isEmpty() && scheduler) {
+        scheduler->unwatch(this, m_filePath);
     }
     m_filePath.clear();
     m_fileChecksum.clear();
-    m_fileChecksumTimer.stop();
+    m_fileSignature = {};
+    m_currentPollIntervalMs = 0;
+    m_forcePolling = false;
     m_fileChangeDelayTimer.stop();
 }
 
@@ -106,9 +324,18 @@ bool FileWatcher::shouldIgnoreChanges()
 
 bool FileWatcher::hasSameFileChecksum()
 {
+    if (m_fileSignature.exists && readSignature() == m_fileSignature) {
+        return true;
+    }
     return calculateChecksum() == m_fileChecksum;
 }
 
+void FileWatcher::handleFileSystemChange()
+{
+    resetPollInterval();
+    checkFileChanged();
+}
+
 void FileWatcher::checkFileChanged()
 {
     if (shouldIgnoreChanges()) {
@@ -118,16 +345,116 @@ void FileWatcher::checkFileChanged()
     // Prevent reentrance
     m_ignoreFileChange = true;
 
-    AsyncTask::runThenCallback([=] { return calculateChecksum(); },
-                               this,
-                               [=](QByteArray checksum) {
-                                   if (checksum != m_fileChecksum) {
-                                       m_fileChecksum = checksum;
-                                       m_fileChangeDelayTimer.start(0);
-                                   }
+    FileSignature lastSignature = m_fileSignature;
+    QByteArray lastChecksum = m_fileChecksum;
+    AsyncTask::runThenCallback(
+        AsyncTask::Executor::Io,
+        [=] {
+            // Only read the file if its metadata indicates a change
+            FileSignature signature = readSignature();
+            if (signature.exists && signature == lastSignature) {
+                return qMakePair(signature, lastChecksum);
+            }
+            return qMakePair(signature, calculateChecksum());
+        },
+        this,
+        [=](const QPair<FileSignature, QByteArray>& result) {
+            if (result.first.exists) {
+                m_fileSignature = result.first;
+            }
+
+            if (result.second != m_fileChecksum) {
+                m_fileChecksum = result.second;
+                resetPollInterval();
+                m_fileChangeDelayTimer.start(0);
+            } else {
+                backOffPollInterval();
+            }
+
+            m_ignoreFileChange = false;
+        });
+}
+
+void FileWatcher::resetPollInterval()
+{
+    if (m_pollIntervalMs > 0 && !m_filePath.isEmpty() && m_currentPollIntervalMs != m_pollIntervalMs) {
+        m_currentPollIntervalMs = m_pollIntervalMs;
+        FileWatchScheduler::instance()->schedulePoll(
+            this, m_filePath, m_currentPollIntervalMs, m_currentPollIntervalMs);
+    }
+}
 
-                                   m_ignoreFileChange = false;
-                               });
+void FileWatcher::backOffPollInterval()
+{
+    // Without native change events the poll is the only way to notice a change
+    if (m_forcePolling) {
+        return;
+    }
+
+    if (m_pollIntervalMs > 0 && !m_filePath.isEmpty()) {
+        int interval = qMin(m_currentPollIntervalMs * 2, m_pollIntervalMs * MaxPollBackOffFactor);
+        if (interval != m_currentPollIntervalMs) {
+            m_currentPollIntervalMs = interval;
+            FileWatchScheduler::instance()->schedulePoll(
+                this, m_filePath, m_currentPollIntervalMs, m_currentPollIntervalMs);
+        }
+    }
+}
+
+/**
+ * Collect the metadata of the watched file without reading it.
+ * The inode and change time are only available on Unix systems.
+ *
+ * @return file signature, invalid if the file does not exist
+ */
+FileWatcher::FileSignature FileWatcher::readSignature() const
+{
+    FileSignature signature;
+
+    QFileInfo fileInfo(m_filePath);
+    if (!fileInfo.exists()) {
+        return signature;
+    }
+
+    signature.exists = true;
+    signature.size = fileInfo.size();
+    signature.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+#ifdef Q_OS_UNIX
+    struct stat statBuf;
+    if (!stat(m_filePath.toLocal8Bit().constData(), &statBuf)) {
+        signature.inode = static_cast<quint64>(statBuf.st_ino);
+        signature.changed = static_cast<qint64>(statBuf.st_ctime);
+    }
+#endif
+
+    return signature;
+}
+
+bool FileWatcher::FileSignature::operator==(const FileSignature& other) const
+{
+    return exists == other.exists && size == other.size && modified == other.modified && changed == other.changed
+           && inode == other.inode;
+}
+
+bool FileWatcher::FileSignature::operator!=(const FileSignature& other) const
+{
+    return !(*this == other);
+}
+
+/**
+ * Calculate the checksum a watcher would compute for a file with the given
+ * contents. Only the leading checksumSizeKibibytes of data are hashed, so
+ * passing the first bytes of the file is enough when the size is limited.
+ *
+ * @param data file contents, at least the hashed part of them
+ * @param checksumSizeKibibytes number of leading KiB to hash, -1 for all of data
+ * @return file checksum
+ */
+QByteArray FileWatcher::checksumOf(const QByteArray& data, int checksumSizeKibibytes)
+{
+    int size = checksumSizeKibibytes * 1024;
+    return QCryptographicHash::hash(size > 0 ? data.left(size) : data, QCryptographicHash::Sha256);
 }
 
 QByteArray FileWatcher::calculateChecksum()
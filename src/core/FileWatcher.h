@@ -18,9 +18,23 @@
 #ifndef KEEPASSXC_FILEWATCHER_H
 #define KEEPASSXC_FILEWATCHER_H
 
-#include <QFileSystemWatcher>
 #include <QTimer>
 
+class FileWatchScheduler;
+
+/**
+ * Watch a single file for changes made by other programs.
+ *
+ * Changes are picked up through native file system notifications where
+ * the file system supports them and through periodic polling. A poll only
+ * reads the file when its size, modification time or identity differ from
+ * the previous check. While the file stays unchanged the polling interval
+ * backs off, unless the file system does not send notifications and the
+ * poll is all there is.
+ *
+ * All watchers share one scheduler which holds the native watches, staggers
+ * the polls of all watched files and hashes them on a small I/O thread pool.
+ */
 class FileWatcher : public QObject
 {
     Q_OBJECT
@@ -29,11 +43,16 @@ public:
     explicit FileWatcher(QObject* parent = nullptr);
     ~FileWatcher() override;
 
-    void start(const QString& path, int checksumIntervalSeconds = 0, int checksumSizeKibibytes = -1);
+    void start(const QString& path,
+               int checksumIntervalSeconds = 0,
+               int checksumSizeKibibytes = -1,
+               const QByteArray& checksum = {});
     void stop();
 
     bool hasSameFileChecksum();
 
+    static QByteArray checksumOf(const QByteArray& data, int checksumSizeKibibytes = -1);
+
 signals:
     void fileChanged(const QString& path);
 
@@ -45,15 +64,36 @@ private slots:
     void checkFileChanged();
 
 private:
+    friend class FileWatchScheduler;
+
+    struct FileSignature
+    {
+        bool exists = false;
+        qint64 size = 0;
+        qint64 modified = 0;
+        qint64 changed = 0;
+        quint64 inode = 0;
+
+        bool operator==(const FileSignature& other) const;
+        bool operator!=(const FileSignature& other) const;
+    };
+
     QByteArray calculateChecksum();
+    FileSignature readSignature() const;
     bool shouldIgnoreChanges();
+    void handleFileSystemChange();
+    void resetPollInterval();
+    void backOffPollInterval();
 
     QString m_filePath;
-    QFileSystemWatcher m_fileWatcher;
     QByteArray m_fileChecksum;
+    FileSignature m_fileSignature;
+    int m_pollIntervalMs = 0;
+    int m_currentPollIntervalMs = 0;
+    // the file system does not deliver change events for the file
+    bool m_forcePolling = false;
     QTimer m_fileChangeDelayTimer;
     QTimer m_fileIgnoreDelayTimer;
-    QTimer m_fileChecksumTimer;
     int m_fileChecksumSizeBytes = -1;
     bool m_ignoreFileChange = false;
 };
@@ -30,8 +30,44 @@
 #include "keeshare/KeeShare.h"
 #endif
 
+#include <QTextStream>
 #include <QtConcurrent>
 
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+    // Changes whenever a group property or the tree structure changes,
+    // which invalidates the inherited properties cached by all groups
+    std::atomic<quint64> resolvedGeneration(1);
+
+    void invalidateResolvedData()
+    {
+        ++resolvedGeneration;
+    }
+
+    // Path of a group as used by Group::findGroupByPath() on the root group, e.g. "/General/"
+    QString pathFromRoot(const Group* group)
+    {
+        QString path("/");
+        for (const QString& name : group->hierarchy().mid(1)) {
+            path += name + "/";
+        }
+        return path;
+    }
+
+    bool isInSubtree(const Group* group, const Group* subtreeRoot)
+    {
+        for (; group; group = group->parentGroup()) {
+            if (group == subtreeRoot) {
+                return true;
+            }
+        }
+        return false;
+    }
+} // namespace
+
 const int Group::DefaultIconNumber = 48;
 const int Group::RecycleBinIconNumber = 43;
 const QString Group::RootAutoTypeSequence = "{USERNAME}{TAB}{PASSWORD}{ENTER}";
@@ -50,8 +86,8 @@ Group::Group()
     m_data.mergeMode = Default;
 
     connect(m_customData, SIGNAL(customDataModified()), this, SIGNAL(groupModified()));
-    connect(this, SIGNAL(groupModified()), SLOT(updateTimeinfo()));
-    connect(this, SIGNAL(groupNonDataChange()), SLOT(updateTimeinfo()));
+    connect(this, SIGNAL(groupModified()), SLOT(handleModified()));
+    connect(this, SIGNAL(groupNonDataChange()), SLOT(handleNonDataChange()));
 }
 
 Group::~Group()
@@ -59,10 +95,7 @@ Group::~Group()
     setUpdateTimeinfo(false);
     // Destroy entries and children manually so DeletedObjects can be added
     // to database.
-    const QList<Entry*> entries = m_entries;
-    for (Entry* entry : entries) {
-        delete entry;
-    }
+    deleteEntries(m_entries);
 
     const QList<Group*> children = m_children;
     for (Group* group : children) {
@@ -76,6 +109,10 @@ Group::~Group()
         m_db->addDeletedObject(delGroup);
     }
 
+    if (m_db) {
+        m_db->removeFromUuidIndex(this, m_uuid);
+    }
+
     cleanupParent();
 }
 
@@ -83,6 +120,7 @@ template <class P, class V> inline bool Group::set(P& property, const V& value)
 {
     if (property != value) {
         property = value;
+        invalidateResolvedData();
         emit groupModified();
         return true;
     } else {
@@ -103,6 +141,36 @@ void Group::updateTimeinfo()
     }
 }
 
+/**
+ * The database of the group is notified directly instead of connecting
+ * every group and entry to it, so database listeners only need a single
+ * connection to the database.
+ */
+void Group::handleModified()
+{
+    updateTimeinfo();
+    if (m_db) {
+        m_db->markAsModified();
+        emit m_db->groupModified(this);
+    }
+}
+
+void Group::emitDataChanged()
+{
+    emit groupDataChanged(this);
+    if (m_db) {
+        emit m_db->groupDataChanged(this);
+    }
+}
+
+void Group::handleNonDataChange()
+{
+    updateTimeinfo();
+    if (m_db) {
+        m_db->markNonDataChange();
+    }
+}
+
 void Group::setUpdateTimeinfo(bool value)
 {
     m_updateTimeinfo = value;
@@ -197,23 +265,7 @@ QString Group::defaultAutoTypeSequence() const
  */
 QString Group::effectiveAutoTypeSequence() const
 {
-    QString sequence;
-
-    const Group* group = this;
-    do {
-        if (group->autoTypeEnabled() == Group::Disable) {
-            return QString();
-        }
-
-        sequence = group->defaultAutoTypeSequence();
-        group = group->parentGroup();
-    } while (group && sequence.isEmpty());
-
-    if (sequence.isEmpty()) {
-        sequence = RootAutoTypeSequence;
-    }
-
-    return sequence;
+    return resolved().autoTypeSequence;
 }
 
 Group::TriState Group::autoTypeEnabled() const
@@ -244,26 +296,12 @@ Entry* Group::lastTopVisibleEntry() const
 
 bool Group::isRecycled() const
 {
-    auto group = this;
-    if (!group->database()) {
-        return false;
-    }
-
-    do {
-        if (group->m_parent && group->m_db->metadata()) {
-            if (group->m_parent == group->m_db->metadata()->recycleBin()) {
-                return true;
-            }
-        }
-        group = group->m_parent;
-    } while (group && group->m_parent && group->m_parent != group->m_db->rootGroup());
-
-    return false;
+    return resolved().recycled;
 }
-
 bool Group::isExpired() const
 {
-    return m_data.timeInfo.expires() && m_data.timeInfo.expiryTime() < Clock::currentDateTimeUtc();
+    return m_data.timeInfo.expires()
+           && m_data.timeInfo.expiryMSecs() < Clock::currentDateTimeUtc().toMSecsSinceEpoch();
 }
 
 bool Group::isEmpty() const
@@ -316,13 +354,17 @@ bool Group::equals(const Group* other, CompareItemOptions options) const
 
 void Group::setUuid(const QUuid& uuid)
 {
-    set(m_uuid, uuid);
+    const QUuid oldUuid = m_uuid;
+    if (set(m_uuid, uuid) && m_db) {
+        m_db->removeFromUuidIndex(this, oldUuid);
+        m_db->addToUuidIndex(this);
+    }
 }
 
 void Group::setName(const QString& name)
 {
     if (set(m_data.name, name)) {
-        emit groupDataChanged(this);
+        emitDataChanged();
     }
 }
 
@@ -337,7 +379,7 @@ void Group::setIcon(int iconNumber)
         m_data.iconNumber = iconNumber;
         m_data.customIcon = QUuid();
         emit groupModified();
-        emit groupDataChanged(this);
+        emitDataChanged();
     }
 }
 
@@ -347,7 +389,7 @@ void Group::setIcon(const QUuid& uuid)
         m_data.customIcon = uuid;
         m_data.iconNumber = 0;
         emit groupModified();
-        emit groupDataChanged(this);
+        emitDataChanged();
     }
 }
 
@@ -436,6 +478,8 @@ void Group::setParent(Group* parent, int index)
         return;
     }
 
+    invalidateResolvedData();
+
     if (!moveWithinDatabase) {
         cleanupParent();
         m_parent = parent;
@@ -445,18 +489,22 @@ void Group::setParent(Group* parent, int index)
             // copy custom icon to the new database
             if (!iconUuid().isNull() && parent->m_db && m_db->metadata()->hasCustomIcon(iconUuid())
                 && !parent->m_db->metadata()->hasCustomIcon(iconUuid())) {
-                parent->m_db->metadata()->addCustomIcon(iconUuid(), icon());
+                parent->m_db->metadata()->addCustomIcon(iconUuid(), m_db->metadata()->customIconData(iconUuid()));
             }
         }
         if (m_db != parent->m_db) {
-            connectDatabaseSignalsRecursive(parent->m_db);
+            setDatabaseRecursive(parent->m_db);
         }
         QObject::setParent(parent);
         emit groupAboutToAdd(this, index);
+        if (m_db) {
+            emit m_db->groupAboutToAdd(this, index);
+        }
         Q_ASSERT(index <= parent->m_children.size());
         parent->m_children.insert(index, this);
     } else {
         emit aboutToMove(this, parent, index);
+        emit m_db->groupAboutToMove(this, parent, index);
         m_parent->m_children.removeAll(this);
         m_parent = parent;
         QObject::setParent(parent);
@@ -472,8 +520,12 @@ void Group::setParent(Group* parent, int index)
 
     if (!moveWithinDatabase) {
         emit groupAdded();
+        if (m_db) {
+            emit m_db->groupAdded();
+        }
     } else {
         emit groupMoved();
+        emit m_db->groupMoved();
     }
 }
 
@@ -485,35 +537,19 @@ void Group::setParent(Database* db)
     cleanupParent();
 
     m_parent = nullptr;
-    connectDatabaseSignalsRecursive(db);
+    invalidateResolvedData();
+    setDatabaseRecursive(db);
 
     QObject::setParent(db);
 }
 
 QStringList Group::hierarchy(int height) const
 {
-    QStringList hierarchy;
-    const Group* group = this;
-    const Group* parent = m_parent;
-
-    if (height == 0) {
+    const QStringList hierarchy = resolved().hierarchy;
+    if (height < 0 || height >= hierarchy.size()) {
         return hierarchy;
     }
-
-    hierarchy.prepend(group->name());
-
-    int level = 1;
-    bool heightReached = level == height;
-
-    while (parent && !heightReached) {
-        group = group->parentGroup();
-        parent = group->parentGroup();
-        heightReached = ++level == height;
-
-        hierarchy.prepend(group->name());
-    }
-
-    return hierarchy;
+    return hierarchy.mid(hierarchy.size() - height);
 }
 
 bool Group::hasChildren() const
@@ -521,6 +557,43 @@ bool Group::hasChildren() const
     return !children().isEmpty();
 }
 
+/**
+ * Delete a group tree at once, e.g. when a database is locked. The tree is
+ * detached before anything is deleted, so the destructors neither emit
+ * signals nor update parents, indexes or deleted objects one by one.
+ *
+ * Nothing may refer to the groups and entries of the tree anymore, the
+ * database has to clear its indexes itself.
+ *
+ * @param root group without parent group to delete with all its contents
+ */
+void Group::destroyTree(Group* root)
+{
+    Q_ASSERT(root && !root->m_parent);
+    if (!root) {
+        return;
+    }
+
+    const QList<Group*> groups = root->groupsRecursive(true);
+    for (Group* group : groups) {
+        group->blockSignals(true);
+        group->m_updateTimeinfo = false;
+        for (Entry* entry : asConst(group->m_entries)) {
+            entry->blockSignals(true);
+            entry->m_updateTimeinfo = false;
+            entry->m_group = nullptr;
+        }
+        group->m_entries.clear();
+        group->m_children.clear();
+        group->m_parent = nullptr;
+        group->m_db = nullptr;
+    }
+
+    // entries and subgroups are QObject children, deleting them with
+    // their parent avoids removing each from its parent's child list
+    delete root;
+}
+
 Database* Group::database()
 {
     return m_db;
@@ -554,24 +627,30 @@ const QList<Entry*>& Group::entries() const
 QList<Entry*> Group::entriesRecursive(bool includeHistoryItems) const
 {
     QList<Entry*> entryList;
-
-    entryList.append(m_entries);
-
-    if (includeHistoryItems) {
-        for (Entry* entry : m_entries) {
-            entryList.append(entry->historyItems());
+    forEachGroupRecursive([&entryList, includeHistoryItems](const Group* group) -> bool {
+        entryList.append(group->m_entries);
+        if (includeHistoryItems) {
+            for (Entry* entry : group->m_entries) {
+                entryList.append(entry->historyItems());
+            }
         }
-    }
-
-    for (Group* group : m_children) {
-        entryList.append(group->entriesRecursive(includeHistoryItems));
-    }
-
+        return true;
+    });
     return entryList;
 }
-
 QList<Entry*> Group::referencesRecursive(const Entry* entry) const
 {
+    if (m_db) {
+        QList<Entry*> references;
+        const auto candidates = m_db->m_referencingEntries.values(entry->uuidToHex());
+        for (Entry* candidate : candidates) {
+            if (isInSubtree(candidate->group(), this) && candidate->hasReferencesTo(entry->uuid())) {
+                references.append(candidate);
+            }
+        }
+        return references;
+    }
+
     auto entries = entriesRecursive();
     return QtConcurrent::blockingFiltered(entries,
                                           [entry](const Entry* e) { return e->hasReferencesTo(entry->uuid()); });
@@ -583,6 +662,16 @@ Entry* Group::findEntryByUuid(const QUuid& uuid, bool recursive) const
         return nullptr;
     }
 
+    // Look up the database index unless the uuid is not unique, in which
+    // case the first entry in tree order has to be found
+    if (m_db && m_db->m_entriesByUuid.count(uuid) <= 1) {
+        Entry* entry = m_db->m_entriesByUuid.value(uuid);
+        if (!entry) {
+            return nullptr;
+        }
+        return (recursive ? isInSubtree(entry->group(), this) : entry->group() == this) ? entry : nullptr;
+    }
+
     auto entries = m_entries;
     if (recursive) {
         entries = entriesRecursive(false);
@@ -609,6 +698,19 @@ Entry* Group::findEntryByPath(const QString& entryPath)
     if (!normalizedEntryPath.startsWith("/") && normalizedEntryPath.contains("/")) {
         normalizedEntryPath = "/" + normalizedEntryPath;
     }
+    if (m_db && m_db->rootGroup() == this) {
+        return m_db->entryByPath(normalizedEntryPath);
+    }
+    // Descendants with the path of an entry in this group also have it in the database index
+    if (m_db && normalizedEntryPath.startsWith("/")) {
+        Entry* entry = m_db->entryByPath(pathFromRoot(this) + normalizedEntryPath.mid(1));
+        if (!entry) {
+            return nullptr;
+        }
+        if (isInSubtree(entry->group(), this)) {
+            return entry;
+        }
+    }
     return findEntryByPathRecursive(normalizedEntryPath, "/");
 }
 
@@ -696,9 +798,27 @@ Group* Group::findGroupByPath(const QString& groupPath)
             + (groupPath.endsWith("/") ? "" : "/");
         // clang-format on
     }
+    if (m_db) {
+        Group* group = m_db->groupByPath(pathFromRoot(this) + normalizedGroupPath.mid(1));
+        if (!group) {
+            return nullptr;
+        }
+        if (isInSubtree(group, this)) {
+            return group;
+        }
+    }
     return findGroupByPathRecursive(normalizedGroupPath, "/");
 }
 
+/**
+ * Changes whenever a group is renamed, added, removed or moved, so that
+ * caches depending on the tree structure can tell when they are stale.
+ */
+quint64 Group::treeGeneration()
+{
+    return resolvedGeneration;
+}
+
 Group* Group::findGroupByPathRecursive(const QString& groupPath, const QString& basePath)
 {
     // paths must be normalized
@@ -723,6 +843,18 @@ Group* Group::findGroupByPathRecursive(const QString& groupPath, const QString&
 QString Group::print(bool recursive, bool flatten, int depth)
 {
     QString response;
+    QTextStream stream(&response);
+    print(stream, recursive, flatten, depth);
+    stream.flush();
+    return response;
+}
+
+/**
+ * Write the listing of print() to a stream while visiting the groups,
+ * so that large trees are not concatenated into one string first.
+ */
+void Group::print(QTextStream& out, bool recursive, bool flatten, int depth) const
+{
     QString prefix;
 
     if (flatten) {
@@ -735,51 +867,53 @@ QString Group::print(bool recursive, bool flatten, int depth)
         prefix = QString("  ").repeated(depth);
     }
 
-    if (entries().isEmpty() && children().isEmpty()) {
-        response += prefix + tr("[empty]", "group has no children") + "\n";
-        return response;
+    if (m_entries.isEmpty() && m_children.isEmpty()) {
+        out << prefix << tr("[empty]", "group has no children") << "\n";
+        return;
     }
 
-    for (Entry* entry : entries()) {
-        response += prefix + entry->title() + "\n";
+    for (const Entry* entry : asConst(m_entries)) {
+        out << prefix << entry->title() << "\n";
     }
 
-    for (Group* innerGroup : children()) {
-        response += prefix + innerGroup->name() + "/\n";
+    for (const Group* innerGroup : asConst(m_children)) {
+        out << prefix << innerGroup->name() << "/\n";
         if (recursive) {
-            response += innerGroup->print(recursive, flatten, depth + 1);
+            innerGroup->print(out, recursive, flatten, depth + 1);
         }
     }
-
-    return response;
 }
 
 QList<const Group*> Group::groupsRecursive(bool includeSelf) const
 {
     QList<const Group*> groupList;
-    if (includeSelf) {
-        groupList.append(this);
-    }
-
-    for (const Group* group : asConst(m_children)) {
-        groupList.append(group->groupsRecursive(true));
-    }
-
+    forEachGroupRecursive(
+        [&groupList](const Group* group) -> bool {
+            groupList.append(group);
+            return true;
+        },
+        includeSelf);
     return groupList;
 }
 
 QList<Group*> Group::groupsRecursive(bool includeSelf)
 {
     QList<Group*> groupList;
-    if (includeSelf) {
-        groupList.append(this);
-    }
+    forEachGroupRecursive(
+        [&groupList](Group* group) -> bool {
+            groupList.append(group);
+            return true;
+        },
+        includeSelf);
+    return groupList;
+}
 
-    for (Group* group : asConst(m_children)) {
-        groupList.append(group->groupsRecursive(true));
+const Group* Group::skippedRecycleBin(bool skipRecycled) const
+{
+    if (!skipRecycled || !m_db || !m_db->metadata()) {
+        return nullptr;
     }
-
-    return groupList;
+    return m_db->metadata()->recycleBin();
 }
 
 QSet<QUuid> Group::customIconsRecursive() const
@@ -808,12 +942,13 @@ QList<QString> Group::usernamesRecursive(int topN) const
 {
     // Collect all usernames and sort for easy counting
     QHash<QString, int> countedUsernames;
-    for (const auto* entry : entriesRecursive()) {
+    forEachEntryRecursive([&countedUsernames](const Entry* entry) -> bool {
         const auto username = entry->username();
         if (!username.isEmpty() && !entry->isAttributeReference(EntryAttributes::UserNameKey)) {
             countedUsernames.insert(username, ++countedUsernames[username]);
         }
-    }
+        return true;
+    });
 
     // Sort username/frequency pairs by frequency and name
     QList<QPair<QString, int>> sortedUsernames;
@@ -846,6 +981,13 @@ Group* Group::findGroupByUuid(const QUuid& uuid)
         return nullptr;
     }
 
+    // Look up the database index unless the uuid is not unique, in which
+    // case the first group in tree order has to be found
+    if (m_db && m_db->m_groupsByUuid.count(uuid) <= 1) {
+        Group* group = m_db->m_groupsByUuid.value(uuid);
+        return isInSubtree(group, this) ? group : nullptr;
+    }
+
     for (Group* group : groupsRecursive(true)) {
         if (group->uuid() == uuid) {
             return group;
@@ -916,7 +1058,7 @@ Group* Group::clone(Entry::CloneFlags entryFlags, Group::CloneFlags groupFlags)
 void Group::copyDataFrom(const Group* other)
 {
     if (set(m_data, other->m_data)) {
-        emit groupDataChanged(this);
+        emitDataChanged();
     }
     m_customData->copyDataFrom(other->m_customData);
     m_lastTopVisibleEntry = other->m_lastTopVisibleEntry;
@@ -932,11 +1074,16 @@ void Group::addEntry(Entry* entry)
     m_entries << entry;
     connect(entry, SIGNAL(entryDataChanged(Entry*)), SIGNAL(entryDataChanged(Entry*)));
     if (m_db) {
-        connect(entry, SIGNAL(entryModified()), m_db, SLOT(markAsModified()));
+        m_db->addToUuidIndex(entry);
+        m_db->updateReferenceIndex(entry);
+        m_db->updateUsernameIndex(entry);
     }
 
     emit groupModified();
     emit entryAdded(entry);
+    if (m_db) {
+        emit m_db->entryAdded(entry);
+    }
 }
 
 void Group::removeEntry(Entry* entry)
@@ -946,16 +1093,110 @@ void Group::removeEntry(Entry* entry)
                QString("Group %1 does not contain %2").arg(this->name(), entry->title()).toLatin1());
 
     emit entryAboutToRemove(entry);
+    if (m_db) {
+        emit m_db->entryAboutToRemove(entry);
+    }
 
     entry->disconnect(this);
     if (m_db) {
-        entry->disconnect(m_db);
+        m_db->removeFromUuidIndex(entry, entry->uuid());
+        m_db->removeFromReferenceIndex(entry);
+        m_db->removeFromUsernameIndex(entry);
     }
     m_entries.removeAll(entry);
     emit groupModified();
     emit entryRemoved(entry);
 }
 
+/**
+ * Move entries of the same database into this group. Compared to calling
+ * Entry::setGroup() for each of them, every source group compacts its list
+ * of entries only once.
+ */
+void Group::moveEntriesHere(const QList<Entry*>& entries)
+{
+    QHash<Group*, QList<Entry*>> entriesByGroup;
+    for (Entry* entry : entries) {
+        Q_ASSERT(entry->group() && entry->group()->database() == m_db);
+        if (entry->group() != this) {
+            entriesByGroup[entry->group()].append(entry);
+        }
+    }
+
+    for (auto it = entriesByGroup.begin(); it != entriesByGroup.end(); ++it) {
+        it.key()->takeEntries(it.value());
+        for (Entry* entry : asConst(it.value())) {
+            entry->m_group = this;
+            addEntry(entry);
+            entry->QObject::setParent(this);
+            if (entry->canUpdateTimeinfo()) {
+                entry->m_data.timeInfo.setLocationChanged(Clock::currentDateTimeUtc());
+            }
+        }
+    }
+}
+
+/**
+ * Delete entries of this group and record them as deleted objects, with a
+ * single compaction of the list of entries.
+ */
+void Group::deleteEntries(const QList<Entry*>& entries)
+{
+    if (entries.isEmpty()) {
+        return;
+    }
+
+    // the list may be m_entries itself, which changes below
+    const QList<Entry*> deleted = entries;
+    takeEntries(deleted);
+    for (Entry* entry : deleted) {
+        if (m_db) {
+            m_db->addDeletedObject(entry->uuid());
+        }
+        delete entry;
+    }
+}
+
+/**
+ * Remove entries from this group without deleting them. This is the bulk
+ * version of removeEntry(): the signals and index updates happen per entry,
+ * but the list of entries is compacted once. The entries are left without a
+ * group, so the caller must either delete them or add them to a group.
+ */
+void Group::takeEntries(const QList<Entry*>& entries)
+{
+    for (Entry* entry : entries) {
+        Q_ASSERT(entry->group() == this);
+        emit entryAboutToRemove(entry);
+        if (m_db) {
+            emit m_db->entryAboutToRemove(entry);
+        }
+
+        entry->disconnect(this);
+        if (m_db) {
+            m_db->removeFromUuidIndex(entry, entry->uuid());
+            m_db->removeFromReferenceIndex(entry);
+            m_db->removeFromUsernameIndex(entry);
+        }
+    }
+
+    QSet<Entry*> removed;
+    removed.reserve(entries.size());
+    for (Entry* entry : entries) {
+        removed.insert(entry);
+    }
+    m_entries.erase(std::remove_if(m_entries.begin(),
+                                   m_entries.end(),
+                                   [&removed](Entry* entry) { return removed.contains(entry); }),
+                    m_entries.end());
+
+    emit groupModified();
+    for (Entry* entry : entries) {
+        emit entryRemoved(entry);
+        entry->m_group = nullptr;
+    }
+}
+
 void Group::moveEntryUp(Entry* entry)
 {
     int row = m_entries.indexOf(entry);
@@ -965,6 +1206,9 @@ void Group::moveEntryUp(Entry* entry)
 
     emit entryAboutToMoveUp(row);
     m_entries.move(row, row - 1);
+    if (m_db) {
+        m_db->invalidatePathIndex();
+    }
     emit entryMovedUp();
     emit groupNonDataChange();
 }
@@ -978,53 +1222,56 @@ void Group::moveEntryDown(Entry* entry)
 
     emit entryAboutToMoveDown(row);
     m_entries.move(row, row + 1);
+    if (m_db) {
+        m_db->invalidatePathIndex();
+    }
     emit entryMovedDown();
     emit groupNonDataChange();
 }
 
-void Group::connectDatabaseSignalsRecursive(Database* db)
+void Group::setDatabaseRecursive(Database* db)
 {
-    if (m_db) {
-        disconnect(m_db);
-    }
-
-    for (Entry* entry : asConst(m_entries)) {
+    if (m_db != db) {
+        invalidateResolvedData();
         if (m_db) {
-            entry->disconnect(m_db);
+            m_db->removeFromUuidIndex(this, m_uuid);
+            for (Entry* entry : asConst(m_entries)) {
+                m_db->removeFromUuidIndex(entry, entry->uuid());
+                m_db->removeFromReferenceIndex(entry);
+                m_db->removeFromUsernameIndex(entry);
+            }
         }
         if (db) {
-            connect(entry, SIGNAL(entryModified()), db, SLOT(markAsModified()));
+            db->addToUuidIndex(this);
+            for (Entry* entry : asConst(m_entries)) {
+                db->addToUuidIndex(entry);
+                db->updateReferenceIndex(entry);
+                db->updateUsernameIndex(entry);
+            }
         }
     }
 
-    if (db) {
-        // clang-format off
-        connect(this, SIGNAL(groupDataChanged(Group*)), db, SIGNAL(groupDataChanged(Group*)));
-        connect(this, SIGNAL(groupAboutToRemove(Group*)), db, SIGNAL(groupAboutToRemove(Group*)));
-        connect(this, SIGNAL(groupRemoved()), db, SIGNAL(groupRemoved()));
-        connect(this, SIGNAL(groupAboutToAdd(Group*, int)), db, SIGNAL(groupAboutToAdd(Group*,int)));
-        connect(this, SIGNAL(groupAdded()), db, SIGNAL(groupAdded()));
-        connect(this, SIGNAL(aboutToMove(Group*,Group*,int)), db, SIGNAL(groupAboutToMove(Group*,Group*,int)));
-        connect(this, SIGNAL(groupMoved()), db, SIGNAL(groupMoved()));
-        connect(this, SIGNAL(groupModified()), db, SLOT(markAsModified()));
-        connect(this, SIGNAL(groupNonDataChange()), db, SLOT(markNonDataChange()));
-        // clang-format on
-    }
-
     m_db = db;
 
     for (Group* group : asConst(m_children)) {
-        group->connectDatabaseSignalsRecursive(db);
+        group->setDatabaseRecursive(db);
     }
 }
 
 void Group::cleanupParent()
 {
     if (m_parent) {
+        invalidateResolvedData();
         emit groupAboutToRemove(this);
+        if (m_db) {
+            emit m_db->groupAboutToRemove(this);
+        }
         m_parent->m_children.removeAll(this);
         emit groupModified();
         emit groupRemoved();
+        if (m_db) {
+            emit m_db->groupRemoved();
+        }
     }
 }
 
@@ -1044,40 +1291,66 @@ void Group::recCreateDelObjects()
 
 bool Group::resolveSearchingEnabled() const
 {
-    switch (m_data.searchingEnabled) {
-    case Inherit:
-        if (!m_parent) {
-            return true;
-        } else {
-            return m_parent->resolveSearchingEnabled();
-        }
-    case Enable:
-        return true;
-    case Disable:
-        return false;
-    default:
-        Q_ASSERT(false);
-        return false;
-    }
+    return resolved().searchingEnabled;
 }
 
 bool Group::resolveAutoTypeEnabled() const
 {
-    switch (m_data.autoTypeEnabled) {
-    case Inherit:
-        if (!m_parent) {
-            return true;
-        } else {
-            return m_parent->resolveAutoTypeEnabled();
+    return resolved().autoTypeEnabled;
+}
+
+/**
+ * Resolve the properties that depend on the parent groups. The result is
+ * cached until any group or the group tree changes, so the per-entry
+ * checks while searching or matching Auto-Type windows do not walk all
+ * parents every time.
+ */
+Group::ResolvedData Group::resolved() const
+{
+    const quint64 generation = resolvedGeneration;
+    const Metadata* metadata = m_db ? m_db->metadata() : nullptr;
+    const Group* recycleBin = metadata ? metadata->recycleBin() : nullptr;
+
+    {
+        QMutexLocker locker(&m_resolvedMutex);
+        if (m_resolved.generation == generation && m_resolved.recycleBin == recycleBin) {
+            return m_resolved;
         }
-    case Enable:
-        return true;
-    case Disable:
-        return false;
-    default:
-        Q_ASSERT(false);
-        return false;
     }
+
+    ResolvedData data;
+    data.generation = generation;
+    data.recycleBin = recycleBin;
+
+    ResolvedData parent;
+    if (m_parent) {
+        parent = m_parent->resolved();
+    }
+
+    data.searchingEnabled = m_data.searchingEnabled == Inherit ? parent.searchingEnabled
+                                                                : m_data.searchingEnabled == Enable;
+    data.autoTypeEnabled = m_data.autoTypeEnabled == Inherit ? parent.autoTypeEnabled
+                                                              : m_data.autoTypeEnabled == Enable;
+
+    // The closest sequence is used unless auto-type is disabled on the way to that group
+    if (m_data.autoTypeEnabled == Disable) {
+        data.autoTypeSequence = QString();
+    } else if (!m_data.defaultAutoTypeSequence.isEmpty()) {
+        data.autoTypeSequence = m_data.defaultAutoTypeSequence;
+    } else if (m_parent) {
+        data.autoTypeSequence = parent.autoTypeSequence;
+    } else {
+        data.autoTypeSequence = RootAutoTypeSequence;
+    }
+
+    data.recycled = m_parent && metadata && (m_parent == recycleBin || parent.recycled);
+
+    data.hierarchy = parent.hierarchy;
+    data.hierarchy.append(m_data.name);
+
+    QMutexLocker locker(&m_resolvedMutex);
+    m_resolved = data;
+    return data;
 }
 
 QStringList Group::locate(const QString& locateTerm, const QString& currentPath) const
@@ -20,6 +20,7 @@
 #define KEEPASSX_GROUP_H
 
 #include <QImage>
+#include <QMutex>
 #include <QPixmap>
 #include <QPointer>
 
@@ -29,6 +30,8 @@
 #include "core/Global.h"
 #include "core/TimeInfo.h"
 
+class QTextStream;
+
 class Group : public QObject
 {
     Q_OBJECT
@@ -117,6 +120,7 @@ public:
     Entry* findEntryBySearchTerm(const QString& term, EntryReferenceType referenceType);
     Group* findGroupByUuid(const QUuid& uuid);
     Group* findGroupByPath(const QString& groupPath);
+    static quint64 treeGeneration();
     QStringList locate(const QString& locateTerm, const QString& currentPath = {"/"}) const;
     Entry* addEntryWithPath(const QString& entryPath);
     void setUuid(const QUuid& uuid);
@@ -142,6 +146,7 @@ public:
     void setParent(Group* parent, int index = -1);
     QStringList hierarchy(int height = -1) const;
     bool hasChildren() const;
+    static void destroyTree(Group* root);
 
     Database* database();
     const Database* database() const;
@@ -154,6 +159,11 @@ public:
     QList<Entry*> entriesRecursive(bool includeHistoryItems = false) const;
     QList<const Group*> groupsRecursive(bool includeSelf) const;
     QList<Group*> groupsRecursive(bool includeSelf);
+    template <typename Visitor>
+    bool forEachGroupRecursive(Visitor visitor, bool includeSelf = true, bool skipRecycled = false);
+    template <typename Visitor>
+    bool forEachGroupRecursive(Visitor visitor, bool includeSelf = true, bool skipRecycled = false) const;
+    template <typename Visitor> bool forEachEntryRecursive(Visitor visitor, bool skipRecycled = false) const;
     QSet<QUuid> customIconsRecursive() const;
     QList<QString> usernamesRecursive(int topN = -1) const;
 
@@ -162,9 +172,12 @@ public:
 
     void copyDataFrom(const Group* other);
     QString print(bool recursive = false, bool flatten = false, int depth = 0);
+    void print(QTextStream& out, bool recursive = false, bool flatten = false, int depth = 0) const;
 
     void addEntry(Entry* entry);
     void removeEntry(Entry* entry);
+    void moveEntriesHere(const QList<Entry*>& entries);
+    void deleteEntries(const QList<Entry*>& entries);
     void moveEntryUp(Entry* entry);
     void moveEntryDown(Entry* entry);
 
@@ -198,13 +211,33 @@ signals:
 
 private slots:
     void updateTimeinfo();
+    void handleModified();
+    void handleNonDataChange();
 
 private:
+    // Properties inherited from the parent groups, see resolved()
+    struct ResolvedData
+    {
+        quint64 generation = 0;
+        const Group* recycleBin = nullptr;
+        bool searchingEnabled = true;
+        bool autoTypeEnabled = true;
+        bool recycled = false;
+        QString autoTypeSequence;
+        QStringList hierarchy;
+    };
+
     template <class P, class V> bool set(P& property, const V& value);
+    ResolvedData resolved() const;
+    const Group* skippedRecycleBin(bool skipRecycled) const;
+    template <typename G, typename Visitor>
+    static bool visitGroupsRecursive(G* group, Visitor& visitor, bool includeSelf, const Group* skipped);
 
     void setParent(Database* db);
 
-    void connectDatabaseSignalsRecursive(Database* db);
+    void setDatabaseRecursive(Database* db);
+    void takeEntries(const QList<Entry*>& entries);
+    void emitDataChanged();
     void cleanupParent();
     void recCreateDelObjects();
 
@@ -224,6 +257,9 @@ private:
 
     bool m_updateTimeinfo;
 
+    mutable ResolvedData m_resolved;
+    mutable QMutex m_resolvedMutex;
+
     friend void Database::setRootGroup(Group* group);
     friend Entry::~Entry();
     friend void Entry::setGroup(Group* group);
@@ -231,4 +267,67 @@ private:
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Group::CloneFlags)
 
+/**
+ * Visit this group and its descendants depth-first in the same order as
+ * groupsRecursive() without building a list. The visitor returns false to
+ * stop the iteration and must not add or remove groups.
+ *
+ * @param visitor callable taking a group and returning whether to continue
+ * @param includeSelf visit this group as well
+ * @param skipRecycled skip the recycle bin and its descendants
+ * @return false if the visitor stopped the iteration
+ */
+template <typename Visitor> bool Group::forEachGroupRecursive(Visitor visitor, bool includeSelf, bool skipRecycled)
+{
+    return visitGroupsRecursive(this, visitor, includeSelf, skippedRecycleBin(skipRecycled));
+}
+
+template <typename Visitor>
+bool Group::forEachGroupRecursive(Visitor visitor, bool includeSelf, bool skipRecycled) const
+{
+    return visitGroupsRecursive(this, visitor, includeSelf, skippedRecycleBin(skipRecycled));
+}
+
+/**
+ * Visit the entries of this group and its descendants in the same order
+ * as entriesRecursive() without building a list. The visitor returns
+ * false to stop the iteration and must not add or remove entries.
+ *
+ * @param visitor callable taking an entry and returning whether to continue
+ * @param skipRecycled skip the entries in the recycle bin and its descendants
+ * @return false if the visitor stopped the iteration
+ */
+template <typename Visitor> bool Group::forEachEntryRecursive(Visitor visitor, bool skipRecycled) const
+{
+    return forEachGroupRecursive(
+        [&visitor](const Group* group) -> bool {
+            for (Entry* entry : group->m_entries) {
+                if (!visitor(entry)) {
+                    return false;
+                }
+            }
+            return true;
+        },
+        true,
+        skipRecycled);
+}
+
+template <typename G, typename Visitor>
+bool Group::visitGroupsRecursive(G* group, Visitor& visitor, bool includeSelf, const Group* skipped)
+{
+    if (group == skipped) {
+        return true;
+    }
+    if (includeSelf && !visitor(group)) {
+        return false;
+    }
+    const QList<Group*>& childGroups = group->m_children;
+    for (Group* child : childGroups) {
+        if (!visitGroupsRecursive<G>(child, visitor, true, skipped)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 #endif // KEEPASSX_GROUP_H
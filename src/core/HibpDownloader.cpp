@@ -21,11 +21,54 @@
 #include "core/NetworkManager.h"
 
 #include <QCryptographicHash>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QUrl>
 #include <QtNetwork>
 
 namespace
 {
+    // Cached ranges are reused for a day
+    const qint64 CACHE_TTL_SECS = 24 * 60 * 60;
+
+    QString cachePath(const QString& prefix)
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/hibp/" + prefix;
+    }
+
+    /*
+     * Return the cached HIBP range of the hash prefix, or a null
+     * array if it is not cached or has expired.
+     */
+    QByteArray readCachedRange(const QString& prefix)
+    {
+        QFileInfo info(cachePath(prefix));
+        if (!info.exists() || info.lastModified().secsTo(QDateTime::currentDateTime()) > CACHE_TTL_SECS) {
+            return {};
+        }
+
+        QFile file(info.filePath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            return {};
+        }
+        auto range = file.readAll();
+        return range.isEmpty() ? QByteArray() : range;
+    }
+
+    void writeCachedRange(const QString& prefix, const QByteArray& range)
+    {
+        const auto path = cachePath(prefix);
+        if (!QDir().mkpath(QFileInfo(path).path())) {
+            return;
+        }
+
+        QSaveFile file(path);
+        if (file.open(QIODevice::WriteOnly) && file.write(range) == range.size()) {
+            file.commit();
+        }
+    }
+
     /*
      * Return the SHA1 hash of the specified password in upper-case hex.
      *
@@ -95,27 +138,68 @@ void HibpDownloader::add(const QString& password)
  */
 void HibpDownloader::validate()
 {
-    for (auto password : m_pwdsToTry) {
-        // The URL we query is https://api.pwnedpasswords.com/range/XXXXX,
-        // where XXXXX is the first five bytes of the hex representation of
-        // the password's SHA1.
-        const auto url = QString("https://api.pwnedpasswords.com/range/") + sha1Hex(password).left(5);
+    // The URL we query is https://api.pwnedpasswords.com/range/XXXXX,
+    // where XXXXX is the first five bytes of the hex representation of
+    // the password's SHA1. Passwords with the same prefix share a request.
+    for (const auto& password : asConst(m_pwdsToTry)) {
+        const auto prefix = sha1Hex(password).left(5);
+        if (!m_pwdsByPrefix.contains(prefix)) {
+            m_prefixesToFetch << prefix;
+        }
+        m_pwdsByPrefix[prefix] << password;
+        ++m_pwdsRemaining;
+    }
+
+    m_pwdsToTry.clear();
+    startRequests();
+}
+
+/*
+ * Submit requests for the pending prefixes, the network scheduler limits
+ * how many of them run at once. Prefixes with a cached range are answered
+ * right away.
+ */
+void HibpDownloader::startRequests()
+{
+    while (!m_prefixesToFetch.isEmpty()) {
+        const auto prefix = m_prefixesToFetch.takeFirst();
+
+        const auto cachedRange = readCachedRange(prefix);
+        if (!cachedRange.isNull()) {
+            processRange(prefix, cachedRange);
+            continue;
+        }
 
         // HIBP requires clients to specify a user agent in the request
         // (https://haveibeenpwned.com/API/v3#UserAgent); however, in order
         // to minimize the amount of information we expose about ourselves,
         // we don't add the KeePassXC version number or platform.
-        auto request = QNetworkRequest(url);
+        auto request = QNetworkRequest(QUrl(QString("https://api.pwnedpasswords.com/range/") + prefix));
         request.setRawHeader("User-Agent", "KeePassXC");
+        // The ranges are cached by this class already, keep them out of the shared disk cache
+        request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
 
         // Finally, submit the request to HIBP.
-        auto reply = getNetMgr()->get(request);
-        connect(reply, &QNetworkReply::finished, this, &HibpDownloader::fetchFinished);
-        connect(reply, &QIODevice::readyRead, this, &HibpDownloader::fetchReadyRead);
-        m_replies.insert(reply, {password, {}});
+        scheduleNetworkGet(request, NetworkPriority::Normal, this, [this, prefix](QNetworkReply* reply) {
+            connect(reply, &QNetworkReply::finished, this, &HibpDownloader::fetchFinished);
+            connect(reply, &QIODevice::readyRead, this, &HibpDownloader::fetchReadyRead);
+            m_replies.insert(reply, {prefix, {}});
+        });
     }
+}
 
-    m_pwdsToTry.clear();
+/*
+ * Send the results of all passwords waiting for the range of the prefix.
+ */
+void HibpDownloader::processRange(const QString& prefix, const QByteArray& range)
+{
+    const auto passwords = m_pwdsByPrefix.take(prefix);
+    m_pwdsRemaining -= passwords.size();
+
+    const auto rangeText = QString::fromLatin1(range);
+    for (const auto& password : passwords) {
+        emit hibpResult(password, pwnCount(password, rangeText));
+    }
 }
 
 int HibpDownloader::passwordsToValidate() const
@@ -125,7 +209,7 @@ int HibpDownloader::passwordsToValidate() const
 
 int HibpDownloader::passwordsRemaining() const
 {
-    return m_replies.size();
+    return m_pwdsRemaining;
 }
 
 /*
@@ -133,11 +217,15 @@ int HibpDownloader::passwordsRemaining() const
  */
 void HibpDownloader::abort()
 {
+    cancelNetworkRequests(this);
     for (auto reply : m_replies.keys()) {
         reply->abort();
         reply->deleteLater();
     }
     m_replies.clear();
+    m_prefixesToFetch.clear();
+    m_pwdsByPrefix.clear();
+    m_pwdsRemaining = 0;
 }
 
 /*
@@ -167,7 +255,7 @@ void HibpDownloader::fetchFinished()
     const auto ok = reply->error() == QNetworkReply::NoError;
     const auto err = reply->errorString();
 
-    const auto password = entry->first;
+    const auto prefix = entry->first;
     const auto hibpReply = entry->second;
 
     reply->deleteLater();
@@ -185,6 +273,7 @@ void HibpDownloader::fetchFinished()
         return;
     }
 
-    // Current password validated, send the result to the caller
-    emit hibpResult(password, pwnCount(password, hibpReply));
+    // Passwords of this prefix validated, send the results to the caller
+    writeCachedRange(prefix, hibpReply);
+    processRange(prefix, hibpReply);
 }
@@ -37,6 +37,10 @@ class QNetworkReply;
  * Usage: Pass the password to check to the ctor and process
  * the `finished` signal to get the result. Process the
  * `failed` signal to handle errors.
+ *
+ * Passwords sharing a hash prefix are checked with a single request,
+ * the requests are limited by the shared network scheduler, and the
+ * responses are cached on disk for a day.
  */
 class HibpDownloader : public QObject
 {
@@ -63,10 +67,14 @@ private slots:
     void fetchReadyRead();
 
 private:
-    void fetchPassword(const QString& password);
+    void startRequests();
+    void processRange(const QString& prefix, const QByteArray& range);
 
     QStringList m_pwdsToTry; // The list of remaining passwords to validate
-    QHash<QNetworkReply*, QPair<QString, QByteArray>> m_replies;
+    QStringList m_prefixesToFetch; // Hash prefixes not requested yet
+    QHash<QString, QStringList> m_pwdsByPrefix; // Passwords waiting for the range of their prefix
+    int m_pwdsRemaining = 0;
+    QHash<QNetworkReply*, QPair<QString, QByteArray>> m_replies; // Prefix and data of each request
 };
 
 #endif // KEEPASSXC_HIBPDOWNLOADER_H
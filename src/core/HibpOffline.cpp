@@ -18,8 +18,13 @@
 #include "HibpOffline.h"
 
 #include <QCryptographicHash>
-#include <QMultiHash>
+#include <QFile>
 #include <QProcess>
+#include <QVector>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
 
 #include "core/Database.h"
 #include "core/Group.h"
@@ -27,6 +32,18 @@
 namespace HibpOffline
 {
     const std::size_t SHA1_BYTES = 20;
+    const int MIN_INDEX_HASH_BYTES = 4;
+
+    // Index layout: header, prefix table, then the sorted records. Each
+    // record is a truncated hash followed by its count. All integers are
+    // stored in little endian.
+    const char INDEX_MAGIC[] = "KPXCHIBP";
+    const int INDEX_MAGIC_SIZE = 8;
+    const quint32 INDEX_VERSION = 1;
+    const int INDEX_HEADER_SIZE = INDEX_MAGIC_SIZE + 4 + 4 + 8;
+    const int INDEX_PREFIXES = 1 << 16;
+    const int INDEX_TABLE_SIZE = (INDEX_PREFIXES + 1) * 8;
+    const int INDEX_COUNT_SIZE = 4;
 
     enum class ParseResult
     {
@@ -35,64 +52,214 @@ namespace HibpOffline
         Error
     };
 
-    ParseResult parseHibpLine(QIODevice& input, QByteArray& sha1, int& count)
+    /**
+     * Scanner for HIBP text files. The input is read in large blocks and
+     * the lines are parsed in place, which keeps the scan bound by I/O.
+     */
+    class TextScanner
     {
-        QByteArray hexSha1(SHA1_BYTES * 2, '\0');
-        const qint64 rc = input.read(hexSha1.data(), hexSha1.size());
-        if (rc == 0) {
-            return ParseResult::Eof;
-        } else if (rc != hexSha1.size()) {
-            return ParseResult::Error;
+    public:
+        explicit TextScanner(QIODevice& input)
+            : m_input(input)
+            , m_buffer(BLOCK_SIZE, Qt::Uninitialized)
+        {
         }
 
-        sha1 = QByteArray::fromHex(hexSha1);
+        ParseResult next();
 
-        char c;
-        if (!input.getChar(&c) || c != ':') {
-            return ParseResult::Error;
+        const char* sha1() const
+        {
+            return m_sha1;
         }
 
-        count = 0;
+        int count() const
+        {
+            return m_count;
+        }
+
+    private:
+        ParseResult parseLine(const char* line, int length);
+
+        static const int BLOCK_SIZE = 1024 * 1024;
+
+        QIODevice& m_input;
+        QByteArray m_buffer;
+        int m_begin = 0;
+        int m_end = 0;
+        bool m_eof = false;
+        char m_sha1[SHA1_BYTES] = {};
+        int m_count = 0;
+    };
+
+    ParseResult TextScanner::next()
+    {
         while (true) {
-            if (!input.getChar(&c)) {
-                return ParseResult::Error;
+            const char* data = m_buffer.constData();
+            const auto* newline = static_cast<const char*>(std::memchr(data + m_begin, '\n', m_end - m_begin));
+
+            int lineBegin = m_begin;
+            int lineEnd;
+            if (newline) {
+                lineEnd = static_cast<int>(newline - data);
+                m_begin = lineEnd + 1;
+            } else if (m_eof) {
+                if (m_begin == m_end) {
+                    return ParseResult::Eof;
+                }
+                // Last line without a line break
+                lineEnd = m_end;
+                m_begin = m_end;
+            } else {
+                // Move the partial line to the front and read the next block
+                if (m_begin > 0) {
+                    std::memmove(m_buffer.data(), data + m_begin, m_end - m_begin);
+                    m_end -= m_begin;
+                    m_begin = 0;
+                }
+                if (m_end == m_buffer.size()) {
+                    return ParseResult::Error;
+                }
+                const qint64 rc = m_input.read(m_buffer.data() + m_end, m_buffer.size() - m_end);
+                if (rc < 0) {
+                    return ParseResult::Error;
+                }
+                m_eof = (rc == 0);
+                m_end += static_cast<int>(rc);
+                continue;
             }
 
-            if (c == '\n' || c == '\r') {
-                break;
+            while (lineEnd > lineBegin && data[lineEnd - 1] == '\r') {
+                --lineEnd;
             }
+            if (lineEnd > lineBegin) {
+                return parseLine(data + lineBegin, lineEnd - lineBegin);
+            }
+        }
+    }
+
+    ParseResult TextScanner::parseLine(const char* line, int length)
+    {
+        // A line is 40 hex digits, a colon and a count
+        const int hexLength = SHA1_BYTES * 2;
+        if (length <= hexLength || line[hexLength] != ':') {
+            return ParseResult::Error;
+        }
+
+        // Table driven decoding, invalid digits map to a value with the high bits set
+        static const QVector<quint8> hexValues = []() -> QVector<quint8> {
+            QVector<quint8> values(256, 0xF0);
+            for (int i = 0; i < 10; ++i) {
+                values['0' + i] = static_cast<quint8>(i);
+            }
+            for (int i = 0; i < 6; ++i) {
+                values['a' + i] = values['A' + i] = static_cast<quint8>(10 + i);
+            }
+            return values;
+        }();
+
+        const auto* hex = reinterpret_cast<const uchar*>(line);
+        quint8 invalid = 0;
+        for (std::size_t i = 0; i < SHA1_BYTES; ++i) {
+            const quint8 high = hexValues[hex[2 * i]];
+            const quint8 low = hexValues[hex[2 * i + 1]];
+            invalid |= high | low;
+            m_sha1[i] = static_cast<char>((high << 4) | low);
+        }
+        if (invalid & 0xF0) {
+            return ParseResult::Error;
+        }
 
+        m_count = 0;
+        for (int i = hexLength + 1; i < length; ++i) {
+            const char c = line[i];
             if (!('0' <= c && c <= '9')) {
                 return ParseResult::Error;
             }
 
-            count *= 10;
-            count += (c - '0');
+            m_count *= 10;
+            m_count += (c - '0');
         }
 
-        while (1 == input.peek(&c, 1) && (c == '\n' || c == '\r')) {
-            input.getChar(&c);
+        return ParseResult::Ok;
+    }
+
+    int hashPrefix(const char* hash)
+    {
+        return (static_cast<uchar>(hash[0]) << 8) | static_cast<uchar>(hash[1]);
+    }
+
+    /**
+     * Sort the records in place and merge the duplicates that truncating the
+     * hashes may produce, keeping the highest count.
+     */
+    void sortRecords(QByteArray& records, int recordSize, int hashBytes)
+    {
+        const int recordCount = records.size() / recordSize;
+        const char* data = records.constData();
+
+        QVector<int> order(recordCount);
+        for (int i = 0; i < recordCount; ++i) {
+            order[i] = i;
         }
+        std::sort(order.begin(), order.end(), [data, recordSize, hashBytes](int a, int b) {
+            return std::memcmp(data + a * recordSize, data + b * recordSize, hashBytes) < 0;
+        });
 
-        return ParseResult::Ok;
+        QByteArray sorted;
+        sorted.reserve(records.size());
+        for (int index : asConst(order)) {
+            const char* record = data + index * recordSize;
+            const int last = sorted.size() - recordSize;
+            if (last >= 0 && std::memcmp(sorted.constData() + last, record, hashBytes) == 0) {
+                auto* count = reinterpret_cast<uchar*>(sorted.data() + last + hashBytes);
+                const quint32 merged = std::max(qFromLittleEndian<quint32>(count),
+                                                qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(record) + hashBytes));
+                qToLittleEndian(merged, count);
+            } else {
+                sorted.append(record, recordSize);
+            }
+        }
+        records = sorted;
     }
 
     bool
     report(QSharedPointer<Database> db, QIODevice& hibpInput, QList<QPair<const Entry*, int>>& findings, QString* error)
     {
-        QMultiHash<QByteArray, const Entry*> entriesBySha1;
-        for (const auto* entry : db->rootGroup()->entriesRecursive()) {
-            if (!entry->isRecycled()) {
+        QVector<QPair<QByteArray, const Entry*>> hashes;
+        db->rootGroup()->forEachEntryRecursive(
+            [&hashes](const Entry* entry) -> bool {
                 const auto sha1 = QCryptographicHash::hash(entry->password().toUtf8(), QCryptographicHash::Sha1);
-                entriesBySha1.insert(sha1, entry);
-            }
-        }
+                hashes.append({sha1, entry});
+                return true;
+            },
+            true);
+        return report(hashes, hibpInput, findings, error);
+    }
 
-        QByteArray sha1;
-        for (quint64 lineNum = 1;; ++lineNum) {
-            int count = 0;
+    bool report(QVector<QPair<QByteArray, const Entry*>> entriesBySha1,
+                QIODevice& hibpInput,
+                QList<QPair<const Entry*, int>>& findings,
+                QString* error)
+    {
+        // Database hashes sorted for a merge join with the file, which is ordered by hash
+        std::stable_sort(entriesBySha1.begin(),
+                         entriesBySha1.end(),
+                         [](const QPair<QByteArray, const Entry*>& a, const QPair<QByteArray, const Entry*>& b) {
+                             return a.first < b.first;
+                         });
+        auto compareSha1 = [](const QPair<QByteArray, const Entry*>& a, const char* sha1) {
+            return std::memcmp(a.first.constData(), sha1, SHA1_BYTES);
+        };
+        auto lessSha1 = [&compareSha1](const QPair<QByteArray, const Entry*>& a, const char* sha1) {
+            return compareSha1(a, sha1) < 0;
+        };
 
-            switch (parseHibpLine(hibpInput, sha1, count)) {
+        TextScanner scanner(hibpInput);
+        char previous[SHA1_BYTES] = {};
+        bool ordered = true;
+        int next = 0;
+        for (quint64 lineNum = 1;; ++lineNum) {
+            switch (scanner.next()) {
             case ParseResult::Eof:
                 return true;
             case ParseResult::Error:
@@ -102,8 +269,26 @@ namespace HibpOffline
                 break;
             }
 
-            for (const auto* entry : entriesBySha1.values(sha1)) {
-                findings.append({entry, count});
+            const char* sha1 = scanner.sha1();
+            if (ordered && std::memcmp(sha1, previous, SHA1_BYTES) < 0) {
+                // Files that are not ordered by hash fall back to a binary search per line
+                ordered = false;
+            }
+
+            int match;
+            if (ordered) {
+                while (next < entriesBySha1.size() && lessSha1(entriesBySha1[next], sha1)) {
+                    ++next;
+                }
+                match = next;
+                std::memcpy(previous, sha1, SHA1_BYTES);
+            } else {
+                const auto it = std::lower_bound(entriesBySha1.constBegin(), entriesBySha1.constEnd(), sha1, lessSha1);
+                match = static_cast<int>(it - entriesBySha1.constBegin());
+            }
+
+            for (; match < entriesBySha1.size() && compareSha1(entriesBySha1[match], sha1) == 0; ++match) {
+                findings.append({entriesBySha1[match].second, scanner.count()});
             }
         }
     }
@@ -148,4 +333,233 @@ namespace HibpOffline
 
         return true;
     }
+
+    bool convert(QIODevice& hibpInput, QFileDevice& output, int hashBytes, QString* error)
+    {
+        if (hashBytes < MIN_INDEX_HASH_BYTES || hashBytes > static_cast<int>(SHA1_BYTES)) {
+            *error = QObject::tr("Invalid hash length %1, must be between %2 and %3 bytes")
+                         .arg(hashBytes)
+                         .arg(MIN_INDEX_HASH_BYTES)
+                         .arg(static_cast<int>(SHA1_BYTES));
+            return false;
+        }
+
+        const int recordSize = hashBytes + INDEX_COUNT_SIZE;
+        const qint64 recordsStart = INDEX_HEADER_SIZE + INDEX_TABLE_SIZE;
+        auto writeError = [&output, error]() -> bool {
+            *error = QObject::tr("Failed to write HIBP index: %1").arg(output.errorString());
+            return false;
+        };
+
+        // The header and the prefix table are written once all records are known
+        if (!output.resize(0) || output.write(QByteArray(static_cast<int>(recordsStart), '\0')) != recordsStart) {
+            return writeError();
+        }
+
+        QVector<quint64> prefixCounts(INDEX_PREFIXES, 0);
+        quint64 recordCount = 0;
+        bool sorted = true;
+        QByteArray record;
+        QByteArray previous;
+        QByteArray batch;
+
+        TextScanner scanner(hibpInput);
+        for (quint64 lineNum = 1;; ++lineNum) {
+            const auto result = scanner.next();
+            if (result == ParseResult::Error) {
+                *error = QObject::tr("HIBP file, line %1: parse error").arg(lineNum);
+                return false;
+            }
+            const int count = scanner.count();
+
+            // Records are held back by one line to merge truncated duplicates
+            const QByteArray hash(scanner.sha1(), hashBytes);
+            if (result == ParseResult::Ok && !previous.isEmpty() && hash == previous) {
+                auto* storedCount = reinterpret_cast<uchar*>(record.data() + hashBytes);
+                qToLittleEndian(std::max(qFromLittleEndian<quint32>(storedCount), static_cast<quint32>(count)),
+                                storedCount);
+                continue;
+            }
+
+            if (!record.isEmpty()) {
+                batch.append(record);
+                ++prefixCounts[hashPrefix(record.constData())];
+                ++recordCount;
+                if (batch.size() >= 1024 * recordSize || result == ParseResult::Eof) {
+                    if (output.write(batch) != batch.size()) {
+                        return writeError();
+                    }
+                    batch.clear();
+                }
+            }
+
+            if (result == ParseResult::Eof) {
+                break;
+            }
+
+            if (!previous.isEmpty() && hash < previous) {
+                sorted = false;
+            }
+            previous = hash;
+            record = hash;
+            record.resize(recordSize);
+            qToLittleEndian(static_cast<quint32>(count), reinterpret_cast<uchar*>(record.data() + hashBytes));
+        }
+
+        if (!sorted) {
+            if (!output.seek(recordsStart)) {
+                return writeError();
+            }
+            QByteArray records = output.read(recordCount * recordSize);
+            if (static_cast<quint64>(records.size()) != recordCount * recordSize) {
+                *error = QObject::tr("Failed to read back HIBP index: %1").arg(output.errorString());
+                return false;
+            }
+
+            sortRecords(records, recordSize, hashBytes);
+
+            recordCount = records.size() / recordSize;
+            prefixCounts.fill(0);
+            for (int offset = 0; offset < records.size(); offset += recordSize) {
+                ++prefixCounts[hashPrefix(records.constData() + offset)];
+            }
+
+            if (!output.seek(recordsStart) || output.write(records) != records.size()
+                || !output.resize(recordsStart + records.size())) {
+                return writeError();
+            }
+        }
+
+        QByteArray header(INDEX_MAGIC, INDEX_MAGIC_SIZE);
+        header.resize(INDEX_HEADER_SIZE + INDEX_TABLE_SIZE);
+        auto* data = reinterpret_cast<uchar*>(header.data());
+        qToLittleEndian(INDEX_VERSION, data + INDEX_MAGIC_SIZE);
+        qToLittleEndian(static_cast<quint32>(hashBytes), data + INDEX_MAGIC_SIZE + 4);
+        qToLittleEndian(recordCount, data + INDEX_MAGIC_SIZE + 8);
+
+        // The table holds the first record of each prefix and the record count
+        quint64 first = 0;
+        for (int prefix = 0; prefix <= INDEX_PREFIXES; ++prefix) {
+            qToLittleEndian(first, data + INDEX_HEADER_SIZE + prefix * 8);
+            if (prefix < INDEX_PREFIXES) {
+                first += prefixCounts[prefix];
+            }
+        }
+
+        if (!output.seek(0) || output.write(header) != header.size() || !output.flush()) {
+            return writeError();
+        }
+
+        return true;
+    }
+
+    /**
+     * @return true if the file starts like a binary index written by convert()
+     */
+    bool isIndex(const QString& filePath)
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        return file.read(INDEX_MAGIC_SIZE) == QByteArray(INDEX_MAGIC, INDEX_MAGIC_SIZE);
+    }
+
+    /**
+     * Look up the passwords of the database in a binary index written by
+     * convert(). The index is memory-mapped and each password costs a binary
+     * search within the records sharing its 16 bit prefix.
+     */
+    bool indexReport(QSharedPointer<Database> db,
+                     const QString& indexFile,
+                     QList<QPair<const Entry*, int>>& findings,
+                     QString* error)
+    {
+        Index index;
+        if (!index.open(indexFile, error)) {
+            return false;
+        }
+
+        db->rootGroup()->forEachEntryRecursive(
+            [&](const Entry* entry) -> bool {
+                const auto sha1 = QCryptographicHash::hash(entry->password().toUtf8(), QCryptographicHash::Sha1);
+                int count;
+                if (index.lookup(sha1, &count)) {
+                    findings.append({entry, count});
+                }
+                return true;
+            },
+            true);
+
+        return true;
+    }
+
+    bool Index::open(const QString& filePath, QString* error)
+    {
+        m_file.close();
+        m_table = nullptr;
+        m_records = nullptr;
+
+        m_file.setFileName(filePath);
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            *error = QObject::tr("Failed to open HIBP index %1: %2").arg(filePath, m_file.errorString());
+            return false;
+        }
+
+        const qint64 size = m_file.size();
+        const uchar* data = size >= INDEX_HEADER_SIZE + INDEX_TABLE_SIZE ? m_file.map(0, size) : nullptr;
+        if (!data || std::memcmp(data, INDEX_MAGIC, INDEX_MAGIC_SIZE) != 0
+            || qFromLittleEndian<quint32>(data + INDEX_MAGIC_SIZE) != INDEX_VERSION) {
+            *error = QObject::tr("Invalid HIBP index: %1").arg(filePath);
+            return false;
+        }
+
+        const int hashBytes = static_cast<int>(qFromLittleEndian<quint32>(data + INDEX_MAGIC_SIZE + 4));
+        const quint64 recordCount = qFromLittleEndian<quint64>(data + INDEX_MAGIC_SIZE + 8);
+        const uchar* table = data + INDEX_HEADER_SIZE;
+        if (hashBytes < MIN_INDEX_HASH_BYTES || hashBytes > static_cast<int>(SHA1_BYTES)
+            || recordCount
+                   != static_cast<quint64>(size - INDEX_HEADER_SIZE - INDEX_TABLE_SIZE) / (hashBytes + INDEX_COUNT_SIZE)
+            || qFromLittleEndian<quint64>(table + INDEX_PREFIXES * 8) != recordCount) {
+            *error = QObject::tr("Invalid HIBP index: %1").arg(filePath);
+            return false;
+        }
+
+        m_hashBytes = hashBytes;
+        m_recordCount = recordCount;
+        m_table = table;
+        m_records = table + INDEX_TABLE_SIZE;
+        return true;
+    }
+
+    /**
+     * Each lookup is a binary search within the records sharing the 16 bit
+     * prefix of the hash.
+     */
+    bool Index::lookup(const QByteArray& sha1, int* count) const
+    {
+        if (!m_table || sha1.size() != static_cast<int>(SHA1_BYTES)) {
+            return false;
+        }
+
+        const int recordSize = m_hashBytes + INDEX_COUNT_SIZE;
+        const int prefix = hashPrefix(sha1.constData());
+        quint64 low = qFromLittleEndian<quint64>(m_table + prefix * 8);
+        quint64 high = std::min(qFromLittleEndian<quint64>(m_table + (prefix + 1) * 8), m_recordCount);
+
+        while (low < high) {
+            const quint64 middle = low + (high - low) / 2;
+            const uchar* record = m_records + middle * recordSize;
+            const int cmp = std::memcmp(record, sha1.constData(), m_hashBytes);
+            if (cmp == 0) {
+                *count = static_cast<int>(qFromLittleEndian<quint32>(record + m_hashBytes));
+                return true;
+            } else if (cmp < 0) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return false;
+    }
 } // namespace HibpOffline
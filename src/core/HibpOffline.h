@@ -18,9 +18,11 @@
 #ifndef KEEPASSXC_HIBPOFFLINE_H
 #define KEEPASSXC_HIBPOFFLINE_H
 
+#include <QFile>
 #include <QIODevice>
 #include <QList>
 #include <QPair>
+#include <QVector>
 
 class Database;
 class Entry;
@@ -32,11 +34,70 @@ namespace HibpOffline
                 QList<QPair<const Entry*, int>>& findings,
                 QString* error);
 
+    /**
+     * Like report(), for SHA-1 hashes of the passwords that have already
+     * been computed, e.g. in parallel.
+     *
+     * @param hashes SHA-1 hash of the password of each entry, in any order
+     */
+    bool report(QVector<QPair<QByteArray, const Entry*>> hashes,
+                QIODevice& hibpInput,
+                QList<QPair<const Entry*, int>>& findings,
+                QString* error);
+
     bool okonReport(QSharedPointer<Database> db,
                     const QString& okon,
                     const QString& okonDatabase,
                     QList<QPair<const Entry*, int>>& findings,
                     QString* error);
+
+    /**
+     * Convert a HIBP text file into a sorted binary index that can be
+     * queried with indexReport() without scanning the whole file.
+     *
+     * The index holds the SHA-1 hashes truncated to hashBytes bytes and
+     * their counts, preceded by a table of the first record of each 16 bit
+     * hash prefix. Input ordered by hash, like the official downloads, is
+     * converted in a single pass; other input is sorted in memory.
+     *
+     * @param hibpInput HIBP text file
+     * @param output index file, opened for reading and writing
+     * @param hashBytes number of leading SHA-1 bytes to keep per hash
+     * @param error set to a description of the error on failure
+     * @return true on success
+     */
+    bool convert(QIODevice& hibpInput, QFileDevice& output, int hashBytes, QString* error);
+
+    bool isIndex(const QString& filePath);
+
+    bool indexReport(QSharedPointer<Database> db,
+                     const QString& indexFile,
+                     QList<QPair<const Entry*, int>>& findings,
+                     QString* error);
+
+    /**
+     * Memory-mapped binary index written by convert(). Once opened, lookups
+     * only read the mapping and can be made from several threads at once.
+     */
+    class Index
+    {
+    public:
+        bool open(const QString& filePath, QString* error);
+
+        /**
+         * @param sha1 SHA-1 hash of a password
+         * @param count set to the number of times the password has been leaked
+         * @return true if the hash is in the index
+         */
+        bool lookup(const QByteArray& sha1, int* count) const;
+
+    private:
+        QFile m_file;
+        const uchar* m_table = nullptr;
+        const uchar* m_records = nullptr;
+        quint64 m_recordCount = 0;
+        int m_hashBytes = 0;
+    };
 } // namespace HibpOffline
 
 #endif // KEEPASSXC_HIBPOFFLINE_H
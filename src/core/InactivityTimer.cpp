@@ -17,14 +17,20 @@
 
 #include "InactivityTimer.h"
 
-#include <QCoreApplication>
+#include <QGuiApplication>
 #include <QTimer>
 
 InactivityTimer::InactivityTimer(QObject* parent)
     : QObject(parent)
     , m_timer(new QTimer(this))
+    , m_inactivityTimeout(0)
+    , m_lastActivity(0)
+    , m_reportedActivity(-1)
     , m_active(false)
+    , m_eventFilterInstalled(false)
+    , m_applicationActive(true)
 {
+    m_clock.start();
     m_timer->setSingleShot(true);
     connect(m_timer, SIGNAL(timeout()), SLOT(timeout()));
 }
@@ -33,21 +39,48 @@ void InactivityTimer::setInactivityTimeout(int inactivityTimeout)
 {
     Q_ASSERT(inactivityTimeout > 0);
 
+    m_inactivityTimeout = inactivityTimeout;
     m_timer->setInterval(inactivityTimeout);
 }
 
+/**
+ * Set where the idle time comes from, see the class description. Takes
+ * effect on the next activation.
+ *
+ * @param source idle time source, may be empty
+ */
+void InactivityTimer::setIdleTimeSource(const IdleTimeSource& source)
+{
+    m_idleTimeSource = source;
+}
+
 void InactivityTimer::activate()
 {
     if (!m_active) {
-        qApp->installEventFilter(this);
+        if (!m_idleTimeSource || m_idleTimeSource() < 0) {
+            useEventFilter();
+        } else if (auto* app = qobject_cast<QGuiApplication*>(QCoreApplication::instance())) {
+            m_applicationActive = app->applicationState() == Qt::ApplicationActive;
+            connect(app,
+                    &QGuiApplication::applicationStateChanged,
+                    this,
+                    &InactivityTimer::applicationStateChanged,
+                    Qt::UniqueConnection);
+        }
     }
     m_active = true;
-    m_timer->start();
+    m_lastActivity = m_clock.elapsed();
+    m_reportedActivity = -1;
+    m_timer->start(m_inactivityTimeout);
 }
 
 void InactivityTimer::deactivate()
 {
-    qApp->removeEventFilter(this);
+    if (qApp) {
+        qApp->removeEventFilter(this);
+        qApp->disconnect(this);
+    }
+    m_eventFilterInstalled = false;
     m_active = false;
     m_timer->stop();
 }
@@ -59,7 +92,8 @@ bool InactivityTimer::eventFilter(QObject* watched, QEvent* event)
     if ((type >= QEvent::MouseButtonPress && type <= QEvent::KeyRelease)
         || (type >= QEvent::HoverEnter && type <= QEvent::HoverMove)
         || (type == QEvent::Wheel)) {
-        m_timer->start();
+        // only remember the time, timeout() checks whether the timeout elapsed
+        m_lastActivity = m_clock.elapsed();
     }
     // clang-format on
 
@@ -73,9 +107,56 @@ void InactivityTimer::timeout()
         return;
     }
 
-    if (m_active && !m_timer->isActive()) {
-        emit inactivityDetected();
+    if (m_active) {
+        auto* app = qobject_cast<QGuiApplication*>(QCoreApplication::instance());
+        // input in other applications doesn't count
+        if (!app || app->applicationState() == Qt::ApplicationActive) {
+            updateLastActivity();
+        }
+        const qint64 remaining = m_lastActivity + m_inactivityTimeout - m_clock.elapsed();
+        if (remaining > 0) {
+            m_timer->start(static_cast<int>(remaining));
+        } else if (m_lastActivity == m_reportedActivity) {
+            // already reported, wait for the next activity
+            m_timer->start(m_inactivityTimeout);
+        } else {
+            m_reportedActivity = m_lastActivity;
+            m_timer->start(m_inactivityTimeout);
+            emit inactivityDetected();
+        }
     }
 
     m_emitMutx.unlock();
 }
+
+void InactivityTimer::applicationStateChanged(Qt::ApplicationState state)
+{
+    const bool wasActive = m_applicationActive;
+    m_applicationActive = state == Qt::ApplicationActive;
+    if (wasActive && !m_applicationActive && m_active) {
+        // the input until the application was left counts
+        updateLastActivity();
+    }
+}
+
+void InactivityTimer::updateLastActivity()
+{
+    if (m_eventFilterInstalled) {
+        return;
+    }
+
+    const qint64 idle = m_idleTimeSource();
+    if (idle < 0) {
+        useEventFilter();
+        return;
+    }
+    m_lastActivity = qMax(m_lastActivity, m_clock.elapsed() - idle);
+}
+
+void InactivityTimer::useEventFilter()
+{
+    if (!m_eventFilterInstalled) {
+        qApp->installEventFilter(this);
+        m_eventFilterInstalled = true;
+    }
+}
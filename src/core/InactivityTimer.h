@@ -18,18 +18,36 @@
 #ifndef KEEPASSX_INACTIVITYTIMER_H
 #define KEEPASSX_INACTIVITYTIMER_H
 
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QObject>
 
+#include <functional>
+
 class QTimer;
 
+/**
+ * Emits inactivityDetected() once the application has not been used for
+ * the inactivity timeout.
+ *
+ * With an idle time source, e.g. the idle time of the OS, the timer only
+ * wakes up when the timeout could have elapsed. While the application is
+ * active, the last use is the last input on the system; while another
+ * application is active, it is the moment the application was left.
+ * Without a source, or if the source doesn't know the idle time, an event
+ * filter on the application records input events instead.
+ */
 class InactivityTimer : public QObject
 {
     Q_OBJECT
 
 public:
+    // milliseconds since the last input, -1 if unknown
+    typedef std::function<qint64()> IdleTimeSource;
+
     explicit InactivityTimer(QObject* parent = nullptr);
     void setInactivityTimeout(int inactivityTimeout);
+    void setIdleTimeSource(const IdleTimeSource& source);
     void activate();
     void deactivate();
 
@@ -41,10 +59,22 @@ protected:
 
 private slots:
     void timeout();
+    void applicationStateChanged(Qt::ApplicationState state);
 
 private:
+    void updateLastActivity();
+    void useEventFilter();
+
     QTimer* m_timer;
+    QElapsedTimer m_clock;
+    IdleTimeSource m_idleTimeSource;
+    int m_inactivityTimeout;
+    // times on m_clock
+    qint64 m_lastActivity;
+    qint64 m_reportedActivity;
     bool m_active;
+    bool m_eventFilterInstalled;
+    bool m_applicationActive;
     QMutex m_emitMutx;
 };
 
@@ -0,0 +1,192 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MemoryUsage.h"
+
+#include "config-keepassx.h"
+
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+// windows.h has to come first
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#elif defined(Q_OS_LINUX)
+#include <cstdio>
+#include <unistd.h>
+#if defined(HAVE_MALLOC_TRIM)
+#include <malloc.h>
+#endif
+#endif
+
+namespace
+{
+    struct CacheRegistry
+    {
+        QMutex mutex;
+        QList<std::function<void()>> clearFunctions;
+        qint64 released = 0;
+
+        static CacheRegistry& instance()
+        {
+            static CacheRegistry registry;
+            return registry;
+        }
+    };
+
+    /**
+     * @return memory of the process that is resident in RAM or 0 if it cannot be determined
+     */
+    qint64 residentSize()
+    {
+#if defined(Q_OS_WIN)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return static_cast<qint64>(counters.WorkingSetSize);
+        }
+        return 0;
+#elif defined(Q_OS_MACOS)
+        mach_task_basic_info_data_t info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count)
+            == KERN_SUCCESS) {
+            return static_cast<qint64>(info.resident_size);
+        }
+        return 0;
+#elif defined(Q_OS_LINUX)
+        long pages = 0;
+        long resident = 0;
+        FILE* statm = std::fopen("/proc/self/statm", "r");
+        if (!statm) {
+            return 0;
+        }
+        const bool read = std::fscanf(statm, "%ld %ld", &pages, &resident) == 2;
+        std::fclose(statm);
+        const long pageSize = sysconf(_SC_PAGE_SIZE);
+        if (!read || pageSize <= 0) {
+            return 0;
+        }
+        return static_cast<qint64>(resident) * static_cast<qint64>(pageSize);
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * Hand the free parts of the heap back to the operating system.
+     */
+    void trimHeap()
+    {
+#if defined(Q_OS_WIN)
+        HeapCompact(GetProcessHeap(), 0);
+#elif defined(Q_OS_MACOS)
+        malloc_zone_pressure_relief(nullptr, 0);
+#elif defined(HAVE_MALLOC_TRIM)
+        malloc_trim(0);
+#endif
+    }
+} // namespace
+
+void MemoryUsage::addAttachment(const QByteArray& data)
+{
+    attachmentsTotal += data.size();
+    if (!m_attachmentData.contains(data.constData())) {
+        m_attachmentData.insert(data.constData());
+        attachmentsDeduplicated += data.size();
+    }
+}
+
+void MemoryUsage::addDeferredAttachment(qint64 size)
+{
+    attachmentsTotal += size;
+}
+
+/**
+ * Memory held by the database, with every attachment counted once.
+ */
+qint64 MemoryUsage::total() const
+{
+    return entries + historyItems + attachmentsDeduplicated + customIconsRaw + customIconsDecoded + customData
+           + deletedObjects;
+}
+
+/**
+ * Approximate the memory of a string from its encoded size.
+ */
+qint64 MemoryUsage::textSize(int utf8Size)
+{
+    return static_cast<qint64>(utf8Size) * static_cast<qint64>(sizeof(QChar));
+}
+
+/**
+ * Register a process-wide cache to be emptied by releaseFreeMemory().
+ * The function may be called from any thread, the clear function is
+ * called from the thread releasing the memory.
+ *
+ * @return always true, to initialize a static flag of the cache with
+ */
+bool MemoryUsage::registerCache(const std::function<void()>& clear)
+{
+    auto& registry = CacheRegistry::instance();
+    QMutexLocker locker(&registry.mutex);
+    registry.clearFunctions.append(clear);
+    return true;
+}
+
+/**
+ * Empty the registered caches and return the freed heap to the operating
+ * system. Meant to be called once the data of a database was released,
+ * as the heap keeps the memory of the entries otherwise.
+ *
+ * @return memory no longer resident in RAM, in bytes
+ */
+qint64 MemoryUsage::releaseFreeMemory()
+{
+    auto& registry = CacheRegistry::instance();
+    QList<std::function<void()>> clearFunctions;
+    {
+        QMutexLocker locker(&registry.mutex);
+        clearFunctions = registry.clearFunctions;
+    }
+
+    const qint64 sizeBefore = residentSize();
+    for (const auto& clear : clearFunctions) {
+        clear();
+    }
+    trimHeap();
+    const qint64 sizeAfter = residentSize();
+    const qint64 released = sizeBefore > 0 && sizeAfter > 0 ? qMax<qint64>(0, sizeBefore - sizeAfter) : 0;
+
+    QMutexLocker locker(&registry.mutex);
+    registry.released += released;
+    return released;
+}
+
+/**
+ * @return memory returned by releaseFreeMemory() since the start of the process, in bytes
+ */
+qint64 MemoryUsage::releasedMemory()
+{
+    auto& registry = CacheRegistry::instance();
+    QMutexLocker locker(&registry.mutex);
+    return registry.released;
+}
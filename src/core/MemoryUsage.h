@@ -0,0 +1,61 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_MEMORYUSAGE_H
+#define KEEPASSXC_MEMORYUSAGE_H
+
+#include <QByteArray>
+#include <QSet>
+
+#include <functional>
+
+/**
+ * Estimated memory held by a database, in bytes per category. Text is
+ * counted in UTF-16 as Qt keeps it, plus the size of the owning objects.
+ *
+ * Attachments share their data implicitly between entries and history
+ * items: attachmentsTotal counts every reference, attachmentsDeduplicated
+ * counts each block of data held in memory once. Attachments that are
+ * still deferred in the database file only count towards the total.
+ */
+class MemoryUsage
+{
+public:
+    qint64 entries = 0;
+    qint64 historyItems = 0;
+    qint64 attachmentsTotal = 0;
+    qint64 attachmentsDeduplicated = 0;
+    qint64 customIconsRaw = 0;
+    qint64 customIconsDecoded = 0;
+    qint64 customData = 0;
+    qint64 deletedObjects = 0;
+
+    void addAttachment(const QByteArray& data);
+    void addDeferredAttachment(qint64 size);
+    qint64 total() const;
+
+    static qint64 textSize(int utf8Size);
+
+    static bool registerCache(const std::function<void()>& clear);
+    static qint64 releaseFreeMemory();
+    static qint64 releasedMemory();
+
+private:
+    QSet<const char*> m_attachmentData;
+};
+
+#endif // KEEPASSXC_MEMORYUSAGE_H
@@ -21,9 +21,23 @@
 #include "core/Database.h"
 #include "core/Entry.h"
 #include "core/Metadata.h"
+#include "core/Trace.h"
+#include "crypto/CryptoHash.h"
+
+#include <QDataStream>
+
+#include <algorithm>
+
+namespace
+{
+    // Digests are truncated, they only need to detect changes of a single entry
+    const int MergeBaseDigestSize = 16;
+    const int MergeBaseUuidSize = 16;
+} // namespace
 
 Merger::Merger(const Database* sourceDb, Database* targetDb)
     : m_mode(Group::Default)
+    , m_useMergeBase(false)
 {
     if (!sourceDb || !targetDb) {
         Q_ASSERT(sourceDb && targetDb);
@@ -36,6 +50,7 @@ Merger::Merger(const Database* sourceDb, Database* targetDb)
 
 Merger::Merger(const Group* sourceGroup, Group* targetGroup)
     : m_mode(Group::Default)
+    , m_useMergeBase(false)
 {
     if (!sourceGroup || !targetGroup) {
         Q_ASSERT(sourceGroup && targetGroup);
@@ -60,21 +75,44 @@ void Merger::resetForcedMergeMode()
     m_mode = Group::Default;
 }
 
+void Merger::setUseMergeBase(bool useMergeBase)
+{
+    m_useMergeBase = useMergeBase;
+}
+
 QStringList Merger::merge()
 {
+    TRACE_SCOPE("Merger::merge");
     // Order of merge steps is important - it is possible that we
     // create some items before deleting them afterwards
+    const bool useMergeBase = isMergeBaseUsable();
+    if (useMergeBase) {
+        loadMergeBase();
+    }
+
+    Database* targetDb = m_context.m_targetDb;
+    if (targetDb) {
+        targetDb->beginBulkUpdate();
+    }
+
     ChangeList changes;
     changes << mergeGroup(m_context);
     changes << mergeDeletions(m_context);
     changes << mergeMetadata(m_context);
 
+    if (useMergeBase) {
+        storeMergeBase();
+    }
+
     // qDebug("Merged %s", qPrintable(changes.join("\n\t")));
 
     // At this point we have a list of changes we may want to show the user
     if (!changes.isEmpty()) {
         m_context.m_targetDb->markAsModified();
     }
+    if (targetDb) {
+        targetDb->endBulkUpdate();
+    }
     return changes;
 }
 
@@ -90,10 +128,14 @@ Merger::ChangeList Merger::mergeGroup(const MergeContext& context)
             // This entry does not exist at all. Create it.
             targetEntry = sourceEntry->clone(Entry::CloneIncludeHistory);
             moveEntry(targetEntry, context.m_targetGroup);
+        } else if (isUnchangedSinceMergeBase(sourceEntry)) {
+            // The source entry was already merged and did not change since, any
+            // difference to the target entry is a local change that has to stay.
+            continue;
         } else {
             // Entry is already present in the database. Update it.
             const bool locationChanged =
-                targetEntry->timeInfo().locationChanged() < sourceEntry->timeInfo().locationChanged();
+                targetEntry->timeInfo().locationChangedMSecs() < sourceEntry->timeInfo().locationChangedMSecs();
             if (locationChanged && targetEntry->group() != context.m_targetGroup) {
                 changes << tr("Relocating %1 [%2]").arg(sourceEntry->title(), sourceEntry->uuidToHex());
                 moveEntry(targetEntry, context.m_targetGroup);
@@ -111,16 +153,16 @@ Merger::ChangeList Merger::mergeGroup(const MergeContext& context)
             targetChildGroup = sourceChildGroup->clone(Entry::CloneNoFlags, Group::CloneNoFlags);
             moveGroup(targetChildGroup, context.m_targetGroup);
             TimeInfo timeinfo = targetChildGroup->timeInfo();
-            timeinfo.setLocationChanged(sourceChildGroup->timeInfo().locationChanged());
+            timeinfo.setLocationChanged(sourceChildGroup->timeInfo().locationChangedMSecs());
             targetChildGroup->setTimeInfo(timeinfo);
         } else {
             bool locationChanged =
-                targetChildGroup->timeInfo().locationChanged() < sourceChildGroup->timeInfo().locationChanged();
+                targetChildGroup->timeInfo().locationChangedMSecs() < sourceChildGroup->timeInfo().locationChangedMSecs();
             if (locationChanged && targetChildGroup->parent() != context.m_targetGroup) {
                 changes << tr("Relocating %1 [%2]").arg(sourceChildGroup->name(), sourceChildGroup->uuidToHex());
                 moveGroup(targetChildGroup, context.m_targetGroup);
                 TimeInfo timeinfo = targetChildGroup->timeInfo();
-                timeinfo.setLocationChanged(sourceChildGroup->timeInfo().locationChanged());
+                timeinfo.setLocationChanged(sourceChildGroup->timeInfo().locationChangedMSecs());
                 targetChildGroup->setTimeInfo(timeinfo);
             }
             changes << resolveGroupConflict(context, sourceChildGroup, targetChildGroup);
@@ -142,8 +184,8 @@ Merger::resolveGroupConflict(const MergeContext& context, const Group* sourceChi
     Q_UNUSED(context);
     ChangeList changes;
 
-    const QDateTime timeExisting = targetChildGroup->timeInfo().lastModificationTime();
-    const QDateTime timeOther = sourceChildGroup->timeInfo().lastModificationTime();
+    const qint64 timeExisting = targetChildGroup->timeInfo().lastModificationMSecs();
+    const qint64 timeOther = sourceChildGroup->timeInfo().lastModificationMSecs();
 
     // only if the other group is newer, update the existing one.
     if (timeExisting < timeOther) {
@@ -231,8 +273,8 @@ void Merger::moveGroup(Group* group, Group* targetGroup)
 void Merger::eraseEntry(Entry* entry)
 {
     Database* database = entry->database();
-    // most simple method to remove an item from DeletedObjects :(
-    const QList<DeletedObject> deletions = database->deletedObjects();
+    // drop the deleted objects added while deleting the item
+    const int deletionCount = database->deletedObjects().size();
     Group* parentGroup = entry->group();
     const bool groupUpdateTimeInfo = parentGroup ? parentGroup->canUpdateTimeinfo() : false;
     if (parentGroup) {
@@ -242,14 +284,14 @@ void Merger::eraseEntry(Entry* entry)
     if (parentGroup) {
         parentGroup->setUpdateTimeinfo(groupUpdateTimeInfo);
     }
-    database->setDeletedObjects(deletions);
+    database->truncateDeletedObjects(deletionCount);
 }
 
 void Merger::eraseGroup(Group* group)
 {
     Database* database = group->database();
-    // most simple method to remove an item from DeletedObjects :(
-    const QList<DeletedObject> deletions = database->deletedObjects();
+    // drop the deleted objects added while deleting the item
+    const int deletionCount = database->deletedObjects().size();
     Group* parentGroup = group->parentGroup();
     const bool groupUpdateTimeInfo = parentGroup ? parentGroup->canUpdateTimeinfo() : false;
     if (parentGroup) {
@@ -259,16 +301,15 @@ void Merger::eraseGroup(Group* group)
     if (parentGroup) {
         parentGroup->setUpdateTimeinfo(groupUpdateTimeInfo);
     }
-    database->setDeletedObjects(deletions);
+    database->truncateDeletedObjects(deletionCount);
 }
 
 Merger::ChangeList
 Merger::resolveEntryConflict_Duplicate(const MergeContext& context, const Entry* sourceEntry, Entry* targetEntry)
 {
     ChangeList changes;
-    const int comparison = compare(targetEntry->timeInfo().lastModificationTime(),
-                                   sourceEntry->timeInfo().lastModificationTime(),
-                                   CompareItemIgnoreMilliseconds);
+    const int comparison = compare(TimeInfo::serialized(targetEntry->timeInfo().lastModificationMSecs()),
+                                   TimeInfo::serialized(sourceEntry->timeInfo().lastModificationMSecs()));
     // if one entry is newer, create a clone and add it to the group
     if (comparison < 0) {
         Entry* clonedEntry = sourceEntry->clone(Entry::CloneNewUuid | Entry::CloneIncludeHistory);
@@ -289,9 +330,8 @@ Merger::resolveEntryConflict_KeepLocal(const MergeContext& context, const Entry*
 {
     Q_UNUSED(context);
     ChangeList changes;
-    const int comparison = compare(targetEntry->timeInfo().lastModificationTime(),
-                                   sourceEntry->timeInfo().lastModificationTime(),
-                                   CompareItemIgnoreMilliseconds);
+    const int comparison = compare(TimeInfo::serialized(targetEntry->timeInfo().lastModificationMSecs()),
+                                   TimeInfo::serialized(sourceEntry->timeInfo().lastModificationMSecs()));
     if (comparison < 0) {
         // we need to make our older entry "newer" than the new entry - therefore
         // we just create a new history entry without any changes - this preserves
@@ -312,9 +352,8 @@ Merger::resolveEntryConflict_KeepRemote(const MergeContext& context, const Entry
 {
     Q_UNUSED(context);
     ChangeList changes;
-    const int comparison = compare(targetEntry->timeInfo().lastModificationTime(),
-                                   sourceEntry->timeInfo().lastModificationTime(),
-                                   CompareItemIgnoreMilliseconds);
+    const int comparison = compare(TimeInfo::serialized(targetEntry->timeInfo().lastModificationMSecs()),
+                                   TimeInfo::serialized(sourceEntry->timeInfo().lastModificationMSecs()));
     if (comparison > 0) {
         // we need to make our older entry "newer" than the new entry - therefore
         // we just create a new history entry without any changes - this preserves
@@ -340,9 +379,8 @@ Merger::ChangeList Merger::resolveEntryConflict_MergeHistories(const MergeContex
     Q_UNUSED(context);
 
     ChangeList changes;
-    const int comparison = compare(targetEntry->timeInfo().lastModificationTime(),
-                                   sourceEntry->timeInfo().lastModificationTime(),
-                                   CompareItemIgnoreMilliseconds);
+    const int comparison = compare(TimeInfo::serialized(targetEntry->timeInfo().lastModificationMSecs()),
+                                   TimeInfo::serialized(sourceEntry->timeInfo().lastModificationMSecs()));
     if (comparison < 0) {
         Group* currentGroup = targetEntry->group();
         Entry* clonedEntry = sourceEntry->clone(Entry::CloneIncludeHistory);
@@ -410,9 +448,8 @@ bool Merger::mergeHistory(const Entry* sourceEntry, Entry* targetEntry, Group::M
     Q_UNUSED(mergeMethod);
     const auto targetHistoryItems = targetEntry->historyItems();
     const auto sourceHistoryItems = sourceEntry->historyItems();
-    const int comparison = compare(sourceEntry->timeInfo().lastModificationTime(),
-                                   targetEntry->timeInfo().lastModificationTime(),
-                                   CompareItemIgnoreMilliseconds);
+    const int comparison = compare(TimeInfo::serialized(sourceEntry->timeInfo().lastModificationMSecs()),
+                                   TimeInfo::serialized(targetEntry->timeInfo().lastModificationMSecs()));
     const bool preferLocal = mergeMethod == Group::KeepLocal || comparison < 0;
     const bool preferRemote = mergeMethod == Group::KeepRemote || comparison > 0;
 
@@ -528,7 +565,7 @@ Merger::ChangeList Merger::mergeDeletions(const MergeContext& context)
     const auto sourceDeletions = context.m_sourceDb->deletedObjects();
 
     QList<DeletedObject> deletions;
-    QMap<QUuid, DeletedObject> mergedDeletions;
+    QHash<QUuid, DeletedObject> mergedDeletions;
     QList<Entry*> entries;
     QList<Group*> groups;
 
@@ -571,19 +608,29 @@ Merger::ChangeList Merger::mergeDeletions(const MergeContext& context)
         eraseEntry(entry);
     }
 
+    QSet<const Group*> pendingGroups;
+    for (const Group* group : asConst(groups)) {
+        pendingGroups.insert(group);
+    }
     while (!groups.isEmpty()) {
         auto* group = groups.takeFirst();
-        if (!(group->children().toSet() & groups.toSet()).isEmpty()) {
+        const QList<Group*> children = group->children();
+        const bool hasPendingChildren =
+            std::any_of(children.begin(), children.end(), [&pendingGroups](const Group* child) {
+                return pendingGroups.contains(child);
+            });
+        if (hasPendingChildren) {
             // we need to finish all children before we are able to determine if the group can be removed
             groups << group;
             continue;
         }
+        pendingGroups.remove(group);
         const auto& object = mergedDeletions[group->uuid()];
         if (group->timeInfo().lastModificationTime() > object.deletionTime) {
             // keep deleted group since it was changed after deletion date
             continue;
         }
-        if (!group->entriesRecursive(false).isEmpty() || !group->groupsRecursive(false).isEmpty()) {
+        if (!group->entries().isEmpty() || !group->children().isEmpty()) {
             // keep deleted group since it contains undeleted content
             continue;
         }
@@ -614,8 +661,7 @@ Merger::ChangeList Merger::mergeMetadata(const MergeContext& context)
 
     for (const auto& iconUuid : sourceMetadata->customIconsOrder()) {
         if (!targetMetadata->hasCustomIcon(iconUuid)) {
-            QImage customIcon = sourceMetadata->customIcon(iconUuid);
-            targetMetadata->addCustomIcon(iconUuid, customIcon);
+            targetMetadata->addCustomIcon(iconUuid, sourceMetadata->customIconData(iconUuid));
             changes << tr("Adding missing icon %1").arg(QString::fromLatin1(iconUuid.toRfc4122().toHex()));
         }
     }
@@ -643,7 +689,8 @@ Merger::ChangeList Merger::mergeMetadata(const MergeContext& context)
         // Transfer new/existing keys
         for (const auto& key : sourceCustomDataKeys) {
             // Don't merge this meta field, it is updated automatically.
-            if (key == CustomData::LastModified) {
+            // The merge base of the source database describes its own merges.
+            if (key == CustomData::LastModified || key.startsWith(CustomData::MergeBaseKeyPrefix)) {
                 continue;
             }
 
@@ -659,3 +706,95 @@ Merger::ChangeList Merger::mergeMetadata(const MergeContext& context)
 
     return changes;
 }
+
+bool Merger::isMergeBaseUsable() const
+{
+    return m_useMergeBase && m_context.m_sourceDb && m_context.m_targetDb
+           && m_context.m_sourceGroup == m_context.m_sourceRootGroup;
+}
+
+QString Merger::mergeBaseKey() const
+{
+    // Copies of the same database share the uuid of their root group
+    QString key = CustomData::MergeBaseKeyPrefix + m_context.m_sourceRootGroup->uuidToHex();
+    if (m_context.m_targetGroup != m_context.m_targetRootGroup) {
+        // a database merged into a group, such as a shared folder
+        key += QStringLiteral("/") + m_context.m_targetGroup->uuidToHex();
+    }
+    return key;
+}
+
+void Merger::loadMergeBase()
+{
+    m_mergeBase.clear();
+
+    const QString value = m_context.m_targetDb->metadata()->customData()->value(mergeBaseKey());
+    const QByteArray data = QByteArray::fromBase64(value.toLatin1());
+    const int recordSize = MergeBaseUuidSize + MergeBaseDigestSize;
+    if (data.size() % recordSize != 0) {
+        return;
+    }
+
+    m_mergeBase.reserve(data.size() / recordSize);
+    for (int offset = 0; offset < data.size(); offset += recordSize) {
+        const QUuid uuid = QUuid::fromRfc4122(data.mid(offset, MergeBaseUuidSize));
+        m_mergeBase.insert(uuid, data.mid(offset + MergeBaseUuidSize, MergeBaseDigestSize));
+    }
+}
+
+void Merger::storeMergeBase()
+{
+    QByteArray data;
+    m_context.m_sourceRootGroup->forEachEntryRecursive([&data](const Entry* entry) {
+        data.append(entry->uuid().toRfc4122());
+        data.append(entryDigest(entry));
+        return true;
+    });
+    m_mergeBase.clear();
+
+    m_context.m_targetDb->metadata()->customData()->set(mergeBaseKey(), QString::fromLatin1(data.toBase64()));
+}
+
+bool Merger::isUnchangedSinceMergeBase(const Entry* sourceEntry) const
+{
+    if (m_mergeBase.isEmpty()) {
+        return false;
+    }
+    const auto digest = m_mergeBase.constFind(sourceEntry->uuid());
+    return digest != m_mergeBase.constEnd() && digest.value() == entryDigest(sourceEntry);
+}
+
+QByteArray Merger::entryDigest(const Entry* entry)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+
+    const TimeInfo& timeInfo = entry->timeInfo();
+    stream << Clock::serialized(timeInfo.lastModificationTime()) << Clock::serialized(timeInfo.locationChanged())
+           << timeInfo.expires() << Clock::serialized(timeInfo.expiryTime());
+    stream << (entry->group() ? entry->group()->uuid() : QUuid());
+    stream << entry->iconNumber() << entry->iconUuid() << entry->foregroundColor() << entry->backgroundColor()
+           << entry->overrideUrl() << entry->tags() << entry->autoTypeEnabled() << entry->defaultAutoTypeSequence();
+
+    const EntryAttributes* attributes = entry->attributes();
+    for (const QString& key : attributes->keys()) {
+        stream << key << attributes->value(key) << attributes->isProtected(key);
+    }
+    const EntryAttachments* attachments = entry->attachments();
+    for (const QString& key : attachments->keys()) {
+        stream << key << attachments->value(key);
+    }
+    const CustomData* customData = entry->customData();
+    for (const QString& key : customData->keys()) {
+        stream << key << customData->value(key);
+    }
+
+    // History items are never edited, their modification times identify them
+    const QList<TimeInfo> historyTimeInfos = entry->historyTimeInfos();
+    stream << historyTimeInfos.size();
+    for (const TimeInfo& historyTimeInfo : historyTimeInfos) {
+        stream << Clock::serialized(historyTimeInfo.lastModificationTime());
+    }
+
+    return CryptoHash::hash(data, CryptoHash::Sha256).left(MergeBaseDigestSize);
+}
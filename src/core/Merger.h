@@ -19,6 +19,7 @@
 #define KEEPASSXC_MERGER_H
 
 #include "core/Group.h"
+#include <QHash>
 #include <QObject>
 #include <QPointer>
 
@@ -33,11 +34,19 @@ public:
     Merger(const Group* sourceGroup, Group* targetGroup);
     void setForcedMergeMode(Group::MergeMode mode);
     void resetForcedMergeMode();
+    /**
+     * Remember a digest of every source entry in the target database after
+     * merging, and skip source entries that did not change since then on the
+     * next merge of the same source. Applies when the whole source database is
+     * merged, either into the target database or into one of its groups.
+     */
+    void setUseMergeBase(bool useMergeBase);
     QStringList merge();
 
 private:
     typedef QString Change;
     typedef QStringList ChangeList;
+    typedef QHash<QUuid, QByteArray> EntryDigests;
 
     struct MergeContext
     {
@@ -51,6 +60,12 @@ private:
     ChangeList mergeGroup(const MergeContext& context);
     ChangeList mergeDeletions(const MergeContext& context);
     ChangeList mergeMetadata(const MergeContext& context);
+    bool isMergeBaseUsable() const;
+    QString mergeBaseKey() const;
+    void loadMergeBase();
+    void storeMergeBase();
+    bool isUnchangedSinceMergeBase(const Entry* sourceEntry) const;
+    static QByteArray entryDigest(const Entry* entry);
     bool markOlderEntry(Entry* entry);
     bool mergeHistory(const Entry* sourceEntry, Entry* targetEntry, Group::MergeMode mergeMethod);
     void moveEntry(Entry* entry, Group* targetGroup);
@@ -75,6 +90,8 @@ private:
 private:
     MergeContext m_context;
     Group::MergeMode m_mode;
+    bool m_useMergeBase;
+    EntryDigests m_mergeBase;
 };
 
 #endif // KEEPASSXC_MERGER_H
@@ -17,22 +17,60 @@
 
 #include "Metadata.h"
 #include <QApplication>
+#include <QBuffer>
 #include <QtCore/QCryptographicHash>
 
 #include "core/Clock.h"
 #include "core/DatabaseIcons.h"
 #include "core/Entry.h"
+#include "core/MemoryUsage.h"
 #include "core/Group.h"
 #include "core/Tools.h"
 
 const int Metadata::DefaultHistoryMaxItems = 10;
 const int Metadata::DefaultHistoryMaxSize = 6 * 1024 * 1024;
 
+namespace
+{
+    // Number of decoded custom icons kept in memory
+    const int CustomIconImageCacheSize = 128;
+
+    // Number of custom icon pixmaps kept in memory for each icon size
+    int customIconPixmapCacheSize(IconSize size)
+    {
+        switch (size) {
+        case IconSize::Large:
+            return 128;
+        case IconSize::Medium:
+            return 256;
+        default:
+            return 512;
+        }
+    }
+
+    QByteArray encodeIcon(const QImage& image)
+    {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        // TODO: check !image.save()
+        image.save(&buffer, "PNG");
+        buffer.close();
+        return data;
+    }
+} // namespace
+
 Metadata::Metadata(QObject* parent)
     : QObject(parent)
+    , m_customIconsHashesValid(true)
     , m_customData(new CustomData(this))
     , m_updateDatetime(true)
 {
+    m_customIconImages.setMaxCost(CustomIconImageCacheSize);
+    for (int size = IconSize::Default; size <= IconSize::Large; ++size) {
+        m_customIconPixmaps[size].setMaxCost(customIconPixmapCacheSize(static_cast<IconSize>(size)));
+    }
+
     init();
     connect(m_customData, SIGNAL(customDataModified()), SIGNAL(metadataModified()));
 }
@@ -65,10 +103,11 @@ void Metadata::init()
 void Metadata::clear()
 {
     init();
-    m_customIcons.clear();
-    m_customIconsRaw.clear();
+    m_customIconsData.clear();
     m_customIconsOrder.clear();
     m_customIconsHashes.clear();
+    m_customIconsHashesValid = true;
+    clearCustomIconCaches();
     m_customData->clear();
 }
 
@@ -107,6 +146,36 @@ void Metadata::copyAttributesFrom(const Metadata* other)
     m_data = other->m_data;
 }
 
+/**
+ * Copy all data from other, including custom icons, custom data and all
+ * dates. Group pointers are resolved by uuid in the given root group.
+ *
+ * @param other metadata to copy
+ * @param rootGroup root group of the database this metadata belongs to
+ */
+void Metadata::copyAllFrom(const Metadata* other, Group* rootGroup)
+{
+    auto findGroup = [rootGroup](const Group* group) -> Group* {
+        return group && rootGroup ? rootGroup->findGroupByUuid(group->uuid()) : nullptr;
+    };
+
+    m_data = other->m_data;
+    m_customIconsData = other->m_customIconsData;
+    m_customIconsOrder = other->m_customIconsOrder;
+    m_customIconsHashes = other->m_customIconsHashes;
+    m_customIconsHashesValid = other->m_customIconsHashesValid;
+    clearCustomIconCaches();
+    m_recycleBin = findGroup(other->m_recycleBin);
+    m_recycleBinChanged = other->m_recycleBinChanged;
+    m_entryTemplatesGroup = findGroup(other->m_entryTemplatesGroup);
+    m_entryTemplatesGroupChanged = other->m_entryTemplatesGroupChanged;
+    m_lastSelectedGroup = findGroup(other->m_lastSelectedGroup);
+    m_lastTopVisibleGroup = findGroup(other->m_lastTopVisibleGroup);
+    m_masterKeyChanged = other->m_masterKeyChanged;
+    m_settingsChanged = other->m_settingsChanged;
+    m_customData->copyDataFrom(other->m_customData);
+}
+
 QString Metadata::generator() const
 {
     return m_data.generator;
@@ -177,9 +246,36 @@ bool Metadata::protectNotes() const
     return m_data.protectNotes;
 }
 
+/**
+ * Decoded image of a custom icon. The icon is decoded from its stored PNG
+ * data on first use and kept in a bounded cache afterwards.
+ *
+ * @param uuid uuid of the custom icon
+ * @return decoded image, or a null image if the icon does not exist
+ */
 QImage Metadata::customIcon(const QUuid& uuid) const
 {
-    return m_customIconsRaw.value(uuid);
+    if (!hasCustomIcon(uuid)) {
+        return {};
+    }
+
+    QImage* image = m_customIconImages.object(uuid);
+    if (!image) {
+        image = new QImage(QImage::fromData(m_customIconsData.value(uuid)));
+        m_customIconImages.insert(uuid, image);
+    }
+    return *image;
+}
+
+/**
+ * Encoded PNG data of a custom icon as it is stored in the database.
+ *
+ * @param uuid uuid of the custom icon
+ * @return encoded icon data
+ */
+QByteArray Metadata::customIconData(const QUuid& uuid) const
+{
+    return m_customIconsData.value(uuid);
 }
 
 QPixmap Metadata::customIconPixmap(const QUuid& uuid, IconSize size) const
@@ -187,7 +283,24 @@ QPixmap Metadata::customIconPixmap(const QUuid& uuid, IconSize size) const
     if (!hasCustomIcon(uuid)) {
         return {};
     }
-    return m_customIcons.value(uuid).pixmap(databaseIcons()->iconSize(size));
+
+    // TODO: This check can go away when we move all QIcon handling outside of core
+    // On older versions of Qt, loading a QPixmap from QImage outside of a GUI
+    // environment causes ASAN to fail and crash on nullptr violation
+    static bool isGui = qApp->inherits("QGuiApplication");
+    if (!isGui) {
+        return {};
+    }
+
+    QPixmap* pixmap = m_customIconPixmaps[size].object(uuid);
+    if (!pixmap) {
+        // Render through a QIcon with a pre-baked resolution to respect the device pixel ratio
+        QImage image = customIcon(uuid);
+        QIcon icon(QPixmap::fromImage(image.scaled(64, 64, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
+        pixmap = new QPixmap(icon.pixmap(databaseIcons()->iconSize(size)));
+        m_customIconPixmaps[size].insert(uuid, pixmap);
+    }
+    return *pixmap;
 }
 
 QHash<QUuid, QPixmap> Metadata::customIconsPixmaps(IconSize size) const
@@ -203,7 +316,7 @@ QHash<QUuid, QPixmap> Metadata::customIconsPixmaps(IconSize size) const
 
 bool Metadata::hasCustomIcon(const QUuid& uuid) const
 {
-    return m_customIconsRaw.contains(uuid);
+    return m_customIconsData.contains(uuid);
 }
 
 QList<QUuid> Metadata::customIconsOrder() const
@@ -211,6 +324,32 @@ QList<QUuid> Metadata::customIconsOrder() const
     return m_customIconsOrder;
 }
 
+/**
+ * Add the encoded custom icons, the decoded icons currently held in the
+ * caches and the database custom data to the usage.
+ */
+void Metadata::addMemoryUsage(MemoryUsage& usage) const
+{
+    for (const QByteArray& data : m_customIconsData) {
+        usage.customIconsRaw += data.size();
+    }
+
+    const QList<QUuid> images = m_customIconImages.keys();
+    for (const QUuid& uuid : images) {
+        const QImage* image = m_customIconImages.object(uuid);
+        usage.customIconsDecoded += static_cast<qint64>(image->bytesPerLine()) * image->height();
+    }
+    for (const auto& pixmaps : m_customIconPixmaps) {
+        const QList<QUuid> keys = pixmaps.keys();
+        for (const QUuid& uuid : keys) {
+            const QPixmap* pixmap = pixmaps.object(uuid);
+            usage.customIconsDecoded += static_cast<qint64>(pixmap->width()) * pixmap->height() * pixmap->depth() / 8;
+        }
+    }
+
+    usage.customData += MemoryUsage::textSize(m_customData->dataSize());
+}
+
 bool Metadata::recycleBinEnabled() const
 {
     return m_data.recycleBinEnabled;
@@ -360,30 +499,45 @@ void Metadata::setProtectNotes(bool value)
 }
 
 void Metadata::addCustomIcon(const QUuid& uuid, const QImage& image)
+{
+    const QByteArray data = encodeIcon(image);
+
+    bool hashesValid = m_customIconsHashesValid;
+    addCustomIcon(uuid, data);
+
+    // The image is already decoded, keep it around for the first lookup
+    m_customIconImages.insert(uuid, new QImage(image));
+    if (hashesValid) {
+        m_customIconsHashes[hashIconData(data)] = uuid;
+        m_customIconsHashesValid = true;
+    }
+}
+
+/**
+ * Add a custom icon from its encoded image data. The data is stored as is
+ * and only decoded once the icon is used.
+ *
+ * @param uuid uuid of the new custom icon
+ * @param data encoded PNG data of the icon
+ */
+void Metadata::addCustomIcon(const QUuid& uuid, const QByteArray& data)
 {
     Q_ASSERT(!uuid.isNull());
-    Q_ASSERT(!m_customIconsRaw.contains(uuid));
+    Q_ASSERT(!m_customIconsData.contains(uuid));
 
-    m_customIconsRaw[uuid] = image;
-    // remove all uuids to prevent duplicates in release mode
-    m_customIconsOrder.removeAll(uuid);
+    // remove all uuids to prevent duplicates in release mode, only searching the list if needed
+    if (m_customIconsData.contains(uuid)) {
+        m_customIconsOrder.removeAll(uuid);
+    }
+    m_customIconsData[uuid] = data;
     m_customIconsOrder.append(uuid);
-    // Associate image hash to uuid
-    QByteArray hash = hashImage(image);
-    m_customIconsHashes[hash] = uuid;
-    Q_ASSERT(m_customIconsRaw.count() == m_customIconsOrder.count());
+    // Image hashes are computed lazily on the next lookup
+    m_customIconsHashesValid = false;
+    Q_ASSERT(m_customIconsData.count() == m_customIconsOrder.count());
 
-    // TODO: This check can go away when we move all QIcon handling outside of core
-    // On older versions of Qt, loading a QPixmap from QImage outside of a GUI
-    // environment causes ASAN to fail and crash on nullptr violation
-    static bool isGui = qApp->inherits("QGuiApplication");
-    if (isGui) {
-        // Generate QIcon with pre-baked resolutions
-        auto basePixmap = QPixmap::fromImage(image.scaled(64, 64, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-        QIcon icon(basePixmap);
-        m_customIcons.insert(uuid, icon);
-    } else {
-        m_customIcons.insert(uuid, QIcon());
+    m_customIconImages.remove(uuid);
+    for (auto& pixmaps : m_customIconPixmaps) {
+        pixmaps.remove(uuid);
     }
 
     emit metadataModified();
@@ -392,24 +546,42 @@ void Metadata::addCustomIcon(const QUuid& uuid, const QImage& image)
 void Metadata::removeCustomIcon(const QUuid& uuid)
 {
     Q_ASSERT(!uuid.isNull());
-    Q_ASSERT(m_customIconsRaw.contains(uuid));
+    Q_ASSERT(m_customIconsData.contains(uuid));
+
+    m_customIconsData.remove(uuid);
+    m_customIconsOrder.removeAll(uuid);
+    m_customIconsHashesValid = false;
+    Q_ASSERT(m_customIconsData.count() == m_customIconsOrder.count());
 
-    // Remove hash record only if this is the same uuid
-    QByteArray hash = hashImage(m_customIconsRaw[uuid]);
-    if (m_customIconsHashes.contains(hash) && m_customIconsHashes[hash] == uuid) {
-        m_customIconsHashes.remove(hash);
+    m_customIconImages.remove(uuid);
+    for (auto& pixmaps : m_customIconPixmaps) {
+        pixmaps.remove(uuid);
     }
 
-    m_customIcons.remove(uuid);
-    m_customIconsRaw.remove(uuid);
-    m_customIconsOrder.removeAll(uuid);
-    Q_ASSERT(m_customIconsRaw.count() == m_customIconsOrder.count());
     emit metadataModified();
 }
 
+/**
+ * Find a custom icon with the same image. Icons are compared by their PNG
+ * data, so the stored icons don't need to be decoded; an identical image
+ * saved by another application may not be found.
+ *
+ * @param candidate image to look for
+ * @return uuid of the icon or a null uuid
+ */
 QUuid Metadata::findCustomIcon(const QImage& candidate)
 {
-    QByteArray hash = hashImage(candidate);
+    if (!m_customIconsHashesValid) {
+        // Associate data hash to uuid, later icons take precedence
+        m_customIconsHashes.clear();
+        m_customIconsHashes.reserve(m_customIconsOrder.size());
+        for (const QUuid& uuid : asConst(m_customIconsOrder)) {
+            m_customIconsHashes[hashIconData(m_customIconsData.value(uuid))] = uuid;
+        }
+        m_customIconsHashesValid = true;
+    }
+
+    QByteArray hash = hashIconData(encodeIcon(candidate));
     return m_customIconsHashes.value(hash, QUuid());
 }
 
@@ -419,18 +591,21 @@ void Metadata::copyCustomIcons(const QSet<QUuid>& iconList, const Metadata* othe
         Q_ASSERT(otherMetadata->hasCustomIcon(uuid));
 
         if (!hasCustomIcon(uuid) && otherMetadata->hasCustomIcon(uuid)) {
-            addCustomIcon(uuid, otherMetadata->customIcon(uuid));
+            addCustomIcon(uuid, otherMetadata->customIconData(uuid));
         }
     }
 }
 
-QByteArray Metadata::hashImage(const QImage& image)
+void Metadata::clearCustomIconCaches()
+{
+    m_customIconImages.clear();
+    for (auto& pixmaps : m_customIconPixmaps) {
+        pixmaps.clear();
+    }
+}
+
+QByteArray Metadata::hashIconData(const QByteArray& data)
 {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
-    auto data = QByteArray(reinterpret_cast<const char*>(image.bits()), static_cast<int>(image.sizeInBytes()));
-#else
-    auto data = QByteArray(reinterpret_cast<const char*>(image.bits()), image.byteCount());
-#endif
     return QCryptographicHash::hash(data, QCryptographicHash::Md5);
 }
 
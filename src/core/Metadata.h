@@ -18,6 +18,7 @@
 #ifndef KEEPASSX_METADATA_H
 #define KEEPASSX_METADATA_H
 
+#include <QCache>
 #include <QDateTime>
 #include <QHash>
 #include <QIcon>
@@ -33,6 +34,7 @@
 
 class Database;
 class Group;
+class MemoryUsage;
 
 class Metadata : public QObject
 {
@@ -84,10 +86,12 @@ public:
     bool protectUrl() const;
     bool protectNotes() const;
     QImage customIcon(const QUuid& uuid) const;
+    QByteArray customIconData(const QUuid& uuid) const;
     bool hasCustomIcon(const QUuid& uuid) const;
     QPixmap customIconPixmap(const QUuid& uuid, IconSize size = IconSize::Default) const;
     QHash<QUuid, QPixmap> customIconsPixmaps(IconSize size = IconSize::Default) const;
     QList<QUuid> customIconsOrder() const;
+    void addMemoryUsage(MemoryUsage& usage) const;
     bool recycleBinEnabled() const;
     Group* recycleBin();
     const Group* recycleBin() const;
@@ -123,6 +127,7 @@ public:
     void setProtectUrl(bool value);
     void setProtectNotes(bool value);
     void addCustomIcon(const QUuid& uuid, const QImage& image);
+    void addCustomIcon(const QUuid& uuid, const QByteArray& data);
     void removeCustomIcon(const QUuid& uuid);
     void copyCustomIcons(const QSet<QUuid>& iconList, const Metadata* otherMetadata);
     QUuid findCustomIcon(const QImage& candidate);
@@ -148,6 +153,7 @@ public:
      * - Settings changed date
      */
     void copyAttributesFrom(const Metadata* other);
+    void copyAllFrom(const Metadata* other, Group* rootGroup);
 
 signals:
     void metadataModified();
@@ -156,14 +162,22 @@ private:
     template <class P, class V> bool set(P& property, const V& value);
     template <class P, class V> bool set(P& property, const V& value, QDateTime& dateTime);
 
-    QByteArray hashImage(const QImage& image);
+    static QByteArray hashIconData(const QByteArray& data);
+    void clearCustomIconCaches();
 
     MetadataData m_data;
 
-    QHash<QUuid, QIcon> m_customIcons;
-    QHash<QUuid, QImage> m_customIconsRaw;
+    /**
+     * Custom icons are kept as their encoded PNG bytes. Images and pixmaps are
+     * decoded on first use and held in bounded LRU caches, so the decoding work
+     * follows the icons that are actually shown rather than all stored icons.
+     */
+    QHash<QUuid, QByteArray> m_customIconsData;
     QList<QUuid> m_customIconsOrder;
     QHash<QByteArray, QUuid> m_customIconsHashes;
+    bool m_customIconsHashesValid;
+    mutable QCache<QUuid, QImage> m_customIconImages;
+    mutable QCache<QUuid, QPixmap> m_customIconPixmaps[IconSize::Large + 1];
 
     QPointer<Group> m_recycleBin;
     QDateTime m_recycleBinChanged;
@@ -0,0 +1,272 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MultiDatabaseSearch.h"
+
+#include "core/AsyncTask.h"
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Global.h"
+#include "core/Group.h"
+
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace
+{
+    using RankedEntry = QPair<int, Entry*>;
+    using RankedUuid = QPair<int, QUuid>;
+
+    // Only the best matches of every database are shown
+    const int MaxResultsPerDatabase = 100;
+
+    QVector<RankedUuid> searchDatabase(EntrySearcher* searcher, const QString& searchString, const Group* root)
+    {
+        const QList<Entry*> entries = searcher->searchRanked(searchString, root, MaxResultsPerDatabase);
+        QVector<RankedUuid> results;
+        results.reserve(entries.size());
+        for (const Entry* entry : entries) {
+            results.append(qMakePair(searcher->score(entry), entry->uuid()));
+        }
+        return results;
+    }
+} // namespace
+
+MultiDatabaseSearch::MultiDatabaseSearch(QObject* parent)
+    : QObject(parent)
+{
+    m_searchPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+
+MultiDatabaseSearch::~MultiDatabaseSearch()
+{
+    cancel();
+    m_searchPool.waitForDone();
+}
+
+/**
+ * Replace the searched databases. The search is repeated if there is one.
+ */
+void MultiDatabaseSearch::setDatabases(const QList<QSharedPointer<Database>>& databases)
+{
+    cancel();
+    m_searchPool.waitForDone();
+
+    for (const QPointer<Database>& db : asConst(m_databases)) {
+        if (db) {
+            disconnect(db.data(), nullptr, this, nullptr);
+        }
+    }
+    m_databases.clear();
+
+    QHash<const Database*, QVector<RankedEntry>> databaseResults;
+    for (const QSharedPointer<Database>& db : databases) {
+        if (!db || m_databases.contains(db.data())) {
+            continue;
+        }
+
+        Database* database = db.data();
+        m_databases.append(database);
+        if (m_databaseResults.contains(database)) {
+            databaseResults.insert(database, m_databaseResults.value(database));
+        }
+
+        // Searches run on a snapshot, repeat a running one so its results follow the tree
+        connect(database, &Database::entryAboutToRemove, this, [this, database](Entry* entry) {
+            interrupt();
+            removeEntry(database, entry);
+        });
+        connect(database, &Database::groupAboutToAdd, this, [this] { interrupt(); });
+        connect(database, &Database::groupAboutToRemove, this, [this] { interrupt(); });
+        connect(database, &Database::groupAboutToMove, this, [this] { interrupt(); });
+        connect(database, &Database::dataAboutToBeReleased, this, [this, database] {
+            interrupt();
+            removeDatabase(database);
+        });
+    }
+    m_databaseResults = databaseResults;
+
+    updateResults();
+    if (!m_searchString.isEmpty()) {
+        search(m_searchString);
+    }
+}
+
+void MultiDatabaseSearch::setCaseSensitive(bool state)
+{
+    m_caseSensitive = state;
+}
+
+/**
+ * Search all databases in parallel. The results of the previous search stay
+ * in place until the new results of their database are available.
+ *
+ * @param searchString search terms, an empty string clears the results
+ */
+void MultiDatabaseSearch::search(const QString& searchString)
+{
+    cancel();
+    m_searchString = searchString;
+
+    if (searchString.isEmpty()) {
+        m_databaseResults.clear();
+        updateResults();
+        emit finished(0);
+        return;
+    }
+
+    const quint64 searchId = m_searchId;
+    m_timer.start();
+    for (const QPointer<Database>& db : asConst(m_databases)) {
+        if (!db || !db->rootGroup()) {
+            continue;
+        }
+
+        QPointer<Database> database = db;
+        QSharedPointer<const Database> snapshot = database->readSnapshot();
+        auto searcher = QSharedPointer<EntrySearcher>::create(m_caseSensitive);
+        searcher->setCancelToken(m_cancelToken);
+        // The index follows entries through signals, create it in the GUI thread
+        snapshot->searchIndex();
+        ++m_pending;
+
+        AsyncTask::runThenCallback(
+            &m_searchPool,
+            [searcher, searchString, snapshot] {
+                return searchDatabase(searcher.data(), searchString, snapshot->rootGroup());
+            },
+            this,
+            [this, searchId, database](const QVector<RankedUuid>& found) {
+                // Superseded or cancelled
+                if (searchId != m_searchId || !database) {
+                    return;
+                }
+
+                // Entries deleted since the snapshot are left out
+                QVector<RankedEntry> results;
+                results.reserve(found.size());
+                for (const RankedUuid& result : found) {
+                    Entry* entry = database->rootGroup()->findEntryByUuid(result.second);
+                    if (entry) {
+                        results.append(qMakePair(result.first, entry));
+                    }
+                }
+
+                m_databaseResults.insert(database.data(), results);
+                --m_pending;
+                updateResults();
+                if (m_pending == 0) {
+                    emit finished(static_cast<int>(m_timer.elapsed()));
+                }
+            });
+    }
+
+    if (m_pending == 0) {
+        m_databaseResults.clear();
+        updateResults();
+        emit finished(0);
+    }
+}
+
+/**
+ * Cancel the running search, it stops as soon as possible and its results are ignored.
+ */
+void MultiDatabaseSearch::cancel()
+{
+    m_cancelToken.cancel();
+    m_cancelToken = EntrySearcher::CancelToken();
+    ++m_searchId;
+    m_pending = 0;
+}
+
+/**
+ * @return merged results of all databases, best matches first
+ */
+const QList<Entry*>& MultiDatabaseSearch::results() const
+{
+    return m_results;
+}
+
+bool MultiDatabaseSearch::isRunning() const
+{
+    return m_pending > 0;
+}
+
+/**
+ * Stop a running search when a database tree changes, the search is
+ * repeated on a new snapshot once the change is done.
+ */
+void MultiDatabaseSearch::interrupt()
+{
+    if (m_pending == 0) {
+        return;
+    }
+
+    cancel();
+
+    QTimer::singleShot(0, this, [this] {
+        if (m_pending == 0 && !m_searchString.isEmpty()) {
+            search(m_searchString);
+        }
+    });
+}
+
+void MultiDatabaseSearch::removeEntry(const Database* db, Entry* entry)
+{
+    auto it = m_databaseResults.find(db);
+    if (it == m_databaseResults.end()) {
+        return;
+    }
+
+    auto ranked = std::find_if(it->begin(), it->end(), [entry](const RankedEntry& result) {
+        return result.second == entry;
+    });
+    if (ranked != it->end()) {
+        it->erase(ranked);
+        m_results.removeOne(entry);
+    }
+}
+
+void MultiDatabaseSearch::removeDatabase(Database* db)
+{
+    disconnect(db, nullptr, this, nullptr);
+    m_databases.removeAll(db);
+    m_databaseResults.remove(db);
+    updateResults();
+}
+
+void MultiDatabaseSearch::updateResults()
+{
+    QVector<RankedEntry> ranked;
+    for (const QPointer<Database>& db : asConst(m_databases)) {
+        if (db) {
+            ranked += m_databaseResults.value(db.data());
+        }
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const RankedEntry& lhs, const RankedEntry& rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    m_results.clear();
+    m_results.reserve(ranked.size());
+    for (const RankedEntry& result : asConst(ranked)) {
+        m_results.append(result.second);
+    }
+    emit resultsChanged();
+}
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_MULTIDATABASESEARCH_H
+#define KEEPASSXC_MULTIDATABASESEARCH_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QVector>
+
+#include "core/EntrySearcher.h"
+
+class Database;
+class Entry;
+
+/**
+ * Search several databases at once. Every database is searched on a thread
+ * of its own with its search index, the merged results are updated as each
+ * database finishes. Every database contributes its best ranked matches, see
+ * EntrySearcher::searchRanked(), ties keep the order of the databases.
+ *
+ * Like the search of a single database widget, the threads search a
+ * snapshot from Database::readSnapshot() and the matches are mapped back to
+ * the live entries. A running search is repeated when the tree of one of
+ * the databases changes.
+ */
+class MultiDatabaseSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MultiDatabaseSearch(QObject* parent = nullptr);
+    ~MultiDatabaseSearch() override;
+
+    void setDatabases(const QList<QSharedPointer<Database>>& databases);
+    void setCaseSensitive(bool state);
+    void search(const QString& searchString);
+    void cancel();
+
+    const QList<Entry*>& results() const;
+    bool isRunning() const;
+
+signals:
+    void resultsChanged();
+    void finished(int elapsedMs);
+
+private:
+    void interrupt();
+    void removeEntry(const Database* db, Entry* entry);
+    void removeDatabase(Database* db);
+    void updateResults();
+
+    QList<QPointer<Database>> m_databases;
+    // latest ranked results of every database with their scores, kept until its next search finishes
+    QHash<const Database*, QVector<QPair<int, Entry*>>> m_databaseResults;
+    QList<Entry*> m_results;
+    QString m_searchString;
+    bool m_caseSensitive = false;
+
+    QThreadPool m_searchPool;
+    EntrySearcher::CancelToken m_cancelToken;
+    quint64 m_searchId = 0;
+    int m_pending = 0;
+    QElapsedTimer m_timer;
+};
+
+#endif // KEEPASSXC_MULTIDATABASESEARCH_H
@@ -21,13 +21,196 @@
 #include "NetworkManager.h"
 
 #include <QCoreApplication>
+#include <QHash>
+#include <QHostInfo>
+#include <QNetworkDiskCache>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QStandardPaths>
+
+namespace
+{
+    // same as the connection limit of QNetworkAccessManager, so requests queue here by priority
+    const int MaxRequestsPerHost = 6;
+    const int MaxActiveRequests = 16;
+    // request slots that are kept free of bulk requests
+    const int ReservedRequests = 4;
+    const qint64 DiskCacheSize = 50 * 1024 * 1024;
+
+    struct PendingRequest
+    {
+        QNetworkRequest request;
+        QPointer<QObject> context;
+        std::function<void(QNetworkReply*)> started;
+    };
+
+    /**
+     * Start requests on the shared network access manager by priority,
+     * within a limit of active requests per host and in total.
+     */
+    class RequestScheduler
+    {
+    public:
+        void schedule(const PendingRequest& pending, NetworkPriority priority)
+        {
+            m_pending[static_cast<int>(priority)].append(pending);
+            startPending();
+
+            // A request to a host without active requests that did not start has to wait,
+            // resolve the host meanwhile so the manager finds the lookup in the host info cache
+            const QString host = pending.request.url().host();
+            if (!m_activeByHost.contains(host)) {
+                prefetchHost(host);
+            }
+        }
+
+        bool cancel(QObject* context)
+        {
+            bool cancelled = false;
+            for (auto& queue : m_pending) {
+                for (auto it = queue.begin(); it != queue.end();) {
+                    if (it->context == context) {
+                        it = queue.erase(it);
+                        cancelled = true;
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            return cancelled;
+        }
+
+    private:
+        void startPending()
+        {
+            for (int priority = 0; priority < PriorityCount; ++priority) {
+                const int limit = activeLimit(priority);
+                // indexed, as the started callbacks may schedule further requests
+                auto& queue = m_pending[priority];
+                for (int i = 0; i < queue.size() && m_active < limit;) {
+                    if (!queue.at(i).context) {
+                        queue.removeAt(i);
+                        continue;
+                    }
+
+                    const QString host = queue.at(i).request.url().host();
+                    if (m_activeByHost.value(host) >= MaxRequestsPerHost) {
+                        ++i;
+                        continue;
+                    }
+
+                    start(queue.takeAt(i), host);
+                }
+            }
+        }
+
+        void start(const PendingRequest& pending, const QString& host)
+        {
+            ++m_active;
+            ++m_activeByHost[host];
+
+            QNetworkReply* reply = getNetMgr()->get(pending.request);
+
+            // release the slot once, whether the reply finishes or is deleted first
+            QSharedPointer<bool> released(new bool(false));
+            auto release = [this, host, released] {
+                if (*released) {
+                    return;
+                }
+                *released = true;
+                --m_active;
+                if (--m_activeByHost[host] <= 0) {
+                    m_activeByHost.remove(host);
+                }
+                startPending();
+            };
+            QObject::connect(reply, &QNetworkReply::finished, getNetMgr(), release, Qt::QueuedConnection);
+            QObject::connect(reply, &QObject::destroyed, getNetMgr(), release, Qt::QueuedConnection);
+
+            pending.started(reply);
+        }
+
+        static int activeLimit(int priority)
+        {
+            if (priority == static_cast<int>(NetworkPriority::Bulk)) {
+                return MaxActiveRequests - ReservedRequests;
+            }
+            return MaxActiveRequests;
+        }
+
+        static void prefetchHost(const QString& host)
+        {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+            if (!host.isEmpty()) {
+                QHostInfo::lookupHost(host, getNetMgr(), [](const QHostInfo&) {});
+            }
+#else
+            Q_UNUSED(host);
+#endif
+        }
+
+        static const int PriorityCount = 3;
+
+        QList<PendingRequest> m_pending[PriorityCount];
+        QHash<QString, int> m_activeByHost;
+        int m_active = 0;
+    };
+
+    RequestScheduler& scheduler()
+    {
+        static RequestScheduler instance;
+        return instance;
+    }
+} // namespace
 
 QNetworkAccessManager* g_netMgr = nullptr;
 QNetworkAccessManager* getNetMgr()
 {
     if (!g_netMgr) {
         g_netMgr = new QNetworkAccessManager(QCoreApplication::instance());
+
+        const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        if (!cacheDir.isEmpty()) {
+            auto diskCache = new QNetworkDiskCache(g_netMgr);
+            diskCache->setCacheDirectory(cacheDir + "/network");
+            diskCache->setMaximumCacheSize(DiskCacheSize);
+            g_netMgr->setCache(diskCache);
+        }
     }
     return g_netMgr;
 }
+
+/**
+ * Start a GET request on the shared network access manager as soon as
+ * the request limits of its host and priority class allow it. Requests
+ * may use HTTP/2, so requests to one server share a connection.
+ *
+ * @param request request to send
+ * @param priority priority class of the request
+ * @param context the request is dropped if it is destroyed before the request starts
+ * @param started called with the reply once the request has been sent
+ */
+void scheduleNetworkGet(const QNetworkRequest& request,
+                        NetworkPriority priority,
+                        QObject* context,
+                        std::function<void(QNetworkReply*)> started)
+{
+    QNetworkRequest http2Request(request);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    http2Request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+#elif QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    http2Request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#endif
+    scheduler().schedule({http2Request, context, std::move(started)}, priority);
+}
+
+/**
+ * Drop the requests of the context that have not been started yet.
+ *
+ * @return true if there were pending requests
+ */
+bool cancelNetworkRequests(QObject* context)
+{
+    return scheduler().cancel(context);
+}
 #endif
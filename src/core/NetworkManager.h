@@ -26,7 +26,26 @@
 #include <QNetworkReply>
 #include <QNetworkRequest>
 
+#include <functional>
+
+/**
+ * Priority classes of network requests. Pending requests of a higher
+ * class are started first, and bulk requests never take the last free
+ * request slots, so interactive fetches don't wait for bulk downloads.
+ */
+enum class NetworkPriority
+{
+    Interactive,
+    Normal,
+    Bulk
+};
+
 QNetworkAccessManager* getNetMgr();
+void scheduleNetworkGet(const QNetworkRequest& request,
+                        NetworkPriority priority,
+                        QObject* context,
+                        std::function<void(QNetworkReply*)> started);
+bool cancelNetworkRequests(QObject* context);
 #else
 Q_STATIC_ASSERT_X(false, "Qt Networking used when WITH_XC_NETWORKING is disabled!");
 #endif
@@ -17,11 +17,12 @@
 
 #include "PassphraseGenerator.h"
 
-#include <QFile>
-#include <QTextStream>
+#include <QThread>
+#include <QtConcurrent>
 #include <cmath>
 
 #include "core/Resources.h"
+#include "core/Wordlist.h"
 #include "crypto/Random.h"
 
 const char* PassphraseGenerator::DefaultSeparator = " ";
@@ -37,14 +38,14 @@ PassphraseGenerator::PassphraseGenerator()
 
 double PassphraseGenerator::estimateEntropy(int wordCount)
 {
-    if (m_wordlist.isEmpty()) {
+    if (!m_wordlist || m_wordlist->isEmpty()) {
         return 0.0;
     }
     if (wordCount < 1) {
         wordCount = m_wordCount;
     }
 
-    return std::log2(m_wordlist.size()) * wordCount;
+    return std::log2(m_wordlist->size()) * wordCount;
 }
 
 void PassphraseGenerator::setWordCount(int wordCount)
@@ -57,22 +58,21 @@ void PassphraseGenerator::setWordCase(PassphraseWordCase wordCase)
     m_wordCase = wordCase;
 }
 
+/**
+ * Use the wordlist at the given path. Wordlists are parsed once and then
+ * shared by all generators until the file changes.
+ *
+ * @param path wordlist file with one word per line
+ */
 void PassphraseGenerator::setWordList(const QString& path)
 {
-    m_wordlist.clear();
-
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    m_wordlist = Wordlist::load(path);
+    if (!m_wordlist) {
         qWarning("Couldn't load passphrase wordlist.");
         return;
     }
 
-    QTextStream in(&file);
-    while (!in.atEnd()) {
-        m_wordlist.append(in.readLine());
-    }
-
-    if (m_wordlist.size() < 4000) {
+    if (m_wordlist->size() < 4000) {
         qWarning("Wordlist too short!");
         return;
     }
@@ -95,14 +95,14 @@ QString PassphraseGenerator::generatePassphrase() const
     Q_ASSERT(isValid());
 
     // In case there was an error loading the wordlist
-    if (m_wordlist.length() == 0) {
+    if (!m_wordlist || m_wordlist->isEmpty()) {
         return QString();
     }
 
     QStringList words;
     for (int i = 0; i < m_wordCount; ++i) {
-        int wordIndex = randomGen()->randomUInt(static_cast<quint32>(m_wordlist.length()));
-        tmpWord = m_wordlist.at(wordIndex);
+        int wordIndex = randomGen()->randomUInt(static_cast<quint32>(m_wordlist->size()));
+        tmpWord = m_wordlist->at(wordIndex);
 
         // convert case
         switch (m_wordCase) {
@@ -123,11 +123,53 @@ QString PassphraseGenerator::generatePassphrase() const
     return words.join(m_separator);
 }
 
+/**
+ * Generate a batch of passphrases with the current settings.
+ * Large batches are split across the global thread pool.
+ *
+ * @param count number of passphrases to generate
+ * @return generated passphrases
+ */
+QStringList PassphraseGenerator::generatePassphrases(int count) const
+{
+    Q_ASSERT(isValid());
+
+    if (count <= 0) {
+        return {};
+    }
+
+    // Make sure the generator is set up before the workers share it
+    randomGen();
+
+    // Below this many passphrases per thread the worker overhead dominates
+    const int minBatchSize = 64;
+    const int workers = qBound(1, count / minBatchSize, QThread::idealThreadCount());
+    QList<QFuture<QStringList>> futures;
+    for (int i = 0; i < workers; ++i) {
+        const int batchSize = count / workers + (i < count % workers ? 1 : 0);
+        futures.append(QtConcurrent::run([this, batchSize] {
+            QStringList batch;
+            batch.reserve(batchSize);
+            for (int j = 0; j < batchSize; ++j) {
+                batch.append(generatePassphrase());
+            }
+            return batch;
+        }));
+    }
+
+    QStringList passphrases;
+    passphrases.reserve(count);
+    for (auto& future : futures) {
+        passphrases.append(future.result());
+    }
+    return passphrases;
+}
+
 bool PassphraseGenerator::isValid() const
 {
     if (m_wordCount == 0) {
         return false;
     }
 
-    return m_wordlist.size() >= 1000;
+    return m_wordlist && m_wordlist->size() >= 1000;
 }
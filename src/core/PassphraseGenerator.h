@@ -19,8 +19,11 @@
 #define KEEPASSX_PASSPHRASEGENERATOR_H
 
 #include <QFlags>
+#include <QSharedPointer>
 #include <QString>
-#include <QVector>
+#include <QStringList>
+
+class Wordlist;
 
 class PassphraseGenerator
 {
@@ -44,6 +47,7 @@ public:
     bool isValid() const;
 
     QString generatePassphrase() const;
+    QStringList generatePassphrases(int count) const;
 
     static constexpr int DefaultWordCount = 7;
     static const char* DefaultSeparator;
@@ -53,7 +57,7 @@ private:
     int m_wordCount;
     PassphraseWordCase m_wordCase;
     QString m_separator;
-    QVector<QString> m_wordlist;
+    QSharedPointer<const Wordlist> m_wordlist;
 };
 
 #endif // KEEPASSX_PASSPHRASEGENERATOR_H
@@ -20,6 +20,24 @@
 
 #include "crypto/Random.h"
 
+#include <QThread>
+#include <QtConcurrent>
+
+namespace
+{
+    // Below this many passwords per thread the worker overhead dominates
+    const int MinBatchSize = 64;
+
+    QVector<QChar> flattenGroups(const QVector<PasswordGroup>& groups)
+    {
+        QVector<QChar> passwordChars;
+        for (const PasswordGroup& group : groups) {
+            passwordChars << group;
+        }
+        return passwordChars;
+    }
+} // namespace
+
 const char* PasswordGenerator::DefaultAdditionalChars = "";
 const char* PasswordGenerator::DefaultExcludedChars = "";
 
@@ -70,15 +88,59 @@ QString PasswordGenerator::generatePassword() const
     Q_ASSERT(isValid());
 
     const QVector<PasswordGroup> groups = passwordGroups();
+    return generatePassword(groups, flattenGroups(groups));
+}
 
-    QVector<QChar> passwordChars;
-    for (const PasswordGroup& group : groups) {
-        for (QChar ch : group) {
-            passwordChars.append(ch);
-        }
+/**
+ * Generate a batch of passwords with the current settings.
+ *
+ * The character groups are only computed once and large batches
+ * are split across the global thread pool.
+ *
+ * @param count number of passwords to generate
+ * @return generated passwords
+ */
+QStringList PasswordGenerator::generatePasswords(int count) const
+{
+    Q_ASSERT(isValid());
+
+    if (count <= 0) {
+        return {};
+    }
+
+    const QVector<PasswordGroup> groups = passwordGroups();
+    const QVector<QChar> passwordChars = flattenGroups(groups);
+
+    // Make sure the generator is set up before the workers share it
+    randomGen();
+
+    const int workers = qBound(1, count / MinBatchSize, QThread::idealThreadCount());
+    QList<QFuture<QStringList>> futures;
+    for (int i = 0; i < workers; ++i) {
+        const int batchSize = count / workers + (i < count % workers ? 1 : 0);
+        futures.append(QtConcurrent::run([this, &groups, &passwordChars, batchSize] {
+            QStringList batch;
+            batch.reserve(batchSize);
+            for (int j = 0; j < batchSize; ++j) {
+                batch.append(generatePassword(groups, passwordChars));
+            }
+            return batch;
+        }));
     }
 
+    QStringList passwords;
+    passwords.reserve(count);
+    for (auto& future : futures) {
+        passwords.append(future.result());
+    }
+    return passwords;
+}
+
+QString PasswordGenerator::generatePassword(const QVector<PasswordGroup>& groups,
+                                            const QVector<QChar>& passwordChars) const
+{
     QString password;
+    password.reserve(m_length);
 
     if (m_flags & CharFromEveryGroup) {
         for (const auto& group : groups) {
@@ -21,6 +21,7 @@
 
 #include <QFlags>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 
 typedef QVector<QChar> PasswordGroup;
@@ -66,12 +67,14 @@ public:
     bool isValid() const;
 
     QString generatePassword() const;
+    QStringList generatePasswords(int count) const;
 
     static const int DefaultLength = 32;
     static const char* DefaultAdditionalChars;
     static const char* DefaultExcludedChars;
 
 private:
+    QString generatePassword(const QVector<PasswordGroup>& groups, const QVector<QChar>& passwordChars) const;
     QVector<PasswordGroup> passwordGroups() const;
     int numCharClasses() const;
 
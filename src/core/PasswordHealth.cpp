@@ -103,12 +103,30 @@ PasswordHealth::Quality PasswordHealth::quality() const
  * than can be derived from the password itself (re-use, expiry).
  */
 HealthChecker::HealthChecker(QSharedPointer<Database> db)
+    : m_db(db)
 {
-    // Build the cache of re-used passwords
-    for (const auto* entry : db->rootGroup()->entriesRecursive()) {
-        if (!entry->isRecycled() && !entry->isAttributeReference("Password")) {
-            m_reuse[entry->password()]
-                << QApplication::tr("Used in %1/%2").arg(entry->group()->hierarchy().join('/'), entry->title());
+    // Only the entries modified since the last report are looked at again
+    auto* cache = db->healthCache();
+    cache->update(db->rootGroup());
+
+    // The entries using a password are only read here, evaluate() runs on other threads
+    const auto users = cache->passwordUsers();
+    for (auto it = users.constBegin(); it != users.constEnd(); ++it) {
+        const auto& used = it.value();
+        if (used.size() < 2) {
+            continue;
+        }
+
+        Reuse& reuse = m_reuse[it.key()];
+        reuse.count = used.size();
+        // Add the first 20 uses of the password to prevent the details display from growing too large
+        for (int i = 0; i < used.size(); ++i) {
+            reuse.details.append(
+                QApplication::tr("Used in %1/%2").arg(used[i]->group()->hierarchy().join('/'), used[i]->title()));
+            if (i == 19) {
+                reuse.details.append("…");
+                break;
+            }
         }
     }
 }
@@ -128,23 +146,18 @@ QSharedPointer<PasswordHealth> HealthChecker::evaluate(const Entry* entry) const
 
     // First analyse the password itself
     const auto pwd = entry->password();
-    auto health = QSharedPointer<PasswordHealth>(new PasswordHealth(pwd));
+    auto health = QSharedPointer<PasswordHealth>(new PasswordHealth(m_db->healthCache()->entropy(pwd)));
 
     // Second, if the password is in the database more than once,
     // reduce the score accordingly
-    const auto& used = m_reuse[pwd];
-    const auto count = used.size();
-    if (count > 1) {
+    const auto reuse = m_reuse.constFind(PasswordHealthCache::passwordKey(pwd));
+    if (reuse != m_reuse.constEnd()) {
+        const auto count = reuse->count;
         constexpr auto penalty = 15;
         health->adjustScore(-penalty * (count - 1));
         health->addScoreReason(QApplication::tr("Password is used %1 times").arg(QString::number(count)));
-        // Add the first 20 uses of the password to prevent the details display from growing too large
-        for (int i = 0; i < used.size(); ++i) {
-            health->addScoreDetails(used[i]);
-            if (i == 19) {
-                health->addScoreDetails("…");
-                break;
-            }
+        for (const auto& details : reuse->details) {
+            health->addScoreDetails(details);
         }
 
         // Don't allow re-used passwords to be considered "good"
@@ -18,10 +18,11 @@
 #ifndef KEEPASSX_PASSWORDHEALTH_H
 #define KEEPASSX_PASSWORDHEALTH_H
 
-#include <QHash>
 #include <QSharedPointer>
 #include <QStringList>
 
+#include "core/PasswordHealthCache.h"
+
 class Database;
 class Entry;
 
@@ -108,12 +109,20 @@ class HealthChecker
 public:
     explicit HealthChecker(QSharedPointer<Database>);
 
-    // Get the health status of an entry in the database
+    // Get the health status of an entry in the database or in a snapshot of it, thread-safe
     QSharedPointer<PasswordHealth> evaluate(const Entry* entry) const;
 
 private:
-    // To determine password re-use: first = password, second = entries that use it
-    QHash<QString, QStringList> m_reuse;
+    struct Reuse
+    {
+        int count = 0;
+        // where the password is used, taken on the thread of the database
+        QStringList details;
+    };
+
+    QSharedPointer<Database> m_db;
+    // To determine password re-use: the passwords used by more than one entry
+    QHash<QByteArray, Reuse> m_reuse;
 };
 
 #endif // KEEPASSX_PASSWORDHEALTH_H
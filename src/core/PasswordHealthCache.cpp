@@ -0,0 +1,160 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PasswordHealthCache.h"
+
+#include "core/Entry.h"
+#include "core/Group.h"
+#include "crypto/Random.h"
+#include "zxcvbn.h"
+
+#include <QMessageAuthenticationCode>
+
+PasswordHealthCache::PasswordHealthCache(QObject* parent)
+    : QObject(parent)
+{
+}
+
+/**
+ * Keyed hash under which the cache knows the password. The key is random
+ * per process, so the hashes kept in memory can't be looked up in
+ * precomputed tables and no plaintext copies of the passwords are kept.
+ *
+ * @return HMAC-SHA256 of the password
+ */
+QByteArray PasswordHealthCache::passwordKey(const QString& password)
+{
+    static const QByteArray key = randomGen()->randomArray(32);
+    return QMessageAuthenticationCode::hash(password.toUtf8(), key, QCryptographicHash::Sha256);
+}
+
+/**
+ * Bring the cache up to date with the entries below the given group,
+ * not counting the recycle bin. Must be called from the thread owning
+ * the entries, before their password users are read.
+ *
+ * @param root group whose entries are cached
+ */
+void PasswordHealthCache::update(const Group* root)
+{
+    ++m_generation;
+    root->forEachEntryRecursive(
+        [this](const Entry* entry) -> bool {
+            updateEntry(entry);
+            return true;
+        },
+        true);
+
+    // Forget the entries that were not visited: removed, recycled or deleted
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->generation != m_generation) {
+            removeUser(it.value(), it.key());
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @return entries using each password, implicitly shared so that the
+ *         reports can read it from other threads while the cache is updated
+ */
+PasswordHealthCache::PasswordUsers PasswordHealthCache::passwordUsers() const
+{
+    return m_users;
+}
+
+/**
+ * zxcvbn entropy of the password, estimated once per password and kept
+ * while an entry uses it. Thread-safe.
+ */
+double PasswordHealthCache::entropy(const QString& password) const
+{
+    const auto key = passwordKey(password);
+    {
+        QMutexLocker locker(&m_entropiesMutex);
+        auto cached = m_entropies.constFind(key);
+        if (cached != m_entropies.constEnd()) {
+            return cached.value();
+        }
+    }
+
+    // Estimate outside of the lock so that other threads can proceed
+    const double entropy = ZxcvbnMatch(password.toLatin1(), nullptr, nullptr);
+
+    QMutexLocker locker(&m_entropiesMutex);
+    m_entropies.insert(key, entropy);
+    return entropy;
+}
+
+/**
+ * @return number of cached entries
+ */
+int PasswordHealthCache::size() const
+{
+    return m_entries.size();
+}
+
+void PasswordHealthCache::clear()
+{
+    m_entries.clear();
+    m_users.clear();
+    QMutexLocker locker(&m_entropiesMutex);
+    m_entropies.clear();
+}
+
+void PasswordHealthCache::updateEntry(const Entry* entry)
+{
+    auto it = m_entries.find(entry);
+    if (it != m_entries.end()) {
+        it->generation = m_generation;
+        if (it->revision == entry->revision()) {
+            return;
+        }
+        removeUser(it.value(), entry);
+        m_entries.erase(it);
+    }
+
+    CachedEntry cached;
+    cached.revision = entry->revision();
+    cached.generation = m_generation;
+    // Passwords that reference another entry are not a re-use
+    if (!entry->isAttributeReference(EntryAttributes::PasswordKey)) {
+        cached.passwordKey = passwordKey(entry->password());
+        m_users[cached.passwordKey].append(entry);
+    }
+    m_entries.insert(entry, cached);
+}
+
+void PasswordHealthCache::removeUser(const CachedEntry& cached, const Entry* entry)
+{
+    if (cached.passwordKey.isEmpty()) {
+        return;
+    }
+
+    auto users = m_users.find(cached.passwordKey);
+    if (users == m_users.end()) {
+        return;
+    }
+    users->removeOne(entry);
+    if (users->isEmpty()) {
+        m_users.erase(users);
+        QMutexLocker locker(&m_entropiesMutex);
+        m_entropies.remove(cached.passwordKey);
+    }
+}
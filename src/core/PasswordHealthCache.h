@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_PASSWORDHEALTHCACHE_H
+#define KEEPASSXC_PASSWORDHEALTHCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+
+class Entry;
+class Group;
+
+/**
+ * Password data of the entries of a database that the health reports
+ * need: which entries share a password and the entropy of every password.
+ *
+ * Passwords are only known by their hash. update() re-hashes the entries
+ * whose revision changed since the previous update and forgets entries
+ * that are gone, so opening a report after a few edits only touches the
+ * edited entries and zxcvbn only runs for passwords it has not seen yet.
+ */
+class PasswordHealthCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef QHash<QByteArray, QList<const Entry*>> PasswordUsers;
+
+    explicit PasswordHealthCache(QObject* parent = nullptr);
+
+    static QByteArray passwordKey(const QString& password);
+
+    void update(const Group* root);
+    PasswordUsers passwordUsers() const;
+    double entropy(const QString& password) const;
+    int size() const;
+    void clear();
+
+private:
+    struct CachedEntry
+    {
+        quint64 revision;
+        quint64 generation;
+        QByteArray passwordKey;
+    };
+
+    void updateEntry(const Entry* entry);
+    void removeUser(const CachedEntry& cached, const Entry* entry);
+
+    QHash<const Entry*, CachedEntry> m_entries;
+    // entries outside of the recycle bin by the keyed hash of their password
+    PasswordUsers m_users;
+    quint64 m_generation = 0;
+    // zxcvbn entropy by password hash, also filled from report threads
+    mutable QHash<QByteArray, double> m_entropies;
+    mutable QMutex m_entropiesMutex;
+};
+
+#endif // KEEPASSXC_PASSWORDHEALTHCACHE_H
@@ -0,0 +1,39 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_PROTECTEDVALUESOURCE_H
+#define KEEPASSXC_PROTECTEDVALUESOURCE_H
+
+#include <QByteArray>
+
+/**
+ * Decrypts protected string values that were kept encrypted when
+ * the database was read.
+ *
+ * Values are addressed by their offset in the inner random stream of
+ * the database file. Implementations must be safe to call from multiple
+ * threads.
+ */
+class ProtectedValueSource
+{
+public:
+    virtual ~ProtectedValueSource() = default;
+
+    virtual QByteArray decrypt(const QByteArray& ciphertext, quint64 offset) const = 0;
+};
+
+#endif // KEEPASSXC_PROTECTEDVALUESOURCE_H
@@ -0,0 +1,198 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SecureArena.h"
+
+#include "core/Global.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <sodium.h>
+
+namespace
+{
+    // slot sizes are powers of two between MinSlotSize and MaxSlotSize
+    constexpr std::size_t MinSlotSize = 16;
+    constexpr std::size_t MaxSlotSize = 2048;
+    constexpr std::size_t ChunkSize = 16 * 1024;
+} // namespace
+
+SecureArena::SecureArena()
+{
+    // idempotent, required before sodium_malloc() can be used
+    if (sodium_init() < 0) {
+        qWarning("SecureArena: failed to initialize libsodium");
+    }
+}
+
+SecureArena::~SecureArena()
+{
+    for (const auto& chunk : asConst(m_chunks)) {
+        sodium_free(chunk.data);
+    }
+}
+
+SecureArena* SecureArena::instance()
+{
+    static SecureArena arena;
+    return &arena;
+}
+
+/**
+ * Allocate memory for sensitive data. The memory is not initialized.
+ *
+ * @param size number of bytes
+ * @return pointer to the memory or nullptr if the allocation failed
+ */
+void* SecureArena::allocate(std::size_t size)
+{
+    const int slot = slotClass(size);
+    if (slot < 0) {
+        return sodium_malloc(size);
+    }
+
+    const std::size_t slotSize = MinSlotSize << slot;
+    QMutexLocker locker(&m_mutex);
+    for (auto& chunk : m_chunks) {
+        if (chunk.slotSize == slotSize && !chunk.freeSlots.isEmpty()) {
+            const int index = chunk.freeSlots.takeLast();
+            return chunk.data + static_cast<std::size_t>(index) * slotSize;
+        }
+    }
+
+    Chunk chunk;
+    chunk.data = static_cast<unsigned char*>(sodium_malloc(ChunkSize));
+    if (!chunk.data) {
+        return nullptr;
+    }
+    chunk.slotSize = slotSize;
+    const int slots = static_cast<int>(ChunkSize / slotSize);
+    chunk.freeSlots.reserve(slots);
+    for (int i = slots - 1; i > 0; --i) {
+        chunk.freeSlots.append(i);
+    }
+    m_chunks.append(chunk);
+    return chunk.data;
+}
+
+/**
+ * Zero and release memory obtained from allocate().
+ *
+ * @param ptr pointer returned by allocate()
+ * @param size size that was passed to allocate()
+ */
+void SecureArena::deallocate(void* ptr, std::size_t size)
+{
+    if (!ptr) {
+        return;
+    }
+
+    const int slot = slotClass(size);
+    if (slot < 0) {
+        // sodium_free() zeroes the region
+        sodium_free(ptr);
+        return;
+    }
+
+    const std::size_t slotSize = MinSlotSize << slot;
+    auto* bytes = static_cast<unsigned char*>(ptr);
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_chunks.size(); ++i) {
+        Chunk& chunk = m_chunks[i];
+        if (chunk.slotSize != slotSize || bytes < chunk.data || bytes >= chunk.data + ChunkSize) {
+            continue;
+        }
+
+        sodium_memzero(bytes, slotSize);
+        chunk.freeSlots.append(static_cast<int>(static_cast<std::size_t>(bytes - chunk.data) / slotSize));
+        if (chunk.freeSlots.size() == static_cast<int>(ChunkSize / slotSize) && hasSpareChunk(slotSize, i)) {
+            // chunk is unused, release it in one go
+            sodium_free(chunk.data);
+            m_chunks.remove(i);
+        }
+        return;
+    }
+
+    Q_ASSERT_X(false, "SecureArena::deallocate", "pointer was not allocated by the arena");
+}
+
+/**
+ * @return number of chunks currently held by the arena
+ */
+int SecureArena::chunkCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_chunks.size();
+}
+
+/**
+ * Zero the contents of a byte array and clear it. Data shared with
+ * other byte arrays is left alone, since wiping it would detach the
+ * array and only zero the copy.
+ *
+ * @param data byte array to wipe
+ */
+void SecureArena::wipe(QByteArray& data)
+{
+    if (data.isDetached() && !data.isEmpty()) {
+        sodium_memzero(data.data(), static_cast<std::size_t>(data.size()));
+    }
+    data.clear();
+}
+
+/**
+ * Zero the contents of a string and clear it. Data shared with
+ * other strings is left alone.
+ *
+ * @param string string to wipe
+ */
+void SecureArena::wipe(QString& string)
+{
+    if (string.isDetached() && !string.isEmpty()) {
+        sodium_memzero(string.data(), static_cast<std::size_t>(string.size()) * sizeof(QChar));
+    }
+    string.clear();
+}
+
+/**
+ * Check whether there is another chunk with free slots of the given size,
+ * so empty chunks are not freed and reallocated over and over again.
+ * The mutex must be locked by the caller.
+ */
+bool SecureArena::hasSpareChunk(std::size_t slotSize, int except) const
+{
+    for (int i = 0; i < m_chunks.size(); ++i) {
+        if (i != except && m_chunks[i].slotSize == slotSize && !m_chunks[i].freeSlots.isEmpty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int SecureArena::slotClass(std::size_t size)
+{
+    if (size > MaxSlotSize) {
+        return -1;
+    }
+
+    int slot = 0;
+    while ((MinSlotSize << slot) < size) {
+        ++slot;
+    }
+    return slot;
+}
@@ -0,0 +1,73 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_SECUREARENA_H
+#define KEEPASSXC_SECUREARENA_H
+
+#include <QMutex>
+#include <QVector>
+
+#include <cstddef>
+
+class QByteArray;
+class QString;
+
+/**
+ * Pooled allocator for sensitive data such as key material.
+ *
+ * Small allocations are served from fixed-size slots in chunks that are
+ * allocated through libsodium, i.e. they are locked into memory and
+ * surrounded by guard pages. A slot is zeroed when it is returned to the
+ * arena; chunks that no longer contain any live slot are zeroed and freed
+ * as a whole. Larger allocations get their own guarded region.
+ *
+ * Sensitive data that lives in Qt containers cannot be placed in the arena.
+ * Use wipe() to zero such buffers before they are released, which does not
+ * rely on the optional global secure delete operator.
+ */
+class SecureArena
+{
+public:
+    static SecureArena* instance();
+
+    void* allocate(std::size_t size);
+    void deallocate(void* ptr, std::size_t size);
+    int chunkCount() const;
+
+    static void wipe(QByteArray& data);
+    static void wipe(QString& string);
+
+private:
+    SecureArena();
+    ~SecureArena();
+    Q_DISABLE_COPY(SecureArena)
+
+    struct Chunk
+    {
+        unsigned char* data;
+        std::size_t slotSize;
+        QVector<int> freeSlots;
+    };
+
+    bool hasSpareChunk(std::size_t slotSize, int except) const;
+    static int slotClass(std::size_t size);
+
+    mutable QMutex m_mutex;
+    QVector<Chunk> m_chunks;
+};
+
+#endif // KEEPASSXC_SECUREARENA_H
@@ -19,14 +19,44 @@
 
 #include "core/Global.h"
 
+/**
+ * Receives every multiplexed signal through a dynamic slot per route.
+ *
+ * The router has no moc generated methods of its own, so every method index past
+ * QObject's methods identifies a route and is handed back to the multiplexer.
+ */
+class SignalMultiplexer::Router : public QObject
+{
+public:
+    explicit Router(SignalMultiplexer* multiplexer)
+        : m_multiplexer(multiplexer)
+    {
+    }
+
+    int qt_metacall(QMetaObject::Call call, int id, void** args) override
+    {
+        id = QObject::qt_metacall(call, id, args);
+        if (id < 0 || call != QMetaObject::InvokeMetaMethod) {
+            return id;
+        }
+
+        m_multiplexer->dispatch(id, sender(), args);
+        return -1;
+    }
+
+private:
+    SignalMultiplexer* m_multiplexer;
+};
+
 SignalMultiplexer::SignalMultiplexer()
+    : m_router(new Router(this))
 {
 }
 
 SignalMultiplexer::~SignalMultiplexer()
 {
-    // disconnect all connections
-    setCurrentObject(nullptr);
+    // deleting the router drops every route connection at once
+    m_router.reset();
 }
 
 QObject* SignalMultiplexer::currentObject() const
@@ -37,27 +67,20 @@ QObject* SignalMultiplexer::currentObject() const
 void SignalMultiplexer::setCurrentObject(QObject* object)
 {
     // remove all Connections from the list whose senders/receivers have been deleted
-    QMutableListIterator<Connection> i = m_connections;
-    while (i.hasNext()) {
-        const Connection& con = i.next();
-
-        if (!con.sender && !con.receiver) {
-            i.remove();
+    QList<int> deadConnections;
+    for (auto it = m_connections.constBegin(); it != m_connections.constEnd(); ++it) {
+        if (!it->sender && !it->receiver) {
+            deadConnections << it.key();
         }
     }
-
-    if (m_currentObject) {
-        for (const Connection& con : asConst(m_connections)) {
-            disconnect(con);
-        }
+    for (int id : asConst(deadConnections)) {
+        removeConnection(id);
     }
 
     m_currentObject = object;
 
     if (object) {
-        for (const Connection& con : asConst(m_connections)) {
-            connect(con);
-        }
+        wireObject(object);
     }
 }
 
@@ -69,11 +92,8 @@ void SignalMultiplexer::connect(QObject* sender, const char* signal, const char*
     con.slot = slot;
     con.sender = sender;
     con.signal = signal;
-    m_connections << con;
-
-    if (m_currentObject) {
-        connect(con);
-    }
+    con.toCurrentObject = true;
+    addConnection(con);
 }
 
 void SignalMultiplexer::connect(const char* signal, QObject* receiver, const char* slot)
@@ -84,65 +104,169 @@ void SignalMultiplexer::connect(const char* signal, QObject* receiver, const cha
     con.receiver = receiver;
     con.signal = signal;
     con.slot = slot;
-    m_connections << con;
-
-    if (m_currentObject) {
-        connect(con);
-    }
+    con.toCurrentObject = false;
+    addConnection(con);
 }
 
 void SignalMultiplexer::disconnect(QObject* sender, const char* signal, const char* slot)
 {
     Q_ASSERT(sender);
 
-    QMutableListIterator<Connection> i = m_connections;
-    while (i.hasNext()) {
-        const Connection& con = i.next();
-
-        if (con.sender == sender && qstrcmp(con.signal, signal) == 0 && qstrcmp(con.slot, slot) == 0) {
-            if (m_currentObject) {
-                disconnect(con);
-            }
-            i.remove();
+    QList<int> matches;
+    for (auto it = m_connections.constBegin(); it != m_connections.constEnd(); ++it) {
+        if (it->toCurrentObject && it->sender == sender && qstrcmp(it->signal, signal) == 0
+            && qstrcmp(it->slot, slot) == 0) {
+            matches << it.key();
         }
     }
+    for (int id : asConst(matches)) {
+        removeConnection(id);
+    }
 }
 
 void SignalMultiplexer::disconnect(const char* signal, QObject* receiver, const char* slot)
 {
     Q_ASSERT(receiver);
 
-    QMutableListIterator<Connection> i = m_connections;
-    while (i.hasNext()) {
-        const Connection& con = i.next();
-
-        if (con.receiver == receiver && qstrcmp(con.signal, signal) == 0 && qstrcmp(con.slot, slot) == 0) {
-            if (m_currentObject) {
-                disconnect(con);
-            }
-            i.remove();
+    QList<int> matches;
+    for (auto it = m_connections.constBegin(); it != m_connections.constEnd(); ++it) {
+        if (!it->toCurrentObject && it->receiver == receiver && qstrcmp(it->signal, signal) == 0
+            && qstrcmp(it->slot, slot) == 0) {
+            matches << it.key();
         }
     }
+    for (int id : asConst(matches)) {
+        removeConnection(id);
+    }
 }
 
-void SignalMultiplexer::connect(const Connection& con)
+/**
+ * Register a route and connect it to the router. Sender routes are connected once
+ * to their fixed sender, routes from the current object are connected to every
+ * object that has been current so far.
+ */
+int SignalMultiplexer::addConnection(const Connection& con)
 {
     Q_ASSERT(con.sender || con.receiver);
 
-    if (con.sender) {
-        QObject::connect(con.sender, con.signal, m_currentObject, con.slot);
+    const int id = m_nextId++;
+    m_connections.insert(id, con);
+
+    if (con.toCurrentObject) {
+        wire(con.sender, con.signal, id, true);
     } else {
-        QObject::connect(m_currentObject, con.signal, con.receiver, con.slot);
+        for (QObject* object : asConst(m_wiredObjects)) {
+            wire(object, con.signal, id, true);
+        }
     }
+
+    return id;
 }
 
-void SignalMultiplexer::disconnect(const Connection& con)
+void SignalMultiplexer::removeConnection(int id)
 {
-    Q_ASSERT(con.sender || con.receiver);
+    const Connection con = m_connections.take(id);
+
+    if (con.toCurrentObject) {
+        if (con.sender) {
+            wire(con.sender, con.signal, id, false);
+        }
+    } else {
+        for (QObject* object : asConst(m_wiredObjects)) {
+            wire(object, con.signal, id, false);
+        }
+    }
+}
+
+/**
+ * Connect all routes leaving the current object to a newly seen object. This happens
+ * once per object, later switches only change which object the router accepts.
+ */
+void SignalMultiplexer::wireObject(QObject* object)
+{
+    if (m_wiredObjects.contains(object)) {
+        return;
+    }
+
+    m_wiredObjects.insert(object);
+    QObject::connect(
+        object, &QObject::destroyed, m_router.data(), [this](QObject* obj) { m_wiredObjects.remove(obj); });
+
+    for (auto it = m_connections.constBegin(); it != m_connections.constEnd(); ++it) {
+        if (!it->toCurrentObject) {
+            wire(object, it->signal, it.key(), true);
+        }
+    }
+}
+
+void SignalMultiplexer::wire(QObject* sender, const char* signal, int id, bool connect)
+{
+    const QByteArray signature = QMetaObject::normalizedSignature(signal + 1);
+    const int signalIndex = sender->metaObject()->indexOfSignal(signature.constData());
+    if (signalIndex < 0) {
+        qWarning("SignalMultiplexer: No such signal %s::%s", sender->metaObject()->className(), signature.constData());
+        return;
+    }
+
+    const int method = QObject::staticMetaObject.methodCount() + id;
+    if (connect) {
+        QMetaObject::connect(sender, signalIndex, m_router.data(), method);
+    } else {
+        QMetaObject::disconnect(sender, signalIndex, m_router.data(), method);
+    }
+}
+
+void SignalMultiplexer::dispatch(int id, QObject* sender, void** args)
+{
+    auto it = m_connections.find(id);
+    if (it == m_connections.end() || !m_currentObject) {
+        return;
+    }
 
-    if (con.sender) {
-        QObject::disconnect(con.sender, con.signal, m_currentObject, con.slot);
+    QObject* target;
+    if (it->toCurrentObject) {
+        target = m_currentObject;
+    } else if (sender == m_currentObject) {
+        target = it->receiver;
     } else {
-        QObject::disconnect(m_currentObject, con.signal, con.receiver, con.slot);
+        // signal from an object that is not current anymore
+        return;
+    }
+
+    if (!target) {
+        return;
+    }
+
+    const int index = slotIndex(it.value(), target);
+    if (index >= 0) {
+        QMetaObject::metacall(target, QMetaObject::InvokeMetaMethod, index, args);
     }
 }
+
+/**
+ * Resolve the slot of a route on the target's class. The index is cached per route
+ * because consecutive targets are almost always instances of the same class.
+ */
+int SignalMultiplexer::slotIndex(Connection& con, QObject* target)
+{
+    const QMetaObject* meta = target->metaObject();
+    if (con.slotClass == meta) {
+        return con.slotIndex;
+    }
+
+    const QByteArray signal = QMetaObject::normalizedSignature(con.signal + 1);
+    const QByteArray slot = QMetaObject::normalizedSignature(con.slot + 1);
+    con.slotClass = meta;
+    con.slotIndex = meta->indexOfMethod(slot.constData());
+    if (con.slotIndex < 0) {
+        qWarning("SignalMultiplexer: No such slot %s::%s", meta->className(), slot.constData());
+    } else if (!QMetaObject::checkConnectArgs(signal.constData(), slot.constData())) {
+        qWarning("SignalMultiplexer: Incompatible sender/receiver arguments %s --> %s::%s",
+                 signal.constData(),
+                 meta->className(),
+                 slot.constData());
+        con.slotIndex = -1;
+    }
+
+    return con.slotIndex;
+}
@@ -18,9 +18,19 @@
 #ifndef KEEPASSX_SIGNALMULTIPLEXER_H
 #define KEEPASSX_SIGNALMULTIPLEXER_H
 
+#include <QHash>
 #include <QObject>
 #include <QPointer>
+#include <QScopedPointer>
+#include <QSet>
 
+/**
+ * Routes signals between a fixed set of objects and whichever object is current.
+ *
+ * Every route is connected exactly once to an internal router object which dispatches
+ * on the current object when the signal fires, so switching the current object is a
+ * pointer swap instead of a disconnect/reconnect cycle over every route.
+ */
 class SignalMultiplexer
 {
 public:
@@ -36,19 +46,33 @@ public:
     void disconnect(const char* signal, QObject* receiver, const char* slot);
 
 private:
+    class Router;
+
     struct Connection
     {
         QPointer<QObject> sender;
         QPointer<QObject> receiver;
         const char* signal;
         const char* slot;
+        // Routes from a fixed sender into the current object, otherwise from the current object to a receiver
+        bool toCurrentObject;
+        // Slot index resolved on the last class the route was dispatched to
+        const QMetaObject* slotClass = nullptr;
+        int slotIndex = -1;
     };
 
-    void connect(const Connection& con);
-    void disconnect(const Connection& con);
+    int addConnection(const Connection& con);
+    void removeConnection(int id);
+    void wireObject(QObject* object);
+    void wire(QObject* sender, const char* signal, int id, bool connect);
+    void dispatch(int id, QObject* sender, void** args);
+    int slotIndex(Connection& con, QObject* target);
 
+    QScopedPointer<Router> m_router;
     QPointer<QObject> m_currentObject;
-    QList<Connection> m_connections;
+    QHash<int, Connection> m_connections;
+    QSet<QObject*> m_wiredObjects;
+    int m_nextId = 0;
 
     Q_DISABLE_COPY(SignalMultiplexer)
 };
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StartupTrace.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QTextStream>
+
+#include "core/Global.h"
+
+namespace StartupTrace
+{
+    namespace
+    {
+        struct Phase
+        {
+            QString name;
+            qint64 elapsed;
+        };
+
+        QElapsedTimer& timer()
+        {
+            static QElapsedTimer timer;
+            if (!timer.isValid()) {
+                timer.start();
+            }
+            return timer;
+        }
+
+        QList<Phase>& phases()
+        {
+            static QList<Phase> phases;
+            return phases;
+        }
+    } // namespace
+
+    bool isEnabled()
+    {
+        static const bool enabled = qEnvironmentVariableIsSet("KEEPASSXC_STARTUP_TRACE");
+        return enabled;
+    }
+
+    /**
+     * Record the end of a startup phase. The first mark starts the clock.
+     */
+    void mark(const QString& phase)
+    {
+        if (!isEnabled()) {
+            return;
+        }
+        phases().append({phase, timer().elapsed()});
+    }
+
+    /**
+     * Print the recorded phases with their duration and clear them.
+     */
+    void report()
+    {
+        if (!isEnabled() || phases().isEmpty()) {
+            return;
+        }
+
+        QTextStream err(stderr, QIODevice::WriteOnly);
+        err << "Startup trace:" << endl;
+        qint64 previous = 0;
+        for (const Phase& phase : asConst(phases())) {
+            err << QString("%1 ms (+%2 ms) %3")
+                       .arg(phase.elapsed, 6)
+                       .arg(phase.elapsed - previous, 5)
+                       .arg(phase.name)
+                << endl;
+            previous = phase.elapsed;
+        }
+        phases().clear();
+    }
+} // namespace StartupTrace
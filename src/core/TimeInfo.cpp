@@ -17,13 +17,17 @@
 
 #include "TimeInfo.h"
 
+#include <limits>
+
 #include "core/Clock.h"
 
+const qint64 TimeInfo::InvalidTime = std::numeric_limits<qint64>::min();
+
 TimeInfo::TimeInfo()
-    : m_expires(false)
-    , m_usageCount(0)
+    : m_usageCount(0)
+    , m_expires(false)
 {
-    QDateTime now = Clock::currentDateTimeUtc();
+    const qint64 now = toMSecs(Clock::currentDateTimeUtc());
     m_lastModificationTime = now;
     m_creationTime = now;
     m_lastAccessTime = now;
@@ -31,24 +35,58 @@ TimeInfo::TimeInfo()
     m_locationChanged = now;
 }
 
+/**
+ * @param dateTime time to convert
+ * @return milliseconds since the epoch, InvalidTime for an invalid time
+ */
+qint64 TimeInfo::toMSecs(const QDateTime& dateTime)
+{
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : InvalidTime;
+}
+
+/**
+ * @param msecs milliseconds since the epoch or InvalidTime
+ * @return time in UTC, invalid for InvalidTime
+ */
+QDateTime TimeInfo::toDateTime(qint64 msecs)
+{
+    return msecs == InvalidTime ? QDateTime() : Clock::datetimeUtc(msecs);
+}
+
+/**
+ * Integer version of Clock::serialized(): drop the milliseconds that are
+ * not stored in the database file.
+ *
+ * @param msecs milliseconds since the epoch or InvalidTime
+ * @return msecs rounded down to whole seconds
+ */
+qint64 TimeInfo::serialized(qint64 msecs)
+{
+    if (msecs == InvalidTime) {
+        return msecs;
+    }
+    const qint64 remainder = msecs % 1000;
+    return msecs - (remainder < 0 ? remainder + 1000 : remainder);
+}
+
 QDateTime TimeInfo::lastModificationTime() const
 {
-    return m_lastModificationTime;
+    return toDateTime(m_lastModificationTime);
 }
 
 QDateTime TimeInfo::creationTime() const
 {
-    return m_creationTime;
+    return toDateTime(m_creationTime);
 }
 
 QDateTime TimeInfo::lastAccessTime() const
 {
-    return m_lastAccessTime;
+    return toDateTime(m_lastAccessTime);
 }
 
 QDateTime TimeInfo::expiryTime() const
 {
-    return m_expiryTime;
+    return toDateTime(m_expiryTime);
 }
 
 bool TimeInfo::expires() const
@@ -62,6 +100,21 @@ int TimeInfo::usageCount() const
 }
 
 QDateTime TimeInfo::locationChanged() const
+{
+    return toDateTime(m_locationChanged);
+}
+
+qint64 TimeInfo::lastModificationMSecs() const
+{
+    return m_lastModificationTime;
+}
+
+qint64 TimeInfo::expiryMSecs() const
+{
+    return m_expiryTime;
+}
+
+qint64 TimeInfo::locationChangedMSecs() const
 {
     return m_locationChanged;
 }
@@ -69,25 +122,25 @@ QDateTime TimeInfo::locationChanged() const
 void TimeInfo::setLastModificationTime(const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_lastModificationTime = dateTime;
+    m_lastModificationTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setCreationTime(const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_creationTime = dateTime;
+    m_creationTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setLastAccessTime(const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_lastAccessTime = dateTime;
+    m_lastAccessTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setExpiryTime(const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_expiryTime = dateTime;
+    m_expiryTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setExpires(bool expires)
@@ -103,7 +156,32 @@ void TimeInfo::setUsageCount(int count)
 void TimeInfo::setLocationChanged(const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_locationChanged = dateTime;
+    m_locationChanged = toMSecs(dateTime);
+}
+
+void TimeInfo::setLastModificationTime(qint64 msecs)
+{
+    m_lastModificationTime = msecs;
+}
+
+void TimeInfo::setCreationTime(qint64 msecs)
+{
+    m_creationTime = msecs;
+}
+
+void TimeInfo::setLastAccessTime(qint64 msecs)
+{
+    m_lastAccessTime = msecs;
+}
+
+void TimeInfo::setExpiryTime(qint64 msecs)
+{
+    m_expiryTime = msecs;
+}
+
+void TimeInfo::setLocationChanged(qint64 msecs)
+{
+    m_locationChanged = msecs;
 }
 
 bool TimeInfo::operator==(const TimeInfo& other) const
@@ -118,23 +196,26 @@ bool TimeInfo::operator!=(const TimeInfo& other) const
 
 bool TimeInfo::equals(const TimeInfo& other, CompareItemOptions options) const
 {
+    const bool ignoreMSecs = options.testFlag(CompareItemIgnoreMilliseconds);
+    auto time = [ignoreMSecs](qint64 msecs) { return ignoreMSecs ? serialized(msecs) : msecs; };
+
     // clang-format off
-    if (::compare(m_lastModificationTime, other.m_lastModificationTime, options) != 0) {
+    if (::compare(time(m_lastModificationTime), time(other.m_lastModificationTime), options) != 0) {
         return false;
     }
-    if (::compare(m_creationTime, other.m_creationTime, options) != 0) {
+    if (::compare(time(m_creationTime), time(other.m_creationTime), options) != 0) {
         return false;
     }
-    if (::compare(!options.testFlag(CompareItemIgnoreStatistics), m_lastAccessTime, other.m_lastAccessTime, options) != 0) {
+    if (::compare(!options.testFlag(CompareItemIgnoreStatistics), time(m_lastAccessTime), time(other.m_lastAccessTime), options) != 0) {
         return false;
     }
-    if (::compare(m_expires, m_expiryTime, other.m_expires, other.expiryTime(), options) != 0) {
+    if (::compare(m_expires, time(m_expiryTime), other.m_expires, time(other.m_expiryTime), options) != 0) {
         return false;
     }
     if (::compare(!options.testFlag(CompareItemIgnoreStatistics), m_usageCount, other.m_usageCount, options) != 0) {
         return false;
     }
-    if (::compare(!options.testFlag(CompareItemIgnoreLocation), m_locationChanged, other.m_locationChanged, options) != 0) {
+    if (::compare(!options.testFlag(CompareItemIgnoreLocation), time(m_locationChanged), time(other.m_locationChanged), options) != 0) {
         return false;
     }
     return true;
@@ -23,11 +23,25 @@
 
 #include "core/Compare.h"
 
+/**
+ * Time stamps and usage statistics of an entry or group.
+ *
+ * Times are kept as milliseconds since the epoch in UTC and only turned
+ * into QDateTime objects when asked for one. The *MSecs() accessors and
+ * setters work on the integer form directly, e.g. for comparisons and
+ * parsing. An invalid QDateTime is stored as InvalidTime.
+ */
 class TimeInfo
 {
 public:
+    static const qint64 InvalidTime;
+
     TimeInfo();
 
+    static qint64 toMSecs(const QDateTime& dateTime);
+    static QDateTime toDateTime(qint64 msecs);
+    static qint64 serialized(qint64 msecs);
+
     QDateTime lastModificationTime() const;
     QDateTime creationTime() const;
     QDateTime lastAccessTime() const;
@@ -36,6 +50,10 @@ public:
     int usageCount() const;
     QDateTime locationChanged() const;
 
+    qint64 lastModificationMSecs() const;
+    qint64 expiryMSecs() const;
+    qint64 locationChangedMSecs() const;
+
     bool operator==(const TimeInfo& other) const;
     bool operator!=(const TimeInfo& other) const;
     bool equals(const TimeInfo& other, CompareItemOptions options = CompareItemDefault) const;
@@ -48,14 +66,20 @@ public:
     void setUsageCount(int count);
     void setLocationChanged(const QDateTime& dateTime);
 
+    void setLastModificationTime(qint64 msecs);
+    void setCreationTime(qint64 msecs);
+    void setLastAccessTime(qint64 msecs);
+    void setExpiryTime(qint64 msecs);
+    void setLocationChanged(qint64 msecs);
+
 private:
-    QDateTime m_lastModificationTime;
-    QDateTime m_creationTime;
-    QDateTime m_lastAccessTime;
-    QDateTime m_expiryTime;
-    bool m_expires;
+    qint64 m_lastModificationTime;
+    qint64 m_creationTime;
+    qint64 m_lastAccessTime;
+    qint64 m_expiryTime;
+    qint64 m_locationChanged;
     int m_usageCount;
-    QDateTime m_locationChanged;
+    bool m_expires;
 };
 
 #endif // KEEPASSX_TIMEINFO_H
@@ -24,11 +24,13 @@
 #include "core/Translator.h"
 
 #include "git-info.h"
+#include <QCache>
 #include <QCoreApplication>
 #include <QElapsedTimer>
 #include <QIODevice>
 #include <QImageReader>
 #include <QLocale>
+#include <QMutex>
 #include <QRegularExpression>
 #include <QStringList>
 #include <QSysInfo>
@@ -37,13 +39,46 @@
 #include <cctype>
 
 #ifdef Q_OS_WIN
-#include <windows.h> // for Sleep()
+#include <windows.h> // for Sleep() and GlobalMemoryStatusEx()
 #endif
 
 #ifdef Q_OS_UNIX
 #include <time.h> // for nanosleep()
+#include <unistd.h> // for sysconf()
 #endif
 
+#ifdef Q_OS_MACOS
+#include <sys/sysctl.h> // for sysctlbyname()
+#endif
+
+namespace
+{
+    /**
+     * Get a compiled regular expression. Expressions built before are kept
+     * by their pattern and options, and copies share the compiled pattern,
+     * so a repeated search term is only compiled once per process.
+     */
+    QRegularExpression cachedRegex(const QString& pattern, QRegularExpression::PatternOptions options)
+    {
+        static QMutex mutex;
+        static QCache<QString, QRegularExpression> cache(256);
+
+        const QString key = QString::number(options) + ':' + pattern;
+        QMutexLocker locker(&mutex);
+        if (auto* regex = cache.object(key)) {
+            return *regex;
+        }
+
+        auto* regex = new QRegularExpression(pattern, options);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+        regex->optimize();
+#endif
+        const QRegularExpression result = *regex;
+        cache.insert(key, regex);
+        return result;
+    }
+} // namespace
+
 namespace Tools
 {
     QString debugInfo()
@@ -178,6 +213,24 @@ namespace Tools
         }
     }
 
+    /**
+     * Read and discard data, also works for sequential devices.
+     *
+     * @return true if size bytes could be read
+     */
+    bool skipFromDevice(QIODevice* device, qint64 size)
+    {
+        QByteArray buffer(static_cast<int>(qMin<qint64>(size, 16384)), Qt::Uninitialized);
+        while (size > 0) {
+            qint64 readResult = device->read(buffer.data(), qMin<qint64>(size, buffer.size()));
+            if (readResult <= 0) {
+                return false;
+            }
+            size -= readResult;
+        }
+        return true;
+    }
+
     QString imageReaderFilter()
     {
         const QList<QByteArray> formats = QImageReader::supportedImageFormats();
@@ -235,6 +288,37 @@ namespace Tools
 #endif
     }
 
+    /**
+     * @return installed physical memory in bytes or 0 if it cannot be determined
+     */
+    quint64 physicalMemory()
+    {
+#if defined(Q_OS_WIN)
+        MEMORYSTATUSEX status;
+        status.dwLength = sizeof(status);
+        if (GlobalMemoryStatusEx(&status)) {
+            return status.ullTotalPhys;
+        }
+        return 0;
+#elif defined(Q_OS_MACOS)
+        quint64 memorySize = 0;
+        size_t length = sizeof(memorySize);
+        if (sysctlbyname("hw.memsize", &memorySize, &length, nullptr, 0) == 0) {
+            return memorySize;
+        }
+        return 0;
+#elif defined(Q_OS_UNIX)
+        const long pages = sysconf(_SC_PHYS_PAGES);
+        const long pageSize = sysconf(_SC_PAGE_SIZE);
+        if (pages > 0 && pageSize > 0) {
+            return static_cast<quint64>(pages) * static_cast<quint64>(pageSize);
+        }
+        return 0;
+#else
+        return 0;
+#endif
+    }
+
     void wait(int ms)
     {
         Q_ASSERT(ms >= 0);
@@ -308,12 +392,9 @@ namespace Tools
             pattern = "^" + pattern + "$";
         }
 
-        auto regex = QRegularExpression(pattern);
-        if (!caseSensitive) {
-            regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
-        }
-
-        return regex;
+        return cachedRegex(pattern,
+                           caseSensitive ? QRegularExpression::NoPatternOption
+                                         : QRegularExpression::CaseInsensitiveOption);
     }
 
     QString uuidToHex(const QUuid& uuid)
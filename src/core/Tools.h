@@ -37,11 +37,13 @@ namespace Tools
     QString humanReadableFileSize(qint64 bytes, quint32 precision = 2);
     bool readFromDevice(QIODevice* device, QByteArray& data, int size = 16384);
     bool readAllFromDevice(QIODevice* device, QByteArray& data);
+    bool skipFromDevice(QIODevice* device, qint64 size);
     QString imageReaderFilter();
     bool isHex(const QByteArray& ba);
     bool isBase64(const QByteArray& ba);
     void sleep(int ms);
     void wait(int ms);
+    quint64 physicalMemory();
     bool checkUrlValid(const QString& urlField);
     QString uuidToHex(const QUuid& uuid);
     QUuid hexToUuid(const QString& uuid);
@@ -0,0 +1,230 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
+#include <atomic>
+
+namespace Trace
+{
+    namespace
+    {
+        // Bounds the memory of long sessions, later events are dropped
+        constexpr int MaxEvents = 1000000;
+
+        struct Event
+        {
+            const char* name;
+            char phase;
+            int thread;
+            qint64 timestamp;
+            qint64 value;
+            quint64 allocations;
+            quint64 allocatedBytes;
+        };
+
+        /**
+         * Collects the events of all threads and writes them out when the
+         * process exits, so capturing a trace needs no cooperation from the UI.
+         */
+        class Recorder
+        {
+        public:
+            Recorder()
+                : m_fileName(QString::fromLocal8Bit(qgetenv("KEEPASSXC_TRACE_FILE")))
+            {
+                m_timer.start();
+            }
+
+            ~Recorder()
+            {
+                write();
+            }
+
+            bool isEnabled() const
+            {
+                return !m_fileName.isEmpty();
+            }
+
+            qint64 now() const
+            {
+                return m_timer.nsecsElapsed() / 1000;
+            }
+
+            void add(const Event& event)
+            {
+                QMutexLocker locker(&m_mutex);
+                if (m_events.size() < MaxEvents) {
+                    m_events.append(event);
+                }
+            }
+
+            void write()
+            {
+                QMutexLocker locker(&m_mutex);
+                if (!isEnabled() || m_events.isEmpty()) {
+                    return;
+                }
+
+                QFile file(m_fileName);
+                if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                    qWarning("Trace: could not write %s", qPrintable(m_fileName));
+                    return;
+                }
+
+                const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+                file.write("{\"traceEvents\":[");
+                const char* separator = "\n";
+                for (const Event& event : m_events) {
+                    QByteArray line = separator + QByteArray("{\"name\":\"") + event.name + "\",\"ph\":\"" + event.phase
+                                      + "\",\"pid\":" + pid + ",\"tid\":" + QByteArray::number(event.thread)
+                                      + ",\"ts\":" + QByteArray::number(event.timestamp);
+                    if (event.phase == 'X') {
+                        line += ",\"dur\":" + QByteArray::number(event.value);
+#ifdef WITH_XC_ALLOC_STATS
+                        line += ",\"args\":{\"allocations\":" + QByteArray::number(event.allocations)
+                                + ",\"bytes\":" + QByteArray::number(event.allocatedBytes) + "}";
+#endif
+                    } else {
+                        line += ",\"args\":{\"value\":" + QByteArray::number(event.value) + "}";
+                    }
+                    file.write(line + "}");
+                    separator = ",\n";
+                }
+
+#ifdef WITH_XC_ALLOC_STATS
+                // One global instant event per scope name with the allocation sizes of all its calls
+                for (auto it = m_histograms.constBegin(); it != m_histograms.constEnd(); ++it) {
+                    QByteArray line = separator + QByteArray("{\"name\":\"") + it.key()
+                                      + " allocation sizes\",\"ph\":\"i\",\"s\":\"g\",\"pid\":" + pid
+                                      + ",\"tid\":0,\"ts\":0,\"args\":{";
+                    for (int bucket = 0; bucket < AllocStats::Buckets; ++bucket) {
+                        // The last size class is open ended
+                        const bool last = bucket + 1 == AllocStats::Buckets;
+                        const quint64 limit = AllocStats::bucketLimit(last ? bucket - 1 : bucket);
+                        line += (bucket > 0 ? ",\"" : "\"") + QByteArray(last ? ">" : "<=") + QByteArray::number(limit)
+                                + "\":" + QByteArray::number(it.value().at(bucket));
+                    }
+                    file.write(line + "}}");
+                }
+#endif
+                file.write("\n],\"displayTimeUnit\":\"ms\"}\n");
+            }
+
+#ifdef WITH_XC_ALLOC_STATS
+            void addHistogram(const char* name, const quint64* histogram)
+            {
+                QMutexLocker locker(&m_mutex);
+                QVector<quint64>& total = m_histograms[name];
+                total.resize(AllocStats::Buckets);
+                for (int i = 0; i < AllocStats::Buckets; ++i) {
+                    total[i] += histogram[i];
+                }
+            }
+#endif
+
+        private:
+            const QString m_fileName;
+            QElapsedTimer m_timer;
+            QMutex m_mutex;
+            QVector<Event> m_events;
+#ifdef WITH_XC_ALLOC_STATS
+            QHash<const char*, QVector<quint64>> m_histograms;
+#endif
+        };
+
+        Recorder& recorder()
+        {
+            static Recorder recorder;
+            return recorder;
+        }
+
+        // Small sequential ids read better in trace viewers than native thread handles
+        int currentThread()
+        {
+            static std::atomic<int> nextThread(1);
+            thread_local int thread = nextThread++;
+            return thread;
+        }
+    } // namespace
+
+    bool isEnabled()
+    {
+        static const bool enabled = recorder().isEnabled();
+        return enabled;
+    }
+
+    void addCounter(const char* name, qint64 value)
+    {
+        if (!isEnabled()) {
+            return;
+        }
+        recorder().add({name, 'C', currentThread(), recorder().now(), value, 0, 0});
+    }
+
+    /**
+     * Write all events recorded so far, replacing the previous trace file.
+     * This happens automatically when the process exits.
+     */
+    void flush()
+    {
+        recorder().write();
+    }
+
+    Scope::Scope(const char* name)
+        : m_name(isEnabled() ? name : nullptr)
+        , m_start(m_name ? recorder().now() : 0)
+    {
+#ifdef WITH_XC_ALLOC_STATS
+        m_allocStart = AllocStats::thread();
+#endif
+    }
+
+    Scope::~Scope()
+    {
+        if (!m_name) {
+            return;
+        }
+
+        const qint64 end = recorder().now();
+#ifdef WITH_XC_ALLOC_STATS
+        // Take the difference before recording the event allocates on its own
+        const AllocStats::Counters current = AllocStats::thread();
+        quint64 histogram[AllocStats::Buckets];
+        for (int i = 0; i < AllocStats::Buckets; ++i) {
+            histogram[i] = current.histogram[i] - m_allocStart.histogram[i];
+        }
+        recorder().add({m_name,
+                        'X',
+                        currentThread(),
+                        m_start,
+                        end - m_start,
+                        current.allocations - m_allocStart.allocations,
+                        current.bytes - m_allocStart.bytes});
+        recorder().addHistogram(m_name, histogram);
+#else
+        recorder().add({m_name, 'X', currentThread(), m_start, end - m_start, 0, 0});
+#endif
+    }
+} // namespace Trace
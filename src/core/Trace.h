@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TRACE_H
+#define KEEPASSXC_TRACE_H
+
+#include "config-keepassx.h"
+
+#include <QtGlobal>
+
+#ifdef WITH_XC_ALLOC_STATS
+#include "core/AllocStats.h"
+#endif
+
+/**
+ * Scoped timers and counters of hot code paths, written as Chrome trace event
+ * JSON (readable by chrome://tracing and Perfetto) to the file named by the
+ * KEEPASSXC_TRACE_FILE environment variable when the process exits.
+ *
+ * The TRACE_SCOPE and TRACE_COUNTER macros compile to nothing unless the
+ * build enables WITH_XC_TRACING. With WITH_XC_ALLOC_STATS, scopes also
+ * record the allocations made by their thread while they were open.
+ */
+namespace Trace
+{
+    bool isEnabled();
+    void addCounter(const char* name, qint64 value);
+    void flush();
+
+    /**
+     * Records the time between construction and destruction as one event.
+     * The name must outlive the trace, which string literals do.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name);
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+
+        const char* m_name;
+        qint64 m_start;
+#ifdef WITH_XC_ALLOC_STATS
+        AllocStats::Counters m_allocStart;
+#endif
+    };
+} // namespace Trace
+
+#ifdef WITH_XC_TRACING
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_COUNTER(name, value) Trace::addCounter(name, value)
+#else
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#define TRACE_COUNTER(name, value) static_cast<void>(0)
+#endif
+
+#endif // KEEPASSXC_TRACE_H
@@ -20,6 +20,7 @@
 
 #include <QCoreApplication>
 #include <QDir>
+#include <QFile>
 #include <QLibraryInfo>
 #include <QLocale>
 #include <QRegularExpression>
@@ -27,6 +28,7 @@
 
 #include "config-keepassx.h"
 #include "core/Config.h"
+#include "core/Global.h"
 #include "core/Resources.h"
 
 /**
@@ -66,17 +68,7 @@ void Translator::installTranslators()
  */
 bool Translator::installTranslator(const QStringList& languages, const QString& path)
 {
-    for (const auto& language : languages) {
-        QLocale locale(language);
-        QScopedPointer<QTranslator> translator(new QTranslator(qApp));
-        if (translator->load(locale, "keepassx_", "", path)) {
-            return QCoreApplication::installTranslator(translator.take());
-        } else if (translator->load(locale, "keepassx_", "", QLibraryInfo::location(QLibraryInfo::TranslationsPath))) {
-            return QCoreApplication::installTranslator(translator.take());
-        }
-    }
-
-    return false;
+    return installCatalog(languages, "keepassx_", {path, QLibraryInfo::location(QLibraryInfo::TranslationsPath)});
 }
 
 /**
@@ -89,18 +81,97 @@ bool Translator::installTranslator(const QStringList& languages, const QString&
  */
 bool Translator::installQtTranslator(const QStringList& languages, const QString& path)
 {
+    return installCatalog(languages, "qtbase_", {path, QLibraryInfo::location(QLibraryInfo::TranslationsPath)});
+}
+
+/**
+ * Install the catalog of the first language that is available in one of the search paths.
+ *
+ * Languages are resolved against the catalog list of each path, so only the selected
+ * catalog is ever opened. It is memory-mapped and stays mapped while the translator
+ * is installed.
+ *
+ * @param languages priority-ordered list of languages
+ * @param prefix catalog file name prefix, e.g. "keepassx_"
+ * @param paths priority-ordered list of absolute search paths
+ * @return true on success
+ */
+bool Translator::installCatalog(const QStringList& languages, const QString& prefix, const QStringList& paths)
+{
+    QList<QSet<QString>> catalogs;
+    for (const auto& path : paths) {
+        catalogs.append(availableCatalogs(path));
+    }
+
     for (const auto& language : languages) {
-        QLocale locale(language);
-        QScopedPointer<QTranslator> qtTranslator(new QTranslator(qApp));
-        if (qtTranslator->load(locale, "qtbase_", "", path)) {
-            return QCoreApplication::installTranslator(qtTranslator.take());
-        } else if (qtTranslator->load(locale, "qtbase_", "", QLibraryInfo::location(QLibraryInfo::TranslationsPath))) {
-            return QCoreApplication::installTranslator(qtTranslator.take());
+        // Try the full locale name first, then strip the country and script parts
+        QStringList names;
+        for (QString name : {QString(language).replace('-', '_'), QLocale(language).name()}) {
+            while (!name.isEmpty()) {
+                if (!names.contains(name)) {
+                    names << name;
+                }
+                name.truncate(qMax(name.lastIndexOf('_'), 0));
+            }
+        }
+
+        for (const auto& name : asConst(names)) {
+            for (int i = 0; i < paths.size(); ++i) {
+                if (!catalogs[i].contains(prefix + name)) {
+                    continue;
+                }
+
+                QScopedPointer<QTranslator> translator(new QTranslator(qApp));
+                auto* file = new QFile(QString("%1/%2%3.qm").arg(paths[i], prefix, name), translator.data());
+                uchar* data = nullptr;
+                if (file->open(QIODevice::ReadOnly)) {
+                    data = file->map(0, file->size());
+                }
+                if (data ? translator->load(data, static_cast<int>(file->size()), paths[i])
+                         : translator->load(file->fileName())) {
+                    return QCoreApplication::installTranslator(translator.take());
+                }
+            }
         }
     }
+
     return false;
 }
 
+/**
+ * Get the catalogs shipped in a translations directory.
+ *
+ * The build installs a manifest listing the catalogs next to them. Directories
+ * without a manifest, like the system Qt translations, are listed instead.
+ *
+ * @param path absolute search path
+ * @return catalog file names without the .qm suffix
+ */
+QSet<QString> Translator::availableCatalogs(const QString& path)
+{
+    QSet<QString> catalogs;
+    if (path.isEmpty()) {
+        return catalogs;
+    }
+
+    QFile manifest(path + "/translations.manifest");
+    if (manifest.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        while (!manifest.atEnd()) {
+            const QString name = QString::fromUtf8(manifest.readLine()).trimmed();
+            if (!name.isEmpty()) {
+                catalogs.insert(name);
+            }
+        }
+        return catalogs;
+    }
+
+    const QStringList fileList = QDir(path).entryList({"*.qm"}, QDir::Files);
+    for (const QString& filename : fileList) {
+        catalogs.insert(filename.left(filename.length() - 3));
+    }
+    return catalogs;
+}
+
 /**
  * @return list of pairs of available language codes and names
  */
@@ -109,10 +180,11 @@ QList<QPair<QString, QString>> Translator::availableLanguages()
     QList<QPair<QString, QString>> languages;
     languages.append(QPair<QString, QString>("system", "System default"));
 
-    QRegularExpression regExp("^keepassx_([a-zA-Z_]+)\\.qm$", QRegularExpression::CaseInsensitiveOption);
-    const QStringList fileList = QDir(resources()->dataPath("translations")).entryList();
-    for (const QString& filename : fileList) {
-        QRegularExpressionMatch match = regExp.match(filename);
+    QRegularExpression regExp("^keepassx_([a-zA-Z_]+)$", QRegularExpression::CaseInsensitiveOption);
+    QStringList catalogs = availableCatalogs(resources()->dataPath("translations")).values();
+    catalogs.sort();
+    for (const QString& catalog : asConst(catalogs)) {
+        QRegularExpressionMatch match = regExp.match(catalog);
         if (match.hasMatch()) {
             QString langcode = match.captured(1);
             if (langcode == "en") {
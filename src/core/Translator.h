@@ -20,6 +20,7 @@
 
 #include <QLocale>
 #include <QPair>
+#include <QSet>
 #include <QString>
 
 class Translator
@@ -31,6 +32,8 @@ public:
 private:
     static bool installTranslator(const QStringList& languages, const QString& path);
     static bool installQtTranslator(const QStringList& languages, const QString& path);
+    static bool installCatalog(const QStringList& languages, const QString& prefix, const QStringList& paths);
+    static QSet<QString> availableCatalogs(const QString& path);
 };
 
 #endif // KEEPASSX_TRANSLATOR_H
@@ -0,0 +1,153 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Wordlist.h"
+
+#include "streams/MappedFileDevice.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    struct CachedWordlist
+    {
+        QDateTime modified;
+        qint64 size;
+        QSharedPointer<const Wordlist> wordlist;
+    };
+
+    QMutex s_cacheMutex;
+    QHash<QString, CachedWordlist> s_cache;
+} // namespace
+
+Wordlist::~Wordlist()
+{
+    if (m_mapped) {
+        m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+    }
+}
+
+/**
+ * Load the wordlist at the given path, re-using the list already loaded
+ * by this process unless the file has changed since. Thread-safe.
+ *
+ * @param path wordlist file
+ * @return the wordlist or null if the file could not be read
+ */
+QSharedPointer<const Wordlist> Wordlist::load(const QString& path)
+{
+    const QFileInfo info(path);
+    const QString key = info.absoluteFilePath();
+    const QDateTime modified = info.lastModified();
+    const qint64 size = info.size();
+
+    QMutexLocker locker(&s_cacheMutex);
+    auto cached = s_cache.constFind(key);
+    if (cached != s_cache.constEnd() && cached->modified == modified && cached->size == size) {
+        return cached->wordlist;
+    }
+
+    QSharedPointer<Wordlist> wordlist(new Wordlist());
+    if (!wordlist->open(path)) {
+        s_cache.remove(key);
+        return {};
+    }
+
+    s_cache.insert(key, {modified, size, wordlist});
+    return wordlist;
+}
+
+/**
+ * @return number of words
+ */
+int Wordlist::size() const
+{
+    return m_offsets.isEmpty() ? 0 : m_offsets.size() - 1;
+}
+
+bool Wordlist::isEmpty() const
+{
+    return size() == 0;
+}
+
+/**
+ * @param index word index, must be less than size()
+ * @return the word without its line ending
+ */
+QString Wordlist::at(int index) const
+{
+    Q_ASSERT(index >= 0 && index < size());
+
+    const char* begin = m_data + m_offsets[index];
+    int length = static_cast<int>(m_offsets[index + 1] - m_offsets[index]);
+    // Strip the line ending, except after the last word of a file without one
+    while (length > 0 && (begin[length - 1] == '\n' || begin[length - 1] == '\r')) {
+        --length;
+    }
+    return QString::fromUtf8(begin, length);
+}
+
+bool Wordlist::open(const QString& path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 fileSize = m_file.size();
+    if (fileSize > std::numeric_limits<quint32>::max()) {
+        return false;
+    }
+
+    uchar* mapped = nullptr;
+    if (fileSize > 0 && MappedFileDevice::isMappingSafe(path)) {
+        mapped = m_file.map(0, fileSize);
+    }
+    if (mapped) {
+        m_data = reinterpret_cast<const char*>(mapped);
+        m_mapped = true;
+    } else {
+        // Network and special files are read into memory instead
+        m_buffer = m_file.readAll();
+        m_file.close();
+        m_data = m_buffer.constData();
+    }
+
+    // Every line is a word, a line ending before the end of the file doesn't
+    // start another one
+    const auto size = static_cast<quint32>(fileSize);
+    if (size > 0) {
+        m_offsets.append(0);
+    }
+    const char* end = m_data + size;
+    for (const char* it = m_data; it < end;) {
+        const auto* newline = static_cast<const char*>(std::memchr(it, '\n', static_cast<size_t>(end - it)));
+        if (!newline || newline + 1 == end) {
+            break;
+        }
+        it = newline + 1;
+        m_offsets.append(static_cast<quint32>(it - m_data));
+    }
+    m_offsets.append(size);
+    return true;
+}
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_WORDLIST_H
+#define KEEPASSXC_WORDLIST_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+/**
+ * Immutable list of words, one per line of a text file.
+ *
+ * The file is memory-mapped when that is safe and the words are only
+ * located by their offsets, a word is decoded when it is asked for.
+ * Lists are shared by all generators of the process through load().
+ */
+class Wordlist
+{
+public:
+    ~Wordlist();
+    Q_DISABLE_COPY(Wordlist)
+
+    static QSharedPointer<const Wordlist> load(const QString& path);
+
+    int size() const;
+    bool isEmpty() const;
+    QString at(int index) const;
+
+private:
+    Wordlist() = default;
+
+    bool open(const QString& path);
+
+    QFile m_file;
+    // either the mapping of m_file or m_buffer
+    const char* m_data = nullptr;
+    bool m_mapped = false;
+    QByteArray m_buffer;
+    // start of every word, followed by the end of the data
+    QVector<quint32> m_offsets;
+};
+
+#endif // KEEPASSXC_WORDLIST_H
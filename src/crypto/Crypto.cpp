@@ -18,13 +18,89 @@
 #include "Crypto.h"
 
 #include <QMutex>
+#include <QStringList>
 
 #include <gcrypt.h>
+#include <sodium.h>
+
+#if defined(Q_PROCESSOR_X86) && defined(Q_CC_MSVC)
+#include <intrin.h>
+#elif defined(Q_PROCESSOR_X86) && (defined(Q_CC_GNU) || defined(Q_CC_CLANG))
+#include <cpuid.h>
+#endif
 
 #include "config-keepassx.h"
 #include "crypto/CryptoHash.h"
 #include "crypto/SymmetricCipher.h"
 
+namespace
+{
+    /**
+     * Detect the SIMD extensions that Argon2 kernels are built for, taking
+     * into account whether the operating system saves the vector registers.
+     */
+    QStringList simdExtensions()
+    {
+        QStringList extensions;
+#if defined(Q_PROCESSOR_X86) && (defined(Q_CC_MSVC) || defined(Q_CC_GNU) || defined(Q_CC_CLANG))
+        unsigned int regs[4] = {0, 0, 0, 0};
+#if defined(Q_CC_MSVC)
+        int info[4];
+        __cpuid(info, 0);
+        const unsigned int maxLeaf = static_cast<unsigned int>(info[0]);
+        auto cpuid = [&regs, &info](int leaf) {
+            __cpuidex(info, leaf, 0);
+            for (int i = 0; i < 4; ++i) {
+                regs[i] = static_cast<unsigned int>(info[i]);
+            }
+        };
+#else
+        const unsigned int maxLeaf = __get_cpuid_max(0, nullptr);
+        auto cpuid = [&regs](unsigned int leaf) { __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]); };
+#endif
+        if (maxLeaf < 1) {
+            return extensions;
+        }
+
+        cpuid(1);
+        const unsigned int ecx = regs[2];
+        const unsigned int edx = regs[3];
+        if (edx & (1u << 26)) {
+            extensions << QStringLiteral("SSE2");
+        }
+        if (ecx & (1u << 9)) {
+            extensions << QStringLiteral("SSSE3");
+        }
+
+        // AVX registers are only usable if the operating system saves them
+        quint64 xcr0 = 0;
+        if (ecx & (1u << 27)) {
+#if defined(Q_CC_MSVC)
+            xcr0 = _xgetbv(0);
+#else
+            unsigned int xcr0Low = 0;
+            unsigned int xcr0High = 0;
+            __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+            xcr0 = (static_cast<quint64>(xcr0High) << 32) | xcr0Low;
+#endif
+        }
+        const bool avxState = (ecx & (1u << 28)) && (xcr0 & 0x6) == 0x6;
+        const bool avx512State = avxState && (xcr0 & 0xE0) == 0xE0;
+
+        if (maxLeaf >= 7) {
+            cpuid(7);
+            if (avxState && (regs[1] & (1u << 5))) {
+                extensions << QStringLiteral("AVX2");
+            }
+            if (avx512State && (regs[1] & (1u << 16))) {
+                extensions << QStringLiteral("AVX-512F");
+            }
+        }
+#endif
+        return extensions;
+    }
+} // namespace
+
 bool Crypto::m_initialized(false);
 QString Crypto::m_errorStr;
 QString Crypto::m_backendVersion;
@@ -43,6 +119,13 @@ bool Crypto::init()
     m_backendVersion = QString::fromLocal8Bit(gcry_check_version(0));
     gcry_control(GCRYCTL_INITIALIZATION_FINISHED, 0);
 
+    // selects the fastest libsodium implementations for this CPU
+    if (sodium_init() < 0) {
+        m_errorStr = "libsodium initialization failed.";
+        qWarning("Crypto::init: %s", qPrintable(m_errorStr));
+        return false;
+    }
+
     if (!checkAlgorithms()) {
         return false;
     }
@@ -74,6 +157,15 @@ QString Crypto::debugInfo()
 
     QString debugInfo = QObject::tr("Cryptographic libraries:").append("\n");
     debugInfo.append(" libgcrypt ").append(m_backendVersion).append("\n");
+    debugInfo.append(" libsodium ").append(QString::fromLocal8Bit(sodium_version_string())).append("\n");
+    debugInfo.append(" libargon2").append("\n");
+
+    // The Argon2 kernel is chosen when libargon2 is built, list what this CPU could use
+    QString extensions = simdExtensions().join(" ");
+    if (extensions.isEmpty()) {
+        extensions = QObject::tr("None");
+    }
+    debugInfo.append(QObject::tr("SIMD extensions for Argon2: %1").arg(extensions)).append("\n");
     return debugInfo;
 }
 
@@ -17,7 +17,9 @@
 
 #include "CryptoHash.h"
 
+#include <QVarLengthArray>
 #include <gcrypt.h>
+#include <sodium.h>
 
 #include "crypto/Crypto.h"
 
@@ -28,6 +30,62 @@ public:
     int hashLen;
 };
 
+namespace
+{
+    const int MaxDigestSize = 64;
+
+    int gcryptAlgorithm(CryptoHash::Algorithm algo)
+    {
+        switch (algo) {
+        case CryptoHash::Sha256:
+            return GCRY_MD_SHA256;
+        case CryptoHash::Sha512:
+            return GCRY_MD_SHA512;
+        default:
+            Q_ASSERT(false);
+            return -1;
+        }
+    }
+
+    /**
+     * Hash the given buffers in one go without opening a context.
+     * If key is set, the HMAC of the buffers is computed instead.
+     */
+    QByteArray hashBuffers(CryptoHash::Algorithm algo, const QVector<QByteArray>& parts, const QByteArray* key)
+    {
+        Q_ASSERT(Crypto::initialized());
+
+        const int algoGcrypt = gcryptAlgorithm(algo);
+
+        QVarLengthArray<gcry_buffer_t, 4> iov;
+        if (key) {
+            gcry_buffer_t buffer = {};
+            buffer.data = const_cast<char*>(key->constData());
+            buffer.len = static_cast<size_t>(key->size());
+            iov.append(buffer);
+        }
+        for (const QByteArray& part : parts) {
+            gcry_buffer_t buffer = {};
+            buffer.data = const_cast<char*>(part.constData());
+            buffer.len = static_cast<size_t>(part.size());
+            iov.append(buffer);
+        }
+
+        char digest[MaxDigestSize];
+        gcry_error_t error = gcry_md_hash_buffers(
+            algoGcrypt, key ? GCRY_MD_FLAG_HMAC : 0, digest, iov.data(), static_cast<int>(iov.size()));
+        if (error != GPG_ERR_NO_ERROR) {
+            qWarning("Gcrypt error (hash): %s\n                     %s", gcry_strerror(error), gcry_strsource(error));
+            Q_ASSERT(false);
+            return {};
+        }
+
+        QByteArray result(digest, static_cast<int>(gcry_md_get_algo_dlen(algoGcrypt)));
+        sodium_memzero(digest, sizeof(digest));
+        return result;
+    }
+} // namespace
+
 CryptoHash::CryptoHash(Algorithm algo, bool hmac)
     : d_ptr(new CryptoHashPrivate())
 {
@@ -35,23 +93,9 @@ CryptoHash::CryptoHash(Algorithm algo, bool hmac)
 
     Q_ASSERT(Crypto::initialized());
 
-    int algoGcrypt = -1;
+    int algoGcrypt = gcryptAlgorithm(algo);
     unsigned int flagsGcrypt = GCRY_MD_FLAG_SECURE;
 
-    switch (algo) {
-    case CryptoHash::Sha256:
-        algoGcrypt = GCRY_MD_SHA256;
-        break;
-
-    case CryptoHash::Sha512:
-        algoGcrypt = GCRY_MD_SHA512;
-        break;
-
-    default:
-        Q_ASSERT(false);
-        break;
-    }
-
     if (hmac) {
         flagsGcrypt |= GCRY_MD_FLAG_HMAC;
     }
@@ -96,6 +140,17 @@ void CryptoHash::setKey(const QByteArray& data)
     Q_ASSERT(error == 0);
 }
 
+/**
+ * Discard all data added so far so the context can be reused.
+ * An HMAC key set with setKey() is kept.
+ */
+void CryptoHash::reset()
+{
+    Q_D(CryptoHash);
+
+    gcry_md_reset(d->ctx);
+}
+
 QByteArray CryptoHash::result() const
 {
     Q_D(const CryptoHash);
@@ -106,17 +161,26 @@ QByteArray CryptoHash::result() const
 
 QByteArray CryptoHash::hash(const QByteArray& data, Algorithm algo)
 {
-    // replace with gcry_md_hash_buffer()?
-    CryptoHash cryptoHash(algo);
-    cryptoHash.addData(data);
-    return cryptoHash.result();
+    return hashBuffers(algo, {data}, nullptr);
+}
+
+/**
+ * Hash the concatenation of the given parts without copying them.
+ */
+QByteArray CryptoHash::hash(const QVector<QByteArray>& parts, Algorithm algo)
+{
+    return hashBuffers(algo, parts, nullptr);
 }
 
 QByteArray CryptoHash::hmac(const QByteArray& data, const QByteArray& key, Algorithm algo)
 {
-    // replace with gcry_md_hash_buffer()?
-    CryptoHash cryptoHash(algo, true);
-    cryptoHash.setKey(key);
-    cryptoHash.addData(data);
-    return cryptoHash.result();
+    return hashBuffers(algo, {data}, &key);
+}
+
+/**
+ * Compute the HMAC of the concatenation of the given parts without copying them.
+ */
+QByteArray CryptoHash::hmac(const QVector<QByteArray>& parts, const QByteArray& key, Algorithm algo)
+{
+    return hashBuffers(algo, parts, &key);
 }
@@ -19,6 +19,7 @@
 #define KEEPASSX_CRYPTOHASH_H
 
 #include <QByteArray>
+#include <QVector>
 
 class CryptoHashPrivate;
 
@@ -36,9 +37,12 @@ public:
     void addData(const QByteArray& data);
     QByteArray result() const;
     void setKey(const QByteArray& data);
+    void reset();
 
     static QByteArray hash(const QByteArray& data, Algorithm algo);
+    static QByteArray hash(const QVector<QByteArray>& parts, Algorithm algo);
     static QByteArray hmac(const QByteArray& data, const QByteArray& key, Algorithm algo);
+    static QByteArray hmac(const QVector<QByteArray>& parts, const QByteArray& key, Algorithm algo);
 
 private:
     CryptoHashPrivate* const d_ptr;
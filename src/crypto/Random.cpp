@@ -18,8 +18,10 @@
 #include "Random.h"
 
 #include <gcrypt.h>
+#include <sodium.h>
 
 #include "core/Global.h"
+#include "core/SecureArena.h"
 #include "crypto/Crypto.h"
 
 class RandomBackendGcrypt : public RandomBackend
@@ -28,6 +30,55 @@ public:
     void randomize(void* data, int len) override;
 };
 
+namespace
+{
+    const int PoolSize = 4096;
+
+    /**
+     * Per-thread buffer of random bytes drawn from libgcrypt in large
+     * blocks. Bytes are zeroed as soon as they are handed out and the
+     * buffer lives in the secure arena, so nothing is left behind once
+     * the thread exits.
+     */
+    class RandomPool
+    {
+    public:
+        RandomPool()
+            : m_data(static_cast<char*>(SecureArena::instance()->allocate(PoolSize)))
+        {
+        }
+
+        ~RandomPool()
+        {
+            SecureArena::instance()->deallocate(m_data, PoolSize);
+        }
+
+        void read(void* data, int len)
+        {
+            auto out = static_cast<char*>(data);
+            while (len > 0) {
+                if (m_pos == PoolSize) {
+                    gcry_randomize(m_data, PoolSize, GCRY_STRONG_RANDOM);
+                    m_pos = 0;
+                }
+
+                int count = qMin(len, PoolSize - m_pos);
+                memcpy(out, m_data + m_pos, static_cast<size_t>(count));
+                sodium_memzero(m_data + m_pos, static_cast<size_t>(count));
+                m_pos += count;
+                out += count;
+                len -= count;
+            }
+        }
+
+    private:
+        char* m_data;
+        int m_pos = PoolSize;
+
+        Q_DISABLE_COPY(RandomPool)
+    };
+} // namespace
+
 QSharedPointer<Random> Random::m_instance;
 
 void Random::randomize(QByteArray& ba)
@@ -95,7 +146,15 @@ void RandomBackendGcrypt::randomize(void* data, int len)
 {
     Q_ASSERT(Crypto::initialized());
 
-    gcry_randomize(data, len, GCRY_STRONG_RANDOM);
+    // Small requests (e.g. one per generated character) are served from a
+    // per-thread pool to avoid a round trip into libgcrypt for every value
+    if (len >= PoolSize / 4) {
+        gcry_randomize(data, len, GCRY_STRONG_RANDOM);
+        return;
+    }
+
+    thread_local RandomPool pool;
+    pool.read(data, len);
 }
 
 RandomBackend::~RandomBackend()
@@ -19,6 +19,25 @@
 
 #include "config-keepassx.h"
 #include "crypto/SymmetricCipherGcrypt.h"
+#include "crypto/SymmetricCipherSodium.h"
+
+std::atomic<SymmetricCipher::Backend> SymmetricCipher::s_preferredBackend(SymmetricCipher::DefaultBackend);
+
+namespace
+{
+    bool preferSodium(SymmetricCipher::Backend backend)
+    {
+        if (backend == SymmetricCipher::DefaultBackend) {
+#if defined(Q_PROCESSOR_X86)
+            return true;
+#else
+            // libsodium has no NEON stream cipher kernels, libgcrypt is faster there
+            return false;
+#endif
+        }
+        return backend == SymmetricCipher::SodiumBackend;
+    }
+} // namespace
 
 SymmetricCipher::SymmetricCipher(Algorithm algo, Mode mode, Direction direction)
     : m_backend(createBackend(algo, mode, direction))
@@ -57,11 +76,16 @@ bool SymmetricCipher::isInitalized() const
 SymmetricCipherBackend* SymmetricCipher::createBackend(Algorithm algo, Mode mode, Direction direction)
 {
     switch (algo) {
+    case Salsa20:
+    case ChaCha20:
+        if (preferSodium(s_preferredBackend.load()) && SymmetricCipherSodium::isSupported(algo, mode)) {
+            return new SymmetricCipherSodium(algo, mode, direction);
+        }
+        return new SymmetricCipherGcrypt(algo, mode, direction);
+
     case Aes128:
     case Aes256:
     case Twofish:
-    case Salsa20:
-    case ChaCha20:
         return new SymmetricCipherGcrypt(algo, mode, direction);
 
     default:
@@ -75,6 +99,12 @@ bool SymmetricCipher::reset()
     return m_backend->reset();
 }
 
+bool SymmetricCipher::setIv(const QByteArray& iv)
+{
+    Q_ASSERT(m_initialized);
+    return m_backend->setIv(iv);
+}
+
 int SymmetricCipher::keySize() const
 {
     return m_backend->keySize();
@@ -138,6 +168,42 @@ int SymmetricCipher::algorithmIvSize(Algorithm algo)
     }
 }
 
+/**
+ * @return backend used for newly created ciphers
+ */
+SymmetricCipher::Backend SymmetricCipher::preferredBackend()
+{
+    return s_preferredBackend.load();
+}
+
+/**
+ * Select the backend used for newly created ciphers. Algorithms
+ * that are not supported by the selected backend fall back to
+ * libgcrypt. DefaultBackend picks the fastest backend for the
+ * algorithm on the current platform.
+ *
+ * @param backend preferred backend
+ */
+void SymmetricCipher::setPreferredBackend(Backend backend)
+{
+    s_preferredBackend.store(backend);
+}
+
+/**
+ * @return true if the backend implements the given algorithm and mode
+ */
+bool SymmetricCipher::isBackendSupported(Backend backend, Algorithm algo, Mode mode)
+{
+    switch (backend) {
+    case DefaultBackend:
+    case GcryptBackend:
+        return true;
+    case SodiumBackend:
+        return SymmetricCipherSodium::isSupported(algo, mode);
+    }
+    return false;
+}
+
 SymmetricCipher::Mode SymmetricCipher::algorithmMode(Algorithm algo)
 {
     switch (algo) {
@@ -23,6 +23,8 @@
 #include <QString>
 #include <QUuid>
 
+#include <atomic>
+
 #include "crypto/SymmetricCipherBackend.h"
 #include "format/KeePass2.h"
 
@@ -54,6 +56,13 @@ public:
         Encrypt
     };
 
+    enum Backend
+    {
+        DefaultBackend,
+        GcryptBackend,
+        SodiumBackend
+    };
+
     SymmetricCipher(Algorithm algo, Mode mode, Direction direction);
     ~SymmetricCipher();
     Q_DISABLE_COPY(SymmetricCipher)
@@ -78,6 +87,11 @@ public:
     }
 
     bool reset();
+    /**
+     * Restart the cipher with a new IV, keeping the key set by init().
+     * Cheaper than a full init() when processing many short messages.
+     */
+    bool setIv(const QByteArray& iv);
     int keySize() const;
     int blockSize() const;
     QString errorString() const;
@@ -88,9 +102,15 @@ public:
     static int algorithmIvSize(Algorithm algo);
     static Mode algorithmMode(Algorithm algo);
 
+    static Backend preferredBackend();
+    static void setPreferredBackend(Backend backend);
+    static bool isBackendSupported(Backend backend, Algorithm algo, Mode mode);
+
 private:
     static SymmetricCipherBackend* createBackend(Algorithm algo, Mode mode, Direction direction);
 
+    static std::atomic<Backend> s_preferredBackend;
+
     const QScopedPointer<SymmetricCipherBackend> m_backend;
     bool m_initialized;
     Algorithm m_algo;
@@ -0,0 +1,189 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SymmetricCipherSodium.h"
+
+#include <limits>
+#include <sodium.h>
+
+namespace
+{
+    const int KEYSTREAM_BLOCK_SIZE = 64;
+    const int KEY_SIZE = 32;
+} // namespace
+
+SymmetricCipherSodium::SymmetricCipherSodium(SymmetricCipher::Algorithm algo,
+                                             SymmetricCipher::Mode mode,
+                                             SymmetricCipher::Direction direction)
+    : m_algo(algo)
+{
+    // stream ciphers are symmetric in both directions
+    Q_UNUSED(direction);
+    Q_ASSERT(isSupported(algo, mode));
+}
+
+SymmetricCipherSodium::~SymmetricCipherSodium()
+{
+    wipeKey();
+}
+
+/**
+ * @return true if the algorithm and mode combination is provided by this backend
+ */
+bool SymmetricCipherSodium::isSupported(SymmetricCipher::Algorithm algo, SymmetricCipher::Mode mode)
+{
+    return mode == SymmetricCipher::Stream && (algo == SymmetricCipher::ChaCha20 || algo == SymmetricCipher::Salsa20);
+}
+
+bool SymmetricCipherSodium::init()
+{
+    // sodium_init() is idempotent and selects the fastest implementation
+    if (sodium_init() < 0) {
+        m_error = "libsodium/initialization failed";
+        return false;
+    }
+    m_offset = 0;
+    return true;
+}
+
+bool SymmetricCipherSodium::setKey(const QByteArray& key)
+{
+    if (key.size() != KEY_SIZE) {
+        m_error = "libsodium/invalid key length";
+        return false;
+    }
+
+    wipeKey();
+    // keep a copy of our own, so it can be wiped without touching the caller's key
+    m_key = QByteArray(key.constData(), key.size());
+    return true;
+}
+
+bool SymmetricCipherSodium::setIv(const QByteArray& iv)
+{
+    bool validIv = (m_algo == SymmetricCipher::Salsa20)
+                       ? iv.size() == crypto_stream_salsa20_NONCEBYTES
+                       : (iv.size() == crypto_stream_chacha20_NONCEBYTES
+                          || iv.size() == crypto_stream_chacha20_ietf_NONCEBYTES);
+    if (!validIv) {
+        m_error = "libsodium/invalid IV length";
+        return false;
+    }
+
+    m_iv = iv;
+    m_offset = 0;
+    return true;
+}
+
+QByteArray SymmetricCipherSodium::process(const QByteArray& data, bool* ok)
+{
+    QByteArray result = data;
+    *ok = processInPlace(result);
+    return result;
+}
+
+bool SymmetricCipherSodium::processInPlace(QByteArray& data)
+{
+    auto* bytes = reinterpret_cast<unsigned char*>(data.data());
+    auto length = static_cast<quint64>(data.size());
+    quint64 pos = 0;
+
+    if (m_iv.size() == crypto_stream_chacha20_ietf_NONCEBYTES
+        && (m_offset + length) / KEYSTREAM_BLOCK_SIZE > std::numeric_limits<quint32>::max()) {
+        m_error = "libsodium/keystream exhausted";
+        return false;
+    }
+
+    // finish the keystream block that was started by the previous call
+    int blockOffset = static_cast<int>(m_offset % KEYSTREAM_BLOCK_SIZE);
+    if (blockOffset != 0 && length > 0) {
+        unsigned char block[KEYSTREAM_BLOCK_SIZE] = {0};
+        xorKeystream(block, KEYSTREAM_BLOCK_SIZE, m_offset / KEYSTREAM_BLOCK_SIZE);
+
+        pos = qMin(length, static_cast<quint64>(KEYSTREAM_BLOCK_SIZE - blockOffset));
+        for (quint64 i = 0; i < pos; ++i) {
+            bytes[i] ^= block[blockOffset + i];
+        }
+        sodium_memzero(block, sizeof(block));
+        m_offset += pos;
+    }
+
+    // the rest starts on a block boundary and is processed in one call
+    if (pos < length) {
+        xorKeystream(bytes + pos, length - pos, m_offset / KEYSTREAM_BLOCK_SIZE);
+        m_offset += length - pos;
+    }
+
+    return true;
+}
+
+bool SymmetricCipherSodium::processInPlace(QByteArray& data, quint64 rounds)
+{
+    for (quint64 i = 0; i != rounds; ++i) {
+        if (!processInPlace(data)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SymmetricCipherSodium::reset()
+{
+    m_offset = 0;
+    return true;
+}
+
+int SymmetricCipherSodium::keySize() const
+{
+    return KEY_SIZE;
+}
+
+int SymmetricCipherSodium::blockSize() const
+{
+    // byte granularity like any other stream cipher
+    return 1;
+}
+
+QString SymmetricCipherSodium::error() const
+{
+    return m_error;
+}
+
+/**
+ * XOR the keystream starting at the given 64 byte block into data.
+ */
+void SymmetricCipherSodium::xorKeystream(unsigned char* data, quint64 length, quint64 blockCounter)
+{
+    auto* key = reinterpret_cast<const unsigned char*>(m_key.constData());
+    auto* iv = reinterpret_cast<const unsigned char*>(m_iv.constData());
+
+    if (m_algo == SymmetricCipher::Salsa20) {
+        crypto_stream_salsa20_xor_ic(data, data, length, iv, blockCounter, key);
+    } else if (m_iv.size() == crypto_stream_chacha20_ietf_NONCEBYTES) {
+        crypto_stream_chacha20_ietf_xor_ic(data, data, length, iv, static_cast<quint32>(blockCounter), key);
+    } else {
+        crypto_stream_chacha20_xor_ic(data, data, length, iv, blockCounter, key);
+    }
+}
+
+void SymmetricCipherSodium::wipeKey()
+{
+    if (!m_key.isEmpty()) {
+        sodium_memzero(m_key.data(), static_cast<std::size_t>(m_key.size()));
+        m_key.clear();
+    }
+}
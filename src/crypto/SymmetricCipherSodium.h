@@ -0,0 +1,63 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_SYMMETRICCIPHERSODIUM_H
+#define KEEPASSXC_SYMMETRICCIPHERSODIUM_H
+
+#include "crypto/SymmetricCipher.h"
+#include "crypto/SymmetricCipherBackend.h"
+
+/**
+ * Stream cipher backend built on libsodium, which selects hand-tuned
+ * (SSSE3/AVX2) ChaCha20 and Salsa20 kernels at runtime.
+ */
+class SymmetricCipherSodium : public SymmetricCipherBackend
+{
+public:
+    SymmetricCipherSodium(SymmetricCipher::Algorithm algo,
+                          SymmetricCipher::Mode mode,
+                          SymmetricCipher::Direction direction);
+    ~SymmetricCipherSodium() override;
+
+    static bool isSupported(SymmetricCipher::Algorithm algo, SymmetricCipher::Mode mode);
+
+    bool init() override;
+    bool setKey(const QByteArray& key) override;
+    bool setIv(const QByteArray& iv) override;
+
+    QByteArray process(const QByteArray& data, bool* ok) override;
+    Q_REQUIRED_RESULT bool processInPlace(QByteArray& data) override;
+    Q_REQUIRED_RESULT bool processInPlace(QByteArray& data, quint64 rounds) override;
+
+    bool reset() override;
+    int keySize() const override;
+    int blockSize() const override;
+
+    QString error() const override;
+
+private:
+    void xorKeystream(unsigned char* data, quint64 length, quint64 blockCounter);
+    void wipeKey();
+
+    const SymmetricCipher::Algorithm m_algo;
+    QByteArray m_key;
+    QByteArray m_iv;
+    quint64 m_offset = 0;
+    QString m_error;
+};
+
+#endif // KEEPASSXC_SYMMETRICCIPHERSODIUM_H
@@ -36,6 +36,8 @@ protected:
     int benchmarkImpl(int msec) const override;
 
 private:
+    Q_REQUIRED_RESULT static bool
+    transformLanes(const QByteArray& key, const QByteArray& seed, int rounds, QByteArray* result);
     Q_REQUIRED_RESULT static bool
     transformKeyRaw(const QByteArray& key, const QByteArray& seed, int rounds, QByteArray* result);
 };
@@ -0,0 +1,209 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Argon2Arena.h"
+
+#include <cstdlib>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+    // blocks are mapped in multiples of the common huge page size
+    constexpr std::size_t HugePageSize = 2 * 1024 * 1024;
+
+    /**
+     * Map a block of at least size bytes for the arena. Huge pages spare
+     * the page faults of mapping the block page by page.
+     *
+     * @param size requested size, set to the mapped size on return
+     */
+    unsigned char* mapBlock(std::size_t& size)
+    {
+        size = (size + HugePageSize - 1) & ~(HugePageSize - 1);
+        void* block = nullptr;
+#if defined(Q_OS_WIN)
+        block = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (block) {
+            // fails beyond the working set size, the block is used unlocked then
+            VirtualLock(block, size);
+        }
+#elif defined(Q_OS_UNIX)
+#ifdef MAP_HUGETLB
+        // explicit huge pages are only available if the administrator reserved them
+        block = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if (!block || block == MAP_FAILED) {
+            block = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (block == MAP_FAILED) {
+                return nullptr;
+            }
+#ifdef MADV_HUGEPAGE
+            madvise(block, size, MADV_HUGEPAGE);
+#endif
+        }
+#ifdef MADV_DONTDUMP
+        madvise(block, size, MADV_DONTDUMP);
+#endif
+        // fails beyond RLIMIT_MEMLOCK, the block is used unlocked then
+        mlock(block, size);
+#else
+        block = std::malloc(size);
+#endif
+        return static_cast<unsigned char*>(block);
+    }
+
+    void unmapBlock(unsigned char* block, std::size_t size)
+    {
+#if defined(Q_OS_WIN)
+        Q_UNUSED(size);
+        VirtualFree(block, 0, MEM_RELEASE);
+#elif defined(Q_OS_UNIX)
+        munlock(block, size);
+        munmap(block, size);
+#else
+        Q_UNUSED(size);
+        std::free(block);
+#endif
+    }
+} // namespace
+
+Argon2Arena::Argon2Arena()
+    : m_enabled(false)
+    , m_inUse(false)
+    , m_block(nullptr)
+    , m_blockSize(0)
+{
+}
+
+Argon2Arena::~Argon2Arena()
+{
+    releaseBlock();
+}
+
+Argon2Arena* Argon2Arena::instance()
+{
+    static Argon2Arena arena;
+    return &arena;
+}
+
+/**
+ * Enable or disable keeping the memory between transformations.
+ * Disabling the arena releases the cached block.
+ */
+void Argon2Arena::setEnabled(bool enabled)
+{
+    QMutexLocker locker(&m_mutex);
+    m_enabled = enabled;
+    if (!enabled && !m_inUse) {
+        releaseBlock();
+    }
+}
+
+bool Argon2Arena::isEnabled() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_enabled;
+}
+
+/**
+ * @return size of the block kept for the next transformation in bytes
+ */
+std::size_t Argon2Arena::cachedSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_blockSize;
+}
+
+/**
+ * Release the cached block, e.g. once no database is unlocked anymore.
+ */
+void Argon2Arena::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_inUse) {
+        releaseBlock();
+    }
+}
+
+/**
+ * Allocation callback for Argon2, see argon2_context::allocate_cbk.
+ *
+ * @return 0 on success
+ */
+int Argon2Arena::allocate(unsigned char** memory, std::size_t size)
+{
+    auto* arena = instance();
+    {
+        QMutexLocker locker(&arena->m_mutex);
+        if (arena->m_enabled && !arena->m_inUse) {
+            if (arena->m_blockSize < size) {
+                // keep the largest block, smaller transformations use a part of it
+                arena->releaseBlock();
+                std::size_t blockSize = size;
+                arena->m_block = mapBlock(blockSize);
+                arena->m_blockSize = arena->m_block ? blockSize : 0;
+            }
+            if (arena->m_block) {
+                arena->m_inUse = true;
+                *memory = arena->m_block;
+                return 0;
+            }
+        }
+    }
+
+    *memory = static_cast<unsigned char*>(std::malloc(size));
+    return *memory ? 0 : -1;
+}
+
+/**
+ * Deallocation callback for Argon2, see argon2_context::free_cbk.
+ * Argon2 has already wiped the memory at this point.
+ */
+void Argon2Arena::deallocate(unsigned char* memory, std::size_t size)
+{
+    Q_UNUSED(size);
+    auto* arena = instance();
+    {
+        QMutexLocker locker(&arena->m_mutex);
+        if (arena->m_inUse && memory == arena->m_block) {
+            arena->m_inUse = false;
+            if (!arena->m_enabled) {
+                arena->releaseBlock();
+            }
+            return;
+        }
+    }
+
+    std::free(memory);
+}
+
+/**
+ * The mutex must be locked by the caller, unless called on destruction.
+ */
+void Argon2Arena::releaseBlock()
+{
+    if (m_block) {
+        unmapBlock(m_block, m_blockSize);
+        m_block = nullptr;
+        m_blockSize = 0;
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ARGON2ARENA_H
+#define KEEPASSXC_ARGON2ARENA_H
+
+#include <QMutex>
+
+#include <cstddef>
+
+/**
+ * Memory block that is kept for the next Argon2 transformation.
+ *
+ * Argon2 fills hundreds of megabytes with every transformation. Allocating
+ * them anew each time means faulting in and zeroing every page again, so
+ * the arena hands the same block to consecutive transformations instead.
+ * The block is backed by huge pages where possible and locked into memory
+ * if the resource limits allow it. Argon2 wipes its memory before
+ * returning it, a cached block never holds data of a finished
+ * transformation.
+ *
+ * Only one transformation uses the block at a time, concurrent ones get
+ * ordinary memory. The arena is disabled by default.
+ */
+class Argon2Arena
+{
+public:
+    static Argon2Arena* instance();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    std::size_t cachedSize() const;
+    void clear();
+
+    static int allocate(unsigned char** memory, std::size_t size);
+    static void deallocate(unsigned char* memory, std::size_t size);
+
+private:
+    Argon2Arena();
+    ~Argon2Arena();
+    Q_DISABLE_COPY(Argon2Arena)
+
+    void releaseBlock();
+
+    mutable QMutex m_mutex;
+    bool m_enabled;
+    bool m_inUse;
+    unsigned char* m_block;
+    std::size_t m_blockSize;
+};
+
+#endif // KEEPASSXC_ARGON2ARENA_H
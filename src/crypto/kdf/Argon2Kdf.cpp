@@ -19,9 +19,20 @@
 
 #include <QtConcurrent>
 
+#include "core/Tools.h"
 #include "crypto/argon2/argon2.h"
+#include "crypto/kdf/Argon2Arena.h"
 #include "format/KeePass2.h"
 
+namespace
+{
+    // memory sizes probed by the auto-tuner, in KiB (64 MiB to 1 GiB)
+    constexpr quint64 MinTuningMemory = 1 << 16;
+    constexpr quint64 MaxTuningMemory = 1 << 20;
+    // a configuration only meets the target time if it allows this many iterations
+    constexpr int MinTuningRounds = 2;
+} // namespace
+
 /**
  * KeePass' Argon2 implementation supports all parameters that are defined in the official specification,
  * but only the number of iterations, the memory size and the degree of parallelism can be configured by
@@ -169,20 +180,24 @@ bool Argon2Kdf::transformKeyRaw(const QByteArray& key,
                                 quint32 parallelism,
                                 QByteArray& result)
 {
-    // Time Cost, Mem Cost, Threads/Lanes, Password, length, Salt, length, out, length
-    int rc = argon2_hash(rounds,
-                         memory,
-                         parallelism,
-                         key.data(),
-                         key.size(),
-                         seed.data(),
-                         seed.size(),
-                         result.data(),
-                         result.size(),
-                         nullptr,
-                         0,
-                         Argon2_d,
-                         version);
+    // Same as argon2_hash(), but the memory comes from the arena
+    argon2_context context{};
+    context.out = reinterpret_cast<uint8_t*>(result.data());
+    context.outlen = static_cast<uint32_t>(result.size());
+    context.pwd = reinterpret_cast<uint8_t*>(const_cast<char*>(key.constData()));
+    context.pwdlen = static_cast<uint32_t>(key.size());
+    context.salt = reinterpret_cast<uint8_t*>(const_cast<char*>(seed.constData()));
+    context.saltlen = static_cast<uint32_t>(seed.size());
+    context.t_cost = rounds;
+    context.m_cost = static_cast<uint32_t>(memory);
+    context.lanes = parallelism;
+    context.threads = parallelism;
+    context.version = version;
+    context.allocate_cbk = &Argon2Arena::allocate;
+    context.free_cbk = &Argon2Arena::deallocate;
+    context.flags = ARGON2_DEFAULT_FLAGS;
+
+    int rc = argon2_ctx(&context, Argon2_d);
     if (rc != ARGON2_OK) {
         qWarning("Argon2 error: %s", argon2_error_message(rc));
         return false;
@@ -196,6 +211,94 @@ QSharedPointer<Kdf> Argon2Kdf::clone() const
     return QSharedPointer<Argon2Kdf>::create(*this);
 }
 
+/**
+ * Pick memory size, parallelism and iterations for the current machine.
+ *
+ * All logical cores and half of them are tried as lanes. For each lane count the
+ * memory size is doubled, up to a quarter of the installed memory, as long as
+ * the minimum number of iterations still fits into the target time. The setting
+ * with the most memory wins, ties are broken by the number of iterations and
+ * then by the lower number of lanes. The winning parameters are applied to
+ * this KDF. If no configuration meets the target, the smallest memory size with
+ * the most iterations is used.
+ *
+ * Every configuration is benchmarked through Kdf::benchmark(), i.e. on a
+ * separate benchmark thread, unless it was measured before in this session.
+ * This function blocks until all probes are done.
+ *
+ * @param msec target transform time in milliseconds
+ * @return measurements of all probed configurations in the order they were run
+ */
+QList<Argon2Kdf::TuningResult> Argon2Kdf::autoTune(int msec)
+{
+    quint64 maxMemory = MaxTuningMemory;
+    const quint64 installedMemory = Tools::physicalMemory() / 1024;
+    if (installedMemory > 0) {
+        maxMemory = qBound(MinTuningMemory, installedMemory / 4, MaxTuningMemory);
+    }
+
+    const auto cores = static_cast<quint32>(qMax(1, QThread::idealThreadCount()));
+    QList<quint32> laneCandidates;
+    if (cores > 1) {
+        laneCandidates << cores / 2;
+    }
+    laneCandidates << cores;
+
+    QList<TuningResult> results;
+    auto measure = [this, msec, &results](quint64 memory, quint32 parallelism) {
+        Argon2Kdf probe(*this);
+        probe.setMemory(memory);
+        probe.setParallelism(parallelism);
+        // configurations measured earlier in this session need no new run
+        int rounds = probe.estimateRounds(msec);
+        if (rounds <= 0) {
+            rounds = probe.benchmark(msec);
+        }
+        const int msecNeeded = static_cast<int>(static_cast<qint64>(msec) * qMax(rounds, MinTuningRounds) / rounds);
+        TuningResult result{memory, parallelism, rounds, qMax(msec, msecNeeded)};
+        results.append(result);
+        return result;
+    };
+    auto isBetter = [](const TuningResult& candidate, const TuningResult& best) {
+        if (candidate.memory != best.memory) {
+            return candidate.memory > best.memory;
+        }
+        return candidate.rounds > best.rounds;
+    };
+
+    bool found = false;
+    TuningResult best{};
+    TuningResult fallback{};
+    for (quint32 lanes : asConst(laneCandidates)) {
+        TuningResult result = measure(MinTuningMemory, lanes);
+        if (fallback.rounds == 0 || result.rounds > fallback.rounds) {
+            fallback = result;
+        }
+
+        quint64 memory = MinTuningMemory;
+        while (result.rounds >= MinTuningRounds) {
+            if (!found || isBetter(result, best)) {
+                best = result;
+                found = true;
+            }
+            memory *= 2;
+            if (memory > maxMemory) {
+                break;
+            }
+            result = measure(memory, lanes);
+        }
+    }
+
+    if (!found) {
+        best = fallback;
+    }
+
+    setMemory(best.memory);
+    setParallelism(best.parallelism);
+    setRounds(best.rounds);
+    return results;
+}
+
 int Argon2Kdf::benchmarkImpl(int msec) const
 {
     QByteArray key = QByteArray(16, '\x7E');
@@ -204,12 +307,23 @@ int Argon2Kdf::benchmarkImpl(int msec) const
     QElapsedTimer timer;
     timer.start();
 
-    int rounds = 4;
-    if (transformKeyRaw(key, seed, version(), rounds, memory(), parallelism(), key)) {
-        return static_cast<int>(rounds * (static_cast<float>(msec) / timer.elapsed()));
-    }
+    // run single iterations until the estimate is stable enough, this keeps
+    // probing large memory sizes short
+    int rounds = 0;
+    do {
+        if (!transformKeyRaw(key, seed, version(), 1, memory(), parallelism(), key)) {
+            return 1;
+        }
+        ++rounds;
+    } while (rounds < 4 && timer.elapsed() < msec / 4);
 
-    return 1;
+    return static_cast<int>(rounds * (static_cast<float>(msec) / qMax<qint64>(1, timer.elapsed())));
+}
+
+QString Argon2Kdf::benchmarkKey() const
+{
+    return QString("%1/%2/%3/%4")
+        .arg(Kdf::benchmarkKey(), QString::number(version()), QString::number(memory()), QString::number(parallelism()));
 }
 
 QString Argon2Kdf::toString() const
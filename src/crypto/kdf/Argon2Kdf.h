@@ -38,8 +38,24 @@ public:
     bool setParallelism(quint32 threads);
     QString toString() const override;
 
+    /**
+     * Benchmark result of a single auto-tuning configuration.
+     */
+    struct TuningResult
+    {
+        quint64 memory;
+        quint32 parallelism;
+        // iterations that fit into the target time
+        int rounds;
+        // estimated transform time in milliseconds using at least the minimum number of iterations
+        int msec;
+    };
+
+    QList<TuningResult> autoTune(int msec);
+
 protected:
     int benchmarkImpl(int msec) const override;
+    QString benchmarkKey() const override;
 
     quint32 m_version;
     quint64 m_memory;
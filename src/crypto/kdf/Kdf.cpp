@@ -18,8 +18,12 @@
 #include "Kdf.h"
 #include "Kdf_p.h"
 
+#include <QHash>
+#include <QMutex>
 #include <QtConcurrent>
 
+#include <limits>
+
 #include "crypto/Random.h"
 
 Kdf::Kdf(const QUuid& uuid)
@@ -69,6 +73,34 @@ void Kdf::randomizeSeed()
     setSeed(randomGen()->randomArray(m_seed.size()));
 }
 
+namespace
+{
+    QMutex benchmarkCacheMutex;
+
+    /**
+     * Measured rounds per millisecond of every benchmarked configuration,
+     * keyed by Kdf::benchmarkKey(). Kept for the lifetime of the process.
+     */
+    QHash<QString, double>& benchmarkCache()
+    {
+        static QHash<QString, double> cache;
+        return cache;
+    }
+
+    double cachedRoundsPerMsec(const QString& key)
+    {
+        QMutexLocker locker(&benchmarkCacheMutex);
+        return benchmarkCache().value(key, 0.0);
+    }
+} // namespace
+
+/**
+ * Measure the number of rounds that fit into the given time. The result is
+ * remembered for this configuration, see estimateRounds().
+ *
+ * @param msec target transform time in milliseconds
+ * @return number of rounds, at least one
+ */
 int Kdf::benchmark(int msec) const
 {
     // Run the benchmark twice using half the time for each run
@@ -82,8 +114,54 @@ int Kdf::benchmark(int msec) const
     thread.start();
     thread.wait();
     rounds += thread.rounds();
+    rounds = qMax(1, rounds);
+
+    if (msec > 0) {
+        QMutexLocker locker(&benchmarkCacheMutex);
+        benchmarkCache().insert(benchmarkKey(), static_cast<double>(rounds) / msec);
+    }
+
+    return rounds;
+}
+
+/**
+ * Predict the number of rounds that fit into the given time from an earlier
+ * benchmark of a configuration with the same performance parameters.
+ *
+ * @param msec target transform time in milliseconds
+ * @return number of rounds or 0 if this configuration was not benchmarked yet
+ */
+int Kdf::estimateRounds(int msec) const
+{
+    const double roundsPerMsec = cachedRoundsPerMsec(benchmarkKey());
+    if (roundsPerMsec <= 0.0) {
+        return 0;
+    }
+    return static_cast<int>(qBound(1.0, roundsPerMsec * msec, static_cast<double>(std::numeric_limits<int>::max())));
+}
 
-    return qMax(1, rounds);
+/**
+ * Predict the transform time for the current number of rounds from an
+ * earlier benchmark of a configuration with the same performance parameters.
+ *
+ * @return time in milliseconds or -1 if this configuration was not benchmarked yet
+ */
+int Kdf::estimateTransformTime() const
+{
+    const double roundsPerMsec = cachedRoundsPerMsec(benchmarkKey());
+    if (roundsPerMsec <= 0.0) {
+        return -1;
+    }
+    return static_cast<int>(qMin(m_rounds / roundsPerMsec, static_cast<double>(std::numeric_limits<int>::max())));
+}
+
+/**
+ * Identify the parameters that determine the speed of a single round.
+ * Configurations with the same key share their benchmark results.
+ */
+QString Kdf::benchmarkKey() const
+{
+    return m_uuid.toString();
 }
 
 Kdf::BenchmarkThread::BenchmarkThread(int msec, const Kdf* kdf)
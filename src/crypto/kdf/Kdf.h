@@ -47,6 +47,8 @@ public:
     virtual QString toString() const = 0;
 
     int benchmark(int msec) const;
+    int estimateRounds(int msec) const;
+    int estimateTransformTime() const;
 
     /*
      * Default target encryption time, in MS.
@@ -63,6 +65,7 @@ public:
 
 protected:
     virtual int benchmarkImpl(int msec) const = 0;
+    virtual QString benchmarkKey() const;
 
     int m_rounds;
     QByteArray m_seed;
@@ -232,6 +232,7 @@ OpenSSHKey::OpenSSHKey(const OpenSSHKey& other)
     , m_rawPrivateData(other.m_rawPrivateData)
     , m_comment(other.m_comment)
     , m_error(other.m_error)
+    , m_fingerprint(other.m_fingerprint)
 {
 }
 
@@ -265,12 +266,20 @@ int OpenSSHKey::keyLength() const
     return 0;
 }
 
+/**
+ * The SHA-256 fingerprint is cached, as keys are hashed and compared
+ * by it whenever they are looked up or listed.
+ */
 const QString OpenSSHKey::fingerprint(QCryptographicHash::Algorithm algo) const
 {
     if (m_rawPublicData.isEmpty()) {
         return {};
     }
 
+    if (algo == QCryptographicHash::Sha256 && !m_fingerprint.isEmpty()) {
+        return m_fingerprint;
+    }
+
     QByteArray publicKey;
     BinaryStream stream(&publicKey);
 
@@ -290,7 +299,8 @@ const QString OpenSSHKey::fingerprint(QCryptographicHash::Algorithm algo) const
         }
         return "MD5:" + md5HashParts.join(':');
     } else if (algo == QCryptographicHash::Sha256) {
-        return "SHA256:" + QString::fromLatin1(rawHash.toBase64(QByteArray::OmitTrailingEquals));
+        m_fingerprint = "SHA256:" + QString::fromLatin1(rawHash.toBase64(QByteArray::OmitTrailingEquals));
+        return m_fingerprint;
     }
 
     return "HASH:" + QString::fromLatin1(rawHash.toHex());
@@ -345,11 +355,13 @@ const QString OpenSSHKey::errorString() const
 void OpenSSHKey::setType(const QString& type)
 {
     m_type = type;
+    m_fingerprint.clear();
 }
 
 void OpenSSHKey::setPublicData(const QList<QByteArray>& data)
 {
     m_rawPublicData = data;
+    m_fingerprint.clear();
 }
 
 void OpenSSHKey::setPrivateData(const QList<QByteArray>& data)
@@ -654,6 +666,7 @@ bool OpenSSHKey::openKey(const QString& passphrase)
 bool OpenSSHKey::readPublic(BinaryStream& stream)
 {
     m_rawPublicData.clear();
+    m_fingerprint.clear();
 
     if (!stream.readString(m_type)) {
         m_error = tr("Unexpected EOF while reading public key");
@@ -691,6 +704,7 @@ bool OpenSSHKey::readPublic(BinaryStream& stream)
 bool OpenSSHKey::readPrivate(BinaryStream& stream)
 {
     m_rawPrivateData.clear();
+    m_fingerprint.clear();
 
     if (!stream.readString(m_type)) {
         m_error = tr("Unexpected EOF while reading private key");
@@ -91,6 +91,8 @@ private:
     QList<QByteArray> m_rawPrivateData;
     QString m_comment;
     QString m_error;
+    // SHA-256 fingerprint, computed on first use
+    mutable QString m_fingerprint;
 };
 
 uint qHash(const OpenSSHKey& key);
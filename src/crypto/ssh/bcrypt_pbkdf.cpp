@@ -15,6 +15,7 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <QtConcurrent>
 #include <QtCore>
 
 extern "C" {
@@ -98,15 +99,51 @@ bcrypt_hash(const quint8* sha2pass, const quint8* sha2salt, quint8* out)
     explicit_bzero(&state, sizeof(state));
 }
 
-int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key, quint32 rounds)
+/*
+ * Compute a single output block. Blocks only share the collapsed
+ * password, so they can be derived independently of each other.
+ */
+static void
+bcrypt_pbkdf_block(const QByteArray& sha2pass, const QByteArray& salt, quint32 count, quint32 rounds, quint8* out)
 {
     QCryptographicHash ctx(QCryptographicHash::Sha512);
-    QByteArray sha2pass;
     QByteArray sha2salt;
-    quint8 out[BCRYPT_HASHSIZE];
     quint8 tmpout[BCRYPT_HASHSIZE];
     quint8 countsalt[4];
 
+    countsalt[0] = (count >> 24) & 0xff;
+    countsalt[1] = (count >> 16) & 0xff;
+    countsalt[2] = (count >> 8) & 0xff;
+    countsalt[3] = count & 0xff;
+
+    /* first round, salt is salt */
+    ctx.addData(salt);
+    ctx.addData(reinterpret_cast<char *>(countsalt), sizeof(countsalt));
+    sha2salt = ctx.result();
+
+    bcrypt_hash(reinterpret_cast<const quint8 *>(sha2pass.constData()), reinterpret_cast<quint8 *>(sha2salt.data()), tmpout);
+    memcpy(out, tmpout, BCRYPT_HASHSIZE);
+
+    for (quint32 i = 1; i < rounds; i++) {
+        /* subsequent rounds, salt is previous output */
+        ctx.reset();
+        ctx.addData(reinterpret_cast<char *>(tmpout), sizeof(tmpout));
+        sha2salt = ctx.result();
+        bcrypt_hash(reinterpret_cast<const quint8 *>(sha2pass.constData()), reinterpret_cast<quint8 *>(sha2salt.data()), tmpout);
+        for (quint32 j = 0; j < BCRYPT_HASHSIZE; j++)
+            out[j] ^= tmpout[j];
+    }
+
+    /* zap */
+    explicit_bzero(tmpout, sizeof(tmpout));
+}
+
+int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key, quint32 rounds)
+{
+    QCryptographicHash ctx(QCryptographicHash::Sha512);
+    QByteArray sha2pass;
+    quint8 out[BCRYPT_HASHSIZE];
+
     /* nothing crazy */
     if (rounds < 1) {
         return -1;
@@ -125,31 +162,26 @@ int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key
     ctx.addData(pass);
     sha2pass = ctx.result();
 
-    /* generate key, sizeof(out) at a time */
-    for (quint32 count = 1, keylen = key.length(); keylen > 0; count++) {
-        countsalt[0] = (count >> 24) & 0xff;
-        countsalt[1] = (count >> 16) & 0xff;
-        countsalt[2] = (count >> 8) & 0xff;
-        countsalt[3] = count & 0xff;
-
-        /* first round, salt is salt */
-        ctx.reset();
-        ctx.addData(salt);
-        ctx.addData(reinterpret_cast<char *>(countsalt), sizeof(countsalt));
-        sha2salt = ctx.result();
+    /*
+     * generate key, sizeof(out) at a time; the key consists of stride
+     * independent blocks, all but the first are derived on the thread pool
+     */
+    QByteArray blocks(static_cast<int>(stride * sizeof(out)), '\0');
+    quint8* blockData = reinterpret_cast<quint8 *>(blocks.data());
+    QList<QFuture<void>> futures;
+    for (quint32 count = 2; count <= stride; count++) {
+        futures.append(QtConcurrent::run([&sha2pass, &salt, count, rounds, blockData] {
+            bcrypt_pbkdf_block(sha2pass, salt, count, rounds, blockData + (count - 1) * BCRYPT_HASHSIZE);
+        }));
+    }
+    bcrypt_pbkdf_block(sha2pass, salt, 1, rounds, blockData);
+    for (auto& future : futures) {
+        future.waitForFinished();
+    }
 
-        bcrypt_hash(reinterpret_cast<quint8 *>(sha2pass.data()), reinterpret_cast<quint8 *>(sha2salt.data()), tmpout);
-        memcpy(out, tmpout, sizeof(out));
-
-        for (quint32 i = 1; i < rounds; i++) {
-            /* subsequent rounds, salt is previous output */
-            ctx.reset();
-            ctx.addData(reinterpret_cast<char *>(tmpout), sizeof(tmpout));
-            sha2salt = ctx.result();
-            bcrypt_hash(reinterpret_cast<quint8 *>(sha2pass.data()), reinterpret_cast<quint8 *>(sha2salt.data()), tmpout);
-            for (quint32 j = 0; j < sizeof(out); j++)
-                out[j] ^= tmpout[j];
-        }
+    for (quint32 count = 1, keylen = key.length(); keylen > 0; count++) {
+        Q_ASSERT(count <= stride);
+        memcpy(out, blockData + (count - 1) * BCRYPT_HASHSIZE, sizeof(out));
 
         /*
          * pbkdf2 deviation: output the key material non-linearly.
@@ -167,6 +199,7 @@ int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key
 
     /* zap */
     explicit_bzero(out, sizeof(out));
+    explicit_bzero(blockData, blocks.size());
 
     return 0;
 }
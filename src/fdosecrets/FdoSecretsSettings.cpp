@@ -87,7 +87,8 @@ namespace FdoSecrets
 
     QUuid FdoSecretsSettings::exposedGroup(Database* db) const
     {
-        return {db->metadata()->customData()->value(Keys::Db::FdoSecretsExposedGroup)};
+        return db->metadata()->customData()->parsedValue<QUuid>(Keys::Db::FdoSecretsExposedGroup,
+                                                                [](const QString& value) { return QUuid(value); });
     }
 
     void FdoSecretsSettings::setExposedGroup(Database* db, const QUuid& group) // clazy:exclude=function-args-by-value
@@ -0,0 +1,164 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "AttributeIndex.h"
+
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+
+#include <algorithm>
+
+namespace FdoSecrets
+{
+
+    /**
+     * @param exposedGroup group whose entries are searched, recursively
+     * @param attributes attribute values that must all match exactly
+     * @return matching entries in the order of the group tree
+     */
+    QList<Entry*> AttributeIndex::search(Group* exposedGroup, const StringStringMap& attributes)
+    {
+        update(exposedGroup);
+
+        // Intersect the entries of every attribute, starting with the smallest set
+        QList<const QSet<Entry*>*> sets;
+        for (auto it = attributes.constBegin(); it != attributes.constEnd(); ++it) {
+            const auto entries = m_entriesByAttribute.constFind(qMakePair(it.key(), it.value()));
+            if (entries == m_entriesByAttribute.constEnd()) {
+                return {};
+            }
+            sets.append(&entries.value());
+        }
+        if (sets.isEmpty()) {
+            return {};
+        }
+        std::sort(sets.begin(), sets.end(), [](const QSet<Entry*>* lhs, const QSet<Entry*>* rhs) {
+            return lhs->size() < rhs->size();
+        });
+
+        QList<Entry*> result;
+        for (Entry* entry : *sets.first()) {
+            bool matches = true;
+            for (int i = 1; i < sets.size() && matches; ++i) {
+                matches = sets[i]->contains(entry);
+            }
+            if (matches) {
+                result.append(entry);
+            }
+        }
+        std::sort(result.begin(), result.end(), [this](Entry* lhs, Entry* rhs) {
+            return m_entries.constFind(lhs)->order < m_entries.constFind(rhs)->order;
+        });
+        return result;
+    }
+
+    void AttributeIndex::clear()
+    {
+        m_group.clear();
+        m_entries.clear();
+        m_entriesByAttribute.clear();
+    }
+
+    void AttributeIndex::update(Group* exposedGroup)
+    {
+        if (m_group != exposedGroup) {
+            clear();
+            m_group = exposedGroup;
+        } else if (exposedGroup->database() && m_modificationCount == exposedGroup->database()->modificationCount()) {
+            return;
+        }
+
+        ++m_generation;
+        int order = 0;
+        for (auto* group : exposedGroup->groupsRecursive(true)) {
+            if (!group->resolveSearchingEnabled()) {
+                continue;
+            }
+            for (auto* entry : group->entries()) {
+                updateEntry(entry, order++);
+            }
+        }
+
+        // Drop the entries that were not visited: removed, moved or no longer searchable
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (it->generation != m_generation) {
+                remove(it.key(), it.value());
+                it = m_entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (exposedGroup->database()) {
+            m_modificationCount = exposedGroup->database()->modificationCount();
+        }
+    }
+
+    void AttributeIndex::updateEntry(Entry* entry, int order)
+    {
+        auto it = m_entries.find(entry);
+        if (it != m_entries.end()) {
+            it->generation = m_generation;
+            it->order = order;
+            if (it->revision == entry->revision() && !it->resolved) {
+                return;
+            }
+            remove(entry, it.value());
+            m_entries.erase(it);
+        }
+
+        IndexedEntry indexed;
+        indexed.revision = entry->revision();
+        indexed.generation = m_generation;
+        indexed.order = order;
+        indexed.resolved = false;
+
+        const EntryAttributes* attributes = entry->attributes();
+        for (const auto& key : attributes->keys()) {
+            // Matched the way Collection::attributeToTerm() searches them
+            QString value;
+            if (key == EntryAttributes::TitleKey || key == EntryAttributes::UserNameKey
+                || key == EntryAttributes::URLKey) {
+                value = entry->resolvePlaceholder(attributes->value(key));
+                indexed.resolved = indexed.resolved || attributes->isReference(key);
+            } else if (key == EntryAttributes::NotesKey || !attributes->isProtected(key)) {
+                value = attributes->value(key);
+            } else {
+                continue;
+            }
+
+            indexed.attributes.append(qMakePair(key, value));
+            m_entriesByAttribute[indexed.attributes.last()].insert(entry);
+        }
+
+        m_entries.insert(entry, indexed);
+    }
+
+    void AttributeIndex::remove(Entry* entry, const IndexedEntry& indexed)
+    {
+        for (const auto& attribute : indexed.attributes) {
+            auto entries = m_entriesByAttribute.find(attribute);
+            if (entries != m_entriesByAttribute.end()) {
+                entries->remove(entry);
+                if (entries->isEmpty()) {
+                    m_entriesByAttribute.erase(entries);
+                }
+            }
+        }
+    }
+
+} // namespace FdoSecrets
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSXC_FDOSECRETS_ATTRIBUTEINDEX_H
+#define KEEPASSXC_FDOSECRETS_ATTRIBUTEINDEX_H
+
+#include "fdosecrets/objects/DBusTypes.h"
+
+#include <QHash>
+#include <QPair>
+#include <QPointer>
+#include <QSet>
+
+class Entry;
+class Group;
+
+namespace FdoSecrets
+{
+
+    /**
+     * @brief Exact attribute values of the entries of an exposed group, so
+     * that SearchItems can intersect the entries of every requested pair
+     * instead of matching each entry against regular expressions.
+     *
+     * Only entries of groups with searching enabled are indexed, like in
+     * EntrySearcher. Protected custom attributes and passwords are not
+     * indexed, as they are not part of the item attributes either. The index is brought up to date
+     * before a search whenever the database was modified: entries whose
+     * revision changed are read again and entries that are gone are dropped.
+     */
+    class AttributeIndex
+    {
+    public:
+        QList<Entry*> search(Group* exposedGroup, const StringStringMap& attributes);
+        void clear();
+
+    private:
+        typedef QPair<QString, QString> Attribute;
+
+        struct IndexedEntry
+        {
+            quint64 revision;
+            quint64 generation;
+            int order;
+            // values with placeholders depend on other entries as well
+            bool resolved;
+            QList<Attribute> attributes;
+        };
+
+        void update(Group* exposedGroup);
+        void updateEntry(Entry* entry, int order);
+        void remove(Entry* entry, const IndexedEntry& indexed);
+
+        QPointer<Group> m_group;
+        quint64 m_modificationCount = 0;
+        quint64 m_generation = 0;
+        QHash<Entry*, IndexedEntry> m_entries;
+        QHash<Attribute, QSet<Entry*>> m_entriesByAttribute;
+    };
+
+} // namespace FdoSecrets
+
+#endif // KEEPASSXC_FDOSECRETS_ATTRIBUTEINDEX_H
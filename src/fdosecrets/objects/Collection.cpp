@@ -35,12 +35,21 @@
 namespace FdoSecrets
 {
 
+    namespace
+    {
+        constexpr int ITEM_CHANGED_INTERVAL_MS = 100;
+    } // namespace
+
     Collection::Collection(Service* parent, DatabaseWidget* backend)
         : DBusObject(parent)
         , m_backend(backend)
         , m_exposedGroup(nullptr)
         , m_registered(false)
     {
+        m_itemChangedTimer.setSingleShot(true);
+        m_itemChangedTimer.setInterval(ITEM_CHANGED_INTERVAL_MS);
+        connect(&m_itemChangedTimer, &QTimer::timeout, this, &Collection::emitItemsChanged);
+
         // whenever the file path or the database object itself change, we do a full reload.
         connect(backend, &DatabaseWidget::databaseFilePathChanged, this, &Collection::reloadBackend);
         connect(backend, &DatabaseWidget::databaseReplaced, this, &Collection::reloadBackend);
@@ -113,13 +122,26 @@ namespace FdoSecrets
         return {};
     }
 
-    DBusReturn<const QList<Item*>> Collection::items() const
+    DBusReturn<const QList<Item*>> Collection::items()
     {
         auto ret = ensureBackend();
         if (ret.isError()) {
             return ret;
         }
-        return m_items;
+        if (backendLocked() || !m_exposedGroup) {
+            return QList<Item*>{};
+        }
+
+        QList<Item*> items;
+        const auto entries = m_exposedGroup->entriesRecursive(false);
+        items.reserve(entries.size());
+        for (const auto& entry : entries) {
+            auto item = itemForEntry(entry);
+            if (item) {
+                items << item;
+            }
+        }
+        return items;
     }
 
     DBusReturn<QString> Collection::label() const
@@ -229,7 +251,7 @@ namespace FdoSecrets
             auto uuid = QUuid::fromRfc4122(QByteArray::fromHex(attributes.value(ItemAttributes::UuidKey).toLatin1()));
             auto entry = m_exposedGroup->findEntryByUuid(uuid);
             if (entry) {
-                return QList<Item*>{m_entryToItem.value(entry)};
+                return QList<Item*>{itemForEntry(entry)};
             } else {
                 return QList<Item*>{};
             }
@@ -239,22 +261,21 @@ namespace FdoSecrets
             auto path = attributes.value(ItemAttributes::PathKey);
             auto entry = m_exposedGroup->findEntryByPath(path);
             if (entry) {
-                return QList<Item*>{m_entryToItem.value(entry)};
+                return QList<Item*>{itemForEntry(entry)};
             } else {
                 return QList<Item*>{};
             }
         }
 
-        QList<EntrySearcher::SearchTerm> terms;
-        for (auto it = attributes.constBegin(); it != attributes.constEnd(); ++it) {
-            terms << attributeToTerm(it.key(), it.value());
-        }
+        // exact matches of all pairs are answered from the index,
+        // an empty search keeps the behavior of EntrySearcher
+        const auto foundEntries = attributes.isEmpty() ? EntrySearcher(false, true).search({}, m_exposedGroup)
+                                                       : m_attributeIndex.search(m_exposedGroup, attributes);
 
         QList<Item*> items;
-        const auto foundEntries = EntrySearcher(false, true).search(terms, m_exposedGroup);
         items.reserve(foundEntries.size());
         for (const auto& entry : foundEntries) {
-            items << m_entryToItem.value(entry);
+            items << itemForEntry(entry);
         }
         return items;
     }
@@ -528,13 +549,8 @@ namespace FdoSecrets
             onDatabaseExposedGroupChanged();
         });
 
-        // Add items for existing entry
-        const auto entries = m_exposedGroup->entriesRecursive(false);
-        for (const auto& entry : entries) {
-            onEntryAdded(entry, false);
-        }
-
-        connectGroupSignalRecursive(m_exposedGroup);
+        // Items for the existing entries are created when a client asks for them
+        connectDatabaseSignals(m_backend->database().data());
     }
 
     void Collection::onDatabaseExposedGroupChanged()
@@ -552,49 +568,106 @@ namespace FdoSecrets
         }
     }
 
-    void Collection::onEntryAdded(Entry* entry, bool emitSignal)
+    Item* Collection::itemForEntry(Entry* entry)
+    {
+        if (!entry || backendLocked() || !isExposed(entry->group())) {
+            return nullptr;
+        }
+        auto item = m_entryToItem.value(entry);
+        if (item) {
+            return item;
+        }
+        return onEntryAdded(entry, false);
+    }
+
+    /**
+     * @param uuid hex encoded uuid of the entry, as in the item path
+     */
+    Item* Collection::itemForUuid(const QString& uuid)
+    {
+        if (backendLocked() || !m_exposedGroup) {
+            return nullptr;
+        }
+        return itemForEntry(m_exposedGroup->findEntryByUuid(QUuid::fromRfc4122(QByteArray::fromHex(uuid.toLatin1()))));
+    }
+
+    Item* Collection::onEntryAdded(Entry* entry, bool emitSignal)
     {
         if (inRecycleBin(entry)) {
-            return;
+            return nullptr;
         }
 
         auto item = new Item(this, entry);
         m_items << item;
         m_entryToItem[entry] = item;
 
-        // forward delete signals
-        connect(entry->group(), &Group::entryAboutToRemove, item, [item](Entry* toBeRemoved) {
-            if (item->backend() == toBeRemoved) {
-                item->doDelete();
+        // relay signals
+        connect(item, &Item::itemChanged, this, [this, item]() {
+            if (!m_changedItemSet.contains(item)) {
+                m_changedItemSet.insert(item);
+                m_changedItems.append(item);
+            }
+            if (!m_itemChangedTimer.isActive()) {
+                m_itemChangedTimer.start();
             }
         });
-
-        // relay signals
-        connect(item, &Item::itemChanged, this, [this, item]() { emit itemChanged(item); });
         connect(item, &Item::itemAboutToDelete, this, [this, item]() {
             m_items.removeAll(item);
             m_entryToItem.remove(item->backend());
+            if (m_changedItemSet.remove(item)) {
+                m_changedItems.removeOne(item);
+            }
             emit itemDeleted(item);
         });
 
         if (emitSignal) {
             emit itemCreated(item);
         }
+        return item;
     }
 
-    void Collection::connectGroupSignalRecursive(Group* group)
+    void Collection::emitItemsChanged()
     {
-        if (inRecycleBin(group)) {
-            return;
+        const auto items = m_changedItems;
+        m_changedItems.clear();
+        m_changedItemSet.clear();
+        for (const auto& item : items) {
+            emit itemChanged(item);
         }
+    }
 
-        connect(group, &Group::groupModified, this, &Collection::collectionChanged);
-        connect(group, &Group::entryAdded, this, [this](Entry* entry) { onEntryAdded(entry, true); });
+    void Collection::connectDatabaseSignals(Database* db)
+    {
+        // a single connection per signal for the whole database instead of connections to every group
+        connect(db, &Database::groupModified, this, [this](Group* group) {
+            if (isExposed(group)) {
+                emit collectionChanged();
+            }
+        });
+        connect(db, &Database::entryAdded, this, [this](Entry* entry) {
+            if (isExposed(entry->group())) {
+                onEntryAdded(entry, true);
+            }
+        });
+        connect(db, &Database::entryAboutToRemove, this, [this](Entry* entry) {
+            auto item = m_entryToItem.value(entry);
+            if (item) {
+                item->doDelete();
+            }
+        });
+    }
 
-        const auto children = group->children();
-        for (const auto& cg : children) {
-            connectGroupSignalRecursive(cg);
+    bool Collection::isExposed(Group* group) const
+    {
+        if (!m_exposedGroup || inRecycleBin(group)) {
+            return false;
+        }
+        for (; group; group = group->parentGroup()) {
+            if (group == m_exposedGroup) {
+                return true;
+            }
         }
+        return false;
     }
 
     Service* Collection::service() const
@@ -649,12 +722,18 @@ namespace FdoSecrets
     {
         m_backend->database()->metadata()->customData()->disconnect(this);
         if (m_exposedGroup) {
-            for (const auto group : m_exposedGroup->groupsRecursive(true)) {
-                group->disconnect(this);
+            m_exposedGroup->disconnect(this);
+            if (m_exposedGroup->database()) {
+                m_exposedGroup->database()->disconnect(this);
             }
         }
 
         m_items.clear();
+        m_entryToItem.clear();
+        m_attributeIndex.clear();
+        m_changedItems.clear();
+        m_changedItemSet.clear();
+        m_itemChangedTimer.stop();
     }
 
     QString Collection::backendFilePath() const
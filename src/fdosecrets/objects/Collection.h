@@ -20,11 +20,13 @@
 
 #include "DBusObject.h"
 
+#include "AttributeIndex.h"
 #include "adaptors/CollectionAdaptor.h"
 #include "core/EntrySearcher.h"
 
 #include <QPointer>
 #include <QSet>
+#include <QTimer>
 
 class Database;
 class DatabaseWidget;
@@ -42,7 +44,7 @@ namespace FdoSecrets
     public:
         explicit Collection(Service* parent, DatabaseWidget* backend);
 
-        DBusReturn<const QList<Item*>> items() const;
+        DBusReturn<const QList<Item*>> items();
 
         DBusReturn<QString> label() const;
         DBusReturn<void> setLabel(const QString& label);
@@ -98,6 +100,15 @@ namespace FdoSecrets
         bool inRecycleBin(Group* group) const;
         bool inRecycleBin(Entry* entry) const;
 
+        /**
+         * Items are only created for the entries handed out to clients,
+         * so exposing a large group doesn't register an object per entry.
+         * @return the item of the exposed entry, created on first use, or
+         *         nullptr if the entry is not exposed
+         */
+        Item* itemForEntry(Entry* entry);
+        Item* itemForUuid(const QString& uuid);
+
         static EntrySearcher::SearchTerm attributeToTerm(const QString& key, const QString& value);
 
     public slots:
@@ -115,14 +126,16 @@ namespace FdoSecrets
         void onDatabaseExposedGroupChanged();
         // force reload info from backend, potentially delete self
         void reloadBackend();
+        void emitItemsChanged();
 
     private:
         friend class DeleteCollectionPrompt;
         friend class CreateCollectionPrompt;
 
-        void onEntryAdded(Entry* entry, bool emitSignal);
+        Item* onEntryAdded(Entry* entry, bool emitSignal);
         void populateContents();
-        void connectGroupSignalRecursive(Group* group);
+        void connectDatabaseSignals(Database* db);
+        bool isExposed(Group* group) const;
         void cleanupConnections();
 
         bool backendLocked() const;
@@ -152,8 +165,16 @@ namespace FdoSecrets
         QPointer<Group> m_exposedGroup;
 
         QSet<QString> m_aliases;
+        // items created so far
         QList<Item*> m_items;
         QMap<const Entry*, Item*> m_entryToItem;
+        AttributeIndex m_attributeIndex;
+
+        // items changed since itemChanged was last emitted, so that bulk
+        // edits signal every item once per interval
+        QList<Item*> m_changedItems;
+        QSet<Item*> m_changedItemSet;
+        QTimer m_itemChangedTimer;
 
         bool m_registered;
     };
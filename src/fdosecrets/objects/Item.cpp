@@ -212,11 +212,7 @@ namespace FdoSecrets
 
     DBusReturn<SecretStruct> Item::getSecret(Session* session)
     {
-        auto ret = ensureBackend();
-        if (ret.isError()) {
-            return ret;
-        }
-        ret = ensureUnlocked();
+        auto ret = plainSecret();
         if (ret.isError()) {
             return ret;
         }
@@ -225,10 +221,8 @@ namespace FdoSecrets
             return DBusReturn<>::Error(QStringLiteral(DBUS_ERROR_SECRET_NO_SESSION));
         }
 
-        auto secret = getEntrySecret(m_backend);
-
         // encode using session
-        secret = session->encode(secret);
+        auto secret = session->encode(ret.value());
 
         // show notification is this was directly called from DBus
         if (calledFromDBus()) {
@@ -310,6 +304,20 @@ namespace FdoSecrets
         return {};
     }
 
+    DBusReturn<SecretStruct> Item::plainSecret() const
+    {
+        auto ret = ensureBackend();
+        if (ret.isError()) {
+            return ret;
+        }
+        ret = ensureUnlocked();
+        if (ret.isError()) {
+            return ret;
+        }
+
+        return getEntrySecret(m_backend);
+    }
+
     Entry* Item::backend() const
     {
         return m_backend;
@@ -328,6 +336,26 @@ namespace FdoSecrets
         deleteLater();
     }
 
+    template <> Item* pathToObject<Item>(const QDBusObjectPath& path)
+    {
+        if (path.path() == QStringLiteral("/")) {
+            return nullptr;
+        }
+        auto bus = QDBusConnection::sessionBus();
+        auto item = qobject_cast<Item*>(bus.objectRegisteredAt(path.path()));
+        if (item) {
+            return item;
+        }
+
+        // the item path is the collection path followed by the entry uuid
+        auto separator = path.path().lastIndexOf('/');
+        auto collection = qobject_cast<Collection*>(bus.objectRegisteredAt(path.path().left(separator)));
+        if (!collection) {
+            return nullptr;
+        }
+        return collection->itemForUuid(path.path().mid(separator + 1));
+    }
+
     Service* Item::service() const
     {
         return collection()->service();
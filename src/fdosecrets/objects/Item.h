@@ -87,6 +87,13 @@ namespace FdoSecrets
          */
         bool isDeletePermanent() const;
 
+        /**
+         * Get the secret without encoding it for a session, so that
+         * several secrets can be encoded together
+         * @return the plain secret, or an error if the item is not accessible
+         */
+        DBusReturn<SecretStruct> plainSecret() const;
+
     public slots:
         void doDelete();
 
@@ -107,6 +114,14 @@ namespace FdoSecrets
         QPointer<Entry> m_backend;
     };
 
+    /**
+     * Items are created on first use, so an item path handed out earlier
+     * may not be registered yet. Ask its collection for it in that case.
+     * @param path
+     * @return the item, or nullptr if path is "/" or no exposed entry
+     */
+    template <> Item* pathToObject<Item>(const QDBusObjectPath& path);
+
 } // namespace FdoSecrets
 
 #endif // KEEPASSXC_FDOSECRETS_ITEM_H
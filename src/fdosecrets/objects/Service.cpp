@@ -75,6 +75,9 @@ namespace FdoSecrets
 
         m_serviceWatcher->setConnection(QDBusConnection::sessionBus());
 
+        // have server keys ready before the first client opens a session
+        DhIetf1024Sha256Aes128CbcPkcs7::prepareServerKeys();
+
         // Add existing database tabs
         for (int idx = 0; idx != m_databases->count(); ++idx) {
             auto dbWidget = m_databases->databaseWidgetFromIndex(idx);
@@ -363,14 +366,22 @@ namespace FdoSecrets
             return DBusReturn<>::Error(QStringLiteral(DBUS_ERROR_SECRET_NO_SESSION));
         }
 
-        QHash<Item*, SecretStruct> res;
-
+        // collect all secrets first so they can be encoded in one batch
+        QList<SecretStruct> secrets;
+        secrets.reserve(items.size());
         for (const auto& item : asConst(items)) {
-            auto ret = item->getSecret(session);
+            auto ret = item->plainSecret();
             if (ret.isError()) {
                 return ret;
             }
-            res[item] = std::move(ret).value();
+            secrets.append(std::move(ret).value());
+        }
+        secrets = session->encode(secrets);
+
+        QHash<Item*, SecretStruct> res;
+        res.reserve(items.size());
+        for (int i = 0; i < items.size(); ++i) {
+            res[items[i]] = secrets[i];
         }
         if (calledFromDBus()) {
             plugin()->emitRequestShowNotification(
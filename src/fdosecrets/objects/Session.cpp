@@ -24,6 +24,7 @@ namespace FdoSecrets
 {
 
     QHash<QString, QVariant> Session::negoniationState;
+    QCache<QString, Session::CachedNegotiation> Session::negotiationCache(32);
 
     Session::Session(std::unique_ptr<CipherPair>&& cipher, const QString& peer, Service* parent)
         : DBusObject(parent)
@@ -38,6 +39,7 @@ namespace FdoSecrets
     void Session::CleanupNegotiation(const QString& peer)
     {
         negoniationState.remove(peer);
+        negotiationCache.remove(peer);
     }
 
     DBusReturn<void> Session::close()
@@ -64,7 +66,6 @@ namespace FdoSecrets
                                                        QVariant& output,
                                                        bool& incomplete)
     {
-        Q_UNUSED(peer);
         incomplete = false;
 
         std::unique_ptr<CipherPair> cipher{};
@@ -72,7 +73,17 @@ namespace FdoSecrets
             cipher.reset(new PlainCipher);
         } else if (algorithm == QLatin1String(DhIetf1024Sha256Aes128CbcPkcs7::Algorithm)) {
             QByteArray clientPublicKey = input.toByteArray();
-            cipher.reset(new DhIetf1024Sha256Aes128CbcPkcs7(clientPublicKey));
+            auto cached = negotiationCache.object(peer);
+            if (cached && cached->clientPublicKey == clientPublicKey) {
+                cipher = cached->cipher->clone();
+            } else {
+                std::unique_ptr<DhIetf1024Sha256Aes128CbcPkcs7> dhCipher{
+                    new DhIetf1024Sha256Aes128CbcPkcs7(clientPublicKey)};
+                if (dhCipher->isValid()) {
+                    negotiationCache.insert(peer, new CachedNegotiation{clientPublicKey, dhCipher->clone()});
+                }
+                cipher = std::move(dhCipher);
+            }
         } else {
             // error notSupported
         }
@@ -97,6 +108,15 @@ namespace FdoSecrets
         return output;
     }
 
+    QList<SecretStruct> Session::encode(const QList<SecretStruct>& inputs) const
+    {
+        auto outputs = m_cipher->encryptAll(inputs);
+        for (auto& output : outputs) {
+            output.session = objectPath();
+        }
+        return outputs;
+    }
+
     SecretStruct Session::decode(const SecretStruct& input) const
     {
         return m_cipher->decrypt(input);
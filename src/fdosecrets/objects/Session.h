@@ -24,6 +24,7 @@
 #include "fdosecrets/objects/adaptors/SessionAdaptor.h"
 
 #include <QByteArray>
+#include <QCache>
 #include <QHash>
 #include <QUuid>
 #include <QVariant>
@@ -56,6 +57,13 @@ namespace FdoSecrets
          */
         SecretStruct encode(const SecretStruct& input) const;
 
+        /**
+         * Encode several secret structs at once, sharing the cipher setup.
+         * @param inputs
+         * @return encoded secrets in the same order as inputs
+         */
+        QList<SecretStruct> encode(const QList<SecretStruct>& inputs) const;
+
         /**
          * Decode the secret struct.
          * @param input
@@ -84,6 +92,17 @@ namespace FdoSecrets
         QUuid m_id;
 
         static QHash<QString, QVariant> negoniationState;
+
+        /**
+         * The last DH negotiation of each peer. A peer opening another session
+         * with the same public key gets the same keys without redoing the exchange.
+         */
+        struct CachedNegotiation
+        {
+            QByteArray clientPublicKey;
+            std::unique_ptr<DhIetf1024Sha256Aes128CbcPkcs7> cipher;
+        };
+        static QCache<QString, CachedNegotiation> negotiationCache;
     };
 
 } // namespace FdoSecrets
@@ -17,13 +17,17 @@
 
 #include "SessionCipher.h"
 
+#include "core/AsyncTask.h"
 #include "crypto/CryptoHash.h"
 #include "crypto/Random.h"
 #include "crypto/SymmetricCipher.h"
 
+#include <QMutex>
+
 #include <gcrypt.h>
 
 #include <memory>
+#include <vector>
 
 namespace
 {
@@ -39,6 +43,81 @@ namespace
     constexpr const int AES_KEY_LEN = 16; // 128 bits
 
     const auto IETF1024_SECOND_OAKLEY_GROUP_P = MpiFromHex(IETF1024_SECOND_OAKLEY_GROUP_P_HEX, false);
+
+    constexpr const size_t SERVER_KEY_POOL_SIZE = 4;
+
+    void generateServerKeys(GcryptMPI& serverPrivate, GcryptMPI& serverPublic)
+    {
+        // generate server side private, 128 bytes
+        serverPrivate.reset(gcry_mpi_snew(KEY_SIZE_BYTES * 8));
+        gcry_mpi_randomize(serverPrivate.get(), KEY_SIZE_BYTES * 8, GCRY_STRONG_RANDOM);
+
+        // generate server side public key
+        serverPublic.reset(gcry_mpi_snew(KEY_SIZE_BYTES * 8));
+        // the generator of Second Oakley Group is 2
+        gcry_mpi_powm(serverPublic.get(), GCRYMPI_CONST_TWO, serverPrivate.get(), IETF1024_SECOND_OAKLEY_GROUP_P.get());
+    }
+
+    /**
+     * A few server key pairs computed ahead of time on a worker thread, so that
+     * opening a session only pays for the exponentiation of the common secret.
+     * Each key pair is handed out once.
+     */
+    class ServerKeyPool
+    {
+    public:
+        static ServerKeyPool& instance()
+        {
+            static ServerKeyPool pool;
+            return pool;
+        }
+
+        void take(GcryptMPI& serverPrivate, GcryptMPI& serverPublic)
+        {
+            {
+                QMutexLocker locker(&m_mutex);
+                if (!m_keys.empty()) {
+                    serverPrivate = std::move(m_keys.back().first);
+                    serverPublic = std::move(m_keys.back().second);
+                    m_keys.pop_back();
+                }
+            }
+            if (!serverPrivate) {
+                generateServerKeys(serverPrivate, serverPublic);
+            }
+            refill();
+        }
+
+        void refill()
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_refilling || m_keys.size() >= SERVER_KEY_POOL_SIZE) {
+                return;
+            }
+            m_refilling = true;
+            AsyncTask::run(AsyncTask::Executor::Background, [this]() {
+                forever {
+                    GcryptMPI serverPrivate;
+                    GcryptMPI serverPublic;
+                    generateServerKeys(serverPrivate, serverPublic);
+
+                    QMutexLocker locker(&m_mutex);
+                    m_keys.emplace_back(std::move(serverPrivate), std::move(serverPublic));
+                    if (m_keys.size() >= SERVER_KEY_POOL_SIZE) {
+                        m_refilling = false;
+                        return;
+                    }
+                }
+            });
+        }
+
+    private:
+        ServerKeyPool() = default;
+
+        QMutex m_mutex;
+        std::vector<std::pair<GcryptMPI, GcryptMPI>> m_keys;
+        bool m_refilling = false;
+    };
 } // namespace
 
 namespace FdoSecrets
@@ -53,24 +132,19 @@ namespace FdoSecrets
         // read client public key
         auto clientPub = MpiFromBytes(clientPublicKeyBytes, false);
 
-        // generate server side private, 128 bytes
         GcryptMPI serverPrivate = nullptr;
+        GcryptMPI serverPublic = nullptr;
         if (NextPrivKey) {
             serverPrivate = std::move(NextPrivKey);
+            if (NextPubKey) {
+                serverPublic = std::move(NextPubKey);
+            } else {
+                serverPublic.reset(gcry_mpi_snew(KEY_SIZE_BYTES * 8));
+                gcry_mpi_powm(
+                    serverPublic.get(), GCRYMPI_CONST_TWO, serverPrivate.get(), IETF1024_SECOND_OAKLEY_GROUP_P.get());
+            }
         } else {
-            serverPrivate.reset(gcry_mpi_snew(KEY_SIZE_BYTES * 8));
-            gcry_mpi_randomize(serverPrivate.get(), KEY_SIZE_BYTES * 8, GCRY_STRONG_RANDOM);
-        }
-
-        // generate server side public key
-        GcryptMPI serverPublic = nullptr;
-        if (NextPubKey) {
-            serverPublic = std::move(NextPubKey);
-        } else {
-            serverPublic.reset(gcry_mpi_snew(KEY_SIZE_BYTES * 8));
-            // the generator of Second Oakley Group is 2
-            gcry_mpi_powm(
-                serverPublic.get(), GCRYMPI_CONST_TWO, serverPrivate.get(), IETF1024_SECOND_OAKLEY_GROUP_P.get());
+            ServerKeyPool::instance().take(serverPrivate, serverPublic);
         }
 
         initialize(std::move(clientPub), std::move(serverPublic), std::move(serverPrivate));
@@ -176,6 +250,50 @@ namespace FdoSecrets
         return output;
     }
 
+    QList<SecretStruct> DhIetf1024Sha256Aes128CbcPkcs7::encryptAll(const QList<SecretStruct>& inputs)
+    {
+        if (inputs.size() < 2) {
+            return CipherPair::encryptAll(inputs);
+        }
+
+        QList<SecretStruct> outputs;
+        outputs.reserve(inputs.size());
+
+        // set up the cipher and draw the IVs for all secrets once, then only restart with a new IV per secret
+        SymmetricCipher encrypter(SymmetricCipher::Aes128, SymmetricCipher::Cbc, SymmetricCipher::Encrypt);
+        const int ivSize = SymmetricCipher::algorithmIvSize(SymmetricCipher::Aes128);
+        const auto IVs = randomGen()->randomArray(ivSize * inputs.size());
+        bool ready = encrypter.init(m_aesKey, IVs.left(ivSize));
+        if (!ready) {
+            qWarning() << "Error encrypt: " << encrypter.errorString();
+        }
+
+        for (int i = 0; i < inputs.size(); ++i) {
+            SecretStruct output = inputs[i];
+            output.value.clear();
+            output.parameters.clear();
+
+            auto IV = IVs.mid(i * ivSize, ivSize);
+            if (!ready || (i > 0 && !encrypter.setIv(IV))) {
+                qWarning() << "Error encrypt: " << encrypter.errorString();
+                outputs.append(output);
+                continue;
+            }
+
+            output.parameters = IV;
+
+            bool ok;
+            output.value = inputs[i].value;
+            output.value = encrypter.process(padPkcs7(output.value, encrypter.blockSize()), &ok);
+            if (!ok) {
+                qWarning() << "Error encrypt: " << encrypter.errorString();
+            }
+            outputs.append(output);
+        }
+
+        return outputs;
+    }
+
     QByteArray& DhIetf1024Sha256Aes128CbcPkcs7::padPkcs7(QByteArray& input, int blockSize)
     {
         // blockSize must be a power of 2.
@@ -230,6 +348,21 @@ namespace FdoSecrets
         return m_publicKey;
     }
 
+    void DhIetf1024Sha256Aes128CbcPkcs7::prepareServerKeys()
+    {
+        ServerKeyPool::instance().refill();
+    }
+
+    std::unique_ptr<DhIetf1024Sha256Aes128CbcPkcs7> DhIetf1024Sha256Aes128CbcPkcs7::clone() const
+    {
+        std::unique_ptr<DhIetf1024Sha256Aes128CbcPkcs7> copy{new DhIetf1024Sha256Aes128CbcPkcs7};
+        copy->m_valid = m_valid;
+        copy->m_privateKey = m_privateKey;
+        copy->m_publicKey = m_publicKey;
+        copy->m_aesKey = m_aesKey;
+        return copy;
+    }
+
     void DhIetf1024Sha256Aes128CbcPkcs7::fixNextServerKeys(GcryptMPI priv, GcryptMPI pub)
     {
         NextPrivKey = std::move(priv);
@@ -34,6 +34,15 @@ namespace FdoSecrets
         CipherPair() = default;
         virtual ~CipherPair() = default;
         virtual SecretStruct encrypt(const SecretStruct& input) = 0;
+        virtual QList<SecretStruct> encryptAll(const QList<SecretStruct>& inputs)
+        {
+            QList<SecretStruct> outputs;
+            outputs.reserve(inputs.size());
+            for (const auto& input : inputs) {
+                outputs.append(encrypt(input));
+            }
+            return outputs;
+        }
         virtual SecretStruct decrypt(const SecretStruct& input) = 0;
         virtual bool isValid() const = 0;
         virtual QVariant negotiationOutput() const = 0;
@@ -51,6 +60,11 @@ namespace FdoSecrets
             return input;
         }
 
+        QList<SecretStruct> encryptAll(const QList<SecretStruct>& inputs) override
+        {
+            return inputs;
+        }
+
         SecretStruct decrypt(const SecretStruct& input) override
         {
             return input;
@@ -122,12 +136,26 @@ namespace FdoSecrets
 
         SecretStruct encrypt(const SecretStruct& input) override;
 
+        QList<SecretStruct> encryptAll(const QList<SecretStruct>& inputs) override;
+
         SecretStruct decrypt(const SecretStruct& input) override;
 
         bool isValid() const override;
 
         QVariant negotiationOutput() const override;
 
+        /**
+         * Start computing server key pairs in the background, so that the
+         * next sessions don't have to wait for them.
+         */
+        static void prepareServerKeys();
+
+        /**
+         * Make an independent cipher with the same negotiated keys, for
+         * another session of a peer that presents the same public key.
+         */
+        std::unique_ptr<DhIetf1024Sha256Aes128CbcPkcs7> clone() const;
+
     private:
         /**
          * For test only, fix the server side private and public key.
@@ -17,6 +17,7 @@
 
 #include "CollectionAdaptor.h"
 
+#include "core/Trace.h"
 #include "fdosecrets/objects/Collection.h"
 #include "fdosecrets/objects/Item.h"
 #include "fdosecrets/objects/Prompt.h"
@@ -67,11 +68,13 @@ namespace FdoSecrets
 
     QDBusObjectPath CollectionAdaptor::Delete()
     {
+        TRACE_SCOPE("FdoSecrets::CollectionAdaptor::Delete");
         return objectPathSafe(p()->deleteCollection().valueOrHandle(p()));
     }
 
     QList<QDBusObjectPath> CollectionAdaptor::SearchItems(const StringStringMap& attributes)
     {
+        TRACE_SCOPE("FdoSecrets::CollectionAdaptor::SearchItems");
         return objectsToPath(p()->searchItems(attributes).valueOrHandle(p()));
     }
 
@@ -80,6 +83,7 @@ namespace FdoSecrets
                                                   bool replace,
                                                   QDBusObjectPath& prompt)
     {
+        TRACE_SCOPE("FdoSecrets::CollectionAdaptor::CreateItem");
         PromptBase* pp = nullptr;
         auto item = p()->createItem(properties, secret, replace, pp).valueOrHandle(p());
         prompt = objectPathSafe(pp);
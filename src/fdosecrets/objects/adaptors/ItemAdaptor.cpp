@@ -17,6 +17,7 @@
 
 #include "ItemAdaptor.h"
 
+#include "core/Trace.h"
 #include "fdosecrets/objects/Item.h"
 #include "fdosecrets/objects/Prompt.h"
 #include "fdosecrets/objects/Session.h"
@@ -66,17 +67,20 @@ namespace FdoSecrets
 
     QDBusObjectPath ItemAdaptor::Delete()
     {
+        TRACE_SCOPE("FdoSecrets::ItemAdaptor::Delete");
         auto prompt = p()->deleteItem().valueOrHandle(p());
         return objectPathSafe(prompt);
     }
 
     SecretStruct ItemAdaptor::GetSecret(const QDBusObjectPath& session)
     {
+        TRACE_SCOPE("FdoSecrets::ItemAdaptor::GetSecret");
         return p()->getSecret(pathToObject<Session>(session)).valueOrHandle(p());
     }
 
     void ItemAdaptor::SetSecret(const SecretStruct& secret)
     {
+        TRACE_SCOPE("FdoSecrets::ItemAdaptor::SetSecret");
         p()->setSecret(secret).handle(p());
     }
 
@@ -17,6 +17,7 @@
 
 #include "PromptAdaptor.h"
 
+#include "core/Trace.h"
 #include "fdosecrets/objects/Prompt.h"
 
 namespace FdoSecrets
@@ -36,11 +37,13 @@ namespace FdoSecrets
 
     void PromptAdaptor::Prompt(const QString& windowId)
     {
+        TRACE_SCOPE("FdoSecrets::PromptAdaptor::Prompt");
         p()->prompt(windowId).handle(p());
     }
 
     void PromptAdaptor::Dismiss()
     {
+        TRACE_SCOPE("FdoSecrets::PromptAdaptor::Dismiss");
         p()->dismiss().handle(p());
     }
 
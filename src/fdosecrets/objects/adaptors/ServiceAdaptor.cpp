@@ -17,6 +17,7 @@
 
 #include "ServiceAdaptor.h"
 
+#include "core/Trace.h"
 #include "fdosecrets/objects/Collection.h"
 #include "fdosecrets/objects/Item.h"
 #include "fdosecrets/objects/Prompt.h"
@@ -49,6 +50,7 @@ namespace FdoSecrets
     QDBusVariant
     ServiceAdaptor::OpenSession(const QString& algorithm, const QDBusVariant& input, QDBusObjectPath& result)
     {
+        TRACE_SCOPE("FdoSecrets::ServiceAdaptor::OpenSession");
         Session* session = nullptr;
         auto output = p()->openSession(algorithm, input.variant(), session).valueOrHandle(p());
         result = objectPathSafe(session);
@@ -58,6 +60,7 @@ namespace FdoSecrets
     QDBusObjectPath
     ServiceAdaptor::CreateCollection(const QVariantMap& properties, const QString& alias, QDBusObjectPath& prompt)
     {
+        TRACE_SCOPE("FdoSecrets::ServiceAdaptor::CreateCollection");
         PromptBase* pp;
         auto coll = p()->createCollection(properties, alias, pp).valueOrHandle(p());
         prompt = objectPathSafe(pp);
@@ -67,6 +70,7 @@ namespace FdoSecrets
     const QList<QDBusObjectPath> ServiceAdaptor::SearchItems(const StringStringMap& attributes,
                                                              QList<QDBusObjectPath>& locked)
     {
+        TRACE_SCOPE("FdoSecrets::ServiceAdaptor::SearchItems");
         QList<Item*> lockedItems, unlockedItems;
         unlockedItems = p()->searchItems(attributes, lockedItems).valueOrHandle(p());
         locked = objectsToPath(lockedItems);
@@ -75,6 +79,7 @@ namespace FdoSecrets
 
     const QList<QDBusObjectPath> ServiceAdaptor::Unlock(const QList<QDBusObjectPath>& paths, QDBusObjectPath& prompt)
     {
+        TRACE_SCOPE("FdoSecrets::ServiceAdaptor::Unlock");
         auto objects = pathsToObject<DBusObject>(paths);
         if (!paths.isEmpty() && objects.isEmpty()) {
             DBusReturn<>::Error(QStringLiteral(DBUS_ERROR_SECRET_NO_SUCH_OBJECT)).handle(p());
@@ -90,6 +95,7 @@ namespace FdoSecrets
 
     const QList<QDBusObjectPath> ServiceAdaptor::Lock(const QList<QDBusObjectPath>& paths, QDBusObjectPath& prompt)
     {
+        TRACE_SCOPE("FdoSecrets::ServiceAdaptor::Lock");
         auto objects = pathsToObject<DBusObject>(paths);
         if (!paths.isEmpty() && objects.isEmpty()) {
             DBusReturn<>::Error(QStringLiteral(DBUS_ERROR_SECRET_NO_SUCH_OBJECT)).handle(p());
@@ -106,6 +112,7 @@ namespace FdoSecrets
     const ObjectPathSecretMap ServiceAdaptor::GetSecrets(const QList<QDBusObjectPath>& items,
                                                          const QDBusObjectPath& session)
     {
+        TRACE_SCOPE("FdoSecrets::ServiceAdaptor::GetSecrets");
         auto itemObjects = pathsToObject<Item>(items);
         if (!items.isEmpty() && itemObjects.isEmpty()) {
             DBusReturn<>::Error(QStringLiteral(DBUS_ERROR_SECRET_NO_SUCH_OBJECT)).handle(p());
@@ -125,12 +132,14 @@ namespace FdoSecrets
 
     QDBusObjectPath ServiceAdaptor::ReadAlias(const QString& name)
     {
+        TRACE_SCOPE("FdoSecrets::ServiceAdaptor::ReadAlias");
         auto coll = p()->readAlias(name).valueOrHandle(p());
         return objectPathSafe(coll);
     }
 
     void ServiceAdaptor::SetAlias(const QString& name, const QDBusObjectPath& collection)
     {
+        TRACE_SCOPE("FdoSecrets::ServiceAdaptor::SetAlias");
         p()->setAlias(name, pathToObject<Collection>(collection)).handle(p());
     }
 
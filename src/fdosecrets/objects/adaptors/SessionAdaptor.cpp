@@ -17,6 +17,7 @@
 
 #include "SessionAdaptor.h"
 
+#include "core/Trace.h"
 #include "fdosecrets/objects/Session.h"
 
 namespace FdoSecrets
@@ -29,6 +30,7 @@ namespace FdoSecrets
 
     void SessionAdaptor::Close()
     {
+        TRACE_SCOPE("FdoSecrets::SessionAdaptor::Close");
         p()->close().handle(p());
     }
 
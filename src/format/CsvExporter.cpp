@@ -18,48 +18,13 @@
 
 #include "CsvExporter.h"
 
-#include <QFile>
-
 #include "core/Database.h"
 #include "core/Group.h"
 
-bool CsvExporter::exportDatabase(const QString& filename, const QSharedPointer<const Database>& db)
-{
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        m_error = file.errorString();
-        return false;
-    }
-    return exportDatabase(&file, db);
-}
-
-bool CsvExporter::exportDatabase(QIODevice* device, const QSharedPointer<const Database>& db)
-{
-    if (device->write(exportHeader().toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
-    }
-
-    if (device->write(exportGroup(db->rootGroup()).toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
-    }
-
-    return true;
-}
-
-QString CsvExporter::exportDatabase(const QSharedPointer<const Database>& db)
-{
-    return exportHeader() + exportGroup(db->rootGroup());
-}
-
-QString CsvExporter::errorString() const
+bool CsvExporter::writeHeader(QIODevice* device, const Database& db)
 {
-    return m_error;
-}
+    Q_UNUSED(db);
 
-QString CsvExporter::exportHeader()
-{
     QString header;
     addColumn(header, "Group");
     addColumn(header, "Title");
@@ -71,18 +36,15 @@ QString CsvExporter::exportHeader()
     addColumn(header, "Icon");
     addColumn(header, "Last Modified");
     addColumn(header, "Created");
-    return header + QString("\n");
+    return write(device, header + QString("\n"));
 }
 
-QString CsvExporter::exportGroup(const Group* group, QString groupPath)
+bool CsvExporter::writeGroup(QIODevice* device, const Group& group, const QStringList& path)
 {
-    QString response;
-    if (!groupPath.isEmpty()) {
-        groupPath.append("/");
-    }
-    groupPath.append(group->name());
+    const QString groupPath = path.join("/");
 
-    const QList<Entry*>& entryList = group->entries();
+    QString response;
+    const QList<Entry*>& entryList = group.entries();
     for (const Entry* entry : entryList) {
         QString line;
 
@@ -101,12 +63,7 @@ QString CsvExporter::exportGroup(const Group* group, QString groupPath)
         response.append(line);
     }
 
-    const QList<Group*>& children = group->children();
-    for (const Group* child : children) {
-        response.append(exportGroup(child, groupPath));
-    }
-
-    return response;
+    return write(device, response);
 }
 
 void CsvExporter::addColumn(QString& str, const QString& column)
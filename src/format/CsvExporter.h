@@ -19,27 +19,16 @@
 #ifndef KEEPASSX_CSVEXPORTER_H
 #define KEEPASSX_CSVEXPORTER_H
 
-#include <QString>
-#include <QtCore/QSharedPointer>
+#include "core/Exporter.h"
 
-class Database;
-class Group;
-class QIODevice;
-
-class CsvExporter
+class CsvExporter : public Exporter
 {
-public:
-    bool exportDatabase(const QString& filename, const QSharedPointer<const Database>& db);
-    bool exportDatabase(QIODevice* device, const QSharedPointer<const Database>& db);
-    QString exportDatabase(const QSharedPointer<const Database>& db);
-    QString errorString() const;
+protected:
+    bool writeHeader(QIODevice* device, const Database& db) override;
+    bool writeGroup(QIODevice* device, const Group& group, const QStringList& path) override;
 
 private:
-    QString exportGroup(const Group* group, QString groupPath = QString());
-    QString exportHeader();
     void addColumn(QString& str, const QString& column);
-
-    QString m_error;
 };
 
 #endif // KEEPASSX_CSVEXPORTER_H
@@ -18,52 +18,55 @@
 #include "HtmlExporter.h"
 
 #include <QBuffer>
-#include <QFile>
+#include <QCryptographicHash>
 
 #include "core/Database.h"
+#include "core/DatabaseIcons.h"
 #include "core/Global.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 
 namespace
 {
-    QString PixmapToHTML(const QPixmap& pixmap)
+    QByteArray pixmapToPng(const QPixmap& pixmap)
     {
         if (pixmap.isNull()) {
-            return "";
+            return {};
         }
 
-        // Based on https://stackoverflow.com/a/6621278
-        QByteArray a;
-        QBuffer buffer(&a);
+        QByteArray png;
+        QBuffer buffer(&png);
         pixmap.save(&buffer, "PNG");
-        return QString("<img src=\"data:image/png;base64,") + a.toBase64() + "\"/>";
+        return png;
     }
-} // namespace
 
-bool HtmlExporter::exportDatabase(const QString& filename, const QSharedPointer<const Database>& db)
-{
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        m_error = file.errorString();
-        return false;
+    QString entryIconKey(const Entry& entry)
+    {
+        QString key = entry.iconUuid().isNull() ? QString::number(entry.iconNumber()) : entry.iconUuid().toString();
+        if (entry.isExpired()) {
+            key.append("-expired");
+        }
+        return key;
     }
-    return exportDatabase(&file, db);
-}
+} // namespace
 
-QString HtmlExporter::errorString() const
+bool HtmlExporter::includeGroup(const Group& group) const
 {
-    return m_error;
+    // Don't output the recycle bin
+    return &group != group.database()->metadata()->recycleBin();
 }
 
-bool HtmlExporter::exportDatabase(QIODevice* device, const QSharedPointer<const Database>& db)
+bool HtmlExporter::writeHeader(QIODevice* device, const Database& db)
 {
-    const auto meta = db->metadata();
+    m_iconClasses.clear();
+
+    const auto meta = db.metadata();
     if (!meta) {
         m_error = "Internal error: metadata is NULL";
         return false;
     }
 
+    const auto iconSize = QString::number(databaseIcons()->iconSize(IconSize::Medium));
     const auto header = QString("<html>"
                                 "<head>"
                                 "<meta charset=\"UTF-8\">"
@@ -85,6 +88,11 @@ bool HtmlExporter::exportDatabase(QIODevice* device, const QSharedPointer<const
                                   "{ font-size: larger; font-family: monospace; } "
                                   ".notes "
                                   "{ font-size: medium; } "
+                                  ".icon "
+                                  "{ display: inline-block; vertical-align: middle; width: "
+                                + iconSize + "px; height: " + iconSize
+                                + "px; background-size: contain; background-repeat: no-repeat; "
+                                  "-webkit-print-color-adjust: exact; print-color-adjust: exact; } "
                                   "</style>"
                                   "</head>\n"
                                   "<body>"
@@ -95,40 +103,50 @@ bool HtmlExporter::exportDatabase(QIODevice* device, const QSharedPointer<const
                                 + meta->description().toHtmlEscaped().replace("\n", "<br>")
                                 + "</p>"
                                   "<p><code>"
-                                + db->filePath().toHtmlEscaped() + "</code></p>");
-    const auto footer = QString("</body>"
-                                "</html>");
+                                + db.filePath().toHtmlEscaped() + "</code></p>");
 
-    if (device->write(header.toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
-    }
+    return write(device, header);
+}
 
-    if (db->rootGroup()) {
-        if (!writeGroup(*device, *db->rootGroup())) {
-            return false;
+bool HtmlExporter::writeFooter(QIODevice* device, const Database& db)
+{
+    Q_UNUSED(db);
+    return write(device, "</body></html>");
+}
+
+/**
+ * Append the markup for an icon. The image data of every distinct icon
+ * is only written once, as a CSS class placed right before its first use.
+ *
+ * @param html output the markup is appended to
+ * @param key identifies the icon among all icons of the export
+ * @param png image data, only needed for the first use of an icon
+ */
+void HtmlExporter::appendIcon(QString& html, const QString& key, const QByteArray& png)
+{
+    auto it = m_iconClasses.constFind(key);
+    if (it == m_iconClasses.constEnd()) {
+        QString iconClass;
+        if (!png.isEmpty()) {
+            iconClass = QString("icon%1").arg(m_iconClasses.size());
+            html.append("<style>." + iconClass + " { background-image: url(\"data:image/png;base64,");
+            html.append(QString::fromLatin1(png.toBase64()));
+            html.append("\"); }</style>");
         }
+        it = m_iconClasses.insert(key, iconClass);
     }
 
-    if (device->write(footer.toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
+    if (!it.value().isEmpty()) {
+        html.append("<span class=\"icon " + it.value() + "\"></span>");
     }
-
-    return true;
 }
 
-bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString path)
+bool HtmlExporter::writeGroup(QIODevice* device, const Group& group, const QStringList& path)
 {
-    // Don't output the recycle bin
-    if (&group == group.database()->metadata()->recycleBin()) {
-        return true;
-    }
-
-    if (!path.isEmpty()) {
-        path.append(" &rarr; ");
+    QStringList escapedPath;
+    for (const auto& name : path) {
+        escapedPath.append(name.toHtmlEscaped());
     }
-    path.append(group.name().toHtmlEscaped());
 
     // Output the header for this group (but only if there are
     // any notes or  entries in this group, otherwise we'd get
@@ -137,11 +155,13 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
     const auto notes = group.notes();
     if (!entries.empty() || !notes.isEmpty()) {
 
-        // Header line
+        // Header line. Group icons may carry badges, so they are told apart by content.
         auto header = QString("<hr><h2>");
-        header.append(PixmapToHTML(group.iconPixmap(IconSize::Medium)));
+        const auto png = pixmapToPng(group.iconPixmap(IconSize::Medium));
+        const auto key = "group-" + QString::fromLatin1(QCryptographicHash::hash(png, QCryptographicHash::Sha1).toHex());
+        appendIcon(header, key, png);
         header.append("&nbsp;");
-        header.append(path);
+        header.append(escapedPath.join(" &rarr; "));
         header.append("</h2>\n");
 
         // Group notes
@@ -152,8 +172,7 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
         }
 
         // Output it
-        if (device.write(header.toUtf8()) == -1) {
-            m_error = device.errorString();
+        if (!write(device, header)) {
             return false;
         }
     }
@@ -236,7 +255,14 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
         // Output it into our table. First the left side with
         // icon and entry title ...
         table += "<tr>";
-        table += "<td width=\"1%\">" + PixmapToHTML(entry->iconPixmap(IconSize::Medium)) + "</td>";
+        const auto iconKey = entryIconKey(*entry);
+        table += "<td width=\"1%\">";
+        QByteArray png;
+        if (!m_iconClasses.contains(iconKey)) {
+            png = pixmapToPng(entry->iconPixmap(IconSize::Medium));
+        }
+        appendIcon(table, iconKey, png);
+        table += "</td>";
         table += "<td width=\"19%\" valign=\"top\"><h3>" + entry->title().toHtmlEscaped() + "</h3></td>";
 
         // ... then the right side with the data fields
@@ -246,18 +272,5 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
 
     // Output the complete table of this group
     table.append("</table>\n");
-    if (device.write(table.toUtf8()) == -1) {
-        m_error = device.errorString();
-        return false;
-    }
-
-    // Recursively output the child groups
-    const auto& children = group.children();
-    for (const auto child : children) {
-        if (child && !writeGroup(device, *child, path)) {
-            return false;
-        }
-    }
-
-    return true;
+    return write(device, table);
 }
@@ -18,24 +18,22 @@
 #ifndef KEEPASSX_HTMLEXPORTER_H
 #define KEEPASSX_HTMLEXPORTER_H
 
-#include <QSharedPointer>
-#include <QString>
+#include "core/Exporter.h"
 
-class Database;
-class Group;
-class QIODevice;
+#include <QHash>
 
-class HtmlExporter
+class HtmlExporter : public Exporter
 {
-public:
-    bool exportDatabase(const QString& filename, const QSharedPointer<const Database>& db);
-    QString errorString() const;
+protected:
+    bool writeHeader(QIODevice* device, const Database& db) override;
+    bool writeGroup(QIODevice* device, const Group& group, const QStringList& path) override;
+    bool writeFooter(QIODevice* device, const Database& db) override;
+    bool includeGroup(const Group& group) const override;
 
 private:
-    bool exportDatabase(QIODevice* device, const QSharedPointer<const Database>& db);
-    bool writeGroup(QIODevice& device, const Group& group, QString path = QString());
+    void appendIcon(QString& html, const QString& key, const QByteArray& png);
 
-    QString m_error;
+    QHash<QString, QString> m_iconClasses;
 };
 
 #endif // KEEPASSX_HTMLEXPORTER_H
@@ -22,6 +22,7 @@
 #include "core/Endian.h"
 #include "core/Group.h"
 #include "crypto/CryptoHash.h"
+#include "format/KdbxProtectedValueSource.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/HashedBlockStream.h"
@@ -29,6 +30,7 @@
 #include "streams/SymmetricCipherStream.h"
 
 #include <QBuffer>
+#include <QtConcurrent>
 
 bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
                                    const QByteArray& headerData,
@@ -48,16 +50,28 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
         return false;
     }
 
-    bool ok = AsyncTask::runAndWaitForFuture([&] { return db->setKey(key, false); });
+    // The challenge only depends on the master seed, so the hardware key
+    // can be queried while the KDF is running
+    QByteArray challengeResponse;
+    QString challengeError;
+    bool challengeOk = false;
+    bool ok = AsyncTask::runAndWaitForFuture(AsyncTask::Executor::Kdf, [&] {
+        auto challenge = QtConcurrent::run(
+            [&] { return key->challenge(m_masterSeed, challengeResponse, &challengeError); });
+        bool keyOk = transformDatabaseKey(db, key, false);
+        challengeOk = challenge.result();
+        return keyOk;
+    });
     if (!ok) {
         raiseError(tr("Unable to calculate database key"));
         return false;
     }
 
-    if (!db->challengeMasterSeed(m_masterSeed)) {
-        raiseError(tr("Unable to issue challenge-response: %1").arg(db->keyError()));
+    if (!challengeOk) {
+        raiseError(tr("Unable to issue challenge-response: %1").arg(challengeError));
         return false;
     }
+    db->setChallengeResponse(m_masterSeed, challengeResponse);
 
     CryptoHash hash(CryptoHash::Sha256);
     hash.addData(m_masterSeed);
@@ -68,6 +82,7 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
     SymmetricCipher::Algorithm cipher = SymmetricCipher::cipherToAlgorithm(db->cipher());
     SymmetricCipherStream cipherStream(
         device, cipher, SymmetricCipher::algorithmMode(cipher), SymmetricCipher::Decrypt);
+    cipherStream.setBatchSize(SymmetricCipherStream::DefaultBatchSize);
     if (!cipherStream.init(finalKey, m_encryptionIV)) {
         raiseError(cipherStream.errorString());
         return false;
@@ -86,6 +101,7 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
     }
 
     HashedBlockStream hashedStream(&cipherStream);
+    hashedStream.setConcurrentBlocks(HashedBlockStream::defaultConcurrentBlocks());
     if (!hashedStream.open(QIODevice::ReadOnly)) {
         raiseError(hashedStream.errorString());
         return false;
@@ -115,6 +131,11 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
     Q_ASSERT(xmlDevice);
 
     KdbxXmlReader xmlReader(KeePass2::FILE_VERSION_3_1);
+    xmlReader.setMetadataOnly(m_metadataOnly);
+    if (m_deferredProtectedValues) {
+        xmlReader.setProtectedValueSource(QSharedPointer<KdbxProtectedValueSource>::create(
+            KeePass2::ProtectedStreamAlgo::Salsa20, m_protectedStreamKey));
+    }
     xmlReader.readDatabase(xmlDevice, db, &randomStream);
 
     if (xmlReader.hasError()) {
@@ -27,6 +27,7 @@
 #include "format/KeePass2.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/HashedBlockStream.h"
+#include "streams/ParallelGzipStream.h"
 #include "streams/QtIOCompressor"
 #include "streams/SymmetricCipherStream.h"
 
@@ -97,6 +98,7 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
     // write cipher stream
     SymmetricCipher::Algorithm algo = SymmetricCipher::cipherToAlgorithm(db->cipher());
     SymmetricCipherStream cipherStream(device, algo, SymmetricCipher::algorithmMode(algo), SymmetricCipher::Encrypt);
+    cipherStream.setBatchSize(SymmetricCipherStream::DefaultBatchSize);
     cipherStream.init(finalKey, encryptionIV);
     if (!cipherStream.open(QIODevice::WriteOnly)) {
         raiseError(cipherStream.errorString());
@@ -105,6 +107,7 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
     CHECK_RETURN_FALSE(writeData(&cipherStream, startBytes));
 
     HashedBlockStream hashedStream(&cipherStream);
+    hashedStream.setConcurrentBlocks(HashedBlockStream::defaultConcurrentBlocks());
     if (!hashedStream.open(QIODevice::WriteOnly)) {
         raiseError(hashedStream.errorString());
         return false;
@@ -112,11 +115,19 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
 
     QIODevice* outputDevice = nullptr;
     QScopedPointer<QtIOCompressor> ioCompressor;
+    QScopedPointer<ParallelGzipStream> parallelCompressor;
 
     if (db->compressionAlgorithm() == Database::CompressionNone) {
         outputDevice = &hashedStream;
+    } else if (m_parallelCompression) {
+        parallelCompressor.reset(new ParallelGzipStream(&hashedStream, m_compressionLevel));
+        if (!parallelCompressor->open(QIODevice::WriteOnly)) {
+            raiseError(parallelCompressor->errorString());
+            return false;
+        }
+        outputDevice = parallelCompressor.data();
     } else {
-        ioCompressor.reset(new QtIOCompressor(&hashedStream));
+        ioCompressor.reset(new QtIOCompressor(&hashedStream, m_compressionLevel));
         ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
         if (!ioCompressor->open(QIODevice::WriteOnly)) {
             raiseError(ioCompressor->errorString());
@@ -134,6 +145,7 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
     }
 
     KdbxXmlWriter xmlWriter(formatVersion());
+    xmlWriter.setFragmentCache(m_fragmentCache);
     xmlWriter.writeDatabase(outputDevice, db, &randomStream, headerHash);
 
     // Explicitly close/reset streams so they are flushed and we can detect
@@ -141,6 +153,10 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
     if (ioCompressor) {
         ioCompressor->close();
     }
+    if (parallelCompressor && !parallelCompressor->finish()) {
+        raiseError(parallelCompressor->errorString());
+        return false;
+    }
     if (!hashedStream.reset()) {
         raiseError(hashedStream.errorString());
         return false;
@@ -0,0 +1,202 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Kdbx4AttachmentSource.h"
+
+#include "core/Tools.h"
+#include "streams/HmacBlockStream.h"
+#include "streams/QtIOCompressor"
+#include "streams/SymmetricCipherStream.h"
+
+#include <QMutexLocker>
+
+/**
+ * Decrypting streams over the payload and the payload offset they are at.
+ */
+struct Kdbx4AttachmentSource::Cursor
+{
+    QFile file;
+    QScopedPointer<HmacBlockStream> hmacStream;
+    QScopedPointer<SymmetricCipherStream> cipherStream;
+    QScopedPointer<QtIOCompressor> ioCompressor;
+    QIODevice* payload = nullptr;
+    qint64 position = 0;
+};
+
+/**
+ * @param filePath database file
+ * @param payloadOffset file offset of the first HMAC block
+ * @param hmacKey HMAC key of the payload blocks
+ * @param cipher payload cipher
+ * @param finalKey payload encryption key
+ * @param encryptionIV payload encryption IV
+ * @param compressed true if the payload is GZip compressed
+ */
+Kdbx4AttachmentSource::Kdbx4AttachmentSource(const QString& filePath,
+                                             qint64 payloadOffset,
+                                             const QByteArray& hmacKey,
+                                             SymmetricCipher::Algorithm cipher,
+                                             const QByteArray& finalKey,
+                                             const QByteArray& encryptionIV,
+                                             bool compressed)
+    : m_filePath(filePath)
+    , m_payloadOffset(payloadOffset)
+    , m_hmacKey(hmacKey)
+    , m_cipher(cipher)
+    , m_finalKey(finalKey)
+    , m_encryptionIV(encryptionIV)
+    , m_compressed(compressed)
+{
+}
+
+Kdbx4AttachmentSource::~Kdbx4AttachmentSource() = default;
+
+/**
+ * Open the database file for later reads. Except on Windows, the file
+ * is kept open so attachments remain readable after the database has
+ * been saved over the original file. Windows doesn't allow replacing
+ * an open file, there it is opened for each read instead.
+ *
+ * @return true if the file could be opened
+ */
+bool Kdbx4AttachmentSource::open()
+{
+#ifdef Q_OS_WIN
+    return QFile::exists(m_filePath);
+#else
+    m_file.reset(new QFile(m_filePath));
+    return m_file->open(QIODevice::ReadOnly);
+#endif
+}
+
+/**
+ * Register the next binary of the inner header.
+ *
+ * @param offset offset of the binary data in the decrypted payload
+ * @param size size of the binary data
+ */
+void Kdbx4AttachmentSource::addBinary(qint64 offset, int size)
+{
+    m_binaries.append({offset, size});
+    m_binariesEnd = qMax(m_binariesEnd, offset + size);
+}
+
+int Kdbx4AttachmentSource::count() const
+{
+    return m_binaries.size();
+}
+
+int Kdbx4AttachmentSource::size(int index) const
+{
+    return m_binaries.value(index, {0, 0}).size;
+}
+
+QByteArray Kdbx4AttachmentSource::read(int index) const
+{
+    if (index < 0 || index >= m_binaries.size()) {
+        return {};
+    }
+    const Binary& binary = m_binaries.at(index);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_cursor && m_cursor->position > binary.offset) {
+        m_cursor.reset();
+    }
+    if (!m_cursor && !openCursor()) {
+        return {};
+    }
+
+    QByteArray data;
+    if (Tools::skipFromDevice(m_cursor->payload, binary.offset - m_cursor->position)) {
+        data = m_cursor->payload->read(binary.size);
+    }
+    if (data.size() != binary.size) {
+        // the file has been modified or truncated since it was opened
+        qWarning("Kdbx4AttachmentSource::read: Unable to read attachment %d: %s",
+                 index,
+                 qPrintable(m_cursor->payload->errorString()));
+        m_cursor.reset();
+        return {};
+    }
+    m_cursor->position = binary.offset + binary.size;
+
+#ifdef Q_OS_WIN
+    // an open file can't be replaced by a save
+    m_cursor.reset();
+#else
+    // don't keep the stream buffers once all binaries have been read
+    if (m_cursor->position >= m_binariesEnd) {
+        m_cursor.reset();
+    }
+#endif
+
+    return data;
+}
+
+/**
+ * Open the payload streams at the start of the payload.
+ *
+ * @return true if the payload can be read
+ */
+bool Kdbx4AttachmentSource::openCursor() const
+{
+    QScopedPointer<Cursor> cursor(new Cursor());
+
+    QIODevice* device = m_file.data();
+    if (!device) {
+        cursor->file.setFileName(m_filePath);
+        if (!cursor->file.open(QIODevice::ReadOnly)) {
+            qWarning("Kdbx4AttachmentSource::read: %s", qPrintable(cursor->file.errorString()));
+            return false;
+        }
+        device = &cursor->file;
+    }
+    if (!device->seek(m_payloadOffset)) {
+        qWarning("Kdbx4AttachmentSource::read: Unable to seek to the payload.");
+        return false;
+    }
+
+    cursor->hmacStream.reset(new HmacBlockStream(device, m_hmacKey));
+    if (!cursor->hmacStream->open(QIODevice::ReadOnly)) {
+        qWarning("Kdbx4AttachmentSource::read: %s", qPrintable(cursor->hmacStream->errorString()));
+        return false;
+    }
+
+    cursor->cipherStream.reset(new SymmetricCipherStream(
+        cursor->hmacStream.data(), m_cipher, SymmetricCipher::algorithmMode(m_cipher), SymmetricCipher::Decrypt));
+    cursor->cipherStream->setBatchSize(SymmetricCipherStream::DefaultBatchSize);
+    if (!cursor->cipherStream->init(m_finalKey, m_encryptionIV)
+        || !cursor->cipherStream->open(QIODevice::ReadOnly)) {
+        qWarning("Kdbx4AttachmentSource::read: %s", qPrintable(cursor->cipherStream->errorString()));
+        return false;
+    }
+
+    cursor->payload = cursor->cipherStream.data();
+    if (m_compressed) {
+        cursor->ioCompressor.reset(new QtIOCompressor(cursor->cipherStream.data()));
+        cursor->ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
+        if (!cursor->ioCompressor->open(QIODevice::ReadOnly)) {
+            qWarning("Kdbx4AttachmentSource::read: %s", qPrintable(cursor->ioCompressor->errorString()));
+            return false;
+        }
+        cursor->payload = cursor->ioCompressor.data();
+    }
+
+    m_cursor.reset(cursor.take());
+    return true;
+}
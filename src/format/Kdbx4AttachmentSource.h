@@ -0,0 +1,83 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_KDBX4ATTACHMENTSOURCE_H
+#define KEEPASSXC_KDBX4ATTACHMENTSOURCE_H
+
+#include "core/AttachmentSource.h"
+#include "crypto/SymmetricCipher.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QScopedPointer>
+#include <QVector>
+
+/**
+ * Attachment source reading inner header binaries from a KDBX4 file.
+ *
+ * Only the position of each binary within the decrypted payload is
+ * kept. The payload streams can't be positioned, so the source keeps
+ * decrypting from the end of the previous read. Attachments read in
+ * file order, like the ones written by a save, decrypt the payload only
+ * once; reading an earlier binary starts over from the beginning.
+ */
+class Kdbx4AttachmentSource : public AttachmentSource
+{
+public:
+    Kdbx4AttachmentSource(const QString& filePath,
+                          qint64 payloadOffset,
+                          const QByteArray& hmacKey,
+                          SymmetricCipher::Algorithm cipher,
+                          const QByteArray& finalKey,
+                          const QByteArray& encryptionIV,
+                          bool compressed);
+    ~Kdbx4AttachmentSource() override;
+
+    bool open();
+    void addBinary(qint64 offset, int size);
+
+    int count() const override;
+    int size(int index) const override;
+    QByteArray read(int index) const override;
+
+private:
+    struct Binary
+    {
+        qint64 offset;
+        int size;
+    };
+
+    struct Cursor;
+
+    bool openCursor() const;
+
+    const QString m_filePath;
+    const qint64 m_payloadOffset;
+    const QByteArray m_hmacKey;
+    const SymmetricCipher::Algorithm m_cipher;
+    const QByteArray m_finalKey;
+    const QByteArray m_encryptionIV;
+    const bool m_compressed;
+    QVector<Binary> m_binaries;
+    qint64 m_binariesEnd = 0;
+
+    mutable QMutex m_mutex;
+    QScopedPointer<QFile> m_file;
+    mutable QScopedPointer<Cursor> m_cursor;
+};
+
+#endif // KEEPASSXC_KDBX4ATTACHMENTSOURCE_H
@@ -18,17 +18,32 @@
 #include "Kdbx4Reader.h"
 
 #include <QBuffer>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
 
 #include "core/AsyncTask.h"
 #include "core/Endian.h"
 #include "core/Group.h"
+#include "core/Tools.h"
 #include "crypto/CryptoHash.h"
+#include "format/Kdbx4AttachmentSource.h"
+#include "format/KdbxProtectedValueSource.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KeePass2RandomStream.h"
+#include "streams/BlockQueueStream.h"
 #include "streams/HmacBlockStream.h"
+#include "streams/MappedFileDevice.h"
 #include "streams/QtIOCompressor"
 #include "streams/SymmetricCipherStream.h"
 
+namespace
+{
+    // Granularity and depth of the queues between the pipelined read stages
+    const qint64 PIPELINE_CHUNK_SIZE = 64 * 1024;
+    const int PIPELINE_QUEUE_BLOCKS = 16;
+} // namespace
+
 bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
                                    const QByteArray& headerData,
                                    QSharedPointer<const CompositeKey> key,
@@ -37,6 +52,8 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
     Q_ASSERT(m_kdbxVersion == KeePass2::FILE_VERSION_4);
 
     m_binaryPool.clear();
+    m_attachmentSource.reset();
+    m_innerHeaderSize = 0;
 
     if (hasError()) {
         return false;
@@ -48,7 +65,7 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
         return false;
     }
 
-    bool ok = AsyncTask::runAndWaitForFuture([&] { return db->setKey(key, false, false); });
+    bool ok = AsyncTask::runAndWaitForFuture(AsyncTask::Executor::Kdf, [&] { return transformDatabaseKey(db, key, false); });
     if (!ok) {
         raiseError(tr("Unable to calculate database key: %1").arg(db->keyError()));
         return false;
@@ -77,18 +94,39 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
                       "If this reoccurs, then your database file may be corrupt.") + " " + tr("(HMAC mismatch)"));
         return false;
     }
-    HmacBlockStream hmacStream(device, hmacKey);
-    if (!hmacStream.open(QIODevice::ReadOnly)) {
-        raiseError(hmacStream.errorString());
-        return false;
-    }
+    // clang-format on
 
     SymmetricCipher::Algorithm cipher = SymmetricCipher::cipherToAlgorithm(db->cipher());
     if (cipher == SymmetricCipher::InvalidAlgorithm) {
         raiseError(tr("Unknown cipher"));
         return false;
     }
+
+    QString fileName = deviceFileName(device);
+    // Reading attachments on demand is also the cheapest way to skip them
+    if ((isDeferredAttachments() || isMetadataOnly()) && !fileName.isEmpty()) {
+        m_attachmentSource.reset(new Kdbx4AttachmentSource(fileName,
+                                                           device->pos(),
+                                                           hmacKey,
+                                                           cipher,
+                                                           finalKey,
+                                                           m_encryptionIV,
+                                                           db->compressionAlgorithm() != Database::CompressionNone));
+        if (!m_attachmentSource->open()) {
+            m_attachmentSource.reset();
+        }
+    }
+
+    // clang-format off
+    HmacBlockStream hmacStream(device, hmacKey);
+    hmacStream.setConcurrentBlocks(HmacBlockStream::defaultConcurrentBlocks());
+    if (!hmacStream.open(QIODevice::ReadOnly)) {
+        raiseError(hmacStream.errorString());
+        return false;
+    }
+
     SymmetricCipherStream cipherStream(&hmacStream, cipher, SymmetricCipher::algorithmMode(cipher), SymmetricCipher::Decrypt);
+    cipherStream.setBatchSize(SymmetricCipherStream::DefaultBatchSize);
     if (!cipherStream.init(finalKey, m_encryptionIV)) {
         raiseError(cipherStream.errorString());
         return false;
@@ -99,6 +137,10 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
     }
     // clang-format on
 
+    if (isPipelinedRead() && QThread::idealThreadCount() > 1) {
+        return readPayloadPipelined(&cipherStream, db);
+    }
+
     QIODevice* xmlDevice = nullptr;
     QScopedPointer<QtIOCompressor> ioCompressor;
 
@@ -114,7 +156,22 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
         xmlDevice = ioCompressor.data();
     }
 
-    while (readInnerHeaderField(xmlDevice) && !hasError()) {
+    return readPayload(xmlDevice, db);
+}
+
+/**
+ * Read the inner header and the XML document from the decrypted
+ * and decompressed payload stream.
+ *
+ * @param device plaintext payload device
+ * @param db database to read into
+ * @return true on success
+ */
+bool Kdbx4Reader::readPayload(QIODevice* device, Database* db)
+{
+    Q_ASSERT(device);
+
+    while (readInnerHeaderField(device) && !hasError()) {
     }
 
     if (hasError()) {
@@ -127,10 +184,16 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
         return false;
     }
 
-    Q_ASSERT(xmlDevice);
-
     KdbxXmlReader xmlReader(KeePass2::FILE_VERSION_4, binaryPool());
-    xmlReader.readDatabase(xmlDevice, db, &randomStream);
+    xmlReader.setMetadataOnly(m_metadataOnly);
+    if (m_attachmentSource) {
+        xmlReader.setAttachmentSource(m_attachmentSource);
+    }
+    if (m_deferredProtectedValues) {
+        xmlReader.setProtectedValueSource(
+            QSharedPointer<KdbxProtectedValueSource>::create(m_irsAlgo, m_protectedStreamKey));
+    }
+    xmlReader.readDatabase(device, db, &randomStream);
 
     if (xmlReader.hasError()) {
         raiseError(xmlReader.errorString());
@@ -140,6 +203,65 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
     return true;
 }
 
+/**
+ * Read the payload with HMAC verification and decryption, decompression
+ * and XML parsing running concurrently. The first two stages run on
+ * dedicated worker threads and hand their output to the next stage
+ * through bounded block queues, parsing happens on the calling thread.
+ *
+ * @param cipherStream opened decrypting payload stream
+ * @param db database to read into
+ * @return true on success
+ */
+bool Kdbx4Reader::readPayloadPipelined(QIODevice* cipherStream, Database* db)
+{
+    BlockQueueStream decryptedQueue(PIPELINE_QUEUE_BLOCKS);
+    BlockQueueStream inflatedQueue(PIPELINE_QUEUE_BLOCKS);
+    decryptedQueue.open(QIODevice::ReadOnly);
+    inflatedQueue.open(QIODevice::ReadOnly);
+
+    // Use a private pool, stages must never wait for a free global worker
+    QThreadPool pipelinePool;
+    pipelinePool.setMaxThreadCount(2);
+
+    QtConcurrent::run(&pipelinePool, [&] { decryptedQueue.pump(cipherStream, PIPELINE_CHUNK_SIZE); });
+
+    BlockQueueStream* xmlQueue = &decryptedQueue;
+    if (db->compressionAlgorithm() != Database::CompressionNone) {
+        xmlQueue = &inflatedQueue;
+        QtConcurrent::run(&pipelinePool, [&] {
+            QtIOCompressor ioCompressor(&decryptedQueue);
+            ioCompressor.setStreamFormat(QtIOCompressor::GzipFormat);
+            if (!ioCompressor.open(QIODevice::ReadOnly)) {
+                inflatedQueue.fail(ioCompressor.errorString());
+            } else {
+                inflatedQueue.pump(&ioCompressor, PIPELINE_CHUNK_SIZE);
+            }
+            // stop the decryption stage if inflating ended early
+            decryptedQueue.cancel();
+        });
+    }
+
+    bool ok = readPayload(xmlQueue, db);
+
+    inflatedQueue.cancel();
+    decryptedQueue.cancel();
+    pipelinePool.waitForDone();
+
+    if (!ok) {
+        // report the root cause if one of the stages failed
+        for (const BlockQueueStream* queue : {&decryptedQueue, &inflatedQueue}) {
+            QString stageError = queue->producerError();
+            if (!stageError.isEmpty()) {
+                raiseError(stageError);
+                break;
+            }
+        }
+    }
+
+    return ok;
+}
+
 bool Kdbx4Reader::readHeaderField(StoreDataStream& device, Database* db)
 {
     QByteArray fieldIDArray = device.read(1);
@@ -248,8 +370,26 @@ bool Kdbx4Reader::readInnerHeaderField(QIODevice* device)
         return false;
     }
 
+    // offset of the field data within the decrypted payload
+    const qint64 fieldOffset = m_innerHeaderSize + 5;
+    m_innerHeaderSize = fieldOffset + fieldLen;
+
     QByteArray fieldData;
-    if (fieldLen != 0) {
+    if (m_attachmentSource && fieldID == KeePass2::InnerHeaderFieldID::Binary && fieldLen > 0) {
+        // only read the flags byte, the data is fetched again when accessed
+        fieldData = device->read(1);
+        if (fieldData.size() != 1 || !Tools::skipFromDevice(device, fieldLen - 1)) {
+            raiseError(tr("Invalid header data length"));
+            return false;
+        }
+    } else if (m_metadataOnly && fieldID == KeePass2::InnerHeaderFieldID::Binary && fieldLen > 0) {
+        // the attachment is not needed at all
+        if (!Tools::skipFromDevice(device, fieldLen)) {
+            raiseError(tr("Invalid header data length"));
+            return false;
+        }
+        return true;
+    } else if (fieldLen != 0) {
         fieldData = device->read(fieldLen);
         if (static_cast<quint32>(fieldData.size()) != fieldLen) {
             raiseError(tr("Invalid header data length"));
@@ -274,6 +414,10 @@ bool Kdbx4Reader::readInnerHeaderField(QIODevice* device)
             raiseError(tr("Invalid inner header binary size"));
             return false;
         }
+        if (m_attachmentSource) {
+            m_attachmentSource->addBinary(fieldOffset + 1, static_cast<int>(fieldLen - 1));
+            break;
+        }
         auto data = fieldData.mid(1);
         m_binaryPool.insert(QString::number(m_binaryPool.size()), data);
         break;
@@ -283,6 +427,21 @@ bool Kdbx4Reader::readInnerHeaderField(QIODevice* device)
     return true;
 }
 
+/**
+ * @param device input device
+ * @return name of the file the device reads from or an empty string
+ */
+QString Kdbx4Reader::deviceFileName(QIODevice* device)
+{
+    if (auto mappedFile = qobject_cast<MappedFileDevice*>(device)) {
+        return mappedFile->fileName();
+    }
+    if (auto file = qobject_cast<QFile*>(device)) {
+        return file->fileName();
+    }
+    return {};
+}
+
 /**
  * Helper method for reading a serialized variant map.
  *
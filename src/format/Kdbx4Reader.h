@@ -20,8 +20,12 @@
 
 #include "format/KdbxReader.h"
 
+#include <QSharedPointer>
+
 #include <QVariantMap>
 
+class Kdbx4AttachmentSource;
+
 /**
  * KDBX4 reader implementation.
  */
@@ -40,10 +44,15 @@ protected:
     bool readHeaderField(StoreDataStream& headerStream, Database* db) override;
 
 private:
+    bool readPayload(QIODevice* device, Database* db);
+    bool readPayloadPipelined(QIODevice* cipherStream, Database* db);
     bool readInnerHeaderField(QIODevice* device);
     QVariantMap readVariantMap(QIODevice* device);
+    static QString deviceFileName(QIODevice* device);
 
     QHash<QString, QByteArray> m_binaryPool;
+    QSharedPointer<Kdbx4AttachmentSource> m_attachmentSource;
+    qint64 m_innerHeaderSize = 0;
 };
 
 #endif // KEEPASSX_KDBX4READER_H
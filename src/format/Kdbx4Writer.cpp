@@ -20,6 +20,7 @@
 #include <QBuffer>
 #include <QFile>
 
+#include "core/AttachmentSource.h"
 #include "core/CustomData.h"
 #include "core/Database.h"
 #include "core/Metadata.h"
@@ -28,6 +29,7 @@
 #include "format/KdbxXmlWriter.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/HmacBlockStream.h"
+#include "streams/ParallelGzipStream.h"
 #include "streams/QtIOCompressor"
 #include "streams/SymmetricCipherStream.h"
 
@@ -119,6 +121,7 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
     QScopedPointer<SymmetricCipherStream> cipherStream;
 
     hmacBlockStream.reset(new HmacBlockStream(device, hmacKey));
+    hmacBlockStream->setConcurrentBlocks(HmacBlockStream::defaultConcurrentBlocks());
     if (!hmacBlockStream->open(QIODevice::WriteOnly)) {
         raiseError(hmacBlockStream->errorString());
         return false;
@@ -126,6 +129,7 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
 
     cipherStream.reset(new SymmetricCipherStream(
         hmacBlockStream.data(), algo, SymmetricCipher::algorithmMode(algo), SymmetricCipher::Encrypt));
+    cipherStream->setBatchSize(SymmetricCipherStream::DefaultBatchSize);
 
     if (!cipherStream->init(finalKey, encryptionIV)) {
         raiseError(cipherStream->errorString());
@@ -138,11 +142,19 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
 
     QIODevice* outputDevice = nullptr;
     QScopedPointer<QtIOCompressor> ioCompressor;
+    QScopedPointer<ParallelGzipStream> parallelCompressor;
 
     if (db->compressionAlgorithm() == Database::CompressionNone) {
         outputDevice = cipherStream.data();
+    } else if (m_parallelCompression) {
+        parallelCompressor.reset(new ParallelGzipStream(cipherStream.data(), m_compressionLevel));
+        if (!parallelCompressor->open(QIODevice::WriteOnly)) {
+            raiseError(parallelCompressor->errorString());
+            return false;
+        }
+        outputDevice = parallelCompressor.data();
     } else {
-        ioCompressor.reset(new QtIOCompressor(cipherStream.data()));
+        ioCompressor.reset(new QtIOCompressor(cipherStream.data(), m_compressionLevel));
         ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
         if (!ioCompressor->open(QIODevice::WriteOnly)) {
             raiseError(ioCompressor->errorString());
@@ -161,7 +173,7 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
         writeInnerHeaderField(outputDevice, KeePass2::InnerHeaderFieldID::InnerRandomStreamKey, protectedStreamKey));
 
     // Write attachments to the inner header
-    writeAttachments(outputDevice, db);
+    CHECK_RETURN_FALSE(writeAttachments(outputDevice, db));
 
     CHECK_RETURN_FALSE(writeInnerHeaderField(outputDevice, KeePass2::InnerHeaderFieldID::End, QByteArray()));
 
@@ -172,6 +184,7 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
     }
 
     KdbxXmlWriter xmlWriter(formatVersion());
+    xmlWriter.setFragmentCache(m_fragmentCache);
     xmlWriter.writeDatabase(outputDevice, db, &randomStream, headerHash);
 
     // Explicitly close/reset streams so they are flushed and we can detect
@@ -179,6 +192,10 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
     if (ioCompressor) {
         ioCompressor->close();
     }
+    if (parallelCompressor && !parallelCompressor->finish()) {
+        raiseError(parallelCompressor->errorString());
+        return false;
+    }
     if (!cipherStream->reset()) {
         raiseError(cipherStream->errorString());
         return false;
@@ -206,35 +223,62 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
  */
 bool Kdbx4Writer::writeInnerHeaderField(QIODevice* device, KeePass2::InnerHeaderFieldID fieldId, const QByteArray& data)
 {
-    QByteArray fieldIdArr;
-    fieldIdArr[0] = static_cast<char>(fieldId);
-    CHECK_RETURN_FALSE(writeData(device, fieldIdArr));
-    CHECK_RETURN_FALSE(
-        writeData(device, Endian::sizedIntToBytes(static_cast<quint32>(data.size()), KeePass2::BYTEORDER)));
-    CHECK_RETURN_FALSE(writeData(device, data));
-
-    return true;
+    return writeInnerHeaderField(device, fieldId, {data});
 }
 
-void Kdbx4Writer::writeAttachments(QIODevice* device, Database* db)
+/**
+ * Write KDBX4 inner header field whose payload is the concatenation of the given parts.
+ *
+ * The parts are written one after the other instead of being joined first,
+ * so large payloads like attachments are never copied.
+ *
+ * @param device output device
+ * @param fieldId field identifier
+ * @param parts field payload
+ * @return true on success
+ */
+bool Kdbx4Writer::writeInnerHeaderField(QIODevice* device,
+                                        KeePass2::InnerHeaderFieldID fieldId,
+                                        std::initializer_list<QByteArray> parts)
 {
-    const QList<Entry*> allEntries = db->rootGroup()->entriesRecursive(true);
-    QSet<QByteArray> writtenAttachments;
+    quint32 size = 0;
+    for (const QByteArray& part : parts) {
+        size += static_cast<quint32>(part.size());
+    }
 
-    for (Entry* entry : allEntries) {
-        const QList<QString> attachmentKeys = entry->attachments()->keys();
-        for (const QString& key : attachmentKeys) {
-            QByteArray data("\x01");
-            data.append(entry->attachments()->value(key));
+    QByteArray header;
+    header.reserve(1 + sizeof(quint32));
+    header.append(static_cast<char>(fieldId));
+    header.append(Endian::sizedIntToBytes(size, KeePass2::BYTEORDER));
+    CHECK_RETURN_FALSE(writeData(device, header));
+
+    for (const QByteArray& part : parts) {
+        if (!part.isEmpty()) {
+            CHECK_RETURN_FALSE(writeData(device, part));
+        }
+    }
 
-            if (writtenAttachments.contains(data)) {
-                continue;
-            }
+    return true;
+}
 
-            writeInnerHeaderField(device, KeePass2::InnerHeaderFieldID::Binary, data);
-            writtenAttachments.insert(data);
+bool Kdbx4Writer::writeAttachments(QIODevice* device, Database* db)
+{
+    // the flags byte in front of the contents, 0x01 = protected
+    static const QByteArray protectedFlag(1, '\x01');
+
+    // the pool is in binary id order, the same the XML writer uses for references,
+    // deferred attachments are read one at a time
+    const QList<AttachmentValue> pool = db->attachmentPool();
+    for (const AttachmentValue& value : pool) {
+        const QByteArray data = value.read();
+        if (value.isDeferred() && data.size() != value.size()) {
+            raiseError(tr("Unable to read attachment data from the database file."));
+            return false;
         }
+        CHECK_RETURN_FALSE(writeInnerHeaderField(device, KeePass2::InnerHeaderFieldID::Binary, {protectedFlag, data}));
     }
+
+    return true;
 }
 
 /**
@@ -33,7 +33,10 @@ public:
 
 private:
     bool writeInnerHeaderField(QIODevice* device, KeePass2::InnerHeaderFieldID fieldId, const QByteArray& data);
-    void writeAttachments(QIODevice* device, Database* db);
+    bool writeInnerHeaderField(QIODevice* device,
+                               KeePass2::InnerHeaderFieldID fieldId,
+                               std::initializer_list<QByteArray> parts);
+    bool writeAttachments(QIODevice* device, Database* db);
     static bool serializeVariantMap(const QVariantMap& map, QByteArray& outputBytes);
 };
 
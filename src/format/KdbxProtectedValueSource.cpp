@@ -0,0 +1,82 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KdbxProtectedValueSource.h"
+
+#include "format/KeePass2RandomStream.h"
+
+#include <QMutexLocker>
+
+KdbxProtectedValueSource::KdbxProtectedValueSource(KeePass2::ProtectedStreamAlgo algo, const QByteArray& key)
+    : m_algo(algo)
+    , m_key(key)
+{
+}
+
+KdbxProtectedValueSource::~KdbxProtectedValueSource() = default;
+
+/**
+ * Decrypt a protected value.
+ *
+ * @param ciphertext encrypted value
+ * @param offset position of the value in the inner random stream
+ * @return plaintext or a null byte array on error
+ */
+QByteArray KdbxProtectedValueSource::decrypt(const QByteArray& ciphertext, quint64 offset) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!seek(offset)) {
+        return {};
+    }
+
+    QByteArray plaintext = ciphertext;
+    if (!m_stream->processInPlace(plaintext)) {
+        qWarning("KdbxProtectedValueSource::decrypt: %s", qPrintable(m_stream->errorString()));
+        m_stream.reset();
+        return {};
+    }
+    m_position += static_cast<quint64>(ciphertext.size());
+
+    return plaintext;
+}
+
+/**
+ * Move the keystream generator to the given offset.
+ * The mutex must be locked by the caller.
+ */
+bool KdbxProtectedValueSource::seek(quint64 offset) const
+{
+    if (!m_stream || offset < m_position) {
+        m_stream.reset(new KeePass2RandomStream(m_algo));
+        m_position = 0;
+        if (!m_stream->init(m_key)) {
+            qWarning("KdbxProtectedValueSource::seek: %s", qPrintable(m_stream->errorString()));
+            m_stream.reset();
+            return false;
+        }
+    }
+
+    if (!m_stream->skip(offset - m_position)) {
+        qWarning("KdbxProtectedValueSource::seek: %s", qPrintable(m_stream->errorString()));
+        m_stream.reset();
+        return false;
+    }
+    m_position = offset;
+
+    return true;
+}
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_KDBXPROTECTEDVALUESOURCE_H
+#define KEEPASSXC_KDBXPROTECTEDVALUESOURCE_H
+
+#include "core/ProtectedValueSource.h"
+#include "format/KeePass2.h"
+
+#include <QMutex>
+#include <QScopedPointer>
+
+class KeePass2RandomStream;
+
+/**
+ * Protected value source backed by the KDBX inner random stream.
+ *
+ * The stream key is retained so the keystream can be regenerated. The
+ * generator only moves forward; decrypting a value before the current
+ * position restarts it from the beginning of the stream.
+ */
+class KdbxProtectedValueSource : public ProtectedValueSource
+{
+public:
+    KdbxProtectedValueSource(KeePass2::ProtectedStreamAlgo algo, const QByteArray& key);
+    ~KdbxProtectedValueSource() override;
+
+    QByteArray decrypt(const QByteArray& ciphertext, quint64 offset) const override;
+
+private:
+    bool seek(quint64 offset) const;
+
+    const KeePass2::ProtectedStreamAlgo m_algo;
+    const QByteArray m_key;
+
+    mutable QMutex m_mutex;
+    mutable QScopedPointer<KeePass2RandomStream> m_stream;
+    mutable quint64 m_position = 0;
+};
+
+#endif // KEEPASSXC_KDBXPROTECTEDVALUESOURCE_H
@@ -62,6 +62,49 @@ bool KdbxReader::readMagicNumbers(QIODevice* device, quint32& sig1, quint32& sig
  * @return true on success
  */
 bool KdbxReader::readDatabase(QIODevice* device, QSharedPointer<const CompositeKey> key, Database* db)
+{
+    QByteArray headerData;
+    if (!readHeaderFields(device, db, &headerData)) {
+        return false;
+    }
+
+    // read payload
+    return readDatabaseImpl(device, headerData, std::move(key), db);
+}
+
+/**
+ * Read only the outer header of a KDBX stream. No key is needed and
+ * nothing past the end of the header is read.
+ * The device will automatically be reset to 0 before reading.
+ *
+ * @param device input device
+ * @param header header fields read from the device
+ * @return true on success
+ */
+bool KdbxReader::readHeader(QIODevice* device, KdbxHeaderInfo& header)
+{
+    Database db;
+    if (!readHeaderFields(device, &db, nullptr)) {
+        return false;
+    }
+
+    header.version = m_kdbxFullVersion;
+    header.cipher = db.cipher();
+    header.compressionAlgorithm = db.compressionAlgorithm();
+    header.kdf = db.kdf();
+    header.publicCustomData = db.publicCustomData();
+    return true;
+}
+
+/**
+ * Read the magic numbers and header fields into the given database.
+ *
+ * @param device input device
+ * @param db database to read the header into
+ * @param headerData raw header bytes if not nullptr
+ * @return true on success
+ */
+bool KdbxReader::readHeaderFields(QIODevice* device, Database* db, QByteArray* headerData)
 {
     device->seek(0);
 
@@ -80,6 +123,7 @@ bool KdbxReader::readDatabase(QIODevice* device, QSharedPointer<const CompositeK
         return false;
     }
     m_kdbxSignature = qMakePair(sig1, sig2);
+    m_kdbxFullVersion = m_kdbxVersion;
 
     // mask out minor version
     m_kdbxVersion &= KeePass2::FILE_VERSION_CRITICAL_MASK;
@@ -94,8 +138,10 @@ bool KdbxReader::readDatabase(QIODevice* device, QSharedPointer<const CompositeK
         return false;
     }
 
-    // read payload
-    return readDatabaseImpl(device, headerStream.storedData(), std::move(key), db);
+    if (headerData) {
+        *headerData = headerStream.storedData();
+    }
+    return true;
 }
 
 bool KdbxReader::hasError() const
@@ -113,6 +159,115 @@ KeePass2::ProtectedStreamAlgo KdbxReader::protectedStreamAlgo() const
     return m_irsAlgo;
 }
 
+/**
+ * @return true if the payload is decrypted, decompressed and parsed on separate threads
+ */
+bool KdbxReader::isPipelinedRead() const
+{
+    return m_pipelinedRead;
+}
+
+/**
+ * Enable or disable pipelined payload reading. Formats that do
+ * not support it silently fall back to sequential reading.
+ *
+ * @param pipelined true to read the payload on separate threads
+ */
+void KdbxReader::setPipelinedRead(bool pipelined)
+{
+    m_pipelinedRead = pipelined;
+}
+
+/**
+ * @return true if attachments are read from the file on demand
+ */
+bool KdbxReader::isDeferredAttachments() const
+{
+    return m_deferredAttachments;
+}
+
+/**
+ * Enable or disable on-demand attachment loading. Attachments are only
+ * deferred when reading a KDBX4 database from a file, otherwise they
+ * are loaded into memory as usual.
+ *
+ * @param deferred true to read attachments from the file when accessed
+ */
+void KdbxReader::setDeferredAttachments(bool deferred)
+{
+    m_deferredAttachments = deferred;
+}
+
+/**
+ * @return true if protected entry strings are decrypted when accessed
+ */
+bool KdbxReader::isDeferredProtectedValues() const
+{
+    return m_deferredProtectedValues;
+}
+
+/**
+ * Enable or disable on-demand decryption of protected entry strings.
+ * The inner random stream key is then kept for as long as the entries
+ * of the database exist.
+ *
+ * @param deferred true to decrypt protected strings when accessed
+ */
+void KdbxReader::setDeferredProtectedValues(bool deferred)
+{
+    m_deferredProtectedValues = deferred;
+}
+
+/**
+ * @return true if only the current state of the groups and entries is read
+ */
+bool KdbxReader::isMetadataOnly() const
+{
+    return m_metadataOnly;
+}
+
+/**
+ * Skip entry history, custom icons and attachments, see
+ * KdbxXmlReader::setMetadataOnly(). Attachments of KDBX 4 files read
+ * from a file stay available and are read on demand.
+ *
+ * @param metadataOnly true to skip content that is not needed to look at the entries
+ */
+void KdbxReader::setMetadataOnly(bool metadataOnly)
+{
+    m_metadataOnly = metadataOnly;
+}
+
+/**
+ * Use a key that was already transformed when the file is read a second
+ * time. It is only used if the KDF seed of the file still matches, the KDF
+ * runs as usual otherwise.
+ *
+ * @param transformSeed KDF seed the key was transformed with
+ * @param transformedKey transformed database key
+ */
+void KdbxReader::setTransformedKey(const QByteArray& transformSeed, const QByteArray& transformedKey)
+{
+    m_transformSeed = transformSeed;
+    m_transformedKey = transformedKey;
+}
+
+/**
+ * Set the key of the database being read, see setTransformedKey().
+ *
+ * @return true on success
+ */
+bool KdbxReader::transformDatabaseKey(Database* db,
+                                      const QSharedPointer<const CompositeKey>& key,
+                                      bool updateChangedTime)
+{
+    if (!m_transformedKey.isEmpty() && db->kdf() && db->kdf()->seed() == m_transformSeed) {
+        db->setTransformedKey(key, m_transformedKey);
+        return true;
+    }
+    return db->setKey(key, updateChangedTime, false);
+}
+
 /**
  * @param data stream cipher UUID as bytes
  */
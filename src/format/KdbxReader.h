@@ -28,6 +28,18 @@
 class Database;
 class QIODevice;
 
+/**
+ * Outer header of a KDBX file, readable without the database key.
+ */
+struct KdbxHeaderInfo
+{
+    quint32 version = 0;
+    QUuid cipher;
+    quint32 compressionAlgorithm = 0;
+    QSharedPointer<Kdf> kdf;
+    QVariantMap publicCustomData;
+};
+
 /**
  * Abstract KDBX reader base class.
  */
@@ -41,12 +53,23 @@ public:
 
     static bool readMagicNumbers(QIODevice* device, quint32& sig1, quint32& sig2, quint32& version);
     bool readDatabase(QIODevice* device, QSharedPointer<const CompositeKey> key, Database* db);
+    bool readHeader(QIODevice* device, KdbxHeaderInfo& header);
 
     bool hasError() const;
     QString errorString() const;
 
     KeePass2::ProtectedStreamAlgo protectedStreamAlgo() const;
 
+    bool isPipelinedRead() const;
+    void setPipelinedRead(bool pipelined);
+    bool isDeferredAttachments() const;
+    void setDeferredAttachments(bool deferred);
+    bool isDeferredProtectedValues() const;
+    void setDeferredProtectedValues(bool deferred);
+    bool isMetadataOnly() const;
+    void setMetadataOnly(bool metadataOnly);
+    void setTransformedKey(const QByteArray& transformSeed, const QByteArray& transformedKey);
+
 protected:
     /**
      * Concrete reader implementation for reading database from device.
@@ -81,6 +104,7 @@ protected:
     virtual void setStreamStartBytes(const QByteArray& data);
     virtual void setInnerRandomStreamID(const QByteArray& data);
 
+    bool transformDatabaseKey(Database* db, const QSharedPointer<const CompositeKey>& key, bool updateChangedTime);
     void raiseError(const QString& errorMessage);
 
     quint32 m_kdbxVersion = 0;
@@ -90,9 +114,18 @@ protected:
     QByteArray m_streamStartBytes;
     QByteArray m_protectedStreamKey;
     KeePass2::ProtectedStreamAlgo m_irsAlgo = KeePass2::ProtectedStreamAlgo::InvalidProtectedStreamAlgo;
+    bool m_pipelinedRead = false;
+    bool m_deferredAttachments = false;
+    bool m_deferredProtectedValues = false;
+    bool m_metadataOnly = false;
+    QByteArray m_transformSeed;
+    QByteArray m_transformedKey;
 
 private:
+    bool readHeaderFields(QIODevice* device, Database* db, QByteArray* headerData);
+
     QPair<quint32, quint32> m_kdbxSignature;
+    quint32 m_kdbxFullVersion = 0;
     QPointer<Database> m_db;
 
     bool m_error = false;
@@ -71,9 +71,49 @@ void KdbxWriter::extractDatabase(QByteArray& xmlOutput, Database* db)
     QBuffer buffer;
     buffer.setBuffer(&xmlOutput);
     buffer.open(QIODevice::WriteOnly);
+    extractDatabase(&buffer, db);
+}
+
+/**
+ * Write the plain XML of the database to a device, without
+ * protecting any values.
+ *
+ * @param device output device
+ * @param db database to extract
+ */
+void KdbxWriter::extractDatabase(QIODevice* device, Database* db)
+{
     KdbxXmlWriter writer(formatVersion());
     writer.disableInnerStreamProtection(true);
-    writer.writeDatabase(&buffer, db);
+    writer.writeDatabase(device, db);
+    if (writer.hasError()) {
+        raiseError(writer.errorString());
+    }
+}
+
+/**
+ * Set the cache used to reuse the XML of groups that did not change
+ * since the last save.
+ *
+ * @param cache fragment cache or nullptr
+ */
+void KdbxWriter::setFragmentCache(KdbxXmlFragmentCache* cache)
+{
+    m_fragmentCache = cache;
+}
+
+/**
+ * Configure the gzip compression of the payload, if the database
+ * enables compression.
+ *
+ * @param level zlib compression level
+ * @param parallel compress on multiple threads
+ */
+void KdbxWriter::setCompression(int level, bool parallel)
+{
+    // -1 selects the zlib default
+    m_compressionLevel = qBound(-1, level, 9);
+    m_parallelCompression = parallel;
 }
 
 /**
@@ -29,6 +29,7 @@
 
 class QIODevice;
 class Database;
+class KdbxXmlFragmentCache;
 
 /**
  * Abstract KDBX writer base class.
@@ -58,6 +59,9 @@ public:
     virtual quint32 formatVersion() = 0;
 
     void extractDatabase(QByteArray& xmlOutput, Database* db);
+    void extractDatabase(QIODevice* device, Database* db);
+    void setFragmentCache(KdbxXmlFragmentCache* cache);
+    void setCompression(int level, bool parallel);
 
     bool hasError() const;
     QString errorString() const;
@@ -89,6 +93,10 @@ protected:
     bool writeData(QIODevice* device, const QByteArray& data);
     void raiseError(const QString& errorMessage);
 
+    KdbxXmlFragmentCache* m_fragmentCache = nullptr;
+    int m_compressionLevel = 6;
+    bool m_parallelCompression = false;
+
     bool m_error = false;
     QString m_errorStr = "";
 };
@@ -0,0 +1,204 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KdbxXmlFragmentCache.h"
+
+#include "core/Entry.h"
+#include "core/Global.h"
+#include "core/Group.h"
+
+namespace
+{
+    // TimeInfo::operator== ignores the expiry time of items that don't
+    // expire, but it is serialized nonetheless
+    bool sameTimes(const TimeInfo& lhs, const TimeInfo& rhs)
+    {
+        return lhs.lastModificationTime() == rhs.lastModificationTime() && lhs.creationTime() == rhs.creationTime()
+               && lhs.lastAccessTime() == rhs.lastAccessTime() && lhs.expiryTime() == rhs.expiryTime()
+               && lhs.expires() == rhs.expires() && lhs.usageCount() == rhs.usageCount()
+               && lhs.locationChanged() == rhs.locationChanged();
+    }
+} // namespace
+
+KdbxXmlFragmentCache::KdbxXmlFragmentCache(QObject* parent)
+    : QObject(parent)
+{
+}
+
+KdbxXmlFragmentCache::~KdbxXmlFragmentCache()
+{
+    clear();
+}
+
+/**
+ * Set the serialization context of the next save. Fragments depend on
+ * settings outside of their group, like the KDBX version or the memory
+ * protection flags. All fragments are dropped if the context changes.
+ *
+ * @param context opaque value describing the serialization settings
+ */
+void KdbxXmlFragmentCache::setContext(quint64 context)
+{
+    if (context != m_context) {
+        clear();
+        m_context = context;
+    }
+}
+
+/**
+ * Look up the cached fragment of a group.
+ *
+ * @param group group to look up
+ * @param depth nesting depth the group is written at
+ * @return fragment or nullptr if there is no valid fragment for the group
+ */
+QSharedPointer<const KdbxXmlFragment> KdbxXmlFragmentCache::fragment(const Group* group, int depth) const
+{
+    auto it = m_groups.constFind(group);
+    if (it == m_groups.constEnd()) {
+        return {};
+    }
+
+    const CachedGroup& cached = it.value();
+    if (cached.depth != depth || !sameTimes(cached.timeInfo, group->timeInfo())
+        || cached.lastTopVisibleEntry != group->lastTopVisibleEntry() || cached.children != group->children()) {
+        return {};
+    }
+
+    int index = 0;
+    for (const Entry* entry : group->entries()) {
+        if (index >= cached.entries.size() || cached.entries[index] != entry
+            || !sameTimes(cached.entryTimeInfos[index], entry->timeInfo())) {
+            return {};
+        }
+        ++index;
+
+        if (entry->hasCompactHistory()) {
+            // compact history items cannot change, comparing their times is enough
+            for (const TimeInfo& timeInfo : entry->historyTimeInfos()) {
+                if (index >= cached.entries.size() || cached.entries[index]
+                    || !sameTimes(cached.entryTimeInfos[index], timeInfo)) {
+                    return {};
+                }
+                ++index;
+            }
+            continue;
+        }
+
+        for (const Entry* item : entry->historyItems()) {
+            if (index >= cached.entries.size() || cached.entries[index] != item
+                || !sameTimes(cached.entryTimeInfos[index], item->timeInfo())) {
+                return {};
+            }
+            ++index;
+        }
+    }
+    if (index != cached.entries.size()) {
+        return {};
+    }
+
+    return cached.fragment;
+}
+
+/**
+ * Store the fragment of a group that was just serialized and watch the
+ * group and its entries for changes.
+ *
+ * @param group serialized group
+ * @param depth nesting depth the group was written at
+ * @param fragment serialized XML
+ */
+void KdbxXmlFragmentCache::insert(const Group* group, int depth, const KdbxXmlFragment& fragment)
+{
+    invalidate(group);
+
+    CachedGroup cached;
+    cached.fragment = QSharedPointer<const KdbxXmlFragment>::create(fragment);
+    cached.depth = depth;
+    cached.timeInfo = group->timeInfo();
+    cached.lastTopVisibleEntry = group->lastTopVisibleEntry();
+    cached.children = group->children();
+
+    auto invalidateGroup = [this, group] { invalidate(group); };
+    cached.connections.append(connect(group, &Group::groupModified, this, invalidateGroup));
+    cached.connections.append(connect(group, &Group::groupNonDataChange, this, invalidateGroup));
+    cached.connections.append(connect(group, &Group::groupDataChanged, this, invalidateGroup));
+    cached.connections.append(connect(group, &Group::entryAdded, this, invalidateGroup));
+    cached.connections.append(connect(group, &Group::entryRemoved, this, invalidateGroup));
+    cached.connections.append(connect(group, &Group::destroyed, this, invalidateGroup));
+
+    for (const Entry* entry : group->entries()) {
+        cached.entries.append(entry);
+        cached.entryTimeInfos.append(entry->timeInfo());
+        cached.connections.append(connect(entry, &Entry::entryModified, this, invalidateGroup));
+        cached.connections.append(connect(entry, &Entry::entryDataChanged, this, invalidateGroup));
+
+        if (entry->hasCompactHistory()) {
+            for (const TimeInfo& timeInfo : entry->historyTimeInfos()) {
+                cached.entries.append(nullptr);
+                cached.entryTimeInfos.append(timeInfo);
+            }
+            continue;
+        }
+
+        for (const Entry* item : entry->historyItems()) {
+            cached.entries.append(item);
+            cached.entryTimeInfos.append(item->timeInfo());
+            cached.connections.append(connect(item, &Entry::entryModified, this, invalidateGroup));
+        }
+    }
+
+    m_groups.insert(group, cached);
+}
+
+/**
+ * Drop the cached fragment of a group.
+ *
+ * @param group group to invalidate
+ */
+void KdbxXmlFragmentCache::invalidate(const Group* group)
+{
+    auto it = m_groups.find(group);
+    if (it == m_groups.end()) {
+        return;
+    }
+
+    for (const QMetaObject::Connection& connection : asConst(it.value().connections)) {
+        disconnect(connection);
+    }
+    m_groups.erase(it);
+}
+
+void KdbxXmlFragmentCache::clear()
+{
+    for (const CachedGroup& cached : asConst(m_groups)) {
+        for (const QMetaObject::Connection& connection : cached.connections) {
+            disconnect(connection);
+        }
+    }
+    m_groups.clear();
+}
+
+bool KdbxXmlFragmentCache::contains(const Group* group) const
+{
+    return m_groups.contains(group);
+}
+
+int KdbxXmlFragmentCache::size() const
+{
+    return m_groups.size();
+}
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_KDBXXMLFRAGMENTCACHE_H
+#define KEEPASSXC_KDBXXMLFRAGMENTCACHE_H
+
+#include <QHash>
+#include <QObject>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "core/TimeInfo.h"
+
+class Entry;
+class Group;
+
+/**
+ * Serialized XML of a single group without its child groups.
+ *
+ * Child groups and everything that differs between two saves of an
+ * unchanged group are left out of the data and recorded as inserts
+ * that are written at the given offsets when the fragment is reused.
+ */
+struct KdbxXmlFragment
+{
+    enum class InsertType
+    {
+        ChildGroup,
+        ProtectedValue,
+        AttachmentRef
+    };
+
+    /**
+     * Protected values and attachments are referred to by the entry of
+     * the group, the index of the history item and their key and are
+     * looked up again when the fragment is reused, so no plaintext is
+     * kept. History items may only exist while they are written.
+     */
+    struct Insert
+    {
+        int offset;
+        InsertType type;
+        const Group* group;
+        const Entry* entry;
+        int historyIndex;
+        QString key;
+    };
+
+    QByteArray data;
+    QVector<Insert> inserts;
+};
+
+/**
+ * Cache of serialized group fragments that lets KdbxXmlWriter reuse
+ * the XML of groups that did not change since the previous save.
+ *
+ * Fragments are dropped as soon as their group or one of its entries
+ * emits a modification signal. Before a fragment is handed out, the
+ * structure and times of the group are compared against the state at
+ * the time it was recorded to catch changes that are not signalled.
+ */
+class KdbxXmlFragmentCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit KdbxXmlFragmentCache(QObject* parent = nullptr);
+    ~KdbxXmlFragmentCache() override;
+
+    void setContext(quint64 context);
+    QSharedPointer<const KdbxXmlFragment> fragment(const Group* group, int depth) const;
+    void insert(const Group* group, int depth, const KdbxXmlFragment& fragment);
+    void invalidate(const Group* group);
+    void clear();
+    bool contains(const Group* group) const;
+    int size() const;
+
+private:
+    struct CachedGroup
+    {
+        QSharedPointer<const KdbxXmlFragment> fragment;
+        int depth;
+        TimeInfo timeInfo;
+        const Entry* lastTopVisibleEntry;
+        QList<Group*> children;
+        QVector<const Entry*> entries;
+        QVector<TimeInfo> entryTimeInfos;
+        QVector<QMetaObject::Connection> connections;
+    };
+
+    quint64 m_context = 0;
+    QHash<const Group*, CachedGroup> m_groups;
+};
+
+#endif // KEEPASSXC_KDBXXMLFRAGMENTCACHE_H
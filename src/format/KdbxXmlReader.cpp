@@ -17,21 +17,340 @@
 
 #include "KdbxXmlReader.h"
 #include "KeePass2RandomStream.h"
+#include "core/AttachmentSource.h"
 #include "core/Clock.h"
 #include "core/DatabaseIcons.h"
 #include "core/Endian.h"
 #include "core/Entry.h"
 #include "core/Global.h"
 #include "core/Group.h"
+#include "core/ProtectedValueSource.h"
 #include "core/Tools.h"
-#include "streams/QtIOCompressor"
+#include "core/Trace.h"
+#include "streams/GzipCodec.h"
 
-#include <QBuffer>
 #include <QFile>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <utility>
 
 #define UUID_LENGTH 16
 
+namespace
+{
+    enum class XmlElement
+    {
+        Unknown,
+        Association,
+        AutoType,
+        BackgroundColor,
+        Binaries,
+        Binary,
+        Color,
+        CreationTime,
+        CustomData,
+        CustomIconUUID,
+        CustomIcons,
+        Data,
+        DataTransferObfuscation,
+        DatabaseDescription,
+        DatabaseDescriptionChanged,
+        DatabaseName,
+        DatabaseNameChanged,
+        DefaultAutoTypeSequence,
+        DefaultSequence,
+        DefaultUserName,
+        DefaultUserNameChanged,
+        DeletedObject,
+        DeletedObjects,
+        DeletionTime,
+        EnableAutoType,
+        EnableSearching,
+        Enabled,
+        Entry,
+        EntryTemplatesGroup,
+        EntryTemplatesGroupChanged,
+        Expires,
+        ExpiryTime,
+        ForegroundColor,
+        Generator,
+        Group,
+        HeaderHash,
+        History,
+        HistoryMaxItems,
+        HistoryMaxSize,
+        Icon,
+        IconID,
+        IsExpanded,
+        Item,
+        KeePassFile,
+        Key,
+        KeystrokeSequence,
+        LastAccessTime,
+        LastModificationTime,
+        LastSelectedGroup,
+        LastTopVisibleEntry,
+        LastTopVisibleGroup,
+        LocationChanged,
+        MaintenanceHistoryDays,
+        MasterKeyChangeForce,
+        MasterKeyChangeRec,
+        MasterKeyChanged,
+        MemoryProtection,
+        Meta,
+        Name,
+        Notes,
+        OverrideURL,
+        ProtectNotes,
+        ProtectPassword,
+        ProtectTitle,
+        ProtectURL,
+        ProtectUserName,
+        RecycleBinChanged,
+        RecycleBinEnabled,
+        RecycleBinUUID,
+        Root,
+        SettingsChanged,
+        String,
+        Tags,
+        Times,
+        UUID,
+        UsageCount,
+        Value,
+        Window,
+    };
+
+    struct ElementName
+    {
+        QLatin1String name;
+        XmlElement element;
+    };
+
+    // Sorted by name, looked up with a binary search
+    const ElementName ELEMENT_NAMES[] = {
+        {QLatin1String("Association"), XmlElement::Association},
+        {QLatin1String("AutoType"), XmlElement::AutoType},
+        {QLatin1String("BackgroundColor"), XmlElement::BackgroundColor},
+        {QLatin1String("Binaries"), XmlElement::Binaries},
+        {QLatin1String("Binary"), XmlElement::Binary},
+        {QLatin1String("Color"), XmlElement::Color},
+        {QLatin1String("CreationTime"), XmlElement::CreationTime},
+        {QLatin1String("CustomData"), XmlElement::CustomData},
+        {QLatin1String("CustomIconUUID"), XmlElement::CustomIconUUID},
+        {QLatin1String("CustomIcons"), XmlElement::CustomIcons},
+        {QLatin1String("Data"), XmlElement::Data},
+        {QLatin1String("DataTransferObfuscation"), XmlElement::DataTransferObfuscation},
+        {QLatin1String("DatabaseDescription"), XmlElement::DatabaseDescription},
+        {QLatin1String("DatabaseDescriptionChanged"), XmlElement::DatabaseDescriptionChanged},
+        {QLatin1String("DatabaseName"), XmlElement::DatabaseName},
+        {QLatin1String("DatabaseNameChanged"), XmlElement::DatabaseNameChanged},
+        {QLatin1String("DefaultAutoTypeSequence"), XmlElement::DefaultAutoTypeSequence},
+        {QLatin1String("DefaultSequence"), XmlElement::DefaultSequence},
+        {QLatin1String("DefaultUserName"), XmlElement::DefaultUserName},
+        {QLatin1String("DefaultUserNameChanged"), XmlElement::DefaultUserNameChanged},
+        {QLatin1String("DeletedObject"), XmlElement::DeletedObject},
+        {QLatin1String("DeletedObjects"), XmlElement::DeletedObjects},
+        {QLatin1String("DeletionTime"), XmlElement::DeletionTime},
+        {QLatin1String("EnableAutoType"), XmlElement::EnableAutoType},
+        {QLatin1String("EnableSearching"), XmlElement::EnableSearching},
+        {QLatin1String("Enabled"), XmlElement::Enabled},
+        {QLatin1String("Entry"), XmlElement::Entry},
+        {QLatin1String("EntryTemplatesGroup"), XmlElement::EntryTemplatesGroup},
+        {QLatin1String("EntryTemplatesGroupChanged"), XmlElement::EntryTemplatesGroupChanged},
+        {QLatin1String("Expires"), XmlElement::Expires},
+        {QLatin1String("ExpiryTime"), XmlElement::ExpiryTime},
+        {QLatin1String("ForegroundColor"), XmlElement::ForegroundColor},
+        {QLatin1String("Generator"), XmlElement::Generator},
+        {QLatin1String("Group"), XmlElement::Group},
+        {QLatin1String("HeaderHash"), XmlElement::HeaderHash},
+        {QLatin1String("History"), XmlElement::History},
+        {QLatin1String("HistoryMaxItems"), XmlElement::HistoryMaxItems},
+        {QLatin1String("HistoryMaxSize"), XmlElement::HistoryMaxSize},
+        {QLatin1String("Icon"), XmlElement::Icon},
+        {QLatin1String("IconID"), XmlElement::IconID},
+        {QLatin1String("IsExpanded"), XmlElement::IsExpanded},
+        {QLatin1String("Item"), XmlElement::Item},
+        {QLatin1String("KeePassFile"), XmlElement::KeePassFile},
+        {QLatin1String("Key"), XmlElement::Key},
+        {QLatin1String("KeystrokeSequence"), XmlElement::KeystrokeSequence},
+        {QLatin1String("LastAccessTime"), XmlElement::LastAccessTime},
+        {QLatin1String("LastModificationTime"), XmlElement::LastModificationTime},
+        {QLatin1String("LastSelectedGroup"), XmlElement::LastSelectedGroup},
+        {QLatin1String("LastTopVisibleEntry"), XmlElement::LastTopVisibleEntry},
+        {QLatin1String("LastTopVisibleGroup"), XmlElement::LastTopVisibleGroup},
+        {QLatin1String("LocationChanged"), XmlElement::LocationChanged},
+        {QLatin1String("MaintenanceHistoryDays"), XmlElement::MaintenanceHistoryDays},
+        {QLatin1String("MasterKeyChangeForce"), XmlElement::MasterKeyChangeForce},
+        {QLatin1String("MasterKeyChangeRec"), XmlElement::MasterKeyChangeRec},
+        {QLatin1String("MasterKeyChanged"), XmlElement::MasterKeyChanged},
+        {QLatin1String("MemoryProtection"), XmlElement::MemoryProtection},
+        {QLatin1String("Meta"), XmlElement::Meta},
+        {QLatin1String("Name"), XmlElement::Name},
+        {QLatin1String("Notes"), XmlElement::Notes},
+        {QLatin1String("OverrideURL"), XmlElement::OverrideURL},
+        {QLatin1String("ProtectNotes"), XmlElement::ProtectNotes},
+        {QLatin1String("ProtectPassword"), XmlElement::ProtectPassword},
+        {QLatin1String("ProtectTitle"), XmlElement::ProtectTitle},
+        {QLatin1String("ProtectURL"), XmlElement::ProtectURL},
+        {QLatin1String("ProtectUserName"), XmlElement::ProtectUserName},
+        {QLatin1String("RecycleBinChanged"), XmlElement::RecycleBinChanged},
+        {QLatin1String("RecycleBinEnabled"), XmlElement::RecycleBinEnabled},
+        {QLatin1String("RecycleBinUUID"), XmlElement::RecycleBinUUID},
+        {QLatin1String("Root"), XmlElement::Root},
+        {QLatin1String("SettingsChanged"), XmlElement::SettingsChanged},
+        {QLatin1String("String"), XmlElement::String},
+        {QLatin1String("Tags"), XmlElement::Tags},
+        {QLatin1String("Times"), XmlElement::Times},
+        {QLatin1String("UUID"), XmlElement::UUID},
+        {QLatin1String("UsageCount"), XmlElement::UsageCount},
+        {QLatin1String("Value"), XmlElement::Value},
+        {QLatin1String("Window"), XmlElement::Window},
+    };
+
+    /**
+     * Map an element name to its id. Unlike comparing the name against
+     * string literals this doesn't allocate temporary strings.
+     *
+     * @param name element name
+     * @return element id or XmlElement::Unknown
+     */
+    XmlElement elementId(const QStringRef& name)
+    {
+        auto it = std::lower_bound(
+            std::begin(ELEMENT_NAMES), std::end(ELEMENT_NAMES), name, [](const ElementName& e, const QStringRef& n) {
+                return n.compare(e.name) > 0;
+            });
+        if (it != std::end(ELEMENT_NAMES) && name == it->name) {
+            return it->element;
+        }
+        return XmlElement::Unknown;
+    }
+
+    // seconds from 0001-01-01 to the epoch, the base of binary KDBX 4 times
+    const qint64 KdbxEpochOffset = 62135596800LL;
+    // 9999-12-31 23:59:59 in binary KDBX 4 time
+    const qint64 KdbxMaxSeconds = 315537897599LL;
+
+    /**
+     * Parse a time in the "yyyy-MM-ddThh:mm:ssZ" form KDBX 3 files use
+     * without going through QDateTime.
+     *
+     * @param str time to parse
+     * @param msecs receives the milliseconds since the epoch
+     * @return false if the string has another form
+     */
+    bool parseUtcTime(const QString& str, qint64* msecs)
+    {
+        if (str.size() != 20 || str.at(4) != '-' || str.at(7) != '-' || str.at(10) != 'T' || str.at(13) != ':'
+            || str.at(16) != ':' || str.at(19) != 'Z') {
+            return false;
+        }
+
+        auto number = [&str](int pos, int length, int* value) {
+            *value = 0;
+            for (int i = pos; i < pos + length; ++i) {
+                const int digit = str.at(i).unicode() - '0';
+                if (digit < 0 || digit > 9) {
+                    return false;
+                }
+                *value = *value * 10 + digit;
+            }
+            return true;
+        };
+
+        int year, month, day, hour, minute, second;
+        if (!number(0, 4, &year) || !number(5, 2, &month) || !number(8, 2, &day) || !number(11, 2, &hour)
+            || !number(14, 2, &minute) || !number(17, 2, &second)) {
+            return false;
+        }
+
+        const QDate date(year, month, day);
+        if (!date.isValid() || hour > 23 || minute > 59 || second > 59) {
+            return false;
+        }
+
+        const qint64 days = date.toJulianDay() - QDate(1970, 1, 1).toJulianDay();
+        *msecs = ((days * 24 + hour) * 60 + minute) * 60000LL + second * 1000LL;
+        return true;
+    }
+
+    /**
+     * Base64 alphabet lookup, with 0x40 marking the padding character
+     * and 0x80 marking characters outside of the alphabet.
+     */
+    struct Base64Alphabet
+    {
+        quint8 values[128];
+
+        Base64Alphabet()
+        {
+            std::fill(std::begin(values), std::end(values), quint8(0x80));
+            const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (quint8 i = 0; i < 64; ++i) {
+                values[static_cast<int>(alphabet[i])] = i;
+            }
+            values[static_cast<int>('=')] = 0x40;
+        }
+    };
+
+    const Base64Alphabet Base64Values;
+
+    // largest field decoded by decodeFixedBase64(), in bytes
+    const int MaxFixedBase64Size = 16;
+
+    /**
+     * Decode the padded base64 text of a field with a fixed size. All
+     * characters are validated together after decoding, so there are
+     * no per-character branches.
+     *
+     * @param text base64 text
+     * @param out buffer for size bytes
+     * @param size decoded size
+     * @return true if text is exactly the padded base64 encoding of size bytes
+     */
+    bool decodeFixedBase64(const QStringRef& text, char* out, int size)
+    {
+        Q_ASSERT(size > 0 && size <= MaxFixedBase64Size);
+
+        const int length = (size + 2) / 3 * 4;
+        if (text.size() != length) {
+            return false;
+        }
+
+        const ushort* in = reinterpret_cast<const ushort*>(text.unicode());
+        const int padding = length / 4 * 3 - size;
+        quint8 decoded[(MaxFixedBase64Size + 2) / 3 * 3];
+        quint32 invalid = 0;
+        for (int i = 0, o = 0; i < length; i += 4, o += 3) {
+            quint32 group = 0;
+            for (int j = i; j < i + 4; ++j) {
+                const quint32 value = Base64Values.values[in[j] & 0x7F] | (quint32(in[j] > 0x7F) << 7);
+                // the padding characters have to be exactly at the end
+                invalid |= (value & 0x80) | (((value >> 6) & 1) ^ quint32(j >= length - padding));
+                group = (group << 6) | (value & 0x3F);
+            }
+            decoded[o] = static_cast<quint8>(group >> 16);
+            decoded[o + 1] = static_cast<quint8>(group >> 8);
+            decoded[o + 2] = static_cast<quint8>(group);
+        }
+
+        if (invalid != 0) {
+            return false;
+        }
+        memcpy(out, decoded, static_cast<size_t>(size));
+        return true;
+    }
+
+    qint64 kdbxSecondsToMSecs(qint64 secs)
+    {
+        if (secs >= 0 && secs <= KdbxMaxSeconds) {
+            return (secs - KdbxEpochOffset) * 1000;
+        }
+        return TimeInfo::toMSecs(QDateTime(QDate(1, 1, 1), QTime(0, 0, 0, 0), Qt::UTC).addSecs(secs));
+    }
+} // namespace
+
 /**
  * @param version KDBX version
  */
@@ -96,6 +415,7 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
     m_meta->setUpdateDatetime(false);
 
     m_randomStream = randomStream;
+    m_protectedOffset = 0;
     m_headerHash.clear();
 
     m_tmpParent.reset(new Group());
@@ -107,7 +427,7 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
         return;
     }
 
-    if (m_xml.readNextStartElement() && m_xml.name() == "KeePassFile") {
+    if (m_xml.readNextStartElement() && elementId(m_xml.name()) == XmlElement::KeePassFile) {
         rootGroupParsed = parseKeePassFile();
     }
 
@@ -124,7 +444,11 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
         qWarning("KdbxXmlReader::readDatabase: found %d invalid entry reference(s)", m_tmpParent->children().size());
     }
 
-    const QSet<QString> poolKeys = asConst(m_binaryPool).keys().toSet();
+    QSet<QString> poolKeys = asConst(m_binaryPool).keys().toSet();
+    const int deferredCount = m_attachmentSource ? m_attachmentSource->count() : 0;
+    for (int i = 0; i < deferredCount; ++i) {
+        poolKeys.insert(QString::number(i));
+    }
     const QSet<QString> entryKeys = asConst(m_binaryMap).keys().toSet();
     const QSet<QString> unmappedKeys = entryKeys - poolKeys;
     const QSet<QString> unusedKeys = poolKeys - entryKeys;
@@ -140,6 +464,18 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
     QHash<QString, QPair<Entry*, QString>>::const_iterator i;
     for (i = m_binaryMap.constBegin(); i != m_binaryMap.constEnd(); ++i) {
         const QPair<Entry*, QString>& target = i.value();
+        if (deferredCount > 0 && !m_binaryPool.contains(i.key())) {
+            bool ok;
+            int index = i.key().toInt(&ok);
+            if (ok && index >= 0 && index < deferredCount) {
+                target.first->attachments()->setDeferred(target.second, m_attachmentSource, index);
+                continue;
+            }
+        }
+        if (m_metadataOnly && !m_binaryPool.contains(i.key())) {
+            // the attachment data was skipped
+            continue;
+        }
         target.first->attachments()->set(target.second, m_binaryPool[i.key()]);
     }
 
@@ -158,6 +494,8 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
         for (Entry* histEntry : historyItems) {
             histEntry->setUpdateTimeinfo(true);
         }
+        // all attachments are assigned, history entries are no longer needed
+        iEntry.value()->compactHistory();
     }
 }
 
@@ -171,6 +509,43 @@ void KdbxXmlReader::setStrictMode(bool strictMode)
     m_strictMode = strictMode;
 }
 
+/**
+ * Resolve binary references that are not in the binary pool from an
+ * attachment source. The attachments are read on demand, the pool key
+ * is the index in the source.
+ *
+ * @param source attachment source
+ */
+void KdbxXmlReader::setAttachmentSource(QSharedPointer<const AttachmentSource> source)
+{
+    m_attachmentSource = std::move(source);
+}
+
+/**
+ * Keep protected entry strings encrypted and let the source decrypt
+ * them when they are accessed. All other protected values are decrypted
+ * through the source right away, so the random stream passed to
+ * readDatabase() is not used.
+ *
+ * @param source protected value source for the inner random stream
+ */
+void KdbxXmlReader::setProtectedValueSource(QSharedPointer<const ProtectedValueSource> source)
+{
+    m_protectedValueSource = std::move(source);
+}
+
+/**
+ * Only read the current state of the groups and entries. Entry history,
+ * custom icons and attachments that are not available from the attachment
+ * source are skipped, so a database read this way must not be saved.
+ *
+ * @param metadataOnly true to skip history, custom icons and attachments
+ */
+void KdbxXmlReader::setMetadataOnly(bool metadataOnly)
+{
+    m_metadataOnly = metadataOnly;
+}
+
 bool KdbxXmlReader::hasError() const
 {
     return m_error || m_xml.hasError();
@@ -192,7 +567,7 @@ QString KdbxXmlReader::errorString() const
 
 bool KdbxXmlReader::isTrueValue(const QStringRef& value)
 {
-    return value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0 || value == "1";
+    return value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0 || value == QLatin1String("1");
 }
 
 void KdbxXmlReader::raiseError(const QString& errorMessage)
@@ -214,12 +589,11 @@ bool KdbxXmlReader::parseKeePassFile()
     bool rootParsedSuccessfully = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Meta") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::Meta:
             parseMeta();
-            continue;
-        }
-
-        if (m_xml.name() == "Root") {
+            break;
+        case XmlElement::Root:
             if (rootElementFound) {
                 rootParsedSuccessfully = false;
                 qWarning("Multiple root elements");
@@ -227,10 +601,11 @@ bool KdbxXmlReader::parseKeePassFile()
                 rootParsedSuccessfully = parseRoot();
                 rootElementFound = true;
             }
-            continue;
+            break;
+        default:
+            skipCurrentElement();
+            break;
         }
-
-        skipCurrentElement();
     }
 
     return rootParsedSuccessfully;
@@ -241,72 +616,111 @@ void KdbxXmlReader::parseMeta()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "Meta");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Generator") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::Generator:
             m_meta->setGenerator(readString());
-        } else if (m_xml.name() == "HeaderHash") {
+            break;
+        case XmlElement::HeaderHash:
             m_headerHash = readBinary();
-        } else if (m_xml.name() == "DatabaseName") {
+            break;
+        case XmlElement::DatabaseName:
             m_meta->setName(readString());
-        } else if (m_xml.name() == "DatabaseNameChanged") {
+            break;
+        case XmlElement::DatabaseNameChanged:
             m_meta->setNameChanged(readDateTime());
-        } else if (m_xml.name() == "DatabaseDescription") {
+            break;
+        case XmlElement::DatabaseDescription:
             m_meta->setDescription(readString());
-        } else if (m_xml.name() == "DatabaseDescriptionChanged") {
+            break;
+        case XmlElement::DatabaseDescriptionChanged:
             m_meta->setDescriptionChanged(readDateTime());
-        } else if (m_xml.name() == "DefaultUserName") {
+            break;
+        case XmlElement::DefaultUserName:
             m_meta->setDefaultUserName(readString());
-        } else if (m_xml.name() == "DefaultUserNameChanged") {
+            break;
+        case XmlElement::DefaultUserNameChanged:
             m_meta->setDefaultUserNameChanged(readDateTime());
-        } else if (m_xml.name() == "MaintenanceHistoryDays") {
+            break;
+        case XmlElement::MaintenanceHistoryDays:
             m_meta->setMaintenanceHistoryDays(readNumber());
-        } else if (m_xml.name() == "Color") {
+            break;
+        case XmlElement::Color:
             m_meta->setColor(readColor());
-        } else if (m_xml.name() == "MasterKeyChanged") {
+            break;
+        case XmlElement::MasterKeyChanged:
             m_meta->setDatabaseKeyChanged(readDateTime());
-        } else if (m_xml.name() == "MasterKeyChangeRec") {
+            break;
+        case XmlElement::MasterKeyChangeRec:
             m_meta->setMasterKeyChangeRec(readNumber());
-        } else if (m_xml.name() == "MasterKeyChangeForce") {
+            break;
+        case XmlElement::MasterKeyChangeForce:
             m_meta->setMasterKeyChangeForce(readNumber());
-        } else if (m_xml.name() == "MemoryProtection") {
+            break;
+        case XmlElement::MemoryProtection:
             parseMemoryProtection();
-        } else if (m_xml.name() == "CustomIcons") {
-            parseCustomIcons();
-        } else if (m_xml.name() == "RecycleBinEnabled") {
+            break;
+        case XmlElement::CustomIcons:
+            if (m_metadataOnly) {
+                m_xml.skipCurrentElement();
+            } else {
+                parseCustomIcons();
+            }
+            break;
+        case XmlElement::RecycleBinEnabled:
             m_meta->setRecycleBinEnabled(readBool());
-        } else if (m_xml.name() == "RecycleBinUUID") {
+            break;
+        case XmlElement::RecycleBinUUID:
             m_meta->setRecycleBin(getGroup(readUuid()));
-        } else if (m_xml.name() == "RecycleBinChanged") {
+            break;
+        case XmlElement::RecycleBinChanged:
             m_meta->setRecycleBinChanged(readDateTime());
-        } else if (m_xml.name() == "EntryTemplatesGroup") {
+            break;
+        case XmlElement::EntryTemplatesGroup:
             m_meta->setEntryTemplatesGroup(getGroup(readUuid()));
-        } else if (m_xml.name() == "EntryTemplatesGroupChanged") {
+            break;
+        case XmlElement::EntryTemplatesGroupChanged:
             m_meta->setEntryTemplatesGroupChanged(readDateTime());
-        } else if (m_xml.name() == "LastSelectedGroup") {
+            break;
+        case XmlElement::LastSelectedGroup:
             m_meta->setLastSelectedGroup(getGroup(readUuid()));
-        } else if (m_xml.name() == "LastTopVisibleGroup") {
+            break;
+        case XmlElement::LastTopVisibleGroup:
             m_meta->setLastTopVisibleGroup(getGroup(readUuid()));
-        } else if (m_xml.name() == "HistoryMaxItems") {
+            break;
+        case XmlElement::HistoryMaxItems: {
             int value = readNumber();
             if (value >= -1) {
                 m_meta->setHistoryMaxItems(value);
             } else {
                 qWarning("HistoryMaxItems invalid number");
             }
-        } else if (m_xml.name() == "HistoryMaxSize") {
+            break;
+        }
+        case XmlElement::HistoryMaxSize: {
             int value = readNumber();
             if (value >= -1) {
                 m_meta->setHistoryMaxSize(value);
             } else {
                 qWarning("HistoryMaxSize invalid number");
             }
-        } else if (m_xml.name() == "Binaries") {
-            parseBinaries();
-        } else if (m_xml.name() == "CustomData") {
+            break;
+        }
+        case XmlElement::Binaries:
+            if (m_metadataOnly) {
+                m_xml.skipCurrentElement();
+            } else {
+                parseBinaries();
+            }
+            break;
+        case XmlElement::CustomData:
             parseCustomData(m_meta->customData());
-        } else if (m_xml.name() == "SettingsChanged") {
+            break;
+        case XmlElement::SettingsChanged:
             m_meta->setSettingsChanged(readDateTime());
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 }
@@ -316,18 +730,25 @@ void KdbxXmlReader::parseMemoryProtection()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "MemoryProtection");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "ProtectTitle") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::ProtectTitle:
             m_meta->setProtectTitle(readBool());
-        } else if (m_xml.name() == "ProtectUserName") {
+            break;
+        case XmlElement::ProtectUserName:
             m_meta->setProtectUsername(readBool());
-        } else if (m_xml.name() == "ProtectPassword") {
+            break;
+        case XmlElement::ProtectPassword:
             m_meta->setProtectPassword(readBool());
-        } else if (m_xml.name() == "ProtectURL") {
+            break;
+        case XmlElement::ProtectURL:
             m_meta->setProtectUrl(readBool());
-        } else if (m_xml.name() == "ProtectNotes") {
+            break;
+        case XmlElement::ProtectNotes:
             m_meta->setProtectNotes(readBool());
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 }
@@ -337,10 +758,13 @@ void KdbxXmlReader::parseCustomIcons()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "CustomIcons");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Icon") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::Icon:
             parseIcon();
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 }
@@ -350,19 +774,24 @@ void KdbxXmlReader::parseIcon()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "Icon");
 
     QUuid uuid;
-    QImage icon;
+    QByteArray iconData;
     bool uuidSet = false;
     bool iconSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::UUID:
             uuid = readUuid();
             uuidSet = !uuid.isNull();
-        } else if (m_xml.name() == "Data") {
-            icon.loadFromData(readBinary());
+            break;
+        case XmlElement::Data:
+            // Decoding is deferred until the icon is shown
+            iconData = readBinary();
             iconSet = true;
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 
@@ -371,7 +800,7 @@ void KdbxXmlReader::parseIcon()
         if (m_meta->hasCustomIcon(uuid)) {
             uuid = QUuid::createUuid();
         }
-        m_meta->addCustomIcon(uuid, icon);
+        m_meta->addCustomIcon(uuid, iconData);
         return;
     }
 
@@ -383,14 +812,14 @@ void KdbxXmlReader::parseBinaries()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "Binaries");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() != "Binary") {
+        if (elementId(m_xml.name()) != XmlElement::Binary) {
             skipCurrentElement();
             continue;
         }
 
         QXmlStreamAttributes attr = m_xml.attributes();
-        QString id = attr.value("ID").toString();
-        QByteArray data = isTrueValue(attr.value("Compressed")) ? readCompressedBinary() : readBinary();
+        QString id = attr.value(QLatin1String("ID")).toString();
+        QByteArray data = isTrueValue(attr.value(QLatin1String("Compressed"))) ? readCompressedBinary() : readBinary();
 
         if (m_binaryPool.contains(id)) {
             qWarning("KdbxXmlReader::parseBinaries: overwriting binary item \"%s\"", qPrintable(id));
@@ -405,11 +834,14 @@ void KdbxXmlReader::parseCustomData(CustomData* customData)
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "CustomData");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Item") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::Item:
             parseCustomDataItem(customData);
-            continue;
+            break;
+        default:
+            skipCurrentElement();
+            break;
         }
-        skipCurrentElement();
     }
 }
 
@@ -423,14 +855,18 @@ void KdbxXmlReader::parseCustomDataItem(CustomData* customData)
     bool valueSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Key") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::Key:
             key = readString();
             keySet = true;
-        } else if (m_xml.name() == "Value") {
+            break;
+        case XmlElement::Value:
             value = readString();
             valueSet = true;
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 
@@ -444,13 +880,15 @@ void KdbxXmlReader::parseCustomDataItem(CustomData* customData)
 
 bool KdbxXmlReader::parseRoot()
 {
+    TRACE_SCOPE("KdbxXmlReader::parseRoot");
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "Root");
 
     bool groupElementFound = false;
     bool groupParsedSuccessfully = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Group") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::Group: {
             if (groupElementFound) {
                 groupParsedSuccessfully = false;
                 raiseError(tr("Multiple group elements"));
@@ -466,10 +904,14 @@ bool KdbxXmlReader::parseRoot()
             }
 
             groupElementFound = true;
-        } else if (m_xml.name() == "DeletedObjects") {
+            break;
+        }
+        case XmlElement::DeletedObjects:
             parseDeletedObjects();
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 
@@ -485,7 +927,8 @@ Group* KdbxXmlReader::parseGroup()
     QList<Group*> children;
     QList<Entry*> entries;
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::UUID: {
             QUuid uuid = readUuid();
             if (uuid.isNull()) {
                 if (m_strictMode) {
@@ -496,17 +939,15 @@ Group* KdbxXmlReader::parseGroup()
             } else {
                 group->setUuid(uuid);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "Name") {
+        case XmlElement::Name:
             group->setName(readString());
-            continue;
-        }
-        if (m_xml.name() == "Notes") {
+            break;
+        case XmlElement::Notes:
             group->setNotes(readString());
-            continue;
-        }
-        if (m_xml.name() == "IconID") {
+            break;
+        case XmlElement::IconID: {
             int iconId = readNumber();
             if (iconId < 0) {
                 if (m_strictMode) {
@@ -519,79 +960,76 @@ Group* KdbxXmlReader::parseGroup()
             }
 
             group->setIcon(iconId);
-            continue;
+            break;
         }
-        if (m_xml.name() == "CustomIconUUID") {
+        case XmlElement::CustomIconUUID: {
             QUuid uuid = readUuid();
             if (!uuid.isNull()) {
                 group->setIcon(uuid);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "Times") {
+        case XmlElement::Times:
             group->setTimeInfo(parseTimes());
-            continue;
-        }
-        if (m_xml.name() == "IsExpanded") {
+            break;
+        case XmlElement::IsExpanded:
             group->setExpanded(readBool());
-            continue;
-        }
-        if (m_xml.name() == "DefaultAutoTypeSequence") {
+            break;
+        case XmlElement::DefaultAutoTypeSequence:
             group->setDefaultAutoTypeSequence(readString());
-            continue;
-        }
-        if (m_xml.name() == "EnableAutoType") {
+            break;
+        case XmlElement::EnableAutoType: {
             QString str = readString();
 
-            if (str.compare("null", Qt::CaseInsensitive) == 0) {
+            if (str.compare(QLatin1String("null"), Qt::CaseInsensitive) == 0) {
                 group->setAutoTypeEnabled(Group::Inherit);
-            } else if (str.compare("true", Qt::CaseInsensitive) == 0) {
+            } else if (str.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0) {
                 group->setAutoTypeEnabled(Group::Enable);
-            } else if (str.compare("false", Qt::CaseInsensitive) == 0) {
+            } else if (str.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0) {
                 group->setAutoTypeEnabled(Group::Disable);
             } else {
                 raiseError(tr("Invalid EnableAutoType value"));
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "EnableSearching") {
+        case XmlElement::EnableSearching: {
             QString str = readString();
 
-            if (str.compare("null", Qt::CaseInsensitive) == 0) {
+            if (str.compare(QLatin1String("null"), Qt::CaseInsensitive) == 0) {
                 group->setSearchingEnabled(Group::Inherit);
-            } else if (str.compare("true", Qt::CaseInsensitive) == 0) {
+            } else if (str.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0) {
                 group->setSearchingEnabled(Group::Enable);
-            } else if (str.compare("false", Qt::CaseInsensitive) == 0) {
+            } else if (str.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0) {
                 group->setSearchingEnabled(Group::Disable);
             } else {
                 raiseError(tr("Invalid EnableSearching value"));
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "LastTopVisibleEntry") {
+        case XmlElement::LastTopVisibleEntry:
             group->setLastTopVisibleEntry(getEntry(readUuid()));
-            continue;
-        }
-        if (m_xml.name() == "Group") {
+            break;
+        case XmlElement::Group: {
             Group* newGroup = parseGroup();
             if (newGroup) {
                 children.append(newGroup);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "Entry") {
+        case XmlElement::Entry: {
             Entry* newEntry = parseEntry(false);
             if (newEntry) {
                 entries.append(newEntry);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "CustomData") {
+        case XmlElement::CustomData:
             parseCustomData(group->customData());
-            continue;
+            break;
+        default:
+            skipCurrentElement();
+            break;
         }
-
-        skipCurrentElement();
     }
 
     if (group->uuid().isNull() && !m_strictMode) {
@@ -624,10 +1062,13 @@ void KdbxXmlReader::parseDeletedObjects()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "DeletedObjects");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "DeletedObject") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::DeletedObject:
             parseDeletedObject();
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 }
@@ -639,7 +1080,8 @@ void KdbxXmlReader::parseDeletedObject()
     DeletedObject delObj{{}, {}};
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::UUID: {
             QUuid uuid = readUuid();
             if (uuid.isNull()) {
                 if (m_strictMode) {
@@ -649,13 +1091,15 @@ void KdbxXmlReader::parseDeletedObject()
                 continue;
             }
             delObj.uuid = uuid;
-            continue;
+            break;
         }
-        if (m_xml.name() == "DeletionTime") {
+        case XmlElement::DeletionTime:
             delObj.deletionTime = readDateTime();
-            continue;
+            break;
+        default:
+            skipCurrentElement();
+            break;
         }
-        skipCurrentElement();
     }
 
     if (!delObj.uuid.isNull() && !delObj.deletionTime.isNull()) {
@@ -678,7 +1122,8 @@ Entry* KdbxXmlReader::parseEntry(bool history)
     QList<StringPair> binaryRefs;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::UUID: {
             QUuid uuid = readUuid();
             if (uuid.isNull()) {
                 if (m_strictMode) {
@@ -689,9 +1134,9 @@ Entry* KdbxXmlReader::parseEntry(bool history)
             } else {
                 entry->setUuid(uuid);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "IconID") {
+        case XmlElement::IconID: {
             int iconId = readNumber();
             if (iconId < 0) {
                 if (m_strictMode) {
@@ -700,63 +1145,59 @@ Entry* KdbxXmlReader::parseEntry(bool history)
                 iconId = 0;
             }
             entry->setIcon(iconId);
-            continue;
+            break;
         }
-        if (m_xml.name() == "CustomIconUUID") {
+        case XmlElement::CustomIconUUID: {
             QUuid uuid = readUuid();
             if (!uuid.isNull()) {
                 entry->setIcon(uuid);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "ForegroundColor") {
+        case XmlElement::ForegroundColor:
             entry->setForegroundColor(readColor());
-            continue;
-        }
-        if (m_xml.name() == "BackgroundColor") {
+            break;
+        case XmlElement::BackgroundColor:
             entry->setBackgroundColor(readColor());
-            continue;
-        }
-        if (m_xml.name() == "OverrideURL") {
+            break;
+        case XmlElement::OverrideURL:
             entry->setOverrideUrl(readString());
-            continue;
-        }
-        if (m_xml.name() == "Tags") {
+            break;
+        case XmlElement::Tags:
             entry->setTags(readString());
-            continue;
-        }
-        if (m_xml.name() == "Times") {
+            break;
+        case XmlElement::Times:
             entry->setTimeInfo(parseTimes());
-            continue;
-        }
-        if (m_xml.name() == "String") {
+            break;
+        case XmlElement::String:
             parseEntryString(entry);
-            continue;
-        }
-        if (m_xml.name() == "Binary") {
+            break;
+        case XmlElement::Binary: {
             QPair<QString, QString> ref = parseEntryBinary(entry);
             if (!ref.first.isEmpty() && !ref.second.isEmpty()) {
                 binaryRefs.append(ref);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "AutoType") {
+        case XmlElement::AutoType:
             parseAutoType(entry);
-            continue;
-        }
-        if (m_xml.name() == "History") {
+            break;
+        case XmlElement::History:
             if (history) {
                 raiseError(tr("History element in history entry"));
+            } else if (m_metadataOnly) {
+                skipProtectedElement();
             } else {
                 historyItems = parseEntryHistory();
             }
-            continue;
-        }
-        if (m_xml.name() == "CustomData") {
+            break;
+        case XmlElement::CustomData:
             parseCustomData(entry->customData());
-            continue;
+            break;
+        default:
+            skipCurrentElement();
+            break;
         }
-        skipCurrentElement();
     }
 
     if (entry->uuid().isNull() && !m_strictMode) {
@@ -803,28 +1244,40 @@ void KdbxXmlReader::parseEntryString(Entry* entry)
 
     QString key;
     QString value;
+    QByteArray ciphertext;
+    quint64 ciphertextOffset = 0;
     bool protect = false;
     bool keySet = false;
     bool valueSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Key") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::Key:
             key = readString();
             keySet = true;
-            continue;
-        }
+            break;
+        case XmlElement::Value: {
+            if (m_protectedValueSource && isTrueValue(m_xml.attributes().value(QLatin1String("Protected")))) {
+                // only remember where the value is in the random stream
+                ciphertext = QByteArray::fromBase64(m_xml.readElementText().toLatin1());
+                ciphertextOffset = m_protectedOffset;
+                m_protectedOffset += static_cast<quint64>(ciphertext.size());
+                protect = true;
+                valueSet = true;
+                break;
+            }
 
-        if (m_xml.name() == "Value") {
-            QXmlStreamAttributes attr = m_xml.attributes();
             bool isProtected;
             bool protectInMemory;
             value = readString(isProtected, protectInMemory);
             protect = isProtected || protectInMemory;
             valueSet = true;
-            continue;
+            break;
+        }
+        default:
+            skipCurrentElement();
+            break;
         }
-
-        skipCurrentElement();
     }
 
     if (keySet && valueSet) {
@@ -833,7 +1286,11 @@ void KdbxXmlReader::parseEntryString(Entry* entry)
             raiseError(tr("Duplicate custom attribute found"));
             return;
         }
-        entry->attributes()->set(key, value, protect);
+        if (!ciphertext.isEmpty()) {
+            entry->attributes()->setDeferred(key, m_protectedValueSource, ciphertext, ciphertextOffset);
+        } else {
+            entry->attributes()->set(key, value, protect);
+        }
         return;
     }
 
@@ -852,16 +1309,16 @@ QPair<QString, QString> KdbxXmlReader::parseEntryBinary(Entry* entry)
     bool valueSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Key") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::Key:
             key = readString();
             keySet = true;
-            continue;
-        }
-        if (m_xml.name() == "Value") {
+            break;
+        case XmlElement::Value: {
             QXmlStreamAttributes attr = m_xml.attributes();
 
-            if (attr.hasAttribute("Ref")) {
-                poolRef = qMakePair(attr.value("Ref").toString(), key);
+            if (attr.hasAttribute(QLatin1String("Ref"))) {
+                poolRef = qMakePair(attr.value(QLatin1String("Ref")).toString(), key);
                 m_xml.skipCurrentElement();
             } else {
                 // format compatibility
@@ -869,9 +1326,12 @@ QPair<QString, QString> KdbxXmlReader::parseEntryBinary(Entry* entry)
             }
 
             valueSet = true;
-            continue;
+            break;
+        }
+        default:
+            skipCurrentElement();
+            break;
         }
-        skipCurrentElement();
     }
 
     if (keySet && valueSet) {
@@ -894,16 +1354,22 @@ void KdbxXmlReader::parseAutoType(Entry* entry)
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "AutoType");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Enabled") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::Enabled:
             entry->setAutoTypeEnabled(readBool());
-        } else if (m_xml.name() == "DataTransferObfuscation") {
+            break;
+        case XmlElement::DataTransferObfuscation:
             entry->setAutoTypeObfuscation(readNumber());
-        } else if (m_xml.name() == "DefaultSequence") {
+            break;
+        case XmlElement::DefaultSequence:
             entry->setDefaultAutoTypeSequence(readString());
-        } else if (m_xml.name() == "Association") {
+            break;
+        case XmlElement::Association:
             parseAutoTypeAssoc(entry);
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 }
@@ -917,14 +1383,18 @@ void KdbxXmlReader::parseAutoTypeAssoc(Entry* entry)
     bool sequenceSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Window") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::Window:
             assoc.window = readString();
             windowSet = true;
-        } else if (m_xml.name() == "KeystrokeSequence") {
+            break;
+        case XmlElement::KeystrokeSequence:
             assoc.sequence = readString();
             sequenceSet = true;
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 
@@ -942,10 +1412,13 @@ QList<Entry*> KdbxXmlReader::parseEntryHistory()
     QList<Entry*> historyItems;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Entry") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::Entry:
             historyItems.append(parseEntry(true));
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 
@@ -958,22 +1431,31 @@ TimeInfo KdbxXmlReader::parseTimes()
 
     TimeInfo timeInfo;
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "LastModificationTime") {
-            timeInfo.setLastModificationTime(readDateTime());
-        } else if (m_xml.name() == "CreationTime") {
-            timeInfo.setCreationTime(readDateTime());
-        } else if (m_xml.name() == "LastAccessTime") {
-            timeInfo.setLastAccessTime(readDateTime());
-        } else if (m_xml.name() == "ExpiryTime") {
-            timeInfo.setExpiryTime(readDateTime());
-        } else if (m_xml.name() == "Expires") {
+        switch (elementId(m_xml.name())) {
+        case XmlElement::LastModificationTime:
+            timeInfo.setLastModificationTime(readTimestamp());
+            break;
+        case XmlElement::CreationTime:
+            timeInfo.setCreationTime(readTimestamp());
+            break;
+        case XmlElement::LastAccessTime:
+            timeInfo.setLastAccessTime(readTimestamp());
+            break;
+        case XmlElement::ExpiryTime:
+            timeInfo.setExpiryTime(readTimestamp());
+            break;
+        case XmlElement::Expires:
             timeInfo.setExpires(readBool());
-        } else if (m_xml.name() == "UsageCount") {
+            break;
+        case XmlElement::UsageCount:
             timeInfo.setUsageCount(readNumber());
-        } else if (m_xml.name() == "LocationChanged") {
-            timeInfo.setLocationChanged(readDateTime());
-        } else {
+            break;
+        case XmlElement::LocationChanged:
+            timeInfo.setLocationChanged(readTimestamp());
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 
@@ -991,21 +1473,18 @@ QString KdbxXmlReader::readString()
 QString KdbxXmlReader::readString(bool& isProtected, bool& protectInMemory)
 {
     QXmlStreamAttributes attr = m_xml.attributes();
-    isProtected = isTrueValue(attr.value("Protected"));
-    protectInMemory = isTrueValue(attr.value("ProtectInMemory"));
+    isProtected = isTrueValue(attr.value(QLatin1String("Protected")));
+    protectInMemory = isTrueValue(attr.value(QLatin1String("ProtectInMemory")));
     QString value = m_xml.readElementText();
 
     if (isProtected && !value.isEmpty()) {
-        QByteArray ciphertext = QByteArray::fromBase64(value.toLatin1());
-        bool ok;
-        QByteArray plaintext = m_randomStream->process(ciphertext, &ok);
-        if (!ok) {
+        QByteArray data = QByteArray::fromBase64(value.toLatin1());
+        if (!decryptProtected(data)) {
             value.clear();
-            raiseError(m_randomStream->errorString());
             return value;
         }
 
-        value = QString::fromUtf8(plaintext);
+        value = QString::fromUtf8(data);
     }
 
     return value;
@@ -1015,10 +1494,10 @@ bool KdbxXmlReader::readBool()
 {
     QString str = readString();
 
-    if (str.compare("true", Qt::CaseInsensitive) == 0) {
+    if (str.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0) {
         return true;
     }
-    if (str.compare("false", Qt::CaseInsensitive) == 0) {
+    if (str.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0) {
         return false;
     }
     if (str.length() == 0) {
@@ -1030,23 +1509,47 @@ bool KdbxXmlReader::readBool()
 
 QDateTime KdbxXmlReader::readDateTime()
 {
-    QString str = readString();
-    if (Tools::isBase64(str.toLatin1())) {
-        QByteArray secsBytes = QByteArray::fromBase64(str.toUtf8()).leftJustified(8, '\0', true).left(8);
-        qint64 secs = Endian::bytesToSizedInt<quint64>(secsBytes, KeePass2::BYTEORDER);
-        return QDateTime(QDate(1, 1, 1), QTime(0, 0, 0, 0), Qt::UTC).addSecs(secs);
+    return TimeInfo::toDateTime(readTimestamp());
+}
+
+/**
+ * Read a date time as milliseconds since the epoch in UTC, like the
+ * TimeInfo of entries and groups stores them.
+ */
+qint64 KdbxXmlReader::readTimestamp()
+{
+    QString str;
+    if (m_xml.attributes().isEmpty()) {
+        char secsBytes[8];
+        if (readFixedBase64(secsBytes, sizeof(secsBytes), str)) {
+            return kdbxSecondsToMSecs(Endian::bytesToSizedInt<quint64>(
+                QByteArray::fromRawData(secsBytes, sizeof(secsBytes)), KeePass2::BYTEORDER));
+        }
+    } else {
+        str = readString();
+    }
+
+    QByteArray latin1 = str.toLatin1();
+    if (Tools::isBase64(latin1)) {
+        QByteArray secsBytes = QByteArray::fromBase64(latin1).leftJustified(8, '\0', true).left(8);
+        return kdbxSecondsToMSecs(Endian::bytesToSizedInt<quint64>(secsBytes, KeePass2::BYTEORDER));
+    }
+
+    qint64 msecs;
+    if (parseUtcTime(str, &msecs)) {
+        return msecs;
     }
 
     QDateTime dt = Clock::parse(str, Qt::ISODate);
     if (dt.isValid()) {
-        return dt;
+        return dt.toMSecsSinceEpoch();
     }
 
     if (m_strictMode) {
         raiseError(tr("Invalid date time value"));
     }
 
-    return Clock::currentDateTimeUtc();
+    return Clock::currentDateTimeUtc().toMSecsSinceEpoch();
 }
 
 QString KdbxXmlReader::readColor()
@@ -1091,7 +1594,18 @@ int KdbxXmlReader::readNumber()
 
 QUuid KdbxXmlReader::readUuid()
 {
-    QByteArray uuidBin = readBinary();
+    QByteArray uuidBin;
+    if (m_xml.attributes().isEmpty()) {
+        char uuidBytes[UUID_LENGTH];
+        QString text;
+        if (readFixedBase64(uuidBytes, UUID_LENGTH, text)) {
+            return QUuid::fromRfc4122(QByteArray::fromRawData(uuidBytes, UUID_LENGTH));
+        }
+        uuidBin = QByteArray::fromBase64(text.toLatin1());
+    } else {
+        uuidBin = readBinary();
+    }
+
     if (uuidBin.isEmpty()) {
         return QUuid();
     }
@@ -1107,38 +1621,88 @@ QUuid KdbxXmlReader::readUuid()
 QByteArray KdbxXmlReader::readBinary()
 {
     QXmlStreamAttributes attr = m_xml.attributes();
-    bool isProtected = isTrueValue(attr.value("Protected"));
+    bool isProtected = isTrueValue(attr.value(QLatin1String("Protected")));
     QString value = m_xml.readElementText();
     QByteArray data = QByteArray::fromBase64(value.toLatin1());
 
-    if (isProtected && !data.isEmpty()) {
-        bool ok;
-        QByteArray plaintext = m_randomStream->process(data, &ok);
-        if (!ok) {
-            data.clear();
-            raiseError(m_randomStream->errorString());
-            return data;
+    if (isProtected && !data.isEmpty() && !decryptProtected(data)) {
+        data.clear();
+    }
+
+    return data;
+}
+
+/**
+ * Read the text of the current element and decode it as base64 of a
+ * fixed size straight from the buffer of the XML reader. Falls back to
+ * returning the text if the element does not hold exactly one piece of
+ * base64 encoded text of that size.
+ *
+ * @param out buffer for the decoded bytes
+ * @param size number of bytes to decode
+ * @param text receives the element text if it could not be decoded
+ * @return true if the element text was decoded into out
+ */
+bool KdbxXmlReader::readFixedBase64(char* out, int size, QString& text)
+{
+    text.clear();
+    bool decoded = false;
+    while (m_xml.readNext() != QXmlStreamReader::EndElement) {
+        if (m_xml.isCharacters()) {
+            if (!decoded && text.isEmpty()) {
+                decoded = decodeFixedBase64(m_xml.text(), out, size);
+                if (!decoded) {
+                    text = m_xml.text().toString();
+                }
+            } else {
+                if (decoded) {
+                    text = QString::fromLatin1(QByteArray::fromRawData(out, size).toBase64());
+                    decoded = false;
+                }
+                text.append(m_xml.text());
+            }
+        } else if (m_xml.isStartElement()) {
+            m_xml.raiseError(tr("Expected character data."));
+            return false;
+        } else if (m_xml.hasError()) {
+            return false;
         }
+    }
+    return decoded;
+}
 
+/**
+ * Decrypt a protected value in place with the inner random stream.
+ *
+ * @param data ciphertext, replaced by the plaintext
+ * @return true on success
+ */
+bool KdbxXmlReader::decryptProtected(QByteArray& data)
+{
+    if (m_protectedValueSource) {
+        QByteArray plaintext = m_protectedValueSource->decrypt(data, m_protectedOffset);
+        m_protectedOffset += static_cast<quint64>(data.size());
+        if (plaintext.isNull()) {
+            raiseError(tr("Unable to decrypt protected value"));
+            return false;
+        }
         data = plaintext;
+        return true;
     }
 
-    return data;
+    if (!m_randomStream->processInPlace(data)) {
+        raiseError(m_randomStream->errorString());
+        return false;
+    }
+    return true;
 }
 
 QByteArray KdbxXmlReader::readCompressedBinary()
 {
     QByteArray rawData = readBinary();
 
-    QBuffer buffer(&rawData);
-    buffer.open(QIODevice::ReadOnly);
-
-    QtIOCompressor compressor(&buffer);
-    compressor.setStreamFormat(QtIOCompressor::GzipFormat);
-    compressor.open(QIODevice::ReadOnly);
-
     QByteArray result;
-    if (!Tools::readAllFromDevice(&compressor, result)) {
+    if (!GzipCodec::decompress(rawData, result)) {
         //: Translator meant is a binary data inside an entry
         raiseError(tr("Unable to decompress binary"));
     }
@@ -1186,3 +1750,37 @@ void KdbxXmlReader::skipCurrentElement()
     qWarning("KdbxXmlReader::skipCurrentElement: skip element \"%s\"", qPrintable(m_xml.name().toString()));
     m_xml.skipCurrentElement();
 }
+
+/**
+ * Skip the current element and its children without parsing them. The
+ * protected values inside it are still decoded to keep the position in
+ * the inner random stream, but they are not decrypted.
+ */
+void KdbxXmlReader::skipProtectedElement()
+{
+    int depth = 1;
+    while (!m_xml.hasError() && depth > 0) {
+        switch (m_xml.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            if (!isTrueValue(m_xml.attributes().value(QLatin1String("Protected")))) {
+                ++depth;
+                break;
+            }
+            // reading the text also consumes the end element
+            const auto size = QByteArray::fromBase64(m_xml.readElementText().toLatin1()).size();
+            if (m_protectedValueSource) {
+                m_protectedOffset += static_cast<quint64>(size);
+            } else if (size > 0 && !m_randomStream->skip(static_cast<quint64>(size))) {
+                raiseError(m_randomStream->errorString());
+                return;
+            }
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            --depth;
+            break;
+        default:
+            break;
+        }
+    }
+}
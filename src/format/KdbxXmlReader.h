@@ -24,9 +24,12 @@
 
 #include <QCoreApplication>
 #include <QPair>
+#include <QSharedPointer>
 #include <QString>
 #include <QXmlStreamReader>
 
+class AttachmentSource;
+class ProtectedValueSource;
 class QIODevice;
 class Group;
 class Entry;
@@ -56,6 +59,10 @@ public:
     bool strictMode() const;
     void setStrictMode(bool strictMode);
 
+    void setAttachmentSource(QSharedPointer<const AttachmentSource> source);
+    void setProtectedValueSource(QSharedPointer<const ProtectedValueSource> source);
+    void setMetadataOnly(bool metadataOnly);
+
 protected:
     typedef QPair<QString, QString> StringPair;
 
@@ -83,13 +90,18 @@ protected:
     virtual QString readString(bool& isProtected, bool& protectInMemory);
     virtual bool readBool();
     virtual QDateTime readDateTime();
+    virtual qint64 readTimestamp();
     virtual QString readColor();
     virtual int readNumber();
     virtual QUuid readUuid();
     virtual QByteArray readBinary();
     virtual QByteArray readCompressedBinary();
+    bool readFixedBase64(char* out, int size, QString& text);
 
     virtual void skipCurrentElement();
+    void skipProtectedElement();
+
+    bool decryptProtected(QByteArray& data);
 
     virtual Group* getGroup(const QUuid& uuid);
     virtual Entry* getEntry(const QUuid& uuid);
@@ -100,6 +112,7 @@ protected:
     const quint32 m_kdbxVersion;
 
     bool m_strictMode = false;
+    bool m_metadataOnly = false;
 
     QPointer<Database> m_db;
     QPointer<Metadata> m_meta;
@@ -111,6 +124,9 @@ protected:
     QHash<QUuid, Entry*> m_entries;
 
     QHash<QString, QByteArray> m_binaryPool;
+    QSharedPointer<const AttachmentSource> m_attachmentSource;
+    QSharedPointer<const ProtectedValueSource> m_protectedValueSource;
+    quint64 m_protectedOffset = 0;
     QHash<QString, QPair<Entry*, QString>> m_binaryMap;
     QByteArray m_headerHash;
 
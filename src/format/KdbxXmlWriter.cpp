@@ -17,19 +17,50 @@
 
 #include "KdbxXmlWriter.h"
 
-#include <QBuffer>
 #include <QFile>
 
+#include "core/AttachmentStore.h"
 #include "core/Endian.h"
 #include "core/Metadata.h"
 #include "format/KeePass2RandomStream.h"
-#include "streams/QtIOCompressor"
+#include "streams/GzipCodec.h"
+#include "streams/RecordingStream.h"
+
+namespace
+{
+    // multiple of 3, so the base64 encoded chunks can simply be concatenated
+    const int Base64ChunkSize = 3 * 16 * 1024;
+    // number of buffered characters after which the XML text is flushed to the output
+    const int TextFlushThreshold = 256 * 1024;
+
+    /**
+     * Check whether text can be appended to the XML output as is, i.e. it
+     * neither has to be escaped nor contains characters that are stripped.
+     */
+    bool isPlainXmlText(const QString& text)
+    {
+        const ushort* data = text.utf16();
+        const ushort* end = data + text.size();
+        for (; data != end; ++data) {
+            const ushort uc = *data;
+            if (uc >= 0x20 && uc < 0x7F) {
+                if (uc == '<' || uc == '>' || uc == '&' || uc == '"') {
+                    return false;
+                }
+            } else if (uc != 0x09 && uc != 0x0A && (uc < 0xA0 || (uc >= 0xD800 && uc <= 0xDFFF) || uc > 0xFFFD)) {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
 
 /**
  * @param version KDBX version
  */
 KdbxXmlWriter::KdbxXmlWriter(quint32 version)
     : m_kdbxVersion(version)
+    , m_xml(&m_text)
 {
 }
 
@@ -45,12 +76,33 @@ void KdbxXmlWriter::writeDatabase(QIODevice* device,
 
     m_xml.setAutoFormatting(true);
     m_xml.setAutoFormattingIndent(-1); // 1 tab
-    m_xml.setCodec("UTF-8");
+    m_text.clear();
+    m_text.reserve(TextFlushThreshold + Base64ChunkSize * 2);
 
     generateIdMap();
 
-    m_xml.setDevice(device);
-    m_xml.writeStartDocument("1.0", true);
+    // Fragments contain the encrypted protected values as inserts only, so
+    // they are not used for plaintext output.
+    QScopedPointer<RecordingStream> recorder;
+    if (m_fragmentCache && m_randomStream && !m_innerStreamProtectionDisabled) {
+        quint64 context = m_kdbxVersion;
+        context |= static_cast<quint64>(m_meta->protectTitle()) << 32;
+        context |= static_cast<quint64>(m_meta->protectUsername()) << 33;
+        context |= static_cast<quint64>(m_meta->protectPassword()) << 34;
+        context |= static_cast<quint64>(m_meta->protectUrl()) << 35;
+        context |= static_cast<quint64>(m_meta->protectNotes()) << 36;
+        m_fragmentCache->setContext(context);
+
+        recorder.reset(new RecordingStream(device));
+        recorder->open(QIODevice::WriteOnly);
+        m_recorder = recorder.data();
+        m_output = m_recorder;
+    } else {
+        m_output = device;
+    }
+
+    // a writer on a string omits the encoding from the declaration
+    m_text.append(R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)");
     m_xml.writeStartElement("KeePassFile");
 
     writeMetadata();
@@ -58,10 +110,17 @@ void KdbxXmlWriter::writeDatabase(QIODevice* device,
 
     m_xml.writeEndElement();
     m_xml.writeEndDocument();
+    flushText();
 
-    if (m_xml.hasError()) {
-        raiseError(device->errorString());
+    if (m_recorder) {
+        if (m_error) {
+            m_fragmentCache->clear();
+        }
+        m_recorder = nullptr;
     }
+    m_output = nullptr;
+    m_text.clear();
+    m_text.squeeze();
 }
 
 void KdbxXmlWriter::writeDatabase(const QString& filename, Database* db)
@@ -83,20 +142,60 @@ QString KdbxXmlWriter::errorString()
 
 void KdbxXmlWriter::generateIdMap()
 {
-    const QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive(true);
-    int nextId = 0;
+    m_binaries = m_db->attachmentPool();
+    m_idMap.clear();
+    m_deferredIdMap.clear();
 
-    for (Entry* entry : allEntries) {
-        const QList<QString> attachmentKeys = entry->attachments()->keys();
-        for (const QString& key : attachmentKeys) {
-            QByteArray data = entry->attachments()->value(key);
-            if (!m_idMap.contains(data)) {
-                m_idMap.insert(data, nextId++);
-            }
+    // digests are cached by the store, so unchanged attachments are not hashed again
+    AttachmentStore* store = m_db->attachmentStore();
+    for (int i = 0; i < m_binaries.size(); ++i) {
+        const AttachmentValue& binary = m_binaries.at(i);
+        if (binary.isDeferred()) {
+            m_deferredIdMap.insert(qMakePair(binary.source.data(), binary.index), i);
+        } else {
+            m_idMap.insert(store->digest(binary.data), i);
         }
     }
 }
 
+int KdbxXmlWriter::attachmentId(const AttachmentValue& attachment) const
+{
+    if (attachment.isDeferred()) {
+        return m_deferredIdMap.value(qMakePair(attachment.source.data(), attachment.index));
+    }
+    return m_idMap.value(m_db->attachmentStore()->digest(attachment.data));
+}
+
+/**
+ * Current value of the attribute a fragment insert refers to. The
+ * fragment cache has verified that the entry and its history did not
+ * change since the fragment was recorded.
+ */
+QString KdbxXmlWriter::insertAttribute(const KdbxXmlFragment::Insert& insert) const
+{
+    if (insert.historyIndex < 0) {
+        return insert.entry->attributes()->value(insert.key);
+    }
+    if (insert.entry->hasCompactHistory()) {
+        return insert.entry->historySnapshots().at(insert.historyIndex).attributeValue(insert.key);
+    }
+    return insert.entry->historyItems().at(insert.historyIndex)->attributes()->value(insert.key);
+}
+
+/**
+ * Attachment a fragment insert refers to, deferred attachments are not read.
+ */
+AttachmentValue KdbxXmlWriter::insertAttachment(const KdbxXmlFragment::Insert& insert) const
+{
+    if (insert.historyIndex < 0) {
+        return insert.entry->attachments()->valueRef(insert.key);
+    }
+    if (insert.entry->hasCompactHistory()) {
+        return insert.entry->historySnapshots().at(insert.historyIndex).attachmentValue(insert.key);
+    }
+    return insert.entry->historyItems().at(insert.historyIndex)->attachments()->valueRef(insert.key);
+}
+
 void KdbxXmlWriter::writeMetadata()
 {
     m_xml.writeStartElement("Meta");
@@ -156,25 +255,18 @@ void KdbxXmlWriter::writeCustomIcons()
 
     const QList<QUuid> customIconsOrder = m_meta->customIconsOrder();
     for (const QUuid& uuid : customIconsOrder) {
-        writeIcon(uuid, m_meta->customIcon(uuid));
+        writeIcon(uuid, m_meta->customIconData(uuid));
     }
 
     m_xml.writeEndElement();
 }
 
-void KdbxXmlWriter::writeIcon(const QUuid& uuid, const QImage& icon)
+void KdbxXmlWriter::writeIcon(const QUuid& uuid, const QByteArray& iconData)
 {
     m_xml.writeStartElement("Icon");
 
     writeUuid("UUID", uuid);
-
-    QByteArray ba;
-    QBuffer buffer(&ba);
-    buffer.open(QIODevice::WriteOnly);
-    // TODO: check !icon.save()
-    icon.save(&buffer, "PNG");
-    buffer.close();
-    writeBinary("Data", ba);
+    writeBinary("Data", iconData);
 
     m_xml.writeEndElement();
 }
@@ -183,43 +275,82 @@ void KdbxXmlWriter::writeBinaries()
 {
     m_xml.writeStartElement("Binaries");
 
-    QHash<QByteArray, int>::const_iterator i;
-    for (i = m_idMap.constBegin(); i != m_idMap.constEnd(); ++i) {
+    for (int i = 0; i < m_binaries.size(); ++i) {
+        const QByteArray binary = m_binaries.at(i).read();
+        if (m_binaries.at(i).isDeferred() && binary.size() != m_binaries.at(i).size()) {
+            raiseError(QObject::tr("Unable to read attachment data from the database file."));
+            return;
+        }
         m_xml.writeStartElement("Binary");
 
-        m_xml.writeAttribute("ID", QString::number(i.value()));
+        m_xml.writeAttribute("ID", QString::number(i));
 
         QByteArray data;
         if (m_db->compressionAlgorithm() == Database::CompressionGZip) {
             m_xml.writeAttribute("Compressed", "True");
 
-            QBuffer buffer;
-            buffer.open(QIODevice::ReadWrite);
-
-            QtIOCompressor compressor(&buffer);
-            compressor.setStreamFormat(QtIOCompressor::GzipFormat);
-            compressor.open(QIODevice::WriteOnly);
-
-            qint64 bytesWritten = compressor.write(i.key());
-            Q_ASSERT(bytesWritten == i.key().size());
-            Q_UNUSED(bytesWritten);
-            compressor.close();
-
-            buffer.seek(0);
-            data = buffer.readAll();
+            data = GzipCodec::compress(binary);
+            Q_ASSERT(!data.isNull());
         } else {
-            data = i.key();
+            data = binary;
         }
 
-        if (!data.isEmpty()) {
-            m_xml.writeCharacters(QString::fromLatin1(data.toBase64()));
-        }
+        writeBase64Characters(data);
         m_xml.writeEndElement();
     }
 
     m_xml.writeEndElement();
 }
 
+/**
+ * Write binary data as base64 encoded element text. The data is encoded
+ * in chunks, so large attachments are never held as one huge string.
+ *
+ * @param data binary data
+ */
+void KdbxXmlWriter::writeBase64Characters(const QByteArray& data)
+{
+    for (int offset = 0; offset < data.size(); offset += Base64ChunkSize) {
+        const int length = qMin(Base64ChunkSize, data.size() - offset);
+        const QByteArray chunk = QByteArray::fromRawData(data.constData() + offset, length);
+        writeBase64Text(chunk.toBase64());
+    }
+}
+
+/**
+ * Write element text, escaping it only if it contains markup characters
+ * or characters that are invalid in XML 1.0.
+ *
+ * @param text element text
+ */
+void KdbxXmlWriter::writeText(const QString& text)
+{
+    if (!isPlainXmlText(text)) {
+        m_xml.writeCharacters(stripInvalidXml10Chars(text));
+        return;
+    }
+    // an empty write closes the start tag without any output
+    m_xml.writeCharacters(QString());
+    m_text.append(text);
+    if (m_text.size() >= TextFlushThreshold) {
+        flushText();
+    }
+}
+
+/**
+ * Write base64 encoded element text straight into the output buffer.
+ *
+ * @param base64 base64 encoded data
+ */
+void KdbxXmlWriter::writeBase64Text(const QByteArray& base64)
+{
+    m_xml.writeCharacters(QString());
+    m_text.append(QLatin1String(base64.constData(), base64.size()));
+    if (m_text.size() >= TextFlushThreshold) {
+        flushText();
+    }
+}
+
 void KdbxXmlWriter::writeCustomData(const CustomData* customData)
 {
     if (customData->isEmpty()) {
@@ -261,6 +392,18 @@ void KdbxXmlWriter::writeGroup(const Group* group)
 {
     Q_ASSERT(!group->uuid().isNull());
 
+    // The start tag of the root group directly follows the still open
+    // start tag of the Root element, so the root group is always written
+    // from scratch. All groups below it may come from the fragment cache.
+    if (m_recorder && group != m_db->rootGroup()) {
+        writeCachedGroup(group);
+    } else {
+        writeGroupElement(group);
+    }
+}
+
+void KdbxXmlWriter::writeGroupElement(const Group* group)
+{
     m_xml.writeStartElement("Group");
 
     writeUuid("UUID", group->uuid());
@@ -291,11 +434,89 @@ void KdbxXmlWriter::writeGroup(const Group* group)
     }
 
     const QList<Group*>& children = group->children();
+    ++m_groupDepth;
     for (const Group* child : children) {
         writeGroup(child);
     }
+    --m_groupDepth;
+
+    m_xml.writeEndElement();
+}
+
+/**
+ * Write a group through the fragment cache. The group is spliced in from
+ * its cached fragment if it is still valid, otherwise it is serialized
+ * and its fragment is recorded for the next save.
+ *
+ * @param group group to write
+ */
+void KdbxXmlWriter::writeCachedGroup(const Group* group)
+{
+    KdbxXmlFragment* parentFragment = m_fragment;
+    beginInsert(KdbxXmlFragment::InsertType::ChildGroup, group);
+    m_fragment = nullptr;
+
+    QSharedPointer<const KdbxXmlFragment> cached = m_fragmentCache->fragment(group, m_groupDepth);
+    if (cached) {
+        writeFragment(*cached);
+    } else {
+        KdbxXmlFragment fragment;
+        m_fragment = &fragment;
+        setRecordBuffer(&fragment.data);
+        writeGroupElement(group);
+        setRecordBuffer(nullptr);
+
+        if (!m_error) {
+            m_fragmentCache->insert(group, m_groupDepth, fragment);
+        }
+    }
+
+    m_fragment = parentFragment;
+    endInsert();
+}
+
+/**
+ * Splice a cached group fragment into the output and write its inserts.
+ *
+ * @param fragment cached fragment
+ */
+void KdbxXmlWriter::writeFragment(const KdbxXmlFragment& fragment)
+{
+    // Open the group in the XML writer without producing any output, so
+    // child groups that have to be serialized again are indented correctly
+    // and the writer ends up in the same state as after writing the group.
+    setDiscarding(true);
+    m_xml.writeStartElement("Group");
+    m_xml.writeStartElement("UUID");
+    m_xml.writeEndElement();
+    setDiscarding(false);
+
+    ++m_groupDepth;
+    int pos = 0;
+    for (const KdbxXmlFragment::Insert& insert : fragment.inserts) {
+        writeRaw(QByteArray::fromRawData(fragment.data.constData() + pos, insert.offset - pos));
+        pos = insert.offset;
+
+        switch (insert.type) {
+        case KdbxXmlFragment::InsertType::ChildGroup:
+            writeGroup(insert.group);
+            break;
+        case KdbxXmlFragment::InsertType::ProtectedValue: {
+            const QByteArray value = protectedValue(insertAttribute(insert));
+            writeRaw(value.isEmpty() ? QByteArray("/>") : ">" + value + "</Value>");
+            break;
+        }
+        case KdbxXmlFragment::InsertType::AttachmentRef:
+            writeRaw(" Ref=\"" + QByteArray::number(attachmentId(insertAttachment(insert))) + "\"");
+            break;
+        }
+    }
+    writeRaw(QByteArray::fromRawData(fragment.data.constData() + pos, fragment.data.size() - pos));
+    --m_groupDepth;
 
+    setDiscarding(true);
     m_xml.writeEndElement();
+    setDiscarding(false);
 }
 
 void KdbxXmlWriter::writeTimes(const TimeInfo& ti)
@@ -368,29 +589,26 @@ void KdbxXmlWriter::writeEntry(const Entry* entry)
         writeString("Key", key);
 
         m_xml.writeStartElement("Value");
-        QString value;
-
-        if (protect) {
-            if (!m_innerStreamProtectionDisabled && m_randomStream) {
-                m_xml.writeAttribute("Protected", "True");
-                bool ok;
-                QByteArray rawData = m_randomStream->process(entry->attributes()->value(key).toUtf8(), &ok);
-                if (!ok) {
-                    raiseError(m_randomStream->errorString());
-                }
-                value = QString::fromLatin1(rawData.toBase64());
-            } else {
-                m_xml.writeAttribute("ProtectInMemory", "True");
-                value = entry->attributes()->value(key);
+        const QString value = entry->attributes()->value(key);
+
+        if (protect && !m_innerStreamProtectionDisabled && m_randomStream) {
+            m_xml.writeAttribute("Protected", "True");
+            // the inner stream key changes with every save
+            beginInsert(KdbxXmlFragment::InsertType::ProtectedValue, nullptr, entry, key);
+            const QByteArray encrypted = protectedValue(value);
+            if (!encrypted.isEmpty()) {
+                writeBase64Text(encrypted);
             }
         } else {
-            value = entry->attributes()->value(key);
-        }
-
-        if (!value.isEmpty()) {
-            m_xml.writeCharacters(stripInvalidXml10Chars(value));
+            if (protect) {
+                m_xml.writeAttribute("ProtectInMemory", "True");
+            }
+            if (!value.isEmpty()) {
+                writeText(value);
+            }
         }
         m_xml.writeEndElement();
+        endInsert();
 
         m_xml.writeEndElement();
     }
@@ -402,7 +620,10 @@ void KdbxXmlWriter::writeEntry(const Entry* entry)
         writeString("Key", key);
 
         m_xml.writeStartElement("Value");
-        m_xml.writeAttribute("Ref", QString::number(m_idMap[entry->attachments()->value(key)]));
+        // attachment ids depend on the attachments of all entries
+        beginInsert(KdbxXmlFragment::InsertType::AttachmentRef, nullptr, entry, key);
+        m_xml.writeAttribute("Ref", QString::number(attachmentId(entry->attachments()->valueRef(key))));
+        endInsert();
         m_xml.writeEndElement();
 
         m_xml.writeEndElement();
@@ -452,20 +673,40 @@ void KdbxXmlWriter::writeEntryHistory(const Entry* entry)
 {
     m_xml.writeStartElement("History");
 
-    const QList<Entry*>& historyItems = entry->historyItems();
-    for (const Entry* item : historyItems) {
+    m_historyOwner = entry;
+    m_historyIndex = 0;
+    entry->forEachHistoryItem([this](const Entry* item) {
         writeEntry(item);
-    }
+        ++m_historyIndex;
+        return true;
+    });
+    m_historyOwner = nullptr;
+    m_historyIndex = -1;
 
     m_xml.writeEndElement();
 }
 
+/**
+ * @return value encrypted with the inner random stream, base64 encoded
+ */
+QByteArray KdbxXmlWriter::protectedValue(const QString& value)
+{
+    bool ok;
+    QByteArray rawData = m_randomStream->process(value.toUtf8(), &ok);
+    if (!ok) {
+        raiseError(m_randomStream->errorString());
+    }
+    return rawData.toBase64();
+}
+
 void KdbxXmlWriter::writeString(const QString& qualifiedName, const QString& string)
 {
     if (string.isEmpty()) {
         m_xml.writeEmptyElement(qualifiedName);
     } else {
-        m_xml.writeTextElement(qualifiedName, stripInvalidXml10Chars(string));
+        m_xml.writeStartElement(qualifiedName);
+        writeText(string);
+        m_xml.writeEndElement();
     }
 }
 
@@ -488,25 +729,23 @@ void KdbxXmlWriter::writeDateTime(const QString& qualifiedName, const QDateTime&
     Q_ASSERT(dateTime.isValid());
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
 
-    QString dateTimeStr;
     if (m_kdbxVersion < KeePass2::FILE_VERSION_4) {
-        dateTimeStr = dateTime.toString(Qt::ISODate);
+        QString dateTimeStr = dateTime.toString(Qt::ISODate);
 
         // Qt < 4.8 doesn't append a 'Z' at the end
         if (!dateTimeStr.isEmpty() && dateTimeStr[dateTimeStr.size() - 1] != 'Z') {
             dateTimeStr.append('Z');
         }
+        writeString(qualifiedName, dateTimeStr);
     } else {
         qint64 secs = QDateTime(QDate(1, 1, 1), QTime(0, 0, 0, 0), Qt::UTC).secsTo(dateTime);
-        QByteArray secsBytes = Endian::sizedIntToBytes(secs, KeePass2::BYTEORDER);
-        dateTimeStr = QString::fromLatin1(secsBytes.toBase64());
+        writeBinary(qualifiedName, Endian::sizedIntToBytes(secs, KeePass2::BYTEORDER));
     }
-    writeString(qualifiedName, dateTimeStr);
 }
 
 void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const QUuid& uuid)
 {
-    writeString(qualifiedName, uuid.toRfc4122().toBase64());
+    writeBinary(qualifiedName, uuid.toRfc4122());
 }
 
 void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const Group* group)
@@ -529,7 +768,13 @@ void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const Entry* entry)
 
 void KdbxXmlWriter::writeBinary(const QString& qualifiedName, const QByteArray& ba)
 {
-    writeString(qualifiedName, QString::fromLatin1(ba.toBase64()));
+    if (ba.isEmpty()) {
+        m_xml.writeEmptyElement(qualifiedName);
+    } else {
+        m_xml.writeStartElement(qualifiedName);
+        writeBase64Text(ba.toBase64());
+        m_xml.writeEndElement();
+    }
 }
 
 void KdbxXmlWriter::writeTriState(const QString& qualifiedName, Group::TriState triState)
@@ -581,6 +826,74 @@ QString KdbxXmlWriter::stripInvalidXml10Chars(QString str)
     return str;
 }
 
+/**
+ * Start an insert in the fragment that is currently being recorded.
+ * Everything written until endInsert() is left out of the fragment and
+ * regenerated from the insert when the fragment is reused.
+ */
+void KdbxXmlWriter::beginInsert(KdbxXmlFragment::InsertType type,
+                                const Group* group,
+                                const Entry* entry,
+                                const QString& key)
+{
+    if (m_fragment) {
+        setRecordBuffer(nullptr);
+        // history items are referred to through the entry that is part of the group
+        const Entry* owner = m_historyOwner ? m_historyOwner : entry;
+        const int historyIndex = m_historyOwner ? m_historyIndex : -1;
+        m_fragment->inserts.append({m_fragment->data.size(), type, group, owner, historyIndex, key});
+    }
+}
+
+void KdbxXmlWriter::endInsert()
+{
+    if (m_fragment) {
+        setRecordBuffer(&m_fragment->data);
+    }
+}
+
+/**
+ * Write data to the output bypassing the XML writer.
+ */
+void KdbxXmlWriter::writeRaw(const QByteArray& data)
+{
+    flushText();
+    if (!data.isEmpty() && m_output->write(data) != data.size()) {
+        raiseError(m_output->errorString());
+    }
+}
+
+/**
+ * Change the buffer the output is recorded into. Buffered XML text is
+ * flushed first, so it ends up where it belongs.
+ */
+void KdbxXmlWriter::setRecordBuffer(QByteArray* buffer)
+{
+    flushText();
+    m_recorder->setRecordBuffer(buffer);
+}
+
+void KdbxXmlWriter::setDiscarding(bool discarding)
+{
+    flushText();
+    m_recorder->setDiscarding(discarding);
+}
+
+/**
+ * Write the buffered XML text to the output as UTF-8.
+ */
+void KdbxXmlWriter::flushText()
+{
+    if (m_text.isEmpty()) {
+        return;
+    }
+    const QByteArray data = m_text.toUtf8();
+    m_text.resize(0);
+    if (m_output->write(data) != data.size()) {
+        raiseError(m_output->errorString());
+    }
+}
+
 void KdbxXmlWriter::raiseError(const QString& errorMessage)
 {
     m_error = true;
@@ -607,3 +920,15 @@ bool KdbxXmlWriter::innerStreamProtectionDisabled() const
 {
     return m_innerStreamProtectionDisabled;
 }
+
+/**
+ * Reuse the serialized XML of unchanged groups from the given cache and
+ * record the XML of all other groups into it. The cache is only used
+ * when writing with inner stream protection.
+ *
+ * @param cache fragment cache or nullptr to serialize all groups
+ */
+void KdbxXmlWriter::setFragmentCache(KdbxXmlFragmentCache* cache)
+{
+    m_fragmentCache = cache;
+}
@@ -26,9 +26,11 @@
 #include "core/Entry.h"
 #include "core/Group.h"
 #include "core/TimeInfo.h"
+#include "format/KdbxXmlFragmentCache.h"
 
 class KeePass2RandomStream;
 class Metadata;
+class RecordingStream;
 
 class KdbxXmlWriter
 {
@@ -42,21 +44,28 @@ public:
     void writeDatabase(const QString& filename, Database* db);
     void disableInnerStreamProtection(bool disable);
     bool innerStreamProtectionDisabled() const;
+    void setFragmentCache(KdbxXmlFragmentCache* cache);
     bool hasError();
     QString errorString();
 
 private:
     void generateIdMap();
+    int attachmentId(const AttachmentValue& attachment) const;
+    QString insertAttribute(const KdbxXmlFragment::Insert& insert) const;
+    AttachmentValue insertAttachment(const KdbxXmlFragment::Insert& insert) const;
 
     void writeMetadata();
     void writeMemoryProtection();
     void writeCustomIcons();
-    void writeIcon(const QUuid& uuid, const QImage& icon);
+    void writeIcon(const QUuid& uuid, const QByteArray& iconData);
     void writeBinaries();
     void writeCustomData(const CustomData* customData);
     void writeCustomDataItem(const QString& key, const QString& value);
     void writeRoot();
     void writeGroup(const Group* group);
+    void writeGroupElement(const Group* group);
+    void writeCachedGroup(const Group* group);
+    void writeFragment(const KdbxXmlFragment& fragment);
     void writeTimes(const TimeInfo& ti);
     void writeDeletedObjects();
     void writeDeletedObject(const DeletedObject& delObj);
@@ -64,6 +73,7 @@ private:
     void writeAutoType(const Entry* entry);
     void writeAutoTypeAssoc(const AutoTypeAssociations::Association& assoc);
     void writeEntryHistory(const Entry* entry);
+    QByteArray protectedValue(const QString& value);
 
     void writeString(const QString& qualifiedName, const QString& string);
     void writeNumber(const QString& qualifiedName, int number);
@@ -73,23 +83,50 @@ private:
     void writeUuid(const QString& qualifiedName, const Group* group);
     void writeUuid(const QString& qualifiedName, const Entry* entry);
     void writeBinary(const QString& qualifiedName, const QByteArray& ba);
+    void writeBase64Characters(const QByteArray& data);
+    void writeText(const QString& text);
+    void writeBase64Text(const QByteArray& base64);
     void writeTriState(const QString& qualifiedName, Group::TriState triState);
     QString colorPartToString(int value);
     QString stripInvalidXml10Chars(QString str);
 
+    void beginInsert(KdbxXmlFragment::InsertType type,
+                     const Group* group,
+                     const Entry* entry = nullptr,
+                     const QString& key = QString());
+    void endInsert();
+    void writeRaw(const QByteArray& data);
+    void setRecordBuffer(QByteArray* buffer);
+    void setDiscarding(bool discarding);
+    void flushText();
+
     void raiseError(const QString& errorMessage);
 
     const quint32 m_kdbxVersion;
 
     bool m_innerStreamProtectionDisabled = false;
 
+    // the XML writer serializes into m_text, which is flushed to m_output as UTF-8 in large blocks
+    QString m_text;
     QXmlStreamWriter m_xml;
+    QIODevice* m_output = nullptr;
     QPointer<const Database> m_db;
     QPointer<const Metadata> m_meta;
     KeePass2RandomStream* m_randomStream = nullptr;
+    QList<AttachmentValue> m_binaries;
+    // binary ids by SHA-256 digest of the contents, deferred attachments by their position in the source
     QHash<QByteArray, int> m_idMap;
+    QHash<QPair<const AttachmentSource*, int>, int> m_deferredIdMap;
     QByteArray m_headerHash;
 
+    KdbxXmlFragmentCache* m_fragmentCache = nullptr;
+    RecordingStream* m_recorder = nullptr;
+    KdbxXmlFragment* m_fragment = nullptr;
+    int m_groupDepth = 0;
+    // entry of the group whose history is being written and the index of the current item
+    const Entry* m_historyOwner = nullptr;
+    int m_historyIndex = -1;
+
     bool m_error = false;
 
     QString m_errorStr = "";
@@ -0,0 +1,157 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KeePass1Importer.h"
+
+#include <QFileInfo>
+#include <QThread>
+
+#include "core/AsyncTask.h"
+#include "core/Database.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+#include "format/KeePass1Reader.h"
+
+namespace
+{
+    struct SourceDatabase
+    {
+        QSharedPointer<Database> database;
+        QString error;
+    };
+
+    /**
+     * Decrypt and parse a KeePass1 database on a worker thread. The database is
+     * handed over to the importing thread, which moves its groups into the target.
+     */
+    SourceDatabase readSourceDatabase(const QString& path,
+                                      const QString& password,
+                                      const QString& keyFileName,
+                                      QThread* importThread)
+    {
+        KeePass1Reader reader;
+        auto db = reader.readDatabase(path, password, keyFileName);
+        if (!db) {
+            return {{}, reader.errorString()};
+        }
+
+        db->moveToThread(importThread);
+        return {db, {}};
+    }
+
+    /**
+     * Move the content of a source database into a new group of the target named after the file.
+     *
+     * @return number of entries moved
+     */
+    int moveIntoTarget(Database* source, const QString& path, Database* target)
+    {
+        Group* sourceRoot = source->rootGroup();
+        const int entries = sourceRoot->entriesRecursive().size();
+
+        // moving a group only carries its own icon along, not the ones of its children
+        target->metadata()->copyCustomIcons(sourceRoot->customIconsRecursive(), source->metadata());
+
+        auto* group = new Group();
+        group->setUuid(QUuid::createUuid());
+        group->setName(QFileInfo(path).completeBaseName());
+        group->setParent(target->rootGroup());
+
+        const QList<Group*> children = sourceRoot->children();
+        for (Group* child : children) {
+            child->setParent(group);
+        }
+        const QList<Entry*> rootEntries = sourceRoot->entries();
+        for (Entry* entry : rootEntries) {
+            entry->setGroup(group);
+        }
+
+        return entries;
+    }
+} // namespace
+
+KeePass1Importer::KeePass1Importer(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void KeePass1Importer::setPassword(const QString& password)
+{
+    m_password = password;
+}
+
+void KeePass1Importer::setKeyFile(const QString& keyFileName)
+{
+    m_keyFileName = keyFileName;
+}
+
+/**
+ * Import the given KeePass1 databases into the target database, all of them
+ * unlocked with the same credentials. fileImported() is emitted for every file
+ * as soon as it has been merged, without blocking the event loop in between.
+ *
+ * @param files paths of the KeePass1 databases
+ * @param target database receiving one group per imported file
+ * @return result of every file, in the given order
+ */
+QList<KeePass1Importer::Result> KeePass1Importer::import(const QStringList& files, Database* target)
+{
+    Q_ASSERT(target && target->rootGroup());
+
+    m_canceled = false;
+
+    // The key transformation dominates, so every file gets a worker of its own
+    QThread* importThread = QThread::currentThread();
+    const QString password = m_password;
+    const QString keyFileName = m_keyFileName;
+    QList<QFuture<SourceDatabase>> sources;
+    for (const QString& file : files) {
+        sources.append(AsyncTask::run(AsyncTask::Executor::Kdf, [file, password, keyFileName, importThread] {
+            return readSourceDatabase(file, password, keyFileName, importThread);
+        }));
+    }
+
+    QList<Result> results;
+    for (int i = 0; i < sources.size(); ++i) {
+        // the sources are always waited for, they are deleted on this thread
+        const SourceDatabase source = AsyncTask::waitForFuture<std::function<SourceDatabase()>>(sources.at(i));
+
+        Result result{files.at(i), 0, {}};
+        if (m_canceled) {
+            result.error = tr("Import canceled.");
+        } else if (!source.database) {
+            result.error = source.error;
+        } else {
+            target->beginBulkUpdate();
+            result.entries = moveIntoTarget(source.database.data(), result.path, target);
+            target->endBulkUpdate();
+        }
+
+        results.append(result);
+        emit fileImported(i + 1, files.size(), result.path, result.error);
+    }
+
+    return results;
+}
+
+/**
+ * Stop merging, every file that has not been merged yet is reported as canceled.
+ */
+void KeePass1Importer::cancel()
+{
+    m_canceled = true;
+}
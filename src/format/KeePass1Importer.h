@@ -0,0 +1,64 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_KEEPASS1IMPORTER_H
+#define KEEPASSXC_KEEPASS1IMPORTER_H
+
+#include <QObject>
+#include <QStringList>
+
+class Database;
+
+/**
+ * Imports a batch of KeePass1 databases into one database.
+ *
+ * The files are decrypted and parsed concurrently on worker threads. Each of them
+ * is then moved into its own group of the target database under a bulk update,
+ * in the order the files were given.
+ */
+class KeePass1Importer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Result
+    {
+        QString path;
+        int entries;
+        QString error;
+    };
+
+    explicit KeePass1Importer(QObject* parent = nullptr);
+
+    void setPassword(const QString& password);
+    void setKeyFile(const QString& keyFileName);
+
+    QList<Result> import(const QStringList& files, Database* target);
+
+public slots:
+    void cancel();
+
+signals:
+    void fileImported(int done, int total, const QString& path, const QString& error);
+
+private:
+    QString m_password;
+    QString m_keyFileName;
+    bool m_canceled = false;
+};
+
+#endif // KEEPASSXC_KEEPASS1IMPORTER_H
@@ -20,12 +20,26 @@
 #include "crypto/CryptoHash.h"
 #include "format/KeePass2.h"
 
+#include <sodium.h>
+
+namespace
+{
+    // Keystream is generated in batches of this many bytes so the cipher
+    // backend can run its multi-block kernels instead of one block per call.
+    const int KeystreamBatchSize = 4096;
+} // namespace
+
 KeePass2RandomStream::KeePass2RandomStream(KeePass2::ProtectedStreamAlgo algo)
     : m_cipher(mapAlgo(algo), SymmetricCipher::Stream, SymmetricCipher::Encrypt)
     , m_offset(0)
 {
 }
 
+KeePass2RandomStream::~KeePass2RandomStream()
+{
+    wipeKeystream(m_buffer.size() - m_offset);
+}
+
 bool KeePass2RandomStream::init(const QByteArray& key)
 {
     switch (m_cipher.algorithm()) {
@@ -44,59 +58,47 @@ bool KeePass2RandomStream::init(const QByteArray& key)
 
 QByteArray KeePass2RandomStream::randomBytes(int size, bool* ok)
 {
-    QByteArray result;
-
-    int bytesRemaining = size;
-
-    while (bytesRemaining > 0) {
-        if (m_buffer.size() == m_offset) {
-            if (!loadBlock()) {
-                *ok = false;
-                return QByteArray();
-            }
-        }
+    QByteArray result(size, '\0');
 
-        int bytesToCopy = qMin(bytesRemaining, m_buffer.size() - m_offset);
-        result.append(m_buffer.mid(m_offset, bytesToCopy));
-        m_offset += bytesToCopy;
-        bytesRemaining -= bytesToCopy;
+    *ok = applyKeystream(result.data(), size);
+    if (!*ok) {
+        return QByteArray();
     }
-
-    *ok = true;
     return result;
 }
 
 QByteArray KeePass2RandomStream::process(const QByteArray& data, bool* ok)
 {
-    bool randomBytesOk;
+    QByteArray result = data;
 
-    QByteArray randomData = randomBytes(data.size(), &randomBytesOk);
-    if (!randomBytesOk) {
-        *ok = false;
+    *ok = applyKeystream(result.data(), result.size());
+    if (!*ok) {
         return QByteArray();
     }
-
-    QByteArray result;
-    result.resize(data.size());
-
-    for (int i = 0; i < data.size(); i++) {
-        result[i] = data[i] ^ randomData[i];
-    }
-
-    *ok = true;
     return result;
 }
 
 bool KeePass2RandomStream::processInPlace(QByteArray& data)
 {
-    bool ok;
-    QByteArray randomData = randomBytes(data.size(), &ok);
-    if (!ok) {
-        return false;
-    }
+    return applyKeystream(data.data(), data.size());
+}
 
-    for (int i = 0; i < data.size(); i++) {
-        data[i] = data[i] ^ randomData[i];
+/**
+ * Advance the keystream by size bytes without applying them.
+ */
+bool KeePass2RandomStream::skip(quint64 size)
+{
+    while (size > 0) {
+        if (m_offset == m_buffer.size()) {
+            if (!loadBlock()) {
+                return false;
+            }
+        }
+
+        int bytesToSkip = static_cast<int>(qMin(size, static_cast<quint64>(m_buffer.size() - m_offset)));
+        wipeKeystream(bytesToSkip);
+        m_offset += bytesToSkip;
+        size -= static_cast<quint64>(bytesToSkip);
     }
 
     return true;
@@ -107,11 +109,40 @@ QString KeePass2RandomStream::errorString() const
     return m_cipher.errorString();
 }
 
+/**
+ * XOR the next size bytes of the keystream into data.
+ */
+bool KeePass2RandomStream::applyKeystream(char* data, int size)
+{
+    int pos = 0;
+    while (pos < size) {
+        if (m_offset == m_buffer.size()) {
+            if (!loadBlock()) {
+                return false;
+            }
+        }
+
+        int bytesToXor = qMin(size - pos, m_buffer.size() - m_offset);
+        const char* keystream = m_buffer.constData() + m_offset;
+        for (int i = 0; i < bytesToXor; ++i) {
+            data[pos + i] ^= keystream[i];
+        }
+        wipeKeystream(bytesToXor);
+        m_offset += bytesToXor;
+        pos += bytesToXor;
+    }
+
+    return true;
+}
+
 bool KeePass2RandomStream::loadBlock()
 {
     Q_ASSERT(m_offset == m_buffer.size());
 
-    m_buffer.fill('\0', m_cipher.blockSize());
+    // a stream cipher produces the same keystream regardless of how it is
+    // split, so batching doesn't change the output
+    int batchSize = qMax(KeystreamBatchSize - KeystreamBatchSize % m_cipher.blockSize(), m_cipher.blockSize());
+    m_buffer.fill('\0', batchSize);
     if (!m_cipher.processInPlace(m_buffer)) {
         return false;
     }
@@ -120,6 +151,16 @@ bool KeePass2RandomStream::loadBlock()
     return true;
 }
 
+/**
+ * Zero the next size bytes of the buffered keystream once they are used.
+ */
+void KeePass2RandomStream::wipeKeystream(int size)
+{
+    if (size > 0) {
+        sodium_memzero(m_buffer.data() + m_offset, static_cast<std::size_t>(size));
+    }
+}
+
 SymmetricCipher::Algorithm KeePass2RandomStream::mapAlgo(KeePass2::ProtectedStreamAlgo algo)
 {
     switch (algo) {
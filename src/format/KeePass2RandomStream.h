@@ -27,15 +27,19 @@ class KeePass2RandomStream
 {
 public:
     KeePass2RandomStream(KeePass2::ProtectedStreamAlgo algo);
+    ~KeePass2RandomStream();
 
     bool init(const QByteArray& key);
     QByteArray randomBytes(int size, bool* ok);
     QByteArray process(const QByteArray& data, bool* ok);
     Q_REQUIRED_RESULT bool processInPlace(QByteArray& data);
+    Q_REQUIRED_RESULT bool skip(quint64 size);
     QString errorString() const;
 
 private:
+    bool applyKeystream(char* data, int size);
     bool loadBlock();
+    void wipeKeystream(int size);
 
     SymmetricCipher m_cipher;
     QByteArray m_buffer;
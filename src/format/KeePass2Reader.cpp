@@ -19,6 +19,7 @@
 #include "format/Kdbx3Reader.h"
 #include "format/Kdbx4Reader.h"
 #include "format/KeePass1.h"
+#include "streams/MappedFileDevice.h"
 
 #include <QFile>
 
@@ -32,6 +33,15 @@
  */
 bool KeePass2Reader::readDatabase(const QString& filename, QSharedPointer<const CompositeKey> key, Database* db)
 {
+    // Prefer mapping the file into memory, fall back to buffered reads
+    // where mapping is unavailable or unsafe (e.g., network shares)
+    if (MappedFileDevice::isMappingSafe(filename)) {
+        MappedFileDevice mappedFile(filename);
+        if (mappedFile.open(QIODevice::ReadOnly)) {
+            return readDatabase(&mappedFile, std::move(key), db);
+        }
+    }
+
     QFile file(filename);
     if (!file.open(QFile::ReadOnly)) {
         raiseError(file.errorString());
@@ -57,9 +67,72 @@ bool KeePass2Reader::readDatabase(const QString& filename, QSharedPointer<const
  * @return true on success
  */
 bool KeePass2Reader::readDatabase(QIODevice* device, QSharedPointer<const CompositeKey> key, Database* db)
+{
+    if (!createReader(device)) {
+        return false;
+    }
+    m_reader->setPipelinedRead(m_pipelinedRead);
+    m_reader->setDeferredAttachments(m_deferredAttachments);
+    m_reader->setDeferredProtectedValues(m_deferredProtectedValues);
+    m_reader->setMetadataOnly(m_metadataOnly);
+    m_reader->setTransformedKey(m_transformSeed, m_transformedKey);
+
+    return m_reader->readDatabase(device, std::move(key), db);
+}
+
+/**
+ * Read only the outer header of a database file. This is cheap and
+ * does not need the key.
+ *
+ * @param filename input file
+ * @param header header fields read from the file
+ * @return true on success
+ */
+bool KeePass2Reader::readHeader(const QString& filename, KdbxHeaderInfo& header)
+{
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly)) {
+        raiseError(file.errorString());
+        return false;
+    }
+
+    bool ok = readHeader(&file, header);
+
+    if (file.error() != QFile::NoError) {
+        raiseError(file.errorString());
+        return false;
+    }
+
+    return ok;
+}
+
+/**
+ * Read only the outer header of a database and detect the file format.
+ *
+ * @param device input device
+ * @param header header fields read from the device
+ * @return true on success
+ */
+bool KeePass2Reader::readHeader(QIODevice* device, KdbxHeaderInfo& header)
+{
+    if (!createReader(device)) {
+        return false;
+    }
+
+    return m_reader->readHeader(device, header);
+}
+
+/**
+ * Check the magic numbers and create the reader for the file format.
+ *
+ * @param device input device
+ * @return true if the format is supported
+ */
+bool KeePass2Reader::createReader(QIODevice* device)
 {
     m_error = false;
     m_errorStr.clear();
+    m_reader.reset();
 
     quint32 signature1, signature2;
     bool ok = KdbxReader::readMagicNumbers(device, signature1, signature2, m_version);
@@ -96,7 +169,7 @@ bool KeePass2Reader::readDatabase(QIODevice* device, QSharedPointer<const Compos
         m_reader.reset(new Kdbx4Reader());
     }
 
-    return m_reader->readDatabase(device, std::move(key), db);
+    return true;
 }
 
 bool KeePass2Reader::hasError() const
@@ -109,6 +182,63 @@ QString KeePass2Reader::errorString() const
     return !m_reader.isNull() ? m_reader->errorString() : m_errorStr;
 }
 
+/**
+ * Decrypt, decompress and parse the payload on separate threads.
+ * Only KDBX 4 files are read pipelined, older formats ignore this setting.
+ *
+ * @param pipelined true to enable pipelined reading
+ */
+void KeePass2Reader::setPipelinedRead(bool pipelined)
+{
+    m_pipelinedRead = pipelined;
+}
+
+/**
+ * Read attachments from the database file only when they are accessed.
+ * Only KDBX 4 files read from a file support this, otherwise attachments
+ * are loaded into memory.
+ *
+ * @param deferred true to enable on-demand attachment loading
+ */
+void KeePass2Reader::setDeferredAttachments(bool deferred)
+{
+    m_deferredAttachments = deferred;
+}
+
+/**
+ * Keep protected entry strings encrypted until they are accessed.
+ *
+ * @param deferred true to enable on-demand decryption
+ */
+void KeePass2Reader::setDeferredProtectedValues(bool deferred)
+{
+    m_deferredProtectedValues = deferred;
+}
+
+/**
+ * Read only what is needed to look at the entries, skipping entry history,
+ * custom icons and attachments. The database must not be saved afterwards.
+ *
+ * @param metadataOnly true to skip history, custom icons and attachments
+ */
+void KeePass2Reader::setMetadataOnly(bool metadataOnly)
+{
+    m_metadataOnly = metadataOnly;
+}
+
+/**
+ * Skip the KDF if the file still has the given KDF seed, see
+ * KdbxReader::setTransformedKey().
+ *
+ * @param transformSeed KDF seed the key was transformed with
+ * @param transformedKey transformed database key
+ */
+void KeePass2Reader::setTransformedKey(const QByteArray& transformSeed, const QByteArray& transformedKey)
+{
+    m_transformSeed = transformSeed;
+    m_transformedKey = transformedKey;
+}
+
 /**
  * @return detected KDBX version
  */
@@ -37,14 +37,23 @@ class KeePass2Reader
 public:
     bool readDatabase(const QString& filename, QSharedPointer<const CompositeKey> key, Database* db);
     bool readDatabase(QIODevice* device, QSharedPointer<const CompositeKey> key, Database* db);
+    bool readHeader(const QString& filename, KdbxHeaderInfo& header);
+    bool readHeader(QIODevice* device, KdbxHeaderInfo& header);
 
     bool hasError() const;
     QString errorString() const;
 
+    void setPipelinedRead(bool pipelined);
+    void setDeferredAttachments(bool deferred);
+    void setDeferredProtectedValues(bool deferred);
+    void setMetadataOnly(bool metadataOnly);
+    void setTransformedKey(const QByteArray& transformSeed, const QByteArray& transformedKey);
+
     QSharedPointer<KdbxReader> reader() const;
     quint32 version() const;
 
 private:
+    bool createReader(QIODevice* device);
     void raiseError(const QString& errorMessage);
 
     bool m_error = false;
@@ -52,6 +61,12 @@ private:
 
     QSharedPointer<KdbxReader> m_reader;
     quint32 m_version = 0;
+    bool m_pipelinedRead = false;
+    bool m_deferredAttachments = false;
+    bool m_deferredProtectedValues = false;
+    bool m_metadataOnly = false;
+    QByteArray m_transformSeed;
+    QByteArray m_transformedKey;
 };
 
 #endif // KEEPASSX_KEEPASS2READER_H
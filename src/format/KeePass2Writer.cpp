@@ -15,6 +15,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QBuffer>
 #include <QFile>
 #include <QIODevice>
 
@@ -66,10 +67,8 @@ bool KeePass2Writer::implicitUpgradeNeeded(Database const* db) const
                 return true;
             }
 
-            for (const auto& historyItem : entry->historyItems()) {
-                if (historyItem->customData() && !historyItem->customData()->isEmpty()) {
-                    return true;
-                }
+            if (entry->hasHistoryCustomData()) {
+                return true;
             }
         }
     }
@@ -105,10 +104,26 @@ bool KeePass2Writer::writeDatabase(QIODevice* device, Database* db)
         m_writer.reset(new Kdbx4Writer());
     }
 
+    m_writer->setFragmentCache(m_fragmentCache);
+    m_writer->setCompression(m_compressionLevel, m_parallelCompression);
     return m_writer->writeDatabase(device, db);
 }
 
 void KeePass2Writer::extractDatabase(Database* db, QByteArray& xmlOutput)
+{
+    QBuffer buffer;
+    buffer.setBuffer(&xmlOutput);
+    buffer.open(QIODevice::WriteOnly);
+    extractDatabase(db, &buffer);
+}
+
+/**
+ * Stream the plain XML of the database to a device.
+ *
+ * @param db database to extract
+ * @param device output device
+ */
+void KeePass2Writer::extractDatabase(Database* db, QIODevice* device)
 {
     m_error = false;
     m_errorStr.clear();
@@ -121,7 +136,30 @@ void KeePass2Writer::extractDatabase(Database* db, QByteArray& xmlOutput)
         m_writer.reset(new Kdbx4Writer());
     }
 
-    m_writer->extractDatabase(xmlOutput, db);
+    m_writer->extractDatabase(device, db);
+}
+
+/**
+ * Reuse the serialized XML of groups that did not change since the
+ * previous save with the same cache.
+ *
+ * @param cache fragment cache or nullptr to serialize the whole database
+ */
+void KeePass2Writer::setFragmentCache(KdbxXmlFragmentCache* cache)
+{
+    m_fragmentCache = cache;
+}
+
+/**
+ * Configure the gzip compression of the payload.
+ *
+ * @param level zlib compression level
+ * @param parallel compress chunks of the payload on multiple threads
+ */
+void KeePass2Writer::setCompression(int level, bool parallel)
+{
+    m_compressionLevel = level;
+    m_parallelCompression = parallel;
 }
 
 bool KeePass2Writer::hasError() const
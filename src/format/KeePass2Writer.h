@@ -25,6 +25,7 @@
 
 class QIODevice;
 class Database;
+class KdbxXmlFragmentCache;
 
 class KeePass2Writer
 {
@@ -34,6 +35,9 @@ public:
     bool writeDatabase(const QString& filename, Database* db);
     bool writeDatabase(QIODevice* device, Database* db);
     void extractDatabase(Database* db, QByteArray& xmlOutput);
+    void extractDatabase(Database* db, QIODevice* device);
+    void setFragmentCache(KdbxXmlFragmentCache* cache);
+    void setCompression(int level, bool parallel);
 
     QSharedPointer<KdbxWriter> writer() const;
     quint32 version() const;
@@ -50,6 +54,9 @@ private:
 
     QScopedPointer<KdbxWriter> m_writer;
     quint32 m_version = 0;
+    KdbxXmlFragmentCache* m_fragmentCache = nullptr;
+    int m_compressionLevel = 6;
+    bool m_parallelCompression = false;
 };
 
 #endif // KEEPASSX_KEEPASS2READER_H
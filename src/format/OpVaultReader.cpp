@@ -25,9 +25,12 @@
 #include "keys/PasswordKey.h"
 
 #include <QDebug>
+#include <QEventLoop>
+#include <QFutureWatcher>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QUuid>
+#include <QtConcurrent>
 #include <gcrypt.h>
 
 OpVaultReader::OpVaultReader(QObject* parent)
@@ -107,6 +110,30 @@ Database* OpVaultReader::readDatabase(QDir& opdataDir, const QString& password)
         }
     }
 
+    const auto bandEntries = decryptBandEntries(readBandEntries(defaultDir), defaultDir);
+    for (const auto& bandEntry : bandEntries) {
+        // https://support.1password.com/opvault-design/#items
+        auto entry = processBandEntry(bandEntry, rootGroup);
+        if (!entry) {
+            qWarning() << "Unable to process Band Entry " << bandEntry.bandEntry["uuid"].toString();
+        }
+    }
+
+    // Remove empty categories (groups)
+    for (auto group : rootGroup->children()) {
+        if (group->isEmpty()) {
+            delete group;
+        }
+    }
+
+    zeroKeys();
+    return db.take();
+}
+
+QList<QJsonObject> OpVaultReader::readBandEntries(const QDir& defaultDir)
+{
+    QList<QJsonObject> bandEntries;
+
     const QString bandChars("0123456789ABCDEF");
     QString bandPattern("band_%1.js");
     for (QChar ch : bandChars) {
@@ -134,26 +161,35 @@ Database* OpVaultReader::readDatabase(QDir& opdataDir, const QString& password)
                     break;
                 }
             }
-            if (!ok) {
-                continue;
-            }
-            // https://support.1password.com/opvault-design/#items
-            auto entry = processBandEntry(bandEnt, defaultDir, rootGroup);
-            if (!entry) {
-                qWarning() << "Unable to process Band Entry " << uuid;
+            if (ok) {
+                bandEntries.append(bandEnt);
             }
         }
     }
 
-    // Remove empty categories (groups)
-    for (auto group : rootGroup->children()) {
-        if (group->isEmpty()) {
-            delete group;
-        }
-    }
+    return bandEntries;
+}
 
-    zeroKeys();
-    return db.take();
+QList<OpVaultReader::DecryptedBandEntry> OpVaultReader::decryptBandEntries(const QList<QJsonObject>& bandEntries,
+                                                                           const QDir& attachmentDir)
+{
+    std::function<DecryptedBandEntry(const QJsonObject&)> decode = [this, attachmentDir](const QJsonObject& entry) {
+        return decodeBandEntry(entry, attachmentDir);
+    };
+
+    const int total = bandEntries.size();
+    QEventLoop loop;
+    QFutureWatcher<DecryptedBandEntry> watcher;
+    connect(&watcher, &QFutureWatcherBase::progressValueChanged, this, [this, total](int done) {
+        emit bandEntriesProgress(done, total);
+    });
+    connect(&watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+    watcher.setFuture(QtConcurrent::mapped(bandEntries, decode));
+    loop.exec();
+    // progress updates are rate limited, make sure the final state is reported
+    emit bandEntriesProgress(total, total);
+
+    return watcher.future().results();
 }
 
 bool OpVaultReader::hasError()
@@ -43,6 +43,14 @@ public:
     bool hasError();
     QString errorString();
 
+signals:
+    /*!
+     * Emitted while the items of the vault are decrypted in the background.
+     * @param done number of items decrypted so far
+     * @param total number of items in the vault
+     */
+    void bandEntriesProgress(int done, int total);
+
 private:
     struct DerivedKeyHMAC
     {
@@ -52,6 +60,23 @@ private:
         QString errorStr;
     };
 
+    /*! An attachment decrypted in the background, ready to be added to its entry. */
+    struct DecryptedAttachment
+    {
+        QString name;
+        QByteArray data;
+    };
+
+    /*! A band entry decrypted in the background, ready to be merged into the database. */
+    struct DecryptedBandEntry
+    {
+        QJsonObject bandEntry;
+        QJsonObject overview;
+        QJsonObject data;
+        QList<DecryptedAttachment> attachments;
+        bool ok = false;
+    };
+
     QJsonObject readAndAssertJsonFile(QFile& file, const QString& stripLeading, const QString& stripTrailing);
 
     DerivedKeyHMAC* deriveKeysFromPassPhrase(QByteArray& salt, const QString& password, unsigned long iterations);
@@ -78,24 +103,40 @@ private:
      * which are used to decrypt the attachments, also.
      * @returns \c nullptr if unable to do the decryption, otherwise the interior object and its keys
      */
-    bool decryptBandEntry(const QJsonObject& bandEntry, QJsonObject& data, QByteArray& key, QByteArray& hmacKey);
-    Entry* processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir, Group* rootGroup);
+    bool decryptBandEntry(const QJsonObject& bandEntry, QJsonObject& data, QByteArray& key, QByteArray& hmacKey) const;
+    bool decryptOverview(const QJsonObject& bandEntry, QJsonObject& overview) const;
+
+    /*!
+     * Reads all band files of the vault and returns their well-formed entries.
+     * \sa https://support.1password.com/opvault-design/#band-files
+     */
+    QList<QJsonObject> readBandEntries(const QDir& defaultDir);
+
+    /*!
+     * Decrypts the given band entries on the global thread pool, while the event loop keeps running.
+     * Each entry is independent of the others, only the simple data required to build the database
+     * entries is produced here; the entries themselves are created by processBandEntry() afterwards.
+     * @returns the decrypted entries in the order of \c bandEntries
+     */
+    QList<DecryptedBandEntry> decryptBandEntries(const QList<QJsonObject>& bandEntries, const QDir& attachmentDir);
+    DecryptedBandEntry decodeBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir) const;
+    Entry* processBandEntry(const DecryptedBandEntry& bandEntry, Group* rootGroup);
 
     bool readAttachment(const QString& filePath,
                         const QByteArray& itemKey,
                         const QByteArray& itemHmacKey,
                         QJsonObject& metadata,
-                        QByteArray& payload);
-    void fillAttachment(Entry* entry,
-                        const QFileInfo& attachmentFileInfo,
-                        const QByteArray& entryKey,
-                        const QByteArray& entryHmacKey);
-    void fillAttachments(Entry* entry,
-                         const QDir& attachmentDir,
-                         const QByteArray& entryKey,
-                         const QByteArray& entryHmacKey);
-
-    bool fillAttributes(Entry* entry, const QJsonObject& bandEntry);
+                        QByteArray& payload) const;
+    bool decryptAttachment(const QFileInfo& attachmentFileInfo,
+                           const QByteArray& entryKey,
+                           const QByteArray& entryHmacKey,
+                           DecryptedAttachment& attachment) const;
+    QList<DecryptedAttachment> decryptAttachments(const QString& entryUuidHex,
+                                                  const QDir& attachmentDir,
+                                                  const QByteArray& entryKey,
+                                                  const QByteArray& entryHmacKey) const;
+
+    void fillAttributes(Entry* entry, const QJsonObject& overviewJson);
 
     void fillFromSection(Entry* entry, const QJsonObject& section);
     void fillFromSectionField(Entry* entry, const QString& sectionName, QJsonObject& field);
@@ -36,7 +36,7 @@ bool OpVaultReader::readAttachment(const QString& filePath,
                                    const QByteArray& itemKey,
                                    const QByteArray& itemHmacKey,
                                    QJsonObject& metadata,
-                                   QByteArray& payload)
+                                   QByteArray& payload) const
 {
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
@@ -139,45 +139,47 @@ bool OpVaultReader::readAttachment(const QString& filePath,
 /*!
  * \sa https://support.1password.com/opvault-design/#attachments
  */
-void OpVaultReader::fillAttachments(Entry* entry,
-                                    const QDir& attachmentDir,
-                                    const QByteArray& entryKey,
-                                    const QByteArray& entryHmacKey)
+QList<OpVaultReader::DecryptedAttachment> OpVaultReader::decryptAttachments(const QString& entryUuidHex,
+                                                                           const QDir& attachmentDir,
+                                                                           const QByteArray& entryKey,
+                                                                           const QByteArray& entryHmacKey) const
 {
+    QList<DecryptedAttachment> attachments;
+
     /*!
      * Attachment files are named with the UUID of the item that they are attached to followed by an underscore
      * and then followed by the UUID of the attachment itself. The file is then given the extension .attachment.
      */
-    auto fileFilter = QString("%1_*.attachment").arg(entry->uuidToHex().toUpper());
+    auto fileFilter = QString("%1_*.attachment").arg(entryUuidHex);
     const auto& attachInfoList = attachmentDir.entryInfoList(QStringList() << fileFilter, QDir::Files);
-    int attachmentCount = attachInfoList.size();
-    if (attachmentCount == 0) {
-        return;
-    }
-
     for (const auto& info : attachInfoList) {
         if (!info.isReadable()) {
             qCritical() << QString("Attachment file \"%1\" is not readable").arg(info.absoluteFilePath());
             continue;
         }
-        fillAttachment(entry, info, entryKey, entryHmacKey);
+        DecryptedAttachment attachment;
+        if (decryptAttachment(info, entryKey, entryHmacKey, attachment)) {
+            attachments.append(attachment);
+        }
     }
+
+    return attachments;
 }
 
-void OpVaultReader::fillAttachment(Entry* entry,
-                                   const QFileInfo& info,
-                                   const QByteArray& entryKey,
-                                   const QByteArray& entryHmacKey)
+bool OpVaultReader::decryptAttachment(const QFileInfo& info,
+                                      const QByteArray& entryKey,
+                                      const QByteArray& entryHmacKey,
+                                      DecryptedAttachment& attachment) const
 {
     QJsonObject attachMetadata;
     QByteArray attachPayload;
     if (!readAttachment(info.absoluteFilePath(), entryKey, entryHmacKey, attachMetadata, attachPayload)) {
-        return;
+        return false;
     }
 
     if (!attachMetadata.contains("overview")) {
         qWarning() << "Expected \"overview\" in attachment metadata";
-        return;
+        return false;
     }
 
     const QString& overB64 = attachMetadata["overview"].toString();
@@ -232,5 +234,7 @@ void OpVaultReader::fillAttachment(Entry* entry,
         }
     }
 
-    entry->attachments()->set(attachKey, attachPayload);
+    attachment.name = attachKey;
+    attachment.data = attachPayload;
+    return true;
 }
@@ -33,7 +33,7 @@
 bool OpVaultReader::decryptBandEntry(const QJsonObject& bandEntry,
                                      QJsonObject& data,
                                      QByteArray& key,
-                                     QByteArray& hmacKey)
+                                     QByteArray& hmacKey) const
 {
     if (!bandEntry.contains("d")) {
         qWarning() << "Band entries must contain a \"d\" key: " << bandEntry.keys();
@@ -105,14 +105,63 @@ bool OpVaultReader::decryptBandEntry(const QJsonObject& bandEntry,
     return true;
 }
 
-Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir, Group* rootGroup)
+bool OpVaultReader::decryptOverview(const QJsonObject& bandEntry, QJsonObject& overview) const
 {
+    const QString overviewStr = bandEntry.value("o").toString();
+    OpData01 entOver01;
+    if (!entOver01.decodeBase64(overviewStr, m_overviewKey, m_overviewHmacKey)) {
+        qCritical() << "Unable to decipher 'o' in UUID \"" << bandEntry.value("uuid").toString() << "\"\n"
+                    << ": " << entOver01.errorString();
+        return false;
+    }
+
+    auto overviewJsonBytes = entOver01.getClearText();
+    auto overviewDoc = QJsonDocument::fromJson(overviewJsonBytes);
+    overview = overviewDoc.object();
+    return true;
+}
+
+/*!
+ * Does all the decryption work for a single band entry. Only uses the keys of the
+ * profile and touches no shared state, so it is safe to run on a worker thread.
+ */
+OpVaultReader::DecryptedBandEntry OpVaultReader::decodeBandEntry(const QJsonObject& bandEntry,
+                                                                 const QDir& attachmentDir) const
+{
+    DecryptedBandEntry result;
+    result.bandEntry = bandEntry;
+
     const QString uuid = bandEntry.value("uuid").toString();
     if (!(uuid.size() == 32 || uuid.size() == 36)) {
         qWarning() << QString("Skipping suspicious band UUID <<%1>> with length %2").arg(uuid).arg(uuid.size());
+        return result;
+    }
+
+    if (!decryptOverview(bandEntry, result.overview)) {
+        return result;
+    }
+
+    QByteArray entryKey;
+    QByteArray entryHmacKey;
+    if (!decryptBandEntry(bandEntry, result.data, entryKey, entryHmacKey)) {
+        return result;
+    }
+
+    const QString uuidHex = Tools::uuidToHex(Tools::hexToUuid(uuid)).toUpper();
+    result.attachments = decryptAttachments(uuidHex, attachmentDir, entryKey, entryHmacKey);
+    result.ok = true;
+    return result;
+}
+
+Entry* OpVaultReader::processBandEntry(const DecryptedBandEntry& decrypted, Group* rootGroup)
+{
+    if (!decrypted.ok) {
         return nullptr;
     }
 
+    const QJsonObject& bandEntry = decrypted.bandEntry;
+    const QString uuid = bandEntry.value("uuid").toString();
+
     QScopedPointer<Entry> entry(new Entry());
 
     if (bandEntry.contains("trashed") && bandEntry["trashed"].toBool()) {
@@ -166,17 +215,9 @@ Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir&
     }
     entry->setUuid(Tools::hexToUuid(uuid));
 
-    if (!fillAttributes(entry.data(), bandEntry)) {
-        return nullptr;
-    }
-
-    QJsonObject data;
-    QByteArray entryKey;
-    QByteArray entryHmacKey;
+    fillAttributes(entry.data(), decrypted.overview);
 
-    if (!decryptBandEntry(bandEntry, data, entryKey, entryHmacKey)) {
-        return nullptr;
-    }
+    const QJsonObject& data = decrypted.data;
 
     if (data.contains("notesPlain")) {
         entry->setNotes(data.value("notesPlain").toString());
@@ -214,24 +255,14 @@ Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir&
         fillFromSection(entry.data(), section);
     }
 
-    fillAttachments(entry.data(), attachmentDir, entryKey, entryHmacKey);
+    for (const auto& attachment : decrypted.attachments) {
+        entry->attachments()->set(attachment.name, attachment.data);
+    }
     return entry.take();
 }
 
-bool OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& bandEntry)
+void OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& overviewJson)
 {
-    const QString overviewStr = bandEntry.value("o").toString();
-    OpData01 entOver01;
-    if (!entOver01.decodeBase64(overviewStr, m_overviewKey, m_overviewHmacKey)) {
-        qCritical() << "Unable to decipher 'o' in UUID \"" << entry->uuid() << "\"\n"
-                    << ": " << entOver01.errorString();
-        return false;
-    }
-
-    auto overviewJsonBytes = entOver01.getClearText();
-    auto overviewDoc = QJsonDocument::fromJson(overviewJsonBytes);
-    auto overviewJson = overviewDoc.object();
-
     QString title = overviewJson.value("title").toString();
     entry->setTitle(title);
 
@@ -258,6 +289,4 @@ bool OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& bandEntry)
         }
     }
     entry->setTags(tagsList.join(','));
-
-    return true;
 }
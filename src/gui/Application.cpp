@@ -50,6 +50,57 @@ namespace
 {
     constexpr int WaitTimeoutMSec = 150;
     const char BlockSizeProperty[] = "blockSize";
+
+    QString instanceIdentifier()
+    {
+        QString userName = qgetenv("USER");
+        if (userName.isEmpty()) {
+            userName = qgetenv("USERNAME");
+        }
+        QString identifier = "keepassxc";
+        if (!userName.isEmpty()) {
+            identifier += "-" + userName;
+        }
+#ifdef QT_DEBUG
+        // In DEBUG mode don't interfere with Release instances
+        identifier += "-DEBUG";
+#endif
+        return identifier;
+    }
+
+    QString lockFilePath()
+    {
+        // According to documentation we should use RuntimeLocation on *nixes, but even Qt doesn't respect
+        // this and creates sockets in TempLocation, so let's be consistent.
+        return QStandardPaths::writableLocation(QStandardPaths::TempLocation) + "/" + instanceIdentifier() + ".lock";
+    }
+
+    QString socketName()
+    {
+        return instanceIdentifier() + ".socket";
+    }
+
+    bool writeFileNames(const QString& serverName, const QStringList& fileNames)
+    {
+        QLocalSocket client;
+        client.connectToServer(serverName);
+        const bool connected = client.waitForConnected(WaitTimeoutMSec);
+        if (!connected) {
+            return false;
+        }
+
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_0);
+        out << quint32(0) << fileNames;
+        out.device()->seek(0);
+        out << quint32(data.size() - sizeof(quint32));
+
+        const bool writeOk = client.write(data) != -1 && client.waitForBytesWritten(WaitTimeoutMSec);
+        client.disconnectFromServer();
+        const bool disconnected = client.waitForDisconnected(WaitTimeoutMSec);
+        return writeOk && disconnected;
+    }
 } // namespace
 
 Application::Application(int& argc, char** argv)
@@ -70,24 +121,8 @@ Application::Application(int& argc, char** argv)
     registerUnixSignals();
 #endif
 
-    QString userName = qgetenv("USER");
-    if (userName.isEmpty()) {
-        userName = qgetenv("USERNAME");
-    }
-    QString identifier = "keepassxc";
-    if (!userName.isEmpty()) {
-        identifier += "-" + userName;
-    }
-#ifdef QT_DEBUG
-    // In DEBUG mode don't interfere with Release instances
-    identifier += "-DEBUG";
-#endif
-    QString lockName = identifier + ".lock";
-    m_socketName = identifier + ".socket";
-
-    // According to documentation we should use RuntimeLocation on *nixes, but even Qt doesn't respect
-    // this and creates sockets in TempLocation, so let's be consistent.
-    m_lockFile = new QLockFile(QStandardPaths::writableLocation(QStandardPaths::TempLocation) + "/" + lockName);
+    m_socketName = socketName();
+    m_lockFile = new QLockFile(lockFilePath());
     m_lockFile->setStaleLockTime(0);
     m_lockFile->tryLock();
 
@@ -326,24 +361,47 @@ bool Application::isAlreadyRunning() const
 
 bool Application::sendFileNamesToRunningInstance(const QStringList& fileNames)
 {
-    QLocalSocket client;
-    client.connectToServer(m_socketName);
-    const bool connected = client.waitForConnected(WaitTimeoutMSec);
-    if (!connected) {
+    return writeFileNames(m_socketName, fileNames);
+}
+
+/**
+ * Hand the given files over to an already running instance without
+ * constructing the GUI application.
+ *
+ * Only a QCoreApplication is required, so this can run before the platform
+ * plugin, styles and widgets are loaded. The running instance raises its
+ * window on every connection, so the files are sent even when the list is
+ * empty. Returns false if single-instance mode is disabled, no instance holds
+ * the lock or the running instance did not respond; the caller then continues
+ * with the regular startup, which also takes care of stale lock files.
+ *
+ * @param fileNames files to open in the running instance
+ * @return true if the running instance accepted the files
+ */
+bool Application::handOffToRunningInstance(const QStringList& fileNames)
+{
+#ifdef QT_DEBUG
+    // In DEBUG mode we can run unlimited instances
+    Q_UNUSED(fileNames);
+    return false;
+#else
+    if (!config()->get(Config::SingleInstance).toBool()) {
         return false;
     }
 
-    QByteArray data;
-    QDataStream out(&data, QIODevice::WriteOnly);
-    out.setVersion(QDataStream::Qt_5_0);
-    out << quint32(0) << fileNames;
-    out.device()->seek(0);
-    out << quint32(data.size() - sizeof(quint32));
-
-    const bool writeOk = client.write(data) != -1 && client.waitForBytesWritten(WaitTimeoutMSec);
-    client.disconnectFromServer();
-    const bool disconnected = client.waitForDisconnected(WaitTimeoutMSec);
-    return writeOk && disconnected;
+    QLockFile lockFile(lockFilePath());
+    lockFile.setStaleLockTime(0);
+    if (lockFile.tryLock()) {
+        // Nobody is running, release the lock again for the regular startup
+        lockFile.unlock();
+        return false;
+    }
+    if (lockFile.error() != QLockFile::LockFailedError) {
+        return false;
+    }
+
+    return writeFileNames(socketName(), fileNames);
+#endif
 }
 
 bool Application::isDarkTheme() const
@@ -42,6 +42,7 @@ public:
     ~Application() override;
 
     static void bootstrap();
+    static bool handOffToRunningInstance(const QStringList& fileNames);
 
     void applyTheme();
 
@@ -118,6 +118,8 @@ ApplicationSettingsWidget::ApplicationSettingsWidget(QWidget* parent)
             m_secUi->lockDatabaseIdleSpinBox, SLOT(setEnabled(bool)));
     connect(m_secUi->touchIDResetCheckBox, SIGNAL(toggled(bool)),
             m_secUi->touchIDResetSpinBox, SLOT(setEnabled(bool)));
+    connect(m_secUi->quickUnlockCheckBox, SIGNAL(toggled(bool)),
+            m_secUi->quickUnlockSpinBox, SLOT(setEnabled(bool)));
     // clang-format on
 
     // Disable mouse wheel grab when scrolling
@@ -199,6 +201,7 @@ void ApplicationSettingsWidget::loadSettings()
     m_generalUi->autoTypeEntryTitleMatchCheckBox->setChecked(config()->get(Config::AutoTypeEntryTitleMatch).toBool());
     m_generalUi->autoTypeEntryURLMatchCheckBox->setChecked(config()->get(Config::AutoTypeEntryURLMatch).toBool());
     m_generalUi->autoTypeHideExpiredEntryCheckBox->setChecked(config()->get(Config::AutoTypeHideExpiredEntry).toBool());
+    m_generalUi->autoTypeBurstModeCheckBox->setChecked(config()->get(Config::AutoTypeBurstMode).toBool());
     m_generalUi->faviconTimeoutSpinBox->setValue(config()->get(Config::FaviconDownloadTimeout).toInt());
 
     m_generalUi->languageComboBox->clear();
@@ -286,6 +289,9 @@ void ApplicationSettingsWidget::loadSettings()
     m_secUi->touchIDResetOnScreenLockCheckBox->setChecked(
         config()->get(Config::Security_ResetTouchIdScreenlock).toBool());
 
+    m_secUi->quickUnlockCheckBox->setChecked(config()->get(Config::Security_QuickUnlock).toBool());
+    m_secUi->quickUnlockSpinBox->setValue(config()->get(Config::Security_QuickUnlockTimeout).toInt());
+
     for (const ExtraPage& page : asConst(m_extraPages)) {
         page.loadSettings();
     }
@@ -326,6 +332,7 @@ void ApplicationSettingsWidget::saveSettings()
     config()->set(Config::AutoTypeEntryTitleMatch, m_generalUi->autoTypeEntryTitleMatchCheckBox->isChecked());
     config()->set(Config::AutoTypeEntryURLMatch, m_generalUi->autoTypeEntryURLMatchCheckBox->isChecked());
     config()->set(Config::AutoTypeHideExpiredEntry, m_generalUi->autoTypeHideExpiredEntryCheckBox->isChecked());
+    config()->set(Config::AutoTypeBurstMode, m_generalUi->autoTypeBurstModeCheckBox->isChecked());
     config()->set(Config::FaviconDownloadTimeout, m_generalUi->faviconTimeoutSpinBox->value());
 
     auto language = m_generalUi->languageComboBox->currentData().toString();
@@ -384,6 +391,9 @@ void ApplicationSettingsWidget::saveSettings()
     config()->set(Config::Security_ResetTouchIdTimeout, m_secUi->touchIDResetSpinBox->value());
     config()->set(Config::Security_ResetTouchIdScreenlock, m_secUi->touchIDResetOnScreenLockCheckBox->isChecked());
 
+    config()->set(Config::Security_QuickUnlock, m_secUi->quickUnlockCheckBox->isChecked());
+    config()->set(Config::Security_QuickUnlockTimeout, m_secUi->quickUnlockSpinBox->value());
+
     // Security: clear storage if related settings are disabled
     if (!config()->get(Config::RememberLastDatabases).toBool()) {
         config()->remove(Config::LastDatabases);
@@ -41,7 +41,22 @@
 namespace
 {
     constexpr int clearFormsDelay = 30000;
-}
+
+    /**
+     * Open the database file, showing the groups and entries before
+     * their history and attachments are read if enabled.
+     */
+    bool openDatabaseFile(Database* db,
+                          const QString& filePath,
+                          const QSharedPointer<CompositeKey>& key,
+                          QString* error)
+    {
+        if (config()->get(Config::ProgressiveDatabaseOpen).toBool()) {
+            return db->openProgressively(filePath, key, error, false);
+        }
+        return db->open(filePath, key, error, false);
+    }
+} // namespace
 
 DatabaseOpenWidget::DatabaseOpenWidget(QWidget* parent)
     : DialogyWidget(parent)
@@ -82,7 +97,7 @@ DatabaseOpenWidget::DatabaseOpenWidget(QWidget* parent)
     sp.setRetainSizeWhenHidden(true);
     m_ui->hardwareKeyProgress->setSizePolicy(sp);
 
-    connect(m_ui->buttonRedetectYubikey, SIGNAL(clicked()), SLOT(pollHardwareKey()));
+    connect(m_ui->buttonRedetectYubikey, &QPushButton::clicked, this, [this] { pollHardwareKey(true); });
     connect(YubiKey::instance(), SIGNAL(detectComplete(bool)), SLOT(hardwareKeyResponse(bool)), Qt::QueuedConnection);
 
     connect(YubiKey::instance(), &YubiKey::userInteractionRequest, this, [this] {
@@ -187,6 +202,41 @@ void DatabaseOpenWidget::enterKey(const QString& pw, const QString& keyFile)
     openDatabase();
 }
 
+/**
+ * Try to unlock the database with credentials entered for another database.
+ * The form is left untouched and no error is shown if the key does not match,
+ * so the user can still enter this database's own credentials.
+ *
+ * @param key composite key to try
+ */
+void DatabaseOpenWidget::unlockWithKey(const QSharedPointer<CompositeKey>& key)
+{
+    if (m_filename.isEmpty() || !m_ui->passwordFormFrame->isEnabled()) {
+        return;
+    }
+
+    m_ui->messageWidget->hide();
+    m_ui->passwordFormFrame->setEnabled(false);
+    auto db = QSharedPointer<Database>::create();
+    QString error;
+    bool ok = openDatabaseFile(db.data(), m_filename, key, &error);
+    m_ui->passwordFormFrame->setEnabled(true);
+
+    if (ok) {
+        m_db = db;
+        emit dialogFinished(true);
+        clearForms();
+    }
+}
+
+/**
+ * Show the option to unlock all other locked databases with the entered credentials.
+ */
+void DatabaseOpenWidget::setUnlockAllAvailable(bool available)
+{
+    m_ui->checkUnlockAll->setVisible(available);
+}
+
 void DatabaseOpenWidget::openDatabase()
 {
     m_ui->messageWidget->hide();
@@ -196,6 +246,12 @@ void DatabaseOpenWidget::openDatabase()
         return;
     }
 
+    // Hardware keys need a challenge per database, only share plain credentials
+    if (m_ui->checkUnlockAll->isVisible() && m_ui->checkUnlockAll->isChecked()
+        && databaseKey->challengeResponseKeys().isEmpty()) {
+        emit unlockAllRequested(databaseKey);
+    }
+
     m_ui->editPassword->setShowPassword(false);
     QCoreApplication::processEvents();
 
@@ -205,7 +261,7 @@ void DatabaseOpenWidget::openDatabase()
     QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
     m_ui->passwordFormFrame->setEnabled(false);
     QCoreApplication::processEvents();
-    bool ok = m_db->open(m_filename, databaseKey, &error, false);
+    bool ok = openDatabaseFile(m_db.data(), m_filename, databaseKey, &error);
     QApplication::restoreOverrideCursor();
     m_ui->passwordFormFrame->setEnabled(true);
 
@@ -380,7 +436,13 @@ void DatabaseOpenWidget::clearKeyFileText()
     m_ui->keyFileLineEdit->clear();
 }
 
-void DatabaseOpenWidget::pollHardwareKey()
+/**
+ * Populate the hardware key list. Unless a new detection is forced,
+ * the cached keys are shown if no key was plugged in or removed.
+ *
+ * @param forceDetection always run a full detection
+ */
+void DatabaseOpenWidget::pollHardwareKey(bool forceDetection)
 {
     if (m_pollingHardwareKey) {
         return;
@@ -394,11 +456,20 @@ void DatabaseOpenWidget::pollHardwareKey()
     m_ui->hardwareKeyProgress->setVisible(true);
     m_pollingHardwareKey = true;
 
-    YubiKey::instance()->findValidKeys();
+    if (forceDetection) {
+        YubiKey::instance()->findValidKeys();
+    } else {
+        YubiKey::instance()->refreshValidKeys();
+    }
 }
 
 void DatabaseOpenWidget::hardwareKeyResponse(bool found)
 {
+    // Ignore detections that were requested elsewhere, e.g. at startup
+    if (!m_pollingHardwareKey) {
+        return;
+    }
+
     m_ui->challengeResponseCombo->clear();
     m_ui->buttonRedetectYubikey->setEnabled(true);
     m_ui->hardwareKeyProgress->setVisible(false);
@@ -44,10 +44,13 @@ public:
     QString filename();
     void clearForms();
     void enterKey(const QString& pw, const QString& keyFile);
+    void unlockWithKey(const QSharedPointer<CompositeKey>& key);
+    void setUnlockAllAvailable(bool available);
     QSharedPointer<Database> database();
 
 signals:
     void dialogFinished(bool accepted);
+    void unlockAllRequested(const QSharedPointer<CompositeKey>& key);
 
 protected:
     void showEvent(QShowEvent* event) override;
@@ -66,7 +69,7 @@ protected slots:
 private slots:
     void browseKeyFile();
     void clearKeyFileText();
-    void pollHardwareKey();
+    void pollHardwareKey(bool forceDetection = false);
     void hardwareKeyResponse(bool found);
     void openHardwareKeyHelp();
     void openKeyFileHelp();
@@ -18,25 +18,32 @@
 #include "DatabaseTabWidget.h"
 
 #include <QFileInfo>
+#include <QInputDialog>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QTabWidget>
+#include <QTimer>
 
 #include "autotype/AutoType.h"
 #include "core/AsyncTask.h"
 #include "core/Config.h"
 #include "core/Database.h"
+#include "core/Entry.h"
 #include "core/Global.h"
 #include "core/Group.h"
+#include "core/MemoryUsage.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
 #include "format/CsvExporter.h"
 #include "format/HtmlExporter.h"
+#include "format/KeePass1Importer.h"
 #include "gui/Clipboard.h"
 #include "gui/DatabaseOpenDialog.h"
 #include "gui/DatabaseWidget.h"
 #include "gui/DatabaseWidgetStateSync.h"
 #include "gui/DragTabBar.h"
 #include "gui/FileDialog.h"
+#include "gui/GlobalSearchDialog.h"
 #include "gui/MessageBox.h"
 #include "gui/entry/EntryView.h"
 #include "gui/group/GroupView.h"
@@ -50,11 +57,17 @@ DatabaseTabWidget::DatabaseTabWidget(QWidget* parent)
     , m_dbWidgetStateSync(new DatabaseWidgetStateSync(this))
     , m_dbWidgetPendingLock(nullptr)
     , m_databaseOpenDialog(new DatabaseOpenDialog(this))
+    , m_releaseMemoryTimer(new QTimer(this))
 {
     auto* tabBar = new DragTabBar(this);
     setTabBar(tabBar);
     setDocumentMode(true);
 
+    // Locking all databases releases them one after the other, return their memory once
+    m_releaseMemoryTimer->setSingleShot(true);
+    m_releaseMemoryTimer->setInterval(1000);
+    connect(m_releaseMemoryTimer, SIGNAL(timeout()), SLOT(releaseFreeMemory()));
+
     // clang-format off
     connect(this, SIGNAL(tabCloseRequested(int)), SLOT(closeDatabaseTab(int)));
     connect(this, SIGNAL(currentChanged(int)), SLOT(emitActivateDatabaseChanged()));
@@ -65,6 +78,9 @@ DatabaseTabWidget::DatabaseTabWidget(QWidget* parent)
     connect(autoType(), SIGNAL(autotypeRejected()), SLOT(relockPendingDatabase()));
     connect(m_databaseOpenDialog.data(), &DatabaseOpenDialog::dialogFinished,
             this, &DatabaseTabWidget::databaseUnlockDialogFinished);
+    connect(this, SIGNAL(databaseOpened(DatabaseWidget*)), SLOT(updateGlobalSearchDatabases()));
+    connect(this, SIGNAL(databaseUnlocked(DatabaseWidget*)), SLOT(updateGlobalSearchDatabases()));
+    connect(this, SIGNAL(databaseLocked(DatabaseWidget*)), m_releaseMemoryTimer, SLOT(start()));
     // clang-format on
 
 #ifdef Q_OS_MACOS
@@ -220,6 +236,12 @@ void DatabaseTabWidget::addDatabaseTab(DatabaseWidget* dbWidget, bool inBackgrou
     connect(dbWidget, SIGNAL(databaseUnlocked()), SLOT(emitDatabaseLockChanged()));
     connect(dbWidget, SIGNAL(databaseLocked()), SLOT(updateTabName()));
     connect(dbWidget, SIGNAL(databaseLocked()), SLOT(emitDatabaseLockChanged()));
+    connect(dbWidget,
+            &DatabaseWidget::requestUnlockAllDatabases,
+            this,
+            [this, dbWidget](const QSharedPointer<CompositeKey>& key) { unlockLockedDatabases(key, dbWidget); });
+
+    updateUnlockAllAvailable();
 }
 
 void DatabaseTabWidget::importCsv()
@@ -261,16 +283,79 @@ void DatabaseTabWidget::mergeDatabase(const QString& filePath)
 void DatabaseTabWidget::importKeePass1Database()
 {
     QString filter = QString("%1 (*.kdb);;%2 (*)").arg(tr("KeePass 1 database"), tr("All files"));
-    QString fileName = fileDialog()->getOpenFileName(this, tr("Open KeePass 1 database"), QString(), filter);
+    const QStringList fileNames =
+        fileDialog()->getOpenFileNames(this, tr("Open KeePass 1 database"), QString(), filter);
 
-    if (fileName.isEmpty()) {
+    if (fileNames.isEmpty()) {
+        return;
+    } else if (fileNames.size() > 1) {
+        importKeePass1Databases(fileNames);
         return;
     }
 
     auto db = QSharedPointer<Database>::create();
     auto* dbWidget = new DatabaseWidget(db, this);
     addDatabaseTab(dbWidget);
-    dbWidget->switchToImportKeepass1(fileName);
+    dbWidget->switchToImportKeepass1(fileNames.first());
+}
+
+/**
+ * Import several KeePass1 databases sharing the same password into one new
+ * database. The files are read concurrently while a progress dialog is shown.
+ */
+void DatabaseTabWidget::importKeePass1Databases(const QStringList& fileNames)
+{
+    bool ok = false;
+    const QString password = QInputDialog::getText(this,
+                                                   tr("Import KeePass 1 databases"),
+                                                   tr("Password of the KeePass 1 databases:"),
+                                                   QLineEdit::Password,
+                                                   QString(),
+                                                   &ok);
+    if (!ok) {
+        return;
+    }
+
+    auto db = execNewDatabaseWizard();
+    if (!db) {
+        return;
+    }
+
+    QProgressDialog progress(tr("Importing KeePass 1 databases…"), tr("Cancel"), 0, fileNames.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(0);
+    progress.setValue(0);
+
+    KeePass1Importer importer;
+    importer.setPassword(password);
+    connect(&progress, &QProgressDialog::canceled, &importer, &KeePass1Importer::cancel);
+    connect(&importer, &KeePass1Importer::fileImported, &progress, [&progress](int done, int total) {
+        progress.setLabelText(tr("Imported %1 of %2 KeePass 1 databases…").arg(done).arg(total));
+        progress.setValue(done);
+    });
+
+    QStringList failures;
+    for (const auto& result : importer.import(fileNames, db.data())) {
+        if (!result.error.isEmpty()) {
+            failures << QString("%1: %2").arg(QFileInfo(result.path).fileName(), result.error);
+        }
+    }
+
+    if (failures.size() == fileNames.size()) {
+        MessageBox::critical(this,
+                             tr("Import KeePass 1 databases"),
+                             tr("None of the databases could be imported:\n%1").arg(failures.join("\n")));
+        return;
+    }
+
+    auto* dbWidget = new DatabaseWidget(db, this);
+    addDatabaseTab(dbWidget);
+
+    if (!failures.isEmpty()) {
+        MessageBox::warning(this,
+                            tr("Import KeePass 1 databases"),
+                            tr("Some databases could not be imported:\n%1").arg(failures.join("\n")));
+    }
 }
 
 void DatabaseTabWidget::importOpVaultDatabase()
@@ -343,8 +428,11 @@ bool DatabaseTabWidget::closeDatabaseTab(DatabaseWidget* dbWidget)
     }
 
     removeTab(tabIndex);
+    // The database is only freed with its widget
+    connect(dbWidget, SIGNAL(destroyed()), m_releaseMemoryTimer, SLOT(start()));
     dbWidget->deleteLater();
     toggleTabbar();
+    updateUnlockAllAvailable();
     emit databaseClosed(filePath);
     return true;
 }
@@ -491,6 +579,70 @@ void DatabaseTabWidget::showDatabaseSettings()
     currentDatabaseWidget()->switchToDatabaseSettings();
 }
 
+/**
+ * Search all unlocked databases in parallel, starting with the search
+ * text of the current tab. Activating a result shows it in its tab.
+ */
+void DatabaseTabWidget::searchAllDatabases()
+{
+    if (!m_globalSearchDialog) {
+        m_globalSearchDialog = new GlobalSearchDialog(this);
+        connect(m_globalSearchDialog.data(),
+                &GlobalSearchDialog::entryActivated,
+                this,
+                &DatabaseTabWidget::showGlobalSearchEntry);
+        m_globalSearchDialog->setDatabases(unlockedDatabases());
+
+        auto* dbWidget = currentDatabaseWidget();
+        m_globalSearchDialog->setSearchText(dbWidget ? dbWidget->getCurrentSearch() : QString());
+    }
+
+    m_globalSearchDialog->show();
+    m_globalSearchDialog->raise();
+    m_globalSearchDialog->activateWindow();
+}
+
+void DatabaseTabWidget::updateGlobalSearchDatabases()
+{
+    // Locked and closed databases leave the search on their own
+    if (m_globalSearchDialog) {
+        m_globalSearchDialog->setDatabases(unlockedDatabases());
+    }
+}
+
+void DatabaseTabWidget::showGlobalSearchEntry(Entry* entry)
+{
+    for (int i = 0; i < count(); ++i) {
+        auto* dbWidget = databaseWidgetFromIndex(i);
+        if (dbWidget && dbWidget->database() && dbWidget->database().data() == entry->database()) {
+            setCurrentIndex(i);
+            dbWidget->showEntry(entry);
+            return;
+        }
+    }
+}
+
+/**
+ * Return the memory of locked and closed databases to the operating system.
+ * Their data is released by then, but the caches and the heap still hold it.
+ */
+void DatabaseTabWidget::releaseFreeMemory()
+{
+    MemoryUsage::releaseFreeMemory();
+}
+
+QList<QSharedPointer<Database>> DatabaseTabWidget::unlockedDatabases() const
+{
+    QList<QSharedPointer<Database>> databases;
+    for (int i = 0; i < count(); ++i) {
+        auto* dbWidget = databaseWidgetFromIndex(i);
+        if (dbWidget && !dbWidget->isLocked() && dbWidget->database()) {
+            databases.append(dbWidget->database());
+        }
+    }
+    return databases;
+}
+
 bool DatabaseTabWidget::isReadOnly(int index) const
 {
     if (count() == 0) {
@@ -733,6 +885,47 @@ void DatabaseTabWidget::emitDatabaseLockChanged()
     } else {
         emit databaseUnlocked(dbWidget);
     }
+
+    updateUnlockAllAvailable();
+}
+
+/**
+ * Try the credentials entered for one database on all other locked databases.
+ *
+ * Every unlock waits for its key derivation in a nested event loop, so the
+ * attempts are started from queued calls. This lets all key derivations run
+ * on the thread pool at the same time instead of one after another.
+ *
+ * @param key composite key entered by the user
+ * @param origin widget the key was entered in
+ */
+void DatabaseTabWidget::unlockLockedDatabases(const QSharedPointer<CompositeKey>& key, DatabaseWidget* origin)
+{
+    for (int i = 0, c = count(); i < c; ++i) {
+        auto* dbWidget = databaseWidgetFromIndex(i);
+        if (!dbWidget || dbWidget == origin || !dbWidget->isLocked()) {
+            continue;
+        }
+        QTimer::singleShot(0, dbWidget, [dbWidget, key] { dbWidget->performUnlockDatabase(key); });
+    }
+}
+
+/**
+ * Offer the unlock all option only while more than one database is locked.
+ */
+void DatabaseTabWidget::updateUnlockAllAvailable()
+{
+    QList<DatabaseWidget*> lockedWidgets;
+    for (int i = 0, c = count(); i < c; ++i) {
+        auto* dbWidget = databaseWidgetFromIndex(i);
+        if (dbWidget && dbWidget->isLocked()) {
+            lockedWidgets.append(dbWidget);
+        }
+    }
+
+    for (auto* dbWidget : asConst(lockedWidgets)) {
+        dbWidget->setUnlockAllAvailable(lockedWidgets.size() > 1);
+    }
 }
 
 void DatabaseTabWidget::performGlobalAutoType()
@@ -24,10 +24,14 @@
 #include <QPointer>
 #include <QTabWidget>
 
+class CompositeKey;
 class Database;
 class DatabaseWidget;
 class DatabaseWidgetStateSync;
 class DatabaseOpenWidget;
+class Entry;
+class GlobalSearchDialog;
+class QTimer;
 
 class DatabaseTabWidget : public QTabWidget
 {
@@ -81,6 +85,7 @@ public slots:
     void showDatabaseSecurity();
     void showDatabaseReports();
     void showDatabaseSettings();
+    void searchAllDatabases();
     void performGlobalAutoType();
     void performBrowserUnlock();
 
@@ -100,15 +105,24 @@ private slots:
     void toggleTabbar();
     void emitActivateDatabaseChanged();
     void emitDatabaseLockChanged();
+    void updateGlobalSearchDatabases();
+    void showGlobalSearchEntry(Entry* entry);
+    void releaseFreeMemory();
 
 private:
     QSharedPointer<Database> execNewDatabaseWizard();
+    void importKeePass1Databases(const QStringList& fileNames);
     void updateLastDatabases(const QString& filename);
     bool warnOnExport();
+    void unlockLockedDatabases(const QSharedPointer<CompositeKey>& key, DatabaseWidget* origin);
+    void updateUnlockAllAvailable();
+    QList<QSharedPointer<Database>> unlockedDatabases() const;
 
     QPointer<DatabaseWidgetStateSync> m_dbWidgetStateSync;
     QPointer<DatabaseWidget> m_dbWidgetPendingLock;
     QPointer<DatabaseOpenDialog> m_databaseOpenDialog;
+    QPointer<GlobalSearchDialog> m_globalSearchDialog;
+    QTimer* m_releaseMemoryTimer;
 };
 
 #endif // KEEPASSX_DATABASETABWIDGET_H
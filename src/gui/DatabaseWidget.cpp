@@ -22,6 +22,7 @@
 #include <QApplication>
 #include <QCheckBox>
 #include <QDesktopServices>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QHBoxLayout>
 #include <QHeaderView>
@@ -33,10 +34,28 @@
 #include <QSplitter>
 #include <QTextEdit>
 
+#include <algorithm>
+
+namespace
+{
+    /**
+     * Find the group of a snapshot that corresponds to a group of the live database.
+     */
+    const Group* snapshotGroup(const Database* snapshot, const QUuid& uuid)
+    {
+        for (const Group* group : snapshot->rootGroup()->groupsRecursive(true)) {
+            if (group->uuid() == uuid) {
+                return group;
+            }
+        }
+        return nullptr;
+    }
+} // namespace
+
 #include "autotype/AutoType.h"
+#include "core/AsyncTask.h"
 #include "core/Config.h"
 #include "core/Database.h"
-#include "core/EntrySearcher.h"
 #include "core/FileWatcher.h"
 #include "core/Group.h"
 #include "core/Merger.h"
@@ -201,18 +220,27 @@ DatabaseWidget::DatabaseWidget(QSharedPointer<Database> db, QWidget* parent)
     connect(m_reportsDialog, SIGNAL(editFinished(bool)), SLOT(switchToMainView(bool)));
     connect(m_databaseSettingDialog, SIGNAL(editFinished(bool)), SLOT(switchToMainView(bool)));
     connect(m_databaseOpenWidget, SIGNAL(dialogFinished(bool)), SLOT(loadDatabase(bool)));
+    connect(m_databaseOpenWidget, &DatabaseOpenWidget::unlockAllRequested, this, &DatabaseWidget::requestUnlockAllDatabases);
     connect(m_keepass1OpenWidget, SIGNAL(dialogFinished(bool)), SLOT(loadDatabase(bool)));
     connect(m_opVaultOpenWidget, SIGNAL(dialogFinished(bool)), SLOT(loadDatabase(bool)));
     connect(m_csvImportWizard, SIGNAL(importFinished(bool)), SLOT(csvImportFinished(bool)));
     connect(this, SIGNAL(currentChanged(int)), SLOT(emitCurrentModeChanged()));
     // clang-format on
 
+    connect(&m_autoSaveScheduler, SIGNAL(saveRequested()), SLOT(autoSave()));
     connectDatabaseSignals();
 
     m_blockAutoSave = false;
 
     m_EntrySearcher = new EntrySearcher(false);
+    m_EntrySearcher->setUseIndex(true);
     m_searchLimitGroup = config()->get(Config::SearchLimitGroup).toBool();
+    m_searchPool.setMaxThreadCount(1);
+    m_searchId = 0;
+    m_searchPending = false;
+    m_searchResultCaseSensitive = false;
+    m_searchResultModificationCount = 0;
+    m_searchResultTreeGeneration = 0;
 
 #ifdef WITH_XC_SSHAGENT
     if (sshAgent()->isEnabled()) {
@@ -241,6 +269,8 @@ DatabaseWidget::DatabaseWidget(const QString& filePath, QWidget* parent)
 
 DatabaseWidget::~DatabaseWidget()
 {
+    cancelSearch();
+    m_searchPool.waitForDone();
     delete m_EntrySearcher;
 }
 
@@ -269,6 +299,11 @@ bool DatabaseWidget::isLocked() const
     return currentMode() == Mode::LockedMode;
 }
 
+void DatabaseWidget::setUnlockAllAvailable(bool available)
+{
+    m_databaseOpenWidget->setUnlockAllAvailable(available);
+}
+
 bool DatabaseWidget::isSaving() const
 {
     return m_db->isSaving();
@@ -387,6 +422,8 @@ void DatabaseWidget::replaceDatabase(QSharedPointer<Database> db)
         newParentUuid = m_newParent->uuid();
     }
 
+    interruptSearch(true);
+
     // TODO: instead of increasing the ref count temporarily, there should be a clean
     // break from the old database. Without this crashes occur due to the change
     // signals triggering dangling pointers.
@@ -491,14 +528,20 @@ void DatabaseWidget::deleteEntries(QList<Entry*> selectedEntries)
     }
 
     // Find references to selected entries and prompt for direction if necessary
+    QSet<const Entry*> selected;
+    for (auto* entry : asConst(selectedEntries)) {
+        selected.insert(entry);
+    }
+
     auto it = selectedEntries.begin();
     while (it != selectedEntries.end()) {
         auto references = m_db->rootGroup()->referencesRecursive(*it);
         if (!references.isEmpty()) {
             // Ignore references that are selected for deletion
-            for (auto* entry : selectedEntries) {
-                references.removeAll(entry);
-            }
+            references.erase(std::remove_if(references.begin(),
+                                            references.end(),
+                                            [&selected](const Entry* entry) { return selected.contains(entry); }),
+                             references.end());
 
             if (!references.isEmpty()) {
                 // Prompt for reference handling
@@ -519,6 +562,7 @@ void DatabaseWidget::deleteEntries(QList<Entry*> selectedEntries)
                         entry->replaceReferencesWithValues(*it);
                     }
                 } else if (result == MessageBox::Skip) {
+                    selected.remove(*it);
                     it = selectedEntries.erase(it);
                     continue;
                 }
@@ -529,13 +573,9 @@ void DatabaseWidget::deleteEntries(QList<Entry*> selectedEntries)
     }
 
     if (permanent) {
-        for (auto* entry : asConst(selectedEntries)) {
-            delete entry;
-        }
+        m_db->deleteEntries(selectedEntries);
     } else {
-        for (auto* entry : asConst(selectedEntries)) {
-            m_db->recycleEntry(entry);
-        }
+        m_db->recycleEntries(selectedEntries);
     }
 
     refreshSearch();
@@ -1058,6 +1098,8 @@ void DatabaseWidget::switchToGroupEdit(Group* group, bool create)
 
 void DatabaseWidget::connectDatabaseSignals()
 {
+    m_autoSaveScheduler.setDatabase(m_db.data());
+
     // relayed Database events
     connect(m_db.data(),
             SIGNAL(filePathChanged(QString, QString)),
@@ -1066,7 +1108,34 @@ void DatabaseWidget::connectDatabaseSignals()
     connect(m_db.data(), SIGNAL(databaseModified()), SIGNAL(databaseModified()));
     connect(m_db.data(), SIGNAL(databaseModified()), SLOT(onDatabaseModified()));
     connect(m_db.data(), SIGNAL(databaseSaved()), SIGNAL(databaseSaved()));
+    connect(m_db.data(), &Database::databaseSaveFailed, this, [this](const QString& error) {
+        showMessage(tr("Writing the database failed: %1").arg(error),
+                    MessageWidget::Error,
+                    true,
+                    MessageWidget::LongAutoHideTimeout);
+    });
     connect(m_db.data(), SIGNAL(databaseFileChanged()), this, SLOT(reloadDatabaseFile()));
+    connect(m_db.data(), &Database::skippedDataLoaded, this, [this] {
+        // the history and attachments of a progressive open arrived
+        if (currentSelectedEntry()) {
+            m_previewView->setEntry(currentSelectedEntry());
+        }
+    });
+
+    // Searches run on a snapshot, but their results hold live entries and
+    // should include the changes made to the tree
+    Database* db = m_db.data();
+    auto interrupt = [this, db](bool searchAgain) {
+        if (db == m_db.data()) {
+            interruptSearch(searchAgain);
+        }
+    };
+    connect(db, &Database::entryAboutToRemove, this, [interrupt] { interrupt(true); });
+    connect(db, &Database::groupAboutToAdd, this, [interrupt] { interrupt(true); });
+    connect(db, &Database::groupAboutToRemove, this, [interrupt] { interrupt(true); });
+    connect(db, &Database::groupAboutToMove, this, [interrupt] { interrupt(true); });
+    connect(db, &Database::bulkUpdateStarted, this, [interrupt] { interrupt(true); });
+    connect(db, &Database::dataAboutToBeReleased, this, [interrupt] { interrupt(false); });
 }
 
 void DatabaseWidget::loadDatabase(bool accepted)
@@ -1116,6 +1185,7 @@ void DatabaseWidget::mergeDatabase(bool accepted)
         }
 
         Merger merger(srcDb.data(), m_db.data());
+        merger.setUseMergeBase(true);
         QStringList changeList = merger.merge();
 
         if (!changeList.isEmpty()) {
@@ -1205,11 +1275,7 @@ void DatabaseWidget::entryActivationSignalReceived(Entry* entry, EntryModel::Mod
         }
         break;
     case EntryModel::ParentGroup:
-        // Call this first to clear out of search mode, otherwise
-        // the desired entry is not properly selected
-        endSearch();
-        m_groupView->setCurrentGroup(entry->group());
-        m_entryView->setCurrentEntry(entry);
+        showEntry(entry);
         break;
     // TODO: switch to 'Notes' tab in details view/pane
     // case EntryModel::Notes:
@@ -1328,13 +1394,31 @@ void DatabaseWidget::performUnlockDatabase(const QString& password, const QStrin
     }
 }
 
+/**
+ * Try to unlock the database with a key that was entered for another database.
+ * Nothing happens if the database is not waiting on its unlock screen.
+ */
+void DatabaseWidget::performUnlockDatabase(const QSharedPointer<CompositeKey>& key)
+{
+    if (currentWidget() == m_databaseOpenWidget && m_databaseOpenWidget->filename() == m_db->filePath()) {
+        m_databaseOpenWidget->unlockWithKey(key);
+    }
+}
+
 void DatabaseWidget::refreshSearch()
 {
-    if (isSearchActive()) {
+    if (isSearchActive() || m_searchPending) {
         search(m_lastSearchText);
     }
 }
 
+/**
+ * Start a search in the background, the results are displayed once it finishes.
+ * A search started before that is cancelled and its results are discarded.
+ *
+ * The search runs on a read snapshot of the database, so the database can be
+ * edited meanwhile. Its results are mapped back to the live entries by UUID.
+ */
 void DatabaseWidget::search(const QString& searchtext)
 {
     if (searchtext.isEmpty()) {
@@ -1342,14 +1426,103 @@ void DatabaseWidget::search(const QString& searchtext)
         return;
     }
 
-    emit searchModeAboutToActivate();
-
+    m_lastSearchText = searchtext;
     Group* searchGroup = m_searchLimitGroup ? currentGroup() : m_db->rootGroup();
 
-    QList<Entry*> searchResult = m_EntrySearcher->search(searchtext, searchGroup);
+    // Typing usually refines the displayed search, so only its results have to be searched
+    const bool refine = isSearchActive() && m_searchResultGroup == searchGroup
+                        && m_searchResultCaseSensitive == m_EntrySearcher->isCaseSensitive()
+                        && m_searchResultModificationCount == m_db->modificationCount()
+                        && m_searchResultTreeGeneration == Group::treeGeneration()
+                        && m_EntrySearcher->narrows(searchtext, m_searchResultText);
+    QList<QUuid> entryUuids;
+    if (refine) {
+        entryUuids.reserve(m_searchResult.size());
+        for (const Entry* entry : asConst(m_searchResult)) {
+            entryUuids.append(entry->uuid());
+        }
+    }
+    const QUuid searchGroupUuid = searchGroup->uuid();
+
+    cancelSearch();
+    const quint64 searchId = m_searchId;
+    const bool caseSensitive = m_EntrySearcher->isCaseSensitive();
+    const quint64 modificationCount = m_db->modificationCount();
+    const quint64 treeGeneration = Group::treeGeneration();
+    auto searcher = QSharedPointer<EntrySearcher>::create(*m_EntrySearcher);
+    searcher->setCancelToken(m_searchCancelToken);
+    QSharedPointer<const Database> snapshot = m_db->readSnapshot();
+    // The index follows entries through signals, create it in the GUI thread
+    snapshot->searchIndex();
+    m_searchPending = true;
+
+    if (!isSearchActive()) {
+        m_searchingLabel->setText(tr("Searching..."));
+        m_searchingLabel->setVisible(true);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    AsyncTask::runThenCallback(
+        &m_searchPool,
+        [searcher, snapshot, searchtext, searchGroupUuid, entryUuids, refine] {
+            QList<Entry*> found;
+            if (refine) {
+                QList<Entry*> entries;
+                entries.reserve(entryUuids.size());
+                for (const QUuid& uuid : entryUuids) {
+                    Entry* entry = snapshot->rootGroup()->findEntryByUuid(uuid);
+                    if (entry) {
+                        entries.append(entry);
+                    }
+                }
+                found = searcher->searchEntries(searchtext, entries);
+            } else if (const Group* group = snapshotGroup(snapshot.data(), searchGroupUuid)) {
+                found = searcher->search(searchtext, group);
+            }
+
+            QList<QUuid> foundUuids;
+            foundUuids.reserve(found.size());
+            for (const Entry* entry : asConst(found)) {
+                foundUuids.append(entry->uuid());
+            }
+            return foundUuids;
+        },
+        this,
+        [=](const QList<QUuid>& foundUuids) {
+            // Superseded or cancelled
+            if (searchId != m_searchId) {
+                return;
+            }
+
+            // Entries deleted since the snapshot are left out
+            QList<Entry*> searchResult;
+            searchResult.reserve(foundUuids.size());
+            for (const QUuid& uuid : foundUuids) {
+                Entry* entry = m_db->rootGroup()->findEntryByUuid(uuid);
+                if (entry) {
+                    searchResult.append(entry);
+                }
+            }
+
+            m_searchPending = false;
+            m_searchResult = searchResult;
+            m_searchResultText = searchtext;
+            m_searchResultGroup = searchGroup;
+            m_searchResultCaseSensitive = caseSensitive;
+            m_searchResultModificationCount = modificationCount;
+            m_searchResultTreeGeneration = treeGeneration;
+            showSearchResults(searchResult);
+
+            emit searchFinished(static_cast<int>(timer.elapsed()));
+        });
+}
+
+void DatabaseWidget::showSearchResults(const QList<Entry*>& searchResult)
+{
+    emit searchModeAboutToActivate();
 
     m_entryView->displaySearch(searchResult);
-    m_lastSearchText = searchtext;
 
     // Display a label detailing our search results
     if (!searchResult.isEmpty()) {
@@ -1366,6 +1539,44 @@ void DatabaseWidget::search(const QString& searchtext)
     emit searchModeActivated();
 }
 
+/**
+ * Cancel the running search, it stops as soon as possible and its results are ignored.
+ */
+void DatabaseWidget::cancelSearch()
+{
+    m_searchCancelToken.cancel();
+    m_searchCancelToken = EntrySearcher::CancelToken();
+    ++m_searchId;
+}
+
+/**
+ * Stop a running search and wait for it before the database tree changes.
+ *
+ * @param searchAgain repeat the search once the change is done
+ */
+void DatabaseWidget::interruptSearch(bool searchAgain)
+{
+    // The displayed results might lose entries
+    m_searchResult.clear();
+    m_searchResultText.clear();
+
+    if (!m_searchPending) {
+        return;
+    }
+
+    cancelSearch();
+    m_searchPool.waitForDone();
+    m_searchPending = false;
+
+    if (searchAgain) {
+        QTimer::singleShot(0, this, [this] {
+            if (!m_searchPending && !m_lastSearchText.isEmpty()) {
+                search(m_lastSearchText);
+            }
+        });
+    }
+}
+
 void DatabaseWidget::setSearchCaseSensitive(bool state)
 {
     m_EntrySearcher->setCaseSensitive(state);
@@ -1383,9 +1594,10 @@ void DatabaseWidget::onGroupChanged()
     auto group = m_groupView->currentGroup();
 
     // Intercept group changes if in search mode
-    if (isSearchActive() && m_searchLimitGroup) {
+    const bool searching = isSearchActive() || m_searchPending;
+    if (searching && m_searchLimitGroup) {
         search(m_lastSearchText);
-    } else if (isSearchActive()) {
+    } else if (searching) {
         endSearch();
     } else {
         m_entryView->displayGroup(group);
@@ -1407,20 +1619,67 @@ void DatabaseWidget::onGroupChanged()
 void DatabaseWidget::onDatabaseModified()
 {
     if (!m_blockAutoSave && config()->get(Config::AutoSaveAfterEveryChange).toBool() && !m_db->isReadOnly()) {
-        save();
+        // Bursts of changes, like bulk edits or merges, are saved once
+        m_autoSaveScheduler.setDelay(config()->get(Config::AutoSaveDelay).toInt());
+        m_autoSaveScheduler.schedule();
     } else {
         // Only block once, then reset
         m_blockAutoSave = false;
     }
 }
 
+void DatabaseWidget::autoSave()
+{
+    // The database may have been saved, locked or closed in the meantime
+    if (isLocked() || !m_db->isModified() || m_db->isReadOnly()
+        || !config()->get(Config::AutoSaveAfterEveryChange).toBool()) {
+        return;
+    }
+
+    if (config()->get(Config::BackgroundSave).toBool() && !m_db->filePath().isEmpty()) {
+        // A running save emits databaseModified() again when it
+        // finishes if there are changes it did not include
+        m_db->saveInBackground(nullptr,
+                               config()->get(Config::UseAtomicSaves).toBool(),
+                               config()->get(Config::BackupBeforeSave).toBool());
+    } else {
+        save();
+    }
+}
+
 QString DatabaseWidget::getCurrentSearch()
 {
     return m_lastSearchText;
 }
 
+/**
+ * Leave search mode and select the entry in its group.
+ *
+ * @param entry entry of this database
+ * @return false if the entry cannot be shown, e.g. while editing
+ */
+bool DatabaseWidget::showEntry(Entry* entry)
+{
+    if (!entry || !entry->group() || entry->database() != m_db.data() || isEntryEditActive()
+        || isGroupEditActive()) {
+        return false;
+    }
+
+    // Call this first to clear out of search mode, otherwise
+    // the desired entry is not properly selected
+    endSearch();
+    m_groupView->setCurrentGroup(entry->group());
+    m_entryView->setCurrentEntry(entry);
+    return true;
+}
+
 void DatabaseWidget::endSearch()
 {
+    cancelSearch();
+    m_searchPending = false;
+    m_searchResult.clear();
+    m_searchResultText.clear();
+
     if (isSearchActive()) {
         // Show the normal entry view of the current group
         emit listModeAboutToActivate();
@@ -22,14 +22,18 @@
 #include <QFileSystemWatcher>
 #include <QScopedPointer>
 #include <QStackedWidget>
+#include <QThreadPool>
 #include <QTimer>
 
 #include "DatabaseOpenDialog.h"
 #include "config-keepassx.h"
+#include "core/AutoSaveScheduler.h"
+#include "core/EntrySearcher.h"
 #include "gui/MessageWidget.h"
 #include "gui/csvImport/CsvImportWizard.h"
 #include "gui/entry/EntryModel.h"
 
+class CompositeKey;
 class DatabaseOpenWidget;
 class KeePass1OpenWidget;
 class OpVaultOpenWidget;
@@ -41,7 +45,6 @@ class EditEntryWidget;
 class EditGroupWidget;
 class Entry;
 class EntryView;
-class EntrySearcher;
 class Group;
 class GroupView;
 class QFile;
@@ -82,6 +85,7 @@ public:
 
     DatabaseWidget::Mode currentMode() const;
     bool isLocked() const;
+    void setUnlockAllAvailable(bool available);
     bool isSaving() const;
     bool isSorted() const;
     bool isSearchActive() const;
@@ -91,6 +95,7 @@ public:
 
     QString getCurrentSearch();
     void refreshSearch();
+    bool showEntry(Entry* entry);
 
     GroupView* groupView();
     EntryView* entryView();
@@ -141,12 +146,14 @@ signals:
     void
     requestOpenDatabase(const QString& filePath, bool inBackground, const QString& password, const QString& keyFile);
     void databaseMerged(QSharedPointer<Database> mergedDb);
+    void requestUnlockAllDatabases(const QSharedPointer<CompositeKey>& key);
     void groupContextMenuRequested(const QPoint& globalPos);
     void entryContextMenuRequested(const QPoint& globalPos);
     void listModeAboutToActivate();
     void listModeActivated();
     void searchModeAboutToActivate();
     void searchModeActivated();
+    void searchFinished(int elapsedMs);
     void mainSplitterSizesChanged();
     void previewSplitterSizesChanged();
     void entryViewStateChanged();
@@ -205,6 +212,7 @@ public slots:
     void switchToOpenDatabase(const QString& filePath, const QString& password, const QString& keyFile);
     void switchToCsvImport(const QString& filePath);
     void performUnlockDatabase(const QString& password, const QString& keyfile = {});
+    void performUnlockDatabase(const QSharedPointer<CompositeKey>& key);
     void csvImportFinished(bool accepted);
     void switchToImportKeepass1(const QString& filePath);
     void switchToImportOpVault(const QString& fileName);
@@ -240,6 +248,7 @@ private slots:
     void onEntryChanged(Entry* entry);
     void onGroupChanged();
     void onDatabaseModified();
+    void autoSave();
     void connectDatabaseSignals();
     void loadDatabase(bool accepted);
     void unlockDatabase(bool accepted);
@@ -258,6 +267,9 @@ private:
     void performIconDownloads(const QList<Entry*>& entries, bool force = false);
     bool performSave(QString& errorMessage, const QString& fileName = {});
     Entry* currentSelectedEntry();
+    void showSearchResults(const QList<Entry*>& searchResult);
+    void cancelSearch();
+    void interruptSearch(bool searchAgain);
 
     QSharedPointer<Database> m_db;
 
@@ -293,9 +305,22 @@ private:
     EntrySearcher* m_EntrySearcher;
     QString m_lastSearchText;
     bool m_searchLimitGroup;
+    // Searches run one at a time outside the GUI thread
+    QThreadPool m_searchPool;
+    EntrySearcher::CancelToken m_searchCancelToken;
+    quint64 m_searchId;
+    bool m_searchPending;
+    // Displayed results, a refined search string only has to look at these
+    QList<Entry*> m_searchResult;
+    QString m_searchResultText;
+    QPointer<Group> m_searchResultGroup;
+    bool m_searchResultCaseSensitive;
+    quint64 m_searchResultModificationCount;
+    quint64 m_searchResultTreeGeneration;
 
     // Autoreload
     bool m_blockAutoSave;
+    AutoSaveScheduler m_autoSaveScheduler;
 };
 
 #endif // KEEPASSX_DATABASEWIDGET_H
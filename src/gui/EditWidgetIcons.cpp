@@ -132,8 +132,7 @@ void EditWidgetIcons::load(const QUuid& currentUuid,
     m_currentUuid = currentUuid;
     setUrl(url);
 
-    m_customIconModel->setIcons(database->metadata()->customIconsPixmaps(IconSize::Default),
-                                database->metadata()->customIconsOrder());
+    m_customIconModel->setMetadata(database->metadata());
 
     QUuid iconUuid = iconStruct.uuid;
     if (iconUuid.isNull()) {
@@ -294,8 +293,7 @@ bool EditWidgetIcons::addCustomIcon(const QImage& icon)
         if (uuid.isNull()) {
             uuid = QUuid::createUuid();
             m_db->metadata()->addCustomIcon(uuid, scaledicon);
-            m_customIconModel->setIcons(m_db->metadata()->customIconsPixmaps(IconSize::Default),
-                                        m_db->metadata()->customIconsOrder());
+            m_customIconModel->setMetadata(m_db->metadata());
             added = true;
         }
 
@@ -378,8 +376,7 @@ void EditWidgetIcons::removeCustomIcon()
 
             // Remove the icon from the database
             m_db->metadata()->removeCustomIcon(iconUuid);
-            m_customIconModel->setIcons(m_db->metadata()->customIconsPixmaps(IconSize::Default),
-                                        m_db->metadata()->customIconsOrder());
+            m_customIconModel->setMetadata(m_db->metadata());
 
             // Reset the current icon view
             updateRadioButtonDefaultIcons();
@@ -27,6 +27,7 @@
 #include "entry/EntryAttachmentsModel.h"
 #include "gui/Clipboard.h"
 #include "gui/Icons.h"
+#include "gui/TotpTicker.h"
 #if defined(WITH_XC_KEESHARE)
 #include "keeshare/KeeShare.h"
 #endif
@@ -34,6 +35,8 @@
 namespace
 {
     constexpr int GeneralTabIndex = 0;
+    // Selection changes coming faster than this are shown once they settle
+    constexpr int UpdateDebounceMs = 75;
 }
 
 EntryPreviewWidget::EntryPreviewWidget(QWidget* parent)
@@ -42,6 +45,9 @@ EntryPreviewWidget::EntryPreviewWidget(QWidget* parent)
     , m_locked(false)
     , m_currentEntry(nullptr)
     , m_currentGroup(nullptr)
+    , m_entryUpdatePending(false)
+    , m_advancedTabPending(false)
+    , m_autotypeTabPending(false)
     , m_selectedTabEntry(0)
     , m_selectedTabGroup(0)
 {
@@ -69,12 +75,17 @@ EntryPreviewWidget::EntryPreviewWidget(QWidget* parent)
     connect(m_ui->entryUrlLabel, SIGNAL(linkActivated(QString)), SLOT(openEntryUrl()));
 
     connect(m_ui->entryTotpButton, SIGNAL(toggled(bool)), m_ui->entryTotpLabel, SLOT(setVisible(bool)));
+    connect(m_ui->entryTotpButton, SIGNAL(toggled(bool)), SLOT(updateTotpLabel()));
     connect(m_ui->entryCloseButton, SIGNAL(clicked()), SLOT(hide()));
     connect(m_ui->togglePasswordButton, SIGNAL(clicked(bool)), SLOT(setPasswordVisible(bool)));
     connect(m_ui->toggleEntryNotesButton, SIGNAL(clicked(bool)), SLOT(setEntryNotesVisible(bool)));
     connect(m_ui->toggleGroupNotesButton, SIGNAL(clicked(bool)), SLOT(setGroupNotesVisible(bool)));
     connect(m_ui->entryTabWidget, SIGNAL(tabBarClicked(int)), SLOT(updateTabIndexes()), Qt::QueuedConnection);
-    connect(&m_totpTimer, SIGNAL(timeout()), SLOT(updateTotpLabel()));
+    connect(m_ui->entryTabWidget, SIGNAL(currentChanged(int)), SLOT(fillCurrentEntryTab()));
+
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(UpdateDebounceMs);
+    connect(&m_updateTimer, SIGNAL(timeout()), SLOT(applyPendingUpdate()));
 
     connect(config(), &Config::changed, this, [this](Config::ConfigKey key) {
         if (key == Config::GUI_HidePreviewPanel) {
@@ -98,15 +109,42 @@ EntryPreviewWidget::~EntryPreviewWidget()
 {
 }
 
+/**
+ * Show the entry. The first selection change is shown right away, further
+ * ones that follow within UpdateDebounceMs, like when holding an arrow key
+ * in the entry list, are only shown once the selection settles.
+ */
 void EntryPreviewWidget::setEntry(Entry* selectedEntry)
 {
     if (!selectedEntry) {
+        m_entryUpdatePending = false;
         hide();
         return;
     }
 
     m_currentEntry = selectedEntry;
 
+    const bool debouncing = m_updateTimer.isActive();
+    m_updateTimer.start();
+    if (debouncing) {
+        m_entryUpdatePending = true;
+        return;
+    }
+
+    m_entryUpdatePending = false;
+    updateEntry();
+}
+
+void EntryPreviewWidget::applyPendingUpdate()
+{
+    if (m_entryUpdatePending && m_currentEntry) {
+        m_entryUpdatePending = false;
+        updateEntry();
+    }
+}
+
+void EntryPreviewWidget::updateEntry()
+{
     updateEntryHeaderLine();
     updateEntryTotp();
     updateEntryGeneralTab();
@@ -119,6 +157,7 @@ void EntryPreviewWidget::setEntry(Entry* selectedEntry)
     const int tabIndex = m_ui->entryTabWidget->isTabEnabled(m_selectedTabEntry) ? m_selectedTabEntry : GeneralTabIndex;
     Q_ASSERT(m_ui->entryTabWidget->isTabEnabled(GeneralTabIndex));
     m_ui->entryTabWidget->setCurrentIndex(tabIndex);
+    fillCurrentEntryTab();
 }
 
 void EntryPreviewWidget::setGroup(Group* selectedGroup)
@@ -128,6 +167,7 @@ void EntryPreviewWidget::setGroup(Group* selectedGroup)
         return;
     }
 
+    m_entryUpdatePending = false;
     m_currentGroup = selectedGroup;
     updateGroupHeaderLine();
     updateGroupGeneralTab();
@@ -179,11 +219,13 @@ void EntryPreviewWidget::updateEntryTotp()
     m_ui->entryTotpButton->setChecked(false);
 
     if (hasTotp) {
-        m_totpTimer.start(1000);
+        if (!m_totpConnection) {
+            m_totpConnection = connect(totpTicker(), SIGNAL(tick()), this, SLOT(updateTotpLabel()));
+        }
         updateTotpLabel();
     } else {
         m_ui->entryTotpLabel->clear();
-        m_totpTimer.stop();
+        disconnect(m_totpConnection);
     }
 }
 
@@ -275,17 +317,53 @@ void EntryPreviewWidget::updateEntryGeneralTab()
     m_ui->entryExpirationLabel->setText(expires);
 }
 
+/**
+ * Enable the advanced tab if the entry has something to show on it. The tab
+ * is only filled once it is shown, see fillCurrentEntryTab().
+ */
 void EntryPreviewWidget::updateEntryAdvancedTab()
 {
     Q_ASSERT(m_currentEntry);
-    m_ui->entryAttributesEdit->clear();
-    const EntryAttributes* attributes = m_currentEntry->attributes();
-    const QStringList customAttributes = attributes->customKeys();
-    const bool hasAttributes = !customAttributes.isEmpty();
+    const bool hasAttributes = !m_currentEntry->attributes()->customKeys().isEmpty();
     const bool hasAttachments = !m_currentEntry->attachments()->isEmpty();
-
     setTabEnabled(m_ui->entryTabWidget, m_ui->entryAdvancedTab, hasAttributes || hasAttachments);
-    if (hasAttributes) {
+    m_advancedTabPending = true;
+}
+
+void EntryPreviewWidget::updateEntryAutotypeTab()
+{
+    Q_ASSERT(m_currentEntry);
+    setTabEnabled(m_ui->entryTabWidget, m_ui->entryAutotypeTab, m_currentEntry->autoTypeAssociations()->size() > 0);
+    m_autotypeTabPending = true;
+}
+
+/**
+ * Fill the tab that is shown, if the entry changed since it was last filled.
+ * The attributes, attachments and Auto-Type associations of entries passed
+ * by in the list are not rendered at all.
+ */
+void EntryPreviewWidget::fillCurrentEntryTab()
+{
+    if (!m_currentEntry || m_entryUpdatePending) {
+        return;
+    }
+
+    QWidget* currentTab = m_ui->entryTabWidget->currentWidget();
+    if (currentTab == m_ui->entryAdvancedTab && m_advancedTabPending) {
+        m_advancedTabPending = false;
+        fillEntryAdvancedTab();
+    } else if (currentTab == m_ui->entryAutotypeTab && m_autotypeTabPending) {
+        m_autotypeTabPending = false;
+        fillEntryAutotypeTab();
+    }
+}
+
+void EntryPreviewWidget::fillEntryAdvancedTab()
+{
+    Q_ASSERT(m_currentEntry);
+    m_ui->entryAttributesEdit->clear();
+    const QStringList customAttributes = m_currentEntry->attributes()->customKeys();
+    if (!customAttributes.isEmpty()) {
         QString attributesText;
         for (const QString& key : customAttributes) {
             QString value = m_currentEntry->attributes()->value(key);
@@ -300,7 +378,7 @@ void EntryPreviewWidget::updateEntryAdvancedTab()
     m_ui->entryAttachmentsWidget->setEntryAttachments(m_currentEntry->attachments());
 }
 
-void EntryPreviewWidget::updateEntryAutotypeTab()
+void EntryPreviewWidget::fillEntryAutotypeTab()
 {
     Q_ASSERT(m_currentEntry);
     m_ui->entryAutotypeTree->clear();
@@ -314,7 +392,6 @@ void EntryPreviewWidget::updateEntryAutotypeTab()
     }
 
     m_ui->entryAutotypeTree->addTopLevelItems(items);
-    setTabEnabled(m_ui->entryTabWidget, m_ui->entryAutotypeTab, !items.isEmpty());
 }
 
 void EntryPreviewWidget::updateGroupHeaderLine()
@@ -368,13 +445,17 @@ void EntryPreviewWidget::updateGroupSharingTab()
 void EntryPreviewWidget::updateTotpLabel()
 {
     if (!m_locked && m_currentEntry && m_currentEntry->hasTotp()) {
+        if (m_ui->entryTotpLabel->isHidden()) {
+            // the code is generated when the label is shown
+            return;
+        }
         const QString totpCode = m_currentEntry->totp();
         const QString firstHalf = totpCode.left(totpCode.size() / 2);
         const QString secondHalf = totpCode.mid(totpCode.size() / 2);
         m_ui->entryTotpLabel->setText(firstHalf + " " + secondHalf);
     } else {
         m_ui->entryTotpLabel->clear();
-        m_totpTimer.stop();
+        disconnect(m_totpConnection);
     }
 }
 
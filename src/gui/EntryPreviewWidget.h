@@ -21,6 +21,7 @@
 #include "config-keepassx.h"
 #include "gui/DatabaseWidget.h"
 
+#include <QTimer>
 #include <QWidget>
 
 namespace Ui
@@ -48,11 +49,13 @@ signals:
     void entryUrlActivated(Entry* entry);
 
 private slots:
+    void applyPendingUpdate();
     void updateEntryHeaderLine();
     void updateEntryTotp();
     void updateEntryGeneralTab();
     void updateEntryAdvancedTab();
     void updateEntryAutotypeTab();
+    void fillCurrentEntryTab();
     void setPasswordVisible(bool state);
     void setEntryNotesVisible(bool state);
     void setGroupNotesVisible(bool state);
@@ -69,6 +72,9 @@ private slots:
     void openEntryUrl();
 
 private:
+    void updateEntry();
+    void fillEntryAdvancedTab();
+    void fillEntryAutotypeTab();
     void removeTab(QTabWidget* tabWidget, QWidget* widget);
     void setTabEnabled(QTabWidget* tabWidget, QWidget* widget, bool enabled);
 
@@ -78,7 +84,11 @@ private:
     bool m_locked;
     QPointer<Entry> m_currentEntry;
     QPointer<Group> m_currentGroup;
-    QTimer m_totpTimer;
+    QTimer m_updateTimer;
+    QMetaObject::Connection m_totpConnection;
+    bool m_entryUpdatePending;
+    bool m_advancedTabPending;
+    bool m_autotypeTabPending;
     quint8 m_selectedTabEntry;
     quint8 m_selectedTabGroup;
 };
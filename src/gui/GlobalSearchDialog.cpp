@@ -0,0 +1,126 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GlobalSearchDialog.h"
+
+#include "core/MultiDatabaseSearch.h"
+#include "gui/entry/EntryView.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QTimer>
+#include <QVBoxLayout>
+
+GlobalSearchDialog::GlobalSearchDialog(QWidget* parent)
+    : QDialog(parent)
+    , m_searchEdit(new QLineEdit())
+    , m_statusLabel(new QLabel())
+    , m_entryView(new EntryView())
+    , m_buttonBox(new QDialogButtonBox(QDialogButtonBox::Close))
+    , m_searchTimer(new QTimer(this))
+    , m_search(new MultiDatabaseSearch(this))
+{
+    auto* layout = new QVBoxLayout();
+    layout->addWidget(m_searchEdit);
+    layout->addWidget(m_statusLabel);
+    layout->addWidget(m_entryView);
+    layout->addWidget(m_buttonBox);
+    setLayout(layout);
+
+    setWindowTitle(tr("Search All Databases"));
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(800, 500);
+
+    m_searchEdit->setPlaceholderText(tr("Search all open databases…"));
+    m_searchEdit->setClearButtonEnabled(true);
+    m_entryView->setDragEnabled(false);
+
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(150);
+
+    connect(m_searchEdit, SIGNAL(textChanged(QString)), m_searchTimer, SLOT(start()));
+    connect(m_searchEdit, SIGNAL(returnPressed()), SLOT(activateFirstResult()));
+    connect(m_searchTimer, SIGNAL(timeout()), SLOT(startSearch()));
+    connect(m_search, SIGNAL(resultsChanged()), SLOT(showResults()));
+    connect(m_entryView, &EntryView::entryActivated, this, [this](Entry* entry) { emit entryActivated(entry); });
+    connect(m_buttonBox, SIGNAL(rejected()), SLOT(close()));
+
+    // Keep the ranking until the user sorts by a column
+    m_entryView->displaySearch({});
+    m_entryView->header()->setSortIndicator(-1, Qt::AscendingOrder);
+}
+
+GlobalSearchDialog::~GlobalSearchDialog()
+{
+}
+
+/**
+ * Replace the searched databases, e.g. after one of them was unlocked.
+ */
+void GlobalSearchDialog::setDatabases(const QList<QSharedPointer<Database>>& databases)
+{
+    m_search->setDatabases(databases);
+}
+
+void GlobalSearchDialog::setSearchText(const QString& text)
+{
+    m_searchEdit->setText(text);
+    m_searchEdit->selectAll();
+    m_searchEdit->setFocus();
+    startSearch();
+}
+
+void GlobalSearchDialog::startSearch()
+{
+    m_searchTimer->stop();
+    m_search->search(m_searchEdit->text());
+    showResults();
+}
+
+/**
+ * Display the merged results, called again whenever another database finished searching.
+ */
+void GlobalSearchDialog::showResults()
+{
+    const QList<Entry*>& results = m_search->results();
+
+    const int sortSection = m_entryView->header()->sortIndicatorSection();
+    const Qt::SortOrder sortOrder = m_entryView->header()->sortIndicatorOrder();
+    m_entryView->displaySearch(results);
+    m_entryView->header()->setSortIndicator(sortSection, sortOrder);
+
+    if (m_searchEdit->text().isEmpty()) {
+        m_statusLabel->clear();
+    } else if (m_search->isRunning() && results.isEmpty()) {
+        m_statusLabel->setText(tr("Searching..."));
+    } else if (results.isEmpty()) {
+        m_statusLabel->setText(tr("No Results"));
+    } else {
+        m_statusLabel->setText(tr("Search Results (%1)").arg(results.size()));
+    }
+}
+
+void GlobalSearchDialog::activateFirstResult()
+{
+    if (m_searchTimer->isActive()) {
+        startSearch();
+    }
+    m_entryView->setFocus();
+    m_entryView->setFirstEntryActive();
+}
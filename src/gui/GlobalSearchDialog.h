@@ -0,0 +1,65 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_GLOBALSEARCHDIALOG_H
+#define KEEPASSXC_GLOBALSEARCHDIALOG_H
+
+#include <QDialog>
+#include <QSharedPointer>
+
+class Database;
+class Entry;
+class EntryView;
+class MultiDatabaseSearch;
+class QDialogButtonBox;
+class QLabel;
+class QLineEdit;
+class QTimer;
+
+/**
+ * Search all unlocked databases at once and list the merged results. The
+ * group column names the database of every result.
+ */
+class GlobalSearchDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit GlobalSearchDialog(QWidget* parent = nullptr);
+    ~GlobalSearchDialog() override;
+
+    void setDatabases(const QList<QSharedPointer<Database>>& databases);
+    void setSearchText(const QString& text);
+
+signals:
+    void entryActivated(Entry* entry);
+
+private slots:
+    void startSearch();
+    void showResults();
+    void activateFirstResult();
+
+private:
+    QLineEdit* m_searchEdit;
+    QLabel* m_statusLabel;
+    EntryView* m_entryView;
+    QDialogButtonBox* m_buttonBox;
+    QTimer* m_searchTimer;
+    MultiDatabaseSearch* m_search;
+};
+
+#endif // KEEPASSXC_GLOBALSEARCHDIALOG_H
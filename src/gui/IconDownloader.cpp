@@ -19,7 +19,8 @@
 #include "core/Config.h"
 #include "core/NetworkManager.h"
 
-#include <QHostInfo>
+#include <QDateTime>
+#include <QHostAddress>
 #include <QImageReader>
 #include <QtNetwork>
 
@@ -36,6 +37,7 @@ IconDownloader::IconDownloader(QObject* parent)
 
 IconDownloader::~IconDownloader()
 {
+    cancelNetworkRequests(this);
     abortDownload();
 }
 
@@ -68,34 +70,57 @@ namespace
         QUrl url = convertVariantToUrl(var);
         return url;
     }
+
+    // Turn an entry URL into the URL favicons are looked up for, defaulting to https
+    QUrl normalizedUrl(const QString& entryUrl)
+    {
+        QUrl url(entryUrl);
+        if (url.isValid() && url.scheme().isEmpty()) {
+            url.setUrl(QString("https://%1").arg(url.toString()));
+        }
+        return url;
+    }
+
+    // Favicons fetched during this session, keyed by host. They are only kept in
+    // memory so the list of sites stored in a database never ends up on disk.
+    constexpr qint64 IconCacheTimeToLiveMs = 60 * 60 * 1000;
+    QHash<QString, QPair<QImage, qint64>> iconCache;
+
+    QString iconCacheKey(const QString& host)
+    {
+        // The fallback service may return a different icon than the site itself
+        bool fallback = config()->get(Config::Security_IconDownloadFallback).toBool();
+        return fallback ? host + QStringLiteral("/fallback") : host;
+    }
 } // namespace
 
+/**
+ * Host whose favicon is fetched for the given entry URL.
+ * All URLs sharing a host receive the same icon.
+ *
+ * @param entryUrl entry URL
+ * @return host name or an empty string if the URL is invalid
+ */
+QString IconDownloader::downloadHost(const QString& entryUrl)
+{
+    return normalizedUrl(entryUrl).host();
+}
+
 void IconDownloader::setUrl(const QString& entryUrl)
 {
     m_url = entryUrl;
-    QUrl url(m_url);
-    if (!url.isValid()) {
-        return;
-    }
-
     m_redirects = 0;
     m_urlsToTry.clear();
 
-    if (url.scheme().isEmpty()) {
-        url.setUrl(QString("https://%1").arg(url.toString()));
+    QUrl url = normalizedUrl(m_url);
+    if (!url.isValid()) {
+        return;
     }
 
     QString fullyQualifiedDomain = url.host();
 
-    // Determine if host portion of URL is an IP address by resolving it and
-    // searching for a match with the returned address(es).
-    bool hostIsIp = false;
-    QList<QHostAddress> hostAddressess = QHostInfo::fromName(fullyQualifiedDomain).addresses();
-    for (const auto& addr : hostAddressess) {
-        if (addr.toString() == fullyQualifiedDomain) {
-            hostIsIp = true;
-        }
-    }
+    // Determine if host portion of URL is an IP address, parsing it avoids a blocking DNS lookup
+    bool hostIsIp = QHostAddress().setAddress(fullyQualifiedDomain);
 
     // Determine the second-level domain, if available
     QString secondLevelDomain;
@@ -127,37 +152,61 @@ void IconDownloader::setUrl(const QString& entryUrl)
 
 void IconDownloader::download()
 {
-    if (m_urlsToTry.isEmpty()) {
+    if (m_timeout.isActive()) {
         return;
     }
 
-    if (!m_timeout.isActive()) {
-        int timeout = config()->get(Config::FaviconDownloadTimeout).toInt();
-        m_timeout.start(timeout * 1000);
+    // Report a cached icon or an unusable URL asynchronously, just like a finished download
+    const QString url = m_url;
+    const auto cached = iconCache.value(iconCacheKey(downloadHost(m_url)));
+    if (!cached.first.isNull() && QDateTime::currentMSecsSinceEpoch() - cached.second < IconCacheTimeToLiveMs) {
+        QTimer::singleShot(0, this, [this, url, cached] { emit finished(url, cached.first); });
+        return;
+    }
 
-        // Use the first URL to start the download process
-        // If a favicon is not found, the next URL will be tried
-        fetchFavicon(m_urlsToTry.takeFirst());
+    if (m_urlsToTry.isEmpty()) {
+        QTimer::singleShot(0, this, [this, url] { emit finished(url, {}); });
+        return;
     }
+
+    int timeout = config()->get(Config::FaviconDownloadTimeout).toInt();
+    m_timeout.start(timeout * 1000);
+
+    // Use the first URL to start the download process
+    // If a favicon is not found, the next URL will be tried
+    fetchFavicon(m_urlsToTry.takeFirst());
 }
 
 void IconDownloader::abortDownload()
 {
     if (m_reply) {
         m_reply->abort();
+    } else if (cancelNetworkRequests(this)) {
+        m_timeout.stop();
+        emit finished(m_url, {});
     }
 }
 
+/**
+ * Set the priority class of the downloads, interactive by default.
+ */
+void IconDownloader::setPriority(NetworkPriority priority)
+{
+    m_priority = priority;
+}
+
 void IconDownloader::fetchFavicon(const QUrl& url)
 {
     m_bytesReceived.clear();
     m_fetchUrl = url;
 
-    QNetworkRequest request(url);
-    m_reply = getNetMgr()->get(request);
-
-    connect(m_reply, &QNetworkReply::finished, this, &IconDownloader::fetchFinished);
-    connect(m_reply, &QIODevice::readyRead, this, &IconDownloader::fetchReadyRead);
+    scheduleNetworkGet(QNetworkRequest(url), m_priority, this, [this](QNetworkReply* reply) {
+        // the timeout covers the download, not the time spent waiting for a free request slot
+        m_timeout.start();
+        m_reply = reply;
+        connect(m_reply, &QNetworkReply::finished, this, &IconDownloader::fetchFinished);
+        connect(m_reply, &QIODevice::readyRead, this, &IconDownloader::fetchReadyRead);
+    });
 }
 
 void IconDownloader::fetchReadyRead()
@@ -196,6 +245,7 @@ void IconDownloader::fetchFinished()
     if (!image.isNull()) {
         // Valid icon received
         m_timeout.stop();
+        iconCache.insert(iconCacheKey(downloadHost(url)), qMakePair(image, QDateTime::currentMSecsSinceEpoch()));
         emit finished(url, image);
     } else if (!m_urlsToTry.empty()) {
         // Try the next url
@@ -24,8 +24,7 @@
 #include <QUrl>
 
 #include "core/Global.h"
-
-class QNetworkReply;
+#include "core/NetworkManager.h"
 
 class IconDownloader : public QObject
 {
@@ -36,8 +35,11 @@ public:
     ~IconDownloader() override;
 
     void setUrl(const QString& entryUrl);
+    void setPriority(NetworkPriority priority);
     void download();
 
+    static QString downloadHost(const QString& entryUrl);
+
 signals:
     void finished(const QString& entryUrl, const QImage& image);
 
@@ -59,6 +61,7 @@ private:
     QNetworkReply* m_reply;
     QTimer m_timeout;
     int m_redirects;
+    NetworkPriority m_priority = NetworkPriority::Interactive;
 };
 
 #endif // KEEPASSXC_ICONDOWNLOADER_H
\ No newline at end of file
@@ -33,6 +33,12 @@
 
 #include <QMutexLocker>
 
+namespace
+{
+    // Enough to keep the network busy without starting the timeouts of requests that are still queued
+    constexpr int MaxConcurrentDownloads = 12;
+} // namespace
+
 IconDownloaderDialog::IconDownloaderDialog(QWidget* parent)
     : QDialog(parent)
     , m_ui(new Ui::IconDownloaderDialog())
@@ -65,6 +71,8 @@ void IconDownloaderDialog::downloadFavicons(const QSharedPointer<Database>& data
 {
     m_db = database;
     m_urlToEntries.clear();
+    m_hostToUrls.clear();
+    m_urlStatusItems.clear();
     abortDownloads();
     for (const auto& e : entries) {
         // Only consider entries with a valid URL and without a custom icon
@@ -85,9 +93,16 @@ void IconDownloaderDialog::downloadFavicons(const QSharedPointer<Database>& data
         QApplication::processEvents();
 
         for (const auto& url : m_urlToEntries.uniqueKeys()) {
-            m_dataModel->appendRow(QList<QStandardItem*>()
-                                   << new QStandardItem(url) << new QStandardItem(tr("Downloading...")));
-            m_activeDownloaders.append(createDownloader(url));
+            auto statusItem = new QStandardItem(tr("Downloading..."));
+            m_dataModel->appendRow(QList<QStandardItem*>() << new QStandardItem(url) << statusItem);
+            m_urlStatusItems.insert(url, statusItem);
+
+            // Entries on the same host share their favicon, only download it once
+            const QString host = IconDownloader::downloadHost(url);
+            if (!m_hostToUrls.contains(host)) {
+                m_activeDownloaders.append(createDownloader(url));
+            }
+            m_hostToUrls.insert(host, url);
         }
 
         // Setup the dialog
@@ -96,9 +111,19 @@ void IconDownloaderDialog::downloadFavicons(const QSharedPointer<Database>& data
         QApplication::processEvents();
 
         // Start the downloads
-        for (auto downloader : m_activeDownloaders) {
-            downloader->download();
-        }
+        m_queuedDownloaders = m_activeDownloaders;
+        startQueuedDownloads();
+    }
+}
+
+/**
+ * Start queued downloads until the concurrency limit is reached.
+ */
+void IconDownloaderDialog::startQueuedDownloads()
+{
+    while (!m_queuedDownloaders.isEmpty()
+           && m_activeDownloaders.size() - m_queuedDownloaders.size() < MaxConcurrentDownloads) {
+        m_queuedDownloaders.takeFirst()->download();
     }
 }
 
@@ -111,6 +136,7 @@ IconDownloader* IconDownloaderDialog::createDownloader(const QString& url)
             SLOT(downloadFinished(const QString&, const QImage&)));
 
     downloader->setUrl(url);
+    downloader->setPriority(NetworkPriority::Bulk);
     return downloader;
 }
 
@@ -126,9 +152,12 @@ void IconDownloaderDialog::downloadFinished(const QString& url, const QImage& ic
         m_activeDownloaders.removeAll(downloader);
     }
 
+    startQueuedDownloads();
     updateProgressBar();
     updateCancelButton();
 
+    const QStringList urls = m_hostToUrls.values(IconDownloader::downloadHost(url));
+
     if (m_db && !icon.isNull()) {
         // Don't add an icon larger than 128x128, but retain original size if smaller
         auto scaledicon = icon;
@@ -137,21 +166,25 @@ void IconDownloaderDialog::downloadFinished(const QString& url, const QImage& ic
         }
 
         QUuid uuid = m_db->metadata()->findCustomIcon(scaledicon);
+        QString message = tr("Already Exists");
         if (uuid.isNull()) {
             uuid = QUuid::createUuid();
             m_db->metadata()->addCustomIcon(uuid, scaledicon);
-            updateTable(url, tr("Ok"));
-        } else {
-            updateTable(url, tr("Already Exists"));
+            message = tr("Ok");
         }
 
-        // Set the icon on all the entries associated with this url
-        for (const auto entry : m_urlToEntries.values(url)) {
-            entry->setIcon(uuid);
+        // Set the icon on all the entries associated with this host
+        for (const auto& hostUrl : urls) {
+            updateTable(hostUrl, message);
+            for (const auto entry : m_urlToEntries.values(hostUrl)) {
+                entry->setIcon(uuid);
+            }
         }
     } else {
         showFallbackMessage(true);
-        updateTable(url, tr("Download Failed"));
+        for (const auto& hostUrl : urls) {
+            updateTable(hostUrl, tr("Download Failed"));
+        }
         return;
     }
 }
@@ -165,7 +198,7 @@ void IconDownloaderDialog::showFallbackMessage(bool state)
 
 void IconDownloaderDialog::updateProgressBar()
 {
-    int total = m_urlToEntries.uniqueKeys().count();
+    int total = m_hostToUrls.uniqueKeys().count();
     int value = total - m_activeDownloaders.count();
     m_ui->progressBar->setValue(value);
     m_ui->progressBar->setMaximum(total);
@@ -180,10 +213,9 @@ void IconDownloaderDialog::updateCancelButton()
 
 void IconDownloaderDialog::updateTable(const QString& url, const QString& message)
 {
-    for (int i = 0; i < m_dataModel->rowCount(); ++i) {
-        if (m_dataModel->item(i, 0)->text() == url) {
-            m_dataModel->item(i, 1)->setText(message);
-        }
+    auto statusItem = m_urlStatusItems.value(url);
+    if (statusItem) {
+        statusItem->setText(message);
     }
 }
 
@@ -193,6 +225,7 @@ void IconDownloaderDialog::abortDownloads()
         delete downloader;
     }
     m_activeDownloaders.clear();
+    m_queuedDownloaders.clear();
     updateProgressBar();
     updateCancelButton();
 }
@@ -50,6 +50,7 @@ private slots:
 
 private:
     IconDownloader* createDownloader(const QString& url);
+    void startQueuedDownloads();
 
     void showFallbackMessage(bool state);
     void updateTable(const QString& url, const QString& message);
@@ -60,7 +61,10 @@ private:
     QStandardItemModel* m_dataModel;
     QSharedPointer<Database> m_db;
     QMultiMap<QString, Entry*> m_urlToEntries;
+    QMultiHash<QString, QString> m_hostToUrls;
+    QHash<QString, QStandardItem*> m_urlStatusItems;
     QList<IconDownloader*> m_activeDownloaders;
+    QList<IconDownloader*> m_queuedDownloaders;
     QMutex m_mutex;
 
     Q_DISABLE_COPY(IconDownloaderDialog)
@@ -20,6 +20,7 @@
 #include <QUuid>
 
 #include "core/DatabaseIcons.h"
+#include "core/Metadata.h"
 
 DefaultIconModel::DefaultIconModel(QObject* parent)
     : QAbstractListModel(parent)
@@ -55,13 +56,24 @@ CustomIconModel::CustomIconModel(QObject* parent)
 {
 }
 
-void CustomIconModel::setIcons(const QHash<QUuid, QPixmap>& icons, const QList<QUuid>& iconsOrder)
+/**
+ * Show the custom icons of the given metadata. The model is only reset if
+ * the metadata or its icons changed since the last call, so views keep
+ * their state when an editor is opened again for the same database.
+ *
+ * @param metadata metadata holding the icons, may be null
+ */
+void CustomIconModel::setMetadata(const Metadata* metadata)
 {
+    const QList<QUuid> iconsOrder = metadata ? metadata->customIconsOrder() : QList<QUuid>();
+    if (metadata == m_metadata && iconsOrder == m_iconsOrder) {
+        return;
+    }
+
     beginResetModel();
 
-    m_icons = icons;
+    m_metadata = metadata;
     m_iconsOrder = iconsOrder;
-    Q_ASSERT(m_icons.count() == m_iconsOrder.count());
 
     endResetModel();
 }
@@ -69,7 +81,7 @@ void CustomIconModel::setIcons(const QHash<QUuid, QPixmap>& icons, const QList<Q
 int CustomIconModel::rowCount(const QModelIndex& parent) const
 {
     if (!parent.isValid()) {
-        return m_icons.size();
+        return m_iconsOrder.size();
     } else {
         return 0;
     }
@@ -81,9 +93,9 @@ QVariant CustomIconModel::data(const QModelIndex& index, int role) const
         return QVariant();
     }
 
-    if (role == Qt::DecorationRole) {
+    if (role == Qt::DecorationRole && m_metadata) {
         QUuid uuid = uuidFromIndex(index);
-        return m_icons.value(uuid);
+        return m_metadata->customIconPixmap(uuid, IconSize::Default);
     }
 
     return QVariant();
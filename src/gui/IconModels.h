@@ -19,7 +19,10 @@
 #define KEEPASSX_ICONMODELS_H
 
 #include <QAbstractListModel>
-#include <QPixmap>
+#include <QPointer>
+#include <QUuid>
+
+class Metadata;
 
 class DefaultIconModel : public QAbstractListModel
 {
@@ -32,6 +35,11 @@ public:
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
 };
 
+/**
+ * The custom icons of a database. Pixmaps are only rendered when a view
+ * asks for them, i.e. for the visible rows, and come from the pixmap cache
+ * of the metadata.
+ */
 class CustomIconModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -41,12 +49,12 @@ public:
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
-    void setIcons(const QHash<QUuid, QPixmap>& icons, const QList<QUuid>& iconsOrder);
+    void setMetadata(const Metadata* metadata);
     QUuid uuidFromIndex(const QModelIndex& index) const;
     QModelIndex indexFromUuid(const QUuid& uuid) const;
 
 private:
-    QHash<QUuid, QPixmap> m_icons;
+    QPointer<const Metadata> m_metadata;
     QList<QUuid> m_iconsOrder;
 };
 
@@ -29,6 +29,23 @@
 
 Icons* Icons::m_instance(nullptr);
 
+namespace
+{
+    /**
+     * Build the cache key of a recolored icon. The colors are part of the key
+     * so a theme or palette change renders fresh pixmaps instead of reusing stale ones.
+     */
+    QString recoloredCacheKey(const QString& name, const QPalette& palette)
+    {
+        return QStringLiteral("%1/%2/%3/%4/%5")
+            .arg(name,
+                 palette.color(QPalette::Normal, QPalette::WindowText).name(QColor::HexArgb),
+                 palette.color(QPalette::Active, QPalette::ButtonText).name(QColor::HexArgb),
+                 palette.color(QPalette::Active, QPalette::HighlightedText).name(QColor::HexArgb),
+                 palette.color(QPalette::Disabled, QPalette::WindowText).name(QColor::HexArgb));
+    }
+} // namespace
+
 QIcon Icons::applicationIcon()
 {
     return icon("keepassxc", false);
@@ -80,7 +97,9 @@ QIcon Icons::trayIconUnlocked()
 
 QIcon Icons::icon(const QString& name, bool recolor, const QColor& overrideColor)
 {
-    QIcon icon = m_iconCache.value(name);
+    recolor = recolor && getMainWindow();
+    const QString cacheName = recolor ? recoloredCacheKey(name, getMainWindow()->palette()) : name;
+    QIcon icon = m_iconCache.value(cacheName);
 
     if (!icon.isNull() && !overrideColor.isValid()) {
         return icon;
@@ -96,7 +115,7 @@ QIcon Icons::icon(const QString& name, bool recolor, const QColor& overrideColor
     QIcon::setThemeName("application");
 
     icon = QIcon::fromTheme(name);
-    if (getMainWindow() && recolor) {
+    if (recolor) {
         const QRect rect(0, 0, 48, 48);
         QImage img = icon.pixmap(rect.width(), rect.height()).toImage();
         img = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
@@ -129,7 +148,7 @@ QIcon Icons::icon(const QString& name, bool recolor, const QColor& overrideColor
     }
 
     if (!overrideColor.isValid()) {
-        m_iconCache.insert(name, icon);
+        m_iconCache.insert(cacheName, icon);
     }
 
     return icon;
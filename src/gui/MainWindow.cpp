@@ -34,15 +34,19 @@
 #include "core/InactivityTimer.h"
 #include "core/Metadata.h"
 #include "core/Resources.h"
+#include "core/StartupTrace.h"
 #include "core/Tools.h"
+#include "crypto/kdf/Argon2Arena.h"
 #include "gui/AboutDialog.h"
 #include "gui/DatabaseWidget.h"
 #include "gui/Icons.h"
 #include "gui/MessageBox.h"
 #include "gui/SearchWidget.h"
+#include "gui/osutils/OSUtils.h"
 #include "keys/CompositeKey.h"
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
+#include "keys/TransformedKeyCache.h"
 
 #ifdef Q_OS_MACOS
 #include "gui/osutils/macutils/MacUtils.h"
@@ -147,14 +151,6 @@ MainWindow::MainWindow()
     restoreState(config()->get(Config::GUI_MainWindowState).toByteArray());
 #ifdef WITH_XC_BROWSER
     m_ui->settingsWidget->addSettingsPage(new BrowserSettingsPage());
-    connect(m_ui->tabWidget, &DatabaseTabWidget::databaseLocked, browserService(), &BrowserService::databaseLocked);
-    connect(m_ui->tabWidget, &DatabaseTabWidget::databaseUnlocked, browserService(), &BrowserService::databaseUnlocked);
-    connect(m_ui->tabWidget,
-            &DatabaseTabWidget::activateDatabaseChanged,
-            browserService(),
-            &BrowserService::activeDatabaseChanged);
-    connect(
-        browserService(), &BrowserService::requestUnlock, m_ui->tabWidget, &DatabaseTabWidget::performBrowserUnlock);
 #endif
 
 #ifdef WITH_XC_SSHAGENT
@@ -188,13 +184,19 @@ MainWindow::MainWindow()
     connect(fdoSS, &FdoSecretsPlugin::error, this, &MainWindow::showErrorMessage);
     connect(fdoSS, &FdoSecretsPlugin::requestSwitchToDatabases, this, &MainWindow::switchToDatabases);
     connect(fdoSS, &FdoSecretsPlugin::requestShowNotification, this, &MainWindow::displayDesktopNotification);
-    fdoSS->updateServiceState();
     m_ui->settingsWidget->addSettingsPage(fdoSS);
+    // Registering the service on the session bus can wait until the window is shown
+    QTimer::singleShot(0, fdoSS, [fdoSS] {
+        fdoSS->updateServiceState();
+        StartupTrace::mark("Secret Service started");
+    });
 #endif
 
 #ifdef WITH_XC_YUBIKEY
     connect(YubiKey::instance(), SIGNAL(userInteractionRequest()), SLOT(showYubiKeyPopup()), Qt::QueuedConnection);
     connect(YubiKey::instance(), SIGNAL(challengeCompleted()), SLOT(hideYubiKeyPopup()), Qt::QueuedConnection);
+    // Detect keys in the background once so unlocking can use the cached key list
+    YubiKey::instance()->findValidKeys();
 #endif
 
     setWindowIcon(icons()->applicationIcon());
@@ -212,27 +214,17 @@ MainWindow::MainWindow()
         m_copyAdditionalAttributeActions, SIGNAL(triggered(QAction*)), SLOT(copyAttribute(QAction*)));
     connect(m_ui->menuEntryCopyAttribute, SIGNAL(aboutToShow()), this, SLOT(updateCopyAttributesMenu()));
 
-    Qt::Key globalAutoTypeKey = static_cast<Qt::Key>(config()->get(Config::GlobalAutoTypeKey).toInt());
-    Qt::KeyboardModifiers globalAutoTypeModifiers =
-        static_cast<Qt::KeyboardModifiers>(config()->get(Config::GlobalAutoTypeModifiers).toInt());
-    if (globalAutoTypeKey > 0 && globalAutoTypeModifiers > 0) {
-        autoType()->registerGlobalShortcut(globalAutoTypeKey, globalAutoTypeModifiers);
-    }
-
     m_ui->toolbarSeparator->setVisible(false);
     m_showToolbarSeparator = config()->get(Config::GUI_ApplicationTheme).toString() != "classic";
 
-    bool isAutoTypeAvailable = autoType()->isAvailable();
-    m_ui->actionEntryAutoType->setVisible(isAutoTypeAvailable);
-    m_ui->actionEntryAutoTypeUsername->setVisible(isAutoTypeAvailable);
-    m_ui->actionEntryAutoTypeUsernameEnter->setVisible(isAutoTypeAvailable);
-    m_ui->actionEntryAutoTypePassword->setVisible(isAutoTypeAvailable);
-    m_ui->actionEntryAutoTypePasswordEnter->setVisible(isAutoTypeAvailable);
-
+    // the OS knows when the last input happened, no need to watch all events of the application
+    auto systemIdleTime = [] { return osUtils->systemIdleTime(); };
     m_inactivityTimer = new InactivityTimer(this);
+    m_inactivityTimer->setIdleTimeSource(systemIdleTime);
     connect(m_inactivityTimer, SIGNAL(inactivityDetected()), this, SLOT(lockDatabasesAfterInactivity()));
 #ifdef WITH_XC_TOUCHID
     m_touchIDinactivityTimer = new InactivityTimer(this);
+    m_touchIDinactivityTimer->setIdleTimeSource(systemIdleTime);
     connect(m_touchIDinactivityTimer, SIGNAL(inactivityDetected()), this, SLOT(forgetTouchIDAfterInactivity()));
 #endif
     applySettingsChanges();
@@ -243,6 +235,7 @@ MainWindow::MainWindow()
     setShortcut(m_ui->actionDatabaseSaveAs, QKeySequence::SaveAs, Qt::CTRL + Qt::SHIFT + Qt::Key_S);
     setShortcut(m_ui->actionDatabaseClose, QKeySequence::Close, Qt::CTRL + Qt::Key_W);
     m_ui->actionLockDatabases->setShortcut(Qt::CTRL + Qt::Key_L);
+    m_ui->actionSearchAllDatabases->setShortcut(Qt::CTRL + Qt::SHIFT + Qt::Key_F);
     setShortcut(m_ui->actionQuit, QKeySequence::Quit, Qt::CTRL + Qt::Key_Q);
     setShortcut(m_ui->actionEntryNew, QKeySequence::New, Qt::CTRL + Qt::Key_N);
     m_ui->actionEntryEdit->setShortcut(Qt::CTRL + Qt::Key_E);
@@ -409,7 +402,6 @@ MainWindow::MainWindow()
     connect(m_ui->tabWidget, SIGNAL(tabNameChanged()), SLOT(updateWindowTitle()));
     connect(m_ui->tabWidget, SIGNAL(currentChanged(int)), SLOT(updateWindowTitle()));
     connect(m_ui->tabWidget, SIGNAL(currentChanged(int)), SLOT(databaseTabChanged(int)));
-    connect(m_ui->tabWidget, SIGNAL(currentChanged(int)), SLOT(setMenuActionState()));
     connect(m_ui->tabWidget, SIGNAL(currentChanged(int)), SLOT(updateTrayIcon()));
     connect(m_ui->tabWidget, SIGNAL(databaseLocked(DatabaseWidget*)), SLOT(databaseStatusChanged(DatabaseWidget*)));
     connect(m_ui->tabWidget, SIGNAL(databaseUnlocked(DatabaseWidget*)), SLOT(databaseStatusChanged(DatabaseWidget*)));
@@ -431,6 +423,7 @@ MainWindow::MainWindow()
     connect(m_ui->actionDatabaseMerge, SIGNAL(triggered()), m_ui->tabWidget, SLOT(mergeDatabase()));
     connect(m_ui->actionDatabaseSecurity, SIGNAL(triggered()), m_ui->tabWidget, SLOT(showDatabaseSecurity()));
     connect(m_ui->actionReports, SIGNAL(triggered()), m_ui->tabWidget, SLOT(showDatabaseReports()));
+    connect(m_ui->actionSearchAllDatabases, SIGNAL(triggered()), m_ui->tabWidget, SLOT(searchAllDatabases()));
     connect(m_ui->actionDatabaseSettings, SIGNAL(triggered()), m_ui->tabWidget, SLOT(showDatabaseSettings()));
     connect(m_ui->actionImportCsv, SIGNAL(triggered()), m_ui->tabWidget, SLOT(importCsv()));
     connect(m_ui->actionImportKeePass1, SIGNAL(triggered()), m_ui->tabWidget, SLOT(importKeePass1Database()));
@@ -597,12 +590,53 @@ MainWindow::MainWindow()
     QObject::connect(qApp, SIGNAL(quitSignalReceived()), this, SLOT(appExit()), Qt::DirectConnection);
 
     restoreConfigState();
+
+    // Load the optional subsystems once the event loop runs and the window got painted
+    QTimer::singleShot(0, this, SLOT(initOptionalSubsystems()));
 }
 
 MainWindow::~MainWindow()
 {
 }
 
+/**
+ * Set up the subsystems which are not needed to show the main window:
+ * the Auto-Type plugin and the browser integration server.
+ */
+void MainWindow::initOptionalSubsystems()
+{
+    Qt::Key globalAutoTypeKey = static_cast<Qt::Key>(config()->get(Config::GlobalAutoTypeKey).toInt());
+    Qt::KeyboardModifiers globalAutoTypeModifiers =
+        static_cast<Qt::KeyboardModifiers>(config()->get(Config::GlobalAutoTypeModifiers).toInt());
+    if (globalAutoTypeKey > 0 && globalAutoTypeModifiers > 0) {
+        autoType()->registerGlobalShortcut(globalAutoTypeKey, globalAutoTypeModifiers);
+    }
+
+    bool isAutoTypeAvailable = autoType()->isAvailable();
+    m_ui->actionEntryAutoType->setVisible(isAutoTypeAvailable);
+    m_ui->actionEntryAutoTypeUsername->setVisible(isAutoTypeAvailable);
+    m_ui->actionEntryAutoTypeUsernameEnter->setVisible(isAutoTypeAvailable);
+    m_ui->actionEntryAutoTypePassword->setVisible(isAutoTypeAvailable);
+    m_ui->actionEntryAutoTypePasswordEnter->setVisible(isAutoTypeAvailable);
+    StartupTrace::mark("Auto-Type plugin loaded");
+
+#ifdef WITH_XC_BROWSER
+    connect(m_ui->tabWidget, &DatabaseTabWidget::databaseLocked, browserService(), &BrowserService::databaseLocked);
+    connect(m_ui->tabWidget, &DatabaseTabWidget::databaseUnlocked, browserService(), &BrowserService::databaseUnlocked);
+    connect(m_ui->tabWidget,
+            &DatabaseTabWidget::activateDatabaseChanged,
+            browserService(),
+            &BrowserService::activeDatabaseChanged);
+    connect(
+        browserService(), &BrowserService::requestUnlock, m_ui->tabWidget, &DatabaseTabWidget::performBrowserUnlock);
+    // Databases may have been opened from the command line already
+    browserService()->activeDatabaseChanged(m_ui->tabWidget->currentDatabaseWidget());
+    StartupTrace::mark("Browser integration started");
+#endif
+
+    StartupTrace::report();
+}
+
 /**
  * Restore the main window's state after launch
  */
@@ -709,6 +743,11 @@ void MainWindow::openDatabase(const QString& filePath, const QString& password,
 
 void MainWindow::setMenuActionState(DatabaseWidget::Mode mode)
 {
+    // A tab switch refreshes the action state once when it is done
+    if (m_menuActionStateBatched) {
+        return;
+    }
+
     int currentIndex = m_ui->stackedWidget->currentIndex();
 
     bool inDatabaseTabWidget = (currentIndex == DatabaseTabScreen);
@@ -716,6 +755,7 @@ void MainWindow::setMenuActionState(DatabaseWidget::Mode mode)
     bool inDatabaseTabWidgetOrWelcomeWidget = inDatabaseTabWidget || inWelcomeWidget;
 
     m_ui->actionDatabaseMerge->setEnabled(inDatabaseTabWidget);
+    m_ui->actionSearchAllDatabases->setEnabled(inDatabaseTabWidget && m_ui->tabWidget->hasLockableDatabases());
     m_ui->actionDatabaseNew->setEnabled(inDatabaseTabWidgetOrWelcomeWidget);
     m_ui->actionDatabaseOpen->setEnabled(inDatabaseTabWidgetOrWelcomeWidget);
     m_ui->menuRecentDatabases->setEnabled(inDatabaseTabWidgetOrWelcomeWidget);
@@ -1149,6 +1189,8 @@ void MainWindow::selectPreviousDatabaseTab()
 
 void MainWindow::databaseTabChanged(int tabIndex)
 {
+    m_menuActionStateBatched = true;
+
     if (tabIndex != -1 && m_ui->stackedWidget->currentIndex() == WelcomeScreen) {
         m_ui->stackedWidget->setCurrentIndex(DatabaseTabScreen);
     } else if (tabIndex == -1 && m_ui->stackedWidget->currentIndex() == DatabaseTabScreen) {
@@ -1156,6 +1198,9 @@ void MainWindow::databaseTabChanged(int tabIndex)
     }
 
     m_actionMultiplexer.setCurrentObject(m_ui->tabWidget->currentDatabaseWidget());
+
+    m_menuActionStateBatched = false;
+    setMenuActionState();
 }
 
 void MainWindow::closeEvent(QCloseEvent* event)
@@ -1400,6 +1445,11 @@ void MainWindow::applySettingsChanges()
         m_inactivityTimer->deactivate();
     }
 
+    auto keyCache = TransformedKeyCache::instance();
+    keyCache->setTimeout(config()->get(Config::Security_QuickUnlockTimeout).toInt() * 60 * 1000);
+    keyCache->setEnabled(config()->get(Config::Security_QuickUnlock).toBool());
+    Argon2Arena::instance()->setEnabled(config()->get(Config::ReuseKdfMemory).toBool());
+
 #ifdef WITH_XC_TOUCHID
     if (config()->get(Config::Security_ResetTouchId).toBool()) {
         // Calculate TouchID timeout in milliseconds
@@ -1640,6 +1690,13 @@ void MainWindow::handleScreenLock()
         lockDatabasesAfterInactivity();
     }
 
+    // never keep quick unlock or share keys across a suspend or a locked session
+    TransformedKeyCache::instance()->clear();
+    TransformedKeyCache::shareInstance()->clear();
+    FileKey::clearCache();
+    // no key is going to be derived soon, give the KDF memory back
+    Argon2Arena::instance()->clear();
+
 #ifdef WITH_XC_TOUCHID
     if (config()->get(Config::Security_ResetTouchIdScreenlock).toBool()) {
         forgetTouchIDAfterInactivity();
@@ -138,6 +138,7 @@ private slots:
 
 private slots:
     void updateTrayIcon();
+    void initOptionalSubsystems();
 
 private:
     static void setShortcut(QAction* action, QKeySequence::StandardKey standard, int fallback = 0);
@@ -176,6 +177,7 @@ private:
     bool m_appExiting = false;
     bool m_restartRequested = false;
     bool m_contextMenuFocusLock = false;
+    bool m_menuActionStateBatched = false;
     bool m_showToolbarSeparator = false;
     qint64 m_lastFocusOutTime = 0;
     qint64 m_lastShowTime = 0;
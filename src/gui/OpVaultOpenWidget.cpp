@@ -40,9 +40,22 @@ void OpVaultOpenWidget::openDatabase()
 
     QDir opVaultDir(m_filename);
 
+    // items are decrypted in the background while the event loop keeps running
+    connect(&reader, &OpVaultReader::bandEntriesProgress, this, [this](int done, int total) {
+        const QString text = tr("Decrypting items… %1 of %2").arg(done).arg(total);
+        if (m_ui->messageWidget->isVisible()) {
+            m_ui->messageWidget->setText(text);
+        } else {
+            m_ui->messageWidget->showMessage(text, MessageWidget::Information, MessageWidget::DisableAutoHide);
+        }
+    });
+
+    setEnabled(false);
     QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
     m_db.reset(reader.readDatabase(opVaultDir, password));
     QApplication::restoreOverrideCursor();
+    setEnabled(true);
+    m_ui->messageWidget->hideMessage();
 
     if (m_db) {
         emit dialogFinished(true);
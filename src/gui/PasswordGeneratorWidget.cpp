@@ -24,9 +24,11 @@
 #include <QLineEdit>
 #include <QTimer>
 
+#include "core/AsyncTask.h"
 #include "core/Config.h"
 #include "core/PasswordGenerator.h"
 #include "core/PasswordHealth.h"
+#include "core/PasswordHealthCache.h"
 #include "core/Resources.h"
 #include "gui/Clipboard.h"
 #include "gui/Icons.h"
@@ -46,6 +48,12 @@ PasswordGeneratorWidget::PasswordGeneratorWidget(QWidget* parent)
     m_ui->buttonCopy->setIcon(icons()->icon("clipboard-text"));
     m_ui->buttonClose->setShortcut(Qt::Key_Escape);
 
+    // Estimate the strength of typed passwords once typing pauses
+    m_strengthTimer.setSingleShot(true);
+    m_strengthTimer.setInterval(150);
+    connect(&m_strengthTimer, SIGNAL(timeout()), SLOT(estimatePasswordStrength()));
+    m_entropyCache.setMaxCost(256);
+
     connect(m_ui->editNewPassword, SIGNAL(textChanged(QString)), SLOT(updateButtonsEnabled(QString)));
     connect(m_ui->editNewPassword, SIGNAL(textChanged(QString)), SLOT(updatePasswordStrength(QString)));
     connect(m_ui->buttonAdvancedMode, SIGNAL(toggled(bool)), SLOT(setAdvancedMode(bool)));
@@ -252,14 +260,50 @@ void PasswordGeneratorWidget::updateButtonsEnabled(const QString& password)
 
 void PasswordGeneratorWidget::updatePasswordStrength(const QString& password)
 {
-    PasswordHealth health(password);
+    // Drop any estimate that is still pending for a previous password
+    m_strengthTimer.stop();
+    ++m_strengthRequest;
+
     if (m_ui->tabWidget->currentIndex() == Diceware) {
         // Diceware estimates entropy differently
-        health = PasswordHealth(m_dicewareGenerator->estimateEntropy());
-
         m_ui->charactersInPassphraseLabel->setText(QString::number(password.length()));
+        showPasswordStrength(PasswordHealth(m_dicewareGenerator->estimateEntropy()));
+        return;
     }
 
+    const double* entropy = m_entropyCache.object(PasswordHealthCache::passwordKey(password));
+    if (entropy) {
+        showPasswordStrength(PasswordHealth(*entropy));
+        return;
+    }
+
+    m_strengthPassword = password;
+    m_strengthTimer.start();
+}
+
+/**
+ * Run zxcvbn for the last typed password outside of the GUI thread.
+ * Results of superseded requests are cached but not shown.
+ */
+void PasswordGeneratorWidget::estimatePasswordStrength()
+{
+    const int request = m_strengthRequest;
+    const QString password = m_strengthPassword;
+    m_strengthPassword.clear();
+
+    AsyncTask::runThenCallback([password] { return PasswordHealth(password).entropy(); },
+                               this,
+                               [this, request, password](double entropy) {
+                                   m_entropyCache.insert(PasswordHealthCache::passwordKey(password),
+                                                         new double(entropy));
+                                   if (request == m_strengthRequest) {
+                                       showPasswordStrength(PasswordHealth(entropy));
+                                   }
+                               });
+}
+
+void PasswordGeneratorWidget::showPasswordStrength(const PasswordHealth& health)
+{
     m_ui->entropyLabel->setText(tr("Entropy: %1 bit").arg(QString::number(health.entropy(), 'f', 2)));
 
     m_ui->entropyProgressBar->setValue(std::min(int(health.entropy()), m_ui->entropyProgressBar->maximum()));
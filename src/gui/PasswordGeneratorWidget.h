@@ -19,8 +19,10 @@
 #ifndef KEEPASSX_PASSWORDGENERATORWIDGET_H
 #define KEEPASSX_PASSWORDGENERATORWIDGET_H
 
+#include <QCache>
 #include <QComboBox>
 #include <QLabel>
+#include <QTimer>
 #include <QWidget>
 
 #include "core/PassphraseGenerator.h"
@@ -77,6 +79,7 @@ private slots:
     void passwordLengthChanged(int length);
     void passphraseLengthChanged(int length);
     void colorStrengthIndicator(const PasswordHealth& health);
+    void estimatePasswordStrength();
 
     void updateGenerator();
 
@@ -85,6 +88,12 @@ private:
 
     PasswordGenerator::CharClasses charClasses();
     PasswordGenerator::GeneratorFlags generatorFlags();
+    void showPasswordStrength(const PasswordHealth& health);
+
+    QTimer m_strengthTimer;
+    QString m_strengthPassword;
+    int m_strengthRequest = 0;
+    QCache<QByteArray, double> m_entropyCache;
 
     const QScopedPointer<PasswordGenerator> m_passwordGenerator;
     const QScopedPointer<PassphraseGenerator> m_dicewareGenerator;
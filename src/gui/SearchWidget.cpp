@@ -33,6 +33,7 @@ SearchWidget::SearchWidget(QWidget* parent)
     , m_ui(new Ui::SearchWidget())
     , m_searchTimer(new QTimer(this))
     , m_clearSearchTimer(new QTimer(this))
+    , m_searchDelay(100)
 {
     m_ui->setupUi(this);
     setFocusProxy(m_ui->searchEdit);
@@ -137,6 +138,7 @@ void SearchWidget::connectSignals(SignalMultiplexer& mx)
     mx.connect(SIGNAL(entrySelectionChanged()), this, SLOT(resetSearchClearTimer()));
     mx.connect(SIGNAL(currentModeChanged(DatabaseWidget::Mode)), this, SLOT(resetSearchClearTimer()));
     mx.connect(SIGNAL(databaseUnlocked()), this, SLOT(searchFocus()));
+    mx.connect(SIGNAL(searchFinished(int)), this, SLOT(updateSearchDelay(int)));
     mx.connect(m_ui->searchEdit, SIGNAL(returnPressed()), SLOT(switchToEntryEdit()));
 }
 
@@ -158,7 +160,16 @@ void SearchWidget::startSearchTimer()
     if (!m_searchTimer->isActive()) {
         m_searchTimer->stop();
     }
-    m_searchTimer->start(100);
+    m_searchTimer->start(m_searchDelay);
+}
+
+/**
+ * Wait longer for the next keystroke when searching takes a while,
+ * small databases still get results right away.
+ */
+void SearchWidget::updateSearchDelay(int elapsedMs)
+{
+    m_searchDelay = qBound(50, 50 + elapsedMs, 300);
 }
 
 void SearchWidget::startSearch()
@@ -71,12 +71,14 @@ private slots:
     void toggleHelp();
     void showSearchMenu();
     void resetSearchClearTimer();
+    void updateSearchDelay(int elapsedMs);
 
 private:
     const QScopedPointer<Ui::SearchWidget> m_ui;
     PopupHelpWidget* m_helpWidget;
     QTimer* m_searchTimer;
     QTimer* m_clearSearchTimer;
+    int m_searchDelay;
     QAction* m_actionCaseSensitive;
     QAction* m_actionLimitGroup;
     QMenu* m_searchMenu;
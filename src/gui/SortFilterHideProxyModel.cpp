@@ -17,11 +17,58 @@
 
 #include "SortFilterHideProxyModel.h"
 
+#include <QDateTime>
+
+namespace
+{
+    // QCollatorSortKey has no default constructor
+    const QCollatorSortKey& emptyCollatorSortKey()
+    {
+        static const QCollatorSortKey key = QCollator().sortKey(QString());
+        return key;
+    }
+} // namespace
+
+SortFilterHideProxyModel::SortKey::SortKey()
+    : type(Unset)
+    , integer(0)
+    , real(0)
+    , collated(emptyCollatorSortKey())
+{
+}
+
 SortFilterHideProxyModel::SortFilterHideProxyModel(QObject* parent)
     : QSortFilterProxyModel(parent)
+    , m_sortKeyColumn(-1)
+    , m_sortKeyRole(-1)
+    , m_sortKeyCaseSensitivity(Qt::CaseSensitive)
+    , m_sortKeyLocaleAware(false)
 {
 }
 
+/**
+ * The sort keys follow the source rows. These connections are made before the
+ * ones of QSortFilterProxyModel, so the keys are up to date when it sorts again.
+ */
+void SortFilterHideProxyModel::setSourceModel(QAbstractItemModel* model)
+{
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    }
+    m_sortKeys.clear();
+
+    if (model) {
+        connect(model, &QAbstractItemModel::dataChanged, this, &SortFilterHideProxyModel::sourceDataChanged);
+        connect(model, &QAbstractItemModel::rowsInserted, this, &SortFilterHideProxyModel::sourceRowsInserted);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &SortFilterHideProxyModel::sourceRowsRemoved);
+        connect(model, &QAbstractItemModel::rowsMoved, this, &SortFilterHideProxyModel::clearSortKeys);
+        connect(model, &QAbstractItemModel::layoutChanged, this, &SortFilterHideProxyModel::clearSortKeys);
+        connect(model, &QAbstractItemModel::modelReset, this, &SortFilterHideProxyModel::clearSortKeys);
+    }
+
+    QSortFilterProxyModel::setSourceModel(model);
+}
+
 Qt::DropActions SortFilterHideProxyModel::supportedDragActions() const
 {
     return sourceModel()->supportedDragActions();
@@ -41,3 +88,121 @@ bool SortFilterHideProxyModel::filterAcceptsColumn(int sourceColumn, const QMode
 
     return sourceColumn >= m_hiddenColumns.size() || !m_hiddenColumns.at(sourceColumn);
 }
+
+/**
+ * Compare precomputed sort keys instead of fetching and comparing the
+ * sort role data for every comparison.
+ */
+bool SortFilterHideProxyModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
+{
+    if (left.parent().isValid() || right.parent().isValid()) {
+        return QSortFilterProxyModel::lessThan(left, right);
+    }
+
+    const SortKey& leftKey = sortKey(left);
+    const SortKey& rightKey = sortKey(right);
+    if (leftKey.type != rightKey.type) {
+        return QSortFilterProxyModel::lessThan(left, right);
+    }
+
+    switch (leftKey.type) {
+    case SortKey::Integer:
+        return leftKey.integer < rightKey.integer;
+    case SortKey::Real:
+        return leftKey.real < rightKey.real;
+    case SortKey::Text:
+        return leftKey.text < rightKey.text;
+    case SortKey::Collated:
+        return leftKey.collated.compare(rightKey.collated) < 0;
+    default:
+        return QSortFilterProxyModel::lessThan(left, right);
+    }
+}
+
+const SortFilterHideProxyModel::SortKey& SortFilterHideProxyModel::sortKey(const QModelIndex& index) const
+{
+    // Keys are kept for a single column, sorting by another one starts over
+    if (index.column() != m_sortKeyColumn || sortRole() != m_sortKeyRole
+        || sortCaseSensitivity() != m_sortKeyCaseSensitivity || isSortLocaleAware() != m_sortKeyLocaleAware) {
+        m_sortKeys.clear();
+        m_sortKeyColumn = index.column();
+        m_sortKeyRole = sortRole();
+        m_sortKeyCaseSensitivity = sortCaseSensitivity();
+        m_sortKeyLocaleAware = isSortLocaleAware();
+        m_collator.setCaseSensitivity(m_sortKeyCaseSensitivity);
+    }
+
+    if (m_sortKeys.size() <= index.row()) {
+        m_sortKeys.resize(qMax(index.row() + 1, sourceModel()->rowCount()));
+    }
+
+    SortKey& key = m_sortKeys[index.row()];
+    if (key.type != SortKey::Unset) {
+        return key;
+    }
+
+    const QVariant value = index.data(m_sortKeyRole);
+    switch (value.userType()) {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+        key.type = SortKey::Integer;
+        key.integer = value.toLongLong();
+        break;
+    case QMetaType::Double:
+    case QMetaType::Float:
+        key.type = SortKey::Real;
+        key.real = value.toDouble();
+        break;
+    case QMetaType::QDateTime:
+        key.type = SortKey::Integer;
+        key.integer = value.toDateTime().toMSecsSinceEpoch();
+        break;
+    case QMetaType::QString:
+        if (m_sortKeyLocaleAware) {
+            key.type = SortKey::Collated;
+            key.collated = m_collator.sortKey(value.toString());
+        } else {
+            key.type = SortKey::Text;
+            key.text = m_sortKeyCaseSensitivity == Qt::CaseSensitive ? value.toString() : value.toString().toCaseFolded();
+        }
+        break;
+    default:
+        key.type = SortKey::Other;
+        break;
+    }
+
+    return key;
+}
+
+void SortFilterHideProxyModel::sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    if (topLeft.parent().isValid() || m_sortKeyColumn < topLeft.column() || m_sortKeyColumn > bottomRight.column()) {
+        return;
+    }
+
+    const int last = qMin(bottomRight.row(), m_sortKeys.size() - 1);
+    for (int row = topLeft.row(); row <= last; ++row) {
+        m_sortKeys[row] = SortKey();
+    }
+}
+
+void SortFilterHideProxyModel::sourceRowsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (!parent.isValid() && first <= m_sortKeys.size()) {
+        m_sortKeys.insert(first, last - first + 1, SortKey());
+    }
+}
+
+void SortFilterHideProxyModel::sourceRowsRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (!parent.isValid() && first < m_sortKeys.size()) {
+        m_sortKeys.remove(first, qMin(last, m_sortKeys.size() - 1) - first + 1);
+    }
+}
+
+void SortFilterHideProxyModel::clearSortKeys()
+{
+    m_sortKeys.clear();
+}
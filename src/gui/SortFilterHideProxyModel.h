@@ -19,7 +19,9 @@
 #define KEEPASSX_SORTFILTERHIDEPROXYMODEL_H
 
 #include <QBitArray>
+#include <QCollator>
 #include <QSortFilterProxyModel>
+#include <QVector>
 
 class SortFilterHideProxyModel : public QSortFilterProxyModel
 {
@@ -27,14 +29,52 @@ class SortFilterHideProxyModel : public QSortFilterProxyModel
 
 public:
     explicit SortFilterHideProxyModel(QObject* parent = nullptr);
+    void setSourceModel(QAbstractItemModel* sourceModel) override;
     Qt::DropActions supportedDragActions() const override;
     void hideColumn(int column, bool hide);
 
 protected:
     bool filterAcceptsColumn(int sourceColumn, const QModelIndex& sourceParent) const override;
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+
+private slots:
+    void sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+    void sourceRowsInserted(const QModelIndex& parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex& parent, int first, int last);
+    void clearSortKeys();
 
 private:
+    // Sort role value of a source row converted once for cheap comparisons
+    struct SortKey
+    {
+        enum Type
+        {
+            Unset,
+            Other,
+            Integer,
+            Real,
+            Text,
+            Collated
+        };
+
+        SortKey();
+
+        Type type;
+        qint64 integer;
+        double real;
+        QString text;
+        QCollatorSortKey collated;
+    };
+
+    const SortKey& sortKey(const QModelIndex& index) const;
+
     QBitArray m_hiddenColumns;
+    mutable QVector<SortKey> m_sortKeys;
+    mutable int m_sortKeyColumn;
+    mutable int m_sortKeyRole;
+    mutable Qt::CaseSensitivity m_sortKeyCaseSensitivity;
+    mutable bool m_sortKeyLocaleAware;
+    mutable QCollator m_collator;
 };
 
 #endif // KEEPASSX_SORTFILTERHIDEPROXYMODEL_H
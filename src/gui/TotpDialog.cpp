@@ -23,6 +23,7 @@
 #include "core/Config.h"
 #include "gui/Clipboard.h"
 #include "gui/MainWindow.h"
+#include "gui/TotpTicker.h"
 
 #include <QShortcut>
 
@@ -39,14 +40,13 @@ TotpDialog::TotpDialog(QWidget* parent, Entry* entry)
     m_ui->setupUi(this);
 
     m_step = m_entry->totpSettings()->step;
-    resetCounter();
+    m_counter = currentCounter();
+    updateTotp();
     updateProgressBar();
+    updateSeconds();
 
     connect(parent, SIGNAL(databaseLocked()), SLOT(close()));
-    connect(&m_totpUpdateTimer, SIGNAL(timeout()), this, SLOT(updateProgressBar()));
-    connect(&m_totpUpdateTimer, SIGNAL(timeout()), this, SLOT(updateSeconds()));
-    m_totpUpdateTimer.start(m_step * 10);
-    updateTotp();
+    connect(totpTicker(), SIGNAL(tick()), SLOT(updateCountdown()));
 
     setAttribute(Qt::WA_DeleteOnClose);
 
@@ -75,22 +75,28 @@ void TotpDialog::copyToClipboard()
     }
 }
 
-void TotpDialog::updateProgressBar()
+void TotpDialog::updateCountdown()
 {
-    if (m_counter < 100) {
-        m_ui->progressBar->setValue(100 - m_counter);
-        m_ui->progressBar->update();
-        ++m_counter;
-    } else {
+    // the code only changes when a new time step starts
+    const quint64 counter = currentCounter();
+    if (counter != m_counter) {
+        m_counter = counter;
         updateTotp();
-        resetCounter();
     }
+    updateProgressBar();
+    updateSeconds();
+}
+
+void TotpDialog::updateProgressBar()
+{
+    const uint elapsed = Clock::currentSecondsSinceEpoch() % m_step;
+    m_ui->progressBar->setValue(100 - static_cast<int>(elapsed * 100 / m_step));
 }
 
 void TotpDialog::updateSeconds()
 {
-    uint epoch = Clock::currentSecondsSinceEpoch() - 1;
-    m_ui->timerLabel->setText(tr("Expires in <b>%n</b> second(s)", "", m_step - (epoch % m_step)));
+    const uint elapsed = Clock::currentSecondsSinceEpoch() % m_step;
+    m_ui->timerLabel->setText(tr("Expires in <b>%n</b> second(s)", "", m_step - elapsed));
 }
 
 void TotpDialog::updateTotp()
@@ -101,8 +107,7 @@ void TotpDialog::updateTotp()
     m_ui->totpLabel->setText(firstHalf + " " + secondHalf);
 }
 
-void TotpDialog::resetCounter()
+quint64 TotpDialog::currentCounter() const
 {
-    uint epoch = Clock::currentSecondsSinceEpoch();
-    m_counter = static_cast<int>(static_cast<double>(epoch % m_step) / m_step * 100);
+    return Clock::currentSecondsSinceEpoch() / m_step;
 }
@@ -24,7 +24,6 @@
 #include "gui/DatabaseWidget.h"
 #include <QDialog>
 #include <QScopedPointer>
-#include <QTimer>
 #include <totp/totp.h>
 
 namespace Ui
@@ -42,6 +41,7 @@ public:
 
 private Q_SLOTS:
     void updateTotp();
+    void updateCountdown();
     void updateProgressBar();
     void updateSeconds();
     void copyToClipboard();
@@ -49,11 +49,10 @@ private Q_SLOTS:
 private:
     QScopedPointer<Ui::TotpDialog> m_ui;
 
-    void resetCounter();
+    quint64 currentCounter() const;
     Entry* m_entry;
-    int m_counter;
+    quint64 m_counter;
     uint m_step;
-    QTimer m_totpUpdateTimer;
 };
 
 #endif // KEEPASSX_TOTPDIALOG_H
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TotpTicker.h"
+
+#include "core/Clock.h"
+
+#include <QCoreApplication>
+#include <QMetaMethod>
+
+TotpTicker* TotpTicker::m_instance(nullptr);
+
+TotpTicker::TotpTicker(QObject* parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, SIGNAL(timeout()), SLOT(emitTick()));
+}
+
+TotpTicker* TotpTicker::instance()
+{
+    if (!m_instance) {
+        m_instance = new TotpTicker(qApp);
+    }
+
+    return m_instance;
+}
+
+void TotpTicker::connectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&TotpTicker::tick) && !m_timer.isActive()) {
+        scheduleNextTick();
+    }
+}
+
+void TotpTicker::disconnectNotify(const QMetaMethod& signal)
+{
+    // an invalid method means everything was disconnected at once
+    if ((!signal.isValid() || signal == QMetaMethod::fromSignal(&TotpTicker::tick))
+        && receivers(SIGNAL(tick())) == 0) {
+        m_timer.stop();
+    }
+}
+
+void TotpTicker::emitTick()
+{
+    scheduleNextTick();
+    emit tick();
+}
+
+void TotpTicker::scheduleNextTick()
+{
+    // fire a few milliseconds into the next second, so the clock has surely moved on
+    const qint64 msecs = Clock::currentMilliSecondsSinceEpoch() % 1000;
+    m_timer.start(static_cast<int>(1005 - msecs));
+}
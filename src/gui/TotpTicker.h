@@ -0,0 +1,60 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TOTPTICKER_H
+#define KEEPASSXC_TOTPTICKER_H
+
+#include <QObject>
+#include <QTimer>
+
+/**
+ * Shared clock for everything that shows a TOTP code. It emits tick() once
+ * per second, right after the second changes, so all displays switch to a
+ * new code at the same time. The timer only runs while tick() is connected.
+ */
+class TotpTicker : public QObject
+{
+    Q_OBJECT
+
+public:
+    static TotpTicker* instance();
+
+signals:
+    void tick();
+
+protected:
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
+
+private slots:
+    void emitTick();
+
+private:
+    explicit TotpTicker(QObject* parent = nullptr);
+    void scheduleNextTick();
+
+    QTimer m_timer;
+
+    static TotpTicker* m_instance;
+};
+
+inline TotpTicker* totpTicker()
+{
+    return TotpTicker::instance();
+}
+
+#endif // KEEPASSXC_TOTPTICKER_H
@@ -23,12 +23,98 @@
 #include <QFileInfo>
 #include <QSpacerItem>
 
+#include <algorithm>
+
+#include "core/AsyncTask.h"
 #include "core/Clock.h"
-#include "format/KeePass2Writer.h"
-#include "gui/MessageBox.h"
 #include "gui/MessageWidget.h"
 #include "totp/totp.h"
 
+namespace
+{
+    // number of CSV rows handed from the tokenizer to the entry creation at once
+    const int ImportBatchSize = 1000;
+    // number of CSV rows converted by one background task
+    const int ConvertChunkSize = 250;
+
+    // database columns, in the order of the column header
+    enum ImportColumn
+    {
+        GroupColumn,
+        TitleColumn,
+        UsernameColumn,
+        PasswordColumn,
+        UrlColumn,
+        NotesColumn,
+        TotpColumn,
+        IconColumn,
+        LastModifiedColumn,
+        CreatedColumn,
+        ImportColumnCount
+    };
+
+    struct ImportedRow
+    {
+        QString group;
+        QString title;
+        QString username;
+        QString password;
+        QString url;
+        QString notes;
+        QSharedPointer<Totp::Settings> totp;
+        bool hasIcon = false;
+        int icon = 0;
+        QDateTime lastModified;
+        QDateTime created;
+    };
+
+    /**
+     * Parse a time given as seconds since the epoch or as an ISO 8601 date.
+     *
+     * @return parsed time, invalid if the value is neither
+     */
+    QDateTime parseImportTime(const QString& value)
+    {
+        if (!value.isEmpty() && std::all_of(value.begin(), value.end(), [](const QChar& c) { return c.isDigit(); })) {
+            return Clock::datetimeUtc(value.toLongLong() * 1000);
+        }
+        return QDateTime::fromString(value, Qt::ISODate);
+    }
+
+    /**
+     * Convert CSV rows to the values of the entries to create. This only uses its
+     * arguments, so chunks of a file can be converted in parallel.
+     *
+     * @param rows CSV rows
+     * @param columns CSV column of every database column, -1 if it is not mapped
+     */
+    QVector<ImportedRow> convertRows(const CsvTable& rows, const QVector<int>& columns)
+    {
+        QVector<ImportedRow> converted;
+        converted.reserve(rows.size());
+        for (const CsvRow& row : rows) {
+            auto field = [&row, &columns](int column) {
+                const int csvColumn = columns.at(column);
+                return csvColumn >= 0 && csvColumn < row.size() ? row.at(csvColumn) : QString();
+            };
+
+            ImportedRow imported;
+            imported.group = field(GroupColumn);
+            imported.title = field(TitleColumn);
+            imported.username = field(UsernameColumn);
+            imported.password = field(PasswordColumn);
+            imported.url = field(UrlColumn);
+            imported.notes = field(NotesColumn);
+            imported.totp = Totp::parseSettings(field(TotpColumn));
+            imported.icon = field(IconColumn).toInt(&imported.hasIcon);
+            imported.lastModified = parseImportTime(field(LastModifiedColumn));
+            imported.created = parseImportTime(field(CreatedColumn));
+            converted.append(imported);
+        }
+        return converted;
+    }
+} // namespace
+
 // I wanted to make the CSV import GUI future-proof, so if one day you need a new field,
 // all you have to do is add a field to m_columnHeader, and the GUI will follow:
 // dynamic generation of comboBoxes, labels, placement and so on. Try it for immense fun!
@@ -193,86 +279,96 @@ QString CsvImportWidget::formatStatusText() const
 
 void CsvImportWidget::writeDatabase()
 {
-    setRootGroup();
-    for (int r = 0; r < m_parserModel->rowCount(); ++r) {
-        // use validity of second column as a GO/NOGO for all others fields
-        if (not m_parserModel->data(m_parserModel->index(r, 1)).isValid()) {
-            continue;
-        }
-        Entry* entry = new Entry();
-        entry->setUuid(QUuid::createUuid());
-        entry->setGroup(splitGroups(m_parserModel->data(m_parserModel->index(r, 0)).toString()));
-        entry->setTitle(m_parserModel->data(m_parserModel->index(r, 1)).toString());
-        entry->setUsername(m_parserModel->data(m_parserModel->index(r, 2)).toString());
-        entry->setPassword(m_parserModel->data(m_parserModel->index(r, 3)).toString());
-        entry->setUrl(m_parserModel->data(m_parserModel->index(r, 4)).toString());
-        entry->setNotes(m_parserModel->data(m_parserModel->index(r, 5)).toString());
-
-        if (m_parserModel->data(m_parserModel->index(r, 6)).isValid()) {
-            auto totp = Totp::parseSettings(m_parserModel->data(m_parserModel->index(r, 6)).toString());
-            entry->setTotp(totp);
+    setEnabled(false);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    QVector<int> columns;
+    for (int column = 0; column < ImportColumnCount; ++column) {
+        columns.append(m_parserModel->mappedColumn(column));
+    }
+
+    // The whole file is streamed again in batches. While the rows of one batch are converted
+    // in parallel chunks, the next batch is tokenized in the background. Groups are assigned
+    // at the end since the group labels of all rows decide about the name of the root group.
+    QList<QPair<QString, Entry*>> entries;
+    QSet<QString> groupLabels;
+    int skipped = m_parserModel->skippedRows();
+    CsvTable rows;
+    m_parserModel->rewind();
+    int count = AsyncTask::runAndWaitForFuture([&] { return m_parserModel->readRows(rows, ImportBatchSize); });
+    while (count > 0) {
+        if (skipped > 0) {
+            const int skippedInBatch = qMin(skipped, rows.size());
+            rows.erase(rows.begin(), rows.begin() + skippedInBatch);
+            skipped -= skippedInBatch;
         }
 
-        bool ok;
-        int icon = m_parserModel->data(m_parserModel->index(r, 7)).toInt(&ok);
-        if (ok) {
-            entry->setIcon(icon);
+        QList<QFuture<QVector<ImportedRow>>> chunks;
+        for (int begin = 0; begin < rows.size(); begin += ConvertChunkSize) {
+            const CsvTable chunk = rows.mid(begin, ConvertChunkSize);
+            chunks.append(AsyncTask::run(AsyncTask::Executor::Interactive,
+                                         [chunk, columns] { return convertRows(chunk, columns); }));
         }
 
-        TimeInfo timeInfo;
-        if (m_parserModel->data(m_parserModel->index(r, 8)).isValid()) {
-            auto datetime = m_parserModel->data(m_parserModel->index(r, 8)).toString();
-            if (datetime.contains(QRegularExpression("^\\d+$"))) {
-                timeInfo.setLastModificationTime(Clock::datetimeUtc(datetime.toLongLong() * 1000));
-            } else {
-                auto lastModified = QDateTime::fromString(datetime, Qt::ISODate);
-                if (lastModified.isValid()) {
-                    timeInfo.setLastModificationTime(lastModified);
+        count = AsyncTask::runAndWaitForFuture([&] { return m_parserModel->readRows(rows, ImportBatchSize); });
+
+        for (const auto& chunk : asConst(chunks)) {
+            for (const ImportedRow& row : chunk.result()) {
+                auto* entry = new Entry();
+                entry->setUuid(QUuid::createUuid());
+                entry->setTitle(row.title);
+                entry->setUsername(row.username);
+                entry->setPassword(row.password);
+                entry->setUrl(row.url);
+                entry->setNotes(row.notes);
+                entry->setTotp(row.totp);
+                if (row.hasIcon) {
+                    entry->setIcon(row.icon);
                 }
-            }
-        }
-        if (m_parserModel->data(m_parserModel->index(r, 9)).isValid()) {
-            auto datetime = m_parserModel->data(m_parserModel->index(r, 9)).toString();
-            if (datetime.contains(QRegularExpression("^\\d+$"))) {
-                timeInfo.setCreationTime(Clock::datetimeUtc(datetime.toLongLong() * 1000));
-            } else {
-                auto created = QDateTime::fromString(datetime, Qt::ISODate);
-                if (created.isValid()) {
-                    timeInfo.setCreationTime(created);
+
+                TimeInfo timeInfo;
+                if (row.lastModified.isValid()) {
+                    timeInfo.setLastModificationTime(row.lastModified);
+                }
+                if (row.created.isValid()) {
+                    timeInfo.setCreationTime(row.created);
                 }
+                entry->setTimeInfo(timeInfo);
+
+                groupLabels.insert(row.group);
+                entries.append(qMakePair(row.group, entry));
             }
         }
-        entry->setTimeInfo(timeInfo);
     }
-    QBuffer buffer;
-    buffer.open(QBuffer::ReadWrite);
-
-    KeePass2Writer writer;
-    writer.writeDatabase(&buffer, m_db);
-    if (writer.hasError()) {
-        MessageBox::warning(this,
-                            tr("Error"),
-                            tr("CSV import: writer has errors:\n%1").arg(writer.errorString()),
-                            MessageBox::Ok,
-                            MessageBox::Ok);
+
+    m_db->beginBulkUpdate();
+    setRootGroup(groupLabels);
+    QHash<QString, Group*> groups;
+    for (const auto& pair : asConst(entries)) {
+        auto it = groups.constFind(pair.first);
+        if (it == groups.constEnd()) {
+            it = groups.insert(pair.first, splitGroups(pair.first));
+        }
+        // keep the time info read from the file
+        TimeInfo timeInfo = pair.second->timeInfo();
+        pair.second->setGroup(it.value());
+        pair.second->setTimeInfo(timeInfo);
     }
+    m_db->endBulkUpdate();
+
+    QApplication::restoreOverrideCursor();
+    setEnabled(true);
     emit editFinished(true);
 }
 
-void CsvImportWidget::setRootGroup()
+void CsvImportWidget::setRootGroup(const QSet<QString>& groupLabels)
 {
-    QString groupLabel;
     QStringList groupList;
     bool is_root = false;
     bool is_empty = false;
     bool is_label = false;
 
-    for (int r = 0; r < m_parserModel->rowCount(); ++r) {
-        // use validity of second column as a GO/NOGO for all others fields
-        if (not m_parserModel->data(m_parserModel->index(r, 1)).isValid()) {
-            continue;
-        }
-        groupLabel = m_parserModel->data(m_parserModel->index(r, 0)).toString();
+    for (const QString& groupLabel : groupLabels) {
         // check if group name is either "root", "" (empty) or some other label
         groupList = groupLabel.split("/", QString::SkipEmptyParts);
         if (groupList.isEmpty()) {
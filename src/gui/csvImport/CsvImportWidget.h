@@ -23,6 +23,7 @@
 #include <QList>
 #include <QPushButton>
 #include <QScopedPointer>
+#include <QSet>
 #include <QStackedWidget>
 #include <QStringListModel>
 
@@ -53,7 +54,6 @@ private slots:
     void skippedChanged(int rows);
     void writeDatabase();
     void updatePreview();
-    void setRootGroup();
     void reject();
 
 private:
@@ -67,6 +67,7 @@ private:
     const QStringList m_columnHeader;
     QStringList m_fieldSeparatorList;
     void configParser();
+    void setRootGroup(const QSet<QString>& groupLabels);
     void updateTableview();
     Group* splitGroups(const QString& label);
     Group* hasChildren(Group* current, const QString& groupName);
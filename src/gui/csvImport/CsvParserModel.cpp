@@ -20,10 +20,19 @@
 
 #include <utility>
 
+#include "core/Tools.h"
+
+namespace
+{
+    // number of rows parsed for the preview, the import streams the whole file
+    const int PreviewRows = 1000;
+} // namespace
+
 CsvParserModel::CsvParserModel(QObject* parent)
     : QAbstractTableModel(parent)
     , m_skipped(0)
 {
+    setRowLimit(PreviewRows);
 }
 
 CsvParserModel::~CsvParserModel()
@@ -37,9 +46,11 @@ void CsvParserModel::setFilename(const QString& filename)
 
 QString CsvParserModel::getFileInfo()
 {
+    QString rows = isTruncated() ? tr("more than %n row(s)", nullptr, getCsvRows())
+                                 : tr("%n row(s)", nullptr, getCsvRows());
     QString a(tr("%1, %2, %3", "file info: bytes, rows, columns")
-                  .arg(tr("%n byte(s)", nullptr, getFileSize()),
-                       tr("%n row(s)", nullptr, getCsvRows()),
+                  .arg(Tools::humanReadableFileSize(getFileSize()),
+                       rows,
                        tr("%n column(s)", nullptr, qMax(0, getCsvCols() - 1))));
     return a;
 }
@@ -86,6 +97,24 @@ void CsvParserModel::mapColumns(int csvColumn, int dbColumn)
     endResetModel();
 }
 
+int CsvParserModel::skippedRows() const
+{
+    return m_skipped;
+}
+
+/**
+ * Get the field of the rows read with CsvParser::readRows() that a database
+ * column is mapped to, the same way data() maps the rows of the preview.
+ *
+ * @param column database column
+ * @return index into the CSV rows or -1 if the column is not mapped
+ */
+int CsvParserModel::mappedColumn(int column) const
+{
+    // the rows of the preview start with an extra empty column
+    return m_columnMap.value(column) - 1;
+}
+
 void CsvParserModel::setSkippedRows(int skipped)
 {
     m_skipped = skipped;
@@ -38,6 +38,8 @@ public:
 
     void setHeaderLabels(const QStringList& labels);
     void mapColumns(int csvColumn, int dbColumn);
+    int skippedRows() const;
+    int mappedColumn(int column) const;
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
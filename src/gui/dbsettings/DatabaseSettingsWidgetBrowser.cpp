@@ -124,17 +124,16 @@ void DatabaseSettingsWidgetBrowser::updateModel()
     m_customDataModel->clear();
     m_customDataModel->setHorizontalHeaderLabels({tr("Key"), tr("Value"), tr("Created")});
 
-    for (const QString& key : customData()->keys()) {
-        if (key.startsWith(CustomData::BrowserKeyPrefix)) {
-            QString strippedKey = key;
-            strippedKey.remove(CustomData::BrowserKeyPrefix);
-            auto created = customData()->value(QString("%1_%2").arg(CustomData::Created, strippedKey));
-            auto createdItem = new QStandardItem(created);
-            createdItem->setEditable(false);
-            m_customDataModel->appendRow(QList<QStandardItem*>()
-                                         << new QStandardItem(strippedKey)
-                                         << new QStandardItem(customData()->value(key)) << createdItem);
-        }
+    const auto keys = customData()->keysWithPrefix(CustomData::BrowserKeyPrefix);
+    for (const QString& key : keys) {
+        QString strippedKey = key;
+        strippedKey.remove(CustomData::BrowserKeyPrefix);
+        auto created = customData()->value(QString("%1_%2").arg(CustomData::Created, strippedKey));
+        auto createdItem = new QStandardItem(created);
+        createdItem->setEditable(false);
+        m_customDataModel->appendRow(QList<QStandardItem*>()
+                                     << new QStandardItem(strippedKey)
+                                     << new QStandardItem(customData()->value(key)) << createdItem);
     }
 
     m_ui->removeCustomDataButton->setEnabled(false);
@@ -172,12 +171,7 @@ void DatabaseSettingsWidgetBrowser::removeSharedEncryptionKeys()
         return;
     }
 
-    QStringList keysToRemove;
-    for (const QString& key : m_db->metadata()->customData()->keys()) {
-        if (key.startsWith(CustomData::BrowserKeyPrefix)) {
-            keysToRemove << key;
-        }
-    }
+    const QStringList keysToRemove = m_db->metadata()->customData()->keysWithPrefix(CustomData::BrowserKeyPrefix);
 
     if (keysToRemove.isEmpty()) {
         MessageBox::information(this,
@@ -307,12 +301,11 @@ void DatabaseSettingsWidgetBrowser::editFinished(QStandardItem* item)
                 m_db->metadata()->customData()->set(newValue, tempValue);
             } else {
                 // Replace just the value
-                for (const QString& key : m_db->metadata()->customData()->keys()) {
-                    if (key.startsWith(CustomData::BrowserKeyPrefix)) {
-                        if (m_valueInEdit == m_db->metadata()->customData()->value(key)) {
-                            m_db->metadata()->customData()->set(key, newValue);
-                            break;
-                        }
+                const auto keys = m_db->metadata()->customData()->keysWithPrefix(CustomData::BrowserKeyPrefix);
+                for (const QString& key : keys) {
+                    if (m_valueInEdit == m_db->metadata()->customData()->value(key)) {
+                        m_db->metadata()->customData()->set(key, newValue);
+                        break;
                     }
                 }
             }
@@ -38,6 +38,7 @@ DatabaseSettingsWidgetEncryption::DatabaseSettingsWidgetEncryption(QWidget* pare
     m_ui->setupUi(this);
 
     connect(m_ui->transformBenchmarkButton, SIGNAL(clicked()), SLOT(benchmarkTransformRounds()));
+    connect(m_ui->autoTuneButton, SIGNAL(clicked()), SLOT(autoTuneKdf()));
     connect(m_ui->kdfComboBox, SIGNAL(currentIndexChanged(int)), SLOT(changeKdf(int)));
 
     connect(m_ui->memorySpinBox, SIGNAL(valueChanged(int)), this, SLOT(memoryChanged(int)));
@@ -69,6 +70,16 @@ DatabaseSettingsWidgetEncryption::DatabaseSettingsWidgetEncryption(QWidget* pare
     connect(m_ui->transformRoundsSpinBox, SIGNAL(valueChanged(int)), SLOT(markDirty()));
     connect(m_ui->memorySpinBox, SIGNAL(valueChanged(int)), SLOT(markDirty()));
     connect(m_ui->parallelismSpinBox, SIGNAL(valueChanged(int)), SLOT(markDirty()));
+
+    // measure changed parameters in the background once the user stops editing them
+    m_previewTimer.setSingleShot(true);
+    m_previewTimer.setInterval(300);
+    connect(&m_previewTimer, SIGNAL(timeout()), SLOT(updateUnlockTimePreview()));
+    connect(m_ui->kdfComboBox, SIGNAL(currentIndexChanged(int)), &m_previewTimer, SLOT(start()));
+    connect(m_ui->transformRoundsSpinBox, SIGNAL(valueChanged(int)), &m_previewTimer, SLOT(start()));
+    connect(m_ui->memorySpinBox, SIGNAL(valueChanged(int)), &m_previewTimer, SLOT(start()));
+    connect(m_ui->parallelismSpinBox, SIGNAL(valueChanged(int)), &m_previewTimer, SLOT(start()));
+    connect(m_ui->compatibilitySelection, SIGNAL(currentIndexChanged(int)), &m_previewTimer, SLOT(start()));
 }
 
 DatabaseSettingsWidgetEncryption::~DatabaseSettingsWidgetEncryption()
@@ -129,6 +140,7 @@ void DatabaseSettingsWidgetEncryption::showEvent(QShowEvent* event)
 {
     QWidget::showEvent(event);
     m_ui->decryptionTimeSlider->setFocus();
+    m_previewTimer.start();
 }
 
 void DatabaseSettingsWidgetEncryption::setupAlgorithmComboBox()
@@ -195,6 +207,8 @@ void DatabaseSettingsWidgetEncryption::updateKdfFields()
     bool parallelismVisible = (id == KeePass2::KDF_ARGON2);
     m_ui->parallelismLabel->setVisible(parallelismVisible);
     m_ui->parallelismSpinBox->setVisible(parallelismVisible);
+
+    m_ui->autoTuneButton->setVisible(id == KeePass2::KDF_ARGON2);
 }
 
 void DatabaseSettingsWidgetEncryption::activateChangeDecryptionTime()
@@ -234,7 +248,12 @@ bool DatabaseSettingsWidgetEncryption::save()
 
         QApplication::setOverrideCursor(Qt::BusyCursor);
 
-        int rounds = AsyncTask::runAndWaitForFuture([&kdf, time]() { return kdf->benchmark(time); });
+        // usually measured in the background while the settings were open
+        int rounds = kdf->estimateRounds(time);
+        if (rounds <= 0) {
+            rounds = AsyncTask::runAndWaitForFuture(AsyncTask::Executor::Kdf,
+                                                    [&kdf, time]() { return kdf->benchmark(time); });
+        }
         kdf->setRounds(rounds);
 
         // TODO: we should probably use AsyncTask::runAndWaitForFuture() here,
@@ -328,7 +347,11 @@ void DatabaseSettingsWidgetEncryption::benchmarkTransformRounds(int millisecs)
     }
 
     // Determine the number of rounds required to meet 1 second delay
-    int rounds = AsyncTask::runAndWaitForFuture([&kdf, millisecs]() { return kdf->benchmark(millisecs); });
+    int rounds = kdf->estimateRounds(millisecs);
+    if (rounds <= 0) {
+        rounds = AsyncTask::runAndWaitForFuture(AsyncTask::Executor::Kdf,
+                                                [&kdf, millisecs]() { return kdf->benchmark(millisecs); });
+    }
 
     m_ui->transformRoundsSpinBox->setValue(rounds);
     m_ui->transformBenchmarkButton->setEnabled(true);
@@ -336,6 +359,96 @@ void DatabaseSettingsWidgetEncryption::benchmarkTransformRounds(int millisecs)
     QApplication::restoreOverrideCursor();
 }
 
+/**
+ * Let the Argon2 auto-tuner choose memory usage, parallelism and rounds
+ * for the given decryption time. The measured configurations are
+ * listed in the button's tool tip.
+ */
+void DatabaseSettingsWidgetEncryption::autoTuneKdf(int millisecs)
+{
+    auto kdf = KeePass2::uuidToKdf(QUuid(m_ui->kdfComboBox->currentData().toByteArray()));
+    if (kdf->uuid() != KeePass2::KDF_ARGON2) {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::BusyCursor);
+    m_ui->autoTuneButton->setEnabled(false);
+    m_ui->transformBenchmarkButton->setEnabled(false);
+
+    auto argon2Kdf = kdf.staticCast<Argon2Kdf>();
+    const auto results =
+        AsyncTask::runAndWaitForFuture(AsyncTask::Executor::Kdf,
+                                       [&argon2Kdf, millisecs]() { return argon2Kdf->autoTune(millisecs); });
+
+    QStringList report;
+    for (const auto& result : results) {
+        report << tr("%1 MiB, %2 thread(s): %3 rounds, %4", "", static_cast<int>(result.parallelism))
+                      .arg(QString::number(result.memory / (1 << 10)),
+                           QString::number(result.parallelism),
+                           QString::number(result.rounds),
+                           getTextualEncryptionTime(result.msec));
+    }
+    m_ui->autoTuneButton->setToolTip(tr("Measured configurations:\n%1").arg(report.join("\n")));
+
+    m_ui->memorySpinBox->setValue(static_cast<int>(argon2Kdf->memory() / (1 << 10)));
+    m_ui->parallelismSpinBox->setValue(static_cast<int>(argon2Kdf->parallelism()));
+    m_ui->transformRoundsSpinBox->setValue(argon2Kdf->rounds());
+
+    m_ui->autoTuneButton->setEnabled(true);
+    m_ui->transformBenchmarkButton->setEnabled(true);
+    QApplication::restoreOverrideCursor();
+}
+
+/**
+ * Build a KDF from the advanced settings without correcting invalid fields.
+ */
+QSharedPointer<Kdf> DatabaseSettingsWidgetEncryption::kdfFromFields() const
+{
+    auto kdf = KeePass2::uuidToKdf(QUuid(m_ui->kdfComboBox->currentData().toByteArray()));
+    kdf->setRounds(m_ui->transformRoundsSpinBox->value());
+    if (kdf->uuid() == KeePass2::KDF_ARGON2) {
+        auto argon2Kdf = kdf.staticCast<Argon2Kdf>();
+        argon2Kdf->setMemory(static_cast<quint64>(m_ui->memorySpinBox->value()) * (1 << 10));
+        argon2Kdf->setParallelism(static_cast<quint32>(m_ui->parallelismSpinBox->value()));
+    }
+    return kdf;
+}
+
+/**
+ * Show the predicted unlock time of the advanced settings. Configurations
+ * that were not measured yet are benchmarked in the background, one at a
+ * time, while the widget is visible. The results are cached by Kdf, so the
+ * benchmark button, the auto-tuner and saving in simple mode can reuse them.
+ */
+void DatabaseSettingsWidgetEncryption::updateUnlockTimePreview()
+{
+    if (!m_db || !m_db->kdf() || !isVisible()) {
+        return;
+    }
+
+    auto kdf = advancedMode() ? kdfFromFields() : m_db->kdf()->clone();
+    if (advancedMode()) {
+        const int msec = kdf->estimateTransformTime();
+        m_ui->unlockTimeValueLabel->setText(msec < 0 ? tr("Measuring…", "Benchmarking the KDF settings")
+                                                     : getTextualEncryptionTime(msec));
+    }
+
+    if (m_previewBenchmarkRunning || kdf->estimateRounds(Kdf::DEFAULT_ENCRYPTION_TIME) > 0) {
+        return;
+    }
+
+    m_previewBenchmarkRunning = true;
+    AsyncTask::runThenCallback(
+        AsyncTask::Executor::Kdf,
+        [kdf]() { return kdf->benchmark(Kdf::DEFAULT_ENCRYPTION_TIME); },
+        this,
+        [this](int) {
+            m_previewBenchmarkRunning = false;
+            // the parameters may have changed while measuring
+            updateUnlockTimePreview();
+        });
+}
+
 void DatabaseSettingsWidgetEncryption::changeKdf(int index)
 {
     Q_ASSERT(m_db);
@@ -373,6 +486,7 @@ void DatabaseSettingsWidgetEncryption::setAdvancedMode(bool advanced)
     if (advanced) {
         loadKdfParameters();
         m_ui->stackedWidget->setCurrentIndex(1);
+        m_previewTimer.start();
     } else {
         m_ui->compatibilitySelection->setCurrentIndex(m_db->kdf()->uuid() == KeePass2::KDF_AES_KDBX3 ? KDBX3 : KDBX4);
         m_ui->stackedWidget->setCurrentIndex(0);
@@ -24,6 +24,7 @@
 
 #include <QPointer>
 #include <QScopedPointer>
+#include <QTimer>
 
 class Database;
 namespace Ui
@@ -58,6 +59,7 @@ protected:
 
 private slots:
     void benchmarkTransformRounds(int millisecs = Kdf::DEFAULT_ENCRYPTION_TIME);
+    void autoTuneKdf(int millisecs = Kdf::DEFAULT_ENCRYPTION_TIME);
     void changeKdf(int index);
     void memoryChanged(int value);
     void parallelismChanged(int value);
@@ -69,6 +71,7 @@ private slots:
     void updateKdfFields();
     void activateChangeDecryptionTime();
     void markDirty();
+    void updateUnlockTimePreview();
 
 private:
     enum FormatSelection
@@ -78,8 +81,12 @@ private:
     };
     static const char* CD_DECRYPTION_TIME_PREFERENCE_KEY;
 
+    QSharedPointer<Kdf> kdfFromFields() const;
+
     bool m_isDirty = false;
     bool m_formatCompatibilityDirty = false;
+    bool m_previewBenchmarkRunning = false;
+    QTimer m_previewTimer;
     const QScopedPointer<Ui::DatabaseSettingsWidgetEncryption> m_ui;
 };
 
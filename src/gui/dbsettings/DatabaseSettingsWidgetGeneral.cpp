@@ -33,6 +33,10 @@ DatabaseSettingsWidgetGeneral::DatabaseSettingsWidgetGeneral(QWidget* parent)
 
     connect(m_ui->historyMaxItemsCheckBox, SIGNAL(toggled(bool)), m_ui->historyMaxItemsSpinBox, SLOT(setEnabled(bool)));
     connect(m_ui->historyMaxSizeCheckBox, SIGNAL(toggled(bool)), m_ui->historyMaxSizeSpinBox, SLOT(setEnabled(bool)));
+    connect(m_ui->deletedObjectsMaxAgeCheckBox,
+            SIGNAL(toggled(bool)),
+            m_ui->deletedObjectsMaxAgeSpinBox,
+            SLOT(setEnabled(bool)));
 }
 
 DatabaseSettingsWidgetGeneral::~DatabaseSettingsWidgetGeneral()
@@ -64,6 +68,11 @@ void DatabaseSettingsWidgetGeneral::initialize()
         m_ui->historyMaxSizeSpinBox->setValue(Metadata::DefaultHistoryMaxSize);
         m_ui->historyMaxSizeCheckBox->setChecked(false);
     }
+
+    const int deletedObjectsMaxAge = m_db->deletedObjectsMaxAge();
+    m_ui->deletedObjectsMaxAgeSpinBox->setValue(deletedObjectsMaxAge > 0 ? deletedObjectsMaxAge : 365);
+    m_ui->deletedObjectsMaxAgeCheckBox->setChecked(deletedObjectsMaxAge > 0);
+    m_ui->deletedObjectsMaxAgeSpinBox->setEnabled(deletedObjectsMaxAge > 0);
 }
 
 void DatabaseSettingsWidgetGeneral::uninitialize()
@@ -134,6 +143,12 @@ bool DatabaseSettingsWidgetGeneral::save()
         truncate = true;
     }
 
+    const int deletedObjectsMaxAge =
+        m_ui->deletedObjectsMaxAgeCheckBox->isChecked() ? m_ui->deletedObjectsMaxAgeSpinBox->value() : 0;
+    if (deletedObjectsMaxAge != m_db->deletedObjectsMaxAge()) {
+        m_db->setDeletedObjectsMaxAge(deletedObjectsMaxAge);
+    }
+
     if (truncate) {
         const QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive(false);
         for (Entry* entry : allEntries) {
@@ -19,15 +19,31 @@
 #include "AutoTypeMatchModel.h"
 
 #include <QFont>
+#include <QRegExp>
+#include <QSet>
 
+#include "core/AsyncTask.h"
 #include "core/DatabaseIcons.h"
 #include "core/Entry.h"
 #include "core/Global.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 
+namespace
+{
+    // filter this many rows in the background instead of blocking the dialog
+    constexpr int AsyncFilterThreshold = 2000;
+
+    bool hasWildcards(const QString& filter)
+    {
+        return filter.contains('*') || filter.contains('?') || filter.contains('[');
+    }
+} // namespace
+
 AutoTypeMatchModel::AutoTypeMatchModel(QObject* parent)
     : QAbstractTableModel(parent)
+    , m_filterGeneration(0)
+    , m_filterPending(false)
 {
 }
 
@@ -51,7 +67,19 @@ void AutoTypeMatchModel::setMatchList(const QList<AutoTypeMatch>& matches)
     severConnections();
 
     m_allGroups.clear();
+    m_allMatches = matches;
     m_matches = matches;
+    m_searchTexts.clear();
+    m_searchTexts.reserve(matches.size());
+    m_visibleRows.clear();
+    m_visibleRows.reserve(matches.size());
+    for (int i = 0; i < matches.size(); ++i) {
+        m_searchTexts.append(searchText(matches.at(i)));
+        m_visibleRows.append(i);
+    }
+    m_filter.clear();
+    ++m_filterGeneration;
+    m_filterPending = false;
 
     QSet<Database*> databases;
 
@@ -77,6 +105,138 @@ void AutoTypeMatchModel::setMatchList(const QList<AutoTypeMatch>& matches)
     endResetModel();
 }
 
+/**
+ * Only show the matches containing filter in one of their columns, ignoring case.
+ *
+ * A filter extending the previous one narrows the visible matches instead of
+ * checking all of them again. Wildcard filters are matched like
+ * QSortFilterProxyModel::setFilterWildcard() does.
+ */
+void AutoTypeMatchModel::setFilter(const QString& filter)
+{
+    const QString lowerFilter = filter.toLower();
+    const bool narrows = !m_filterPending && !hasWildcards(m_filter) && !hasWildcards(lowerFilter)
+                         && lowerFilter.contains(m_filter);
+
+    QVector<int> candidates;
+    if (narrows) {
+        candidates = m_visibleRows;
+    } else {
+        candidates.reserve(m_allMatches.size());
+        for (int i = 0; i < m_allMatches.size(); ++i) {
+            candidates.append(i);
+        }
+    }
+
+    m_filter = lowerFilter;
+    const quint64 generation = ++m_filterGeneration;
+
+    if (candidates.size() < AsyncFilterThreshold) {
+        m_filterPending = false;
+        applyFilter(filterRows(m_searchTexts, candidates, lowerFilter));
+        return;
+    }
+
+    m_filterPending = true;
+    const QVector<QString> texts = m_searchTexts;
+    AsyncTask::runThenCallback([texts, candidates, lowerFilter] { return filterRows(texts, candidates, lowerFilter); },
+                               this,
+                               [this, generation](const QVector<int>& rows) {
+                                   if (generation != m_filterGeneration) {
+                                       return;
+                                   }
+                                   m_filterPending = false;
+                                   applyFilter(rows);
+                               });
+}
+
+QVector<int>
+AutoTypeMatchModel::filterRows(const QVector<QString>& texts, const QVector<int>& candidates, const QString& filter)
+{
+    if (filter.isEmpty()) {
+        return candidates;
+    }
+
+    QVector<int> rows;
+    if (hasWildcards(filter)) {
+        const QRegExp regExp(filter, Qt::CaseInsensitive, QRegExp::Wildcard);
+        for (int row : candidates) {
+            const QStringList columns = texts.at(row).split('\n');
+            for (const QString& column : columns) {
+                if (regExp.indexIn(column) != -1) {
+                    rows.append(row);
+                    break;
+                }
+            }
+        }
+    } else {
+        for (int row : candidates) {
+            if (texts.at(row).contains(filter)) {
+                rows.append(row);
+            }
+        }
+    }
+    return rows;
+}
+
+/**
+ * Show the given rows of m_allMatches, removing rows in place if they are a
+ * subset of the visible ones.
+ */
+void AutoTypeMatchModel::applyFilter(const QVector<int>& rows)
+{
+    // Both lists are in ascending order
+    int next = 0;
+    for (int row : asConst(m_visibleRows)) {
+        if (next < rows.size() && rows.at(next) == row) {
+            ++next;
+        }
+    }
+
+    if (next != rows.size()) {
+        beginResetModel();
+        m_visibleRows = rows;
+        m_matches.clear();
+        for (int row : rows) {
+            m_matches.append(m_allMatches.at(row));
+        }
+        endResetModel();
+        return;
+    }
+
+    // Remove the filtered rows as ranges, starting at the end
+    QSet<int> kept;
+    kept.reserve(rows.size());
+    for (int row : rows) {
+        kept.insert(row);
+    }
+    int last = m_visibleRows.size() - 1;
+    while (last >= 0) {
+        if (kept.contains(m_visibleRows.at(last))) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !kept.contains(m_visibleRows.at(first - 1))) {
+            --first;
+        }
+        beginRemoveRows(QModelIndex(), first, last);
+        m_visibleRows.remove(first, last - first + 1);
+        m_matches.erase(m_matches.begin() + first, m_matches.begin() + last + 1);
+        endRemoveRows();
+        last = first - 1;
+    }
+}
+
+QString AutoTypeMatchModel::searchText(const AutoTypeMatch& match) const
+{
+    QStringList columns;
+    columns << (match.entry->group() ? match.entry->group()->name() : QString())
+            << match.entry->resolveMultiplePlaceholders(match.entry->title())
+            << match.entry->resolveMultiplePlaceholders(match.entry->username()) << match.sequence;
+    return columns.join('\n').toLower();
+}
+
 int AutoTypeMatchModel::rowCount(const QModelIndex& parent) const
 {
     if (parent.isValid()) {
@@ -155,6 +315,12 @@ QVariant AutoTypeMatchModel::headerData(int section, Qt::Orientation orientation
 
 void AutoTypeMatchModel::entryDataChanged(Entry* entry)
 {
+    for (int i = 0; i < m_allMatches.size(); ++i) {
+        if (m_allMatches.at(i).entry == entry) {
+            m_searchTexts[i] = searchText(m_allMatches.at(i));
+        }
+    }
+
     for (int row = 0; row < m_matches.size(); ++row) {
         AutoTypeMatch match = m_matches[row];
         if (match.entry == entry) {
@@ -170,10 +336,29 @@ void AutoTypeMatchModel::entryAboutToRemove(Entry* entry)
         if (match.entry == entry) {
             beginRemoveRows(QModelIndex(), row, row);
             m_matches.removeAt(row);
+            m_visibleRows.remove(row);
             endRemoveRows();
             --row;
         }
     }
+
+    for (int i = m_allMatches.size() - 1; i >= 0; --i) {
+        if (m_allMatches.at(i).entry != entry) {
+            continue;
+        }
+        m_allMatches.removeAt(i);
+        m_searchTexts.remove(i);
+        for (int& row : m_visibleRows) {
+            if (row > i) {
+                --row;
+            }
+        }
+    }
+
+    // A background filter result refers to the old rows
+    if (m_filterPending) {
+        setFilter(m_filter);
+    }
 }
 
 void AutoTypeMatchModel::entryRemoved()
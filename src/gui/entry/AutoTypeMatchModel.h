@@ -20,6 +20,7 @@
 #define KEEPASSX_AUTOTYPEMATCHMODEL_H
 
 #include <QAbstractTableModel>
+#include <QVector>
 
 #include "core/AutoTypeMatch.h"
 
@@ -49,6 +50,7 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
 
     void setMatchList(const QList<AutoTypeMatch>& matches);
+    void setFilter(const QString& filter);
 
 private slots:
     void entryAboutToRemove(Entry* entry);
@@ -58,9 +60,20 @@ private slots:
 private:
     void severConnections();
     void makeConnections(const Group* group);
+    QString searchText(const AutoTypeMatch& match) const;
+    void applyFilter(const QVector<int>& rows);
+    static QVector<int> filterRows(const QVector<QString>& texts, const QVector<int>& candidates, const QString& filter);
 
+    // all matches and their lower case column texts
+    QList<AutoTypeMatch> m_allMatches;
+    QVector<QString> m_searchTexts;
+    // matches passing the filter and their index in m_allMatches
     QList<AutoTypeMatch> m_matches;
+    QVector<int> m_visibleRows;
     QList<const Group*> m_allGroups;
+    QString m_filter;
+    quint64 m_filterGeneration;
+    bool m_filterPending;
 };
 
 #endif // KEEPASSX_AUTOTYPEMATCHMODEL_H
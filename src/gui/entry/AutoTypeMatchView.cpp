@@ -113,6 +113,11 @@ void AutoTypeMatchView::setMatchList(const QList<AutoTypeMatch>& matches)
     setFirstMatchActive();
 }
 
+void AutoTypeMatchView::filterMatches(const QString& filter)
+{
+    m_model->setFilter(filter);
+}
+
 void AutoTypeMatchView::setFirstMatchActive()
 {
     if (m_model->rowCount() > 0) {
@@ -37,6 +37,7 @@ public:
     void setCurrentMatch(const AutoTypeMatch& match);
     AutoTypeMatch matchFromIndex(const QModelIndex& index);
     void setMatchList(const QList<AutoTypeMatch>& matches);
+    void filterMatches(const QString& filter);
     void setFirstMatchActive();
 
 signals:
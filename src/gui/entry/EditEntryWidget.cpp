@@ -822,7 +822,7 @@ void EditEntryWidget::loadEntry(Entry* entry,
     setReadOnly(m_history);
 
     setCurrentPage(0);
-    setPageHidden(m_historyWidget, m_history || m_entry->historyItems().count() < 1);
+    setPageHidden(m_historyWidget, m_history || m_entry->historyItemCount() < 1);
 #ifdef WITH_XC_SSHAGENT
     setPageHidden(m_sshAgentWidget, !sshAgent()->isEnabled());
 #endif
@@ -985,7 +985,7 @@ void EditEntryWidget::setForms(Entry* entry, bool restore)
     m_editWidgetProperties->setFields(entry->timeInfo(), entry->uuid());
 
     if (!m_history && !restore) {
-        m_historyModel->setEntries(entry->historyItems());
+        m_historyModel->setEntry(entry);
         m_historyUi->historyView->sortByColumn(0, Qt::DescendingOrder);
     }
     if (m_historyModel->rowCount() > 0) {
@@ -1027,7 +1027,7 @@ bool EditEntryWidget::commitEntry()
 
     // must stand before beginUpdate()
     // we don't want to create a new history item, if only the history has changed
-    m_entry->removeHistoryItems(m_historyModel->deletedEntries());
+    m_entry->removeHistoryItemsAt(m_historyModel->deletedEntries());
     m_historyModel->clearDeletedEntries();
 
     m_autoTypeAssoc->removeEmpty();
@@ -1052,7 +1052,7 @@ bool EditEntryWidget::commitEntry()
         m_entry->endUpdate();
     }
 
-    m_historyModel->setEntries(m_entry->historyItems());
+    m_historyModel->setEntry(m_entry);
     m_advancedUi->attachmentsWidget->setEntryAttachments(m_entry->attachments());
 
     showMessage(tr("Entry updated successfully."), MessageWidget::Positive);
@@ -8,8 +8,11 @@
 #include <QFileInfo>
 #include <QMimeData>
 #include <QProcessEnvironment>
+#include <QProgressDialog>
 #include <QTemporaryFile>
 
+#include <limits>
+
 #include "EntryAttachmentsModel.h"
 #include "config-keepassx.h"
 #include "core/Config.h"
@@ -18,6 +21,116 @@
 #include "gui/FileDialog.h"
 #include "gui/MessageBox.h"
 
+namespace
+{
+    // Attachment files are read and written in chunks of this size so the
+    // progress dialog stays responsive for large files
+    constexpr qint64 AttachmentChunkSize = 1024 * 1024;
+
+    int progressUnits(qint64 bytes)
+    {
+        // QProgressDialog only takes int values, count KiB instead of bytes
+        return static_cast<int>(bytes / 1024);
+    }
+
+    /**
+     * Read a file into a single preallocated buffer chunk by chunk.
+     *
+     * @param file opened file
+     * @param data receives the file contents
+     * @param progress progress dialog to update after each chunk
+     * @param processed number of bytes processed so far, updated in place
+     * @param errorMessage receives the error message on failure
+     * @return true on success
+     */
+    bool readFileChunked(QFile& file,
+                         QByteArray& data,
+                         QProgressDialog& progress,
+                         qint64& processed,
+                         QString& errorMessage)
+    {
+        if (file.isSequential()) {
+            if (!Tools::readAllFromDevice(&file, data)) {
+                errorMessage = file.errorString();
+                return false;
+            }
+            return true;
+        }
+
+        const qint64 fileSize = file.size();
+        if (fileSize >= std::numeric_limits<int>::max()) {
+            errorMessage = EntryAttachmentsWidget::tr("File is too large");
+            return false;
+        }
+
+        QByteArray buffer(static_cast<int>(fileSize), Qt::Uninitialized);
+        qint64 bytesRead = 0;
+        while (bytesRead < fileSize) {
+            if (progress.wasCanceled()) {
+                errorMessage = EntryAttachmentsWidget::tr("Operation aborted");
+                return false;
+            }
+
+            const qint64 readResult =
+                file.read(buffer.data() + bytesRead, qMin(AttachmentChunkSize, fileSize - bytesRead));
+            if (readResult < 0) {
+                errorMessage = file.errorString();
+                return false;
+            } else if (readResult == 0) {
+                // file was truncated while reading
+                break;
+            }
+
+            bytesRead += readResult;
+            processed += readResult;
+            progress.setValue(progressUnits(processed));
+        }
+
+        buffer.resize(static_cast<int>(bytesRead));
+        data = buffer;
+        return true;
+    }
+
+    /**
+     * Write attachment data to a device chunk by chunk without copying it.
+     *
+     * @param device opened device
+     * @param data attachment data
+     * @param progress progress dialog to update after each chunk
+     * @param processed number of bytes processed so far, updated in place
+     * @param errorMessage receives the error message on failure
+     * @return true on success
+     */
+    bool writeChunked(QIODevice& device,
+                      const QByteArray& data,
+                      QProgressDialog& progress,
+                      qint64& processed,
+                      QString& errorMessage)
+    {
+        const qint64 dataSize = data.size();
+        qint64 bytesWritten = 0;
+        while (bytesWritten < dataSize) {
+            if (progress.wasCanceled()) {
+                errorMessage = EntryAttachmentsWidget::tr("Operation aborted");
+                return false;
+            }
+
+            const qint64 writeResult =
+                device.write(data.constData() + bytesWritten, qMin(AttachmentChunkSize, dataSize - bytesWritten));
+            if (writeResult < 0) {
+                errorMessage = device.errorString();
+                return false;
+            }
+
+            bytesWritten += writeResult;
+            processed += writeResult;
+            progress.setValue(progressUnits(processed));
+        }
+
+        return true;
+    }
+} // namespace
+
 EntryAttachmentsWidget::EntryAttachmentsWidget(QWidget* parent)
     : QWidget(parent)
     , m_ui(new Ui::EntryAttachmentsWidget)
@@ -218,7 +331,9 @@ void EntryAttachmentsWidget::saveSelectedAttachments()
     }
     config()->set(Config::LastAttachmentDir, QFileInfo(saveDir.absolutePath()).absolutePath());
 
-    QStringList errors;
+    // ask about existing files up front so the questions don't interfere with the progress dialog
+    QStringList filenames;
+    qint64 totalSize = 0;
     for (const QModelIndex& index : indexes) {
         const QString filename = m_attachmentsModel->keyByIndex(index);
         const QString attachmentPath = saveDir.absoluteFilePath(filename);
@@ -243,13 +358,36 @@ void EntryAttachmentsWidget::saveSelectedAttachments()
             }
         }
 
-        QFile file(attachmentPath);
-        const QByteArray attachmentData = m_entryAttachments->value(filename);
-        const bool saveOk = file.open(QIODevice::WriteOnly) && file.write(attachmentData) == attachmentData.size();
-        if (!saveOk) {
+        filenames.append(filename);
+        totalSize += m_entryAttachments->valueSize(filename);
+    }
+
+    QScopedPointer<QProgressDialog> progress(createProgressDialog(tr("Saving attachments…"), totalSize));
+    qint64 processed = 0;
+
+    QStringList errors;
+    for (const QString& filename : asConst(filenames)) {
+        QFile file(saveDir.absoluteFilePath(filename));
+        QString errorMessage;
+        if (!file.open(QIODevice::WriteOnly)) {
             errors.append(QString("%1 - %2").arg(filename, file.errorString()));
+            continue;
+        }
+
+        const QByteArray attachmentData = m_entryAttachments->value(filename);
+        if (!writeChunked(file, attachmentData, *progress, processed, errorMessage) || !file.flush()) {
+            if (errorMessage.isEmpty()) {
+                errorMessage = file.errorString();
+            }
+            errors.append(QString("%1 - %2").arg(filename, errorMessage));
+            file.remove();
+        }
+
+        if (progress->wasCanceled()) {
+            break;
         }
     }
+    progress->reset();
 
     if (!errors.isEmpty()) {
         errorOccurred(tr("Unable to save attachments:\n%1").arg(errors.join('\n')));
@@ -315,18 +453,32 @@ bool EntryAttachmentsWidget::insertAttachments(const QStringList& filenames, QSt
         return false;
     }
 
+    qint64 totalSize = 0;
+    for (const QString& filename : filenames) {
+        totalSize += QFileInfo(filename).size();
+    }
+    QScopedPointer<QProgressDialog> progress(createProgressDialog(tr("Adding attachments…"), totalSize));
+    qint64 processed = 0;
+
     QStringList errors;
     for (const QString& filename : filenames) {
         QByteArray data;
         QFile file(filename);
         const QFileInfo fInfo(filename);
-        const bool readOk = file.open(QIODevice::ReadOnly) && Tools::readAllFromDevice(&file, data);
-        if (readOk) {
+        QString readError;
+        if (!file.open(QIODevice::ReadOnly)) {
+            errors.append(QString("%1 - %2").arg(fInfo.fileName(), file.errorString()));
+        } else if (readFileChunked(file, data, *progress, processed, readError)) {
             m_entryAttachments->set(fInfo.fileName(), data);
         } else {
-            errors.append(QString("%1 - %2").arg(fInfo.fileName(), file.errorString()));
+            errors.append(QString("%1 - %2").arg(fInfo.fileName(), readError));
+        }
+
+        if (progress->wasCanceled()) {
+            break;
         }
     }
+    progress->reset();
 
     if (!errors.isEmpty()) {
         errorMessage = tr("Unable to open file(s):\n%1", "", errors.size()).arg(errors.join('\n'));
@@ -349,10 +501,18 @@ bool EntryAttachmentsWidget::openAttachment(const QModelIndex& index, QString& e
 #endif
 
     QScopedPointer<QTemporaryFile> tmpFile(new QTemporaryFile(tmpFileTemplate, this));
+    if (!tmpFile->open()) {
+        errorMessage = QString("%1 - %2").arg(filename, tmpFile->errorString());
+        return false;
+    }
 
-    const bool saveOk = tmpFile->open() && tmpFile->write(attachmentData) == attachmentData.size() && tmpFile->flush();
+    QScopedPointer<QProgressDialog> progress(createProgressDialog(tr("Opening attachment…"), attachmentData.size()));
+    qint64 processed = 0;
+    QString writeError;
+    const bool saveOk = writeChunked(*tmpFile, attachmentData, *progress, processed, writeError) && tmpFile->flush();
+    progress->reset();
     if (!saveOk) {
-        errorMessage = QString("%1 - %2").arg(filename, tmpFile->errorString());
+        errorMessage = QString("%1 - %2").arg(filename, writeError.isEmpty() ? tmpFile->errorString() : writeError);
         return false;
     }
 
@@ -368,6 +528,23 @@ bool EntryAttachmentsWidget::openAttachment(const QModelIndex& index, QString& e
     return true;
 }
 
+/**
+ * Create a window modal progress dialog for reading or writing attachment
+ * data. The dialog only shows up if the operation takes a noticeable time.
+ *
+ * @param labelText dialog label
+ * @param totalSize total number of bytes to process
+ * @return progress dialog, owned by the caller
+ */
+QProgressDialog* EntryAttachmentsWidget::createProgressDialog(const QString& labelText, qint64 totalSize)
+{
+    auto progress = new QProgressDialog(labelText, tr("Abort"), 0, qMax(1, progressUnits(totalSize)), this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
+    progress->setValue(0);
+    return progress;
+}
+
 QStringList EntryAttachmentsWidget::confirmLargeAttachments(const QStringList& filenames)
 {
     const QString confirmation(tr("%1 is a big file (%2 MB).\nYour database may get very large and reduce "
@@ -10,6 +10,7 @@ namespace Ui
 }
 
 class QByteArray;
+class QProgressDialog;
 class EntryAttachments;
 class EntryAttachmentsModel;
 
@@ -56,6 +57,7 @@ private:
     bool insertAttachments(const QStringList& fileNames, QString& errorMessage);
     bool openAttachment(const QModelIndex& index, QString& errorMessage);
 
+    QProgressDialog* createProgressDialog(const QString& labelText, qint64 totalSize);
     QStringList confirmLargeAttachments(const QStringList& filenames);
 
     bool eventFilter(QObject* watched, QEvent* event) override;
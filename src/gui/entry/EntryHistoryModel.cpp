@@ -17,30 +17,115 @@
 
 #include "EntryHistoryModel.h"
 
-#include "core/Entry.h"
+#include "core/AsyncTask.h"
 #include "core/Global.h"
 
+#include <QTimer>
+
+#include <vector>
+
+namespace
+{
+    // Rows added to the model at a time
+    const int FetchBatchSize = 100;
+    const int ChangesColumn = 4;
+
+    struct ChangesJob
+    {
+        int item;
+        HistoryItem historyItem;
+        HistoryItem previousItem;
+    };
+
+    /**
+     * @return names of the fields that historyItem changed compared to previousItem
+     */
+    QString changedFields(const HistoryItem& historyItem, const HistoryItem& previousItem)
+    {
+        QStringList fields;
+        for (const QString& key : historyItem.changedAttributes(previousItem)) {
+            if (key == EntryAttributes::TitleKey) {
+                fields << EntryHistoryModel::tr("Title");
+            } else if (key == EntryAttributes::UserNameKey) {
+                fields << EntryHistoryModel::tr("Username");
+            } else if (key == EntryAttributes::PasswordKey) {
+                fields << EntryHistoryModel::tr("Password");
+            } else if (key == EntryAttributes::URLKey) {
+                fields << EntryHistoryModel::tr("URL");
+            } else if (key == EntryAttributes::NotesKey) {
+                fields << EntryHistoryModel::tr("Notes");
+            } else {
+                fields << key;
+            }
+        }
+        if (!historyItem.hasSameAttachments(previousItem)) {
+            fields << EntryHistoryModel::tr("Attachments");
+        }
+
+        const EntryData& data = historyItem.data();
+        const EntryData& previousData = previousItem.data();
+        if (data.tags != previousData.tags) {
+            fields << EntryHistoryModel::tr("Tags");
+        }
+        if (data.iconNumber != previousData.iconNumber || data.customIcon != previousData.customIcon) {
+            fields << EntryHistoryModel::tr("Icon");
+        }
+        if (data.foregroundColor != previousData.foregroundColor
+            || data.backgroundColor != previousData.backgroundColor) {
+            fields << EntryHistoryModel::tr("Colors");
+        }
+        if (data.autoTypeEnabled != previousData.autoTypeEnabled
+            || data.autoTypeObfuscation != previousData.autoTypeObfuscation
+            || data.defaultAutoTypeSequence != previousData.defaultAutoTypeSequence) {
+            fields << EntryHistoryModel::tr("Auto-Type");
+        }
+        if (data.timeInfo.expires() != previousData.timeInfo.expires()
+            || data.timeInfo.expiryTime() != previousData.timeInfo.expiryTime()) {
+            fields << EntryHistoryModel::tr("Expiration");
+        }
+
+        if (fields.isEmpty()) {
+            return EntryHistoryModel::tr("No changes");
+        }
+        return fields.join(", ");
+    }
+} // namespace
+
 EntryHistoryModel::EntryHistoryModel(QObject* parent)
     : QAbstractTableModel(parent)
 {
 }
 
+EntryHistoryModel::~EntryHistoryModel()
+{
+    qDeleteAll(m_entries);
+}
+
+/**
+ * Create an entry from the history item of the row to view or restore it.
+ * The model keeps the entry until it shows another history.
+ */
 Entry* EntryHistoryModel::entryFromIndex(const QModelIndex& index) const
 {
-    Q_ASSERT(index.isValid() && index.row() < m_historyEntries.size());
-    return m_historyEntries.at(index.row());
+    Q_ASSERT(index.isValid() && index.row() < m_rows.size());
+    const int item = m_rows.at(index.row());
+    Entry*& entry = m_entries[item];
+    if (!entry) {
+        entry = m_items.at(item).createEntry();
+    }
+    return entry;
 }
 
 int EntryHistoryModel::columnCount(const QModelIndex& parent) const
 {
     Q_UNUSED(parent);
-    return 4;
+    return 5;
 }
 
 int EntryHistoryModel::rowCount(const QModelIndex& parent) const
 {
     if (!parent.isValid()) {
-        return m_historyEntries.count();
+        return m_rows.count();
     } else {
         return 0;
     }
@@ -53,22 +138,31 @@ QVariant EntryHistoryModel::data(const QModelIndex& index, int role) const
     }
 
     if (role == Qt::DisplayRole || role == Qt::UserRole) {
-        Entry* entry = entryFromIndex(index);
-        const TimeInfo& timeInfo = entry->timeInfo();
-        QDateTime lastModificationLocalTime = timeInfo.lastModificationTime().toLocalTime();
+        const int item = m_rows.at(index.row());
+        const HistoryItem& historyItem = m_items.at(item);
         switch (index.column()) {
-        case 0:
+        case 0: {
+            QDateTime lastModificationLocalTime = historyItem.timeInfo().lastModificationTime().toLocalTime();
             if (role == Qt::DisplayRole) {
                 return lastModificationLocalTime.toString(Qt::SystemLocaleShortDate);
             } else {
                 return lastModificationLocalTime;
             }
+        }
         case 1:
-            return entry->title();
+            return historyItem.attributeValue(EntryAttributes::TitleKey);
         case 2:
-            return entry->username();
+            return historyItem.attributeValue(EntryAttributes::UserNameKey);
         case 3:
-            return entry->url();
+            return historyItem.attributeValue(EntryAttributes::URLKey);
+        case ChangesColumn: {
+            auto changes = m_changes.constFind(item);
+            if (changes != m_changes.constEnd()) {
+                return changes.value();
+            }
+            requestChanges(item);
+            return QVariant();
+        }
         }
     }
 
@@ -87,62 +181,167 @@ QVariant EntryHistoryModel::headerData(int section, Qt::Orientation orientation,
             return tr("Username");
         case 3:
             return tr("URL");
+        case ChangesColumn:
+            return tr("Changes");
         }
     }
 
     return QVariant();
 }
 
-void EntryHistoryModel::setEntries(const QList<Entry*>& entries)
+bool EntryHistoryModel::canFetchMore(const QModelIndex& parent) const
 {
-    beginResetModel();
+    return !parent.isValid() && m_nextItem >= 0;
+}
+
+void EntryHistoryModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
 
-    m_historyEntries = entries;
-    m_deletedHistoryEntries.clear();
+    const int count = qMin(FetchBatchSize, m_nextItem + 1);
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + count - 1);
+    for (int i = 0; i < count; ++i) {
+        m_rows.append(m_nextItem--);
+    }
+    endInsertRows();
+}
 
-    endResetModel();
+void EntryHistoryModel::setEntry(const Entry* entry)
+{
+    reset(entry->historySnapshots());
 }
 
 void EntryHistoryModel::clear()
+{
+    reset({});
+}
+
+void EntryHistoryModel::reset(const QList<HistoryItem>& items)
 {
     beginResetModel();
 
-    m_historyEntries.clear();
-    m_deletedHistoryEntries.clear();
+    m_items = items;
+    m_rows.clear();
+    m_nextItem = m_items.size() - 1;
+    m_deletedItems.clear();
+    qDeleteAll(m_entries);
+    m_entries.clear();
+
+    ++m_generation;
+    m_changes.clear();
+    m_requestedChanges.clear();
+    m_queuedChanges.clear();
+    if (!m_items.isEmpty()) {
+        // there is nothing to compare the oldest item with
+        m_changes.insert(0, tr("Oldest version"));
+    }
+
+    const int count = qMin(FetchBatchSize, m_items.size());
+    for (int i = 0; i < count; ++i) {
+        m_rows.append(m_nextItem--);
+    }
 
     endResetModel();
 }
 
+/**
+ * Queue the comparison of a history item with the previous one, the queued
+ * items are compared together once control returns to the event loop.
+ */
+void EntryHistoryModel::requestChanges(int item) const
+{
+    if (m_requestedChanges.contains(item)) {
+        return;
+    }
+    m_requestedChanges.insert(item);
+
+    if (m_queuedChanges.isEmpty()) {
+        auto* model = const_cast<EntryHistoryModel*>(this);
+        QTimer::singleShot(0, model, [model] { model->computeChanges(); });
+    }
+    m_queuedChanges.append(item);
+}
+
+void EntryHistoryModel::computeChanges()
+{
+    if (m_queuedChanges.isEmpty()) {
+        return;
+    }
+
+    std::vector<ChangesJob> jobs;
+    jobs.reserve(m_queuedChanges.size());
+    for (int item : asConst(m_queuedChanges)) {
+        jobs.push_back({item, m_items.at(item), m_items.at(item - 1)});
+    }
+    m_queuedChanges.clear();
+
+    const quint64 generation = m_generation;
+    AsyncTask::runThenCallback(
+        AsyncTask::Executor::Interactive,
+        [jobs] {
+            QVector<QPair<int, QString>> results;
+            results.reserve(static_cast<int>(jobs.size()));
+            for (const ChangesJob& job : jobs) {
+                results.append({job.item, changedFields(job.historyItem, job.previousItem)});
+            }
+            return results;
+        },
+        this,
+        [this, generation](const QVector<QPair<int, QString>>& results) {
+            // the model shows another history by now
+            if (generation != m_generation) {
+                return;
+            }
+
+            for (const auto& result : results) {
+                m_changes.insert(result.first, result.second);
+                const int row = m_rows.indexOf(result.first);
+                if (row >= 0) {
+                    emit dataChanged(index(row, ChangesColumn), index(row, ChangesColumn));
+                }
+            }
+        });
+}
+
 void EntryHistoryModel::clearDeletedEntries()
 {
-    m_deletedHistoryEntries.clear();
+    m_deletedItems.clear();
 }
 
-QList<Entry*> EntryHistoryModel::deletedEntries()
+/**
+ * @return positions of the deleted items in the history of the entry
+ */
+QList<int> EntryHistoryModel::deletedEntries() const
 {
-    return m_deletedHistoryEntries;
+    return m_deletedItems;
 }
 
 void EntryHistoryModel::deleteIndex(QModelIndex index)
 {
     if (index.isValid()) {
-        Entry* entry = entryFromIndex(index);
-        beginRemoveRows(QModelIndex(), m_historyEntries.indexOf(entry), m_historyEntries.indexOf(entry));
-        m_historyEntries.removeAll(entry);
-        m_deletedHistoryEntries << entry;
+        const int row = index.row();
+        beginRemoveRows(QModelIndex(), row, row);
+        m_deletedItems << m_rows.at(row);
+        m_rows.remove(row);
         endRemoveRows();
     }
 }
 
 void EntryHistoryModel::deleteAll()
 {
-    Q_ASSERT(m_historyEntries.count() > 0);
+    Q_ASSERT(m_rows.count() > 0);
 
-    beginRemoveRows(QModelIndex(), 0, m_historyEntries.size() - 1);
+    beginRemoveRows(QModelIndex(), 0, m_rows.size() - 1);
 
-    for (Entry* entry : asConst(m_historyEntries)) {
-        m_deletedHistoryEntries << entry;
+    for (int item : asConst(m_rows)) {
+        m_deletedItems << item;
+    }
+    // the items without a row yet are gone as well
+    while (m_nextItem >= 0) {
+        m_deletedItems << m_nextItem--;
     }
-    m_historyEntries.clear();
+    m_rows.clear();
     endRemoveRows();
 }
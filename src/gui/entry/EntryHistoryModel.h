@@ -19,32 +19,61 @@
 #define KEEPASSX_ENTRYHISTORYMODEL_H
 
 #include <QAbstractTableModel>
+#include <QHash>
+#include <QSet>
+#include <QVector>
 
-class Entry;
+#include "core/Entry.h"
 
+/**
+ * History items of an entry, newest first. The model works on snapshots of the
+ * items, so compact history items are not expanded into entries. Rows are added
+ * in batches as the view scrolls, and the fields each item changed compared to
+ * the previous one are worked out in the background once a row is shown.
+ */
 class EntryHistoryModel : public QAbstractTableModel
 {
     Q_OBJECT
 
 public:
     explicit EntryHistoryModel(QObject* parent = nullptr);
+    ~EntryHistoryModel() override;
 
     Entry* entryFromIndex(const QModelIndex& index) const;
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
 
-    void setEntries(const QList<Entry*>& entries);
+    void setEntry(const Entry* entry);
     void clear();
     void clearDeletedEntries();
-    QList<Entry*> deletedEntries();
+    QList<int> deletedEntries() const;
     void deleteIndex(QModelIndex index);
     void deleteAll();
 
 private:
-    QList<Entry*> m_historyEntries;
-    QList<Entry*> m_deletedHistoryEntries;
+    void reset(const QList<HistoryItem>& items);
+    void requestChanges(int item) const;
+    void computeChanges();
+
+    // snapshots from oldest to newest, as in the entry
+    QList<HistoryItem> m_items;
+    // item shown in each row
+    QVector<int> m_rows;
+    // newest item that has no row yet, -1 once all have one
+    int m_nextItem = -1;
+    QList<int> m_deletedItems;
+    // entries created from the items for viewing or restoring them
+    mutable QHash<int, Entry*> m_entries;
+
+    mutable QHash<int, QString> m_changes;
+    mutable QSet<int> m_requestedChanges;
+    mutable QList<int> m_queuedChanges;
+    // tells results of a previous history apart
+    quint64 m_generation = 0;
 };
 
 #endif // KEEPASSX_ENTRYHISTORYMODEL_H
@@ -18,28 +18,43 @@
 #include "EntryModel.h"
 
 #include <QDateTime>
+#include <QFileInfo>
 #include <QFont>
 #include <QMimeData>
 #include <QPainter>
 #include <QPalette>
 
 #include "core/Config.h"
+#include "core/Database.h"
 #include "core/DatabaseIcons.h"
 #include "core/Entry.h"
 #include "core/Global.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/Trace.h"
 #include "gui/Icons.h"
 #ifdef Q_OS_MACOS
 #include "gui/osutils/macutils/MacUtils.h"
 #endif
 
+namespace
+{
+    QString databaseName(const Database* db)
+    {
+        if (!db->metadata()->name().isEmpty()) {
+            return db->metadata()->name();
+        }
+        return QFileInfo(db->filePath()).fileName();
+    }
+} // namespace
+
 EntryModel::EntryModel(QObject* parent)
     : QAbstractTableModel(parent)
     , m_group(nullptr)
     , HiddenContentDisplay(QString("\u25cf").repeated(6))
     , DateFormat(Qt::DefaultLocaleShortDate)
 {
+    loadConfig();
     connect(config(), &Config::changed, this, &EntryModel::onConfigChanged);
 }
 
@@ -62,54 +77,131 @@ void EntryModel::setGroup(Group* group)
         return;
     }
 
-    beginResetModel();
-
-    severConnections();
+    if (m_group) {
+        disconnect(m_group, nullptr, this, nullptr);
+    }
 
     m_group = group;
-    m_allGroups.clear();
-    m_entries = group->entries();
     m_orgEntries.clear();
 
     makeConnections(group);
+    QSet<Database*> databases;
+    if (group->database()) {
+        databases.insert(group->database());
+    }
+    setDatabases(databases);
 
-    endResetModel();
+    updateEntries(group->entries());
 }
 
+/**
+ * Display a list of entries, e.g. search results. Changes of these entries
+ * are tracked through the signals of their databases.
+ */
 void EntryModel::setEntries(const QList<Entry*>& entries)
 {
-    beginResetModel();
-
-    severConnections();
+    if (m_group) {
+        disconnect(m_group, nullptr, this, nullptr);
+        m_group = nullptr;
+    }
 
-    m_group = nullptr;
-    m_allGroups.clear();
-    m_entries = entries;
     m_orgEntries = entries;
 
     QSet<Database*> databases;
+    for (Entry* entry : entries) {
+        Q_ASSERT(entry->group()->database());
+        databases.insert(entry->group()->database());
+    }
+    setDatabases(databases);
 
+    updateEntries(entries);
+}
+
+/**
+ * Replace the displayed entries with row removals and insertions, so the view
+ * keeps the selection and scroll position of the rows that stay. A model reset
+ * is used instead if the staying rows are reordered or if there are too many
+ * separate ranges of changed rows.
+ */
+void EntryModel::updateEntries(const QList<Entry*>& entries)
+{
+    const int MaxChangedRanges = 64;
+
+    QSet<Entry*> newEntries;
+    newEntries.reserve(entries.size());
+    for (Entry* entry : entries) {
+        newEntries.insert(entry);
+    }
+    QSet<Entry*> oldEntries;
+    oldEntries.reserve(m_entries.size());
     for (Entry* entry : asConst(m_entries)) {
-        databases.insert(entry->group()->database());
+        oldEntries.insert(entry);
     }
 
-    for (Database* db : asConst(databases)) {
-        Q_ASSERT(db);
-        const QList<Group*> groupList = db->rootGroup()->groupsRecursive(true);
-        for (const Group* group : groupList) {
-            m_allGroups.append(group);
+    // The staying entries must have the same order in both lists
+    int changedRanges = 0;
+    bool incremental = m_bulkUpdates == 0 && !m_resetPending;
+    int oldRow = 0;
+    for (int row = 0; incremental && row < entries.size(); ++row) {
+        if (!oldEntries.contains(entries.at(row))) {
+            if (row == 0 || oldEntries.contains(entries.at(row - 1))) {
+                ++changedRanges;
+            }
+            continue;
         }
-
-        if (db->metadata()->recycleBin()) {
-            m_allGroups.removeOne(db->metadata()->recycleBin());
+        while (oldRow < m_entries.size() && !newEntries.contains(m_entries.at(oldRow))) {
+            if (oldRow == 0 || newEntries.contains(m_entries.at(oldRow - 1))) {
+                ++changedRanges;
+            }
+            ++oldRow;
         }
+        incremental = oldRow < m_entries.size() && m_entries.at(oldRow) == entries.at(row);
+        ++oldRow;
     }
+    incremental = incremental && changedRanges <= MaxChangedRanges;
 
-    for (const Group* group : asConst(m_allGroups)) {
-        makeConnections(group);
+    if (!incremental) {
+        beginBulkReset();
+        m_entries = entries;
+        endBulkReset();
+        return;
     }
 
-    endResetModel();
+    // Remove rows from the end, so the row numbers of earlier ranges stay valid
+    for (int last = m_entries.size() - 1; last >= 0; --last) {
+        if (newEntries.contains(m_entries.at(last))) {
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !newEntries.contains(m_entries.at(first - 1))) {
+            --first;
+        }
+        beginRemoveRows(QModelIndex(), first, last);
+        for (int row = first; row <= last; ++row) {
+            m_displayRecords.remove(m_entries.at(row));
+        }
+        m_entries.erase(m_entries.begin() + first, m_entries.begin() + last + 1);
+        endRemoveRows();
+        last = first;
+    }
+
+    // The remaining rows are the staying entries in the new order
+    for (int first = 0; first < entries.size(); ++first) {
+        if (oldEntries.contains(entries.at(first))) {
+            continue;
+        }
+        int last = first;
+        while (last + 1 < entries.size() && !oldEntries.contains(entries.at(last + 1))) {
+            ++last;
+        }
+        beginInsertRows(QModelIndex(), first, last);
+        QList<Entry*> updated = m_entries.mid(0, first);
+        updated.append(entries.mid(first, last - first + 1));
+        updated.append(m_entries.mid(first));
+        m_entries = updated;
+        endInsertRows();
+        first = last;
+    }
 }
 
 int EntryModel::rowCount(const QModelIndex& parent) const
@@ -133,122 +225,75 @@ int EntryModel::columnCount(const QModelIndex& parent) const
 
 QVariant EntryModel::data(const QModelIndex& index, int role) const
 {
+    TRACE_SCOPE("EntryModel::data");
     if (!index.isValid()) {
         return QVariant();
     }
 
     Entry* entry = entryFromIndex(index);
-    EntryAttributes* attr = entry->attributes();
 
     if (role == Qt::DisplayRole) {
+        const DisplayRecord& record = displayRecord(entry);
         QString result;
         switch (index.column()) {
         case ParentGroup:
             if (entry->group()) {
+                // Name the database of each result when they come from several
+                if (m_databases.size() > 1 && entry->database()) {
+                    return QString("%1 / %2").arg(databaseName(entry->database()), entry->group()->name());
+                }
                 return entry->group()->name();
             }
             break;
         case Title:
-            result = entry->resolveMultiplePlaceholders(entry->title());
-            if (attr->isReference(EntryAttributes::TitleKey)) {
-                result.prepend(tr("Ref: ", "Reference abbreviation"));
-            }
-            return result;
+            return record.title;
         case Username:
-            if (config()->get(Config::GUI_HideUsernames).toBool()) {
-                result = EntryModel::HiddenContentDisplay;
-            } else {
-                result = entry->resolveMultiplePlaceholders(entry->username());
+            if (entry->username().isEmpty() && !m_emptyPlaceholder) {
+                return result;
             }
-            if (attr->isReference(EntryAttributes::UserNameKey)) {
+            result = m_hideUsernames ? EntryModel::HiddenContentDisplay : record.username;
+            if (entry->attributes()->isReference(EntryAttributes::UserNameKey)) {
                 result.prepend(tr("Ref: ", "Reference abbreviation"));
             }
-            if (entry->username().isEmpty() && !config()->get(Config::Security_PasswordEmptyPlaceholder).toBool()) {
-                result = "";
-            }
             return result;
         case Password:
-            if (config()->get(Config::GUI_HidePasswords).toBool()) {
-                result = EntryModel::HiddenContentDisplay;
-            } else {
-                result = entry->resolveMultiplePlaceholders(entry->password());
+            if (entry->password().isEmpty() && !m_emptyPlaceholder) {
+                return result;
             }
-            if (attr->isReference(EntryAttributes::PasswordKey)) {
+            result = m_hidePasswords ? EntryModel::HiddenContentDisplay : record.password;
+            if (entry->attributes()->isReference(EntryAttributes::PasswordKey)) {
                 result.prepend(tr("Ref: ", "Reference abbreviation"));
             }
-            if (entry->password().isEmpty() && !config()->get(Config::Security_PasswordEmptyPlaceholder).toBool()) {
-                result = "";
-            }
             return result;
         case Url:
-            result = entry->resolveMultiplePlaceholders(entry->displayUrl());
-            if (attr->isReference(EntryAttributes::URLKey)) {
-                result.prepend(tr("Ref: ", "Reference abbreviation"));
-            }
-            return result;
+            return record.url;
         case Notes:
             if (!entry->notes().isEmpty()) {
-                if (config()->get(Config::Security_HideNotes).toBool()) {
-                    result = EntryModel::HiddenContentDisplay;
-                } else {
-                    // Display only first line of notes in simplified format if not hidden
-                    result = entry->notes().section("\n", 0, 0).simplified();
-                }
-                if (attr->isReference(EntryAttributes::NotesKey)) {
+                result = m_hideNotes ? EntryModel::HiddenContentDisplay : record.notes;
+                if (entry->attributes()->isReference(EntryAttributes::NotesKey)) {
                     result.prepend(tr("Ref: ", "Reference abbreviation"));
                 }
             }
             return result;
         case Expires:
-            // Display either date of expiry or 'Never'
-            result = entry->timeInfo().expires()
-                         ? entry->timeInfo().expiryTime().toLocalTime().toString(EntryModel::DateFormat)
-                         : tr("Never");
-            return result;
+            return record.expires;
         case Created:
-            result = entry->timeInfo().creationTime().toLocalTime().toString(EntryModel::DateFormat);
-            return result;
+            return record.created;
         case Modified:
-            result = entry->timeInfo().lastModificationTime().toLocalTime().toString(EntryModel::DateFormat);
-            return result;
+            return record.modified;
         case Accessed:
-            result = entry->timeInfo().lastAccessTime().toLocalTime().toString(EntryModel::DateFormat);
-            return result;
-        case Attachments: {
-            // Display comma-separated list of attachments
-            QList<QString> attachments = entry->attachments()->keys();
-            for (const auto& attachment : attachments) {
-                if (result.isEmpty()) {
-                    result.append(attachment);
-                    continue;
-                }
-                result.append(QString(", ") + attachment);
-            }
-            return result;
-        }
-        case Size: {
-            const int unitsSize = 4;
-            QString units[unitsSize] = {"B", "KiB", "MiB", "GiB"};
-            float resultInt = entry->size();
-
-            for (int i = 0; i < unitsSize; i++) {
-                if (resultInt < 1024 || i == unitsSize - 1) {
-                    resultInt = qRound(resultInt * 100) / 100.0;
-                    result = QStringLiteral("%1 %2").arg(QString::number(resultInt), units[i]);
-                    break;
-                }
-                resultInt /= 1024.0;
-            }
-
-            return result;
-        }
+            return record.accessed;
+        case Attachments:
+            return record.attachments;
+        case Size:
+            return record.size;
         }
     } else if (role == Qt::UserRole) { // Qt::UserRole is used as sort role, see EntryView::EntryView()
         switch (index.column()) {
         case Username:
-            return entry->resolveMultiplePlaceholders(entry->username());
+            return displayRecord(entry).username;
         case Password:
-            return entry->resolveMultiplePlaceholders(entry->password());
+            return displayRecord(entry).password;
         case Expires:
             // There seems to be no better way of expressing 'infinity'
             return entry->timeInfo().expires() ? entry->timeInfo().expiryTime() : QDateTime(QDate(9999, 1, 1));
@@ -300,7 +345,7 @@ QVariant EntryModel::data(const QModelIndex& index, int role) const
     } else if (role == Qt::ForegroundRole) {
         QColor foregroundColor;
         foregroundColor.setNamedColor(entry->foregroundColor());
-        if (entry->hasReferences()) {
+        if (displayRecord(entry).hasReferences) {
             QPalette p;
             foregroundColor = p.color(QPalette::Current, QPalette::Text);
             int lightness =
@@ -325,6 +370,65 @@ QVariant EntryModel::data(const QModelIndex& index, int role) const
     return QVariant();
 }
 
+/**
+ * Resolving placeholders and formatting is too slow to repeat for every
+ * paint and sort, so the display values of an entry are computed once.
+ */
+const EntryModel::DisplayRecord& EntryModel::displayRecord(Entry* entry) const
+{
+    const Database* db = entry->database();
+    const quint64 modificationCount = db ? db->modificationCount() : 0;
+    auto it = m_displayRecords.find(entry);
+    if (it != m_displayRecords.end() && it->revision == entry->revision()
+        && (!it->hasReferences || it->modificationCount == modificationCount)) {
+        return it.value();
+    }
+
+    const EntryAttributes* attr = entry->attributes();
+    DisplayRecord record;
+    record.revision = entry->revision();
+    record.hasReferences = entry->hasReferences();
+    record.modificationCount = modificationCount;
+
+    record.title = entry->resolveMultiplePlaceholders(entry->title());
+    if (attr->isReference(EntryAttributes::TitleKey)) {
+        record.title.prepend(tr("Ref: ", "Reference abbreviation"));
+    }
+    record.username = entry->resolveMultiplePlaceholders(entry->username());
+    record.password = entry->resolveMultiplePlaceholders(entry->password());
+    record.url = entry->resolveMultiplePlaceholders(entry->displayUrl());
+    if (attr->isReference(EntryAttributes::URLKey)) {
+        record.url.prepend(tr("Ref: ", "Reference abbreviation"));
+    }
+    // Display only first line of notes in simplified format
+    record.notes = entry->notes().section("\n", 0, 0).simplified();
+
+    // Display either date of expiry or 'Never'
+    const TimeInfo& timeInfo = entry->timeInfo();
+    record.expires = timeInfo.expires() ? timeInfo.expiryTime().toLocalTime().toString(EntryModel::DateFormat)
+                                        : tr("Never");
+    record.created = timeInfo.creationTime().toLocalTime().toString(EntryModel::DateFormat);
+    record.modified = timeInfo.lastModificationTime().toLocalTime().toString(EntryModel::DateFormat);
+    record.accessed = timeInfo.lastAccessTime().toLocalTime().toString(EntryModel::DateFormat);
+
+    // Display comma-separated list of attachments
+    record.attachments = QStringList(entry->attachments()->keys()).join(", ");
+
+    const int unitsSize = 4;
+    QString units[unitsSize] = {"B", "KiB", "MiB", "GiB"};
+    float resultInt = entry->size();
+    for (int i = 0; i < unitsSize; i++) {
+        if (resultInt < 1024 || i == unitsSize - 1) {
+            resultInt = qRound(resultInt * 100) / 100.0;
+            record.size = QStringLiteral("%1 %2").arg(QString::number(resultInt), units[i]);
+            break;
+        }
+        resultInt /= 1024.0;
+    }
+
+    return m_displayRecords.insert(entry, record).value();
+}
+
 QVariant EntryModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     Q_UNUSED(orientation);
@@ -463,46 +567,53 @@ QMimeData* EntryModel::mimeData(const QModelIndexList& indexes) const
 
 void EntryModel::entryAboutToAdd(Entry* entry)
 {
-    if (!m_group && !m_orgEntries.contains(entry)) {
+    Q_UNUSED(entry);
+
+    if (m_bulkUpdates > 0) {
+        beginBulkReset();
         return;
     }
 
     beginInsertRows(QModelIndex(), m_entries.size(), m_entries.size());
-    if (!m_group) {
-        m_entries.append(entry);
-    }
 }
 
 void EntryModel::entryAdded(Entry* entry)
 {
-    if (!m_group && !m_orgEntries.contains(entry)) {
-        return;
-    }
+    Q_UNUSED(entry);
 
-    if (m_group) {
-        m_entries = m_group->entries();
+    m_entries = m_group->entries();
+    if (!m_resetPending) {
+        endInsertRows();
     }
-    endInsertRows();
 }
 
 void EntryModel::entryAboutToRemove(Entry* entry)
 {
-    beginRemoveRows(QModelIndex(), m_entries.indexOf(entry), m_entries.indexOf(entry));
-    if (!m_group) {
-        m_entries.removeAll(entry);
+    m_displayRecords.remove(entry);
+
+    if (m_bulkUpdates > 0) {
+        beginBulkReset();
+        return;
     }
+
+    beginRemoveRows(QModelIndex(), m_entries.indexOf(entry), m_entries.indexOf(entry));
 }
 
 void EntryModel::entryRemoved()
 {
-    if (m_group) {
-        m_entries = m_group->entries();
+    m_entries = m_group->entries();
+    if (!m_resetPending) {
+        endRemoveRows();
     }
-    endRemoveRows();
 }
 
 void EntryModel::entryAboutToMoveUp(int row)
 {
+    if (m_bulkUpdates > 0) {
+        beginBulkReset();
+        return;
+    }
+
     beginMoveRows(QModelIndex(), row, row, QModelIndex(), row - 1);
     if (m_group) {
         m_entries.move(row, row - 1);
@@ -514,11 +625,18 @@ void EntryModel::entryMovedUp()
     if (m_group) {
         m_entries = m_group->entries();
     }
-    endMoveRows();
+    if (!m_resetPending) {
+        endMoveRows();
+    }
 }
 
 void EntryModel::entryAboutToMoveDown(int row)
 {
+    if (m_bulkUpdates > 0) {
+        beginBulkReset();
+        return;
+    }
+
     beginMoveRows(QModelIndex(), row, row, QModelIndex(), row + 2);
     if (m_group) {
         m_entries.move(row, row + 1);
@@ -530,24 +648,188 @@ void EntryModel::entryMovedDown()
     if (m_group) {
         m_entries = m_group->entries();
     }
-    endMoveRows();
+    if (!m_resetPending) {
+        endMoveRows();
+    }
 }
 
 void EntryModel::entryDataChanged(Entry* entry)
 {
+    if (m_bulkUpdates > 0) {
+        m_dataChangePending = true;
+        return;
+    }
+
     int row = m_entries.indexOf(entry);
-    emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    if (row != -1) {
+        emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    }
+}
+
+/**
+ * A displayed entry that was moved to another group is shown again,
+ * unless it was moved to the recycle bin.
+ */
+void EntryModel::databaseEntryAdded(Entry* entry)
+{
+    if (m_group || !m_orgEntries.contains(entry) || m_entries.contains(entry)) {
+        return;
+    }
+
+    const Database* db = entry->database();
+    if (db && db->metadata()->recycleBin() && entry->group() == db->metadata()->recycleBin()) {
+        return;
+    }
+
+    if (m_bulkUpdates > 0) {
+        beginBulkReset();
+        m_entries.append(entry);
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_entries.size(), m_entries.size());
+    m_entries.append(entry);
+    endInsertRows();
+}
+
+void EntryModel::databaseEntryAboutToRemove(Entry* entry)
+{
+    if (m_group) {
+        return;
+    }
+
+    m_displayRecords.remove(entry);
+    int row = m_entries.indexOf(entry);
+    if (row == -1) {
+        return;
+    }
+
+    if (m_bulkUpdates > 0) {
+        beginBulkReset();
+        m_entries.removeAt(row);
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_entries.removeAt(row);
+    endRemoveRows();
+}
+
+void EntryModel::databaseEntryDataChanged(Entry* entry)
+{
+    if (!m_group) {
+        entryDataChanged(entry);
+    }
+}
+
+void EntryModel::bulkUpdateStarted()
+{
+    ++m_bulkUpdates;
+}
+
+/**
+ * Report the changes of a finished bulk update at once: a model reset if
+ * entries were added, removed or moved, otherwise a single data change.
+ */
+void EntryModel::bulkUpdateFinished()
+{
+    if (m_bulkUpdates == 0 || --m_bulkUpdates > 0) {
+        return;
+    }
+
+    if (m_resetPending) {
+        endBulkReset();
+    } else if (m_dataChangePending && !m_entries.isEmpty()) {
+        emit dataChanged(index(0, 0), index(m_entries.size() - 1, columnCount() - 1));
+    }
+    m_dataChangePending = false;
+}
+
+/**
+ * The entries of a released database are deleted without signals,
+ * so the model drops all of them beforehand.
+ */
+void EntryModel::databaseAboutToBeReleased()
+{
+    // Search results can come from several databases, keep the others
+    auto* db = qobject_cast<Database*>(sender());
+    if (db && !m_group) {
+        QList<Entry*> entries;
+        for (Entry* entry : asConst(m_entries)) {
+            if (entry->database() != db) {
+                entries.append(entry);
+            }
+        }
+        // Entries that are not displayed might not exist anymore
+        m_orgEntries = entries;
+
+        QSet<Database*> databases;
+        for (const QPointer<Database>& otherDb : asConst(m_databases)) {
+            if (otherDb && otherDb != db) {
+                databases.insert(otherDb.data());
+            }
+        }
+        setDatabases(databases);
+        updateEntries(entries);
+        return;
+    }
+
+    beginBulkReset();
+    severConnections();
+    m_group = nullptr;
+    m_entries.clear();
+    m_orgEntries.clear();
+    endBulkReset();
+}
+
+void EntryModel::beginBulkReset()
+{
+    if (!m_resetPending) {
+        m_resetPending = true;
+        beginResetModel();
+    }
+}
+
+void EntryModel::endBulkReset()
+{
+    if (m_resetPending) {
+        if (m_group) {
+            m_entries = m_group->entries();
+        }
+        m_resetPending = false;
+        m_dataChangePending = false;
+        m_displayRecords.clear();
+        endResetModel();
+    }
+}
+
+void EntryModel::loadConfig()
+{
+    m_hideUsernames = config()->get(Config::GUI_HideUsernames).toBool();
+    m_hidePasswords = config()->get(Config::GUI_HidePasswords).toBool();
+    m_hideNotes = config()->get(Config::Security_HideNotes).toBool();
+    m_emptyPlaceholder = config()->get(Config::Security_PasswordEmptyPlaceholder).toBool();
 }
 
 void EntryModel::onConfigChanged(Config::ConfigKey key)
 {
     switch (key) {
     case Config::GUI_HideUsernames:
+        loadConfig();
         emit dataChanged(index(0, Username), index(rowCount() - 1, Username), {Qt::DisplayRole});
         break;
     case Config::GUI_HidePasswords:
+        loadConfig();
         emit dataChanged(index(0, Password), index(rowCount() - 1, Password), {Qt::DisplayRole});
         break;
+    case Config::Security_HideNotes:
+        loadConfig();
+        emit dataChanged(index(0, Notes), index(rowCount() - 1, Notes), {Qt::DisplayRole});
+        break;
+    case Config::Security_PasswordEmptyPlaceholder:
+        loadConfig();
+        emit dataChanged(index(0, Username), index(rowCount() - 1, Password), {Qt::DisplayRole});
+        break;
     default:
         break;
     }
@@ -559,9 +841,13 @@ void EntryModel::severConnections()
         disconnect(m_group, nullptr, this, nullptr);
     }
 
-    for (const Group* group : asConst(m_allGroups)) {
-        disconnect(group, nullptr, this, nullptr);
+    for (const QPointer<Database>& db : asConst(m_databases)) {
+        if (db) {
+            disconnect(db.data(), nullptr, this, nullptr);
+        }
     }
+    m_databases.clear();
+    m_bulkUpdates = 0;
 }
 
 void EntryModel::makeConnections(const Group* group)
@@ -576,3 +862,46 @@ void EntryModel::makeConnections(const Group* group)
     connect(group, SIGNAL(entryMovedDown()), SLOT(entryMovedDown()));
     connect(group, SIGNAL(entryDataChanged(Entry*)), SLOT(entryDataChanged(Entry*)));
 }
+
+void EntryModel::makeConnections(Database* db)
+{
+    if (m_databases.contains(db)) {
+        return;
+    }
+
+    m_databases.append(db);
+    connect(db, &Database::bulkUpdateStarted, this, &EntryModel::bulkUpdateStarted);
+    connect(db, &Database::bulkUpdateFinished, this, &EntryModel::bulkUpdateFinished);
+    connect(db, &Database::dataAboutToBeReleased, this, &EntryModel::databaseAboutToBeReleased);
+    connect(db, &Database::entryAdded, this, &EntryModel::databaseEntryAdded);
+    connect(db, &Database::entryAboutToRemove, this, &EntryModel::databaseEntryAboutToRemove);
+    connect(db, &Database::entryDataChanged, this, &EntryModel::databaseEntryDataChanged);
+    if (db->isBulkUpdating()) {
+        ++m_bulkUpdates;
+    }
+}
+
+/**
+ * Stay connected to the databases that are still needed instead of
+ * reconnecting on every change of the displayed entries.
+ */
+void EntryModel::setDatabases(const QSet<Database*>& databases)
+{
+    for (auto it = m_databases.begin(); it != m_databases.end();) {
+        if (!*it) {
+            it = m_databases.erase(it);
+        } else if (!databases.contains(it->data())) {
+            disconnect(it->data(), nullptr, this, nullptr);
+            if ((*it)->isBulkUpdating() && m_bulkUpdates > 0) {
+                --m_bulkUpdates;
+            }
+            it = m_databases.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (Database* db : databases) {
+        makeConnections(db);
+    }
+}
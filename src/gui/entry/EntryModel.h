@@ -19,10 +19,14 @@
 #define KEEPASSX_ENTRYMODEL_H
 
 #include <QAbstractTableModel>
+#include <QHash>
 #include <QPixmap>
+#include <QPointer>
+#include <QSet>
 
 #include "core/Config.h"
 
+class Database;
 class Entry;
 class Group;
 
@@ -76,17 +80,61 @@ private slots:
     void entryAboutToMoveDown(int row);
     void entryMovedDown();
     void entryDataChanged(Entry* entry);
+    void databaseEntryAdded(Entry* entry);
+    void databaseEntryAboutToRemove(Entry* entry);
+    void databaseEntryDataChanged(Entry* entry);
+    void bulkUpdateStarted();
+    void bulkUpdateFinished();
+    void databaseAboutToBeReleased();
 
     void onConfigChanged(Config::ConfigKey key);
 
 private:
+    // Display values of an entry, valid while its revision is unchanged and,
+    // if it has references, while its database is not modified
+    struct DisplayRecord
+    {
+        quint64 revision;
+        bool hasReferences;
+        quint64 modificationCount;
+        QString title;
+        QString username;
+        QString password;
+        QString url;
+        QString notes;
+        QString expires;
+        QString created;
+        QString modified;
+        QString accessed;
+        QString attachments;
+        QString size;
+    };
+
+    const DisplayRecord& displayRecord(Entry* entry) const;
+    void loadConfig();
+    void updateEntries(const QList<Entry*>& entries);
     void severConnections();
     void makeConnections(const Group* group);
+    void makeConnections(Database* db);
+    void setDatabases(const QSet<Database*>& databases);
+    void beginBulkReset();
+    void endBulkReset();
 
     Group* m_group;
     QList<Entry*> m_entries;
     QList<Entry*> m_orgEntries;
-    QList<const Group*> m_allGroups;
+    QList<QPointer<Database>> m_databases;
+    // changes during bulk updates are reported once the update is finished
+    int m_bulkUpdates = 0;
+    bool m_resetPending = false;
+    bool m_dataChangePending = false;
+    mutable QHash<const Entry*, DisplayRecord> m_displayRecords;
+
+    // config()->get() is too slow to call for every cell
+    bool m_hideUsernames;
+    bool m_hidePasswords;
+    bool m_hideNotes;
+    bool m_emptyPlaceholder;
 
     const QString HiddenContentDisplay;
     const Qt::DateFormat DateFormat;
@@ -27,6 +27,12 @@
 #include "core/Tools.h"
 #include "keeshare/KeeShare.h"
 
+namespace
+{
+    // Number of children of a group that are shown before the view has to fetch more
+    constexpr int FetchBatchSize = 500;
+} // namespace
+
 GroupModel::GroupModel(Database* db, QObject* parent)
     : QAbstractItemModel(parent)
     , m_db(nullptr)
@@ -38,7 +44,12 @@ void GroupModel::changeDatabase(Database* newDb)
 {
     beginResetModel();
 
+    if (m_db) {
+        disconnect(m_db.data(), nullptr, this, nullptr);
+    }
     m_db = newDb;
+    m_rows.clear();
+    m_fetchLimits.clear();
 
     // clang-format off
     connect(m_db, SIGNAL(groupDataChanged(Group*)), SLOT(groupDataChanged(Group*)));
@@ -48,6 +59,9 @@ void GroupModel::changeDatabase(Database* newDb)
     connect(m_db, SIGNAL(groupRemoved()), SLOT(groupRemoved()));
     connect(m_db, SIGNAL(groupAboutToMove(Group*,Group*,int)), SLOT(groupAboutToMove(Group*,Group*,int)));
     connect(m_db, SIGNAL(groupMoved()), SLOT(groupMoved()));
+    connect(m_db, SIGNAL(bulkUpdateFinished()), SLOT(bulkUpdateFinished()));
+    connect(m_db, SIGNAL(dataAboutToBeReleased()), SLOT(databaseAboutToBeReleased()));
+    connect(m_db, SIGNAL(dataReleased()), SLOT(databaseReleased()));
     // clang-format on
 
     endResetModel();
@@ -59,8 +73,7 @@ int GroupModel::rowCount(const QModelIndex& parent) const
         // we have exactly 1 root item
         return 1;
     } else {
-        const Group* group = groupFromIndex(parent);
-        return group->children().size();
+        return fetchedRows(groupFromIndex(parent));
     }
 }
 
@@ -105,14 +118,33 @@ QModelIndex GroupModel::parent(Group* group) const
         // index is already the root group
         return QModelIndex();
     } else {
-        const Group* grandParentGroup = parentGroup->parentGroup();
-        if (!grandParentGroup) {
-            // parent is the root group
-            return createIndex(0, 0, parentGroup);
-        } else {
-            return createIndex(grandParentGroup->children().indexOf(parentGroup), 0, parentGroup);
-        }
+        return createIndex(groupRow(parentGroup), 0, parentGroup);
+    }
+}
+
+bool GroupModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (!parent.isValid()) {
+        return false;
+    }
+
+    const Group* group = groupFromIndex(parent);
+    return fetchedRows(group) < group->children().size();
+}
+
+void GroupModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
     }
+
+    const Group* group = groupFromIndex(parent);
+    int fetched = fetchedRows(group);
+    int limit = qMin(group->children().size(), fetched + FetchBatchSize);
+
+    beginInsertRows(parent, fetched, limit - 1);
+    m_fetchLimits.insert(group, limit);
+    endInsertRows();
 }
 
 QVariant GroupModel::data(const QModelIndex& index, int role) const
@@ -158,17 +190,114 @@ QVariant GroupModel::headerData(int section, Qt::Orientation orientation, int ro
     return QVariant();
 }
 
+/**
+ * Return the index of the group, or an invalid index while the group
+ * has not been fetched yet, see fetchGroup().
+ */
 QModelIndex GroupModel::index(Group* group) const
 {
-    int row;
+    if (!isFetched(group)) {
+        return QModelIndex();
+    }
 
-    if (!group->parentGroup()) {
-        row = 0;
-    } else {
-        row = group->parentGroup()->children().indexOf(group);
+    return createIndex(groupRow(group), 0, group);
+}
+
+/**
+ * Make sure the group and all of its parents are fetched, so index()
+ * returns a valid index for it.
+ */
+void GroupModel::fetchGroup(Group* group)
+{
+    Group* parentGroup = group->parentGroup();
+    if (!parentGroup) {
+        return;
+    }
+
+    fetchGroup(parentGroup);
+
+    int row = groupRow(group);
+    int fetched = fetchedRows(parentGroup);
+    if (row >= fetched) {
+        beginInsertRows(index(parentGroup), fetched, row);
+        m_fetchLimits.insert(parentGroup, row + 1);
+        endInsertRows();
+    }
+}
+
+/**
+ * Return the row of the group below its parent. Rows are cached for all
+ * children of a parent at once, so views asking for the parents of many
+ * siblings don't search the list of children over and over.
+ */
+int GroupModel::groupRow(const Group* group) const
+{
+    const Group* parentGroup = group->parentGroup();
+    if (!parentGroup) {
+        return 0;
+    }
+
+    const QList<Group*>& children = parentGroup->children();
+    auto cached = m_rows.constFind(group);
+    if (cached != m_rows.constEnd() && children.value(cached.value()) == group) {
+        return cached.value();
+    }
+
+    for (int i = 0; i < children.size(); ++i) {
+        m_rows.insert(children.at(i), i);
+    }
+    return m_rows.value(group, -1);
+}
+
+int GroupModel::fetchedRows(const Group* group) const
+{
+    return qMin(group->children().size(), m_fetchLimits.value(group, FetchBatchSize));
+}
+
+bool GroupModel::isFetched(const Group* group) const
+{
+    const Group* parentGroup = group->parentGroup();
+    if (!parentGroup) {
+        return true;
+    }
+    return groupRow(group) < fetchedRows(parentGroup) && isFetched(parentGroup);
+}
+
+/**
+ * Account for a child inserted at the given row of a group that currently
+ * has the given number of children. Returns whether the view sees the new
+ * row; rows past the fetched ones only show up with the next fetch.
+ */
+bool GroupModel::fetchInsertedRow(const Group* group, int childCount, int row)
+{
+    int limit = m_fetchLimits.value(group, FetchBatchSize);
+    if (!isFetched(group) || row >= limit) {
+        return false;
+    }
+
+    if (childCount >= limit) {
+        // keep the last fetched row from sliding out of the view
+        m_fetchLimits.insert(group, limit + 1);
+    }
+    return true;
+}
+
+/**
+ * Account for a child removed from the given row of a group that currently
+ * has the given number of children. Returns whether the view saw the row.
+ */
+bool GroupModel::fetchRemovedRow(const Group* group, int childCount, int row)
+{
+    int limit = m_fetchLimits.value(group, FetchBatchSize);
+    if (!isFetched(group) || row >= limit) {
+        return false;
     }
 
-    return createIndex(row, 0, group);
+    if (childCount > limit) {
+        // keep the first unfetched row from sliding into the view
+        m_fetchLimits.insert(group, limit - 1);
+    }
+    return true;
 }
 
 Group* GroupModel::groupFromIndex(const QModelIndex& index) const
@@ -300,7 +429,7 @@ bool GroupModel::dropMimeData(const QMimeData* data,
             if (sourceDb != targetDb) {
                 QUuid customIcon = entry->iconUuid();
                 if (!customIcon.isNull() && !targetDb->metadata()->hasCustomIcon(customIcon)) {
-                    targetDb->metadata()->addCustomIcon(customIcon, sourceDb->metadata()->customIcon(customIcon));
+                    targetDb->metadata()->addCustomIcon(customIcon, sourceDb->metadata()->customIconData(customIcon));
                 }
 
                 // Always clone the entry across db's to reset the UUID
@@ -364,62 +493,151 @@ QMimeData* GroupModel::mimeData(const QModelIndexList& indexes) const
 
 void GroupModel::groupDataChanged(Group* group)
 {
+    // reported for all groups at the end of a bulk update
+    if (m_db->isBulkUpdating()) {
+        m_dataChangePending = true;
+        return;
+    }
+
     QModelIndex ix = index(group);
-    emit dataChanged(ix, ix);
+    if (ix.isValid()) {
+        emit dataChanged(ix, ix);
+    }
 }
 
 void GroupModel::groupAboutToRemove(Group* group)
 {
-    Q_ASSERT(group->parentGroup());
+    Group* parentGroup = group->parentGroup();
+    Q_ASSERT(parentGroup);
 
-    QModelIndex parentIndex = parent(group);
-    Q_ASSERT(parentIndex.isValid());
-    int pos = group->parentGroup()->children().indexOf(group);
+    int pos = groupRow(group);
     Q_ASSERT(pos != -1);
 
-    beginRemoveRows(parentIndex, pos, pos);
+    // the group may be deleted after this, so don't keep anything about it
+    const QList<Group*> groups = group->groupsRecursive(true);
+    for (const Group* removed : groups) {
+        m_fetchLimits.remove(removed);
+    }
+
+    m_pendingChange = PendingChange::None;
+    if (fetchRemovedRow(parentGroup, parentGroup->children().size(), pos)) {
+        m_pendingChange = PendingChange::Remove;
+        beginRemoveRows(index(parentGroup), pos, pos);
+    }
 }
 
 void GroupModel::groupRemoved()
 {
-    endRemoveRows();
+    m_rows.clear();
+    if (m_pendingChange == PendingChange::Remove) {
+        endRemoveRows();
+    }
 }
 
 void GroupModel::groupAboutToAdd(Group* group, int index)
 {
-    Q_ASSERT(group->parentGroup());
-
-    QModelIndex parentIndex = parent(group);
+    Group* parentGroup = group->parentGroup();
+    Q_ASSERT(parentGroup);
 
-    beginInsertRows(parentIndex, index, index);
+    m_pendingChange = PendingChange::None;
+    if (fetchInsertedRow(parentGroup, parentGroup->children().size(), index)) {
+        m_pendingChange = PendingChange::Insert;
+        beginInsertRows(this->index(parentGroup), index, index);
+    }
 }
 
 void GroupModel::groupAdded()
 {
-    endInsertRows();
+    m_rows.clear();
+    if (m_pendingChange == PendingChange::Insert) {
+        endInsertRows();
+    }
 }
 
+/**
+ * A move is shown as a move, a removal or an insertion, depending on which
+ * of its ends the view has fetched.
+ */
 void GroupModel::groupAboutToMove(Group* group, Group* toGroup, int pos)
 {
-    Q_ASSERT(group->parentGroup());
+    Group* fromGroup = group->parentGroup();
+    Q_ASSERT(fromGroup);
 
-    QModelIndex oldParentIndex = parent(group);
+    // evaluate both ends before any fetch limit changes
+    QModelIndex oldParentIndex = index(fromGroup);
     QModelIndex newParentIndex = index(toGroup);
-    int oldPos = group->parentGroup()->children().indexOf(group);
-    if (group->parentGroup() == toGroup && pos > oldPos) {
-        // beginMoveRows() has a bit different semantics than Group::setParent() and
-        // QList::move() when the new position is greater than the old
-        pos++;
-    }
+    int oldPos = groupRow(group);
+
+    int fromCount = fromGroup->children().size();
+    bool removed = fetchRemovedRow(fromGroup, fromCount, oldPos);
+    int toCount = toGroup == fromGroup ? fromCount - 1 : toGroup->children().size();
+    bool inserted = fetchInsertedRow(toGroup, toCount, pos);
+
+    m_pendingChange = PendingChange::None;
+    if (removed && inserted) {
+        if (fromGroup == toGroup && pos > oldPos) {
+            // beginMoveRows() has a bit different semantics than Group::setParent() and
+            // QList::move() when the new position is greater than the old
+            pos++;
+        }
 
-    bool moveResult = beginMoveRows(oldParentIndex, oldPos, oldPos, newParentIndex, pos);
-    Q_UNUSED(moveResult);
-    Q_ASSERT(moveResult);
+        m_pendingChange = PendingChange::Move;
+        bool moveResult = beginMoveRows(oldParentIndex, oldPos, oldPos, newParentIndex, pos);
+        Q_UNUSED(moveResult);
+        Q_ASSERT(moveResult);
+    } else if (removed) {
+        m_pendingChange = PendingChange::Remove;
+        beginRemoveRows(oldParentIndex, oldPos, oldPos);
+    } else if (inserted) {
+        m_pendingChange = PendingChange::Insert;
+        beginInsertRows(newParentIndex, pos, pos);
+    }
 }
 
 void GroupModel::groupMoved()
 {
-    endMoveRows();
+    m_rows.clear();
+    if (m_pendingChange == PendingChange::Move) {
+        endMoveRows();
+    } else if (m_pendingChange == PendingChange::Remove) {
+        endRemoveRows();
+    } else if (m_pendingChange == PendingChange::Insert) {
+        endInsertRows();
+    }
+}
+
+/**
+ * Group changes during a bulk update are reported at once. Groups are
+ * rarely added or removed in bulk, so only data changes are coalesced and
+ * the view keeps its expanded and current groups.
+ */
+void GroupModel::bulkUpdateFinished()
+{
+    if (!m_dataChangePending) {
+        return;
+    }
+    m_dataChangePending = false;
+
+    const QList<Group*> groups = m_db->rootGroup()->groupsRecursive(true);
+    for (Group* group : groups) {
+        QModelIndex ix = index(group);
+        if (ix.isValid()) {
+            emit dataChanged(ix, ix);
+        }
+    }
+}
+
+void GroupModel::databaseAboutToBeReleased()
+{
+    // the groups are deleted without signals, see Database::releaseData()
+    beginResetModel();
+}
+
+void GroupModel::databaseReleased()
+{
+    m_rows.clear();
+    m_fetchLimits.clear();
+    endResetModel();
 }
 
 void GroupModel::sortChildren(Group* rootGroup, bool reverse)
@@ -430,6 +648,7 @@ void GroupModel::sortChildren(Group* rootGroup, bool reverse)
     collectIndexesRecursively(oldIndexes, rootGroup->children());
 
     rootGroup->sortChildrenRecursively(reverse);
+    m_rows.clear();
 
     QList<QModelIndex> newIndexes;
     collectIndexesRecursively(newIndexes, rootGroup->children());
@@ -441,6 +660,10 @@ void GroupModel::sortChildren(Group* rootGroup, bool reverse)
     emit layoutChanged();
 }
 
+/**
+ * Collect the indexes of the groups and all of their children. Groups that
+ * have not been fetched get invalid indexes.
+ */
 void GroupModel::collectIndexesRecursively(QList<QModelIndex>& indexes, QList<Group*> groups)
 {
     for (auto group : groups) {
@@ -19,6 +19,8 @@
 #define KEEPASSX_GROUPMODEL_H
 
 #include <QAbstractItemModel>
+#include <QHash>
+#include <QPointer>
 
 class Database;
 class Group;
@@ -31,12 +33,15 @@ public:
     explicit GroupModel(Database* db, QObject* parent = nullptr);
     void changeDatabase(Database* newDb);
     QModelIndex index(Group* group) const;
+    void fetchGroup(Group* group);
     Group* groupFromIndex(const QModelIndex& index) const;
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
     QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
     QModelIndex parent(const QModelIndex& index) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     Qt::DropActions supportedDropActions() const override;
@@ -48,7 +53,20 @@ public:
     void sortChildren(Group* rootGroup, bool reverse = false);
 
 private:
+    enum class PendingChange
+    {
+        None,
+        Insert,
+        Remove,
+        Move
+    };
+
     QModelIndex parent(Group* group) const;
+    int groupRow(const Group* group) const;
+    int fetchedRows(const Group* group) const;
+    bool isFetched(const Group* group) const;
+    bool fetchInsertedRow(const Group* group, int childCount, int row);
+    bool fetchRemovedRow(const Group* group, int childCount, int row);
     void collectIndexesRecursively(QList<QModelIndex>& indexes, QList<Group*> groups);
 
 private slots:
@@ -59,9 +77,18 @@ private slots:
     void groupAdded();
     void groupAboutToMove(Group* group, Group* toGroup, int pos);
     void groupMoved();
+    void bulkUpdateFinished();
+    void databaseAboutToBeReleased();
+    void databaseReleased();
 
 private:
-    Database* m_db;
+    QPointer<Database> m_db;
+    bool m_dataChangePending = false;
+    PendingChange m_pendingChange = PendingChange::None;
+    // Rows of groups below their parents, filled on demand and dropped on every structural change
+    mutable QHash<const Group*, int> m_rows;
+    // Number of children fetched for groups that differ from FetchBatchSize
+    QHash<const Group*, int> m_fetchLimits;
 };
 
 #endif // KEEPASSX_GROUPMODEL_H
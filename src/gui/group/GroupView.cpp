@@ -115,22 +115,39 @@ void GroupView::expandedChanged(const QModelIndex& index)
 
     Group* group = m_model->groupFromIndex(index);
     group->setExpanded(isExpanded(index));
+
+    // children of collapsed groups are only restored once they become visible
+    if (group->isExpanded()) {
+        for (int row = 0; row < m_model->rowCount(index); ++row) {
+            recInitExpanded(m_model->index(row, 0, index));
+        }
+    }
 }
 
-void GroupView::recInitExpanded(Group* group)
+/**
+ * Restore the expanded state of the group at the index and of its visible
+ * descendants. Descendants of collapsed groups are skipped, which keeps this
+ * cheap on large trees; expandedChanged() picks them up when their parent
+ * gets expanded.
+ */
+void GroupView::recInitExpanded(const QModelIndex& index)
 {
+    Group* group = m_model->groupFromIndex(index);
+
     m_updatingExpanded = true;
-    expandGroup(group, group->isExpanded());
+    setExpanded(index, group->isExpanded());
     m_updatingExpanded = false;
 
-    const QList<Group*> children = group->children();
-    for (Group* child : children) {
-        recInitExpanded(child);
+    if (group->isExpanded()) {
+        for (int row = 0; row < m_model->rowCount(index); ++row) {
+            recInitExpanded(m_model->index(row, 0, index));
+        }
     }
 }
 
 void GroupView::expandGroup(Group* group, bool expand)
 {
+    m_model->fetchGroup(group);
     QModelIndex index = m_model->index(group);
     setExpanded(index, expand);
 }
@@ -152,8 +169,7 @@ void GroupView::setModel(QAbstractItemModel* model)
 void GroupView::syncExpandedState(const QModelIndex& parent, int start, int end)
 {
     for (int row = start; row <= end; row++) {
-        Group* group = m_model->groupFromIndex(m_model->index(row, 0, parent));
-        recInitExpanded(group);
+        recInitExpanded(m_model->index(row, 0, parent));
     }
 }
 
@@ -162,12 +178,13 @@ void GroupView::setCurrentGroup(Group* group)
     if (group == nullptr) {
         setCurrentIndex(QModelIndex());
     } else {
+        m_model->fetchGroup(group);
         setCurrentIndex(m_model->index(group));
     }
 }
 
 void GroupView::modelReset()
 {
-    recInitExpanded(m_model->groupFromIndex(m_model->index(0, 0)));
+    recInitExpanded(m_model->index(0, 0));
     setCurrentIndex(m_model->index(0, 0));
 }
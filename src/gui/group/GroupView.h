@@ -52,7 +52,7 @@ protected:
     void focusInEvent(QFocusEvent* event) override;
 
 private:
-    void recInitExpanded(Group* group);
+    void recInitExpanded(const QModelIndex& index);
 
     GroupModel* const m_model;
     bool m_updatingExpanded;
@@ -50,6 +50,12 @@ public:
      */
     virtual bool isCapslockEnabled() = 0;
 
+    /**
+     * @return milliseconds since the last keyboard or mouse input on the
+     *         system, -1 if the OS doesn't tell.
+     */
+    virtual qint64 systemIdleTime() = 0;
+
 protected:
     explicit OSUtilsBase(QObject* parent = nullptr);
     virtual ~OSUtilsBase();
@@ -124,6 +124,13 @@ bool MacUtils::isCapslockEnabled()
     return (CGEventSourceFlagsState(kCGEventSourceStateHIDSystemState) & kCGEventFlagMaskAlphaShift) != 0;
 }
 
+qint64 MacUtils::systemIdleTime()
+{
+    const double seconds =
+        CGEventSourceSecondsSinceLastEventType(kCGEventSourceStateHIDSystemState, kCGAnyInputEventType);
+    return static_cast<qint64>(seconds * 1000);
+}
+
 /**
  * Toggle application state between foreground app and UIElement app.
  * Foreground apps have dock icons, UIElement apps do not.
@@ -37,6 +37,7 @@ public:
     bool isLaunchAtStartupEnabled() const override;
     void setLaunchAtStartup(bool enable) override;
     bool isCapslockEnabled() override;
+    qint64 systemIdleTime() override;
 
     WId activeWindow();
     bool raiseWindow(WId pid);
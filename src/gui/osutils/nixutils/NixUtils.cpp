@@ -19,6 +19,8 @@
 
 #include <QApplication>
 #include <QColor>
+#include <QDBusConnection>
+#include <QDBusMessage>
 #include <QDir>
 #include <QFile>
 #include <QGuiApplication>
@@ -134,3 +136,47 @@ bool NixUtils::isCapslockEnabled()
 
     return false;
 }
+
+qint64 NixUtils::systemIdleTime()
+{
+    // Idle time services of GNOME and of KDE and other desktops implementing the freedesktop.org interface
+    static const struct
+    {
+        const char* service;
+        const char* path;
+        const char* interface;
+        const char* method;
+    } sources[] = {
+        {"org.gnome.Mutter.IdleMonitor", "/org/gnome/Mutter/IdleMonitor/Core", "org.gnome.Mutter.IdleMonitor",
+         "GetIdletime"},
+        {"org.freedesktop.ScreenSaver", "/org/freedesktop/ScreenSaver", "org.freedesktop.ScreenSaver",
+         "GetSessionIdleTime"},
+    };
+    // the first source that answered, the others are not asked again
+    static int workingSource = -1;
+
+    auto query = [](int index) -> qint64 {
+        const auto& source = sources[index];
+        auto message = QDBusMessage::createMethodCall(source.service, source.path, source.interface, source.method);
+        // called from the GUI thread, don't wait long for a hanging service
+        const auto reply = QDBusConnection::sessionBus().call(message, QDBus::Block, 500);
+        if (reply.type() != QDBusMessage::ReplyMessage || reply.arguments().isEmpty()) {
+            return -1;
+        }
+        bool ok = false;
+        const qint64 idle = reply.arguments().first().toLongLong(&ok);
+        return ok ? idle : -1;
+    };
+
+    if (workingSource >= 0) {
+        return query(workingSource);
+    }
+    for (int i = 0; i < static_cast<int>(sizeof(sources) / sizeof(sources[0])); ++i) {
+        const qint64 idle = query(i);
+        if (idle >= 0) {
+            workingSource = i;
+            return idle;
+        }
+    }
+    return -1;
+}
@@ -32,6 +32,7 @@ public:
     bool isLaunchAtStartupEnabled() const override;
     void setLaunchAtStartup(bool enable) override;
     bool isCapslockEnabled() override;
+    qint64 systemIdleTime() override;
 
 private:
     explicit NixUtils(QObject* parent = nullptr);
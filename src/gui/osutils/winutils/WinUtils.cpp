@@ -106,6 +106,17 @@ bool WinUtils::isCapslockEnabled()
     return GetKeyState(VK_CAPITAL) == 1;
 }
 
+qint64 WinUtils::systemIdleTime()
+{
+    LASTINPUTINFO info;
+    info.cbSize = sizeof(info);
+    if (!GetLastInputInfo(&info)) {
+        return -1;
+    }
+    // both are tick counts that wrap around after 49.7 days, the difference is still right
+    return static_cast<DWORD>(GetTickCount() - info.dwTime);
+}
+
 bool WinUtils::isHighContrastMode() const
 {
     QSettings settings(R"(HKEY_CURRENT_USER\Control Panel\Accessibility\HighContrast)", QSettings::NativeFormat);
@@ -36,6 +36,7 @@ public:
     bool isLaunchAtStartupEnabled() const override;
     void setLaunchAtStartup(bool enable) override;
     bool isCapslockEnabled() override;
+    qint64 systemIdleTime() override;
     bool isHighContrastMode() const;
 
 protected:
@@ -18,9 +18,11 @@
 #include "ReportsDialog.h"
 #include "ui_ReportsDialog.h"
 
+#include "ReportsPageDuplicates.h"
 #include "ReportsPageHealthcheck.h"
 #include "ReportsPageHibp.h"
 #include "ReportsPageStatistics.h"
+#include "ReportsWidgetDuplicates.h"
 #include "ReportsWidgetHealthcheck.h"
 #include "ReportsWidgetHibp.h"
 
@@ -57,6 +59,7 @@ ReportsDialog::ReportsDialog(QWidget* parent)
     , m_healthPage(new ReportsPageHealthcheck())
     , m_hibpPage(new ReportsPageHibp())
     , m_statPage(new ReportsPageStatistics())
+    , m_duplicatesPage(new ReportsPageDuplicates())
     , m_editEntryWidget(new EditEntryWidget(this))
 {
     m_ui->setupUi(this);
@@ -65,6 +68,7 @@ ReportsDialog::ReportsDialog(QWidget* parent)
     addPage(m_healthPage);
     addPage(m_hibpPage);
     addPage(m_statPage);
+    addPage(m_duplicatesPage);
 
     m_ui->stackedWidget->setCurrentIndex(0);
 
@@ -76,6 +80,9 @@ ReportsDialog::ReportsDialog(QWidget* parent)
     connect(m_ui->categoryList, SIGNAL(categoryChanged(int)), m_ui->stackedWidget, SLOT(setCurrentIndex(int)));
     connect(m_healthPage->m_healthWidget, SIGNAL(entryActivated(Entry*)), SLOT(entryActivationSignalReceived(Entry*)));
     connect(m_hibpPage->m_hibpWidget, SIGNAL(entryActivated(Entry*)), SLOT(entryActivationSignalReceived(Entry*)));
+    connect(m_duplicatesPage->m_duplicatesWidget,
+            SIGNAL(entryActivated(Entry*)),
+            SLOT(entryActivationSignalReceived(Entry*)));
     connect(m_editEntryWidget, SIGNAL(editFinished(bool)), SLOT(switchToMainView(bool)));
 }
 
@@ -140,6 +147,8 @@ void ReportsDialog::switchToMainView(bool previousDialogAccepted)
             m_healthPage->m_healthWidget->calculateHealth();
         } else if (m_sender == m_hibpPage->m_hibpWidget) {
             m_hibpPage->m_hibpWidget->refreshAfterEdit();
+        } else if (m_sender == m_duplicatesPage->m_duplicatesWidget) {
+            m_duplicatesPage->m_duplicatesWidget->findDuplicates();
         }
     }
 
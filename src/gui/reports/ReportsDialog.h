@@ -30,6 +30,7 @@ class Database;
 class Entry;
 class Group;
 class QTabWidget;
+class ReportsPageDuplicates;
 class ReportsPageHealthcheck;
 class ReportsPageHibp;
 class ReportsPageStatistics;
@@ -78,6 +79,7 @@ private:
     const QSharedPointer<ReportsPageHealthcheck> m_healthPage;
     const QSharedPointer<ReportsPageHibp> m_hibpPage;
     const QSharedPointer<ReportsPageStatistics> m_statPage;
+    const QSharedPointer<ReportsPageDuplicates> m_duplicatesPage;
     QPointer<EditEntryWidget> m_editEntryWidget;
     QWidget* m_sender = nullptr;
 
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReportsPageDuplicates.h"
+
+#include "ReportsWidgetDuplicates.h"
+#include "gui/Icons.h"
+
+#include <QApplication>
+
+ReportsPageDuplicates::ReportsPageDuplicates()
+    : m_duplicatesWidget(new ReportsWidgetDuplicates())
+{
+}
+
+QString ReportsPageDuplicates::name()
+{
+    return QApplication::tr("Duplicates");
+}
+
+QIcon ReportsPageDuplicates::icon()
+{
+    return icons()->icon("entry-clone");
+}
+
+QWidget* ReportsPageDuplicates::createWidget()
+{
+    return m_duplicatesWidget;
+}
+
+void ReportsPageDuplicates::loadSettings(QWidget* widget, QSharedPointer<Database> db)
+{
+    const auto settingsWidget = reinterpret_cast<ReportsWidgetDuplicates*>(widget);
+    settingsWidget->loadSettings(db);
+}
+
+void ReportsPageDuplicates::saveSettings(QWidget* widget)
+{
+    const auto settingsWidget = reinterpret_cast<ReportsWidgetDuplicates*>(widget);
+    settingsWidget->saveSettings();
+}
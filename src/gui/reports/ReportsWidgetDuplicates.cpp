@@ -0,0 +1,269 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReportsWidgetDuplicates.h"
+#include "ui_ReportsWidgetDuplicates.h"
+
+#include "core/Database.h"
+#include "core/DuplicateDetector.h"
+#include "core/Global.h"
+#include "core/Group.h"
+#include "gui/Icons.h"
+#include "gui/MessageBox.h"
+
+#include <QMenu>
+#include <QStandardItemModel>
+#include <QTimer>
+
+namespace
+{
+    // Index of the group of duplicates in the first column of every row
+    const int GroupRole = Qt::UserRole;
+    // Index of the entry in its group in the first column of entry rows
+    const int EntryRole = Qt::UserRole + 1;
+} // namespace
+
+ReportsWidgetDuplicates::ReportsWidgetDuplicates(QWidget* parent)
+    : QWidget(parent)
+    , m_ui(new Ui::ReportsWidgetDuplicates())
+    , m_model(new QStandardItemModel(this))
+{
+    m_ui->setupUi(this);
+
+    m_ui->duplicatesTreeView->setModel(m_model.data());
+    m_ui->duplicatesTreeView->setSelectionMode(QAbstractItemView::NoSelection);
+
+    connect(m_ui->duplicatesTreeView, SIGNAL(customContextMenuRequested(QPoint)), SLOT(customMenuRequested(QPoint)));
+    connect(m_ui->duplicatesTreeView, SIGNAL(doubleClicked(QModelIndex)), SLOT(emitEntryActivated(QModelIndex)));
+    connect(m_ui->mergeAllButton, SIGNAL(clicked()), SLOT(mergeAll()));
+    connect(m_ui->removeAllButton, SIGNAL(clicked()), SLOT(removeAll()));
+}
+
+ReportsWidgetDuplicates::~ReportsWidgetDuplicates()
+{
+}
+
+void ReportsWidgetDuplicates::loadSettings(QSharedPointer<Database> db)
+{
+    m_db = std::move(db);
+    m_duplicatesFound = false;
+    m_model->clear();
+    m_duplicates.clear();
+
+    auto row = QList<QStandardItem*>();
+    row << new QStandardItem(tr("Please wait, duplicates are being searched..."));
+    m_model->appendRow(row);
+}
+
+void ReportsWidgetDuplicates::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+
+    if (!m_duplicatesFound) {
+        // Search on next event loop to allow widget to appear
+        m_duplicatesFound = true;
+        QTimer::singleShot(0, this, SLOT(findDuplicates()));
+    }
+}
+
+void ReportsWidgetDuplicates::findDuplicates()
+{
+    m_model->clear();
+    m_duplicates.clear();
+
+    const auto duplicates = DuplicateDetector::findDuplicates(m_db->rootGroup());
+    const bool editable = !duplicates.isEmpty() && !m_db->isReadOnly();
+    m_ui->mergeAllButton->setEnabled(editable);
+    m_ui->removeAllButton->setEnabled(editable);
+    if (duplicates.isEmpty()) {
+        m_model->setHorizontalHeaderLabels(QStringList() << tr("Congratulations, no duplicate entries found!"));
+        return;
+    }
+
+    m_model->setHorizontalHeaderLabels(QStringList()
+                                       << tr("Title") << tr("Username") << tr("Path") << tr("Last Modified"));
+    for (int i = 0; i < duplicates.size(); ++i) {
+        const auto& group = duplicates.at(i);
+        const Entry* kept = DuplicateDetector::keptEntry(group);
+
+        auto row = QList<QStandardItem*>();
+        row << new QStandardItem(kept->iconPixmap(), kept->title());
+        row << new QStandardItem(kept->username());
+        row << new QStandardItem(tr("%n entries", "", group.size()));
+        row << new QStandardItem();
+        row[0]->setData(i, GroupRole);
+
+        QList<QPointer<Entry>> entries;
+        for (int j = 0; j < group.size(); ++j) {
+            Entry* entry = group.at(j);
+            entries.append(entry);
+
+            auto title = entry->title();
+            if (entry == kept) {
+                title.append(tr(" (Kept)"));
+            }
+            auto entryRow = QList<QStandardItem*>();
+            entryRow << new QStandardItem(entry->iconPixmap(), title);
+            entryRow << new QStandardItem(entry->username());
+            entryRow << new QStandardItem(entry->group()->iconPixmap(), entry->group()->hierarchy().join("/"));
+            entryRow << new QStandardItem(entry->timeInfo().lastModificationTime().toLocalTime().toString(
+                Qt::DefaultLocaleShortDate));
+            entryRow[0]->setData(i, GroupRole);
+            entryRow[0]->setData(j, EntryRole);
+            row[0]->appendRow(entryRow);
+        }
+        m_duplicates.append(entries);
+        m_model->appendRow(row);
+    }
+
+    m_ui->duplicatesTreeView->expandAll();
+    for (int i = 0; i < m_model->columnCount(); ++i) {
+        m_ui->duplicatesTreeView->resizeColumnToContents(i);
+    }
+}
+
+void ReportsWidgetDuplicates::emitEntryActivated(const QModelIndex& index)
+{
+    if (!index.isValid()) {
+        return;
+    }
+
+    const auto first = index.sibling(index.row(), 0);
+    const auto entryIndex = first.data(EntryRole);
+    if (!entryIndex.isValid()) {
+        return;
+    }
+    Entry* entry = m_duplicates.value(first.data(GroupRole).toInt()).value(entryIndex.toInt());
+    if (entry) {
+        emit entryActivated(entry);
+    }
+}
+
+void ReportsWidgetDuplicates::customMenuRequested(QPoint pos)
+{
+    const auto index = m_ui->duplicatesTreeView->indexAt(pos);
+    const auto duplicates = duplicatesAt(index);
+    if (duplicates.isEmpty()) {
+        return;
+    }
+
+    const auto menu = new QMenu(this);
+
+    const auto first = index.sibling(index.row(), 0);
+    if (first.data(EntryRole).isValid()) {
+        QPointer<Entry> entry = m_duplicates.value(first.data(GroupRole).toInt()).value(first.data(EntryRole).toInt());
+        const auto edit = new QAction(icons()->icon("entry-edit"), tr("Edit Entry..."), this);
+        menu->addAction(edit);
+        connect(edit, &QAction::triggered, this, [this, entry] {
+            if (entry) {
+                emit entryActivated(entry);
+            }
+        });
+        menu->addSeparator();
+    }
+
+    const auto merge = new QAction(icons()->icon("database-merge"), tr("Merge Duplicates"), this);
+    merge->setEnabled(!m_db->isReadOnly());
+    menu->addAction(merge);
+    connect(merge, &QAction::triggered, this, [this, duplicates] { this->merge(duplicates); });
+
+    const auto remove = new QAction(icons()->icon("entry-delete"), tr("Remove Duplicates"), this);
+    remove->setEnabled(!m_db->isReadOnly());
+    menu->addAction(remove);
+    connect(remove, &QAction::triggered, this, [this, duplicates] { this->remove(duplicates); });
+
+    menu->popup(m_ui->duplicatesTreeView->viewport()->mapToGlobal(pos));
+}
+
+void ReportsWidgetDuplicates::mergeAll()
+{
+    merge(duplicatesAt({}));
+}
+
+void ReportsWidgetDuplicates::removeAll()
+{
+    remove(duplicatesAt({}));
+}
+
+/**
+ * @return group of duplicates of the row at index, or all of them for an invalid index,
+ *         without the entries that were deleted meanwhile
+ */
+QList<QList<Entry*>> ReportsWidgetDuplicates::duplicatesAt(const QModelIndex& index) const
+{
+    QList<QList<QPointer<Entry>>> groups;
+    if (!index.isValid()) {
+        groups = m_duplicates;
+    } else {
+        const auto groupIndex = index.sibling(index.row(), 0).data(GroupRole);
+        if (!groupIndex.isValid()) {
+            return {};
+        }
+        groups.append(m_duplicates.value(groupIndex.toInt()));
+    }
+
+    QList<QList<Entry*>> duplicates;
+    for (const auto& group : asConst(groups)) {
+        QList<Entry*> entries;
+        for (Entry* entry : group) {
+            if (entry) {
+                entries.append(entry);
+            }
+        }
+        if (entries.size() > 1) {
+            duplicates.append(entries);
+        }
+    }
+    return duplicates;
+}
+
+bool ReportsWidgetDuplicates::confirm(const QString& title, const QString& text)
+{
+    return MessageBox::question(this, title, text, MessageBox::Yes | MessageBox::Cancel, MessageBox::Cancel)
+           == MessageBox::Yes;
+}
+
+void ReportsWidgetDuplicates::merge(const QList<QList<Entry*>>& duplicates)
+{
+    if (duplicates.isEmpty()
+        || !confirm(tr("Merge duplicates"),
+                    tr("The kept entries take the custom attributes, attachments, tags and notes of their "
+                       "duplicates, which are moved to the recycle bin. Do you want to continue?"))) {
+        return;
+    }
+
+    DuplicateDetector::mergeDuplicates(m_db.data(), duplicates);
+    findDuplicates();
+}
+
+void ReportsWidgetDuplicates::remove(const QList<QList<Entry*>>& duplicates)
+{
+    if (duplicates.isEmpty()
+        || !confirm(tr("Remove duplicates"),
+                    tr("All duplicates except the kept entries are moved to the recycle bin. "
+                       "Do you want to continue?"))) {
+        return;
+    }
+
+    DuplicateDetector::removeDuplicates(m_db.data(), duplicates);
+    findDuplicates();
+}
+
+void ReportsWidgetDuplicates::saveSettings()
+{
+    // nothing to do - the tab is passive
+}
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_REPORTSWIDGETDUPLICATES_H
+#define KEEPASSXC_REPORTSWIDGETDUPLICATES_H
+
+#include <QList>
+#include <QModelIndex>
+#include <QPointer>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QWidget>
+
+class Database;
+class Entry;
+class QStandardItemModel;
+
+namespace Ui
+{
+    class ReportsWidgetDuplicates;
+}
+
+class ReportsWidgetDuplicates : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ReportsWidgetDuplicates(QWidget* parent = nullptr);
+    ~ReportsWidgetDuplicates();
+
+    void loadSettings(QSharedPointer<Database> db);
+    void saveSettings();
+
+protected:
+    void showEvent(QShowEvent* event) override;
+
+signals:
+    void entryActivated(Entry*);
+
+public slots:
+    void findDuplicates();
+    void emitEntryActivated(const QModelIndex& index);
+    void customMenuRequested(QPoint);
+    void mergeAll();
+    void removeAll();
+
+private:
+    QList<QList<Entry*>> duplicatesAt(const QModelIndex& index) const;
+    bool confirm(const QString& title, const QString& text);
+    void merge(const QList<QList<Entry*>>& duplicates);
+    void remove(const QList<QList<Entry*>>& duplicates);
+
+    QScopedPointer<Ui::ReportsWidgetDuplicates> m_ui;
+
+    bool m_duplicatesFound = false;
+    QScopedPointer<QStandardItemModel> m_model;
+    QSharedPointer<Database> m_db;
+    // groups of duplicates, indexed by the rows of the model
+    QList<QList<QPointer<Entry>>> m_duplicates;
+};
+
+#endif // KEEPASSXC_REPORTSWIDGETDUPLICATES_H
@@ -26,6 +26,7 @@
 #include "gui/Icons.h"
 #include "gui/styles/StateColorPalette.h"
 
+#include <QFutureWatcher>
 #include <QMenu>
 #include <QSharedPointer>
 #include <QSortFilterProxyModel>
@@ -38,43 +39,41 @@ namespace
     public:
         struct Item
         {
-            QPointer<const Group> group;
-            QPointer<const Entry> entry;
             QSharedPointer<PasswordHealth> health;
             bool knownBad = false;
 
-            Item(const Group* g, const Entry* e, QSharedPointer<PasswordHealth> h)
-                : group(g)
-                , entry(e)
-                , health(h)
+            Item(const Entry* e, QSharedPointer<PasswordHealth> h)
+                : health(h)
                 , knownBad(e->customData()->contains(PasswordHealth::OPTION_KNOWN_BAD)
                            && e->customData()->value(PasswordHealth::OPTION_KNOWN_BAD) == TRUE_STR)
             {
             }
-
-            bool operator<(const Item& rhs) const
-            {
-                return health->score() < rhs.health->score();
-            }
         };
 
         explicit Health(QSharedPointer<Database>);
 
-        const QList<QSharedPointer<Item>>& items() const
+        // Entries of a snapshot of the database to evaluate, the evaluation itself may run on any thread
+        const QList<const Entry*>& candidates() const
+        {
+            return m_candidates;
+        }
+
+        // Live entry of the candidate with the given index, null once it is deleted
+        const Entry* entry(int index) const
         {
-            return m_items;
+            return m_entries.at(index);
         }
 
-        bool anyKnownBad() const
+        QSharedPointer<Item> evaluate(const Entry* candidate) const
         {
-            return m_anyKnownBad;
+            return QSharedPointer<Item>(new Item(candidate, m_checker.evaluate(candidate)));
         }
 
     private:
-        QSharedPointer<Database> m_db;
+        QSharedPointer<const Database> m_snapshot;
         HealthChecker m_checker;
-        QList<QSharedPointer<Item>> m_items;
-        bool m_anyKnownBad = false;
+        QList<const Entry*> m_candidates;
+        QList<QPointer<const Entry>> m_entries;
     };
 
     class ReportSortProxyModel : public QSortFilterProxyModel
@@ -100,10 +99,16 @@ namespace
 } // namespace
 
 Health::Health(QSharedPointer<Database> db)
-    : m_db(db)
+    : m_snapshot(db->readSnapshot())
     , m_checker(db)
 {
-    for (const auto* group : db->rootGroup()->groupsRecursive(true)) {
+    QHash<QUuid, const Entry*> entries;
+    db->rootGroup()->forEachEntryRecursive([&entries](const Entry* entry) -> bool {
+        entries.insert(entry->uuid(), entry);
+        return true;
+    });
+
+    for (const auto* group : m_snapshot->rootGroup()->groupsRecursive(true)) {
         // Skip recycle bin
         if (group->isRecycled()) {
             continue;
@@ -119,22 +124,10 @@ Health::Health(QSharedPointer<Database> db)
                 continue;
             }
 
-            // Evaluate this entry
-            const auto item = QSharedPointer<Item>(new Item(group, entry, m_checker.evaluate(entry)));
-            if (item->knownBad) {
-                m_anyKnownBad = true;
-            }
-
-            // Add entry if its password isn't at least "good"
-            if (item->health->quality() < PasswordHealth::Quality::Good) {
-                m_items.append(item);
-            }
+            m_candidates.append(entry);
+            m_entries.append(entries.value(entry->uuid()));
         }
     }
-
-    // Sort the result so that the worst passwords (least score)
-    // are at the top
-    std::sort(m_items.begin(), m_items.end(), [](QSharedPointer<Item> x, QSharedPointer<Item> y) { return *x < *y; });
 }
 
 ReportsWidgetHealthcheck::ReportsWidgetHealthcheck(QWidget* parent)
@@ -252,44 +245,68 @@ void ReportsWidgetHealthcheck::showEvent(QShowEvent* event)
 
 void ReportsWidgetHealthcheck::calculateHealth()
 {
+    // A new check replaces the one still running
+    if (m_healthWatcher) {
+        m_healthWatcher->disconnect(this);
+        m_healthWatcher->cancel();
+        m_healthWatcher->deleteLater();
+    }
+
     m_referencesModel->clear();
+    m_rowToEntry.clear();
+    m_referencesModel->setHorizontalHeaderLabels(QStringList() << tr("") << tr("Title") << tr("Path") << tr("Score")
+                                                               << tr("Reason"));
 
-    // Perform the health check
-    const QScopedPointer<Health> health(AsyncTask::runAndWaitForFuture([this] { return new Health(m_db); }));
+    // Show the "show known bad entries" checkbox only if there's any
+    // known bad entry in the database.
+    m_ui->showKnownBadCheckBox->hide();
 
     // Display entries that are marked as "known bad"?
     const auto showKnownBad = m_ui->showKnownBadCheckBox->isChecked();
 
-    // Display the entries
-    m_rowToEntry.clear();
-    for (const auto& item : health->items()) {
-        if (item->knownBad && !showKnownBad) {
-            // Exclude this entry from the report
-            continue;
-        }
-
-        // Show the entry in the report
-        addHealthRow(item->health, item->group, item->entry, item->knownBad);
-    }
-
-    // Set the table header
-    if (m_referencesModel->rowCount() == 0) {
-        m_referencesModel->setHorizontalHeaderLabels(QStringList() << tr("Congratulations, everything is healthy!"));
-    } else {
-        m_referencesModel->setHorizontalHeaderLabels(QStringList() << tr("") << tr("Title") << tr("Path") << tr("Score")
-                                                                   << tr("Reason"));
-        m_ui->healthcheckTableView->sortByColumn(0, Qt::AscendingOrder);
-    }
+    // Evaluate the entries on the thread pool and add the rows as their results arrive
+    auto health = QSharedPointer<Health>::create(m_db);
+    std::function<QSharedPointer<Health::Item>(const Entry*)> evaluate = [health](const Entry* candidate) {
+        return health->evaluate(candidate);
+    };
 
-    m_ui->healthcheckTableView->resizeRowsToContents();
+    auto watcher = new QFutureWatcher<QSharedPointer<Health::Item>>(this);
+    m_healthWatcher = watcher;
+    connect(watcher,
+            &QFutureWatcherBase::resultsReadyAt,
+            this,
+            [this, watcher, health, showKnownBad](int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    const auto item = watcher->resultAt(i);
+                    // Entries deleted since the snapshot are left out
+                    const auto* entry = health->entry(i);
+                    if (!entry || !entry->group()) {
+                        continue;
+                    }
+                    if (item->knownBad) {
+                        m_ui->showKnownBadCheckBox->show();
+                    }
+
+                    // Show the entry if its password isn't at least "good", unless it is excluded
+                    if (item->health->quality() < PasswordHealth::Quality::Good && (!item->knownBad || showKnownBad)) {
+                        addHealthRow(item->health, entry->group(), entry, item->knownBad);
+                    }
+                }
+            });
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher] {
+        watcher->deleteLater();
+
+        if (m_referencesModel->rowCount() == 0) {
+            m_referencesModel->setHorizontalHeaderLabels(QStringList()
+                                                         << tr("Congratulations, everything is healthy!"));
+        } else {
+            // Worst passwords (least score) at the top
+            m_ui->healthcheckTableView->sortByColumn(3, Qt::AscendingOrder);
+        }
 
-    // Show the "show known bad entries" checkbox if there's any known
-    // bad entry in the database.
-    if (health->anyKnownBad()) {
-        m_ui->showKnownBadCheckBox->show();
-    } else {
-        m_ui->showKnownBadCheckBox->hide();
-    }
+        m_ui->healthcheckTableView->resizeRowsToContents();
+    });
+    watcher->setFuture(QtConcurrent::mapped(health->candidates(), evaluate));
 }
 
 void ReportsWidgetHealthcheck::emitEntryActivated(const QModelIndex& index)
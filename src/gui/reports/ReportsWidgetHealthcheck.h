@@ -22,12 +22,14 @@
 #include <QHash>
 #include <QIcon>
 #include <QPair>
+#include <QPointer>
 #include <QWidget>
 
 class Database;
 class Entry;
 class Group;
 class PasswordHealth;
+class QFutureWatcherBase;
 class QSortFilterProxyModel;
 class QStandardItemModel;
 
@@ -71,6 +73,7 @@ private:
     QSharedPointer<Database> m_db;
     QList<QPair<const Group*, const Entry*>> m_rowToEntry;
     Entry* m_contextmenuEntry = nullptr;
+    QPointer<QFutureWatcherBase> m_healthWatcher;
 };
 
 #endif // KEEPASSXC_REPORTSWIDGETHEALTHCHECK_H
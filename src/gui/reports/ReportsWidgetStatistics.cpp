@@ -22,137 +22,150 @@
 #include "core/Database.h"
 #include "core/Global.h"
 #include "core/Group.h"
+#include "core/MemoryUsage.h"
 #include "core/Metadata.h"
 #include "core/PasswordHealth.h"
+#include "core/Tools.h"
 #include "gui/Icons.h"
 
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QHash>
 #include <QStandardItemModel>
 
 namespace
 {
-    class Stats
+    // Number of entries evaluated by one worker task
+    constexpr int STATS_CHUNK_SIZE = 250;
+} // namespace
+
+class ReportsWidgetStatistics::Stats
+{
+public:
+    // The statistics we collect:
+    QDateTime modified; // File modification time
+    int nGroups = 0; // Number of groups in the database
+    int nEntries = 0; // Number of entries (across all groups)
+    int nExpired = 0; // Number of expired entries
+    int nPwdsWeak = 0; // Number of weak or poor passwords
+    int nPwdsShort = 0; // Number of passwords 8 characters or less in size
+    int nPwdsUnique = 0; // Number of unique passwords
+    int nPwdsReused = 0; // Number of non-unique passwords
+    int nKnownBad = 0; // Number of known bad entries
+    int pwdTotalLen = 0; // Total length of all passwords
+    int maxReuse = 0; // Max number of entries sharing the same password
+    MemoryUsage memory; // Estimated memory held by the database
+
+    // Get average password length
+    int averagePwdLength() const
     {
-    public:
-        // The statistics we collect:
-        QDateTime modified; // File modification time
-        int nGroups = 0; // Number of groups in the database
-        int nEntries = 0; // Number of entries (across all groups)
-        int nExpired = 0; // Number of expired entries
-        int nPwdsWeak = 0; // Number of weak or poor passwords
-        int nPwdsShort = 0; // Number of passwords 8 characters or less in size
-        int nPwdsUnique = 0; // Number of unique passwords
-        int nPwdsReused = 0; // Number of non-unique passwords
-        int nKnownBad = 0; // Number of known bad entries
-        int pwdTotalLen = 0; // Total length of all passwords
-
-        // Ctor does all the work
-        explicit Stats(QSharedPointer<Database> db)
-            : modified(QFileInfo(db->filePath()).lastModified())
-            , m_db(db)
-        {
-            gatherStats(db->rootGroup()->groupsRecursive(true));
-        }
+        return nPwdsUnique == 0 ? 0 : pwdTotalLen / nPwdsUnique;
+    }
 
-        // Get average password length
-        int averagePwdLength() const
-        {
-            return m_passwords.empty() ? 0 : pwdTotalLen / m_passwords.size();
-        }
+    // Get max number of password reuse (=how many entries
+    // share the same password)
+    int maxPwdReuse() const
+    {
+        return maxReuse;
+    }
 
-        // Get max number of password reuse (=how many entries
-        // share the same password)
-        int maxPwdReuse() const
-        {
-            int ret = 0;
-            for (const auto& count : m_passwords) {
-                ret = std::max(ret, count);
-            }
-            return ret;
-        }
+    // A warning sign is displayed if one of the
+    // following returns true.
+    bool isAnyExpired() const
+    {
+        return nExpired > 0;
+    }
 
-        // A warning sign is displayed if one of the
-        // following returns true.
-        bool isAnyExpired() const
-        {
-            return nExpired > 0;
-        }
+    bool areTooManyPwdsReused() const
+    {
+        return nPwdsReused > nPwdsUnique / 10;
+    }
 
-        bool areTooManyPwdsReused() const
-        {
-            return nPwdsReused > nPwdsUnique / 10;
-        }
+    bool arePwdsReusedTooOften() const
+    {
+        return maxPwdReuse() > 3;
+    }
 
-        bool arePwdsReusedTooOften() const
-        {
-            return maxPwdReuse() > 3;
-        }
+    bool isAvgPwdTooShort() const
+    {
+        return averagePwdLength() < 10;
+    }
+
+    bool isHistoryTooLarge() const
+    {
+        return memory.historyItems > memory.entries;
+    }
 
-        bool isAvgPwdTooShort() const
-        {
-            return averagePwdLength() < 10;
+    // Collect the figures that only need the database structure and the
+    // password reuse of the health cache. Must run on the GUI thread.
+    void gatherDatabase(QSharedPointer<Database> db)
+    {
+        modified = QFileInfo(db->filePath()).lastModified();
+        memory = db->memoryUsage();
+        db->rootGroup()->forEachGroupRecursive(
+            [this](const Group*) -> bool {
+                ++nGroups;
+                return true;
+            },
+            true,
+            true);
+
+        // The health cache also leaves out the recycle bin
+        const auto emptyKey = PasswordHealthCache::passwordKey("");
+        const auto users = db->healthCache()->passwordUsers();
+        for (auto it = users.constBegin(); it != users.constEnd(); ++it) {
+            if (it.key() == emptyKey) {
+                continue;
+            }
+            ++nPwdsUnique;
+            nPwdsReused += it.value().size() - 1;
+            maxReuse = std::max(maxReuse, it.value().size());
         }
+    }
 
-    private:
-        QSharedPointer<Database> m_db;
-        QHash<QString, int> m_passwords;
+    // Collect the per-entry figures of a chunk of entries, thread-safe
+    void gatherEntries(const QList<const Entry*>& entries, const HealthChecker& checker)
+    {
+        for (const auto* entry : entries) {
+            ++nEntries;
 
-        void gatherStats(const QList<Group*>& groups)
-        {
-            auto checker = HealthChecker(m_db);
+            if (entry->isExpired()) {
+                ++nExpired;
+            }
 
-            for (const auto* group : groups) {
-                // Don't count anything in the recycle bin
-                if (group->isRecycled()) {
-                    continue;
+            // Get password statistics
+            const auto pwd = entry->password();
+            if (!pwd.isEmpty()) {
+                if (pwd.size() < 8) {
+                    ++nPwdsShort;
                 }
 
-                ++nGroups;
+                // Speed up Zxcvbn process by excluding very long passwords and most passphrases
+                if (pwd.size() < 25 && checker.evaluate(entry)->quality() <= PasswordHealth::Quality::Weak) {
+                    ++nPwdsWeak;
+                }
 
-                for (const auto* entry : group->entries()) {
-                    // Don't count anything in the recycle bin
-                    if (entry->isRecycled()) {
-                        continue;
-                    }
-
-                    ++nEntries;
-
-                    if (entry->isExpired()) {
-                        ++nExpired;
-                    }
-
-                    // Get password statistics
-                    const auto pwd = entry->password();
-                    if (!pwd.isEmpty()) {
-                        if (!m_passwords.contains(pwd)) {
-                            ++nPwdsUnique;
-                        } else {
-                            ++nPwdsReused;
-                        }
-
-                        if (pwd.size() < 8) {
-                            ++nPwdsShort;
-                        }
-
-                        // Speed up Zxcvbn process by excluding very long passwords and most passphrases
-                        if (pwd.size() < 25 && checker.evaluate(entry)->quality() <= PasswordHealth::Quality::Weak) {
-                            ++nPwdsWeak;
-                        }
-
-                        if (entry->customData()->contains(PasswordHealth::OPTION_KNOWN_BAD)
-                            && entry->customData()->value(PasswordHealth::OPTION_KNOWN_BAD) == TRUE_STR) {
-                            ++nKnownBad;
-                        }
-
-                        pwdTotalLen += pwd.size();
-                        m_passwords[pwd]++;
-                    }
+                if (entry->customData()->contains(PasswordHealth::OPTION_KNOWN_BAD)
+                    && entry->customData()->value(PasswordHealth::OPTION_KNOWN_BAD) == TRUE_STR) {
+                    ++nKnownBad;
                 }
+
+                pwdTotalLen += pwd.size();
             }
         }
-    };
-} // namespace
+    }
+
+    // Add the per-entry figures of a finished chunk
+    void add(const Stats& chunk)
+    {
+        nEntries += chunk.nEntries;
+        nExpired += chunk.nExpired;
+        nPwdsWeak += chunk.nPwdsWeak;
+        nPwdsShort += chunk.nPwdsShort;
+        nKnownBad += chunk.nKnownBad;
+        pwdTotalLen += chunk.pwdTotalLen;
+    }
+};
 
 ReportsWidgetStatistics::ReportsWidgetStatistics(QWidget* parent)
     : QWidget(parent)
@@ -208,49 +221,132 @@ void ReportsWidgetStatistics::showEvent(QShowEvent* event)
 
 void ReportsWidgetStatistics::calculateStats()
 {
-    const QScopedPointer<Stats> stats(AsyncTask::runAndWaitForFuture([this] { return new Stats(m_db); }));
+    // A new calculation replaces the one still running
+    if (m_statsWatcher) {
+        m_statsWatcher->disconnect(this);
+        m_statsWatcher->cancel();
+        m_statsWatcher->deleteLater();
+    }
 
+    // The health checker brings the health cache up to date, which has to
+    // happen here; the entries of a snapshot are then evaluated in chunks on
+    // the thread pool, the database may change or be locked in the meantime
+    auto checker = QSharedPointer<HealthChecker>::create(m_db);
+    auto stats = QSharedPointer<Stats>::create();
+    stats->gatherDatabase(m_db);
+
+    QSharedPointer<const Database> snapshot = m_db->readSnapshot();
+    QList<QList<const Entry*>> chunks;
+    snapshot->rootGroup()->forEachEntryRecursive(
+        [&chunks](const Entry* entry) -> bool {
+            if (chunks.isEmpty() || chunks.last().size() >= STATS_CHUNK_SIZE) {
+                chunks.append(QList<const Entry*>());
+            }
+            chunks.last().append(entry);
+            return true;
+        },
+        true);
+    const int totalChunks = chunks.size();
+
+    std::function<Stats(const QList<const Entry*>&)> gather = [checker, snapshot](const QList<const Entry*>& entries) {
+        Stats chunk;
+        chunk.gatherEntries(entries, *checker);
+        return chunk;
+    };
+
+    auto watcher = new QFutureWatcher<Stats>(this);
+    m_statsWatcher = watcher;
+    auto doneChunks = QSharedPointer<int>::create(0);
+    connect(watcher,
+            &QFutureWatcherBase::resultsReadyAt,
+            this,
+            [this, watcher, stats, doneChunks, totalChunks](int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    stats->add(watcher->resultAt(i));
+                }
+                *doneChunks += end - begin;
+                if (*doneChunks < totalChunks) {
+                    showStats(*stats, *doneChunks * 100 / totalChunks);
+                }
+            });
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, stats] {
+        watcher->deleteLater();
+        showStats(*stats, 100);
+    });
+    watcher->setFuture(QtConcurrent::mapped(chunks, gather));
+}
+
+/**
+ * Fill the table with the statistics gathered so far.
+ *
+ * @param stats statistics of the evaluated entries
+ * @param progress percentage of the entries evaluated
+ */
+void ReportsWidgetStatistics::showStats(const Stats& stats, int progress)
+{
     m_referencesModel->clear();
+    if (progress < 100) {
+        addStatsRow(tr("Please wait, database statistics are being calculated..."), tr("%1%").arg(progress));
+    }
     addStatsRow(tr("Database name"), m_db->metadata()->name());
     addStatsRow(tr("Description"), m_db->metadata()->description());
     addStatsRow(tr("Location"), m_db->filePath());
-    addStatsRow(tr("Last saved"), stats->modified.toString(Qt::DefaultLocaleShortDate));
+    addStatsRow(tr("Last saved"), stats.modified.toString(Qt::DefaultLocaleShortDate));
     addStatsRow(tr("Unsaved changes"),
                 m_db->isModified() ? tr("yes") : tr("no"),
                 m_db->isModified(),
                 tr("The database was modified, but the changes have not yet been saved to disk."));
-    addStatsRow(tr("Number of groups"), QString::number(stats->nGroups));
-    addStatsRow(tr("Number of entries"), QString::number(stats->nEntries));
+    addStatsRow(tr("Number of groups"), QString::number(stats.nGroups));
+    addStatsRow(tr("Number of entries"), QString::number(stats.nEntries));
     addStatsRow(tr("Number of expired entries"),
-                QString::number(stats->nExpired),
-                stats->isAnyExpired(),
+                QString::number(stats.nExpired),
+                stats.isAnyExpired(),
                 tr("The database contains entries that have expired."));
-    addStatsRow(tr("Unique passwords"), QString::number(stats->nPwdsUnique));
+    addStatsRow(tr("Unique passwords"), QString::number(stats.nPwdsUnique));
     addStatsRow(tr("Non-unique passwords"),
-                QString::number(stats->nPwdsReused),
-                stats->areTooManyPwdsReused(),
+                QString::number(stats.nPwdsReused),
+                stats.areTooManyPwdsReused(),
                 tr("More than 10% of passwords are reused. Use unique passwords when possible."));
     addStatsRow(tr("Maximum password reuse"),
-                QString::number(stats->maxPwdReuse()),
-                stats->arePwdsReusedTooOften(),
+                QString::number(stats.maxPwdReuse()),
+                stats.arePwdsReusedTooOften(),
                 tr("Some passwords are used more than three times. Use unique passwords when possible."));
     addStatsRow(tr("Number of short passwords"),
-                QString::number(stats->nPwdsShort),
-                stats->nPwdsShort > 0,
+                QString::number(stats.nPwdsShort),
+                stats.nPwdsShort > 0,
                 tr("Recommended minimum password length is at least 8 characters."));
     addStatsRow(tr("Number of weak passwords"),
-                QString::number(stats->nPwdsWeak),
-                stats->nPwdsWeak > 0,
+                QString::number(stats.nPwdsWeak),
+                stats.nPwdsWeak > 0,
                 tr("Recommend using long, randomized passwords with a rating of 'good' or 'excellent'."));
     addStatsRow(tr("Entries excluded from reports"),
-                QString::number(stats->nKnownBad),
-                stats->nKnownBad > 0,
+                QString::number(stats.nKnownBad),
+                stats.nKnownBad > 0,
                 tr("Excluding entries from reports, e. g. because they are known to have a poor password, isn't "
                    "necessarily a problem but you should keep an eye on them."));
     addStatsRow(tr("Average password length"),
-                tr("%1 characters").arg(stats->averagePwdLength()),
-                stats->isAvgPwdTooShort(),
+                tr("%1 characters").arg(stats.averagePwdLength()),
+                stats.isAvgPwdTooShort(),
                 tr("Average password length is less than ten characters. Longer passwords provide more security."));
+    addStatsRow(tr("Estimated memory usage"), Tools::humanReadableFileSize(stats.memory.total()));
+    addStatsRow(tr("Memory used by entries"), Tools::humanReadableFileSize(stats.memory.entries));
+    addStatsRow(tr("Memory used by entry history"),
+                Tools::humanReadableFileSize(stats.memory.historyItems),
+                stats.isHistoryTooLarge(),
+                tr("The entry history uses more memory than the entries themselves. Lowering the history limits "
+                   "in the database settings reduces it."));
+    addStatsRow(tr("Memory used by attachments"),
+                tr("%1 (%2 before deduplication)")
+                    .arg(Tools::humanReadableFileSize(stats.memory.attachmentsDeduplicated),
+                         Tools::humanReadableFileSize(stats.memory.attachmentsTotal)));
+    addStatsRow(tr("Memory used by custom icons"),
+                tr("%1 (%2 decoded)")
+                    .arg(Tools::humanReadableFileSize(stats.memory.customIconsRaw),
+                         Tools::humanReadableFileSize(stats.memory.customIconsDecoded)));
+    addStatsRow(tr("Memory used by custom data"), Tools::humanReadableFileSize(stats.memory.customData));
+    addStatsRow(tr("Memory used by deleted objects"), Tools::humanReadableFileSize(stats.memory.deletedObjects));
+    addStatsRow(tr("Memory returned after locking and closing databases"),
+                Tools::humanReadableFileSize(MemoryUsage::releasedMemory()));
 }
 
 void ReportsWidgetStatistics::saveSettings()
@@ -19,9 +19,11 @@
 #define KEEPASSXC_REPORTSWIDGETSTATISTICS_H
 
 #include <QIcon>
+#include <QPointer>
 #include <QWidget>
 
 class Database;
+class QFutureWatcherBase;
 class QStandardItemModel;
 
 namespace Ui
@@ -46,13 +48,17 @@ private slots:
     void calculateStats();
 
 private:
+    class Stats;
+
     QScopedPointer<Ui::ReportsWidgetStatistics> m_ui;
 
     bool m_statsCalculated = false;
     QIcon m_errIcon;
     QScopedPointer<QStandardItemModel> m_referencesModel;
     QSharedPointer<Database> m_db;
+    QPointer<QFutureWatcherBase> m_statsWatcher;
 
+    void showStats(const Stats& stats, int progress);
     void addStatsRow(QString name, QString value, bool bad = false, QString badMsg = "");
 };
 
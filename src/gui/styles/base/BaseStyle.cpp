@@ -33,6 +33,7 @@
 #include <QMenu>
 #include <QPainter>
 #include <QPainterPath>
+#include <QPixmapCache>
 #include <QPoint>
 #include <QPolygon>
 #include <QPushButton>
@@ -1384,6 +1385,59 @@ namespace Phantom
                 }
             }
         }
+
+        // Primitives bigger than this are painted directly, caching them would
+        // only churn QPixmapCache.
+        constexpr int MaxCachedPrimitiveExtent = 64;
+
+        // Paints a small primitive through QPixmapCache instead of building its
+        // paths every time, which adds up when scrolling long item views on
+        // software rendered displays. The key holds everything the painting
+        // depends on: the name (with any option bits the caller needs), the state
+        // and direction, the size, the device pixel ratio and the palette. After a
+        // palette change the old pixmaps are never hit again and age out of the
+        // cache.
+        //
+        // The paint function gets the painter and the rect to paint in, which is
+        // the option rect moved to the origin when the result is cached.
+        template <typename PaintFn>
+        void drawCachedPrimitive(QPainter* painter,
+                                 const QString& name,
+                                 const QStyleOption* option,
+                                 uint paletteKey,
+                                 PaintFn paint)
+        {
+            const QRect& rect = option->rect;
+            if (rect.isEmpty() || rect.width() > MaxCachedPrimitiveExtent || rect.height() > MaxCachedPrimitiveExtent
+                || !painter->device() || painter->transform().type() > QTransform::TxTranslate) {
+                paint(painter, rect);
+                return;
+            }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+            const qreal ratio = painter->device()->devicePixelRatioF();
+#else
+            const qreal ratio = painter->device()->devicePixelRatio();
+#endif
+            const QString key = QStringLiteral("phantom-%1-%2-%3-%4x%5-%6-%7")
+                                    .arg(name)
+                                    .arg(static_cast<int>(option->state))
+                                    .arg(static_cast<int>(option->direction))
+                                    .arg(rect.width())
+                                    .arg(rect.height())
+                                    .arg(ratio)
+                                    .arg(paletteKey);
+            QPixmap pixmap;
+            if (!QPixmapCache::find(key, &pixmap)) {
+                pixmap = QPixmap(rect.size() * ratio);
+                pixmap.setDevicePixelRatio(ratio);
+                pixmap.fill(Qt::transparent);
+                QPainter pixmapPainter(&pixmap);
+                paint(&pixmapPainter, QRect(QPoint(0, 0), rect.size()));
+                pixmapPainter.end();
+                QPixmapCache::insert(key, pixmap);
+            }
+            painter->drawPixmap(rect.topLeft(), pixmap);
+        }
     } // namespace
 } // namespace Phantom
 
@@ -1454,6 +1508,8 @@ void BaseStyle::drawPrimitive(PrimitiveElement elem,
     namespace Ph = Phantom;
     auto ph_swatchPtr = getCachedSwatchOfQPalette(&d->swatchCache, &d->headSwatchFastKey, option->palette);
     const Ph::PhSwatch& swatch = *ph_swatchPtr.data();
+    // The swatch we just got is always at the head of the cache
+    const uint paletteKey = d->swatchCache.at(0).first;
     const int state = option->state;
     // Cast to int here to suppress warnings about cases listed which are not in
     // the original enum. This is for custom primitive elements.
@@ -1519,16 +1575,23 @@ void BaseStyle::drawPrimitive(PrimitiveElement elem,
             }
         }
         Swatchy color = useSelectionColor ? S_highlightedText : S_indicator_current;
-        QRect r = option->rect;
         if (Ph::BranchesOnEdge) {
+            QRect r = option->rect;
             // TODO RTL
             r.moveLeft(0);
             if (r.width() < r.height())
                 r.setWidth(r.height());
+            int adj = qMin(r.width(), r.height()) / 4;
+            r.adjust(adj, adj, -adj, -adj);
+            Ph::drawArrow(painter, r, arrow, swatch.brush(color));
+            break;
         }
-        int adj = qMin(r.width(), r.height()) / 4;
-        r.adjust(adj, adj, -adj, -adj);
-        Ph::drawArrow(painter, r, arrow, swatch.brush(color));
+        const QString name = useSelectionColor ? QStringLiteral("branch-selected") : QStringLiteral("branch");
+        Ph::drawCachedPrimitive(painter, name, option, paletteKey, [&](QPainter* p, QRect r) {
+            int adj = qMin(r.width(), r.height()) / 4;
+            r.adjust(adj, adj, -adj, -adj);
+            Ph::drawArrow(p, r, arrow, swatch.brush(color));
+        });
         break;
     }
     case PE_IndicatorMenuCheckMark: {
@@ -1818,7 +1881,6 @@ void BaseStyle::drawPrimitive(PrimitiveElement elem,
         auto checkbox = qstyleoption_cast<const QStyleOptionButton*>(option);
         if (!checkbox)
             break;
-        QRect r = option->rect;
         bool isHighlighted = option->state & State_HasFocus && option->state & State_KeyboardFocusChange;
         bool isSelected = option->state & State_Selected;
         bool isFlat = checkbox->features & QStyleOptionButton::Flat;
@@ -1835,70 +1897,76 @@ void BaseStyle::drawPrimitive(PrimitiveElement elem,
         if (isSelected && isFlat) {
             fgColor = S_highlightedText;
         }
-        if (!isFlat) {
-            QRect fillR = r;
-            Ph::fillRectOutline(painter, fillR, 1, swatch.color(outlineColor));
-            fillR.adjust(1, 1, -1, -1);
-            if (Ph::IndicatorShadows && !isPressed && isEnabled) {
-                Ph::fillRectEdges(painter, fillR, Qt::TopEdge, 1, swatch.color(S_base_shadow));
-                fillR.adjust(0, 1, 0, 0);
+        const QString name = isFlat ? QStringLiteral("checkbox-flat") : QStringLiteral("checkbox");
+        Ph::drawCachedPrimitive(painter, name, option, paletteKey, [&](QPainter* p, const QRect& r) {
+            if (!isFlat) {
+                QRect fillR = r;
+                Ph::fillRectOutline(p, fillR, 1, swatch.color(outlineColor));
+                fillR.adjust(1, 1, -1, -1);
+                if (Ph::IndicatorShadows && !isPressed && isEnabled) {
+                    Ph::fillRectEdges(p, fillR, Qt::TopEdge, 1, swatch.color(S_base_shadow));
+                    fillR.adjust(0, 1, 0, 0);
+                }
+                p->fillRect(fillR, swatch.color(bgFillColor));
             }
-            painter->fillRect(fillR, swatch.color(bgFillColor));
-        }
-        if (checkbox->state & State_NoChange) {
-            const qreal insetScale = 0.7;
-            qreal rx, ry, rw, rh;
-            QRectF(r.adjusted(1, 1, -1, -1)).getRect(&rx, &ry, &rw, &rh);
-            qreal dimx = rw * insetScale;
-            qreal dimy = rh * insetScale;
-            QRectF r_(rx + (rw - dimx) / 2, ry + (rh - dimy) / 2, dimx, dimy);
-            Ph::drawHyphen(painter, d->checkBox_pen_scratch, r_, swatch, fgColor);
-        } else if (checkbox->state & State_On) {
-            const qreal insetScale = 0.8;
-            qreal rx, ry, rw, rh;
-            QRectF(r.adjusted(1, 1, -1, -1)).getRect(&rx, &ry, &rw, &rh);
-            // kinda wrong, assumes we're already square, but we probably are
-            qreal dimx = rw * insetScale * Ph::CheckMark_WidthOfHeightScale;
-            qreal dimy = rh * insetScale;
-            QRectF r_(rx + (rw - dimx) / 2, ry + (rh - dimy) / 2, dimx, dimy);
-            Ph::drawCheck(painter, d->checkBox_pen_scratch, r_, swatch, fgColor);
-        }
+            if (checkbox->state & State_NoChange) {
+                const qreal insetScale = 0.7;
+                qreal rx, ry, rw, rh;
+                QRectF(r.adjusted(1, 1, -1, -1)).getRect(&rx, &ry, &rw, &rh);
+                qreal dimx = rw * insetScale;
+                qreal dimy = rh * insetScale;
+                QRectF r_(rx + (rw - dimx) / 2, ry + (rh - dimy) / 2, dimx, dimy);
+                Ph::drawHyphen(p, d->checkBox_pen_scratch, r_, swatch, fgColor);
+            } else if (checkbox->state & State_On) {
+                const qreal insetScale = 0.8;
+                qreal rx, ry, rw, rh;
+                QRectF(r.adjusted(1, 1, -1, -1)).getRect(&rx, &ry, &rw, &rh);
+                // kinda wrong, assumes we're already square, but we probably are
+                qreal dimx = rw * insetScale * Ph::CheckMark_WidthOfHeightScale;
+                qreal dimy = rh * insetScale;
+                QRectF r_(rx + (rw - dimx) / 2, ry + (rh - dimy) / 2, dimx, dimy);
+                Ph::drawCheck(p, d->checkBox_pen_scratch, r_, swatch, fgColor);
+            }
+        });
         break;
     }
     case PE_IndicatorRadioButton: {
-        qreal rx, ry, rw, rh;
-        QRectF(option->rect).getRect(&rx, &ry, &rw, &rh);
         bool isHighlighted = option->state & State_HasFocus && option->state & State_KeyboardFocusChange;
         bool isSunken = state & State_Sunken;
         bool isEnabled = state & State_Enabled;
         Swatchy outlineColor = isHighlighted ? S_highlight_outline : S_window_outline;
         Swatchy bgFillColor = isSunken ? S_highlight : S_base;
-        QPointF circleCenter(rx + rw / 2.0, ry + rh / 2.0);
-        const qreal lineThickness = 1.0;
-        qreal outlineRadius = (qMin(rw, rh) - lineThickness) / 2.0;
-        qreal fillRadius = outlineRadius - lineThickness / 2.0;
-        Ph::PSave save(painter);
-        painter->setRenderHint(QPainter::Antialiasing);
-        painter->setBrush(swatch.brush(bgFillColor));
-        painter->setPen(swatch.pen(outlineColor));
-        painter->drawEllipse(circleCenter, outlineRadius, outlineRadius);
-        if (Ph::IndicatorShadows && !isSunken && isEnabled) {
-            // Really slow, just a temp demo test
-            painter->setPen(Qt::NoPen);
-            painter->setBrush(swatch.brush(S_base_shadow));
-            QPainterPath path0, path1;
-            path0.addEllipse(circleCenter, fillRadius, fillRadius);
-            path1.addEllipse(circleCenter + QPointF(0, 1.25), fillRadius, fillRadius);
-            QPainterPath path2 = path0 - path1;
-            painter->drawPath(path2);
-        }
-        if (state & State_On) {
-            Swatchy fgColor = isSunken ? S_highlightedText : S_windowText;
-            qreal checkmarkRadius = outlineRadius / 2.32;
-            painter->setPen(Qt::NoPen);
-            painter->setBrush(swatch.brush(fgColor));
-            painter->drawEllipse(circleCenter, checkmarkRadius, checkmarkRadius);
-        }
+        const QString name = QStringLiteral("radiobutton");
+        Ph::drawCachedPrimitive(painter, name, option, paletteKey, [&](QPainter* p, const QRect& r) {
+            qreal rx, ry, rw, rh;
+            QRectF(r).getRect(&rx, &ry, &rw, &rh);
+            QPointF circleCenter(rx + rw / 2.0, ry + rh / 2.0);
+            const qreal lineThickness = 1.0;
+            qreal outlineRadius = (qMin(rw, rh) - lineThickness) / 2.0;
+            qreal fillRadius = outlineRadius - lineThickness / 2.0;
+            Ph::PSave save(p);
+            p->setRenderHint(QPainter::Antialiasing);
+            p->setBrush(swatch.brush(bgFillColor));
+            p->setPen(swatch.pen(outlineColor));
+            p->drawEllipse(circleCenter, outlineRadius, outlineRadius);
+            if (Ph::IndicatorShadows && !isSunken && isEnabled) {
+                // Really slow, just a temp demo test
+                p->setPen(Qt::NoPen);
+                p->setBrush(swatch.brush(S_base_shadow));
+                QPainterPath path0, path1;
+                path0.addEllipse(circleCenter, fillRadius, fillRadius);
+                path1.addEllipse(circleCenter + QPointF(0, 1.25), fillRadius, fillRadius);
+                QPainterPath path2 = path0 - path1;
+                p->drawPath(path2);
+            }
+            if (state & State_On) {
+                Swatchy fgColor = isSunken ? S_highlightedText : S_windowText;
+                qreal checkmarkRadius = outlineRadius / 2.32;
+                p->setPen(Qt::NoPen);
+                p->setBrush(swatch.brush(fgColor));
+                p->drawEllipse(circleCenter, checkmarkRadius, checkmarkRadius);
+            }
+        });
         break;
     }
     case PE_IndicatorToolBarHandle: {
@@ -99,9 +99,12 @@ KeeShareSettings::Reference KeeShare::referenceOf(const Group* group)
     if (!customData->contains(KeeShare_Reference)) {
         return s_emptyReference;
     }
-    const auto encoded = customData->value(KeeShare_Reference);
-    const auto serialized = QString::fromUtf8(QByteArray::fromBase64(encoded.toLatin1()));
-    KeeShareSettings::Reference reference = KeeShareSettings::Reference::deserialize(serialized);
+    // the reference is only decoded again after it changed
+    const auto reference =
+        customData->parsedValue<KeeShareSettings::Reference>(KeeShare_Reference, [](const QString& encoded) {
+            const auto serialized = QString::fromUtf8(QByteArray::fromBase64(encoded.toLatin1()));
+            return KeeShareSettings::Reference::deserialize(serialized);
+        });
     if (reference.isNull()) {
         qWarning("Invalid sharing reference detected - sharing disabled");
         return s_emptyReference;
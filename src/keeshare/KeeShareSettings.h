@@ -178,4 +178,6 @@ namespace KeeShareSettings
     };
 }; // namespace KeeShareSettings
 
+Q_DECLARE_METATYPE(KeeShareSettings::Reference)
+
 #endif // KEEPASSXC_KEESHARESETTINGS_H
@@ -22,6 +22,10 @@
 #include "keeshare/KeeShare.h"
 #include "keeshare/Signature.h"
 #include "keys/PasswordKey.h"
+#include "keys/TransformedKeyCache.h"
+
+#include <QHash>
+#include <QMutex>
 
 #if defined(WITH_XC_KEESHARE_SECURE)
 #include <quazip.h>
@@ -30,6 +34,10 @@
 
 namespace
 {
+    // transform seed of the last export to each container during this session
+    QMutex exportSeedsMutex;
+    QHash<QString, QByteArray> exportSeeds;
+
     void resolveReferenceAttributes(Entry* targetEntry, const Database* sourceDb)
     {
         for (const auto& attribute : EntryAttributes::DefaultAttributes) {
@@ -54,14 +62,13 @@ namespace
         }
     }
 
-    Database* extractIntoDatabase(const KeeShareSettings::Reference& reference, const Group* sourceRoot)
+    Database* extractIntoDatabase(const Group* sourceRoot)
     {
         const auto* sourceDb = sourceRoot->database();
         auto* targetDb = new Database();
+        targetDb->setEmitModified(false);
         auto* targetMetadata = targetDb->metadata();
         targetMetadata->setRecycleBinEnabled(false);
-        auto key = QSharedPointer<CompositeKey>::create();
-        key->addKey(QSharedPointer<PasswordKey>::create(reference.password));
 
         // Copy the source root as the root of the export database, memory manage the old root node
         auto* targetRoot = sourceRoot->clone(Entry::CloneNoFlags, Group::CloneNoFlags);
@@ -71,7 +78,7 @@ namespace
         targetRoot->setUpdateTimeinfo(updateTimeinfo);
         const auto sourceEntries = sourceRoot->entriesRecursive(false);
         for (const Entry* sourceEntry : sourceEntries) {
-            auto* targetEntry = sourceEntry->clone(Entry::CloneIncludeHistory);
+            auto* targetEntry = sourceEntry->clone(Entry::CloneIncludeHistory | Entry::CloneCompactHistory);
             const bool updateTimeinfoEntry = targetEntry->canUpdateTimeinfo();
             targetEntry->setUpdateTimeinfo(false);
             targetEntry->setGroup(targetRoot);
@@ -82,7 +89,6 @@ namespace
             }
         }
 
-        targetDb->setKey(key);
         auto* obsoleteRoot = targetDb->rootGroup();
         targetDb->setRootGroup(targetRoot);
         delete obsoleteRoot;
@@ -104,10 +110,13 @@ namespace
         return targetDb;
     }
 
-    ShareObserver::Result
-    intoSignedContainer(const QString& resolvedPath, const KeeShareSettings::Reference& reference, Database* targetDb)
+    ShareObserver::Result intoSignedContainer(const QString& resolvedPath,
+                                              const KeeShareSettings::Reference& reference,
+                                              const KeeShareSettings::Own& own,
+                                              Database* targetDb)
     {
 #if !defined(WITH_XC_KEESHARE_SECURE)
+        Q_UNUSED(own);
         Q_UNUSED(targetDb);
         Q_UNUSED(resolvedPath);
         return {reference.path,
@@ -125,7 +134,6 @@ namespace
                 return {reference.path, ShareObserver::Result::Error, writer.errorString()};
             }
         }
-        const auto own = KeeShare::own();
         QuaZip zip(resolvedPath);
         zip.setFileNameCodec("UTF-8");
         const bool zipOpened = zip.open(QuaZip::mdCreate);
@@ -219,10 +227,54 @@ ShareObserver::Result ShareExport::intoContainer(const QString& resolvedPath,
                                                  const KeeShareSettings::Reference& reference,
                                                  const Group* group)
 {
-    QScopedPointer<Database> targetDb(extractIntoDatabase(reference, group));
+    return writeContainer(resolvedPath, reference, KeeShare::own(), prepareDatabase(group));
+}
+
+/**
+ * Copy the shared group into a new database for export.
+ *
+ * The returned database has no key yet and is deleted on the thread it was
+ * created on, so it can be handed to writeContainer() on a worker thread.
+ */
+QSharedPointer<Database> ShareExport::prepareDatabase(const Group* group)
+{
+    return QSharedPointer<Database>(extractIntoDatabase(group), &QObject::deleteLater);
+}
+
+/**
+ * Derive the share key and write the container, the expensive part of an
+ * export. Touches nothing but its arguments, so it may run on any thread.
+ */
+ShareObserver::Result ShareExport::writeContainer(const QString& resolvedPath,
+                                                  const KeeShareSettings::Reference& reference,
+                                                  const KeeShareSettings::Own& own,
+                                                  QSharedPointer<Database> targetDb)
+{
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create(reference.password));
+    key->setTransformCache(TransformedKeyCache::shareInstance());
+
+    // keep the transform seed of the previous export, so the cached key can be used
+    // instead of running the KDF again, the master seed still changes on every write
+    QByteArray seed;
+    {
+        QMutexLocker locker(&exportSeedsMutex);
+        seed = exportSeeds.value(resolvedPath);
+    }
+    if (!seed.isEmpty()) {
+        targetDb->kdf()->setSeed(seed);
+    }
+    if (!targetDb->setKey(key)) {
+        return {reference.path, ShareObserver::Result::Error, targetDb->keyError()};
+    }
+    {
+        QMutexLocker locker(&exportSeedsMutex);
+        exportSeeds.insert(resolvedPath, targetDb->kdf()->seed());
+    }
+
     const QFileInfo info(resolvedPath);
     if (KeeShare::isContainerType(info, KeeShare::signedContainerFileType())) {
-        return intoSignedContainer(resolvedPath, reference, targetDb.data());
+        return intoSignedContainer(resolvedPath, reference, own, targetDb.data());
     }
     if (KeeShare::isContainerType(info, KeeShare::unsignedContainerFileType())) {
         return intoUnsignedContainer(resolvedPath, reference, targetDb.data());
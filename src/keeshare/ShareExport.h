@@ -29,6 +29,12 @@ public:
     static ShareObserver::Result
     intoContainer(const QString& resolvedPath, const KeeShareSettings::Reference& reference, const Group* group);
 
+    static QSharedPointer<Database> prepareDatabase(const Group* group);
+    static ShareObserver::Result writeContainer(const QString& resolvedPath,
+                                                const KeeShareSettings::Reference& reference,
+                                                const KeeShareSettings::Own& own,
+                                                QSharedPointer<Database> targetDb);
+
 private:
     ShareExport() = delete;
 };
@@ -17,11 +17,14 @@
 #include "ShareImport.h"
 #include "config-keepassx.h"
 #include "core/Merger.h"
+#include "crypto/CryptoHash.h"
 #include "format/KeePass2Reader.h"
 #include "keeshare/KeeShare.h"
 #include "keeshare/Signature.h"
 #include "keys/PasswordKey.h"
+#include "keys/TransformedKeyCache.h"
 
+#include <QCoreApplication>
 #include <QMessageBox>
 #include <QPushButton>
 
@@ -43,7 +46,7 @@ namespace
     };
 
     QPair<Trust, KeeShareSettings::Certificate>
-    check(QByteArray& data,
+    check(bool signatureValid,
           const KeeShareSettings::Reference& reference,
           const KeeShareSettings::Certificate& ownCertificate,
           const QList<KeeShareSettings::ScopedCertificate>& knownCertificates,
@@ -52,10 +55,7 @@ namespace
         KeeShareSettings::Certificate certificate;
         if (!sign.signature.isEmpty()) {
             certificate = sign.certificate;
-            auto key = sign.certificate.sshKey();
-            key.openKey(QString());
-            const auto signer = Signature();
-            if (!signer.verify(data, sign.signature, key)) {
+            if (!signatureValid) {
                 qCritical("Invalid signature for shared container %s.", qPrintable(reference.path));
                 return {Invalid, KeeShareSettings::Certificate()};
             }
@@ -123,20 +123,49 @@ namespace
         return {UntrustedOnce, certificate};
     }
 
-    ShareObserver::Result
-    signedContainerInto(const QString& resolvedPath, const KeeShareSettings::Reference& reference, Group* targetGroup)
+    bool readDatabase(QByteArray& payload,
+                      const KeeShareSettings::Reference& reference,
+                      ShareImport::Container& container)
     {
+        QBuffer buffer(&payload);
+        buffer.open(QIODevice::ReadOnly);
+
+        KeePass2Reader reader;
+        auto key = QSharedPointer<CompositeKey>::create();
+        key->addKey(QSharedPointer<PasswordKey>::create(reference.password));
+        // containers keep their transform seed between exports, only a new seed or password runs the KDF
+        key->setTransformCache(TransformedKeyCache::shareInstance());
+        QSharedPointer<Database> sourceDb(new Database(), &QObject::deleteLater);
+        sourceDb->setEmitModified(false);
+        if (!reader.readDatabase(&buffer, key, sourceDb.data())) {
+            qCritical("Error while parsing the database: %s", qPrintable(reader.errorString()));
+            container.result = {reference.path, ShareObserver::Result::Error, reader.errorString()};
+            return false;
+        }
+
+        // the database may be read on a worker thread, but is merged and deleted on the GUI thread
+        sourceDb->moveToThread(QCoreApplication::instance()->thread());
+        container.database = sourceDb;
+        return true;
+    }
+
+    void readSignedContainer(QByteArray& data,
+                             const KeeShareSettings::Reference& reference,
+                             ShareImport::Container& container)
+    {
+        container.isSigned = true;
 #if !defined(WITH_XC_KEESHARE_SECURE)
-        Q_UNUSED(targetGroup);
-        Q_UNUSED(resolvedPath);
-        return {reference.path,
-                ShareObserver::Result::Warning,
-                ShareImport::tr("Signed share container are not supported - import prevented")};
+        Q_UNUSED(data);
+        container.result = {reference.path,
+                            ShareObserver::Result::Warning,
+                            ShareImport::tr("Signed share container are not supported - import prevented")};
 #else
-        QuaZip zip(resolvedPath);
+        QBuffer zipBuffer(&data);
+        QuaZip zip(&zipBuffer);
         if (!zip.open(QuaZip::mdUnzip)) {
             qCritical("Unable to open file %s.", qPrintable(reference.path));
-            return {reference.path, ShareObserver::Result::Error, ShareImport::tr("File is not readable")};
+            container.result = {reference.path, ShareObserver::Result::Error, ShareImport::tr("File is not readable")};
+            return;
         }
         const auto expected = QSet<QString>() << KeeShare::signatureFileName() << KeeShare::containerFileName();
         const auto files = zip.getFileInfoList();
@@ -146,7 +175,9 @@ namespace
         }
         if (expected != actual) {
             qCritical("Invalid sharing container %s.", qPrintable(reference.path));
-            return {reference.path, ShareObserver::Result::Error, ShareImport::tr("Invalid sharing container")};
+            container.result = {
+                reference.path, ShareObserver::Result::Error, ShareImport::tr("Invalid sharing container")};
+            return;
         }
 
         zip.setCurrentFile(KeeShare::signatureFileName());
@@ -154,7 +185,7 @@ namespace
         signatureFile.open(QuaZipFile::ReadOnly);
         QTextStream stream(&signatureFile);
 
-        const auto sign = KeeShareSettings::Sign::deserialize(stream.readAll());
+        container.sign = KeeShareSettings::Sign::deserialize(stream.readAll());
         signatureFile.close();
 
         zip.setCurrentFile(KeeShare::containerFileName());
@@ -162,171 +193,56 @@ namespace
         databaseFile.open(QuaZipFile::ReadOnly);
         auto payload = databaseFile.readAll();
         databaseFile.close();
-        QBuffer buffer(&payload);
-        buffer.open(QIODevice::ReadOnly);
 
-        KeePass2Reader reader;
-        auto key = QSharedPointer<CompositeKey>::create();
-        key->addKey(QSharedPointer<PasswordKey>::create(reference.password));
-        auto sourceDb = QSharedPointer<Database>::create();
-        if (!reader.readDatabase(&buffer, key, sourceDb.data())) {
-            qCritical("Error while parsing the database: %s", qPrintable(reader.errorString()));
-            return {reference.path, ShareObserver::Result::Error, reader.errorString()};
+        if (!readDatabase(payload, reference, container)) {
+            return;
         }
 
-        auto foreign = KeeShare::foreign();
-        auto own = KeeShare::own();
-        auto trust = check(payload, reference, own.certificate, foreign.certificates, sign);
-        switch (trust.first) {
-        case Invalid:
-            qWarning("Prevent untrusted import");
-            return {reference.path, ShareObserver::Result::Error, ShareImport::tr("Untrusted import prevented")};
-
-        case UntrustedForever:
-        case TrustedForever: {
-            bool found = false;
-            const auto trusted =
-                trust.first == TrustedForever ? KeeShareSettings::Trust::Trusted : KeeShareSettings::Trust::Untrusted;
-            for (KeeShareSettings::ScopedCertificate& scopedCertificate : foreign.certificates) {
-                if (scopedCertificate.certificate.key == trust.second.key && scopedCertificate.path == reference.path) {
-                    scopedCertificate.certificate.signer = trust.second.signer;
-                    scopedCertificate.path = reference.path;
-                    scopedCertificate.trust = trusted;
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                foreign.certificates << KeeShareSettings::ScopedCertificate{reference.path, trust.second, trusted};
-            }
-            // update foreign certificates with new settings
-            KeeShare::setForeign(foreign);
-
-            if (trust.first == TrustedForever) {
-                qDebug("Synchronize %s %s with %s",
-                       qPrintable(reference.path),
-                       qPrintable(targetGroup->name()),
-                       qPrintable(sourceDb->rootGroup()->name()));
-                Merger merger(sourceDb->rootGroup(), targetGroup);
-                merger.setForcedMergeMode(Group::Synchronize);
-                auto changelist = merger.merge();
-                if (!changelist.isEmpty()) {
-                    return {
-                        reference.path, ShareObserver::Result::Success, ShareImport::tr("Successful signed import")};
-                }
-            }
-            // Silent ignore of untrusted import or unchanging import
-            return {};
-        }
-        case TrustedOnce:
-        case Own: {
-            qDebug("Synchronize %s %s with %s",
-                   qPrintable(reference.path),
-                   qPrintable(targetGroup->name()),
-                   qPrintable(sourceDb->rootGroup()->name()));
-            Merger merger(sourceDb->rootGroup(), targetGroup);
-            merger.setForcedMergeMode(Group::Synchronize);
-            auto changelist = merger.merge();
-            if (!changelist.isEmpty()) {
-                return {reference.path, ShareObserver::Result::Success, ShareImport::tr("Successful signed import")};
-            }
-            return {};
-        }
-        default:
-            qWarning("Prevented untrusted import of signed KeeShare database %s", qPrintable(reference.path));
-            return {reference.path, ShareObserver::Result::Warning, ShareImport::tr("Untrusted import prevented")};
+        // verify here as well, only the trust decision needs the GUI thread
+        if (!container.sign.signature.isEmpty()) {
+            auto key = container.sign.certificate.sshKey();
+            key.openKey(QString());
+            const auto signer = Signature();
+            container.signatureValid = signer.verify(payload, container.sign.signature, key);
         }
 #endif
     }
 
-    ShareObserver::Result
-    unsignedContainerInto(const QString& resolvedPath, const KeeShareSettings::Reference& reference, Group* targetGroup)
+    void readUnsignedContainer(QByteArray& data,
+                               const KeeShareSettings::Reference& reference,
+                               ShareImport::Container& container)
     {
 #if !defined(WITH_XC_KEESHARE_INSECURE)
-        Q_UNUSED(targetGroup);
-        Q_UNUSED(resolvedPath);
-        return {reference.path,
-                ShareObserver::Result::Warning,
-                ShareImport::tr("Unsigned share container are not supported - import prevented")};
+        Q_UNUSED(data);
+        container.result = {reference.path,
+                            ShareObserver::Result::Warning,
+                            ShareImport::tr("Unsigned share container are not supported - import prevented")};
 #else
-        QFile file(resolvedPath);
-        if (!file.open(QIODevice::ReadOnly)) {
-            qCritical("Unable to open file %s.", qPrintable(reference.path));
-            return {reference.path, ShareObserver::Result::Error, ShareImport::tr("File is not readable")};
-        }
-        auto payload = file.readAll();
-        file.close();
-        QBuffer buffer(&payload);
-        buffer.open(QIODevice::ReadOnly);
-
-        KeePass2Reader reader;
-        auto key = QSharedPointer<CompositeKey>::create();
-        key->addKey(QSharedPointer<PasswordKey>::create(reference.password));
-        auto sourceDb = QSharedPointer<Database>::create();
-        if (!reader.readDatabase(&buffer, key, sourceDb.data())) {
-            qCritical("Error while parsing the database: %s", qPrintable(reader.errorString()));
-            return {reference.path, ShareObserver::Result::Error, reader.errorString()};
-        }
-
-        auto foreign = KeeShare::foreign();
-        const auto own = KeeShare::own();
-        const auto sign = KeeShareSettings::Sign(); // invalid sign
-        auto trust = check(payload, reference, own.certificate, foreign.certificates, sign);
-        switch (trust.first) {
-        case UntrustedForever:
-        case TrustedForever: {
-            bool found = false;
-            const auto trusted =
-                trust.first == TrustedForever ? KeeShareSettings::Trust::Trusted : KeeShareSettings::Trust::Untrusted;
-            for (KeeShareSettings::ScopedCertificate& scopedCertificate : foreign.certificates) {
-                if (scopedCertificate.certificate.key == trust.second.key && scopedCertificate.path == reference.path) {
-                    scopedCertificate.certificate.signer = trust.second.signer;
-                    scopedCertificate.path = reference.path;
-                    scopedCertificate.trust = trusted;
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                foreign.certificates << KeeShareSettings::ScopedCertificate{reference.path, trust.second, trusted};
-            }
-            // update foreign certificates with new settings
-            KeeShare::setForeign(foreign);
-
-            if (trust.first == TrustedForever) {
-                qDebug("Synchronize %s %s with %s",
-                       qPrintable(reference.path),
-                       qPrintable(targetGroup->name()),
-                       qPrintable(sourceDb->rootGroup()->name()));
-                Merger merger(sourceDb->rootGroup(), targetGroup);
-                merger.setForcedMergeMode(Group::Synchronize);
-                auto changelist = merger.merge();
-                if (!changelist.isEmpty()) {
-                    return {
-                        reference.path, ShareObserver::Result::Success, ShareImport::tr("Successful signed import")};
-                }
-            }
-            return {};
-        }
+        readDatabase(data, reference, container);
+#endif
+    }
 
-        case TrustedOnce: {
-            qDebug("Synchronize %s %s with %s",
-                   qPrintable(reference.path),
-                   qPrintable(targetGroup->name()),
-                   qPrintable(sourceDb->rootGroup()->name()));
-            Merger merger(sourceDb->rootGroup(), targetGroup);
-            merger.setForcedMergeMode(Group::Synchronize);
-            auto changelist = merger.merge();
-            if (!changelist.isEmpty()) {
-                return {reference.path, ShareObserver::Result::Success, ShareImport::tr("Successful unsigned import")};
-            }
-            return {};
-        }
-        default:
-            qWarning("Prevented untrusted import of unsigned KeeShare database %s", qPrintable(reference.path));
-            return {reference.path, ShareObserver::Result::Warning, ShareImport::tr("Untrusted import prevented")};
+    ShareObserver::Result synchronize(const KeeShareSettings::Reference& reference,
+                                      const ShareImport::Container& container,
+                                      Group* targetGroup)
+    {
+        const auto* sourceRoot = container.database->rootGroup();
+        qDebug("Synchronize %s %s with %s",
+               qPrintable(reference.path),
+               qPrintable(targetGroup->name()),
+               qPrintable(sourceRoot->name()));
+        Merger merger(sourceRoot, targetGroup);
+        merger.setForcedMergeMode(Group::Synchronize);
+        // only entries that changed in the share since the last import need to be compared
+        merger.setUseMergeBase(true);
+        auto changelist = merger.merge();
+        if (!changelist.isEmpty()) {
+            return {reference.path,
+                    ShareObserver::Result::Success,
+                    container.isSigned ? ShareImport::tr("Successful signed import")
+                                       : ShareImport::tr("Successful unsigned import")};
         }
-#endif
+        return {};
     }
 
 } // namespace
@@ -335,17 +251,113 @@ ShareObserver::Result ShareImport::containerInto(const QString& resolvedPath,
                                                  const KeeShareSettings::Reference& reference,
                                                  Group* targetGroup)
 {
+    return applyContainer(readContainer(resolvedPath, reference), reference, targetGroup);
+}
+
+/**
+ * Read and decrypt a share container and verify its signature.
+ *
+ * This does not touch any database or setting and may run on any thread.
+ * If the container digest matches knownDigest, nothing is decrypted and the
+ * container is marked as unchanged.
+ */
+ShareImport::Container ShareImport::readContainer(const QString& resolvedPath,
+                                                  const KeeShareSettings::Reference& reference,
+                                                  const QByteArray& knownDigest)
+{
+    Container container;
     const QFileInfo info(resolvedPath);
     if (!info.exists()) {
         qCritical("File %s does not exist.", qPrintable(info.absoluteFilePath()));
-        return {reference.path, ShareObserver::Result::Warning, tr("File does not exist")};
+        container.result = {reference.path, ShareObserver::Result::Warning, tr("File does not exist")};
+        return container;
+    }
+
+    const bool isSigned = KeeShare::isContainerType(info, KeeShare::signedContainerFileType());
+    if (!isSigned && !KeeShare::isContainerType(info, KeeShare::unsignedContainerFileType())) {
+        container.result = {reference.path, ShareObserver::Result::Error, tr("Unknown share container type")};
+        return container;
+    }
+
+    QFile file(resolvedPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical("Unable to open file %s.", qPrintable(reference.path));
+        container.result = {reference.path, ShareObserver::Result::Error, tr("File is not readable")};
+        return container;
+    }
+    auto data = file.readAll();
+    file.close();
+
+    container.digest = CryptoHash::hash(data, CryptoHash::Sha256);
+    if (!knownDigest.isEmpty() && container.digest == knownDigest) {
+        container.unchanged = true;
+        return container;
+    }
+
+    if (isSigned) {
+        readSignedContainer(data, reference, container);
+    } else {
+        readUnsignedContainer(data, reference, container);
+    }
+    return container;
+}
+
+/**
+ * Decide on the trust of a container read by readContainer() and merge it
+ * into the target group. May ask the user, so it has to run on the GUI thread.
+ */
+ShareObserver::Result ShareImport::applyContainer(const Container& container,
+                                                  const KeeShareSettings::Reference& reference,
+                                                  Group* targetGroup)
+{
+    if (container.unchanged) {
+        return {};
+    }
+    if (container.result.isValid()) {
+        return container.result;
     }
 
-    if (KeeShare::isContainerType(info, KeeShare::signedContainerFileType())) {
-        return signedContainerInto(resolvedPath, reference, targetGroup);
+    auto foreign = KeeShare::foreign();
+    const auto own = KeeShare::own();
+    auto trust = check(container.signatureValid, reference, own.certificate, foreign.certificates, container.sign);
+    switch (trust.first) {
+    case Invalid:
+        qWarning("Prevent untrusted import");
+        return {reference.path, ShareObserver::Result::Error, tr("Untrusted import prevented")};
+
+    case UntrustedForever:
+    case TrustedForever: {
+        bool found = false;
+        const auto trusted =
+            trust.first == TrustedForever ? KeeShareSettings::Trust::Trusted : KeeShareSettings::Trust::Untrusted;
+        for (KeeShareSettings::ScopedCertificate& scopedCertificate : foreign.certificates) {
+            if (scopedCertificate.certificate.key == trust.second.key && scopedCertificate.path == reference.path) {
+                scopedCertificate.certificate.signer = trust.second.signer;
+                scopedCertificate.path = reference.path;
+                scopedCertificate.trust = trusted;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            foreign.certificates << KeeShareSettings::ScopedCertificate{reference.path, trust.second, trusted};
+        }
+        // update foreign certificates with new settings
+        KeeShare::setForeign(foreign);
+
+        if (trust.first == TrustedForever) {
+            return synchronize(reference, container, targetGroup);
+        }
+        // Silent ignore of untrusted import
+        return {};
     }
-    if (KeeShare::isContainerType(info, KeeShare::unsignedContainerFileType())) {
-        return unsignedContainerInto(resolvedPath, reference, targetGroup);
+    case TrustedOnce:
+    case Own:
+        return synchronize(reference, container, targetGroup);
+    default:
+        qWarning("Prevented untrusted import of %s KeeShare database %s",
+                 container.isSigned ? "signed" : "unsigned",
+                 qPrintable(reference.path));
+        return {reference.path, ShareObserver::Result::Warning, tr("Untrusted import prevented")};
     }
-    return {reference.path, ShareObserver::Result::Error, tr("Unknown share container type")};
 }
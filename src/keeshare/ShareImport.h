@@ -19,13 +19,35 @@
 
 #include "keeshare/ShareObserver.h"
 
+#include <QSharedPointer>
+
+class Database;
+
 class ShareImport
 {
     Q_DECLARE_TR_FUNCTIONS(ShareImport)
 public:
+    struct Container
+    {
+        // set if the container could not be read
+        ShareObserver::Result result;
+        QByteArray digest;
+        bool unchanged = false;
+        bool isSigned = false;
+        bool signatureValid = false;
+        KeeShareSettings::Sign sign;
+        QSharedPointer<Database> database;
+    };
+
     static ShareObserver::Result
     containerInto(const QString& resolvedPath, const KeeShareSettings::Reference& reference, Group* targetGroup);
 
+    static Container readContainer(const QString& resolvedPath,
+                                   const KeeShareSettings::Reference& reference,
+                                   const QByteArray& knownDigest = QByteArray());
+    static ShareObserver::Result
+    applyContainer(const Container& container, const KeeShareSettings::Reference& reference, Group* targetGroup);
+
 public:
     ShareImport() = delete;
 };
@@ -16,11 +16,14 @@
  */
 
 #include "ShareObserver.h"
+#include "core/AsyncTask.h"
 #include "core/Config.h"
 #include "core/Database.h"
 #include "core/FileWatcher.h"
 #include "core/Global.h"
 #include "core/Group.h"
+#include "core/Metadata.h"
+#include "crypto/CryptoHash.h"
 #include "keeshare/KeeShare.h"
 #include "keeshare/ShareExport.h"
 #include "keeshare/ShareImport.h"
@@ -35,6 +38,65 @@ namespace
 
     constexpr int FileWatchPeriod = 30;
     constexpr int FileWatchSize = 5;
+
+    void addToDigest(CryptoHash& hash, const QString& value)
+    {
+        const QByteArray bytes = value.toUtf8();
+        hash.addData(QByteArray::number(bytes.size()));
+        hash.addData(bytes);
+    }
+
+    /**
+     * Digest everything that ends up in the export of a share: the reference
+     * settings, the signing certificate, the shared group with the structure and
+     * fields of its subgroups, its entries and the deleted objects of the database.
+     * Entries are covered by their group and modification time, references to
+     * entries outside the share by their resolved values.
+     */
+    QByteArray exportDigest(const KeeShareSettings::Reference& reference,
+                            const KeeShareSettings::Own& own,
+                            const Group* group)
+    {
+        CryptoHash hash(CryptoHash::Sha256);
+        addToDigest(hash, QString::number(reference.type));
+        addToDigest(hash, reference.path);
+        addToDigest(hash, reference.password);
+        hash.addData(own.certificate.key);
+
+        for (const Group* child : group->groupsRecursive(true)) {
+            addToDigest(hash, child->uuidToHex());
+            addToDigest(hash, child == group ? QString() : child->parentGroup()->uuidToHex());
+            addToDigest(hash, child->name());
+            addToDigest(hash, child->notes());
+            addToDigest(hash, QString::number(child->iconNumber()));
+            addToDigest(hash, child->iconUuid().toString());
+        }
+
+        for (const Entry* entry : group->entriesRecursive(false)) {
+            addToDigest(hash, entry->uuidToHex());
+            addToDigest(hash, entry->group()->uuidToHex());
+            addToDigest(hash, QString::number(entry->timeInfo().lastModificationTime().toMSecsSinceEpoch()));
+            addToDigest(hash, QString::number(entry->historyItemCount()));
+            if (entry->hasReferences()) {
+                for (const auto& attribute : EntryAttributes::DefaultAttributes) {
+                    addToDigest(hash, entry->resolveMultiplePlaceholders(entry->attributes()->value(attribute)));
+                }
+            }
+        }
+
+        for (const auto& object : group->database()->deletedObjects()) {
+            addToDigest(hash, object.uuid.toString());
+            addToDigest(hash, QString::number(object.deletionTime.toMSecsSinceEpoch()));
+        }
+
+        return hash.result();
+    }
+
+    QDateTime fileModified(const QString& path)
+    {
+        const QFileInfo info(path);
+        return info.exists() ? info.lastModified() : QDateTime();
+    }
 } // End Namespace
 
 ShareObserver::ShareObserver(QSharedPointer<Database> db, QObject* parent)
@@ -62,6 +124,7 @@ void ShareObserver::deinitialize()
     m_groupToReference.clear();
     m_shareToGroup.clear();
     m_fileWatchers.clear();
+    m_importDigests.clear();
 }
 
 void ShareObserver::reinitialize()
@@ -78,11 +141,13 @@ void ShareObserver::reinitialize()
         m_groupToReference.remove(group);
         m_shareToGroup.remove(oldResolvedPath);
         m_fileWatchers.remove(oldResolvedPath);
+        m_importDigests.remove(oldResolvedPath);
 
         if (newReference.isValid()) {
             m_groupToReference[group] = newReference;
             const auto newResolvedPath = resolvePath(newReference.path, m_db);
             m_shareToGroup[newResolvedPath] = group;
+            m_importDigests.remove(newResolvedPath);
         }
 
         shares.append({group, newReference});
@@ -186,7 +251,46 @@ void ShareObserver::handleDatabaseChanged()
 
 void ShareObserver::handleFileUpdated(const QString& path)
 {
-    const Result result = importShare(path);
+    KeeShareSettings::Reference reference;
+    if (!importTarget(path, reference)) {
+        return;
+    }
+
+    const auto resolvedPath = resolvePath(reference.path, m_db);
+    if (m_runningImports.contains(resolvedPath)) {
+        m_pendingImports.insert(resolvedPath);
+        return;
+    }
+    m_runningImports.insert(resolvedPath);
+
+    // reading the container runs the KDF and verifies the signature, keep that off the GUI thread
+    const auto knownDigest = m_importDigests.value(resolvedPath);
+    AsyncTask::runThenCallback(
+        AsyncTask::Executor::Background,
+        [=] { return ShareImport::readContainer(resolvedPath, reference, knownDigest); },
+        this,
+        [=](const ShareImport::Container& container) {
+            m_runningImports.remove(resolvedPath);
+
+            // the share may have been reconfigured or removed in the meantime
+            KeeShareSettings::Reference currentReference;
+            auto* shareGroup = importTarget(path, currentReference);
+            if (shareGroup && currentReference == reference) {
+                const Result result = ShareImport::applyContainer(container, reference, shareGroup);
+                if (!container.unchanged) {
+                    rememberImport(resolvedPath, container.digest, result);
+                }
+                notifyAboutImport(result);
+            }
+
+            if (m_pendingImports.remove(resolvedPath)) {
+                handleFileUpdated(path);
+            }
+        });
+}
+
+void ShareObserver::notifyAboutImport(const Result& result)
+{
     if (!result.isValid()) {
         return;
     }
@@ -207,29 +311,62 @@ void ShareObserver::handleFileUpdated(const QString& path)
 
 ShareObserver::Result ShareObserver::importShare(const QString& path)
 {
-    if (!KeeShare::active().in) {
+    KeeShareSettings::Reference reference;
+    auto* shareGroup = importTarget(path, reference);
+    if (!shareGroup) {
         return {};
     }
+
+    const auto resolvedPath = resolvePath(reference.path, m_db);
+    const auto container = ShareImport::readContainer(resolvedPath, reference, m_importDigests.value(resolvedPath));
+    const Result result = ShareImport::applyContainer(container, reference, shareGroup);
+    if (!container.unchanged) {
+        rememberImport(resolvedPath, container.digest, result);
+    }
+    return result;
+}
+
+/**
+ * Find the group a share file is imported into.
+ *
+ * @param path path of the share file
+ * @param reference receives the share reference of the group
+ * @return the group, or nullptr if the file is not imported
+ */
+Group* ShareObserver::importTarget(const QString& path, KeeShareSettings::Reference& reference) const
+{
+    if (!KeeShare::active().in) {
+        return nullptr;
+    }
     const auto changePath = resolvePath(path, m_db);
     auto shareGroup = m_shareToGroup.value(changePath);
     if (!shareGroup) {
         qWarning("Group for %s does not exist", qPrintable(path));
-        return {};
+        return nullptr;
     }
-    const auto reference = KeeShare::referenceOf(shareGroup);
+    reference = KeeShare::referenceOf(shareGroup);
     if (reference.type == KeeShareSettings::Inactive) {
         // changes of inactive references are ignored
-        return {};
+        return nullptr;
     }
     if (reference.type == KeeShareSettings::ExportTo) {
         // changes of export only references are ignored
-        return {};
+        return nullptr;
     }
 
     Q_ASSERT(shareGroup->database() == m_db);
     Q_ASSERT(shareGroup == m_db->rootGroup()->findGroupByUuid(shareGroup->uuid()));
-    const auto resolvedPath = resolvePath(reference.path, m_db);
-    return ShareImport::containerInto(resolvedPath, reference, shareGroup);
+    return shareGroup;
+}
+
+void ShareObserver::rememberImport(const QString& resolvedPath, const QByteArray& digest, const Result& result)
+{
+    if (digest.isEmpty() || result.isError() || result.isWarning()) {
+        // failed imports are retried on the next change
+        m_importDigests.remove(resolvedPath);
+    } else {
+        m_importDigests[resolvedPath] = digest;
+    }
 }
 
 QSharedPointer<Database> ShareObserver::database()
@@ -237,8 +374,14 @@ QSharedPointer<Database> ShareObserver::database()
     return m_db;
 }
 
-QList<ShareObserver::Result> ShareObserver::exportShares()
+void ShareObserver::exportShares()
 {
+    if (m_runningExports > 0) {
+        // never write a container twice at once, export again once the running exports are done
+        m_exportRequested = true;
+        return;
+    }
+
     QList<Result> results;
     struct Reference
     {
@@ -269,24 +412,65 @@ QList<ShareObserver::Result> ShareObserver::exportShares()
     }
     if (!results.isEmpty()) {
         // We need to block export due to config
-        return results;
+        notifyAboutExports(results);
+        return;
     }
 
+    const auto own = KeeShare::own();
     for (auto it = references.cbegin(); it != references.cend(); ++it) {
         const auto& reference = it.value().first();
         const QString resolvedPath = resolvePath(reference.config.path, m_db);
+
+        const QByteArray digest = exportDigest(reference.config, own, reference.group);
+        const auto state = m_exportStates.value(resolvedPath);
+        if (state.digest == digest && !state.fileModified.isNull() && state.fileModified == fileModified(resolvedPath)) {
+            // nothing in the share changed since it was last written
+            continue;
+        }
+
         auto watcher = m_fileWatchers.value(resolvedPath);
         if (watcher) {
             watcher->stop();
         }
 
-        results << ShareExport::intoContainer(resolvedPath, reference.config, reference.group);
+        // copy the share on this thread, the key derivation and writing happen on a worker
+        const auto targetDb = ShareExport::prepareDatabase(reference.group);
+        const auto config = reference.config;
+        ++m_runningExports;
+        AsyncTask::runThenCallback(
+            AsyncTask::Executor::Background,
+            [=] { return ShareExport::writeContainer(resolvedPath, config, own, targetDb); },
+            this,
+            [=](const Result& result) { finishExport(resolvedPath, digest, result); });
+    }
+}
 
-        if (watcher) {
-            watcher->start(resolvedPath, FileWatchPeriod, FileWatchSize);
-        }
+void ShareObserver::finishExport(const QString& resolvedPath, const QByteArray& digest, const Result& result)
+{
+    if (result.isError() || result.isWarning()) {
+        m_exportStates.remove(resolvedPath);
+    } else {
+        m_exportStates[resolvedPath] = {digest, fileModified(resolvedPath)};
+    }
+
+    auto watcher = m_fileWatchers.value(resolvedPath);
+    if (watcher) {
+        watcher->start(resolvedPath, FileWatchPeriod, FileWatchSize);
+    }
+
+    m_exportResults << result;
+    if (--m_runningExports > 0) {
+        return;
+    }
+
+    const auto results = m_exportResults;
+    m_exportResults.clear();
+    notifyAboutExports(results);
+
+    if (m_exportRequested) {
+        m_exportRequested = false;
+        exportShares();
     }
-    return results;
 }
 
 void ShareObserver::handleDatabaseSaved()
@@ -294,11 +478,15 @@ void ShareObserver::handleDatabaseSaved()
     if (!KeeShare::active().out) {
         return;
     }
+    exportShares();
+}
+
+void ShareObserver::notifyAboutExports(const QList<Result>& results)
+{
     QStringList error;
     QStringList warning;
     QStringList success;
 
-    const auto results = exportShares();
     for (const Result& result : results) {
         if (!result.isValid()) {
             Q_ASSERT(result.isValid());
@@ -18,8 +18,11 @@
 #ifndef KEEPASSXC_SHAREOBSERVER_H
 #define KEEPASSXC_SHAREOBSERVER_H
 
+#include <QDateTime>
+#include <QHash>
 #include <QMap>
 #include <QObject>
+#include <QSet>
 #include <QSharedPointer>
 #include <QStringList>
 
@@ -72,7 +75,12 @@ private slots:
 
 private:
     Result importShare(const QString& path);
-    QList<Result> exportShares();
+    Group* importTarget(const QString& path, KeeShareSettings::Reference& reference) const;
+    void rememberImport(const QString& resolvedPath, const QByteArray& digest, const Result& result);
+    void notifyAboutImport(const Result& result);
+    void exportShares();
+    void finishExport(const QString& resolvedPath, const QByteArray& digest, const Result& result);
+    void notifyAboutExports(const QList<Result>& results);
 
     void deinitialize();
     void reinitialize();
@@ -83,6 +91,22 @@ private:
     QMap<QPointer<Group>, KeeShareSettings::Reference> m_groupToReference;
     QMap<QString, QPointer<Group>> m_shareToGroup;
     QMap<QString, QSharedPointer<FileWatcher>> m_fileWatchers;
+
+    // content digest of each export target when it was last written, to skip unchanged shares
+    struct ExportState
+    {
+        QByteArray digest;
+        QDateTime fileModified;
+    };
+    QHash<QString, ExportState> m_exportStates;
+
+    // digest of each share container when it was last imported, to skip unchanged files
+    QHash<QString, QByteArray> m_importDigests;
+    QSet<QString> m_runningImports;
+    QSet<QString> m_pendingImports;
+    QList<Result> m_exportResults;
+    int m_runningExports = 0;
+    bool m_exportRequested = false;
 };
 
 #endif // KEEPASSXC_SHAREOBSERVER_H
@@ -22,8 +22,62 @@
 #include "crypto/ssh/OpenSSHKey.h"
 
 #include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QSharedPointer>
 #include <gcrypt.h>
 
+namespace
+{
+    constexpr int MaxCachedKeys = 32;
+    constexpr int MaxCachedVerifications = 256;
+
+    /**
+     * Public keys parsed for verification and signatures that verified successfully,
+     * so that polling an unchanged share does not verify the same signature again.
+     * Shared by the threads reading share containers.
+     */
+    class VerificationCache
+    {
+    public:
+        QSharedPointer<gcry_sexp> publicKey(const QByteArray& keyId)
+        {
+            QMutexLocker locker(&m_mutex);
+            const auto* key = m_keys.object(keyId);
+            return key ? *key : QSharedPointer<gcry_sexp>();
+        }
+
+        void insertPublicKey(const QByteArray& keyId, const QSharedPointer<gcry_sexp>& key)
+        {
+            QMutexLocker locker(&m_mutex);
+            m_keys.insert(keyId, new QSharedPointer<gcry_sexp>(key));
+        }
+
+        bool isVerified(const QByteArray& verificationId)
+        {
+            QMutexLocker locker(&m_mutex);
+            return m_verified.contains(verificationId);
+        }
+
+        void insertVerified(const QByteArray& verificationId)
+        {
+            QMutexLocker locker(&m_mutex);
+            m_verified.insert(verificationId, new bool(true));
+        }
+
+    private:
+        QMutex m_mutex;
+        QCache<QByteArray, QSharedPointer<gcry_sexp>> m_keys{MaxCachedKeys};
+        QCache<QByteArray, bool> m_verified{MaxCachedVerifications};
+    };
+
+    VerificationCache& verificationCache()
+    {
+        static VerificationCache cache;
+        return cache;
+    }
+} // namespace
+
 struct RSASigner
 {
     gcry_error_t rc;
@@ -163,7 +217,6 @@ struct RSASigner
         enum SEXP
         {
             Data,
-            Key,
             Sig
         };
 
@@ -175,23 +228,36 @@ struct RSASigner
 
         const QByteArray block = CryptoHash::hash(data, CryptoHash::Sha256);
 
+        const QByteArray keyId =
+            CryptoHash::hash(QByteArray::number(parts[0].size()) + ':' + parts[0] + parts[1], CryptoHash::Sha256);
+        const QByteArray verificationId = keyId + block + signature.toLatin1();
+        if (verificationCache().isVerified(verificationId)) {
+            return true;
+        }
+
         Tools::Map<MPI, gcry_mpi_t, &gcry_mpi_release> mpi;
         Tools::Map<SEXP, gcry_sexp_t, &gcry_sexp_release> sexp;
 
-        rc = gcry_mpi_scan(&mpi[E], format, parts[0].data(), parts[0].size(), nullptr);
-        if (rc != GPG_ERR_NO_ERROR) {
-            raiseError();
-            return false;
-        }
-        rc = gcry_mpi_scan(&mpi[N], format, parts[1].data(), parts[1].size(), nullptr);
-        if (rc != GPG_ERR_NO_ERROR) {
-            raiseError();
-            return false;
-        }
-        rc = gcry_sexp_build(&sexp[Key], NULL, "(public-key (rsa (n %m) (e %m)))", mpi[N], mpi[E]);
-        if (rc != GPG_ERR_NO_ERROR) {
-            raiseError();
-            return false;
+        auto publicKey = verificationCache().publicKey(keyId);
+        if (!publicKey) {
+            rc = gcry_mpi_scan(&mpi[E], format, parts[0].data(), parts[0].size(), nullptr);
+            if (rc != GPG_ERR_NO_ERROR) {
+                raiseError();
+                return false;
+            }
+            rc = gcry_mpi_scan(&mpi[N], format, parts[1].data(), parts[1].size(), nullptr);
+            if (rc != GPG_ERR_NO_ERROR) {
+                raiseError();
+                return false;
+            }
+            gcry_sexp_t keySexp = nullptr;
+            rc = gcry_sexp_build(&keySexp, NULL, "(public-key (rsa (n %m) (e %m)))", mpi[N], mpi[E]);
+            if (rc != GPG_ERR_NO_ERROR) {
+                raiseError();
+                return false;
+            }
+            publicKey = QSharedPointer<gcry_sexp>(keySexp, &gcry_sexp_release);
+            verificationCache().insertPublicKey(keyId, publicKey);
         }
 
         QRegExp extractor("rsa\\|([a-f0-9]+)", Qt::CaseInsensitive);
@@ -217,12 +283,16 @@ struct RSASigner
             raiseError();
             return false;
         }
-        rc = gcry_pk_verify(sexp[Sig], sexp[Data], sexp[Key]);
+        rc = gcry_pk_verify(sexp[Sig], sexp[Data], publicKey.data());
         if (rc != GPG_ERR_NO_ERROR && rc != GPG_ERR_BAD_SIGNATURE) {
             raiseError();
             return false;
         }
-        return rc != GPG_ERR_BAD_SIGNATURE;
+        if (rc == GPG_ERR_BAD_SIGNATURE) {
+            return false;
+        }
+        verificationCache().insertVerified(verificationId);
+        return true;
     }
 };
 
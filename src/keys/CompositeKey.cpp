@@ -22,13 +22,16 @@
 #include <format/KeePass2.h>
 
 #include "core/Global.h"
+#include "core/Trace.h"
 #include "crypto/CryptoHash.h"
 #include "crypto/kdf/AesKdf.h"
+#include "keys/TransformedKeyCache.h"
 
 QUuid CompositeKey::UUID("76a7ae25-a542-4add-9849-7c06be945b94");
 
 CompositeKey::CompositeKey()
     : Key(UUID)
+    , m_transformCache(nullptr)
 {
 }
 
@@ -106,21 +109,42 @@ QByteArray CompositeKey::rawKey(const QByteArray* transformSeed, bool* ok, QStri
  * challenge response key components after key transformation.
  * KDBX4+ KDFs transform the whole key including challenge-response components.
  *
+ * If quick unlock is enabled, the result is taken from and stored in the
+ * TransformedKeyCache so the KDF only runs once for the same key and parameters.
+ * A different cache can be chosen with setTransformCache().
+ *
  * @param kdf key derivation function
  * @param result transformed key hash
  * @return true on success
  */
 bool CompositeKey::transform(const Kdf& kdf, QByteArray& result, QString* error) const
 {
+    QByteArray key;
     if (kdf.uuid() == KeePass2::KDF_AES_KDBX3) {
         // legacy KDBX3 AES-KDF, challenge response is added later to the hash
-        return kdf.transform(rawKey(), result);
+        key = rawKey();
+    } else {
+        QByteArray seed = kdf.seed();
+        Q_ASSERT(!seed.isEmpty());
+        bool ok = false;
+        key = rawKey(&seed, &ok, error);
+        if (!ok) {
+            return false;
+        }
     }
 
-    QByteArray seed = kdf.seed();
-    Q_ASSERT(!seed.isEmpty());
-    bool ok = false;
-    return kdf.transform(rawKey(&seed, &ok, error), result) && ok;
+    auto cache = m_transformCache ? m_transformCache : TransformedKeyCache::instance();
+    if (cache->lookup(kdf, key, result)) {
+        return true;
+    }
+    {
+        TRACE_SCOPE("Kdf::transform");
+        if (!kdf.transform(key, result)) {
+            return false;
+        }
+    }
+    cache->insert(kdf, key, result);
+    return true;
 }
 
 bool CompositeKey::challenge(const QByteArray& seed, QByteArray& result, QString* error) const
@@ -188,3 +212,13 @@ const QList<QSharedPointer<ChallengeResponseKey>>& CompositeKey::challengeRespon
 {
     return m_challengeResponseKeys;
 }
+
+/**
+ * Use the given cache for transformed keys instead of the quick unlock cache.
+ *
+ * @param cache cache to use, nullptr for the quick unlock cache
+ */
+void CompositeKey::setTransformCache(TransformedKeyCache* cache)
+{
+    m_transformCache = cache;
+}
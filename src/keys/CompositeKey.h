@@ -27,6 +27,8 @@
 #include "keys/ChallengeResponseKey.h"
 #include "keys/Key.h"
 
+class TransformedKeyCache;
+
 class CompositeKey : public Key
 {
 public:
@@ -48,11 +50,14 @@ public:
     void addChallengeResponseKey(const QSharedPointer<ChallengeResponseKey>& key);
     const QList<QSharedPointer<ChallengeResponseKey>>& challengeResponseKeys() const;
 
+    void setTransformCache(TransformedKeyCache* cache);
+
 private:
     QByteArray rawKey(const QByteArray* transformSeed, bool* ok = nullptr, QString* error = nullptr) const;
 
     QList<QSharedPointer<Key>> m_keys;
     QList<QSharedPointer<ChallengeResponseKey>> m_challengeResponseKeys;
+    TransformedKeyCache* m_transformCache;
 };
 
 #endif // KEEPASSX_COMPOSITEKEY_H
@@ -18,31 +18,83 @@
 
 #include "FileKey.h"
 
+#include "core/SecureArena.h"
 #include "core/Tools.h"
 #include "crypto/CryptoHash.h"
 #include "crypto/Random.h"
 
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
 
 #include <algorithm>
+#include <cctype>
 #include <cstring>
-#include <gcrypt.h>
 #include <sodium.h>
 
 QUuid FileKey::UUID("a584cbc4-c9b4-437e-81bb-362ca9709273");
 
 constexpr int FileKey::SHA256_SIZE;
 
+namespace
+{
+    // key files at least this large are remembered for the session
+    constexpr qint64 MinCachedFileSize = 1024 * 1024;
+    // chunk size in which hashed key files are read
+    constexpr int HashChunkSize = 1024 * 1024;
+    // bytes inspected to tell XML key files from other files
+    constexpr qint64 HeaderSize = 64;
+
+    /**
+     * Key of a large key file, valid as long as the file keeps its size
+     * and modification time.
+     */
+    struct CachedFileKey
+    {
+        qint64 size;
+        qint64 lastModified;
+        FileKey::Type type;
+        char* key;
+    };
+
+    QMutex s_cacheMutex;
+    QHash<QString, CachedFileKey> s_cache;
+
+    void releaseCachedKey(CachedFileKey& cached, int size)
+    {
+        SecureArena::instance()->deallocate(cached.key, static_cast<std::size_t>(size));
+        cached.key = nullptr;
+    }
+
+    /**
+     * Check whether the header may start a KeePass 2 XML key file, i.e.
+     * its first character after an optional byte order mark and white
+     * space opens a tag.
+     */
+    bool mayBeXml(const QByteArray& header)
+    {
+        const auto bom = QByteArrayLiteral("\xEF\xBB\xBF");
+        int pos = header.startsWith(bom) ? bom.size() : 0;
+        while (pos < header.size() && std::isspace(static_cast<unsigned char>(header.at(pos)))) {
+            ++pos;
+        }
+        // only white space in the header, let the parser decide
+        return pos == header.size() || header.at(pos) == '<';
+    }
+} // namespace
+
 FileKey::FileKey()
     : Key(UUID)
-    , m_key(static_cast<char*>(gcry_malloc_secure(SHA256_SIZE)))
+    , m_key(static_cast<char*>(SecureArena::instance()->allocate(SHA256_SIZE)))
 {
 }
 
 FileKey::~FileKey()
 {
     if (m_key) {
-        gcry_free(m_key);
+        SecureArena::instance()->deallocate(m_key, SHA256_SIZE);
         m_key = nullptr;
     }
 }
@@ -75,33 +127,46 @@ bool FileKey::load(QIODevice* device)
         return false;
     }
 
-    if (device->size() == 0) {
+    const qint64 size = device->size();
+    if (size == 0) {
         return false;
     }
 
-    // try different legacy key file formats
+    // classify the file from its header, so large files are only read once for hashing
     if (!device->reset()) {
         return false;
     }
-    if (loadXml(device)) {
-        m_type = KeePass2XML;
-        return true;
-    }
+    const bool xmlCandidate = mayBeXml(device->peek(HeaderSize));
 
-    if (!device->reset()) {
-        return false;
-    }
-    if (loadBinary(device)) {
-        m_type = FixedBinary;
-        return true;
+    // try different legacy key file formats
+    if (xmlCandidate) {
+        if (!device->reset()) {
+            return false;
+        }
+        if (loadXml(device)) {
+            m_type = KeePass2XML;
+            return true;
+        }
     }
 
-    if (!device->reset()) {
-        return false;
+    if (size == 32) {
+        if (!device->reset()) {
+            return false;
+        }
+        if (loadBinary(device)) {
+            m_type = FixedBinary;
+            return true;
+        }
     }
-    if (loadHex(device)) {
-        m_type = FixedBinaryHex;
-        return true;
+
+    if (size == 64) {
+        if (!device->reset()) {
+            return false;
+        }
+        if (loadHex(device)) {
+            m_type = FixedBinaryHex;
+            return true;
+        }
     }
 
     // if no legacy format was detected, generate SHA-256 hash of key file
@@ -132,12 +197,34 @@ bool FileKey::load(QIODevice* device)
  * Usage of legacy formats is discouraged and support for them may be
  * removed in a future version.
  *
+ * The key of a large file is remembered for the session as long as the
+ * file keeps its size and modification time, so unlocking again does not
+ * read it once more.
+ *
  * @param fileName input file name
  * @param errorMsg error message if loading failed
  * @return true if key file was loaded successfully
  */
 bool FileKey::load(const QString& fileName, QString* errorMsg)
 {
+    QFileInfo fileInfo(fileName);
+    const QString cachePath = fileInfo.canonicalFilePath();
+    const bool cacheable = !cachePath.isEmpty() && fileInfo.size() >= MinCachedFileSize;
+    const qint64 lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    if (cacheable) {
+        QMutexLocker locker(&s_cacheMutex);
+        auto it = s_cache.find(cachePath);
+        if (it != s_cache.end()) {
+            if (it->size == fileInfo.size() && it->lastModified == lastModified) {
+                std::memcpy(m_key, it->key, SHA256_SIZE);
+                m_type = it->type;
+                return true;
+            }
+            releaseCachedKey(*it, SHA256_SIZE);
+            s_cache.erase(it);
+        }
+    }
+
     QFile file(fileName);
     if (!file.open(QFile::ReadOnly)) {
         if (errorMsg) {
@@ -156,9 +243,34 @@ bool FileKey::load(const QString& fileName, QString* errorMsg)
         }
     }
 
+    if (result && cacheable) {
+        auto* key = static_cast<char*>(SecureArena::instance()->allocate(SHA256_SIZE));
+        if (key) {
+            std::memcpy(key, m_key, SHA256_SIZE);
+            QMutexLocker locker(&s_cacheMutex);
+            auto it = s_cache.find(cachePath);
+            if (it != s_cache.end()) {
+                releaseCachedKey(*it, SHA256_SIZE);
+            }
+            s_cache.insert(cachePath, {fileInfo.size(), lastModified, m_type, key});
+        }
+    }
+
     return result;
 }
 
+/**
+ * Forget the keys of all key files remembered by load().
+ */
+void FileKey::clearCache()
+{
+    QMutexLocker locker(&s_cacheMutex);
+    for (auto it = s_cache.begin(); it != s_cache.end(); ++it) {
+        releaseCachedKey(*it, SHA256_SIZE);
+    }
+    s_cache.clear();
+}
+
 /**
  * @return key data as bytes
  */
@@ -367,13 +479,16 @@ bool FileKey::loadHashed(QIODevice* device)
 {
     CryptoHash cryptoHash(CryptoHash::Sha256);
 
-    QByteArray buffer;
-    do {
-        if (!Tools::readFromDevice(device, buffer)) {
-            return false;
-        }
-        cryptoHash.addData(buffer);
-    } while (!buffer.isEmpty());
+    // one buffer for all chunks, wiped once the file has been hashed
+    QByteArray buffer(HashChunkSize, Qt::Uninitialized);
+    qint64 readBytes;
+    while ((readBytes = device->read(buffer.data(), buffer.size())) > 0) {
+        cryptoHash.addData(QByteArray::fromRawData(buffer.constData(), static_cast<int>(readBytes)));
+    }
+    SecureArena::wipe(buffer);
+    if (readBytes < 0) {
+        return false;
+    }
 
     auto result = cryptoHash.result();
     std::memcpy(m_key, result.data(), std::min(SHA256_SIZE, result.size()));
@@ -47,6 +47,7 @@ public:
     Type type() const;
     static void create(QIODevice* device, int size = 128);
     static bool create(const QString& fileName, QString* errorMsg = nullptr, int size = 128);
+    static void clearCache();
 
 private:
     static constexpr int SHA256_SIZE = 32;
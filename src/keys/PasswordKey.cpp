@@ -16,12 +16,12 @@
  */
 
 #include "PasswordKey.h"
+#include "core/SecureArena.h"
 #include "core/Tools.h"
 
 #include "crypto/CryptoHash.h"
 #include <algorithm>
 #include <cstring>
-#include <gcrypt.h>
 
 QUuid PasswordKey::UUID("77e90411-303a-43f2-b773-853b05635ead");
 
@@ -29,13 +29,13 @@ constexpr int PasswordKey::SHA256_SIZE;
 
 PasswordKey::PasswordKey()
     : Key(UUID)
-    , m_key(static_cast<char*>(gcry_malloc_secure(SHA256_SIZE)))
+    , m_key(static_cast<char*>(SecureArena::instance()->allocate(SHA256_SIZE)))
 {
 }
 
 PasswordKey::PasswordKey(const QString& password)
     : Key(UUID)
-    , m_key(static_cast<char*>(gcry_malloc_secure(SHA256_SIZE)))
+    , m_key(static_cast<char*>(SecureArena::instance()->allocate(SHA256_SIZE)))
 {
     setPassword(password);
 }
@@ -43,7 +43,7 @@ PasswordKey::PasswordKey(const QString& password)
 PasswordKey::~PasswordKey()
 {
     if (m_key) {
-        gcry_free(m_key);
+        SecureArena::instance()->deallocate(m_key, SHA256_SIZE);
         m_key = nullptr;
     }
 }
@@ -0,0 +1,274 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TransformedKeyCache.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QTimer>
+
+#include "core/Clock.h"
+#include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
+#include "crypto/SymmetricCipher.h"
+#include "crypto/kdf/Kdf.h"
+
+namespace
+{
+    // upper bound for the number of cached keys, oldest entries are evicted first
+    constexpr int MaxCachedKeys = 16;
+    constexpr int DefaultTimeout = 30 * 60 * 1000;
+    constexpr int ExpiryCheckInterval = 30 * 1000;
+    constexpr int ShareTimeout = 8 * 60 * 60 * 1000;
+} // namespace
+
+TransformedKeyCache* TransformedKeyCache::m_instance(nullptr);
+TransformedKeyCache* TransformedKeyCache::m_shareInstance(nullptr);
+
+TransformedKeyCache::TransformedKeyCache(QObject* parent)
+    : QObject(parent)
+    , m_timeout(DefaultTimeout)
+    , m_expiryTimer(new QTimer(this))
+{
+    m_expiryTimer->setInterval(ExpiryCheckInterval);
+    connect(m_expiryTimer, SIGNAL(timeout()), SLOT(removeExpired()));
+}
+
+/**
+ * The instance always lives on the application thread, even if
+ * it is first requested by a thread running the KDF.
+ */
+TransformedKeyCache* TransformedKeyCache::instance()
+{
+    static QMutex instanceMutex;
+    QMutexLocker locker(&instanceMutex);
+
+    if (!m_instance) {
+        m_instance = createInstance();
+    }
+
+    return m_instance;
+}
+
+/**
+ * Cache for the keys of KeeShare containers. Unlike the quick unlock cache it
+ * is always enabled, so importing a container again or exporting with the
+ * same transform seed does not run the KDF for the same password twice.
+ */
+TransformedKeyCache* TransformedKeyCache::shareInstance()
+{
+    static QMutex instanceMutex;
+    QMutexLocker locker(&instanceMutex);
+
+    if (!m_shareInstance) {
+        m_shareInstance = createInstance();
+        m_shareInstance->setTimeout(ShareTimeout);
+        m_shareInstance->setEnabled(true);
+    }
+
+    return m_shareInstance;
+}
+
+TransformedKeyCache* TransformedKeyCache::createInstance()
+{
+    auto cache = new TransformedKeyCache();
+    if (qApp) {
+        cache->moveToThread(qApp->thread());
+        cache->setParent(qApp);
+    }
+    return cache;
+}
+
+bool TransformedKeyCache::isEnabled() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_enabled;
+}
+
+/**
+ * Enable or disable the cache. Disabling it wipes all cached keys.
+ *
+ * @param enabled true to cache transformed keys
+ */
+void TransformedKeyCache::setEnabled(bool enabled)
+{
+    QMutexLocker locker(&m_mutex);
+    m_enabled = enabled;
+    if (!m_enabled) {
+        clearLocked();
+    }
+    QMetaObject::invokeMethod(m_expiryTimer, m_enabled ? "start" : "stop");
+}
+
+/**
+ * @return time in milliseconds after which cached keys expire
+ */
+int TransformedKeyCache::timeout() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_timeout;
+}
+
+/**
+ * Set the time after which newly cached keys expire.
+ *
+ * @param msec timeout in milliseconds
+ */
+void TransformedKeyCache::setTimeout(int msec)
+{
+    QMutexLocker locker(&m_mutex);
+    m_timeout = msec > 0 ? msec : DefaultTimeout;
+}
+
+bool TransformedKeyCache::isEmpty() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_keys.isEmpty();
+}
+
+/**
+ * Look up the transformed key for the given KDF and raw key.
+ *
+ * @param kdf key derivation function including its seed
+ * @param rawKey raw key which is passed to the KDF
+ * @param transformedKey receives the transformed key
+ * @return true if a valid cached key was found
+ */
+bool TransformedKeyCache::lookup(const Kdf& kdf, const QByteArray& rawKey, QByteArray& transformedKey)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_enabled || m_keys.isEmpty()) {
+        return false;
+    }
+
+    const QByteArray id = cacheId(kdf, rawKey);
+    auto it = m_keys.constFind(id);
+    if (it == m_keys.constEnd()) {
+        return false;
+    }
+    if (it->expires <= Clock::currentMilliSecondsSinceEpoch()) {
+        m_keys.remove(id);
+        m_insertionOrder.removeOne(id);
+        return false;
+    }
+
+    transformedKey = crypt(it->encryptedKey, it->iv, false);
+    return !transformedKey.isEmpty();
+}
+
+/**
+ * Cache a transformed key. Does nothing unless the cache is enabled.
+ *
+ * @param kdf key derivation function including its seed
+ * @param rawKey raw key which was passed to the KDF
+ * @param transformedKey result of the KDF
+ */
+void TransformedKeyCache::insert(const Kdf& kdf, const QByteArray& rawKey, const QByteArray& transformedKey)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_enabled || transformedKey.isEmpty()) {
+        return;
+    }
+
+    if (m_ephemeralKey.isEmpty()) {
+        m_ephemeralKey = randomGen()->randomArray(32);
+    }
+
+    CachedKey cachedKey;
+    cachedKey.iv = randomGen()->randomArray(SymmetricCipher::algorithmIvSize(SymmetricCipher::Aes256));
+    cachedKey.encryptedKey = crypt(transformedKey, cachedKey.iv, true);
+    cachedKey.expires = Clock::currentMilliSecondsSinceEpoch() + m_timeout;
+    if (cachedKey.encryptedKey.isEmpty()) {
+        return;
+    }
+
+    const QByteArray id = cacheId(kdf, rawKey);
+    m_insertionOrder.removeOne(id);
+    m_insertionOrder.append(id);
+    m_keys.insert(id, cachedKey);
+
+    while (m_insertionOrder.size() > MaxCachedKeys) {
+        m_keys.remove(m_insertionOrder.takeFirst());
+    }
+}
+
+/**
+ * Wipe all cached keys and the ephemeral encryption key.
+ */
+void TransformedKeyCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    clearLocked();
+}
+
+void TransformedKeyCache::removeExpired()
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = Clock::currentMilliSecondsSinceEpoch();
+    for (auto it = m_keys.begin(); it != m_keys.end();) {
+        if (it->expires <= now) {
+            m_insertionOrder.removeOne(it.key());
+            it = m_keys.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (m_keys.isEmpty()) {
+        clearLocked();
+    }
+}
+
+QByteArray TransformedKeyCache::cacheId(const Kdf& kdf, const QByteArray& rawKey) const
+{
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream << kdf.uuid() << kdf.clone()->writeParameters() << rawKey;
+    }
+
+    // the raw key must not be recoverable from the id, so use a keyed hash
+    Q_ASSERT(!m_ephemeralKey.isEmpty());
+    return CryptoHash::hmac(data, m_ephemeralKey, CryptoHash::Sha256);
+}
+
+QByteArray TransformedKeyCache::crypt(const QByteArray& data, const QByteArray& iv, bool encrypt) const
+{
+    SymmetricCipher cipher(SymmetricCipher::Aes256,
+                           SymmetricCipher::Ctr,
+                           encrypt ? SymmetricCipher::Encrypt : SymmetricCipher::Decrypt);
+    if (!cipher.init(m_ephemeralKey, iv)) {
+        return {};
+    }
+
+    bool ok = false;
+    QByteArray result = cipher.process(data, &ok);
+    return ok ? result : QByteArray();
+}
+
+void TransformedKeyCache::clearLocked()
+{
+    for (auto& cachedKey : m_keys) {
+        cachedKey.encryptedKey.fill('\0');
+    }
+    m_keys.clear();
+    m_insertionOrder.clear();
+
+    // a new ephemeral key invalidates anything that may still linger in memory
+    m_ephemeralKey.fill('\0');
+    m_ephemeralKey.clear();
+}
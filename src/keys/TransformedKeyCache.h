@@ -0,0 +1,91 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TRANSFORMEDKEYCACHE_H
+#define KEEPASSXC_TRANSFORMEDKEYCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+
+class Kdf;
+class QTimer;
+
+/**
+ * Opt-in, process-wide cache of transformed database keys which allows
+ * re-unlocking a database without running the KDF again.
+ *
+ * Entries are looked up by an HMAC of the KDF parameters and the raw
+ * (untransformed) key, so a cached key is only ever returned for the exact
+ * same credentials and KDF settings. The transformed keys are stored encrypted
+ * with an ephemeral key that is generated for every process and never leaves
+ * memory. Entries expire after a configurable time, the whole cache is wiped
+ * when it is disabled or clear() is called.
+ *
+ * The cache is accessed from the threads running the KDF and is thread-safe.
+ */
+class TransformedKeyCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static TransformedKeyCache* instance();
+    static TransformedKeyCache* shareInstance();
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+    int timeout() const;
+    void setTimeout(int msec);
+    bool isEmpty() const;
+
+    bool lookup(const Kdf& kdf, const QByteArray& rawKey, QByteArray& transformedKey);
+    void insert(const Kdf& kdf, const QByteArray& rawKey, const QByteArray& transformedKey);
+
+public slots:
+    void clear();
+
+private slots:
+    void removeExpired();
+
+private:
+    explicit TransformedKeyCache(QObject* parent = nullptr);
+
+    struct CachedKey
+    {
+        QByteArray iv;
+        QByteArray encryptedKey;
+        qint64 expires;
+    };
+
+    static TransformedKeyCache* createInstance();
+    QByteArray cacheId(const Kdf& kdf, const QByteArray& rawKey) const;
+    QByteArray crypt(const QByteArray& data, const QByteArray& iv, bool encrypt) const;
+    void clearLocked();
+
+    static TransformedKeyCache* m_instance;
+    static TransformedKeyCache* m_shareInstance;
+
+    mutable QMutex m_mutex;
+    bool m_enabled = false;
+    int m_timeout;
+    QByteArray m_ephemeralKey;
+    QHash<QByteArray, CachedKey> m_keys;
+    QList<QByteArray> m_insertionOrder;
+    QTimer* m_expiryTimer;
+};
+
+#endif // KEEPASSXC_TRANSFORMEDKEYCACHE_H
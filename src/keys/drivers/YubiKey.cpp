@@ -98,6 +98,27 @@ namespace
         }
         return nullptr;
     }
+
+    /**
+     * Enumerate the serial numbers of all connected keys without
+     * issuing any test challenges, which is fast enough to be done
+     * every time the key list is shown.
+     */
+    QSet<unsigned int> connectedSerials()
+    {
+        QSet<unsigned int> serials;
+        bool onlykey;
+        for (int i = 0, j = 0; i + j < MAX_KEYS;) {
+            auto* yk_key = openKey(i, j, &onlykey);
+            if (!yk_key) {
+                break;
+            }
+            onlykey ? ++j : ++i;
+            serials.insert(getSerial(yk_key));
+            closeKey(yk_key);
+        }
+        return serials;
+    }
 } // namespace
 
 YubiKey::YubiKey()
@@ -152,68 +173,107 @@ void YubiKey::findValidKeys()
             return;
         }
 
-        // Remove all known keys
-        m_foundKeys.clear();
+        detectKeys();
 
-        // Try to detect up to 4 connected hardware keys
-        for (int i = 0, j = 0; i + j < MAX_KEYS;) {
-            bool onlyKey = false;
-            auto yk_key = openKey(i, j, &onlyKey);
-            if (yk_key) {
-                onlyKey ? ++j : ++i;
-                auto vender = onlyKey ? QStringLiteral("OnlyKey") : QStringLiteral("YubiKey");
-                auto serial = getSerial(yk_key);
-                if (serial == 0) {
-                    closeKey(yk_key);
-                    continue;
-                }
+        m_mutex.unlock();
+        emit detectComplete(!m_foundKeys.isEmpty());
+    });
+}
 
-                auto st = ykds_alloc();
-                yk_get_status(yk_key, st);
-                int vid, pid;
-                yk_get_key_vid_pid(yk_key, &vid, &pid);
-
-                bool wouldBlock;
-                QList<QPair<int, QString>> ykSlots;
-                for (int slot = 1; slot <= 2; ++slot) {
-                    auto config = (slot == 1 ? CONFIG1_VALID : CONFIG2_VALID);
-                    if (!(ykds_touch_level(st) & config)) {
-                        // Slot is not configured
-                        continue;
-                    }
-                    // Don't actually challenge a YubiKey Neo or below, they always require button press
-                    // if it is enabled for the slot resulting in failed detection
-                    if (pid <= NEO_OTP_U2F_CCID_PID) {
-                        auto display = tr("%1 [%2] Configured Slot - %3")
-                                           .arg(vender, QString::number(serial), QString::number(slot));
-                        ykSlots.append({slot, display});
-                    } else if (performTestChallenge(yk_key, slot, &wouldBlock)) {
-                        auto display = tr("%1 [%2] Challenge Response - Slot %3 - %4")
-                                           .arg(vender,
-                                                QString::number(serial),
-                                                QString::number(slot),
-                                                wouldBlock ? tr("Press") : tr("Passive"));
-                        ykSlots.append({slot, display});
-                    }
-                }
+/**
+ * Report the keys found by the last detection, which is repeated only if
+ * keys have been plugged in or removed since then. This avoids the latency
+ * of the test challenges whenever the list of keys is needed again.
+ */
+void YubiKey::refreshValidKeys()
+{
+    m_error.clear();
+    if (!isInitialized()) {
+        return;
+    }
 
-                if (!ykSlots.isEmpty()) {
-                    m_foundKeys.insert(serial, ykSlots);
-                }
+    QtConcurrent::run([this] {
+        // Wait for a detection that is still running, e.g. the one issued at startup
+        QMutexLocker locker(&m_mutex);
+
+        auto serials = connectedSerials();
+        if (!m_detected || serials != m_connectedSerials) {
+            detectKeys();
+        }
 
-                ykds_free(st);
+        locker.unlock();
+        emit detectComplete(!m_foundKeys.isEmpty());
+    });
+}
+
+/**
+ * Detect all connected keys and their configured slots.
+ * The mutex must be locked by the caller.
+ */
+void YubiKey::detectKeys()
+{
+    // Remove all known keys
+    m_foundKeys.clear();
+    m_connectedSerials.clear();
+
+    // Try to detect up to 4 connected hardware keys
+    for (int i = 0, j = 0; i + j < MAX_KEYS;) {
+        bool onlyKey = false;
+        auto yk_key = openKey(i, j, &onlyKey);
+        if (yk_key) {
+            onlyKey ? ++j : ++i;
+            auto vender = onlyKey ? QStringLiteral("OnlyKey") : QStringLiteral("YubiKey");
+            auto serial = getSerial(yk_key);
+            m_connectedSerials.insert(serial);
+            if (serial == 0) {
                 closeKey(yk_key);
+                continue;
+            }
 
-                Tools::wait(100);
-            } else {
-                // No more keys are connected
-                break;
+            auto st = ykds_alloc();
+            yk_get_status(yk_key, st);
+            int vid, pid;
+            yk_get_key_vid_pid(yk_key, &vid, &pid);
+
+            bool wouldBlock;
+            QList<QPair<int, QString>> ykSlots;
+            for (int slot = 1; slot <= 2; ++slot) {
+                auto config = (slot == 1 ? CONFIG1_VALID : CONFIG2_VALID);
+                if (!(ykds_touch_level(st) & config)) {
+                    // Slot is not configured
+                    continue;
+                }
+                // Don't actually challenge a YubiKey Neo or below, they always require button press
+                // if it is enabled for the slot resulting in failed detection
+                if (pid <= NEO_OTP_U2F_CCID_PID) {
+                    auto display = tr("%1 [%2] Configured Slot - %3")
+                                       .arg(vender, QString::number(serial), QString::number(slot));
+                    ykSlots.append({slot, display});
+                } else if (performTestChallenge(yk_key, slot, &wouldBlock)) {
+                    auto display = tr("%1 [%2] Challenge Response - Slot %3 - %4")
+                                       .arg(vender,
+                                            QString::number(serial),
+                                            QString::number(slot),
+                                            wouldBlock ? tr("Press") : tr("Passive"));
+                    ykSlots.append({slot, display});
+                }
+            }
+
+            if (!ykSlots.isEmpty()) {
+                m_foundKeys.insert(serial, ykSlots);
             }
+
+            ykds_free(st);
+            closeKey(yk_key);
+
+            Tools::wait(100);
+        } else {
+            // No more keys are connected
+            break;
         }
+    }
 
-        m_mutex.unlock();
-        emit detectComplete(!m_foundKeys.isEmpty());
-    });
+    m_detected = true;
 }
 
 QList<YubiKeySlot> YubiKey::foundKeys()
@@ -299,7 +359,8 @@ YubiKey::ChallengeResult YubiKey::challenge(YubiKeySlot slot, const QByteArray&
 
     auto* yk_key = openKeySerial(slot.first);
     if (!yk_key) {
-        // Key with specified serial number is not connected
+        // Key with specified serial number is not connected, the cached key list is outdated
+        m_detected = false;
         m_error =
             tr("Could not find hardware key with serial number %1. Please plug it in to continue.").arg(slot.first);
         m_mutex.unlock();
@@ -22,6 +22,7 @@
 #include <QHash>
 #include <QMutex>
 #include <QObject>
+#include <QSet>
 #include <QTimer>
 
 typedef QPair<unsigned int, int> YubiKeySlot;
@@ -46,6 +47,7 @@ public:
     bool isInitialized();
 
     void findValidKeys();
+    void refreshValidKeys();
 
     QList<YubiKeySlot> foundKeys();
     QString getDisplayName(YubiKeySlot slot);
@@ -89,8 +91,11 @@ private:
     ChallengeResult
     performChallenge(void* key, int slot, bool mayBlock, const QByteArray& challenge, QByteArray& response);
     bool performTestChallenge(void* key, int slot, bool* wouldBlock);
+    void detectKeys();
 
     QHash<unsigned int, QList<QPair<int, QString>>> m_foundKeys;
+    QSet<unsigned int> m_connectedSerials;
+    bool m_detected = false;
 
     QMutex m_mutex;
     QTimer m_interactionTimer;
@@ -46,6 +46,10 @@ void YubiKey::findValidKeys()
 {
 }
 
+void YubiKey::refreshValidKeys()
+{
+}
+
 QList<YubiKeySlot> YubiKey::foundKeys()
 {
     return {};
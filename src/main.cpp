@@ -23,6 +23,7 @@
 #include "cli/Utils.h"
 #include "config-keepassx.h"
 #include "core/Config.h"
+#include "core/StartupTrace.h"
 #include "core/Tools.h"
 #include "crypto/Crypto.h"
 #include "gui/Application.h"
@@ -46,6 +47,7 @@ Q_IMPORT_PLUGIN(QXcbIntegrationPlugin)
 int main(int argc, char** argv)
 {
     QT_REQUIRE_VERSION(argc, argv, QT_VERSION_STR)
+    StartupTrace::mark("Process started");
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
     QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
@@ -75,6 +77,24 @@ int main(int argc, char** argv)
     parser.addOption(pwstdinOption);
     parser.addOption(debugInfoOption);
 
+    // Hand the command line over to a running instance before the GUI is initialized. Only a core
+    // application is needed for that, which spares the second process loading the platform plugin.
+    {
+        QCoreApplication handOffApp(argc, argv);
+        QCoreApplication::setApplicationName("KeePassXC");
+        if (parser.parse(QCoreApplication::arguments()) && !parser.isSet(versionOption)
+            && !parser.isSet(helpOption)) {
+            if (parser.isSet(configOption) || parser.isSet(localConfigOption)) {
+                Config::createConfigFromFile(parser.value(configOption), parser.value(localConfigOption));
+            }
+            if (Application::handOffToRunningInstance(parser.positionalArguments())) {
+                qWarning() << QObject::tr("Another instance of KeePassXC is already running.").toUtf8().constData();
+                return EXIT_SUCCESS;
+            }
+        }
+    }
+    StartupTrace::mark("Single instance handoff");
+
     Application app(argc, argv);
     // don't set organizationName as that changes the return value of
     // QStandardPaths::writableLocation(QDesktopServices::DataLocation)
@@ -83,6 +103,7 @@ int main(int argc, char** argv)
     app.setProperty("KPXC_QUALIFIED_APPNAME", "org.keepassxc.KeePassXC");
 
     parser.process(app);
+    StartupTrace::mark("Application created");
 
     // Exit early if we're only showing the help / version
     if (parser.isSet(versionOption) || parser.isSet(helpOption)) {
@@ -103,15 +124,18 @@ int main(int argc, char** argv)
         qWarning() << QObject::tr("Another instance of KeePassXC is already running.").toUtf8().constData();
         return EXIT_SUCCESS;
     }
+    StartupTrace::mark("Configuration and single instance check");
 
     // Apply the configured theme before creating any GUI elements
     app.applyTheme();
+    StartupTrace::mark("Theme applied");
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 7, 0)
     QGuiApplication::setDesktopFileName(app.property("KPXC_QUALIFIED_APPNAME").toString() + QStringLiteral(".desktop"));
 #endif
 
     Application::bootstrap();
+    StartupTrace::mark("Bootstrap and translators");
 
     if (!Crypto::init()) {
         QString error = QObject::tr("Fatal error while testing the cryptographic functions.");
@@ -120,6 +144,7 @@ int main(int argc, char** argv)
         MessageBox::critical(nullptr, QObject::tr("KeePassXC - Error"), error);
         return EXIT_FAILURE;
     }
+    StartupTrace::mark("Crypto self test");
 
     // Displaying the debugging informations must be done after Crypto::init,
     // to make sure we know which libgcrypt version is used.
@@ -131,6 +156,7 @@ int main(int argc, char** argv)
     }
 
     MainWindow mainWindow;
+    StartupTrace::mark("Main window created");
 
     const bool pwstdin = parser.isSet(pwstdinOption);
     for (const QString& filename : fileNames) {
@@ -148,6 +174,7 @@ int main(int argc, char** argv)
             mainWindow.openDatabase(filename, password, parser.value(keyfileOption));
         }
     }
+    StartupTrace::mark("Command line databases opened");
 
     int exitCode = Application::exec();
 
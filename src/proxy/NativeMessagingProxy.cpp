@@ -19,8 +19,11 @@
 #include "browser/BrowserShared.h"
 
 #include <QCoreApplication>
+#include <QSocketNotifier>
 #include <QtConcurrent/QtConcurrent>
 
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 
 #ifdef Q_OS_WIN
@@ -31,6 +34,7 @@
 #else
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <unistd.h>
 #endif
 
 NativeMessagingProxy::NativeMessagingProxy()
@@ -51,36 +55,80 @@ void NativeMessagingProxy::setupStandardInput()
 #ifdef Q_OS_WIN
     setmode(fileno(stdin), _O_BINARY);
     setmode(fileno(stdout), _O_BINARY);
-#endif
 
+    // Anonymous pipes can't be waited on, so a thread blocks on them instead
     QtConcurrent::run([this] {
-        while (std::cin.good()) {
-            if (std::cin.peek() != EOF) {
-                uint length = 0;
-                for (uint i = 0; i < sizeof(uint); ++i) {
-                    length |= getchar() << (i * 8);
-                }
-
-                QString msg;
-                msg.reserve(length);
-                for (uint i = 0; i < length; ++i) {
-                    msg.append(getchar());
-                }
-
-                if (msg.length() > 0) {
-                    emit stdinMessage(msg);
-                }
+        quint32 length = 0;
+        while (std::cin.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+            if (length > static_cast<quint32>(BrowserShared::NATIVEMSG_MAX_LENGTH)) {
+                break;
+            }
+
+            QByteArray msg(static_cast<int>(length), '\0');
+            if (!std::cin.read(msg.data(), msg.size())) {
+                break;
+            }
+
+            if (!msg.isEmpty()) {
+                emit stdinMessage(msg);
             }
-            QThread::msleep(100);
         }
         QCoreApplication::quit();
     });
+#else
+    m_stdinNotifier = new QSocketNotifier(STDIN_FILENO, QSocketNotifier::Read, this);
+    connect(m_stdinNotifier, SIGNAL(activated(int)), this, SLOT(readStandardInput()));
+#endif
+}
+
+/**
+ * Read what is available on stdin and forward the completed messages. The
+ * browser prefixes every message with its length in native byte order.
+ */
+void NativeMessagingProxy::readStandardInput()
+{
+#ifndef Q_OS_WIN
+    char data[16384];
+    const auto size = ::read(STDIN_FILENO, data, sizeof(data));
+    if (size < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return;
+    }
+    if (size <= 0) {
+        // The browser closed the connection
+        m_stdinNotifier->setEnabled(false);
+        QCoreApplication::quit();
+        return;
+    }
+
+    m_stdinBuffer.append(data, static_cast<int>(size));
+    while (m_stdinBuffer.size() >= static_cast<int>(sizeof(quint32))) {
+        quint32 length = 0;
+        std::memcpy(&length, m_stdinBuffer.constData(), sizeof(length));
+        if (length > static_cast<quint32>(BrowserShared::NATIVEMSG_MAX_LENGTH)) {
+            // The stream is out of sync, there is no way to recover
+            m_stdinNotifier->setEnabled(false);
+            QCoreApplication::quit();
+            return;
+        }
+
+        const int frameLength = static_cast<int>(sizeof(length) + length);
+        if (m_stdinBuffer.size() < frameLength) {
+            break;
+        }
+
+        const auto msg = m_stdinBuffer.mid(sizeof(length), static_cast<int>(length));
+        m_stdinBuffer.remove(0, frameLength);
+        if (!msg.isEmpty()) {
+            transferStdinMessage(msg);
+        }
+    }
+#endif
 }
 
-void NativeMessagingProxy::transferStdinMessage(const QString& msg)
+void NativeMessagingProxy::transferStdinMessage(const QByteArray& msg)
 {
     if (m_localSocket && m_localSocket->state() == QLocalSocket::ConnectedState) {
-        m_localSocket->write(msg.toUtf8(), msg.length());
+        m_localSocket->write(msg);
         m_localSocket->flush();
     }
 }
@@ -102,15 +150,17 @@ void NativeMessagingProxy::setupLocalSocket()
 
 void NativeMessagingProxy::transferSocketMessage()
 {
-    auto msg = m_localSocket->readAll();
-    if (!msg.isEmpty()) {
+    // A read may hold a partial message or several pipelined ones
+    m_socketBuffer.append(m_localSocket->readAll());
+    for (const auto& msg : m_socketBuffer.takeMessages()) {
         // Explicitly write the message length as 1 byte chunks
-        uint len = msg.size();
+        quint32 len = msg.size();
         std::cout.write(reinterpret_cast<char*>(&len), sizeof(len));
 
         // Write the message and flush the stream
-        std::cout << msg.toStdString() << std::flush;
+        std::cout.write(msg.constData(), msg.size());
     }
+    std::cout << std::flush;
 }
 
 void NativeMessagingProxy::socketDisconnected()
@@ -18,6 +18,8 @@
 #ifndef NATIVEMESSAGINGPROXY_H
 #define NATIVEMESSAGINGPROXY_H
 
+#include "browser/BrowserShared.h"
+
 #include <QLocalSocket>
 #include <QObject>
 #include <QScopedPointer>
@@ -33,19 +35,25 @@ public:
     ~NativeMessagingProxy() override = default;
 
 signals:
-    void stdinMessage(QString msg);
+    void stdinMessage(QByteArray msg);
 
 public slots:
     void transferSocketMessage();
-    void transferStdinMessage(const QString& msg);
+    void transferStdinMessage(const QByteArray& msg);
     void socketDisconnected();
 
+private slots:
+    void readStandardInput();
+
 private:
     void setupStandardInput();
     void setupLocalSocket();
 
 private:
     QScopedPointer<QLocalSocket> m_localSocket;
+    BrowserShared::MessageBuffer m_socketBuffer;
+    QByteArray m_stdinBuffer;
+    QSocketNotifier* m_stdinNotifier = nullptr;
 
     Q_DISABLE_COPY(NativeMessagingProxy)
 };
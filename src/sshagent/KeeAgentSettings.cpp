@@ -17,8 +17,27 @@
  */
 
 #include "KeeAgentSettings.h"
+#include "core/MemoryUsage.h"
 #include "core/Tools.h"
 
+#include <QCache>
+
+namespace
+{
+    /**
+     * Settings parsed before, by their XML document. The settings of an
+     * entry rarely change, so after the first unlock only changed
+     * settings documents have to be parsed again.
+     */
+    QCache<QByteArray, KeeAgentSettings>& parsedSettings()
+    {
+        static QCache<QByteArray, KeeAgentSettings> cache(1024);
+        static const bool registered = MemoryUsage::registerCache([] { cache.clear(); });
+        Q_UNUSED(registered);
+        return cache;
+    }
+} // namespace
+
 KeeAgentSettings::KeeAgentSettings()
 {
     reset();
@@ -335,7 +354,8 @@ bool KeeAgentSettings::inEntryAttachments(const EntryAttachments* attachments)
 }
 
 /**
- * Read settings from an entry as an XML attachment.
+ * Read settings from an entry as an XML attachment. Settings missing
+ * from the document are reset to their defaults.
  *
  * Sets error string on error.
  *
@@ -344,7 +364,26 @@ bool KeeAgentSettings::inEntryAttachments(const EntryAttachments* attachments)
  */
 bool KeeAgentSettings::fromEntry(const Entry* entry)
 {
-    return fromXml(entry->attachments()->value("KeeAgent.settings"));
+    const QByteArray xml = entry->attachments()->value("KeeAgent.settings");
+    if (xml.isEmpty()) {
+        return fromXml(xml);
+    }
+
+    const auto* parsed = parsedSettings().object(xml);
+    if (parsed) {
+        *this = *parsed;
+        return true;
+    }
+
+    KeeAgentSettings settings;
+    if (!settings.fromXml(xml)) {
+        m_error = settings.errorString();
+        return false;
+    }
+
+    *this = settings;
+    parsedSettings().insert(xml, new KeeAgentSettings(settings));
+    return true;
 }
 
 /**
@@ -23,6 +23,7 @@
 #include "crypto/ssh/OpenSSHKey.h"
 #include "sshagent/KeeAgentSettings.h"
 
+#include <QtConcurrent>
 #include <QtNetwork>
 
 #ifdef Q_OS_WIN
@@ -121,9 +122,37 @@ bool SSHAgent::isAgentRunning() const
 
 bool SSHAgent::sendMessage(const QByteArray& in, QByteArray& out)
 {
+    QList<QByteArray> responses;
+    if (!sendMessages({in}, responses)) {
+        return false;
+    }
+
+    out = responses.first();
+    return true;
+}
+
+/**
+ * Send several requests over a single agent connection.
+ * The requests are written back to back and the agent answers them in order.
+ *
+ * @param in requests to send
+ * @param out responses received so far, in request order
+ * @return true if every request got a response
+ */
+bool SSHAgent::sendMessages(const QList<QByteArray>& in, QList<QByteArray>& out)
+{
+    out.clear();
+
 #ifdef Q_OS_WIN
     if (!useOpenSSH()) {
-        return sendMessagePageant(in, out);
+        for (const QByteArray& request : in) {
+            QByteArray response;
+            if (!sendMessagePageant(request, response)) {
+                return false;
+            }
+            out.append(response);
+        }
+        return true;
     }
 #endif
 
@@ -136,12 +165,18 @@ bool SSHAgent::sendMessage(const QByteArray& in, QByteArray& out)
         return false;
     }
 
-    stream.writeString(in);
+    for (const QByteArray& request : in) {
+        stream.writeString(request);
+    }
     stream.flush();
 
-    if (!stream.readString(out)) {
-        m_error = tr("Agent protocol error.");
-        return false;
+    for (int i = 0; i < in.size(); ++i) {
+        QByteArray response;
+        if (!stream.readString(response)) {
+            m_error = tr("Agent protocol error.");
+            return false;
+        }
+        out.append(response);
     }
 
     socket.close();
@@ -234,6 +269,16 @@ bool SSHAgent::addIdentity(OpenSSHKey& key, const KeeAgentSettings& settings, co
         return false;
     }
 
+    QByteArray responseData;
+    if (!sendMessage(addIdentityRequest(key, settings), responseData)) {
+        return false;
+    }
+
+    return handleAddIdentityResponse(responseData, key, settings, databaseUuid);
+}
+
+QByteArray SSHAgent::addIdentityRequest(OpenSSHKey& key, const KeeAgentSettings& settings) const
+{
     QByteArray requestData;
     BinaryStream request(&requestData);
 
@@ -251,11 +296,14 @@ bool SSHAgent::addIdentity(OpenSSHKey& key, const KeeAgentSettings& settings, co
         request.write(SSH_AGENT_CONSTRAIN_CONFIRM);
     }
 
-    QByteArray responseData;
-    if (!sendMessage(requestData, responseData)) {
-        return false;
-    }
+    return requestData;
+}
 
+bool SSHAgent::handleAddIdentityResponse(const QByteArray& responseData,
+                                         const OpenSSHKey& key,
+                                         const KeeAgentSettings& settings,
+                                         const QUuid& databaseUuid)
+{
     if (responseData.length() < 1 || static_cast<quint8>(responseData[0]) != SSH_AGENT_SUCCESS) {
         m_error =
             tr("Agent refused this identity. Possible reasons include:") + "\n" + tr("The key has already been added.");
@@ -290,6 +338,38 @@ bool SSHAgent::removeIdentity(OpenSSHKey& key)
         return false;
     }
 
+    QByteArray responseData;
+    return sendMessage(removeIdentityRequest(key), responseData);
+}
+
+/**
+ * Remove several identities from the SSH agent over a single connection.
+ *
+ * @param keys identities to remove
+ * @return true on success
+ */
+bool SSHAgent::removeIdentities(QList<OpenSSHKey>& keys)
+{
+    if (keys.isEmpty()) {
+        return true;
+    }
+
+    if (!isAgentRunning()) {
+        m_error = tr("No agent running, cannot remove identity.");
+        return false;
+    }
+
+    QList<QByteArray> requests;
+    for (OpenSSHKey& key : keys) {
+        requests.append(removeIdentityRequest(key));
+    }
+
+    QList<QByteArray> responses;
+    return sendMessages(requests, responses);
+}
+
+QByteArray SSHAgent::removeIdentityRequest(OpenSSHKey& key) const
+{
     QByteArray requestData;
     BinaryStream request(&requestData);
 
@@ -300,8 +380,7 @@ bool SSHAgent::removeIdentity(OpenSSHKey& key)
     request.write(SSH_AGENTC_REMOVE_IDENTITY);
     request.writeString(keyData);
 
-    QByteArray responseData;
-    return sendMessage(requestData, responseData);
+    return requestData;
 }
 
 /**
@@ -402,15 +481,18 @@ bool SSHAgent::checkIdentity(const OpenSSHKey& key, bool& loaded)
  */
 void SSHAgent::removeAllIdentities()
 {
+    QList<OpenSSHKey> keys;
+
     auto it = m_addedKeys.begin();
     while (it != m_addedKeys.end()) {
         // Remove key if requested to remove on lock
         if (it.value().second) {
-            OpenSSHKey key = it.key();
-            removeIdentity(key);
+            keys.append(it.key());
         }
         it = m_addedKeys.erase(it);
     }
+
+    removeIdentities(keys);
 }
 
 /**
@@ -435,6 +517,7 @@ void SSHAgent::databaseLocked()
     }
 
     QUuid databaseUuid = widget->database()->uuid();
+    QList<OpenSSHKey> keys;
 
     auto it = m_addedKeys.begin();
     while (it != m_addedKeys.end()) {
@@ -442,14 +525,15 @@ void SSHAgent::databaseLocked()
             ++it;
             continue;
         }
-        OpenSSHKey key = it.key();
         if (it.value().second) {
-            if (!removeIdentity(key)) {
-                emit error(m_error);
-            }
+            keys.append(it.key());
         }
         it = m_addedKeys.erase(it);
     }
+
+    if (!removeIdentities(keys)) {
+        emit error(m_error);
+    }
 }
 
 void SSHAgent::databaseUnlocked()
@@ -459,6 +543,14 @@ void SSHAgent::databaseUnlocked()
         return;
     }
 
+    struct PendingKey
+    {
+        KeeAgentSettings settings;
+        QSharedPointer<OpenSSHKey> key;
+        QString password;
+    };
+    QVector<PendingKey> pendingKeys;
+
     for (Entry* e : widget->database()->rootGroup()->entriesRecursive()) {
         if (widget->database()->metadata()->recycleBinEnabled()
             && e->group() == widget->database()->metadata()->recycleBin()) {
@@ -475,16 +567,70 @@ void SSHAgent::databaseUnlocked()
             continue;
         }
 
-        OpenSSHKey key;
+        // Only parse the key here, the expensive decryption is done below
+        QSharedPointer<OpenSSHKey> key(new OpenSSHKey());
+
+        if (!settings.toOpenSSHKey(e, *key, false)) {
+            continue;
+        }
+
+        pendingKeys.append({settings, key, e->password()});
+    }
+
+    // Decrypt all keys concurrently, encrypted OpenSSH keys can take seconds each
+    QList<QFuture<bool>> futures;
+    for (const PendingKey& pending : asConst(pendingKeys)) {
+        OpenSSHKey* key = pending.key.data();
+        const QString password = pending.password;
+        futures.append(QtConcurrent::run([key, password] { return !key->encrypted() || key->openKey(password); }));
+    }
+
+    const QUuid databaseUuid = widget->database()->uuid();
 
-        if (!settings.toOpenSSHKey(e, key, true)) {
+    // Send all keys to the agent over one connection; ignore errors if we have previously added the key
+    QList<int> requested;
+    QList<QByteArray> requests;
+    bool anyUnknownKey = false;
+    for (int i = 0; i < pendingKeys.size(); ++i) {
+        if (!futures[i].result()) {
             continue;
         }
 
-        // Add key to agent; ignore errors if we have previously added the key
-        bool known_key = m_addedKeys.contains(key);
-        if (!addIdentity(key, settings, widget->database()->uuid()) && !known_key) {
+        OpenSSHKey& key = *pendingKeys[i].key;
+        if (m_addedKeys.contains(key) && m_addedKeys[key].first != databaseUuid) {
+            // ownership conflict, the key is known to belong to another database
+            continue;
+        }
+
+        anyUnknownKey |= !m_addedKeys.contains(key);
+        requested.append(i);
+        requests.append(addIdentityRequest(key, pendingKeys[i].settings));
+    }
+
+    if (requests.isEmpty()) {
+        return;
+    }
+
+    if (!isAgentRunning()) {
+        if (anyUnknownKey) {
+            emit error(tr("No agent running, cannot add identity."));
+        }
+        return;
+    }
+
+    QList<QByteArray> responses;
+    bool sent = sendMessages(requests, responses);
+    const QString sendError = m_error;
+
+    for (int i = 0; i < responses.size(); ++i) {
+        const PendingKey& pending = pendingKeys[requested[i]];
+        bool known_key = m_addedKeys.contains(*pending.key);
+        if (!handleAddIdentityResponse(responses[i], *pending.key, pending.settings, databaseUuid) && !known_key) {
             emit error(m_error);
         }
     }
+
+    if (!sent && anyUnknownKey) {
+        emit error(sendError);
+    }
 }
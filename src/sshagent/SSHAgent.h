@@ -75,6 +75,14 @@ private:
     const quint8 SSH_AGENT_CONSTRAIN_CONFIRM = 2;
 
     bool sendMessage(const QByteArray& in, QByteArray& out);
+    bool sendMessages(const QList<QByteArray>& in, QList<QByteArray>& out);
+    QByteArray addIdentityRequest(OpenSSHKey& key, const KeeAgentSettings& settings) const;
+    bool handleAddIdentityResponse(const QByteArray& responseData,
+                                   const OpenSSHKey& key,
+                                   const KeeAgentSettings& settings,
+                                   const QUuid& databaseUuid);
+    QByteArray removeIdentityRequest(OpenSSHKey& key) const;
+    bool removeIdentities(QList<OpenSSHKey>& keys);
 #ifdef Q_OS_WIN
     bool sendMessagePageant(const QByteArray& in, QByteArray& out);
 
@@ -0,0 +1,223 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BlockQueueStream.h"
+
+#include <QMutexLocker>
+
+BlockQueueStream::BlockQueueStream(int maxBlocks, QObject* parent)
+    : QIODevice(parent)
+    , m_maxBlocks(qMax(1, maxBlocks))
+{
+}
+
+BlockQueueStream::~BlockQueueStream()
+{
+    close();
+}
+
+bool BlockQueueStream::open(QIODevice::OpenMode mode)
+{
+    if (mode & QIODevice::WriteOnly) {
+        qWarning("BlockQueueStream::open: Only read mode is supported.");
+        return false;
+    }
+
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+/**
+ * Close the consumer side of the stream. A producer blocked
+ * in push() is woken up and told to stop.
+ */
+void BlockQueueStream::close()
+{
+    cancel();
+
+    m_block.clear();
+    m_blockPos = 0;
+
+    QIODevice::close();
+}
+
+bool BlockQueueStream::isSequential() const
+{
+    return true;
+}
+
+bool BlockQueueStream::atEnd() const
+{
+    if (m_blockPos < m_block.size()) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    return !waitForData();
+}
+
+/**
+ * Append a block to the queue. Blocks the calling (producer)
+ * thread while the queue is full.
+ *
+ * @param block data block
+ * @return false if the consumer has closed the stream
+ */
+bool BlockQueueStream::push(const QByteArray& block)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_queue.size() >= m_maxBlocks && !m_cancelled) {
+        m_notFull.wait(&m_mutex);
+    }
+    if (m_cancelled) {
+        return false;
+    }
+
+    m_queue.enqueue(block);
+    m_notEmpty.wakeAll();
+    return true;
+}
+
+/**
+ * Signal the end of the stream to the consumer.
+ */
+void BlockQueueStream::finish()
+{
+    QMutexLocker locker(&m_mutex);
+    m_finished = true;
+    m_notEmpty.wakeAll();
+}
+
+/**
+ * Terminate the stream with an error. The consumer receives
+ * the error after all previously queued blocks have been read.
+ *
+ * @param errorMessage error message
+ */
+void BlockQueueStream::fail(const QString& errorMessage)
+{
+    QMutexLocker locker(&m_mutex);
+    m_finished = true;
+    m_failed = true;
+    m_producerError = errorMessage;
+    m_notEmpty.wakeAll();
+}
+
+/**
+ * Cancel the stream. Both a producer blocked in push() and a
+ * consumer waiting for data are woken up.
+ */
+void BlockQueueStream::cancel()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cancelled = true;
+    m_queue.clear();
+    m_notFull.wakeAll();
+    m_notEmpty.wakeAll();
+}
+
+/**
+ * @return error message passed to fail() or an empty string
+ */
+QString BlockQueueStream::producerError() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_producerError;
+}
+
+/**
+ * Read the source device in chunks and push them into the queue until
+ * the source is exhausted, fails or the stream is closed by the consumer.
+ * Meant to be run on the producer thread.
+ *
+ * @param source device to read from
+ * @param chunkSize maximum size of a single queued block
+ * @return true if the source was read completely
+ */
+bool BlockQueueStream::pump(QIODevice* source, qint64 chunkSize)
+{
+    Q_ASSERT(chunkSize > 0);
+
+    while (true) {
+        QByteArray chunk(static_cast<int>(chunkSize), Qt::Uninitialized);
+        qint64 bytesRead = source->read(chunk.data(), chunkSize);
+        if (bytesRead < 0) {
+            fail(source->errorString());
+            return false;
+        } else if (bytesRead == 0) {
+            finish();
+            return true;
+        }
+
+        chunk.resize(static_cast<int>(bytesRead));
+        if (!push(chunk)) {
+            return false;
+        }
+    }
+}
+
+/**
+ * Wait until data is queued or the producer has terminated the stream.
+ * The mutex must be locked by the caller.
+ *
+ * @return true if there is a queued block
+ */
+bool BlockQueueStream::waitForData() const
+{
+    while (m_queue.isEmpty() && !m_finished && !m_cancelled) {
+        m_notEmpty.wait(&m_mutex);
+    }
+    return !m_queue.isEmpty();
+}
+
+qint64 BlockQueueStream::readData(char* data, qint64 maxSize)
+{
+    qint64 bytesRead = 0;
+
+    while (bytesRead < maxSize) {
+        if (m_blockPos == m_block.size()) {
+            QMutexLocker locker(&m_mutex);
+            // don't stall the consumer once we have something to return
+            if (bytesRead > 0 && m_queue.isEmpty()) {
+                break;
+            }
+            if (!waitForData()) {
+                if (m_failed) {
+                    setErrorString(m_producerError);
+                    return bytesRead > 0 ? bytesRead : -1;
+                }
+                break;
+            }
+            m_block = m_queue.dequeue();
+            m_blockPos = 0;
+            m_notFull.wakeAll();
+        }
+
+        qint64 bytesToCopy = qMin(maxSize - bytesRead, static_cast<qint64>(m_block.size() - m_blockPos));
+        memcpy(data + bytesRead, m_block.constData() + m_blockPos, static_cast<size_t>(bytesToCopy));
+        bytesRead += bytesToCopy;
+        m_blockPos += static_cast<int>(bytesToCopy);
+    }
+
+    return bytesRead;
+}
+
+qint64 BlockQueueStream::writeData(const char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_BLOCKQUEUESTREAM_H
+#define KEEPASSXC_BLOCKQUEUESTREAM_H
+
+#include <QIODevice>
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+
+/**
+ * Read-only sequential device that is fed by a producer thread through
+ * a bounded queue of data blocks.
+ *
+ * The producer pushes blocks with push() and terminates the stream with
+ * finish() or fail(). The consumer reads from the device like from any
+ * other QIODevice and blocks while the queue is empty. Closing the device
+ * from the consumer side cancels the producer; cancel() does the same
+ * and may be called from any thread.
+ */
+class BlockQueueStream : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit BlockQueueStream(int maxBlocks = 4, QObject* parent = nullptr);
+    ~BlockQueueStream() override;
+
+    bool open(QIODevice::OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override;
+    bool atEnd() const override;
+
+    bool push(const QByteArray& block);
+    void finish();
+    void fail(const QString& errorMessage);
+    void cancel();
+    QString producerError() const;
+
+    bool pump(QIODevice* source, qint64 chunkSize);
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    bool waitForData() const;
+
+    const int m_maxBlocks;
+    mutable QMutex m_mutex;
+    mutable QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    QQueue<QByteArray> m_queue;
+    QByteArray m_block;
+    int m_blockPos = 0;
+    bool m_finished = false;
+    bool m_cancelled = false;
+    bool m_failed = false;
+    QString m_producerError;
+};
+
+#endif // KEEPASSXC_BLOCKQUEUESTREAM_H
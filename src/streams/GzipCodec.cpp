@@ -0,0 +1,229 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GzipCodec.h"
+
+#include "config-keepassx.h"
+#include "core/Endian.h"
+
+#include <limits>
+
+#include <zlib.h>
+#ifdef WITH_XC_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+namespace
+{
+    // deflate can't compress better than this, larger size hints come from corrupt data
+    const qint64 MaxDeflateRatio = 1032;
+    const int GzipTrailerSize = 8;
+
+    /**
+     * Get the uncompressed size recorded in the gzip trailer, if it is plausible.
+     *
+     * @return uncompressed size or -1 if unknown
+     */
+    qint64 uncompressedSizeHint(const QByteArray& data)
+    {
+        if (data.size() < GzipTrailerSize) {
+            return -1;
+        }
+        // the size is stored modulo 2^32, which is exact for anything a QByteArray can hold
+        qint64 size = Endian::bytesToSizedInt<quint32>(data.right(4), QSysInfo::LittleEndian);
+        if (size > data.size() * MaxDeflateRatio || size >= std::numeric_limits<int>::max()) {
+            return -1;
+        }
+        return size;
+    }
+
+#ifndef WITH_XC_LIBDEFLATE
+    QByteArray zlibCompress(const QByteArray& data, int compressionLevel)
+    {
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+
+        // same parameters as QtIOCompressor, so the output is the same
+        if (deflateInit2(&stream, compressionLevel, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return {};
+        }
+
+        QByteArray output(static_cast<int>(deflateBound(&stream, static_cast<uLong>(data.size()))), Qt::Uninitialized);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+
+        int result = deflate(&stream, Z_FINISH);
+        output.resize(static_cast<int>(stream.total_out));
+        deflateEnd(&stream);
+
+        if (result != Z_STREAM_END) {
+            return {};
+        }
+        return output;
+    }
+#endif
+
+    bool zlibDecompress(const QByteArray& data, QByteArray& output)
+    {
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+        stream.avail_in = static_cast<uInt>(data.size());
+
+        if (inflateInit2(&stream, 31) != Z_OK) {
+            return false;
+        }
+
+        // one spare byte, so a correct size hint does not need another round for the end of the stream
+        qint64 sizeHint = uncompressedSizeHint(data);
+        if (sizeHint < 0) {
+            sizeHint = qMin<qint64>(data.size() * 4LL, 64 * 1024 * 1024);
+        }
+        QByteArray result(static_cast<int>(sizeHint) + 1, Qt::Uninitialized);
+        stream.next_out = reinterpret_cast<Bytef*>(result.data());
+        stream.avail_out = static_cast<uInt>(result.size());
+
+        bool ok = false;
+        while (true) {
+            int status = inflate(&stream, Z_NO_FLUSH);
+            if (status == Z_STREAM_END) {
+                ok = true;
+                break;
+            } else if (status != Z_OK && status != Z_BUF_ERROR) {
+                break;
+            } else if (stream.avail_in == 0 && stream.avail_out > 0) {
+                // Truncated input, QtIOCompressor also returns the data up to this point
+                ok = true;
+                break;
+            } else if (stream.avail_out == 0) {
+                if (result.size() > std::numeric_limits<int>::max() / 2) {
+                    break;
+                }
+                int oldSize = result.size();
+                result.resize(oldSize * 2);
+                stream.next_out = reinterpret_cast<Bytef*>(result.data() + oldSize);
+                stream.avail_out = static_cast<uInt>(result.size() - oldSize);
+            }
+        }
+
+        if (ok) {
+            result.resize(static_cast<int>(stream.total_out));
+            output = result;
+        }
+        inflateEnd(&stream);
+        return ok;
+    }
+
+#ifdef WITH_XC_LIBDEFLATE
+    QByteArray libdeflateCompress(const QByteArray& data, int compressionLevel)
+    {
+        // libdeflate has levels up to 12, but 10 and above are much slower than zlib's 9
+        int level = compressionLevel == Z_DEFAULT_COMPRESSION ? 6 : qBound(0, compressionLevel, 9);
+        libdeflate_compressor* compressor = libdeflate_alloc_compressor(level);
+        if (!compressor) {
+            return {};
+        }
+
+        auto inputSize = static_cast<size_t>(data.size());
+        QByteArray output(static_cast<int>(libdeflate_gzip_compress_bound(compressor, inputSize)), Qt::Uninitialized);
+        size_t outputSize = libdeflate_gzip_compress(
+            compressor, data.constData(), inputSize, output.data(), static_cast<size_t>(output.size()));
+        libdeflate_free_compressor(compressor);
+
+        if (outputSize == 0) {
+            return {};
+        }
+        output.resize(static_cast<int>(outputSize));
+        return output;
+    }
+
+    bool libdeflateDecompress(const QByteArray& data, QByteArray& output)
+    {
+        // libdeflate needs the exact output size, which only a valid trailer gives
+        qint64 sizeHint = uncompressedSizeHint(data);
+        if (sizeHint < 0) {
+            return false;
+        }
+
+        libdeflate_decompressor* decompressor = libdeflate_alloc_decompressor();
+        if (!decompressor) {
+            return false;
+        }
+
+        QByteArray result(static_cast<int>(sizeHint), Qt::Uninitialized);
+        size_t resultSize = 0;
+        libdeflate_result status = libdeflate_gzip_decompress(decompressor,
+                                                              data.constData(),
+                                                              static_cast<size_t>(data.size()),
+                                                              result.data(),
+                                                              static_cast<size_t>(result.size()),
+                                                              &resultSize);
+        libdeflate_free_decompressor(decompressor);
+
+        if (status != LIBDEFLATE_SUCCESS || resultSize != static_cast<size_t>(result.size())) {
+            return false;
+        }
+        output = result;
+        return true;
+    }
+#endif
+} // namespace
+
+namespace GzipCodec
+{
+    /**
+     * Compress data into a gzip member.
+     *
+     * @param data uncompressed data
+     * @param compressionLevel zlib compression level
+     * @return compressed data or a null byte array on error
+     */
+    QByteArray compress(const QByteArray& data, int compressionLevel)
+    {
+        compressionLevel = qBound(Z_DEFAULT_COMPRESSION, compressionLevel, Z_BEST_COMPRESSION);
+#ifdef WITH_XC_LIBDEFLATE
+        return libdeflateCompress(data, compressionLevel);
+#else
+        return zlibCompress(data, compressionLevel);
+#endif
+    }
+
+    /**
+     * Decompress a gzip member. Data that libdeflate can't decompress at once,
+     * e.g. since it is truncated, is handed to zlib, which accepts the same
+     * input as QtIOCompressor.
+     *
+     * @param data compressed data
+     * @param output decompressed data
+     * @return true on success
+     */
+    bool decompress(const QByteArray& data, QByteArray& output)
+    {
+#ifdef WITH_XC_LIBDEFLATE
+        if (libdeflateDecompress(data, output)) {
+            return true;
+        }
+#endif
+        return zlibDecompress(data, output);
+    }
+} // namespace GzipCodec
@@ -0,0 +1,38 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_GZIPCODEC_H
+#define KEEPASSXC_GZIPCODEC_H
+
+#include <QByteArray>
+
+/**
+ * Gzip compression of data that is held in memory as a whole.
+ *
+ * Unlike QtIOCompressor, the whole input is handed to the compression
+ * library in one call and the output is allocated once. When built with
+ * WITH_XC_LIBDEFLATE, libdeflate is used instead of zlib, otherwise the
+ * output is the same as the one of QtIOCompressor. Either way the result
+ * is a single regular gzip member.
+ */
+namespace GzipCodec
+{
+    QByteArray compress(const QByteArray& data, int compressionLevel = 6);
+    bool decompress(const QByteArray& data, QByteArray& output);
+} // namespace GzipCodec
+
+#endif // KEEPASSXC_GZIPCODEC_H
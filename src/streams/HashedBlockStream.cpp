@@ -17,9 +17,13 @@
 
 #include "HashedBlockStream.h"
 
+#include <QThread>
+#include <QtConcurrent>
 #include <cstring>
 
 #include "core/Endian.h"
+#include "core/SecureArena.h"
+#include "core/Trace.h"
 #include "crypto/CryptoHash.h"
 
 const QSysInfo::Endian HashedBlockStream::ByteOrder = QSysInfo::LittleEndian;
@@ -45,7 +49,18 @@ HashedBlockStream::~HashedBlockStream()
 
 void HashedBlockStream::init()
 {
-    m_buffer.clear();
+    // make sure no background hashing refers to the old data anymore
+    for (auto& block : m_pendingBlocks) {
+        block.hash.waitForFinished();
+        SecureArena::wipe(block.data);
+    }
+    m_pendingBlocks.clear();
+    m_pendingIndex = 0;
+    m_pendingEof = false;
+    m_pendingError.clear();
+
+    // blocks carry the decrypted payload when reading KDBX 3 databases
+    SecureArena::wipe(m_buffer);
     m_bufferPos = 0;
     m_blockIndex = 0;
     m_eof = false;
@@ -69,6 +84,10 @@ bool HashedBlockStream::reset()
         }
     }
 
+    if (isWritable() && !flushPendingBlocks(0)) {
+        return false;
+    }
+
     init();
 
     return true;
@@ -87,9 +106,46 @@ void HashedBlockStream::close()
         writeHashedBlock();
     }
 
+    if (isWritable()) {
+        flushPendingBlocks(0);
+    }
+    init();
+
     LayeredStream::close();
 }
 
+/**
+ * @return number of blocks whose SHA-256 is computed ahead of time, 0 if hashing is not concurrent
+ */
+int HashedBlockStream::concurrentBlocks() const
+{
+    return m_concurrentBlocks;
+}
+
+/**
+ * Compute the SHA-256 of several blocks at once on the global thread pool.
+ * A reader queues up to this many blocks after the current one and compares
+ * their stored hashes once it gets to them. A writer queues its finished
+ * blocks and writes each after its hash is done, keeping the block indices
+ * in order. With 0, every block is hashed on the calling thread. Set this
+ * before the first read or write.
+ *
+ * @param blocks number of blocks in flight besides the current one
+ */
+void HashedBlockStream::setConcurrentBlocks(int blocks)
+{
+    m_concurrentBlocks = qMax(0, blocks);
+}
+
+/**
+ * @return blocks in flight for this machine, one per additional core and at most four
+ */
+int HashedBlockStream::defaultConcurrentBlocks()
+{
+    // one block per additional core, but don't hold more than a few MiB in flight
+    return qBound(0, QThread::idealThreadCount() - 1, 4);
+}
+
 qint64 HashedBlockStream::readData(char* data, qint64 maxSize)
 {
     if (m_error) {
@@ -125,60 +181,131 @@ qint64 HashedBlockStream::readData(char* data, qint64 maxSize)
 }
 
 bool HashedBlockStream::readHashedBlock()
+{
+    TRACE_SCOPE("HashedBlockStream::readHashedBlock");
+    if (m_eof) {
+        return false;
+    }
+
+    QByteArray hash;
+    QByteArray computedHash;
+    if (m_concurrentBlocks > 0) {
+        readAheadBlocks();
+        if (m_pendingBlocks.isEmpty()) {
+            m_error = true;
+            setErrorString(m_pendingError);
+            return false;
+        }
+
+        PendingBlock block = m_pendingBlocks.dequeue();
+        hash = block.expectedHash;
+        m_buffer = block.data;
+        if (!m_buffer.isEmpty()) {
+            computedHash = block.hash.result();
+        }
+    } else {
+        QString errorMessage;
+        if (!readRawBlock(m_blockIndex, hash, m_buffer, errorMessage)) {
+            m_error = true;
+            setErrorString(errorMessage);
+            return false;
+        }
+        if (!m_buffer.isEmpty()) {
+            computedHash = blockHash(m_buffer);
+        }
+    }
+
+    if (m_buffer.isEmpty()) {
+        m_eof = true;
+        return false;
+    }
+
+    if (hash != computedHash) {
+        m_error = true;
+        setErrorString("Mismatch between hash and data.");
+        return false;
+    }
+
+    m_bufferPos = 0;
+    m_blockIndex++;
+
+    return true;
+}
+
+/**
+ * Read the next block and its hash from the base device without verifying
+ * the hash. Only the hash of the final block is checked here.
+ *
+ * @param expectedIndex index the block must have
+ * @param hash stored hash of the block
+ * @param data block data, empty for the final block
+ * @param errorMessage error message in case of failure
+ * @return true on success
+ */
+bool HashedBlockStream::readRawBlock(quint32 expectedIndex, QByteArray& hash, QByteArray& data, QString& errorMessage)
 {
     bool ok;
 
     quint32 index = Endian::readSizedInt<quint32>(m_baseDevice, ByteOrder, &ok);
-    if (!ok || index != m_blockIndex) {
-        m_error = true;
-        setErrorString("Invalid block index.");
+    if (!ok || index != expectedIndex) {
+        errorMessage = "Invalid block index.";
         return false;
     }
 
-    QByteArray hash = m_baseDevice->read(32);
+    hash = m_baseDevice->read(32);
     if (hash.size() != 32) {
-        m_error = true;
-        setErrorString("Invalid hash size.");
+        errorMessage = "Invalid hash size.";
         return false;
     }
 
-    m_blockSize = Endian::readSizedInt<qint32>(m_baseDevice, ByteOrder, &ok);
-    if (!ok || m_blockSize < 0) {
-        m_error = true;
-        setErrorString("Invalid block size.");
+    qint32 blockSize = Endian::readSizedInt<qint32>(m_baseDevice, ByteOrder, &ok);
+    if (!ok || blockSize < 0) {
+        errorMessage = "Invalid block size.";
         return false;
     }
 
-    if (m_blockSize == 0) {
+    if (blockSize == 0) {
         if (hash.count('\0') != 32) {
-            m_error = true;
-            setErrorString("Invalid hash of final block.");
+            errorMessage = "Invalid hash of final block.";
             return false;
         }
 
-        m_eof = true;
-        return false;
-    }
-
-    m_buffer = m_baseDevice->read(m_blockSize);
-    if (m_buffer.size() != m_blockSize) {
-        m_error = true;
-        setErrorString("Block too short.");
-        return false;
+        data.clear();
+        return true;
     }
 
-    if (hash != CryptoHash::hash(m_buffer, CryptoHash::Sha256)) {
-        m_error = true;
-        setErrorString("Mismatch between hash and data.");
+    data = m_baseDevice->read(blockSize);
+    if (data.size() != blockSize) {
+        errorMessage = "Block too short.";
         return false;
     }
 
-    m_bufferPos = 0;
-    m_blockIndex++;
-
     return true;
 }
 
+/**
+ * Read blocks ahead of the current one and start computing their SHA-256.
+ * A read error ends the queue and is only reported after the blocks before
+ * it have been handed out, so the error surfaces at the same place in the
+ * stream as without read-ahead.
+ */
+void HashedBlockStream::readAheadBlocks()
+{
+    while (!m_pendingEof && m_pendingError.isEmpty() && m_pendingBlocks.size() <= m_concurrentBlocks) {
+        PendingBlock block;
+        block.index = m_pendingIndex;
+        if (!readRawBlock(block.index, block.expectedHash, block.data, m_pendingError)) {
+            break;
+        }
+        m_pendingEof = block.data.isEmpty();
+        if (!m_pendingEof) {
+            block.hash = QtConcurrent::run(&HashedBlockStream::blockHash, block.data);
+        }
+        ++m_pendingIndex;
+        m_pendingBlocks.enqueue(block);
+    }
+}
+
 qint64 HashedBlockStream::writeData(const char* data, qint64 maxSize)
 {
     Q_ASSERT(maxSize >= 0);
@@ -214,18 +341,53 @@ qint64 HashedBlockStream::writeData(const char* data, qint64 maxSize)
 
 bool HashedBlockStream::writeHashedBlock()
 {
-    if (!Endian::writeSizedInt<qint32>(m_blockIndex, m_baseDevice, ByteOrder)) {
-        m_error = true;
-        setErrorString(m_baseDevice->errorString());
+    TRACE_SCOPE("HashedBlockStream::writeHashedBlock");
+    if (m_concurrentBlocks > 0) {
+        PendingBlock block;
+        block.index = m_blockIndex;
+        block.data = m_buffer;
+        block.hash = QtConcurrent::run(&HashedBlockStream::blockHash, m_buffer);
+        m_pendingBlocks.enqueue(block);
+
+        m_buffer.clear();
+        m_blockIndex++;
+        return flushPendingBlocks(m_concurrentBlocks);
+    }
+
+    if (!writeBlock(m_blockIndex, blockHash(m_buffer), m_buffer)) {
         return false;
     }
+
+    m_buffer.clear();
     m_blockIndex++;
+    return true;
+}
 
-    QByteArray hash;
-    if (!m_buffer.isEmpty()) {
-        hash = CryptoHash::hash(m_buffer, CryptoHash::Sha256);
-    } else {
-        hash.fill(0, 32);
+/**
+ * Wait for the SHA-256 of the oldest queued blocks and write them with their
+ * index, hash and size, until no more than maxPending blocks are queued.
+ *
+ * @param maxPending number of blocks that may stay queued
+ * @return true on success
+ */
+bool HashedBlockStream::flushPendingBlocks(int maxPending)
+{
+    while (m_pendingBlocks.size() > maxPending) {
+        PendingBlock block = m_pendingBlocks.dequeue();
+        if (!writeBlock(block.index, block.hash.result(), block.data)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool HashedBlockStream::writeBlock(quint32 index, const QByteArray& hash, const QByteArray& data)
+{
+    if (!Endian::writeSizedInt<qint32>(index, m_baseDevice, ByteOrder)) {
+        m_error = true;
+        setErrorString(m_baseDevice->errorString());
+        return false;
     }
 
     if (m_baseDevice->write(hash) != hash.size()) {
@@ -234,25 +396,34 @@ bool HashedBlockStream::writeHashedBlock()
         return false;
     }
 
-    if (!Endian::writeSizedInt<qint32>(m_buffer.size(), m_baseDevice, ByteOrder)) {
+    if (!Endian::writeSizedInt<qint32>(data.size(), m_baseDevice, ByteOrder)) {
         m_error = true;
         setErrorString(m_baseDevice->errorString());
         return false;
     }
 
-    if (!m_buffer.isEmpty()) {
-        if (m_baseDevice->write(m_buffer) != m_buffer.size()) {
+    if (!data.isEmpty()) {
+        if (m_baseDevice->write(data) != data.size()) {
             m_error = true;
             setErrorString(m_baseDevice->errorString());
             return false;
         }
-
-        m_buffer.clear();
     }
 
     return true;
 }
 
+/**
+ * @return SHA-256 of the block, all zeros for the empty final block
+ */
+QByteArray HashedBlockStream::blockHash(const QByteArray& data)
+{
+    if (data.isEmpty()) {
+        return QByteArray(32, '\0');
+    }
+    return CryptoHash::hash(data, CryptoHash::Sha256);
+}
+
 bool HashedBlockStream::atEnd() const
 {
     return m_eof;
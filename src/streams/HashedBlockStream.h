@@ -18,10 +18,18 @@
 #ifndef KEEPASSX_HASHEDBLOCKSTREAM_H
 #define KEEPASSX_HASHEDBLOCKSTREAM_H
 
+#include <QFuture>
+#include <QQueue>
 #include <QSysInfo>
 
 #include "streams/LayeredStream.h"
 
+/**
+ * Block stream of KDBX 3 payloads. Each block is stored with its index,
+ * the SHA-256 of its data and its size, and the stream ends with an empty
+ * block whose hash is all zeros. The hashes only detect corruption, as
+ * they are not keyed.
+ */
 class HashedBlockStream : public LayeredStream
 {
     Q_OBJECT
@@ -36,14 +44,32 @@ public:
 
     bool atEnd() const override;
 
+    int concurrentBlocks() const;
+    void setConcurrentBlocks(int blocks);
+    static int defaultConcurrentBlocks();
+
 protected:
     qint64 readData(char* data, qint64 maxSize) override;
     qint64 writeData(const char* data, qint64 maxSize) override;
 
 private:
+    struct PendingBlock
+    {
+        quint32 index = 0;
+        QByteArray data;
+        QFuture<QByteArray> hash;
+        QByteArray expectedHash;
+    };
+
     void init();
     bool readHashedBlock();
+    bool readRawBlock(quint32 expectedIndex, QByteArray& hash, QByteArray& data, QString& errorMessage);
+    void readAheadBlocks();
     bool writeHashedBlock();
+    bool flushPendingBlocks(int maxPending);
+    bool writeBlock(quint32 index, const QByteArray& hash, const QByteArray& data);
+
+    static QByteArray blockHash(const QByteArray& data);
 
     static const QSysInfo::Endian ByteOrder;
     qint32 m_blockSize;
@@ -52,6 +78,12 @@ private:
     quint32 m_blockIndex;
     bool m_eof;
     bool m_error;
+
+    int m_concurrentBlocks = 0;
+    QQueue<PendingBlock> m_pendingBlocks;
+    quint32 m_pendingIndex;
+    bool m_pendingEof;
+    QString m_pendingError;
 };
 
 #endif // KEEPASSX_HASHEDBLOCKSTREAM_H
@@ -17,10 +17,14 @@
 
 #include "HmacBlockStream.h"
 
+#include <QThread>
+#include <QtConcurrent>
 #include <utility>
 
 #include "core/Endian.h"
+#include "core/Trace.h"
 #include "crypto/CryptoHash.h"
+#include "streams/MappedFileDevice.h"
 
 const QSysInfo::Endian HmacBlockStream::ByteOrder = QSysInfo::LittleEndian;
 
@@ -47,6 +51,15 @@ HmacBlockStream::~HmacBlockStream()
 
 void HmacBlockStream::init()
 {
+    // make sure no background hashing refers to the old data anymore
+    for (auto& block : m_pendingBlocks) {
+        block.hmac.waitForFinished();
+    }
+    m_pendingBlocks.clear();
+    m_pendingIndex = 0;
+    m_pendingEof = false;
+    m_pendingError.clear();
+
     m_buffer.clear();
     m_bufferPos = 0;
     m_blockIndex = 0;
@@ -69,6 +82,10 @@ bool HmacBlockStream::reset()
         }
     }
 
+    if (isWritable() && !flushPendingBlocks(0)) {
+        return false;
+    }
+
     init();
 
     return true;
@@ -87,9 +104,45 @@ void HmacBlockStream::close()
         writeHashedBlock();
     }
 
+    if (isWritable()) {
+        flushPendingBlocks(0);
+    }
+    init();
+
     LayeredStream::close();
 }
 
+/**
+ * @return number of blocks hashed in the background
+ */
+int HmacBlockStream::concurrentBlocks() const
+{
+    return m_concurrentBlocks;
+}
+
+/**
+ * Hash blocks on the global thread pool. When reading, up to the given
+ * number of upcoming blocks are read ahead and verified while the current
+ * block is being consumed. When writing, finished blocks are hashed in the
+ * background and written out in order. Set to 0 to hash on the calling
+ * thread. Must be set before the first read or write.
+ *
+ * @param blocks number of blocks hashed concurrently
+ */
+void HmacBlockStream::setConcurrentBlocks(int blocks)
+{
+    m_concurrentBlocks = qMax(0, blocks);
+}
+
+/**
+ * @return suitable number of concurrently hashed blocks for this machine
+ */
+int HmacBlockStream::defaultConcurrentBlocks()
+{
+    // one block per additional core, but don't hold more than a few MiB in flight
+    return qBound(0, QThread::idealThreadCount() - 1, 4);
+}
+
 qint64 HmacBlockStream::readData(char* data, qint64 maxSize)
 {
     if (m_error) {
@@ -125,59 +178,108 @@ qint64 HmacBlockStream::readData(char* data, qint64 maxSize)
 
 bool HmacBlockStream::readHashedBlock()
 {
+    TRACE_SCOPE("HmacBlockStream::readHashedBlock");
     if (m_eof) {
         return false;
     }
-    QByteArray hmac = m_baseDevice->read(32);
-    if (hmac.size() != 32) {
-        m_error = true;
-        setErrorString("Invalid HMAC size.");
-        return false;
-    }
 
-    QByteArray blockSizeBytes = m_baseDevice->read(4);
-    if (blockSizeBytes.size() != 4) {
-        m_error = true;
-        setErrorString("Invalid block size size.");
-        return false;
+    QByteArray hmac;
+    QByteArray computedHmac;
+    if (m_concurrentBlocks > 0) {
+        readAheadBlocks();
+        if (m_pendingBlocks.isEmpty()) {
+            m_error = true;
+            setErrorString(m_pendingError);
+            return false;
+        }
+
+        PendingBlock block = m_pendingBlocks.dequeue();
+        hmac = block.expectedHmac;
+        computedHmac = block.hmac.result();
+        m_buffer = block.data;
+    } else {
+        QString errorMessage;
+        if (!readRawBlock(hmac, m_buffer, errorMessage)) {
+            m_error = true;
+            setErrorString(errorMessage);
+            return false;
+        }
+        computedHmac = blockHmac(m_blockIndex, m_buffer, m_key);
     }
-    auto blockSize = Endian::bytesToSizedInt<qint32>(blockSizeBytes, ByteOrder);
-    if (blockSize < 0) {
+
+    if (hmac != computedHmac) {
         m_error = true;
-        setErrorString("Invalid block size.");
+        setErrorString("Mismatch between hash and data.");
         return false;
     }
 
-    m_buffer = m_baseDevice->read(blockSize);
-    if (m_buffer.size() != blockSize) {
-        m_error = true;
-        setErrorString("Block too short.");
+    m_bufferPos = 0;
+    ++m_blockIndex;
+
+    if (m_buffer.isEmpty()) {
+        m_eof = true;
         return false;
     }
 
-    CryptoHash hasher(CryptoHash::Sha256, true);
-    hasher.setKey(getCurrentHmacKey());
-    hasher.addData(Endian::sizedIntToBytes<quint64>(m_blockIndex, ByteOrder));
-    hasher.addData(blockSizeBytes);
-    hasher.addData(m_buffer);
+    return true;
+}
 
-    if (hmac != hasher.result()) {
-        m_error = true;
-        setErrorString("Mismatch between hash and data.");
+/**
+ * Read the next block and its HMAC from the base device without verifying it.
+ *
+ * @param hmac stored HMAC of the block
+ * @param data block data
+ * @param errorMessage error message in case of failure
+ * @return true on success
+ */
+bool HmacBlockStream::readRawBlock(QByteArray& hmac, QByteArray& data, QString& errorMessage)
+{
+    hmac = m_baseDevice->read(32);
+    if (hmac.size() != 32) {
+        errorMessage = "Invalid HMAC size.";
         return false;
     }
 
-    m_bufferPos = 0;
-    ++m_blockIndex;
+    QByteArray blockSizeBytes = m_baseDevice->read(4);
+    if (blockSizeBytes.size() != 4) {
+        errorMessage = "Invalid block size size.";
+        return false;
+    }
+    auto blockSize = Endian::bytesToSizedInt<qint32>(blockSizeBytes, ByteOrder);
+    if (blockSize < 0) {
+        errorMessage = "Invalid block size.";
+        return false;
+    }
 
-    if (blockSize == 0) {
-        m_eof = true;
+    // Avoid copying the ciphertext if the file is memory-mapped
+    auto mappedDevice = qobject_cast<MappedFileDevice*>(m_baseDevice);
+    data = mappedDevice ? mappedDevice->readSlice(blockSize) : m_baseDevice->read(blockSize);
+    if (data.size() != blockSize) {
+        errorMessage = "Block too short.";
         return false;
     }
 
     return true;
 }
 
+/**
+ * Fill the read-ahead queue and start verifying the queued blocks in the background.
+ * Read errors are stored and reported once the queue has been drained.
+ */
+void HmacBlockStream::readAheadBlocks()
+{
+    while (!m_pendingEof && m_pendingError.isEmpty() && m_pendingBlocks.size() <= m_concurrentBlocks) {
+        PendingBlock block;
+        if (!readRawBlock(block.expectedHmac, block.data, m_pendingError)) {
+            break;
+        }
+        block.hmac = QtConcurrent::run(&HmacBlockStream::blockHmac, m_pendingIndex, block.data, m_key);
+        m_pendingEof = block.data.isEmpty();
+        ++m_pendingIndex;
+        m_pendingBlocks.enqueue(block);
+    }
+}
+
 qint64 HmacBlockStream::writeData(const char* data, qint64 maxSize)
 {
     Q_ASSERT(maxSize >= 0);
@@ -210,51 +312,85 @@ qint64 HmacBlockStream::writeData(const char* data, qint64 maxSize)
 
 bool HmacBlockStream::writeHashedBlock()
 {
-    CryptoHash hasher(CryptoHash::Sha256, true);
-    hasher.setKey(getCurrentHmacKey());
-    hasher.addData(Endian::sizedIntToBytes<quint64>(m_blockIndex, ByteOrder));
-    hasher.addData(Endian::sizedIntToBytes<qint32>(m_buffer.size(), ByteOrder));
-    hasher.addData(m_buffer);
-    QByteArray hash = hasher.result();
-
-    if (m_baseDevice->write(hash) != hash.size()) {
+    TRACE_SCOPE("HmacBlockStream::writeHashedBlock");
+    if (m_concurrentBlocks > 0) {
+        PendingBlock block;
+        block.data = m_buffer;
+        block.hmac = QtConcurrent::run(&HmacBlockStream::blockHmac, m_blockIndex, m_buffer, m_key);
+        m_pendingBlocks.enqueue(block);
+
+        m_buffer.clear();
+        ++m_blockIndex;
+        return flushPendingBlocks(m_concurrentBlocks);
+    }
+
+    if (!writeBlock(blockHmac(m_blockIndex, m_buffer, m_key), m_buffer)) {
+        return false;
+    }
+
+    m_buffer.clear();
+    ++m_blockIndex;
+    return true;
+}
+
+/**
+ * Write out hashed blocks in order until at most maxPending are left.
+ *
+ * @param maxPending number of blocks that may stay queued
+ * @return true on success
+ */
+bool HmacBlockStream::flushPendingBlocks(int maxPending)
+{
+    while (m_pendingBlocks.size() > maxPending) {
+        PendingBlock block = m_pendingBlocks.dequeue();
+        if (!writeBlock(block.hmac.result(), block.data)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool HmacBlockStream::writeBlock(const QByteArray& hmac, const QByteArray& data)
+{
+    if (m_baseDevice->write(hmac) != hmac.size()) {
         m_error = true;
         setErrorString(m_baseDevice->errorString());
         return false;
     }
 
-    if (!Endian::writeSizedInt<qint32>(m_buffer.size(), m_baseDevice, ByteOrder)) {
+    if (!Endian::writeSizedInt<qint32>(data.size(), m_baseDevice, ByteOrder)) {
         m_error = true;
         setErrorString(m_baseDevice->errorString());
         return false;
     }
 
-    if (!m_buffer.isEmpty()) {
-        if (m_baseDevice->write(m_buffer) != m_buffer.size()) {
+    if (!data.isEmpty()) {
+        if (m_baseDevice->write(data) != data.size()) {
             m_error = true;
             setErrorString(m_baseDevice->errorString());
             return false;
         }
-
-        m_buffer.clear();
     }
-    ++m_blockIndex;
+
     return true;
 }
 
-QByteArray HmacBlockStream::getCurrentHmacKey() const
+QByteArray HmacBlockStream::blockHmac(quint64 blockIndex, const QByteArray& data, const QByteArray& key)
 {
-    return getHmacKey(m_blockIndex, m_key);
+    // The block key changes with every block, so there is no HMAC state that could be
+    // kept across blocks. Hash the buffers in one go to avoid allocating contexts.
+    const QVector<QByteArray> parts = {Endian::sizedIntToBytes<quint64>(blockIndex, ByteOrder),
+                                       Endian::sizedIntToBytes<qint32>(data.size(), ByteOrder),
+                                       data};
+    return CryptoHash::hmac(parts, getHmacKey(blockIndex, key), CryptoHash::Sha256);
 }
 
 QByteArray HmacBlockStream::getHmacKey(quint64 blockIndex, const QByteArray& key)
 {
     Q_ASSERT(key.size() == 64);
-    QByteArray indexBytes = Endian::sizedIntToBytes<quint64>(blockIndex, ByteOrder);
-    CryptoHash hasher(CryptoHash::Sha512);
-    hasher.addData(indexBytes);
-    hasher.addData(key);
-    return hasher.result();
+    const QVector<QByteArray> parts = {Endian::sizedIntToBytes<quint64>(blockIndex, ByteOrder), key};
+    return CryptoHash::hash(parts, CryptoHash::Sha512);
 }
 
 bool HmacBlockStream::atEnd() const
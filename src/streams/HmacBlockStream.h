@@ -18,6 +18,8 @@
 #ifndef KEEPASSX_HMACBLOCKSTREAM_H
 #define KEEPASSX_HMACBLOCKSTREAM_H
 
+#include <QFuture>
+#include <QQueue>
 #include <QSysInfo>
 
 #include "streams/LayeredStream.h"
@@ -38,15 +40,31 @@ public:
 
     bool atEnd() const override;
 
+    int concurrentBlocks() const;
+    void setConcurrentBlocks(int blocks);
+    static int defaultConcurrentBlocks();
+
 protected:
     qint64 readData(char* data, qint64 maxSize) override;
     qint64 writeData(const char* data, qint64 maxSize) override;
 
 private:
+    struct PendingBlock
+    {
+        QByteArray data;
+        QFuture<QByteArray> hmac;
+        QByteArray expectedHmac;
+    };
+
     void init();
     bool readHashedBlock();
+    bool readRawBlock(QByteArray& hmac, QByteArray& data, QString& errorMessage);
+    void readAheadBlocks();
     bool writeHashedBlock();
-    QByteArray getCurrentHmacKey() const;
+    bool flushPendingBlocks(int maxPending);
+    bool writeBlock(const QByteArray& hmac, const QByteArray& data);
+
+    static QByteArray blockHmac(quint64 blockIndex, const QByteArray& data, const QByteArray& key);
 
     static const QSysInfo::Endian ByteOrder;
     qint32 m_blockSize;
@@ -56,6 +74,12 @@ private:
     quint64 m_blockIndex;
     bool m_eof;
     bool m_error;
+
+    int m_concurrentBlocks = 0;
+    QQueue<PendingBlock> m_pendingBlocks;
+    quint64 m_pendingIndex;
+    bool m_pendingEof;
+    QString m_pendingError;
 };
 
 #endif // KEEPASSX_HMACBLOCKSTREAM_H
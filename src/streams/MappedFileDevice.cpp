@@ -0,0 +1,155 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFileDevice.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QStorageInfo>
+
+MappedFileDevice::MappedFileDevice(const QString& filePath, QObject* parent)
+    : QIODevice(parent)
+    , m_file(filePath)
+{
+}
+
+MappedFileDevice::~MappedFileDevice()
+{
+    close();
+}
+
+bool MappedFileDevice::open(QIODevice::OpenMode mode)
+{
+    if (isOpen()) {
+        qWarning("MappedFileDevice::open: Device is already open.");
+        return false;
+    }
+    if (mode & QIODevice::WriteOnly) {
+        qWarning("MappedFileDevice::open: Only read mode is supported.");
+        return false;
+    }
+
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        setErrorString(m_file.errorString());
+        return false;
+    }
+
+    m_size = m_file.size();
+    m_data = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+    if (!m_data) {
+        setErrorString(m_file.errorString());
+        m_file.close();
+        m_size = 0;
+        return false;
+    }
+
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+void MappedFileDevice::close()
+{
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_size = 0;
+    m_file.close();
+
+    QIODevice::close();
+}
+
+qint64 MappedFileDevice::size() const
+{
+    return m_size;
+}
+
+QString MappedFileDevice::fileName() const
+{
+    return m_file.fileName();
+}
+
+/**
+ * Read up to maxSize bytes from the current position without copying
+ * them. The returned byte array references the mapped file and must
+ * not be used after the device has been closed.
+ *
+ * @param maxSize maximum number of bytes to read
+ * @return view into the mapped file
+ */
+QByteArray MappedFileDevice::readSlice(qint64 maxSize)
+{
+    if (!isOpen() || maxSize <= 0) {
+        return {};
+    }
+
+    qint64 offset = pos();
+    qint64 length = qMin(maxSize, m_size - offset);
+    if (length <= 0) {
+        return {};
+    }
+
+    seek(offset + length);
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(m_data + offset), static_cast<int>(length));
+}
+
+/**
+ * Check whether the file lives on a file system that can safely be
+ * memory-mapped. Network file systems are excluded since a connection
+ * loss or a remote truncation would fault the mapped pages instead of
+ * producing a read error.
+ *
+ * @param filePath path to the file
+ * @return true if the file may be mapped
+ */
+bool MappedFileDevice::isMappingSafe(const QString& filePath)
+{
+    QString absolutePath = QFileInfo(filePath).absoluteFilePath();
+    QString nativePath = QDir::toNativeSeparators(absolutePath);
+    if (absolutePath.startsWith("//") || nativePath.startsWith("\\\\")) {
+        // UNC path
+        return false;
+    }
+
+    QStorageInfo storage(QFileInfo(absolutePath).absolutePath());
+    if (!storage.isValid() || !storage.isReady()) {
+        return false;
+    }
+
+    static const QStringList networkFileSystems = {
+        "nfs", "nfs4", "cifs", "smbfs", "smb2", "smb3", "afs", "ncpfs", "9p", "coda", "davfs", "webdav", "fuse.sshfs"};
+    QString fsType = QString::fromUtf8(storage.fileSystemType()).toLower();
+    return !networkFileSystems.contains(fsType) && !fsType.startsWith("fuse.smb") && !fsType.startsWith("fuse.dav");
+}
+
+qint64 MappedFileDevice::readData(char* data, qint64 maxSize)
+{
+    qint64 offset = pos();
+    qint64 length = qMin(maxSize, m_size - offset);
+    if (length <= 0) {
+        return 0;
+    }
+
+    memcpy(data, m_data + offset, static_cast<size_t>(length));
+    return length;
+}
+
+qint64 MappedFileDevice::writeData(const char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
@@ -0,0 +1,58 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_MAPPEDFILEDEVICE_H
+#define KEEPASSXC_MAPPEDFILEDEVICE_H
+
+#include <QFile>
+#include <QIODevice>
+
+/**
+ * Read-only random access device backed by a memory-mapped file.
+ *
+ * In addition to the regular QIODevice interface, readSlice() hands out
+ * views into the mapping without copying the data. Slices are only
+ * valid as long as the device is open.
+ */
+class MappedFileDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit MappedFileDevice(const QString& filePath, QObject* parent = nullptr);
+    ~MappedFileDevice() override;
+
+    bool open(QIODevice::OpenMode mode) override;
+    void close() override;
+    qint64 size() const override;
+    QString fileName() const;
+
+    QByteArray readSlice(qint64 maxSize);
+
+    static bool isMappingSafe(const QString& filePath);
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    QFile m_file;
+    uchar* m_data = nullptr;
+    qint64 m_size = 0;
+};
+
+#endif // KEEPASSXC_MAPPEDFILEDEVICE_H
@@ -0,0 +1,264 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelGzipStream.h"
+
+#include "core/Endian.h"
+#include "core/Trace.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <zlib.h>
+
+namespace
+{
+    const int WindowSize = 32 * 1024;
+
+    /**
+     * Compress a chunk of input into raw deflate data.
+     *
+     * @param input chunk of input
+     * @param dictionary up to 32 KiB of input preceding the chunk
+     * @param level zlib compression level
+     * @param last finish the deflate stream after this chunk
+     * @return compressed data or a null byte array on error
+     */
+    QByteArray deflateChunk(const QByteArray& input, const QByteArray& dictionary, int level, bool last)
+    {
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+
+        // negative window bits produce raw deflate without zlib header
+        if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return {};
+        }
+
+        if (!dictionary.isEmpty()
+            && deflateSetDictionary(&stream,
+                                    reinterpret_cast<const Bytef*>(dictionary.constData()),
+                                    static_cast<uInt>(dictionary.size()))
+                   != Z_OK) {
+            deflateEnd(&stream);
+            return {};
+        }
+
+        // leave room for the sync flush marker and the final block
+        QByteArray output(static_cast<int>(deflateBound(&stream, static_cast<uLong>(input.size()))) + 16,
+                          Qt::Uninitialized);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.constData()));
+        stream.avail_in = static_cast<uInt>(input.size());
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+
+        int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+        bool ok = last ? result == Z_STREAM_END : (result == Z_OK && stream.avail_in == 0);
+        output.resize(static_cast<int>(stream.total_out));
+        deflateEnd(&stream);
+
+        if (!ok) {
+            return {};
+        }
+        return output;
+    }
+} // namespace
+
+ParallelGzipStream::ParallelGzipStream(QIODevice* baseDevice, int compressionLevel)
+    : LayeredStream(baseDevice)
+    , m_compressionLevel(qBound(Z_DEFAULT_COMPRESSION, compressionLevel, Z_BEST_COMPRESSION))
+    , m_maxPendingChunks(qMax(2, QThread::idealThreadCount() * 2))
+{
+}
+
+ParallelGzipStream::~ParallelGzipStream()
+{
+    close();
+}
+
+bool ParallelGzipStream::open(QIODevice::OpenMode mode)
+{
+    if (mode & QIODevice::ReadOnly) {
+        qWarning("ParallelGzipStream::open: Only write mode is supported.");
+        return false;
+    }
+    if (!LayeredStream::open(mode)) {
+        return false;
+    }
+
+    m_chunk.clear();
+    m_chunk.reserve(ChunkSize);
+    m_dictionary.clear();
+    m_crc = static_cast<quint32>(crc32(0, Z_NULL, 0));
+    m_inputSize = 0;
+    m_finished = false;
+    m_error = false;
+
+    char extraFlags = 0;
+    if (m_compressionLevel == Z_BEST_COMPRESSION) {
+        extraFlags = 2;
+    } else if (m_compressionLevel == Z_BEST_SPEED) {
+        extraFlags = 4;
+    }
+
+    // magic, deflate method, no flags, no modification time, OS unknown
+    QByteArray header("\x1f\x8b\x08\x00\x00\x00\x00\x00", 8);
+    header.append(extraFlags);
+    header.append('\xff');
+    if (!writeBase(header)) {
+        LayeredStream::close();
+        return false;
+    }
+
+    return true;
+}
+
+void ParallelGzipStream::close()
+{
+    if (isOpen()) {
+        finish();
+    }
+
+    LayeredStream::close();
+}
+
+/**
+ * Compress the remaining input and write the gzip trailer.
+ * Unlike close(), the error string is kept if this fails.
+ *
+ * @return true if the whole stream was written
+ */
+bool ParallelGzipStream::finish()
+{
+    if (m_finished) {
+        return !m_error;
+    }
+    m_finished = true;
+
+    if (!m_error && submitChunk(true) && writeCompressed(true)) {
+        QByteArray trailer = Endian::sizedIntToBytes<quint32>(m_crc, QSysInfo::LittleEndian);
+        trailer.append(Endian::sizedIntToBytes<quint32>(m_inputSize, QSysInfo::LittleEndian));
+        writeBase(trailer);
+    }
+
+    // discard chunks that are still compressing after an error
+    while (!m_pendingChunks.isEmpty()) {
+        m_pendingChunks.dequeue().waitForFinished();
+    }
+
+    return !m_error;
+}
+
+qint64 ParallelGzipStream::readData(char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+qint64 ParallelGzipStream::writeData(const char* data, qint64 maxSize)
+{
+    if (m_error || m_finished) {
+        return -1;
+    }
+
+    m_crc = static_cast<quint32>(crc32(m_crc, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(maxSize)));
+    m_inputSize += static_cast<quint32>(maxSize);
+
+    qint64 bytesWritten = 0;
+    while (bytesWritten < maxSize) {
+        int bytesToCopy = static_cast<int>(qMin(maxSize - bytesWritten, qint64(ChunkSize - m_chunk.size())));
+        m_chunk.append(data + bytesWritten, bytesToCopy);
+        bytesWritten += bytesToCopy;
+
+        if (m_chunk.size() == ChunkSize && !submitChunk(false)) {
+            return -1;
+        }
+    }
+
+    return bytesWritten;
+}
+
+/**
+ * Queue the buffered input for compression and write out the chunks
+ * that are done. Blocks while too many chunks are in flight.
+ *
+ * @param last the buffered input is the end of the stream
+ * @return false on error
+ */
+bool ParallelGzipStream::submitChunk(bool last)
+{
+    QByteArray chunk = m_chunk;
+    QByteArray dictionary = m_dictionary;
+    int level = m_compressionLevel;
+    m_pendingChunks.enqueue(
+        QtConcurrent::run([chunk, dictionary, level, last] { return deflateChunk(chunk, dictionary, level, last); }));
+
+    m_dictionary = m_chunk.right(WindowSize);
+    m_chunk.clear();
+    m_chunk.reserve(ChunkSize);
+
+    while (m_pendingChunks.size() >= m_maxPendingChunks) {
+        if (!writeBase(m_pendingChunks.dequeue().result())) {
+            return false;
+        }
+    }
+
+    return writeCompressed(false);
+}
+
+/**
+ * Write compressed chunks to the base device in input order.
+ *
+ * @param waitForAll wait for chunks that are still being compressed
+ * @return false on error
+ */
+bool ParallelGzipStream::writeCompressed(bool waitForAll)
+{
+    TRACE_SCOPE("ParallelGzipStream::writeCompressed");
+    while (!m_pendingChunks.isEmpty() && (waitForAll || m_pendingChunks.head().isFinished())) {
+        if (!writeBase(m_pendingChunks.dequeue().result())) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ParallelGzipStream::writeBase(const QByteArray& data)
+{
+    if (m_error) {
+        return false;
+    }
+    if (data.isNull()) {
+        setError(tr("Compressing the stream failed."));
+        return false;
+    }
+    if (m_baseDevice->write(data) != data.size()) {
+        setError(m_baseDevice->errorString());
+        return false;
+    }
+
+    return true;
+}
+
+void ParallelGzipStream::setError(const QString& errorMessage)
+{
+    m_error = true;
+    setErrorString(errorMessage);
+}
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_PARALLELGZIPSTREAM_H
+#define KEEPASSXC_PARALLELGZIPSTREAM_H
+
+#include <QFuture>
+#include <QQueue>
+
+#include "streams/LayeredStream.h"
+
+/**
+ * Write-only gzip stream that compresses the input on a thread pool.
+ *
+ * The input is split into chunks of ChunkSize bytes that are compressed
+ * independently, each primed with the preceding 32 KiB of input as the
+ * deflate dictionary. Every chunk but the last ends with a sync flush, so
+ * the compressed chunks can be concatenated into a single deflate stream.
+ * The output is one regular gzip member that any inflate implementation
+ * can read.
+ */
+class ParallelGzipStream : public LayeredStream
+{
+    Q_OBJECT
+
+public:
+    static const int ChunkSize = 128 * 1024;
+
+    explicit ParallelGzipStream(QIODevice* baseDevice, int compressionLevel = 6);
+    ~ParallelGzipStream() override;
+
+    bool open(QIODevice::OpenMode mode) override;
+    void close() override;
+    bool finish();
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    bool submitChunk(bool last);
+    bool writeCompressed(bool waitForAll);
+    bool writeBase(const QByteArray& data);
+    void setError(const QString& errorMessage);
+
+    const int m_compressionLevel;
+    const int m_maxPendingChunks;
+    QByteArray m_chunk;
+    QByteArray m_dictionary;
+    QQueue<QFuture<QByteArray>> m_pendingChunks;
+    quint32 m_crc = 0;
+    quint32 m_inputSize = 0;
+    bool m_finished = false;
+    bool m_error = false;
+};
+
+#endif // KEEPASSXC_PARALLELGZIPSTREAM_H
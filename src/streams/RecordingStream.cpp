@@ -0,0 +1,73 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RecordingStream.h"
+
+RecordingStream::RecordingStream(QIODevice* baseDevice)
+    : LayeredStream(baseDevice)
+{
+}
+
+/**
+ * Set the buffer that receives a copy of all data written from now on.
+ *
+ * @param buffer record buffer or nullptr to stop recording
+ */
+void RecordingStream::setRecordBuffer(QByteArray* buffer)
+{
+    m_recordBuffer = buffer;
+}
+
+/**
+ * Limit the size of the record buffer.
+ *
+ * @param limit maximum number of bytes to record or -1 for no limit
+ */
+void RecordingStream::setRecordLimit(int limit)
+{
+    m_recordLimit = limit;
+}
+
+void RecordingStream::setDiscarding(bool discard)
+{
+    m_discarding = discard;
+}
+
+qint64 RecordingStream::writeData(const char* data, qint64 maxSize)
+{
+    if (m_discarding) {
+        return maxSize;
+    }
+
+    qint64 bytesWritten = LayeredStream::writeData(data, maxSize);
+    if (bytesWritten == -1) {
+        setErrorString(m_baseDevice->errorString());
+        return -1;
+    }
+
+    if (m_recordBuffer) {
+        auto size = static_cast<int>(bytesWritten);
+        if (m_recordLimit >= 0) {
+            size = qMin(size, m_recordLimit - m_recordBuffer->size());
+        }
+        if (size > 0) {
+            m_recordBuffer->append(data, size);
+        }
+    }
+
+    return bytesWritten;
+}
@@ -0,0 +1,52 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_RECORDINGSTREAM_H
+#define KEEPASSXC_RECORDINGSTREAM_H
+
+#include "streams/LayeredStream.h"
+
+/**
+ * Write stream that forwards all data to its base device and
+ * appends a copy to the current record buffer, if one is set.
+ *
+ * While discarding is enabled, written data is dropped instead
+ * of being forwarded or recorded. A record limit stops recording
+ * once the buffer holds that many bytes, which is enough to keep
+ * the head of a file as it is written.
+ */
+class RecordingStream : public LayeredStream
+{
+    Q_OBJECT
+
+public:
+    explicit RecordingStream(QIODevice* baseDevice);
+
+    void setRecordBuffer(QByteArray* buffer);
+    void setRecordLimit(int limit);
+    void setDiscarding(bool discard);
+
+protected:
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    QByteArray* m_recordBuffer = nullptr;
+    int m_recordLimit = -1;
+    bool m_discarding = false;
+};
+
+#endif // KEEPASSXC_RECORDINGSTREAM_H
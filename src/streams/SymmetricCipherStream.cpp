@@ -17,6 +17,11 @@
 
 #include "SymmetricCipherStream.h"
 
+#include "core/SecureArena.h"
+#include "core/Trace.h"
+
+const int SymmetricCipherStream::DefaultBatchSize = 1024 * 1024;
+
 SymmetricCipherStream::SymmetricCipherStream(QIODevice* baseDevice,
                                              SymmetricCipher::Algorithm algo,
                                              SymmetricCipher::Mode mode,
@@ -49,7 +54,8 @@ bool SymmetricCipherStream::init(const QByteArray& key, const QByteArray& iv)
 
 void SymmetricCipherStream::resetInternalState()
 {
-    m_buffer.clear();
+    // the buffer holds decrypted data
+    SecureArena::wipe(m_buffer);
     m_bufferPos = 0;
     m_bufferFilling = false;
     m_error = false;
@@ -122,26 +128,28 @@ qint64 SymmetricCipherStream::readData(char* data, qint64 maxSize)
 
 bool SymmetricCipherStream::readBlock()
 {
-    QByteArray newData;
-
-    if (m_bufferFilling) {
-        newData.resize(blockSize() - m_buffer.size());
-    } else {
+    TRACE_SCOPE("SymmetricCipherStream::readBlock");
+    if (!m_bufferFilling) {
         m_buffer.clear();
-        newData.resize(blockSize());
     }
 
-    int readResult = m_baseDevice->read(newData.data(), newData.size());
+    // read straight into the buffer to avoid an intermediate copy
+    int bufferedSize = m_buffer.size();
+    m_buffer.resize(blockSize());
+    qint64 readResult = m_baseDevice->read(m_buffer.data() + bufferedSize, m_buffer.size() - bufferedSize);
 
     if (readResult == -1) {
+        m_buffer.resize(bufferedSize);
         m_error = true;
         setErrorString(m_baseDevice->errorString());
         return false;
     } else {
-        m_buffer.append(newData.left(readResult));
+        m_buffer.resize(bufferedSize + static_cast<int>(readResult));
     }
 
-    if (!m_streamCipher && m_buffer.size() != blockSize()) {
+    // Block ciphers can process any whole number of blocks at once,
+    // in batch mode this is usually less than a full batch at the end
+    if (!m_streamCipher && (m_buffer.isEmpty() || m_buffer.size() % cipherBlockSize() != 0)) {
         m_bufferFilling = true;
         return false;
     } else {
@@ -158,21 +166,16 @@ bool SymmetricCipherStream::readBlock()
                 // PKCS7 padding
                 quint8 padLength = m_buffer.at(m_buffer.size() - 1);
 
-                if (padLength == blockSize()) {
-                    Q_ASSERT(m_buffer == QByteArray(blockSize(), blockSize()));
-                    // full block with just padding: discard
-                    m_buffer.clear();
-                    return false;
-                } else if (padLength > blockSize()) {
+                if (padLength > cipherBlockSize()) {
                     // invalid padding
                     m_error = true;
                     setErrorString("Invalid padding.");
                     return false;
                 } else {
                     Q_ASSERT(m_buffer.right(padLength) == QByteArray(padLength, padLength));
-                    // resize buffer to strip padding
-                    m_buffer.resize(blockSize() - padLength);
-                    return true;
+                    // resize buffer to strip padding, a block with just padding is discarded
+                    m_buffer.resize(m_buffer.size() - padLength);
+                    return !m_buffer.isEmpty();
                 }
             } else {
                 return m_buffer.size() > 0;
@@ -219,11 +222,12 @@ qint64 SymmetricCipherStream::writeData(const char* data, qint64 maxSize)
 
 bool SymmetricCipherStream::writeBlock(bool lastBlock)
 {
+    TRACE_SCOPE("SymmetricCipherStream::writeBlock");
     Q_ASSERT(m_streamCipher || lastBlock || (m_buffer.size() == blockSize()));
 
     if (lastBlock && !m_streamCipher) {
         // PKCS7 padding
-        int padLen = blockSize() - m_buffer.size();
+        int padLen = cipherBlockSize() - m_buffer.size() % cipherBlockSize();
         for (int i = 0; i < padLen; i++) {
             m_buffer.append(static_cast<char>(padLen));
         }
@@ -245,10 +249,44 @@ bool SymmetricCipherStream::writeBlock(bool lastBlock)
     }
 }
 
+/**
+ * @return number of bytes passed to the cipher backend at once
+ */
 int SymmetricCipherStream::blockSize() const
 {
+    if (m_batchSize > 0) {
+        // round down to whole cipher blocks
+        return qMax(cipherBlockSize(), m_batchSize - m_batchSize % cipherBlockSize());
+    }
     if (m_streamCipher) {
         return 1024;
     }
     return m_cipher->blockSize();
 }
+
+int SymmetricCipherStream::cipherBlockSize() const
+{
+    return m_streamCipher ? 1 : m_cipher->blockSize();
+}
+
+/**
+ * @return size of the batches passed to the cipher, 0 if processing block by block
+ */
+int SymmetricCipherStream::batchSize() const
+{
+    return m_batchSize;
+}
+
+/**
+ * Buffer up to the given number of bytes and process them with a single
+ * call into the cipher backend instead of one call per cipher block.
+ * This lets the backend use its pipelined (e.g., AES-NI) code paths.
+ * Must be set before the first read or write.
+ *
+ * @param bytes batch size, 0 to process block by block
+ */
+void SymmetricCipherStream::setBatchSize(int bytes)
+{
+    Q_ASSERT(m_buffer.isEmpty());
+    m_batchSize = qMax(0, bytes);
+}
@@ -35,6 +35,10 @@ public:
                           SymmetricCipher::Direction direction);
     ~SymmetricCipherStream();
     bool init(const QByteArray& key, const QByteArray& iv);
+    static const int DefaultBatchSize;
+
+    int batchSize() const;
+    void setBatchSize(int bytes);
     bool open(QIODevice::OpenMode mode) override;
     bool reset() override;
     void close() override;
@@ -48,6 +52,7 @@ private:
     bool readBlock();
     bool writeBlock(bool lastBlock);
     int blockSize() const;
+    int cipherBlockSize() const;
 
     const QScopedPointer<SymmetricCipher> m_cipher;
     QByteArray m_buffer;
@@ -57,6 +62,7 @@ private:
     bool m_isInitialized;
     bool m_dataWritten;
     bool m_streamCipher;
+    int m_batchSize = 0;
 };
 
 #endif // KEEPASSX_SYMMETRICCIPHERSTREAM_H
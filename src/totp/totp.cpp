@@ -182,31 +182,26 @@ QString Totp::writeSettings(const QSharedPointer<Totp::Settings>& settings,
     }
 }
 
-QString Totp::generateTotp(const QSharedPointer<Totp::Settings>& settings, const quint64 time)
+/**
+ * Prepare the HMAC of the settings, decoding the key only when it or the
+ * algorithm changed since the last code.
+ *
+ * @return the HMAC, null if the key is invalid
+ */
+static QMessageAuthenticationCode* prepareHmac(Totp::Settings& settings)
 {
-    Q_ASSERT(!settings.isNull());
-    if (settings.isNull()) {
-        return QObject::tr("Invalid Settings", "TOTP");
-    }
-
-    const Encoder& encoder = settings->encoder;
-    uint step = settings->custom ? settings->step : encoder.step;
-    uint digits = settings->custom ? settings->digits : encoder.digits;
-
-    quint64 current;
-    if (time == 0) {
-        current = qToBigEndian(static_cast<quint64>(Clock::currentSecondsSinceEpoch()) / step);
-    } else {
-        current = qToBigEndian(time / step);
+    if (settings.hmac && settings.hmacKey == settings.key && settings.hmacAlgorithm == settings.algorithm) {
+        return settings.hmac.data();
     }
 
-    QVariant secret = Base32::decode(Base32::sanitizeInput(settings->key.toLatin1()));
+    settings.hmac.reset();
+    QVariant secret = Base32::decode(Base32::sanitizeInput(settings.key.toLatin1()));
     if (secret.isNull()) {
-        return QObject::tr("Invalid Key", "TOTP");
+        return nullptr;
     }
 
     QCryptographicHash::Algorithm cryptoHash;
-    switch (settings->algorithm) {
+    switch (settings.algorithm) {
     case Totp::Algorithm::Sha512:
         cryptoHash = QCryptographicHash::Sha512;
         break;
@@ -217,10 +212,29 @@ QString Totp::generateTotp(const QSharedPointer<Totp::Settings>& settings, const
         cryptoHash = QCryptographicHash::Sha1;
         break;
     }
-    QMessageAuthenticationCode code(cryptoHash);
-    code.setKey(secret.toByteArray());
-    code.addData(QByteArray(reinterpret_cast<char*>(&current), sizeof(current)));
-    QByteArray hmac = code.result();
+    settings.hmac.reset(new QMessageAuthenticationCode(cryptoHash, secret.toByteArray()));
+    settings.hmacKey = settings.key;
+    settings.hmacAlgorithm = settings.algorithm;
+    return settings.hmac.data();
+}
+
+/**
+ * @param counter number of the time step
+ */
+static QString generateCode(Totp::Settings& settings, const quint64 counter)
+{
+    QMessageAuthenticationCode* code = prepareHmac(settings);
+    if (!code) {
+        return QObject::tr("Invalid Key", "TOTP");
+    }
+
+    const Totp::Encoder& encoder = settings.encoder;
+    uint digits = settings.custom ? settings.digits : encoder.digits;
+
+    const quint64 current = qToBigEndian(counter);
+    code->reset();
+    code->addData(reinterpret_cast<const char*>(&current), sizeof(current));
+    QByteArray hmac = code->result();
 
     int offset = (hmac[hmac.length() - 1] & 0xf);
 
@@ -249,6 +263,50 @@ QString Totp::generateTotp(const QSharedPointer<Totp::Settings>& settings, const
     return retval;
 }
 
+static uint stepOf(const Totp::Settings& settings)
+{
+    return settings.custom ? settings.step : settings.encoder.step;
+}
+
+QString Totp::generateTotp(const QSharedPointer<Totp::Settings>& settings, const quint64 time)
+{
+    Q_ASSERT(!settings.isNull());
+    if (settings.isNull()) {
+        return QObject::tr("Invalid Settings", "TOTP");
+    }
+
+    const quint64 now = time == 0 ? static_cast<quint64>(Clock::currentSecondsSinceEpoch()) : time;
+    return generateCode(*settings, now / stepOf(*settings));
+}
+
+/**
+ * Generate the codes of many entries at once, e.g. all logins returned to
+ * the browser, reading the clock only once.
+ *
+ * @return the code of the current and of the next time step of every
+ *         settings, in the same order
+ */
+QList<QPair<QString, QString>> Totp::generateTotps(const QList<QSharedPointer<Totp::Settings>>& settings,
+                                                   const quint64 time)
+{
+    const quint64 now = time == 0 ? static_cast<quint64>(Clock::currentSecondsSinceEpoch()) : time;
+
+    QList<QPair<QString, QString>> codes;
+    codes.reserve(settings.size());
+    for (const auto& entrySettings : settings) {
+        Q_ASSERT(!entrySettings.isNull());
+        if (entrySettings.isNull()) {
+            const QString invalid = QObject::tr("Invalid Settings", "TOTP");
+            codes.append(qMakePair(invalid, invalid));
+            continue;
+        }
+
+        const quint64 counter = now / stepOf(*entrySettings);
+        codes.append(qMakePair(generateCode(*entrySettings, counter), generateCode(*entrySettings, counter + 1)));
+    }
+    return codes;
+}
+
 QList<QPair<QString, QString>> Totp::supportedEncoders()
 {
     QList<QPair<QString, QString>> encoders;
@@ -24,6 +24,7 @@
 #include <QtCore/QSharedPointer>
 #include <QtCore/qglobal.h>
 
+class QMessageAuthenticationCode;
 class QUrl;
 
 namespace Totp
@@ -61,6 +62,12 @@ namespace Totp
         bool custom;
         uint digits;
         uint step;
+        // HMAC keyed with the decoded key, prepared on first use for the
+        // key and algorithm it was created for. Generating codes updates
+        // it, so the settings must not be used by several threads at once.
+        QSharedPointer<QMessageAuthenticationCode> hmac;
+        QString hmacKey;
+        Totp::Algorithm hmacAlgorithm;
     };
 
     constexpr uint DEFAULT_STEP = 30u;
@@ -87,6 +94,8 @@ namespace Totp
                           bool forceOtp = false);
 
     QString generateTotp(const QSharedPointer<Totp::Settings>& settings, const quint64 time = 0ull);
+    QList<QPair<QString, QString>> generateTotps(const QList<QSharedPointer<Totp::Settings>>& settings,
+                                                 const quint64 time = 0ull);
 
     QList<QPair<QString, QString>> supportedEncoders();
     QList<QPair<QString, Algorithm>> supportedAlgorithms();
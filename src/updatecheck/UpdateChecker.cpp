@@ -64,10 +64,14 @@ void UpdateChecker::checkForUpdates(bool manuallyRequested)
         QNetworkRequest request(apiUrl);
         request.setRawHeader("Accept", "application/json");
 
-        m_reply = getNetMgr()->get(request);
-
-        connect(m_reply, &QNetworkReply::finished, this, &UpdateChecker::fetchFinished);
-        connect(m_reply, &QIODevice::readyRead, this, &UpdateChecker::fetchReadyRead);
+        // a check that is still waiting for a free request slot is replaced
+        cancelNetworkRequests(this);
+        const auto priority = m_isManuallyRequested ? NetworkPriority::Interactive : NetworkPriority::Normal;
+        scheduleNetworkGet(request, priority, this, [this](QNetworkReply* reply) {
+            m_reply = reply;
+            connect(m_reply, &QNetworkReply::finished, this, &UpdateChecker::fetchFinished);
+            connect(m_reply, &QIODevice::readyRead, this, &UpdateChecker::fetchReadyRead);
+        });
     }
 }
 
@@ -116,6 +116,11 @@ void ZxcvbnUnInit();
  *               The data should be freed by calling ZxcvbnFreeInfo().
  * 
  * Returns the entropy of the password (in bits).
+ *
+ * All matching state is kept on the stack or in the returned Info list and the
+ * dictionary trie is only read, so the function may be called concurrently from
+ * several threads once the dictionary is available (always when it is compiled in,
+ * after ZxcvbnInit() has returned when it is read from file).
  */
 double ZxcvbnMatch(const char *Passwd, const char *UserDict[], ZxcMatch_t **Info);
 
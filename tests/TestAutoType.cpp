@@ -23,6 +23,7 @@
 
 #include "autotype/AutoType.h"
 #include "autotype/AutoTypePlatformPlugin.h"
+#include "autotype/AutoTypeWindowMatcher.h"
 #include "autotype/test/AutoTypeTestInterface.h"
 #include "core/Config.h"
 #include "core/Resources.h"
@@ -277,6 +278,43 @@ void TestAutoType::testGlobalAutoTypeRegExp()
     m_test->clearActions();
 }
 
+void TestAutoType::testWindowMatcher()
+{
+    auto* matcher = AutoTypeWindowMatcher::forDatabase(m_db.data());
+    QCOMPARE(AutoTypeWindowMatcher::forDatabase(m_db.data()), matcher);
+
+    AutoTypeAssociations::Association association;
+    association.window = "*Browser - Login*";
+    association.sequence = "wildcard";
+    m_entry2->autoTypeAssociations()->add(association);
+
+    QList<AutoTypeMatch> matches = matcher->match("My Browser - Login Page", false, false);
+    QCOMPARE(matches.size(), 1);
+    QCOMPARE(matches.first().entry, m_entry2);
+    QCOMPARE(matches.first().sequence, QString("wildcard"));
+    QVERIFY(matcher->match("My Browser - Logout", false, false).isEmpty());
+
+    // changed associations are compiled again
+    association.window = "*Logout";
+    m_entry2->autoTypeAssociations()->update(0, association);
+    QVERIFY(matcher->match("My Browser - Login Page", false, false).isEmpty());
+    QCOMPARE(matcher->match("My Browser - Logout", false, false).size(), 1);
+
+    // titles and URLs only match if enabled
+    QVERIFY(matcher->match("An Entry Title!", false, false).isEmpty());
+    matches = matcher->match("An Entry Title!", true, false);
+    QCOMPARE(matches.size(), 1);
+    QCOMPARE(matches.first().entry, m_entry2);
+    QCOMPARE(matches.first().sequence, m_entry2->effectiveAutoTypeSequence());
+    QVERIFY(matcher->match("Dummy - http://example.org/", false, false).isEmpty());
+    QCOMPARE(matcher->match("Dummy - http://example.org/", false, true).size(), 1);
+
+    // disabling Auto-Type for the group applies to its entries
+    QCOMPARE(matcher->match("custom window", false, false).size(), 1);
+    m_group->setAutoTypeEnabled(Group::Disable);
+    QVERIFY(matcher->match("custom window", false, false).isEmpty());
+}
+
 void TestAutoType::testAutoTypeSyntaxChecks()
 {
     // Huge sequence
@@ -318,6 +356,25 @@ void TestAutoType::testAutoTypeSyntaxChecks()
     QVERIFY(!AutoType::checkHighRepetition("{delay 5000000000}"));
 }
 
+void TestAutoType::testCachedSequence()
+{
+    const QString sequence("{PASSWORD}{TAB 2}{ADD}{F5}x{TAB 0}");
+    const QString keys = QString("%1%1+%2x").arg(m_test->keyToString(Qt::Key_Tab)).arg(m_test->keyToString(Qt::Key_F5));
+
+    m_autoType->performAutoTypeWithSequence(m_entry1, sequence);
+    QCOMPARE(m_test->actionChars(), QString("mypass") + keys);
+
+    // the compiled sequence must not keep any entry data
+    m_test->clearActions();
+    m_autoType->performAutoTypeWithSequence(m_entry5, sequence);
+    QCOMPARE(m_test->actionChars(), QString("example5") + keys);
+
+    m_test->clearActions();
+    m_entry1->setPassword("changed");
+    m_autoType->performAutoTypeWithSequence(m_entry1, sequence);
+    QCOMPARE(m_test->actionChars(), QString("changed") + keys);
+}
+
 void TestAutoType::testAutoTypeEffectiveSequences()
 {
     QString defaultSequence("{USERNAME}{TAB}{PASSWORD}{ENTER}");
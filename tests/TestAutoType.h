@@ -47,7 +47,9 @@ private slots:
     void testGlobalAutoTypeUrlSubdomainMatch();
     void testGlobalAutoTypeTitleMatchDisabled();
     void testGlobalAutoTypeRegExp();
+    void testWindowMatcher();
     void testAutoTypeSyntaxChecks();
+    void testCachedSequence();
     void testAutoTypeEffectiveSequences();
 
 private:
@@ -19,6 +19,7 @@
 
 #include "TestGlobal.h"
 #include "browser/BrowserSettings.h"
+#include "browser/BrowserShared.h"
 #include "core/Tools.h"
 #include "crypto/Crypto.h"
 #include "sodium/crypto_box.h"
@@ -87,6 +88,33 @@ void TestBrowser::testDecryptMessage()
     QCOMPARE(decrypted["action"].toString(), QString("test-action"));
 }
 
+void TestBrowser::testSharedKey()
+{
+    m_browserAction->m_publicKey = SERVERPUBLICKEY;
+    m_browserAction->m_secretKey = SERVERSECRETKEY;
+    m_browserAction->m_clientPublicKey = PUBLICKEY;
+
+    const QByteArray sharedKey = m_browserAction->sharedKey();
+    QCOMPARE(sharedKey.size(), static_cast<int>(crypto_box_BEFORENMBYTES));
+    QCOMPARE(m_browserAction->sharedKey(), sharedKey);
+
+    // the shared key is recomputed once the client switches keys
+    QJsonObject json;
+    json["action"] = "change-public-keys";
+    json["publicKey"] = PUBLICKEY;
+    json["nonce"] = NONCE;
+    m_browserAction->processClientMessage(json);
+    QVERIFY(m_browserAction->m_sharedKey.isEmpty());
+    QVERIFY(m_browserAction->sharedKey() != sharedKey);
+
+    QString message = "+zjtntnk4rGWSl/Ph7Vqip/swvgeupk4lNgHEm2OO3ujNr0OMz6eQtGwjtsj+/rP";
+    QVERIFY(m_browserAction->decryptMessage(message, NONCE).isEmpty());
+
+    // invalid keys don't produce a shared key
+    m_browserAction->m_clientPublicKey = "invalid";
+    QVERIFY(m_browserAction->sharedKey().isEmpty());
+}
+
 void TestBrowser::testGetBase64FromKey()
 {
     unsigned char pk[crypto_box_PUBLICKEYBYTES];
@@ -338,6 +366,38 @@ void TestBrowser::testSearchEntriesWithAdditionalURLs()
     QCOMPARE(additionalResult[0]->url(), QString("https://github.com/"));
 }
 
+void TestBrowser::testSearchEntriesIndex()
+{
+    auto db = QSharedPointer<Database>::create();
+    auto* root = db->rootGroup();
+
+    QStringList urls = {"https://github.com/", "https://www.example.com", "https://login.example.com"};
+    auto entries = createEntries(urls, root);
+
+    auto result = m_browserService->searchEntries(db, "https://www.example.com", "https://www.example.com");
+    QCOMPARE(result.length(), 1);
+    QCOMPARE(result[0], entries[1]);
+
+    // Modified, moved and recycled entries are picked up by the next search
+    entries[0]->setUrl("https://www.example.com/login");
+    result = m_browserService->searchEntries(db, "https://www.example.com", "https://www.example.com");
+    QCOMPARE(result.length(), 2);
+    QCOMPARE(result[0], entries[0]);
+    QCOMPARE(result[1], entries[1]);
+
+    auto* group = new Group();
+    group->setParent(root);
+    group->setSearchingEnabled(Group::Disable);
+    entries[0]->setGroup(group);
+    db->recycleEntry(entries[1]);
+    result = m_browserService->searchEntries(db, "https://www.example.com", "https://www.example.com");
+    QCOMPARE(result.length(), 0);
+
+    result = m_browserService->searchEntries(db, "https://sub.login.example.com", "https://sub.login.example.com");
+    QCOMPARE(result.length(), 1);
+    QCOMPARE(result[0], entries[2]);
+}
+
 void TestBrowser::testInvalidEntries()
 {
     auto db = QSharedPointer<Database>::create();
@@ -663,3 +723,35 @@ void TestBrowser::testBestMatchingWithAdditionalURLs()
     QCOMPARE(sorted.length(), 1);
     QCOMPARE(sorted[0]->url(), urls[0]);
 }
+
+void TestBrowser::testMessageBuffer()
+{
+    BrowserShared::MessageBuffer buffer;
+
+    // A message split across reads is only complete after its last part
+    buffer.append(R"({"action":"get-logins","message":"{\"a\"})");
+    QVERIFY(buffer.takeMessages().isEmpty());
+    buffer.append(R"(:1}"})");
+    auto messages = buffer.takeMessages();
+    QCOMPARE(messages.size(), 1);
+    QCOMPARE(messages[0], QByteArray(R"({"action":"get-logins","message":"{\"a\":1}"})"));
+
+    // Pipelined messages are split, a trailing partial one is kept
+    buffer.append(R"({"a":"}"}{"b":[1,{"c":2}]}{"c")");
+    messages = buffer.takeMessages();
+    QCOMPARE(messages.size(), 2);
+    QCOMPARE(messages[0], QByteArray(R"({"a":"}"})"));
+    QCOMPARE(messages[1], QByteArray(R"({"b":[1,{"c":2}]})"));
+    buffer.append(R"(:3})");
+    messages = buffer.takeMessages();
+    QCOMPARE(messages.size(), 1);
+    QCOMPARE(messages[0], QByteArray(R"({"c":3})"));
+
+    // Oversized messages are dropped
+    buffer.append("{\"a\":\"" + QByteArray(BrowserShared::NATIVEMSG_MAX_LENGTH, 'a'));
+    QVERIFY(buffer.takeMessages().isEmpty());
+    buffer.append(R"("}{"d":4})");
+    messages = buffer.takeMessages();
+    QCOMPARE(messages.size(), 1);
+    QCOMPARE(messages[0], QByteArray(R"({"d":4})"));
+}
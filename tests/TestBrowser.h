@@ -35,6 +35,7 @@ private slots:
     void testChangePublicKeys();
     void testEncryptMessage();
     void testDecryptMessage();
+    void testSharedKey();
     void testGetBase64FromKey();
     void testIncrementNonce();
 
@@ -46,12 +47,14 @@ private slots:
     void testSearchEntriesByUUID();
     void testSearchEntriesWithPort();
     void testSearchEntriesWithAdditionalURLs();
+    void testSearchEntriesIndex();
     void testInvalidEntries();
     void testSubdomainsAndPaths();
     void testSortEntries();
     void testValidURLs();
     void testBestMatchingCredentials();
     void testBestMatchingWithAdditionalURLs();
+    void testMessageBuffer();
 
 private:
     QList<Entry*> createEntries(QStringList& urls, Group* root) const;
@@ -31,15 +31,19 @@
 #include "cli/Add.h"
 #include "cli/AddGroup.h"
 #include "cli/Analyze.h"
+#include "cli/Batch.h"
 #include "cli/Clip.h"
 #include "cli/Command.h"
+#include "cli/CommandServer.h"
 #include "cli/Create.h"
 #include "cli/Diceware.h"
 #include "cli/Edit.h"
 #include "cli/Estimate.h"
 #include "cli/Export.h"
 #include "cli/Generate.h"
+#include "cli/GenerateDatabase.h"
 #include "cli/Help.h"
+#include "cli/HibpIndex.h"
 #include "cli/Import.h"
 #include "cli/Info.h"
 #include "cli/List.h"
@@ -47,6 +51,7 @@
 #include "cli/Merge.h"
 #include "cli/Move.h"
 #include "cli/Open.h"
+#include "cli/Probe.h"
 #include "cli/Remove.h"
 #include "cli/RemoveGroup.h"
 #include "cli/Show.h"
@@ -54,6 +59,8 @@
 
 #include <QClipboard>
 #include <QFuture>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QSet>
 #include <QSignalSpy>
 #include <QTextStream>
@@ -211,21 +218,65 @@ void TestCli::setInput(const QStringList& input)
     m_stdin->seek(pos);
 }
 
+void TestCli::testBatch()
+{
+    Commands::setupCommands(false);
+    Batch batchCmd;
+
+    setInput({"a",
+              "# comment",
+              "add -q -u newuser /newentry",
+              "",
+              "mkdir -q General/NewGroup",
+              "show -a Title \"/Sample Entry\"",
+              "rm /doesnotexist",
+              "serve"});
+    QCOMPARE(execCmd(batchCmd, {"batch", "--format", "json", m_dbFile->fileName()}), EXIT_FAILURE);
+
+    QList<QJsonObject> records;
+    for (const auto& line : m_stdout->readAll().split('\n')) {
+        if (!line.isEmpty()) {
+            records << QJsonDocument::fromJson(line).object();
+        }
+    }
+    QCOMPARE(records.size(), 5);
+    QCOMPARE(records[0]["line"].toInt(), 2);
+    QCOMPARE(records[0]["command"].toString(), QString("add"));
+    QCOMPARE(records[0]["exitCode"].toInt(), EXIT_SUCCESS);
+    QCOMPARE(records[1]["exitCode"].toInt(), EXIT_SUCCESS);
+    QCOMPARE(records[2]["output"].toString(), QString("Sample Entry\n"));
+    QCOMPARE(records[3]["exitCode"].toInt(), EXIT_FAILURE);
+    QVERIFY(!records[3]["error"].toString().isEmpty());
+    QCOMPARE(records[4]["exitCode"].toInt(), EXIT_FAILURE);
+
+    // All changes were saved once at the end
+    auto db = readDatabase();
+    QVERIFY(db);
+    auto* entry = db->rootGroup()->findEntryByPath("/newentry");
+    QVERIFY(entry);
+    QCOMPARE(entry->username(), QString("newuser"));
+    QVERIFY(db->rootGroup()->findGroupByPath("/General/NewGroup"));
+}
+
 void TestCli::testBatchCommands()
 {
     Commands::setupCommands(false);
     QVERIFY(Commands::getCommand("add"));
     QVERIFY(Commands::getCommand("analyze"));
+    QVERIFY(Commands::getCommand("batch"));
     QVERIFY(Commands::getCommand("clip"));
     QVERIFY(Commands::getCommand("close"));
     QVERIFY(Commands::getCommand("db-create"));
+    QVERIFY(Commands::getCommand("db-generate"));
     QVERIFY(Commands::getCommand("db-info"));
+    QVERIFY(Commands::getCommand("db-probe"));
     QVERIFY(Commands::getCommand("diceware"));
     QVERIFY(Commands::getCommand("edit"));
     QVERIFY(Commands::getCommand("estimate"));
     QVERIFY(Commands::getCommand("export"));
     QVERIFY(Commands::getCommand("generate"));
     QVERIFY(Commands::getCommand("help"));
+    QVERIFY(Commands::getCommand("hibp-index"));
     QVERIFY(Commands::getCommand("import"));
     QVERIFY(Commands::getCommand("locate"));
     QVERIFY(Commands::getCommand("ls"));
@@ -235,9 +286,10 @@ void TestCli::testBatchCommands()
     QVERIFY(Commands::getCommand("open"));
     QVERIFY(Commands::getCommand("rm"));
     QVERIFY(Commands::getCommand("rmdir"));
+    QVERIFY(Commands::getCommand("serve"));
     QVERIFY(Commands::getCommand("show"));
     QVERIFY(!Commands::getCommand("doesnotexist"));
-    QCOMPARE(Commands::getCommands().size(), 22);
+    QCOMPARE(Commands::getCommands().size(), 27);
 }
 
 void TestCli::testInteractiveCommands()
@@ -248,13 +300,16 @@ void TestCli::testInteractiveCommands()
     QVERIFY(Commands::getCommand("clip"));
     QVERIFY(Commands::getCommand("close"));
     QVERIFY(Commands::getCommand("db-create"));
+    QVERIFY(Commands::getCommand("db-generate"));
     QVERIFY(Commands::getCommand("db-info"));
+    QVERIFY(Commands::getCommand("db-probe"));
     QVERIFY(Commands::getCommand("diceware"));
     QVERIFY(Commands::getCommand("edit"));
     QVERIFY(Commands::getCommand("estimate"));
     QVERIFY(Commands::getCommand("exit"));
     QVERIFY(Commands::getCommand("generate"));
     QVERIFY(Commands::getCommand("help"));
+    QVERIFY(Commands::getCommand("hibp-index"));
     QVERIFY(Commands::getCommand("locate"));
     QVERIFY(Commands::getCommand("ls"));
     QVERIFY(Commands::getCommand("merge"));
@@ -266,7 +321,7 @@ void TestCli::testInteractiveCommands()
     QVERIFY(Commands::getCommand("rmdir"));
     QVERIFY(Commands::getCommand("show"));
     QVERIFY(!Commands::getCommand("doesnotexist"));
-    QCOMPARE(Commands::getCommands().size(), 22);
+    QCOMPARE(Commands::getCommands().size(), 25);
 }
 
 void TestCli::testAdd()
@@ -434,6 +489,61 @@ void TestCli::testAnalyze()
     QVERIFY(output.contains("123"));
     m_stderr->readLine(); // Skip password prompt
     QCOMPARE(m_stderr->readAll(), QByteArray());
+
+    // binary indexes written by hibp-index are accepted as well
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString indexPath = tempDir.filePath("hibp.idx");
+    HibpIndex hibpIndexCmd;
+    QVERIFY(hibpIndexCmd.getDescriptionLine().contains(hibpIndexCmd.name));
+    execCmd(hibpIndexCmd, {"hibp-index", hibpPath, indexPath});
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    m_stdout->readAll();
+
+    setInput("a");
+    execCmd(analyzeCmd, {"analyze", "--hibp", indexPath, m_dbFile->fileName()});
+    output = m_stdout->readAll();
+    QVERIFY(output.contains("Sample Entry"));
+    QVERIFY(output.contains("123"));
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+
+    // one record per entry with problems, without progress messages
+    setInput("a");
+    execCmd(analyzeCmd, {"analyze", "--hibp", indexPath, "--health", "--format", "json", m_dbFile->fileName()});
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    bool found = false;
+    for (const auto& line : m_stdout->readAll().split('\n')) {
+        if (line.isEmpty()) {
+            continue;
+        }
+        const auto record = QJsonDocument::fromJson(line).object();
+        QVERIFY(!record.isEmpty());
+        if (record["path"].toString() == "/Sample Entry") {
+            QCOMPARE(record["leaked"].toString(), QString("true"));
+            QCOMPARE(record["leakCount"].toString(), QString("123"));
+            QVERIFY(!record["quality"].toString().isEmpty());
+            found = true;
+        }
+    }
+    QVERIFY(found);
+
+    // the health can be checked without a HIBP file
+    setInput("a");
+    execCmd(analyzeCmd, {"analyze", "--health", m_dbFile->fileName()});
+    output = m_stdout->readAll();
+    QVERIFY(output.contains("Password for 'Sample Entry' is "));
+    QVERIFY(!output.contains("leaked"));
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+
+    // and so can duplicates
+    setInput("a");
+    execCmd(analyzeCmd, {"analyze", "--duplicates", m_dbFile->fileName()});
+    QVERIFY(!m_stdout->readAll().contains("are duplicates"));
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
 }
 
 void TestCli::testClip()
@@ -684,6 +794,48 @@ void TestCli::testInfo()
     QCOMPARE(m_stdout->readLine(), QByteArray("Cipher: AES 256-bit\n"));
     QCOMPARE(m_stdout->readLine(), QByteArray("KDF: AES (6000 rounds)\n"));
     QCOMPARE(m_stdout->readLine(), QByteArray("Recycle bin is enabled.\n"));
+
+    // Test with memory option.
+    setInput("a");
+    execCmd(infoCmd, {"db-info", "-q", "--memory", m_dbFile->fileName()});
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    const QList<QByteArray> lines = m_stdout->readAll().split('\n');
+    QVERIFY(lines.size() > 7);
+    QVERIFY(lines.at(6).startsWith("Estimated memory usage: "));
+    QVERIFY(lines.at(7).startsWith("  Entries: "));
+}
+
+void TestCli::testProbe()
+{
+    Probe probeCmd;
+    QVERIFY(!probeCmd.name.isEmpty());
+    QVERIFY(probeCmd.getDescriptionLine().contains(probeCmd.name));
+
+    // no password is needed
+    execCmd(probeCmd, {"db-probe", m_dbFile->fileName()});
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    QCOMPARE(m_stdout->readLine(),
+             QString("%1\tKDBX 3.1\tAES 256-bit\tAES (6000 rounds)\tGZip\n").arg(m_dbFile->fileName()).toUtf8());
+
+    // directories are scanned for databases
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(QFile::copy(m_dbFile->fileName(), tempDir.filePath("a.kdbx")));
+    QVERIFY(QDir(tempDir.path()).mkdir("sub"));
+    QVERIFY(QFile::copy(m_dbFile->fileName(), tempDir.filePath("sub/b.kdbx")));
+    execCmd(probeCmd, {"db-probe", tempDir.path()});
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    QVERIFY(m_stdout->readLine().startsWith(tempDir.filePath("a.kdbx").toUtf8() + "\tKDBX"));
+    QVERIFY(m_stdout->readLine().startsWith(tempDir.filePath("sub/b.kdbx").toUtf8() + "\tKDBX"));
+    QCOMPARE(m_stdout->readAll(), QByteArray());
+
+    // files that are not databases are reported
+    QFile notDatabase(tempDir.filePath("c.kdbx"));
+    QVERIFY(notDatabase.open(QIODevice::WriteOnly));
+    notDatabase.write("not a database");
+    notDatabase.close();
+    QCOMPARE(execCmd(probeCmd, {"db-probe", notDatabase.fileName()}), EXIT_FAILURE);
+    QVERIFY(m_stderr->readAll().contains("Not a KeePass database."));
 }
 
 void TestCli::testDiceware()
@@ -704,6 +856,16 @@ void TestCli::testDiceware()
     passphrase = m_stdout->readLine();
     QCOMPARE(passphrase.split(" ").size(), 10);
 
+    execCmd(dicewareCmd, {"diceware", "-W", "3", "-c", "200"});
+    const auto passphrases = QString(m_stdout->readAll()).split("\n", QString::SkipEmptyParts);
+    QCOMPARE(passphrases.size(), 200);
+    for (const auto& line : passphrases) {
+        QCOMPARE(line.split(" ").size(), 3);
+    }
+
+    execCmd(dicewareCmd, {"diceware", "-c", "0"});
+    QCOMPARE(m_stderr->readLine(), QByteArray("Invalid count 0\n"));
+
     // Testing with invalid word count
     execCmd(dicewareCmd, {"diceware", "-W", "-10"});
     QCOMPARE(m_stderr->readLine(), QByteArray("Invalid word count -10\n"));
@@ -1045,6 +1207,86 @@ void TestCli::testGenerate()
     // Testing with invalid word count format
     execCmd(generateCmd, {"generate", "-L", "bleuh"});
     QCOMPARE(m_stderr->readLine(), QByteArray("Invalid password length bleuh\n"));
+
+    execCmd(generateCmd, {"generate", "-L", "8", "-n", "--count", "500"});
+    const auto passwords = QString(m_stdout->readAll()).split("\n", QString::SkipEmptyParts);
+    QCOMPARE(passwords.size(), 500);
+    QRegularExpression regex("^[0-9]{8}$");
+    for (const auto& password : passwords) {
+        QVERIFY2(regex.match(password).hasMatch(), qPrintable(password));
+    }
+
+    execCmd(generateCmd, {"generate", "-c", "-1"});
+    QCOMPARE(m_stderr->readLine(), QByteArray("Invalid count -1\n"));
+}
+
+void TestCli::testGenerateDatabase()
+{
+    GenerateDatabase generateCmd;
+    QVERIFY(!generateCmd.name.isEmpty());
+    QVERIFY(generateCmd.getDescriptionLine().contains(generateCmd.name));
+
+    QScopedPointer<QTemporaryDir> testDir(new QTemporaryDir());
+    const QStringList options = {"--seed",
+                                 "7",
+                                 "--groups",
+                                 "3",
+                                 "--entries",
+                                 "20",
+                                 "--history",
+                                 "2",
+                                 "--attachments",
+                                 "5",
+                                 "--icons",
+                                 "2",
+                                 "--references",
+                                 "3",
+                                 "--attributes",
+                                 "2"};
+
+    const QString dbFilename = testDir->path() + "/testGenerate.kdbx";
+    setInput({"a", "a"});
+    execCmd(generateCmd, QStringList({"db-generate", dbFilename, "-p"}) + options);
+    m_stderr->readLine(); // Skip password prompt
+    m_stderr->readLine(); // Skip password repeat prompt
+    QCOMPARE(m_stdout->readLine(), QByteArray("Successfully generated new database with 20 entries.\n"));
+
+    auto db = readDatabase(dbFilename, "a");
+    QVERIFY(db);
+    const QList<Entry*> entries = db->rootGroup()->entriesRecursive();
+    QCOMPARE(entries.size(), 20);
+    QCOMPARE(db->rootGroup()->groupsRecursive(false).size(), 3);
+    QCOMPARE(db->metadata()->customIconsOrder().size(), 2);
+
+    int attachments = 0;
+    int references = 0;
+    for (const Entry* entry : entries) {
+        QCOMPARE(entry->historyItems().size(), 2);
+        QCOMPARE(entry->attributes()->customKeys().size(), 2);
+        attachments += entry->attachments()->keys().size();
+        if (entry->hasReferences()) {
+            ++references;
+        }
+    }
+    QCOMPARE(attachments, 5);
+    QCOMPARE(references, 3);
+
+    // The same seed generates the same content
+    const QString secondFilename = testDir->path() + "/testGenerate2.kdbx";
+    setInput({"a", "a"});
+    execCmd(generateCmd, QStringList({"db-generate", secondFilename, "-p"}) + options);
+    auto secondDb = readDatabase(secondFilename, "a");
+    QVERIFY(secondDb);
+    const QList<Entry*> secondEntries = secondDb->rootGroup()->entriesRecursive();
+    QCOMPARE(secondEntries.size(), entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        QCOMPARE(secondEntries.at(i)->uuid(), entries.at(i)->uuid());
+        QCOMPARE(secondEntries.at(i)->password(), entries.at(i)->password());
+    }
+
+    // Should refuse invalid counts
+    execCmd(generateCmd, {"db-generate", testDir->path() + "/testGenerate3.kdbx", "--entries", "-1"});
+    QCOMPARE(m_stderr->readLine(), QByteArray("Invalid value -1 for option --entries.\n"));
 }
 
 void TestCli::testImport()
@@ -1144,6 +1386,43 @@ void TestCli::testImport()
 
     db = readDatabase(databaseFilenameQuiet, "a");
     QVERIFY(db);
+
+    // Batch import of KeePass1 databases, one group per file
+    const QString basicKdb = QString(KEEPASSX_TEST_DATA_DIR).append("/basic.kdb");
+    const QString twofishKdb = QString(KEEPASSX_TEST_DATA_DIR).append("/Twofish.kdb");
+    databaseFilename = testDir->path() + "/testImportKdb.kdbx";
+    setInput({"a", "a", "masterpw"});
+    execCmd(importCmd, {"import", "-p", "--kdb", basicKdb, twofishKdb, databaseFilename});
+
+    QCOMPARE(m_stderr->readLine(), QByteArray("Enter password to encrypt database (optional): \n"));
+    QCOMPARE(m_stderr->readLine(), QByteArray("Repeat password: \n"));
+    QCOMPARE(m_stderr->readLine(), QByteArray("Enter password of the KeePass1 databases: \n"));
+    QCOMPARE(m_stdout->readLine(), QByteArray("[1/2] Imported ") + basicKdb.toUtf8() + ".\n");
+    QCOMPARE(m_stdout->readLine(), QByteArray("[2/2] Imported ") + twofishKdb.toUtf8() + ".\n");
+    QCOMPARE(m_stdout->readLine(), QByteArray("Successfully imported database.\n"));
+
+    db = readDatabase(databaseFilename, "a");
+    QVERIFY(db);
+    QVERIFY(db->rootGroup()->findGroupByPath("/basic/Internet"));
+    QVERIFY(db->rootGroup()->findGroupByPath("/Twofish/Twofish"));
+
+    // A file that cannot be imported fails the whole batch
+    databaseFilename = testDir->path() + "/testImportKdbFailed.kdbx";
+    setInput({"a", "a", "wrong"});
+    execCmd(importCmd, {"import", "-p", "--kdb", basicKdb, databaseFilename});
+
+    m_stderr->readLine(); // Skip password prompts
+    m_stderr->readLine();
+    m_stderr->readLine();
+    QVERIFY(m_stderr->readLine().startsWith("[1/1] Unable to import "));
+    QCOMPARE(m_stderr->readLine(),
+             QByteArray("1 database(s) could not be imported, the new database was not saved.\n"));
+    QVERIFY(!QFile::exists(databaseFilename));
+
+    // Several sources are only accepted with --kdb
+    execCmd(importCmd, {"import", m_xmlFile->fileName(), basicKdb, databaseFilename});
+    QCOMPARE(m_stdout->readAll(), QByteArray());
+    QVERIFY(!QFile::exists(databaseFilename));
 }
 
 void TestCli::testKeyFileOption()
@@ -1274,6 +1553,25 @@ void TestCli::testList()
     m_stderr->readLine(); // skip password prompt
     QCOMPARE(m_stderr->readAll(), QByteArray("Cannot find group /DoesNotExist/.\n"));
     QCOMPARE(m_stdout->readAll(), QByteArray());
+
+    setInput("a");
+    execCmd(listCmd, {"ls", "-R", "--format", "tsv", m_dbFile->fileName(), "/Homebanking"});
+    auto lines = m_stdout->readAll().split('\n');
+    QCOMPARE(lines.size(), 3);
+    QVERIFY(lines[0].startsWith("group\t/Homebanking/Subgroup/\tSubgroup\t"));
+    QVERIFY(lines[1].startsWith("entry\t/Homebanking/Subgroup/Subgroup Entry\tSubgroup Entry\t"));
+
+    setInput("a");
+    execCmd(listCmd, {"ls", "--format", "json", m_dbFile->fileName()});
+    auto record = QJsonDocument::fromJson(m_stdout->readLine()).object();
+    QCOMPARE(record["type"].toString(), QString("entry"));
+    QCOMPARE(record["path"].toString(), QString("/Sample Entry"));
+    QCOMPARE(record["uuid"].toString().size(), 32);
+
+    setInput("a");
+    execCmd(listCmd, {"ls", "--format", "xml", m_dbFile->fileName()});
+    QVERIFY(m_stderr->readAll().contains("Unsupported format xml."));
+    QCOMPARE(m_stdout->readAll(), QByteArray());
 }
 
 void TestCli::testLocate()
@@ -1323,6 +1621,19 @@ void TestCli::testLocate()
     execCmd(locateCmd, {"locate", tmpFile.fileName(), "Entry"});
     QCOMPARE(m_stdout->readAll(),
              QByteArray("/Sample Entry\n/General/New Entry\n/Homebanking/Subgroup/Subgroup Entry\n"));
+
+    setInput("a");
+    execCmd(locateCmd, {"locate", "--format", "json", tmpFile.fileName(), "Entry"});
+    QStringList paths;
+    for (const auto& line : m_stdout->readAll().split('\n')) {
+        if (!line.isEmpty()) {
+            paths << QJsonDocument::fromJson(line).object()["path"].toString();
+        }
+    }
+    QCOMPARE(paths,
+             QStringList() << "/Sample Entry"
+                           << "/General/New Entry"
+                           << "/Homebanking/Subgroup/Subgroup Entry");
 }
 
 void TestCli::testMerge()
@@ -1447,6 +1758,34 @@ void TestCli::testMerge()
     execCmd(mergeCmd, {"merge", "-q", sourceFile.fileName(), sourceFile.fileName()});
     QCOMPARE(m_stderr->readAll(), QByteArray());
     QCOMPARE(m_stdout->readAll(), QByteArray());
+
+    // several databases can be merged in one run
+    auto* otherEntry = new Entry();
+    otherEntry->setUuid(QUuid::createUuid());
+    otherEntry->setTitle("Other Website");
+    group->addEntry(otherEntry);
+
+    TemporaryFile sourceFile2;
+    sourceFile2.open();
+    sourceFile2.close();
+    db->saveAs(sourceFile2.fileName());
+
+    setInput("a");
+    execCmd(mergeCmd, {"merge", "-s", targetFile2.fileName(), sourceFile.fileName(), sourceFile2.fileName()});
+    QList<QByteArray> outLines4 = m_stdout->readAll().split('\n');
+    QVERIFY(outLines4.contains(QString("Successfully merged %1, %2 into %3.")
+                                   .arg(sourceFile.fileName(), sourceFile2.fileName(), targetFile2.fileName())
+                                   .toUtf8()));
+
+    mergedDb = QSharedPointer<Database>::create();
+    QVERIFY(mergedDb->open(targetFile2.fileName(), oldKey));
+    QVERIFY(mergedDb->rootGroup()->findEntryByPath("/Internet/Some Website"));
+    QVERIFY(mergedDb->rootGroup()->findEntryByPath("/Internet/Other Website"));
+
+    // all sources have to be readable
+    setInput("a");
+    execCmd(mergeCmd, {"merge", "-s", targetFile2.fileName(), sourceFile.fileName(), "/nonexistent.kdbx"});
+    QVERIFY(m_stderr->readAll().contains("Error reading merge file"));
 }
 
 void TestCli::testMergeWithKeys()
@@ -1696,6 +2035,61 @@ void TestCli::testRemoveQuiet()
     QVERIFY(!db->rootGroup()->findEntryByPath(QString("/%1/Sample Entry").arg(Group::tr("Recycle Bin"))));
 }
 
+void TestCli::testServe()
+{
+    Commands::setupCommands(false);
+
+    auto db = readDatabase();
+    QVERIFY(db);
+    CommandServer server(db, 60);
+    QSignalSpy finishedSpy(&server, SIGNAL(finished()));
+    QVERIFY(server.listen());
+
+    CommandServer otherServer(readDatabase(), 60);
+    QVERIFY(!otherServer.listen());
+
+    QByteArray out;
+    QByteArray err;
+    QCOMPARE(server.execute({"ls"}, out, err), EXIT_SUCCESS);
+    QVERIFY(out.startsWith("Sample Entry\n"));
+    QCOMPARE(err, QByteArray());
+
+    QCOMPARE(server.execute({"serve"}, out, err), EXIT_FAILURE);
+    QCOMPARE(out, QByteArray());
+    QVERIFY(!err.isEmpty());
+
+    // Commands which prompt or wait are refused
+    QCOMPARE(server.execute({"clip", "/Sample Entry"}, out, err), EXIT_FAILURE);
+    QVERIFY(err.contains("cannot be served"));
+    QCOMPARE(server.execute({"add", "-p", "/New Entry"}, out, err), EXIT_FAILURE);
+    QVERIFY(err.contains("cannot be served"));
+    QVERIFY(!db->rootGroup()->findEntryByPath("/New Entry"));
+
+    // Invocations for the database are run by the server without unlocking it again
+    int exitCode = EXIT_FAILURE;
+    const QString dbPath = m_dbFile->fileName();
+    auto future = QtConcurrent::run(
+        [&] { return CommandServer::forward(dbPath, {"show", dbPath, "/Sample Entry"}, db->key(), exitCode); });
+    QTRY_VERIFY(future.isFinished());
+    QVERIFY(future.result());
+    QCOMPARE(exitCode, EXIT_SUCCESS);
+    QVERIFY(m_stdout->readAll().contains("Title: Sample Entry"));
+
+    // but only with the key of the database
+    auto wrongKey = QSharedPointer<CompositeKey>::create();
+    wrongKey->addKey(QSharedPointer<PasswordKey>::create("wrong"));
+    future = QtConcurrent::run(
+        [&] { return CommandServer::forward(dbPath, {"show", dbPath, "/Sample Entry"}, wrongKey, exitCode); });
+    QTRY_VERIFY(future.isFinished());
+    QVERIFY(future.result());
+    QCOMPARE(exitCode, EXIT_FAILURE);
+    QVERIFY(!m_stdout->readAll().contains("Title: Sample Entry"));
+
+    server.close();
+    QCOMPARE(finishedSpy.count(), 1);
+    QVERIFY(!CommandServer::forward(dbPath, {"ls", dbPath}, db->key(), exitCode));
+}
+
 void TestCli::testShow()
 {
     Show showCmd;
@@ -1736,6 +2130,17 @@ void TestCli::testShow()
     execCmd(showCmd, {"show", "-a", "Title", m_dbFile->fileName(), "/Sample Entry"});
     QCOMPARE(m_stdout->readAll(), QByteArray("Sample Entry\n"));
 
+    setInput("a");
+    execCmd(showCmd, {"show", "--format", "json", m_dbFile->fileName(), "/Sample Entry"});
+    auto record = QJsonDocument::fromJson(m_stdout->readAll()).object();
+    QCOMPARE(record["Title"].toString(), QString("Sample Entry"));
+    QCOMPARE(record["UserName"].toString(), QString("User Name"));
+    QCOMPARE(record["Password"].toString(), QString("PROTECTED"));
+
+    setInput("a");
+    execCmd(showCmd, {"show", "--format", "tsv", "-a", "Title", "-a", "Notes", m_dbFile->fileName(), "/Sample Entry"});
+    QCOMPARE(m_stdout->readAll(), QByteArray("Title\tSample Entry\nNotes\tNotes\n"));
+
     setInput("a");
     execCmd(showCmd, {"show", "-a", "Password", m_dbFile->fileName(), "/Sample Entry"});
     QCOMPARE(m_stdout->readAll(), QByteArray("Password\n"));
@@ -46,6 +46,7 @@ private slots:
     void init();
     void cleanup();
 
+    void testBatch();
     void testBatchCommands();
     void testAdd();
     void testAddGroup();
@@ -61,8 +62,10 @@ private slots:
     void testExport();
     void testGenerate_data();
     void testGenerate();
+    void testGenerateDatabase();
     void testImport();
     void testInfo();
+    void testProbe();
     void testKeyFileOption();
     void testNoPasswordOption();
     void testHelp();
@@ -76,6 +79,7 @@ private slots:
     void testRemove();
     void testRemoveGroup();
     void testRemoveQuiet();
+    void testServe();
     void testShow();
     void testInvalidDbFiles();
     void testYubiKeyOption();
@@ -18,6 +18,7 @@
 #include "TestConfig.h"
 
 #include <QList>
+#include <QSettings>
 #include <QTest>
 
 #include "config-keepassx-tests.h"
@@ -43,3 +44,25 @@ void TestConfig::testUpgrade()
 
     tempFile.remove();
 }
+
+// changed values are served from memory right away, but only written on sync
+void TestConfig::testWriteBehind()
+{
+    TemporaryFile configFile;
+    TemporaryFile localConfigFile;
+    QVERIFY(configFile.open());
+    QVERIFY(localConfigFile.open());
+    configFile.close();
+    localConfigFile.close();
+    Config::createConfigFromFile(configFile.fileName(), localConfigFile.fileName());
+
+    config()->set(Config::GUI_Language, QString("fr"));
+    QCOMPARE(config()->get(Config::GUI_Language).toString(), QString("fr"));
+    QVERIFY(!QSettings(configFile.fileName(), QSettings::IniFormat).contains("GUI/Language"));
+
+    config()->sync();
+    QCOMPARE(QSettings(configFile.fileName(), QSettings::IniFormat).value("GUI/Language").toString(), QString("fr"));
+
+    config()->remove(Config::GUI_Language);
+    QCOMPARE(config()->get(Config::GUI_Language).toString(), QString("system"));
+}
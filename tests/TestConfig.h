@@ -25,6 +25,7 @@ class TestConfig : public QObject
     Q_OBJECT
 private slots:
     void testUpgrade();
+    void testWriteBehind();
 };
 
 #endif // KEEPASSX_TESTCONFIG_H
@@ -61,3 +61,37 @@ void TestCryptoHash::test()
              QByteArray::fromHex("0d41b612584ed39ff72944c29494573e40f4bb95283455fae2e0be1e3565aa9f48057d59e6ffd777970e2"
                                  "82871c25a549a2763e5b724794f312c97021c42f91d"));
 }
+
+void TestCryptoHash::testParts()
+{
+    const QVector<QByteArray> parts = {QByteArray("KeePa"), QByteArray(), QByteArray("ssX")};
+    QCOMPARE(CryptoHash::hash(parts, CryptoHash::Sha256),
+             QByteArray::fromHex("0b56e5f65263e747af4a833bd7dd7ad26a64d7a4de7c68e52364893dca0766b4"));
+
+    const QByteArray key("secret");
+    const QByteArray expected256 =
+        QByteArray::fromHex("a74520d07e502e283dd9fa21b36a7f5827f9ee855ed98007a3ca35f4d433d167");
+    QCOMPARE(CryptoHash::hmac(QByteArray("KeePassX"), key, CryptoHash::Sha256), expected256);
+    QCOMPARE(CryptoHash::hmac(parts, key, CryptoHash::Sha256), expected256);
+    QCOMPARE(CryptoHash::hmac(parts, key, CryptoHash::Sha512),
+             QByteArray::fromHex("593f1635ac8b8dfa3ded20e7e16486160a593ec556c3ba0335c52f3c9fb409f3582f0a304889dddd6afa3"
+                                 "45c6b26c3c20c460dc50e563a6fdcc6ed01f9571fd1"));
+}
+
+void TestCryptoHash::testReset()
+{
+    CryptoHash cryptoHash(CryptoHash::Sha256);
+    cryptoHash.addData(QByteArray("garbage"));
+    cryptoHash.reset();
+    cryptoHash.addData(QByteArray("KeePassX"));
+    QCOMPARE(cryptoHash.result(),
+             QByteArray::fromHex("0b56e5f65263e747af4a833bd7dd7ad26a64d7a4de7c68e52364893dca0766b4"));
+
+    // the HMAC key survives a reset
+    CryptoHash hmac(CryptoHash::Sha256, true);
+    hmac.setKey(QByteArray("secret"));
+    hmac.addData(QByteArray("garbage"));
+    hmac.reset();
+    hmac.addData(QByteArray("KeePassX"));
+    QCOMPARE(hmac.result(), QByteArray::fromHex("a74520d07e502e283dd9fa21b36a7f5827f9ee855ed98007a3ca35f4d433d167"));
+}
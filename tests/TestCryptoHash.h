@@ -27,6 +27,8 @@ class TestCryptoHash : public QObject
 private slots:
     void initTestCase();
     void test();
+    void testParts();
+    void testReset();
 };
 
 #endif // KEEPASSX_TESTCRYPTOHASH_H
@@ -109,3 +109,15 @@ void TestCsvExporter::testNestedGroups()
             .append(ExpectedHeaderLine)
             .append("\"Passwords/Test Group Name/Test Sub Group Name\",\"Test Entry Title\",\"\",\"\",\"\",\"\"")));
 }
+
+void TestCsvExporter::testWriteFailure()
+{
+    auto* entry = new Entry();
+    entry->setGroup(m_db->rootGroup());
+    entry->setTitle("Test Entry Title");
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QVERIFY(!m_csvExporter->exportDatabase(&buffer, m_db));
+    QVERIFY(!m_csvExporter->errorString().isEmpty());
+}
@@ -39,6 +39,7 @@ private slots:
     void testExport();
     void testEmptyDatabase();
     void testNestedGroups();
+    void testWriteFailure();
 
 private:
     QSharedPointer<Database> m_db;
@@ -344,3 +344,60 @@ void TestCsvParser::testUnicode()
     QVERIFY(t.at(0).at(2) == "3śAż");
     QVERIFY(t.at(0).at(3) == "żac");
 }
+
+void TestCsvParser::testRowLimit()
+{
+    QTextStream out(file.data());
+    for (int i = 0; i < 10; ++i) {
+        out << i << ",x\n";
+    }
+    parser->setRowLimit(4);
+    QVERIFY(parser->parse(file.data()));
+    t = parser->getCsvTable();
+    QCOMPARE(t.size(), 4);
+    QCOMPARE(t.at(3).at(0), QString("3"));
+    QVERIFY(parser->isTruncated());
+
+    parser->setRowLimit(10);
+    QVERIFY(parser->reparse());
+    QCOMPARE(parser->getCsvTable().size(), 10);
+    QVERIFY(!parser->isTruncated());
+    parser->setRowLimit(0);
+}
+
+void TestCsvParser::testStreaming()
+{
+    // large enough to span several chunks, with CR LF pairs and quoted fields across chunk borders
+    const int rowCount = 20000;
+    QTextStream out(file.data());
+    for (int i = 0; i < rowCount; ++i) {
+        if (i % 3 == 0) {
+            out << i << ",\"quoted\r\nvalue " << i << "\",plain\r\n";
+        } else {
+            out << i << ",simple value " << i << ",plain\r\n";
+        }
+    }
+    QVERIFY(parser->parse(file.data()));
+    QCOMPARE(parser->getCsvTable().size(), rowCount);
+
+    parser->rewind();
+    CsvTable rows;
+    int total = 0;
+    while (parser->readRows(rows, 777) > 0) {
+        QVERIFY(rows.size() <= 777);
+        for (const auto& row : rows) {
+            QCOMPARE(row.size(), 3);
+            QCOMPARE(row.at(0), QString::number(total));
+            if (total % 3 == 0) {
+                QCOMPARE(row.at(1), QString("quoted\nvalue %1").arg(total));
+            } else {
+                QCOMPARE(row.at(1), QString("simple value %1").arg(total));
+            }
+            QCOMPARE(row.at(2), QString("plain"));
+            ++total;
+        }
+    }
+    QCOMPARE(total, rowCount);
+    // the preview table is left alone
+    QCOMPARE(parser->getCsvTable().size(), rowCount);
+}
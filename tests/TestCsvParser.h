@@ -59,6 +59,8 @@ private slots:
     void testQuoted();
     void testMultiline();
     void testColumns();
+    void testRowLimit();
+    void testStreaming();
 
 private:
     QScopedPointer<QTemporaryFile> file;
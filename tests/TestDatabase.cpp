@@ -19,11 +19,22 @@
 #include "TestDatabase.h"
 #include "TestGlobal.h"
 
+#include <QBuffer>
+#include <QDir>
 #include <QSignalSpy>
+#include <QTemporaryDir>
 
 #include "config-keepassx-tests.h"
+#include "core/AsyncTask.h"
+#include "core/AttachmentStore.h"
+#include "core/AutoSaveScheduler.h"
+#include "core/ChangeJournal.h"
+#include "core/Clock.h"
+#include "core/Config.h"
+#include "core/Group.h"
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
+#include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
 #include "keys/PasswordKey.h"
 #include "util/TemporaryFile.h"
@@ -95,6 +106,394 @@ void TestDatabase::testSave()
     QVERIFY(!QFile::exists(backupFilePath));
 }
 
+void TestDatabase::testFileChecksumWithoutReread()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto db = QSharedPointer<Database>::create();
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QString error;
+    QVERIFY(db->open(tempFile.fileName(), key, &error));
+
+    auto rewriteFile = [&] {
+        QFile file(tempFile.fileName());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QByteArray content = file.readAll();
+        file.close();
+        QTest::qWait(1100);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(file.write(content), static_cast<qint64>(content.size()));
+    };
+
+    // The checksums taken while reading and writing must match the file,
+    // rewriting it with the same content is not a change
+    QSignalSpy spyFileChanged(db.data(), SIGNAL(databaseFileChanged()));
+    rewriteFile();
+    db->metadata()->setName("test");
+    QVERIFY2(db->save(&error), error.toLatin1());
+
+    rewriteFile();
+    db->metadata()->setName("test2");
+    QVERIFY2(db->save(&error, false, false), error.toLatin1());
+
+    rewriteFile();
+    db->metadata()->setName("test3");
+    QVERIFY2(db->saveInBackground(&error), error.toLatin1());
+    QTRY_VERIFY(!db->isSaving());
+    QVERIFY(!db->isModified());
+
+    rewriteFile();
+    QTest::qWait(100);
+    QCOMPARE(spyFileChanged.count(), 0);
+    db->metadata()->setName("test4");
+    QVERIFY2(db->save(&error), error.toLatin1());
+}
+
+void TestDatabase::testSaveWithPreparedKey()
+{
+    Config::createTempFileInstance();
+    config()->set(Config::PrepareSaveKey, true);
+
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto db = QSharedPointer<Database>::create();
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QString error;
+    QVERIFY(db->open(tempFile.fileName(), key, &error));
+
+    // give the key for the first save time to be derived, the second one
+    // may have to fall back to deriving it on its own
+    QTest::qWait(250);
+    QByteArray previousSeed = db->kdf()->seed();
+    for (int i = 0; i < 2; ++i) {
+        db->metadata()->setName(QString("test%1").arg(i));
+        QVERIFY2(db->save(&error), error.toLatin1());
+        QVERIFY(db->kdf()->seed() != previousSeed);
+        previousSeed = db->kdf()->seed();
+
+        auto reopened = QSharedPointer<Database>::create();
+        QVERIFY2(reopened->open(tempFile.fileName(), key, &error), error.toLatin1());
+        QCOMPARE(reopened->metadata()->name(), QString("test%1").arg(i));
+        QCOMPARE(reopened->kdf()->seed(), previousSeed);
+    }
+
+    config()->set(Config::PrepareSaveKey, false);
+}
+
+void TestDatabase::testBackgroundSave()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto db = QSharedPointer<Database>::create();
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QString error;
+    QVERIFY(db->open(tempFile.fileName(), key, &error));
+
+    db->metadata()->setName("snapshot");
+    auto* entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setTitle("saved");
+    entry->setGroup(db->rootGroup());
+    QVERIFY(db->isModified());
+
+    QSignalSpy spySaved(db.data(), SIGNAL(databaseSaved()));
+    QSignalSpy spyFailed(db.data(), SIGNAL(databaseSaveFailed(QString)));
+    QVERIFY2(db->saveInBackground(&error), error.toLatin1());
+    QVERIFY(db->isSaving());
+    QVERIFY(!db->saveInBackground(&error));
+
+    // edit the database while the snapshot is being written
+    db->metadata()->setName("changed");
+    entry->setTitle("changed");
+
+    QTRY_COMPARE(spySaved.count(), 1);
+    QCOMPARE(spyFailed.count(), 0);
+    QVERIFY(!db->isSaving());
+    QVERIFY(db->isModified());
+
+    auto savedDb = QSharedPointer<Database>::create();
+    QVERIFY(savedDb->open(tempFile.fileName(), key, &error));
+    QCOMPARE(savedDb->metadata()->name(), QString("snapshot"));
+    Entry* savedEntry = savedDb->rootGroup()->findEntryByUuid(entry->uuid());
+    QVERIFY(savedEntry);
+    QCOMPARE(savedEntry->title(), QString("saved"));
+
+    // a save without concurrent edits leaves the database clean
+    QVERIFY2(db->saveInBackground(&error), error.toLatin1());
+    QTRY_COMPARE(spySaved.count(), 2);
+    QVERIFY(!db->isModified());
+
+    QVERIFY(savedDb->open(tempFile.fileName(), key, &error));
+    QCOMPARE(savedDb->metadata()->name(), QString("changed"));
+    QCOMPARE(savedDb->rootGroup()->findEntryByUuid(entry->uuid())->title(), QString("changed"));
+}
+
+void TestDatabase::testAutoSaveScheduler()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto db = QSharedPointer<Database>::create();
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QString error;
+    QVERIFY(db->open(tempFile.fileName(), key, &error));
+
+    AutoSaveScheduler scheduler;
+    scheduler.setDatabase(db.data());
+    scheduler.setDelay(50);
+    QCOMPARE(scheduler.delay(), 50);
+    QSignalSpy spyRequested(&scheduler, SIGNAL(saveRequested()));
+
+    // a burst of changes results in a single save
+    for (int i = 0; i < 5; ++i) {
+        scheduler.schedule();
+    }
+    QVERIFY(scheduler.isPending());
+    QTRY_COMPARE(spyRequested.count(), 1);
+    QTest::qWait(100);
+    QCOMPARE(spyRequested.count(), 1);
+    QVERIFY(!scheduler.isPending());
+
+    // changes during a running save queue exactly one more save
+    db->metadata()->setName("changed");
+    QVERIFY2(db->saveInBackground(&error), error.toLatin1());
+    for (int i = 0; i < 3; ++i) {
+        scheduler.schedule();
+    }
+    while (db->isSaving()) {
+        QCOMPARE(spyRequested.count(), 1);
+        QTest::qWait(5);
+    }
+    QTRY_COMPARE(spyRequested.count(), 2);
+    QTest::qWait(100);
+    QCOMPARE(spyRequested.count(), 2);
+    QVERIFY(!scheduler.isPending());
+
+    scheduler.schedule();
+    scheduler.cancel();
+    QVERIFY(!scheduler.isPending());
+    QTest::qWait(100);
+    QCOMPARE(spyRequested.count(), 2);
+}
+
+void TestDatabase::testBackupDatabase()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString filePath = tempDir.filePath("backup.kdbx");
+    const QString backupFilePath = tempDir.filePath("backup.old.kdbx");
+    QVERIFY(QFile::copy(dbFileName, filePath));
+    QVERIFY(QFile::setPermissions(filePath, QFile::ReadOwner | QFile::WriteOwner));
+
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+    auto db = QSharedPointer<Database>::create();
+    QString error;
+    QVERIFY(db->open(filePath, key, &error));
+
+    // every save keeps the previous generation, whichever way it is created
+    for (bool atomic : {true, false}) {
+        for (int i = 0; i < 2; ++i) {
+            const QString previousName = db->metadata()->name();
+            db->metadata()->setName(QString("generation%1").arg(i));
+            QVERIFY2(db->save(&error, atomic, true), error.toLatin1());
+
+            auto backup = QSharedPointer<Database>::create();
+            QVERIFY2(backup->open(backupFilePath, key, &error), error.toLatin1());
+            QCOMPARE(backup->metadata()->name(), previousName);
+            QCOMPARE(QFile::permissions(backupFilePath) & QFile::WriteOwner, QFile::WriteOwner);
+
+            auto saved = QSharedPointer<Database>::create();
+            QVERIFY2(saved->open(filePath, key, &error), error.toLatin1());
+            QCOMPARE(saved->metadata()->name(), QString("generation%1").arg(i));
+        }
+    }
+}
+
+void TestDatabase::testNonAtomicSave()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString filePath = tempDir.filePath("nonatomic.kdbx");
+    QVERIFY(QFile::copy(dbFileName, filePath));
+    QVERIFY(QFile::setPermissions(filePath, QFile::ReadOwner | QFile::WriteOwner));
+
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+    auto db = QSharedPointer<Database>::create();
+    QString error;
+    QVERIFY(db->open(filePath, key, &error));
+
+    db->metadata()->setName("renamed");
+    QVERIFY2(db->save(&error, false), error.toLatin1());
+    // the temporary file next to the database was renamed into place
+    QDir dir(tempDir.path());
+    QCOMPARE(dir.entryList(QDir::Files | QDir::Hidden), QStringList() << "nonatomic.kdbx");
+    QCOMPARE(QFile::permissions(filePath) & QFile::WriteOwner, QFile::WriteOwner);
+
+    auto saved = QSharedPointer<Database>::create();
+    QVERIFY2(saved->open(filePath, key, &error), error.toLatin1());
+    QCOMPARE(saved->metadata()->name(), QString("renamed"));
+
+    // without permission to create files, the database is written in place
+    QVERIFY(QFile::setPermissions(tempDir.path(), QFile::ReadOwner | QFile::ExeOwner));
+    db->metadata()->setName("in place");
+    bool ok = db->save(&error, false);
+    QFile::setPermissions(tempDir.path(), QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+    QVERIFY2(ok, error.toLatin1());
+    QCOMPARE(dir.entryList(QDir::Files | QDir::Hidden), QStringList() << "nonatomic.kdbx");
+
+    QVERIFY2(saved->open(filePath, key, &error), error.toLatin1());
+    QCOMPARE(saved->metadata()->name(), QString("in place"));
+}
+
+void TestDatabase::testReadSnapshot()
+{
+    Database db;
+    auto* entry = new Entry();
+    entry->setGroup(db.rootGroup());
+    entry->setTitle("original");
+    entry->setPassword("secret");
+
+    auto snapshot = db.readSnapshot();
+    QVERIFY(snapshot);
+    QCOMPARE(snapshot->modificationCount(), db.modificationCount());
+    // the copy is shared until the database changes
+    QCOMPARE(db.readSnapshot(), snapshot);
+
+    entry->setTitle("changed");
+    auto newSnapshot = db.readSnapshot();
+    QVERIFY(newSnapshot != snapshot);
+
+    const Entry* copy = snapshot->rootGroup()->findEntryByUuid(entry->uuid());
+    QVERIFY(copy);
+    QVERIFY(copy != entry);
+    QCOMPARE(copy->title(), QString("original"));
+    QCOMPARE(newSnapshot->rootGroup()->findEntryByUuid(entry->uuid())->title(), QString("changed"));
+
+    // several threads read the same snapshot while the database changes
+    const QUuid uuid = entry->uuid();
+    QList<QFuture<QString>> futures;
+    for (int i = 0; i < 4; ++i) {
+        futures << AsyncTask::run(AsyncTask::Executor::Interactive, [snapshot, uuid] {
+            const Entry* copy = snapshot->rootGroup()->findEntryByUuid(uuid);
+            return copy->title() + copy->password();
+        });
+    }
+    delete entry;
+    for (auto& future : futures) {
+        future.waitForFinished();
+        QCOMPARE(future.result(), QString("originalsecret"));
+    }
+}
+
+void TestDatabase::testChangeJournal()
+{
+    Database db;
+    const ChangeJournal* journal = db.changeJournal();
+    const quint64 start = journal->sequence();
+
+    auto* group = new Group();
+    group->setUuid(QUuid::createUuid());
+    group->setParent(db.rootGroup());
+    auto* entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setGroup(group);
+    const quint64 added = journal->sequence();
+
+    entry->setTitle("title");
+    entry->setPassword("password");
+    entry->setIcon(3);
+    entry->attachments()->set("file.txt", QByteArray("data"));
+
+    QVector<ChangeJournal::Change> changes;
+    QVERIFY(journal->changesSince(added, &changes));
+    // the modifications of the entry are combined into a single change
+    QCOMPARE(changes.size(), 1);
+    QCOMPARE(changes.first().kind, ChangeJournal::Kind::EntryModified);
+    QCOMPARE(changes.first().uuid, entry->uuid());
+    QCOMPARE(changes.first().fields,
+             ChangeJournal::Attributes | ChangeJournal::Properties | ChangeJournal::Attachments);
+    QCOMPARE(changes.first().sequence, journal->sequence());
+
+    QVERIFY(journal->changesSince(start, &changes));
+    QVERIFY(changes.size() > 1);
+    QCOMPARE(changes.first().kind, ChangeJournal::Kind::GroupAdded);
+    QCOMPARE(changes.first().uuid, group->uuid());
+
+    const QUuid entryUuid = entry->uuid();
+    const quint64 modified = journal->sequence();
+    delete entry;
+    QVERIFY(journal->changesSince(modified, &changes));
+    QCOMPARE(changes.first().kind, ChangeJournal::Kind::EntryRemoved);
+    QCOMPARE(changes.first().uuid, entryUuid);
+
+    // nothing is known about the changes before a new tree was set
+    const quint64 beforeRelease = journal->sequence();
+    db.releaseData();
+    QVERIFY(!journal->changesSince(beforeRelease, &changes));
+    QVERIFY(journal->changesSince(journal->sequence(), &changes));
+    QVERIFY(changes.isEmpty());
+
+    // only the most recent changes are kept
+    ChangeJournal small(4);
+    for (int i = 0; i < 10; ++i) {
+        small.record(ChangeJournal::Kind::EntryAdded, QUuid::createUuid());
+    }
+    QVERIFY(small.size() <= 4);
+    QVERIFY(!small.changesSince(0, &changes));
+    QVERIFY(small.changesSince(small.sequence() - 1, &changes));
+    QCOMPARE(changes.size(), 1);
+    QCOMPARE(changes.first().sequence, small.sequence());
+}
+
+void TestDatabase::testExtract()
+{
+    Database db;
+    // KDBX 3 keeps the attachments in the XML
+    db.setKdf(KeePass2::uuidToKdf(KeePass2::KDF_AES_KDBX3));
+
+    auto* entry = new Entry();
+    entry->setGroup(db.rootGroup());
+    entry->setTitle("Attachment");
+    QByteArray attachment;
+    for (int i = 0; i < 100000; ++i) {
+        attachment.append(QByteArray::number(i));
+    }
+    entry->attachments()->set("large.bin", attachment);
+
+    QByteArray xmlData;
+    QVERIFY(db.extract(xmlData));
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QString error;
+    QVERIFY2(db.extract(&buffer, &error), qPrintable(error));
+    QCOMPARE(buffer.data(), xmlData);
+
+    // the attachment is encoded in chunks, but the text must match a single encoding
+    db.setCompressionAlgorithm(Database::CompressionNone);
+    QByteArray plainXmlData;
+    QVERIFY(db.extract(plainXmlData));
+    QVERIFY(plainXmlData.contains(attachment.toBase64()));
+
+    QBuffer readOnly;
+    QVERIFY(readOnly.open(QIODevice::ReadOnly));
+    QVERIFY(!db.extract(&readOnly, &error));
+    QVERIFY(!error.isEmpty());
+}
+
 void TestDatabase::testSignals()
 {
     TemporaryFile tempFile;
@@ -206,3 +605,308 @@ void TestDatabase::testEmptyRecycleBinWithHierarchicalData()
     writer.writeDatabase(&afterCleanup, db.data());
     QVERIFY(afterCleanup.size() < initialSize);
 }
+
+void TestDatabase::testRecycleAndDeleteEntries()
+{
+    Database db;
+    db.metadata()->setRecycleBinEnabled(true);
+
+    auto* group1 = new Group();
+    group1->setParent(db.rootGroup());
+    auto* group2 = new Group();
+    group2->setParent(db.rootGroup());
+
+    QList<Entry*> entries;
+    for (int i = 0; i < 10; ++i) {
+        auto* entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setGroup(i % 2 == 0 ? group1 : group2);
+        entries.append(entry);
+    }
+
+    // entries of both groups go to the recycle bin at once
+    QList<Entry*> recycled = {entries[0], entries[1], entries[4], entries[5], entries[8], entries[9]};
+    db.recycleEntries(recycled);
+    Group* recycleBin = db.metadata()->recycleBin();
+    QVERIFY(recycleBin);
+    QCOMPARE(recycleBin->entries().size(), 6);
+    QCOMPARE(group1->entries(), QList<Entry*>({entries[2], entries[6]}));
+    QCOMPARE(group2->entries(), QList<Entry*>({entries[3], entries[7]}));
+    for (auto* entry : recycled) {
+        QCOMPARE(entry->group(), recycleBin);
+        QCOMPARE(db.rootGroup()->findEntryByUuid(entry->uuid()), entry);
+    }
+    QVERIFY(db.deletedObjects().isEmpty());
+
+    const QUuid deletedUuid = entries[2]->uuid();
+    db.deleteEntries({entries[2], entries[3], entries[7]});
+    QCOMPARE(group1->entries(), QList<Entry*>({entries[6]}));
+    QVERIFY(group2->entries().isEmpty());
+    QCOMPARE(db.deletedObjects().size(), 3);
+    QVERIFY(db.containsDeletedObject(deletedUuid));
+    QVERIFY(!db.rootGroup()->findEntryByUuid(deletedUuid));
+
+    // deleting from the recycle bin keeps the remaining entries
+    QUuid remainingUuid = entries[9]->uuid();
+    db.deleteEntries({entries[0], entries[1], entries[4], entries[5], entries[8]});
+    QCOMPARE(recycleBin->entries().size(), 1);
+    QCOMPARE(recycleBin->entries().first()->uuid(), remainingUuid);
+
+    db.emptyRecycleBin();
+    QVERIFY(recycleBin->entries().isEmpty());
+    QCOMPARE(db.deletedObjects().size(), 9);
+}
+
+void TestDatabase::testDeletedObjects()
+{
+    Database db;
+    const QUuid uuid1 = QUuid::createUuid();
+    const QUuid uuid2 = QUuid::createUuid();
+
+    QVERIFY(!db.containsDeletedObject(uuid1));
+    db.addDeletedObject(uuid1);
+    QVERIFY(db.containsDeletedObject(uuid1));
+    QVERIFY(!db.containsDeletedObject(uuid2));
+
+    // objects added after a lookup are found as well
+    db.addDeletedObject(uuid2);
+    QVERIFY(db.containsDeletedObject(uuid2));
+
+    QList<DeletedObject> deletions = db.deletedObjects();
+    deletions.removeFirst();
+    db.setDeletedObjects(deletions);
+    QVERIFY(!db.containsDeletedObject(uuid1));
+    QVERIFY(db.containsDeletedObject(deletions.first()));
+
+    // objects recorded twice stay indexed until the last copy is dropped
+    db.addDeletedObject(uuid2);
+    QCOMPARE(db.deletedObjects().size(), 2);
+    db.truncateDeletedObjects(1);
+    QVERIFY(db.containsDeletedObject(uuid2));
+    db.truncateDeletedObjects(0);
+    QVERIFY(!db.containsDeletedObject(uuid2));
+
+    const QDateTime now = Clock::currentDateTimeUtc();
+    db.addDeletedObject({uuid1, now.addDays(-40)});
+    db.addDeletedObject({uuid2, now.addDays(-10)});
+    QVERIFY(db.containsDeletedObject(uuid1));
+    QCOMPARE(db.pruneDeletedObjects(now.addDays(-30)), 1);
+    QVERIFY(!db.containsDeletedObject(uuid1));
+    QVERIFY(db.containsDeletedObject(uuid2));
+    QCOMPARE(db.pruneDeletedObjects(now.addDays(-30)), 0);
+
+    QCOMPARE(db.deletedObjectsMaxAge(), 0);
+    db.setDeletedObjectsMaxAge(5);
+    QCOMPARE(db.deletedObjectsMaxAge(), 5);
+    QVERIFY(db.metadata()->customData()->contains(Database::DeletedObjectsMaxAgeKey));
+    db.setDeletedObjectsMaxAge(0);
+    QVERIFY(!db.metadata()->customData()->contains(Database::DeletedObjectsMaxAgeKey));
+
+    db.releaseData();
+    QVERIFY(!db.containsDeletedObject(uuid2));
+}
+
+void TestDatabase::testAttachmentPool()
+{
+    Database db;
+    // separate instances with the same contents
+    const QByteArray content1 = QByteArray("attachment ").append("one");
+    const QByteArray content2 = QByteArray("attachment ").append("one");
+    QVERIFY(content1.constData() != content2.constData());
+
+    auto* entry1 = new Entry();
+    entry1->attachments()->set("a", content1);
+    entry1->setGroup(db.rootGroup());
+
+    // adding an entry to the database shares equal attachment data
+    auto* entry2 = new Entry();
+    entry2->attachments()->set("a", content2);
+    entry2->attachments()->set("b", QByteArray("attachment two"));
+    entry2->setGroup(db.rootGroup());
+    QCOMPARE(entry2->attachments()->value("a").constData(), entry1->attachments()->value("a").constData());
+
+    entry2->beginUpdate();
+    entry2->attachments()->remove("b");
+    entry2->endUpdate();
+    QVERIFY(entry2->historyItemCount() > 0);
+
+    {
+        const QList<AttachmentValue> pool = db.attachmentPool();
+        QCOMPARE(pool.size(), 2);
+        QCOMPARE(pool.at(0).data, content1);
+        QCOMPARE(pool.at(1).data, QByteArray("attachment two"));
+    }
+
+    // blobs that are gone from the database are dropped from the store
+    AttachmentStore* store = db.attachmentStore();
+    const int storedCount = store->count();
+    entry2->removeHistoryItems(entry2->historyItems());
+    QCOMPARE(db.attachmentPool().size(), 1);
+    QVERIFY(store->count() < storedCount);
+
+    // binary ids of the file match the pool
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("test"));
+    db.setKey(key);
+    KeePass2Writer writer;
+    QVERIFY(writer.writeDatabase(&buffer, &db));
+    buffer.seek(0);
+    auto loaded = QSharedPointer<Database>::create();
+    KeePass2Reader reader;
+    QVERIFY(reader.readDatabase(&buffer, key, loaded.data()));
+    const QList<Entry*> entries = loaded->rootGroup()->entries();
+    QCOMPARE(entries.size(), 2);
+    QCOMPARE(entries.at(0)->attachments()->value("a"), content1);
+    QCOMPARE(entries.at(1)->attachments()->value("a"), content1);
+    QVERIFY(!entries.at(1)->attachments()->hasKey("b"));
+}
+
+void TestDatabase::testReleaseData()
+{
+    Database db;
+    QPointer<Group> group = new Group();
+    group->setParent(db.rootGroup());
+    QPointer<Group> subgroup = new Group();
+    subgroup->setParent(group);
+    QPointer<Entry> entry = new Entry();
+    entry->setGroup(subgroup);
+    entry->setTitle("entry");
+    const QUuid entryUuid = entry->uuid();
+    QPointer<Group> oldRoot = db.rootGroup();
+
+    QSignalSpy spyAboutToRelease(&db, SIGNAL(dataAboutToBeReleased()));
+    QSignalSpy spyReleased(&db, SIGNAL(dataReleased()));
+    QSignalSpy spyGroupAboutToRemove(&db, SIGNAL(groupAboutToRemove(Group*)));
+    QSignalSpy spyEntryAboutToRemove(&db, SIGNAL(entryAboutToRemove(Entry*)));
+
+    db.releaseData();
+
+    QCOMPARE(spyAboutToRelease.count(), 1);
+    QCOMPARE(spyReleased.count(), 1);
+    // the tree is destroyed without notifications for the single objects
+    QCOMPARE(spyGroupAboutToRemove.count(), 0);
+    QCOMPARE(spyEntryAboutToRemove.count(), 0);
+    QVERIFY(!oldRoot);
+    QVERIFY(!group);
+    QVERIFY(!subgroup);
+    QVERIFY(!entry);
+    QVERIFY(db.deletedObjects().isEmpty());
+
+    QVERIFY(db.rootGroup());
+    QVERIFY(!db.rootGroup()->findEntryByUuid(entryUuid));
+
+    // the database stays usable
+    auto* newEntry = new Entry();
+    newEntry->setUuid(entryUuid);
+    newEntry->setGroup(db.rootGroup());
+    QCOMPARE(db.rootGroup()->findEntryByUuid(entryUuid), newEntry);
+}
+
+void TestDatabase::testCommonUsernames()
+{
+    Database db;
+    auto* group = new Group();
+    group->setParent(db.rootGroup());
+
+    auto addEntry = [](Group* parent, const QString& username) {
+        auto* entry = new Entry();
+        entry->setUsername(username);
+        entry->setGroup(parent);
+        return entry;
+    };
+
+    addEntry(db.rootGroup(), "alice");
+    Entry* bob = addEntry(group, "bob");
+    addEntry(group, "bob");
+    addEntry(group, "");
+    QCOMPARE(db.commonUsernames(), QList<QString>({"bob", "alice"}));
+
+    // modifications update the counts without rescanning
+    bob->setUsername("carol");
+    QCOMPARE(db.commonUsernames(), QList<QString>({"alice", "bob", "carol"}));
+
+    // references are not counted
+    bob->setUsername("{REF:U@I:" + bob->uuidToHex() + "}");
+    QCOMPARE(db.commonUsernames(), QList<QString>({"alice", "bob"}));
+
+    db.updateCommonUsernames(1);
+    QCOMPARE(db.commonUsernames(), QList<QString>({"alice"}));
+
+    // moving a group to another database moves its usernames
+    Database other;
+    group->setParent(other.rootGroup());
+    db.updateCommonUsernames();
+    QCOMPARE(db.commonUsernames(), QList<QString>({"alice"}));
+    QCOMPARE(other.commonUsernames(), QList<QString>({"bob"}));
+    group->setParent(db.rootGroup());
+    QVERIFY(other.commonUsernames().isEmpty());
+    QCOMPARE(db.commonUsernames(), QList<QString>({"alice", "bob"}));
+    delete bob;
+    QCOMPARE(db.commonUsernames(), QList<QString>({"alice", "bob"}));
+    delete group->entries().first();
+    QCOMPARE(db.commonUsernames(), QList<QString>({"alice"}));
+}
+
+void TestDatabase::testMemoryUsage()
+{
+    Database db;
+    MemoryUsage empty = db.memoryUsage();
+    QCOMPARE(empty.entries, qint64(0));
+    QCOMPARE(empty.attachmentsTotal, qint64(0));
+
+    const QByteArray attachment(1000, 'a');
+    auto* entry = new Entry();
+    entry->setTitle("Title");
+    entry->setPassword("password");
+    entry->attachments()->set("first", attachment);
+    entry->attachments()->set("second", attachment);
+    entry->setGroup(db.rootGroup());
+
+    Entry* historyItem = entry->clone(Entry::CloneNoFlags);
+    entry->addHistoryItem(historyItem);
+
+    db.metadata()->addCustomIcon(QUuid::createUuid(), QImage(16, 16, QImage::Format_ARGB32));
+
+    auto* deleted = new Entry();
+    deleted->setUuid(QUuid::createUuid());
+    deleted->setGroup(db.rootGroup());
+    delete deleted;
+
+    MemoryUsage usage = db.memoryUsage();
+    QVERIFY(usage.entries > 0);
+    QVERIFY(usage.historyItems > 0);
+    // Both attachments and the history item share one copy of the data
+    QCOMPARE(usage.attachmentsTotal, qint64(4 * attachment.size()));
+    QCOMPARE(usage.attachmentsDeduplicated, qint64(attachment.size()));
+    QVERIFY(usage.customIconsRaw > 0);
+    QCOMPARE(usage.deletedObjects, qint64(sizeof(DeletedObject)));
+    QCOMPARE(usage.total(),
+             usage.entries + usage.historyItems + usage.attachmentsDeduplicated + usage.customIconsRaw
+                 + usage.customIconsDecoded + usage.customData + usage.deletedObjects);
+}
+
+void TestDatabase::testReleaseFreeMemory()
+{
+    // The clear function stays registered for the rest of the process
+    static int cleared = 0;
+    MemoryUsage::registerCache([] { ++cleared; });
+
+    const qint64 releasedBefore = MemoryUsage::releasedMemory();
+    auto* db = new Database();
+    for (int i = 0; i < 1000; ++i) {
+        auto* entry = new Entry();
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setNotes(QString(1000, 'n'));
+        entry->setGroup(db->rootGroup());
+    }
+    db->releaseData();
+    delete db;
+
+    const qint64 released = MemoryUsage::releaseFreeMemory();
+    QCOMPARE(cleared, 1);
+    QVERIFY(released >= 0);
+    QCOMPARE(MemoryUsage::releasedMemory(), releasedBefore + released);
+}
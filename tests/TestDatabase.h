@@ -29,11 +29,27 @@ private slots:
     void initTestCase();
     void testOpen();
     void testSave();
+    void testFileChecksumWithoutReread();
+    void testSaveWithPreparedKey();
+    void testBackgroundSave();
+    void testAutoSaveScheduler();
+    void testBackupDatabase();
+    void testNonAtomicSave();
+    void testReadSnapshot();
+    void testChangeJournal();
+    void testExtract();
     void testSignals();
     void testEmptyRecycleBinOnDisabled();
     void testEmptyRecycleBinOnNotCreated();
     void testEmptyRecycleBinOnEmpty();
     void testEmptyRecycleBinWithHierarchicalData();
+    void testRecycleAndDeleteEntries();
+    void testDeletedObjects();
+    void testAttachmentPool();
+    void testReleaseData();
+    void testCommonUsernames();
+    void testMemoryUsage();
+    void testReleaseFreeMemory();
 };
 
 #endif // KEEPASSX_TESTDATABASE_H
@@ -0,0 +1,162 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestDuplicateDetector.h"
+#include "TestGlobal.h"
+
+#include <QSignalSpy>
+
+#include "core/Clock.h"
+#include "core/Database.h"
+#include "core/DuplicateDetector.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+
+QTEST_GUILESS_MAIN(TestDuplicateDetector)
+
+namespace
+{
+    Entry* addEntry(Group* group,
+                    const QString& title,
+                    const QString& username,
+                    const QString& url,
+                    const QString& password)
+    {
+        auto* entry = new Entry();
+        entry->setTitle(title);
+        entry->setUsername(username);
+        entry->setUrl(url);
+        entry->setPassword(password);
+        entry->setGroup(group);
+        return entry;
+    }
+
+    void setModified(Entry* entry, int daysAgo)
+    {
+        TimeInfo timeInfo = entry->timeInfo();
+        timeInfo.setLastModificationTime(Clock::currentDateTimeUtc().addDays(-daysAgo));
+        entry->setTimeInfo(timeInfo);
+    }
+} // namespace
+
+void TestDuplicateDetector::testFingerprint()
+{
+    Database db;
+    Group* root = db.rootGroup();
+    const Entry* entry = addEntry(root, "Bank", "alice", "https://www.bank.com/login", "secret");
+
+    // case, whitespace, the URL path and a www prefix don't matter
+    const auto fingerprint = DuplicateDetector::fingerprint(entry);
+    QCOMPARE(DuplicateDetector::fingerprint(addEntry(root, " bank ", "Alice", "https://bank.com/account", "secret")),
+             fingerprint);
+    QCOMPARE(DuplicateDetector::fingerprint(addEntry(root, "Bank", "alice", "bank.com", "secret")), fingerprint);
+
+    // the password does, and so do the other fields
+    QVERIFY(DuplicateDetector::fingerprint(addEntry(root, "Bank", "alice", "bank.com", "Secret")) != fingerprint);
+    QVERIFY(DuplicateDetector::fingerprint(addEntry(root, "Bank", "bob", "bank.com", "secret")) != fingerprint);
+    QVERIFY(DuplicateDetector::fingerprint(addEntry(root, "Bank", "alice", "bank.org", "secret")) != fingerprint);
+
+    // fields don't run into each other
+    const auto joined = DuplicateDetector::fingerprint(addEntry(root, "ab", "c", "", ""));
+    QVERIFY(DuplicateDetector::fingerprint(addEntry(root, "a", "bc", "", "")) != joined);
+}
+
+void TestDuplicateDetector::testFindDuplicates()
+{
+    Database db;
+    Group* root = db.rootGroup();
+    auto* group = new Group();
+    group->setParent(root);
+
+    Entry* bank1 = addEntry(root, "Bank", "alice", "https://www.bank.com/login", "secret");
+    Entry* mail1 = addEntry(root, "Mail", "bob", "", "x");
+    addEntry(root, "Bank", "alice", "https://www.bank.com/login", "different");
+    Entry* bank2 = addEntry(group, "bank", "alice", "https://bank.com", "secret");
+    Entry* mail2 = addEntry(group, "Mail", "bob", "", "x");
+    Entry* mail3 = addEntry(group, "MAIL", "bob", "", "x");
+    addEntry(group, "Unique", "", "", "");
+
+    QList<QList<Entry*>> expected;
+    expected << (QList<Entry*>() << bank1 << bank2) << (QList<Entry*>() << mail1 << mail2 << mail3);
+    QCOMPARE(DuplicateDetector::findDuplicates(root), expected);
+
+    // entries in the recycle bin are not duplicates
+    db.recycleEntry(mail3);
+    db.recycleEntry(bank2);
+    expected.clear();
+    expected << (QList<Entry*>() << mail1 << mail2);
+    QCOMPARE(DuplicateDetector::findDuplicates(root), expected);
+}
+
+void TestDuplicateDetector::testMergeDuplicates()
+{
+    Database db;
+    Group* root = db.rootGroup();
+    Entry* older = addEntry(root, "Bank", "alice", "https://bank.com", "secret");
+    older->attributes()->set("PIN", "1234", true);
+    older->attachments()->set("statement.pdf", "pdf");
+    older->setTags("finance");
+    older->setNotes("Call before noon");
+    setModified(older, 10);
+    Entry* newer = addEntry(root, "Bank", "alice", "https://bank.com", "secret");
+    newer->attributes()->set("PIN", "5678");
+    newer->setTags("bank");
+    setModified(newer, 1);
+    Entry* oldest = addEntry(root, "Bank", "alice", "https://bank.com", "secret");
+    oldest->setNotes("Call before noon");
+    setModified(oldest, 100);
+
+    const auto duplicates = DuplicateDetector::findDuplicates(root);
+    QCOMPARE(duplicates.size(), 1);
+    QCOMPARE(DuplicateDetector::keptEntry(duplicates.first()), newer);
+
+    QSignalSpy bulkUpdates(&db, SIGNAL(bulkUpdateStarted()));
+    QCOMPARE(DuplicateDetector::mergeDuplicates(&db, duplicates), 2);
+    QCOMPARE(bulkUpdates.size(), 1);
+
+    // the kept entry takes what it misses, but keeps its own values
+    QCOMPARE(newer->attributes()->value("PIN"), QString("5678"));
+    QVERIFY(newer->attachments()->hasKey("statement.pdf"));
+    QCOMPARE(newer->tagList(), QStringList({"bank", "finance"}));
+    QCOMPARE(newer->notes(), QString("Call before noon"));
+    QCOMPARE(newer->historyItemCount(), 1);
+
+    QVERIFY(older->isRecycled());
+    QVERIFY(oldest->isRecycled());
+    QVERIFY(!newer->isRecycled());
+    QVERIFY(DuplicateDetector::findDuplicates(root).isEmpty());
+}
+
+void TestDuplicateDetector::testRemoveDuplicates()
+{
+    Database db;
+    db.metadata()->setRecycleBinEnabled(false);
+    Group* root = db.rootGroup();
+    setModified(addEntry(root, "Bank", "alice", "", "secret"), 2);
+    Entry* kept = addEntry(root, "Bank", "alice", "", "secret");
+    setModified(kept, 1);
+    setModified(addEntry(root, "Mail", "bob", "", "x"), 1);
+    setModified(addEntry(root, "Mail", "bob", "", "x"), 2);
+    addEntry(root, "Unique", "", "", "");
+
+    QSignalSpy bulkUpdates(&db, SIGNAL(bulkUpdateStarted()));
+    QCOMPARE(DuplicateDetector::removeDuplicates(&db, DuplicateDetector::findDuplicates(root)), 2);
+    QCOMPARE(bulkUpdates.size(), 1);
+    QCOMPARE(root->entries().size(), 3);
+    QVERIFY(root->entries().contains(kept));
+    QCOMPARE(root->entries().first()->title(), QString("Bank"));
+}
@@ -46,6 +46,301 @@ void TestEntry::testHistoryItemDeletion()
     QVERIFY(historyEntry.isNull());
 }
 
+void TestEntry::testHistoryItemSharing()
+{
+    const QString notes(QString("notes").repeated(100));
+    const QByteArray attachment(QByteArray("data").repeated(100));
+
+    QScopedPointer<Entry> entry(new Entry());
+    entry->setNotes(QString(notes.constData(), notes.size()));
+    entry->setPassword("current");
+    entry->attachments()->set("a", QByteArray(attachment.constData(), attachment.size()));
+
+    // Separately allocated copies, as read from a file
+    Entry* historyEntry = new Entry();
+    historyEntry->setNotes(QString(notes.constData(), notes.size()));
+    historyEntry->setPassword("previous");
+    historyEntry->attachments()->set("a", QByteArray(attachment.constData(), attachment.size()));
+    QVERIFY(historyEntry->notes().constData() != entry->notes().constData());
+
+    entry->addHistoryItem(historyEntry);
+    QCOMPARE(historyEntry->notes(), notes);
+    QCOMPARE(historyEntry->password(), QString("previous"));
+    QVERIFY(historyEntry->notes().constData() == entry->notes().constData());
+    QVERIFY(historyEntry->attachments()->value("a").constData() == entry->attachments()->value("a").constData());
+
+    // Editing the entry leaves the shared history values intact
+    entry->setNotes("changed");
+    QCOMPARE(historyEntry->notes(), notes);
+}
+
+void TestEntry::testCompactHistory()
+{
+    Database db;
+    db.metadata()->setHistoryMaxItems(2);
+    auto* entry = new Entry();
+    entry->setGroup(db.rootGroup());
+    entry->setTitle("title0");
+
+    for (int i = 1; i <= 3; ++i) {
+        entry->beginUpdate();
+        entry->setTitle(QString("title%1").arg(i));
+        entry->setNotes(QString("notes%1").arg(i));
+        entry->endUpdate();
+    }
+
+    // Edits keep their snapshots compact, truncation included
+    QVERIFY(entry->hasCompactHistory());
+    QCOMPARE(entry->historyItemCount(), 2);
+    QCOMPARE(entry->historyTimeInfos().size(), 2);
+    QVERIFY(!entry->hasHistoryCustomData());
+
+    QStringList titles;
+    entry->forEachHistoryItem([&titles](const Entry* item) {
+        titles.append(item->title());
+        return true;
+    });
+    QCOMPARE(titles, QStringList() << "title1" << "title2");
+    QVERIFY(entry->hasCompactHistory());
+
+    QScopedPointer<Entry> clone(entry->clone(Entry::CloneIncludeHistory));
+    QVERIFY(clone->hasCompactHistory());
+    QCOMPARE(clone->historyItemCount(), 2);
+
+    // Asking for the entries creates them once
+    const QList<Entry*> historyItems = entry->historyItems();
+    QVERIFY(!entry->hasCompactHistory());
+    QCOMPARE(historyItems.size(), 2);
+    QCOMPARE(historyItems.at(0)->title(), QString("title1"));
+    QCOMPARE(historyItems.at(0)->notes(), QString("notes1"));
+    QCOMPARE(historyItems.at(1)->uuid(), entry->uuid());
+    QCOMPARE(entry->historyItems(), historyItems);
+
+    QCOMPARE(clone->historyItems().at(0)->title(), QString("title1"));
+    QCOMPARE(clone->historyItems().at(0)->uuid(), clone->uuid());
+
+    // Expanded history can be cloned as snapshots without touching the original entries
+    QScopedPointer<Entry> snapshot(entry->clone(Entry::CloneIncludeHistory | Entry::CloneCompactHistory));
+    QVERIFY(snapshot->hasCompactHistory());
+    QVERIFY(!entry->hasCompactHistory());
+    QCOMPARE(snapshot->historyItemCount(), 2);
+    QCOMPARE(snapshot->historyTimeInfos().first(), historyItems.at(0)->timeInfo());
+    QCOMPARE(snapshot->historyItems().at(1)->notes(), QString("notes2"));
+    QCOMPARE(snapshot->historyItems().at(1)->uuid(), snapshot->uuid());
+
+    // Further edits append entries while they are in use
+    entry->beginUpdate();
+    entry->setTitle("title4");
+    entry->endUpdate();
+    QVERIFY(!entry->hasCompactHistory());
+    QCOMPARE(entry->historyItems().size(), 2);
+    QCOMPARE(entry->historyItems().last()->title(), QString("title3"));
+
+    entry->compactHistory();
+    QVERIFY(entry->hasCompactHistory());
+    QCOMPARE(entry->historyItems().last()->title(), QString("title3"));
+}
+
+void TestEntry::testAttributeStorage()
+{
+    Entry entry1;
+    entry1.setTitle("title");
+    entry1.attributes()->set("b", "2");
+    entry1.attributes()->set("Z", "3");
+    entry1.attributes()->set("Q", "1", true);
+    entry1.attributes()->set("a", "4");
+
+    // The order matches the one of a QMap
+    QMap<QString, QString> expected;
+    for (const QString& key : EntryAttributes::DefaultAttributes) {
+        expected.insert(key, QString());
+    }
+    expected.insert("b", "2");
+    expected.insert("Z", "3");
+    expected.insert("Q", "1");
+    expected.insert("a", "4");
+    QCOMPARE(entry1.attributes()->keys(), expected.keys());
+    QCOMPARE(entry1.attributes()->customKeys(), QList<QString>() << "Q" << "Z" << "a" << "b");
+    QCOMPARE(entry1.title(), QString("title"));
+    QCOMPARE(entry1.attributes()->value(QString("Ti") + "tle"), QString("title"));
+    QVERIFY(entry1.attributes()->isProtected("Q"));
+    QVERIFY(entry1.attributes()->containsValue("4"));
+    QVERIFY(!entry1.attributes()->containsValue("5"));
+    QVERIFY(EntryAttributes::isDefaultAttribute(QString("User") + "Name"));
+    QVERIFY(!EntryAttributes::isDefaultAttribute("b"));
+
+    // Custom keys are stored once for all entries
+    Entry entry2;
+    entry2.attributes()->set(QString("Z"), "3");
+    QCOMPARE(entry2.attributes()->customKeys().first().constData(),
+             entry1.attributes()->customKeys().at(1).constData());
+
+    entry1.attributes()->remove("Z");
+    QVERIFY(!entry1.attributes()->contains("Z"));
+    QCOMPARE(entry1.attributes()->customKeys(), QList<QString>() << "Q" << "a" << "b");
+    entry1.attributes()->rename("a", "c");
+    QCOMPARE(entry1.attributes()->customKeys(), QList<QString>() << "Q" << "b" << "c");
+
+    Entry entry3;
+    entry3.attributes()->copyDataFrom(entry1.attributes());
+    QVERIFY(*entry3.attributes() == *entry1.attributes());
+    entry3.attributes()->set("c", "5");
+    QVERIFY(*entry3.attributes() != *entry1.attributes());
+    QCOMPARE(entry1.attributes()->value("c"), QString("4"));
+}
+
+void TestEntry::testCompressedAttributes()
+{
+    const QString notes = QString("Restart the service, then check the logs.\n").repeated(500);
+    const QString blob = QString("MIIDdzCCAl+gAwIBAgIEbDc4MDANBgkqhkiG9w0BAQsFADBsMRAwDgYD\n").repeated(400);
+    QVERIFY(notes.size() >= EntryAttributes::CompressionThreshold);
+    QVERIFY(blob.size() >= EntryAttributes::CompressionThreshold);
+
+    Database db;
+    auto* entry = new Entry();
+    entry->setGroup(db.rootGroup());
+    const int emptySize = entry->size();
+    entry->setNotes(notes);
+    entry->attributes()->set("blob", blob);
+    entry->attributes()->set("secret", blob, true);
+    entry->attributes()->set("small", "value");
+
+    // Only large values that are not protected are compressed
+    EntryAttributes* attributes = entry->attributes();
+    QVERIFY(attributes->isCompressed(EntryAttributes::NotesKey));
+    QVERIFY(attributes->isCompressed("blob"));
+    QVERIFY(!attributes->isCompressed("secret"));
+    QVERIFY(!attributes->isCompressed("small"));
+    QCOMPARE(entry->notes(), notes);
+    QCOMPARE(attributes->value("blob"), blob);
+    QVERIFY(attributes->containsValue(blob));
+    QVERIFY(attributes->containsValue("value"));
+    QVERIFY(!attributes->containsValue(blob + "x"));
+
+    // Sizes are those of the values, not of their compressed form
+    QCOMPARE(entry->size(), emptySize + notes.toUtf8().size() + 4 + 6 + 2 * blob.toUtf8().size() + 5 + 5);
+
+    // Renaming and copying keep the values compressed
+    attributes->rename("blob", "blob2");
+    QVERIFY(attributes->isCompressed("blob2"));
+    QCOMPARE(attributes->value("blob2"), blob);
+
+    Entry copy;
+    copy.attributes()->copyDataFrom(attributes);
+    QVERIFY(copy.attributes()->isCompressed("blob2"));
+    QVERIFY(*copy.attributes() == *attributes);
+    copy.attributes()->set("blob2", blob + "x");
+    QVERIFY(*copy.attributes() != *attributes);
+    QCOMPARE(copy.attributes()->value("blob2"), blob + "x");
+    QCOMPARE(attributes->value("blob2"), blob);
+
+    // History items keep the compressed values
+    entry->beginUpdate();
+    entry->setTitle("title");
+    entry->endUpdate();
+    const QList<HistoryItem> snapshots = entry->historySnapshots();
+    QCOMPARE(snapshots.size(), 1);
+    QCOMPARE(snapshots.first().attributeValue(EntryAttributes::NotesKey), notes);
+    QCOMPARE(snapshots.first().changedAttributes(HistoryItem(entry)), QStringList() << EntryAttributes::TitleKey);
+    QScopedPointer<Entry> historyEntry(snapshots.first().createEntry());
+    QVERIFY(historyEntry->attributes()->isCompressed("blob2"));
+    QCOMPARE(historyEntry->notes(), notes);
+
+    // Protecting a value stores it uncompressed
+    attributes->set("blob2", blob, true);
+    QVERIFY(!attributes->isCompressed("blob2"));
+    QVERIFY(attributes->isProtected("blob2"));
+    QCOMPARE(attributes->value("blob2"), blob);
+}
+
+void TestEntry::testSizeCache()
+{
+    Entry entry;
+    const int emptySize = entry.size();
+
+    entry.setNotes("1234");
+    QCOMPARE(entry.size(), emptySize + 4);
+    QCOMPARE(entry.size(), emptySize + 4);
+
+    entry.attachments()->set("a", QByteArray(10, 'x'));
+    QCOMPARE(entry.size(), emptySize + 4 + 1 + 10);
+
+    entry.attributes()->set("b", "12");
+    QCOMPARE(entry.size(), emptySize + 4 + 1 + 10 + 1 + 2);
+
+    Entry other;
+    other.copyDataFrom(&entry);
+    QCOMPARE(other.size(), entry.size());
+    entry.attachments()->remove("a");
+    QCOMPARE(entry.size(), emptySize + 4 + 1 + 2);
+}
+
+void TestEntry::testTimeInfo()
+{
+    const QDateTime time = Clock::datetimeUtc(2020, 5, 17, 12, 30, 45).addMSecs(250);
+
+    TimeInfo timeInfo;
+    timeInfo.setLastModificationTime(time);
+    QCOMPARE(timeInfo.lastModificationTime(), time);
+    QCOMPARE(timeInfo.lastModificationTime().timeSpec(), Qt::UTC);
+    QCOMPARE(timeInfo.lastModificationMSecs(), time.toMSecsSinceEpoch());
+
+    timeInfo.setExpiryTime(QDateTime());
+    QVERIFY(!timeInfo.expiryTime().isValid());
+    QCOMPARE(timeInfo.expiryMSecs(), TimeInfo::InvalidTime);
+
+    // whole seconds are kept, also before the epoch
+    QCOMPARE(TimeInfo::serialized(time.toMSecsSinceEpoch()), Clock::serialized(time).toMSecsSinceEpoch());
+    const QDateTime old = Clock::datetimeUtc(1960, 1, 1, 0, 0, 1).addMSecs(750);
+    QCOMPARE(TimeInfo::serialized(old.toMSecsSinceEpoch()), Clock::serialized(old).toMSecsSinceEpoch());
+
+    TimeInfo other = timeInfo;
+    QVERIFY(other == timeInfo);
+    other.setLastModificationTime(time.toMSecsSinceEpoch() + 500);
+    QVERIFY(other != timeInfo);
+    QVERIFY(other.equals(timeInfo, CompareItemIgnoreMilliseconds));
+    other.setLastModificationTime(time.toMSecsSinceEpoch() + 1000);
+    QVERIFY(!other.equals(timeInfo, CompareItemIgnoreMilliseconds));
+}
+
+void TestEntry::testCustomDataLookups()
+{
+    Entry entry;
+    CustomData* customData = entry.customData();
+    customData->set(CustomData::BrowserKeyPrefix + "b", "key-b");
+    customData->set("unrelated", "value");
+    customData->set(CustomData::BrowserKeyPrefix + "a", "key-a");
+
+    QCOMPARE(customData->keysWithPrefix(CustomData::BrowserKeyPrefix),
+             QList<QString>() << CustomData::BrowserKeyPrefix + "a" << CustomData::BrowserKeyPrefix + "b");
+    QVERIFY(customData->keysWithPrefix("missing").isEmpty());
+
+    QHash<QString, QString> browserKeys = customData->browserKeys();
+    QCOMPARE(browserKeys.size(), 2);
+    QCOMPARE(browserKeys.value("a"), QString("key-a"));
+
+    // the caches follow changes
+    customData->set(CustomData::BrowserKeyPrefix + "a", "changed");
+    customData->remove(CustomData::BrowserKeyPrefix + "b");
+    browserKeys = customData->browserKeys();
+    QCOMPARE(browserKeys.size(), 1);
+    QCOMPARE(browserKeys.value("a"), QString("changed"));
+    QCOMPARE(customData->keysWithPrefix(CustomData::BrowserKeyPrefix).size(), 1);
+
+    int parsed = 0;
+    auto parse = [&parsed](const QString& value) {
+        ++parsed;
+        return value.toInt();
+    };
+    customData->set("number", "42");
+    QCOMPARE(customData->parsedValue<int>("number", parse), 42);
+    QCOMPARE(customData->parsedValue<int>("number", parse), 42);
+    QCOMPARE(parsed, 1);
+    customData->set("number", "7");
+    QCOMPARE(customData->parsedValue<int>("number", parse), 7);
+    QCOMPARE(parsed, 2);
+}
+
 void TestEntry::testCopyDataFrom()
 {
     QScopedPointer<Entry> entry(new Entry());
@@ -510,6 +805,49 @@ void TestEntry::testResolveNonIdPlaceholdersToUuid()
     }
 }
 
+void TestEntry::testResolveCache()
+{
+    Database db;
+    auto* root = db.rootGroup();
+
+    auto* entry1 = new Entry();
+    entry1->setGroup(root);
+    entry1->setUuid(QUuid::createUuid());
+    entry1->setTitle("Title1");
+    entry1->setUsername("{S:Custom}");
+    entry1->attributes()->set("Custom", "Value1");
+
+    auto* entry2 = new Entry();
+    entry2->setGroup(root);
+    entry2->setUuid(QUuid::createUuid());
+    entry2->setTitle(QString("{REF:T@I:%1}").arg(entry1->uuidToHex()));
+    entry2->setUsername(QString("{REF:U@T:%1}").arg("Title3"));
+
+    QCOMPARE(entry1->resolveMultiplePlaceholders(entry1->username()), QString("Value1"));
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->title()), QString("Title1"));
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->username()), QString());
+
+    // changes of the entry itself invalidate its cached values
+    entry1->attributes()->set("Custom", "Value2");
+    QCOMPARE(entry1->resolveMultiplePlaceholders(entry1->username()), QString("Value2"));
+
+    // changes of referenced entries invalidate the cached values as well
+    entry1->setTitle("Title2");
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->title()), QString("Title2"));
+    QCOMPARE(entry2->resolvePlaceholder(entry2->title()), QString("Title2"));
+
+    // and so do new entries that are now found by a reference
+    auto* entry3 = new Entry();
+    entry3->setUuid(QUuid::createUuid());
+    entry3->setTitle("Title3");
+    entry3->setUsername("User3");
+    entry3->setGroup(root);
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->username()), QString("User3"));
+
+    delete entry3;
+    QCOMPARE(entry2->resolveMultiplePlaceholders(entry2->username()), QString());
+}
+
 void TestEntry::testResolveClonedEntry()
 {
     Database db;
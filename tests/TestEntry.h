@@ -29,6 +29,13 @@ class TestEntry : public QObject
 private slots:
     void initTestCase();
     void testHistoryItemDeletion();
+    void testHistoryItemSharing();
+    void testCompactHistory();
+    void testAttributeStorage();
+    void testCompressedAttributes();
+    void testSizeCache();
+    void testTimeInfo();
+    void testCustomDataLookups();
     void testCopyDataFrom();
     void testClone();
     void testResolveUrl();
@@ -36,6 +43,7 @@ private slots:
     void testResolveRecursivePlaceholders();
     void testResolveReferencePlaceholders();
     void testResolveNonIdPlaceholdersToUuid();
+    void testResolveCache();
     void testResolveClonedEntry();
     void testIsRecycled();
     void testMove();
@@ -20,15 +20,19 @@
 
 #include <QSignalSpy>
 
+#include "core/Database.h"
 #include "core/DatabaseIcons.h"
 #include "core/Entry.h"
 #include "core/Group.h"
+#include "core/Metadata.h"
 #include "crypto/Crypto.h"
 #include "gui/IconModels.h"
 #include "gui/SortFilterHideProxyModel.h"
 #include "gui/entry/AutoTypeAssociationsModel.h"
+#include "gui/entry/AutoTypeMatchModel.h"
 #include "gui/entry/EntryAttachmentsModel.h"
 #include "gui/entry/EntryAttributesModel.h"
+#include "gui/entry/EntryHistoryModel.h"
 #include "gui/entry/EntryModel.h"
 #include "modeltest.h"
 
@@ -117,9 +121,14 @@ void TestEntryModel::test()
     QCOMPARE(spyAboutToRemove.count(), 1);
     QCOMPARE(spyRemoved.count(), 1);
 
+    // switching groups replaces the rows without a reset
     QSignalSpy spyReset(model, SIGNAL(modelReset()));
     model->setGroup(group2);
-    QCOMPARE(spyReset.count(), 1);
+    QCOMPARE(spyReset.count(), 0);
+    QCOMPARE(spyRemoved.count(), 2);
+    QCOMPARE(spyAdded.count(), 2);
+    QCOMPARE(model->rowCount(), 1);
+    QCOMPARE(model->entryFromIndex(model->index(0, 0)), entry2);
 
     delete group1;
     delete group2;
@@ -243,20 +252,34 @@ void TestEntryModel::testCustomIconModel()
 
     QCOMPARE(model->rowCount(), 0);
 
-    QHash<QUuid, QPixmap> icons;
-    QList<QUuid> iconsOrder;
+    Database db;
+    Metadata* metadata = db.metadata();
 
     QUuid iconUuid = QUuid::fromRfc4122(QByteArray(16, '2'));
-    icons.insert(iconUuid, QPixmap());
-    iconsOrder << iconUuid;
+    metadata->addCustomIcon(iconUuid, QByteArray("icon2"));
 
     QUuid iconUuid2 = QUuid::fromRfc4122(QByteArray(16, '1'));
-    icons.insert(iconUuid2, QPixmap());
-    iconsOrder << iconUuid2;
+    metadata->addCustomIcon(iconUuid2, QByteArray("icon1"));
 
-    model->setIcons(icons, iconsOrder);
+    QSignalSpy spyReset(model, SIGNAL(modelReset()));
+    model->setMetadata(metadata);
+    QCOMPARE(spyReset.count(), 1);
+    QCOMPARE(model->rowCount(), 2);
     QCOMPARE(model->uuidFromIndex(model->index(0, 0)), iconUuid);
     QCOMPARE(model->uuidFromIndex(model->index(1, 0)), iconUuid2);
+    QCOMPARE(model->indexFromUuid(iconUuid2).row(), 1);
+
+    // the model is only rebuilt when the icons changed
+    model->setMetadata(metadata);
+    QCOMPARE(spyReset.count(), 1);
+    metadata->removeCustomIcon(iconUuid);
+    model->setMetadata(metadata);
+    QCOMPARE(spyReset.count(), 2);
+    QCOMPARE(model->rowCount(), 1);
+    QCOMPARE(model->uuidFromIndex(model->index(0, 0)), iconUuid2);
+
+    model->setMetadata(nullptr);
+    QCOMPARE(model->rowCount(), 0);
 
     delete modelTest;
     delete model;
@@ -298,6 +321,58 @@ void TestEntryModel::testAutoTypeAssociationsModel()
     delete associations;
 }
 
+void TestEntryModel::testAutoTypeMatchFilter()
+{
+    AutoTypeMatchModel* model = new AutoTypeMatchModel(this);
+    ModelTest* modelTest = new ModelTest(model, this);
+
+    Database db;
+    QList<AutoTypeMatch> matches;
+    const QStringList titles = {"alpha", "alphabet", "beta"};
+    const QStringList usernames = {"bob", "carol", "dave"};
+    for (int i = 0; i < titles.size(); ++i) {
+        auto* entry = new Entry();
+        entry->setGroup(db.rootGroup());
+        entry->setTitle(titles.at(i));
+        entry->setUsername(usernames.at(i));
+        matches.append(AutoTypeMatch(entry, "{USERNAME}"));
+    }
+
+    model->setMatchList(matches);
+    QCOMPARE(model->rowCount(), 3);
+
+    QSignalSpy spyReset(model, SIGNAL(modelReset()));
+    QSignalSpy spyRemoved(model, SIGNAL(rowsRemoved(QModelIndex, int, int)));
+
+    // a growing filter narrows the visible rows
+    model->setFilter("alp");
+    QCOMPARE(model->rowCount(), 2);
+    model->setFilter("alphab");
+    QCOMPARE(model->rowCount(), 1);
+    QCOMPARE(model->data(model->index(0, AutoTypeMatchModel::Title)).toString(), QString("alphabet"));
+    QCOMPARE(spyReset.count(), 0);
+    QCOMPARE(spyRemoved.count(), 2);
+
+    model->setFilter("");
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(spyReset.count(), 1);
+
+    model->setFilter("CAR");
+    QCOMPARE(model->rowCount(), 1);
+    QCOMPARE(model->data(model->index(0, AutoTypeMatchModel::Username)).toString(), QString("carol"));
+
+    model->setFilter("*et");
+    QCOMPARE(model->rowCount(), 2);
+
+    delete matches.at(2).entry;
+    QCOMPARE(model->rowCount(), 1);
+    model->setFilter("");
+    QCOMPARE(model->rowCount(), 2);
+
+    delete modelTest;
+    delete model;
+}
+
 void TestEntryModel::testProxyModel()
 {
     EntryModel* modelSource = new EntryModel(this);
@@ -356,6 +431,58 @@ void TestEntryModel::testProxyModel()
     delete db;
 }
 
+void TestEntryModel::testProxySort()
+{
+    EntryModel* modelSource = new EntryModel(this);
+    SortFilterHideProxyModel* modelProxy = new SortFilterHideProxyModel(this);
+    modelProxy->setSourceModel(modelSource);
+    modelProxy->setDynamicSortFilter(true);
+    modelProxy->setSortLocaleAware(true);
+    modelProxy->setSortCaseSensitivity(Qt::CaseInsensitive);
+    modelProxy->setSortRole(Qt::UserRole);
+
+    ModelTest* modelTest = new ModelTest(modelProxy, this);
+
+    Database db;
+    const QStringList titles = {"beta", "Alpha", "gamma"};
+    for (const QString& title : titles) {
+        auto* entry = new Entry();
+        entry->setTitle(title);
+        entry->setGroup(db.rootGroup());
+    }
+    modelSource->setGroup(db.rootGroup());
+
+    auto sortedTitles = [modelProxy]() -> QStringList {
+        QStringList result;
+        for (int row = 0; row < modelProxy->rowCount(); ++row) {
+            result << modelProxy->index(row, EntryModel::Title).data().toString();
+        }
+        return result;
+    };
+
+    modelProxy->sort(EntryModel::Title, Qt::AscendingOrder);
+    QCOMPARE(sortedTitles(), QStringList({"Alpha", "beta", "gamma"}));
+
+    // keys follow changed, added and removed rows
+    db.rootGroup()->entries().at(0)->setTitle("delta");
+    QCOMPARE(sortedTitles(), QStringList({"Alpha", "delta", "gamma"}));
+    auto* entry = new Entry();
+    entry->setTitle("Epsilon");
+    entry->setGroup(db.rootGroup());
+    QCOMPARE(sortedTitles(), QStringList({"Alpha", "delta", "Epsilon", "gamma"}));
+    delete db.rootGroup()->entries().at(1);
+    QCOMPARE(sortedTitles(), QStringList({"delta", "Epsilon", "gamma"}));
+
+    // sizes are compared as numbers
+    entry->setNotes(QString(2000, 'x'));
+    modelProxy->sort(EntryModel::Size, Qt::DescendingOrder);
+    QCOMPARE(sortedTitles().first(), QString("Epsilon"));
+
+    delete modelTest;
+    delete modelProxy;
+    delete modelSource;
+}
+
 void TestEntryModel::testDatabaseDelete()
 {
     EntryModel* model = new EntryModel(this);
@@ -386,3 +513,229 @@ void TestEntryModel::testDatabaseDelete()
     delete modelTest;
     delete model;
 }
+
+void TestEntryModel::testBulkUpdate()
+{
+    Database db;
+    auto* entry1 = new Entry();
+    entry1->setGroup(db.rootGroup());
+
+    EntryModel* model = new EntryModel(this);
+    ModelTest* modelTest = new ModelTest(model, this);
+    model->setGroup(db.rootGroup());
+
+    QSignalSpy spyAdded(model, SIGNAL(rowsInserted(QModelIndex, int, int)));
+    QSignalSpy spyRemoved(model, SIGNAL(rowsRemoved(QModelIndex, int, int)));
+    QSignalSpy spyReset(model, SIGNAL(modelReset()));
+    QSignalSpy spyDataChanged(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)));
+
+    // data changes are coalesced into one
+    db.beginBulkUpdate();
+    entry1->setTitle("title1");
+    entry1->setUsername("user1");
+    QCOMPARE(spyDataChanged.count(), 0);
+    db.endBulkUpdate();
+    QCOMPARE(spyDataChanged.count(), 1);
+    QCOMPARE(spyReset.count(), 0);
+
+    // added and removed rows end up in a single reset
+    db.beginBulkUpdate();
+    db.beginBulkUpdate();
+    for (int i = 0; i < 3; ++i) {
+        auto* entry = new Entry();
+        entry->setGroup(db.rootGroup());
+    }
+    delete entry1;
+    db.endBulkUpdate();
+    QCOMPARE(spyReset.count(), 0);
+    db.endBulkUpdate();
+
+    QCOMPARE(spyAdded.count(), 0);
+    QCOMPARE(spyRemoved.count(), 0);
+    QCOMPARE(spyReset.count(), 1);
+    QCOMPARE(model->rowCount(), 3);
+
+    // outside of bulk updates rows are reported one by one again
+    auto* entry = new Entry();
+    entry->setGroup(db.rootGroup());
+    QCOMPARE(spyAdded.count(), 1);
+    QCOMPARE(model->rowCount(), 4);
+
+    delete modelTest;
+    delete model;
+}
+
+void TestEntryModel::testIncrementalEntries()
+{
+    EntryModel* model = new EntryModel(this);
+    ModelTest* modelTest = new ModelTest(model, this);
+
+    Database db;
+    Group* group = new Group();
+    group->setParent(db.rootGroup());
+    QList<Entry*> entries;
+    for (int i = 0; i < 6; ++i) {
+        auto* entry = new Entry();
+        entry->setGroup(i % 2 ? group : db.rootGroup());
+        entries << entry;
+    }
+
+    model->setEntries(entries);
+    QCOMPARE(model->rowCount(), 6);
+
+    QSignalSpy spyReset(model, SIGNAL(modelReset()));
+    QSignalSpy spyRemoved(model, SIGNAL(rowsRemoved(QModelIndex, int, int)));
+    QSignalSpy spyAdded(model, SIGNAL(rowsInserted(QModelIndex, int, int)));
+
+    // a narrowed result removes the dropped rows
+    model->setEntries({entries[0], entries[3], entries[4]});
+    QCOMPARE(spyReset.count(), 0);
+    QCOMPARE(spyRemoved.count(), 2);
+    QCOMPARE(spyRemoved.at(0).at(1).toInt(), 5);
+    QCOMPARE(spyRemoved.at(1).at(1).toInt(), 1);
+    QCOMPARE(spyRemoved.at(1).at(2).toInt(), 2);
+
+    // a widened result inserts the new rows
+    const QList<Entry*> widened = {entries[0], entries[1], entries[3], entries[4], entries[5]};
+    model->setEntries(widened);
+    QCOMPARE(spyReset.count(), 0);
+    QCOMPARE(spyAdded.count(), 2);
+    QCOMPARE(spyAdded.at(0).at(1).toInt(), 1);
+    QCOMPARE(spyAdded.at(1).at(1).toInt(), 4);
+    QCOMPARE(model->rowCount(), widened.size());
+    for (int row = 0; row < widened.size(); ++row) {
+        QCOMPARE(model->entryFromIndex(model->index(row, 0)), widened.at(row));
+    }
+
+    // a reordered result resets the model
+    model->setEntries({entries[1], entries[0]});
+    QCOMPARE(spyReset.count(), 1);
+    QCOMPARE(model->rowCount(), 2);
+
+    // changes are followed through the database
+    delete entries[0];
+    QCOMPARE(model->rowCount(), 1);
+    entries[1]->setGroup(db.rootGroup());
+    QCOMPARE(model->rowCount(), 1);
+    QCOMPARE(model->entryFromIndex(model->index(0, 0)), entries[1]);
+
+    delete modelTest;
+    delete model;
+}
+
+void TestEntryModel::testDisplayCache()
+{
+    EntryModel* model = new EntryModel(this);
+    ModelTest* modelTest = new ModelTest(model, this);
+
+    Database db;
+    Group* group1 = new Group();
+    group1->setParent(db.rootGroup());
+    Group* group2 = new Group();
+    group2->setParent(db.rootGroup());
+
+    Entry* entry1 = new Entry();
+    entry1->setGroup(group1);
+    entry1->setTitle("title");
+    entry1->setUsername("user");
+
+    // the referenced entry is in a group the model does not show
+    Entry* entry2 = new Entry();
+    entry2->setGroup(group2);
+    entry2->setTitle("referenced");
+
+    model->setGroup(group1);
+    QModelIndex title = model->index(0, EntryModel::Title);
+    QModelIndex username = model->index(0, EntryModel::Username);
+    QCOMPARE(model->data(title).toString(), QString("title"));
+    QCOMPARE(model->data(username).toString(), QString("user"));
+
+    entry1->setTitle("changed");
+    QCOMPARE(model->data(title).toString(), QString("changed"));
+
+    entry1->setUsername(QString("{REF:T@I:%1}").arg(entry2->uuidToHex()));
+    QCOMPARE(model->data(username).toString(), QString("Ref: referenced"));
+    QCOMPARE(model->data(username, Qt::UserRole).toString(), QString("referenced"));
+    entry2->setTitle("changed reference");
+    QCOMPARE(model->data(username).toString(), QString("Ref: changed reference"));
+    QCOMPARE(model->data(username, Qt::UserRole).toString(), QString("changed reference"));
+
+    delete modelTest;
+    delete model;
+}
+
+void TestEntryModel::testEntryHistoryModel()
+{
+    Entry entry;
+    entry.setTitle("title 0");
+    for (int i = 1; i <= 250; ++i) {
+        entry.beginUpdate();
+        entry.setTitle(QString("title %1").arg(i));
+        entry.endUpdate();
+    }
+    QVERIFY(entry.hasCompactHistory());
+
+    auto* model = new EntryHistoryModel(this);
+    auto* modelTest = new ModelTest(model, this);
+    model->setEntry(&entry);
+
+    // rows are added in batches, newest first, without expanding the history
+    QCOMPARE(model->rowCount(), 100);
+    QCOMPARE(model->data(model->index(0, 1)).toString(), QString("title 249"));
+    QCOMPARE(model->data(model->index(99, 1)).toString(), QString("title 150"));
+    QVERIFY(model->canFetchMore({}));
+    model->fetchMore({});
+    QCOMPARE(model->rowCount(), 200);
+    model->fetchMore({});
+    QCOMPARE(model->rowCount(), 250);
+    QVERIFY(!model->canFetchMore({}));
+    QCOMPARE(model->data(model->index(249, 1)).toString(), QString("title 0"));
+    QCOMPARE(model->entryFromIndex(model->index(10, 0))->title(), QString("title 239"));
+    QVERIFY(entry.hasCompactHistory());
+
+    // deletions refer to the positions in the history
+    model->deleteIndex(model->index(0, 0));
+    QCOMPARE(model->rowCount(), 249);
+    QCOMPARE(model->deletedEntries(), QList<int>({249}));
+    entry.removeHistoryItemsAt(model->deletedEntries());
+    QCOMPARE(entry.historyItemCount(), 249);
+    QVERIFY(entry.hasCompactHistory());
+
+    model->setEntry(&entry);
+    model->deleteAll();
+    QCOMPARE(model->rowCount(), 0);
+    QCOMPARE(model->deletedEntries().size(), 249);
+    entry.removeHistoryItemsAt(model->deletedEntries());
+    QCOMPARE(entry.historyItemCount(), 0);
+
+    // the changed fields are compared in the background
+    Entry changed;
+    changed.setTitle("a");
+    changed.setPassword("p1");
+    changed.beginUpdate();
+    changed.setPassword("p2");
+    changed.endUpdate();
+    changed.beginUpdate();
+    changed.setTitle("b");
+    changed.endUpdate();
+    changed.beginUpdate();
+    changed.setUsername("user");
+    changed.attachments()->set("file", "data");
+    changed.endUpdate();
+
+    model->setEntry(&changed);
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(model->data(model->index(2, 4)).toString(), QString("Oldest version"));
+    model->data(model->index(0, 4));
+    model->data(model->index(1, 4));
+    QTRY_COMPARE(model->data(model->index(0, 4)).toString(), QString("Title"));
+    QTRY_COMPARE(model->data(model->index(1, 4)).toString(), QString("Password"));
+
+    // and the same for expanded history items
+    QCOMPARE(changed.historyItems().size(), 3);
+    model->setEntry(&changed);
+    QTRY_COMPARE(model->data(model->index(0, 4)).toString(), QString("Title"));
+
+    delete modelTest;
+    delete model;
+}
@@ -32,8 +32,14 @@ private slots:
     void testDefaultIconModel();
     void testCustomIconModel();
     void testAutoTypeAssociationsModel();
+    void testAutoTypeMatchFilter();
     void testProxyModel();
+    void testProxySort();
     void testDatabaseDelete();
+    void testBulkUpdate();
+    void testIncrementalEntries();
+    void testDisplayCache();
+    void testEntryHistoryModel();
 };
 
 #endif // KEEPASSX_TESTENTRYMODEL_H
@@ -18,6 +18,13 @@
 #include "TestEntrySearcher.h"
 #include "TestGlobal.h"
 
+#include "core/Clock.h"
+#include "core/Database.h"
+#include "core/EntrySearchIndex.h"
+#include "core/MultiDatabaseSearch.h"
+
+#include <QSignalSpy>
+
 QTEST_GUILESS_MAIN(TestEntrySearcher)
 
 void TestEntrySearcher::init()
@@ -370,3 +377,276 @@ void TestEntrySearcher::testSkipProtected()
         m_entrySearcher.search("_testAttribute:testE1 _testProtected:apple _testAttribute:testE2", m_rootGroup);
     QCOMPARE(m_searchResult, {});
 }
+
+void TestEntrySearcher::testSearchIndex()
+{
+    Database db;
+    Group* root = db.rootGroup();
+
+    auto* e1 = new Entry();
+    e1->setTitle("Dropbox Account");
+    e1->setUsername("alice");
+    e1->setUrl("https://www.dropbox.com");
+    e1->setGroup(root);
+
+    auto* e2 = new Entry();
+    e2->setTitle("{USERNAME}");
+    e2->setUsername("dropbox-backup");
+    e2->setGroup(root);
+
+    auto* e3 = new Entry();
+    e3->setTitle("Bank");
+    e3->setNotes("PIN stored at the branch office");
+    e3->attributes()->set("account", "4711-kontonummer");
+    e3->attributes()->set("secret", "dropbox", true);
+    e3->setGroup(root);
+
+    EntrySearcher indexedSearcher;
+    indexedSearcher.setUseIndex(true);
+
+    const QStringList queries{"dropbox",
+                              "DROPBOX",
+                              "title:dropbox",
+                              "drop*box",
+                              "d?opbox",
+                              "*box",
+                              "ba",
+                              "-dropbox",
+                              "dropbox -account",
+                              "branch office",
+                              "\"branch office\"",
+                              "+bank",
+                              "_account:kontonummer",
+                              "_secret:dropbox",
+                              "*drop.*box",
+                              "*(dropbox|bank)",
+                              "url:www.dropbox",
+                              "nothing-matches-this"};
+
+    auto compareResults = [&]() {
+        for (const QString& query : queries) {
+            QCOMPARE(indexedSearcher.search(query, root), m_entrySearcher.search(query, root));
+        }
+    };
+
+    compareResults();
+    QCOMPARE(db.searchIndex()->size(), 3);
+
+    QCOMPARE(indexedSearcher.search("title:dropbox", root), QList<Entry*>({e1, e2}));
+    QCOMPARE(indexedSearcher.search("_account:kontonummer", root), QList<Entry*>({e3}));
+
+    // modified entries are reindexed
+    e1->setTitle("Nextcloud Account");
+    e3->setNotes("dropbox");
+    compareResults();
+    QCOMPARE(indexedSearcher.search("title:dropbox", root), QList<Entry*>({e2}));
+    QCOMPARE(indexedSearcher.search("notes:dropbox", root), QList<Entry*>({e3}));
+
+    // deleted entries are removed from the index
+    delete e3;
+    QCOMPARE(db.searchIndex()->size(), 2);
+    compareResults();
+}
+
+void TestEntrySearcher::testParallelSearch()
+{
+    QList<Entry*> expected;
+    for (int i = 0; i < 3000; ++i) {
+        auto* entry = new Entry();
+        entry->setTitle(QString("entry %1").arg(i));
+        entry->setGroup(m_rootGroup);
+        if (QString::number(i).startsWith("1")) {
+            expected.append(entry);
+        }
+    }
+
+    // results are merged in tree order
+    m_searchResult = m_entrySearcher.search("title:\"entry 1*\"", m_rootGroup);
+    QCOMPARE(m_searchResult, expected);
+    m_searchResult = m_entrySearcher.search("", m_rootGroup);
+    QCOMPARE(m_searchResult, m_rootGroup->entries());
+
+    EntrySearcher::CancelToken token;
+    m_entrySearcher.setCancelToken(token);
+    token.cancel();
+    m_searchResult = m_entrySearcher.search("", m_rootGroup);
+    QCOMPARE(m_searchResult, {});
+}
+
+void TestEntrySearcher::testNarrowingSearch()
+{
+    // longer plain terms and additional terms only match a subset
+    QVERIFY(m_entrySearcher.narrows("some", "som"));
+    QVERIFY(m_entrySearcher.narrows("SOMETHING", "some"));
+    QVERIFY(m_entrySearcher.narrows("title:something", "title:some"));
+    QVERIFY(m_entrySearcher.narrows("some thing", "some"));
+    QVERIFY(m_entrySearcher.narrows("-user some", "-user som"));
+
+    // anything else is a different search
+    QVERIFY(!m_entrySearcher.narrows("some", "some thing"));
+    QVERIFY(!m_entrySearcher.narrows("other", "some"));
+    QVERIFY(!m_entrySearcher.narrows("some", ""));
+    QVERIFY(!m_entrySearcher.narrows("-some", "-som"));
+    QVERIFY(!m_entrySearcher.narrows("+some", "+som"));
+    QVERIFY(!m_entrySearcher.narrows("username:some", "title:some"));
+    QVERIFY(!m_entrySearcher.narrows("so*me", "so*"));
+    QVERIFY(!m_entrySearcher.narrows("title:some", "title"));
+
+    m_entrySearcher.setCaseSensitive(true);
+    QVERIFY(!m_entrySearcher.narrows("SOMETHING", "some"));
+    QVERIFY(m_entrySearcher.narrows("something", "some"));
+}
+
+void TestEntrySearcher::testTags()
+{
+    Database db;
+    Group* root = db.rootGroup();
+
+    auto* e1 = new Entry();
+    e1->setTitle("Mail");
+    e1->setTags("work, mail;Personal");
+    e1->setGroup(root);
+
+    auto* e2 = new Entry();
+    e2->setTitle("Bank");
+    e2->setTags("finance:personal");
+    e2->setGroup(root);
+
+    auto* e3 = new Entry();
+    e3->setTitle("Work laptop");
+    e3->setGroup(root);
+
+    QCOMPARE(e1->tagList(), QStringList({"work", "mail", "Personal"}));
+    // equal tags of different entries share their data
+    auto* e4 = new Entry();
+    e4->setTags("work");
+    QVERIFY(e4->tagList().first().constData() == e1->tagList().first().constData());
+    delete e4;
+
+    QCOMPARE(m_entrySearcher.search("tag:work", root), QList<Entry*>({e1}));
+    QCOMPARE(m_entrySearcher.search("tag:personal", root), QList<Entry*>({e1, e2}));
+    QCOMPARE(m_entrySearcher.search("+tag:mail", root), QList<Entry*>({e1}));
+    QCOMPARE(m_entrySearcher.search("-tag:personal", root), QList<Entry*>({e3}));
+    QCOMPARE(m_entrySearcher.search("tag:fin*", root), QList<Entry*>({e2}));
+
+    EntrySearcher indexedSearcher;
+    indexedSearcher.setUseIndex(true);
+    const QStringList queries{"tag:work", "tag:personal", "+tag:mail", "-tag:personal", "tag:fin*", "work tag:mail"};
+    for (const QString& query : queries) {
+        QCOMPARE(indexedSearcher.search(query, root), m_entrySearcher.search(query, root));
+    }
+
+    // retagged entries are reindexed
+    e2->setTags("work");
+    QCOMPARE(indexedSearcher.search("tag:work", root), QList<Entry*>({e1, e2}));
+    QCOMPARE(indexedSearcher.search("tag:finance", root), QList<Entry*>());
+}
+
+void TestEntrySearcher::testMultiDatabaseSearch()
+{
+    auto db1 = QSharedPointer<Database>::create();
+    auto db2 = QSharedPointer<Database>::create();
+    auto addEntry = [](Database* db, const QString& title) {
+        auto* entry = new Entry();
+        entry->setTitle(title);
+        entry->setGroup(db->rootGroup());
+        return entry;
+    };
+    Entry* contains1 = addEntry(db1.data(), "gmail account");
+    Entry* exact1 = addEntry(db1.data(), "mail");
+    addEntry(db1.data(), "other");
+    Entry* prefix2 = addEntry(db2.data(), "Mailbox");
+    Entry* contains2 = addEntry(db2.data(), "webmail");
+    Entry* exact2 = addEntry(db2.data(), "Mail");
+
+    MultiDatabaseSearch search;
+    QSignalSpy finished(&search, SIGNAL(finished(int)));
+    search.setDatabases({db1, db2});
+    search.search("mail");
+    QVERIFY(search.isRunning());
+    QVERIFY(finished.wait());
+    QVERIFY(!search.isRunning());
+
+    // ranked by title match, ties keep the database order
+    QCOMPARE(search.results(), QList<Entry*>() << exact1 << exact2 << prefix2 << contains1 << contains2);
+
+    // entries and databases that go away leave the results
+    delete prefix2;
+    QCOMPARE(search.results(), QList<Entry*>() << exact1 << exact2 << contains1 << contains2);
+    db1.reset();
+    QCOMPARE(search.results(), QList<Entry*>() << exact2 << contains2);
+
+    finished.clear();
+    search.search("");
+    QCOMPARE(finished.size(), 1);
+    QVERIFY(search.results().isEmpty());
+}
+
+void TestEntrySearcher::testRankedSearch()
+{
+    auto addEntry = [this](const QString& title, const QString& username = {}) {
+        auto* entry = new Entry();
+        entry->setTitle(title);
+        entry->setUsername(username);
+        entry->setGroup(m_rootGroup);
+        return entry;
+    };
+    Entry* username = addEntry("other", "mail");
+    Entry* substring = addEntry("gmail");
+    Entry* wordStart = addEntry("Web Mail");
+    Entry* prefix = addEntry("Mailbox");
+    Entry* exact = addEntry("mail");
+    addEntry("unrelated");
+
+    // title matches first, ties keep the tree order
+    const QList<Entry*> expected{exact, prefix, wordStart, substring, username};
+    QCOMPARE(m_entrySearcher.searchRanked("mail", m_rootGroup, 0), expected);
+    QCOMPARE(m_entrySearcher.searchRanked("mail", m_rootGroup, 2), expected.mid(0, 2));
+    QCOMPARE(m_entrySearcher.searchRanked("mail", m_rootGroup, 10), expected);
+    QVERIFY(m_entrySearcher.searchRanked("nothing", m_rootGroup, 10).isEmpty());
+
+    // the ranked matches are the matches of a plain search
+    const QStringList queries{"mail", "mail -web", "title:mail", "u:mail", "+mail", "m*l"};
+    for (const QString& query : queries) {
+        const QList<Entry*> matches = m_entrySearcher.search(query, m_rootGroup);
+        const QList<Entry*> ranked = m_entrySearcher.searchRanked(query, m_rootGroup, 0);
+        QCOMPARE(ranked.size(), matches.size());
+        for (Entry* entry : ranked) {
+            QVERIFY(matches.contains(entry));
+        }
+    }
+
+    // usage and recency order equal title matches
+    Entry* unused = addEntry("bank");
+    Entry* used = addEntry("bank");
+    Entry* stale = addEntry("bank");
+    TimeInfo timeInfo = used->timeInfo();
+    timeInfo.setUsageCount(10);
+    used->setTimeInfo(timeInfo);
+    timeInfo = stale->timeInfo();
+    timeInfo.setLastAccessTime(Clock::currentDateTimeUtc().addDays(-100));
+    stale->setTimeInfo(timeInfo);
+    QCOMPARE(m_entrySearcher.searchRanked("bank", m_rootGroup, 0), QList<Entry*>({used, unused, stale}));
+    QVERIFY(m_entrySearcher.score(used) > m_entrySearcher.score(unused));
+    QCOMPARE(m_entrySearcher.searchRanked("bank", m_rootGroup, 1), QList<Entry*>({used}));
+
+    // but never outweigh a better title match
+    Entry* bankPrefix = addEntry("banking");
+    timeInfo = bankPrefix->timeInfo();
+    timeInfo.setUsageCount(1000000);
+    bankPrefix->setTimeInfo(timeInfo);
+    QCOMPARE(m_entrySearcher.searchRanked("bank", m_rootGroup, 0).last(), bankPrefix);
+
+    // the search index gives the same ranking
+    Database db;
+    const QList<Entry*> entries = m_rootGroup->entries();
+    for (Entry* entry : entries) {
+        entry->setGroup(db.rootGroup());
+    }
+    EntrySearcher indexedSearcher;
+    indexedSearcher.setUseIndex(true);
+    for (const QString& query : queries) {
+        QCOMPARE(indexedSearcher.searchRanked(query, db.rootGroup(), 3),
+                 m_entrySearcher.searchRanked(query, db.rootGroup(), 3));
+    }
+}
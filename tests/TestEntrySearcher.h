@@ -38,6 +38,12 @@ private slots:
     void testCustomAttributesAreSearched();
     void testGroup();
     void testSkipProtected();
+    void testSearchIndex();
+    void testParallelSearch();
+    void testNarrowingSearch();
+    void testTags();
+    void testMultiDatabaseSearch();
+    void testRankedSearch();
 
 private:
     Group* m_rootGroup;
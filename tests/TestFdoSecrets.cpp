@@ -92,6 +92,26 @@ void TestFdoSecrets::testDhIetf1024Sha256Aes128CbcPkcs7()
     QVERIFY(cipher->isValid());
 
     QCOMPARE(cipher->m_aesKey.toHex(), QByteArrayLiteral("6b8f5ee55138eac37118508be21e7834"));
+
+    auto copy = cipher->clone();
+    QVERIFY(copy->isValid());
+    QCOMPARE(copy->m_aesKey, cipher->m_aesKey);
+    QCOMPARE(copy->negotiationOutput(), cipher->negotiationOutput());
+
+    // batch encryption uses a distinct IV per secret and round-trips through decrypt
+    QList<FdoSecrets::SecretStruct> secrets;
+    for (const auto& value : {QByteArrayLiteral("first"), QByteArrayLiteral("0123456789abcdef"), QByteArray()}) {
+        FdoSecrets::SecretStruct secret;
+        secret.value = value;
+        secrets.append(secret);
+    }
+    const auto encrypted = cipher->encryptAll(secrets);
+    QCOMPARE(encrypted.size(), secrets.size());
+    QVERIFY(encrypted[0].parameters != encrypted[1].parameters);
+    for (int i = 0; i < secrets.size(); ++i) {
+        QCOMPARE(encrypted[i].parameters.size(), 16);
+        QCOMPARE(cipher->decrypt(encrypted[i]).value, secrets[i].value);
+    }
 }
 
 void TestFdoSecrets::testCrazyAttributeKey()
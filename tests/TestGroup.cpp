@@ -20,9 +20,11 @@
 #include "TestGlobal.h"
 #include "mock/MockClock.h"
 
+#include <QBuffer>
 #include <QScopedPointer>
 #include <QSignalSpy>
 
+#include "core/MemoryUsage.h"
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
 
@@ -472,6 +474,48 @@ void TestGroup::testCopyCustomIcons()
     QCOMPARE(metaTarget->customIcon(group2Icon).pixel(0, 0), qRgb(4, 5, 6));
 }
 
+void TestGroup::testCustomIconData()
+{
+    QImage image(16, 16, QImage::Format_RGB32);
+    image.fill(qRgb(7, 8, 9));
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(image.save(&buffer, "PNG"));
+    buffer.close();
+
+    QScopedPointer<Database> db(new Database());
+    Metadata* meta = db->metadata();
+
+    // Encoded data is kept as is and decoded on demand
+    QUuid iconUuid = QUuid::createUuid();
+    meta->addCustomIcon(iconUuid, data);
+    QVERIFY(meta->hasCustomIcon(iconUuid));
+
+    // Lookups compare the encoded data without decoding the icons
+    QCOMPARE(meta->findCustomIcon(image), iconUuid);
+    MemoryUsage usage;
+    meta->addMemoryUsage(usage);
+    QCOMPARE(usage.customIconsDecoded, qint64(0));
+    QCOMPARE(meta->customIconData(iconUuid), data);
+    QCOMPARE(meta->customIcon(iconUuid).size(), QSize(16, 16));
+    QCOMPARE(meta->customIcon(iconUuid).pixel(0, 0), qRgb(7, 8, 9));
+
+    // Lookups by image still resolve icons added from encoded data
+    QCOMPARE(meta->findCustomIcon(image), iconUuid);
+
+    // Copies carry the encoded data over
+    QScopedPointer<Database> dbTarget(new Database());
+    dbTarget->metadata()->copyCustomIcons({iconUuid}, meta);
+    QCOMPARE(dbTarget->metadata()->customIconData(iconUuid), data);
+
+    meta->removeCustomIcon(iconUuid);
+    QVERIFY(!meta->hasCustomIcon(iconUuid));
+    QVERIFY(meta->customIcon(iconUuid).isNull());
+    QVERIFY(meta->findCustomIcon(image).isNull());
+}
+
 void TestGroup::testFindEntry()
 {
     QScopedPointer<Database> db(new Database());
@@ -554,6 +598,108 @@ void TestGroup::testFindEntry()
     QVERIFY(!entry);
 }
 
+void TestGroup::testFindByUuidIndex()
+{
+    QScopedPointer<Database> db(new Database());
+    QScopedPointer<Database> db2(new Database());
+
+    auto* group1 = new Group();
+    group1->setUuid(QUuid::createUuid());
+    group1->setParent(db->rootGroup());
+    auto* group2 = new Group();
+    group2->setUuid(QUuid::createUuid());
+    group2->setParent(db->rootGroup());
+
+    auto* entry1 = new Entry();
+    entry1->setUuid(QUuid::createUuid());
+    entry1->setGroup(group1);
+
+    QCOMPARE(db->rootGroup()->findEntryByUuid(entry1->uuid()), entry1);
+    QCOMPARE(group1->findEntryByUuid(entry1->uuid(), false), entry1);
+    QVERIFY(!group2->findEntryByUuid(entry1->uuid()));
+    QVERIFY(!db->rootGroup()->findEntryByUuid(entry1->uuid(), false));
+    QCOMPARE(db->rootGroup()->findGroupByUuid(group1->uuid()), group1);
+    QCOMPARE(group1->findGroupByUuid(group1->uuid()), group1);
+    QVERIFY(!group2->findGroupByUuid(group1->uuid()));
+
+    // changed uuids are reindexed
+    const QUuid oldUuid = entry1->uuid();
+    entry1->setUuid(QUuid::createUuid());
+    QVERIFY(!db->rootGroup()->findEntryByUuid(oldUuid));
+    QCOMPARE(db->rootGroup()->findEntryByUuid(entry1->uuid()), entry1);
+
+    // moving entries and groups within and across databases
+    entry1->setGroup(group2);
+    QCOMPARE(group2->findEntryByUuid(entry1->uuid()), entry1);
+    QVERIFY(!group1->findEntryByUuid(entry1->uuid()));
+
+    group2->setParent(db2->rootGroup());
+    QVERIFY(!db->rootGroup()->findEntryByUuid(entry1->uuid()));
+    QVERIFY(!db->rootGroup()->findGroupByUuid(group2->uuid()));
+    QCOMPARE(db2->rootGroup()->findEntryByUuid(entry1->uuid()), entry1);
+    QCOMPARE(db2->rootGroup()->findGroupByUuid(group2->uuid()), group2);
+
+    // duplicated uuids resolve to the first entry in tree order
+    auto* duplicate = entry1->clone(Entry::CloneNoFlags);
+    duplicate->setGroup(db2->rootGroup());
+    QCOMPARE(db2->rootGroup()->findEntryByUuid(entry1->uuid()), duplicate);
+    QCOMPARE(group2->findEntryByUuid(entry1->uuid()), entry1);
+
+    delete duplicate;
+    QCOMPARE(db2->rootGroup()->findEntryByUuid(entry1->uuid()), entry1);
+    const QUuid entryUuid = entry1->uuid();
+    const QUuid groupUuid = group2->uuid();
+    delete group2;
+    QVERIFY(!db2->rootGroup()->findEntryByUuid(entryUuid));
+    QVERIFY(!db2->rootGroup()->findGroupByUuid(groupUuid));
+}
+
+void TestGroup::testReferencesRecursive()
+{
+    QScopedPointer<Database> db(new Database());
+
+    auto* group1 = new Group();
+    group1->setParent(db->rootGroup());
+
+    auto* target = new Entry();
+    target->setUuid(QUuid::createUuid());
+    target->setTitle("target");
+    target->setUsername("user");
+    target->setGroup(db->rootGroup());
+
+    auto* reference1 = new Entry();
+    reference1->setUuid(QUuid::createUuid());
+    reference1->setUsername(QString("{REF:U@I:%1}").arg(target->uuidToHex()));
+    reference1->setGroup(db->rootGroup());
+
+    // references are indexed no matter if they are set before or after adding the entry
+    auto* reference2 = new Entry();
+    reference2->setUuid(QUuid::createUuid());
+    reference2->setGroup(group1);
+    reference2->setTitle(QString("{REF:T@I:%1}").arg(target->uuidToHex().toUpper()));
+
+    auto* unrelated = new Entry();
+    unrelated->setUuid(QUuid::createUuid());
+    unrelated->setNotes(target->uuidToHex());
+    unrelated->setGroup(db->rootGroup());
+
+    auto references = db->rootGroup()->referencesRecursive(target);
+    QCOMPARE(references.size(), 2);
+    QVERIFY(references.contains(reference1));
+    QVERIFY(references.contains(reference2));
+    QCOMPARE(group1->referencesRecursive(target), QList<Entry*>({reference2}));
+
+    reference1->replaceReferencesWithValues(target);
+    QCOMPARE(reference1->username(), QString("user"));
+    QCOMPARE(db->rootGroup()->referencesRecursive(target), QList<Entry*>({reference2}));
+
+    // entries leaving the database are no longer returned
+    QScopedPointer<Database> db2(new Database());
+    group1->setParent(db2->rootGroup());
+    QVERIFY(db->rootGroup()->referencesRecursive(target).isEmpty());
+    QCOMPARE(db2->rootGroup()->referencesRecursive(target), QList<Entry*>({reference2}));
+}
+
 void TestGroup::testFindGroupByPath()
 {
     QScopedPointer<Database> db(new Database());
@@ -616,6 +762,58 @@ void TestGroup::testFindGroupByPath()
     QVERIFY(!group);
 }
 
+void TestGroup::testFindByPathIndex()
+{
+    QScopedPointer<Database> db(new Database());
+
+    // Two groups with the same name, the first one in tree order wins
+    auto* first = new Group();
+    first->setName("group");
+    first->setParent(db->rootGroup());
+    auto* second = new Group();
+    second->setName("group");
+    second->setParent(db->rootGroup());
+
+    auto* entry1 = new Entry();
+    entry1->setTitle("entry");
+    entry1->setGroup(first);
+    auto* entry2 = new Entry();
+    entry2->setTitle("entry");
+    entry2->setGroup(second);
+
+    QCOMPARE(db->rootGroup()->findGroupByPath("/group/"), first);
+    QCOMPARE(db->rootGroup()->findEntryByPath("/group/entry"), entry1);
+    QCOMPARE(db->rootGroup()->findEntryByPath("entry"), entry1);
+
+    // Lookups relative to a group stay within it
+    QCOMPARE(second->findEntryByPath("/entry"), entry2);
+    QCOMPARE(second->findGroupByPath("/"), second);
+    QVERIFY(!second->findEntryByPath("/missing"));
+
+    // Renames, moves and reordering are picked up
+    entry1->setTitle("renamed");
+    QCOMPARE(db->rootGroup()->findEntryByPath("/group/entry"), entry2);
+    QCOMPARE(db->rootGroup()->findEntryByPath("/group/renamed"), entry1);
+
+    second->setName("other");
+    QCOMPARE(db->rootGroup()->findEntryByPath("/other/entry"), entry2);
+    QVERIFY(!db->rootGroup()->findEntryByPath("/group/entry"));
+
+    second->setParent(first);
+    QCOMPARE(db->rootGroup()->findGroupByPath("/group/other/"), second);
+    QVERIFY(!db->rootGroup()->findGroupByPath("/other/"));
+
+    auto* entry3 = new Entry();
+    entry3->setTitle("renamed");
+    entry3->setGroup(first);
+    QCOMPARE(db->rootGroup()->findEntryByPath("/group/renamed"), entry1);
+    first->moveEntryDown(entry1);
+    QCOMPARE(db->rootGroup()->findEntryByPath("/group/renamed"), entry3);
+
+    delete entry3;
+    QCOMPARE(db->rootGroup()->findEntryByPath("/group/renamed"), entry1);
+}
+
 void TestGroup::testPrint()
 {
     QScopedPointer<Database> db(new Database());
@@ -1051,6 +1249,121 @@ void TestGroup::testChildrenSort()
     delete parent;
 }
 
+void TestGroup::testInheritedProperties()
+{
+    QScopedPointer<Database> db(new Database());
+    db->metadata()->setRecycleBinEnabled(true);
+
+    auto* group1 = new Group();
+    group1->setName("group1");
+    group1->setParent(db->rootGroup());
+    auto* group2 = new Group();
+    group2->setName("group2");
+    group2->setParent(group1);
+
+    QVERIFY(group2->resolveSearchingEnabled());
+    QVERIFY(group2->resolveAutoTypeEnabled());
+    QCOMPARE(group2->effectiveAutoTypeSequence(), Group::RootAutoTypeSequence);
+    QCOMPARE(group2->hierarchy(), QStringList({db->rootGroup()->name(), "group1", "group2"}));
+    QVERIFY(!group2->isRecycled());
+
+    // changes of parents are reflected by their children
+    group1->setSearchingEnabled(Group::Disable);
+    group1->setDefaultAutoTypeSequence("{PASSWORD}");
+    group1->setName("renamed");
+    QVERIFY(!group2->resolveSearchingEnabled());
+    QCOMPARE(group2->effectiveAutoTypeSequence(), QString("{PASSWORD}"));
+    QCOMPARE(group2->hierarchy(2), QStringList({"renamed", "group2"}));
+
+    group1->setAutoTypeEnabled(Group::Disable);
+    QVERIFY(!group2->resolveAutoTypeEnabled());
+    QCOMPARE(group2->effectiveAutoTypeSequence(), QString());
+
+    group2->setSearchingEnabled(Group::Enable);
+    group2->setAutoTypeEnabled(Group::Enable);
+    QVERIFY(group2->resolveSearchingEnabled());
+    QVERIFY(group2->resolveAutoTypeEnabled());
+
+    // and so are moves
+    group2->setParent(db->rootGroup());
+    QCOMPARE(group2->hierarchy(), QStringList({db->rootGroup()->name(), "group2"}));
+    QCOMPARE(group2->effectiveAutoTypeSequence(), Group::RootAutoTypeSequence);
+
+    db->recycleGroup(group1);
+    QVERIFY(group1->isRecycled());
+    QVERIFY(!group2->isRecycled());
+    group2->setParent(group1);
+    QVERIFY(group2->isRecycled());
+}
+
+void TestGroup::testForEachRecursive()
+{
+    QScopedPointer<Database> db(new Database());
+    db->metadata()->setRecycleBinEnabled(true);
+
+    auto* group1 = new Group();
+    group1->setParent(db->rootGroup());
+    auto* group11 = new Group();
+    group11->setParent(group1);
+    auto* group2 = new Group();
+    group2->setParent(db->rootGroup());
+
+    QList<Entry*> entries;
+    for (auto* group : {db->rootGroup(), group1, group11, group2}) {
+        for (int i = 0; i < 2; ++i) {
+            auto* entry = new Entry();
+            entry->setGroup(group);
+            entries.append(entry);
+        }
+    }
+
+    auto* recycled = new Entry();
+    recycled->setGroup(group2);
+    db->recycleEntry(recycled);
+
+    QList<Group*> visitedGroups;
+    db->rootGroup()->forEachGroupRecursive([&](Group* group) -> bool {
+        visitedGroups.append(group);
+        return true;
+    });
+    QCOMPARE(visitedGroups, db->rootGroup()->groupsRecursive(true));
+
+    QList<Entry*> visitedEntries;
+    db->rootGroup()->forEachEntryRecursive([&](Entry* entry) -> bool {
+        visitedEntries.append(entry);
+        return true;
+    });
+    QCOMPARE(visitedEntries, db->rootGroup()->entriesRecursive());
+    QVERIFY(visitedEntries.contains(recycled));
+
+    // skipping the recycle bin
+    visitedEntries.clear();
+    db->rootGroup()->forEachEntryRecursive(
+        [&](Entry* entry) -> bool {
+            visitedEntries.append(entry);
+            return true;
+        },
+        true);
+    QCOMPARE(visitedEntries, entries);
+
+    // stopping early
+    visitedEntries.clear();
+    QVERIFY(!db->rootGroup()->forEachEntryRecursive([&](Entry* entry) -> bool {
+        visitedEntries.append(entry);
+        return visitedEntries.size() < 3;
+    }));
+    QCOMPARE(visitedEntries, entries.mid(0, 3));
+
+    visitedGroups.clear();
+    QVERIFY(group1->forEachGroupRecursive(
+        [&](Group* group) -> bool {
+            visitedGroups.append(group);
+            return true;
+        },
+        false));
+    QCOMPARE(visitedGroups, QList<Group*>({group11}));
+}
+
 void TestGroup::testHierarchy()
 {
     Group group1;
@@ -1319,3 +1632,50 @@ void TestGroup::testMove()
     QCOMPARE(root->entries().at(2), entry1);
     QCOMPARE(root->entries().at(3), entry0);
 }
+
+void TestGroup::testDatabaseNotifications()
+{
+    Database db1;
+    Database db2;
+
+    auto* group = new Group();
+    group->setParent(db1.rootGroup());
+    auto* entry = new Entry();
+    entry->setGroup(group);
+    db1.markAsClean();
+
+    QSignalSpy spyGroupModified1(&db1, SIGNAL(groupModified(Group*)));
+    QSignalSpy spyDataChanged1(&db1, SIGNAL(groupDataChanged(Group*)));
+    group->setName("group");
+    QCOMPARE(spyGroupModified1.count(), 1);
+    QCOMPARE(spyDataChanged1.count(), 1);
+    QVERIFY(db1.isModified());
+
+    db1.markAsClean();
+    entry->setTitle("entry");
+    QVERIFY(db1.isModified());
+
+    // after moving the group, only the new database is notified
+    QSignalSpy spyAboutToRemove1(&db1, SIGNAL(groupAboutToRemove(Group*)));
+    QSignalSpy spyAdded2(&db2, SIGNAL(groupAdded()));
+    group->setParent(db2.rootGroup());
+    QCOMPARE(spyAboutToRemove1.count(), 1);
+    QCOMPARE(spyAdded2.count(), 1);
+
+    db1.markAsClean();
+    db2.markAsClean();
+    spyDataChanged1.clear();
+    entry->setTitle("moved");
+    group->setName("moved");
+    QVERIFY(!db1.isModified());
+    QVERIFY(db2.isModified());
+    QCOMPARE(spyDataChanged1.count(), 0);
+
+    QSignalSpy spyEntryAdded2(&db2, SIGNAL(entryAdded(Entry*)));
+    QSignalSpy spyEntryAboutToRemove2(&db2, SIGNAL(entryAboutToRemove(Entry*)));
+    auto* entry2 = new Entry();
+    entry2->setGroup(db2.rootGroup());
+    QCOMPARE(spyEntryAdded2.count(), 1);
+    delete entry2;
+    QCOMPARE(spyEntryAboutToRemove2.count(), 1);
+}
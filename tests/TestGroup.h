@@ -37,8 +37,12 @@ private slots:
     void testCopyCustomIcon();
     void testClone();
     void testCopyCustomIcons();
+    void testCustomIconData();
     void testFindEntry();
+    void testFindByUuidIndex();
+    void testReferencesRecursive();
     void testFindGroupByPath();
+    void testFindByPathIndex();
     void testPrint();
     void testLocate();
     void testAddEntryWithPath();
@@ -47,9 +51,12 @@ private slots:
     void testEquals();
     void testChildrenSort();
     void testHierarchy();
+    void testInheritedProperties();
+    void testForEachRecursive();
     void testApplyGroupIconRecursively();
     void testUsernamesRecursive();
     void testMove();
+    void testDatabaseNotifications();
 };
 
 #endif // KEEPASSX_TESTGROUP_H
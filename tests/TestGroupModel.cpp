@@ -148,3 +148,52 @@ void TestGroupModel::test()
     delete modelTest;
     delete model;
 }
+
+void TestGroupModel::testFetchMore()
+{
+    QScopedPointer<Database> db(new Database());
+    Group* groupRoot = db->rootGroup();
+
+    QList<Group*> groups;
+    for (int i = 0; i < 1200; ++i) {
+        auto* group = new Group();
+        group->setName(QString("group%1").arg(i));
+        group->setParent(groupRoot);
+        groups.append(group);
+    }
+
+    GroupModel model(db.data());
+    QModelIndex indexRoot = model.index(0, 0);
+
+    // children are fetched in batches
+    QCOMPARE(model.rowCount(indexRoot), 500);
+    QVERIFY(model.canFetchMore(indexRoot));
+    QVERIFY(!model.index(groups.at(600)).isValid());
+
+    model.fetchMore(indexRoot);
+    QCOMPARE(model.rowCount(indexRoot), 1000);
+    QCOMPARE(model.data(model.index(groups.at(600))).toString(), QString("group600"));
+
+    // changes past the fetched rows are not reported
+    QSignalSpy spyAboutToAdd(&model, SIGNAL(rowsAboutToBeInserted(QModelIndex, int, int)));
+    QSignalSpy spyAboutToRemove(&model, SIGNAL(rowsAboutToBeRemoved(QModelIndex, int, int)));
+    delete groups.takeAt(1100);
+    QCOMPARE(spyAboutToRemove.count(), 0);
+    QCOMPARE(model.rowCount(indexRoot), 1000);
+
+    // a group moved into the fetched rows shows up as an insertion
+    groups.at(1150)->setParent(groupRoot, 0);
+    QCOMPARE(spyAboutToAdd.count(), 1);
+    QCOMPARE(model.rowCount(indexRoot), 1001);
+    QCOMPARE(model.index(groups.at(1150)).row(), 0);
+
+    // fetching a group makes it and its predecessors available
+    model.fetchGroup(groups.last());
+    QCOMPARE(model.rowCount(indexRoot), 1199);
+    QVERIFY(!model.canFetchMore(indexRoot));
+    QCOMPARE(model.data(model.index(groups.last())).toString(), QString("group1199"));
+
+    ModelTest modelTest(&model);
+    delete groups.takeFirst();
+    QCOMPARE(model.rowCount(indexRoot), 1198);
+}
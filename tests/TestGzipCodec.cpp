@@ -0,0 +1,132 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestGzipCodec.h"
+#include "TestGlobal.h"
+
+#include <QBuffer>
+
+#include "config-keepassx.h"
+#include "streams/GzipCodec.h"
+#include "streams/QtIOCompressor"
+
+QTEST_GUILESS_MAIN(TestGzipCodec)
+
+namespace
+{
+    QByteArray sampleText()
+    {
+        QByteArray text;
+        for (int i = 0; text.size() < 300 * 1024; ++i) {
+            text.append(QString("<Entry><String>line %1</String></Entry>\n").arg(i % 997).toLatin1());
+        }
+        return text;
+    }
+
+    QByteArray streamCompress(const QByteArray& data)
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        QtIOCompressor compressor(&buffer);
+        compressor.setStreamFormat(QtIOCompressor::GzipFormat);
+        compressor.open(QIODevice::WriteOnly);
+        compressor.write(data);
+        compressor.close();
+        return buffer.data();
+    }
+
+    QByteArray streamDecompress(QByteArray data)
+    {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        QtIOCompressor compressor(&buffer);
+        compressor.setStreamFormat(QtIOCompressor::GzipFormat);
+        compressor.open(QIODevice::ReadOnly);
+        return compressor.readAll();
+    }
+} // namespace
+
+void TestGzipCodec::testRoundTrip_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("level");
+
+    QByteArray binary(200 * 1024, Qt::Uninitialized);
+    for (int i = 0; i < binary.size(); ++i) {
+        binary[i] = static_cast<char>((i * 2654435761u) >> 13);
+    }
+
+    QTest::newRow("empty") << QByteArray() << 6;
+    QTest::newRow("small") << QByteArray("KeePassXC") << 6;
+    QTest::newRow("text") << sampleText() << 6;
+    QTest::newRow("text fast") << sampleText() << 1;
+    QTest::newRow("text best") << sampleText() << 9;
+    QTest::newRow("text stored") << sampleText() << 0;
+    QTest::newRow("binary") << binary << 6;
+    QTest::newRow("zeros") << QByteArray(1024 * 1024, '\0') << 6;
+}
+
+void TestGzipCodec::testRoundTrip()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, level);
+
+    QByteArray compressed = GzipCodec::compress(data, level);
+    QVERIFY(!compressed.isNull());
+    QCOMPARE(compressed.left(2), QByteArray("\x1f\x8b"));
+
+    QByteArray decompressed;
+    QVERIFY(GzipCodec::decompress(compressed, decompressed));
+    QCOMPARE(decompressed, data);
+
+    // the data must stay readable by the streaming reader
+    QCOMPARE(streamDecompress(compressed), data);
+}
+
+void TestGzipCodec::testStreamCompatibility()
+{
+    QByteArray text = sampleText();
+    QByteArray streamCompressed = streamCompress(text);
+
+    QByteArray decompressed;
+    QVERIFY(GzipCodec::decompress(streamCompressed, decompressed));
+    QCOMPARE(decompressed, text);
+
+#ifndef WITH_XC_LIBDEFLATE
+    // zlib produces exactly the same file as the streaming writer
+    QCOMPARE(GzipCodec::compress(text), streamCompressed);
+#endif
+}
+
+void TestGzipCodec::testCorruptInput()
+{
+    QByteArray text = sampleText();
+    QByteArray compressed = GzipCodec::compress(text);
+
+    QByteArray decompressed;
+    QVERIFY(!GzipCodec::decompress(QByteArray("not compressed at all"), decompressed));
+
+    QByteArray corrupt = compressed;
+    corrupt[0] = 'x';
+    QVERIFY(!GzipCodec::decompress(corrupt, decompressed));
+
+    // truncated data is accepted up to the cut, like the streaming reader does
+    QByteArray truncated = compressed.left(compressed.size() / 2);
+    QVERIFY(GzipCodec::decompress(truncated, decompressed));
+    QVERIFY(!decompressed.isEmpty());
+    QVERIFY(text.startsWith(decompressed));
+}
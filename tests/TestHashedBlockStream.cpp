@@ -23,6 +23,7 @@
 #include "FailDevice.h"
 #include "crypto/Crypto.h"
 #include "streams/HashedBlockStream.h"
+#include "streams/HmacBlockStream.h"
 
 QTEST_GUILESS_MAIN(TestHashedBlockStream)
 
@@ -102,3 +103,94 @@ void TestHashedBlockStream::testWriteFailure()
     QVERIFY(!writer.reset());
     QCOMPARE(writer.errorString(), QString("FAILDEVICE"));
 }
+
+void TestHashedBlockStream::testHmacConcurrentBlocks()
+{
+    QByteArray key(64, 'K');
+    QByteArray input;
+    for (int i = 0; i < 1000; ++i) {
+        input.append(static_cast<char>(i % 251));
+    }
+
+    QBuffer sequentialBuffer;
+    QVERIFY(sequentialBuffer.open(QIODevice::WriteOnly));
+    HmacBlockStream sequentialWriter(&sequentialBuffer, key, 64);
+    QVERIFY(sequentialWriter.open(QIODevice::WriteOnly));
+    QCOMPARE(sequentialWriter.write(input), qint64(input.size()));
+    sequentialWriter.close();
+
+    // background hashing must produce the identical stream
+    QBuffer concurrentBuffer;
+    QVERIFY(concurrentBuffer.open(QIODevice::WriteOnly));
+    HmacBlockStream concurrentWriter(&concurrentBuffer, key, 64);
+    concurrentWriter.setConcurrentBlocks(3);
+    QVERIFY(concurrentWriter.open(QIODevice::WriteOnly));
+    QCOMPARE(concurrentWriter.write(input), qint64(input.size()));
+    concurrentWriter.close();
+    QCOMPARE(concurrentBuffer.buffer(), sequentialBuffer.buffer());
+
+    QBuffer readBuffer(&concurrentBuffer.buffer());
+    QVERIFY(readBuffer.open(QIODevice::ReadOnly));
+    HmacBlockStream reader(&readBuffer, key);
+    reader.setConcurrentBlocks(3);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    QCOMPARE(reader.readAll(), input);
+    QVERIFY(reader.atEnd());
+    reader.close();
+
+    // a corrupted block is detected even though it was verified ahead of time
+    QByteArray corrupted = concurrentBuffer.buffer();
+    corrupted[corrupted.size() / 2] = static_cast<char>(corrupted.at(corrupted.size() / 2) ^ 0x01);
+    QBuffer corruptedBuffer(&corrupted);
+    QVERIFY(corruptedBuffer.open(QIODevice::ReadOnly));
+    HmacBlockStream corruptedReader(&corruptedBuffer, key);
+    corruptedReader.setConcurrentBlocks(3);
+    QVERIFY(corruptedReader.open(QIODevice::ReadOnly));
+    corruptedReader.readAll();
+    QVERIFY(!corruptedReader.errorString().isEmpty());
+}
+
+void TestHashedBlockStream::testHashedConcurrentBlocks()
+{
+    QByteArray input;
+    for (int i = 0; i < 1000; ++i) {
+        input.append(static_cast<char>(i % 251));
+    }
+
+    QBuffer sequentialBuffer;
+    QVERIFY(sequentialBuffer.open(QIODevice::WriteOnly));
+    HashedBlockStream sequentialWriter(&sequentialBuffer, 64);
+    QVERIFY(sequentialWriter.open(QIODevice::WriteOnly));
+    QCOMPARE(sequentialWriter.write(input), qint64(input.size()));
+    sequentialWriter.close();
+
+    // background hashing must produce the identical stream
+    QBuffer concurrentBuffer;
+    QVERIFY(concurrentBuffer.open(QIODevice::WriteOnly));
+    HashedBlockStream concurrentWriter(&concurrentBuffer, 64);
+    concurrentWriter.setConcurrentBlocks(3);
+    QVERIFY(concurrentWriter.open(QIODevice::WriteOnly));
+    QCOMPARE(concurrentWriter.write(input), qint64(input.size()));
+    concurrentWriter.close();
+    QCOMPARE(concurrentBuffer.buffer(), sequentialBuffer.buffer());
+
+    QBuffer readBuffer(&concurrentBuffer.buffer());
+    QVERIFY(readBuffer.open(QIODevice::ReadOnly));
+    HashedBlockStream reader(&readBuffer);
+    reader.setConcurrentBlocks(3);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    QCOMPARE(reader.readAll(), input);
+    QVERIFY(reader.atEnd());
+    reader.close();
+
+    // a corrupted block is detected even though it was verified ahead of time
+    QByteArray corrupted = concurrentBuffer.buffer();
+    corrupted[corrupted.size() / 2] = static_cast<char>(corrupted.at(corrupted.size() / 2) ^ 0x01);
+    QBuffer corruptedBuffer(&corrupted);
+    QVERIFY(corruptedBuffer.open(QIODevice::ReadOnly));
+    HashedBlockStream corruptedReader(&corruptedBuffer);
+    corruptedReader.setConcurrentBlocks(3);
+    QVERIFY(corruptedReader.open(QIODevice::ReadOnly));
+    corruptedReader.readAll();
+    QVERIFY(!corruptedReader.errorString().isEmpty());
+}
@@ -29,6 +29,8 @@ private slots:
     void testWriteRead();
     void testReset();
     void testWriteFailure();
+    void testHmacConcurrentBlocks();
+    void testHashedConcurrentBlocks();
 };
 
 #endif // KEEPASSX_TESTHASHEDBLOCKSTREAM_H
@@ -29,6 +29,7 @@
 #include <QByteArray>
 #include <QFile>
 #include <QList>
+#include <QTemporaryFile>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestHibp)
@@ -123,3 +124,89 @@ void TestHibp::testPwned()
     QCOMPARE(findings[1].first, entry4);
     QCOMPARE(findings[1].second, 456);
 }
+
+void TestHibp::testLargeFile()
+{
+    // Spans several read blocks, the matching line comes last
+    QByteArray hibpContents;
+    for (int i = 0; i < 40000; ++i) {
+        hibpContents.append(QString("%1:%2\r\n").arg(i, 40, 16, QChar('0')).arg(i).toLatin1());
+    }
+    hibpContents.append("0BEEC7B5EA3F0FDBC95D0DD47F3C5BC275DA8A33:123");
+    QBuffer hibpBuffer(&hibpContents);
+    QVERIFY(hibpBuffer.open(QIODevice::ReadOnly));
+
+    Entry* entry = new Entry();
+    entry->setPassword("foo");
+    entry->setGroup(m_db->rootGroup());
+
+    QList<QPair<const Entry*, int>> findings;
+    QString error;
+    QVERIFY(HibpOffline::report(m_db, hibpBuffer, findings, &error));
+    QCOMPARE(error, QString());
+    QCOMPARE(findings.size(), 1);
+    QCOMPARE(findings[0].first, entry);
+    QCOMPARE(findings[0].second, 123);
+}
+
+void TestHibp::testIndex_data()
+{
+    QTest::addColumn<QByteArray>("hibpContents");
+    QTest::addColumn<int>("hashBytes");
+
+    QTest::newRow("Sorted") << QByteArray(TEST_HIBP_CONTENTS) << 20;
+    QTest::newRow("Unsorted") << QByteArray("62cdb7020ff920e5aa642c3d4066950dd1f01f4d:456\r\n"
+                                            "\r\n"
+                                            "0BEEC7B5EA3F0FDBC95D0DD47F3C5BC275DA8A33:123\r\n")
+                              << 20;
+    QTest::newRow("Truncated") << QByteArray(TEST_HIBP_CONTENTS) << 4;
+}
+
+void TestHibp::testIndex()
+{
+    QFETCH(QByteArray, hibpContents);
+    QFETCH(int, hashBytes);
+
+    QBuffer hibpBuffer(&hibpContents);
+    QVERIFY(hibpBuffer.open(QIODevice::ReadOnly));
+
+    QTemporaryFile indexFile;
+    QVERIFY(indexFile.open());
+    QString error;
+    QVERIFY(HibpOffline::convert(hibpBuffer, indexFile, hashBytes, &error));
+    QCOMPARE(error, QString());
+    indexFile.close();
+    QVERIFY(HibpOffline::isIndex(indexFile.fileName()));
+
+    Group* root = m_db->rootGroup();
+
+    Entry* entry1 = new Entry();
+    entry1->setPassword("bar");
+    entry1->setGroup(root);
+
+    Entry* entry2 = new Entry();
+    entry2->setPassword("xyz");
+    entry2->setGroup(root);
+
+    Entry* entry3 = new Entry();
+    entry3->setPassword("foo");
+    entry3->setGroup(root);
+
+    QList<QPair<const Entry*, int>> findings;
+    QVERIFY(HibpOffline::indexReport(m_db, indexFile.fileName(), findings, &error));
+    QCOMPARE(error, QString());
+    QCOMPARE(findings.size(), 2);
+    QCOMPARE(findings[0].first, entry1);
+    QCOMPARE(findings[0].second, 456);
+    QCOMPARE(findings[1].first, entry3);
+    QCOMPARE(findings[1].second, 123);
+
+    // Text files are not mistaken for an index
+    QTemporaryFile textFile;
+    QVERIFY(textFile.open());
+    textFile.write(TEST_HIBP_CONTENTS);
+    textFile.close();
+    QVERIFY(!HibpOffline::isIndex(textFile.fileName()));
+    QVERIFY(!HibpOffline::indexReport(m_db, textFile.fileName(), findings, &error));
+    QVERIFY(!error.isEmpty());
+}
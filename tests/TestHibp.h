@@ -34,6 +34,9 @@ private slots:
     void testEmpty();
     void testIoError();
     void testPwned();
+    void testLargeFile();
+    void testIndex_data();
+    void testIndex();
 
 private:
     QSharedPointer<Database> m_db;
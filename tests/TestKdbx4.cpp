@@ -19,16 +19,24 @@
 #include "TestGlobal.h"
 
 #include "config-keepassx-tests.h"
+#include "core/Group.h"
 #include "core/Metadata.h"
+#include "format/KdbxXmlFragmentCache.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KdbxXmlWriter.h"
 #include "format/KeePass2.h"
+#include "format/KeePass2RandomStream.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
 #include "mock/MockChallengeResponseKey.h"
 
+#include <QSignalSpy>
+#include <QTemporaryFile>
+#include <QtConcurrent>
+#include <algorithm>
+
 int main(int argc, char* argv[])
 {
     QCoreApplication app(argc, argv);
@@ -438,6 +446,494 @@ void TestKdbx4Argon2::testCustomData()
     QCOMPARE(newEntry->customData()->value(customDataKey2), customData2);
 }
 
+Q_DECLARE_METATYPE(Database::CompressionAlgorithm)
+void TestKdbx4Argon2::testPipelinedRead()
+{
+    QFETCH(Database::CompressionAlgorithm, compression);
+    QFETCH(bool, corrupt);
+
+    Database sourceDb;
+    sourceDb.changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2)));
+    sourceDb.setCompressionAlgorithm(compression);
+    sourceDb.metadata()->setName("Pipelined");
+
+    // make sure the payload spans several HMAC blocks
+    auto* entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setGroup(sourceDb.rootGroup());
+    entry->setTitle("Large");
+    QByteArray attachment;
+    for (int i = 0; i < 200000; ++i) {
+        attachment.append(QByteArray::number(i * 7919));
+    }
+    entry->attachments()->set("large.bin", attachment);
+
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    KeePass2Writer writer;
+    writer.writeDatabase(&buffer, &sourceDb);
+    QVERIFY(!writer.hasError());
+
+    if (corrupt) {
+        // flip a byte in the middle of the payload
+        QByteArray& data = buffer.buffer();
+        data[data.size() / 2] = static_cast<char>(data.at(data.size() / 2) ^ 0xff);
+    }
+
+    buffer.seek(0);
+    KeePass2Reader reader;
+    reader.setPipelinedRead(true);
+    auto targetDb = QSharedPointer<Database>::create();
+    reader.readDatabase(&buffer, QSharedPointer<CompositeKey>::create(), targetDb.data());
+
+    if (corrupt) {
+        QVERIFY(reader.hasError());
+        return;
+    }
+
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    QCOMPARE(targetDb->metadata()->name(), QString("Pipelined"));
+    QCOMPARE(targetDb->rootGroup()->entries().size(), 1);
+    QCOMPARE(targetDb->rootGroup()->entries().at(0)->attachments()->value("large.bin"), attachment);
+}
+
+void TestKdbx4Argon2::testPipelinedRead_data()
+{
+    QTest::addColumn<Database::CompressionAlgorithm>("compression");
+    QTest::addColumn<bool>("corrupt");
+
+    QTest::newRow("GZip") << Database::CompressionGZip << false;
+    QTest::newRow("No compression") << Database::CompressionNone << false;
+    QTest::newRow("GZip, corrupted") << Database::CompressionGZip << true;
+    QTest::newRow("No compression, corrupted") << Database::CompressionNone << true;
+}
+
+void TestKdbx4Argon2::testDeferredAttachments()
+{
+    QFETCH(Database::CompressionAlgorithm, compression);
+
+    Database sourceDb;
+    sourceDb.changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2)));
+    sourceDb.setCompressionAlgorithm(compression);
+
+    auto* entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setGroup(sourceDb.rootGroup());
+    QByteArray largeAttachment;
+    for (int i = 0; i < 200000; ++i) {
+        largeAttachment.append(QByteArray::number(i * 7919));
+    }
+    entry->attachments()->set("large.bin", largeAttachment);
+    entry->attachments()->set("small.txt", "small");
+    entry->attachments()->set("empty", "");
+    entry->addHistoryItem(entry->clone(Entry::CloneNoFlags));
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    KeePass2Writer writer;
+    writer.writeDatabase(&file, &sourceDb);
+    QVERIFY(!writer.hasError());
+    file.close();
+
+    QFile readFile(file.fileName());
+    QVERIFY(readFile.open(QIODevice::ReadOnly));
+    KeePass2Reader reader;
+    reader.setDeferredAttachments(true);
+    auto targetDb = QSharedPointer<Database>::create();
+    reader.readDatabase(&readFile, QSharedPointer<CompositeKey>::create(), targetDb.data());
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    readFile.close();
+
+    QCOMPARE(targetDb->rootGroup()->entries().size(), 1);
+    auto* attachments = targetDb->rootGroup()->entries().at(0)->attachments();
+    QVERIFY(attachments->isDeferred("large.bin"));
+    QCOMPARE(attachments->keys(), QList<QString>({"empty", "large.bin", "small.txt"}));
+    QCOMPARE(attachments->attachmentsSize(), entry->attachments()->attachmentsSize());
+    QCOMPARE(attachments->value("small.txt"), QByteArray("small"));
+    QCOMPARE(attachments->value("large.bin"), largeAttachment);
+    QCOMPARE(attachments->value("empty"), QByteArray());
+    QVERIFY(*attachments == *entry->attachments());
+
+    attachments->rename("small.txt", "renamed.txt");
+    QVERIFY(attachments->isDeferred("renamed.txt"));
+    QCOMPARE(attachments->value("renamed.txt"), QByteArray("small"));
+
+    // deferred attachments are pooled by their position in the file and read while saving
+    const QList<AttachmentValue> pool = targetDb->attachmentPool();
+    QCOMPARE(pool.size(), 3);
+    for (const AttachmentValue& value : pool) {
+        QVERIFY(value.isDeferred());
+    }
+    QBuffer savedBuffer;
+    QVERIFY(savedBuffer.open(QIODevice::ReadWrite));
+    writer.writeDatabase(&savedBuffer, targetDb.data());
+    QVERIFY2(!writer.hasError(), qPrintable(writer.errorString()));
+    savedBuffer.seek(0);
+    auto savedDb = QSharedPointer<Database>::create();
+    reader.readDatabase(&savedBuffer, QSharedPointer<CompositeKey>::create(), savedDb.data());
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    const EntryAttachments* savedAttachments = savedDb->rootGroup()->entries().at(0)->attachments();
+    QCOMPARE(savedAttachments->value("large.bin"), largeAttachment);
+    QCOMPARE(savedAttachments->value("renamed.txt"), QByteArray("small"));
+    QCOMPARE(savedAttachments->value("empty"), QByteArray());
+
+    targetDb->loadDeferredAttachments();
+    QVERIFY(!attachments->hasDeferred());
+    QCOMPARE(attachments->value("large.bin"), largeAttachment);
+    // the history item shares the binaries of the entry
+    const QList<AttachmentValue> historyValues = targetDb->rootGroup()->entries().at(0)->historyAttachmentValues();
+    QCOMPARE(historyValues.size(), 3);
+    for (const AttachmentValue& value : historyValues) {
+        QVERIFY(!value.isDeferred());
+        if (value.data.size() == largeAttachment.size()) {
+            QVERIFY(value.data.constData() == attachments->value("large.bin").constData());
+        }
+    }
+
+    // databases read from memory keep their attachments in memory
+    QBuffer buffer;
+    QVERIFY(file.open());
+    buffer.setData(file.readAll());
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    auto bufferDb = QSharedPointer<Database>::create();
+    reader.readDatabase(&buffer, QSharedPointer<CompositeKey>::create(), bufferDb.data());
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    QVERIFY(!bufferDb->rootGroup()->entries().at(0)->attachments()->hasDeferred());
+}
+
+void TestKdbx4Argon2::testDeferredAttachments_data()
+{
+    QTest::addColumn<Database::CompressionAlgorithm>("compression");
+
+    QTest::newRow("GZip") << Database::CompressionGZip;
+    QTest::newRow("No compression") << Database::CompressionNone;
+}
+
+void TestKdbx4Argon2::testDeferredProtectedValues()
+{
+    Database sourceDb;
+    sourceDb.changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2)));
+
+    for (int i = 0; i < 3; ++i) {
+        auto* entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setGroup(sourceDb.rootGroup());
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setPassword(QString("password %1").arg(i));
+        entry->attributes()->set("Secret", QString("secret %1").arg(i), true);
+        entry->attributes()->set("Empty", "", true);
+    }
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+    KeePass2Writer writer;
+    writer.writeDatabase(&buffer, &sourceDb);
+    QVERIFY(!writer.hasError());
+
+    buffer.seek(0);
+    KeePass2Reader reader;
+    reader.setDeferredProtectedValues(true);
+    auto targetDb = QSharedPointer<Database>::create();
+    reader.readDatabase(&buffer, QSharedPointer<CompositeKey>::create(), targetDb.data());
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+
+    const auto entries = targetDb->rootGroup()->entries();
+    QCOMPARE(entries.size(), 3);
+
+    // access the values out of order to force the keystream to be regenerated
+    auto* attributes = entries.at(2)->attributes();
+    QVERIFY(attributes->isDeferred(EntryAttributes::PasswordKey));
+    QVERIFY(attributes->isDeferred("Secret"));
+    QVERIFY(!attributes->isDeferred("Empty"));
+    QVERIFY(!attributes->isDeferred(EntryAttributes::TitleKey));
+    QCOMPARE(attributes->value("Secret"), QString("secret 2"));
+    QVERIFY(!attributes->isDeferred("Secret"));
+    QVERIFY(attributes->isDeferred(EntryAttributes::PasswordKey));
+    QCOMPARE(entries.at(2)->password(), QString("password 2"));
+
+    // clones share the deferred values
+    QScopedPointer<Entry> clone(entries.at(0)->clone(Entry::CloneNoFlags));
+    QVERIFY(clone->attributes()->isDeferred(EntryAttributes::PasswordKey));
+    QVERIFY(*clone->attributes() == *entries.at(0)->attributes());
+    QCOMPARE(clone->password(), QString("password 0"));
+
+    for (int i = 0; i < entries.size(); ++i) {
+        QCOMPARE(entries.at(i)->password(), QString("password %1").arg(i));
+        QCOMPARE(entries.at(i)->attributes()->value("Secret"), QString("secret %1").arg(i));
+        QCOMPARE(entries.at(i)->attributes()->value("Empty"), QString());
+        QVERIFY(entries.at(i)->attributes()->isProtected("Secret"));
+    }
+
+    // several threads may decrypt the same values at once
+    buffer.seek(0);
+    auto concurrentDb = QSharedPointer<Database>::create();
+    reader.readDatabase(&buffer, QSharedPointer<CompositeKey>::create(), concurrentDb.data());
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    const auto concurrentEntries = concurrentDb->rootGroup()->entries();
+    QList<int> indexes;
+    for (int i = 0; i < 64; ++i) {
+        indexes.append(i % concurrentEntries.size());
+    }
+    std::function<QString(int)> readValues = [&concurrentEntries](int index) {
+        const EntryAttributes* attributes = concurrentEntries.at(index)->attributes();
+        return attributes->value(EntryAttributes::PasswordKey) + "/" + attributes->value("Secret");
+    };
+    const auto values = QtConcurrent::blockingMapped<QStringList>(indexes, readValues);
+    for (int i = 0; i < indexes.size(); ++i) {
+        QCOMPARE(values.at(i), QString("password %1/secret %1").arg(indexes.at(i)));
+    }
+}
+
+void TestKdbx4Argon2::testMetadataOnly()
+{
+    QFETCH(bool, deferredProtectedValues);
+
+    Database sourceDb;
+    sourceDb.changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2)));
+    const QUuid iconUuid = QUuid::createUuid();
+    sourceDb.metadata()->addCustomIcon(iconUuid, QByteArray("icon"));
+
+    for (int i = 0; i < 3; ++i) {
+        auto* entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setGroup(sourceDb.rootGroup());
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setIcon(iconUuid);
+        entry->attachments()->set("file.txt", QByteArray::number(i));
+
+        // the protected values of the skipped history come before those of the next entry
+        Entry* historyItem = entry->clone(Entry::CloneNoFlags);
+        historyItem->setPassword(QString("old password %1").arg(i));
+        historyItem->attributes()->set("Secret", QString("old secret %1").arg(i), true);
+        entry->addHistoryItem(historyItem);
+
+        entry->setPassword(QString("password %1").arg(i));
+        entry->attributes()->set("Secret", QString("secret %1").arg(i), true);
+    }
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    KeePass2Writer writer;
+    writer.writeDatabase(&file, &sourceDb);
+    QVERIFY(!writer.hasError());
+    file.close();
+
+    QFile readFile(file.fileName());
+    QVERIFY(readFile.open(QIODevice::ReadOnly));
+    QBuffer buffer;
+    buffer.setData(readFile.readAll());
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    KeePass2Reader reader;
+    reader.setMetadataOnly(true);
+    reader.setDeferredProtectedValues(deferredProtectedValues);
+    auto targetDb = QSharedPointer<Database>::create();
+    reader.readDatabase(&buffer, QSharedPointer<CompositeKey>::create(), targetDb.data());
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+
+    QVERIFY(!targetDb->metadata()->hasCustomIcon(iconUuid));
+    const auto entries = targetDb->rootGroup()->entries();
+    QCOMPARE(entries.size(), 3);
+    for (int i = 0; i < entries.size(); ++i) {
+        QCOMPARE(entries.at(i)->title(), QString("Entry %1").arg(i));
+        QCOMPARE(entries.at(i)->password(), QString("password %1").arg(i));
+        QCOMPARE(entries.at(i)->attributes()->value("Secret"), QString("secret %1").arg(i));
+        QCOMPARE(entries.at(i)->iconUuid(), iconUuid);
+        QVERIFY(entries.at(i)->historyItems().isEmpty());
+        QVERIFY(entries.at(i)->attachments()->isEmpty());
+    }
+
+    // attachments of databases opened from a file are read on demand
+    Database fileDb;
+    QString error;
+    QVERIFY2(fileDb.open(file.fileName(), QSharedPointer<CompositeKey>::create(), &error, false, true),
+             qPrintable(error));
+    QVERIFY(fileDb.isMetadataOnly());
+    QVERIFY(fileDb.isReadOnly());
+    const auto fileEntries = fileDb.rootGroup()->entries();
+    QCOMPARE(fileEntries.size(), 3);
+    QVERIFY(fileEntries.at(1)->historyItems().isEmpty());
+    QVERIFY(fileEntries.at(1)->attachments()->isDeferred("file.txt"));
+    QCOMPARE(fileEntries.at(1)->attachments()->value("file.txt"), QByteArray("1"));
+
+    // saving would lose the skipped content
+    QVERIFY(!fileDb.saveAs(file.fileName() + ".copy", &error));
+    QVERIFY(!QFile::exists(file.fileName() + ".copy"));
+}
+
+void TestKdbx4Argon2::testMetadataOnly_data()
+{
+    QTest::addColumn<bool>("deferredProtectedValues");
+
+    QTest::newRow("Decrypted protected values") << false;
+    QTest::newRow("Deferred protected values") << true;
+}
+
+void TestKdbx4Argon2::testProgressiveOpen()
+{
+    Database sourceDb;
+    sourceDb.changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2)));
+    const QUuid iconUuid = QUuid::createUuid();
+    sourceDb.metadata()->addCustomIcon(iconUuid, QByteArray("icon"));
+
+    for (int i = 0; i < 3; ++i) {
+        auto* entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setGroup(sourceDb.rootGroup());
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setIcon(iconUuid);
+        entry->attachments()->set("file.txt", QByteArray::number(i));
+
+        Entry* historyItem = entry->clone(Entry::CloneNoFlags);
+        historyItem->setPassword(QString("old password %1").arg(i));
+        entry->addHistoryItem(historyItem);
+        entry->setPassword(QString("password %1").arg(i));
+    }
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    KeePass2Writer writer;
+    writer.writeDatabase(&file, &sourceDb);
+    QVERIFY(!writer.hasError());
+    file.close();
+
+    Database db;
+    QSignalSpy spyLoaded(&db, SIGNAL(skippedDataLoaded()));
+    QString error;
+    QVERIFY2(db.openProgressively(file.fileName(), QSharedPointer<CompositeKey>::create(), &error),
+             qPrintable(error));
+
+    // the entries are there right away and can be edited, but not saved yet
+    QVERIFY(db.isMetadataOnly());
+    QVERIFY(db.isLoadingSkippedData());
+    QVERIFY(!db.isReadOnly());
+    QVERIFY(!db.isModified());
+    auto entries = db.rootGroup()->entries();
+    QCOMPARE(entries.size(), 3);
+    QVERIFY(entries.at(0)->historyItems().isEmpty());
+    entries.at(0)->beginUpdate();
+    entries.at(0)->setPassword("new password");
+    entries.at(0)->endUpdate();
+    QCOMPARE(entries.at(0)->historyItems().size(), 1);
+    QVERIFY(!db.saveAs(file.fileName() + ".copy", &error));
+
+    QTRY_COMPARE(spyLoaded.count(), 1);
+    QVERIFY(!db.isMetadataOnly());
+    QVERIFY(!db.isLoadingSkippedData());
+    QVERIFY(db.metadata()->hasCustomIcon(iconUuid));
+    for (int i = 0; i < entries.size(); ++i) {
+        QCOMPARE(entries.at(i)->attachments()->value("file.txt"), QByteArray::number(i));
+        QVERIFY(!entries.at(i)->historyItems().isEmpty());
+        QCOMPARE(entries.at(i)->historyItems().first()->password(), QString("old password %1").arg(i));
+    }
+
+    // the history read from the file comes before the one added in the meantime
+    const auto history = entries.at(0)->historyItems();
+    QCOMPARE(history.size(), 2);
+    QCOMPARE(history.last()->password(), QString("password 0"));
+    QCOMPARE(entries.at(0)->password(), QString("new password"));
+    QVERIFY(db.isModified());
+
+    QVERIFY2(db.saveAs(file.fileName() + ".copy", &error), qPrintable(error));
+    QFile::remove(file.fileName() + ".copy");
+}
+
+namespace
+{
+    QByteArray writeProtectedXml(Database* db, KdbxXmlFragmentCache* cache)
+    {
+        KeePass2RandomStream randomStream(KeePass2::ProtectedStreamAlgo::ChaCha20);
+        if (!randomStream.init(QByteArray(64, '\x42'))) {
+            return {};
+        }
+
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        KdbxXmlWriter writer(KeePass2::FILE_VERSION_4);
+        writer.setFragmentCache(cache);
+        writer.writeDatabase(&buffer, db, &randomStream);
+        return writer.hasError() ? QByteArray() : buffer.data();
+    }
+} // namespace
+
+void TestKdbx4Argon2::testXmlFragmentCache()
+{
+    bool hasError;
+    QString errorString;
+    auto db = readXml(QString(KEEPASSX_TEST_DATA_DIR).append("/NewDatabase.xml"), true, hasError, errorString);
+    QVERIFY2(!hasError, qPrintable(errorString));
+
+    Group* root = db->rootGroup();
+    Group* general = root->findChildByName("General");
+    Group* windows = root->findChildByName("Windows");
+    Group* recycleBin = root->findChildByName("Recycle Bin");
+    QVERIFY(general && windows && recycleBin);
+    Group* subsub = windows->findChildByName("Subsub");
+    Group* network = recycleBin->findChildByName("Network");
+    QVERIFY(subsub && network);
+
+    KdbxXmlFragmentCache cache;
+    QByteArray reference = writeProtectedXml(db.data(), nullptr);
+    QVERIFY(!reference.isEmpty());
+    QCOMPARE(writeProtectedXml(db.data(), &cache), reference);
+    QCOMPARE(cache.size(), root->groupsRecursive(false).size());
+
+    // all groups below the root group are spliced in from the cache
+    QCOMPARE(writeProtectedXml(db.data(), &cache), reference);
+    QCOMPARE(cache.size(), root->groupsRecursive(false).size());
+
+    // compact history items are only created while they are written
+    const QList<Entry*> entries = root->entriesRecursive();
+    auto historyOwner = std::find_if(
+        entries.constBegin(), entries.constEnd(), [](const Entry* e) { return e->historyItemCount() > 0; });
+    QVERIFY(historyOwner != entries.constEnd());
+    QVERIFY((*historyOwner)->hasCompactHistory());
+    QCOMPARE(writeProtectedXml(db.data(), &cache), reference);
+
+    Entry* entry = subsub->entries().at(0);
+    entry->setPassword("changed");
+    QVERIFY(!cache.contains(subsub));
+    QVERIFY(cache.contains(windows));
+    reference = writeProtectedXml(db.data(), nullptr);
+    QCOMPARE(writeProtectedXml(db.data(), &cache), reference);
+    QVERIFY(cache.contains(subsub));
+
+    entry->attachments()->set("test.txt", "attachment");
+    auto* newEntry = new Entry();
+    newEntry->setUuid(QUuid::createUuid());
+    newEntry->setPassword("new");
+    newEntry->attachments()->set("test.txt", "attachment");
+    newEntry->setGroup(general);
+    reference = writeProtectedXml(db.data(), nullptr);
+    QCOMPARE(writeProtectedXml(db.data(), &cache), reference);
+
+    // moved groups change their indentation and their parents' children
+    network->setParent(general);
+    reference = writeProtectedXml(db.data(), nullptr);
+    QCOMPARE(writeProtectedXml(db.data(), &cache), reference);
+
+    // changes that are not signalled are caught when the fragment is looked up
+    TimeInfo timeInfo = windows->timeInfo();
+    timeInfo.setUsageCount(timeInfo.usageCount() + 1);
+    windows->setTimeInfo(timeInfo);
+    QVERIFY(cache.contains(windows));
+    reference = writeProtectedXml(db.data(), nullptr);
+    QCOMPARE(writeProtectedXml(db.data(), &cache), reference);
+
+    delete newEntry;
+    reference = writeProtectedXml(db.data(), nullptr);
+    QCOMPARE(writeProtectedXml(db.data(), &cache), reference);
+
+    db->metadata()->setProtectUrl(!db->metadata()->protectUrl());
+    reference = writeProtectedXml(db.data(), nullptr);
+    QCOMPARE(writeProtectedXml(db.data(), &cache), reference);
+
+    delete subsub;
+    QVERIFY(!cache.contains(subsub));
+    reference = writeProtectedXml(db.data(), nullptr);
+    QCOMPARE(writeProtectedXml(db.data(), &cache), reference);
+}
+
 void TestKdbx4AesKdf::initTestCaseImpl()
 {
     m_xmlDb->changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_AES_KDBX4)));
@@ -31,6 +31,15 @@ private slots:
     void testUpgradeMasterKeyIntegrity();
     void testUpgradeMasterKeyIntegrity_data();
     void testCustomData();
+    void testPipelinedRead();
+    void testPipelinedRead_data();
+    void testDeferredAttachments();
+    void testDeferredAttachments_data();
+    void testDeferredProtectedValues();
+    void testMetadataOnly();
+    void testMetadataOnly_data();
+    void testProgressiveOpen();
+    void testXmlFragmentCache();
 
 protected:
     void initTestCaseImpl() override;
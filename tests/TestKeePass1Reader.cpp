@@ -19,10 +19,12 @@
 #include "TestGlobal.h"
 
 #include <QBuffer>
+#include <QSignalSpy>
 
 #include "config-keepassx-tests.h"
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
+#include "format/KeePass1Importer.h"
 #include "format/KeePass1Reader.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
@@ -243,6 +245,48 @@ void TestKeePass1Reader::testCP1252Password()
     QCOMPARE(db->rootGroup()->children().at(0)->name(), name);
 }
 
+void TestKeePass1Reader::testImporter()
+{
+    const QString basic = QString(KEEPASSX_TEST_DATA_DIR).append("/basic.kdb");
+    const QString missing = QString(KEEPASSX_TEST_DATA_DIR).append("/missing.kdb");
+    const QString twofish = QString(KEEPASSX_TEST_DATA_DIR).append("/Twofish.kdb");
+
+    Database target;
+    KeePass1Importer importer;
+    importer.setPassword("masterpw");
+    QSignalSpy spy(&importer, SIGNAL(fileImported(int, int, QString, QString)));
+
+    const auto results = importer.import({basic, missing, twofish}, &target);
+    QCOMPARE(results.size(), 3);
+    QCOMPARE(results.at(0).path, basic);
+    QVERIFY(results.at(0).error.isEmpty());
+    QCOMPARE(results.at(0).entries, m_db->rootGroup()->entriesRecursive().size());
+    QVERIFY(!results.at(1).error.isEmpty());
+    QCOMPARE(results.at(1).entries, 0);
+    QVERIFY(results.at(2).error.isEmpty());
+
+    // progress is reported for every file in order, including the failed ones
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(1).at(0).toInt(), 2);
+    QCOMPARE(spy.at(1).at(1).toInt(), 3);
+    QCOMPARE(spy.at(1).at(2).toString(), missing);
+    QVERIFY(!spy.at(1).at(3).toString().isEmpty());
+
+    // every imported file ends up in a group named after it
+    QCOMPARE(target.rootGroup()->children().size(), 2);
+    Group* basicGroup = target.rootGroup()->children().at(0);
+    QCOMPARE(basicGroup->name(), QString("basic"));
+    QCOMPARE(basicGroup->children().size(), m_db->rootGroup()->children().size());
+    QCOMPARE(basicGroup->entriesRecursive().size(), results.at(0).entries);
+    QCOMPARE(target.rootGroup()->children().at(1)->name(), QString("Twofish"));
+    QCOMPARE(target.rootGroup()->children().at(1)->children().at(0)->name(), QString("Twofish"));
+
+    // icons of nested groups and entries are carried along
+    for (const QUuid& uuid : basicGroup->customIconsRecursive()) {
+        QVERIFY(target.metadata()->hasCustomIcon(uuid));
+    }
+}
+
 void TestKeePass1Reader::cleanupTestCase()
 {
 }
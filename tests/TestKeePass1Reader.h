@@ -40,6 +40,7 @@ private slots:
     void testCompositeKey();
     void testTwofish();
     void testCP1252Password();
+    void testImporter();
     void cleanupTestCase();
 
 private:
@@ -29,6 +29,8 @@
 #include "FailDevice.h"
 #include "config-keepassx-tests.h"
 
+#include <QElapsedTimer>
+
 void TestKeePass2Format::initTestCase()
 {
     QVERIFY(Crypto::init());
@@ -496,6 +498,49 @@ void TestKeePass2Format::testXmlRepairUuidHistoryItem()
     QCOMPARE(historyItem->uuid(), entry->uuid());
 }
 
+void TestKeePass2Format::benchmarkXmlRead()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    // scale the entries of NewDatabase.xml up to 100k entries
+    const int entryCount = 100000;
+    const QList<Entry*> templates = m_xmlDb->rootGroup()->entriesRecursive();
+    QVERIFY(!templates.isEmpty());
+
+    Database db;
+    for (int i = 0; i < entryCount; ++i) {
+        Entry* entry = templates.at(i % templates.size())->clone(Entry::CloneNewUuid | Entry::CloneIncludeHistory);
+        entry->setGroup(db.rootGroup());
+    }
+
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    bool hasError;
+    QString errorString;
+    writeXml(&buffer, &db, hasError, errorString);
+    QVERIFY2(!hasError, qPrintable(errorString));
+
+    QElapsedTimer timer;
+    qint64 elapsed = 0;
+    int runs = 0;
+    QBENCHMARK
+    {
+        buffer.seek(0);
+        timer.start();
+        auto readDb = readXml(&buffer, false, hasError, errorString);
+        elapsed += timer.nsecsElapsed();
+        ++runs;
+        QVERIFY2(!hasError, qPrintable(errorString));
+        QCOMPARE(readDb->rootGroup()->entries().size(), entryCount);
+    }
+
+    qInfo("KdbxXmlReader: %.0f entries/s", entryCount * runs / (elapsed / 1e9));
+}
+
 void TestKeePass2Format::testReadBackTargetDb()
 {
     // read back previously constructed KDBX
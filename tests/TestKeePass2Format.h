@@ -52,6 +52,7 @@ private slots:
     void testXmlEmptyUuids();
     void testXmlInvalidXmlChars();
     void testXmlRepairUuidHistoryItem();
+    void benchmarkXmlRead();
 
     /**
      * KDBX binary format tests.
@@ -24,6 +24,7 @@
 #include "format/KeePass2RandomStream.h"
 
 QTEST_GUILESS_MAIN(TestKeePass2RandomStream)
+Q_DECLARE_METATYPE(KeePass2::ProtectedStreamAlgo);
 
 void TestKeePass2RandomStream::initTestCase()
 {
@@ -79,3 +80,57 @@ void TestKeePass2RandomStream::test()
     QCOMPARE(cipherData, cipherDataEncrypt);
     QCOMPARE(randomStreamData, cipherData);
 }
+
+void TestKeePass2RandomStream::testBatchBoundaries_data()
+{
+    QTest::addColumn<KeePass2::ProtectedStreamAlgo>("algo");
+
+    QTest::newRow("Salsa20") << KeePass2::ProtectedStreamAlgo::Salsa20;
+    QTest::newRow("ChaCha20") << KeePass2::ProtectedStreamAlgo::ChaCha20;
+}
+
+void TestKeePass2RandomStream::testBatchBoundaries()
+{
+    QFETCH(KeePass2::ProtectedStreamAlgo, algo);
+
+    const QByteArray key = QByteArray::fromHex("00112233445566778899aabbccddeeff");
+    const int Size = 20000;
+
+    QByteArray data;
+    for (int i = 0; i < Size; ++i) {
+        data.append(static_cast<char>(i * 7));
+    }
+
+    QScopedPointer<SymmetricCipher> cipher;
+    if (algo == KeePass2::ProtectedStreamAlgo::Salsa20) {
+        cipher.reset(new SymmetricCipher(SymmetricCipher::Salsa20, SymmetricCipher::Stream, SymmetricCipher::Encrypt));
+        QVERIFY(cipher->init(CryptoHash::hash(key, CryptoHash::Sha256), KeePass2::INNER_STREAM_SALSA20_IV));
+    } else {
+        QByteArray keyIv = CryptoHash::hash(key, CryptoHash::Sha512);
+        cipher.reset(new SymmetricCipher(SymmetricCipher::ChaCha20, SymmetricCipher::Stream, SymmetricCipher::Encrypt));
+        QVERIFY(cipher->init(keyIv.left(32), keyIv.mid(32, 12)));
+    }
+    bool ok;
+    QByteArray expected = cipher->process(data, &ok);
+    QVERIFY(ok);
+
+    // many small fields, crossing keystream batch boundaries at arbitrary offsets
+    KeePass2RandomStream randomStream(algo);
+    QVERIFY(randomStream.init(key));
+    QByteArray result;
+    int pos = 0;
+    int field = 0;
+    while (pos < Size) {
+        QByteArray chunk = data.mid(pos, 1 + (field++ * 37) % 301);
+        if (field % 2 == 0) {
+            QVERIFY(randomStream.processInPlace(chunk));
+        } else {
+            chunk = randomStream.process(chunk, &ok);
+            QVERIFY(ok);
+        }
+        result.append(chunk);
+        pos += chunk.size();
+    }
+
+    QCOMPARE(result, expected);
+}
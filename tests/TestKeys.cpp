@@ -26,12 +26,18 @@
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
 #include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
 #include "crypto/kdf/AesKdf.h"
+#include "crypto/kdf/Argon2Arena.h"
+#include "crypto/kdf/Argon2Kdf.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
+#include "keys/TransformedKeyCache.h"
 #include "mock/MockChallengeResponseKey.h"
+#include "mock/MockClock.h"
+#include "util/TemporaryFile.h"
 
 QTEST_GUILESS_MAIN(TestKeys)
 Q_DECLARE_METATYPE(FileKey::Type);
@@ -195,6 +201,203 @@ void TestKeys::testFileKeyError()
     errorMsg = "";
 }
 
+void TestKeys::testLargeFileKey()
+{
+    // starts like XML, but is hashed
+    QByteArray data = randomGen()->randomArray(3 * 1024 * 1024 + 17);
+    data.prepend("<?xml version=\"1.0\"?><Other/>");
+
+    TemporaryFile file;
+    QVERIFY(file.open());
+    QCOMPARE(file.write(data), qint64(data.size()));
+    file.close();
+
+    FileKey fileKey;
+    QString errorMsg;
+    QVERIFY2(fileKey.load(file.fileName(), &errorMsg), errorMsg.toLatin1());
+    QCOMPARE(fileKey.type(), FileKey::Hashed);
+    QCOMPARE(fileKey.rawKey(), CryptoHash::hash(data, CryptoHash::Sha256));
+
+    // the key of an unchanged file is remembered
+    FileKey cachedKey;
+    QVERIFY(cachedKey.load(file.fileName(), &errorMsg));
+    QCOMPARE(cachedKey.type(), FileKey::Hashed);
+    QCOMPARE(cachedKey.rawKey(), fileKey.rawKey());
+
+    // a changed file is read again
+    data.append('x');
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    QCOMPARE(file.write(data), qint64(data.size()));
+    file.close();
+    FileKey changedKey;
+    QVERIFY(changedKey.load(file.fileName(), &errorMsg));
+    QCOMPARE(changedKey.rawKey(), CryptoHash::hash(data, CryptoHash::Sha256));
+
+    FileKey::clearCache();
+    FileKey reloadedKey;
+    QVERIFY(reloadedKey.load(file.fileName(), &errorMsg));
+    QCOMPARE(reloadedKey.rawKey(), changedKey.rawKey());
+}
+
+void TestKeys::testArgon2AutoTune()
+{
+    Argon2Kdf kdf;
+    const auto results = kdf.autoTune(Kdf::MIN_ENCRYPTION_TIME);
+    QVERIFY(!results.isEmpty());
+
+    // the applied parameters are one of the measured configurations
+    bool applied = false;
+    for (const auto& result : results) {
+        QVERIFY(result.memory >= (1 << 16));
+        QVERIFY(result.parallelism >= 1);
+        QVERIFY(result.rounds >= 1);
+        QVERIFY(result.msec >= Kdf::MIN_ENCRYPTION_TIME);
+        if (result.memory == kdf.memory() && result.parallelism == kdf.parallelism()
+            && result.rounds == kdf.rounds()) {
+            applied = true;
+        }
+    }
+    QVERIFY(applied);
+
+    QByteArray transformed;
+    QVERIFY(kdf.transform(QByteArray(32, '\x01'), transformed));
+    QCOMPARE(transformed.size(), 32);
+}
+
+void TestKeys::testKdfBenchmarkCache()
+{
+    // parameters no other test uses
+    Argon2Kdf kdf;
+    kdf.setMemory(1 << 13);
+    kdf.setParallelism(3);
+    QCOMPARE(kdf.estimateRounds(Kdf::MIN_ENCRYPTION_TIME), 0);
+    QCOMPARE(kdf.estimateTransformTime(), -1);
+
+    const int rounds = kdf.benchmark(Kdf::MIN_ENCRYPTION_TIME);
+    QVERIFY(qAbs(kdf.estimateRounds(Kdf::MIN_ENCRYPTION_TIME) - rounds) <= 1);
+    QVERIFY(kdf.estimateRounds(Kdf::MIN_ENCRYPTION_TIME * 2) >= rounds * 2 - 1);
+    kdf.setRounds(rounds);
+    QVERIFY(qAbs(kdf.estimateTransformTime() - Kdf::MIN_ENCRYPTION_TIME) <= 1);
+
+    // the rounds do not matter, the other performance parameters do
+    auto copy = kdf.clone().staticCast<Argon2Kdf>();
+    copy->setRounds(rounds * 2);
+    QVERIFY(qAbs(copy->estimateTransformTime() - Kdf::MIN_ENCRYPTION_TIME * 2) <= 1);
+    copy->setParallelism(4);
+    QCOMPARE(copy->estimateRounds(Kdf::MIN_ENCRYPTION_TIME), 0);
+}
+
+void TestKeys::testArgon2Arena()
+{
+    auto arena = Argon2Arena::instance();
+    QVERIFY(!arena->isEnabled());
+
+    Argon2Kdf kdf;
+    kdf.setMemory(1 << 13);
+    kdf.setRounds(1);
+    kdf.setParallelism(2);
+    kdf.randomizeSeed();
+    const QByteArray raw(32, '\x01');
+
+    QByteArray expected;
+    QVERIFY(kdf.transform(raw, expected));
+    QCOMPARE(arena->cachedSize(), std::size_t(0));
+
+    // the block is kept for the next transformation and gives the same results
+    arena->setEnabled(true);
+    for (int i = 0; i < 2; ++i) {
+        QByteArray transformed;
+        QVERIFY(kdf.transform(raw, transformed));
+        QCOMPARE(transformed, expected);
+        QVERIFY(arena->cachedSize() >= kdf.memory() * 1024);
+    }
+
+    // smaller transformations reuse the larger block
+    const std::size_t cachedSize = arena->cachedSize();
+    Argon2Kdf smallKdf(kdf);
+    smallKdf.setMemory(1 << 12);
+    QByteArray transformed;
+    QVERIFY(smallKdf.transform(raw, transformed));
+    QVERIFY(transformed != expected);
+    QCOMPARE(arena->cachedSize(), cachedSize);
+
+    arena->clear();
+    QCOMPARE(arena->cachedSize(), std::size_t(0));
+    QVERIFY(kdf.transform(raw, transformed));
+    QCOMPARE(transformed, expected);
+    QVERIFY(arena->cachedSize() > 0);
+
+    arena->setEnabled(false);
+    QCOMPARE(arena->cachedSize(), std::size_t(0));
+}
+
+void TestKeys::testTransformedKeyCache()
+{
+    auto clock = new MockClock();
+    MockClock::setup(clock);
+
+    auto cache = TransformedKeyCache::instance();
+    cache->setTimeout(60 * 1000);
+    cache->setEnabled(true);
+    QVERIFY(cache->isEmpty());
+
+    auto compositeKey = QSharedPointer<CompositeKey>::create();
+    compositeKey->addKey(QSharedPointer<PasswordKey>::create("password"));
+
+    AesKdf kdf(true);
+    kdf.setRounds(1000);
+    kdf.randomizeSeed();
+
+    QByteArray transformed;
+    QVERIFY(compositeKey->transform(kdf, transformed));
+    QVERIFY(!cache->isEmpty());
+
+    QByteArray cached;
+    QVERIFY(cache->lookup(kdf, compositeKey->rawKey(), cached));
+    QCOMPARE(cached, transformed);
+
+    // the cached key is only used for the exact same credentials and parameters
+    QVERIFY(!cache->lookup(kdf, PasswordKey("other").rawKey(), cached));
+    AesKdf otherKdf(true);
+    otherKdf.setRounds(1000);
+    otherKdf.randomizeSeed();
+    QVERIFY(!cache->lookup(otherKdf, compositeKey->rawKey(), cached));
+    otherKdf.setSeed(kdf.seed());
+    otherKdf.setRounds(1001);
+    QVERIFY(!cache->lookup(otherKdf, compositeKey->rawKey(), cached));
+
+    QByteArray transformedAgain;
+    QVERIFY(compositeKey->transform(kdf, transformedAgain));
+    QCOMPARE(transformedAgain, transformed);
+
+    // cached keys expire
+    clock->advanceSecond(61);
+    QVERIFY(!cache->lookup(kdf, compositeKey->rawKey(), cached));
+
+    QVERIFY(compositeKey->transform(kdf, transformed));
+    QVERIFY(!cache->isEmpty());
+    cache->clear();
+    QVERIFY(cache->isEmpty());
+
+    // nothing is cached while disabled
+    cache->setEnabled(false);
+    QVERIFY(compositeKey->transform(kdf, transformed));
+    QVERIFY(cache->isEmpty());
+
+    // keys can use the share cache instead, which is always enabled
+    auto shareCache = TransformedKeyCache::shareInstance();
+    QVERIFY(shareCache->isEnabled());
+    shareCache->clear();
+    compositeKey->setTransformCache(shareCache);
+    QVERIFY(compositeKey->transform(kdf, transformedAgain));
+    QCOMPARE(transformedAgain, transformed);
+    QVERIFY(!shareCache->isEmpty());
+    QVERIFY(cache->isEmpty());
+    shareCache->clear();
+
+    MockClock::teardown();
+}
+
 void TestKeys::benchmarkTransformKey()
 {
     QByteArray env = qgetenv("BENCHMARK");
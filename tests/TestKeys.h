@@ -34,7 +34,12 @@ private slots:
     void testCreateAndOpenFileKey();
     void testFileKeyHash();
     void testFileKeyError();
+    void testLargeFileKey();
     void testCompositeKeyComponents();
+    void testArgon2AutoTune();
+    void testKdfBenchmarkCache();
+    void testArgon2Arena();
+    void testTransformedKeyCache();
     void benchmarkTransformKey();
 };
 
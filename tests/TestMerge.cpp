@@ -1235,6 +1235,108 @@ void TestMerge::testCustomData()
              QString("oldValue")); // Old value should not be replaced
 }
 
+/**
+ * Entries that did not change in the source since the last merge
+ * must not override local changes, regardless of the merge mode.
+ */
+void TestMerge::testMergeBase()
+{
+    QScopedPointer<Database> dbDestination(createTestDatabase());
+    QScopedPointer<Database> dbSource(
+        createTestDatabaseStructureClone(dbDestination.data(), Entry::CloneIncludeHistory, Group::CloneIncludeEntries));
+
+    const QString mergeBaseKey = CustomData::MergeBaseKeyPrefix + dbSource->rootGroup()->uuidToHex();
+
+    m_clock->advanceSecond(1);
+
+    Merger merger1(dbSource.data(), dbDestination.data());
+    merger1.setForcedMergeMode(Group::KeepRemote);
+    merger1.setUseMergeBase(true);
+    QVERIFY(merger1.merge().isEmpty());
+    QVERIFY(dbDestination->metadata()->customData()->contains(mergeBaseKey));
+    QVERIFY(!dbSource->metadata()->customData()->contains(mergeBaseKey));
+
+    m_clock->advanceSecond(1);
+
+    Entry* destinationEntry1 = dbDestination->rootGroup()->findEntryByPath("entry1");
+    QVERIFY(destinationEntry1);
+    destinationEntry1->beginUpdate();
+    destinationEntry1->setTitle("local title");
+    destinationEntry1->endUpdate();
+
+    m_clock->advanceSecond(1);
+
+    // The source is unchanged, so the local change survives KeepRemote
+    Merger merger2(dbSource.data(), dbDestination.data());
+    merger2.setForcedMergeMode(Group::KeepRemote);
+    merger2.setUseMergeBase(true);
+    QVERIFY(merger2.merge().isEmpty());
+    QCOMPARE(destinationEntry1->title(), QString("local title"));
+
+    m_clock->advanceSecond(1);
+
+    Entry* sourceEntry1 = dbSource->rootGroup()->findEntryByPath("entry1");
+    QVERIFY(sourceEntry1);
+    sourceEntry1->beginUpdate();
+    sourceEntry1->setTitle("remote title");
+    sourceEntry1->endUpdate();
+
+    m_clock->advanceSecond(1);
+
+    // A changed source entry is merged as usual
+    Merger merger3(dbSource.data(), dbDestination.data());
+    merger3.setForcedMergeMode(Group::KeepRemote);
+    merger3.setUseMergeBase(true);
+    QVERIFY(!merger3.merge().isEmpty());
+    Entry* mergedEntry1 = dbDestination->rootGroup()->findEntryByUuid(sourceEntry1->uuid());
+    QVERIFY(mergedEntry1);
+    QCOMPARE(mergedEntry1->title(), QString("remote title"));
+}
+
+/**
+ * A database merged into a group, as done for shared folders, keeps
+ * its own merge base for that group.
+ */
+void TestMerge::testMergeBaseIntoGroup()
+{
+    QScopedPointer<Database> dbDestination(createTestDatabase());
+    QScopedPointer<Database> dbSource(new Database());
+    auto* sourceEntry = new Entry();
+    sourceEntry->setUuid(QUuid::createUuid());
+    sourceEntry->setTitle("shared entry");
+    sourceEntry->setGroup(dbSource->rootGroup());
+
+    Group* targetGroup = dbDestination->rootGroup()->children().at(0);
+    const QString mergeBaseKey = CustomData::MergeBaseKeyPrefix + dbSource->rootGroup()->uuidToHex()
+                                 + QStringLiteral("/") + targetGroup->uuidToHex();
+
+    m_clock->advanceSecond(1);
+
+    Merger merger1(dbSource->rootGroup(), targetGroup);
+    merger1.setForcedMergeMode(Group::Synchronize);
+    merger1.setUseMergeBase(true);
+    QVERIFY(!merger1.merge().isEmpty());
+    QVERIFY(dbDestination->metadata()->customData()->contains(mergeBaseKey));
+
+    Entry* targetEntry = targetGroup->findEntryByUuid(sourceEntry->uuid());
+    QVERIFY(targetEntry);
+
+    m_clock->advanceSecond(1);
+
+    targetEntry->beginUpdate();
+    targetEntry->setTitle("local title");
+    targetEntry->endUpdate();
+
+    m_clock->advanceSecond(1);
+
+    // The shared entry is unchanged, so it is not compared again
+    Merger merger2(dbSource->rootGroup(), targetGroup);
+    merger2.setForcedMergeMode(Group::Synchronize);
+    merger2.setUseMergeBase(true);
+    QVERIFY(merger2.merge().isEmpty());
+    QCOMPARE(targetEntry->title(), QString("local title"));
+}
+
 void TestMerge::testDeletedEntry()
 {
     QScopedPointer<Database> dbDestination(createTestDatabase());
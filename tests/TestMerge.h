@@ -60,6 +60,8 @@ private slots:
     void testMergeDuplicateCustomIcons();
     void testMetadata();
     void testCustomData();
+    void testMergeBase();
+    void testMergeBaseIntoGroup();
     void testDeletedEntry();
     void testDeletedGroup();
     void testDeletedRevertedEntry();
@@ -31,6 +31,7 @@
 #include <QJsonObject>
 #include <QList>
 #include <QPair>
+#include <QSignalSpy>
 #include <QStringList>
 #include <QTest>
 #include <QUuid>
@@ -68,10 +69,15 @@ void TestOpVaultReader::testReadIntoDatabase()
     QDir opVaultDir(m_opVaultPath);
 
     OpVaultReader reader;
+    QSignalSpy progressSpy(&reader, SIGNAL(bandEntriesProgress(int, int)));
     QScopedPointer<Database> db(reader.readDatabase(opVaultDir, "a"));
     QVERIFY(db);
     QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
 
+    // the items are decrypted in parallel, progress ends with all of them done
+    QVERIFY(!progressSpy.isEmpty());
+    QCOMPARE(progressSpy.last().at(0).toInt(), progressSpy.last().at(1).toInt());
+
     // Confirm specific entry details are valid
     auto entry = db->rootGroup()->findEntryByPath("/Login/KeePassXC");
     QVERIFY(entry);
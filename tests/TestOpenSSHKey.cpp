@@ -442,4 +442,14 @@ void TestOpenSSHKey::testGenerateRSA()
     QCOMPARE(key.cipherName(), QString("none"));
     QCOMPARE(key.type(), QString("ssh-rsa"));
     QCOMPARE(key.comment(), QString(""));
+
+    const QString fingerprint = key.fingerprint();
+    QVERIFY(!fingerprint.isEmpty());
+    QCOMPARE(key.fingerprint(), fingerprint);
+
+    // the cached fingerprint follows changes of the public key
+    QList<QByteArray> publicParts = key.publicParts();
+    publicParts[1].append('\x01');
+    key.setPublicData(publicParts);
+    QVERIFY(key.fingerprint() != fingerprint);
 }
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestParallelGzipStream.h"
+#include "TestGlobal.h"
+
+#include <QBuffer>
+
+#include "FailDevice.h"
+#include "streams/ParallelGzipStream.h"
+#include "streams/QtIOCompressor"
+
+QTEST_GUILESS_MAIN(TestParallelGzipStream)
+
+void TestParallelGzipStream::testRoundTrip_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("level");
+
+    QByteArray text;
+    for (int i = 0; text.size() < 5 * ParallelGzipStream::ChunkSize + 1234; ++i) {
+        text.append(QString("<Entry><String>line %1</String></Entry>\n").arg(i % 997).toLatin1());
+    }
+    QByteArray binary(3 * ParallelGzipStream::ChunkSize, Qt::Uninitialized);
+    for (int i = 0; i < binary.size(); ++i) {
+        binary[i] = static_cast<char>((i * 2654435761u) >> 13);
+    }
+
+    QTest::newRow("empty") << QByteArray() << 6;
+    QTest::newRow("small") << QByteArray("KeePassXC") << 6;
+    QTest::newRow("exact chunk") << text.left(ParallelGzipStream::ChunkSize) << 6;
+    QTest::newRow("text") << text << 6;
+    QTest::newRow("text fast") << text << 1;
+    QTest::newRow("text best") << text << 9;
+    QTest::newRow("text stored") << text << 0;
+    QTest::newRow("binary") << binary << 6;
+}
+
+void TestParallelGzipStream::testRoundTrip()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, level);
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+
+    ParallelGzipStream writer(&buffer, level);
+    QVERIFY(writer.open(QIODevice::WriteOnly));
+    // write in odd sizes to cross chunk boundaries
+    for (int offset = 0; offset < data.size(); offset += 10007) {
+        QCOMPARE(writer.write(data.mid(offset, 10007)), qint64(data.mid(offset, 10007).size()));
+    }
+    QVERIFY(writer.finish());
+    writer.close();
+    buffer.close();
+
+    QByteArray compressed = buffer.data();
+    QCOMPARE(compressed.left(2), QByteArray("\x1f\x8b"));
+    if (level > 0 && data.startsWith("<Entry>")) {
+        QVERIFY(compressed.size() < data.size());
+    }
+
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QtIOCompressor reader(&buffer);
+    reader.setStreamFormat(QtIOCompressor::GzipFormat);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    QCOMPARE(reader.readAll(), data);
+}
+
+void TestParallelGzipStream::testWriteFailure()
+{
+    QByteArray data(4 * ParallelGzipStream::ChunkSize, 'x');
+
+    FailDevice failDevice(16);
+    QVERIFY(failDevice.open(QIODevice::WriteOnly));
+
+    ParallelGzipStream writer(&failDevice);
+    QVERIFY(writer.open(QIODevice::WriteOnly));
+    writer.write(data);
+    QVERIFY(!writer.finish());
+    QVERIFY(!writer.errorString().isEmpty());
+}
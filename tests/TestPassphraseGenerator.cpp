@@ -17,9 +17,11 @@
 
 #include "TestPassphraseGenerator.h"
 #include "core/PassphraseGenerator.h"
+#include "core/Wordlist.h"
 #include "crypto/Crypto.h"
 
 #include <QRegularExpression>
+#include <QTemporaryFile>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestPassphraseGenerator)
@@ -52,3 +54,31 @@ void TestPassphraseGenerator::testWordCase()
     QRegularExpression regex("^([A-Z][a-z]* ?)+$");
     QVERIFY(regex.match(passphrase).hasMatch());
 }
+
+void TestPassphraseGenerator::testWordlist()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write("alpha\r\nbeta\n\ngamma");
+    file.flush();
+
+    auto wordlist = Wordlist::load(file.fileName());
+    QVERIFY(wordlist);
+    QCOMPARE(wordlist->size(), 4);
+    QCOMPARE(wordlist->at(0), QString("alpha"));
+    QCOMPARE(wordlist->at(1), QString("beta"));
+    QCOMPARE(wordlist->at(2), QString(""));
+    QCOMPARE(wordlist->at(3), QString("gamma"));
+
+    // The parsed list is shared until the file changes
+    QCOMPARE(Wordlist::load(file.fileName()), wordlist);
+    file.write("\ndelta\n");
+    file.flush();
+    auto changed = Wordlist::load(file.fileName());
+    QVERIFY(changed != wordlist);
+    QCOMPARE(changed->size(), 5);
+    QCOMPARE(changed->at(4), QString("delta"));
+    QCOMPARE(wordlist->at(3), QString("gamma"));
+
+    QVERIFY(!Wordlist::load(file.fileName() + ".missing"));
+}
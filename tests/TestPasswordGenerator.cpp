@@ -141,3 +141,23 @@ void TestPasswordGenerator::testLookalikeExclusion()
     regex.setPattern("^[^lI01﹒]+$");
     QVERIFY(regex.match(password).hasMatch());
 }
+
+void TestPasswordGenerator::testGeneratePasswords()
+{
+    PasswordGenerator generator;
+    generator.setLength(12);
+    generator.setCharClasses(PasswordGenerator::LowerLetters | PasswordGenerator::Numbers);
+    generator.setFlags(PasswordGenerator::CharFromEveryGroup);
+    QVERIFY(generator.isValid());
+
+    QVERIFY(generator.generatePasswords(0).isEmpty());
+
+    const QStringList passwords = generator.generatePasswords(1000);
+    QCOMPARE(passwords.size(), 1000);
+
+    QRegularExpression regex(R"(^(?=.*[a-z])(?=.*\d)[a-z\d]{12}$)");
+    for (const QString& password : passwords) {
+        QVERIFY2(regex.match(password).hasMatch(), qPrintable(password));
+    }
+    QCOMPARE(passwords.toSet().size(), passwords.size());
+}
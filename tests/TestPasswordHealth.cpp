@@ -18,12 +18,21 @@
 #include "TestPasswordHealth.h"
 #include "TestGlobal.h"
 
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
 #include "core/PasswordHealth.h"
+#include "core/PasswordHealthCache.h"
+#include "crypto/Crypto.h"
+#include "zxcvbn/zxcvbn.h"
+
+#include <QtConcurrent>
 
 QTEST_GUILESS_MAIN(TestPasswordHealth)
 
 void TestPasswordHealth::initTestCase()
 {
+    QVERIFY(Crypto::init());
 }
 
 void TestPasswordHealth::testNoDb()
@@ -63,3 +72,112 @@ void TestPasswordHealth::testNoDb()
     QVERIFY(excellent.scoreReason().isEmpty());
     QVERIFY(excellent.scoreDetails().isEmpty());
 }
+
+void TestPasswordHealth::testHealthChecker()
+{
+    auto db = QSharedPointer<Database>::create();
+    QList<const Entry*> entries;
+    for (int i = 0; i < 50; ++i) {
+        auto* entry = new Entry();
+        entry->setTitle(QString("entry%1").arg(i));
+        // Every other entry re-uses the same password
+        entry->setPassword(i % 2 ? QString("MIhIN9UKrgtPL2hp") : QString("MIhIN9UKrgtPL2hp%1").arg(i));
+        entry->setGroup(db->rootGroup());
+        entries.append(entry);
+    }
+
+    HealthChecker checker(db);
+
+    // Evaluating from several threads gives the same results as evaluating serially
+    std::function<int(const Entry*)> score = [&checker](const Entry* entry) {
+        return checker.evaluate(entry)->score();
+    };
+    const auto scores = QtConcurrent::blockingMapped<QList<int>>(entries, score);
+    QCOMPARE(scores.size(), entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        QCOMPARE(scores[i], checker.evaluate(entries[i])->score());
+    }
+
+    const auto reused = checker.evaluate(entries[1]);
+    QCOMPARE(int(reused->entropy()), 78);
+    QCOMPARE(reused->score(), 78 - 15 * 24);
+    QVERIFY(reused->scoreReason().contains("25"));
+    QVERIFY(checker.evaluate(entries[0])->score() > 64);
+}
+
+void TestPasswordHealth::testHealthCache()
+{
+    auto db = QSharedPointer<Database>::create();
+    QList<Entry*> entries;
+    for (int i = 0; i < 3; ++i) {
+        auto* entry = new Entry();
+        entry->setTitle(QString("entry%1").arg(i));
+        entry->setPassword(i < 2 ? QString("MIhIN9UKrgtPL2hp") : QString("Yohb2ChR4"));
+        entry->setGroup(db->rootGroup());
+        entries.append(entry);
+    }
+
+    auto* cache = db->healthCache();
+    QCOMPARE(cache->size(), 0);
+
+    {
+        HealthChecker checker(db);
+        QCOMPARE(cache->size(), 3);
+        QCOMPARE(cache->passwordUsers().size(), 2);
+        QCOMPARE(checker.evaluate(entries[0])->score(), 78 - 15);
+        QVERIFY(checker.evaluate(entries[0])->scoreReason().contains("2"));
+        QCOMPARE(checker.evaluate(entries[2])->score(), 47);
+    }
+
+    // Modified entries are picked up by the next report
+    entries[1]->setPassword("MIhIN9UKrgtPL2hp1");
+    {
+        HealthChecker checker(db);
+        QCOMPARE(cache->size(), 3);
+        QCOMPARE(cache->passwordUsers().size(), 3);
+        QCOMPARE(checker.evaluate(entries[0])->score(), 78);
+        QVERIFY(checker.evaluate(entries[0])->scoreReason().isEmpty());
+    }
+
+    // Recycled and deleted entries are forgotten
+    db->recycleEntry(entries[2]);
+    delete entries[1];
+    {
+        HealthChecker checker(db);
+        QCOMPARE(cache->size(), 1);
+        QCOMPARE(cache->passwordUsers().size(), 1);
+        QCOMPARE(checker.evaluate(entries[0])->score(), 78);
+    }
+
+    entries[0]->setPassword(entries[2]->password());
+    {
+        HealthChecker checker(db);
+        QCOMPARE(cache->passwordUsers().size(), 1);
+        QCOMPARE(checker.evaluate(entries[0])->score(), 47);
+    }
+}
+
+void TestPasswordHealth::benchmarkEntropy()
+{
+    const QStringList passwords = {"secret",
+                                   "Yohb2ChR4",
+                                   "MIhIN9UKrgtPL2hp",
+                                   "correcthorsebatterystaple",
+                                   "P@ssw0rd1234",
+                                   "qwertyuiop",
+                                   "Tr0ub4dor&3",
+                                   "zxcvbn-2020-password",
+                                   "iuhb3@f8$Q1!a0Zo",
+                                   "summer2019winter2020"};
+    QList<QByteArray> encoded;
+    for (const auto& password : passwords) {
+        encoded.append(password.toUtf8());
+    }
+
+    QBENCHMARK
+    {
+        for (const auto& password : asConst(encoded)) {
+            ZxcvbnMatch(password.constData(), nullptr, nullptr);
+        }
+    }
+}
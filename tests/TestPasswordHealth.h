@@ -27,6 +27,9 @@ class TestPasswordHealth : public QObject
 private slots:
     void initTestCase();
     void testNoDb();
+    void testHealthChecker();
+    void testHealthCache();
+    void benchmarkEntropy();
 };
 
 #endif // KEEPASSX_TESTPASSWORDHEALTH_H
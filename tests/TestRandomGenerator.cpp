@@ -19,9 +19,11 @@
 #include "TestGlobal.h"
 #include "core/Endian.h"
 #include "core/Global.h"
+#include "crypto/Crypto.h"
 #include "stub/TestRandom.h"
 
 #include <QTest>
+#include <QtConcurrent>
 
 QTEST_GUILESS_MAIN(TestRandomGenerator)
 
@@ -78,3 +80,34 @@ void TestRandomGenerator::testUIntRange()
     m_backend->setNextBytes(nextBytes);
     QCOMPARE(randomGen()->randomUIntRange(100, 200), 142U);
 }
+
+void TestRandomGenerator::testPooledBackend()
+{
+    // Switch to the default libgcrypt backend, this releases the preset backend
+    TestRandom::teardown();
+    m_backend = nullptr;
+    QVERIFY(Crypto::init());
+
+    QVector<int> counts(62);
+    for (int i = 0; i < 10000; ++i) {
+        quint32 value = randomGen()->randomUInt(62);
+        QVERIFY(value < 62U);
+        ++counts[static_cast<int>(value)];
+    }
+    QVERIFY(!counts.contains(0));
+
+    // Small draws from different threads must not share pooled bytes
+    QByteArray local = randomGen()->randomArray(16);
+    QByteArray remote = QtConcurrent::run([] { return randomGen()->randomArray(16); }).result();
+    QCOMPARE(local.size(), 16);
+    QCOMPARE(remote.size(), 16);
+    QVERIFY(local != remote);
+
+    // Requests that span several pool refills as well as large direct reads
+    QByteArray mixed;
+    for (int i = 0; i < 1000; ++i) {
+        mixed.append(randomGen()->randomArray(13));
+    }
+    QCOMPARE(mixed.size(), 13000);
+    QCOMPARE(randomGen()->randomArray(8192).size(), 8192);
+}
@@ -33,6 +33,7 @@ private slots:
     void cleanupTestCase();
     void testUInt();
     void testUIntRange();
+    void testPooledBackend();
 
 private:
     RandomBackendPreset* m_backend;
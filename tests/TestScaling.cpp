@@ -0,0 +1,180 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestScaling.h"
+
+#include "config-keepassx.h"
+#include "core/Database.h"
+#include "core/DatabaseGenerator.h"
+#include "core/Group.h"
+#include "core/Merger.h"
+#include "crypto/Crypto.h"
+
+#ifdef WITH_XC_BROWSER
+#include "browser/BrowserService.h"
+#endif
+
+#include <QElapsedTimer>
+#include <QTest>
+
+#include <functional>
+#include <limits>
+
+QTEST_GUILESS_MAIN(TestScaling)
+
+namespace
+{
+    constexpr int SmallEntryCount = 1000;
+    constexpr int LargeEntryCount = SmallEntryCount * 10;
+    constexpr int EntriesPerGroup = 100;
+    constexpr int Repetitions = 5;
+    // Measurements below this are mostly timer and scheduler noise
+    constexpr qint64 NoiseFloorNs = 1000000;
+    // Allowed growth of an indexed lookup, and of an operation over all entries, for ten times the entries
+    constexpr double IndexedLimit = 2.0;
+    constexpr double LinearLimit = 20.0;
+
+    QSharedPointer<Database> generateDatabase(int entryCount)
+    {
+        auto db = QSharedPointer<Database>::create();
+        DatabaseGenerator::Settings settings;
+        settings.groups = entryCount / EntriesPerGroup;
+        settings.entries = entryCount;
+        settings.references = entryCount / 10;
+        DatabaseGenerator(settings).populate(db.data());
+        return db;
+    }
+
+    /**
+     * Return the shortest of several runs of the given operation in nanoseconds.
+     * The prepare step runs before each of them and is not measured.
+     */
+    qint64 bestTime(const std::function<void()>& run, const std::function<void()>& prepare = {})
+    {
+        qint64 best = std::numeric_limits<qint64>::max();
+        for (int i = 0; i < Repetitions; ++i) {
+            if (prepare) {
+                prepare();
+            }
+            QElapsedTimer timer;
+            timer.start();
+            run();
+            best = qMin(best, timer.nsecsElapsed());
+        }
+        return best;
+    }
+
+    void verifyScaling(qint64 small, qint64 large, double limit)
+    {
+        const auto message = QString("%1 entries took %2 us, %3 entries took %4 us, allowed ratio is %5")
+                                 .arg(SmallEntryCount)
+                                 .arg(small / 1000)
+                                 .arg(LargeEntryCount)
+                                 .arg(large / 1000)
+                                 .arg(limit)
+                                 .toLatin1();
+        QVERIFY2(static_cast<double>(large) <= static_cast<double>(qMax(small, NoiseFloorNs)) * limit,
+                 message.constData());
+    }
+} // namespace
+
+void TestScaling::initTestCase()
+{
+    QVERIFY(Crypto::init());
+}
+
+void TestScaling::testFindEntryByUuid()
+{
+    constexpr int Lookups = 100000;
+
+    auto measure = [](int entryCount) {
+        auto db = generateDatabase(entryCount);
+        QList<QUuid> uuids;
+        for (const auto* entry : db->rootGroup()->entriesRecursive()) {
+            uuids.append(entry->uuid());
+        }
+        auto* root = db->rootGroup();
+        return bestTime([&] {
+            for (int i = 0; i < Lookups; ++i) {
+                QVERIFY(root->findEntryByUuid(uuids.at(i % uuids.size())));
+            }
+        });
+    };
+
+    const qint64 small = measure(SmallEntryCount);
+    const qint64 large = measure(LargeEntryCount);
+    verifyScaling(small, large, IndexedLimit);
+}
+
+void TestScaling::testReferencesRecursive()
+{
+    constexpr int Lookups = 1000;
+
+    auto measure = [](int entryCount) {
+        auto db = generateDatabase(entryCount);
+        const auto entries = db->rootGroup()->entriesRecursive();
+        auto* root = db->rootGroup();
+        return bestTime([&] {
+            for (int i = 0; i < Lookups; ++i) {
+                root->referencesRecursive(entries.at(i % entries.size()));
+            }
+        });
+    };
+
+    const qint64 small = measure(SmallEntryCount);
+    const qint64 large = measure(LargeEntryCount);
+    verifyScaling(small, large, IndexedLimit);
+}
+
+void TestScaling::testMerge()
+{
+    auto measure = [](int entryCount) {
+        // Both databases come from the same seed, so they share all UUIDs
+        auto source = generateDatabase(entryCount);
+        const auto entries = source->rootGroup()->entriesRecursive();
+        for (int i = 0; i < entries.size(); i += 10) {
+            entries.at(i)->setNotes(QStringLiteral("Changed in the source database"));
+        }
+
+        QSharedPointer<Database> target;
+        return bestTime([&] { Merger(source.data(), target.data()).merge(); },
+                        [&] { target = generateDatabase(entryCount); });
+    };
+
+    const qint64 small = measure(SmallEntryCount);
+    const qint64 large = measure(LargeEntryCount);
+    verifyScaling(small, large, LinearLimit);
+}
+
+void TestScaling::testBrowserSearchEntries()
+{
+#ifdef WITH_XC_BROWSER
+    auto measure = [](int entryCount) {
+        // All generated sites share one base domain, so every entry is a candidate
+        auto db = generateDatabase(entryCount);
+        const QString url = QStringLiteral("https://site7.example.com/login");
+        browserService()->searchEntries(db, url, url);
+        return bestTime([&] { browserService()->searchEntries(db, url, url); });
+    };
+
+    const qint64 small = measure(SmallEntryCount);
+    const qint64 large = measure(LargeEntryCount);
+    verifyScaling(small, large, LinearLimit);
+#else
+    QSKIP("Browser integration is not enabled");
+#endif
+}
@@ -0,0 +1,43 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TESTSCALING_H
+#define KEEPASSXC_TESTSCALING_H
+
+#include <QObject>
+
+/**
+ * Guards against complexity regressions by timing the same operation on a
+ * generated database and on one ten times its size. Plain timings are too
+ * machine dependent to assert on, but their ratio is not: indexed lookups
+ * should cost about the same on both, and operations over all entries about
+ * ten times as much. A quadratic slip, like a list lookup in a loop over all
+ * entries, shows up as a ratio of a hundred.
+ */
+class TestScaling : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void testFindEntryByUuid();
+    void testReferencesRecursive();
+    void testMerge();
+    void testBrowserSearchEntries();
+};
+
+#endif // KEEPASSXC_TESTSCALING_H
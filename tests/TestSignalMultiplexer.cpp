@@ -0,0 +1,151 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestSignalMultiplexer.h"
+
+#include <QTest>
+
+#include "core/SignalMultiplexer.h"
+
+QTEST_GUILESS_MAIN(TestSignalMultiplexer)
+
+void TestSignalMultiplexer::testRouteToCurrentObject()
+{
+    SignalMultiplexer mx;
+    MultiplexerSource source;
+    MultiplexerTarget first;
+    MultiplexerTarget second;
+
+    mx.connect(&source, SIGNAL(triggered()), SLOT(trigger()));
+    mx.connect(&source, SIGNAL(valueChanged(int)), SLOT(setValue(int)));
+
+    // Nothing is delivered without a current object
+    emit source.triggered();
+    QVERIFY(first.calls.isEmpty());
+
+    mx.setCurrentObject(&first);
+    QCOMPARE(mx.currentObject(), &first);
+    emit source.triggered();
+    emit source.valueChanged(1);
+    QCOMPARE(first.calls, QStringList({"trigger", "value 1"}));
+
+    mx.setCurrentObject(&second);
+    emit source.valueChanged(2);
+    QCOMPARE(first.calls, QStringList({"trigger", "value 1"}));
+    QCOMPARE(second.calls, QStringList({"value 2"}));
+
+    // Switching back and forth must not duplicate deliveries
+    mx.setCurrentObject(&first);
+    mx.setCurrentObject(&second);
+    mx.setCurrentObject(&first);
+    emit source.triggered();
+    QCOMPARE(first.calls, QStringList({"trigger", "value 1", "trigger"}));
+    QCOMPARE(second.calls, QStringList({"value 2"}));
+
+    // Routes added while an object is current apply immediately
+    MultiplexerSource other;
+    mx.connect(&other, SIGNAL(triggered()), SLOT(trigger()));
+    emit other.triggered();
+    QCOMPARE(first.calls.size(), 4);
+}
+
+void TestSignalMultiplexer::testRouteFromCurrentObject()
+{
+    SignalMultiplexer mx;
+    MultiplexerSource receiver;
+    MultiplexerTarget first;
+    MultiplexerTarget second;
+
+    mx.connect(SIGNAL(changed(int)), &receiver, SLOT(receive(int)));
+    mx.setCurrentObject(&first);
+    mx.setCurrentObject(&second);
+
+    // Only the current object is listened to, even though both have been wired
+    emit first.changed(1);
+    emit second.changed(2);
+    QCOMPARE(receiver.values, QList<int>({2}));
+
+    mx.setCurrentObject(&first);
+    emit first.changed(3);
+    emit second.changed(4);
+    QCOMPARE(receiver.values, QList<int>({2, 3}));
+
+    // A route added later reaches objects that were wired before
+    MultiplexerSource late;
+    mx.connect(SIGNAL(changed(int)), &late, SLOT(receive(int)));
+    mx.setCurrentObject(&second);
+    emit second.changed(5);
+    QCOMPARE(late.values, QList<int>({5}));
+    QCOMPARE(receiver.values, QList<int>({2, 3, 5}));
+
+    mx.setCurrentObject(nullptr);
+    emit second.changed(6);
+    QCOMPARE(receiver.values, QList<int>({2, 3, 5}));
+}
+
+void TestSignalMultiplexer::testDisconnect()
+{
+    SignalMultiplexer mx;
+    MultiplexerSource source;
+    MultiplexerTarget target;
+
+    mx.connect(&source, SIGNAL(triggered()), SLOT(trigger()));
+    mx.connect(SIGNAL(changed(int)), &source, SLOT(receive(int)));
+    mx.setCurrentObject(&target);
+
+    mx.disconnect(&source, SIGNAL(triggered()), SLOT(trigger()));
+    mx.disconnect(SIGNAL(changed(int)), &source, SLOT(receive(int)));
+
+    emit source.triggered();
+    emit target.changed(1);
+    QVERIFY(target.calls.isEmpty());
+    QVERIFY(source.values.isEmpty());
+}
+
+void TestSignalMultiplexer::testDeletedObjects()
+{
+    SignalMultiplexer mx;
+    MultiplexerSource source;
+
+    mx.connect(&source, SIGNAL(triggered()), SLOT(trigger()));
+    mx.connect(SIGNAL(changed(int)), &source, SLOT(receive(int)));
+
+    auto* target = new MultiplexerTarget();
+    mx.setCurrentObject(target);
+    emit target->changed(1);
+    delete target;
+    QVERIFY(!mx.currentObject());
+
+    // A deleted current object is never dispatched to
+    emit source.triggered();
+
+    // A new object allocated after the deletion is wired from scratch
+    MultiplexerTarget replacement;
+    mx.setCurrentObject(&replacement);
+    emit source.triggered();
+    emit replacement.changed(2);
+    QCOMPARE(replacement.calls, QStringList({"trigger"}));
+    QCOMPARE(source.values, QList<int>({1, 2}));
+
+    {
+        MultiplexerSource temporary;
+        mx.connect(&temporary, SIGNAL(triggered()), SLOT(trigger()));
+    }
+    mx.setCurrentObject(&replacement);
+    emit source.triggered();
+    QCOMPARE(replacement.calls, QStringList({"trigger", "trigger"}));
+}
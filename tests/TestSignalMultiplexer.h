@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TESTSIGNALMULTIPLEXER_H
+#define KEEPASSXC_TESTSIGNALMULTIPLEXER_H
+
+#include <QObject>
+#include <QStringList>
+
+class MultiplexerTarget : public QObject
+{
+    Q_OBJECT
+
+public:
+    QStringList calls;
+
+signals:
+    void changed(int value);
+
+public slots:
+    void trigger()
+    {
+        calls << "trigger";
+    }
+
+    void setValue(int value)
+    {
+        calls << QString("value %1").arg(value);
+    }
+};
+
+class MultiplexerSource : public QObject
+{
+    Q_OBJECT
+
+public:
+    QList<int> values;
+
+signals:
+    void triggered();
+    void valueChanged(int value);
+
+public slots:
+    void receive(int value)
+    {
+        values << value;
+    }
+};
+
+class TestSignalMultiplexer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRouteToCurrentObject();
+    void testRouteFromCurrentObject();
+    void testDisconnect();
+    void testDeletedObjects();
+};
+
+#endif // KEEPASSXC_TESTSIGNALMULTIPLEXER_H
@@ -29,6 +29,7 @@ QTEST_GUILESS_MAIN(TestSymmetricCipher)
 Q_DECLARE_METATYPE(SymmetricCipher::Algorithm);
 Q_DECLARE_METATYPE(SymmetricCipher::Mode);
 Q_DECLARE_METATYPE(SymmetricCipher::Direction);
+Q_DECLARE_METATYPE(SymmetricCipher::Backend);
 
 void TestSymmetricCipher::initTestCase()
 {
@@ -510,3 +511,144 @@ void TestSymmetricCipher::testStreamReset()
     writer.close();
     QCOMPARE(buffer.buffer().size(), 16);
 }
+
+void TestSymmetricCipher::testBatchedStream_data()
+{
+    QTest::addColumn<SymmetricCipher::Algorithm>("algorithm");
+    QTest::addColumn<int>("dataSize");
+
+    QTest::newRow("AES256 aligned") << SymmetricCipher::Aes256 << 1024;
+    QTest::newRow("AES256 unaligned") << SymmetricCipher::Aes256 << 1031;
+    QTest::newRow("Twofish unaligned") << SymmetricCipher::Twofish << 1031;
+    QTest::newRow("ChaCha20 unaligned") << SymmetricCipher::ChaCha20 << 1031;
+}
+
+void TestSymmetricCipher::testBatchedStream()
+{
+    QFETCH(SymmetricCipher::Algorithm, algorithm);
+    QFETCH(int, dataSize);
+
+    auto mode = SymmetricCipher::algorithmMode(algorithm);
+    QByteArray key(32, 'K');
+    QByteArray iv(SymmetricCipher::algorithmIvSize(algorithm), 'I');
+    QByteArray plainText;
+    for (int i = 0; i < dataSize; ++i) {
+        plainText.append(static_cast<char>(i % 253));
+    }
+
+    QBuffer blockBuffer;
+    QVERIFY(blockBuffer.open(QIODevice::WriteOnly));
+    SymmetricCipherStream blockWriter(&blockBuffer, algorithm, mode, SymmetricCipher::Encrypt);
+    QVERIFY(blockWriter.init(key, iv));
+    QVERIFY(blockWriter.open(QIODevice::WriteOnly));
+    QCOMPARE(blockWriter.write(plainText), qint64(plainText.size()));
+    blockWriter.close();
+
+    // batching must not change the cipher text
+    QBuffer batchBuffer;
+    QVERIFY(batchBuffer.open(QIODevice::WriteOnly));
+    SymmetricCipherStream batchWriter(&batchBuffer, algorithm, mode, SymmetricCipher::Encrypt);
+    batchWriter.setBatchSize(100);
+    QVERIFY(batchWriter.init(key, iv));
+    QVERIFY(batchWriter.open(QIODevice::WriteOnly));
+    QCOMPARE(batchWriter.write(plainText), qint64(plainText.size()));
+    batchWriter.close();
+    QCOMPARE(batchBuffer.buffer(), blockBuffer.buffer());
+
+    QBuffer readBuffer(&batchBuffer.buffer());
+    QVERIFY(readBuffer.open(QIODevice::ReadOnly));
+    SymmetricCipherStream batchReader(&readBuffer, algorithm, mode, SymmetricCipher::Decrypt);
+    batchReader.setBatchSize(SymmetricCipherStream::DefaultBatchSize);
+    QVERIFY(batchReader.init(key, iv));
+    QVERIFY(batchReader.open(QIODevice::ReadOnly));
+    QCOMPARE(batchReader.readAll(), plainText);
+}
+
+void TestSymmetricCipher::testBackends_data()
+{
+    QTest::addColumn<SymmetricCipher::Algorithm>("algorithm");
+    QTest::addColumn<int>("ivSize");
+
+    QTest::newRow("ChaCha20 IETF") << SymmetricCipher::ChaCha20 << 12;
+    QTest::newRow("ChaCha20 original") << SymmetricCipher::ChaCha20 << 8;
+    QTest::newRow("Salsa20") << SymmetricCipher::Salsa20 << 8;
+}
+
+void TestSymmetricCipher::testBackends()
+{
+    QFETCH(SymmetricCipher::Algorithm, algorithm);
+    QFETCH(int, ivSize);
+
+    auto mode = SymmetricCipher::Stream;
+    QVERIFY(SymmetricCipher::isBackendSupported(SymmetricCipher::GcryptBackend, algorithm, mode));
+    if (!SymmetricCipher::isBackendSupported(SymmetricCipher::SodiumBackend, algorithm, mode)) {
+        QSKIP("libsodium backend does not support this cipher");
+    }
+
+    QByteArray key = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+    QByteArray iv = QByteArray::fromHex("000000090000004a0000000031415926").left(ivSize);
+    QByteArray plainText;
+    for (int i = 0; i < 4099; ++i) {
+        plainText.append(static_cast<char>(i % 251));
+    }
+
+    // odd chunk sizes make sure partial keystream blocks are carried over correctly
+    const QList<int> chunkSizes = {1, 7, 63, 64, 65, 129, 1000};
+    QByteArray cipherTexts[2];
+    const SymmetricCipher::Backend backends[2] = {SymmetricCipher::GcryptBackend, SymmetricCipher::SodiumBackend};
+    for (int i = 0; i < 2; ++i) {
+        SymmetricCipher::setPreferredBackend(backends[i]);
+        SymmetricCipher cipher(algorithm, mode, SymmetricCipher::Encrypt);
+        QVERIFY(cipher.init(key, iv));
+
+        int pos = 0;
+        int chunk = 0;
+        while (pos < plainText.size()) {
+            QByteArray data = plainText.mid(pos, chunkSizes[chunk++ % chunkSizes.size()]);
+            QVERIFY(cipher.processInPlace(data));
+            cipherTexts[i].append(data);
+            pos += data.size();
+        }
+    }
+    SymmetricCipher::setPreferredBackend(SymmetricCipher::DefaultBackend);
+
+    QCOMPARE(cipherTexts[1], cipherTexts[0]);
+}
+
+void TestSymmetricCipher::benchmarkBackends_data()
+{
+    QTest::addColumn<SymmetricCipher::Algorithm>("algorithm");
+    QTest::addColumn<SymmetricCipher::Mode>("mode");
+    QTest::addColumn<int>("ivSize");
+    QTest::addColumn<SymmetricCipher::Backend>("backend");
+
+    QTest::newRow("AES256 gcrypt") << SymmetricCipher::Aes256 << SymmetricCipher::Cbc << 16 << SymmetricCipher::GcryptBackend;
+    QTest::newRow("Twofish gcrypt") << SymmetricCipher::Twofish << SymmetricCipher::Cbc << 16 << SymmetricCipher::GcryptBackend;
+    QTest::newRow("ChaCha20 gcrypt") << SymmetricCipher::ChaCha20 << SymmetricCipher::Stream << 12 << SymmetricCipher::GcryptBackend;
+    QTest::newRow("ChaCha20 sodium") << SymmetricCipher::ChaCha20 << SymmetricCipher::Stream << 12 << SymmetricCipher::SodiumBackend;
+    QTest::newRow("Salsa20 gcrypt") << SymmetricCipher::Salsa20 << SymmetricCipher::Stream << 8 << SymmetricCipher::GcryptBackend;
+    QTest::newRow("Salsa20 sodium") << SymmetricCipher::Salsa20 << SymmetricCipher::Stream << 8 << SymmetricCipher::SodiumBackend;
+}
+
+void TestSymmetricCipher::benchmarkBackends()
+{
+    QFETCH(SymmetricCipher::Algorithm, algorithm);
+    QFETCH(SymmetricCipher::Mode, mode);
+    QFETCH(int, ivSize);
+    QFETCH(SymmetricCipher::Backend, backend);
+
+    if (!SymmetricCipher::isBackendSupported(backend, algorithm, mode)) {
+        QSKIP("Backend does not support this cipher");
+    }
+
+    SymmetricCipher::setPreferredBackend(backend);
+    SymmetricCipher cipher(algorithm, mode, SymmetricCipher::Encrypt);
+    SymmetricCipher::setPreferredBackend(SymmetricCipher::DefaultBackend);
+    QVERIFY(cipher.init(QByteArray(32, 'K'), QByteArray(ivSize, 'I')));
+
+    QByteArray data(1024 * 1024, 'D');
+    QBENCHMARK
+    {
+        QVERIFY(cipher.processInPlace(data));
+    }
+}
@@ -40,6 +40,12 @@ private slots:
     void testChaCha20();
     void testPadding();
     void testStreamReset();
+    void testBatchedStream_data();
+    void testBatchedStream();
+    void testBackends_data();
+    void testBackends();
+    void benchmarkBackends_data();
+    void benchmarkBackends();
 };
 
 #endif // KEEPASSX_TESTSYMMETRICCIPHER_H
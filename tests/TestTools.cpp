@@ -17,9 +17,17 @@
 
 #include "TestTools.h"
 
+#include "core/AsyncTask.h"
+#include "core/InactivityTimer.h"
+#include "core/SecureArena.h"
+
 #include <QLocale>
+#include <QRegularExpression>
+#include <QSignalSpy>
 #include <QTest>
 
+#include <algorithm>
+
 QTEST_GUILESS_MAIN(TestTools)
 
 namespace
@@ -89,3 +97,135 @@ void TestTools::testEnvSubstitute()
     QCOMPARE(Tools::envSubstitute("start/$EMPTY$$EMPTY$HOME/end", environment), QString("start/$/home/user/end"));
 #endif
 }
+
+void TestTools::testConvertToRegex()
+{
+    QRegularExpression regex = Tools::convertToRegex("a*b?", true, false, false);
+    QCOMPARE(regex.pattern(), QString("a.*b."));
+    QCOMPARE(regex.patternOptions(), QRegularExpression::CaseInsensitiveOption);
+    QVERIFY(regex.match("xxAyyBz").hasMatch());
+
+    regex = Tools::convertToRegex("a.b", true, true, true);
+    QCOMPARE(regex.pattern(), QString("^a\\.b$"));
+    QCOMPARE(regex.patternOptions(), QRegularExpression::NoPatternOption);
+    QVERIFY(regex.match("a.b").hasMatch());
+    QVERIFY(!regex.match("A.b").hasMatch());
+
+    // repeated terms are served from the cache, with the options they were asked for
+    QCOMPARE(Tools::convertToRegex("a.b", true, true, true), regex);
+    QCOMPARE(Tools::convertToRegex("a.b", true, true, false).patternOptions(),
+             QRegularExpression::CaseInsensitiveOption);
+    QVERIFY(!Tools::convertToRegex("(", false).isValid());
+}
+
+void TestTools::testSecureArena()
+{
+    auto arena = SecureArena::instance();
+    const int chunks = arena->chunkCount();
+
+    // enough slots for more than one chunk
+    QList<void*> allocations;
+    for (int i = 0; i < 600; ++i) {
+        auto ptr = static_cast<char*>(arena->allocate(48));
+        QVERIFY(ptr);
+        std::fill(ptr, ptr + 48, static_cast<char>(i));
+        allocations.append(ptr);
+    }
+    QVERIFY(arena->chunkCount() >= chunks + 2);
+    for (int i = 0; i < allocations.size(); ++i) {
+        QCOMPARE(static_cast<char*>(allocations[i])[47], static_cast<char>(i));
+    }
+
+    for (void* ptr : allocations) {
+        arena->deallocate(ptr, 48);
+    }
+    // empty chunks are released, except for one spare chunk
+    QVERIFY(arena->chunkCount() <= chunks + 1);
+
+    auto large = static_cast<char*>(arena->allocate(100000));
+    QVERIFY(large);
+    large[99999] = 'x';
+    arena->deallocate(large, 100000);
+
+    QByteArray data("secret data");
+    QByteArray shared = data;
+    SecureArena::wipe(data);
+    QVERIFY(data.isEmpty());
+    QCOMPARE(shared, QByteArray("secret data"));
+    SecureArena::wipe(shared);
+    QVERIFY(shared.isEmpty());
+
+    QString string("secret string");
+    SecureArena::wipe(string);
+    QVERIFY(string.isEmpty());
+}
+
+void TestTools::testAsyncTaskExecutors()
+{
+    using AsyncTask::Executor;
+    const QList<Executor> executors = {
+        Executor::Global, Executor::Kdf, Executor::Io, Executor::Interactive, Executor::Background};
+
+    // every executor has a pool of its own
+    QList<QThreadPool*> pools;
+    for (auto executor : executors) {
+        auto* pool = AsyncTask::threadPool(executor);
+        QVERIFY(pool);
+        QVERIFY(!pools.contains(pool));
+        QVERIFY(pool->maxThreadCount() >= 1);
+        pools.append(pool);
+    }
+    QCOMPARE(AsyncTask::threadPool(Executor::Global), QThreadPool::globalInstance());
+    QCOMPARE(AsyncTask::threadPool(Executor::Background)->maxThreadCount(), 1);
+
+    // tasks run on worker threads at the priority of their executor
+    for (auto executor : executors) {
+        auto* mainThread = QThread::currentThread();
+        const auto result = AsyncTask::runAndWaitForFuture(executor, [mainThread] {
+            return qMakePair(QThread::currentThread() != mainThread, QThread::currentThread()->priority());
+        });
+        QVERIFY(result.first);
+        if (AsyncTask::threadPriority(executor) != QThread::InheritPriority) {
+            QCOMPARE(result.second, AsyncTask::threadPriority(executor));
+        }
+    }
+    QCOMPARE(AsyncTask::threadPriority(Executor::Background), QThread::LowestPriority);
+
+    int callbackResult = 0;
+    QObject context;
+    AsyncTask::runThenCallback(
+        Executor::Io, [] { return 42; }, &context, [&callbackResult](int value) { callbackResult = value; });
+    QTRY_COMPARE(callbackResult, 42);
+}
+
+void TestTools::testInactivityTimer()
+{
+    qint64 idle = 0;
+    InactivityTimer timer;
+    timer.setInactivityTimeout(100);
+    timer.setIdleTimeSource([&idle] { return idle; });
+    QSignalSpy spyInactivity(&timer, SIGNAL(inactivityDetected()));
+    timer.activate();
+
+    // constant input keeps the timer from firing
+    QTest::qWait(250);
+    QCOMPARE(spyInactivity.count(), 0);
+
+    idle = 1000;
+    QTRY_COMPARE(spyInactivity.count(), 1);
+    // the inactivity is reported once until the next input
+    QTest::qWait(250);
+    QCOMPARE(spyInactivity.count(), 1);
+
+    idle = 0;
+    QTest::qWait(150);
+    idle = 1000;
+    QTRY_COMPARE(spyInactivity.count(), 2);
+    timer.deactivate();
+
+    // without an idle time, the events of the application are watched
+    timer.setIdleTimeSource([] { return qint64(-1); });
+    timer.activate();
+    QTRY_COMPARE(spyInactivity.count(), 3);
+    timer.deactivate();
+}
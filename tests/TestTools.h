@@ -28,6 +28,10 @@ private slots:
     void testIsHex();
     void testIsBase64();
     void testEnvSubstitute();
+    void testConvertToRegex();
+    void testSecureArena();
+    void testAsyncTaskExecutors();
+    void testInactivityTimer();
 };
 
 #endif // KEEPASSX_TESTTOOLS_H
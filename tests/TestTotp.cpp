@@ -114,6 +114,28 @@ void TestTotp::testTotpCode()
     QCOMPARE(Totp::generateTotp(settings, time), QString("69279037"));
 }
 
+void TestTotp::testTotpBatch()
+{
+    auto settings = Totp::createSettings("GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQ", 8, Totp::DEFAULT_STEP);
+    auto steam = Totp::parseSettings("otpauth://totp/"
+                                     "test:test@example.com?secret=63BEDWCQZKTQWPESARIERL5DTTQFCJTK&issuer=Valve&"
+                                     "algorithm=SHA1&digits=5&period=30&encoder=steam");
+
+    // Current and next time step, 1111111109 and 1111111111 are consecutive steps
+    quint64 time = 1111111109;
+    auto codes = Totp::generateTotps({settings, steam}, time);
+    QCOMPARE(codes.size(), 2);
+    QCOMPARE(codes[0].first, QString("07081804"));
+    QCOMPARE(codes[0].second, QString("14050471"));
+    QCOMPARE(codes[1].first, Totp::generateTotp(steam, time));
+    QCOMPARE(codes[1].second, Totp::generateTotp(steam, time + Totp::DEFAULT_STEP));
+
+    // A changed key is decoded again
+    settings->key = "GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQGEZA";
+    settings->algorithm = Totp::Algorithm::Sha256;
+    QCOMPARE(Totp::generateTotp(settings, time), QString("68084774"));
+}
+
 void TestTotp::testSteamTotp()
 {
     // OTP URL Parsing
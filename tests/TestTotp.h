@@ -29,6 +29,7 @@ private slots:
     void initTestCase();
     void testParseSecret();
     void testTotpCode();
+    void testTotpBatch();
     void testSteamTotp();
     void testEntryHistory();
 };
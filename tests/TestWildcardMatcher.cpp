@@ -51,14 +51,29 @@ void TestWildcardMatcher::testMatcher()
     QFETCH(QString, pattern);
     QFETCH(bool, match);
 
-    initMatcher(text);
-    verifyMatchResult(pattern, match);
+    initMatcher(pattern);
+    verifyMatchResult(text, match);
     cleanupMatcher();
 }
 
-void TestWildcardMatcher::initMatcher(QString text)
+void TestWildcardMatcher::testReuse()
 {
-    m_matcher = new WildcardMatcher(text);
+    const WildcardMatcher matcher(QString("so*other*t"));
+    QCOMPARE(matcher.longestPart(), QString("other"));
+    QVERIFY(matcher.match(AlternativeText));
+    QVERIFY(!matcher.match(DefaultText));
+    QVERIFY(matcher.match(AlternativeText.toUpper()));
+    QVERIFY(!matcher.match(QString()));
+
+    const WildcardMatcher exact(DefaultText);
+    QCOMPARE(exact.longestPart(), DefaultText);
+    QVERIFY(exact.match(DefaultText));
+    QVERIFY(!exact.match(AlternativeText));
+}
+
+void TestWildcardMatcher::initMatcher(QString pattern)
+{
+    m_matcher = new WildcardMatcher(pattern);
 }
 
 void TestWildcardMatcher::cleanupMatcher()
@@ -66,23 +81,23 @@ void TestWildcardMatcher::cleanupMatcher()
     delete m_matcher;
 }
 
-void TestWildcardMatcher::verifyMatchResult(QString pattern, bool expected)
+void TestWildcardMatcher::verifyMatchResult(QString text, bool expected)
 {
     if (expected) {
-        verifyMatch(pattern);
+        verifyMatch(text);
     } else {
-        verifyNoMatch(pattern);
+        verifyNoMatch(text);
     }
 }
 
-void TestWildcardMatcher::verifyMatch(QString pattern)
+void TestWildcardMatcher::verifyMatch(QString text)
 {
-    bool matchResult = m_matcher->match(pattern);
+    bool matchResult = m_matcher->match(text);
     QVERIFY(matchResult);
 }
 
-void TestWildcardMatcher::verifyNoMatch(QString pattern)
+void TestWildcardMatcher::verifyNoMatch(QString text)
 {
-    bool matchResult = m_matcher->match(pattern);
+    bool matchResult = m_matcher->match(text);
     QVERIFY(!matchResult);
 }
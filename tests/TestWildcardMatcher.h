@@ -29,16 +29,17 @@ class TestWildcardMatcher : public QObject
 private slots:
     void testMatcher();
     void testMatcher_data();
+    void testReuse();
 
 private:
     static const QString DefaultText;
     static const QString AlternativeText;
 
-    void initMatcher(QString text);
+    void initMatcher(QString pattern);
     void cleanupMatcher();
-    void verifyMatchResult(QString pattern, bool expected);
-    void verifyMatch(QString pattern);
-    void verifyNoMatch(QString pattern);
+    void verifyMatchResult(QString text, bool expected);
+    void verifyMatch(QString text);
+    void verifyNoMatch(QString text);
 
     WildcardMatcher* m_matcher;
 };
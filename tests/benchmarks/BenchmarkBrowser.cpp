@@ -0,0 +1,50 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkBrowser.h"
+#include "BenchmarkUtils.h"
+
+#include "browser/BrowserService.h"
+#include "core/Database.h"
+#include "crypto/Crypto.h"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(BenchmarkBrowser)
+
+void BenchmarkBrowser::initTestCase()
+{
+    QVERIFY(Crypto::init());
+}
+
+void BenchmarkBrowser::benchmarkSearchEntries_data()
+{
+    BenchmarkUtils::addEntryCountRows();
+}
+
+void BenchmarkBrowser::benchmarkSearchEntries()
+{
+    QFETCH(int, entryCount);
+    auto db = BenchmarkUtils::createDatabase(entryCount);
+
+    // One site that has entries and one that has none, like a browser visiting pages
+    QBENCHMARK
+    {
+        browserService()->searchEntries(db, "https://site7.example.com", "https://site7.example.com/login");
+        browserService()->searchEntries(db, "https://unknown.example.org", "https://unknown.example.org/");
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkCrypto.h"
+
+#include "crypto/Crypto.h"
+#include "crypto/SymmetricCipher.h"
+#include "format/KeePass2RandomStream.h"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(BenchmarkCrypto)
+
+Q_DECLARE_METATYPE(KeePass2::ProtectedStreamAlgo);
+Q_DECLARE_METATYPE(SymmetricCipher::Algorithm);
+Q_DECLARE_METATYPE(SymmetricCipher::Mode);
+Q_DECLARE_METATYPE(SymmetricCipher::Direction);
+
+namespace
+{
+    constexpr int DataSize = 1024 * 1024;
+    // Typical size of a protected value, like a password
+    constexpr int FieldSize = 32;
+} // namespace
+
+void BenchmarkCrypto::initTestCase()
+{
+    QVERIFY(Crypto::init());
+}
+
+void BenchmarkCrypto::benchmarkRandomStream_data()
+{
+    QTest::addColumn<KeePass2::ProtectedStreamAlgo>("algorithm");
+    QTest::newRow("Salsa20") << KeePass2::ProtectedStreamAlgo::Salsa20;
+    QTest::newRow("ChaCha20") << KeePass2::ProtectedStreamAlgo::ChaCha20;
+}
+
+void BenchmarkCrypto::benchmarkRandomStream()
+{
+    QFETCH(KeePass2::ProtectedStreamAlgo, algorithm);
+
+    KeePass2RandomStream stream(algorithm);
+    QVERIFY(stream.init(QByteArray(64, 'K')));
+
+    // Protected values are processed one at a time while reading and writing a database
+    QByteArray field(FieldSize, 'F');
+    QBENCHMARK
+    {
+        for (int i = 0; i < DataSize / FieldSize; ++i) {
+            QVERIFY(stream.processInPlace(field));
+        }
+    }
+}
+
+void BenchmarkCrypto::benchmarkSymmetricCipher_data()
+{
+    QTest::addColumn<SymmetricCipher::Algorithm>("algorithm");
+    QTest::addColumn<SymmetricCipher::Mode>("mode");
+    QTest::addColumn<SymmetricCipher::Direction>("direction");
+    QTest::addColumn<int>("keySize");
+    QTest::addColumn<int>("ivSize");
+
+    struct Cipher
+    {
+        const char* name;
+        SymmetricCipher::Algorithm algorithm;
+        SymmetricCipher::Mode mode;
+        int keySize;
+        int ivSize;
+    };
+    const Cipher ciphers[] = {
+        {"AES128-CBC", SymmetricCipher::Aes128, SymmetricCipher::Cbc, 16, 16},
+        {"AES128-CTR", SymmetricCipher::Aes128, SymmetricCipher::Ctr, 16, 16},
+        {"AES128-ECB", SymmetricCipher::Aes128, SymmetricCipher::Ecb, 16, 16},
+        {"AES256-CBC", SymmetricCipher::Aes256, SymmetricCipher::Cbc, 32, 16},
+        {"AES256-CTR", SymmetricCipher::Aes256, SymmetricCipher::Ctr, 32, 16},
+        {"AES256-ECB", SymmetricCipher::Aes256, SymmetricCipher::Ecb, 32, 16},
+        {"Twofish-CBC", SymmetricCipher::Twofish, SymmetricCipher::Cbc, 32, 16},
+        {"Salsa20", SymmetricCipher::Salsa20, SymmetricCipher::Stream, 32, 8},
+        {"ChaCha20", SymmetricCipher::ChaCha20, SymmetricCipher::Stream, 32, 12},
+    };
+
+    for (const auto& cipher : ciphers) {
+        QTest::newRow(qPrintable(QString("%1 encrypt").arg(cipher.name)))
+            << cipher.algorithm << cipher.mode << SymmetricCipher::Encrypt << cipher.keySize << cipher.ivSize;
+        QTest::newRow(qPrintable(QString("%1 decrypt").arg(cipher.name)))
+            << cipher.algorithm << cipher.mode << SymmetricCipher::Decrypt << cipher.keySize << cipher.ivSize;
+    }
+}
+
+void BenchmarkCrypto::benchmarkSymmetricCipher()
+{
+    QFETCH(SymmetricCipher::Algorithm, algorithm);
+    QFETCH(SymmetricCipher::Mode, mode);
+    QFETCH(SymmetricCipher::Direction, direction);
+    QFETCH(int, keySize);
+    QFETCH(int, ivSize);
+
+    SymmetricCipher cipher(algorithm, mode, direction);
+    QVERIFY(cipher.init(QByteArray(keySize, 'K'), QByteArray(ivSize, 'I')));
+
+    QByteArray data(DataSize, 'D');
+    QBENCHMARK
+    {
+        QVERIFY(cipher.processInPlace(data));
+    }
+}
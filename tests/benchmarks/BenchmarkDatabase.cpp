@@ -0,0 +1,165 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkDatabase.h"
+#include "BenchmarkUtils.h"
+
+#include "config-keepassx.h"
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/EntrySearcher.h"
+#include "core/Group.h"
+#include "core/Merger.h"
+#include "core/PasswordHealth.h"
+#include "crypto/Crypto.h"
+
+#ifdef WITH_XC_ALLOC_STATS
+#include "core/AllocStats.h"
+#endif
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(BenchmarkDatabase)
+
+namespace
+{
+    // A mix of a plain term, field terms and an exclusion, like users type them
+    const QStringList SearchQueries = {"user42", "title:Entry url:site7", "example -notes:second"};
+} // namespace
+
+void BenchmarkDatabase::initTestCase()
+{
+    QVERIFY(Crypto::init());
+}
+
+void BenchmarkDatabase::benchmarkSearch_data()
+{
+    BenchmarkUtils::addEntryCountRows();
+}
+
+void BenchmarkDatabase::benchmarkSearch()
+{
+    QFETCH(int, entryCount);
+    auto db = BenchmarkUtils::createDatabase(entryCount);
+
+    EntrySearcher searcher;
+    QBENCHMARK
+    {
+        for (const auto& query : SearchQueries) {
+            searcher.search(query, db->rootGroup(), true);
+        }
+    }
+}
+
+void BenchmarkDatabase::benchmarkSearchAllocations_data()
+{
+    BenchmarkUtils::addEntryCountRows();
+}
+
+/**
+ * Report the allocations of one round of searches as the result, to keep an
+ * eye on the allocation churn of the search. Worker threads are included.
+ */
+void BenchmarkDatabase::benchmarkSearchAllocations()
+{
+#ifdef WITH_XC_ALLOC_STATS
+    QFETCH(int, entryCount);
+    auto db = BenchmarkUtils::createDatabase(entryCount);
+
+    EntrySearcher searcher;
+    // Leave the one-time setup of the search out of the count
+    searcher.search(SearchQueries.first(), db->rootGroup(), true);
+    const quint64 before = AllocStats::processAllocations();
+    for (const auto& query : SearchQueries) {
+        searcher.search(query, db->rootGroup(), true);
+    }
+    QTest::setBenchmarkResult(static_cast<qreal>(AllocStats::processAllocations() - before), QTest::Events);
+#else
+    QSKIP("Counting allocations requires WITH_XC_ALLOC_STATS");
+#endif
+}
+
+void BenchmarkDatabase::benchmarkIndexedSearch_data()
+{
+    BenchmarkUtils::addEntryCountRows();
+}
+
+void BenchmarkDatabase::benchmarkIndexedSearch()
+{
+    QFETCH(int, entryCount);
+    auto db = BenchmarkUtils::createDatabase(entryCount);
+
+    EntrySearcher searcher;
+    searcher.setUseIndex(true);
+    // Build the index outside of the measurement, it is kept between searches
+    searcher.search(SearchQueries.first(), db->rootGroup(), true);
+    QBENCHMARK
+    {
+        for (const auto& query : SearchQueries) {
+            searcher.search(query, db->rootGroup(), true);
+        }
+    }
+}
+
+void BenchmarkDatabase::benchmarkMerge_data()
+{
+    BenchmarkUtils::addEntryCountRows();
+}
+
+void BenchmarkDatabase::benchmarkMerge()
+{
+    QFETCH(int, entryCount);
+    auto source = BenchmarkUtils::createDatabase(entryCount);
+    auto target = QSharedPointer<Database>::create();
+    target->setRootGroup(source->rootGroup()->clone(Entry::CloneNoFlags, Group::CloneIncludeEntries));
+
+    // Change every tenth entry on the source side so the merge has work to do
+    const QList<Entry*> entries = source->rootGroup()->entriesRecursive();
+    for (int i = 0; i < entries.size(); i += 10) {
+        TimeInfo timeInfo = entries[i]->timeInfo();
+        timeInfo.setLastModificationTime(timeInfo.lastModificationTime().addSecs(60));
+        entries[i]->setNotes(entries[i]->notes() + "\nchanged");
+        entries[i]->setTimeInfo(timeInfo);
+    }
+
+    // Merging is not repeatable, the second run would find nothing to do
+    QBENCHMARK_ONCE
+    {
+        Merger merger(source.data(), target.data());
+        merger.merge();
+    }
+}
+
+void BenchmarkDatabase::benchmarkHealthCheck_data()
+{
+    BenchmarkUtils::addEntryCountRows();
+}
+
+void BenchmarkDatabase::benchmarkHealthCheck()
+{
+    QFETCH(int, entryCount);
+    auto db = BenchmarkUtils::createDatabase(entryCount);
+    const QList<Entry*> entries = db->rootGroup()->entriesRecursive();
+
+    QBENCHMARK
+    {
+        HealthChecker checker(db);
+        for (const auto* entry : entries) {
+            checker.evaluate(entry);
+        }
+    }
+}
@@ -0,0 +1,202 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkFormat.h"
+#include "BenchmarkUtils.h"
+
+#include "core/Database.h"
+#include "crypto/Crypto.h"
+#include "format/KdbxXmlWriter.h"
+#include "format/KeePass2RandomStream.h"
+#include "format/KeePass2Reader.h"
+#include "format/KeePass2Writer.h"
+#include "streams/GzipCodec.h"
+#include "streams/QtIOCompressor"
+
+#include <QBuffer>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(BenchmarkFormat)
+
+namespace
+{
+    /**
+     * Attachment-like data, half of it compressible text and half noise.
+     */
+    QByteArray attachmentData(int size)
+    {
+        QByteArray data;
+        data.reserve(size);
+        for (int i = 0; data.size() < size / 2; ++i) {
+            data.append(QString("Line %1 of an attached text document\n").arg(i).toLatin1());
+        }
+        quint32 state = 12345;
+        while (data.size() < size) {
+            state = state * 1103515245u + 12345u;
+            data.append(static_cast<char>(state >> 24));
+        }
+        return data.left(size);
+    }
+
+    void addGzipRows()
+    {
+        QTest::addColumn<bool>("streaming");
+        QTest::addColumn<int>("size");
+        for (int size : {64 * 1024, 4 * 1024 * 1024}) {
+            QTest::newRow(qPrintable(QString("QtIOCompressor, %1 KiB").arg(size / 1024))) << true << size;
+            QTest::newRow(qPrintable(QString("GzipCodec, %1 KiB").arg(size / 1024))) << false << size;
+        }
+    }
+} // namespace
+
+void BenchmarkFormat::initTestCase()
+{
+    QVERIFY(Crypto::init());
+}
+
+void BenchmarkFormat::benchmarkWriteKdbx4_data()
+{
+    BenchmarkUtils::addEntryCountRows();
+}
+
+void BenchmarkFormat::benchmarkWriteKdbx4()
+{
+    QFETCH(int, entryCount);
+    auto db = BenchmarkUtils::createDatabase(entryCount);
+
+    QBENCHMARK
+    {
+        QBuffer buffer;
+        buffer.open(QBuffer::WriteOnly);
+        KeePass2Writer writer;
+        QVERIFY2(writer.writeDatabase(&buffer, db.data()), qPrintable(writer.errorString()));
+    }
+}
+
+void BenchmarkFormat::benchmarkWriteXml_data()
+{
+    BenchmarkUtils::addEntryCountRows();
+}
+
+/**
+ * Measure the XML serialization alone, i.e. the share of the KDBX 4
+ * save time that is spent before compression and encryption.
+ */
+void BenchmarkFormat::benchmarkWriteXml()
+{
+    QFETCH(int, entryCount);
+    auto db = BenchmarkUtils::createDatabase(entryCount);
+
+    QBENCHMARK
+    {
+        KeePass2RandomStream randomStream(KeePass2::ProtectedStreamAlgo::ChaCha20);
+        QVERIFY(randomStream.init(QByteArray(64, '\x42')));
+
+        QBuffer buffer;
+        buffer.open(QBuffer::WriteOnly);
+        KdbxXmlWriter writer(KeePass2::FILE_VERSION_4);
+        writer.writeDatabase(&buffer, db.data(), &randomStream);
+        QVERIFY2(!writer.hasError(), qPrintable(writer.errorString()));
+    }
+}
+
+void BenchmarkFormat::benchmarkReadKdbx4_data()
+{
+    BenchmarkUtils::addEntryCountRows();
+}
+
+void BenchmarkFormat::benchmarkReadKdbx4()
+{
+    QFETCH(int, entryCount);
+
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    {
+        auto db = BenchmarkUtils::createDatabase(entryCount);
+        KeePass2Writer writer;
+        QVERIFY2(writer.writeDatabase(&buffer, db.data()), qPrintable(writer.errorString()));
+    }
+
+    auto key = BenchmarkUtils::databaseKey();
+    QBENCHMARK
+    {
+        buffer.seek(0);
+        auto db = QSharedPointer<Database>::create();
+        KeePass2Reader reader;
+        reader.readDatabase(&buffer, key, db.data());
+        QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    }
+}
+
+void BenchmarkFormat::benchmarkGzipCompress_data()
+{
+    addGzipRows();
+}
+
+/**
+ * Compare compressing an attachment through QtIOCompressor with
+ * compressing it at once, as it is done for KDBX 3 attachments.
+ */
+void BenchmarkFormat::benchmarkGzipCompress()
+{
+    QFETCH(bool, streaming);
+    QFETCH(int, size);
+    QByteArray data = attachmentData(size);
+
+    QBENCHMARK
+    {
+        if (streaming) {
+            QBuffer buffer;
+            buffer.open(QBuffer::WriteOnly);
+            QtIOCompressor compressor(&buffer);
+            compressor.setStreamFormat(QtIOCompressor::GzipFormat);
+            QVERIFY(compressor.open(QIODevice::WriteOnly));
+            QCOMPARE(compressor.write(data), qint64(data.size()));
+            compressor.close();
+        } else {
+            QVERIFY(!GzipCodec::compress(data).isNull());
+        }
+    }
+}
+
+void BenchmarkFormat::benchmarkGzipDecompress_data()
+{
+    addGzipRows();
+}
+
+void BenchmarkFormat::benchmarkGzipDecompress()
+{
+    QFETCH(bool, streaming);
+    QFETCH(int, size);
+    QByteArray compressed = GzipCodec::compress(attachmentData(size));
+
+    QBENCHMARK
+    {
+        QByteArray data;
+        if (streaming) {
+            QBuffer buffer(&compressed);
+            buffer.open(QBuffer::ReadOnly);
+            QtIOCompressor compressor(&buffer);
+            compressor.setStreamFormat(QtIOCompressor::GzipFormat);
+            QVERIFY(compressor.open(QIODevice::ReadOnly));
+            data = compressor.readAll();
+        } else {
+            QVERIFY(GzipCodec::decompress(compressed, data));
+        }
+        QCOMPARE(data.size(), size);
+    }
+}
@@ -0,0 +1,41 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_BENCHMARKFORMAT_H
+#define KEEPASSXC_BENCHMARKFORMAT_H
+
+#include <QObject>
+
+class BenchmarkFormat : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void benchmarkWriteKdbx4_data();
+    void benchmarkWriteKdbx4();
+    void benchmarkWriteXml_data();
+    void benchmarkWriteXml();
+    void benchmarkReadKdbx4_data();
+    void benchmarkReadKdbx4();
+    void benchmarkGzipCompress_data();
+    void benchmarkGzipCompress();
+    void benchmarkGzipDecompress_data();
+    void benchmarkGzipDecompress();
+};
+
+#endif // KEEPASSXC_BENCHMARKFORMAT_H
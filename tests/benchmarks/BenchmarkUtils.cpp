@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+
+#include "core/Database.h"
+#include "core/DatabaseGenerator.h"
+#include "crypto/kdf/Kdf.h"
+#include "format/KeePass2.h"
+#include "keys/CompositeKey.h"
+#include "keys/PasswordKey.h"
+
+#include <QTest>
+
+namespace
+{
+    constexpr int EntriesPerGroup = 100;
+} // namespace
+
+namespace BenchmarkUtils
+{
+    QSharedPointer<CompositeKey> databaseKey()
+    {
+        auto key = QSharedPointer<CompositeKey>::create();
+        key->addKey(QSharedPointer<PasswordKey>::create("benchmark"));
+        return key;
+    }
+
+    /**
+     * Create a database with the given number of entries, spread over groups of
+     * EntriesPerGroup entries on average. The content comes from DatabaseGenerator
+     * with a fixed seed, so every run works on the same data. One in ten entries
+     * reuses a password.
+     *
+     * The KDF is made as cheap as possible to keep it out of the measurements.
+     */
+    QSharedPointer<Database> createDatabase(int entryCount)
+    {
+        auto db = QSharedPointer<Database>::create();
+        auto kdf = KeePass2::uuidToKdf(KeePass2::KDF_ARGON2);
+        kdf->setRounds(1);
+        kdf->processParameters({{KeePass2::KDFPARAM_ARGON2_MEMORY, 1024}, {KeePass2::KDFPARAM_ARGON2_PARALLELISM, 1}});
+        db->changeKdf(kdf);
+        db->setKey(databaseKey());
+
+        DatabaseGenerator::Settings settings;
+        settings.groups = qMax(1, entryCount / EntriesPerGroup);
+        settings.entries = entryCount;
+        settings.customAttributes = 1;
+        settings.passwordReuse = 10;
+        DatabaseGenerator(settings).populate(db.data());
+
+        return db;
+    }
+
+    void addEntryCountRows()
+    {
+        QTest::addColumn<int>("entryCount");
+        QTest::newRow("1k") << 1000;
+        QTest::newRow("10k") << 10000;
+        QTest::newRow("100k") << 100000;
+    }
+} // namespace BenchmarkUtils
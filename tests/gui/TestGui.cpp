@@ -685,43 +685,43 @@ void TestGui::testPasswordEntryEntropy()
 
                generatedPassword->setText("");
                QTest::keyClicks(generatedPassword, "hello");
-               QCOMPARE(entropyLabel->text(), QString("Entropy: 6.38 bit"));
-               QCOMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
+               QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 6.38 bit"));
+               QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
 
                generatedPassword->setText("");
                QTest::keyClicks(generatedPassword, "helloworld");
-               QCOMPARE(entropyLabel->text(), QString("Entropy: 13.10 bit"));
-               QCOMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
+               QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 13.10 bit"));
+               QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
 
                generatedPassword->setText("");
                QTest::keyClicks(generatedPassword, "password1");
-               QCOMPARE(entropyLabel->text(), QString("Entropy: 4.00 bit"));
-               QCOMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
+               QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 4.00 bit"));
+               QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
 
                generatedPassword->setText("");
                QTest::keyClicks(generatedPassword, "D0g..................");
-               QCOMPARE(entropyLabel->text(), QString("Entropy: 19.02 bit"));
-               QCOMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
+               QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 19.02 bit"));
+               QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
 
                generatedPassword->setText("");
                QTest::keyClicks(generatedPassword, "Tr0ub4dour&3");
-               QCOMPARE(entropyLabel->text(), QString("Entropy: 30.87 bit"));
-               QCOMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
+               QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 30.87 bit"));
+               QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Poor"));
 
                generatedPassword->setText("");
                QTest::keyClicks(generatedPassword, "correcthorsebatterystaple");
-               QCOMPARE(entropyLabel->text(), QString("Entropy: 47.98 bit"));
-               QCOMPARE(strengthLabel->text(), QString("Password Quality: Weak"));
+               QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 47.98 bit"));
+               QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Weak"));
 
                generatedPassword->setText("");
                QTest::keyClicks(generatedPassword, "YQC3kbXbjC652dTDH");
-               QCOMPARE(entropyLabel->text(), QString("Entropy: 95.83 bit"));
-               QCOMPARE(strengthLabel->text(), QString("Password Quality: Good"));
+               QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 95.83 bit"));
+               QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Good"));
 
                generatedPassword->setText("");
                QTest::keyClicks(generatedPassword, "Bs5ZFfthWzR8DGFEjaCM6bGqhmCT4km");
-               QCOMPARE(entropyLabel->text(), QString("Entropy: 174.59 bit"));
-               QCOMPARE(strengthLabel->text(), QString("Password Quality: Excellent"));
+               QTRY_COMPARE(entropyLabel->text(), QString("Entropy: 174.59 bit"));
+               QTRY_COMPARE(strengthLabel->text(), QString("Password Quality: Excellent"));
 
                QTest::mouseClick(generatedPassword, Qt::LeftButton);
                QTest::keyClick(generatedPassword, Qt::Key_Escape););
@@ -1282,7 +1282,7 @@ void TestGui::testDatabaseSettings()
 
 void TestGui::testKeePass1Import()
 {
-    fileDialog()->setNextFileName(QString(KEEPASSX_TEST_DATA_DIR).append("/basic.kdb"));
+    fileDialog()->setNextFileNames({QString(KEEPASSX_TEST_DATA_DIR).append("/basic.kdb")});
     triggerAction("actionImportKeePass1");
 
     auto* keepass1OpenWidget = m_tabWidget->currentDatabaseWidget()->findChild<QWidget*>("keepass1OpenWidget");
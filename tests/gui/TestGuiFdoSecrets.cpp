@@ -446,6 +446,30 @@ void TestGuiFdoSecrets::testServiceSearch()
         QCOMPARE(locked.size(), 0);
         QCOMPARE(unlocked.size(), 0);
     }
+
+    // all pairs have to match
+    {
+        QList<Item*> locked;
+        CHECKED_DBUS_LOCAL_CALL(unlocked, service->searchItems({{"fdosecrets-test", "1"}, {crazyKey, "1"}}, locked));
+        QCOMPARE(locked.size(), 0);
+        QCOMPARE(unlocked.size(), 0);
+    }
+
+    // searching again sees changed attributes
+    item->backend()->attributes()->set("fdosecrets-test", "3");
+    {
+        QList<Item*> locked;
+        CHECKED_DBUS_LOCAL_CALL(unlocked, service->searchItems({{"fdosecrets-test", "1"}}, locked));
+        QCOMPARE(locked.size(), 0);
+        QCOMPARE(unlocked.size(), 0);
+    }
+    {
+        QList<Item*> locked;
+        CHECKED_DBUS_LOCAL_CALL(unlocked,
+                                service->searchItems({{"fdosecrets-test", "3"}, {crazyKey, crazyValue}}, locked));
+        QCOMPARE(locked.size(), 0);
+        QCOMPARE(unlocked, {item});
+    }
 }
 
 void TestGuiFdoSecrets::testServiceUnlock()
@@ -32,6 +32,16 @@ void TestGuiPixmaps::testDatabaseIcons()
     auto pixmap = databaseIcons()->icon(0);
     auto pixmapCached = databaseIcons()->icon(0);
     QCOMPARE(pixmapCached.cacheKey(), pixmap.cacheKey());
+
+    // every size is rasterized and cached on its own
+    auto pixmapLarge = databaseIcons()->icon(0, IconSize::Large);
+    QVERIFY(pixmapLarge.cacheKey() != pixmap.cacheKey());
+    QCOMPARE(databaseIcons()->icon(0, IconSize::Large).cacheKey(), pixmapLarge.cacheKey());
+
+    // badged icons are reused as long as the base pixmap is shared
+    auto badged = databaseIcons()->applyBadge(databaseIcons()->icon(1), DatabaseIcons::Expired);
+    auto badgedCached = databaseIcons()->applyBadge(databaseIcons()->icon(1), DatabaseIcons::Expired);
+    QCOMPARE(badgedCached.cacheKey(), badged.cacheKey());
 }
 
 void TestGuiPixmaps::testEntryIcons()